@@ -14,8 +14,8 @@ if(NOT MSVC_VERSION)
   # to .r[o]data section one after the other!
   add_compile_options(-fno-ident -Wa,-mbig-obj)
   link_libraries( -lws2_32 -lshlwapi -ldbghelp -luser32 -liphlpapi -lpsapi -luserenv )
-  # zmq requires windows xp or higher
-  add_definitions(-DWINVER=0x0501 -D_WIN32_WINNT=0x0501)
+  # zmq requires windows xp or higher, the tun completion loop vista
+  add_definitions(-DWINVER=0x0600 -D_WIN32_WINNT=0x0600)
 endif()
 
 if(EMBEDDED_CFG)
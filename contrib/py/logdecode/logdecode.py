@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+turns lokinet's binary logs (logging type=binary) into text
+"""
+
+from argparse import ArgumentParser as AP
+from datetime import datetime
+import struct
+import sys
+
+MAGIC = b'LLBL'
+LEVELS = ['Trace', 'Debug', 'Info', 'Warn', 'Error', 'None']
+
+ENTRY_SITE = 1
+ENTRY_RECORD = 2
+ENTRY_DROPPED = 3
+
+
+class Reader:
+    """ reads fixed size fields off the front of the log """
+
+    def __init__(self, data):
+        self.data = data
+        self.off = 0
+
+    def more(self):
+        return self.off < len(self.data)
+
+    def take(self, size):
+        if self.off + size > len(self.data):
+            raise EOFError('log ends part way through an entry')
+        chunk = self.data[self.off:self.off + size]
+        self.off += size
+        return chunk
+
+    def unpack(self, fmt):
+        return struct.unpack('<' + fmt, self.take(struct.calcsize('<' + fmt)))
+
+
+def format_args(payload):
+    """ the message as the text loggers would have printed it """
+    out = []
+    args = Reader(payload)
+    while args.more():
+        tag = chr(args.take(1)[0])
+        if tag == 's':
+            size, = args.unpack('H')
+            out.append(args.take(size).decode('utf-8', 'replace'))
+        elif tag == 'i':
+            out.append(str(args.unpack('q')[0]))
+        elif tag == 'u':
+            out.append(str(args.unpack('Q')[0]))
+        elif tag == 'f':
+            out.append('%g' % args.unpack('d')[0])
+        else:
+            out.append('<bad argument %r>' % tag)
+            break
+    return ''.join(out)
+
+
+def decode(data, write):
+    """ write each entry in data as a line of text """
+    log = Reader(data)
+    sites = {}
+    while log.more():
+        if data[log.off:log.off + 4] == MAGIC:
+            log.take(4)
+            version = log.take(1)[0]
+            if version != 1:
+                raise ValueError('unknown log version %d' % version)
+            # another run, its sites are numbered afresh
+            sites = {}
+            continue
+        kind = log.take(1)[0]
+        if kind == ENTRY_SITE:
+            site, line, size = log.unpack('IiH')
+            sites[site] = '%s:%d' % (log.take(size).decode('utf-8', 'replace'), line)
+        elif kind == ENTRY_RECORD:
+            when, thread, level, site, truncated, size = log.unpack('qHBIBH')
+            msg = format_args(log.take(size))
+            if truncated:
+                msg += ' [truncated]'
+            stamp = datetime.fromtimestamp(when / 1000).strftime('%c')
+            write('[%s] (%d) %s %s\t%s' % (
+                LEVELS[level] if level < len(LEVELS) else level, thread, stamp,
+                sites.get(site, '?'), msg))
+        elif kind == ENTRY_DROPPED:
+            dropped, = log.unpack('Q')
+            write('[Warn] %d log records dropped so far' % dropped)
+        else:
+            raise ValueError('unknown entry %d at offset %d' % (kind, log.off - 1))
+
+
+def main():
+    """
+    main function for logdecode
+    """
+    argparser = AP()
+    argparser.add_argument('logfile', type=str, help='binary log written by lokinet')
+    args = argparser.parse_args()
+    with open(args.logfile, 'rb') as rfile:
+        data = rfile.read()
+    try:
+        decode(data, print)
+    except EOFError as ex:
+        print(ex, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
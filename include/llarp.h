@@ -78,6 +78,33 @@ extern "C"
   bool
   llarp_vpn_io_writepkt(struct llarp_vpn_pkt_writer* w, unsigned char* pktbuf, size_t pktlen);
 
+  /// size of each packet slot in the buffers of the batched calls below, the largest packet
+  /// lokinet carries
+#define LLARP_VPN_PACKET_SLOT_SIZE 1500
+
+  /// batched read on packet reader from lokinet internals, for when a call costs more than the
+  /// copy (e.g. across jni). slots is numslots packet slots of LLARP_VPN_PACKET_SLOT_SIZE bytes
+  /// back to back, packet i is copied straight from the queue into slot i and its size put in
+  /// lens[i]. blocks until there is at least one packet, then takes what else is queued
+  /// returns -1 on error, returns number of packets read
+  /// thread safe
+  ssize_t
+  llarp_vpn_io_readpkts(
+      struct llarp_vpn_pkt_reader* r, unsigned char* slots, uint32_t* lens, size_t numslots);
+
+  /// batched non blocking write on packet writer to lokinet internals, slots laid out as for
+  /// llarp_vpn_io_readpkts with the size of packet i in lens[i]. packets are copied straight
+  /// into the queue. stops at the first packet that does not fit in the queue, packets with a
+  /// bad size are dropped
+  /// returns -1 on error, returns number of packets taken, dropped ones included
+  /// thread safe
+  ssize_t
+  llarp_vpn_io_writepkts(
+      struct llarp_vpn_pkt_writer* w,
+      const unsigned char* slots,
+      const uint32_t* lens,
+      size_t numpkts);
+
   /// close vpn io and free private implementation after done
   /// operation is async and calls llarp_vpn_io.closed after fully closed
   /// after fully closed the llarp_vpn_io MUST be re-initialized by
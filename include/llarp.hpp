@@ -25,6 +25,10 @@ namespace llarp
   {
     class ThreadPool;
   }
+  namespace handlers
+  {
+    struct EmbeddedEndpoint;
+  }
 
   struct RuntimeOptions
   {
@@ -90,6 +94,11 @@ namespace llarp
     bool
     CallSafe(std::function<void(void)> f);
 
+    /// the endpoint called name if it has [network] type=embedded, for apps that run lokinet
+    /// in process and talk to remotes without a tun. nullptr if there is no such endpoint
+    std::shared_ptr<handlers::EmbeddedEndpoint>
+    GetEmbeddedEndpoint(const std::string& name = "default") const;
+
     /// Creates a router. Can be overridden to allow a different class of router
     /// to be created instead. Defaults to llarp::Router.
     virtual std::unique_ptr<AbstractRouter>
@@ -108,6 +108,10 @@ typedef struct in6_addr t_tun_in6_addr;
 #define TUNTAP_MODE_ETHERNET 0x0001
 #define TUNTAP_MODE_TUNNEL 0x0002
 #define TUNTAP_MODE_PERSIST 0x0004
+/* linux only, create the device so more queues can be attached to it */
+#define TUNTAP_MODE_MULTIQUEUE 0x0008
+/* linux only, prefix packets with a struct virtio_net_hdr */
+#define TUNTAP_MODE_VNETHDR 0x0010
 
 #define TUNTAP_LOG_NONE 0x0000
 #define TUNTAP_LOG_DEBUG 0x0001
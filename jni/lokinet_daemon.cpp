@@ -84,4 +84,15 @@ extern "C"
       return JNI_FALSE;
     return llarp_main_inject_default_vpn(ptr, &impl->io, impl->info) ? JNI_TRUE : JNI_FALSE;
   }
+
+  JNIEXPORT jboolean JNICALL
+  Java_network_loki_lokinet_LokinetDaemon_SetLowActivity(
+      JNIEnv* env, jobject self, jboolean allowed)
+  {
+    auto ptr = GetImpl<llarp::Context>(env, self);
+    if (ptr == nullptr || ptr->router == nullptr)
+      return JNI_FALSE;
+    ptr->router->SetIdleAllowed(allowed == JNI_TRUE);
+    return JNI_TRUE;
+  }
 }
\ No newline at end of file
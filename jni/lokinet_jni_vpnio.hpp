@@ -113,6 +113,22 @@ namespace lokinet
       return llarp_vpn_io_writepkt(Writer(), buf, len);
     }
 
+    ssize_t
+    ReadPackets(void* slots, uint32_t* lens, size_t numslots)
+    {
+      if (not Ready())
+        return -1;
+      return llarp_vpn_io_readpkts(Reader(), (unsigned char*)slots, lens, numslots);
+    }
+
+    ssize_t
+    WritePackets(const void* slots, const uint32_t* lens, size_t numpkts)
+    {
+      if (not Ready())
+        return -1;
+      return llarp_vpn_io_writepkts(Writer(), (const unsigned char*)slots, lens, numpkts);
+    }
+
     void
     SetIfName(std::string_view val)
     {
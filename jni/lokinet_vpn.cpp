@@ -64,6 +64,42 @@ extern "C"
     return vpn->WritePacket(pktbuf, pktlen);
   }
 
+  /// slots is a direct buffer of PacketSize() byte slots, lens a direct buffer of native order
+  /// ints, one per slot. one crossing moves as many packets as are queued
+  JNIEXPORT jint JNICALL
+  Java_network_loki_lokinet_LokinetVPN_ReadPkts(
+      JNIEnv* env, jobject self, jobject slots, jobject lens)
+  {
+    lokinet_jni_vpnio* vpn = GetImpl<lokinet_jni_vpnio>(env, self);
+    if (vpn == nullptr)
+      return -1;
+    void* slotbuf = env->GetDirectBufferAddress(slots);
+    auto* lenbuf = static_cast<uint32_t*>(env->GetDirectBufferAddress(lens));
+    if (slotbuf == nullptr or lenbuf == nullptr)
+      return -1;
+    const size_t numslots = std::min<size_t>(
+        env->GetDirectBufferCapacity(slots) / LLARP_VPN_PACKET_SLOT_SIZE,
+        env->GetDirectBufferCapacity(lens) / sizeof(uint32_t));
+    return vpn->ReadPackets(slotbuf, lenbuf, numslots);
+  }
+
+  JNIEXPORT jint JNICALL
+  Java_network_loki_lokinet_LokinetVPN_WritePkts(
+      JNIEnv* env, jobject self, jobject slots, jobject lens, jint num)
+  {
+    lokinet_jni_vpnio* vpn = GetImpl<lokinet_jni_vpnio>(env, self);
+    if (vpn == nullptr or num < 0)
+      return -1;
+    const void* slotbuf = env->GetDirectBufferAddress(slots);
+    const auto* lenbuf = static_cast<const uint32_t*>(env->GetDirectBufferAddress(lens));
+    if (slotbuf == nullptr or lenbuf == nullptr)
+      return -1;
+    const size_t numslots = std::min<size_t>(
+        env->GetDirectBufferCapacity(slots) / LLARP_VPN_PACKET_SLOT_SIZE,
+        env->GetDirectBufferCapacity(lens) / sizeof(uint32_t));
+    return vpn->WritePackets(slotbuf, lenbuf, std::min<size_t>(num, numslots));
+  }
+
   JNIEXPORT void JNICALL
   Java_network_loki_lokinet_LokinetVPN_SetInfo(JNIEnv* env, jobject self, jobject info)
   {
@@ -64,6 +64,14 @@ extern "C"
   JNIEXPORT jboolean JNICALL
   Java_network_loki_lokinet_LokinetDaemon_InjectVPN(JNIEnv*, jobject, jobject);
 
+  /*
+   * Class:     network_loki_lokinet_LokinetDaemon
+   * Method:    SetLowActivity
+   * Signature: (Z)Z
+   */
+  JNIEXPORT jboolean JNICALL
+  Java_network_loki_lokinet_LokinetDaemon_SetLowActivity(JNIEnv*, jobject, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,6 +56,22 @@ extern "C"
   JNIEXPORT jboolean JNICALL
   Java_network_loki_lokinet_LokinetVPN_WritePkt(JNIEnv*, jobject, jobject);
 
+  /*
+   * Class:     network_loki_lokinet_LokinetVPN
+   * Method:    ReadPkts
+   * Signature: (Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)I
+   */
+  JNIEXPORT jint JNICALL
+  Java_network_loki_lokinet_LokinetVPN_ReadPkts(JNIEnv*, jobject, jobject, jobject);
+
+  /*
+   * Class:     network_loki_lokinet_LokinetVPN
+   * Method:    WritePkts
+   * Signature: (Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;I)I
+   */
+  JNIEXPORT jint JNICALL
+  Java_network_loki_lokinet_LokinetVPN_WritePkts(JNIEnv*, jobject, jobject, jobject, jint);
+
   /*
    * Class:     network_loki_lokinet_LokinetVPN
    * Method:    SetInfo
@@ -19,6 +19,8 @@
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <map>
+#include <set>
 #include "constants/version.hpp"
 
 namespace llarp
@@ -39,6 +41,7 @@ namespace llarp
   {
     constexpr Default DefaultJobQueueSize{1024 * 8};
     constexpr Default DefaultWorkerThreads{0};
+    constexpr Default DefaultRPCThreads{2};
     constexpr Default DefaultBlockBogons{true};
 
     conf.defineOption<int>(
@@ -185,6 +188,250 @@ namespace llarp
           m_workerThreads = arg;
         });
 
+    conf.defineOption<int>(
+        "router",
+        "rpc-threads",
+        DefaultRPCThreads,
+        Comment{
+            "The number of threads that serve rpc requests and lokid replies, apart from the",
+            "worker-threads doing cryptography so a busy api does not hold up traffic.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("rpc-threads must be >= 1");
+
+          m_rpcThreads = arg;
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "udp-offload",
+        Default{true},
+        Hidden,
+        AssignmentAcceptor(m_udpOffload),
+        Comment{
+            "Use kernel udp segmentation and receive offload for link traffic where supported.",
+            "Lokinet falls back to regular sends when the kernel or NIC lacks support.",
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "io-uring",
+        Default{false},
+        Hidden,
+        AssignmentAcceptor(m_ioUring),
+        Comment{
+            "Do link socket reads and writes through io_uring, which takes the place of",
+            "udp-offload. Needs Linux 6.0 or newer and a lokinet built with WITH_IO_URING.",
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "busy-poll",
+        RelayOnly,
+        Default{0},
+        Comment{
+            "Microseconds the event loop and link sockets spin waiting for packets before they",
+            "sleep, which saves a wakeup per packet on dedicated relays at the cost of keeping",
+            "cores busy. Socket reads need CAP_NET_ADMIN to spin. 0 turns it off.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("busy-poll must be >= 0");
+
+          m_busyPoll = std::chrono::microseconds{arg};
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "loop-cpu",
+        RelayOnly,
+        Default{-1},
+        Comment{
+            "A cpu to pin the event loop thread to, best one kept free of other work with the",
+            "isolcpus kernel option and left out of cpu-affinity. -1 lets the kernel decide.",
+        },
+        [this](int arg) {
+          if (arg < -1)
+            throw std::invalid_argument("loop-cpu must be >= -1");
+
+          m_loopCpu = arg;
+        });
+
+    conf.defineOption<fs::path>(
+        "router",
+        "capture-file",
+        Hidden,
+        Comment{
+            "Write every datagram the link layers read, with when and from where, to this file",
+            "to be replayed offline by benchReplay. It grows without bound, for test nodes.",
+        },
+        [this](fs::path arg) { m_captureFile = std::move(arg); });
+
+    conf.defineOption<bool>(
+        "router",
+        "capture-keys",
+        Hidden,
+        Default{false},
+        AssignmentAcceptor(m_captureKeys),
+        Comment{
+            "Also write the key of each link session to capture-file once it is set up, so its",
+            "traffic opens on replay. Anyone with the file can read that traffic, only ever turn",
+            "this on for test nodes of your own.",
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "aes-gcm",
+        Default{true},
+        Hidden,
+        AssignmentAcceptor(m_aesGCM),
+        Comment{
+            "Encrypt link traffic with AES-256-GCM instead of xchacha20 and a keyed hash when",
+            "this cpu has AES instructions and the remote router supports it too.",
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "link-sockets",
+        RelayOnly,
+        Default{1},
+        Comment{
+            "The number of UDP sockets to open on each inbound link address, each read by its",
+            "own thread. The kernel spreads remote routers across them, which helps busy relays",
+            "on multi-core machines. Requires SO_REUSEPORT support.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("link-sockets must be >= 1");
+
+          m_linkSockets = arg;
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "huge-pages",
+        RelayOnly,
+        Default{false},
+        AssignmentAcceptor(m_hugePages),
+        Comment{
+            "Back packet buffers with transparent huge pages, which cuts tlb misses on busy",
+            "relays. The kernel must allow them, see /sys/kernel/mm/transparent_hugepage.",
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "numa-local",
+        RelayOnly,
+        Default{false},
+        AssignmentAcceptor(m_numaLocal),
+        Comment{
+            "Place the packet buffers each thread allocates on that thread's NUMA node.",
+            "Best combined with cpu-affinity on machines with more than one cpu socket.",
+        });
+
+    conf.defineOption<std::string>(
+        "router",
+        "cpu-affinity",
+        RelayOnly,
+        Comment{
+            "Comma separated cpus, or ranges of them such as 4-7, to pin the crypto worker and",
+            "link socket threads to, one each in turn. Leaving it empty lets the kernel decide.",
+        },
+        [this](std::string arg) {
+          m_cpuAffinity.clear();
+          for (auto part : split(arg, ",", true))
+          {
+            trim(part);
+            const auto dash = part.find('-');
+            int first = 0;
+            int last = 0;
+            if (not parse_int(part.substr(0, dash), first)
+                or (dash != std::string_view::npos and not parse_int(part.substr(dash + 1), last)))
+              throw std::invalid_argument(stringify("invalid cpu-affinity entry: ", part));
+            if (dash == std::string_view::npos)
+              last = first;
+            if (first < 0 or last < first)
+              throw std::invalid_argument(stringify("invalid cpu-affinity range: ", part));
+            for (int cpu = first; cpu <= last; ++cpu)
+              m_cpuAffinity.push_back(cpu);
+          }
+        });
+
+    conf.defineOption<std::string>(
+        "router",
+        "link-padding",
+        Default{"bucketed"},
+        Comment{
+            "Random padding on link control packets such as acks: bucketed adds 16 to 32 bytes,",
+            "none adds nothing. Peers take either, so this only changes what we send.",
+        },
+        [this](std::string arg) {
+          const auto profile = padding::ParseProfile(arg);
+          if (not profile or *profile == padding::Profile::ConstantRate)
+            throw std::invalid_argument(stringify("invalid link-padding: ", arg));
+          m_linkPadding = *profile;
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "ack-delay",
+        Default{static_cast<int>(DefaultAckDelay.count())},
+        Hidden,
+        Comment{
+            "Milliseconds a link session may hold acks for so they go out together.",
+            "Higher values send fewer packets on busy relays at the cost of latency.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("ack-delay must be >= 0");
+          m_ackDelay = std::chrono::milliseconds{arg};
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "ack-budget",
+        Default{static_cast<int>(DefaultAckBudget)},
+        Hidden,
+        Comment{
+            "How many acks a link session holds before it sends them without waiting.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("ack-budget must be >= 1");
+          m_ackBudget = arg;
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "cell-batch-delay",
+        Default{0},
+        Hidden,
+        Comment{
+            "Milliseconds small routing messages on a path may wait to share a relay cell.",
+            "0 only packs together what is sent in the same pass of the event loop.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("cell-batch-delay must be >= 0");
+          m_cellBatchDelay = std::chrono::milliseconds{arg};
+        });
+
+    conf.defineOption<int>(
+        "router",
+        "cell-bundle-delay",
+        Default{0},
+        Hidden,
+        Comment{
+            "Milliseconds relay cells to the same next hop may wait to share a link message.",
+            "0 only bundles the cells relayed in the same pass of the event loop.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("cell-bundle-delay must be >= 0");
+          m_cellBundleDelay = std::chrono::milliseconds{arg};
+        });
+
     // Hidden option because this isn't something that should ever be turned off occasionally when
     // doing dev/testing work.
     conf.defineOption<bool>(
@@ -385,6 +632,158 @@ namespace llarp
           m_Paths = arg;
         });
 
+    conf.defineOption<std::string>(
+        "network",
+        "padding",
+        ClientOnly,
+        Default{"bucketed"},
+        Comment{
+            "How the cells of our paths are padded, both ways. bucketed rounds each up to a",
+            "multiple of 128 bytes. none pads nothing, for the least bandwidth. constant-rate",
+            "rounds up to 512 bytes and sends a cover cell every second a path is otherwise",
+            "idle, for the most resistance to traffic analysis at the most bandwidth.",
+        },
+        [this](std::string arg) {
+          const auto profile = padding::ParseProfile(arg);
+          if (not profile)
+            throw std::invalid_argument(stringify("invalid [network]:padding: ", arg));
+          m_Padding = *profile;
+        });
+
+    conf.defineOption<int>(
+        "network",
+        "path-pool-max",
+        ClientOnly,
+        Default{0},
+        Comment{
+            "Keep up to this many spare paths built ahead of time, so new endpoints can start",
+            "sending without waiting for their own paths to build. 0 turns the pool off.",
+        },
+        [this](int arg) {
+          if (arg < 0 or arg > 32)
+            throw std::invalid_argument("[network]:path-pool-max must be >= 0 and <= 32");
+          m_PathPoolMax = arg;
+        });
+
+    conf.defineOption<int>(
+        "network",
+        "path-pool-min",
+        ClientOnly,
+        Default{0},
+        Comment{
+            "Refill the spare path pool once it drops below this many paths.",
+            "0 means half of path-pool-max.",
+        },
+        [this](int arg) {
+          if (arg < 0 or arg > 32)
+            throw std::invalid_argument("[network]:path-pool-min must be >= 0 and <= 32");
+          m_PathPoolMin = arg;
+        });
+
+    conf.defineOption<int>(
+        "network",
+        "multipath",
+        ClientOnly,
+        Default{1},
+        Comment{
+            "Spread traffic to each remote address over up to this many of its introductions,",
+            "so one bulk transfer can use the bandwidth of several paths. 1 sends everything",
+            "down one path.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 8)
+            throw std::invalid_argument("[network]:multipath must be >= 1 and <= 8");
+          m_Multipath = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "repair-frames",
+        ClientOnly,
+        Default{true},
+        AssignmentAcceptor(m_RepairFrames),
+        Comment{
+            "Follow each group of messages sent down a path that loses traffic with a repair",
+            "message, from which the remote rebuilds one lost message of the group without",
+            "waiting a round trip for a resend. Groups get smaller as loss goes up.",
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "compress",
+        ClientOnly,
+        Default{false},
+        AssignmentAcceptor(m_Compress),
+        Comment{
+            "Compress traffic to remote addresses that take it before it is encrypted, so",
+            "text such as web pages takes fewer cells. A convo whose traffic does not get",
+            "smaller stops trying for a while. Not used on paths that get repair messages.",
+        });
+
+    conf.defineOption<int>(
+        "network",
+        "lookup-fanout",
+        ClientOnly,
+        Default{2},
+        Comment{
+            "How many of the routers storing a remote address's introset to ask for it at",
+            "once. The first good answer is used and the rest are dropped. Relays agree on",
+            "which routers those are, so the first is nearly always right. Min 1, max 4.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 4)
+            throw std::invalid_argument("[network]:lookup-fanout must be >= 1 and <= 4");
+          m_LookupFanout = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "warm-restart",
+        ClientOnly,
+        Default{false},
+        AssignmentAcceptor(m_WarmRestart),
+        Comment{
+            "Save the introsets of the remotes we have sessions with and our first hops when",
+            "stopping, encrypted to our keyfile, and start from them on the next run so traffic",
+            "flows sooner. Needs a keyfile.",
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "aggregate-introsets",
+        ClientOnly,
+        Default{false},
+        AssignmentAcceptor(m_AggregateIntroSets),
+        Comment{
+            "Set on every instance of a service that runs on more than one lokinet with the",
+            "same keyfile. Each then looks up the introset for our address now and then and",
+            "publishes the intros of the others beside its own, so clients spread new",
+            "sessions over all of them.",
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "dns-prefetch",
+        ClientOnly,
+        Default{true},
+        AssignmentAcceptor(m_DNSPrefetch),
+        Comment{
+            "When a .loki or .snode name is resolved, start looking up the remote and building",
+            "paths to it right away, so the connection that usually follows finds them ready.",
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "lazy-start",
+        ClientOnly,
+        Default{false},
+        AssignmentAcceptor(m_LazyStart),
+        Comment{
+            "Build no paths until something first looks up or sends to a remote through this",
+            "endpoint. Starts sooner and costs nothing while unused, but the endpoint publishes",
+            "no introset and cannot be reached until then.",
+        });
+
     conf.defineOption<bool>(
         "network",
         "exit",
@@ -396,6 +795,39 @@ namespace llarp
             "on the server and may pose liability concerns. Enable at your own risk.",
         });
 
+    conf.defineOption<int>(
+        "network",
+        "exit-batch-delay",
+        ClientOnly,
+        Default{0},
+        Hidden,
+        Comment{
+            "Milliseconds exit traffic may wait for more packets to share its message, both on",
+            "an exit and on a client talking to one. 0 only packs together what is sent in the",
+            "same pass of the event loop.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("exit-batch-delay must be >= 0");
+          m_ExitBatchDelay = std::chrono::milliseconds{arg};
+        });
+
+    conf.defineOption<int>(
+        "network",
+        "exit-capacity",
+        ClientOnly,
+        Default{0},
+        Comment{
+            "Mbit/s this exit can carry, published with its introset so clients with more than",
+            "one exit for a range send more of their flows to the ones that can take them.",
+            "0 publishes nothing.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("exit-capacity must be >= 0");
+          m_ExitCapacity = arg;
+        });
+
     // TODO: not implemented yet!
     // TODO: define the order of precedence (e.g. is whitelist applied before blacklist?)
     //       additionally, what's default? What if I don't whitelist anything?
@@ -515,6 +947,32 @@ namespace llarp
           }
         });
 
+    conf.defineOption<int>(
+        "network",
+        "tun-queues",
+        Default{1},
+        Hidden,
+        Comment{
+            "Linux only: open the interface with this many queues so the kernel spreads flows",
+            "over them instead of funneling everything through one.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 64)
+            throw std::invalid_argument("[network]:tun-queues must be between 1 and 64");
+          m_TunQueues = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "tun-offload",
+        Default{false},
+        Hidden,
+        AssignmentAcceptor(m_TunOffload),
+        Comment{
+            "Linux only: let the kernel hand tcp segmentation to lokinet so one read off the",
+            "interface can carry many packets.",
+        });
+
     // TODO: could be useful for snodes in the future, but currently only implemented for clients:
     conf.defineOption<std::string>(
         "network",
@@ -646,6 +1104,21 @@ namespace llarp
           }
         });
 
+    conf.defineOption<int>(
+        "dns",
+        "upstream-contexts",
+        Default{1},
+        Hidden,
+        Comment{
+            "How many unbound contexts upstream lookups are spread over, by name. More can",
+            "resolve for many clients at once where one would hold lookups up.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument("[dns]:upstream-contexts must be at least 1");
+          m_UpstreamContexts = arg;
+        });
+
     conf.defineOption<std::string>(
         "dns",
         "bind",
@@ -701,6 +1174,8 @@ namespace llarp
         int asNum = std::atoi(str.data());
         if (asNum > 0)
           info.port = asNum;
+        else if (str == "xdp")
+          info.xdp = true;
 
         // otherwise, ignore ("future-proofing")
       }
@@ -739,6 +1214,11 @@ namespace llarp
             "Typically this section can be left blank: if no inbound bind addresses are",
             "configured then lokinet will search for a local network interface with a public",
             "IP address and use that (with port 1090).",
+            "",
+            "Dedicated relays on Linux can add ',xdp' to an interface, as in eth0=1090,xdp, to",
+            "read link traffic with AF_XDP instead of through the kernel udp stack. This needs a",
+            "lokinet built with WITH_XDP and the CAP_NET_ADMIN, CAP_NET_RAW and CAP_BPF",
+            "capabilities; lokinet falls back to the regular socket when it is unavailable.",
         });
 
     conf.defineOption<std::string>(
@@ -946,6 +1426,7 @@ namespace llarp
             "  file - plaintext formatting",
             "  json - json-formatted log statements",
             "  syslog - logs directed to syslog",
+            "  binary - unformatted records for contrib/py/logdecode, needs a file",
         });
 
     conf.defineOption<std::string>(
@@ -1020,6 +1501,8 @@ namespace llarp
   bool
   Config::Load(std::optional<fs::path> fname, bool isRelay)
   {
+    m_Filename = fname;
+    m_IsRelay = isRelay;
     if (not fname.has_value())
       return LoadDefault(isRelay);
     try
@@ -1056,6 +1539,47 @@ namespace llarp
     }
   }
 
+  std::shared_ptr<Config>
+  Config::Reload() const
+  {
+    if (not m_Filename.has_value())
+      return nullptr;
+    auto conf = std::make_shared<Config>(m_DataDir);
+    if (not conf->Load(m_Filename, m_IsRelay))
+      return nullptr;
+    return conf;
+  }
+
+  std::vector<std::string>
+  Config::ChangedOptions(const Config& other) const
+  {
+    // an option can be given more than once so each is compared as the set of its values
+    using Options_t = std::map<std::string, std::multiset<std::string>>;
+    const auto collect = [](const ConfigParser& parser) {
+      Options_t options;
+      parser.IterAll([&](std::string_view section, const SectionValues_t& values) {
+        for (const auto& [key, value] : values)
+          options[stringify(section, ":", key)].insert(value);
+      });
+      return options;
+    };
+    const auto ours = collect(m_Parser);
+    const auto theirs = collect(other.m_Parser);
+    std::vector<std::string> changed;
+    for (const auto& [name, values] : ours)
+    {
+      const auto itr = theirs.find(name);
+      if (itr == theirs.end() or itr->second != values)
+        changed.push_back(name);
+    }
+    for (const auto& [name, values] : theirs)
+    {
+      if (ours.count(name) == 0)
+        changed.push_back(name);
+    }
+    return changed;
+  }
+
   bool
   Config::LoadDefault(bool isRelay)
   {
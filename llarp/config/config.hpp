@@ -5,10 +5,12 @@
 #include <crypto/types.hpp>
 #include <router_contact.hpp>
 #include <util/fs.hpp>
+#include <util/padding.hpp>
 #include <util/str.hpp>
 #include <config/ini.hpp>
 #include <config/definition.hpp>
 #include <constants/files.hpp>
+#include <constants/link_layer.hpp>
 #include <net/ip_address.hpp>
 #include <net/net_int.hpp>
 #include <net/ip_range_map.hpp>
@@ -51,9 +53,32 @@ namespace llarp
 
     bool m_blockBogons = false;
 
+    bool m_udpOffload = true;
+    bool m_ioUring = false;
+    std::chrono::microseconds m_busyPoll = 0us;
+    int m_loopCpu = -1;
+
+    std::optional<fs::path> m_captureFile;
+    bool m_captureKeys = false;
+    bool m_aesGCM = true;
+
+    size_t m_linkSockets = 1;
+
+    bool m_hugePages = false;
+    bool m_numaLocal = false;
+    std::vector<int> m_cpuAffinity;
+    padding::Profile m_linkPadding = padding::DefaultProfile;
+
+    std::chrono::milliseconds m_ackDelay = DefaultAckDelay;
+    size_t m_ackBudget = DefaultAckBudget;
+    std::chrono::milliseconds m_cellBatchDelay = 0ms;
+    std::chrono::milliseconds m_cellBundleDelay = 0ms;
+
     IpAddress m_publicAddress;
 
     int m_workerThreads = -1;
+    /// lokimq's general threads, which only rpc and lokid work runs on
+    int m_rpcThreads = 2;
     int m_numNetThreads = -1;
 
     size_t m_JobQueueSize = 0;
@@ -75,13 +100,28 @@ namespace llarp
     std::string m_strictConnect;
     std::string m_ifname;
     IPRange m_ifaddr;
+    int m_TunQueues = 1;
+    bool m_TunOffload = false;
 
     std::optional<fs::path> m_keyfile;
     std::string m_endpointType;
     bool m_reachable = false;
     std::optional<int> m_Hops;
     std::optional<int> m_Paths;
+    padding::Profile m_Padding = padding::DefaultProfile;
+    int m_PathPoolMin = 0;
+    int m_PathPoolMax = 0;
+    int m_Multipath = 1;
+    bool m_RepairFrames = true;
+    bool m_Compress = false;
+    int m_LookupFanout = 2;
+    bool m_WarmRestart = false;
+    bool m_AggregateIntroSets = false;
+    bool m_DNSPrefetch = true;
+    bool m_LazyStart = false;
     bool m_AllowExit = false;
+    std::chrono::milliseconds m_ExitBatchDelay = 0ms;
+    int m_ExitCapacity = 0;
     std::set<RouterID> m_snodeBlacklist;
     net::IPRangeMap<service::Address> m_ExitMap;
     net::IPRangeMap<std::string> m_LNSExitMap;
@@ -111,6 +151,7 @@ namespace llarp
   {
     IpAddress m_bind;
     std::vector<IpAddress> m_upstreamDNS;
+    int m_UpstreamContexts = 1;
 
     void
     defineConfigOptions(ConfigDefinition& conf, const ConfigGenParameters& params);
@@ -123,6 +164,8 @@ namespace llarp
       std::string interface;
       int addressFamily = -1;
       uint16_t port = -1;
+      /// read with AF_XDP, only on interfaces
+      bool xdp = false;
     };
     /// Create a LinkInfo from the given string.
     /// @throws if str does not represent a LinkInfo.
@@ -224,6 +267,15 @@ namespace llarp
     void
     Override(std::string section, std::string key, std::string value);
 
+    /// read the file this was loaded from again into a new Config, nullptr if it was not
+    /// loaded from a file or no longer parses
+    std::shared_ptr<Config>
+    Reload() const;
+
+    /// "section:key" of every option whose values in the file differ between this and other
+    std::vector<std::string>
+    ChangedOptions(const Config& other) const;
+
    private:
     /// Load (initialize) a default config.
     ///
@@ -244,6 +296,8 @@ namespace llarp
 
     ConfigParser m_Parser;
     const fs::path m_DataDir;
+    std::optional<fs::path> m_Filename;
+    bool m_IsRelay = false;
   };
 
   void
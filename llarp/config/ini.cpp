@@ -121,7 +121,8 @@ namespace llarp
   }
 
   void
-  ConfigParser::IterAll(std::function<void(std::string_view, const SectionValues_t&)> visit)
+  ConfigParser::IterAll(
+      std::function<void(std::string_view, const SectionValues_t&)> visit) const
   {
     for (const auto& item : m_Config)
       visit(item.first, item.second);
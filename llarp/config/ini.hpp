@@ -33,7 +33,7 @@ namespace llarp
 
     /// iterate all sections and thier values
     void
-    IterAll(std::function<void(std::string_view, const SectionValues_t&)> visit);
+    IterAll(std::function<void(std::string_view, const SectionValues_t&)> visit) const;
 
     /// visit a section in config read only by name
     /// return false if no section or value propagated from visitor
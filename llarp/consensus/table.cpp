@@ -1,15 +1,122 @@
 #include <consensus/table.hpp>
 #include <crypto/crypto.hpp>
 
+#include <algorithm>
+
 namespace llarp
 {
   namespace consensus
   {
+    /// the keep threshold of a slot that is always drawn as itself
+    static constexpr uint64_t KeepAll = uint64_t{1} << 32;
+
+    Table::Table(std::vector<Entry> entries)
+    {
+      std::stable_sort(entries.begin(), entries.end(), [](const auto& left, const auto& right) {
+        return left.router < right.router;
+      });
+      entries.erase(
+          std::unique(
+              entries.begin(),
+              entries.end(),
+              [](const auto& left, const auto& right) { return left.router == right.router; }),
+          entries.end());
+      m_Entries = std::move(entries);
+      const size_t sz = m_Entries.size();
+      if (sz == 0)
+        return;
+
+      uint64_t total = 0;
+      for (size_t idx = 0; idx < sz; ++idx)
+      {
+        auto& entry = m_Entries[idx];
+        entry.weight = std::max(entry.weight, uint32_t{1});
+        total += entry.weight;
+        m_Index.emplace(entry.router, idx);
+      }
+
+      // each slot holds sz * weight / total of a draw, those over 1 fill the ones under it
+      std::vector<double> share(sz);
+      std::vector<uint32_t> under;
+      std::vector<uint32_t> over;
+      for (size_t idx = 0; idx < sz; ++idx)
+      {
+        share[idx] = double(m_Entries[idx].weight) * double(sz) / double(total);
+        (share[idx] < 1.0 ? under : over).push_back(idx);
+      }
+      m_Keep.assign(sz, KeepAll);
+      m_Alias.resize(sz);
+      for (size_t idx = 0; idx < sz; ++idx)
+        m_Alias[idx] = idx;
+      while (not under.empty() and not over.empty())
+      {
+        const auto small = under.back();
+        under.pop_back();
+        const auto large = over.back();
+        m_Keep[small] = uint64_t(share[small] * double(KeepAll));
+        m_Alias[small] = large;
+        share[large] -= 1.0 - share[small];
+        if (share[large] < 1.0)
+        {
+          over.pop_back();
+          under.push_back(large);
+        }
+      }
+      // whatever is left is 1 give or take rounding and keeps its whole slot
+    }
+
+    uint32_t
+    Table::Weight(const RouterID& router) const
+    {
+      const auto itr = m_Index.find(router);
+      if (itr == m_Index.end())
+        return 0;
+      return m_Entries[itr->second].weight;
+    }
+
+    const RouterID&
+    Table::Pick() const
+    {
+      return Pick(randint());
+    }
+
+    const RouterID&
+    Table::Pick(uint64_t random) const
+    {
+      const size_t slot = (random & 0xffffffff) % m_Entries.size();
+      const uint64_t coin = random >> 32;
+      return m_Entries[coin < m_Keep[slot] ? slot : m_Alias[slot]].router;
+    }
+
+    std::vector<RouterID>
+    Table::Replicas(const AlignedBuffer<RouterID::SIZE>& location, size_t n) const
+    {
+      n = std::min(n, m_Entries.size());
+      std::vector<RouterID> replicas;
+      replicas.reserve(n);
+      auto itr = std::lower_bound(
+          m_Entries.begin(), m_Entries.end(), location, [](const auto& entry, const auto& loc) {
+            return entry.router.as_array() < loc.as_array();
+          });
+      while (replicas.size() < n)
+      {
+        if (itr == m_Entries.end())
+          itr = m_Entries.begin();
+        replicas.push_back(itr->router);
+        ++itr;
+      }
+      return replicas;
+    }
+
     ShortHash
     Table::CalculateHash() const
     {
+      std::vector<byte_t> routers;
+      routers.reserve(m_Entries.size() * RouterID::SIZE);
+      for (const auto& entry : m_Entries)
+        routers.insert(routers.end(), entry.router.begin(), entry.router.end());
       ShortHash h;
-      const llarp_buffer_t buf(begin()->data(), size());
+      const llarp_buffer_t buf(routers);
       CryptoManager::instance()->shorthash(h, buf);
       return h;
     }
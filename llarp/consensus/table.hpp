@@ -2,17 +2,89 @@
 #define LLARP_CONSENSUS_TABLE_HPP
 
 #include <crypto/types.hpp>
+#include <router_id.hpp>
+
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 namespace llarp
 {
   namespace consensus
   {
-    /// consensus table
-    struct Table : public std::vector<RouterID>
+    /// the service node list as lokid last gave it, each router with a weight. it is never
+    /// changed once made, so it is handed around as a shared_ptr to const and read from any
+    /// thread without a lock. a router is drawn in proportion to its weight in constant time
+    /// with walker's alias method
+    struct Table
     {
+      struct Entry
+      {
+        RouterID router;
+        /// how many times as often as a weight 1 router it is drawn, 0 is taken as 1
+        uint32_t weight = 1;
+      };
+
+      Table() = default;
+
+      /// a router given more than once is kept once, with the first weight given for it
+      explicit Table(std::vector<Entry> entries);
+
+      size_t
+      Size() const
+      {
+        return m_Entries.size();
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Entries.empty();
+      }
+
+      bool
+      Contains(const RouterID& router) const
+      {
+        return m_Index.count(router) != 0;
+      }
+
+      /// 0 for a router that is not in it
+      uint32_t
+      Weight(const RouterID& router) const;
+
+      /// every entry, sorted by router
+      const std::vector<Entry>&
+      Entries() const
+      {
+        return m_Entries;
+      }
+
+      /// a router drawn in proportion to its weight, must not be Empty()
+      const RouterID&
+      Pick() const;
+
+      /// a router drawn with the 64 random bits given, Pick with those bits made for it
+      const RouterID&
+      Pick(uint64_t random) const;
+
+      /// the first n routers at or after location on the ring the sorted routers make, wrapping
+      /// from the last to the first, fewer if it has fewer. everyone with the same list picks
+      /// the same ones for a location, however much of the network they have heard of, so
+      /// where an introset is stored and where it is looked for agree
+      std::vector<RouterID>
+      Replicas(const AlignedBuffer<RouterID::SIZE>& location, size_t n) const;
+
+      /// hash of the routers in it, the same for the same list whatever order it came in
       ShortHash
       CalculateHash() const;
+
+     private:
+      std::vector<Entry> m_Entries;
+      std::unordered_map<RouterID, size_t, RouterID::Hash> m_Index;
+      /// slot i is drawn as itself when the high 32 random bits are below m_Keep[i] and as
+      /// m_Alias[i] otherwise
+      std::vector<uint64_t> m_Keep;
+      std::vector<uint32_t> m_Alias;
     };
   }  // namespace consensus
 }  // namespace llarp
@@ -4,4 +4,12 @@ namespace llarp
 {
   /// default queue length for logic jobs
   constexpr std::size_t event_loop_queue_size = 1024;
+
+  /// max number of datagrams we read or write per udp syscall when batching
+  constexpr std::size_t udp_batch_size = 16;
+
+  /// max number of datagrams the kernel will split a single segmented udp send into
+  constexpr std::size_t udp_max_segments = 64;
+  /// max size of a single segmented udp send
+  constexpr std::size_t udp_max_segmented_size = 65000;
 }  // namespace llarp
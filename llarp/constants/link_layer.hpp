@@ -8,4 +8,10 @@
 constexpr size_t MAX_LINK_MSG_SIZE = 8192;
 static constexpr auto DefaultLinkSessionLifetime = 1min;
 constexpr size_t MaxSendQueueSize = 1024;
+/// how long a session holds acks so it can send them in one datagram
+static constexpr auto DefaultAckDelay = 5ms;
+/// how many acks a session holds before it sends them anyways
+constexpr size_t DefaultAckBudget = 32;
+/// while a client is idle its timers wait for the next multiple of this so they wake together
+static constexpr auto IdleWakeupWindow = 10s;
 #endif
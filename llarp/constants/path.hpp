@@ -27,16 +27,26 @@ namespace llarp
     /// spread, above, should be able to maintain more than this number of paths
     /// normally once things are going).
     constexpr std::size_t min_intro_paths = 4;
+    /// paths kept per path set while the router is idle
+    constexpr std::size_t idle_min_paths = 2;
     /// after this many ms a path build times out
     constexpr auto build_timeout = 30s;
 
-    /// measure latency every this interval ms
+    /// rtt measured longer ago than this is stale on a path carrying traffic
     constexpr auto latency_interval = 20s;
+    /// a path carrying nothing is probed this often to see that it is still up
+    constexpr auto idle_latency_interval = 60s;
+    /// a latency probe unanswered this long, with nothing else heard on the path, means it's dead
+    constexpr auto latency_timeout = 10s;
     /// if a path is inactive for this amount of time it's dead
     constexpr auto alive_timeout = latency_interval * 1.5;
 
     /// how big transit hop traffic queues are
     constexpr std::size_t transit_hop_queue_size = 256;
+    /// how many nonces per direction a hop's replay filter holds before it starts forgetting
+    constexpr std::size_t replay_filter_capacity = 1024;
+    /// odds a fresh nonce is dropped as a replay
+    constexpr double replay_filter_fp_rate = 1e-5;
 
   }  // namespace path
 }  // namespace llarp
@@ -6,6 +6,7 @@
 #include <dht/context.hpp>
 #include <ev/ev.hpp>
 #include <ev/vpnio.hpp>
+#include <handlers/embedded.hpp>
 #include <nodedb.hpp>
 #include <router/router.hpp>
 #include <service/context.hpp>
@@ -27,6 +28,15 @@ namespace llarp
     return logic && LogicCall(logic, f);
   }
 
+  std::shared_ptr<handlers::EmbeddedEndpoint>
+  Context::GetEmbeddedEndpoint(const std::string& name) const
+  {
+    if (router == nullptr)
+      return nullptr;
+    return std::dynamic_pointer_cast<handlers::EmbeddedEndpoint>(
+        router->hiddenServiceContext().GetEndpointByName(name));
+  }
+
   void
   Context::Configure(Config conf)
   {
@@ -68,6 +78,8 @@ namespace llarp
 
     llarp::LogInfo(llarp::VERSION_FULL, " ", llarp::RELEASE_MOTTO);
     llarp::LogInfo("starting up");
+    using Clock_t = std::chrono::steady_clock;
+    const auto started = Clock_t::now();
     if (mainloop == nullptr)
     {
       auto jobQueueSize = std::max(event_loop_queue_size, config->router.m_JobQueueSize);
@@ -85,14 +97,30 @@ namespace llarp
     nodedb = std::make_unique<llarp_nodedb>(
         nodedb_dir, [r = router.get()](auto call) { r->QueueDiskIO(std::move(call)); });
 
+    const auto configureStarted = Clock_t::now();
     if (!router->Configure(config, opts.isRouter, nodedb.get()))
       throw std::runtime_error("Failed to configure router");
 
     // must be done after router is made so we can use its disk io worker
     // must also be done after configure so that netid is properly set if it
     // is provided by config
+    const auto loadStarted = Clock_t::now();
     if (!this->LoadDatabase())
       throw std::runtime_error("Config::Setup() failed to load database");
+
+    const auto ms = [](auto dlt) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(dlt);
+    };
+    llarp::LogInfo(
+        "setup took ",
+        ms(Clock_t::now() - started),
+        ": ",
+        ms(configureStarted - started),
+        " making the router, ",
+        ms(loadStarted - configureStarted),
+        " configuring it, ",
+        ms(Clock_t::now() - loadStarted),
+        " loading the nodedb");
   }
 
   std::unique_ptr<AbstractRouter>
@@ -235,6 +263,55 @@ extern "C"
     return w->queue.pushBack(std::move(pkt)) == llarp::thread::QueueReturn::Success;
   }
 
+  static_assert(LLARP_VPN_PACKET_SLOT_SIZE == llarp::net::IPPacket::MaxSize);
+
+  ssize_t
+  llarp_vpn_io_readpkts(
+      struct llarp_vpn_pkt_reader* r, unsigned char* slots, uint32_t* lens, size_t numslots)
+  {
+    if (r == nullptr or slots == nullptr or lens == nullptr or numslots == 0)
+      return -1;
+    if (not r->queue.enabled())
+      return -1;
+    size_t num = 0;
+    auto copyOut = [&](const llarp_vpn_pkt_queue::Packet_t& pkt) {
+      std::copy_n(pkt.buf, pkt.sz, slots + (num * LLARP_VPN_PACKET_SLOT_SIZE));
+      lens[num] = pkt.sz;
+      ++num;
+    };
+    r->queue.popFrontWith(copyOut);
+    while (num < numslots and r->queue.tryPopFrontWith(copyOut))
+      ;
+    return num;
+  }
+
+  ssize_t
+  llarp_vpn_io_writepkts(
+      struct llarp_vpn_pkt_writer* w,
+      const unsigned char* slots,
+      const uint32_t* lens,
+      size_t numpkts)
+  {
+    if (w == nullptr or slots == nullptr or lens == nullptr)
+      return -1;
+    size_t num = 0;
+    for (; num < numpkts; ++num)
+    {
+      const auto sz = lens[num];
+      if (sz == 0 or sz > LLARP_VPN_PACKET_SLOT_SIZE)
+        continue;
+      const auto* pkt = slots + (num * LLARP_VPN_PACKET_SLOT_SIZE);
+      const auto ret =
+          w->queue.tryEmplaceBackWith([pkt, sz](llarp_vpn_pkt_queue::Packet_t& slot) {
+            slot.sz = sz;
+            std::copy_n(pkt, sz, slot.buf);
+          });
+      if (ret != llarp::thread::QueueReturn::Success)
+        break;
+    }
+    return num;
+  }
+
   bool
   llarp_main_inject_vpn_by_name(
       llarp::Context* ctx,
@@ -16,6 +16,8 @@ static constexpr uint32_t SIGSIZE = 64;
 static constexpr uint32_t TUNNONCESIZE = 32;
 static constexpr uint32_t HMACSIZE = 32;
 static constexpr uint32_t PATHIDSIZE = 16;
+static constexpr uint32_t GCMTAGSIZE = 16;
+static constexpr uint32_t GCMNONCESIZE = 12;
 
 static constexpr uint32_t PQ_CIPHERTEXTSIZE = crypto_kem_CIPHERTEXTBYTES;
 static constexpr uint32_t PQ_PUBKEYSIZE = crypto_kem_PUBLICKEYBYTES;
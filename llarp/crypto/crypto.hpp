@@ -19,6 +19,22 @@
 
 namespace llarp
 {
+  /// a region of memory handed to a batched crypto call
+  struct CryptoSpan
+  {
+    byte_t* base;
+    size_t sz;
+  };
+
+  /// one ed25519 signature handed to a batched verify
+  struct SignatureCheck
+  {
+    const PubKey* pubkey;
+    const byte_t* msg;
+    size_t sz;
+    const Signature* sig;
+  };
+
   /// library crypto configuration
   struct Crypto
   {
@@ -37,12 +53,54 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher in place over num buffers that share one key, bufs[i] uses
+    /// nonces[i], gives a backend the whole batch so it can interleave the streams
+    virtual bool
+    xchacha20_batch(
+        const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret&) = 0;
+
+    /// true when aes-256-gcm runs on cpu instructions for it here, the aes256gcm calls fail
+    /// otherwise
+    virtual bool
+    aes256gcm_available() = 0;
+
+    /// aes-256-gcm in place over num buffers that share one key. bufs[i] uses the first
+    /// GCMNONCESIZE bytes of nonces[i], ads[i] is authenticated along with it and the tag goes
+    /// in tags[i]
+    virtual bool
+    aes256gcm_seal_batch(
+        const CryptoSpan* bufs,
+        const CryptoSpan* ads,
+        const TunnelNonce* nonces,
+        GCMTag* tags,
+        size_t num,
+        const SharedSecret&) = 0;
+
+    /// opens what aes256gcm_seal_batch sealed, sets valid[i] for bufs[i], return true if all of
+    /// them are valid. a buffer that is not valid is left zeroed
+    virtual bool
+    aes256gcm_open_batch(
+        const CryptoSpan* bufs,
+        const CryptoSpan* ads,
+        const TunnelNonce* nonces,
+        const GCMTag* tags,
+        size_t num,
+        const SharedSecret&,
+        bool* valid) = 0;
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
     /// path dh relay side
     virtual bool
     dh_server(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
+    /// the part of dh_client that only depends on the two keys, dh_client is the hmac of
+    /// its nonce keyed with this
+    virtual bool
+    dh_client_static(SharedSecret&, const PubKey&, const SecretKey&) = 0;
+    /// the part of dh_server that only depends on the two keys
+    virtual bool
+    dh_server_static(SharedSecret&, const PubKey&, const SecretKey&) = 0;
     /// transport dh client side
     virtual bool
     transport_dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
@@ -55,6 +113,9 @@ namespace llarp
     /// blake2s 256 bit "hmac" (keyed hash)
     virtual bool
     hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) = 0;
+    /// keyed hash of num buffers that share one key, the hash of bufs[i] goes in results[i]
+    virtual bool
+    hmac_batch(ShortHash* results, const CryptoSpan* bufs, size_t num, const SharedSecret&) = 0;
     /// ed25519 sign
     virtual bool
     sign(Signature&, const SecretKey&, const llarp_buffer_t&) = 0;
@@ -64,6 +125,10 @@ namespace llarp
     /// ed25519 verify
     virtual bool
     verify(const PubKey&, const llarp_buffer_t&, const Signature&) = 0;
+    /// ed25519 verify num signatures, sets valid[i] for checks[i], return true if all of
+    /// them are valid
+    virtual bool
+    verify_batch(const SignatureCheck* checks, size_t num, bool* valid) = 0;
 
     /// derive sub keys for public keys
     virtual bool
@@ -1,4 +1,5 @@
 #include <crypto/crypto_libsodium.hpp>
+#include <crypto/xchacha20_lanes.hpp>
 #include <sodium/crypto_generichash.h>
 #include <sodium/crypto_sign.h>
 #include <sodium/crypto_scalarmult.h>
@@ -6,11 +7,13 @@
 #include <sodium/crypto_stream_xchacha20.h>
 #include <sodium/crypto_core_ed25519.h>
 #include <sodium/crypto_aead_xchacha20poly1305.h>
+#include <sodium/crypto_aead_aes256gcm.h>
 #include <sodium/randombytes.h>
 #include <sodium/utils.h>
 #include <util/mem.hpp>
 #include <util/endian.hpp>
 #include <util/str.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -128,13 +131,6 @@ namespace llarp
       return result;
     }
 
-    bool
-    CryptoLibSodium::xchacha20(
-        const llarp_buffer_t& buff, const SharedSecret& k, const TunnelNonce& n)
-    {
-      return crypto_stream_xchacha20_xor(buff.base, buff.base, buff.sz, n.data(), k.data()) == 0;
-    }
-
     bool
     CryptoLibSodium::xchacha20_alt(
         const llarp_buffer_t& out, const llarp_buffer_t& in, const SharedSecret& k, const byte_t* n)
@@ -144,6 +140,104 @@ namespace llarp
       return crypto_stream_xchacha20_xor(out.base, in.base, in.sz, n, k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_batch(
+        const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k)
+    {
+      // libsodium has no multi stream xchacha, so batches go through our own lanes kernel
+      if (num > 1)
+      {
+        xchacha20_kernel().run(bufs, nonces, num, k);
+        return true;
+      }
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        ok &= crypto_stream_xchacha20_xor(
+                  bufs[idx].base, bufs[idx].base, bufs[idx].sz, nonces[idx].data(), k.data())
+            == 0;
+      }
+      return ok;
+    }
+
+    bool
+    CryptoLibSodium::aes256gcm_available()
+    {
+      return crypto_aead_aes256gcm_is_available() == 1;
+    }
+
+    bool
+    CryptoLibSodium::aes256gcm_seal_batch(
+        const CryptoSpan* bufs,
+        const CryptoSpan* ads,
+        const TunnelNonce* nonces,
+        GCMTag* tags,
+        size_t num,
+        const SharedSecret& k)
+    {
+      static_assert(GCMTag::SIZE == crypto_aead_aes256gcm_ABYTES);
+      static_assert(GCMNONCESIZE == crypto_aead_aes256gcm_NPUBBYTES);
+      if (not aes256gcm_available())
+        return false;
+      crypto_aead_aes256gcm_state state;
+      crypto_aead_aes256gcm_beforenm(&state, k.data());
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        ok &= crypto_aead_aes256gcm_encrypt_detached_afternm(
+                  bufs[idx].base,
+                  tags[idx].data(),
+                  nullptr,
+                  bufs[idx].base,
+                  bufs[idx].sz,
+                  ads[idx].base,
+                  ads[idx].sz,
+                  nullptr,
+                  nonces[idx].data(),
+                  &state)
+            == 0;
+      }
+      sodium_memzero(&state, sizeof(state));
+      return ok;
+    }
+
+    bool
+    CryptoLibSodium::aes256gcm_open_batch(
+        const CryptoSpan* bufs,
+        const CryptoSpan* ads,
+        const TunnelNonce* nonces,
+        const GCMTag* tags,
+        size_t num,
+        const SharedSecret& k,
+        bool* valid)
+    {
+      if (not aes256gcm_available())
+      {
+        std::fill_n(valid, num, false);
+        return false;
+      }
+      crypto_aead_aes256gcm_state state;
+      crypto_aead_aes256gcm_beforenm(&state, k.data());
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        valid[idx] = crypto_aead_aes256gcm_decrypt_detached_afternm(
+                         bufs[idx].base,
+                         nullptr,
+                         bufs[idx].base,
+                         bufs[idx].sz,
+                         tags[idx].data(),
+                         ads[idx].base,
+                         ads[idx].sz,
+                         nonces[idx].data(),
+                         &state)
+            == 0;
+        ok &= valid[idx];
+      }
+      sodium_memzero(&state, sizeof(state));
+      return ok;
+    }
+
     bool
     CryptoLibSodium::dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
@@ -157,6 +251,19 @@ namespace llarp
     {
       return dh_server_priv(shared, pk, sk, n);
     }
+    bool
+    CryptoLibSodium::dh_client_static(
+        llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk)
+    {
+      return dh(shared, sk.toPublic(), pk, pk.data(), sk);
+    }
+
+    bool
+    CryptoLibSodium::dh_server_static(
+        llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk)
+    {
+      return dh(shared, pk, sk.toPublic(), pk.data(), sk);
+    }
     /// transport dh client side
     bool
     CryptoLibSodium::transport_dh_client(
@@ -173,19 +280,23 @@ namespace llarp
     }
 
     bool
-    CryptoLibSodium::shorthash(ShortHash& result, const llarp_buffer_t& buff)
+    CryptoLibSodium::hmac_batch(
+        ShortHash* results, const CryptoSpan* bufs, size_t num, const SharedSecret& secret)
     {
-      return crypto_generichash_blake2b(
-                 result.data(), ShortHash::SIZE, buff.base, buff.sz, nullptr, 0)
-          != -1;
-    }
-
-    bool
-    CryptoLibSodium::hmac(byte_t* result, const llarp_buffer_t& buff, const SharedSecret& secret)
-    {
-      return crypto_generichash_blake2b(
-                 result, HMACSIZE, buff.base, buff.sz, secret.data(), HMACSECSIZE)
-          != -1;
+      static_assert(ShortHash::SIZE == HMACSIZE);
+      bool ok = true;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        ok &= crypto_generichash_blake2b(
+                  results[idx].data(),
+                  HMACSIZE,
+                  bufs[idx].base,
+                  bufs[idx].sz,
+                  secret.data(),
+                  HMACSECSIZE)
+            != -1;
+      }
+      return ok;
     }
 
     static bool
@@ -250,6 +361,23 @@ namespace llarp
       return crypto_sign_verify_detached(sig.data(), buf.base, buf.sz, pub.data()) != -1;
     }
 
+    bool
+    CryptoLibSodium::verify_batch(const SignatureCheck* checks, size_t num, bool* valid)
+    {
+      // libsodium has no batch ed25519 verify, so this saves the virtual call per signature
+      // and bulk callers spread their batches over threads
+      bool all = true;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto& check = checks[idx];
+        valid[idx] = crypto_sign_verify_detached(
+                         check.sig->data(), check.msg, check.sz, check.pubkey->data())
+            != -1;
+        all &= valid[idx];
+      }
+      return all;
+    }
+
     /// clamp a 32 byte ec point
     static void
     clamp_ed25519(byte_t* out)
@@ -3,6 +3,9 @@
 
 #include <crypto/crypto.hpp>
 
+#include <sodium/crypto_generichash.h>
+#include <sodium/crypto_stream_xchacha20.h>
+
 namespace llarp
 {
   namespace sodium
@@ -30,12 +33,49 @@ namespace llarp
           const SharedSecret&,
           const byte_t*) override;
 
+      /// xchacha symmetric cipher over a batch of buffers
+      bool
+      xchacha20_batch(
+          const CryptoSpan* bufs,
+          const TunnelNonce* nonces,
+          size_t num,
+          const SharedSecret&) override;
+
+      bool
+      aes256gcm_available() override;
+
+      /// aes-256-gcm over a batch of buffers, the key is expanded once per batch
+      bool
+      aes256gcm_seal_batch(
+          const CryptoSpan* bufs,
+          const CryptoSpan* ads,
+          const TunnelNonce* nonces,
+          GCMTag* tags,
+          size_t num,
+          const SharedSecret&) override;
+
+      bool
+      aes256gcm_open_batch(
+          const CryptoSpan* bufs,
+          const CryptoSpan* ads,
+          const TunnelNonce* nonces,
+          const GCMTag* tags,
+          size_t num,
+          const SharedSecret&,
+          bool* valid) override;
+
       /// path dh creator's side
       bool
       dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
       /// path dh relay side
       bool
       dh_server(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
+      /// nonce free part of dh_client
+      bool
+      dh_client_static(SharedSecret&, const PubKey&, const SecretKey&) override;
+      /// nonce free part of dh_server
+      bool
+      dh_server_static(SharedSecret&, const PubKey&, const SecretKey&) override;
       /// transport dh client side
       bool
       transport_dh_client(
@@ -50,6 +90,10 @@ namespace llarp
       /// blake2s 256 bit hmac
       bool
       hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) override;
+      /// blake2s 256 bit hmac over a batch of buffers
+      bool
+      hmac_batch(
+          ShortHash* results, const CryptoSpan* bufs, size_t num, const SharedSecret&) override;
       /// ed25519 sign
       bool
       sign(Signature&, const SecretKey&, const llarp_buffer_t&) override;
@@ -59,6 +103,9 @@ namespace llarp
       /// ed25519 verify
       bool
       verify(const PubKey&, const llarp_buffer_t&, const Signature&) override;
+      /// ed25519 verify over a batch of signatures
+      bool
+      verify_batch(const SignatureCheck* checks, size_t num, bool* valid) override;
 
       /// derive sub keys for public keys.  hash is really only intended for
       /// testing and overrides key_n if given.
@@ -106,6 +153,31 @@ namespace llarp
       bool
       check_identity_privkey(const SecretKey&) override;
     };
+
+    // the per packet calls are here so HotCrypto callers can inline them
+
+    inline bool
+    CryptoLibSodium::xchacha20(
+        const llarp_buffer_t& buff, const SharedSecret& k, const TunnelNonce& n)
+    {
+      return crypto_stream_xchacha20_xor(buff.base, buff.base, buff.sz, n.data(), k.data()) == 0;
+    }
+
+    inline bool
+    CryptoLibSodium::shorthash(ShortHash& result, const llarp_buffer_t& buff)
+    {
+      return crypto_generichash_blake2b(
+                 result.data(), ShortHash::SIZE, buff.base, buff.sz, nullptr, 0)
+          != -1;
+    }
+
+    inline bool
+    CryptoLibSodium::hmac(byte_t* result, const llarp_buffer_t& buff, const SharedSecret& secret)
+    {
+      return crypto_generichash_blake2b(
+                 result, HMACSIZE, buff.base, buff.sz, secret.data(), HMACSECSIZE)
+          != -1;
+    }
   }  // namespace sodium
 
 }  // namespace llarp
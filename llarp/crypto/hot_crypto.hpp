@@ -0,0 +1,36 @@
+#ifndef LLARP_CRYPTO_HOT_CRYPTO_HPP
+#define LLARP_CRYPTO_HOT_CRYPTO_HPP
+
+#include <crypto/crypto.hpp>
+
+#ifdef LOKINET_STATIC_CRYPTO
+#include <crypto/crypto_libsodium.hpp>
+
+#include <cassert>
+#endif
+
+namespace llarp
+{
+  /// the crypto per packet work calls into. with LOKINET_STATIC_CRYPTO it is bound to
+  /// libsodium at compile time, so calls through it skip the vtable and the small ones inline.
+  /// only a CryptoLibSodium can be installed then, anything that mocks the crypto on these
+  /// paths needs a build without it
+#ifdef LOKINET_STATIC_CRYPTO
+  using HotCrypto_t = sodium::CryptoLibSodium;
+#else
+  using HotCrypto_t = Crypto;
+#endif
+
+  inline HotCrypto_t*
+  HotCrypto()
+  {
+#ifdef LOKINET_STATIC_CRYPTO
+    assert(dynamic_cast<sodium::CryptoLibSodium*>(CryptoManager::instance()));
+    return static_cast<HotCrypto_t*>(CryptoManager::instance());
+#else
+    return CryptoManager::instance();
+#endif
+  }
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,97 @@
+#include <crypto/key_cache.hpp>
+
+#include <crypto/crypto.hpp>
+
+namespace llarp
+{
+  EphemeralKeyCache::EphemeralKeyCache(size_t capacity, Worker_t worker)
+      : m_Capacity{capacity}, m_Worker{std::move(worker)}
+  {
+    m_Keys.reserve(m_Capacity);
+  }
+
+  EphemeralKeyCache::~EphemeralKeyCache()
+  {
+    for (auto& key : m_Keys)
+      key.Zero();
+  }
+
+  void
+  EphemeralKeyCache::Take(SecretKey& key)
+  {
+    bool got = false;
+    bool refill = false;
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      if (not m_Keys.empty())
+      {
+        key = m_Keys.back();
+        m_Keys.back().Zero();
+        m_Keys.pop_back();
+        m_Hits++;
+        got = true;
+        refill = m_Keys.size() <= m_Capacity / 2;
+      }
+      else
+      {
+        m_Misses++;
+        refill = true;
+      }
+    }
+    if (refill)
+      RequestRefill();
+    if (not got)
+      CryptoManager::instance()->encryption_keygen(key);
+  }
+
+  void
+  EphemeralKeyCache::RequestRefill()
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      if (m_Refilling or m_Keys.size() >= m_Capacity)
+        return;
+      m_Refilling = true;
+    }
+    m_Worker([this]() { Refill(); });
+  }
+
+  void
+  EphemeralKeyCache::Refill()
+  {
+    auto crypto = CryptoManager::instance();
+    for (;;)
+    {
+      // generate outside the lock so takers never wait on a keygen
+      SecretKey key;
+      crypto->encryption_keygen(key);
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      m_Generated++;
+      m_Keys.emplace_back(key);
+      key.Zero();
+      if (m_Keys.size() >= m_Capacity)
+      {
+        m_Refilling = false;
+        return;
+      }
+    }
+  }
+
+  size_t
+  EphemeralKeyCache::Size() const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return m_Keys.size();
+  }
+
+  util::StatusObject
+  EphemeralKeyCache::ExtractStatus() const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return util::StatusObject{{"capacity", uint64_t{m_Capacity}},
+                              {"ready", uint64_t{m_Keys.size()}},
+                              {"hits", m_Hits},
+                              {"misses", m_Misses},
+                              {"generated", m_Generated}};
+  }
+}  // namespace llarp
@@ -0,0 +1,61 @@
+#ifndef LLARP_CRYPTO_KEY_CACHE_HPP
+#define LLARP_CRYPTO_KEY_CACHE_HPP
+
+#include <crypto/types.hpp>
+#include <util/status.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace llarp
+{
+  /// ready made encryption keypairs for handshakes that want a fresh one each time
+  /// a worker tops the cache up once it runs low, so a burst of path builds takes keys out
+  /// instead of generating them in line
+  class EphemeralKeyCache
+  {
+   public:
+    using Work_t = std::function<void(void)>;
+    using Worker_t = std::function<void(Work_t)>;
+
+    /// worker queues the refill job, anything that outlives the cache must not run it
+    EphemeralKeyCache(size_t capacity, Worker_t worker);
+
+    ~EphemeralKeyCache();
+
+    EphemeralKeyCache(const EphemeralKeyCache&) = delete;
+    EphemeralKeyCache&
+    operator=(const EphemeralKeyCache&) = delete;
+
+    /// any thread, hands out a key nobody else gets, generating it here if we ran dry
+    void
+    Take(SecretKey& key);
+
+    /// ask for a refill, nothing happens if one is already queued
+    void
+    RequestRefill();
+
+    size_t
+    Size() const;
+
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    void
+    Refill();
+
+    const size_t m_Capacity;
+    Worker_t m_Worker;
+    mutable std::mutex m_Mutex;
+    std::vector<SecretKey> m_Keys;
+    bool m_Refilling = false;
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+    uint64_t m_Generated = 0;
+  };
+}  // namespace llarp
+
+#endif
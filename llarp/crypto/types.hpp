@@ -228,6 +228,7 @@ namespace llarp
   using TunnelNonce = AlignedBuffer<TUNNONCESIZE>;
   using SymmNonce = AlignedBuffer<NONCESIZE>;
   using SymmKey = AlignedBuffer<32>;
+  using GCMTag = AlignedBuffer<GCMTAGSIZE>;
 
   using PQCipherBlock = AlignedBuffer<PQ_CIPHERTEXTSIZE + 1>;
   using PQPubKey = AlignedBuffer<PQ_PUBKEYSIZE>;
@@ -0,0 +1,52 @@
+#include <crypto/verified_cache.hpp>
+
+#include <crypto/crypto.hpp>
+
+namespace llarp
+{
+  VerifiedCache::VerifiedCache(llarp_time_t interval, size_t capacity)
+      : m_Verified{interval, capacity}
+  {}
+
+  bool
+  VerifiedCache::Digest(ShortHash& digest, const llarp_buffer_t& buf)
+  {
+    return CryptoManager::instance()->shorthash(digest, buf);
+  }
+
+  bool
+  VerifiedCache::Contains(const ShortHash& digest, llarp_time_t now)
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    m_Verified.Decay(now);
+    if (m_Verified.Contains(digest))
+    {
+      m_Hits++;
+      return true;
+    }
+    m_Misses++;
+    return false;
+  }
+
+  void
+  VerifiedCache::Add(const ShortHash& digest, llarp_time_t now)
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    m_Verified.Insert(digest, now);
+  }
+
+  size_t
+  VerifiedCache::Size() const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return m_Verified.Size();
+  }
+
+  util::StatusObject
+  VerifiedCache::ExtractStatus() const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return util::StatusObject{
+        {"size", m_Verified.Size()}, {"hits", m_Hits}, {"misses", m_Misses}};
+  }
+}  // namespace llarp
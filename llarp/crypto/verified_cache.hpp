@@ -0,0 +1,47 @@
+#ifndef LLARP_CRYPTO_VERIFIED_CACHE_HPP
+#define LLARP_CRYPTO_VERIFIED_CACHE_HPP
+
+#include <crypto/types.hpp>
+#include <util/decaying_hashset.hpp>
+#include <util/status.hpp>
+
+#include <mutex>
+
+namespace llarp
+{
+  /// digests of signed objects whose signature and proof of work we already checked
+  /// an object seen again through republishing or lookups is answered by hashing its encoding
+  /// instead of verifying it. only what passed goes in, expiry checks stay with the caller
+  class VerifiedCache
+  {
+   public:
+    /// keep entries for interval, at most capacity of them
+    VerifiedCache(llarp_time_t interval, size_t capacity);
+
+    /// hash buf into the key this cache uses
+    static bool
+    Digest(ShortHash& digest, const llarp_buffer_t& buf);
+
+    /// any thread, true if digest was verified and has not decayed
+    bool
+    Contains(const ShortHash& digest, llarp_time_t now);
+
+    /// any thread, remember digest as verified
+    void
+    Add(const ShortHash& digest, llarp_time_t now);
+
+    size_t
+    Size() const;
+
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    mutable std::mutex m_Mutex;
+    util::DecayingHashSet<ShortHash> m_Verified;
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+  };
+}  // namespace llarp
+
+#endif
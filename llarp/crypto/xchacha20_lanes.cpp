@@ -0,0 +1,243 @@
+#include <crypto/xchacha20_lanes.hpp>
+
+#include <sodium/crypto_stream_chacha20.h>
+#include <util/endian.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace llarp
+{
+  namespace sodium
+  {
+    using v4u = uint32_t __attribute__((vector_size(16)));
+#if defined(__x86_64__) || defined(__i386__)
+    using v8u = uint32_t __attribute__((vector_size(32)));
+    using v16u = uint32_t __attribute__((vector_size(64)));
+#endif
+
+    static constexpr uint32_t Sigma[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+    template <typename V>
+    __attribute__((always_inline)) static inline void
+    quarter_round(V& a, V& b, V& c, V& d)
+    {
+      a += b;
+      d ^= a;
+      d = (d << 16) | (d >> 16);
+      c += d;
+      b ^= c;
+      b = (b << 12) | (b >> 20);
+      a += b;
+      d ^= a;
+      d = (d << 8) | (d >> 24);
+      c += d;
+      b ^= c;
+      b = (b << 7) | (b >> 25);
+    }
+
+    /// the chacha double rounds, over one word per lane, V is a plain uint32_t for one lane
+    template <typename V>
+    __attribute__((always_inline)) static inline void
+    chacha_rounds(V (&x)[16])
+    {
+      for (int round = 0; round < 10; ++round)
+      {
+        quarter_round(x[0], x[4], x[8], x[12]);
+        quarter_round(x[1], x[5], x[9], x[13]);
+        quarter_round(x[2], x[6], x[10], x[14]);
+        quarter_round(x[3], x[7], x[11], x[15]);
+        quarter_round(x[0], x[5], x[10], x[15]);
+        quarter_round(x[1], x[6], x[11], x[12]);
+        quarter_round(x[2], x[7], x[8], x[13]);
+        quarter_round(x[3], x[4], x[9], x[14]);
+      }
+    }
+
+    /// derive the chacha20 key for one xchacha20 stream from the first 16 bytes of its nonce
+    static void
+    hchacha20(byte_t* subkey, const byte_t* key, const byte_t* nonce)
+    {
+      uint32_t x[16];
+      std::copy_n(Sigma, 4, x);
+      for (int w = 0; w < 8; ++w)
+        x[4 + w] = le32toh(buf32toh(key + 4 * w));
+      for (int w = 0; w < 4; ++w)
+        x[12 + w] = le32toh(buf32toh(nonce + 4 * w));
+      chacha_rounds(x);
+      for (int w = 0; w < 4; ++w)
+      {
+        htole32buf(subkey + 4 * w, x[w]);
+        htole32buf(subkey + 16 + 4 * w, x[12 + w]);
+      }
+    }
+
+    /// one xchacha20 stream while it has a lane
+    struct Lane
+    {
+      byte_t* ptr = nullptr;
+      size_t left = 0;
+      const byte_t* nonce = nullptr;
+      byte_t subkey[32];
+    };
+
+    /// keep every lane busy with a stream, handing a lane the next buffer as soon as its
+    /// stream is done, so different sized buffers still fill the vector. once one stream is
+    /// left it finishes in libsodium, which is fast on long buffers by itself
+    template <typename V>
+    __attribute__((always_inline)) static inline void
+    run_lanes(const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k)
+    {
+      constexpr size_t N = sizeof(V) / sizeof(uint32_t);
+      Lane lanes[N];
+      // per lane state words 4 to 15, transposed so lane i is element i of each vector
+      V key[8] = {};
+      V ctrlo = {};
+      V ctrhi = {};
+      V n0 = {};
+      V n1 = {};
+      size_t next = 0;
+      size_t active = 0;
+
+      const auto refill = [&](size_t i) -> bool {
+        while (next < num)
+        {
+          const auto& buf = bufs[next];
+          const byte_t* nonce = nonces[next].data();
+          ++next;
+          if (buf.sz == 0)
+            continue;
+          auto& lane = lanes[i];
+          lane.ptr = buf.base;
+          lane.left = buf.sz;
+          lane.nonce = nonce;
+          hchacha20(lane.subkey, k.data(), nonce);
+          for (int w = 0; w < 8; ++w)
+            key[w][i] = le32toh(buf32toh(lane.subkey + 4 * w));
+          ctrlo[i] = 0;
+          ctrhi[i] = 0;
+          n0[i] = le32toh(buf32toh(nonce + 16));
+          n1[i] = le32toh(buf32toh(nonce + 20));
+          return true;
+        }
+        lanes[i].left = 0;
+        return false;
+      };
+
+      for (size_t i = 0; i < N; ++i)
+      {
+        if (refill(i))
+          ++active;
+      }
+
+      while (active > 1)
+      {
+        V in[16];
+        for (int w = 0; w < 4; ++w)
+          in[w] = V{} + Sigma[w];
+        std::copy_n(key, 8, in + 4);
+        in[12] = ctrlo;
+        in[13] = ctrhi;
+        in[14] = n0;
+        in[15] = n1;
+        V x[16];
+        std::copy_n(in, 16, x);
+        chacha_rounds(x);
+        for (int w = 0; w < 16; ++w)
+          x[w] += in[w];
+
+        // 64 bit block counter, carry into the high word where the low one wrapped
+        ctrlo += 1;
+        ctrhi -= reinterpret_cast<V>(ctrlo == 0);
+
+        for (size_t i = 0; i < N; ++i)
+        {
+          auto& lane = lanes[i];
+          if (lane.left == 0)
+            continue;
+          if (lane.left >= 64)
+          {
+            for (int w = 0; w < 16; ++w)
+              htobuf32(lane.ptr + 4 * w, buf32toh(lane.ptr + 4 * w) ^ htole32(x[w][i]));
+            lane.ptr += 64;
+            lane.left -= 64;
+          }
+          else
+          {
+            byte_t stream[64];
+            for (int w = 0; w < 16; ++w)
+              htole32buf(stream + 4 * w, x[w][i]);
+            for (size_t idx = 0; idx < lane.left; ++idx)
+              lane.ptr[idx] ^= stream[idx];
+            lane.left = 0;
+          }
+          if (lane.left == 0 and not refill(i))
+            --active;
+        }
+      }
+
+      for (size_t i = 0; i < N; ++i)
+      {
+        auto& lane = lanes[i];
+        if (lane.left == 0)
+          continue;
+        const uint64_t ctr = (uint64_t{ctrhi[i]} << 32) | ctrlo[i];
+        crypto_stream_chacha20_xor_ic(
+            lane.ptr, lane.ptr, lane.left, lane.nonce + 16, ctr, lane.subkey);
+      }
+    }
+
+    static void
+    run_portable(
+        const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k)
+    {
+      // sse2 on x86_64, neon on arm64, plain code where the compiler has neither
+      run_lanes<v4u>(bufs, nonces, num, k);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    __attribute__((target("avx2"))) static void
+    run_avx2(const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k)
+    {
+      run_lanes<v8u>(bufs, nonces, num, k);
+    }
+
+    __attribute__((target("avx512f"))) static void
+    run_avx512(
+        const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k)
+    {
+      run_lanes<v16u>(bufs, nonces, num, k);
+    }
+#endif
+
+    std::vector<XChaCha20Kernel>
+    xchacha20_kernels()
+    {
+      std::vector<XChaCha20Kernel> kernels;
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f"))
+        kernels.push_back({"avx512", 16, &run_avx512});
+      if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({"avx2", 8, &run_avx2});
+#endif
+      kernels.push_back({"portable", 4, &run_portable});
+      return kernels;
+    }
+
+    const XChaCha20Kernel&
+    xchacha20_kernel()
+    {
+      static const XChaCha20Kernel kernel = [] {
+        const auto kernels = xchacha20_kernels();
+        const char* avx2 = std::getenv("AVX2_FORCE_DISABLE");
+        if (avx2 && std::string(avx2) == "1")
+          return kernels.back();
+        return kernels.front();
+      }();
+      return kernel;
+    }
+  }  // namespace sodium
+}  // namespace llarp
@@ -0,0 +1,36 @@
+#ifndef LLARP_CRYPTO_XCHACHA20_LANES_HPP
+#define LLARP_CRYPTO_XCHACHA20_LANES_HPP
+
+#include <crypto/crypto.hpp>
+#include <crypto/types.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  namespace sodium
+  {
+    /// a multi buffer xchacha20, runs one stream per simd lane so a batch of small relay
+    /// cells costs about what one cell per lane would. gives the same bytes as
+    /// crypto_stream_xchacha20_xor on each buffer
+    struct XChaCha20Kernel
+    {
+      const char* name;
+      /// streams run side by side
+      size_t lanes;
+      void (*run)(
+          const CryptoSpan* bufs, const TunnelNonce* nonces, size_t num, const SharedSecret& k);
+    };
+
+    /// every kernel this cpu can run, widest first, the portable one is always last
+    std::vector<XChaCha20Kernel>
+    xchacha20_kernels();
+
+    /// the widest kernel this cpu can run, picked once. AVX2_FORCE_DISABLE=1 in the
+    /// environment keeps it to the portable one
+    const XChaCha20Kernel&
+    xchacha20_kernel();
+  }  // namespace sodium
+}  // namespace llarp
+
+#endif
@@ -1,11 +1,12 @@
 #ifndef LLARP_DHT_BUCKET_HPP
 #define LLARP_DHT_BUCKET_HPP
 
-#include <dht/kademlia.hpp>
 #include <dht/key.hpp>
 #include <util/status.hpp>
 
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <set>
 #include <vector>
 
@@ -13,22 +14,26 @@ namespace llarp
 {
   namespace dht
   {
+    /// the nodes of one kind we know, kept in one vector sorted by key. every key sharing a
+    /// prefix sits in one run, so the closest by xor come from halving runs down the target's
+    /// bits with binary searches, and nothing on the query side allocates
     template <typename Val_t>
     struct Bucket
     {
-      using BucketStorage_t = std::map<Key_t, Val_t, XorMetric>;
+      using BucketStorage_t = std::vector<Val_t>;
       using Random_t = std::function<uint64_t()>;
 
-      Bucket(const Key_t& us, Random_t r) : nodes(XorMetric(us)), random(std::move(r))
+      /// nodes used to be ordered by distance from us, key order serves every query now
+      Bucket(const Key_t& /* us */, Random_t r) : random(std::move(r))
       {}
 
       util::StatusObject
       ExtractStatus() const
       {
         util::StatusObject obj{};
-        for (const auto& item : nodes)
+        for (const auto& node : nodes)
         {
-          obj[item.first.ToString()] = item.second.ExtractStatus();
+          obj[node.ID.ToString()] = node.ExtractStatus();
         }
         return obj;
       }
@@ -39,56 +44,54 @@ namespace llarp
         return nodes.size();
       }
 
-      struct SetIntersector
+      /// write the up to k keys closest to target by xor that accept takes to out, closest
+      /// first, out has room for k. returns how many it wrote
+      template <typename Accept_t>
+      size_t
+      GetNearest(const Key_t& target, Key_t* out, size_t k, Accept_t&& accept) const
       {
-        bool
-        operator()(const typename BucketStorage_t::value_type& lhs, const Key_t& rhs)
-        {
-          return lhs.first < rhs;
-        }
-
-        bool
-        operator()(const Key_t& lhs, const typename BucketStorage_t::value_type& rhs)
-        {
-          return lhs < rhs.first;
-        }
-      };
+        size_t found = 0;
+        Walk(nodes.begin(), nodes.end(), 0, Key_t{}, target, out, k, found, accept);
+        return found;
+      }
 
       bool
       GetRandomNodeExcluding(Key_t& result, const std::set<Key_t>& exclude) const
       {
-        std::vector<typename BucketStorage_t::value_type> candidates;
-        std::set_difference(
-            nodes.begin(),
-            nodes.end(),
-            exclude.begin(),
-            exclude.end(),
-            std::back_inserter(candidates),
-            SetIntersector());
-
-        if (candidates.empty())
+        // nodes and exclude are both in key order so one pass over each lines them up
+        const auto notExcluded = [&exclude](auto& ex, const Key_t& key) {
+          while (ex != exclude.end() and *ex < key)
+            ++ex;
+          return ex == exclude.end() or *ex != key;
+        };
+        size_t candidates = 0;
+        auto ex = exclude.begin();
+        for (const auto& node : nodes)
+        {
+          if (notExcluded(ex, node.ID))
+            ++candidates;
+        }
+        if (candidates == 0)
         {
           return false;
         }
-        result = candidates[random() % candidates.size()].first;
+        size_t pick = random() % candidates;
+        ex = exclude.begin();
+        for (const auto& node : nodes)
+        {
+          if (notExcluded(ex, node.ID) and pick-- == 0)
+          {
+            result = node.ID;
+            break;
+          }
+        }
         return true;
       }
 
       bool
       FindClosest(const Key_t& target, Key_t& result) const
       {
-        Key_t mindist;
-        mindist.Fill(0xff);
-        for (const auto& item : nodes)
-        {
-          auto curDist = item.first ^ target;
-          if (curDist < mindist)
-          {
-            mindist = curDist;
-            result = item.first;
-          }
-        }
-        return nodes.size() > 0;
+        return GetNearest(target, &result, 1, [](const Key_t&) { return true; }) == 1;
       }
 
       bool
@@ -103,7 +106,7 @@ namespace llarp
         {
           std::transform(
               nodes.begin(), nodes.end(), std::inserter(result, result.end()), [](const auto& a) {
-                return a.first;
+                return a.ID;
               });
 
           return true;
@@ -112,9 +115,7 @@ namespace llarp
         size_t sz = nodes.size();
         while (N)
         {
-          auto itr = nodes.begin();
-          std::advance(itr, random() % sz);
-          if (result.insert(itr->first).second)
+          if (result.insert(nodes[random() % sz].ID).second)
           {
             --N;
           }
@@ -125,25 +126,8 @@ namespace llarp
       bool
       FindCloseExcluding(const Key_t& target, Key_t& result, const std::set<Key_t>& exclude) const
       {
-        Key_t maxdist;
-        maxdist.Fill(0xff);
-        Key_t mindist;
-        mindist.Fill(0xff);
-        for (const auto& item : nodes)
-        {
-          if (exclude.count(item.first))
-          {
-            continue;
-          }
-
-          auto curDist = item.first ^ target;
-          if (curDist < mindist)
-          {
-            mindist = curDist;
-            result = item.first;
-          }
-        }
-        return mindist < maxdist;
+        const auto notExcluded = [&exclude](const Key_t& key) { return exclude.count(key) == 0; };
+        return GetNearest(target, &result, 1, notExcluded) == 1;
       }
 
       bool
@@ -153,36 +137,32 @@ namespace llarp
           size_t N,
           const std::set<Key_t>& exclude) const
       {
-        std::set<Key_t> s(exclude.begin(), exclude.end());
-
-        Key_t peer;
-        while (N--)
-        {
-          if (!FindCloseExcluding(target, peer, s))
-          {
-            return false;
-          }
-          s.insert(peer);
-          result.insert(peer);
-        }
-        return true;
+        std::vector<Key_t> nearest(N);
+        const auto notExcluded = [&exclude](const Key_t& key) { return exclude.count(key) == 0; };
+        const size_t found = GetNearest(target, nearest.data(), N, notExcluded);
+        result.insert(nearest.begin(), nearest.begin() + found);
+        return found == N;
       }
 
       void
       PutNode(const Val_t& val)
       {
-        auto itr = nodes.find(val.ID);
-        if (itr == nodes.end() || itr->second < val)
+        auto itr = LowerBound(val.ID);
+        if (itr == nodes.end() || itr->ID != val.ID)
         {
-          nodes[val.ID] = val;
+          nodes.insert(itr, val);
+        }
+        else if (*itr < val)
+        {
+          *itr = val;
         }
       }
 
       void
       DelNode(const Key_t& key)
       {
-        auto itr = nodes.find(key);
-        if (itr != nodes.end())
+        auto itr = LowerBound(key);
+        if (itr != nodes.end() && itr->ID == key)
         {
           nodes.erase(itr);
         }
@@ -191,7 +171,17 @@ namespace llarp
       bool
       HasNode(const Key_t& key) const
       {
-        return nodes.find(key) != nodes.end();
+        return GetNode(key) != nullptr;
+      }
+
+      /// the node with key, nullptr if we have none
+      const Val_t*
+      GetNode(const Key_t& key) const
+      {
+        auto itr = std::lower_bound(nodes.begin(), nodes.end(), key, KeyLess{});
+        if (itr == nodes.end() || itr->ID != key)
+          return nullptr;
+        return &*itr;
       }
 
       // remove all nodes who's key matches a predicate
@@ -199,23 +189,24 @@ namespace llarp
       void
       RemoveIf(Predicate pred)
       {
-        auto itr = nodes.begin();
-        while (itr != nodes.end())
-        {
-          if (pred(itr->first))
-            itr = nodes.erase(itr);
-          else
-            ++itr;
-        }
+        EraseIf([&pred](const Val_t& node) { return pred(node.ID); });
+      }
+
+      // remove all nodes that match a predicate
+      template <typename Predicate>
+      void
+      EraseIf(Predicate pred)
+      {
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), pred), nodes.end());
       }
 
       template <typename Visit_t>
       void
       ForEachNode(Visit_t visit)
       {
-        for (const auto& item : nodes)
+        for (const auto& node : nodes)
         {
-          visit(item.second);
+          visit(node);
         }
       }
 
@@ -225,8 +216,69 @@ namespace llarp
         nodes.clear();
       }
 
+      /// sorted by ID, at most one node per ID
       BucketStorage_t nodes;
       Random_t random;
+
+     private:
+      using Iter_t = typename BucketStorage_t::const_iterator;
+
+      static constexpr size_t KeyBits = Key_t::SIZE * 8;
+
+      struct KeyLess
+      {
+        bool
+        operator()(const Val_t& node, const Key_t& key) const
+        {
+          return node.ID < key;
+        }
+      };
+
+      typename BucketStorage_t::iterator
+      LowerBound(const Key_t& key)
+      {
+        return std::lower_bound(nodes.begin(), nodes.end(), key, KeyLess{});
+      }
+
+      /// the nodes in [lo, hi) share the first depth bits of prefix, the rest of prefix is zero
+      template <typename Accept_t>
+      static void
+      Walk(
+          Iter_t lo,
+          Iter_t hi,
+          size_t depth,
+          const Key_t& prefix,
+          const Key_t& target,
+          Key_t* out,
+          size_t k,
+          size_t& found,
+          Accept_t& accept)
+      {
+        if (lo == hi or found >= k)
+          return;
+        // one node left or nothing left to split on, keys are unique so both end here
+        if (std::next(lo) == hi or depth == KeyBits)
+        {
+          if (accept(lo->ID))
+            out[found++] = lo->ID;
+          return;
+        }
+        // every node on the side that agrees with target on this bit is closer than any on
+        // the other side, so take that side first
+        Key_t upper = prefix;
+        upper[depth / 8] |= 0x80 >> (depth % 8);
+        const auto mid = std::lower_bound(lo, hi, upper, KeyLess{});
+        if (target[depth / 8] & (0x80 >> (depth % 8)))
+        {
+          Walk(mid, hi, depth + 1, upper, target, out, k, found, accept);
+          Walk(lo, mid, depth + 1, prefix, target, out, k, found, accept);
+        }
+        else
+        {
+          Walk(lo, mid, depth + 1, prefix, target, out, k, found, accept);
+          Walk(mid, hi, depth + 1, upper, target, out, k, found, accept);
+        }
+      }
     };
   }  // namespace dht
 }  // namespace llarp
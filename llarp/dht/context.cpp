@@ -1,5 +1,6 @@
 #include <dht/context.hpp>
 
+#include <consensus/table.hpp>
 #include <dht/explorenetworkjob.hpp>
 #include <dht/localrouterlookup.hpp>
 #include <dht/localserviceaddresslookup.hpp>
@@ -17,11 +18,15 @@
 #include <path/path_context.hpp>
 #include <router/abstractrouter.hpp>
 #include <routing/dht_message.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/thread/logic.hpp>
 #include <nodedb.hpp>
 #include <profiling.hpp>
 #include <router/i_rc_lookup_handler.hpp>
 #include <util/decaying_hashset.hpp>
+#include <util/metrics.hpp>
+#include <util/tracy.hpp>
+#include <array>
 #include <vector>
 
 namespace llarp
@@ -75,15 +80,25 @@ namespace llarp
       bool
       LookupRouter(const RouterID& target, RouterLookupHandler result) override
       {
-        Key_t askpeer;
-        if (!_nodes->FindClosest(Key_t(target), askpeer))
+        std::array<Key_t, RouterLookupFanout> askpeers;
+        const size_t found = _nodes->GetNearest(
+            Key_t(target), askpeers.data(), askpeers.size(), [](const Key_t&) { return true; });
+        if (found == 0)
         {
           return false;
         }
-        LookupRouterRecursive(target, OurKey(), 0, askpeer, result);
+        LookupRouterParallel(target, {askpeers.begin(), askpeers.begin() + found}, result);
         return true;
       }
 
+      /// for ourselves request router with public key target from all of askpeers at once,
+      /// the first to find it wins
+      void
+      LookupRouterParallel(
+          const RouterID& target,
+          const std::vector<Key_t>& askpeers,
+          RouterLookupHandler result);
+
       bool
       HasRouterLookup(const RouterID& target) const override
       {
@@ -113,6 +128,9 @@ namespace llarp
       void
       DHTSendTo(const RouterID& peer, IMessage* msg, bool keepalive = true) override;
 
+      void
+      DHTSendToPath(const PathID_t& localPath, IMessage* msg) override;
+
       /// get routers closest to target excluding requester
       bool
       HandleExploritoryRouterLookup(
@@ -172,14 +190,20 @@ namespace llarp
       std::unique_ptr<Bucket<RCNode>> _nodes;
 
       // for introduction sets
-      std::unique_ptr<Bucket<ISNode>> _services;
+      std::unique_ptr<IntroSetStore> _services;
 
-      Bucket<ISNode>*
+      IntroSetStore*
       services() override
       {
         return _services.get();
       }
 
+      ExploreScheduler&
+      exploreScheduler() override
+      {
+        return _exploreScheduler;
+      }
+
       bool allowTransit{false};
 
       bool&
@@ -234,6 +258,7 @@ namespace llarp
       PendingIntrosetLookups _pendingIntrosetLookups;
       PendingRouterLookups _pendingRouterLookups;
       PendingExploreLookups _pendingExploreLookups;
+      ExploreScheduler _exploreScheduler;
 
       PendingIntrosetLookups&
       pendingIntrosetLookups() override
@@ -287,6 +312,26 @@ namespace llarp
       void
       ScheduleCleanupTimer();
 
+      /// have the logic thread send what is in the outboxes once it is done with what it is
+      /// on now, so everything for one peer or path by then goes as one message
+      void
+      QueueFlush();
+
+      void
+      FlushOutbox();
+
+      using Outbox_t = std::vector<IMessage::Ptr_t>;
+      std::unordered_map<RouterID, Outbox_t, RouterID::Hash> m_PeerOutbox;
+      std::unordered_map<PathID_t, Outbox_t, PathID_t::Hash> m_PathOutbox;
+      bool m_FlushQueued = false;
+      uint64_t m_MessagesSent = 0;
+      uint64_t m_BatchesSent = 0;
+
+      /// ours in the router's metrics, from Init on
+      metrics::Counter* m_SentMetric = nullptr;
+      metrics::Gauge* m_NodesMetric = nullptr;
+      metrics::Gauge* m_IntroSetsMetric = nullptr;
+
       void
       CleanupTX();
 
@@ -337,18 +382,10 @@ namespace llarp
       if (_services)
       {
         // expire intro sets
-        auto& nodes = _services->nodes;
-        auto itr = nodes.begin();
-        while (itr != nodes.end())
-        {
-          if (itr->second.introset.IsExpired(now))
-          {
-            itr = nodes.erase(itr);
-          }
-          else
-            ++itr;
-        }
+        _services->Expire(now);
+        m_IntroSetsMetric->Set(_services->Size());
       }
+      m_NodesMetric->Set(_nodes->size());
       ScheduleCleanupTimer();
     }
 
@@ -415,10 +452,7 @@ namespace llarp
     std::optional<llarp::service::EncryptedIntroSet>
     Context::GetIntroSetByLocation(const Key_t& key) const
     {
-      auto itr = _services->nodes.find(key);
-      if (itr == _services->nodes.end())
-        return {};
-      return itr->second.introset;
+      return _services->Get(key, Now());
     }
 
     void
@@ -440,6 +474,11 @@ namespace llarp
                              {"pendingExploreLookups", pendingExploreLookups().ExtractStatus()},
                              {"nodes", _nodes->ExtractStatus()},
                              {"services", _services->ExtractStatus()},
+                             {"explore", _exploreScheduler.ExtractStatus()},
+                             {"verifiedIntrosets", service::VerifiedIntroSetStatus()},
+                             {"verifiedRCs", VerifiedRCStatus()},
+                             {"outbox",
+                              {{"messages", m_MessagesSent}, {"batches", m_BatchesSent}}},
                              {"ourKey", ourKey.ToHex()}};
       return obj;
     }
@@ -450,7 +489,11 @@ namespace llarp
       router = r;
       ourKey = us;
       _nodes = std::make_unique<Bucket<RCNode>>(ourKey, llarp::randint);
-      _services = std::make_unique<Bucket<ISNode>>(ourKey, llarp::randint);
+      _services = std::make_unique<IntroSetStore>();
+      m_SentMetric = &r->metrics().AddCounter("llarp_dht_messages_sent_total", "dht messages sent");
+      m_NodesMetric = &r->metrics().AddGauge("llarp_dht_nodes", "routers in our dht");
+      m_IntroSetsMetric =
+          &r->metrics().AddGauge("llarp_dht_introsets", "introsets we store for others");
       llarp::LogDebug("initialize dht with key ", ourKey);
       // start cleanup timer
       ScheduleCleanupTimer();
@@ -466,14 +509,113 @@ namespace llarp
     void
     Context::DHTSendTo(const RouterID& peer, IMessage* msg, bool)
     {
-      llarp::DHTImmediateMessage m;
-      m.msgs.emplace_back(msg);
-      router->SendToOrQueue(peer, &m, [](SendStatus status) {
-        if (status != SendStatus::Success)
-          LogInfo("DHTSendTo unsuccessful, status: ", (int)status);
-      });
-      auto now = Now();
-      router->PersistSessionUntil(peer, now + 1min);
+      m_PeerOutbox[peer].emplace_back(msg);
+      QueueFlush();
+    }
+
+    void
+    Context::DHTSendToPath(const PathID_t& localPath, IMessage* msg)
+    {
+      m_PathOutbox[localPath].emplace_back(msg);
+      QueueFlush();
+    }
+
+    void
+    Context::QueueFlush()
+    {
+      if (m_FlushQueued)
+        return;
+      m_FlushQueued = true;
+      LogicCall(router->logic(), [this]() { FlushOutbox(); });
+    }
+
+    namespace
+    {
+      /// what one batched dht message may hold, well under what a link message or a
+      /// routing message down a path can carry
+      constexpr size_t MaxBatchBytes = MAX_LINK_MSG_SIZE / 2;
+
+      size_t
+      EncodedSize(const IMessage& msg)
+      {
+        std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+        llarp_buffer_t buf(tmp);
+        // too big to share a batch, it goes alone and fails to send like it did before
+        if (not msg.BEncode(&buf))
+          return tmp.size();
+        return buf.cur - buf.base;
+      }
+
+      /// call send with runs of msgs that together stay in MaxBatchBytes, in order. one
+      /// message bigger than that goes in a run by itself
+      template <typename Send_t>
+      void
+      ForEachBatch(std::vector<IMessage::Ptr_t> msgs, Send_t send)
+      {
+        std::vector<IMessage::Ptr_t> batch;
+        size_t bytes = 0;
+        for (auto& msg : msgs)
+        {
+          const size_t size = EncodedSize(*msg);
+          if (not batch.empty() and bytes + size > MaxBatchBytes)
+          {
+            send(std::move(batch));
+            batch.clear();
+            bytes = 0;
+          }
+          batch.emplace_back(std::move(msg));
+          bytes += size;
+        }
+        if (not batch.empty())
+          send(std::move(batch));
+      }
+    }  // namespace
+
+    void
+    Context::FlushOutbox()
+    {
+      alloc::Scope allocScope{alloc::DHTMessages};
+      LLARP_ZONE("dht::Context::FlushOutbox");
+      m_FlushQueued = false;
+      auto peers = std::move(m_PeerOutbox);
+      m_PeerOutbox.clear();
+      auto paths = std::move(m_PathOutbox);
+      m_PathOutbox.clear();
+
+      const auto now = Now();
+      for (auto& [peer, msgs] : peers)
+      {
+        m_MessagesSent += msgs.size();
+        m_SentMetric->Inc(msgs.size());
+        ForEachBatch(std::move(msgs), [this, &peer = peer](auto batch) {
+          llarp::DHTImmediateMessage m;
+          m.msgs = std::move(batch);
+          m_BatchesSent++;
+          router->SendToOrQueue(peer, &m, [](SendStatus status) {
+            if (status != SendStatus::Success)
+              LogInfo("DHTSendTo unsuccessful, status: ", (int)status);
+          });
+        });
+        router->PersistSessionUntil(peer, now + 1min);
+      }
+      for (auto& [id, msgs] : paths)
+      {
+        auto path = router->pathContext().GetByUpstream(router->pubkey(), id);
+        if (not path)
+        {
+          LogWarn("did not send reply for relayed dht request, no such local path for pathid=", id);
+          continue;
+        }
+        m_MessagesSent += msgs.size();
+        m_SentMetric->Inc(msgs.size());
+        ForEachBatch(std::move(msgs), [this, &path, &id = id](auto batch) {
+          routing::DHTMessage m;
+          m.M = std::move(batch);
+          m_BatchesSent++;
+          if (not path->SendRoutingMessage(m, router))
+            LogWarn("failed to send routing message for dht replies, pathid=", id);
+        });
+      }
     }
 
     // this function handles incoming DHT messages sent down a path by a client
@@ -483,13 +625,17 @@ namespace llarp
     bool
     Context::RelayRequestForPath(const llarp::PathID_t& id, const IMessage& msg)
     {
-      llarp::routing::DHTMessage reply;
-      if (!msg.HandleMessage(router->dht(), reply.M))
+      alloc::Scope allocScope{alloc::DHTMessages};
+      LLARP_ZONE("dht::Context::RelayRequestForPath");
+      std::vector<IMessage::Ptr_t> replies;
+      if (!msg.HandleMessage(router->dht(), replies))
         return false;
-      if (not reply.M.empty())
+      if (not replies.empty())
       {
-        auto path = router->pathContext().GetByUpstream(router->pubkey(), id);
-        return path && path->SendRoutingMessage(reply, router);
+        auto& outbox = m_PathOutbox[id];
+        for (auto& reply : replies)
+          outbox.emplace_back(std::move(reply));
+        QueueFlush();
       }
       return true;
     }
@@ -507,7 +653,7 @@ namespace llarp
       _pendingIntrosetLookups.NewTX(
           peer,
           asker,
-          asker,
+          LocalServiceAddressLookup::CoalesceKey(addr, askpeer),
           new LocalServiceAddressLookup(path, txid, relayOrder, addr, this, askpeer));
     }
 
@@ -642,6 +788,18 @@ namespace llarp
           peer, asker, target, new RecursiveRouterLookup(asker, target, this, handler));
     }
 
+    void
+    Context::LookupRouterParallel(
+        const RouterID& target, const std::vector<Key_t>& askpeers, RouterLookupHandler handler)
+    {
+      const TXOwner asker(OurKey(), 0);
+      std::vector<TXOwner> peers;
+      for (const auto& askpeer : askpeers)
+        peers.emplace_back(askpeer, ++ids);
+      _pendingRouterLookups.NewParallelTX(
+          peers, asker, target, new RecursiveRouterLookup(asker, target, this, handler));
+    }
+
     llarp_time_t
     Context::Now() const
     {
@@ -654,5 +812,38 @@ namespace llarp
       return std::make_unique<Context>();
     }
 
+    std::vector<Key_t>
+    IntroSetStorageFor(AbstractRouter* router, const Key_t& location)
+    {
+      std::vector<Key_t> storage;
+      if (const auto table = router->rcLookupHandler().ConsensusTable(); not table->Empty())
+      {
+        for (const auto& replica : table->Replicas(location, IntroSetStorageRedundancy))
+          storage.emplace_back(replica.as_array());
+        return storage;
+      }
+      const auto closest =
+          router->nodedb()->FindClosestShared(location, IntroSetStorageRedundancy);
+      for (const auto& rc : closest)
+        storage.emplace_back(rc->pubkey);
+      return storage;
+    }
+
+    bool
+    StoresIntroSetAt(AbstractRouter* router, const Key_t& location)
+    {
+      const Key_t us{router->pubkey()};
+      const auto table = router->rcLookupHandler().ConsensusTable();
+      for (const auto& replica : table->Replicas(location, IntroSetStorageRedundancy))
+        if (Key_t{replica.as_array()} == us)
+          return true;
+      const auto closest =
+          router->nodedb()->FindClosestShared(location, IntroSetStorageRedundancy);
+      for (const auto& rc : closest)
+        if (Key_t{rc->pubkey} == us)
+          return true;
+      return false;
+    }
+
   }  // namespace dht
 }  // namespace llarp
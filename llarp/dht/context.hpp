@@ -3,6 +3,8 @@
 
 #include <dht/bucket.hpp>
 #include <dht/dht.h>
+#include <dht/explore_scheduler.hpp>
+#include <dht/introset_store.hpp>
 #include <dht/key.hpp>
 #include <dht/message.hpp>
 #include <dht/messages/findintro.hpp>
@@ -16,6 +18,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace llarp
 {
@@ -32,6 +35,20 @@ namespace llarp
     static constexpr size_t IntroSetStorageRedundancy =
         (IntroSetRelayRedundancy * IntroSetRequestsPerRelay);
 
+    /// number of the closest routers our own router lookups ask at once
+    static constexpr size_t RouterLookupFanout = 3;
+
+    /// the IntroSetStorageRedundancy routers an introset at location is stored on, in relay
+    /// order. the replicas the consensus table's ring gives, which every relay agrees on, or
+    /// the closest routers our nodedb knows of until lokid gave us a table
+    std::vector<Key_t>
+    IntroSetStorageFor(AbstractRouter* router, const Key_t& location);
+
+    /// true if we are one of the routers that store an introset at location, by the ring or
+    /// by closeness, so relays still placing introsets by closeness reach us too
+    bool
+    StoresIntroSetAt(AbstractRouter* router, const Key_t& location);
+
     struct AbstractContext
     {
       using PendingIntrosetLookups = TXHolder<TXOwner, service::EncryptedIntroSet, TXOwner::Hash>;
@@ -91,6 +108,10 @@ namespace llarp
       virtual void
       DHTSendTo(const RouterID& peer, IMessage* msg, bool keepalive = true) = 0;
 
+      /// send a dht message down one of our transit paths, to the client at its end
+      virtual void
+      DHTSendToPath(const PathID_t& localPath, IMessage* msg) = 0;
+
       /// get routers closest to target excluding requester
       virtual bool
       HandleExploritoryRouterLookup(
@@ -168,9 +189,12 @@ namespace llarp
       virtual const PendingExploreLookups&
       pendingExploreLookups() const = 0;
 
-      virtual Bucket<ISNode>*
+      virtual IntroSetStore*
       services() = 0;
 
+      virtual ExploreScheduler&
+      exploreScheduler() = 0;
+
       virtual bool&
       AllowTransit() = 0;
       virtual const bool&
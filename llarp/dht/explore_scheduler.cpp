@@ -0,0 +1,49 @@
+#include <dht/explore_scheduler.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace dht
+  {
+    void
+    ExploreScheduler::Seen(size_t known, size_t total)
+    {
+      m_Known += std::min(known, total);
+      m_Total += total;
+    }
+
+    bool
+    ExploreScheduler::Due(llarp_time_t now, size_t buckets, llarp_time_t floor)
+    {
+      if (now < m_NextAt)
+        return false;
+      if (m_Total > 0)
+        m_Coverage = double(m_Known) / double(m_Total);
+
+      if (buckets < ColdStartRouters or m_Interval < floor)
+        m_Interval = floor;
+      else if (m_Total > 0 and m_Coverage < SteadyCoverage)
+        m_Interval = std::max(floor, m_Interval / 2);
+      else
+      {
+        // nothing new since the last, or nothing heard at all past cold start
+        m_Interval = std::min(MaxInterval, m_Interval * 2);
+      }
+      m_Known = 0;
+      m_Total = 0;
+      m_NextAt = now + m_Interval;
+      m_Explores++;
+      return true;
+    }
+
+    util::StatusObject
+    ExploreScheduler::ExtractStatus() const
+    {
+      return util::StatusObject{{"interval", to_json(m_Interval)},
+                                {"nextAt", to_json(m_NextAt)},
+                                {"coverage", m_Coverage},
+                                {"explores", m_Explores}};
+    }
+  }  // namespace dht
+}  // namespace llarp
@@ -0,0 +1,67 @@
+#ifndef LLARP_DHT_EXPLORE_SCHEDULER_HPP
+#define LLARP_DHT_EXPLORE_SCHEDULER_HPP
+
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// decides when to explore the network for routers, from how much of it we seem to know.
+    /// every router an explore reply or a gossip brings us is counted as known or new to us,
+    /// the share of known ones is our coverage. while we know few routers, or the last
+    /// explores still turn up new ones, the interval halves down to the floor we are given,
+    /// and once nearly everything we hear of is known it doubles up to MaxInterval.
+    /// used from the logic thread only.
+    struct ExploreScheduler
+    {
+      /// the longest we go without exploring
+      static constexpr llarp_time_t MaxInterval = 5min;
+      /// fewer routers than this in our bucket is a cold start, explore at the floor
+      static constexpr size_t ColdStartRouters = 32;
+      /// at this share of known routers we are covered and back off
+      static constexpr double SteadyCoverage = 0.95;
+
+      /// count routers we heard of, known of them were in our nodedb already
+      void
+      Seen(size_t known, size_t total);
+
+      /// return true if it is time to explore, and schedule the one after it from the
+      /// coverage since the last. buckets is how many routers our dht knows, floor the
+      /// shortest interval allowed
+      bool
+      Due(llarp_time_t now, size_t buckets, llarp_time_t floor);
+
+      /// the interval the last explore set
+      llarp_time_t
+      Interval() const
+      {
+        return m_Interval;
+      }
+
+      /// share of known routers as of the last explore, 0 until we heard of any
+      double
+      Coverage() const
+      {
+        return m_Coverage;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      llarp_time_t m_NextAt = 0s;
+      llarp_time_t m_Interval = 0s;
+      double m_Coverage = 0;
+      size_t m_Known = 0;
+      size_t m_Total = 0;
+      uint64_t m_Explores = 0;
+    };
+  }  // namespace dht
+}  // namespace llarp
+
+#endif
@@ -31,14 +31,19 @@ namespace llarp
 
       auto router = parent->GetRouter();
       using std::placeholders::_1;
+      size_t known = 0;
       for (const auto& pk : valuesFound)
       {
         // lookup router
         if (router and router->nodedb()->Has(pk))
+        {
+          known++;
           continue;
+        }
         parent->LookupRouter(
             pk, std::bind(&AbstractRouter::HandleDHTLookupForExplore, router, pk, _1));
       }
+      parent->exploreScheduler().Seen(known, valuesFound.size());
     }
   }  // namespace dht
 }  // namespace llarp
@@ -0,0 +1,101 @@
+#include <dht/introset_store.hpp>
+
+#include <constants/path.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    IntroSetStore::Shard&
+    IntroSetStore::ShardFor(const Key_t& key)
+    {
+      return m_Shards[Key_t::Hash{}(key) % NumShards];
+    }
+
+    const IntroSetStore::Shard&
+    IntroSetStore::ShardFor(const Key_t& key) const
+    {
+      return m_Shards[Key_t::Hash{}(key) % NumShards];
+    }
+
+    bool
+    IntroSetStore::Put(const service::EncryptedIntroSet& introset)
+    {
+      const Key_t key{introset.derivedSigningKey.as_array()};
+      auto& shard = ShardFor(key);
+      util::Lock lock(shard.access);
+      auto [itr, inserted] = shard.introsets.try_emplace(key, introset);
+      if (not inserted)
+      {
+        if (itr->second.signedAt > introset.signedAt)
+          return false;
+        itr->second = introset;
+      }
+      shard.expiries.emplace(introset.signedAt + path::default_lifetime, key);
+      return true;
+    }
+
+    std::optional<service::EncryptedIntroSet>
+    IntroSetStore::Get(const Key_t& location, llarp_time_t now) const
+    {
+      const auto& shard = ShardFor(location);
+      std::shared_lock lock(shard.access);
+      auto itr = shard.introsets.find(location);
+      if (itr == shard.introsets.end() or itr->second.IsExpired(now))
+      {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+      shard.hits.fetch_add(1, std::memory_order_relaxed);
+      return itr->second;
+    }
+
+    void
+    IntroSetStore::Expire(llarp_time_t now)
+    {
+      for (auto& shard : m_Shards)
+      {
+        util::Lock lock(shard.access);
+        auto& expiries = shard.expiries;
+        const auto end = expiries.upper_bound(now);
+        for (auto itr = expiries.begin(); itr != end; ++itr)
+        {
+          // skip keys that were put again since with a later introset
+          auto introset = shard.introsets.find(itr->second);
+          if (introset != shard.introsets.end() and introset->second.IsExpired(now))
+            shard.introsets.erase(introset);
+        }
+        expiries.erase(expiries.begin(), end);
+      }
+    }
+
+    size_t
+    IntroSetStore::Size() const
+    {
+      size_t size = 0;
+      for (const auto& shard : m_Shards)
+      {
+        std::shared_lock lock(shard.access);
+        size += shard.introsets.size();
+      }
+      return size;
+    }
+
+    util::StatusObject
+    IntroSetStore::ExtractStatus() const
+    {
+      std::vector<util::StatusObject> shards;
+      size_t size = 0;
+      for (const auto& shard : m_Shards)
+      {
+        std::shared_lock lock(shard.access);
+        size += shard.introsets.size();
+        shards.emplace_back(
+            util::StatusObject{{"entries", shard.introsets.size()},
+                               {"hits", shard.hits.load(std::memory_order_relaxed)},
+                               {"misses", shard.misses.load(std::memory_order_relaxed)}});
+      }
+      return util::StatusObject{{"entries", size}, {"shards", shards}};
+    }
+  }  // namespace dht
+}  // namespace llarp
@@ -0,0 +1,72 @@
+#ifndef LLARP_DHT_INTROSET_STORE_HPP
+#define LLARP_DHT_INTROSET_STORE_HPP
+
+#include <dht/key.hpp>
+#include <service/intro_set.hpp>
+#include <util/status.hpp>
+#include <util/thread/annotations.hpp>
+#include <util/thread/threading.hpp>
+#include <util/time.hpp>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// the introsets we store for the network, by derived signing key. split over shards
+    /// by key so publishes and lookups for different keys never wait on each other, and a
+    /// lookup only takes its shard shared, so it can be answered from any thread. each
+    /// shard keeps its keys by expiry too, so expiring walks only what is due
+    struct IntroSetStore
+    {
+      static constexpr size_t NumShards = 16;
+
+      /// store introset unless we have a newer one for its key
+      /// return true if it was stored
+      bool
+      Put(const service::EncryptedIntroSet& introset);
+
+      /// the introset stored for location, if there is one that has not expired
+      std::optional<service::EncryptedIntroSet>
+      Get(const Key_t& location, llarp_time_t now) const;
+
+      /// drop the introsets that have expired
+      void
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Shard
+      {
+        mutable util::Mutex access;
+        std::unordered_map<Key_t, service::EncryptedIntroSet, Key_t::Hash> introsets
+            GUARDED_BY(access);
+        /// keys by when the introset they had when put here expires, a key put again
+        /// stays under its old time too until that comes up
+        std::multimap<llarp_time_t, Key_t> expiries GUARDED_BY(access);
+        mutable std::atomic<uint64_t> hits = 0;
+        mutable std::atomic<uint64_t> misses = 0;
+      };
+
+      Shard&
+      ShardFor(const Key_t& key);
+
+      const Shard&
+      ShardFor(const Key_t& key) const;
+
+      std::array<Shard, NumShards> m_Shards;
+    };
+  }  // namespace dht
+}  // namespace llarp
+
+#endif
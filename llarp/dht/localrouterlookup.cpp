@@ -21,16 +21,6 @@ namespace llarp
     void
     LocalRouterLookup::SendReply()
     {
-      auto path =
-          parent->GetRouter()->pathContext().GetByUpstream(parent->OurKey().as_array(), localPath);
-      if (!path)
-      {
-        llarp::LogWarn(
-            "did not send reply for relayed dht request, no such local path "
-            "for pathid=",
-            localPath);
-        return;
-      }
       if (valuesFound.size())
       {
         RouterContact found;
@@ -50,15 +40,8 @@ namespace llarp
           llarp::LogWarn("We found a null RC for dht request, dropping it");
         }
       }
-      routing::DHTMessage msg;
-      msg.M.emplace_back(new GotRouterMessage(parent->OurKey(), whoasked.txid, valuesFound, true));
-      if (!path->SendRoutingMessage(msg, parent->GetRouter()))
-      {
-        llarp::LogWarn(
-            "failed to send routing message when informing result of dht "
-            "request, pathid=",
-            localPath);
-      }
+      parent->DHTSendToPath(
+          localPath, new GotRouterMessage(parent->OurKey(), whoasked.txid, valuesFound, true));
     }
   }  // namespace dht
 }  // namespace llarp
@@ -19,7 +19,16 @@ namespace llarp
           uint64_t relayOrder,
           const Key_t& addr,
           AbstractContext* ctx,
-          __attribute__((unused)) const Key_t& askpeer);
+          const Key_t& askpeer);
+
+      /// the key lookups for addr from askpeer wait under, so clients asking for the same
+      /// introset through us at once share one request to the storage node. two peers
+      /// close to the same addr with the same hash would share too, and both store it
+      static TXOwner
+      CoalesceKey(const Key_t& addr, const Key_t& askpeer)
+      {
+        return TXOwner{addr, Key_t::Hash{}(askpeer)};
+      }
 
       void
       SendReply() override;
@@ -18,25 +18,7 @@ namespace llarp
     void
     LocalTagLookup::SendReply()
     {
-      auto path =
-          parent->GetRouter()->pathContext().GetByUpstream(parent->OurKey().as_array(), localPath);
-      if (!path)
-      {
-        llarp::LogWarn(
-            "did not send reply for relayed dht request, no such local path "
-            "for pathid=",
-            localPath);
-        return;
-      }
-      routing::DHTMessage msg;
-      msg.M.emplace_back(new GotIntroMessage(valuesFound, whoasked.txid));
-      if (!path->SendRoutingMessage(msg, parent->GetRouter()))
-      {
-        llarp::LogWarn(
-            "failed to send routing message when informing result of dht "
-            "request, pathid=",
-            localPath);
-      }
+      parent->DHTSendToPath(localPath, new GotIntroMessage(valuesFound, whoasked.txid));
     }
   }  // namespace dht
 }  // namespace llarp
@@ -1,6 +1,7 @@
 #include <dht/context.hpp>
 
 #include <memory>
+#include <util/alloc_stats.hpp>
 #include <util/bencode.hpp>
 #include <dht/messages/findintro.hpp>
 #include <dht/messages/findrouter.hpp>
@@ -9,6 +10,9 @@
 #include <dht/messages/pubintro.hpp>
 #include <dht/messages/findname.hpp>
 #include <dht/messages/gotname.hpp>
+#include <dht/messages/rcdigest.hpp>
+#include <dht/messages/findrcs.hpp>
+#include <dht/messages/gotrcs.hpp>
 
 namespace llarp
 {
@@ -66,6 +70,19 @@ namespace llarp
             case 'I':
               msg = std::make_unique<PublishIntroMessage>(From, relayed);
               break;
+            case 'D':
+              // only ever sent between peers
+              if (not relayed)
+                msg = std::make_unique<RCDigestMessage>(From);
+              break;
+            case 'B':
+              if (not relayed)
+                msg = std::make_unique<FindRCsMessage>(From);
+              break;
+            case 'P':
+              if (not relayed)
+                msg = std::make_unique<GotRCsMessage>(From);
+              break;
             case 'G':
               if (relayed)
               {
@@ -130,6 +147,7 @@ namespace llarp
     DecodeMesssageList(
         Key_t from, llarp_buffer_t* buf, std::vector<IMessage::Ptr_t>& list, bool relayed)
     {
+      alloc::Scope allocScope{alloc::DHTMessages};
       ListDecoder dec(relayed, from, list);
       return bencode_read_list(dec, buf);
     }
@@ -5,6 +5,7 @@
 #include <dht/key.hpp>
 #include <path/path_types.hpp>
 #include <util/bencode.hpp>
+#include <util/pool.hpp>
 
 #include <vector>
 
@@ -24,6 +25,20 @@ namespace llarp
 
       using Ptr_t = std::unique_ptr<IMessage>;
 
+      /// a message is made for every one decoded and every reply and gone once handled, so
+      /// their storage is recycled rather than going back to the heap
+      static void*
+      operator new(size_t sz)
+      {
+        return util::PoolAlloc(sz);
+      }
+
+      static void
+      operator delete(void* ptr, size_t sz)
+      {
+        util::PoolFree(ptr, sz);
+      }
+
       virtual bool
       HandleMessage(struct llarp_dht_context* dht, std::vector<Ptr_t>& replies) const = 0;
 
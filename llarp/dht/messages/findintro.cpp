@@ -3,7 +3,6 @@
 #include <dht/messages/gotintro.hpp>
 #include <routing/message.hpp>
 #include <router/abstractrouter.hpp>
-#include <nodedb.hpp>
 
 namespace llarp
 {
@@ -105,19 +104,17 @@ namespace llarp
           return true;
         }
 
-        auto closestRCs =
-            dht.GetRouter()->nodedb()->FindClosestTo(location, IntroSetStorageRedundancy);
+        // the same routers a publish with this relay order went to
+        const auto storage = IntroSetStorageFor(dht.GetRouter(), location);
 
-        if (closestRCs.size() <= relayOrder)
+        if (storage.size() <= relayOrder)
         {
           llarp::LogWarn("Can't fulfill FindIntro for relayOrder: ", relayOrder);
           replies.emplace_back(new GotIntroMessage({}, txID));
           return true;
         }
 
-        const auto& entry = closestRCs[relayOrder];
-        Key_t peer = Key_t(entry.pubkey);
-        dht.LookupIntroSetForPath(location, txID, pathID, peer, 0);
+        dht.LookupIntroSetForPath(location, txID, pathID, storage[relayOrder], 0);
       }
       else
       {
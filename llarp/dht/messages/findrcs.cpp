@@ -0,0 +1,89 @@
+#include <dht/messages/findrcs.hpp>
+
+#include <dht/context.hpp>
+#include <dht/messages/gotrcs.hpp>
+#include <messages/dht_immediate.hpp>
+#include <nodedb.hpp>
+#include <router/abstractrouter.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// as many rcs as fit in one link message beside the framing
+    static constexpr size_t RCsPerPage = 6;
+    /// entries one page looks at, so asking for old rcs of a big nodedb is no long walk
+    static constexpr size_t ScanPerPage = 256;
+
+    bool
+    FindRCsMessage::BEncode(llarp_buffer_t* buf) const
+    {
+      if (not bencode_start_dict(buf))
+        return false;
+      if (not BEncodeWriteDictMsgType(buf, "A", "B"))
+        return false;
+      if (not BEncodeWriteDictEntry("C", after, buf))
+        return false;
+      if (not BEncodeWriteDictInt("N", pages, buf))
+        return false;
+      if (not BEncodeWriteDictInt("T", txid, buf))
+        return false;
+      if (not BEncodeWriteDictInt("U", since.count(), buf))
+        return false;
+      if (not BEncodeWriteDictInt("V", version, buf))
+        return false;
+      return bencode_end(buf);
+    }
+
+    bool
+    FindRCsMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+    {
+      if (key == "C")
+        return after.BDecode(val);
+      if (key == "N")
+        return bencode_read_integer(val, &pages);
+      if (key == "T")
+        return bencode_read_integer(val, &txid);
+      if (key == "U")
+      {
+        uint64_t ms;
+        if (not bencode_read_integer(val, &ms))
+          return false;
+        since = llarp_time_t{ms};
+        return true;
+      }
+      bool read = false;
+      if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+        return false;
+      return read;
+    }
+
+    bool
+    FindRCsMessage::HandleMessage(
+        llarp_dht_context* ctx,
+        __attribute__((unused)) std::vector<std::unique_ptr<IMessage>>& replies) const
+    {
+      auto* router = ctx->impl->GetRouter();
+      if (not router->IsServiceNode())
+        return false;
+      const RouterID from{From.as_array()};
+      const uint64_t numPages = std::clamp<uint64_t>(pages, 1, MaxPages);
+      RouterID next = after;
+      // each page goes as its own message, together they would not fit in one
+      for (uint64_t page = 0; page < numPages; ++page)
+      {
+        std::vector<RouterContact> found;
+        next = router->nodedb()->PageUpdatedSince(since, next, RCsPerPage, ScanPerPage, found);
+        const bool last = next.IsZero() or page + 1 == numPages;
+        DHTImmediateMessage msg;
+        msg.msgs.emplace_back(new GotRCsMessage(txid, std::move(found), next, last));
+        router->SendToOrQueue(from, &msg);
+        if (last)
+          break;
+      }
+      return true;
+    }
+  }  // namespace dht
+}  // namespace llarp
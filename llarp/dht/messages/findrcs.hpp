@@ -0,0 +1,44 @@
+#ifndef LLARP_DHT_MESSAGES_FIND_RCS_HPP
+#define LLARP_DHT_MESSAGES_FIND_RCS_HPP
+
+#include <dht/message.hpp>
+#include <router_id.hpp>
+#include <util/types.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// ask a service node for the rcs it has that were updated after since, walking its nodedb
+    /// in key order from past after. it answers with up to pages GotRCsMessage, the last of
+    /// them says where to ask from next. never relayed over paths
+    struct FindRCsMessage final : public IMessage
+    {
+      /// most pages one ask gets back
+      static constexpr uint64_t MaxPages = 8;
+
+      explicit FindRCsMessage(const Key_t& from) : IMessage(from)
+      {}
+
+      FindRCsMessage(uint64_t id, llarp_time_t _since, const RouterID& _after, uint64_t _pages)
+          : IMessage({}), after(_after), since(_since), pages(_pages), txid(id)
+      {}
+
+      bool
+      BEncode(llarp_buffer_t* buf) const override;
+
+      bool
+      DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+      bool
+      HandleMessage(
+          llarp_dht_context* ctx, std::vector<std::unique_ptr<IMessage>>& replies) const override;
+
+      RouterID after;
+      llarp_time_t since = 0s;
+      uint64_t pages = 1;
+      uint64_t txid = 0;
+    };
+  }  // namespace dht
+}  // namespace llarp
+#endif
@@ -7,6 +7,7 @@
 #include <router/abstractrouter.hpp>
 #include <routing/dht_message.hpp>
 #include <tooling/dht_event.hpp>
+#include <util/thread/logic.hpp>
 #include <utility>
 
 namespace llarp
@@ -30,19 +31,38 @@ namespace llarp
           (found.size() > 0 ? found[0] : llarp::service::EncryptedIntroSet{}),
           txid);
 
-      for (const auto& introset : found)
+      TXOwner owner(From, txid);
+      const auto now = dht.Now();
+      // repeats are answered from the verified cache right here, anything new has signatures
+      // to check and goes to a worker so the logic thread does not wait on them
+      if (service::AllVerified(found, now))
+        return HandleVerified(ctx, owner, found);
+      if (not dht.pendingIntrosetLookups().GetPendingLookupFrom(owner))
       {
-        if (!introset.Verify(dht.Now()))
-        {
-          LogWarn(
-              "Invalid introset while handling direct GotIntro "
-              "from ",
-              From);
-          return false;
-        }
+        LogError("no pending TX for GIM from ", From, " txid=", txid);
+        return false;
       }
-      TXOwner owner(From, txid);
+      router->QueueWork([ctx, router, owner, found = found, now]() mutable {
+        const bool valid = service::VerifyAll(found, now);
+        LogicCall(router->logic(), [ctx, owner, found = std::move(found), valid]() {
+          if (not valid)
+          {
+            LogWarn("Invalid introset while handling direct GotIntro from ", owner.node);
+            return;
+          }
+          HandleVerified(ctx, owner, found);
+        });
+      });
+      return true;
+    }
 
+    bool
+    GotIntroMessage::HandleVerified(
+        llarp_dht_context* ctx,
+        const TXOwner& owner,
+        const std::vector<service::EncryptedIntroSet>& found)
+    {
+      auto& dht = *ctx->impl;
       auto serviceLookup = dht.pendingIntrosetLookups().GetPendingLookupFrom(owner);
       if (serviceLookup)
       {
@@ -56,7 +76,7 @@ namespace llarp
         }
         return true;
       }
-      LogError("no pending TX for GIM from ", From, " txid=", txid);
+      LogError("no pending TX for GIM from ", owner.node, " txid=", owner.txid);
       return false;
     }
 
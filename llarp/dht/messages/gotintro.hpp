@@ -2,6 +2,7 @@
 #define LLARP_DHT_MESSAGES_GOT_INTRO_HPP
 
 #include <dht/message.hpp>
+#include <dht/txowner.hpp>
 #include <service/intro_set.hpp>
 #include <util/copy_or_nullptr.hpp>
 
@@ -49,6 +50,14 @@ namespace llarp
 
       bool
       HandleMessage(llarp_dht_context* ctx, std::vector<IMessage::Ptr_t>& replies) const override;
+
+     private:
+      /// hand found to the lookup owner is waiting on, once every introset in it checked out
+      static bool
+      HandleVerified(
+          llarp_dht_context* ctx,
+          const TXOwner& owner,
+          const std::vector<service::EncryptedIntroSet>& found);
     };
 
     struct RelayedGotIntroMessage final : public GotIntroMessage
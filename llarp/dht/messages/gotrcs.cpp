@@ -0,0 +1,64 @@
+#include <dht/messages/gotrcs.hpp>
+
+#include <dht/context.hpp>
+#include <router/abstractrouter.hpp>
+#include <router/i_rc_lookup_handler.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    bool
+    GotRCsMessage::BEncode(llarp_buffer_t* buf) const
+    {
+      if (not bencode_start_dict(buf))
+        return false;
+      if (not BEncodeWriteDictMsgType(buf, "A", "P"))
+        return false;
+      if (not BEncodeWriteDictEntry("C", next, buf))
+        return false;
+      if (not BEncodeWriteDictInt("L", last ? 1 : 0, buf))
+        return false;
+      if (not BEncodeWriteDictList("R", rcs, buf))
+        return false;
+      if (not BEncodeWriteDictInt("T", txid, buf))
+        return false;
+      if (not BEncodeWriteDictInt("V", version, buf))
+        return false;
+      return bencode_end(buf);
+    }
+
+    bool
+    GotRCsMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+    {
+      if (key == "C")
+        return next.BDecode(val);
+      if (key == "L")
+      {
+        uint64_t result;
+        if (not bencode_read_integer(val, &result))
+          return false;
+        last = result != 0;
+        return true;
+      }
+      if (key == "R")
+        return BEncodeReadList(rcs, val);
+      if (key == "T")
+        return bencode_read_integer(val, &txid);
+      bool read = false;
+      if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+        return false;
+      return read;
+    }
+
+    bool
+    GotRCsMessage::HandleMessage(
+        llarp_dht_context* ctx,
+        __attribute__((unused)) std::vector<std::unique_ptr<IMessage>>& replies) const
+    {
+      auto* router = ctx->impl->GetRouter();
+      return router->rcLookupHandler().HandleRCPage(
+          RouterID{From.as_array()}, txid, rcs, next, last);
+    }
+  }  // namespace dht
+}  // namespace llarp
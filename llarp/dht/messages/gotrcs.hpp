@@ -0,0 +1,44 @@
+#ifndef LLARP_DHT_MESSAGES_GOT_RCS_HPP
+#define LLARP_DHT_MESSAGES_GOT_RCS_HPP
+
+#include <dht/message.hpp>
+#include <router_contact.hpp>
+#include <router_id.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// one page of rcs in answer to a FindRCsMessage. next is where the walk goes on from,
+    /// zero once the asked for node has sent everything, last is set on the final page of
+    /// an answer
+    struct GotRCsMessage final : public IMessage
+    {
+      explicit GotRCsMessage(const Key_t& from) : IMessage(from)
+      {}
+
+      GotRCsMessage(
+          uint64_t id, std::vector<RouterContact> _rcs, const RouterID& _next, bool _last)
+          : IMessage({}), rcs(std::move(_rcs)), next(_next), txid(id), last(_last)
+      {}
+
+      bool
+      BEncode(llarp_buffer_t* buf) const override;
+
+      bool
+      DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+      bool
+      HandleMessage(
+          llarp_dht_context* ctx, std::vector<std::unique_ptr<IMessage>>& replies) const override;
+
+      std::vector<RouterContact> rcs;
+      RouterID next;
+      uint64_t txid = 0;
+      bool last = false;
+    };
+  }  // namespace dht
+}  // namespace llarp
+#endif
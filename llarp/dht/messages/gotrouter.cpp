@@ -2,6 +2,7 @@
 #include <dht/messages/gotrouter.hpp>
 
 #include <memory>
+#include <nodedb.hpp>
 #include <path/path_context.hpp>
 #include <router/abstractrouter.hpp>
 #include <router/i_rc_lookup_handler.hpp>
@@ -120,11 +121,14 @@ namespace llarp
       // store if valid
       for (const auto& rc : foundRCs)
       {
+        // txid == 0 on gossip
+        const bool known = txid == 0 and dht.GetRouter()->nodedb()->Has(rc.pubkey);
         if (not dht.GetRouter()->rcLookupHandler().CheckRC(rc))
           return false;
-        if (txid == 0)  // txid == 0 on gossip
+        if (txid == 0)
         {
           auto* router = dht.GetRouter();
+          dht.exploreScheduler().Seen(known ? 1 : 0, 1);
           router->NotifyRouterEvent<tooling::RCGossipReceivedEvent>(router->pubkey(), rc);
           router->GossipRCIfNeeded(rc);
 
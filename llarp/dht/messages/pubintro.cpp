@@ -5,7 +5,6 @@
 #include <messages/dht_immediate.hpp>
 #include <router/abstractrouter.hpp>
 #include <routing/dht_message.hpp>
-#include <nodedb.hpp>
 
 #include <tooling/dht_event.hpp>
 
@@ -85,29 +84,28 @@ namespace llarp
         return true;
       }
 
-      // identify closest 4 routers
-      auto closestRCs = dht.GetRouter()->nodedb()->FindClosestTo(addr, IntroSetStorageRedundancy);
-      if (closestRCs.size() != IntroSetStorageRedundancy)
+      // the 4 routers that store this introset
+      const auto storage = IntroSetStorageFor(router, addr);
+      if (storage.size() != IntroSetStorageRedundancy)
       {
-        llarp::LogWarn("Received PublishIntroMessage but only know ", closestRCs.size(), " nodes");
+        llarp::LogWarn("Received PublishIntroMessage but only know ", storage.size(), " nodes");
         replies.emplace_back(new GotIntroMessage({}, txID));
         return true;
       }
 
       const auto& us = dht.OurKey();
 
-      // function to identify the closest 4 routers we know of for this introset
+      // function to hand the introset to the one of them at index
       auto propagateIfNotUs = [&](size_t index) {
         assert(index < IntroSetStorageRedundancy);
 
-        const auto& rc = closestRCs[index];
-        const Key_t peer{rc.pubkey};
+        const Key_t& peer = storage[index];
 
         if (peer == us)
         {
           llarp::LogInfo("we are peer ", index, " so storing instead of propagating");
 
-          dht.services()->PutNode(introset);
+          dht.services()->Put(introset);
           replies.emplace_back(new GotIntroMessage({introset}, txID));
         }
         else
@@ -139,28 +137,10 @@ namespace llarp
       }
       else
       {
-        int candidateNumber = -1;
-        int index = 0;
-        for (const auto& rc : closestRCs)
+        if (StoresIntroSetAt(router, addr))
         {
-          if (rc.pubkey == dht.OurKey())
-          {
-            candidateNumber = index;
-            break;
-          }
-          ++index;
-        }
-
-        if (candidateNumber >= 0)
-        {
-          LogInfo(
-              "Received PubIntro for ",
-              keyStr,
-              ", txid=",
-              txID,
-              " and we are candidate ",
-              candidateNumber);
-          dht.services()->PutNode(introset);
+          LogInfo("Received PubIntro for ", keyStr, ", txid=", txID, " and we are candidate");
+          dht.services()->Put(introset);
           replies.emplace_back(new GotIntroMessage({introset}, txID));
         }
         else
@@ -0,0 +1,67 @@
+#include <dht/messages/rcdigest.hpp>
+
+#include <dht/context.hpp>
+#include <router/abstractrouter.hpp>
+#include <router/i_gossiper.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    bool
+    RCDigestMessage::BEncode(llarp_buffer_t* buf) const
+    {
+      if (not bencode_start_dict(buf))
+        return false;
+      if (not BEncodeWriteDictMsgType(buf, "A", "D"))
+        return false;
+      if (not BEncodeWriteDictString("D", digest.bits, buf))
+        return false;
+      if (not BEncodeWriteDictInt("K", digest.hashes, buf))
+        return false;
+      if (not BEncodeWriteDictInt("N", digest.seed, buf))
+        return false;
+      if (not BEncodeWriteDictInt("V", version, buf))
+        return false;
+      return bencode_end(buf);
+    }
+
+    bool
+    RCDigestMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+    {
+      if (key == "D")
+      {
+        llarp_buffer_t strbuf;
+        if (not bencode_read_string(val, &strbuf) or strbuf.sz > RCDigest::MaxBytes)
+          return false;
+        digest.bits.assign(strbuf.base, strbuf.base + strbuf.sz);
+        return true;
+      }
+      if (key == "K")
+        return bencode_read_integer(val, &digest.hashes);
+      if (key == "N")
+        return bencode_read_integer(val, &digest.seed);
+      bool read = false;
+      if (not BEncodeMaybeVerifyVersion("V", version, LLARP_PROTO_VERSION, read, key, val))
+        return false;
+      return read;
+    }
+
+    bool
+    RCDigestMessage::HandleMessage(
+        llarp_dht_context* ctx,
+        __attribute__((unused)) std::vector<std::unique_ptr<IMessage>>& replies) const
+    {
+      auto* router = ctx->impl->GetRouter();
+      if (not router->IsServiceNode())
+        return false;
+      if (not digest.IsValid())
+      {
+        LogWarn("bad rc digest from ", From);
+        return false;
+      }
+      router->rcGossiper().HandleDigest(RouterID{From.as_array()}, digest);
+      return true;
+    }
+  }  // namespace dht
+}  // namespace llarp
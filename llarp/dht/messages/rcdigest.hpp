@@ -0,0 +1,35 @@
+#ifndef LLARP_DHT_MESSAGES_RC_DIGEST_HPP
+#define LLARP_DHT_MESSAGES_RC_DIGEST_HPP
+
+#include <dht/message.hpp>
+#include <router/rc_digest.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// a service node telling a peer which rcs it has, so the peer gossips it only the ones it
+    /// is missing. never relayed over paths
+    struct RCDigestMessage final : public IMessage
+    {
+      explicit RCDigestMessage(const Key_t& from) : IMessage(from)
+      {}
+
+      RCDigestMessage(const Key_t& from, RCDigest d) : IMessage(from), digest(std::move(d))
+      {}
+
+      bool
+      BEncode(llarp_buffer_t* buf) const override;
+
+      bool
+      DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+      bool
+      HandleMessage(
+          llarp_dht_context* ctx, std::vector<std::unique_ptr<IMessage>>& replies) const override;
+
+      RCDigest digest;
+    };
+  }  // namespace dht
+}  // namespace llarp
+#endif
@@ -46,10 +46,11 @@ namespace llarp
     {
       if (valuesFound.size())
       {
+        parent->GetRouter()->rcLookupHandler().CheckRCs(valuesFound);
         RouterContact found;
         for (const auto& rc : valuesFound)
         {
-          if (found.OtherIsNewer(rc) && parent->GetRouter()->rcLookupHandler().CheckRC(rc))
+          if (found.OtherIsNewer(rc))
             found = rc;
         }
         valuesFound.clear();
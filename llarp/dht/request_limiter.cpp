@@ -0,0 +1,97 @@
+#include <dht/request_limiter.hpp>
+
+#include <dht/messages/findintro.hpp>
+#include <dht/messages/findname.hpp>
+#include <dht/messages/findrouter.hpp>
+
+namespace llarp
+{
+  namespace dht
+  {
+    static constexpr std::array<const char*, static_cast<size_t>(RequestLimiter::Kind::Count)>
+        KindNames{"findIntro", "findRouter", "findName", "other", "undecoded"};
+
+    RequestLimiter::Kind
+    RequestLimiter::KindOf(const IMessage& msg)
+    {
+      if (dynamic_cast<const FindIntroMessage*>(&msg))
+        return Kind::FindIntro;
+      if (dynamic_cast<const FindRouterMessage*>(&msg))
+        return Kind::FindRouter;
+      if (dynamic_cast<const FindNameMessage*>(&msg))
+        return Kind::FindName;
+      return Kind::Other;
+    }
+
+    template <typename Map_t, typename Key_t>
+    RequestLimiter::Bucket&
+    RequestLimiter::BucketFor(
+        Map_t& buckets, const Key_t& key, double rate, double burst, llarp_time_t now)
+    {
+      auto itr = buckets.find(key);
+      if (itr == buckets.end())
+        itr = buckets.emplace(key, Bucket{util::TokenBucket{rate, burst}, now}).first;
+      itr->second.lastUsed = now;
+      return itr->second;
+    }
+
+    bool
+    RequestLimiter::Allow(const RouterID& peer, const PathID_t& path, Kind kind, llarp_time_t now)
+    {
+      auto& pathBucket = BucketFor(m_Paths, path, PathRate, PathBurst, now);
+      auto& peerBucket = BucketFor(m_Peers, peer, PeerRate, PeerBurst, now);
+      if (pathBucket.tokens.Available(now) < 1.0 or not peerBucket.tokens.Take(now))
+      {
+        m_Rejected[static_cast<size_t>(kind)]++;
+        return false;
+      }
+      pathBucket.tokens.Take(now);
+      m_Allowed[static_cast<size_t>(kind)]++;
+      return true;
+    }
+
+    bool
+    RequestLimiter::Exhausted(const RouterID& peer, const PathID_t& path, llarp_time_t now)
+    {
+      const auto empty = [now](auto& buckets, const auto& key) {
+        auto itr = buckets.find(key);
+        return itr != buckets.end() and itr->second.tokens.Available(now) < 1.0;
+      };
+      if (not empty(m_Paths, path) and not empty(m_Peers, peer))
+        return false;
+      m_Rejected[static_cast<size_t>(Kind::Undecoded)]++;
+      return true;
+    }
+
+    void
+    RequestLimiter::Expire(llarp_time_t now)
+    {
+      const auto expire = [now](auto& buckets) {
+        for (auto itr = buckets.begin(); itr != buckets.end();)
+        {
+          if (now >= itr->second.lastUsed + IdleTimeout)
+            itr = buckets.erase(itr);
+          else
+            ++itr;
+        }
+      };
+      expire(m_Paths);
+      expire(m_Peers);
+    }
+
+    util::StatusObject
+    RequestLimiter::ExtractStatus() const
+    {
+      util::StatusObject allowed, rejected;
+      for (size_t idx = 0; idx < KindNames.size(); ++idx)
+      {
+        allowed[KindNames[idx]] = m_Allowed[idx];
+        rejected[KindNames[idx]] = m_Rejected[idx];
+      }
+      return util::StatusObject{{"paths", uint64_t(m_Paths.size())},
+                                {"peers", uint64_t(m_Peers.size())},
+                                {"allowed", allowed},
+                                {"rejected", rejected}};
+    }
+  }  // namespace dht
+}  // namespace llarp
@@ -0,0 +1,91 @@
+#ifndef LLARP_DHT_REQUEST_LIMITER_HPP
+#define LLARP_DHT_REQUEST_LIMITER_HPP
+
+#include <path/path_types.hpp>
+#include <router_id.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+#include <util/token_bucket.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace dht
+  {
+    struct IMessage;
+
+    /// token buckets for the dht requests clients send us over the paths that end at us, one
+    /// for each path and one for each relay the paths come in from, so a few clients sending
+    /// lookups as fast as they can do not crowd out everyone else's. logic thread only
+    struct RequestLimiter
+    {
+      /// requests a second one path may make, and how many at once
+      static constexpr double PathRate = 8;
+      static constexpr double PathBurst = 32;
+      /// requests a second all the paths through one relay may make, and how many at once
+      static constexpr double PeerRate = 64;
+      static constexpr double PeerBurst = 256;
+      /// a bucket not used for this long has refilled and is forgotten
+      static constexpr auto IdleTimeout = 1min;
+
+      enum class Kind
+      {
+        FindIntro,
+        FindRouter,
+        FindName,
+        Other,
+        /// turned away before the messages were decoded
+        Undecoded,
+        Count
+      };
+
+      static Kind
+      KindOf(const IMessage& msg);
+
+      /// take a token for a request of kind from path coming in from peer, false if either
+      /// is out of them in which case neither is taken from
+      bool
+      Allow(const RouterID& peer, const PathID_t& path, Kind kind, llarp_time_t now);
+
+      /// true if path or peer has no tokens left, so the dht messages they sent can be turned
+      /// away before decoding them. counted as an undecoded rejection when it is
+      bool
+      Exhausted(const RouterID& peer, const PathID_t& path, llarp_time_t now);
+
+      /// forget the buckets that went idle
+      void
+      Expire(llarp_time_t now);
+
+      uint64_t
+      Rejected(Kind kind) const
+      {
+        return m_Rejected[static_cast<size_t>(kind)];
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Bucket
+      {
+        util::TokenBucket tokens;
+        llarp_time_t lastUsed;
+      };
+
+      /// the bucket for key, made full if there is none
+      template <typename Map_t, typename Key_t>
+      static Bucket&
+      BucketFor(Map_t& buckets, const Key_t& key, double rate, double burst, llarp_time_t now);
+
+      std::unordered_map<PathID_t, Bucket, PathID_t::Hash> m_Paths;
+      std::unordered_map<RouterID, Bucket, RouterID::Hash> m_Peers;
+      std::array<uint64_t, static_cast<size_t>(Kind::Count)> m_Allowed{};
+      std::array<uint64_t, static_cast<size_t>(Kind::Count)> m_Rejected{};
+    };
+  }  // namespace dht
+}  // namespace llarp
+
+#endif
@@ -4,10 +4,13 @@
 #include <dht/tx.hpp>
 #include <dht/txowner.hpp>
 #include <util/time.hpp>
+#include <util/timer_wheel.hpp>
 #include <util/status.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace llarp
 {
@@ -23,6 +26,17 @@ namespace llarp
       std::unordered_map<K, llarp_time_t, K_Hash> timeouts;
       // maps remote peer with tx to handle reply from them
       std::unordered_map<TXOwner, TXPtr, TXOwner::Hash> tx;
+      // the other peers a parallel tx asked, to the owner its tx is kept under
+      std::unordered_map<TXOwner, TXOwner, TXOwner::Hash> siblings;
+      // the peers a parallel tx is still waiting on, by the owner its tx is kept under
+      std::unordered_map<TXOwner, std::vector<TXOwner>, TXOwner::Hash> asking;
+      // fires when entries in timeouts may be due so Expire does not walk all of them
+      // entries are not cancelled when a timeout is removed, they check it is still due instead
+      util::TimerWheel timeoutWheel;
+      uint32_t nextTimeoutID = 0;
+      // txs that sent a request, and txs that waited on one already out for their key
+      uint64_t started = 0;
+      uint64_t coalesced = 0;
 
       const TX<K, V>*
       GetPendingLookupFrom(const TXOwner& owner) const;
@@ -30,7 +44,7 @@ namespace llarp
       util::StatusObject
       ExtractStatus() const
       {
-        util::StatusObject obj{};
+        util::StatusObject obj{{"started", started}, {"coalesced", coalesced}};
         std::vector<util::StatusObject> txObjs, timeoutsObjs, waitingObjs;
         std::transform(
             tx.begin(),
@@ -82,6 +96,17 @@ namespace llarp
           TX<K, V>* t,
           llarp_time_t requestTimeoutMS = 15s);
 
+      /// ask every peer in askpeers for k at once through one tx kept under the first of
+      /// them. the first answer wins and drops the rest, a peer without one only ends the
+      /// tx once all the others have said the same
+      void
+      NewParallelTX(
+          const std::vector<TXOwner>& askpeers,
+          const TXOwner& whoasked,
+          const K& k,
+          TX<K, V>* t,
+          llarp_time_t requestTimeoutMS = 15s);
+
       /// mark tx as not fond
       void
       NotFound(const TXOwner& from, const std::unique_ptr<Key_t>& next);
@@ -103,13 +128,25 @@ namespace llarp
 
       void
       Expire(llarp_time_t now);
+
+     private:
+      void
+      ExpireKey(const K& key);
+
+      /// the owner the tx for a reply from owner is kept under
+      const TXOwner&
+      Primary(const TXOwner& owner) const;
+
+      /// drop what is left of the parallel asks of the tx kept under owner
+      void
+      Forget(const TXOwner& owner);
     };
 
     template <typename K, typename V, typename K_Hash>
     const TX<K, V>*
     TXHolder<K, V, K_Hash>::GetPendingLookupFrom(const TXOwner& owner) const
     {
-      auto itr = tx.find(owner);
+      auto itr = tx.find(Primary(owner));
       if (itr == tx.end())
       {
         return nullptr;
@@ -118,6 +155,26 @@ namespace llarp
       return itr->second.get();
     }
 
+    template <typename K, typename V, typename K_Hash>
+    const TXOwner&
+    TXHolder<K, V, K_Hash>::Primary(const TXOwner& owner) const
+    {
+      auto itr = siblings.find(owner);
+      return itr == siblings.end() ? owner : itr->second;
+    }
+
+    template <typename K, typename V, typename K_Hash>
+    void
+    TXHolder<K, V, K_Hash>::Forget(const TXOwner& owner)
+    {
+      auto itr = asking.find(owner);
+      if (itr == asking.end())
+        return;
+      for (const auto& peer : itr->second)
+        siblings.erase(peer);
+      asking.erase(itr);
+    }
+
     template <typename K, typename V, typename K_Hash>
     void
     TXHolder<K, V, K_Hash>::NewTX(
@@ -135,23 +192,63 @@ namespace llarp
       auto itr = timeouts.find(k);
       if (itr == timeouts.end())
       {
-        timeouts.emplace(k, time_now_ms() + requestTimeoutMS);
+        const auto now = time_now_ms();
+        timeouts.emplace(k, now + requestTimeoutMS);
+        timeoutWheel.Schedule(
+            nextTimeoutID++, now, requestTimeoutMS, [this, k]() { ExpireKey(k); });
       }
       if (count == 0)
       {
+        started++;
         t->Start(askpeer);
       }
+      else
+        coalesced++;
+    }
+
+    template <typename K, typename V, typename K_Hash>
+    void
+    TXHolder<K, V, K_Hash>::NewParallelTX(
+        const std::vector<TXOwner>& askpeers,
+        const TXOwner& whoasked,
+        const K& k,
+        TX<K, V>* t,
+        llarp_time_t requestTimeoutMS)
+    {
+      // someone already asking for k answers this one too
+      const bool joined = waiting.count(k) > 0;
+      const TXOwner primary = askpeers.front();
+      NewTX(primary, whoasked, k, t, requestTimeoutMS);
+      if (joined or askpeers.size() == 1)
+        return;
+      asking[primary] = askpeers;
+      for (auto itr = askpeers.begin() + 1; itr != askpeers.end(); ++itr)
+      {
+        siblings.emplace(*itr, primary);
+        t->Start(*itr);
+      }
     }
 
     template <typename K, typename V, typename K_Hash>
     void
     TXHolder<K, V, K_Hash>::NotFound(const TXOwner& from, const std::unique_ptr<Key_t>&)
     {
-      auto txitr = tx.find(from);
+      const TXOwner primary = Primary(from);
+      auto txitr = tx.find(primary);
       if (txitr == tx.end())
       {
         return;
       }
+      auto askitr = asking.find(primary);
+      if (askitr != asking.end())
+      {
+        auto& peers = askitr->second;
+        peers.erase(std::remove(peers.begin(), peers.end(), from), peers.end());
+        siblings.erase(from);
+        // another peer may still have it
+        if (not peers.empty())
+          return;
+      }
       Inform(from, txitr->second->target, {}, true, true);
     }
 
@@ -175,6 +272,7 @@ namespace llarp
           {
             txitr->second->SendReply();
             tx.erase(txitr);
+            Forget(itr->second);
           }
         }
         ++itr;
@@ -195,19 +293,19 @@ namespace llarp
     void
     TXHolder<K, V, K_Hash>::Expire(llarp_time_t now)
     {
-      auto itr = timeouts.begin();
-      while (itr != timeouts.end())
-      {
-        if (now >= itr->second)
-        {
-          Inform(TXOwner{}, itr->first, {}, true, false);
-          itr = timeouts.erase(itr);
-        }
-        else
-        {
-          ++itr;
-        }
-      }
+      timeoutWheel.Advance(now);
+    }
+
+    template <typename K, typename V, typename K_Hash>
+    void
+    TXHolder<K, V, K_Hash>::ExpireKey(const K& key)
+    {
+      auto itr = timeouts.find(key);
+      // answered already or asked for again with a later timeout
+      if (itr == timeouts.end() or timeoutWheel.Now() < itr->second)
+        return;
+      Inform(TXOwner{}, key, {}, true, false);
+      timeouts.erase(key);
     }
   }  // namespace dht
 }  // namespace llarp
@@ -51,9 +51,7 @@ namespace llarp
         std::size_t
         operator()(const TXOwner& o) const noexcept
         {
-          std::size_t sz2;
-          memcpy(&sz2, o.node.data(), sizeof(std::size_t));
-          return o.txid ^ (sz2 << 1);
+          return KeyedHash(&o.txid, sizeof(o.txid)) ^ (Key_t::Hash()(o.node) << 1);
         }
       };
     };
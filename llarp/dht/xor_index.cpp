@@ -0,0 +1,98 @@
+#include <dht/xor_index.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace llarp
+{
+  namespace dht
+  {
+    static constexpr size_t KeyBits = Key_t::SIZE * 8;
+
+    static bool
+    bit_at(const byte_t* data, size_t bit)
+    {
+      return data[bit / 8] & (0x80 >> (bit % 8));
+    }
+
+    void
+    XorIndex::Insert(const RouterID& id)
+    {
+      m_IDs.insert(id);
+    }
+
+    void
+    XorIndex::Remove(const RouterID& id)
+    {
+      m_IDs.erase(id);
+    }
+
+    void
+    XorIndex::Clear()
+    {
+      m_IDs.clear();
+    }
+
+    size_t
+    XorIndex::Size() const
+    {
+      return m_IDs.size();
+    }
+
+    std::vector<RouterID>
+    XorIndex::FindClosest(const Key_t& location, size_t k) const
+    {
+      std::vector<RouterID> out;
+      if (k == 0)
+        return out;
+      out.reserve(std::min(k, m_IDs.size()));
+      Walk(m_IDs.begin(), m_IDs.end(), 0, RouterID{}, location, k, out);
+      return out;
+    }
+
+    void
+    XorIndex::ForEachAfter(const RouterID& after, std::function<bool(const RouterID&)> visit) const
+    {
+      for (auto itr = m_IDs.upper_bound(after); itr != m_IDs.end(); ++itr)
+      {
+        if (not visit(*itr))
+          return;
+      }
+    }
+
+    void
+    XorIndex::Walk(
+        Set_t::const_iterator lo,
+        Set_t::const_iterator hi,
+        size_t depth,
+        const RouterID& prefix,
+        const Key_t& location,
+        size_t k,
+        std::vector<RouterID>& out) const
+    {
+      if (lo == hi or out.size() >= k)
+        return;
+      // one id left or nothing left to split on, ids are unique so both end here
+      if (std::next(lo) == hi or depth == KeyBits)
+      {
+        out.push_back(*lo);
+        return;
+      }
+      // every id under the side that agrees with location on this bit is closer than any
+      // on the other side, so take that side first
+      RouterID upper = prefix;
+      upper[depth / 8] |= 0x80 >> (depth % 8);
+      const auto mid = m_IDs.lower_bound(upper);
+      if (bit_at(location.data(), depth))
+      {
+        Walk(mid, hi, depth + 1, upper, location, k, out);
+        Walk(lo, mid, depth + 1, prefix, location, k, out);
+      }
+      else
+      {
+        Walk(lo, mid, depth + 1, prefix, location, k, out);
+        Walk(mid, hi, depth + 1, upper, location, k, out);
+      }
+    }
+  }  // namespace dht
+}  // namespace llarp
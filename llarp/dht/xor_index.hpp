@@ -0,0 +1,61 @@
+#ifndef LLARP_DHT_XOR_INDEX_HPP
+#define LLARP_DHT_XOR_INDEX_HPP
+
+#include <dht/key.hpp>
+#include <router_id.hpp>
+
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace llarp
+{
+  namespace dht
+  {
+    /// router ids kept in key order, which is a binary radix tree flattened: every id that
+    /// shares a prefix sits in one run, split in two by the next bit. the k closest to a
+    /// location by xor come from walking down the location's bits and only opening the runs
+    /// that can still hold a closer id, O(k log n) and no full table sort
+    struct XorIndex
+    {
+      void
+      Insert(const RouterID& id);
+
+      void
+      Remove(const RouterID& id);
+
+      void
+      Clear();
+
+      size_t
+      Size() const;
+
+      /// up to k ids closest to location by xor, closest first
+      std::vector<RouterID>
+      FindClosest(const Key_t& location, size_t k) const;
+
+      /// visit the ids past after in key order until visit returns false, so a long walk can be
+      /// taken in pieces by going on from the last id seen
+      void
+      ForEachAfter(const RouterID& after, std::function<bool(const RouterID&)> visit) const;
+
+     private:
+      using Set_t = std::set<RouterID>;
+
+      /// ids in [lo, hi) share the first depth bits of prefix, the rest of prefix is zero
+      void
+      Walk(
+          Set_t::const_iterator lo,
+          Set_t::const_iterator hi,
+          size_t depth,
+          const RouterID& prefix,
+          const Key_t& location,
+          size_t k,
+          std::vector<RouterID>& out) const;
+
+      Set_t m_IDs;
+    };
+  }  // namespace dht
+}  // namespace llarp
+
+#endif
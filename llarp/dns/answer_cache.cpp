@@ -0,0 +1,172 @@
+#include <dns/answer_cache.hpp>
+
+#include <dns/message_view.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace llarp
+{
+  namespace dns
+  {
+    static constexpr size_t HeaderSize = 12;
+    static constexpr uint16_t OPTType = 41;
+
+    static uint16_t
+    ReadU16(const byte_t* ptr)
+    {
+      return (uint16_t{ptr[0]} << 8) | ptr[1];
+    }
+
+    static uint32_t
+    ReadU32(const byte_t* ptr)
+    {
+      return (uint32_t{ReadU16(ptr)} << 16) | ReadU16(ptr + 2);
+    }
+
+    static void
+    WriteU32(byte_t* ptr, uint32_t val)
+    {
+      ptr[0] = val >> 24;
+      ptr[1] = val >> 16;
+      ptr[2] = val >> 8;
+      ptr[3] = val;
+    }
+
+    /// the key for the one question in the wire format message in buf and the offset just
+    /// past it, nullopt unless there is exactly one
+    static std::optional<std::pair<std::string, size_t>>
+    QuestionKey(const llarp_buffer_t& buf)
+    {
+      MessageView view;
+      if (not view.Parse(buf) or view.qdCount != 1)
+        return std::nullopt;
+      std::string key(reinterpret_cast<const char*>(view.qname), view.qnameSize + 4);
+      // labels are lowercased, their lengths and the qtype and qclass are left alone
+      for (size_t off = 0; off + 1 < view.qnameSize; off += view.qname[off] + 1)
+      {
+        for (size_t idx = off + 1; idx <= off + view.qname[off]; ++idx)
+        {
+          if (key[idx] >= 'A' and key[idx] <= 'Z')
+            key[idx] += 'a' - 'A';
+        }
+      }
+      return std::make_pair(std::move(key), view.questionEnd);
+    }
+
+    /// offset past the possibly compressed name at off, nullopt if it runs off the end
+    static std::optional<size_t>
+    SkipName(const llarp_buffer_t& buf, size_t off)
+    {
+      while (off < buf.sz)
+      {
+        const byte_t len = buf.base[off];
+        if ((len & 0xc0) == 0xc0)
+          return off + 2;
+        if (len & 0xc0)
+          return std::nullopt;
+        off += len + 1;
+        if (len == 0)
+          return off;
+      }
+      return std::nullopt;
+    }
+
+    void
+    AnswerCache::Put(const llarp_buffer_t& reply, llarp_time_t now)
+    {
+      if (reply.sz < HeaderSize)
+        return;
+      const byte_t flags = reply.base[2];
+      const byte_t rcode = reply.base[3] & 0x0f;
+      // a response, not truncated, and either no error or no such name
+      if ((flags & 0x80) == 0 or (flags & 0x02) or (rcode != 0 and rcode != 3))
+        return;
+      auto question = QuestionKey(reply);
+      if (not question)
+        return;
+      size_t off = question->second;
+      const size_t numRecords =
+          size_t{ReadU16(reply.base + 6)} + ReadU16(reply.base + 8) + ReadU16(reply.base + 10);
+      Entry entry;
+      uint32_t minTTL = std::numeric_limits<uint32_t>::max();
+      for (size_t idx = 0; idx < numRecords; ++idx)
+      {
+        const auto end = SkipName(reply, off);
+        if (not end or *end + 10 > reply.sz)
+          return;
+        off = *end;
+        const uint16_t type = ReadU16(reply.base + off);
+        const uint16_t rdlen = ReadU16(reply.base + off + 8);
+        // the opt pseudo record uses its ttl field for flags
+        if (type != OPTType)
+        {
+          const uint32_t ttl = ReadU32(reply.base + off + 4);
+          entry.ttls.emplace_back(off + 4, ttl);
+          minTTL = std::min(minTTL, ttl);
+        }
+        off += 10 + rdlen;
+        if (off > reply.sz)
+          return;
+      }
+      if (entry.ttls.empty() or minTTL == 0)
+        return;
+
+      const auto ttl = std::min<llarp_time_t>(std::chrono::seconds{minTTL}, MaxTTL);
+      entry.reply.assign(reply.base, reply.base + reply.sz);
+      entry.stored = now;
+      entry.expires = now + ttl;
+
+      if (auto itr = m_Entries.find(question->first); itr != m_Entries.end())
+        Erase(itr);
+      else if (m_Entries.size() >= MaxEntries)
+        Erase(m_Entries.find(m_ByUse.front()));
+      entry.pos = m_ByUse.insert(m_ByUse.end(), question->first);
+      m_Entries.emplace(std::move(question->first), std::move(entry));
+    }
+
+    std::optional<std::vector<byte_t>>
+    AnswerCache::Get(const llarp_buffer_t& query, llarp_time_t now)
+    {
+      // only plain queries, opcode 0
+      if (query.sz < HeaderSize or (query.base[2] & 0xf8) != 0)
+        return std::nullopt;
+      const auto question = QuestionKey(query);
+      if (not question)
+        return std::nullopt;
+      const auto itr = m_Entries.find(question->first);
+      if (itr == m_Entries.end())
+      {
+        m_Misses++;
+        return std::nullopt;
+      }
+      if (now >= itr->second.expires)
+      {
+        Erase(itr);
+        m_Misses++;
+        return std::nullopt;
+      }
+      m_Hits++;
+      auto& entry = itr->second;
+      m_ByUse.splice(m_ByUse.end(), m_ByUse, entry.pos);
+
+      std::vector<byte_t> reply = entry.reply;
+      // their id and recursion desired bit
+      reply[0] = query.base[0];
+      reply[1] = query.base[1];
+      reply[2] = (reply[2] & 0xfe) | (query.base[2] & 0x01);
+      const auto held = std::chrono::duration_cast<std::chrono::seconds>(now - entry.stored);
+      for (const auto& [off, ttl] : entry.ttls)
+        WriteU32(reply.data() + off, ttl - held.count());
+      return reply;
+    }
+
+    void
+    AnswerCache::Erase(std::unordered_map<std::string, Entry>::iterator itr)
+    {
+      m_ByUse.erase(itr->second.pos);
+      m_Entries.erase(itr);
+    }
+  }  // namespace dns
+}  // namespace llarp
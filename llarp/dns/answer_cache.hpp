@@ -0,0 +1,77 @@
+#ifndef LLARP_DNS_ANSWER_CACHE_HPP
+#define LLARP_DNS_ANSWER_CACHE_HPP
+
+#include <util/buffer.hpp>
+#include <util/time.hpp>
+
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace dns
+  {
+    /// replies from upstream kept in wire format by question, so a repeat query is answered
+    /// without going to the resolver or through dns::Message. the question's wire bytes with
+    /// the name lowercased are the key, and a hit has its ttls lowered in place by how long it
+    /// was held. the least recently used reply goes when full. not thread safe.
+    struct AnswerCache
+    {
+      static constexpr size_t MaxEntries = 1024;
+      /// hold nothing longer than this whatever its ttl says
+      static constexpr auto MaxTTL = 1h;
+
+      /// keep the wire format reply if it answers a single question with records that all
+      /// have a ttl and did not fail or get truncated
+      void
+      Put(const llarp_buffer_t& reply, llarp_time_t now);
+
+      /// the kept reply to the wire format query with its id and ttls made current
+      std::optional<std::vector<byte_t>>
+      Get(const llarp_buffer_t& query, llarp_time_t now);
+
+      size_t
+      Size() const
+      {
+        return m_Entries.size();
+      }
+
+      uint64_t
+      Hits() const
+      {
+        return m_Hits;
+      }
+
+      uint64_t
+      Misses() const
+      {
+        return m_Misses;
+      }
+
+     private:
+      struct Entry
+      {
+        std::vector<byte_t> reply;
+        /// where each ttl is in reply and what it was when we got it
+        std::vector<std::pair<size_t, uint32_t>> ttls;
+        llarp_time_t stored;
+        llarp_time_t expires;
+        std::list<std::string>::iterator pos;
+      };
+
+      void
+      Erase(std::unordered_map<std::string, Entry>::iterator itr);
+
+      std::unordered_map<std::string, Entry> m_Entries;
+      /// keys least recently used first
+      std::list<std::string> m_ByUse;
+      uint64_t m_Hits = 0;
+      uint64_t m_Misses = 0;
+    };
+  }  // namespace dns
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,129 @@
+#include <dns/message_view.hpp>
+
+#include <dns/dns.hpp>
+
+namespace llarp
+{
+  namespace dns
+  {
+    static constexpr size_t HeaderSize = 12;
+
+    static uint16_t
+    ReadU16(const byte_t* ptr)
+    {
+      return (uint16_t{ptr[0]} << 8) | ptr[1];
+    }
+
+    static void
+    WriteU16(byte_t* ptr, uint16_t val)
+    {
+      ptr[0] = val >> 8;
+      ptr[1] = val;
+    }
+
+    bool
+    MessageView::Parse(const llarp_buffer_t& buf)
+    {
+      if (buf.sz < HeaderSize)
+        return false;
+      id = ReadU16(buf.base);
+      fields = ReadU16(buf.base + 2);
+      qdCount = ReadU16(buf.base + 4);
+      anCount = ReadU16(buf.base + 6);
+      nsCount = ReadU16(buf.base + 8);
+      arCount = ReadU16(buf.base + 10);
+      if (qdCount == 0)
+        return false;
+      size_t off = HeaderSize;
+      while (true)
+      {
+        if (off >= buf.sz)
+          return false;
+        const byte_t len = buf.base[off];
+        // the first name in a message has nothing before it to point at
+        if (len & 0xc0)
+          return false;
+        off += len + 1;
+        if (len == 0)
+          break;
+      }
+      if (off + 4 > buf.sz)
+        return false;
+      qname = buf.base + HeaderSize;
+      qnameSize = off - HeaderSize;
+      qtype = ReadU16(buf.base + off);
+      qclass = ReadU16(buf.base + off + 2);
+      questionEnd = off + 4;
+      return true;
+    }
+
+    bool
+    MessageView::IsName(std::string_view name) const
+    {
+      if (not name.empty() and name.back() == '.')
+        name.remove_suffix(1);
+      if (DottedSize() != name.size() + 1)
+        return false;
+      bool same = true;
+      ForEachChar([&](size_t idx, char ch) {
+        if (idx < name.size() and ch != name[idx])
+          same = false;
+      });
+      return same;
+    }
+
+    bool
+    MessageView::HasTLD(std::string_view tld) const
+    {
+      // tld is followed by the trailing dot
+      const size_t size = DottedSize();
+      if (size < tld.size() + 1)
+        return false;
+      const size_t start = size - tld.size() - 1;
+      bool same = true;
+      ForEachChar([&](size_t idx, char ch) {
+        if (idx >= start and idx < start + tld.size() and ch != tld[idx - start])
+          same = false;
+      });
+      return same;
+    }
+
+    std::string
+    MessageView::QName() const
+    {
+      std::string name;
+      name.reserve(DottedSize());
+      ForEachChar([&name](size_t, char ch) { name += ch; });
+      return name;
+    }
+
+    ReplyWriter::ReplyWriter(std::vector<byte_t>& msg, const MessageView& query)
+        : m_Msg(msg), m_Fields(query.fields)
+    {
+      m_Msg.resize(query.questionEnd);
+      WriteU16(m_Msg.data() + 4, 1);
+      WriteU16(m_Msg.data() + 6, 0);
+      WriteU16(m_Msg.data() + 8, 0);
+      WriteU16(m_Msg.data() + 10, 0);
+    }
+
+    void
+    ReplyWriter::NX()
+    {
+      SetFields(((m_Fields | flags_QR | flags_AA | flags_RA) & ~flags_RD) | flags_RCODENameError);
+    }
+
+    void
+    ReplyWriter::ServFail()
+    {
+      SetFields(((m_Fields | flags_QR | flags_AA | flags_RA) & ~flags_RD) | flags_RCODEServFail);
+    }
+
+    void
+    ReplyWriter::SetFields(uint16_t fields)
+    {
+      m_Fields = fields;
+      WriteU16(m_Msg.data() + 2, fields);
+    }
+  }  // namespace dns
+}  // namespace llarp
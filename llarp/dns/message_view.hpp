@@ -0,0 +1,97 @@
+#ifndef LLARP_DNS_MESSAGE_VIEW_HPP
+#define LLARP_DNS_MESSAGE_VIEW_HPP
+
+#include <dns/message.hpp>
+#include <util/buffer.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llarp
+{
+  namespace dns
+  {
+    /// the header and first question of a wire format message read where it lies, so deciding
+    /// what to do with a query allocates nothing. the buffer must outlive the view
+    struct MessageView
+    {
+      MsgID_t id = 0;
+      uint16_t fields = 0;
+      uint16_t qdCount = 0;
+      uint16_t anCount = 0;
+      uint16_t nsCount = 0;
+      uint16_t arCount = 0;
+      uint16_t qtype = 0;
+      uint16_t qclass = 0;
+      /// the first question's name as it is on the wire, labels each after their length
+      /// ending with a 0
+      const byte_t* qname = nullptr;
+      size_t qnameSize = 0;
+      /// offset just past the first question
+      size_t questionEnd = 0;
+
+      /// false unless buf holds a header and a first question that does not use compression
+      bool
+      Parse(const llarp_buffer_t& buf);
+
+      /// the first question's name is exactly name, with or without the trailing dot
+      bool
+      IsName(std::string_view name) const;
+
+      /// the first question's name ends in tld, as with Question::HasTLD
+      bool
+      HasTLD(std::string_view tld) const;
+
+      /// the first question's name dotted as in Question::qname, for when a string is needed
+      std::string
+      QName() const;
+
+     private:
+      /// visit each character of the dotted name with its index
+      template <typename Visit_t>
+      void
+      ForEachChar(Visit_t visit) const
+      {
+        size_t idx = 0;
+        for (size_t off = 0; off + 1 < qnameSize; off += qname[off] + 1)
+        {
+          for (size_t pos = off + 1; pos <= off + qname[off]; ++pos)
+            visit(idx++, char(qname[pos]));
+          visit(idx++, '.');
+        }
+      }
+
+      /// length of the dotted name
+      size_t
+      DottedSize() const
+      {
+        return qnameSize > 1 ? qnameSize - 1 : 0;
+      }
+    };
+
+    /// turns the wire format query in msg into our reply where it lies. everything after the
+    /// first question is cut off and the header set as Message::Encode would have
+    struct ReplyWriter
+    {
+      ReplyWriter(std::vector<byte_t>& msg, const MessageView& query);
+
+      /// no such name
+      void
+      NX();
+
+      /// we could not resolve it
+      void
+      ServFail();
+
+     private:
+      void
+      SetFields(uint16_t fields);
+
+      std::vector<byte_t>& m_Msg;
+      uint16_t m_Fields;
+    };
+  }  // namespace dns
+}  // namespace llarp
+
+#endif
@@ -14,12 +14,18 @@ namespace llarp
         Logic_ptr serverLogic,
         llarp_ev_loop_ptr clientLoop,
         Logic_ptr clientLogic,
-        IQueryHandler* h)
+        IQueryHandler* h,
+        metrics::Registry& metrics)
         : m_ServerLoop(std::move(serverLoop))
         , m_ClientLoop(std::move(clientLoop))
         , m_ServerLogic(std::move(serverLogic))
         , m_ClientLogic(std::move(clientLogic))
         , m_QueryHandler(h)
+        , m_QueriesMetric(metrics.AddCounter("llarp_dns_queries_total", "dns queries we got"))
+        , m_HookedMetric(metrics.AddCounter(
+              "llarp_dns_hooked_queries_total", "dns queries we answered ourselves"))
+        , m_CachedMetric(metrics.AddCounter(
+              "llarp_dns_cached_queries_total", "dns queries answered from our upstream cache"))
     {
       m_Client.user = this;
       m_Server.user = this;
@@ -34,11 +40,12 @@ namespace llarp
     {}
 
     bool
-    Proxy::Start(const IpAddress& addr, const std::vector<IpAddress>& resolvers)
+    Proxy::Start(
+        const IpAddress& addr, const std::vector<IpAddress>& resolvers, size_t numContexts)
     {
       if (resolvers.size())
       {
-        if (not SetupUnboundResolver(resolvers))
+        if (not SetupUnboundResolver(resolvers, numContexts))
         {
           llarp::LogError("Failed to add upstream resolvers during DNS server setup.");
           return false;
@@ -94,7 +101,7 @@ namespace llarp
     }
 
     bool
-    Proxy::SetupUnboundResolver(const std::vector<IpAddress>& resolvers)
+    Proxy::SetupUnboundResolver(const std::vector<IpAddress>& resolvers, size_t numContexts)
     {
       auto failFunc = [self = weak_from_this()](SockAddr to, Message msg) {
         auto this_ptr = self.lock();
@@ -112,31 +119,53 @@ namespace llarp
         }
       };
 
-      m_UnboundResolver = std::make_shared<UnboundResolver>(
+      auto resolver = std::make_shared<UnboundResolver>(
           m_ServerLoop, std::move(replyFunc), std::move(failFunc));
-      if (not m_UnboundResolver->Init())
+      if (not resolver->Init(numContexts))
       {
         llarp::LogError("Failed to initialize upstream DNS resolver.");
-        m_UnboundResolver = nullptr;
         return false;
       }
-      for (const auto& resolver : resolvers)
+      for (const auto& upstream : resolvers)
       {
-        if (not m_UnboundResolver->AddUpstreamResolver(resolver.toHost()))
+        if (not resolver->AddUpstreamResolver(upstream.toHost()))
         {
-          llarp::LogError("Failed to add upstream DNS server: ", resolver.toHost());
-          m_UnboundResolver = nullptr;
+          llarp::LogError("Failed to add upstream DNS server: ", upstream.toHost());
           return false;
         }
       }
-
+      m_UnboundResolver = std::move(resolver);
       return true;
     }
 
+    void
+    Proxy::SetUpstreams(std::vector<IpAddress> resolvers, size_t numContexts)
+    {
+      // lookups go out through m_UnboundResolver on the server logic so it is swapped there
+      LogicCall(m_ServerLogic, [self = shared_from_this(), resolvers, numContexts]() {
+        if (resolvers.empty())
+          self->m_UnboundResolver = nullptr;
+        else if (not self->SetupUnboundResolver(resolvers, numContexts))
+          llarp::LogError("Failed to change upstream DNS resolvers, keeping the old ones.");
+      });
+    }
+
     void
     Proxy::HandleTick(llarp_udp_io*)
     {}
 
+    util::StatusObject
+    Proxy::ExtractStatus() const
+    {
+      util::StatusObject obj{
+          {"cacheSize", m_Cache.Size()},
+          {"cacheHits", m_Cache.Hits()},
+          {"cacheMisses", m_Cache.Misses()}};
+      if (m_UnboundResolver)
+        obj["upstream"] = m_UnboundResolver->ExtractStatus();
+      return obj;
+    }
+
     void
     Proxy::SendServerMessageBufferTo(const SockAddr& to, const llarp_buffer_t& buf)
     {
@@ -167,6 +196,7 @@ namespace llarp
       auto self = shared_from_this();
       LogicCall(m_ServerLogic, [to, buffer = std::move(buf), self]() {
         llarp_buffer_t buf(buffer);
+        self->m_Cache.Put(buf, time_now_ms());
         self->SendServerMessageBufferTo(to, buf);
       });
     }
@@ -236,43 +266,67 @@ namespace llarp
     void
     Proxy::HandlePktServer(const SockAddr& from, Buffer_t buf)
     {
-      MessageHeader hdr;
-      llarp_buffer_t pkt(buf);
-      if (!hdr.Decode(&pkt))
+      // most queries are decided on from the question alone, so only decode the whole message
+      // for the ones that need it
+      MessageView query;
+      if (not query.Parse(llarp_buffer_t(buf)))
       {
         llarp::LogWarn("failed to parse dns header from ", from);
         return;
       }
-
-      TX tx = {hdr.id, from};
-      Message msg(hdr);
-      if (!msg.Decode(&pkt))
-      {
-        llarp::LogWarn("failed to parse dns message from ", from);
-        return;
-      }
+      m_QueriesMetric.Inc();
 
       // we don't provide a DoH resolver because it requires verified TLS
       // TLS needs X509/ASN.1-DER and opting into the Root CA Cabal
       // thankfully mozilla added a backdoor that allows ISPs to turn it off
       // so we disable DoH for firefox using mozilla's ISP backdoor
       // see: https://github.com/loki-project/loki-network/issues/832
-      for (const auto& q : msg.questions)
+      if (query.IsName("use-application-dns.net"))
+      {
+        // yea it is, let's turn off DoH because god is dead.
+        ReplyWriter(buf, query).NX();
+        // press F to pay respects
+        SendServerMessageBufferTo(from, llarp_buffer_t(buf));
+        return;
+      }
+
+      const bool hook = m_QueryHandler and m_QueryHandler->ShouldHookDNSQuery(query);
+      if (not hook and not m_UnboundResolver)
       {
-        // is this firefox looking for their backdoor record?
-        if (q.IsName("use-application-dns.net"))
+        // no upstream resolvers
+        // let's serv fail it
+        ReplyWriter(buf, query).ServFail();
+        SendServerMessageBufferTo(from, llarp_buffer_t(buf));
+        return;
+      }
+      if (not hook)
+      {
+        if (const auto reply = m_Cache.Get(llarp_buffer_t(buf), time_now_ms()))
         {
-          // yea it is, let's turn off DoH because god is dead.
-          msg.AddNXReply();
-          // press F to pay respects
-          SendServerMessageTo(from, std::move(msg));
+          m_CachedMetric.Inc();
+          SendServerMessageBufferTo(from, llarp_buffer_t(*reply));
           return;
         }
       }
 
-      auto self = shared_from_this();
-      if (m_QueryHandler && m_QueryHandler->ShouldHookDNSMessage(msg))
+      MessageHeader hdr;
+      llarp_buffer_t pkt(buf);
+      if (!hdr.Decode(&pkt))
+      {
+        llarp::LogWarn("failed to parse dns header from ", from);
+        return;
+      }
+      Message msg(hdr);
+      if (!msg.Decode(&pkt))
+      {
+        llarp::LogWarn("failed to parse dns message from ", from);
+        return;
+      }
+
+      if (hook)
       {
+        m_HookedMetric.Inc();
+        auto self = shared_from_this();
         if (!m_QueryHandler->HandleHookedDNSMessage(
                 std::move(msg),
                 std::bind(&Proxy::SendServerMessageTo, self, from, std::placeholders::_1)))
@@ -280,14 +334,6 @@ namespace llarp
           llarp::LogWarn("failed to handle hooked dns");
         }
       }
-      else if (not m_UnboundResolver)
-      {
-        // no upstream resolvers
-        // let's serv fail it
-        msg.AddServFail();
-
-        SendServerMessageTo(from, std::move(msg));
-      }
       else
       {
         m_UnboundResolver->Lookup(from, std::move(msg));
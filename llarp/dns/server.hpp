@@ -1,9 +1,12 @@
 #ifndef LLARP_DNS_SERVER_HPP
 #define LLARP_DNS_SERVER_HPP
 
+#include <dns/answer_cache.hpp>
 #include <dns/message.hpp>
+#include <dns/message_view.hpp>
 #include <ev/ev.h>
 #include <net/net.hpp>
+#include <util/metrics.hpp>
 #include <util/thread/logic.hpp>
 #include <dns/unbound_resolver.hpp>
 
@@ -22,6 +25,10 @@ namespace llarp
       virtual bool
       ShouldHookDNSMessage(const Message& msg) const = 0;
 
+      /// return true if we should hook the query we got, going on its first question alone
+      virtual bool
+      ShouldHookDNSQuery(const MessageView& query) const = 0;
+
       /// handle a hooked message
       virtual bool
       HandleHookedDNSMessage(Message query, std::function<void(Message)> sendReply) = 0;
@@ -35,10 +42,21 @@ namespace llarp
           Logic_ptr serverLogic,
           llarp_ev_loop_ptr clientLoop,
           Logic_ptr clientLogic,
-          IQueryHandler* handler);
+          IQueryHandler* handler,
+          metrics::Registry& metrics);
 
+      /// lookups that go upstream are spread over numContexts unbound contexts
       bool
-      Start(const IpAddress& addr, const std::vector<IpAddress>& resolvers);
+      Start(
+          const IpAddress& addr, const std::vector<IpAddress>& resolvers, size_t numContexts = 1);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+      /// resolve upstream through resolvers from now on, lookups already sent to the ones we had
+      /// are dropped. the ones we had stay if the new ones can not be set up
+      void
+      SetUpstreams(std::vector<IpAddress> resolvers, size_t numContexts);
 
       void
       Stop();
@@ -81,7 +99,7 @@ namespace llarp
       PickRandomResolver() const;
 
       bool
-      SetupUnboundResolver(const std::vector<IpAddress>& resolvers);
+      SetupUnboundResolver(const std::vector<IpAddress>& resolvers, size_t numContexts);
 
      private:
       llarp_udp_io m_Server;
@@ -93,6 +111,11 @@ namespace llarp
       IQueryHandler* m_QueryHandler;
       std::vector<IpAddress> m_Resolvers;
       std::shared_ptr<UnboundResolver> m_UnboundResolver;
+      /// upstream replies, only touched from the server logic
+      AnswerCache m_Cache;
+      metrics::Counter& m_QueriesMetric;
+      metrics::Counter& m_HookedMetric;
+      metrics::Counter& m_CachedMetric;
 
       struct TX
       {
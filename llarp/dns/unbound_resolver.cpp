@@ -2,6 +2,10 @@
 
 #include <dns/server.hpp>
 #include <util/buffer.hpp>
+#include <util/time.hpp>
+
+#include <algorithm>
+#include <cctype>
 
 namespace llarp::dns
 {
@@ -10,51 +14,59 @@ namespace llarp::dns
     std::weak_ptr<UnboundResolver> resolver;
     Message msg;
     SockAddr source;
+    /// which of the resolver's contexts it went to
+    size_t context;
+    llarp_time_t started;
   };
 
   void
   UnboundResolver::Reset()
   {
     started = false;
-    if (unboundContext)
+    if (not unboundContexts.empty())
     {
       DeregisterPollFD();
-      ub_ctx_delete(unboundContext);
+      for (auto* ctx : unboundContexts)
+        ub_ctx_delete(ctx);
     }
-    unboundContext = nullptr;
+    unboundContexts.clear();
   }
 
   void
   UnboundResolver::DeregisterPollFD()
   {
 #ifdef _WIN32
-    runnerThread->join();
+    for (auto& runner : runnerThreads)
+      runner.join();
+    runnerThreads.clear();
 #else
-    eventLoop->deregister_poll_fd_readable(ub_fd(unboundContext));
+    for (auto* ctx : unboundContexts)
+      eventLoop->deregister_poll_fd_readable(ub_fd(ctx));
 #endif
   }
 
   void
   UnboundResolver::RegisterPollFD()
   {
+    for (auto* ctx : unboundContexts)
+    {
 #ifdef _WIN32
-    runnerThread = std::make_unique<std::thread>([self = shared_from_this()]() {
-      while (self->started)
-      {
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(20ms);
-        ub_wait(self->unboundContext);
-      }
-    });
+      runnerThreads.emplace_back([self = shared_from_this(), ctx]() {
+        while (self->started)
+        {
+          using namespace std::chrono_literals;
+          std::this_thread::sleep_for(20ms);
+          ub_wait(ctx);
+        }
+      });
 #else
-    eventLoop->register_poll_fd_readable(
-        ub_fd(unboundContext), [=]() { ub_process(unboundContext); });
+      eventLoop->register_poll_fd_readable(ub_fd(ctx), [ctx]() { ub_process(ctx); });
 #endif
+    }
   }
 
   UnboundResolver::UnboundResolver(llarp_ev_loop_ptr loop, ReplyFunction reply, FailFunction fail)
-      : unboundContext(nullptr)
-      , started(false)
+      : started(false)
       , eventLoop(loop)
 #ifdef _WIN32
       // on win32 we use another thread for io because LOL windows
@@ -70,6 +82,17 @@ namespace llarp::dns
 #endif
   {}
 
+  void
+  UnboundResolver::LookupDone(size_t idx, llarp_time_t dlt, bool failed)
+  {
+    std::lock_guard<std::mutex> lock{statsMutex};
+    if (idx < outstanding.size() and outstanding[idx] > 0)
+      outstanding[idx]--;
+    latency.Add(dlt);
+    if (failed)
+      failures++;
+  }
+
   // static callback
   void
   UnboundResolver::Callback(void* data, int err, ub_result* result)
@@ -78,7 +101,12 @@ namespace llarp::dns
 
     auto this_ptr = lookup->resolver.lock();
     if (not this_ptr)
-      return;  // resolver is gone, so we don't reply.
+    {
+      // resolver is gone, so we don't reply.
+      ub_resolve_free(result);
+      return;
+    }
+    this_ptr->LookupDone(lookup->context, time_now_ms() - lookup->started, err != 0);
 
     if (err != 0)
     {
@@ -109,23 +137,32 @@ namespace llarp::dns
   }
 
   bool
-  UnboundResolver::Init()
+  UnboundResolver::Init(size_t numContexts)
   {
     if (started)
     {
       Reset();
     }
 
-    unboundContext = ub_ctx_create();
-
-    if (not unboundContext)
+    for (size_t idx = 0; idx < std::max<size_t>(numContexts, 1); ++idx)
     {
-      return false;
-    }
-
+      auto* ctx = ub_ctx_create();
+      if (not ctx)
+      {
+        for (auto* made : unboundContexts)
+          ub_ctx_delete(made);
+        unboundContexts.clear();
+        return false;
+      }
 #ifdef _WIN32
-    ub_ctx_async(unboundContext, 1);
+      ub_ctx_async(ctx, 1);
 #endif
+      unboundContexts.push_back(ctx);
+    }
+    {
+      std::lock_guard<std::mutex> lock{statsMutex};
+      outstanding.assign(unboundContexts.size(), 0);
+    }
 
     started = true;
     RegisterPollFD();
@@ -135,10 +172,13 @@ namespace llarp::dns
   bool
   UnboundResolver::AddUpstreamResolver(const std::string& upstreamResolverIP)
   {
-    if (ub_ctx_set_fwd(unboundContext, upstreamResolverIP.c_str()) != 0)
+    for (auto* ctx : unboundContexts)
     {
-      Reset();
-      return false;
+      if (ub_ctx_set_fwd(ctx, upstreamResolverIP.c_str()) != 0)
+      {
+        Reset();
+        return false;
+      }
     }
     return true;
   }
@@ -146,7 +186,7 @@ namespace llarp::dns
   void
   UnboundResolver::Lookup(const SockAddr& source, Message msg)
   {
-    if (not unboundContext)
+    if (unboundContexts.empty())
     {
       msg.AddServFail();
       failFunc(source, std::move(msg));
@@ -154,10 +194,21 @@ namespace llarp::dns
     }
 
     const auto& q = msg.questions[0];
-    auto* lookup = new PendingUnboundLookup{weak_from_this(), msg, source};
+    const std::string name = q.Name();
+    // the same name always goes to the same context so its cache gets the repeats
+    std::string lowered = name;
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char ch) {
+      return std::tolower(ch);
+    });
+    const size_t idx = std::hash<std::string>{}(lowered) % unboundContexts.size();
+    {
+      std::lock_guard<std::mutex> lock{statsMutex};
+      outstanding[idx]++;
+    }
+    auto* lookup = new PendingUnboundLookup{weak_from_this(), msg, source, idx, time_now_ms()};
     int err = ub_resolve_async(
-        unboundContext,
-        q.Name().c_str(),
+        unboundContexts[idx],
+        name.c_str(),
         q.qtype,
         q.qclass,
         (void*)lookup,
@@ -166,10 +217,27 @@ namespace llarp::dns
 
     if (err != 0)
     {
+      delete lookup;
+      LookupDone(idx, 0s, true);
       msg.AddServFail();
       failFunc(source, std::move(msg));
       return;
     }
   }
 
+  util::StatusObject
+  UnboundResolver::ExtractStatus() const
+  {
+    std::lock_guard<std::mutex> lock{statsMutex};
+    uint64_t inFlight = 0;
+    for (const auto num : outstanding)
+      inFlight += num;
+    return util::StatusObject{
+        {"contexts", unboundContexts.size()},
+        {"outstanding", inFlight},
+        {"outstandingPerContext", outstanding},
+        {"failures", failures},
+        {"latency", latency.ExtractStatus()}};
+  }
+
 }  // namespace llarp::dns
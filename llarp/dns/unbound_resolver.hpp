@@ -7,10 +7,14 @@
 #include <queue>
 
 #include <ev/ev.hpp>
+#include <util/histogram.hpp>
+#include <util/status.hpp>
 #include <util/thread/logic.hpp>
 
 #include <dns/message.hpp>
 
+#include <vector>
+
 #ifdef _WIN32
 #include <thread>
 #endif
@@ -23,14 +27,23 @@ namespace llarp::dns
   class UnboundResolver : public std::enable_shared_from_this<UnboundResolver>
   {
    private:
-    ub_ctx* unboundContext;
+    /// lookups go to one of these by the hash of the name, so they resolve side by side
+    std::vector<ub_ctx*> unboundContexts;
 #ifdef _WIN32
     /// windows needs to run as blocking in another thread to work at all becuase LOL windows
-    std::unique_ptr<std::thread> runnerThread;
+    std::vector<std::thread> runnerThreads;
 #endif
 
     std::atomic<bool> started;
 
+    /// guards the metrics below, callbacks come from a runner thread per context on windows
+    mutable std::mutex statsMutex;
+    /// lookups in flight on each context
+    std::vector<uint64_t> outstanding;
+    /// how long lookups took to come back
+    util::DurationHistogram latency;
+    uint64_t failures = 0;
+
     llarp_ev_loop_ptr eventLoop;
     ReplyFunction replyFunc;
     FailFunction failFunc;
@@ -43,21 +56,29 @@ namespace llarp::dns
     void
     RegisterPollFD();
 
+    /// note that a lookup on context idx ended after taking dlt
+    void
+    LookupDone(size_t idx, llarp_time_t dlt, bool failed);
+
    public:
     UnboundResolver(llarp_ev_loop_ptr eventLoop, ReplyFunction replyFunc, FailFunction failFunc);
 
     static void
     Callback(void* data, int err, ub_result* result);
 
-    // upstream resolver IP can be IPv4 or IPv6
+    /// make numContexts unbound contexts to spread lookups over
     bool
-    Init();
+    Init(size_t numContexts = 1);
 
+    // upstream resolver IP can be IPv4 or IPv6
     bool
     AddUpstreamResolver(const std::string& upstreamResolverIP);
 
     void
     Lookup(const SockAddr& source, Message msg);
+
+    util::StatusObject
+    ExtractStatus() const;
   };
 
 }  // namespace llarp::dns
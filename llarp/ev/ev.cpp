@@ -76,6 +76,21 @@ llarp_ev_udp_sendto(struct llarp_udp_io* udp, const llarp::SockAddr& to, const l
   return udp->sendto(udp, to, buf.base, buf.sz);
 }
 
+int
+llarp_ev_udp_sendto_batch(struct llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num)
+{
+  if (udp->sendto_batch)
+    return udp->sendto_batch(udp, pkts, num);
+  int sent = 0;
+  for (size_t idx = 0; idx < num; ++idx)
+  {
+    if (udp->sendto(udp, pkts[idx].addr, pkts[idx].data, pkts[idx].sz) < 0)
+      break;
+    sent++;
+  }
+  return sent;
+}
+
 bool
 llarp_ev_add_tun(struct llarp_ev_loop* loop, struct llarp_tun_io* tun)
 {
@@ -121,6 +136,23 @@ llarp_ev_tun_async_write(struct llarp_tun_io* tun, const llarp_buffer_t& buf)
 #endif
 }
 
+size_t
+llarp_ev_tun_async_write_batch(struct llarp_tun_io* tun, const llarp_tun_pkt* pkts, size_t n)
+{
+#ifndef _WIN32
+  if (tun->writepkts)
+    return tun->writepkts(tun, pkts, n);
+#endif
+  size_t written = 0;
+  for (size_t idx = 0; idx < n; ++idx)
+  {
+    const llarp_buffer_t buf(pkts[idx].base, pkts[idx].sz);
+    if (llarp_ev_tun_async_write(tun, buf))
+      written++;
+  }
+  return written;
+}
+
 bool
 llarp_tcp_conn_async_write(struct llarp_tcp_conn* conn, const llarp_buffer_t& b)
 {
@@ -17,6 +17,7 @@
 #include <net/net_if.hpp>
 
 #include <memory>
+#include <string>
 
 #include <cstdint>
 #include <cstdlib>
@@ -65,6 +66,14 @@ llarp_ev_loop_time_now_ms(const llarp_ev_loop_ptr& ev);
 void
 llarp_ev_loop_stop(const llarp_ev_loop_ptr& ev);
 
+/// a single datagram in a batched UDP read or write
+struct llarp_udp_pkt
+{
+  llarp::SockAddr addr;
+  const byte_t* data;
+  size_t sz;
+};
+
 /// UDP handling configuration
 struct llarp_udp_io
 {
@@ -78,8 +87,40 @@ struct llarp_udp_io
   void (*tick)(struct llarp_udp_io*);
 
   void (*recvfrom)(struct llarp_udp_io*, const llarp::SockAddr& source, ManagedBuffer);
+  /// optional, called once per wakeup with every datagram read in that wakeup
+  /// if set this is used instead of recvfrom
+  /// the buffers are only valid for the duration of the call
+  void (*recvfrom_batch)(struct llarp_udp_io*, const llarp_udp_pkt* pkts, size_t num) = nullptr;
   /// set by parent
   int (*sendto)(struct llarp_udp_io*, const llarp::SockAddr&, const byte_t*, size_t);
+  /// set by parent, send many datagrams in as few syscalls as possible
+  /// returns the number of datagrams sent or -1 on error
+  int (*sendto_batch)(struct llarp_udp_io*, const llarp_udp_pkt* pkts, size_t num) = nullptr;
+
+  /// set before adding to share the bound port with other sockets, the kernel then spreads
+  /// inbound flows across them by hashing the remote address
+  bool reuseport = false;
+  /// set before adding to have reads on an empty socket spin this many microseconds for a
+  /// datagram before they sleep, SO_BUSY_POLL (linux only). 0 for regular reads
+  int busy_poll_us = 0;
+  /// set before adding to ask for kernel segmentation / receive offload (linux only)
+  bool want_offload = false;
+  /// set by parent when receive offload is active
+  bool gro = false;
+  /// set before adding to do reads and writes through io_uring (linux, WITH_IO_URING builds)
+  /// replaces offload, falls back to the regular path if the kernel lacks support
+  bool want_uring = false;
+  /// set before adding to read ipv4 datagrams for our port off this interface with AF_XDP
+  /// (linux, WITH_XDP builds), replaces offload and io_uring, sends stay on the socket
+  /// falls back to the regular path if the interface or kernel lacks support
+  std::string xdp_ifname;
+  /// set by parent when the socket supports segmentation offload
+  /// sends one buffer that the kernel splits into datagrams of segsz bytes (the last one may be
+  /// shorter), returns -1 on error in which case it may be unset by the parent if the kernel or
+  /// NIC turns out to not support it
+  int (*sendto_segmented)(
+      struct llarp_udp_io*, const llarp::SockAddr&, const byte_t*, size_t sz, size_t segsz) =
+      nullptr;
 };
 
 /// add UDP handler
@@ -90,6 +131,12 @@ llarp_ev_add_udp(struct llarp_ev_loop* ev, struct llarp_udp_io* udp, const llarp
 int
 llarp_ev_udp_sendto(struct llarp_udp_io* udp, const llarp::SockAddr& to, const llarp_buffer_t& pkt);
 
+/// send many UDP packets at once, falls back to one send per packet if the event loop does
+/// not support batched sends
+/// returns the number of packets sent or -1 on error
+int
+llarp_ev_udp_sendto_batch(struct llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num);
+
 /// close UDP handler
 int
 llarp_ev_close_udp(struct llarp_udp_io* udp);
@@ -192,6 +239,13 @@ struct llarp_fd_promise;
 int
 llarp_fd_promise_wait_for_value(struct llarp_fd_promise* promise);
 
+/// a packet to write to a tun interface, pointing into storage owned by the caller
+struct llarp_tun_pkt
+{
+  const byte_t* base;
+  size_t sz;
+};
+
 struct llarp_tun_io
 {
   // TODO: more info?
@@ -200,6 +254,9 @@ struct llarp_tun_io
   uint32_t dnsaddr;
   int netmask;
   char ifname[IFNAMSIZ + 1];
+  /// linux only, how many queues to open on the device so the kernel spreads flows over
+  /// them, 0 or 1 opens a plain single queue device
+  size_t queues;
 
   void* user;
   void* impl;
@@ -217,6 +274,11 @@ struct llarp_tun_io
   void (*recvpkt)(struct llarp_tun_io*, const llarp_buffer_t&);
   /// set by parent
   bool (*writepkt)(struct llarp_tun_io*, const byte_t*, size_t);
+  /// linux only, open the device with a virtio net header and let the kernel hand us tso
+  /// super packets, which get cut back into mtu sized packets as they are read
+  bool offload;
+  /// set by parent, write pkts in order, returns how many made it out
+  size_t (*writepkts)(struct llarp_tun_io*, const struct llarp_tun_pkt*, size_t);
 };
 
 /// create tun interface with network interface name ifname
@@ -229,4 +291,9 @@ llarp_ev_add_tun(struct llarp_ev_loop* ev, struct llarp_tun_io* tun);
 bool
 llarp_ev_tun_async_write(struct llarp_tun_io* tun, const llarp_buffer_t&);
 
+/// write a batch of packets on tun interface in order, in as few syscalls as the platform allows
+/// returns how many were written, the rest were dropped
+size_t
+llarp_ev_tun_async_write_batch(struct llarp_tun_io* tun, const llarp_tun_pkt* pkts, size_t n);
+
 #endif
@@ -5,6 +5,7 @@
 #include <ev/ev.h>
 #include <util/buffer.hpp>
 #include <util/codel.hpp>
+#include <util/thread/job.hpp>
 #include <util/thread/threading.hpp>
 
 // writev
@@ -337,9 +338,7 @@ namespace llarp
         WriteBuffer::GetTime,
         WriteBuffer::PutTime,
         WriteBuffer::Compare,
-        WriteBuffer::GetNow,
-        llarp::util::NullMutex,
-        llarp::util::NullLock>;
+        WriteBuffer::GetNow>;
 
     using LosslessWriteQueue_t = std::deque<WriteBuffer>;
 
@@ -697,14 +696,18 @@ struct llarp_ev_loop
   virtual bool
   running() const = 0;
 
+  /// publishes the time for time_now and coarse_now_ms
   virtual void
   update_time()
-  {}
+  {
+    llarp::publish_coarse_now_ms();
+  }
 
+  /// the time as of our last wakeup, which is all per packet timestamps need
   virtual llarp_time_t
   time_now() const
   {
-    return llarp::time_now_ms();
+    return llarp::coarse_now_ms();
   }
 
   virtual void
@@ -726,6 +729,17 @@ struct llarp_ev_loop
   virtual bool
   add_ticker(std::function<void(void)> ticker) = 0;
 
+  /// spin for up to this long waiting for io each time before we block, for dedicated relays
+  /// that would rather burn a core than pay for a wakeup per datagram. 0 blocks straight away
+  virtual void set_busy_poll(std::chrono::microseconds)
+  {
+  }
+
+  /// pin the thread that runs us to cpu once run starts, -1 leaves it to the kernel
+  virtual void set_loop_cpu(int)
+  {
+  }
+
   virtual void
   stop() = 0;
 
@@ -796,8 +810,9 @@ struct llarp_ev_loop
     }
   }
 
+  /// queue f to run on the event loop thread, safe to call from any thread
   virtual void
-  call_soon(std::function<void(void)> f) = 0;
+  call_soon(llarp::thread::Job f) = 0;
 
   virtual void
   register_poll_fd_readable(int fd, std::function<void(void)> callback) = 0;
@@ -1,9 +1,41 @@
 #include <ev/ev_libuv.hpp>
+#include <net/ip_packet.hpp>
+#include <net/tun_offload.hpp>
+#include <util/numa.hpp>
 #include <util/thread/logic.hpp>
 #include <util/thread/queue.hpp>
 
+#include <array>
 #include <cstring>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/if_tun.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
+#ifdef LOKINET_IO_URING
+#include <ev/ev_uring.hpp>
+#endif
+
+#ifdef LOKINET_XDP
+#include <ev/ev_xdp.hpp>
+#endif
+
 namespace libuv
 {
 #define LoopCall(h, ...)    \
@@ -403,18 +435,52 @@ namespace libuv
 
   struct udp_glue : public glue
   {
+    /// libuv hands us one chunk of the receive buffer per datagram when using recvmmsg
+    static constexpr size_t MaxDatagramSize = 64 * 1024;
+
     uv_udp_t m_Handle;
     uv_check_t m_Ticker;
     llarp_udp_io* const m_UDP;
     llarp::SockAddr m_Addr;
     std::vector<char> m_Buffer;
+    /// datagrams read in the current wakeup, pointing into m_Buffer
+    std::vector<llarp_udp_pkt> m_RecvBatch;
+    bool m_UseMMsg = false;
+    /// used instead of uv_udp_recv_start when receive offload is on as libuv does not give us
+    /// the segment size of coalesced reads
+    uv_poll_t m_GROPoll;
+    bool m_Closing = false;
+#ifdef LOKINET_IO_URING
+    std::unique_ptr<llarp::uring::UDPRing> m_Ring;
+    /// set once the handles below are initialized, they get closed along with the socket
+    bool m_RingActive = false;
+    /// watches the ring's completion eventfd
+    uv_poll_t m_RingPoll;
+    /// submits sends queued since the last loop iteration before we block
+    uv_prepare_t m_RingSubmit;
+#endif
+#ifdef LOKINET_XDP
+    std::unique_ptr<llarp::xdp::PortReceiver> m_XDP;
+    /// one per queue of m_XDP, they never move once initialized
+    std::unique_ptr<uv_poll_t[]> m_XDPPolls;
+    /// poll handles still closing, the socket closes after the last
+    size_t m_XDPClosing = 0;
+#endif
 
     udp_glue(uv_loop_t* loop, llarp_udp_io* udp, const llarp::SockAddr& src)
         : m_UDP(udp), m_Addr(src)
     {
       m_Handle.data = this;
       m_Ticker.data = this;
-      uv_udp_init(loop, &m_Handle);
+      // the socket has to exist before bind for us to set SO_REUSEPORT on it
+      const unsigned int domain =
+          udp->reuseport ? static_cast<const sockaddr*>(m_Addr)->sa_family : AF_UNSPEC;
+#ifdef UV_UDP_RECVMMSG
+      m_UseMMsg = uv_udp_init_ex(loop, &m_Handle, domain | UV_UDP_RECVMMSG) == 0;
+      if (not m_UseMMsg)
+#endif
+        uv_udp_init_ex(loop, &m_Handle, domain);
+      m_RecvBatch.reserve(llarp::udp_batch_size);
       uv_check_init(loop, &m_Ticker);
     }
 
@@ -423,18 +489,70 @@ namespace libuv
     {
       udp_glue* self = static_cast<udp_glue*>(h->data);
       if (self->m_Buffer.empty())
+      {
+        // libuv only does recvmmsg when the buffer can hold more than one max sized datagram
+        if (self->m_UseMMsg)
+          suggested_size = std::max(suggested_size, MaxDatagramSize * llarp::udp_batch_size);
         self->m_Buffer.resize(suggested_size);
+      }
       buf->base = self->m_Buffer.data();
       buf->len = self->m_Buffer.size();
     }
 
     /// callback for libuv
     static void
-    OnRecv(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const sockaddr* addr, unsigned)
+    OnRecv(
+        uv_udp_t* handle,
+        ssize_t nread,
+        const uv_buf_t* buf,
+        const sockaddr* addr,
+        unsigned flags)
     {
       udp_glue* glue = static_cast<udp_glue*>(handle->data);
-      if (addr)
-        glue->RecvFrom(nread, buf, llarp::SockAddr(*addr));
+      if (addr == nullptr)
+      {
+        // end of a recvmmsg burst (or nothing to read)
+        glue->FlushRecvBatch();
+        return;
+      }
+#ifdef UV_UDP_MMSG_CHUNK
+      if (flags & UV_UDP_MMSG_CHUNK)
+      {
+        // chunks stay valid until the burst ends so we can hand them up all at once
+        glue->QueueRecv(nread, buf, llarp::SockAddr(*addr));
+        return;
+      }
+#else
+      (void)flags;
+#endif
+      // not batched by libuv, the buffer is reused for the next read so deliver it now
+      glue->QueueRecv(nread, buf, llarp::SockAddr(*addr));
+      glue->FlushRecvBatch();
+    }
+
+    void
+    QueueRecv(ssize_t sz, const uv_buf_t* buf, const llarp::SockAddr& fromaddr)
+    {
+      if (sz <= 0 or m_UDP == nullptr)
+        return;
+      if (m_UDP->recvfrom_batch == nullptr)
+      {
+        RecvFrom(sz, buf, fromaddr);
+        return;
+      }
+      m_RecvBatch.emplace_back(llarp_udp_pkt{fromaddr, (const byte_t*)buf->base, size_t(sz)});
+    }
+
+    void
+    FlushRecvBatch()
+    {
+      if (m_RecvBatch.empty())
+        return;
+      // the loop may have slept a while before these came in
+      llarp::publish_coarse_now_ms();
+      if (m_UDP and m_UDP->recvfrom_batch)
+        m_UDP->recvfrom_batch(m_UDP, m_RecvBatch.data(), m_RecvBatch.size());
+      m_RecvBatch.clear();
     }
 
     void
@@ -465,6 +583,10 @@ namespace libuv
     {
       if (m_UDP && m_UDP->tick)
         m_UDP->tick(m_UDP);
+#ifdef LOKINET_IO_URING
+      if (m_RingActive)
+        m_Ring->Submit();
+#endif
     }
 
     static int
@@ -477,16 +599,359 @@ namespace libuv
       return uv_udp_try_send(&self->m_Handle, &buf, 1, to);
     }
 
+#ifdef __linux__
+    static void
+    OnGROReadable(uv_poll_t* handle, int status, int events)
+    {
+      if (status < 0 or not(events & UV_READABLE))
+        return;
+      static_cast<udp_glue*>(handle->data)->ReadGRO();
+    }
+
+    /// read coalesced datagrams and split them back up using the kernel reported segment size
+    void
+    ReadGRO()
+    {
+      if (m_Buffer.empty())
+        m_Buffer.resize(MaxDatagramSize * llarp::udp_batch_size);
+      for (size_t idx = 0; idx < llarp::udp_batch_size; ++idx)
+      {
+        sockaddr_in6 from{};
+        std::array<char, CMSG_SPACE(sizeof(int))> control{};
+        iovec iov{m_Buffer.data() + (idx * MaxDatagramSize), MaxDatagramSize};
+        msghdr hdr{};
+        hdr.msg_name = &from;
+        hdr.msg_namelen = sizeof(from);
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = control.data();
+        hdr.msg_controllen = control.size();
+        const ssize_t nread = ::recvmsg(m_UDP->fd, &hdr, MSG_DONTWAIT);
+        if (nread <= 0)
+          break;
+        size_t segsz = nread;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+        {
+          if (cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO)
+          {
+            int gso_size = 0;
+            std::memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            if (gso_size > 0)
+              segsz = gso_size;
+          }
+        }
+        const llarp::SockAddr fromaddr{*reinterpret_cast<const sockaddr*>(&from)};
+        for (size_t offset = 0; offset < size_t(nread); offset += segsz)
+        {
+          const auto chunk = uv_buf_init(
+              (char*)iov.iov_base + offset, std::min(segsz, size_t(nread) - offset));
+          QueueRecv(chunk.len, &chunk, fromaddr);
+        }
+      }
+      FlushRecvBatch();
+    }
+
+    static int
+    SendToSegmented(
+        llarp_udp_io* udp, const llarp::SockAddr& to, const byte_t* ptr, size_t sz, size_t segsz)
+    {
+      auto* self = static_cast<udp_glue*>(udp->impl);
+      if (self == nullptr)
+        return -1;
+      std::array<char, CMSG_SPACE(sizeof(uint16_t))> control{};
+      iovec iov{const_cast<byte_t*>(ptr), sz};
+      msghdr hdr{};
+      hdr.msg_name = const_cast<sockaddr*>(static_cast<const sockaddr*>(to));
+      hdr.msg_namelen = sizeof(sockaddr_in6);
+      hdr.msg_iov = &iov;
+      hdr.msg_iovlen = 1;
+      hdr.msg_control = control.data();
+      hdr.msg_controllen = control.size();
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      const uint16_t gso_size = segsz;
+      std::memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+      const auto ret = ::sendmsg(udp->fd, &hdr, MSG_DONTWAIT);
+      if (ret < 0 and (errno == EIO or errno == EINVAL or errno == EOPNOTSUPP))
+      {
+        // the NIC can't checksum segments for us, stop trying
+        llarp::LogWarn(
+            "udp segmentation offload unavailable on ", self->m_Addr, ": ", strerror(errno));
+        udp->sendto_segmented = nullptr;
+      }
+      return ret < 0 ? -1 : int(ret);
+    }
+
+    /// probe the kernel for segmentation and receive offload support
+    /// return true if we are reading with GRO
+    bool
+    SetupOffload(uv_loop_t* loop)
+    {
+      int val = 0;
+      socklen_t len = sizeof(val);
+      if (::getsockopt(m_UDP->fd, SOL_UDP, UDP_SEGMENT, &val, &len) == 0)
+      {
+        m_UDP->sendto_segmented = &SendToSegmented;
+        llarp::LogInfo("udp segmentation offload enabled on ", m_Addr);
+      }
+      val = 1;
+      if (::setsockopt(m_UDP->fd, SOL_UDP, UDP_GRO, &val, sizeof(val)) != 0)
+        return false;
+      m_GROPoll.data = this;
+      if (uv_poll_init_socket(loop, &m_GROPoll, m_UDP->fd) != 0
+          or uv_poll_start(&m_GROPoll, UV_READABLE, &OnGROReadable) != 0)
+      {
+        val = 0;
+        ::setsockopt(m_UDP->fd, SOL_UDP, UDP_GRO, &val, sizeof(val));
+        return false;
+      }
+      llarp::LogInfo("udp receive offload enabled on ", m_Addr);
+      m_UDP->gro = true;
+      return true;
+    }
+#endif
+
+#ifdef LOKINET_IO_URING
+    static void
+    OnRingReadable(uv_poll_t* handle, int status, int events)
+    {
+      if (status < 0 or not(events & UV_READABLE))
+        return;
+      auto* self = static_cast<udp_glue*>(handle->data);
+      self->m_Ring->Drain(
+          [self](const llarp::SockAddr& from, const byte_t* ptr, size_t sz) {
+            const auto chunk = uv_buf_init((char*)ptr, sz);
+            self->QueueRecv(sz, &chunk, from);
+          },
+          [self]() { self->FlushRecvBatch(); });
+    }
+
+    static int
+    SendToRing(llarp_udp_io* udp, const llarp::SockAddr& to, const byte_t* ptr, size_t sz)
+    {
+      auto* self = static_cast<udp_glue*>(udp->impl);
+      if (self == nullptr)
+        return -1;
+      if (self->m_Ring->QueueSend(to, ptr, sz))
+        return sz;
+      // out of send slots until completions come back
+      return SendTo(udp, to, ptr, sz);
+    }
+
+    static int
+    SendToBatchRing(llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num)
+    {
+      auto* self = static_cast<udp_glue*>(udp->impl);
+      if (self == nullptr)
+        return -1;
+      size_t queued = 0;
+      while (queued < num
+             and self->m_Ring->QueueSend(pkts[queued].addr, pkts[queued].data, pkts[queued].sz))
+        queued++;
+      if (queued == num)
+        return num;
+      self->m_Ring->Submit();
+      const int sent = SendToBatch(udp, pkts + queued, num - queued);
+      return sent < 0 ? int(queued) : int(queued) + sent;
+    }
+
+    /// move reads and writes onto io_uring, return true if we are reading through the ring
+    bool
+    SetupRing(uv_loop_t* loop)
+    {
+      m_Ring = llarp::uring::UDPRing::Create(m_UDP->fd);
+      if (m_Ring == nullptr)
+      {
+        llarp::LogWarn("io_uring unavailable for ", m_Addr, ", using regular udp io");
+        return false;
+      }
+      m_RingPoll.data = this;
+      m_RingSubmit.data = this;
+      if (uv_poll_init(loop, &m_RingPoll, m_Ring->EventFD()) != 0)
+      {
+        m_Ring.reset();
+        return false;
+      }
+      uv_prepare_init(loop, &m_RingSubmit);
+      m_RingActive = true;
+      const auto submit = [](uv_prepare_t* h) {
+        static_cast<udp_glue*>(h->data)->m_Ring->Submit();
+      };
+      if (uv_poll_start(&m_RingPoll, UV_READABLE, &OnRingReadable) != 0
+          or uv_prepare_start(&m_RingSubmit, submit) != 0)
+      {
+        llarp::LogWarn("failed to watch io_uring for ", m_Addr, ", using regular udp io");
+        uv_poll_stop(&m_RingPoll);
+        return false;
+      }
+      llarp::LogInfo("udp io via io_uring enabled on ", m_Addr);
+      return true;
+    }
+#endif
+
+#ifdef LOKINET_XDP
+    static void
+    OnXDPReadable(uv_poll_t* handle, int status, int events)
+    {
+      if (status < 0 or not(events & UV_READABLE))
+        return;
+      auto* self = static_cast<udp_glue*>(handle->data);
+      const size_t queue = handle - self->m_XDPPolls.get();
+      self->m_XDP->Drain(
+          queue,
+          [self](const llarp::SockAddr& from, const byte_t* ptr, size_t sz) {
+            const auto chunk = uv_buf_init((char*)ptr, sz);
+            self->QueueRecv(sz, &chunk, from);
+          },
+          [self]() { self->FlushRecvBatch(); });
+    }
+
+    /// read our port off the interface with AF_XDP, the socket keeps reading what the kernel
+    /// still gets. returns true if xdp reads are on
+    bool
+    SetupXDP(uv_loop_t* loop)
+    {
+      m_XDP = llarp::xdp::PortReceiver::Create(m_UDP->xdp_ifname, m_Addr.getPort());
+      if (m_XDP == nullptr)
+      {
+        llarp::LogWarn("xdp unavailable on ", m_UDP->xdp_ifname, ", using regular udp io");
+        return false;
+      }
+      const size_t numQueues = m_XDP->NumQueues();
+      m_XDPPolls.reset(new uv_poll_t[numQueues]);
+      size_t started = 0;
+      for (; started < numQueues; ++started)
+      {
+        auto* poll = &m_XDPPolls[started];
+        poll->data = this;
+        if (uv_poll_init(loop, poll, m_XDP->FD(started)) != 0)
+          break;
+        if (uv_poll_start(poll, UV_READABLE, &OnXDPReadable) != 0)
+        {
+          uv_close((uv_handle_t*)poll, nullptr);
+          break;
+        }
+      }
+      if (started < numQueues)
+      {
+        llarp::LogWarn("failed to watch xdp sockets on ", m_UDP->xdp_ifname);
+        for (size_t idx = 0; idx < started; ++idx)
+          uv_close((uv_handle_t*)&m_XDPPolls[idx], nullptr);
+        m_XDP.reset();
+        return false;
+      }
+      return true;
+    }
+#endif
+
+    static int
+    SendToBatch(llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num)
+    {
+      auto* self = static_cast<udp_glue*>(udp->impl);
+      if (self == nullptr)
+        return -1;
+#ifdef __linux__
+      std::array<mmsghdr, llarp::udp_batch_size> msgs;
+      std::array<iovec, llarp::udp_batch_size> iovs;
+      size_t sent = 0;
+      while (sent < num)
+      {
+        const size_t chunk = std::min(num - sent, llarp::udp_batch_size);
+        for (size_t idx = 0; idx < chunk; ++idx)
+        {
+          const auto& pkt = pkts[sent + idx];
+          iovs[idx].iov_base = const_cast<byte_t*>(pkt.data);
+          iovs[idx].iov_len = pkt.sz;
+          auto& hdr = msgs[idx].msg_hdr;
+          hdr = {};
+          hdr.msg_name = const_cast<sockaddr*>(static_cast<const sockaddr*>(pkt.addr));
+          hdr.msg_namelen = sizeof(sockaddr_in6);
+          hdr.msg_iov = &iovs[idx];
+          hdr.msg_iovlen = 1;
+        }
+        const int n = ::sendmmsg(udp->fd, msgs.data(), chunk, MSG_DONTWAIT);
+        if (n <= 0)
+          return sent ? int(sent) : -1;
+        sent += n;
+        if (size_t(n) < chunk)
+          break;
+      }
+      return sent;
+#else
+      int sent = 0;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        if (SendTo(udp, pkts[idx].addr, pkts[idx].data, pkts[idx].sz) < 0)
+          break;
+        sent++;
+      }
+      return sent;
+#endif
+    }
+
     bool
     Bind()
     {
-      auto ret = uv_udp_bind(&m_Handle, m_Addr, 0);
+      unsigned int flags = 0;
+      if (m_UDP->reuseport)
+      {
+        // libuv sets SO_REUSEPORT for this on the BSDs but only SO_REUSEADDR on linux, which does
+        // not balance between the sockets
+        flags |= UV_UDP_REUSEADDR;
+#ifdef __linux__
+        int fd = -1;
+        const int on = 1;
+        if (uv_fileno((const uv_handle_t*)&m_Handle, &fd)
+            or setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1)
+        {
+          llarp::LogError("failed to set SO_REUSEPORT for ", m_Addr, ": ", strerror(errno));
+          return false;
+        }
+#endif
+      }
+      auto ret = uv_udp_bind(&m_Handle, m_Addr, flags);
       if (ret)
       {
         llarp::LogError("failed to bind to ", m_Addr, " ", uv_strerror(ret));
         return false;
       }
-      if (uv_udp_recv_start(&m_Handle, &Alloc, &OnRecv))
+#if defined(_WIN32) || defined(_WIN64)
+#else
+      if (uv_fileno((const uv_handle_t*)&m_Handle, &m_UDP->fd))
+        return false;
+      m_UDP->sendto_batch = &SendToBatch;
+#endif
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+      const int spin = m_UDP->busy_poll_us;
+      if (spin > 0 and ::setsockopt(m_UDP->fd, SOL_SOCKET, SO_BUSY_POLL, &spin, sizeof(spin)) != 0)
+        llarp::LogWarn("cannot busy poll reads on ", m_Addr, ": ", strerror(errno));
+#endif
+      bool reading = false;
+      [[maybe_unused]] bool ring = false;
+      [[maybe_unused]] bool xdp = false;
+#ifdef LOKINET_XDP
+      // frames come off the nic one datagram each so this replaces offload and the ring
+      if (not m_UDP->xdp_ifname.empty())
+        xdp = SetupXDP(m_Handle.loop);
+#else
+      if (not m_UDP->xdp_ifname.empty())
+        llarp::LogWarn("lokinet was built without xdp support, ignoring it for ", m_Addr);
+#endif
+#ifdef LOKINET_IO_URING
+      // coalesced reads would not fit the ring's buffers so this replaces offload
+      if (m_UDP->want_uring and not xdp)
+        ring = reading = SetupRing(m_Handle.loop);
+#else
+      if (m_UDP->want_uring)
+        llarp::LogWarn("lokinet was built without io_uring support, ignoring it for ", m_Addr);
+#endif
+#ifdef __linux__
+      if (m_UDP->want_offload and not ring and not xdp)
+        reading = SetupOffload(m_Handle.loop);
+#endif
+      if (not reading and uv_udp_recv_start(&m_Handle, &Alloc, &OnRecv))
       {
         llarp::LogError("failed to start recving packets via ", m_Addr);
         return false;
@@ -496,12 +961,14 @@ namespace libuv
         llarp::LogError("failed to start ticker");
         return false;
       }
-#if defined(_WIN32) || defined(_WIN64)
-#else
-      if (uv_fileno((const uv_handle_t*)&m_Handle, &m_UDP->fd))
-        return false;
-#endif
       m_UDP->sendto = &SendTo;
+#ifdef LOKINET_IO_URING
+      if (ring)
+      {
+        m_UDP->sendto = &SendToRing;
+        m_UDP->sendto_batch = &SendToBatchRing;
+      }
+#endif
       m_UDP->impl = this;
       return true;
     }
@@ -520,8 +987,59 @@ namespace libuv
     void
     Close() override
     {
+      // our handles can close in a chain so the socket handle is not closing yet on a second call
+      if (m_Closing or uv_is_closing((const uv_handle_t*)&m_Handle))
+        return;
+      m_Closing = true;
       m_UDP->impl = nullptr;
+      m_UDP->sendto_batch = nullptr;
+      m_UDP->sendto_segmented = nullptr;
       uv_check_stop(&m_Ticker);
+#ifdef LOKINET_IO_URING
+      if (m_RingActive)
+      {
+        m_RingActive = false;
+        uv_poll_stop(&m_RingPoll);
+        uv_prepare_stop(&m_RingSubmit);
+        // same as below, the ring goes away with the glue once the socket is closed
+        uv_close((uv_handle_t*)&m_RingSubmit, [](uv_handle_t* h) {
+          auto* self = static_cast<udp_glue*>(h->data);
+          uv_close((uv_handle_t*)&self->m_RingPoll, [](uv_handle_t* h) {
+            auto* self = static_cast<udp_glue*>(h->data);
+            uv_close((uv_handle_t*)&self->m_Handle, &OnClosed);
+          });
+        });
+        return;
+      }
+#endif
+#ifdef LOKINET_XDP
+      if (m_XDP)
+      {
+        // the receiver goes away with the glue once the socket is closed
+        m_XDPClosing = m_XDP->NumQueues();
+        for (size_t idx = 0; idx < m_XDP->NumQueues(); ++idx)
+        {
+          uv_poll_stop(&m_XDPPolls[idx]);
+          uv_close((uv_handle_t*)&m_XDPPolls[idx], [](uv_handle_t* h) {
+            auto* self = static_cast<udp_glue*>(h->data);
+            if (--self->m_XDPClosing == 0)
+              uv_close((uv_handle_t*)&self->m_Handle, &OnClosed);
+          });
+        }
+        return;
+      }
+#endif
+      if (m_UDP->gro)
+      {
+        m_UDP->gro = false;
+        // the poll handle must go away before the socket it watches
+        uv_poll_stop(&m_GROPoll);
+        uv_close((uv_handle_t*)&m_GROPoll, [](uv_handle_t* h) {
+          auto* self = static_cast<udp_glue*>(h->data);
+          uv_close((uv_handle_t*)&self->m_Handle, &OnClosed);
+        });
+        return;
+      }
       uv_close((uv_handle_t*)&m_Handle, &OnClosed);
     }
   };
@@ -609,6 +1127,21 @@ namespace libuv
     device* const m_Device;
     byte_t m_Buffer[1500];
     bool readpkt;
+#ifdef __linux__
+    /// a queue attached to a multiqueue device after the one m_Device opened
+    struct Queue
+    {
+      tun_glue* glue;
+      int fd = -1;
+      uv_poll_t handle;
+    };
+    std::vector<std::unique_ptr<Queue>> m_Queues;
+    /// packets carry a virtio net header and reads can be tso super packets
+    bool m_Offload = false;
+    std::vector<byte_t> m_OffloadBuffer;
+#endif
+    /// handles still closing, we go away with the last one
+    size_t m_PendingCloses = 0;
 
     tun_glue(llarp_tun_io* tun) : m_Tun(tun), m_Device(tuntap_init())
     {
@@ -619,6 +1152,10 @@ namespace libuv
 
     ~tun_glue() override
     {
+#ifdef __linux__
+      for (const auto& queue : m_Queues)
+        ::close(queue->fd);
+#endif
       tuntap_destroy(m_Device);
     }
 
@@ -636,14 +1173,53 @@ namespace libuv
     {
       if (events & UV_READABLE)
       {
-        static_cast<tun_glue*>(h->data)->Read();
+        auto* self = static_cast<tun_glue*>(h->data);
+#ifdef __linux__
+        if (self->m_Offload)
+        {
+          self->ReadOffloaded(self->m_Device->tun_fd);
+          return;
+        }
+#endif
+        self->HandleRead(tuntap_read(self->m_Device, self->m_Buffer, sizeof(self->m_Buffer)));
+      }
+    }
+
+#ifdef __linux__
+    static void
+    OnQueuePoll(uv_poll_t* h, int, int events)
+    {
+      if (events & UV_READABLE)
+      {
+        auto* queue = static_cast<Queue*>(h->data);
+        auto* self = queue->glue;
+        if (self->m_Offload)
+          self->ReadOffloaded(queue->fd);
+        else
+          self->HandleRead(::read(queue->fd, self->m_Buffer, sizeof(self->m_Buffer)));
       }
     }
 
     void
-    Read()
+    ReadOffloaded(int fd)
+    {
+      const auto sz = ::read(fd, m_OffloadBuffer.data(), m_OffloadBuffer.size());
+      if (sz <= 0)
+        return;
+      const bool ok = llarp::net::SplitOffloadedPacket(
+          m_OffloadBuffer.data(), sz, [this](const byte_t* ptr, size_t len) {
+            const llarp_buffer_t pkt(ptr, len);
+            if (m_Tun && m_Tun->recvpkt)
+              m_Tun->recvpkt(m_Tun, pkt);
+          });
+      if (not ok)
+        llarp::LogDebug("dropping tun packet of ", sz, " bytes we could not segment");
+    }
+#endif
+
+    void
+    HandleRead(ssize_t sz)
     {
-      auto sz = tuntap_read(m_Device, m_Buffer, sizeof(m_Buffer));
       if (sz > 0)
       {
         llarp::LogDebug("tun read ", sz);
@@ -662,17 +1238,27 @@ namespace libuv
         m_Tun->tick(m_Tun);
     }
 
+    void
+    HandleClosed()
+    {
+      if (--m_PendingCloses == 0)
+        delete this;
+    }
+
     static void
     OnClosed(uv_handle_t* h)
     {
-      auto* self = static_cast<tun_glue*>(h->data);
-      if (self)
-      {
-        h->data = nullptr;
-        delete self;
-      }
+      static_cast<tun_glue*>(h->data)->HandleClosed();
     }
 
+#ifdef __linux__
+    static void
+    OnQueueClosed(uv_handle_t* h)
+    {
+      static_cast<Queue*>(h->data)->glue->HandleClosed();
+    }
+#endif
+
     void
     Close() override
     {
@@ -680,18 +1266,67 @@ namespace libuv
         return;
       m_Tun->impl = nullptr;
       uv_check_stop(&m_Ticker);
-      uv_close((uv_handle_t*)&m_Ticker, [](uv_handle_t* h) {
-        tun_glue* glue = static_cast<tun_glue*>(h->data);
-        uv_close((uv_handle_t*)&glue->m_Handle, &OnClosed);
-      });
+      m_PendingCloses = 2;
+#ifdef __linux__
+      m_PendingCloses += m_Queues.size();
+      for (auto& queue : m_Queues)
+        uv_close((uv_handle_t*)&queue->handle, &OnQueueClosed);
+#endif
+      uv_close((uv_handle_t*)&m_Ticker, &OnClosed);
+      uv_close((uv_handle_t*)&m_Handle, &OnClosed);
     }
 
     bool
     Write(const byte_t* pkt, size_t sz)
     {
+#ifdef __linux__
+      if (m_Offload or not m_Queues.empty())
+        return WriteTo(QueueFor(pkt, sz), pkt, sz);
+#endif
       return tuntap_write(m_Device, (void*)pkt, sz) != -1;
     }
 
+#ifdef __linux__
+    /// keep each flow on one queue so its packets reach the kernel in order on one cpu
+    int
+    QueueFor(const byte_t* pkt, size_t sz) const
+    {
+      if (m_Queues.empty())
+        return m_Device->tun_fd;
+      const size_t idx = llarp::net::FlowHash(pkt, sz) % (m_Queues.size() + 1);
+      return idx == 0 ? m_Device->tun_fd : m_Queues[idx - 1]->fd;
+    }
+
+    bool
+    WriteTo(int fd, const byte_t* pkt, size_t sz)
+    {
+      if (not m_Offload)
+        return ::write(fd, pkt, sz) != -1;
+      // nothing for the kernel to do with what we write, lokinet checksums its packets
+      const llarp::net::VirtioNetHdr hdr{};
+      iovec iov[2] = {{const_cast<llarp::net::VirtioNetHdr*>(&hdr), sizeof(hdr)},
+                      {const_cast<byte_t*>(pkt), sz}};
+      return ::writev(fd, iov, 2) != -1;
+    }
+
+    /// write a run of tcp segments as one tso super packet, the headers once then each payload
+    bool
+    WriteCoalesced(const llarp_tun_pkt* pkts, size_t n)
+    {
+      llarp::net::VirtioNetHdr hdr;
+      byte_t header[llarp::net::MaxCoalescedHeaderSize];
+      const size_t hdrlen = llarp::net::MakeCoalescedHeader(pkts, n, hdr, header);
+      std::array<iovec, llarp::net::MaxCoalescedPackets + 2> iov;
+      iov[0] = {&hdr, sizeof(hdr)};
+      iov[1] = {header, hdrlen};
+      for (size_t idx = 0; idx < n; ++idx)
+      {
+        iov[idx + 2] = {const_cast<byte_t*>(pkts[idx].base) + hdrlen, pkts[idx].sz - hdrlen};
+      }
+      return ::writev(QueueFor(pkts[0].base, pkts[0].sz), iov.data(), n + 2) != -1;
+    }
+#endif
+
     static bool
     WritePkt(llarp_tun_io* tun, const byte_t* pkt, size_t sz)
     {
@@ -699,11 +1334,94 @@ namespace libuv
       return glue && glue->Write(pkt, sz);
     }
 
+    size_t
+    WriteBatch(const llarp_tun_pkt* pkts, size_t n)
+    {
+      size_t written = 0;
+      size_t idx = 0;
+      while (idx < n)
+      {
+        size_t run = 1;
+#ifdef __linux__
+        // with a vnet header we can hand a whole stretch of one tcp stream over in one writev
+        if (m_Offload)
+          run = llarp::net::CoalescableRun(pkts + idx, n - idx);
+        if (run > 1)
+        {
+          if (WriteCoalesced(pkts + idx, run))
+            written += run;
+          idx += run;
+          continue;
+        }
+#endif
+        if (Write(pkts[idx].base, pkts[idx].sz))
+          written++;
+        idx++;
+      }
+      return written;
+    }
+
+    static size_t
+    WritePkts(llarp_tun_io* tun, const llarp_tun_pkt* pkts, size_t n)
+    {
+      tun_glue* glue = static_cast<tun_glue*>(tun->impl);
+      return glue ? glue->WriteBatch(pkts, n) : 0;
+    }
+
+#ifdef __linux__
+    /// attach the rest of the queues to a multiqueue device, we make do with however many we
+    /// manage to open
+    void
+    OpenQueues(uv_loop_t* loop)
+    {
+      for (size_t idx = 1; idx < m_Tun->queues; ++idx)
+      {
+        auto queue = std::make_unique<Queue>();
+        queue->glue = this;
+        queue->handle.data = queue.get();
+        queue->fd = ::open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+        if (queue->fd == -1)
+        {
+          llarp::LogWarn("failed to open tun queue ", idx, ": ", strerror(errno));
+          break;
+        }
+        ifreq ifr{};
+        std::strncpy(ifr.ifr_name, m_Device->if_name, sizeof(ifr.ifr_name) - 1);
+        ifr.ifr_flags = IFF_TUN | IFF_NO_PI | IFF_MULTI_QUEUE;
+        if (m_Offload)
+          ifr.ifr_flags |= IFF_VNET_HDR;
+        if (::ioctl(queue->fd, TUNSETIFF, &ifr) == -1
+            or uv_poll_init(loop, &queue->handle, queue->fd) != 0)
+        {
+          llarp::LogWarn("failed to attach tun queue ", idx, " to ", m_Tun->ifname);
+          ::close(queue->fd);
+          break;
+        }
+        // in the list before starting so Close() always sees it
+        m_Queues.emplace_back(std::move(queue));
+        if (uv_poll_start(&m_Queues.back()->handle, UV_READABLE, &OnQueuePoll) != 0)
+        {
+          llarp::LogWarn("failed to start polling tun queue ", idx, " on ", m_Tun->ifname);
+          break;
+        }
+      }
+      llarp::LogInfo(m_Tun->ifname, " reading ", m_Queues.size() + 1, " queues");
+    }
+#endif
+
     bool
     Init(uv_loop_t* loop)
     {
       memcpy(m_Device->if_name, m_Tun->ifname, sizeof(m_Device->if_name));
-      if (tuntap_start(m_Device, TUNTAP_MODE_TUNNEL, 0) == -1)
+      int mode = TUNTAP_MODE_TUNNEL;
+#ifdef __linux__
+      if (m_Tun->queues > 1)
+        mode |= TUNTAP_MODE_MULTIQUEUE;
+      m_Offload = m_Tun->offload;
+      if (m_Offload)
+        mode |= TUNTAP_MODE_VNETHDR;
+#endif
+      if (tuntap_start(m_Device, mode, 0) == -1)
       {
         llarp::LogError("failed to start up ", m_Tun->ifname);
         return false;
@@ -728,6 +1446,16 @@ namespace libuv
       }
 
       tuntap_set_nonblocking(m_Device, 1);
+#ifdef __linux__
+      if (m_Offload)
+      {
+        m_OffloadBuffer.resize(llarp::net::MaxOffloadPacketSize);
+        // without these we still get vnet headers, just no super packets
+        const unsigned offloads = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6 | TUN_F_TSO_ECN;
+        if (::ioctl(m_Device->tun_fd, TUNSETOFFLOAD, offloads) == -1)
+          llarp::LogWarn("failed to enable tso on ", m_Tun->ifname, ": ", strerror(errno));
+      }
+#endif
 
       if (uv_poll_init(loop, &m_Handle, m_Device->tun_fd) == -1)
       {
@@ -744,7 +1472,12 @@ namespace libuv
         llarp::LogError("failed to set up tun interface timer for ", m_Tun->ifname);
         return false;
       }
+#ifdef __linux__
+      if (m_Tun->queues > 1)
+        OpenQueues(loop);
+#endif
       m_Tun->writepkt = &WritePkt;
+      m_Tun->writepkts = &WritePkts;
       m_Tun->impl = this;
       return true;
     }
@@ -755,11 +1488,12 @@ namespace libuv
   Loop::FlushLogic()
   {
     llarp::LogTrace("Loop::FlushLogic() start");
-    while (not m_LogicCalls.empty())
-    {
-      auto f = m_LogicCalls.popFront();
-      f();
-    }
+    // cleared first so anything pushed from here on wakes us again
+    m_WakeupPending.exchange(false, std::memory_order_acq_rel);
+    // one queue's worth per call so jobs that queue more jobs can't starve io
+    m_LogicCalls.Drain(m_LogicCalls.Capacity());
+    if (not m_LogicCalls.Empty() and not m_WakeupPending.exchange(true, std::memory_order_acq_rel))
+      uv_async_send(&m_WakeUp);
     llarp::LogTrace("Loop::FlushLogic() end");
   }
 
@@ -801,6 +1535,9 @@ namespace libuv
     m_TickTimer->data = this;
     if (uv_timer_init(&m_Impl, m_TickTimer) == -1)
       return false;
+    m_TimerWakeup.data = this;
+    if (uv_timer_init(&m_Impl, &m_TimerWakeup) == -1)
+      return false;
     m_Run.store(true);
     m_nextID.store(0);
     m_WakeUp.data = this;
@@ -844,7 +1581,36 @@ namespace libuv
   {
     llarp::LogTrace("Loop::run()");
     m_EventLoopThreadID = std::this_thread::get_id();
-    return uv_run(&m_Impl, UV_RUN_DEFAULT);
+    if (m_LoopCpu >= 0 and llarp::util::PinThisThreadTo(m_LoopCpu))
+      llarp::LogInfo("event loop pinned to cpu ", m_LoopCpu);
+    if (m_BusyPoll.count() <= 0)
+      return uv_run(&m_Impl, UV_RUN_DEFAULT);
+    llarp::LogInfo("event loop busy polls for ", m_BusyPoll.count(), "us before it blocks");
+    int ret = 1;
+    while (ret and m_Run)
+    {
+      BusyPoll();
+      ret = uv_run(&m_Impl, UV_RUN_ONCE);
+    }
+    return ret;
+  }
+
+  void
+  Loop::BusyPoll()
+  {
+#ifdef __linux__
+    // running the loop itself while we spin would pump every link session each time around,
+    // so we only ask the backend if something is ready and leave it to the loop to take it
+    pollfd backend{uv_backend_fd(&m_Impl), POLLIN, 0};
+    if (backend.fd < 0)
+      return;
+    auto spin = m_BusyPoll;
+    if (const int timeout = uv_backend_timeout(&m_Impl); timeout >= 0)
+      spin = std::min<std::chrono::microseconds>(spin, std::chrono::milliseconds{timeout});
+    const auto until = std::chrono::steady_clock::now() + spin;
+    while (::poll(&backend, 1, 0) == 0 and std::chrono::steady_clock::now() < until)
+      ;
+#endif
   }
 
   int
@@ -861,29 +1627,12 @@ namespace libuv
     return 0;
   }
 
-  struct TimerData
-  {
-    Loop* loop;
-    uint64_t job_id;
-  };
-
-  void
-  CloseUVTimer(uv_timer_t* timer)
-  {
-    // have to delete timer handle this way because libuv.
-    uv_timer_stop(timer);
-    uv_close((uv_handle_t*)timer, [](uv_handle_t* handle) { delete (uv_timer_t*)handle; });
-  }
-
   static void
-  OnUVTimer(uv_timer_t* timer)
+  OnTimerWakeup(uv_timer_t* timer)
   {
-    TimerData* timer_data = static_cast<TimerData*>(timer->data);
-    Loop* loop = timer_data->loop;
-    loop->do_timer_job(timer_data->job_id);
-
-    delete timer_data;
-    CloseUVTimer(timer);
+    Loop* loop = static_cast<Loop*>(timer->data);
+    loop->update_time();
+    loop->run_timers();
   }
 
   uint32_t
@@ -915,22 +1664,15 @@ namespace libuv
   void
   Loop::process_timer_queue()
   {
+    if (m_timerQueue.empty())
+      return;
+    const auto now = time_now();
     while (not m_timerQueue.empty())
     {
       PendingTimer job = m_timerQueue.popFront();
-      uint64_t job_id = job.job_id;
-      m_pendingCalls.emplace(job_id, std::move(job.callback));
-
-      TimerData* timer_data = new TimerData;
-      timer_data->loop = this;
-      timer_data->job_id = job_id;
-
-      uv_timer_t* newTimer = new uv_timer_t;
-      newTimer->data = (void*)timer_data;
-
-      uv_timer_init(&m_Impl, newTimer);
-      uv_timer_start(newTimer, &OnUVTimer, job.delay_ms.count(), 0);
+      m_Timers.Schedule(job.job_id, now, job.delay_ms, std::move(job.callback));
     }
+    run_timers();
   }
 
   void
@@ -938,21 +1680,23 @@ namespace libuv
   {
     while (not m_timerCancelQueue.empty())
     {
-      uint64_t job_id = m_timerCancelQueue.popFront();
-      m_pendingCalls.erase(job_id);
+      m_Timers.Cancel(m_timerCancelQueue.popFront());
     }
   }
 
   void
-  Loop::do_timer_job(uint64_t job_id)
+  Loop::run_timers()
   {
-    auto itr = m_pendingCalls.find(job_id);
-    if (itr != m_pendingCalls.end())
+    const auto now = time_now();
+    m_Timers.Advance(now);
+    const auto next = m_Timers.NextWakeup();
+    if (not next)
     {
-      if (itr->second)
-        itr->second();
-      m_pendingCalls.erase(itr->first);
+      uv_timer_stop(&m_TimerWakeup);
+      return;
     }
+    const auto delay = std::max(*next - now, llarp_time_t{0});
+    uv_timer_start(&m_TimerWakeup, &OnTimerWakeup, delay.count(), 0);
   }
 
   void
@@ -1071,22 +1815,26 @@ namespace libuv
   }
 
   void
-  Loop::call_soon(std::function<void(void)> f)
+  Loop::call_soon(llarp::thread::Job f)
   {
-    if (not m_EventLoopThreadID.has_value())
-    {
-      m_LogicCalls.tryPushBack(f);
-      uv_async_send(&m_WakeUp);
-      return;
-    }
-    const auto inEventLoop = *m_EventLoopThreadID == std::this_thread::get_id();
-
-    if (inEventLoop and m_LogicCalls.full())
+    if (not m_LogicCalls.TryPush(f))
     {
-      FlushLogic();
+      if (not m_EventLoopThreadID.has_value())
+      {
+        llarp::LogWarn("event loop not running and its queue is full, dropping job");
+        return;
+      }
+      const auto inEventLoop = *m_EventLoopThreadID == std::this_thread::get_id();
+      while (not m_LogicCalls.TryPush(f))
+      {
+        if (inEventLoop)
+          FlushLogic();
+        else
+          std::this_thread::yield();
+      }
     }
-    m_LogicCalls.pushBack(f);
-    uv_async_send(&m_WakeUp);
+    if (not m_WakeupPending.exchange(true, std::memory_order_acq_rel))
+      uv_async_send(&m_WakeUp);
   }
 
   void
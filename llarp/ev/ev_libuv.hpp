@@ -5,9 +5,11 @@
 #include <uv.h>
 #include <vector>
 #include <functional>
+#include <util/thread/job_queue.hpp>
 #include <util/thread/logic.hpp>
 #include <util/thread/queue.hpp>
 #include <util/meta/memfn.hpp>
+#include <util/timer_wheel.hpp>
 
 #include <map>
 
@@ -57,8 +59,9 @@ namespace libuv
     void
     process_cancel_queue();
 
+    /// run due timers and rearm the wakeup for the next one
     void
-    do_timer_job(uint64_t job_id);
+    run_timers();
 
     void
     stop() override;
@@ -106,6 +109,18 @@ namespace libuv
     bool
     add_ticker(std::function<void(void)> ticker) override;
 
+    void
+    set_busy_poll(std::chrono::microseconds spin) override
+    {
+      m_BusyPoll = spin;
+    }
+
+    void
+    set_loop_cpu(int cpu) override
+    {
+      m_LoopCpu = cpu;
+    }
+
     /// register event listener
     bool
     add_ev(llarp::ev_io*, bool) override
@@ -123,7 +138,7 @@ namespace libuv
     std::shared_ptr<llarp::Logic> m_Logic;
 
     void
-    call_soon(std::function<void(void)> f) override;
+    call_soon(llarp::thread::Job f) override;
 
     void
     register_poll_fd_readable(int fd, Callback callback) override;
@@ -139,8 +154,9 @@ namespace libuv
     uv_timer_t* m_TickTimer;
     uv_async_t m_WakeUp;
     std::atomic<bool> m_Run;
-    using AtomicQueue_t = llarp::thread::Queue<std::function<void(void)>>;
-    AtomicQueue_t m_LogicCalls;
+    llarp::thread::JobQueue m_LogicCalls;
+    /// set while a wakeup is on its way so producers only poke the loop once per batch
+    std::atomic<bool> m_WakeupPending{false};
 
 #ifdef LOKINET_DEBUG
     uint64_t last_time;
@@ -148,13 +164,22 @@ namespace libuv
 #endif
     std::atomic<uint32_t> m_nextID;
 
-    std::map<uint32_t, Callback> m_pendingCalls;
+    /// every call_after_delay lives in here, woken up by the one uv timer below
+    llarp::util::TimerWheel m_Timers;
+    uv_timer_t m_TimerWakeup;
 
     std::unordered_map<int, uv_poll_t> m_Polls;
 
     llarp::thread::Queue<PendingTimer> m_timerQueue;
     llarp::thread::Queue<uint32_t> m_timerCancelQueue;
     std::optional<std::thread::id> m_EventLoopThreadID;
+
+    std::chrono::microseconds m_BusyPoll{0};
+    int m_LoopCpu = -1;
+
+    /// spin until the backend has something for us, m_BusyPoll goes by or a timer is due
+    void
+    BusyPoll();
   };
 
 }  // namespace libuv
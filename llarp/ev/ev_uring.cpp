@@ -0,0 +1,209 @@
+#include <ev/ev_uring.hpp>
+#include <constants/evloop.hpp>
+#include <util/logging/logger.hpp>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace llarp
+{
+  namespace uring
+  {
+    /// user data of the multishot recv, sends carry their slot index
+    static constexpr uint64_t RecvTag = ~uint64_t{0};
+    /// id of our provided buffer group
+    static constexpr int BufGroup = 0;
+    /// size of each provided buffer, holds the recvmsg header, the peer address and one datagram
+    static constexpr size_t RecvBufferSize = 4096;
+
+    std::unique_ptr<UDPRing>
+    UDPRing::Create(int fd)
+    {
+      std::unique_ptr<UDPRing> ring{new UDPRing{}};
+      if (not ring->Init(fd))
+        return nullptr;
+      return ring;
+    }
+
+    bool
+    UDPRing::Init(int fd)
+    {
+      int ret = io_uring_queue_init(RingDepth, &m_Ring, 0);
+      if (ret < 0)
+      {
+        LogWarn("io_uring_queue_init failed: ", strerror(-ret));
+        return false;
+      }
+      m_RingInited = true;
+      // index 0 in the fixed file table from here on
+      ret = io_uring_register_files(&m_Ring, &fd, 1);
+      if (ret < 0)
+      {
+        LogWarn("io_uring_register_files failed: ", strerror(-ret));
+        return false;
+      }
+      m_EventFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (m_EventFD == -1 or io_uring_register_eventfd(&m_Ring, m_EventFD) < 0)
+      {
+        LogWarn("failed to register io_uring eventfd: ", strerror(errno));
+        return false;
+      }
+      m_BufRing = io_uring_setup_buf_ring(&m_Ring, NumRecvBuffers, BufGroup, 0, &ret);
+      if (m_BufRing == nullptr)
+      {
+        LogWarn("io_uring provided buffers unavailable: ", strerror(-ret));
+        return false;
+      }
+      m_RecvBuffers.resize(NumRecvBuffers * RecvBufferSize);
+      const int mask = io_uring_buf_ring_mask(NumRecvBuffers);
+      for (unsigned idx = 0; idx < NumRecvBuffers; ++idx)
+      {
+        byte_t* buf = m_RecvBuffers.data() + (idx * RecvBufferSize);
+        io_uring_buf_ring_add(m_BufRing, buf, RecvBufferSize, idx, mask, idx);
+      }
+      io_uring_buf_ring_advance(m_BufRing, NumRecvBuffers);
+
+      m_SendSlots.resize(NumSendSlots);
+      m_FreeSlots.reserve(NumSendSlots);
+      for (uint16_t idx = 0; idx < NumSendSlots; ++idx)
+        m_FreeSlots.push_back(NumSendSlots - 1 - idx);
+
+      m_RecvHdr.msg_namelen = sizeof(sockaddr_in6);
+      if (not ArmRecv())
+        return false;
+      Submit();
+      return true;
+    }
+
+    UDPRing::~UDPRing()
+    {
+      if (m_BufRing)
+        io_uring_free_buf_ring(&m_Ring, m_BufRing, NumRecvBuffers, BufGroup);
+      if (m_RingInited)
+        io_uring_queue_exit(&m_Ring);
+      if (m_EventFD != -1)
+        ::close(m_EventFD);
+    }
+
+    bool
+    UDPRing::ArmRecv()
+    {
+      auto* sqe = io_uring_get_sqe(&m_Ring);
+      if (sqe == nullptr)
+      {
+        Submit();
+        sqe = io_uring_get_sqe(&m_Ring);
+      }
+      if (sqe == nullptr)
+        return false;
+      io_uring_prep_recvmsg_multishot(sqe, 0, &m_RecvHdr, 0);
+      sqe->flags |= IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+      sqe->buf_group = BufGroup;
+      io_uring_sqe_set_data64(sqe, RecvTag);
+      m_RecvArmed = true;
+      m_Unsubmitted++;
+      return true;
+    }
+
+    bool
+    UDPRing::QueueSend(const SockAddr& to, const byte_t* ptr, size_t sz)
+    {
+      if (sz > MaxSendSize or m_FreeSlots.empty())
+        return false;
+      auto* sqe = io_uring_get_sqe(&m_Ring);
+      if (sqe == nullptr)
+      {
+        Submit();
+        sqe = io_uring_get_sqe(&m_Ring);
+      }
+      if (sqe == nullptr)
+        return false;
+      const auto idx = m_FreeSlots.back();
+      m_FreeSlots.pop_back();
+      auto& slot = m_SendSlots[idx];
+      // the kernel reads the datagram when it runs the sqe so it has to outlive this call
+      std::copy_n(ptr, sz, slot.data.begin());
+      std::memcpy(&slot.addr, static_cast<const sockaddr*>(to), sizeof(slot.addr));
+      slot.iov = {slot.data.data(), sz};
+      slot.hdr = {};
+      slot.hdr.msg_name = &slot.addr;
+      slot.hdr.msg_namelen = sizeof(slot.addr);
+      slot.hdr.msg_iov = &slot.iov;
+      slot.hdr.msg_iovlen = 1;
+      io_uring_prep_sendmsg(sqe, 0, &slot.hdr, 0);
+      sqe->flags |= IOSQE_FIXED_FILE;
+      io_uring_sqe_set_data64(sqe, idx);
+      if (++m_Unsubmitted >= udp_batch_size)
+        Submit();
+      return true;
+    }
+
+    void
+    UDPRing::Submit()
+    {
+      if (m_Unsubmitted == 0)
+        return;
+      const int ret = io_uring_submit(&m_Ring);
+      if (ret < 0)
+      {
+        LogWarn("io_uring_submit failed: ", strerror(-ret));
+        return;
+      }
+      m_Unsubmitted = 0;
+    }
+
+    size_t
+    UDPRing::Drain(const RecvHandler_t& recv, const std::function<void(void)>& flush)
+    {
+      eventfd_t ignored;
+      ::eventfd_read(m_EventFD, &ignored);
+
+      const int mask = io_uring_buf_ring_mask(NumRecvBuffers);
+      size_t numRead = 0;
+      int numReturned = 0;
+      unsigned numSeen = 0;
+      unsigned head;
+      io_uring_cqe* cqe;
+      io_uring_for_each_cqe(&m_Ring, head, cqe)
+      {
+        numSeen++;
+        const auto tag = io_uring_cqe_get_data64(cqe);
+        if (tag != RecvTag)
+        {
+          if (tag < m_SendSlots.size())
+            m_FreeSlots.push_back(tag);
+          continue;
+        }
+        if (not(cqe->flags & IORING_CQE_F_MORE))
+          m_RecvArmed = false;
+        if (not(cqe->flags & IORING_CQE_F_BUFFER))
+          continue;
+        const uint16_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        byte_t* buf = m_RecvBuffers.data() + (bid * RecvBufferSize);
+        auto* out = cqe->res > 0 ? io_uring_recvmsg_validate(buf, cqe->res, &m_RecvHdr) : nullptr;
+        if (out and out->namelen >= sizeof(sockaddr_in) and not(out->flags & MSG_TRUNC))
+        {
+          const auto* name = static_cast<const sockaddr*>(io_uring_recvmsg_name(out));
+          const auto* payload =
+              static_cast<const byte_t*>(io_uring_recvmsg_payload(out, &m_RecvHdr));
+          const auto len = io_uring_recvmsg_payload_length(out, cqe->res, &m_RecvHdr);
+          recv(SockAddr{*name}, payload, len);
+          numRead++;
+        }
+        // queued now but the kernel only sees it once we advance below
+        io_uring_buf_ring_add(m_BufRing, buf, RecvBufferSize, bid, mask, numReturned++);
+      }
+      // whoever got the datagrams is done with them after this so the buffers can go back
+      flush();
+      io_uring_buf_ring_advance(m_BufRing, numReturned);
+      io_uring_cq_advance(&m_Ring, numSeen);
+      // the kernel drops the multishot when it runs out of buffers or hits an error
+      if (not m_RecvArmed)
+        ArmRecv();
+      Submit();
+      return numRead;
+    }
+  }  // namespace uring
+}  // namespace llarp
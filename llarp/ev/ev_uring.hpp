@@ -0,0 +1,95 @@
+#ifndef LLARP_EV_URING_HPP
+#define LLARP_EV_URING_HPP
+
+#include <ev/ev.h>
+#include <net/sock_addr.hpp>
+
+#include <liburing.h>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace llarp
+{
+  namespace uring
+  {
+    /// io_uring driven reads and writes for one bound udp socket
+    /// the socket is registered as a fixed file, reads are a single multishot recvmsg into a
+    /// kernel provided buffer ring and writes are queued as sqes that go out in one submit
+    struct UDPRing
+    {
+      /// largest datagram we copy into a send slot, bigger ones are sent directly
+      static constexpr size_t MaxSendSize = 2048;
+      static constexpr unsigned RingDepth = 512;
+      static constexpr unsigned NumRecvBuffers = 256;
+      static constexpr unsigned NumSendSlots = 256;
+
+      using RecvHandler_t = std::function<void(const SockAddr&, const byte_t*, size_t)>;
+
+      /// set up a ring for fd, returns nullptr if the kernel lacks what we need
+      static std::unique_ptr<UDPRing>
+      Create(int fd);
+
+      ~UDPRing();
+
+      UDPRing(const UDPRing&) = delete;
+      UDPRing&
+      operator=(const UDPRing&) = delete;
+
+      /// eventfd that gets readable when completions are waiting
+      int
+      EventFD() const
+      {
+        return m_EventFD;
+      }
+
+      /// queue a datagram, it goes out on the next Submit
+      /// returns false if no send slot was free or the datagram is too big for one
+      bool
+      QueueSend(const SockAddr& to, const byte_t* ptr, size_t sz);
+
+      /// hand every queued sqe to the kernel in one syscall
+      void
+      Submit();
+
+      /// reap completions, calling recv for every datagram read and flush once after the last
+      /// the datagrams are only valid until flush returns
+      /// returns the number of datagrams read
+      size_t
+      Drain(const RecvHandler_t& recv, const std::function<void(void)>& flush);
+
+     private:
+      UDPRing() = default;
+
+      bool
+      Init(int fd);
+
+      bool
+      ArmRecv();
+
+      struct SendSlot
+      {
+        sockaddr_in6 addr;
+        iovec iov;
+        msghdr hdr;
+        std::array<byte_t, MaxSendSize> data;
+      };
+
+      io_uring m_Ring{};
+      bool m_RingInited = false;
+      int m_EventFD = -1;
+      io_uring_buf_ring* m_BufRing = nullptr;
+      std::vector<byte_t> m_RecvBuffers;
+      /// template for the multishot recv, the kernel only reads the name and control lengths
+      msghdr m_RecvHdr{};
+      bool m_RecvArmed = false;
+      std::vector<SendSlot> m_SendSlots;
+      std::vector<uint16_t> m_FreeSlots;
+      size_t m_Unsubmitted = 0;
+    };
+  }  // namespace uring
+}  // namespace llarp
+
+#endif
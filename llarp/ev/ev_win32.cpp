@@ -3,6 +3,7 @@
 #ifdef _WIN32
 
 #include <util/logging/logger.hpp>
+#include <algorithm>
 #include <atomic>
 
 // a single event queue for the TUN interface
@@ -27,11 +28,30 @@ begin_tun_loop(int nThreads, llarp_ev_loop* loop)
   poolSize = nThreads;
 }
 
+// completions dequeued per wakeup
+static constexpr ULONG TunCompletionBatch = 64;
+// what a cancelled read completes with
+static constexpr ULONG_PTR StatusCancelled = 0xC0000120;
+
+win32_tun_io::win32_tun_io(llarp_tun_io* tio)
+    : t(tio)
+    , tunif(tuntap_init())
+    , m_ReadSlots(new asio_evt_pkt[OutstandingReads])
+    , m_WriteSlots(new asio_evt_pkt[WriteSlots])
+{
+  m_FreeWrites.reserve(WriteSlots);
+  for (size_t idx = 0; idx < WriteSlots; ++idx)
+  {
+    m_WriteSlots[idx].write = true;
+    m_FreeWrites.push_back(&m_WriteSlots[idx]);
+  }
+}
+
 // this one is called from the TUN handler
 bool
 win32_tun_io::queue_write(const byte_t* buf, size_t sz)
 {
-  return do_write((void*)buf, sz);
+  return do_write(buf, sz);
 }
 
 bool
@@ -84,25 +104,41 @@ win32_tun_io::add_ev(llarp_ev_loop* loop)
   // we're already non-blocking
   // add to list
   tun_listeners.push_back(this);
-  byte_t* readbuf = (byte_t*)malloc(1500);
-  read(readbuf, 1500);
+  for (size_t idx = 0; idx < OutstandingReads; ++idx)
+    read(&m_ReadSlots[idx]);
   return true;
 }
 
-// places data in event queue for kernel to process
+// copies into a pooled slot and places it in event queue for kernel to process
 bool
-win32_tun_io::do_write(void* data, size_t sz)
+win32_tun_io::do_write(const byte_t* data, size_t sz)
 {
-  DWORD code;
-  asio_evt_pkt* pkt = new asio_evt_pkt;
-  pkt->buf = data;
-  pkt->sz = sz;
-  pkt->write = true;
+  if (sz > sizeof(asio_evt_pkt::buf))
+    return false;
+  asio_evt_pkt* pkt = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(m_WriteMutex);
+    if (m_FreeWrites.empty())
+      return false;
+    pkt = m_FreeWrites.back();
+    m_FreeWrites.pop_back();
+  }
   memset(&pkt->pkt, '\0', sizeof(pkt->pkt));
-  WriteFile(tunif->tun_fd, data, sz, nullptr, &pkt->pkt);
-  code = GetLastError();
-  // llarp::LogInfo("wrote data, error ", code);
-  return (code == 0 || code == 997);
+  memcpy(pkt->buf, data, sz);
+  pkt->sz = sz;
+  // the slot comes back through the completion port, even when this finishes right away
+  if (WriteFile(tunif->tun_fd, pkt->buf, sz, nullptr, &pkt->pkt)
+      || GetLastError() == ERROR_IO_PENDING)
+    return true;
+  release_write(pkt);
+  return false;
+}
+
+void
+win32_tun_io::release_write(asio_evt_pkt* pkt)
+{
+  std::lock_guard<std::mutex> lock(m_WriteMutex);
+  m_FreeWrites.push_back(pkt);
 }
 
 // while this one is called from the event loop
@@ -115,34 +151,33 @@ win32_tun_io::flush_write()
 }
 
 void
-win32_tun_io::read(byte_t* buf, size_t sz)
+win32_tun_io::read(asio_evt_pkt* pkt)
 {
-  asio_evt_pkt* pkt = new asio_evt_pkt;
-  pkt->buf = buf;
   memset(&pkt->pkt, '\0', sizeof(OVERLAPPED));
-  pkt->sz = sz;
+  pkt->sz = 0;
   pkt->write = false;
-  ReadFile(tunif->tun_fd, buf, sz, nullptr, &pkt->pkt);
+  if (!ReadFile(tunif->tun_fd, pkt->buf, sizeof(pkt->buf), nullptr, &pkt->pkt)
+      && GetLastError() != ERROR_IO_PENDING)
+    llarp::LogWarn("failed to post tun read: ", GetLastError());
 }
 
 // and now the event loop itself
+// completions are taken in batches and everything read in one batch goes to the logic thread
+// in a single call, followed by one tick of each device that saw io
 extern "C" DWORD FAR PASCAL
 tun_ev_loop(void* u)
 {
   llarp_ev_loop* logic = static_cast<llarp_ev_loop*>(u);
 
-  DWORD size = 0;
-  OVERLAPPED* ovl = nullptr;
-  ULONG_PTR listener = 0;
-  asio_evt_pkt* pkt = nullptr;
-  BOOL alert;
+  OVERLAPPED_ENTRY entries[TunCompletionBatch];
+  ULONG count = 0;
+  bool exiting = false;
 
   std::atomic_flag tick_queued;
-  while (true)
+  while (!exiting)
   {
-    alert = GetQueuedCompletionStatus(tun_event_queue, &size, &listener, &ovl, EV_TICK_INTERVAL);
-
-    if (!alert)
+    if (!GetQueuedCompletionStatusEx(
+            tun_event_queue, entries, TunCompletionBatch, &count, EV_TICK_INTERVAL, FALSE))
     {
       // tick listeners on io timeout, this is required to be done every tick
       // cycle regardless of any io being done, this manages the internal state
@@ -163,28 +198,56 @@ tun_ev_loop(void* u)
 
       continue;
     }
-    if (listener == (ULONG_PTR)~0)
-      break;
     // if we're here, then we got something interesting :>
-    pkt = (asio_evt_pkt*)ovl;
-    win32_tun_io* ev = reinterpret_cast<win32_tun_io*>(listener);
-    if (!pkt->write)
+    std::vector<std::pair<win32_tun_io*, asio_evt_pkt*>> reads;
+    std::vector<win32_tun_io*> active;
+    ULONG exits = 0;
+    for (ULONG idx = 0; idx < count; ++idx)
     {
-      // llarp::LogInfo("read tun ", size, " bytes, pass to handler");
-      logic->call_soon([pkt, size, ev]() {
-        if (ev->t->recvpkt)
-          ev->t->recvpkt(ev->t, llarp_buffer_t(pkt->buf, size));
-        free(pkt->buf);
-        delete pkt;
-      });
-      byte_t* readbuf = (byte_t*)malloc(1500);
-      ev->read(readbuf, 1500);
+      const auto& entry = entries[idx];
+      if (entry.lpCompletionKey == (ULONG_PTR)~0)
+      {
+        ++exits;
+        continue;
+      }
+      win32_tun_io* ev = reinterpret_cast<win32_tun_io*>(entry.lpCompletionKey);
+      asio_evt_pkt* pkt = reinterpret_cast<asio_evt_pkt*>(entry.lpOverlapped);
+      if (std::find(active.begin(), active.end(), ev) == active.end())
+        active.push_back(ev);
+      if (pkt->write)
+      {
+        ev->release_write(pkt);
+        continue;
+      }
+      // the device is going away, leave the slot be
+      if (entry.lpOverlapped->Internal == StatusCancelled)
+        continue;
+      pkt->sz = entry.dwNumberOfBytesTransferred;
+      reads.emplace_back(ev, pkt);
     }
-
-    logic->call_soon([ev]() {
-      ev->flush_write();
-      if (ev->t->tick)
-        ev->t->tick(ev->t);
+    if (exits)
+    {
+      exiting = true;
+      // one each for the other threads, hand back any we took that were theirs
+      for (ULONG idx = 1; idx < exits; ++idx)
+        PostQueuedCompletionStatus(tun_event_queue, 0, ~0, nullptr);
+      continue;
+    }
+    if (active.empty())
+      continue;
+    logic->call_soon([reads = std::move(reads), active = std::move(active)]() {
+      for (const auto& [ev, pkt] : reads)
+      {
+        if (pkt->sz && ev->t->recvpkt)
+          ev->t->recvpkt(ev->t, llarp_buffer_t(pkt->buf, pkt->sz));
+        ev->read(pkt);
+      }
+      for (const auto& ev : active)
+      {
+        ev->flush_write();
+        if (ev->t->tick)
+          ev->t->tick(ev->t);
+      }
     });
   }
   llarp::LogDebug("exit TUN event loop thread from system managed thread pool");
@@ -11,15 +11,17 @@
 #include <process.h>
 
 #include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
 
-// io packet for TUN read/write
+// io packet for TUN read/write, pooled by the device so the buffer outlives the call
 struct asio_evt_pkt
 {
   OVERLAPPED pkt = {0, 0, 0, 0, nullptr};  // must be first, since this is part of the IO call
   bool write = false;                      // true, or false if read pkt
-  size_t sz;                               // should match the queued data size, if not try again?
-  void* buf;  // must remain valid until we get notification; this is _supposed_
-              // to be zero-copy
+  size_t sz = 0;                           // bytes queued, or read once it completes
+  byte_t buf[EV_WRITE_BUF_SZ];
 };
 
 extern "C" DWORD FAR PASCAL
@@ -29,39 +31,22 @@ void
 exit_tun_loop();
 
 void
-begin_tun_loop(int nThreads);
-
-namespace llarp
-{
-  struct udp_listener : public ev_io
-  {
-    llarp_udp_io* udp;
-
-    udp_listener(int fd, llarp_udp_io* u) : ev_io(fd), udp(u){};
-
-    ~udp_listener()
-    {}
-
-    bool
-    tick();
-
-    int
-    read(byte_t* buf, size_t sz);
-
-    int
-    sendto(const sockaddr* to, const void* data, size_t sz);
-  };
-}  // namespace llarp
+begin_tun_loop(int nThreads, llarp_ev_loop* loop);
 
 // A different kind of event loop,
 // more suited for the native Windows NT
 // event model
 struct win32_tun_io
 {
+  /// reads kept posted on the device, each goes back once its packet is handled
+  static constexpr size_t OutstandingReads = 16;
+  /// writes in flight at once, past that we drop like a full queue would
+  static constexpr size_t WriteSlots = 256;
+
   llarp_tun_io* t;
   device* tunif;
 
-  win32_tun_io(llarp_tun_io* tio) : t(tio), tunif(tuntap_init()){};
+  win32_tun_io(llarp_tun_io* tio);
 
   bool
   queue_write(const byte_t* buf, size_t sz);
@@ -75,15 +60,20 @@ struct win32_tun_io
 
   // places data in event queue for kernel to process
   bool
-  do_write(void* data, size_t sz);
+  do_write(const byte_t* data, size_t sz);
 
   // we call this one when we get a packet in the event port
   // which then kicks off another write
   void
   flush_write();
 
+  /// post a read into pkt, one of our read slots
   void
-  read(byte_t* buf, size_t sz);
+  read(asio_evt_pkt* pkt);
+
+  /// give a completed write slot back
+  void
+  release_write(asio_evt_pkt* pkt);
 
   ~win32_tun_io()
   {
@@ -91,6 +81,13 @@ struct win32_tun_io
     if (tunif->tun_fd)
       tuntap_destroy(tunif);
   }
+
+ private:
+  std::unique_ptr<asio_evt_pkt[]> m_ReadSlots;
+  std::unique_ptr<asio_evt_pkt[]> m_WriteSlots;
+  /// written from the completion threads as well as the logic thread
+  std::mutex m_WriteMutex;
+  std::vector<asio_evt_pkt*> m_FreeWrites;
 };
 
 #endif
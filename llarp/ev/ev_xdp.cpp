@@ -0,0 +1,250 @@
+#include <ev/ev_xdp.hpp>
+#include <util/logging/logger.hpp>
+
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifndef LOKINET_XDP_PROGRAM
+#define LOKINET_XDP_PROGRAM "/usr/share/lokinet/lokinet_xdp.o"
+#endif
+
+namespace llarp
+{
+  namespace xdp
+  {
+    /// every frame of a umem fits in its fill ring, so giving frames back never waits
+    static constexpr unsigned RingSize = PortReceiver::NumFrames;
+
+    PortReceiver::Queue::~Queue()
+    {
+      if (xsk)
+        xsk_socket__delete(xsk);
+      if (umem)
+        xsk_umem__delete(umem);
+      if (umemArea)
+        ::munmap(umemArea, NumFrames * FrameSize);
+    }
+
+    std::unique_ptr<PortReceiver>
+    PortReceiver::Create(const std::string& ifname, uint16_t port)
+    {
+      std::unique_ptr<PortReceiver> recv{new PortReceiver{}};
+      if (not recv->Init(ifname, port))
+        return nullptr;
+      return recv;
+    }
+
+    /// rx queues the interface has, from sysfs
+    static unsigned
+    CountRxQueues(const std::string& ifname)
+    {
+      namespace fs = std::filesystem;
+      std::error_code ec;
+      unsigned num = 0;
+      for (const auto& entry : fs::directory_iterator{"/sys/class/net/" + ifname + "/queues", ec})
+      {
+        if (entry.path().filename().string().rfind("rx-", 0) == 0)
+          num++;
+      }
+      return num ? num : 1;
+    }
+
+    bool
+    PortReceiver::Init(const std::string& ifname, uint16_t port)
+    {
+      m_IfIndex = ::if_nametoindex(ifname.c_str());
+      if (m_IfIndex == 0)
+      {
+        LogWarn("no interface named ", ifname, " for xdp");
+        return false;
+      }
+      m_Port = port;
+      m_Program = xdp_program__open_file(LOKINET_XDP_PROGRAM, "xdp", nullptr);
+      if (libxdp_get_error(m_Program))
+      {
+        m_Program = nullptr;
+        LogWarn("failed to load xdp program from ", LOKINET_XDP_PROGRAM);
+        return false;
+      }
+      // libxdp lets other programs stay attached next to ours through its dispatcher
+      int ret = xdp_program__attach(m_Program, m_IfIndex, XDP_MODE_UNSPEC, 0);
+      if (ret)
+      {
+        LogWarn("failed to attach xdp program to ", ifname, ": ", strerror(-ret));
+        return false;
+      }
+      m_Attached = true;
+      auto* obj = xdp_program__bpf_obj(m_Program);
+      m_SocketMap = bpf_object__find_map_fd_by_name(obj, "xsks_map");
+      const int ports = bpf_object__find_map_fd_by_name(obj, "lokinet_ports");
+      if (m_SocketMap < 0 or ports < 0)
+      {
+        LogWarn("xdp program at ", LOKINET_XDP_PROGRAM, " lacks our maps");
+        return false;
+      }
+      const unsigned numQueues = std::min(CountRxQueues(ifname), MaxQueues);
+      for (unsigned queue = 0; queue < numQueues; ++queue)
+      {
+        if (not AddQueue(ifname, queue))
+          return false;
+      }
+      // only now, a datagram steered to a queue without a socket would be lost
+      const uint16_t key = htons(port);
+      const uint8_t val = 1;
+      if (bpf_map_update_elem(ports, &key, &val, BPF_ANY))
+      {
+        LogWarn("failed to add port ", port, " to xdp program: ", strerror(errno));
+        return false;
+      }
+      LogInfo("xdp reads on ", ifname, " port ", port, " over ", numQueues, " queues");
+      return true;
+    }
+
+    bool
+    PortReceiver::AddQueue(const std::string& ifname, unsigned queue)
+    {
+      auto q = std::make_unique<Queue>();
+      const size_t areaSize = NumFrames * FrameSize;
+      q->umemArea =
+          ::mmap(nullptr, areaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (q->umemArea == MAP_FAILED)
+      {
+        q->umemArea = nullptr;
+        return false;
+      }
+      xsk_umem_config umemConfig{};
+      umemConfig.fill_size = RingSize;
+      umemConfig.comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+      umemConfig.frame_size = FrameSize;
+      umemConfig.frame_headroom = 0;
+      int ret = xsk_umem__create(
+          &q->umem, q->umemArea, areaSize, &q->fill, &q->completion, &umemConfig);
+      if (ret)
+      {
+        LogWarn("failed to create umem for ", ifname, " queue ", queue, ": ", strerror(-ret));
+        return false;
+      }
+      xsk_socket_config config{};
+      config.rx_size = RingSize;
+      config.tx_size = XSK_RING_PROD__DEFAULT_NUM_DESCS;
+      // our program is already attached, it only needs the socket in its map
+      config.libxdp_flags = XSK_LIBXDP_FLAGS__INHIBIT_PROG_LOAD;
+      config.bind_flags = XDP_USE_NEED_WAKEUP;
+      ret = xsk_socket__create(&q->xsk, ifname.c_str(), queue, q->umem, &q->rx, &q->tx, &config);
+      if (ret)
+      {
+        LogWarn("failed to create xdp socket on ", ifname, " queue ", queue, ": ", strerror(-ret));
+        return false;
+      }
+      uint32_t idx = 0;
+      if (xsk_ring_prod__reserve(&q->fill, RingSize, &idx) != RingSize)
+        return false;
+      for (unsigned frame = 0; frame < RingSize; ++frame)
+        *xsk_ring_prod__fill_addr(&q->fill, idx++) = uint64_t{frame} * FrameSize;
+      xsk_ring_prod__submit(&q->fill, RingSize);
+      if (xsk_socket__update_xskmap(q->xsk, m_SocketMap))
+      {
+        LogWarn("failed to add xdp socket for queue ", queue, " to the map");
+        return false;
+      }
+      m_Queues.emplace_back(std::move(q));
+      return true;
+    }
+
+    PortReceiver::~PortReceiver()
+    {
+      // sockets first so nothing is steered to a queue we are tearing down
+      m_Queues.clear();
+      if (m_Attached)
+        xdp_program__detach(m_Program, m_IfIndex, XDP_MODE_UNSPEC, 0);
+      if (m_Program)
+        xdp_program__close(m_Program);
+    }
+
+    int
+    PortReceiver::FD(size_t queue) const
+    {
+      return xsk_socket__fd(m_Queues[queue]->xsk);
+    }
+
+    /// the udp payload of an ipv4 frame our program steered to us, nullptr if it is not one
+    static const byte_t*
+    ParseFrame(const byte_t* frame, size_t len, uint16_t port, SockAddr& from, size_t& sz)
+    {
+      if (len < sizeof(ethhdr) + sizeof(iphdr) + sizeof(udphdr))
+        return nullptr;
+      const auto* ip = reinterpret_cast<const iphdr*>(frame + sizeof(ethhdr));
+      const size_t ipLen = ip->ihl * 4;
+      if (ip->version != 4 or ipLen < sizeof(iphdr)
+          or len < sizeof(ethhdr) + ipLen + sizeof(udphdr))
+        return nullptr;
+      const auto* udp = reinterpret_cast<const udphdr*>(frame + sizeof(ethhdr) + ipLen);
+      const size_t udpLen = ntohs(udp->len);
+      if (udp->dest != htons(port) or udpLen < sizeof(udphdr)
+          or sizeof(ethhdr) + ipLen + udpLen > len)
+        return nullptr;
+      sockaddr_in addr{};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = ip->saddr;
+      addr.sin_port = udp->source;
+      from = SockAddr{addr};
+      sz = udpLen - sizeof(udphdr);
+      return reinterpret_cast<const byte_t*>(udp + 1);
+    }
+
+    size_t
+    PortReceiver::Drain(
+        size_t queue, const RecvHandler_t& recv, const std::function<void(void)>& flush)
+    {
+      auto& q = *m_Queues[queue];
+      uint32_t rxIdx = 0;
+      const auto numFrames = xsk_ring_cons__peek(&q.rx, RingSize, &rxIdx);
+      if (numFrames == 0)
+      {
+        // the driver waits for us to say so before it takes the frames we gave back
+        if (xsk_ring_prod__needs_wakeup(&q.fill))
+          ::recvfrom(xsk_socket__fd(q.xsk), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+        return 0;
+      }
+      size_t numRead = 0;
+      for (uint32_t n = 0; n < numFrames; ++n)
+      {
+        const auto* desc = xsk_ring_cons__rx_desc(&q.rx, rxIdx + n);
+        const auto* frame =
+            static_cast<const byte_t*>(xsk_umem__get_data(q.umemArea, desc->addr));
+        SockAddr from;
+        size_t sz = 0;
+        if (const auto* payload = ParseFrame(frame, desc->len, m_Port, from, sz))
+        {
+          recv(from, payload, sz);
+          numRead++;
+        }
+      }
+      // whoever got the datagrams is done with them after this so the frames can go back
+      flush();
+      uint32_t fillIdx = 0;
+      xsk_ring_prod__reserve(&q.fill, numFrames, &fillIdx);
+      for (uint32_t n = 0; n < numFrames; ++n)
+      {
+        const auto addr = xsk_ring_cons__rx_desc(&q.rx, rxIdx + n)->addr;
+        *xsk_ring_prod__fill_addr(&q.fill, fillIdx + n) = xsk_umem__extract_addr(addr);
+      }
+      xsk_ring_prod__submit(&q.fill, numFrames);
+      xsk_ring_cons__release(&q.rx, numFrames);
+      if (xsk_ring_prod__needs_wakeup(&q.fill))
+        ::recvfrom(xsk_socket__fd(q.xsk), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+      return numRead;
+    }
+  }  // namespace xdp
+}  // namespace llarp
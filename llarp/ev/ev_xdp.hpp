@@ -0,0 +1,92 @@
+#ifndef LLARP_EV_XDP_HPP
+#define LLARP_EV_XDP_HPP
+
+#include <ev/ev.h>
+#include <net/sock_addr.hpp>
+
+#include <xdp/libxdp.h>
+#include <xdp/xsk.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llarp
+{
+  namespace xdp
+  {
+    /// AF_XDP reads for one udp port on one interface, bypassing the kernel udp stack
+    /// our program on the interface hands ipv4 datagrams for the port to an AF_XDP socket on
+    /// each rx queue, everything else (and anything it can not parse) goes to the kernel, so the
+    /// regular socket stays bound to catch the rest and to do our sends
+    struct PortReceiver
+    {
+      /// frames in each queue's umem
+      static constexpr unsigned NumFrames = 2048;
+      static constexpr unsigned FrameSize = XSK_UMEM__DEFAULT_FRAME_SIZE;
+      /// most queues we bind, the size of the program's socket map
+      static constexpr unsigned MaxQueues = 64;
+
+      using RecvHandler_t = std::function<void(const SockAddr&, const byte_t*, size_t)>;
+
+      /// attach to ifname and take port on every rx queue, returns nullptr if the interface,
+      /// kernel or our privileges do not allow it
+      static std::unique_ptr<PortReceiver>
+      Create(const std::string& ifname, uint16_t port);
+
+      ~PortReceiver();
+
+      PortReceiver(const PortReceiver&) = delete;
+      PortReceiver&
+      operator=(const PortReceiver&) = delete;
+
+      size_t
+      NumQueues() const
+      {
+        return m_Queues.size();
+      }
+
+      /// the AF_XDP socket for queue, readable when frames are waiting
+      int
+      FD(size_t queue) const;
+
+      /// hand up every datagram waiting on queue, calling flush once after the last
+      /// the datagrams point into the umem and are only valid until flush returns
+      /// returns the number of datagrams read
+      size_t
+      Drain(size_t queue, const RecvHandler_t& recv, const std::function<void(void)>& flush);
+
+     private:
+      PortReceiver() = default;
+
+      bool
+      Init(const std::string& ifname, uint16_t port);
+
+      bool
+      AddQueue(const std::string& ifname, unsigned queue);
+
+      struct Queue
+      {
+        void* umemArea = nullptr;
+        xsk_umem* umem = nullptr;
+        xsk_ring_prod fill{};
+        xsk_ring_cons completion{};
+        xsk_socket* xsk = nullptr;
+        xsk_ring_cons rx{};
+        xsk_ring_prod tx{};
+
+        ~Queue();
+      };
+
+      int m_IfIndex = 0;
+      uint16_t m_Port = 0;
+      xdp_program* m_Program = nullptr;
+      bool m_Attached = false;
+      int m_SocketMap = -1;
+      std::vector<std::unique_ptr<Queue>> m_Queues;
+    };
+  }  // namespace xdp
+}  // namespace llarp
+
+#endif
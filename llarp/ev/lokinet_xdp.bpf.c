@@ -0,0 +1,54 @@
+// steers ipv4 udp datagrams for our link ports to the AF_XDP socket on the queue they arrived
+// on, everything else goes to the kernel as before. built with clang -target bpf when
+// WITH_XDP is on
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/in.h>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <bpf/bpf_endian.h>
+#include <bpf/bpf_helpers.h>
+
+struct
+{
+  __uint(type, BPF_MAP_TYPE_XSKMAP);
+  __uint(max_entries, 64);
+  __type(key, __u32);
+  __type(value, __u32);
+} xsks_map SEC(".maps");
+
+/// udp ports in network order that lokinet wants, the value is unused
+struct
+{
+  __uint(type, BPF_MAP_TYPE_HASH);
+  __uint(max_entries, 16);
+  __type(key, __u16);
+  __type(value, __u8);
+} lokinet_ports SEC(".maps");
+
+SEC("xdp")
+int
+lokinet_xdp(struct xdp_md* ctx)
+{
+  void* data = (void*)(long)ctx->data;
+  void* data_end = (void*)(long)ctx->data_end;
+
+  struct ethhdr* eth = data;
+  if ((void*)(eth + 1) > data_end || eth->h_proto != bpf_htons(ETH_P_IP))
+    return XDP_PASS;
+  struct iphdr* ip = (void*)(eth + 1);
+  if ((void*)(ip + 1) > data_end || ip->protocol != IPPROTO_UDP || ip->ihl < 5)
+    return XDP_PASS;
+  // fragments go to the kernel to be put back together
+  if (ip->frag_off & bpf_htons(0x3fff))
+    return XDP_PASS;
+  struct udphdr* udp = (void*)ip + (ip->ihl * 4);
+  if ((void*)(udp + 1) > data_end)
+    return XDP_PASS;
+  if (bpf_map_lookup_elem(&lokinet_ports, &udp->dest) == NULL)
+    return XDP_PASS;
+  // nothing bound on this queue means the kernel gets it
+  return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+}
+
+char _license[] SEC("license") = "GPL";
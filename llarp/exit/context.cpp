@@ -6,7 +6,10 @@ namespace llarp
 {
   namespace exit
   {
-    Context::Context(AbstractRouter* r) : m_Router(r)
+    Context::Context(AbstractRouter* r)
+        : m_Router(r)
+        , m_SessionsMetric(r->metrics().AddGauge(
+              "llarp_exit_sessions", "exit sessions clients have with us"))
     {}
     Context::~Context() = default;
 
@@ -14,12 +17,15 @@ namespace llarp
     Context::Tick(llarp_time_t now)
     {
       {
+        size_t sessions = 0;
         auto itr = m_Exits.begin();
         while (itr != m_Exits.end())
         {
           itr->second->Tick(now);
+          sessions += itr->second->NumActiveExits();
           ++itr;
         }
+        m_SessionsMetric.Set(sessions);
       }
       {
         auto itr = m_Closed.begin();
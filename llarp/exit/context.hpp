@@ -2,6 +2,7 @@
 #define LLARP_EXIT_CONTEXT_HPP
 #include <exit/policy.hpp>
 #include <handlers/exit.hpp>
+#include <util/metrics.hpp>
 
 #include <string>
 #include <unordered_map>
@@ -48,6 +49,7 @@ namespace llarp
      private:
       AbstractRouter* m_Router;
       std::unordered_map<std::string, std::shared_ptr<handlers::ExitEndpoint>> m_Exits;
+      metrics::Gauge& m_SessionsMetric;
       std::list<std::shared_ptr<handlers::ExitEndpoint>> m_Closed;
     };
   }  // namespace exit
@@ -4,6 +4,9 @@
 #include <path/path_context.hpp>
 #include <router/abstractrouter.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace llarp
 {
   namespace exit
@@ -49,6 +52,19 @@ namespace llarp
                              {"looksDead", LooksDead(now)},
                              {"expiresSoon", ExpiresSoon(now)},
                              {"expired", IsExpired(now)}};
+      obj["upstream"] = util::StatusObject{{"queued", m_UpstreamQueue.Size()},
+                                           {"drops", m_UpstreamQueue.Drops()},
+                                           {"marks", m_UpstreamQueue.Marks()},
+                                           {"delay", m_UpstreamQueue.Delays().ExtractStatus()}};
+      obj["downstream"] =
+          util::StatusObject{{"queued", m_DownstreamQueue.Size()},
+                             {"drops", m_DownstreamQueue.Drops()},
+                             {"marks", m_DownstreamQueue.Marks()},
+                             {"delay", m_DownstreamQueue.Delays().ExtractStatus()},
+                             {"held", m_HeldDownstream.X.size()},
+                             {"messages", m_MessagesSent},
+                             {"packetsPerMessage",
+                              m_MessagesSent ? double(m_PacketsSent) / m_MessagesSent : 0.0}};
       return obj;
     }
 
@@ -107,15 +123,12 @@ namespace llarp
     }
 
     bool
-    Endpoint::QueueOutboundTraffic(ManagedBuffer buf, uint64_t counter)
+    Endpoint::QueueOutboundTraffic(ManagedBuffer buf, uint64_t)
     {
-      // queue overflow
-      if (m_UpstreamQueue.size() > MaxUpstreamQueueSize)
-        return false;
-
       llarp::net::IPPacket pkt;
       if (!pkt.Load(buf.underlying))
         return false;
+      pkt.ClampTCPMSS();
       if (pkt.IsV6() && m_Parent->SupportsV6())
       {
         huint128_t dst;
@@ -138,9 +151,11 @@ namespace llarp
       {
         return false;
       }
-      m_UpstreamQueue.emplace(pkt, counter);
+      // codel on a full queue drops the fattest flow's oldest, not what comes in
+      const auto now = m_Parent->Now();
+      m_UpstreamQueue.Push(net::FlowHash(pkt.buf, pkt.sz), pkt, pkt.sz, now);
       m_TxRate += buf.underlying.sz;
-      m_LastActive = m_Parent->Now();
+      m_LastActive = now;
       return true;
     }
 
@@ -150,6 +165,8 @@ namespace llarp
       llarp::net::IPPacket pkt;
       if (!pkt.Load(buf.underlying))
         return false;
+      // hosts out on the internet would otherwise send segments too big to carry back
+      pkt.ClampTCPMSS();
 
       huint128_t src;
       if (m_RewriteSource)
@@ -161,60 +178,72 @@ namespace llarp
       else
         pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(src)), xhtonl(net::TruncateV6(m_IP)));
 
-      const auto _pktbuf = pkt.Buffer();
-      const llarp_buffer_t& pktbuf = _pktbuf.underlying;
-      const uint8_t queue_idx = pktbuf.sz / llarp::routing::ExitPadSize;
-      if (m_DownstreamQueues.find(queue_idx) == m_DownstreamQueues.end())
-        m_DownstreamQueues.emplace(queue_idx, InboundTrafficQueue_t{});
-      auto& queue = m_DownstreamQueues.at(queue_idx);
-      if (queue.size() == 0)
-      {
-        queue.emplace_back();
-        return queue.back().PutBuffer(pktbuf, m_Counter++);
-      }
-      auto& msg = queue.back();
-      if (msg.Size() + pktbuf.sz > llarp::routing::ExitPadSize)
-      {
-        queue.emplace_back();
-        return queue.back().PutBuffer(pktbuf, m_Counter++);
-      }
+      m_DownstreamQueue.Push(net::FlowHash(pkt.buf, pkt.sz), pkt, pkt.sz, m_Parent->Now());
+      return true;
+    }
 
-      return msg.PutBuffer(pktbuf, m_Counter++);
+    void
+    Endpoint::FlushUpstream()
+    {
+      m_UpstreamQueue.Pop(
+          m_Parent->Now(), std::numeric_limits<size_t>::max(), [this](net::IPPacket& pkt) {
+            m_Parent->QueueOutboundTraffic(pkt.ConstBuffer());
+          });
     }
 
     bool
-    Endpoint::Flush()
+    Endpoint::FlushDownstream(size_t& budget)
     {
-      // flush upstream queue
-      while (m_UpstreamQueue.size())
+      const auto now = m_Parent->Now();
+      auto path = GetCurrentPath();
+      if (path == nullptr)
       {
-        m_Parent->QueueOutboundTraffic(m_UpstreamQueue.top().pkt.ConstBuffer());
-        m_UpstreamQueue.pop();
+        m_DownstreamQueue.Pop(now, std::numeric_limits<size_t>::max(), [](net::IPPacket&) {});
+        m_HeldDownstream.Clear();
+        return false;
       }
-      // flush downstream queue
+      // packets go out in the order the flow queues pick, as many to a message as fit, and
+      // the last one that is not full waits to be topped up
+      auto& msg = m_HeldDownstream;
+      const size_t sent = m_DownstreamQueue.Pop(now, budget, [&](net::IPPacket& pkt) {
+        if (msg.Size() + pkt.sz > routing::ExitPadSize)
+          SendDownstream(path);
+        if (msg.X.empty())
+          m_HeldSince = now;
+        msg.PutBuffer(pkt.ConstBuffer(), m_Counter++);
+      });
+      budget -= std::min(sent, budget);
+      return true;
+    }
+
+    void
+    Endpoint::FlushHeldDownstream()
+    {
+      if (m_HeldDownstream.X.empty())
+        return;
+      if (m_Parent->Now() < m_HeldSince + m_Parent->ExitBatchDelay())
+        return;
       auto path = GetCurrentPath();
-      bool sent = path != nullptr;
       if (path)
+        SendDownstream(path);
+      else
+        m_HeldDownstream.Clear();
+    }
+
+    void
+    Endpoint::SendDownstream(const path::HopHandler_ptr& path)
+    {
+      auto& msg = m_HeldDownstream;
+      if (msg.X.empty())
+        return;
+      msg.S = path->NextSeqNo();
+      if (path->SendRoutingMessage(msg, m_Parent->GetRouter()))
       {
-        for (auto& item : m_DownstreamQueues)
-        {
-          auto& queue = item.second;
-          while (queue.size())
-          {
-            auto& msg = queue.front();
-            msg.S = path->NextSeqNo();
-            if (path->SendRoutingMessage(msg, m_Parent->GetRouter()))
-            {
-              m_RxRate += msg.Size();
-              sent = true;
-            }
-            queue.pop_front();
-          }
-        }
+        m_RxRate += msg.Size();
+        m_MessagesSent++;
+        m_PacketsSent += msg.X.size();
       }
-      for (auto& item : m_DownstreamQueues)
-        item.second.clear();
-      return sent;
+      msg.Clear();
     }
 
     llarp::path::HopHandler_ptr
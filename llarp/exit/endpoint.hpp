@@ -4,10 +4,10 @@
 #include <crypto/types.hpp>
 #include <net/ip_packet.hpp>
 #include <path/path.hpp>
+#include <routing/transfer_traffic_message.hpp>
+#include <util/fq_codel.hpp>
 #include <util/time.hpp>
 
-#include <queue>
-
 namespace llarp
 {
   namespace handlers
@@ -22,6 +22,7 @@ namespace llarp
     struct Endpoint
     {
       static constexpr size_t MaxUpstreamQueueSize = 256;
+      static constexpr size_t MaxDownstreamQueueSize = 1024;
 
       Endpoint(
           const llarp::PubKey& remoteIdent,
@@ -59,9 +60,26 @@ namespace llarp
       bool
       QueueInboundTraffic(ManagedBuffer buff);
 
-      /// flush inbound and outbound traffic queues
+      /// send our queued outbound traffic to the internet
+      void
+      FlushUpstream();
+
+      /// send up to budget bytes of queued inbound traffic down our path, taking what went
+      /// from budget. return false if we have no path, everything queued is dropped then.
+      /// packets that do not fill a message are held for FlushHeldDownstream
+      bool
+      FlushDownstream(size_t& budget);
+
+      /// send the held partly filled message once it waited out the batch delay
+      void
+      FlushHeldDownstream();
+
+      /// return true if we have inbound traffic queued
       bool
-      Flush();
+      HasDownstream() const
+      {
+        return not m_DownstreamQueue.Empty();
+      }
 
       /// queue outbound traffic
       /// does ip rewrite here
@@ -109,6 +127,10 @@ namespace llarp
       const llarp_time_t createdAt;
 
      private:
+      /// send the held message down path and start a new one
+      void
+      SendDownstream(const path::HopHandler_ptr& path);
+
       llarp::handlers::ExitEndpoint* m_Parent;
       llarp::PubKey m_remoteSignKey;
       llarp::PathID_t m_CurrentPath;
@@ -116,28 +138,19 @@ namespace llarp
       uint64_t m_TxRate, m_RxRate;
       llarp_time_t m_LastActive;
       bool m_RewriteSource;
-      using InboundTrafficQueue_t = std::deque<llarp::routing::TransferTrafficMessage>;
-      using TieredQueue = std::map<uint8_t, InboundTrafficQueue_t>;
-      // maps number of fragments the message will fit in to the queue for it
-      TieredQueue m_DownstreamQueues;
-
-      struct UpstreamBuffer
-      {
-        UpstreamBuffer(const llarp::net::IPPacket& p, uint64_t c) : pkt(p), counter(c)
-        {}
-
-        llarp::net::IPPacket pkt;
-        uint64_t counter;
-
-        bool
-        operator<(const UpstreamBuffer& other) const
-        {
-          return counter < other.counter;
-        }
-      };
-
-      using UpstreamQueue_t = std::priority_queue<UpstreamBuffer>;
-      UpstreamQueue_t m_UpstreamQueue;
+      /// traffic both ways, fair queued by flow so one bulk transfer does not hold up the
+      /// rest of this client's traffic, ect packets are marked rather than dropped
+      template <size_t MaxSize>
+      using PacketQueue_t =
+          util::FlowQueues<net::IPPacket, 64, MaxSize, net::IPPacket::MarkCongestion>;
+      PacketQueue_t<MaxDownstreamQueueSize> m_DownstreamQueue;
+      PacketQueue_t<MaxUpstreamQueueSize> m_UpstreamQueue;
+      /// downstream packets waiting on more to share their message, and since when
+      routing::TransferTrafficMessage m_HeldDownstream;
+      llarp_time_t m_HeldSince = 0s;
+      /// messages sent down our path and the packets they carried
+      uint64_t m_MessagesSent = 0;
+      uint64_t m_PacketsSent = 0;
       uint64_t m_Counter;
     };
   }  // namespace exit
@@ -34,6 +34,8 @@ namespace llarp
     void
     BaseSession::HandlePathDied(path::Path_ptr p)
     {
+      if (m_GrantedPaths.erase(p->RXID()) and not m_GrantedPaths.empty())
+        m_FailOvers++;
       p->Rebuild();
     }
 
@@ -44,6 +46,10 @@ namespace llarp
       obj["lastExitUse"] = to_json(m_LastUse);
       auto pub = m_ExitIdentity.toPublic();
       obj["exitIdentity"] = pub.ToString();
+      obj["grantedPaths"] = m_GrantedPaths.size();
+      obj["failOvers"] = m_FailOvers;
+      obj["upstreamMessages"] = m_MessagesSent;
+      obj["packetsPerMessage"] = m_MessagesSent ? double(m_PacketsSent) / m_MessagesSent : 0.0;
       return obj;
     }
 
@@ -61,7 +67,49 @@ namespace llarp
       const size_t expect = (1 + (numPaths / 2));
       // check 30 seconds into the future and see if we need more paths
       const llarp_time_t future = now + 30s + buildIntervalLimit;
-      return NumPathsExistingAt(future) < expect;
+      if (NumPathsExistingAt(future) < expect)
+        return true;
+      // the spare granted path is built before it is needed, not after one dies
+      return NumGrantedAt(future) < MinGrantedPaths
+          and NumInStatus(path::ePathBuilding) < MinGrantedPaths;
+    }
+
+    size_t
+    BaseSession::NumGrantedAt(llarp_time_t when) const
+    {
+      size_t num = 0;
+      for (const auto& item : m_GrantedPaths)
+      {
+        const auto p = item.second.lock();
+        if (p and p->IsReady() and not p->Expired(when))
+          num++;
+      }
+      return num;
+    }
+
+    path::Path_ptr
+    BaseSession::PickGrantedPath(llarp_time_t now)
+    {
+      auto& ready = m_ReadyGranted;
+      ready.clear();
+      auto itr = m_GrantedPaths.begin();
+      while (itr != m_GrantedPaths.end())
+      {
+        auto p = itr->second.lock();
+        if (p == nullptr or p->Expired(now))
+        {
+          itr = m_GrantedPaths.erase(itr);
+          continue;
+        }
+        if (p->IsReady() and not p->ExpiresSoon(now))
+          ready.emplace_back(std::move(p));
+        ++itr;
+      }
+      if (ready.empty())
+        return PickRandomEstablishedPath(llarp::path::ePathRoleExit);
+      auto p = ready[m_NextGranted++ % ready.size()];
+      ready.clear();
+      return p;
     }
 
     void
@@ -138,6 +186,7 @@ namespace llarp
       if (b == 0s)
       {
         llarp::LogInfo("obtained an exit via ", p->Endpoint());
+        m_GrantedPaths[p->RXID()] = p;
         CallPendingCallbacks(true);
       }
       return true;
@@ -178,6 +227,7 @@ namespace llarp
         }
       };
       ForEachPath(sendExitClose);
+      m_GrantedPaths.clear();
       path::Builder::ResetInternalState();
     }
 
@@ -227,24 +277,18 @@ namespace llarp
     {
       const auto pktbuf = pkt.ConstBuffer();
       const llarp_buffer_t& buf = pktbuf;
-      auto& queue = m_Upstream[buf.sz / N];
+      const uint8_t tier = buf.sz / N;
+      auto& queue = m_Upstream[tier];
       // queue overflow
       if (queue.size() >= MaxUpstreamQueueLength)
         return false;
-      if (queue.size() == 0)
-      {
-        queue.emplace_back();
-        return queue.back().PutBuffer(buf, m_Counter++);
-      }
-      auto& back = queue.back();
       // pack to nearest N
-      if (back.Size() + buf.sz > N)
+      if (queue.empty() or queue.back().Size() + buf.sz > N)
       {
         queue.emplace_back();
-        return queue.back().PutBuffer(buf, m_Counter++);
+        m_UpstreamStarted[tier] = m_router->Now();
       }
-
-      return back.PutBuffer(buf, m_Counter++);
+      return queue.back().PutBuffer(buf, m_Counter++);
     }
 
     bool
@@ -274,24 +318,30 @@ namespace llarp
     BaseSession::FlushUpstream()
     {
       auto now = m_router->Now();
-      auto path = PickRandomEstablishedPath(llarp::path::ePathRoleExit);
+      auto path = PickGrantedPath(now);
       if (path)
       {
         for (auto& item : m_Upstream)
         {
           auto& queue = item.second;  // XXX: uninitialised memory here!
-          while (queue.size())
+          // the last message of a tier has room for more, it waits for them a little
+          const bool holdLast = now < m_UpstreamStarted[item.first] + m_BatchDelay;
+          while (queue.size() > (holdLast ? 1 : 0))
           {
             auto& msg = queue.front();
             if (path)
             {
               msg.S = path->NextSeqNo();
-              path->SendRoutingMessage(msg, m_router);
+              if (path->SendRoutingMessage(msg, m_router))
+              {
+                m_MessagesSent++;
+                m_PacketsSent += msg.X.size();
+              }
             }
             queue.pop_front();
 
-            // spread across all paths
-            path = PickRandomEstablishedPath(llarp::path::ePathRoleExit);
+            // spread across the granted paths
+            path = PickGrantedPath(now);
           }
         }
       }
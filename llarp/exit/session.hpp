@@ -9,6 +9,7 @@
 
 #include <deque>
 #include <queue>
+#include <unordered_map>
 
 namespace llarp
 {
@@ -27,6 +28,9 @@ namespace llarp
                          public std::enable_shared_from_this<BaseSession>
     {
       static constexpr size_t MaxUpstreamQueueLength = 256;
+      /// paths the exit granted us that we keep up at all times, so traffic moves straight
+      /// to another when one dies instead of waiting on a build and a new grant
+      static constexpr size_t MinGrantedPaths = 2;
 
       BaseSession(
           const llarp::RouterID& exitRouter,
@@ -84,10 +88,17 @@ namespace llarp
       bool
       QueueUpstreamTraffic(llarp::net::IPPacket pkt, const size_t packSize);
 
-      /// flush upstream to exit via paths
+      /// flush upstream to exit via paths, a message that is not full yet waits up to the
+      /// batch delay for more packets
       bool
       FlushUpstream();
 
+      void
+      SetBatchDelay(llarp_time_t delay)
+      {
+        m_BatchDelay = delay;
+      }
+
       /// flush downstream to user via tun
       void
       FlushDownstream();
@@ -138,11 +149,32 @@ namespace llarp
       HandleTraffic(llarp::path::Path_ptr p, const llarp_buffer_t& buf, uint64_t seqno);
 
      private:
+      /// a granted path that is ready, in turn, or any established exit path if none is
+      path::Path_ptr
+      PickGrantedPath(llarp_time_t now);
+
+      /// granted paths that will still be up at when
+      size_t
+      NumGrantedAt(llarp_time_t when) const;
+
       std::set<RouterID> m_SnodeBlacklist;
+      /// paths the exit granted us by rxid
+      std::unordered_map<PathID_t, std::weak_ptr<path::Path>, PathID_t::Hash> m_GrantedPaths;
+      size_t m_NextGranted = 0;
+      /// reused by PickGrantedPath
+      std::vector<path::Path_ptr> m_ReadyGranted;
+      /// times traffic had to leave a granted path that died for another
+      uint64_t m_FailOvers = 0;
 
       using UpstreamTrafficQueue_t = std::deque<llarp::routing::TransferTrafficMessage>;
       using TieredQueue_t = std::map<uint8_t, UpstreamTrafficQueue_t>;
       TieredQueue_t m_Upstream;
+      /// when the last message of each tier got its first packet
+      std::map<uint8_t, llarp_time_t> m_UpstreamStarted;
+      llarp_time_t m_BatchDelay = 0s;
+      /// messages sent to the exit and the packets they carried
+      uint64_t m_MessagesSent = 0;
+      uint64_t m_PacketsSent = 0;
 
       using DownstreamPkt = std::pair<uint64_t, llarp::net::IPPacket>;
 
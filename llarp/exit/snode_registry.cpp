@@ -0,0 +1,238 @@
+#include <exit/snode_registry.hpp>
+
+#include <router/abstractrouter.hpp>
+#include <routing/transfer_traffic_message.hpp>
+#include <util/logging/logger.hpp>
+
+#include <optional>
+
+namespace llarp
+{
+  namespace exit
+  {
+    /// the protocol and ports of a raw ip packet as the side that sent the first packet of the
+    /// flow sees them, so a packet and its reply give the same key. addresses are left out as
+    /// the snode rewrites them
+    static std::optional<uint64_t>
+    FlowKey(const byte_t* pkt, size_t sz, bool reply)
+    {
+      constexpr byte_t ICMP = 1;
+      constexpr byte_t TCP = 6;
+      constexpr byte_t UDP = 17;
+      constexpr byte_t ICMP6 = 58;
+      if (sz == 0)
+        return std::nullopt;
+      byte_t proto;
+      size_t l4;
+      switch (pkt[0] >> 4)
+      {
+        case 4:
+          if (sz < 20)
+            return std::nullopt;
+          proto = pkt[9];
+          l4 = (pkt[0] & 0x0f) * 4;
+          break;
+        case 6:
+          if (sz < 40)
+            return std::nullopt;
+          proto = pkt[6];
+          l4 = 40;
+          break;
+        default:
+          return std::nullopt;
+      }
+      uint64_t key = uint64_t{proto} << 32;
+      if ((proto == TCP or proto == UDP) and l4 + 4 <= sz)
+      {
+        const uint64_t src = (uint64_t{pkt[l4]} << 8) | pkt[l4 + 1];
+        const uint64_t dst = (uint64_t{pkt[l4 + 2]} << 8) | pkt[l4 + 3];
+        key |= reply ? (dst << 16) | src : (src << 16) | dst;
+      }
+      else if ((proto == ICMP or proto == ICMP6) and l4 + 6 <= sz)
+      {
+        // the echo identifier, the same both ways
+        key |= (uint64_t{pkt[l4 + 4]} << 8) | pkt[l4 + 5];
+      }
+      return key;
+    }
+
+    void
+    FlowOwners::Sent(Owner owner, const byte_t* pkt, size_t sz, llarp_time_t now)
+    {
+      m_Last = owner;
+      if (const auto key = FlowKey(pkt, sz, false))
+        m_Flows[*key] = Flow{owner, now};
+    }
+
+    FlowOwners::Owner
+    FlowOwners::Received(const byte_t* pkt, size_t sz) const
+    {
+      if (const auto key = FlowKey(pkt, sz, true))
+      {
+        const auto itr = m_Flows.find(*key);
+        if (itr != m_Flows.end())
+          return itr->second.owner;
+      }
+      return m_Last;
+    }
+
+    void
+    FlowOwners::Forget(Owner owner)
+    {
+      if (m_Last == owner)
+        m_Last = nullptr;
+      for (auto itr = m_Flows.begin(); itr != m_Flows.end();)
+      {
+        if (itr->second.owner == owner)
+          itr = m_Flows.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    void
+    FlowOwners::Expire(llarp_time_t now)
+    {
+      for (auto itr = m_Flows.begin(); itr != m_Flows.end();)
+      {
+        if (now >= itr->second.lastSent + FlowLifetime)
+          itr = m_Flows.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    SNodeSessionRegistry::SNodeSessionRegistry(AbstractRouter* r) : m_Router(r)
+    {}
+
+    BaseSession_ptr
+    SNodeSessionRegistry::Obtain(
+        const RouterID& snode,
+        Owner owner,
+        WritePacket write,
+        size_t numPaths,
+        size_t numHops,
+        bool bundleRC,
+        llarp_time_t batchDelay)
+    {
+      auto& shared = m_Sessions[snode];
+      if (shared.session and not shared.session->IsStopped())
+      {
+        if (not shared.holders.empty() and shared.holders.count(owner) == 0)
+        {
+          m_Joined++;
+          LogDebug(shared.session->Name(), " shared with another endpoint");
+        }
+        shared.holders[owner] = std::move(write);
+        return shared.session;
+      }
+      shared.holders.clear();
+      shared.flows = FlowOwners{};
+      shared.holders.emplace(owner, std::move(write));
+      shared.session = std::make_shared<SNodeSession>(
+          snode,
+          [this, snode](const llarp_buffer_t& buf) -> bool { return Deliver(snode, buf); },
+          m_Router,
+          numPaths,
+          numHops,
+          false,
+          bundleRC);
+      shared.session->SetBatchDelay(batchDelay);
+      return shared.session;
+    }
+
+    bool
+    SNodeSessionRegistry::QueueUpstream(const RouterID& snode, Owner owner, net::IPPacket pkt)
+    {
+      auto itr = m_Sessions.find(snode);
+      if (itr == m_Sessions.end() or itr->second.holders.count(owner) == 0)
+        return false;
+      itr->second.flows.Sent(owner, pkt.buf, pkt.sz, m_Router->Now());
+      return itr->second.session->QueueUpstreamTraffic(std::move(pkt), routing::ExitPadSize);
+    }
+
+    bool
+    SNodeSessionRegistry::Deliver(const RouterID& snode, const llarp_buffer_t& buf)
+    {
+      auto itr = m_Sessions.find(snode);
+      if (itr == m_Sessions.end() or itr->second.holders.empty())
+        return false;
+      auto& holders = itr->second.holders;
+      auto holder = holders.find(itr->second.flows.Received(buf.base, buf.sz));
+      // nobody sent on it yet, with one holder it can only be theirs
+      if (holder == holders.end())
+      {
+        if (holders.size() > 1)
+          return false;
+        holder = holders.begin();
+      }
+      return holder->second(buf);
+    }
+
+    void
+    SNodeSessionRegistry::Release(Shared& shared, Owner owner)
+    {
+      if (shared.holders.erase(owner) == 0)
+        return;
+      shared.flows.Forget(owner);
+      if (shared.holders.empty() and shared.session)
+        shared.session->Stop();
+    }
+
+    void
+    SNodeSessionRegistry::Release(const RouterID& snode, Owner owner)
+    {
+      auto itr = m_Sessions.find(snode);
+      if (itr != m_Sessions.end())
+        Release(itr->second, owner);
+    }
+
+    void
+    SNodeSessionRegistry::ReleaseAll(Owner owner)
+    {
+      for (auto& item : m_Sessions)
+        Release(item.second, owner);
+    }
+
+    size_t
+    SNodeSessionRegistry::Holders(const RouterID& snode) const
+    {
+      const auto itr = m_Sessions.find(snode);
+      return itr == m_Sessions.end() ? 0 : itr->second.holders.size();
+    }
+
+    void
+    SNodeSessionRegistry::Tick(llarp_time_t now)
+    {
+      for (auto itr = m_Sessions.begin(); itr != m_Sessions.end();)
+      {
+        auto& session = itr->second.session;
+        if (session == nullptr or (session->ShouldRemove() and session->IsStopped()))
+        {
+          itr = m_Sessions.erase(itr);
+          continue;
+        }
+        // forgotten next tick
+        if (session->IsExpired(now))
+          session->Stop();
+        else
+          session->Tick(now);
+        itr->second.flows.Expire(now);
+        ++itr;
+      }
+    }
+
+    util::StatusObject
+    SNodeSessionRegistry::ExtractStatus() const
+    {
+      uint64_t shared = 0;
+      for (const auto& item : m_Sessions)
+      {
+        if (item.second.holders.size() > 1)
+          ++shared;
+      }
+      return util::StatusObject{
+          {"sessions", uint64_t(m_Sessions.size())}, {"shared", shared}, {"joined", m_Joined}};
+    }
+  }  // namespace exit
+}  // namespace llarp
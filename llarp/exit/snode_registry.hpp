@@ -0,0 +1,129 @@
+#ifndef LLARP_EXIT_SNODE_REGISTRY_HPP
+#define LLARP_EXIT_SNODE_REGISTRY_HPP
+
+#include <exit/session.hpp>
+#include <router_id.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+#include <util/types.hpp>
+
+#include <functional>
+#include <unordered_map>
+
+namespace llarp
+{
+  struct AbstractRouter;
+
+  namespace exit
+  {
+    /// which holder of a shared snode session each flow through it is for, learned from what
+    /// they send so the replies go back to the one that sent it
+    struct FlowOwners
+    {
+      using Owner = const void*;
+
+      /// a flow nothing went out on for this long is forgotten
+      static constexpr auto FlowLifetime = 5min;
+
+      /// owner sent the raw ip packet at pkt
+      void
+      Sent(Owner owner, const byte_t* pkt, size_t sz, llarp_time_t now);
+
+      /// the owner of the flow the raw ip packet at pkt came back on, the last to send
+      /// anything when it is on no flow we know
+      Owner
+      Received(const byte_t* pkt, size_t sz) const;
+
+      /// drop owner's flows
+      void
+      Forget(Owner owner);
+
+      void
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const
+      {
+        return m_Flows.size();
+      }
+
+     private:
+      struct Flow
+      {
+        Owner owner;
+        llarp_time_t lastSent;
+      };
+
+      std::unordered_map<uint64_t, Flow> m_Flows;
+      Owner m_Last = nullptr;
+    };
+
+    /// the snode sessions of every endpoint in the daemon by the snode they go to, so that
+    /// endpoints talking to the same snode share one session and its paths instead of each
+    /// building their own. a session stops once the last endpoint holding it lets go.
+    /// logic thread only
+    struct SNodeSessionRegistry
+    {
+      using Owner = FlowOwners::Owner;
+      using WritePacket = std::function<bool(const llarp_buffer_t&)>;
+
+      explicit SNodeSessionRegistry(AbstractRouter* r);
+
+      /// owner's hold on the session to snode, made with numPaths paths of numHops hops by
+      /// the first owner to ask. write gets the packets that come back on owner's flows
+      BaseSession_ptr
+      Obtain(
+          const RouterID& snode,
+          Owner owner,
+          WritePacket write,
+          size_t numPaths,
+          size_t numHops,
+          bool bundleRC,
+          llarp_time_t batchDelay);
+
+      /// send pkt from owner to snode, false if owner does not hold a session to it
+      bool
+      QueueUpstream(const RouterID& snode, Owner owner, net::IPPacket pkt);
+
+      /// owner is done with its session to snode
+      void
+      Release(const RouterID& snode, Owner owner);
+
+      /// owner is done with all its sessions
+      void
+      ReleaseAll(Owner owner);
+
+      /// how many owners hold the session to snode
+      size_t
+      Holders(const RouterID& snode) const;
+
+      /// tick each session once whoever holds it, stopping the expired ones
+      void
+      Tick(llarp_time_t now);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Shared
+      {
+        BaseSession_ptr session;
+        std::unordered_map<Owner, WritePacket> holders;
+        FlowOwners flows;
+      };
+
+      bool
+      Deliver(const RouterID& snode, const llarp_buffer_t& buf);
+
+      void
+      Release(Shared& shared, Owner owner);
+
+      AbstractRouter* m_Router;
+      std::unordered_map<RouterID, Shared, RouterID::Hash> m_Sessions;
+      /// times an owner got a session another owner made
+      uint64_t m_Joined = 0;
+    };
+  }  // namespace exit
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,267 @@
+#include <handlers/embedded.hpp>
+
+#include <router/abstractrouter.hpp>
+#include <util/logging/logger.hpp>
+#include <util/thread/logic.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace llarp
+{
+  namespace handlers
+  {
+    EmbeddedEndpoint::EmbeddedEndpoint(AbstractRouter* r, service::Context* parent)
+        : service::Endpoint(r, parent)
+    {}
+
+    void
+    EmbeddedEndpoint::Listen(
+        uint16_t port, service::ChannelKind kind, RecvFunc recv, BrokenFunc broken)
+    {
+      LogicCall(EndpointLogic(), [self = shared_from_this(), port, kind, recv, broken]() {
+        self->m_Listeners[ListenKey(port, kind)] = Listener{recv, broken};
+      });
+    }
+
+    void
+    EmbeddedEndpoint::StopListening(uint16_t port, service::ChannelKind kind)
+    {
+      LogicCall(EndpointLogic(), [self = shared_from_this(), port, kind]() {
+        self->m_Listeners.erase(ListenKey(port, kind));
+      });
+    }
+
+    /// how often reliable streams look for segments to resend and acks to send
+    static constexpr auto ReliableTimerInterval = 50ms;
+
+    bool
+    EmbeddedEndpoint::SendTo(
+        const service::Address& remote,
+        uint16_t port,
+        service::ChannelKind kind,
+        const llarp_buffer_t& data)
+    {
+      if (kind == service::ChannelKind::Ack)
+        return false;
+      if (kind == service::ChannelKind::Reliable)
+      {
+        std::vector<std::vector<byte_t>> segments;
+        for (size_t pos = 0; pos < data.sz; pos += MaxPayload)
+        {
+          const auto sz = std::min(MaxPayload, data.sz - pos);
+          segments.emplace_back(data.base + pos, data.base + pos + sz);
+        }
+        auto send = [self = shared_from_this(),
+                     key = StreamKey{remote, port},
+                     segments = std::move(segments)]() mutable {
+          auto& stream = self->m_ReliableOut[key];
+          for (auto& segment : segments)
+          {
+            if (not stream.Queue(std::move(segment)))
+            {
+              self->StreamBroke(key, service::ChannelKind::Reliable);
+              return;
+            }
+          }
+          self->FlushReliable(key);
+        };
+        LogicCall(EndpointLogic(), std::move(send));
+        return true;
+      }
+      if (data.sz > MaxPayload)
+        return false;
+      std::vector<byte_t> frame(service::ChannelHeader::Size + data.sz);
+      std::copy_n(data.base, data.sz, frame.data() + service::ChannelHeader::Size);
+      auto send =
+          [self = shared_from_this(), remote, port, kind, frame = std::move(frame)]() mutable {
+            service::ChannelHeader hdr;
+            hdr.kind = kind;
+            hdr.port = port;
+            // numbered here so the order on the wire is the order we send in
+            if (kind == service::ChannelKind::Stream)
+              hdr.seqno = self->m_StreamsOut[{remote, port}]++;
+            hdr.Encode(frame.data());
+            self->SendToServiceOrQueue(
+                remote, llarp_buffer_t(frame), service::eProtocolEmbedded);
+          };
+      LogicCall(EndpointLogic(), std::move(send));
+      return true;
+    }
+
+    bool
+    EmbeddedEndpoint::HandleInboundPacket(
+        const service::ConvoTag tag, const llarp_buffer_t& buf, service::ProtocolType t, uint64_t)
+    {
+      if (t != service::eProtocolEmbedded)
+        return false;
+      const auto hdr = service::ChannelHeader::Decode(buf);
+      if (not hdr)
+        return false;
+      service::ServiceInfo sender;
+      if (not GetSenderFor(tag, sender))
+        return false;
+      const auto& from = sender.Addr();
+      const llarp_buffer_t data{
+          buf.base + service::ChannelHeader::Size, buf.sz - service::ChannelHeader::Size};
+      if (hdr->kind == service::ChannelKind::Ack)
+      {
+        const StreamKey key{from, hdr->port};
+        const auto ack = service::StreamAck::Decode(data);
+        auto stream = m_ReliableOut.find(key);
+        if (ack and stream != m_ReliableOut.end())
+        {
+          stream->second.HandleAck(*ack, Now());
+          FlushReliable(key);
+        }
+        return true;
+      }
+      auto itr = m_Listeners.find(ListenKey(hdr->port, hdr->kind));
+      if (itr == m_Listeners.end())
+      {
+        LogDebug(Name(), " nothing listening on port ", hdr->port, " for ", from);
+        return true;
+      }
+      if (hdr->kind == service::ChannelKind::Datagram)
+      {
+        itr->second.recv(from, data);
+        return true;
+      }
+      const StreamKey key{from, hdr->port};
+      const auto recv = itr->second.recv;
+      const auto deliver = [&from, &recv](const std::vector<byte_t>& inOrder) {
+        recv(from, llarp_buffer_t(inOrder));
+      };
+      if (hdr->kind == service::ChannelKind::Reliable)
+      {
+        auto& stream = m_ReliableIn[key];
+        if (stream.Push(hdr->seqno, std::vector<byte_t>{data.base, data.base + data.sz}, deliver))
+          SendAck(key, stream);
+        else
+          ScheduleReliableTimer();
+        return true;
+      }
+      auto& stream = m_StreamsIn[key];
+      const bool intact = stream.Push(
+          hdr->seqno,
+          std::vector<byte_t>{data.base, data.base + data.sz},
+          Now(),
+          deliver);
+      if (not intact)
+        StreamBroke(key, service::ChannelKind::Stream);
+      return true;
+    }
+
+    void
+    EmbeddedEndpoint::StreamBroke(const StreamKey& key, service::ChannelKind kind)
+    {
+      LogWarn(Name(), " stream with ", key.first, " on port ", key.second, " lost data");
+      auto itr = m_Listeners.find(ListenKey(key.second, kind));
+      if (itr != m_Listeners.end() and itr->second.broken)
+        itr->second.broken(key.first);
+      // it takes nothing more, the app carries on over a fresh port if it wants to
+    }
+
+    void
+    EmbeddedEndpoint::SendFrame(
+        const StreamKey& key,
+        service::ChannelKind kind,
+        uint32_t seqno,
+        const byte_t* data,
+        size_t sz)
+    {
+      std::vector<byte_t> frame(service::ChannelHeader::Size + sz);
+      std::copy_n(data, sz, frame.data() + service::ChannelHeader::Size);
+      service::ChannelHeader hdr;
+      hdr.kind = kind;
+      hdr.port = key.second;
+      hdr.seqno = seqno;
+      hdr.Encode(frame.data());
+      SendToServiceOrQueue(key.first, llarp_buffer_t(frame), service::eProtocolEmbedded);
+    }
+
+    void
+    EmbeddedEndpoint::FlushReliable(const StreamKey& key)
+    {
+      auto itr = m_ReliableOut.find(key);
+      if (itr == m_ReliableOut.end())
+        return;
+      auto& stream = itr->second;
+      stream.Flush(Now(), [&](uint32_t seqno, const std::vector<byte_t>& data) {
+        SendFrame(key, service::ChannelKind::Reliable, seqno, data.data(), data.size());
+      });
+      if (stream.Failed())
+      {
+        StreamBroke(key, service::ChannelKind::Reliable);
+        m_ReliableOut.erase(itr);
+        return;
+      }
+      if (not stream.Idle())
+        ScheduleReliableTimer();
+    }
+
+    void
+    EmbeddedEndpoint::SendAck(const StreamKey& key, service::ReliableReceiver& stream)
+    {
+      std::array<byte_t, service::StreamAck::Size> ack;
+      stream.TakeAck().Encode(ack.data());
+      SendFrame(key, service::ChannelKind::Ack, 0, ack.data(), ack.size());
+    }
+
+    void
+    EmbeddedEndpoint::ScheduleReliableTimer()
+    {
+      if (m_ReliableTimerQueued)
+        return;
+      m_ReliableTimerQueued = true;
+      RouterLogic()->call_later(ReliableTimerInterval, [self = weak_from_this()]() {
+        if (auto ptr = self.lock())
+        {
+          // the timer fires on the router logic, streams live on the endpoint's
+          LogicCall(ptr->EndpointLogic(), [ptr]() { ptr->OnReliableTimer(); });
+        }
+      });
+    }
+
+    void
+    EmbeddedEndpoint::OnReliableTimer()
+    {
+      m_ReliableTimerQueued = false;
+      for (auto& [key, stream] : m_ReliableIn)
+      {
+        if (stream.AckPending())
+          SendAck(key, stream);
+      }
+      std::vector<StreamKey> busy;
+      for (const auto& [key, stream] : m_ReliableOut)
+      {
+        if (not stream.Idle())
+          busy.push_back(key);
+      }
+      for (const auto& key : busy)
+        FlushReliable(key);
+    }
+
+    void
+    EmbeddedEndpoint::Tick(llarp_time_t now)
+    {
+      service::Endpoint::Tick(now);
+      for (auto& [key, stream] : m_StreamsIn)
+      {
+        if (not stream.Broken() and not stream.Expire(now))
+          StreamBroke(key, service::ChannelKind::Stream);
+      }
+    }
+
+    util::StatusObject
+    EmbeddedEndpoint::ExtractStatus() const
+    {
+      auto obj = service::Endpoint::ExtractStatus();
+      util::StatusObject streams;
+      for (const auto& [key, stream] : m_ReliableOut)
+        streams[key.first.ToString() + ":" + std::to_string(key.second)] = stream.ExtractStatus();
+      obj["reliableStreams"] = streams;
+      return obj;
+    }
+  }  // namespace handlers
+}  // namespace llarp
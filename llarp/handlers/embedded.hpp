@@ -0,0 +1,144 @@
+#ifndef LLARP_HANDLERS_EMBEDDED_HPP
+#define LLARP_HANDLERS_EMBEDDED_HPP
+
+#include <net/ip_packet.hpp>
+#include <service/embedded_channel.hpp>
+#include <service/endpoint.hpp>
+#include <service/reliable_stream.hpp>
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace handlers
+  {
+    /// endpoint for apps that run lokinet in process, buffers go straight into convos on a
+    /// port instead of through ip packets on a tun
+    struct EmbeddedEndpoint final : public service::Endpoint,
+                                    public std::enable_shared_from_this<EmbeddedEndpoint>
+    {
+      /// the most one send carries, what fits in a packet on a tun
+      static constexpr size_t MaxPayload = net::IPPacket::MaxSize - service::ChannelHeader::Size;
+
+      using RecvFunc = std::function<void(const service::Address&, const llarp_buffer_t&)>;
+      /// a stream from this remote lost data and takes nothing more
+      using BrokenFunc = std::function<void(const service::Address&)>;
+
+      EmbeddedEndpoint(AbstractRouter* r, service::Context* parent);
+
+      /// call recv with what arrives on port, and broken when a stream to it breaks, both on
+      /// the endpoint's logic thread. replaces what was listening there. safe from any thread
+      void
+      Listen(
+          uint16_t port, service::ChannelKind kind, RecvFunc recv, BrokenFunc broken = nullptr);
+
+      /// safe from any thread
+      void
+      StopListening(uint16_t port, service::ChannelKind kind);
+
+      /// send data to port on remote, safe from any thread. false if it is bigger than
+      /// MaxPayload, except on a reliable stream which splits it up as it needs to. a reliable
+      /// stream that cannot get its data through calls broken of what listens on its port
+      bool
+      SendTo(
+          const service::Address& remote,
+          uint16_t port,
+          service::ChannelKind kind,
+          const llarp_buffer_t& data);
+
+      bool
+      HandleInboundPacket(
+          const service::ConvoTag tag,
+          const llarp_buffer_t& buf,
+          service::ProtocolType t,
+          uint64_t seqno) override;
+
+      void
+      Tick(llarp_time_t now) override;
+
+      util::StatusObject
+      ExtractStatus() const override;
+
+      std::string
+      GetIfName() const override
+      {
+        return "";
+      }
+
+      path::PathSet_ptr
+      GetSelf() override
+      {
+        return shared_from_this();
+      }
+
+      bool
+      SupportsV6() const override
+      {
+        return false;
+      }
+
+      void
+      SendPacketToRemote(const llarp_buffer_t&) override{};
+
+      huint128_t
+      ObtainIPForAddr(const AlignedBuffer<32>&, bool) override
+      {
+        return {0};
+      }
+
+     private:
+      struct Listener
+      {
+        RecvFunc recv;
+        BrokenFunc broken;
+      };
+
+      /// one end of a stream, the remote and its port
+      using StreamKey = std::pair<service::Address, uint16_t>;
+
+      static uint32_t
+      ListenKey(uint16_t port, service::ChannelKind kind)
+      {
+        return (uint32_t(kind) << 16) | port;
+      }
+
+      void
+      StreamBroke(const StreamKey& key, service::ChannelKind kind);
+
+      void
+      SendFrame(
+          const StreamKey& key,
+          service::ChannelKind kind,
+          uint32_t seqno,
+          const byte_t* data,
+          size_t sz);
+
+      /// send whatever the reliable stream to key may send now
+      void
+      FlushReliable(const StreamKey& key);
+
+      void
+      SendAck(const StreamKey& key, service::ReliableReceiver& stream);
+
+      /// resend timers and delayed acks of reliable streams, runs while any has something
+      /// unacked either way
+      void
+      ScheduleReliableTimer();
+
+      void
+      OnReliableTimer();
+
+      std::unordered_map<uint32_t, Listener> m_Listeners;
+      /// next seqno for each stream we send on
+      std::map<StreamKey, uint32_t> m_StreamsOut;
+      std::map<StreamKey, service::StreamReassembly> m_StreamsIn;
+      std::map<StreamKey, service::ReliableSender> m_ReliableOut;
+      std::map<StreamKey, service::ReliableReceiver> m_ReliableIn;
+      bool m_ReliableTimerQueued = false;
+    };
+  }  // namespace handlers
+}  // namespace llarp
+
+#endif
@@ -35,12 +35,13 @@ namespace llarp
     ExitEndpoint::ExitEndpoint(const std::string& name, AbstractRouter* r)
         : m_Router(r)
         , m_Resolver(std::make_shared<dns::Proxy>(
-              r->netloop(), r->logic(), r->netloop(), r->logic(), this))
+              r->netloop(), r->logic(), r->netloop(), r->logic(), this, r->metrics()))
         , m_Name(name)
         , m_Tun{{0},
                 0,
                 0,
                 {0},
+                0,
                 nullptr,
                 nullptr,
                 nullptr,
@@ -71,6 +72,8 @@ namespace llarp
         exitsObj[item.first.ToString()] = item.second->ExtractStatus();
       }
       obj["exits"] = exitsObj;
+      obj["addrPool"] = m_AddrPool.ExtractStatus();
+      obj["dns"] = m_Resolver->ExtractStatus();
       return obj;
     }
 
@@ -104,6 +107,28 @@ namespace llarp
       return false;
     }
 
+    bool
+    ExitEndpoint::ShouldHookDNSQuery(const dns::MessageView& query) const
+    {
+      // always hook ptr for ranges we own
+      if (query.qtype == dns::qTypePTR)
+      {
+        huint128_t ip;
+        if (!dns::DecodePTR(query.QName(), ip))
+          return false;
+        return m_OurRange.Contains(ip);
+      }
+      if (query.qtype == dns::qTypeA || query.qtype == dns::qTypeCNAME
+          || query.qtype == dns::qTypeAAAA)
+      {
+        if (query.IsName("localhost.loki"))
+          return true;
+        if (query.HasTLD(".snode"))
+          return true;
+      }
+      return false;
+    }
+
     bool
     ExitEndpoint::HandleHookedDNSMessage(dns::Message msg, std::function<void(dns::Message)> reply)
     {
@@ -298,16 +323,32 @@ namespace llarp
               " as we have no working endpoints");
         }
       });
+      for (const auto& item : m_ActiveExits)
+        item.second->FlushUpstream();
       {
-        auto itr = m_ActiveExits.begin();
-        while (itr != m_ActiveExits.end())
+        // clients take turns a quantum at a time, so one busy client's downloads do not hold
+        // up everyone else's while we are over budget
+        size_t budget = MaxFlushBytes;
+        bool more = true;
+        while (more and budget > 0)
         {
-          if (!itr->second->Flush())
+          more = false;
+          for (const auto& [pk, ep] : m_ActiveExits)
           {
-            LogWarn("exit session with ", itr->first, " dropped packets");
+            if (not ep->HasDownstream())
+              continue;
+            size_t quantum = std::min(budget, FlushQuantum);
+            const size_t before = quantum;
+            if (not ep->FlushDownstream(quantum))
+              LogWarn("exit session with ", pk, " dropped packets");
+            budget -= std::min(budget, before - quantum);
+            more = more or ep->HasDownstream();
+            if (budget == 0)
+              break;
           }
-          ++itr;
         }
+        for (const auto& item : m_ActiveExits)
+          item.second->FlushHeldDownstream();
       }
       {
         auto itr = m_SNodeSessions.begin();
@@ -333,7 +374,7 @@ namespace llarp
       const huint128_t ip = GetIfAddr();
       m_KeyToIP[us] = ip;
       m_IPToKey[ip] = us;
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_AddrPool.Pin(ip);
       m_SNodeKeys.insert(us);
       if (m_ShouldInitTun)
       {
@@ -344,7 +385,7 @@ namespace llarp
           return false;
         }
         llarp::LogInfo("Trying to start resolver ", m_LocalResolverAddr.toString());
-        return m_Resolver->Start(m_LocalResolverAddr, m_UpstreamResolvers);
+        return m_Resolver->Start(m_LocalResolverAddr, m_UpstreamResolvers, m_UpstreamContexts);
       }
       return true;
     }
@@ -419,28 +460,19 @@ namespace llarp
     huint128_t
     ExitEndpoint::AllocateNewAddress()
     {
-      if (m_NextAddr < m_HigestAddr)
-        return ++m_NextAddr;
+      if (const auto maybe = m_AddrPool.Allocate())
+        return *maybe;
 
-      // find oldest activity ip address
-      huint128_t found = {0};
-      llarp_time_t min = std::numeric_limits<llarp_time_t>::max();
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      // kick the ident on the least active address off exit and take it
+      // TODO: DoS
+      const auto oldest = m_AddrPool.Oldest();
+      if (not oldest)
       {
-        if (itr->second < min)
-        {
-          found.h = itr->first.h;
-          min = itr->second;
-        }
-        ++itr;
+        LogError(Name(), " every address is ours, none to give out");
+        return huint128_t{0};
       }
-      // kick old ident off exit
-      // TODO: DoS
-      PubKey pk = m_IPToKey[found];
-      KickIdentOffExit(pk);
-
-      return found;
+      KickIdentOffExit(m_IPToKey[*oldest]);
+      return m_AddrPool.Allocate().value_or(*oldest);
     }
 
     bool
@@ -456,6 +488,7 @@ namespace llarp
       huint128_t ip = m_KeyToIP[pk];
       m_KeyToIP.erase(pk);
       m_IPToKey.erase(ip);
+      m_AddrPool.Release(ip);
       auto range = m_ActiveExits.equal_range(pk);
       auto exit_itr = range.first;
       while (exit_itr != range.second)
@@ -465,7 +498,7 @@ namespace llarp
     void
     ExitEndpoint::MarkIPActive(huint128_t ip)
     {
-      m_IPActivity[ip] = GetRouter()->Now();
+      m_AddrPool.MarkActive(ip, GetRouter()->Now());
     }
 
     void
@@ -547,8 +580,10 @@ namespace llarp
         m_ShouldInitTun = false;
       }
 
+      m_ExitBatchDelay = networkConfig.m_ExitBatchDelay;
       m_LocalResolverAddr = dnsConfig.m_bind;
       m_UpstreamResolvers = dnsConfig.m_upstreamDNS;
+      m_UpstreamContexts = dnsConfig.m_UpstreamContexts;
 
       m_OurRange = networkConfig.m_ifaddr;
       if (!m_OurRange.addr.h)
@@ -563,8 +598,8 @@ namespace llarp
       strncpy(m_Tun.ifaddr, host_str.c_str(), sizeof(m_Tun.ifaddr) - 1);
       m_Tun.netmask = m_OurRange.HostmaskBits();
       m_IfAddr = m_OurRange.addr;
-      m_NextAddr = m_IfAddr;
       m_HigestAddr = m_OurRange.HighestAddr();
+      m_AddrPool.Reset(m_IfAddr, m_HigestAddr);
       LogInfo(
           Name(),
           " set ifaddr range to ",
@@ -591,6 +626,8 @@ namespace llarp
       }
       strncpy(m_Tun.ifname, ifname.c_str(), sizeof(m_Tun.ifname) - 1);
       LogInfo(Name(), " set ifname to ", m_Tun.ifname);
+      m_Tun.queues = networkConfig.m_TunQueues;
+      m_Tun.offload = networkConfig.m_TunOffload;
 
       // TODO: "exit-whitelist" and "exit-blacklist"
       //       (which weren't originally implemented)
@@ -13,6 +13,11 @@ namespace llarp
   {
     struct ExitEndpoint : public dns::IQueryHandler
     {
+      /// most inbound traffic bytes one flush sends down to clients, the rest waits in their
+      /// queues, and how much each client gets per turn
+      static constexpr size_t MaxFlushBytes = 1024 * 1024;
+      static constexpr size_t FlushQuantum = 16 * 1024;
+
       ExitEndpoint(const std::string& name, AbstractRouter* r);
       ~ExitEndpoint() override;
 
@@ -37,6 +42,9 @@ namespace llarp
       bool
       ShouldHookDNSMessage(const dns::Message& msg) const override;
 
+      bool
+      ShouldHookDNSQuery(const dns::MessageView& query) const override;
+
       bool
       HandleHookedDNSMessage(dns::Message msg, std::function<void(dns::Message)>) override;
 
@@ -62,6 +70,13 @@ namespace llarp
       llarp_time_t
       Now() const;
 
+      /// how long exit traffic to clients may wait for more to share its message
+      llarp_time_t
+      ExitBatchDelay() const
+      {
+        return m_ExitBatchDelay;
+      }
+
       template <typename Stats>
       void
       CalculateTrafficStats(Stats& stats)
@@ -75,6 +90,13 @@ namespace llarp
         }
       }
 
+      /// exit sessions clients have with us
+      size_t
+      NumActiveExits() const
+      {
+        return m_ActiveExits.size();
+      }
+
       /// DO NOT CALL ME
       void
       DelEndpointInfo(const PathID_t& path);
@@ -159,15 +181,17 @@ namespace llarp
       huint128_t m_IfAddr;
       huint128_t m_HigestAddr;
 
-      huint128_t m_NextAddr;
       IPRange m_OurRange;
 
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      /// addresses we hand out to exit clients and when each last saw traffic
+      net::AddressPool m_AddrPool;
 
       llarp_tun_io m_Tun;
 
       IpAddress m_LocalResolverAddr;
       std::vector<IpAddress> m_UpstreamResolvers;
+      /// unbound contexts to spread upstream lookups over
+      size_t m_UpstreamContexts = 1;
 
       using Pkt_t = net::IPPacket;
       using PacketQueue_t = util::CoDelQueue<
@@ -176,12 +200,13 @@ namespace llarp
           Pkt_t::PutTime,
           Pkt_t::CompareOrder,
           Pkt_t::GetNow,
-          util::NullMutex,
-          util::NullLock>;
+          1024,
+          Pkt_t::MarkCongestion>;
 
       /// internet to llarp packet queue
       PacketQueue_t m_InetToNetwork;
       bool m_UseV6;
+      llarp_time_t m_ExitBatchDelay = 0s;
     };
   }  // namespace handlers
 }  // namespace llarp
@@ -19,6 +19,7 @@
 #include <service/name.hpp>
 #include <util/meta/memfn.hpp>
 #include <util/thread/logic.hpp>
+#include <util/tracy.hpp>
 #include <nodedb.hpp>
 #include <rpc/endpoint_rpc.hpp>
 
@@ -30,15 +31,48 @@ namespace llarp
 {
   namespace handlers
   {
+    void
+    TunEndpoint::OrderPacketsToUser()
+    {
+      // mostly already in order, so only pay for a sort when it isn't
+      if (not std::is_sorted(m_NetworkToUserOrder.begin(), m_NetworkToUserOrder.end()))
+        std::sort(m_NetworkToUserOrder.begin(), m_NetworkToUserOrder.end());
+    }
+
+    void
+    TunEndpoint::ClearPacketsToUser()
+    {
+      m_NetworkToUserOrder.clear();
+      m_NetworkToUserPending = 0;
+    }
+
     void
     TunEndpoint::FlushToUser(std::function<bool(const net::IPPacket&)> send)
     {
       // flush network to user
-      while (not m_NetworkToUserPktQueue.empty())
+      OrderPacketsToUser();
+      for (const auto& item : m_NetworkToUserOrder)
+        send(m_NetworkToUserPkts[item.second]);
+      ClearPacketsToUser();
+    }
+
+    void
+    TunEndpoint::FlushToTun(llarp_tun_io* tun)
+    {
+      if (m_NetworkToUserOrder.empty())
+        return;
+      OrderPacketsToUser();
+      m_TunWriteBatch.clear();
+      for (const auto& item : m_NetworkToUserOrder)
       {
-        send(m_NetworkToUserPktQueue.top().pkt);
-        m_NetworkToUserPktQueue.pop();
+        const auto& pkt = m_NetworkToUserPkts[item.second];
+        m_TunWriteBatch.emplace_back(llarp_tun_pkt{pkt.buf, pkt.sz});
       }
+      const size_t written =
+          llarp_ev_tun_async_write_batch(tun, m_TunWriteBatch.data(), m_TunWriteBatch.size());
+      if (written < m_TunWriteBatch.size())
+        llarp::LogWarn(Name(), " dropped ", m_TunWriteBatch.size() - written, " packets");
+      ClearPacketsToUser();
     }
 
     bool
@@ -58,10 +92,24 @@ namespace llarp
 
     TunEndpoint::TunEndpoint(AbstractRouter* r, service::Context* parent, bool lazyVPN)
         : service::Endpoint(r, parent)
-        , m_UserToNetworkPktQueue("endpoint_sendq", r->netloop(), r->netloop())
+        , m_UserToNetworkPriorityQueue("endpoint_sendq_priority", r->netloop(), r->netloop())
+        , m_PriorityDelayMetric(r->metrics().AddHistogram(
+              "llarp_tun_priority_queue_us",
+              "interactive packets read from the tun waiting to be sent",
+              metrics::LatencyBounds()))
+        , m_BulkDelayMetric(r->metrics().AddHistogram(
+              "llarp_tun_bulk_queue_us",
+              "bulk packets read from the tun waiting to be sent",
+              metrics::LatencyBounds()))
         , m_Resolver(std::make_shared<dns::Proxy>(
-              r->netloop(), r->logic(), r->netloop(), r->logic(), this))
+              r->netloop(), r->logic(), r->netloop(), r->logic(), this, r->metrics()))
+        , m_FlushMetric(r->metrics().AddHistogram(
+              "llarp_tun_flush_us",
+              "turning packets read from the tun into path traffic",
+              metrics::LatencyBounds()))
     {
+      m_UserToNetworkPktQueues.emplace_back(
+          std::make_unique<PacketQueue_t>("endpoint_sendq", r->netloop(), r->netloop()));
       if (not lazyVPN)
       {
         tunif.reset(new llarp_tun_io());
@@ -91,27 +139,48 @@ namespace llarp
         resolvers.emplace_back(addr.toString());
       obj["ustreamResolvers"] = resolvers;
       obj["localResolver"] = m_LocalResolverAddr.toString();
+      obj["dns"] = m_Resolver->ExtractStatus();
       util::StatusObject ips{};
-      for (const auto& item : m_IPActivity)
-      {
-        util::StatusObject ipObj{{"lastActive", to_json(item.second)}};
+      m_AddrPool.ForEach([&](huint128_t ip, llarp_time_t lastActive) {
+        const auto itr = m_IPToAddr.find(ip);
+        if (itr == m_IPToAddr.end())
+          return;
+        util::StatusObject ipObj{{"lastActive", to_json(lastActive)}};
         std::string remoteStr;
-        AlignedBuffer<32> addr = m_IPToAddr.at(item.first);
-        if (m_SNodes.at(addr))
+        const auto& addr = itr->second.addr;
+        if (itr->second.snode)
           remoteStr = RouterID(addr.as_array()).ToString();
         else
           remoteStr = service::Address(addr.as_array()).ToString();
         ipObj["remote"] = remoteStr;
-        std::string ipaddr = item.first.ToString();
-        ips[ipaddr] = ipObj;
-      }
+        ips[ip.ToString()] = ipObj;
+      });
       obj["addrs"] = ips;
       obj["ourIP"] = m_OurIP.ToString();
-      obj["nextIP"] = m_NextIP.ToString();
       obj["maxIP"] = m_MaxIP.ToString();
+      obj["addrPool"] = m_AddrPool.ExtractStatus();
+      obj["sendHeld"] = m_SendHeld;
+      uint64_t marks = m_UserToNetworkPriorityQueue.Marks();
+      for (const auto& queue : m_UserToNetworkPktQueues)
+        marks += queue->Marks();
+      obj["sendMarks"] = marks;
+      obj["ingress"] = m_Classifier.ExtractStatus();
+      obj["exitSelector"] = m_ExitSelector.ExtractStatus(Now());
       return obj;
     }
 
+    void
+    TunEndpoint::Reconfigure(const Config& prev, const Config& conf)
+    {
+      Endpoint::Reconfigure(prev, conf);
+      if (conf.dns.m_upstreamDNS == m_UpstreamResolvers
+          and size_t(conf.dns.m_UpstreamContexts) == m_UpstreamContexts)
+        return;
+      m_UpstreamResolvers = conf.dns.m_upstreamDNS;
+      m_UpstreamContexts = conf.dns.m_UpstreamContexts;
+      m_Resolver->SetUpstreams(m_UpstreamResolvers, m_UpstreamContexts);
+    }
+
     bool
     TunEndpoint::Configure(const NetworkConfig& conf, const DnsConfig& dnsConf)
     {
@@ -192,6 +261,7 @@ namespace llarp
 
       m_LocalResolverAddr = dnsConf.m_bind;
       m_UpstreamResolvers = dnsConf.m_upstreamDNS;
+      m_UpstreamContexts = dnsConf.m_UpstreamContexts;
 
       for (const auto& item : conf.m_mapAddrs)
       {
@@ -233,6 +303,15 @@ namespace llarp
         const auto addr = m_OurRange.BaseAddressString();
         llarp::LogInfo(Name() + " set ifaddr to ", addr, " with netmask ", tunif->netmask);
         strncpy(tunif->ifaddr, addr.c_str(), sizeof(tunif->ifaddr) - 1);
+        tunif->queues = conf.m_TunQueues;
+        tunif->offload = conf.m_TunOffload;
+      }
+
+      while (m_UserToNetworkPktQueues.size() < static_cast<size_t>(conf.m_TunQueues))
+      {
+        const auto loop = m_router->netloop();
+        m_UserToNetworkPktQueues.emplace_back(std::make_unique<PacketQueue_t>(
+            "endpoint_sendq_" + std::to_string(m_UserToNetworkPktQueues.size()), loop, loop));
       }
 
       return Endpoint::Configure(conf, dnsConf);
@@ -247,7 +326,10 @@ namespace llarp
     void
     TunEndpoint::Flush()
     {
+      LLARP_ZONE("TunEndpoint::Flush");
+      const auto start = metrics::Histogram::Clock_t::now();
       FlushSend();
+      m_FlushMetric.ObserveSince(start);
       Pump(Now());
     }
 
@@ -268,9 +350,9 @@ namespace llarp
     TunEndpoint::FindAddrForIP(service::Address& addr, huint128_t ip)
     {
       auto itr = m_IPToAddr.find(ip);
-      if (itr != m_IPToAddr.end() and not m_SNodes[itr->second])
+      if (itr != m_IPToAddr.end() and not itr->second.snode)
       {
-        addr = service::Address(itr->second.as_array());
+        addr = service::Address(itr->second.addr.as_array());
         return true;
       }
       return false;
@@ -281,9 +363,9 @@ namespace llarp
     TunEndpoint::FindAddrForIP(RouterID& addr, huint128_t ip)
     {
       auto itr = m_IPToAddr.find(ip);
-      if (itr != m_IPToAddr.end() and m_SNodes[itr->second])
+      if (itr != m_IPToAddr.end() and itr->second.snode)
       {
-        addr = RouterID(itr->second.as_array());
+        addr = RouterID(itr->second.addr.as_array());
         return true;
       }
       return false;
@@ -374,6 +456,14 @@ namespace llarp
         return false;
       }
       std::string qname = msg.questions[0].Name();
+      {
+        // whatever was asked about a remote, traffic to it usually follows
+        service::Address remote;
+        if (remote.FromString(qname, ".loki"))
+          PrefetchService(remote);
+        else if (remote.FromString(qname, ".snode"))
+          PrefetchSNode(remote.as_array());
+      }
       const auto nameparts = split(qname, ".");
       std::string lnsName;
       if (nameparts.size() >= 2 and ends_with(qname, ".loki"))
@@ -663,6 +753,28 @@ namespace llarp
       return false;
     }
 
+    bool
+    TunEndpoint::ShouldHookDNSQuery(const dns::MessageView& query) const
+    {
+      if (query.qdCount != 1)
+        return false;
+      /// hook every .loki
+      if (query.HasTLD(".loki"))
+        return true;
+      /// hook every .snode
+      if (query.HasTLD(".snode"))
+        return true;
+      // hook any ranges we own
+      if (query.qtype == llarp::dns::qTypePTR)
+      {
+        huint128_t ip = {0};
+        if (!dns::DecodePTR(query.QName(), ip))
+          return false;
+        return m_OurRange.Contains(ip);
+      }
+      return false;
+    }
+
     bool
     TunEndpoint::MapAddress(const service::Address& addr, huint128_t ip, bool SNode)
     {
@@ -670,15 +782,16 @@ namespace llarp
       if (itr != m_IPToAddr.end())
       {
         llarp::LogWarn(
-            ip, " already mapped to ", service::Address(itr->second.as_array()).ToString());
+            ip, " already mapped to ", service::Address(itr->second.addr.as_array()).ToString());
         return false;
       }
       llarp::LogInfo(Name() + " map ", addr.ToString(), " to ", ip);
 
-      m_IPToAddr[ip] = addr;
+      m_IPToAddr[ip] = IPMapping{addr, SNode, {}};
       m_AddrToIP[addr] = ip;
-      m_SNodes[addr] = SNode;
       MarkIPActiveForever(ip);
+      // it may be outside our range
+      m_ClassifierBuiltFrom.reset();
       return true;
     }
 
@@ -755,14 +868,14 @@ namespace llarp
           auto impl = ep->GetVPNImpl();
           if (impl)
           {
-            /// get packets from vpn
-            while (not impl->writer.queue.empty())
-            {
+            /// get packets from vpn, looked at where they sit in the queue
+            auto fromVPN = [ep, running](net::IPPacket& pkt) {
               // queue it to be sent over lokinet
-              auto pkt = impl->writer.queue.popFront();
-              if (running)
-                ep->m_UserToNetworkPktQueue.Emplace(pkt);
-            }
+              if (running and ep->AdmitFromUser(pkt))
+                ep->UserToNetworkQueueFor(pkt.buf, pkt.sz).Emplace(pkt);
+            };
+            while (impl->writer.queue.tryPopFrontWith(fromVPN))
+              ;
           }
 
           // process packets queued from vpn
@@ -827,9 +940,10 @@ namespace llarp
         return false;
       }
 
-      m_NextIP = m_OurIP;
       m_OurRange.addr = m_OurIP;
       m_MaxIP = m_OurRange.HighestAddr();
+      // the highest address is left out, as it always has been
+      m_AddrPool.Reset(m_OurIP, m_MaxIP - huint128_t{1});
       llarp::LogInfo(Name(), " set ", ifname, " to have address ", m_OurIP);
       llarp::LogInfo(Name(), " allocated up to ", m_MaxIP, " on range ", m_OurRange);
 
@@ -876,7 +990,7 @@ namespace llarp
         llarp::LogError(Name(), " failed to set up network interface");
         return false;
       }
-      if (!m_Resolver->Start(m_LocalResolverAddr, m_UpstreamResolvers))
+      if (!m_Resolver->Start(m_LocalResolverAddr, m_UpstreamResolvers, m_UpstreamContexts))
       {
         llarp::LogError(Name(), " failed to start DNS server");
         return false;
@@ -888,6 +1002,36 @@ namespace llarp
     TunEndpoint::Tick(llarp_time_t now)
     {
       Endpoint::Tick(now);
+      TickExits(now);
+    }
+
+    void
+    TunEndpoint::TickExits(llarp_time_t now)
+    {
+      std::set<service::Address> exits;
+      m_ExitMap.ForEachValue([&exits](const service::Address& exit) { exits.insert(exit); });
+      m_ExitSelector.Tick(now, exits);
+      // nothing to pick between, or nothing sent yet when we are to start lazily
+      if (exits.size() < 2 or (m_state->m_LazyStart and m_ExitSelector.Flows() == 0))
+        return;
+      for (const auto& exit : exits)
+      {
+        const auto ctx = GetReadyOutboundContext(exit);
+        if (ctx == nullptr)
+        {
+          m_ExitSelector.Lost(exit);
+          // keep paths up to every exit so a better one is there to move new flows to
+          if (m_state->m_RemoteSessions.count(exit) == 0
+              and m_state->m_PendingServiceLookups.count(exit) == 0)
+            EnsurePathToService(exit, [](service::Address, service::OutboundContext*) {}, 5s);
+          continue;
+        }
+        m_ExitSelector.Advertised(exit, ctx->GetCurrentIntroSet());
+        if (const auto rtt = ctx->RoundTrip())
+          m_ExitSelector.Latency(exit, *rtt);
+        else
+          m_ExitSelector.Lost(exit);
+      }
     }
 
     bool
@@ -896,11 +1040,67 @@ namespace llarp
       return llarp::service::Endpoint::Stop();
     }
 
+    TunEndpoint::PacketQueue_t&
+    TunEndpoint::UserToNetworkQueueFor(const byte_t* ptr, size_t sz)
+    {
+      if (net::IsInteractive(ptr, sz))
+        return m_UserToNetworkPriorityQueue;
+      if (m_UserToNetworkPktQueues.size() == 1)
+        return *m_UserToNetworkPktQueues.front();
+      return *m_UserToNetworkPktQueues[net::FlowHash(ptr, sz) % m_UserToNetworkPktQueues.size()];
+    }
+
+    bool
+    TunEndpoint::AdmitFromUser(const net::IPPacket& pkt)
+    {
+      if (m_ClassifierBuiltFrom != ExitMapVersion())
+        RebuildClassifier();
+      switch (m_Classifier.Classify(pkt))
+      {
+        case net::IngressVerdict::Forward:
+          Router()->NotifyUserActivity();
+          return true;
+        case net::IngressVerdict::Unreachable:
+          if (const auto icmp = pkt.MakeICMPUnreachable())
+          {
+            if (pkt.IsV4())
+              HandleWriteIPPacket(icmp->ConstBuffer(), pkt.dst4to6(), pkt.src4to6(), 0);
+            else
+              HandleWriteIPPacket(icmp->ConstBuffer(), pkt.dstv6(), pkt.srcv6(), 0);
+          }
+          return false;
+        case net::IngressVerdict::Drop:
+          return false;
+      }
+      return false;
+    }
+
+    void
+    TunEndpoint::RebuildClassifier()
+    {
+      // as an exit we send replies for the whole internet to clients in our range
+      std::optional<IPRange> sourceRange;
+      if (not m_state->m_ExitEnabled)
+        sourceRange = m_OurRange;
+      std::vector<IPRange> local{m_OurRange};
+      for (const auto& item : m_IPToAddr)
+      {
+        if (not m_OurRange.Contains(item.first))
+          local.emplace_back(IPRange{item.first, netmask_ipv6_bits(128)});
+      }
+      std::vector<IPRange> routed;
+      m_ExitMap.ForEachEntry(
+          [&routed](const IPRange& range, const service::Address&) { routed.emplace_back(range); });
+      m_Classifier.Reset(sourceRange, local, routed);
+      m_ClassifierBuiltFrom = ExitMapVersion();
+    }
+
     void
     TunEndpoint::FlushSend()
     {
-      m_UserToNetworkPktQueue.Process([&](net::IPPacket& pkt) {
+      const auto sendpkt = [&](net::IPPacket& pkt) {
         std::function<bool(const llarp_buffer_t&)> sendFunc;
+        pkt.ClampTCPMSS();
 
         huint128_t dst, src;
         if (pkt.IsV4())
@@ -928,7 +1128,10 @@ namespace llarp
           }
           else
           {
-            const auto addr = *exits.begin();
+            // the same flow keeps going out through the same exit, or its connections break
+            const auto addr = exits.size() == 1
+                ? *exits.begin()
+                : m_ExitSelector.Pick(net::FlowHash(pkt.buf, pkt.sz), exits, Now());
             pkt.ZeroSourceAddress();
             MarkAddressOutbound(addr);
             EnsurePathToService(
@@ -944,31 +1147,35 @@ namespace llarp
           }
           return;
         }
-        if (m_SNodes.at(itr->second))
+        auto& mapping = itr->second;
+        const auto proto = m_state->m_ExitEnabled ? service::eProtocolExit : pkt.ServiceProtocol();
+        std::shared_ptr<service::OutboundContext> ctx;
+        if (mapping.snode)
         {
           sendFunc = std::bind(
               &TunEndpoint::SendToSNodeOrQueue,
               this,
-              itr->second.as_array(),
+              mapping.addr.as_array(),
               std::placeholders::_1);
         }
-        else if (m_state->m_ExitEnabled)
+        else if (ctx = mapping.ctx.lock(); ctx and ctx->ReadyToSend())
         {
-          sendFunc = std::bind(
-              &TunEndpoint::SendToServiceOrQueue,
-              this,
-              service::Address(itr->second.as_array()),
-              std::placeholders::_1,
-              service::eProtocolExit);
+          // the context we sent through last is still good, no session lookups needed
+          sendFunc = [ctx, proto](const llarp_buffer_t& buf) {
+            ctx->AsyncEncryptAndSendTo(buf, proto);
+            return true;
+          };
         }
         else
         {
+          const service::Address remote{mapping.addr.as_array()};
+          mapping.ctx = GetReadyOutboundContext(remote);
           sendFunc = std::bind(
               &TunEndpoint::SendToServiceOrQueue,
               this,
-              service::Address(itr->second.as_array()),
+              remote,
               std::placeholders::_1,
-              pkt.ServiceProtocol());
+              proto);
         }
         // prepare packet for insertion into network
         // this includes clearing IP addresses, recalculating checksums, etc
@@ -985,7 +1192,25 @@ namespace llarp
           return;
         }
         llarp::LogWarn(Name(), " did not flush packets");
-      });
+      };
+      // leave packets in the codel queues while everything downstream is backed up, so they
+      // are dropped there on the way in instead of after we encrypt them
+      if (TrafficBackedUp())
+      {
+        m_SendHeld++;
+        return;
+      }
+      const auto now = llarp_ev_loop_time_now_ms(m_router->netloop());
+      const auto sendFrom = [&sendpkt, now](metrics::Histogram& delay) {
+        return [&sendpkt, &delay, now](net::IPPacket& pkt) {
+          const auto waited = std::max(now - pkt.timestamp, 0ms);
+          delay.Observe(std::chrono::duration_cast<std::chrono::microseconds>(waited).count());
+          sendpkt(pkt);
+        };
+      };
+      m_UserToNetworkPriorityQueue.Process(sendFrom(m_PriorityDelayMetric));
+      for (auto& queue : m_UserToNetworkPktQueues)
+        queue->Process(sendFrom(m_BulkDelayMetric));
     }
 
     bool
@@ -1031,6 +1256,8 @@ namespace llarp
           // we got exit traffic from someone who we should not have gotten it from
           return false;
         }
+        if (mapped.size() > 1)
+          m_ExitSelector.Received(service::Address{addr}, buf.sz, Now());
       }
       else
       {
@@ -1047,12 +1274,16 @@ namespace llarp
         const llarp_buffer_t& b, huint128_t src, huint128_t dst, uint64_t seqno)
     {
       ManagedBuffer buf(b);
-      WritePacket write;
-      write.seqno = seqno;
-      auto& pkt = write.pkt;
+      // reuse a slot from an earlier flush when there is one rather than growing
+      if (m_NetworkToUserPending == m_NetworkToUserPkts.size())
+        m_NetworkToUserPkts.emplace_back();
+      auto& pkt = m_NetworkToUserPkts[m_NetworkToUserPending];
       // load
       if (!pkt.Load(buf))
         return false;
+      // the far end may not have clamped its syn ack, and our side would then send segments
+      // bigger than we can carry back to it
+      pkt.ClampTCPMSS();
       if (pkt.IsV4())
       {
         pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(src)), xhtonl(net::TruncateV6(dst)));
@@ -1061,7 +1292,7 @@ namespace llarp
       {
         pkt.UpdateIPv6Address(src, dst);
       }
-      m_NetworkToUserPktQueue.push(std::move(write));
+      m_NetworkToUserOrder.emplace_back(seqno, m_NetworkToUserPending++);
       return true;
     }
 
@@ -1087,50 +1318,34 @@ namespace llarp
         }
       }
       // allocate new address
-      if (m_NextIP < m_MaxIP)
+      if (const auto maybe = m_AddrPool.Allocate())
       {
-        do
-        {
-          nextIP = ++m_NextIP;
-        } while (m_IPToAddr.find(nextIP) != m_IPToAddr.end() && m_NextIP < m_MaxIP);
-        if (nextIP < m_MaxIP)
-        {
-          m_AddrToIP[ident] = nextIP;
-          m_IPToAddr[nextIP] = ident;
-          m_SNodes[ident] = snode;
-          llarp::LogInfo(Name(), " mapped ", ident, " to ", nextIP);
-          MarkIPActive(nextIP);
-          return nextIP;
-        }
+        nextIP = *maybe;
+        m_AddrToIP[ident] = nextIP;
+        m_IPToAddr[nextIP] = IPMapping{ident, snode, {}};
+        llarp::LogInfo(Name(), " mapped ", ident, " to ", nextIP);
+        MarkIPActive(nextIP);
+        return nextIP;
       }
 
       // we are full
       // expire least active ip
       // TODO: prevent DoS
-      std::pair<huint128_t, llarp_time_t> oldest = {huint128_t{0}, 0s};
-
-      // find oldest entry
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
+      const auto oldest = m_AddrPool.Oldest();
+      if (not oldest)
       {
-        if (itr->second <= now)
-        {
-          if ((now - itr->second) > oldest.second)
-          {
-            oldest.first = itr->first;
-            oldest.second = itr->second;
-          }
-        }
-        ++itr;
+        LogError(Name(), " no address to give ", ident, ", every one is mapped for good");
+        return nextIP;
       }
-      // remap address
-      m_IPToAddr[oldest.first] = ident;
-      m_AddrToIP[ident] = oldest.first;
-      m_SNodes[ident] = snode;
-      nextIP = oldest.first;
+      nextIP = *oldest;
+      // remap address, the key it had no longer maps to it
+      auto& mapping = m_IPToAddr[nextIP];
+      m_AddrToIP.erase(mapping.addr);
+      mapping = IPMapping{ident, snode, {}};
+      m_AddrToIP[ident] = nextIP;
 
       // mark ip active
-      m_IPActivity[nextIP] = std::max(m_IPActivity[nextIP], now);
+      m_AddrPool.MarkActive(nextIP, now);
 
       return nextIP;
     }
@@ -1145,13 +1360,13 @@ namespace llarp
     TunEndpoint::MarkIPActive(huint128_t ip)
     {
       llarp::LogDebug(Name(), " address ", ip, " is active");
-      m_IPActivity[ip] = std::max(Now(), m_IPActivity[ip]);
+      m_AddrPool.MarkActive(ip, Now());
     }
 
     void
     TunEndpoint::MarkIPActiveForever(huint128_t ip)
     {
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_AddrPool.Pin(ip);
     }
 
     void
@@ -1166,13 +1381,7 @@ namespace llarp
       // called in the isolated network thread
       auto* self = static_cast<TunEndpoint*>(tun->user);
       self->Flush();
-      self->FlushToUser([self, tun](const net::IPPacket& pkt) -> bool {
-        if (not llarp_ev_tun_async_write(tun, pkt.ConstBuffer()))
-        {
-          llarp::LogWarn(self->Name(), " packet dropped");
-        }
-        return false;
-      });
+      self->FlushToTun(tun);
     }  // namespace handlers
 
     void
@@ -1180,7 +1389,9 @@ namespace llarp
     {
       // called for every packet read from user in isolated network thread
       auto* self = static_cast<TunEndpoint*>(tun->user);
-      self->m_UserToNetworkPktQueue.EmplaceIf([&](net::IPPacket& pkt) { return pkt.Load(b); });
+      self->UserToNetworkQueueFor(b.base, b.sz).EmplaceIf([&](net::IPPacket& pkt) {
+        return pkt.Load(b) and self->AdmitFromUser(pkt);
+      });
     }
 
     TunEndpoint::~TunEndpoint() = default;
@@ -4,15 +4,20 @@
 #include <dns/server.hpp>
 #include <ev/ev.h>
 #include <ev/vpnio.hpp>
+#include <net/address_pool.hpp>
+#include <net/ingress_classifier.hpp>
 #include <net/ip.hpp>
 #include <net/ip_packet.hpp>
 #include <net/net.hpp>
 #include <service/endpoint.hpp>
+#include <service/exit_selector.hpp>
 #include <util/codel.hpp>
+#include <util/metrics.hpp>
 #include <util/thread/threading.hpp>
 
 #include <future>
-#include <queue>
+#include <utility>
+#include <vector>
 
 namespace llarp
 {
@@ -34,6 +39,9 @@ namespace llarp
       bool
       Configure(const NetworkConfig& conf, const DnsConfig& dnsConf) override;
 
+      void
+      Reconfigure(const Config& prev, const Config& conf) override;
+
       void
       SendPacketToRemote(const llarp_buffer_t&) override{};
 
@@ -55,6 +63,9 @@ namespace llarp
       bool
       ShouldHookDNSMessage(const dns::Message& msg) const override;
 
+      bool
+      ShouldHookDNSQuery(const dns::MessageView& query) const override;
+
       bool
       HandleHookedDNSMessage(
           dns::Message query, std::function<void(dns::Message)> sendreply) override;
@@ -152,9 +163,9 @@ namespace llarp
       {
         Addr_t addr;
         auto itr = m_IPToAddr.find(ip);
-        if (itr != m_IPToAddr.end() and m_SNodes[itr->second] == isSNode)
+        if (itr != m_IPToAddr.end() and itr->second.snode == isSNode)
         {
-          addr = Addr_t(itr->second);
+          addr = Addr_t(itr->second.addr);
         }
         // found
         return addr;
@@ -191,25 +202,55 @@ namespace llarp
           net::IPPacket::GetTime,
           net::IPPacket::PutTime,
           net::IPPacket::CompareOrder,
-          net::IPPacket::GetNow>;
-
-      /// queue for sending packets over the network from us
-      PacketQueue_t m_UserToNetworkPktQueue;
+          net::IPPacket::GetNow,
+          1024,
+          net::IPPacket::MarkCongestion>;
+
+      /// queues for sending packets over the network from us, packets go to one by flow hash so
+      /// a burst on one flow doesn't push every other flow over its codel target
+      std::vector<std::unique_ptr<PacketQueue_t>> m_UserToNetworkPktQueues;
+      /// the net::IsInteractive packets we send, flushed before any of the others so acks and
+      /// dns are not held up behind a bulk upload
+      PacketQueue_t m_UserToNetworkPriorityQueue;
+      /// how long packets sat in the queues before we sent them, interactive and bulk
+      metrics::Histogram& m_PriorityDelayMetric;
+      metrics::Histogram& m_BulkDelayMetric;
+      /// flushes that left the queues alone because our paths were backed up
+      uint64_t m_SendHeld = 0;
+
+      /// the queue the raw ip packet at ptr belongs in, by class then by flow
+      PacketQueue_t&
+      UserToNetworkQueueFor(const byte_t* ptr, size_t sz);
+
+      /// turns away packets read from the tun that could never be sent before they are queued
+      net::IngressClassifier m_Classifier;
+      /// version of the exit map m_Classifier was built from, unset when it needs rebuilding
+      std::optional<uint64_t> m_ClassifierBuiltFrom;
+
+      /// true if pkt read from the tun should be queued to send, answers ones nothing can take
+      /// with icmp unreachable
+      bool
+      AdmitFromUser(const net::IPPacket& pkt);
 
-      struct WritePacket
-      {
-        uint64_t seqno;
-        net::IPPacket pkt;
+      void
+      RebuildClassifier();
 
-        bool
-        operator<(const WritePacket& other) const
-        {
-          return other.seqno < seqno;
-        }
-      };
+      /// picks which exit each flow goes out through when a range maps to more than one
+      service::ExitSelector m_ExitSelector;
 
-      /// queue for sending packets to user from network
-      std::priority_queue<WritePacket> m_NetworkToUserPktQueue;
+      /// keep paths up to every exit m_ExitSelector may pick and tell it their round trips
+      void
+      TickExits(llarp_time_t now);
+
+      /// packets to send to user from network, kept between flushes so their storage is reused
+      std::vector<net::IPPacket> m_NetworkToUserPkts;
+      /// how many of m_NetworkToUserPkts are waiting to go out
+      size_t m_NetworkToUserPending = 0;
+      /// seqno and index into m_NetworkToUserPkts of each waiting packet, sorted before a flush
+      /// instead of heaping whole packets around as they come in
+      std::vector<std::pair<uint64_t, uint32_t>> m_NetworkToUserOrder;
+      /// reused to hand batches to the tun
+      std::vector<llarp_tun_pkt> m_TunWriteBatch;
       /// return true if we have a remote loki address for this ip address
       bool
       HasRemoteForIP(huint128_t ipv4) const;
@@ -226,15 +267,21 @@ namespace llarp
       virtual void
       FlushSend();
 
+      /// what an ip maps to: the key, whether it is a service node, and the outbound context
+      /// we last sent to it through, so sending a packet to an ip is one probe while that
+      /// context stays ready
+      struct IPMapping
+      {
+        AlignedBuffer<32> addr;
+        bool snode = false;
+        std::weak_ptr<service::OutboundContext> ctx;
+      };
+
       /// maps ip to key (host byte order)
-      std::unordered_map<huint128_t, AlignedBuffer<32>> m_IPToAddr;
+      std::unordered_map<huint128_t, IPMapping> m_IPToAddr;
       /// maps key to ip (host byte order)
       std::unordered_map<AlignedBuffer<32>, huint128_t, AlignedBuffer<32>::Hash> m_AddrToIP;
 
-      /// maps key to true if key is a service node, maps key to false if key is
-      /// a hidden service
-      std::unordered_map<AlignedBuffer<32>, bool, AlignedBuffer<32>::Hash> m_SNodes;
-
      private:
       llarp_vpn_io_impl*
       GetVPNImpl()
@@ -266,19 +313,21 @@ namespace llarp
       }
       /// our dns resolver
       std::shared_ptr<dns::Proxy> m_Resolver;
+      /// how long FlushSend takes to turn what we read from the tun into path traffic
+      metrics::Histogram& m_FlushMetric;
 
-      /// maps ip address to timestamp last active
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      /// addresses we hand out to remotes and when each last saw traffic
+      net::AddressPool m_AddrPool;
       /// our ip address (host byte order)
       huint128_t m_OurIP;
-      /// next ip address to allocate (host byte order)
-      huint128_t m_NextIP;
       /// highest ip address to allocate (host byte order)
       huint128_t m_MaxIP;
       /// our ip range we are using
       llarp::IPRange m_OurRange;
       /// upstream dns resolver list
       std::vector<IpAddress> m_UpstreamResolvers;
+      /// unbound contexts to spread upstream lookups over
+      size_t m_UpstreamContexts = 1;
       /// local dns
       IpAddress m_LocalResolverAddr;
       /// list of strict connect addresses for hooks
@@ -298,6 +347,18 @@ namespace llarp
       /// drop
       void
       FlushToUser(std::function<bool(const net::IPPacket&)> sendfunc);
+
+      /// send packets on endpoint to user through the tun in as few writes as we can
+      void
+      FlushToTun(llarp_tun_io* tun);
+
+      /// sort what is waiting to go to the user into seqno order
+      void
+      OrderPacketsToUser();
+
+      /// forget everything that went to the user, keeping the storage
+      void
+      ClearPacketsToUser();
     };
 
   }  // namespace handlers
@@ -1,10 +1,21 @@
 #include <hook/shell.hpp>
 
 #if defined(ENABLE_SHELLHOOKS)
-#include <util/thread_pool.hpp>
-#include <util/logger.hpp>
+#include <util/logging/logger.hpp>
+#include <util/thread/threading.hpp>
+
+#include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 #if !defined(__linux__) || !defined(_GNU_SOURCE)
 // Not all systems declare this variable
 extern char** environ;
@@ -19,126 +30,140 @@ namespace llarp
   namespace hooks
   {
 #if defined(ENABLE_SHELLHOOKS)
-    struct ExecShellHookBackend : public IBackend,
-                                  public std::enable_shared_from_this<ExecShellHookBackend>
+    /// runs the hook on a thread of its own with posix_spawn, which starts the child without
+    /// copying our address space, so neither the caller nor the size of the router holds it up
+    struct ExecShellHookBackend : public IBackend
     {
-      thread::ThreadPool m_ThreadPool;
+      using Params_t = std::unordered_map<std::string, std::string>;
 
-      std::vector<std::string> _args;
-      std::vector<char*> args;
+      /// runs waiting to start, past this they are dropped rather than queued without bound
+      static constexpr size_t MaxQueuedRuns = 64;
 
-      ExecShellHookBackend(std::string script) : m_ThreadPool(1, 1000, "exechook")
+      explicit ExecShellHookBackend(const std::string& script)
       {
-        do
+        size_t pos = 0;
+        while (pos < script.size())
         {
-          const auto idx = script.find_first_of(' ');
-          std::string sub;
-          if (idx == std::string::npos)
-            sub = script;
-          else
-            sub = script.substr(0, idx);
-          _args.emplace_back(std::move(sub));
-          args.push_back((char*)_args.back().c_str());
-          script = script.substr(idx + 1);
-        } while (script.find_first_of(' ') != std::string::npos);
-        args.push_back(nullptr);
-        LogInfo("make hook ", args.size());
+          const auto end = std::min(script.find(' ', pos), script.size());
+          if (end > pos)
+            m_Args.emplace_back(script.substr(pos, end - pos));
+          pos = end + 1;
+        }
+        for (auto& arg : m_Args)
+          m_Argv.push_back(arg.data());
+        m_Argv.push_back(nullptr);
       }
 
-      ~ExecShellHookBackend()
+      ~ExecShellHookBackend() override
       {
-        m_ThreadPool.shutdown();
+        Stop();
       }
 
       bool
       Start() override
       {
-        m_ThreadPool.start();
+        if (m_Args.empty())
+          return false;
+        m_Thread = std::thread{[this]() {
+          util::SetThreadName("exechook");
+          Run();
+        }};
         return true;
       }
 
       bool
       Stop() override
       {
-        m_ThreadPool.stop();
+        {
+          std::lock_guard lock{m_Mutex};
+          m_Stopping = true;
+        }
+        m_CV.notify_one();
+        if (m_Thread.joinable() and m_Thread.get_id() != std::this_thread::get_id())
+          m_Thread.join();
         return true;
       }
 
-      char*
-      Exe() const
+      void
+      NotifyAsync(Params_t params) override
       {
-        return args[0];
+        {
+          std::lock_guard lock{m_Mutex};
+          if (m_Stopping)
+            return;
+          if (m_Queue.size() >= MaxQueuedRuns)
+          {
+            LogWarn("hook ", m_Args[0], " is behind, dropping a run");
+            return;
+          }
+          m_Queue.emplace_back(std::move(params));
+        }
+        m_CV.notify_one();
       }
 
-      char* const*
-      Args() const
+     private:
+      /// one run at a time and in the order asked for, so an up never lands after its down
+      void
+      Run()
       {
-        return args.data();
+        std::unique_lock lock{m_Mutex};
+        while (true)
+        {
+          m_CV.wait(lock, [this]() { return m_Stopping or not m_Queue.empty(); });
+          // what was asked for before stopping still runs, a down hook is often the last
+          if (m_Queue.empty())
+            return;
+          auto params = std::move(m_Queue.front());
+          m_Queue.pop_front();
+          lock.unlock();
+          Spawn(params);
+          lock.lock();
+        }
       }
 
       void
-      NotifyAsync(std::unordered_map<std::string, std::string> params) override;
-    };
-
-    struct ExecShellHookJob
-    {
-      std::vector<std::string> m_env;
-      std::vector<char*> _m_env;
-      std::shared_ptr<ExecShellHookBackend> m_Parent;
-
-      ExecShellHookJob(
-          std::shared_ptr<ExecShellHookBackend> b,
-          const std::unordered_map<std::string, std::string> env)
-          : m_Parent(b)
+      Spawn(const Params_t& params)
       {
 #if defined(Darwin)
         char** ptr = *_NSGetEnviron();
 #else
         char** ptr = environ;
 #endif
-        do
+        std::vector<std::string> env;
+        for (; ptr and *ptr; ++ptr)
+          env.emplace_back(*ptr);
+        for (const auto& [key, val] : params)
+          env.emplace_back(key + "=" + val);
+        std::vector<char*> envp;
+        for (auto& item : env)
+          envp.push_back(item.data());
+        envp.push_back(nullptr);
+
+        pid_t child = -1;
+        const int err =
+            ::posix_spawn(&child, m_Argv[0], nullptr, nullptr, m_Argv.data(), envp.data());
+        if (err)
         {
-          m_env.emplace_back(*ptr);
-          ++ptr;
-        } while (ptr && *ptr);
-        for (const auto& item : env)
-          m_env.emplace_back(item.first + "=" + item.second);
-        for (const auto& item : m_env)
-          _m_env.push_back((char*)item.c_str());
-        _m_env.push_back(nullptr);
+          LogError("failed to run hook ", m_Args[0], ": ", std::strerror(err));
+          return;
+        }
+        int status = 0;
+        while (::waitpid(child, &status, 0) == -1 and errno == EINTR)
+          continue;
+        if (not WIFEXITED(status) or WEXITSTATUS(status) != 0)
+          LogWarn("hook ", m_Args[0], " exited with status ", status);
       }
 
-      char* const*
-      Env()
-      {
-        return _m_env.data();
-      }
+      std::vector<std::string> m_Args;
+      std::vector<char*> m_Argv;
 
-      void
-      Exec()
-      {
-        std::thread t([&]() {
-          int result = 0;
-          const pid_t child = ::fork();
-          if (child == -1)
-            return;
-          if (child)
-            ::waitpid(child, &result, 0);
-          else
-            ::execve(m_Parent->Exe(), m_Parent->Args(), Env());
-        });
-        t.join();
-      }
+      std::mutex m_Mutex;
+      std::condition_variable m_CV;
+      std::deque<Params_t> m_Queue;
+      bool m_Stopping = false;
+      std::thread m_Thread;
     };
 
-    void
-    ExecShellHookBackend::NotifyAsync(std::unordered_map<std::string, std::string> params)
-    {
-      auto job = std::make_shared<ExecShellHookJob>(shared_from_this(), std::move(params));
-
-      m_ThreadPool.addJob(std::bind(&ExecShellHookJob::Exec, job));
-    }
-
     Backend_ptr
     ExecShellBackend(std::string execFilePath)
     {
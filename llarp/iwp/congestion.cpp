@@ -0,0 +1,132 @@
+#include <iwp/congestion.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    void
+    CongestionControl::OnRTTSample(llarp_time_t rtt)
+    {
+      if (rtt <= 0s)
+        rtt = 1ms;
+      if (m_SRTT == 0s)
+      {
+        m_SRTT = rtt;
+        m_RTTVar = rtt / 2;
+        m_MinRTT = rtt;
+        return;
+      }
+      // rfc 6298
+      const auto delta = m_SRTT > rtt ? m_SRTT - rtt : rtt - m_SRTT;
+      m_RTTVar = (m_RTTVar * 3 + delta) / 4;
+      m_SRTT = (m_SRTT * 7 + rtt) / 8;
+      m_MinRTT = std::min(m_MinRTT, rtt);
+    }
+
+    void
+    CongestionControl::OnAcked(size_t num, llarp_time_t now)
+    {
+      if (num == 0)
+        return;
+      if (m_Window < m_SSThresh)
+      {
+        // slow start
+        m_Window = std::min(m_Window + num, MaxWindow);
+        return;
+      }
+      if (m_EpochStart == 0s)
+      {
+        m_EpochStart = now;
+        m_WindowMax = std::max(m_WindowMax, m_Window);
+      }
+      const double K = std::cbrt(m_WindowMax * (1 - Beta) / C);
+      const double t = std::chrono::duration<double>(now - m_EpochStart + m_SRTT).count();
+      const double target = C * std::pow(t - K, 3) + m_WindowMax;
+      // grow towards the cubic target over one window of acks, probe slowly when at it
+      const double step = target > m_Window ? (target - m_Window) / m_Window : 0.01 / m_Window;
+      m_Window = std::min(m_Window + step * num, MaxWindow);
+    }
+
+    void
+    CongestionControl::OnLoss(llarp_time_t now)
+    {
+      if (m_LastLoss > 0s and now - m_LastLoss < std::max(m_SRTT, 10ms))
+        return;
+      m_LastLoss = now;
+      m_LossEvents++;
+      m_WindowMax = m_Window;
+      m_Window = std::max(m_Window * Beta, MinWindow);
+      m_SSThresh = m_Window;
+      m_EpochStart = 0s;
+    }
+
+    void
+    CongestionControl::OnTimeout(llarp_time_t now)
+    {
+      m_LastLoss = now;
+      m_LossEvents++;
+      m_WindowMax = m_Window;
+      m_SSThresh = std::max(m_Window * Beta, MinWindow);
+      m_Window = std::min(InitialWindow, m_SSThresh);
+      m_EpochStart = 0s;
+    }
+
+    double
+    CongestionControl::PacingRate() const
+    {
+      if (m_SRTT == 0s)
+        return 0;
+      // pace a little faster than the window so we fill it, more so in slow start
+      const double gain = m_Window < m_SSThresh ? 2.0 : 1.25;
+      return gain * m_Window / std::chrono::duration<double>(m_SRTT).count();
+    }
+
+    void
+    CongestionControl::Refill(llarp_time_t now)
+    {
+      if (m_LastRefill == 0s)
+        m_LastRefill = now;
+      const auto rate = PacingRate();
+      if (rate == 0)
+      {
+        m_Tokens = MaxBurst;
+      }
+      else if (now > m_LastRefill)
+      {
+        const double elapsed = std::chrono::duration<double>(now - m_LastRefill).count();
+        m_Tokens = std::min(m_Tokens + elapsed * rate, std::max(MaxBurst, m_Window / 4));
+      }
+      m_LastRefill = now;
+    }
+
+    bool
+    CongestionControl::CanSend(size_t num, size_t inflight, llarp_time_t now)
+    {
+      Refill(now);
+      if (inflight == 0)
+        return true;
+      return inflight + num <= m_Window and m_Tokens >= 1;
+    }
+
+    void
+    CongestionControl::OnSent(size_t num)
+    {
+      m_Tokens = std::max(m_Tokens - num, -MaxBurst);
+    }
+
+    util::StatusObject
+    CongestionControl::ExtractStatus() const
+    {
+      return {{"cwnd", Window()},
+              {"ssthresh", static_cast<uint64_t>(m_SSThresh)},
+              {"srtt", to_json(m_SRTT)},
+              {"rttvar", to_json(m_RTTVar)},
+              {"minRTT", to_json(m_MinRTT)},
+              {"pacingRate", PacingRate()},
+              {"lossEvents", m_LossEvents}};
+    }
+  }  // namespace iwp
+}  // namespace llarp
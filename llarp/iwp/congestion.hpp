@@ -0,0 +1,107 @@
+#ifndef LLARP_IWP_CONGESTION_HPP
+#define LLARP_IWP_CONGESTION_HPP
+
+#include <util/status.hpp>
+#include <util/time.hpp>
+#include <util/types.hpp>
+
+#include <cstddef>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// loss based (CUBIC) congestion control and pacing for one session
+    /// everything is counted in datagrams, an XMIT or a DATA fragment each count as one
+    struct CongestionControl
+    {
+      /// window we start with and fall back to after a message times out
+      static constexpr double InitialWindow = 16;
+      /// we never go lower than this so a session can always make progress
+      static constexpr double MinWindow = 2;
+      static constexpr double MaxWindow = 4096;
+      /// multiplicative decrease on loss
+      static constexpr double Beta = 0.7;
+      /// cubic scaling constant
+      static constexpr double C = 0.4;
+      /// most datagrams we let out back to back once pacing kicks in
+      static constexpr double MaxBurst = 8;
+
+      /// feed an rtt sample, only use messages that were never retransmitted
+      void
+      OnRTTSample(llarp_time_t rtt);
+
+      /// num datagrams were acked by the remote
+      void
+      OnAcked(size_t num, llarp_time_t now);
+
+      /// we had to retransmit, at most one decrease per round trip
+      void
+      OnLoss(llarp_time_t now);
+
+      /// a message timed out without being acked
+      void
+      OnTimeout(llarp_time_t now);
+
+      /// return true if we may send num more datagrams with inflight already unacked
+      /// we always let one message through when nothing is in flight so big messages still go
+      bool
+      CanSend(size_t num, size_t inflight, llarp_time_t now);
+
+      /// we sent num datagrams, takes them out of the pacing budget
+      void
+      OnSent(size_t num);
+
+      /// pacing rate in datagrams per second, 0 when we have no rtt yet
+      double
+      PacingRate() const;
+
+      size_t
+      Window() const
+      {
+        return static_cast<size_t>(m_Window);
+      }
+
+      llarp_time_t
+      SmoothedRTT() const
+      {
+        return m_SRTT;
+      }
+
+      llarp_time_t
+      RTTVariance() const
+      {
+        return m_RTTVar;
+      }
+
+      uint64_t
+      LossEvents() const
+      {
+        return m_LossEvents;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      void
+      Refill(llarp_time_t now);
+
+      double m_Window = InitialWindow;
+      double m_SSThresh = MaxWindow;
+      /// window before the last decrease
+      double m_WindowMax = 0;
+      /// when the current cubic growth epoch started
+      llarp_time_t m_EpochStart = 0s;
+      llarp_time_t m_LastLoss = 0s;
+      llarp_time_t m_SRTT = 0s;
+      llarp_time_t m_RTTVar = 0s;
+      llarp_time_t m_MinRTT = 0s;
+      double m_Tokens = MaxBurst;
+      llarp_time_t m_LastRefill = 0s;
+      uint64_t m_LossEvents = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
+
+#endif
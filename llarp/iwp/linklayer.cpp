@@ -24,7 +24,9 @@ namespace llarp
         : ILinkLayer(
             keyManager, getrc, h, sign, before, est, reneg, timeout, closed, pumpDone, worker)
         , permitInbound{allowInbound}
-    {}
+    {
+      m_CookieSecret.Randomize();
+    }
 
     LinkLayer::~LinkLayer() = default;
 
@@ -40,39 +42,380 @@ namespace llarp
       return 2;
     }
 
-    void
-    LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+    std::shared_ptr<ILinkSession>
+    LinkLayer::SessionFor(const SockAddr& from, const llarp_buffer_t& pkt, bool& isNewSession)
     {
-      std::shared_ptr<ILinkSession> session;
-      auto itr = m_AuthedAddrs.find(from);
-      bool isNewSession = false;
+      isNewSession = false;
+      const EndpointKey key{from};
+      auto itr = m_AuthedAddrs.find(key);
       if (itr == m_AuthedAddrs.end())
       {
+        {
+          Lock_t lock(m_PendingMutex);
+          auto pending = m_Pending.find(key);
+          if (pending != m_Pending.end())
+            return pending->second;
+        }
+        if (auto moved = MovedSessionFor(from, pkt))
+          return moved;
         Lock_t lock(m_PendingMutex);
-        if (m_Pending.count(from) == 0)
+        if (not permitInbound)
+          return nullptr;
+        if (not AllowNewSession(from, pkt, m_Pending.size()))
+          return nullptr;
+        isNewSession = true;
+        auto session = std::make_shared<Session>(this, from);
+        m_Pending.insert({key, session});
+        return session;
+      }
+      Lock_t lock(m_AuthedLinksMutex);
+      auto range = m_AuthedLinks.equal_range(itr->second);
+      return range.first->second;
+    }
+
+    std::shared_ptr<ILinkSession>
+    LinkLayer::MovedSessionFor(const SockAddr& from, const llarp_buffer_t& pkt)
+    {
+      const auto now = Now();
+      const EndpointKey key{from};
+      auto itr = m_Migrating.find(key);
+      if (itr != m_Migrating.end())
+      {
+        if (now < itr->second.expires)
         {
-          if (not permitInbound)
-            return;
-          isNewSession = true;
-          m_Pending.insert({from, std::make_shared<Session>(this, from)});
+          if (auto session = itr->second.session.lock())
+            return session;
         }
-        session = m_Pending.find(from)->second;
+        m_Migrating.erase(itr);
+      }
+      // handshakes are keyed for no session, they would only spend our budget
+      const size_t sz = pkt.sz - std::min(pkt.sz, PacketOverhead);
+      if (pkt.sz < PacketOverhead + CommandOverhead or sz == Introduction::SIZE
+          or sz == Introduction::SIZE + Cookie_t::SIZE or sz == Resumption::SIZE)
+        return nullptr;
+      if (now - m_MigrationWindow >= 1s)
+      {
+        m_MigrationWindow = now;
+        m_MigrationChecks = 0;
       }
-      else
+      if (m_MigrationChecks >= MaxMigrationChecks)
+        return nullptr;
+      m_MigrationChecks++;
+      std::shared_ptr<ILinkSession> found;
       {
         Lock_t lock(m_AuthedLinksMutex);
-        auto range = m_AuthedLinks.equal_range(itr->second);
-        session = range.first->second;
+        for (const auto& item : m_AuthedLinks)
+        {
+          if (static_cast<const Session*>(item.second.get())->Authenticates(pkt))
+          {
+            found = item.second;
+            break;
+          }
+        }
+      }
+      if (found == nullptr)
+        return nullptr;
+      // the budget bounds how many can be live, the rest only wait to be swept
+      if (m_Migrating.size() >= MaxMigrationChecks)
+      {
+        for (auto mitr = m_Migrating.begin(); mitr != m_Migrating.end();)
+        {
+          if (now >= mitr->second.expires)
+            mitr = m_Migrating.erase(mitr);
+          else
+            ++mitr;
+        }
+      }
+      m_Migrating[key] = Migration{found, now + PathChallengeTimeout};
+      static_cast<Session*>(found.get())->ChallengeAddress(from);
+      return found;
+    }
+
+    void
+    LinkLayer::Migrated(ILinkSession* s, const IpAddress& from, const IpAddress& to)
+    {
+      m_AuthedAddrs.erase(EndpointKey{from});
+      m_AuthedAddrs[EndpointKey{to}] = s->GetPubKey();
+      for (auto itr = m_Migrating.begin(); itr != m_Migrating.end();)
+      {
+        auto session = itr->second.session.lock();
+        if (session == nullptr or session.get() == s)
+          itr = m_Migrating.erase(itr);
+        else
+          ++itr;
+      }
+      m_Migrated++;
+    }
+
+    /// what remotes key their intros to us with
+    static SharedSecret
+    IntroKeyFor(const PubKey& pk)
+    {
+      SharedSecret key;
+      CryptoManager::instance()->shorthash(key, llarp_buffer_t(pk));
+      return key;
+    }
+
+    bool
+    LinkLayer::AllowNewSession(const SockAddr& from, const llarp_buffer_t& pkt, size_t pending)
+    {
+      if (pending < CookiePendingThreshold)
+      {
+        if (m_RequireCookies)
+          LogInfo(Name(), " pending sessions are under ", CookiePendingThreshold, ", cookies off");
+        m_RequireCookies = false;
+        return true;
+      }
+      if (not m_RequireCookies)
+        LogWarn(Name(), " has ", pending, " pending sessions, new ones must send a cookie");
+      m_RequireCookies = true;
+
+      // anything that is not an intro to us gets no answer, so we never reflect junk. all this
+      // is symmetric crypto, the signature check and dh wait until the remote has a cookie
+      if (pkt.sz < Introduction::SIZE + PacketOverhead)
+        return false;
+      auto crypto = CryptoManager::instance();
+      const auto key = IntroKeyFor(GetOurRC().pubkey);
+      ShortHash H;
+      const llarp_buffer_t macbuf(pkt.base + HMACSIZE, pkt.sz - HMACSIZE);
+      if (not crypto->hmac(H.data(), macbuf, key) or H != ShortHash{pkt.base})
+        return false;
+
+      const uint64_t interval = Now() / CookieInterval;
+      if (pkt.sz == Resumption::SIZE + PacketOverhead)
+      {
+        // a good ticket costs us no more than a cookie would, so it needs none
+        std::vector<byte_t> body(pkt.base + PacketOverhead, pkt.base + pkt.sz);
+        if (not crypto->xchacha20(llarp_buffer_t(body), key, TunnelNonce{pkt.base + HMACSIZE}))
+          return false;
+        PubKey ident;
+        SharedSecret secret;
+        if (OpenTicket(Ticket_t{body.data()}, ident, secret, false))
+          return true;
+      }
+      else if (pkt.sz >= Introduction::SIZE + Cookie_t::SIZE + PacketOverhead)
+      {
+        // the session opens the intro again for itself if we let it in
+        std::vector<byte_t> body(pkt.base + PacketOverhead, pkt.base + pkt.sz);
+        if (not crypto->xchacha20(llarp_buffer_t(body), key, TunnelNonce{pkt.base + HMACSIZE}))
+          return false;
+        const Cookie_t cookie{body.data() + Introduction::SIZE};
+        if (cookie == MakeCookie(from, interval) or cookie == MakeCookie(from, interval - 1))
+          return true;
+      }
+      SendCookie(from, MakeCookie(from, interval));
+      return false;
+    }
+
+    Cookie_t
+    LinkLayer::MakeCookie(const SockAddr& from, uint64_t interval) const
+    {
+      const std::string material = from.toString() + "/" + std::to_string(interval);
+      ShortHash H;
+      CryptoManager::instance()->hmac(H.data(), llarp_buffer_t(material), m_CookieSecret);
+      return Cookie_t{H.data()};
+    }
+
+    SharedSecret
+    LinkLayer::TicketKey(uint64_t interval) const
+    {
+      const std::string material = "ticket/" + std::to_string(interval);
+      SharedSecret key;
+      CryptoManager::instance()->hmac(key.data(), llarp_buffer_t(material), m_CookieSecret);
+      return key;
+    }
+
+    Ticket_t
+    LinkLayer::MakeTicket(const PubKey& ident, const SharedSecret& secret) const
+    {
+      auto crypto = CryptoManager::instance();
+      const auto now = Now();
+      const auto key = TicketKey(now / TicketLifetime);
+      Ticket_t ticket;
+      byte_t* ptr = ticket.data();
+      crypto->randbytes(ptr, TunnelNonce::SIZE);
+      const TunnelNonce N{ptr};
+      ptr += TunnelNonce::SIZE;
+      byte_t* const body = ptr;
+      std::copy_n(ident.data(), PubKey::SIZE, ptr);
+      ptr += PubKey::SIZE;
+      std::copy_n(secret.data(), SharedSecret::SIZE, ptr);
+      ptr += SharedSecret::SIZE;
+      htobe64buf(ptr, (now + TicketLifetime).count());
+      ptr += sizeof(uint64_t);
+      crypto->xchacha20(llarp_buffer_t(body, ptr - body), key, N);
+      crypto->hmac(ptr, llarp_buffer_t(ticket.data(), ptr - ticket.data()), key);
+      return ticket;
+    }
+
+    bool
+    LinkLayer::OpenTicket(const Ticket_t& ticket, PubKey& ident, SharedSecret& secret, bool consume)
+    {
+      auto crypto = CryptoManager::instance();
+      const auto now = Now();
+      const size_t sealedSize = Ticket_t::SIZE - ShortHash::SIZE;
+      const llarp_buffer_t macbuf(ticket.data(), sealedSize);
+      const ShortHash expected{ticket.data() + sealedSize};
+      // sealed in this interval or the one before, which is all a lifetime can span
+      const uint64_t interval = now / TicketLifetime;
+      SharedSecret key;
+      ShortHash H;
+      bool found = false;
+      for (const auto i : {interval, interval - 1})
+      {
+        key = TicketKey(i);
+        if (crypto->hmac(H.data(), macbuf, key) and H == expected)
+        {
+          found = true;
+          break;
+        }
       }
-      if (session)
+      if (not found)
+        return false;
+      const TunnelNonce N{ticket.data()};
+      std::array<byte_t, PubKey::SIZE + SharedSecret::SIZE + sizeof(uint64_t)> body;
+      std::copy_n(ticket.data() + TunnelNonce::SIZE, body.size(), body.data());
+      if (not crypto->xchacha20(llarp_buffer_t(body), key, N))
+        return false;
+      const llarp_time_t expires{bufbe64toh(body.data() + PubKey::SIZE + SharedSecret::SIZE)};
+      if (now >= expires or m_UsedTickets.count(N))
+        return false;
+      if (consume)
+      {
+        if (m_UsedTickets.size() >= MaxTickets)
+        {
+          for (auto itr = m_UsedTickets.begin(); itr != m_UsedTickets.end();)
+          {
+            if (now >= itr->second)
+              itr = m_UsedTickets.erase(itr);
+            else
+              ++itr;
+          }
+        }
+        // we must not forget a ticket before it expires, past this the remote does a full intro
+        if (m_UsedTickets.size() >= MaxTickets)
+          return false;
+        m_UsedTickets.emplace(N, expires);
+        m_Resumed++;
+      }
+      std::copy_n(body.data(), PubKey::SIZE, ident.data());
+      std::copy_n(body.data() + PubKey::SIZE, SharedSecret::SIZE, secret.data());
+      return true;
+    }
+
+    void
+    LinkLayer::PutTicket(const RouterID& remote, const Ticket_t& ticket, const SharedSecret& secret)
+    {
+      const auto now = Now();
+      if (m_Tickets.size() >= MaxTickets and m_Tickets.count(remote) == 0)
       {
-        bool success = session->Recv_LL(std::move(pkt));
-        if (!success and isNewSession)
+        for (auto itr = m_Tickets.begin(); itr != m_Tickets.end();)
         {
-          LogWarn("Brand new session failed; removing from pending sessions list");
-          m_Pending.erase(m_Pending.find(from));
+          if (now >= itr->second.expires)
+            itr = m_Tickets.erase(itr);
+          else
+            ++itr;
         }
+        if (m_Tickets.size() >= MaxTickets)
+          m_Tickets.erase(m_Tickets.begin());
       }
+      m_Tickets[remote] = HeldTicket{ticket, secret, now + TicketLifetime};
+    }
+
+    std::optional<std::pair<Ticket_t, SharedSecret>>
+    LinkLayer::TakeTicket(const RouterID& remote)
+    {
+      auto itr = m_Tickets.find(remote);
+      if (itr == m_Tickets.end())
+        return std::nullopt;
+      auto held = std::move(itr->second);
+      m_Tickets.erase(itr);
+      if (Now() >= held.expires)
+        return std::nullopt;
+      return std::make_pair(held.ticket, held.secret);
+    }
+
+    void
+    LinkLayer::SendCookie(const SockAddr& from, const Cookie_t& cookie)
+    {
+      // sealed like an intro ack but under the intro key, the remote has no session key yet
+      auto crypto = CryptoManager::instance();
+      const auto key = IntroKeyFor(GetOurRC().pubkey);
+      ILinkSession::Packet_t pkt(Cookie_t::SIZE + PacketOverhead);
+      crypto->randbytes(pkt.data() + HMACSIZE, TUNNONCESIZE);
+      std::copy_n(cookie.data(), cookie.size(), pkt.data() + PacketOverhead);
+      const llarp_buffer_t body(pkt.data() + PacketOverhead, Cookie_t::SIZE);
+      if (not crypto->xchacha20(body, key, TunnelNonce{pkt.data() + HMACSIZE}))
+        return;
+      const llarp_buffer_t macbuf(pkt.data() + HMACSIZE, pkt.size() - HMACSIZE);
+      if (not crypto->hmac(pkt.data(), macbuf, key))
+        return;
+      LogDebug("sent cookie to ", from);
+      SendTo_LL(from, llarp_buffer_t(pkt));
+    }
+
+    bool
+    LinkLayer::DeliverTo(
+        const std::shared_ptr<ILinkSession>& session,
+        const SockAddr& from,
+        ILinkSession::Packet_t pkt,
+        bool isNewSession)
+    {
+      bool success = session->Recv_LL(std::move(pkt));
+      if (!success and isNewSession)
+      {
+        LogWarn("Brand new session failed; removing from pending sessions list");
+        m_Pending.erase(m_Pending.find(EndpointKey{from}));
+        return false;
+      }
+      return true;
+    }
+
+    void
+    LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+    {
+      bool isNewSession = false;
+      if (auto session = SessionFor(from, llarp_buffer_t(pkt), isNewSession))
+        DeliverTo(session, from, std::move(pkt), isNewSession);
+    }
+
+    void
+    LinkLayer::RecvBurst(const llarp_udp_pkt* pkts, size_t num)
+    {
+      // a burst is usually many datagrams from a handful of peers, so only look up the session
+      // again when the source address changes
+      std::shared_ptr<ILinkSession> session;
+      const SockAddr* last = nullptr;
+      bool isNewSession = false;
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto& from = pkts[idx].addr;
+        if (last == nullptr or not(*last == from))
+        {
+          session = SessionFor(from, llarp_buffer_t(pkts[idx].data, pkts[idx].sz), isNewSession);
+          last = &from;
+        }
+        if (session == nullptr)
+          continue;
+        ILinkSession::Packet_t pkt(pkts[idx].data, pkts[idx].data + pkts[idx].sz);
+        if (not DeliverTo(session, from, std::move(pkt), isNewSession))
+        {
+          session = nullptr;
+          last = nullptr;
+        }
+        isNewSession = false;
+      }
+    }
+
+    void
+    LinkLayer::RestoreSession(const SockAddr& from, const RouterID& remote, const SharedSecret& key)
+    {
+      auto session = std::make_shared<Session>(this, from);
+      {
+        Lock_t lock(m_PendingMutex);
+        m_Pending.insert({EndpointKey{from}, session});
+      }
+      session->RestoreForReplay(remote, key);
     }
 
     bool
@@ -80,14 +423,42 @@ namespace llarp
     {
       if (!ILinkLayer::MapAddr(r, s))
         return false;
-      m_AuthedAddrs.emplace(s->GetRemoteEndpoint(), r);
+      m_AuthedAddrs.emplace(EndpointKey{s->GetRemoteEndpoint()}, r);
       return true;
     }
 
     void
     LinkLayer::UnmapAddr(const IpAddress& addr)
     {
-      m_AuthedAddrs.erase(addr);
+      m_AuthedAddrs.erase(EndpointKey{addr});
+    }
+
+    bool
+    LinkLayer::QueueHandshake(Work_t work, bool shed)
+    {
+      if (shed and m_HandshakesQueued >= MaxQueuedHandshakes)
+      {
+        m_HandshakesShed++;
+        return false;
+      }
+      m_HandshakesQueued++;
+      QueueWork([this, work = std::move(work)]() {
+        work();
+        m_HandshakesQueued--;
+      });
+      return true;
+    }
+
+    util::StatusObject
+    LinkLayer::ExtractStatus() const
+    {
+      auto status = ILinkLayer::ExtractStatus();
+      status["handshakes"] = util::StatusObject{
+          {"queued", uint64_t{m_HandshakesQueued.load()}}, {"shed", m_HandshakesShed.load()}};
+      status["tickets"] = util::StatusObject{
+          {"held", uint64_t{m_Tickets.size()}}, {"resumed", m_Resumed}};
+      status["migrated"] = m_Migrated;
+      return status;
     }
 
     std::shared_ptr<ILinkSession>
@@ -8,12 +8,37 @@
 #include <link/server.hpp>
 #include <config/key_manager.hpp>
 
+#include <atomic>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 namespace llarp
 {
   namespace iwp
   {
+    /// a stateless proof that an intro came from the address it claims, we ask for one before
+    /// keeping any state for a new remote while we are under a handshake flood
+    using Cookie_t = AlignedBuffer<24>;
+    /// pending inbound sessions at which new intros must carry a cookie
+    static constexpr size_t CookiePendingThreshold = 32;
+    /// how long a cookie is good for, one more interval is allowed for the round trip
+    static constexpr auto CookieInterval = 10s;
+    /// what a remote sends instead of an intro to resume a session with us, sealed under a key
+    /// only we know: a nonce, then its identity key, the secret both ends derived from the old
+    /// session and when the ticket expires, then a keyed hash over all of that
+    using Ticket_t = AlignedBuffer<
+        TunnelNonce::SIZE + PubKey::SIZE + SharedSecret::SIZE + sizeof(uint64_t) + ShortHash::SIZE>;
+    /// how long a ticket is good for, the key we seal them under changes this often
+    static constexpr auto TicketLifetime = 1h;
+    /// tickets we hold for remotes, and used ones we remember so each opens once
+    static constexpr size_t MaxTickets = 1024;
+    /// times a second we look for the session a packet from an address we do not know is keyed
+    /// for, each look costs a keyed hash per established session
+    static constexpr size_t MaxMigrationChecks = 64;
+    /// handshakes waiting on workers past which we drop new inbound intros
+    static constexpr size_t MaxQueuedHandshakes = 256;
+
     struct LinkLayer final : public ILinkLayer
     {
       LinkLayer(
@@ -44,15 +69,115 @@ namespace llarp
       void
       RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) override;
 
+      void
+      RecvBurst(const llarp_udp_pkt* pkts, size_t num) override;
+
       bool
       MapAddr(const RouterID& pk, ILinkSession* s) override;
 
       void
       UnmapAddr(const IpAddress& addr);
 
+      /// a remote proved it moved from one address to another, packets from the new one go to
+      /// its session from here on
+      void
+      Migrated(ILinkSession* s, const IpAddress& from, const IpAddress& to);
+
+      /// add a ready session for from keyed as a capture logged it, to replay that capture
+      void
+      RestoreSession(const SockAddr& from, const RouterID& remote, const SharedSecret& key);
+
+      /// run handshake crypto on a worker, false if shed is set and too many are queued
+      bool
+      QueueHandshake(Work_t work, bool shed);
+
+      util::StatusObject
+      ExtractStatus() const override;
+
+      /// seal a ticket for a remote that has a session with us to resume it later
+      Ticket_t
+      MakeTicket(const PubKey& ident, const SharedSecret& secret) const;
+
+      /// open a ticket a remote resumes with, false if it is not one of ours, expired or
+      /// already used. consume marks it used
+      bool
+      OpenTicket(const Ticket_t& ticket, PubKey& ident, SharedSecret& secret, bool consume);
+
+      /// hold a ticket a remote gave us for the next time we connect to it
+      void
+      PutTicket(const RouterID& remote, const Ticket_t& ticket, const SharedSecret& secret);
+
+      /// take the ticket we hold for a remote, if there is one that is still good
+      std::optional<std::pair<Ticket_t, SharedSecret>>
+      TakeTicket(const RouterID& remote);
+
      private:
-      std::unordered_map<IpAddress, RouterID, IpAddress::Hash> m_AuthedAddrs;
+      /// find the session for a remote address, creating a pending inbound session if allowed
+      std::shared_ptr<ILinkSession>
+      SessionFor(const SockAddr& from, const llarp_buffer_t& pkt, bool& isNewSession)
+          EXCLUDES(m_PendingMutex);
+
+      /// the established session a packet from an address we do not know is keyed for, the remote
+      /// behind it may have moved. we send it the packets from there while it checks
+      std::shared_ptr<ILinkSession>
+      MovedSessionFor(const SockAddr& from, const llarp_buffer_t& pkt)
+          EXCLUDES(m_AuthedLinksMutex);
+
+      /// true if a first packet from a remote we have no session with may make one, with
+      /// pending sessions waiting already. past the threshold a well formed intro that lacks a
+      /// good cookie is answered with one and dropped
+      bool
+      AllowNewSession(const SockAddr& from, const llarp_buffer_t& pkt, size_t pending);
+
+      /// the key our tickets from an interval are sealed under
+      SharedSecret
+      TicketKey(uint64_t interval) const;
+
+      /// the cookie for a remote address in an interval, from the secret only we know
+      Cookie_t
+      MakeCookie(const SockAddr& from, uint64_t interval) const;
+
+      void
+      SendCookie(const SockAddr& from, const Cookie_t& cookie);
+
+      /// hand a packet to a session, dropping brand new sessions that reject their first packet
+      /// returns false if the session was dropped
+      bool
+      DeliverTo(
+          const std::shared_ptr<ILinkSession>& session,
+          const SockAddr& from,
+          ILinkSession::Packet_t pkt,
+          bool isNewSession);
+
+      std::unordered_map<EndpointKey, RouterID, EndpointKey::Hash> m_AuthedAddrs;
       const bool permitInbound;
+      /// keys our cookies, never leaves this process
+      SharedSecret m_CookieSecret;
+      /// set while we are over the threshold, so we log when it changes
+      bool m_RequireCookies = false;
+      struct HeldTicket
+      {
+        Ticket_t ticket;
+        SharedSecret secret;
+        llarp_time_t expires;
+      };
+      /// tickets remotes gave us
+      std::unordered_map<RouterID, HeldTicket, RouterID::Hash> m_Tickets;
+      /// nonces of tickets remotes resumed with, until the tickets expire
+      std::unordered_map<TunnelNonce, llarp_time_t, TunnelNonce::Hash> m_UsedTickets;
+      uint64_t m_Resumed = 0;
+      struct Migration
+      {
+        std::weak_ptr<ILinkSession> session;
+        llarp_time_t expires;
+      };
+      /// addresses established sessions were asked to prove they moved to
+      std::unordered_map<EndpointKey, Migration, EndpointKey::Hash> m_Migrating;
+      llarp_time_t m_MigrationWindow = 0s;
+      size_t m_MigrationChecks = 0;
+      uint64_t m_Migrated = 0;
+      std::atomic<size_t> m_HandshakesQueued{0};
+      std::atomic<uint64_t> m_HandshakesShed{0};
     };
 
     using LinkLayer_ptr = std::shared_ptr<LinkLayer>;
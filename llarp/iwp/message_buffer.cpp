@@ -1,31 +1,53 @@
 #include <iwp/message_buffer.hpp>
 #include <iwp/session.hpp>
-#include <crypto/crypto.hpp>
+#include <crypto/hot_crypto.hpp>
 
 namespace llarp
 {
   namespace iwp
   {
+    std::vector<std::pair<uint16_t, uint16_t>>
+    AckRanges(const FragmentBits& acks, size_t numFragments)
+    {
+      std::vector<std::pair<uint16_t, uint16_t>> ranges;
+      size_t idx = 0;
+      while (idx < numFragments)
+      {
+        if (not acks.test(idx))
+        {
+          ++idx;
+          continue;
+        }
+        const size_t start = idx;
+        while (idx < numFragments and acks.test(idx))
+          ++idx;
+        ranges.emplace_back(start, idx - start);
+      }
+      return ranges;
+    }
+
     OutboundMessage::OutboundMessage(
         uint64_t msgid,
         ILinkSession::Message_t msg,
         llarp_time_t now,
-        ILinkSession::CompletionHandler handler)
+        ILinkSession::CompletionHandler handler,
+        size_t fragsz)
         : m_Data{std::move(msg)}
         , m_MsgID{msgid}
+        , m_FragSize{fragsz}
         , m_Completed{handler}
         , m_LastFlush{now}
         , m_StartedAt{now}
     {
       const llarp_buffer_t buf(m_Data);
-      CryptoManager::instance()->shorthash(m_Digest, buf);
+      HotCrypto()->shorthash(m_Digest, buf);
       m_Acks.set(0);
     }
 
     ILinkSession::Packet_t
     OutboundMessage::XMIT() const
     {
-      size_t extra = std::min(m_Data.size(), FragmentSize);
+      size_t extra = std::min(m_Data.size(), m_FragSize);
       auto xmit = CreatePacket(Command::eXMIT, 10 + 32 + extra, 0, 0);
       htobe16buf(xmit.data() + CommandOverhead + PacketOverhead, m_Data.size());
       htobe64buf(xmit.data() + 2 + CommandOverhead + PacketOverhead, m_MsgID);
@@ -46,20 +68,87 @@ namespace llarp
     }
 
     bool
-    OutboundMessage::ShouldFlush(llarp_time_t now) const
+    OutboundMessage::ShouldFlush(llarp_time_t now, llarp_time_t interval) const
+    {
+      return m_Transmitted and now - m_LastFlush >= interval;
+    }
+
+    size_t
+    OutboundMessage::NumPackets() const
+    {
+      return std::max(size_t{1}, (m_Data.size() + m_FragSize - 1) / m_FragSize);
+    }
+
+    size_t
+    OutboundMessage::InFlight() const
+    {
+      if (not m_Transmitted)
+        return 0;
+      size_t num = 1;
+      for (size_t idx = 1; idx < NumPackets(); ++idx)
+      {
+        if (not m_Acks.test(idx))
+          num++;
+      }
+      return num;
+    }
+
+    void
+    OutboundMessage::Transmit(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
     {
-      return now - m_LastFlush >= TXFlushInterval;
+      sendpkt(XMIT());
+      if (m_Data.size() > m_FragSize)
+        FlushUnAcked(sendpkt, now);
+      m_Transmitted = true;
+      m_SentAt = now;
+      m_LastFlush = now;
     }
 
     void
-    OutboundMessage::Ack(byte_t bitmask)
+    OutboundMessage::Ack(const FragmentBits& acks)
+    {
+      // the remote never forgets a fragment, an older ack report can only have fewer set
+      m_Acks |= acks;
+    }
+
+    FragmentBits
+    OutboundMessage::FindLost(llarp_time_t now, llarp_time_t minAge)
     {
-      m_Acks = std::bitset<8>(bitmask);
+      FragmentBits lost;
+      const auto num = NumPackets();
+      size_t above = 0;
+      for (size_t idx = num; idx-- > 1;)
+      {
+        if (m_Acks.test(idx))
+        {
+          above++;
+          continue;
+        }
+        if (above == 0)
+          continue;
+        // acked fragments after this one means it was skipped rather than still in transit
+        if (m_HoleReports[idx] < 0xff)
+          m_HoleReports[idx]++;
+        const bool enough = m_HoleReports[idx] >= DupAckThreshold or above >= ReorderThreshold;
+        if (enough and now - m_FragSentAt[idx] >= minAge)
+          lost.set(idx);
+      }
+      return lost;
     }
 
     void
     OutboundMessage::FlushUnAcked(
         std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    {
+      RetransmitFragments(~m_Acks, std::move(sendpkt), now);
+      m_LastFlush = now;
+    }
+
+    void
+    OutboundMessage::RetransmitFragments(
+        const FragmentBits& frags,
+        std::function<void(ILinkSession::Packet_t)> sendpkt,
+        llarp_time_t now)
     {
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
@@ -67,9 +156,12 @@ namespace llarp
       const auto datasz = m_Data.size();
       while (idx < datasz)
       {
-        if (not m_Acks[idx / FragmentSize])
+        const auto fragidx = idx / m_FragSize;
+        if (frags.test(fragidx) and not m_Acks.test(fragidx))
         {
-          const size_t fragsz = idx + FragmentSize < datasz ? FragmentSize : datasz - idx;
+          m_FragSentAt[fragidx] = now;
+          m_HoleReports[fragidx] = 0;
+          const size_t fragsz = std::min(m_FragSize, datasz - idx);
           auto frag = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
           htobe16buf(frag.data() + 2 + PacketOverhead, idx);
           htobe64buf(frag.data() + 4 + PacketOverhead, m_MsgID);
@@ -79,18 +171,17 @@ namespace llarp
               frag.data() + PacketOverhead + Overhead + 2);
           sendpkt(std::move(frag));
         }
-        idx += FragmentSize;
+        idx += m_FragSize;
       }
-      m_LastFlush = now;
     }
 
     bool
     OutboundMessage::IsTransmitted() const
     {
       const auto sz = m_Data.size();
-      for (uint16_t idx = 0; idx < sz; idx += FragmentSize)
+      for (uint16_t idx = 0; idx < sz; idx += m_FragSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragSize))
           return false;
       }
       return true;
@@ -113,23 +204,47 @@ namespace llarp
       m_Completed = nullptr;
     }
 
-    InboundMessage::InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now)
-        : m_Data(size_t{sz}), m_Digset{std::move(h)}, m_MsgID(msgid), m_LastActiveAt{now}
+    InboundMessage::InboundMessage(
+        uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now, size_t fragsz)
+        : m_Data(size_t{sz})
+        , m_Digset{std::move(h)}
+        , m_MsgID(msgid)
+        , m_FragSize{fragsz}
+        , m_LastActiveAt{now}
     {}
 
-    void
+    bool
     InboundMessage::HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now)
     {
       if (idx + buf.sz > m_Data.size())
       {
         LogWarn("invalid fragment offset ", idx);
-        return;
+        return false;
       }
       byte_t* dst = m_Data.data() + idx;
       std::copy_n(buf.base, buf.sz, dst);
-      m_Acks.set(idx / FragmentSize);
-      LogDebug("got fragment ", idx / FragmentSize);
+      const size_t fragidx = idx / m_FragSize;
+      const bool dupe = m_Acks.test(fragidx);
+      m_Acks.set(fragidx);
+      LogDebug("got fragment ", fragidx);
       m_LastActiveAt = now;
+      if (dupe)
+        return false;
+      for (size_t n = 0; n < fragidx; ++n)
+      {
+        if (not m_Acks.test(n))
+        {
+          m_ACKNow = true;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    size_t
+    InboundMessage::NumFragments() const
+    {
+      return std::max(size_t{1}, (m_Data.size() + m_FragSize - 1) / m_FragSize);
     }
 
     ILinkSession::Packet_t
@@ -141,19 +256,37 @@ namespace llarp
       return acks;
     }
 
+    ILinkSession::Packet_t
+    InboundMessage::SACK() const
+    {
+      const auto ranges = AckRanges(m_Acks, NumFragments());
+      auto sack = CreatePacket(Command::eSACK, 9 + (ranges.size() * 4));
+      byte_t* ptr = sack.data() + CommandOverhead + PacketOverhead;
+      htobe64buf(ptr, m_MsgID);
+      ptr += sizeof(uint64_t);
+      *ptr++ = static_cast<byte_t>(ranges.size());
+      for (const auto& [start, len] : ranges)
+      {
+        htobe16buf(ptr, start);
+        htobe16buf(ptr + sizeof(uint16_t), len);
+        ptr += 2 * sizeof(uint16_t);
+      }
+      return sack;
+    }
+
     byte_t
     InboundMessage::AcksBitmask() const
     {
-      return byte_t{(byte_t)m_Acks.to_ulong()};
+      return byte_t{(byte_t)(m_Acks.to_ulong() & 0xff)};
     }
 
     bool
     InboundMessage::IsCompleted() const
     {
       const auto sz = m_Data.size();
-      for (size_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx < sz; idx += m_FragSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragSize))
           return false;
       }
       return true;
@@ -162,7 +295,7 @@ namespace llarp
     bool
     InboundMessage::ShouldSendACKS(llarp_time_t now) const
     {
-      return now > m_LastACKSent + ACKResendInterval;
+      return m_ACKNow or now > m_LastACKSent + ACKResendInterval;
     }
 
     bool
@@ -172,9 +305,9 @@ namespace llarp
     }
 
     void
-    InboundMessage::SendACKS(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    InboundMessage::ACKSSent(llarp_time_t now)
     {
-      sendpkt(ACKS());
+      m_ACKNow = false;
       m_LastACKSent = now;
     }
 
@@ -183,7 +316,7 @@ namespace llarp
     {
       ShortHash gotten;
       const llarp_buffer_t buf(m_Data);
-      CryptoManager::instance()->shorthash(gotten, buf);
+      HotCrypto()->shorthash(gotten, buf);
       return gotten == m_Digset;
     }
   }  // namespace iwp
@@ -1,5 +1,7 @@
 #ifndef LLARP_IWP_MESSAGE_BUFFER_HPP
 #define LLARP_IWP_MESSAGE_BUFFER_HPP
+#include <array>
+#include <bitset>
 #include <vector>
 #include <constants/link_layer.hpp>
 #include <link/session.hpp>
@@ -25,14 +27,35 @@ namespace llarp
       eNACK = 4,
       /// multiack
       eMACK = 5,
+      /// selective acknowledge fragments as ranges
+      eSACK = 6,
       /// close session
       eCLOS = 0xff,
     };
 
-    /// max size of data fragments
+    /// size of data fragments until path mtu probing finds a bigger one, and what peers that
+    /// do not probe always send
     static constexpr size_t FragmentSize = 1024;
+    /// fragment sizes we probe for in order, the largest puts an XMIT right at a 1500 byte mtu
+    /// over ipv6
+    static constexpr std::array<size_t, 4> FragmentSizes = {FragmentSize, 1152, 1280, 1344};
+    static constexpr size_t MaxFragmentSize = FragmentSizes.back();
     /// plaintext header overhead size
     static constexpr size_t CommandOverhead = 2;
+    /// most fragments a message can have, at the smallest fragment size
+    static constexpr size_t MaxFragments = MAX_LINK_MSG_SIZE / FragmentSize;
+    /// ack state of every fragment in a message
+    using FragmentBits = std::bitset<MaxFragments>;
+    /// most ranges we put in one eSACK, alternating fragments is the worst case
+    static constexpr size_t MaxSACKBlocks = (MaxFragments + 1) / 2;
+    /// how many ack reports of a hole below acked fragments before we resend it early
+    static constexpr size_t DupAckThreshold = 2;
+    /// how many acked fragments above a hole make it lost on their own
+    static constexpr size_t ReorderThreshold = 3;
+
+    /// encode acked fragments as (first fragment, number of fragments) ranges
+    std::vector<std::pair<uint16_t, uint16_t>>
+    AckRanges(const FragmentBits& acks, size_t numFragments);
 
     struct OutboundMessage
     {
@@ -41,27 +64,64 @@ namespace llarp
           uint64_t msgid,
           ILinkSession::Message_t data,
           llarp_time_t now,
-          ILinkSession::CompletionHandler handler);
+          ILinkSession::CompletionHandler handler,
+          size_t fragsz = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       uint64_t m_MsgID = 0;
-      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      /// what we cut it into, fixed once it is queued since the remote learns it from the XMIT
+      size_t m_FragSize = FragmentSize;
+      FragmentBits m_Acks;
+      /// how many ack reports showed each fragment missing below acked ones
+      std::array<uint8_t, MaxFragments> m_HoleReports{};
+      /// when we last put each fragment on the wire
+      std::array<llarp_time_t, MaxFragments> m_FragSentAt{};
       ILinkSession::CompletionHandler m_Completed;
       llarp_time_t m_LastFlush = 0s;
       ShortHash m_Digest;
       llarp_time_t m_StartedAt = 0s;
+      /// set once congestion control let us put it on the wire
+      bool m_Transmitted = false;
+      llarp_time_t m_SentAt = 0s;
+      /// how many times we resent unacked fragments
+      size_t m_Retransmits = 0;
 
       ILinkSession::Packet_t
       XMIT() const;
 
+      /// merge in the fragments the remote says it has
       void
-      Ack(byte_t bitmask);
+      Ack(const FragmentBits& acks);
+
+      /// find holes that we have enough evidence for to resend before the retransmit timeout
+      /// minAge keeps us from resending a fragment that cannot have been acked yet
+      FragmentBits
+      FindLost(llarp_time_t now, llarp_time_t minAge);
 
       void
       FlushUnAcked(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
 
+      /// resend just the given fragments
+      void
+      RetransmitFragments(
+          const FragmentBits& frags,
+          std::function<void(ILinkSession::Packet_t)> sendpkt,
+          llarp_time_t now);
+
+      /// send the XMIT and every fragment for the first time
+      void
+      Transmit(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+
       bool
-      ShouldFlush(llarp_time_t now) const;
+      ShouldFlush(llarp_time_t now, llarp_time_t interval) const;
+
+      /// number of datagrams it takes to send this message, the XMIT carries the first fragment
+      size_t
+      NumPackets() const;
+
+      /// number of datagrams sent and not acked yet
+      size_t
+      InFlight() const;
 
       void
       Completed();
@@ -79,16 +139,22 @@ namespace llarp
     struct InboundMessage
     {
       InboundMessage() = default;
-      InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now);
+      InboundMessage(
+          uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now, size_t fragsz = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       ShortHash m_Digset;
       uint64_t m_MsgID = 0;
+      /// what the remote cut it into, the size of the fragment in its XMIT
+      size_t m_FragSize = FragmentSize;
       llarp_time_t m_LastACKSent = 0s;
       llarp_time_t m_LastActiveAt = 0s;
-      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      FragmentBits m_Acks;
+      /// a fragment came in past a hole, ack right away so the sender can fast retransmit
+      bool m_ACKNow = false;
 
-      void
+      /// returns true if this fragment arrived after one before it went missing
+      bool
       HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now);
 
       bool
@@ -107,10 +173,18 @@ namespace llarp
       ShouldSendACKS(llarp_time_t now) const;
 
       void
-      SendACKS(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+      ACKSSent(llarp_time_t now);
 
+      size_t
+      NumFragments() const;
+
+      /// legacy single byte fragment ack
       ILinkSession::Packet_t
       ACKS() const;
+
+      /// fragment acks as ranges
+      ILinkSession::Packet_t
+      SACK() const;
     };
 
   }  // namespace iwp
@@ -1,13 +1,80 @@
 #include <iwp/session.hpp>
 
+#include <crypto/hot_crypto.hpp>
 #include <messages/link_intro.hpp>
 #include <messages/discard.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/meta/memfn.hpp>
+#include <util/padding.hpp>
+#include <util/tracy.hpp>
 
 namespace llarp
 {
   namespace iwp
   {
+    /// sits after the tag of an aes-256-gcm sealed packet where the rest of the keyed hash would
+    /// be, a keyed hash ends in it one time in 2^128
+    static constexpr std::array<byte_t, HMACSIZE - GCMTAGSIZE> AESGCMMarker = {
+        'i', 'w', 'p', ' ', 'a', 'e', 's', '-', '2', '5', '6', '-', 'g', 'c', 'm', 0};
+    /// starts a ping that carries our ciphers, pings from before this had random pad there
+    static constexpr std::array<byte_t, 8> CipherMagic = {'c', 'i', 'p', 'h', 'e', 'r', 's', ':'};
+    /// starts a ping padded out to the datagram an XMIT at the fragment size after it makes
+    static constexpr std::array<byte_t, 8> MTUProbeMagic = {'m', 't', 'u', 'p', 'r', 'o', 'b', 'e'};
+    /// starts a ping acking the probe for the fragment size after it
+    static constexpr std::array<byte_t, 8> MTUAckMagic = {'m', 't', 'u', 'a', 'c', 'k', 'e', 'd'};
+    /// starts a ping carrying a ticket to resume the session with later
+    static constexpr std::array<byte_t, 8> TicketMagic = {'t', 'i', 'c', 'k', 'e', 't', 's', ':'};
+    /// what both ends key a ticket's secret with
+    static constexpr std::array<byte_t, 10> ResumeLabel = {
+        'i', 'w', 'p', ' ', 'r', 'e', 's', 'u', 'm', 'e'};
+    /// starts a ping asking the address it went to to echo what follows
+    static constexpr std::array<byte_t, 8> PathChallengeMagic = {
+        'p', 'a', 't', 'h', 'c', 'h', 'a', 'l'};
+    /// starts a ping echoing a path challenge
+    static constexpr std::array<byte_t, 8> PathResponseMagic = {
+        'p', 'a', 't', 'h', 'r', 'e', 's', 'p'};
+    /// plaintext an XMIT has before its first fragment
+    static constexpr size_t XMITHeaderSize = sizeof(uint16_t) + sizeof(uint64_t) + ShortHash::SIZE;
+
+    /// true if the ping body starts with magic and has at least extra bytes after it
+    template <size_t N>
+    static bool
+    HasMagic(const std::array<byte_t, N>& magic, const byte_t* body, size_t sz, size_t extra)
+    {
+      return sz >= N + extra and std::equal(magic.begin(), magic.end(), body);
+    }
+
+    /// the secret a ticket for a session carries, both ends derive it from the session key so it
+    /// never goes over the wire
+    static SharedSecret
+    ResumeSecretFor(const SharedSecret& sessionKey)
+    {
+      SharedSecret secret;
+      HotCrypto()->hmac(secret.data(), llarp_buffer_t(ResumeLabel), sessionKey);
+      return secret;
+    }
+
+    /// the key a session resumed with nonce N runs under, fresh for every resumption
+    static SharedSecret
+    ResumedKeyFor(const SharedSecret& secret, const TunnelNonce& N)
+    {
+      SharedSecret key;
+      HotCrypto()->hmac(key.data(), llarp_buffer_t(N), secret);
+      return key;
+    }
+
+    static bool
+    IsAESGCM(const byte_t* pkt)
+    {
+      return std::equal(AESGCMMarker.begin(), AESGCMMarker.end(), pkt + GCMTAGSIZE);
+    }
+
+    static bool
+    IsAESGCM(const ILinkSession::Packet_t& pkt)
+    {
+      return IsAESGCM(pkt.data());
+    }
+
     ILinkSession::Packet_t
     CreatePacket(Command cmd, size_t plainsize, size_t minpad, size_t variance)
     {
@@ -23,21 +90,31 @@ namespace llarp
       CryptoManager::instance()->randbytes(pkt.data() + HMACSIZE, TUNNONCESIZE);
       pkt[PacketOverhead] = LLARP_PROTO_VERSION;
       pkt[PacketOverhead + 1] = cmd;
+      padding::CountLink(plainsize, pad);
       return pkt;
     }
 
+    ILinkSession::Packet_t
+    CreatePacket(Command cmd, size_t plainsize)
+    {
+      const auto pad = padding::LinkPadding(padding::LinkProfile());
+      return CreatePacket(cmd, plainsize, pad.min, pad.variance);
+    }
+
     Session::Session(LinkLayer* p, const RouterContact& rc, const AddressInfo& ai)
         : m_State{State::Initial}
         , m_Inbound{false}
         , m_Parent(p)
         , m_CreatedAt{p->Now()}
         , m_RemoteAddr(ai.toIpAddress())
+        , m_PeerAddr(m_RemoteAddr)
         , m_ChosenAI(ai)
         , m_RemoteRC(rc)
     {
       token.Zero();
       GotLIM = util::memFn(&Session::GotOutboundLIM, this);
-      CryptoManager::instance()->shorthash(m_SessionKey, llarp_buffer_t(rc.pubkey));
+      CryptoManager::instance()->shorthash(m_IntroKey, llarp_buffer_t(rc.pubkey));
+      m_SessionKey = m_IntroKey;
     }
 
     Session::Session(LinkLayer* p, const IpAddress& from)
@@ -46,6 +123,7 @@ namespace llarp
         , m_Parent(p)
         , m_CreatedAt{p->Now()}
         , m_RemoteAddr(from)
+        , m_PeerAddr(from)
     {
       token.Randomize();
       GotLIM = util::memFn(&Session::GotInboundLIM, this);
@@ -58,9 +136,9 @@ namespace llarp
     {
       LogDebug("send ", sz, " to ", m_RemoteAddr);
       const llarp_buffer_t pkt(buf, sz);
-      m_Parent->SendTo_LL(m_RemoteAddr.createSockAddr(), pkt);
-      m_LastTX = time_now_ms();
-      m_TXRate += sz;
+      m_Parent->SendTo_LL(m_PeerAddr.createSockAddr(), pkt);
+      m_LastTX = m_Parent->Now();
+      m_TXRate.Add(sz);
     }
 
     bool
@@ -76,6 +154,9 @@ namespace llarp
       GotLIM = util::memFn(&Session::GotRenegLIM, this);
       m_RemoteRC = msg->rc;
       m_Parent->MapAddr(m_RemoteRC.pubkey, this);
+      m_Parent->CaptureSessionKey(m_RemoteAddr.createSockAddr(), m_RemoteRC.pubkey, m_SessionKey);
+      AdvertiseCiphers();
+      SendTicket();
       return m_Parent->SessionEstablished(this, true);
     }
 
@@ -96,67 +177,239 @@ namespace llarp
         {
           self->m_State = State::Ready;
           self->m_Parent->MapAddr(self->m_RemoteRC.pubkey, self.get());
+          self->m_Parent->CaptureSessionKey(
+              self->m_RemoteAddr.createSockAddr(), self->m_RemoteRC.pubkey, self->m_SessionKey);
+          self->AdvertiseCiphers();
           self->m_Parent->SessionEstablished(self.get(), false);
         }
       });
       return true;
     }
 
+    void
+    Session::RestoreForReplay(const RouterID& remote, const SharedSecret& key)
+    {
+      m_RemoteRC.pubkey = PubKey{remote.as_array()};
+      m_SessionKey = key;
+      DeriveAESGCMKey();
+      m_State = State::Ready;
+      m_LastRX = m_Parent->Now();
+      GotLIM = util::memFn(&Session::GotRenegLIM, this);
+      m_Parent->MapAddr(remote, this);
+    }
+
     void
     Session::SendOurLIM(ILinkSession::CompletionHandler h)
     {
-      LinkIntroMessage msg;
-      msg.rc = m_Parent->GetOurRC();
-      msg.N.Randomize();
-      msg.P = 60000;
-      if (not msg.Sign(m_Parent->Sign))
-      {
-        LogError("failed to sign our RC for ", m_RemoteAddr);
+      auto msg = std::make_shared<LinkIntroMessage>();
+      msg->rc = m_Parent->GetOurRC();
+      msg->N.Randomize();
+      msg->P = 60000;
+      // signing is the slow part, the rest waits for it back on the logic thread
+      m_Parent->QueueHandshake(
+          [self = shared_from_this(), msg, h]() {
+            if (not msg->Sign(self->m_Parent->Sign))
+            {
+              LogError("failed to sign our RC for ", self->m_RemoteAddr);
+              return;
+            }
+            LogicCall(self->m_Parent->logic(), [self, msg, h]() { self->SendSignedLIM(*msg, h); });
+          },
+          false);
+    }
+
+    void
+    Session::SendSignedLIM(const LinkIntroMessage& msg, ILinkSession::CompletionHandler h)
+    {
+      if (m_State == State::Closed)
         return;
-      }
       ILinkSession::Message_t data(LinkIntroMessage::MaxSize + PacketOverhead);
       llarp_buffer_t buf(data);
       if (not msg.BEncode(&buf))
       {
         LogError("failed to encode LIM for ", m_RemoteAddr);
       }
-      if (!SendMessageBuffer(std::move(data), h))
+      if (!SendMessageBuffer(std::move(data), h, TrafficClass::Control))
       {
         LogError("failed to send LIM to ", m_RemoteAddr);
       }
       LogDebug("sent LIM to ", m_RemoteAddr);
     }
 
+    bool
+    Session::HandleLIM(const LinkIntroMessage* msg)
+    {
+      // the parser reuses its message, the check needs its own copy
+      auto lim = std::make_shared<LinkIntroMessage>(*msg);
+      m_LIMPending = true;
+      m_Parent->QueueHandshake(
+          [self = shared_from_this(), lim]() {
+            const bool valid = lim->Verify();
+            LogicCall(self->m_Parent->logic(), [self, lim, valid]() {
+              self->LIMChecked(*lim, valid);
+            });
+          },
+          false);
+      return true;
+    }
+
+    void
+    Session::LIMChecked(const LinkIntroMessage& msg, bool valid)
+    {
+      m_LIMPending = false;
+      if (m_State == State::Closed)
+        return;
+      if (not valid)
+        LogError("invalid LIM from ", m_RemoteAddr);
+      else
+        GotLIM(&msg);
+      // what came in behind the LIM was held so it is handled as from the peer the LIM names
+      auto held = std::move(m_HeldRX);
+      m_HeldRX.clear();
+      for (auto itr = held.begin(); itr != held.end(); ++itr)
+      {
+        if (m_LIMPending)
+        {
+          m_HeldRX.insert(
+              m_HeldRX.end(), std::make_move_iterator(itr), std::make_move_iterator(held.end()));
+          break;
+        }
+        m_Parent->HandleMessage(this, llarp_buffer_t(*itr));
+      }
+    }
+
+    void
+    Session::DeliverMessage(const llarp_buffer_t& buf)
+    {
+      if (not m_LIMPending)
+      {
+        m_Parent->HandleMessage(this, buf);
+        return;
+      }
+      if (m_HeldRX.size() >= MaxHeldMessages)
+      {
+        LogWarn("dropping message from ", m_RemoteAddr, " while its LIM is checked");
+        return;
+      }
+      m_HeldRX.emplace_back(buf.base, buf.base + buf.sz);
+    }
+
     void
     Session::EncryptAndSend(ILinkSession::Packet_t data)
     {
+      alloc::Scope allocScope{alloc::LinkBuffers};
       if (m_EncryptNext == nullptr)
+      {
         m_EncryptNext = std::make_shared<CryptoQueue_t>();
+        m_EncryptQueuedAt = Clock_t::now();
+      }
       m_EncryptNext->emplace_back(std::move(data));
       if (!IsEstablished())
       {
-        EncryptWorker(std::move(m_EncryptNext));
+        EncryptWorker(std::move(m_EncryptNext), m_EncryptQueuedAt, m_PeerAddr.createSockAddr());
         m_EncryptNext = nullptr;
       }
     }
 
     void
-    Session::EncryptWorker(CryptoQueue_ptr msgs)
+    Session::EncryptWorker(CryptoQueue_ptr msgs, Clock_t::time_point queued, SockAddr to)
     {
+      alloc::Scope allocScope{alloc::LinkBuffers};
+      LLARP_ZONE("iwp::Session::EncryptWorker");
       LogDebug("encrypt worker ", msgs->size(), " messages");
-      for (auto& pkt : *msgs)
+      if (msgs->empty())
+        return;
+      const auto* times = m_Parent->StageTimes();
+      const auto started = Clock_t::now();
+      if (times)
+        times->encryptWait.ObserveSince(queued);
+      const auto num = msgs->size();
+      LLARP_PLOT("iwp encrypt batch", num);
+      if (m_RemoteAESGCM.load(std::memory_order_acquire))
+        SealAESGCM(*msgs);
+      else
+      {
+        std::vector<CryptoSpan> spans;
+        std::vector<TunnelNonce> nonces;
+        std::vector<ShortHash> macs(num);
+        spans.reserve(num);
+        nonces.reserve(num);
+        // encrypt everything then mac everything so the crypto backend sees the whole batch
+        for (auto& pkt : *msgs)
+        {
+          nonces.emplace_back(pkt.data() + HMACSIZE);
+          spans.emplace_back(
+              CryptoSpan{pkt.data() + PacketOverhead, pkt.size() - PacketOverhead});
+        }
+        auto* crypto = HotCrypto();
+        crypto->xchacha20_batch(spans.data(), nonces.data(), num, m_SessionKey);
+        for (size_t idx = 0; idx < num; ++idx)
+        {
+          auto& pkt = (*msgs)[idx];
+          spans[idx] = CryptoSpan{pkt.data() + HMACSIZE, pkt.size() - HMACSIZE};
+        }
+        crypto->hmac_batch(macs.data(), spans.data(), num, m_SessionKey);
+        for (size_t idx = 0; idx < num; ++idx)
+          std::copy_n(macs[idx].begin(), HMACSIZE, (*msgs)[idx].data());
+      }
+
+      std::vector<llarp_udp_pkt> batch;
+      batch.reserve(num);
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        auto& pkt = (*msgs)[idx];
+        batch.emplace_back(llarp_udp_pkt{to, pkt.data(), pkt.size()});
+        m_TXRate.Add(pkt.size());
+      }
+      const auto encrypted = Clock_t::now();
+      if (times)
+        times->encrypt.ObserveSince(started);
+      LogDebug("send ", batch.size(), " packets to ", m_RemoteAddr);
+      if (m_Parent->CanSendSegmented())
+        SendCoalesced(batch);
+      else
+        m_Parent->SendBatchTo_LL(batch.data(), batch.size());
+      if (times)
+        times->send.ObserveSince(encrypted);
+      m_LastTX = m_Parent->Now();
+    }
+
+    void
+    Session::SendCoalesced(const std::vector<llarp_udp_pkt>& pkts)
+    {
+      // data fragments of a message are all the same size except the last one so each
+      // flush of an outbound message ends up as a single run here
+      std::vector<llarp_udp_pkt> rest;
+      std::vector<byte_t> coalesced;
+      size_t idx = 0;
+      while (idx < pkts.size())
       {
-        llarp_buffer_t pktbuf(pkt);
-        const TunnelNonce nonce_ptr{pkt.data() + HMACSIZE};
-        pktbuf.base += PacketOverhead;
-        pktbuf.cur = pktbuf.base;
-        pktbuf.sz -= PacketOverhead;
-        CryptoManager::instance()->xchacha20(pktbuf, m_SessionKey, nonce_ptr);
-        pktbuf.base = pkt.data() + HMACSIZE;
-        pktbuf.sz = pkt.size() - HMACSIZE;
-        CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
-        Send_LL(pkt.data(), pkt.size());
+        const size_t segsz = pkts[idx].sz;
+        size_t end = idx + 1;
+        while (end < pkts.size() and end - idx < udp_max_segments
+               and (end - idx + 1) * segsz <= udp_max_segmented_size and pkts[end].sz <= segsz)
+        {
+          // a shorter datagram can only be the tail of a run
+          if (pkts[end++].sz < segsz)
+            break;
+        }
+        if (end - idx > 1)
+        {
+          coalesced.clear();
+          for (size_t n = idx; n < end; ++n)
+            coalesced.insert(coalesced.end(), pkts[n].data, pkts[n].data + pkts[n].sz);
+          if (m_Parent->SendSegmentedTo_LL(
+                  pkts[idx].addr, coalesced.data(), coalesced.size(), segsz))
+          {
+            idx = end;
+            continue;
+          }
+        }
+        rest.insert(rest.end(), pkts.begin() + idx, pkts.begin() + end);
+        idx = end;
       }
+      if (not rest.empty())
+        m_Parent->SendBatchTo_LL(rest.data(), rest.size());
     }
 
     void
@@ -164,9 +417,9 @@ namespace llarp
     {
       if (m_State == State::Closed)
         return;
-      auto close_msg = CreatePacket(Command::eCLOS, 0, 16, 16);
+      auto close_msg = CreatePacket(Command::eCLOS, 0);
       if (m_State == State::Ready)
-        m_Parent->UnmapAddr(m_RemoteAddr);
+        m_Parent->UnmapAddr(m_PeerAddr);
       m_State = State::Closed;
       EncryptAndSend(std::move(close_msg));
       LogInfo("closing connection to ", m_RemoteAddr);
@@ -174,48 +427,160 @@ namespace llarp
 
     bool
     Session::SendMessageBuffer(
-        ILinkSession::Message_t buf, ILinkSession::CompletionHandler completed)
+        ILinkSession::Message_t buf, ILinkSession::CompletionHandler completed, TrafficClass cls)
     {
+      alloc::Scope allocScope{alloc::LinkBuffers};
       if (m_TXMsgs.size() >= MaxSendQueueSize)
         return false;
       const auto now = m_Parent->Now();
-      const auto msgid = m_TXID++;
-      const auto bufsz = buf.size();
-      auto& msg = m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed})
-                      .first->second;
-      EncryptAndSend(msg.XMIT());
-      if (bufsz > FragmentSize)
+      const auto msgid = m_TXID;
+      // refused when the oldest message in flight is a full ring behind
+      const auto [msg, inserted] =
+          m_TXMsgs.Emplace(msgid, msgid, std::move(buf), now, completed, m_FragSize);
+      if (not inserted)
+        return false;
+      m_TXID++;
+      // what goes in one datagram is a cell someone is waiting on, not a transfer
+      if (cls == TrafficClass::Bulk and msg->NumPackets() == 1)
+        cls = TrafficClass::Interactive;
+      m_TXPending[static_cast<size_t>(cls)].emplace_back(msgid);
+      m_Stats.totalInFlightTX++;
+      LogDebug("queue message ", msgid);
+      TransmitPending(now);
+      return true;
+    }
+
+    bool
+    Session::TransmitClass(TrafficClass cls, size_t& budget, llarp_time_t now)
+    {
+      auto& pending = m_TXPending[static_cast<size_t>(cls)];
+      while (not pending.empty())
       {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        const auto msgid = pending.front();
+        auto* msg = m_TXMsgs.Find(msgid);
+        if (msg == nullptr)
+        {
+          // timed out while waiting
+          pending.pop_front();
+          continue;
+        }
+        const auto num = msg->NumPackets();
+        if (num > budget)
+          return true;
+        if (not m_CC.CanSend(num, m_InFlight, now))
+          return false;
+        LogDebug("send message ", msgid);
+        msg->Transmit(util::memFn(&Session::EncryptAndSend, this), now);
+        m_CC.OnSent(num);
+        m_InFlight += num;
+        budget -= num;
+        pending.pop_front();
       }
-      m_Stats.totalInFlightTX++;
-      LogDebug("send message ", msgid);
       return true;
     }
 
+    void
+    Session::TransmitPending(llarp_time_t now)
+    {
+      for (const auto cls : {TrafficClass::Control, TrafficClass::PathBuild})
+      {
+        size_t unlimited = std::numeric_limits<size_t>::max();
+        if (not TransmitClass(cls, unlimited, now))
+          return;
+      }
+      // deficit round robin, a class held back by the window does not bank credit while it waits
+      bool more = true;
+      while (more)
+      {
+        more = false;
+        for (const auto cls : {TrafficClass::Interactive, TrafficClass::Bulk})
+        {
+          const auto idx = static_cast<size_t>(cls);
+          auto& deficit = m_TXDeficit[idx];
+          deficit = std::min(deficit + TXQuantum[idx], TXQuantum[idx] + MaxFragments);
+          if (not TransmitClass(cls, deficit, now))
+            return;
+          if (m_TXPending[idx].empty())
+            deficit = 0;
+          else
+            more = true;
+        }
+      }
+    }
+
+    llarp_time_t
+    Session::RetransmitTimeout() const
+    {
+      const auto srtt = m_CC.SmoothedRTT();
+      if (srtt == 0s)
+        return TXFlushInterval;
+      return std::clamp(srtt + m_CC.RTTVariance() * 4, MinRetransmitTimeout, TXFlushInterval);
+    }
+
+    void
+    Session::OnTXCompleted(const OutboundMessage& msg, llarp_time_t now)
+    {
+      // karn: retransmitted messages give ambiguous samples
+      if (msg.m_Retransmits == 0)
+        m_CC.OnRTTSample(now - msg.m_SentAt);
+      const auto acked = msg.InFlight();
+      m_CC.OnAcked(acked, now);
+      m_InFlight -= std::min(m_InFlight, acked);
+    }
+
+    void
+    Session::QueueMACK(uint64_t rxid)
+    {
+      m_SendMACKs.emplace_back(rxid);
+      if (m_SendMACKs.size() > 1)
+        return;
+      const auto delay = m_Parent->AckDelay();
+      m_MACKDue = m_Parent->Now() + delay;
+      if (delay == 0s)
+        return;
+      // make sure they go out even if nothing else wakes us up
+      m_Parent->logic()->call_later(delay, [self = weak_from_this()]() {
+        if (auto ptr = self.lock())
+        {
+          if (ptr->ShouldSendMACK(ptr->m_Parent->Now()))
+            ptr->Pump();
+        }
+      });
+    }
+
+    bool
+    Session::ShouldSendMACK(llarp_time_t now) const
+    {
+      if (m_SendMACKs.empty())
+        return false;
+      if (m_SendMACKs.size() >= m_Parent->AckBudget())
+        return true;
+      // ride along with whatever we are about to encrypt and send anyways
+      if (m_EncryptNext and not m_EncryptNext->empty())
+        return true;
+      return now >= m_MACKDue;
+    }
+
     void
     Session::SendMACK()
     {
       // send multi acks
-      while (not m_SendMACKs.empty())
+      size_t idx = 0;
+      while (idx < m_SendMACKs.size())
       {
-        const auto sz = m_SendMACKs.size();
-        const auto max = Session::MaxACKSInMACK;
-        auto numAcks = std::min(sz, max);
+        const auto numAcks = std::min(m_SendMACKs.size() - idx, Session::MaxACKSInMACK);
         auto mack = CreatePacket(Command::eMACK, 1 + (numAcks * sizeof(uint64_t)));
         mack[PacketOverhead + CommandOverhead] = byte_t{static_cast<byte_t>(numAcks)};
         byte_t* ptr = mack.data() + 3 + PacketOverhead;
         LogDebug("send ", numAcks, " macks to ", m_RemoteAddr);
-        const auto& itr = m_SendMACKs.top();
-        while (numAcks > 0)
+        for (const auto end = idx + numAcks; idx < end; ++idx)
         {
-          htobe64buf(ptr, itr);
-          m_SendMACKs.pop();
-          numAcks--;
+          htobe64buf(ptr, m_SendMACKs[idx]);
           ptr += sizeof(uint64_t);
         }
         EncryptAndSend(std::move(mack));
       }
+      m_SendMACKs.clear();
     }
 
     void
@@ -226,32 +591,50 @@ namespace llarp
       {
         if (ShouldPing())
           SendKeepAlive();
-        for (auto& item : m_RXMsgs)
-        {
-          if (item.second.ShouldSendACKS(now))
+        if (m_State == State::Ready)
+          ProbeMTU(now);
+        m_RXMsgs.ForEach([&](uint64_t, InboundMessage& msg) {
+          if (msg.ShouldSendACKS(now))
           {
-            item.second.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
+            SendACKSFor(msg, now);
           }
-        }
-        for (auto& item : m_TXMsgs)
-        {
-          if (item.second.ShouldFlush(now))
+        });
+        const auto rto = RetransmitTimeout();
+        m_InFlight = 0;
+        m_TXMsgs.ForEach([&](uint64_t, OutboundMessage& msg) {
+          if (msg.ShouldFlush(now, rto))
           {
-            item.second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+            m_CC.OnLoss(now);
+            msg.m_Retransmits++;
+            m_Stats.totalRetransmitTX++;
+            msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
           }
-        }
+          m_InFlight += msg.InFlight();
+        });
+        TransmitPending(now);
       }
+      if (ShouldSendMACK(now))
+        SendMACK();
       auto self = shared_from_this();
       assert(self.use_count() > 1);
       if (m_EncryptNext && !m_EncryptNext->empty())
       {
-        m_Parent->QueueWork([self, data = std::move(m_EncryptNext)] { self->EncryptWorker(data); });
+        m_Parent->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self,
+             data = std::move(m_EncryptNext),
+             queued = m_EncryptQueuedAt,
+             to = m_PeerAddr.createSockAddr()] { self->EncryptWorker(data, queued, to); });
         m_EncryptNext = nullptr;
       }
 
       if (m_DecryptNext && !m_DecryptNext->empty())
       {
-        m_Parent->QueueWork([self, data = std::move(m_DecryptNext)] { self->DecryptWorker(data); });
+        m_Parent->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self, data = std::move(m_DecryptNext), queued = m_DecryptQueuedAt] {
+              self->DecryptWorker(data, queued);
+            });
         m_DecryptNext = nullptr;
       }
     }
@@ -276,7 +659,7 @@ namespace llarp
       if (m_State == State::Ready)
       {
         const auto now = m_Parent->Now();
-        return now - m_LastTX > PingInterval;
+        return now - m_LastTX > (m_Parent->IsIdle() ? IdlePingInterval : PingInterval);
       }
       return false;
     }
@@ -285,17 +668,27 @@ namespace llarp
     Session::GetSessionStats() const
     {
       // TODO: thread safety
-      return m_Stats;
+      auto stats = m_Stats;
+      stats.congestionWindow = m_CC.Window();
+      stats.smoothedRTTMs = m_CC.SmoothedRTT().count();
+      stats.totalLossEventsTX = m_CC.LossEvents();
+      stats.fragmentSize = m_FragSize;
+      return stats;
     }
 
     util::StatusObject
     Session::ExtractStatus() const
     {
       const auto now = m_Parent->Now();
+      size_t pending = 0;
+      for (const auto& msgs : m_TXPending)
+        pending += msgs.size();
 
       return {{"txRateCurrent", m_Stats.currentRateTX},
               {"rxRateCurrent", m_Stats.currentRateRX},
               {"rxPktsRcvd", m_Stats.totalPacketsRX},
+              {"txRate", m_TXRate.ExtractStatus()},
+              {"rxRate", m_RXRate.ExtractStatus()},
 
               // leave 'tx' and 'rx' as duplicates of 'xRateCurrent' for compat
               {"tx", m_Stats.currentRateTX},
@@ -304,13 +697,22 @@ namespace llarp
               {"txPktsAcked", m_Stats.totalAckedTX},
               {"txPktsDropped", m_Stats.totalDroppedTX},
               {"txPktsInFlight", m_Stats.totalInFlightTX},
+              {"txPktsRetransmitted", m_Stats.totalRetransmitTX},
+              {"txFragsInFlight", m_InFlight},
+              {"txMsgsPending", pending},
+              {"txMsgsPendingControl", m_TXPending[0].size()},
+              {"txMsgsPendingPathBuild", m_TXPending[1].size()},
+              {"txMsgsPendingInteractive", m_TXPending[2].size()},
+              {"txMsgsPendingBulk", m_TXPending[3].size()},
+              {"congestion", m_CC.ExtractStatus()},
+              {"fragmentSize", m_FragSize},
 
               {"state", StateToString(m_State)},
               {"inbound", m_Inbound},
               {"replayFilter", m_ReplayFilter.size()},
               {"txMsgQueueSize", m_TXMsgs.size()},
               {"rxMsgQueueSize", m_RXMsgs.size()},
-              {"remoteAddr", m_RemoteAddr.toString()},
+              {"remoteAddr", m_PeerAddr.toString()},
               {"remoteRC", m_RemoteRC.ExtractStatus()},
               {"created", to_json(m_CreatedAt)},
               {"uptime", to_json(now - m_CreatedAt)}};
@@ -333,104 +735,139 @@ namespace llarp
     }
 
     void
-    Session::ResetRates()
+    Session::ResetRates(llarp_time_t now)
     {
-      m_Stats.currentRateTX = m_TXRate;
-      m_Stats.currentRateRX = m_RXRate;
-      m_RXRate = 0;
-      m_TXRate = 0;
+      m_TXRate.Tick(now);
+      m_RXRate.Tick(now);
+      m_Stats.currentRateTX = uint64_t(m_TXRate.Last());
+      m_Stats.currentRateRX = uint64_t(m_RXRate.Last());
+      m_Stats.p95RateTX = uint64_t(m_TXRate.Percentile(0.95));
+      m_Stats.p95RateRX = uint64_t(m_RXRate.Percentile(0.95));
     }
 
     void
     Session::Tick(llarp_time_t now)
     {
+      if (m_Resuming and m_State == State::Introduction and now - m_ResumeSentAt > ResumeTimeout)
+      {
+        LogDebug("no answer to our resumption from ", m_RemoteAddr, ", sending a full intro");
+        GenerateAndSendIntro();
+      }
       if (ShouldResetRates(now))
       {
-        ResetRates();
+        ResetRates(now);
         m_ResetRatesAt = now + 1s;
       }
       // remove pending outbound messsages that timed out
       // inform waiters
       {
-        auto itr = m_TXMsgs.begin();
-        while (itr != m_TXMsgs.end())
+        // collect first, the timeout handlers may queue new messages
+        std::vector<uint64_t> timedOut;
+        m_TXMsgs.ForEach([&](uint64_t msgid, const OutboundMessage& msg) {
+          if (msg.IsTimedOut(now))
+            timedOut.emplace_back(msgid);
+        });
+        bool transmitted = false;
+        bool bigFragments = false;
+        for (const auto msgid : timedOut)
         {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_Stats.totalDroppedTX++;
-            m_Stats.totalInFlightTX--;
-            LogDebug("Dropped unacked packet to ", m_RemoteAddr);
-            itr->second.InformTimeout();
-            itr = m_TXMsgs.erase(itr);
-          }
-          else
-            ++itr;
+          auto msg = m_TXMsgs.Take(msgid);
+          // only ones that made it onto the wire say anything about the path
+          transmitted = transmitted or msg->m_Transmitted;
+          bigFragments = bigFragments
+              or (msg->m_Transmitted and msg->NumPackets() > 1 and msg->m_FragSize > FragmentSize);
+          m_Stats.totalDroppedTX++;
+          m_Stats.totalInFlightTX--;
+          LogDebug("Dropped unacked packet to ", m_RemoteAddr);
+          msg->InformTimeout();
         }
+        if (transmitted)
+          m_CC.OnTimeout(now);
+        if (bigFragments)
+          MTUBlackHole(now);
       }
       {
         // remove pending inbound messages that timed out
-        auto itr = m_RXMsgs.begin();
-        while (itr != m_RXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_ReplayFilter.emplace(itr->first, now);
-            itr = m_RXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
-      {
-        // decay replay window
-        auto itr = m_ReplayFilter.begin();
-        while (itr != m_ReplayFilter.end())
+        std::vector<uint64_t> timedOut;
+        m_RXMsgs.ForEach([&](uint64_t rxid, const InboundMessage& msg) {
+          if (msg.IsTimedOut(now))
+            timedOut.emplace_back(rxid);
+        });
+        for (const auto rxid : timedOut)
         {
-          if (itr->second + ReplayWindow <= now)
-          {
-            itr = m_ReplayFilter.erase(itr);
-          }
-          else
-            ++itr;
+          m_ReplayFilter.Insert(rxid);
+          m_RXMsgs.Erase(rxid);
         }
       }
     }
 
-    using Introduction =
-        AlignedBuffer<PubKey::SIZE + PubKey::SIZE + TunnelNonce::SIZE + Signature::SIZE>;
-
     void
     Session::GenerateAndSendIntro()
     {
-      TunnelNonce N;
-      N.Randomize();
-      {
-        ILinkSession::Packet_t req(Introduction::SIZE + PacketOverhead);
-        const auto pk = m_Parent->GetOurRC().pubkey;
-        const auto e_pk = m_Parent->RouterEncryptionSecret().toPublic();
-        auto itr = req.data() + PacketOverhead;
-        std::copy_n(pk.data(), pk.size(), itr);
-        itr += pk.size();
-        std::copy_n(e_pk.data(), e_pk.size(), itr);
-        itr += e_pk.size();
-        std::copy_n(N.data(), N.size(), itr);
-        Signature Z;
-        llarp_buffer_t signbuf(req.data() + PacketOverhead, Introduction::SIZE - Signature::SIZE);
-        m_Parent->Sign(Z, signbuf);
-        std::copy_n(
-            Z.data(),
-            Z.size(),
-            req.data() + PacketOverhead + (Introduction::SIZE - Signature::SIZE));
-        CryptoManager::instance()->randbytes(req.data() + HMACSIZE, TUNNONCESIZE);
-        EncryptAndSend(std::move(req));
-      }
-      m_State = State::Introduction;
-      if (not CryptoManager::instance()->transport_dh_client(
-              m_SessionKey, m_ChosenAI.pubkey, m_Parent->RouterEncryptionSecret(), N))
+      // one intro at a time, a cookie that comes back meanwhile goes into the next one
+      if (m_HandshakeBusy)
+        return;
+      // each ticket is good once, if the resumption goes unanswered we come back here for a
+      // full intro
+      if (auto held = m_Parent->TakeTicket(m_RemoteRC.pubkey))
       {
-        LogError("failed to transport_dh_client on outbound session to ", m_RemoteAddr);
+        SendResumption(held->first, held->second);
         return;
       }
+      m_Resuming = false;
+      TunnelNonce N;
+      N.Randomize();
+      const size_t cookieSize = m_Cookie.IsZero() ? 0 : Cookie_t::SIZE;
+      ILinkSession::Packet_t req(Introduction::SIZE + cookieSize + PacketOverhead);
+      const auto pk = m_Parent->GetOurRC().pubkey;
+      const auto& secret = m_Parent->RouterEncryptionSecret();
+      const auto e_pk = secret.toPublic();
+      auto itr = req.data() + PacketOverhead;
+      std::copy_n(pk.data(), pk.size(), itr);
+      itr += pk.size();
+      std::copy_n(e_pk.data(), e_pk.size(), itr);
+      itr += e_pk.size();
+      std::copy_n(N.data(), N.size(), itr);
+      // after the signature so servers that never ask for one do not see it
+      std::copy_n(m_Cookie.data(), cookieSize, req.end() - cookieSize);
+      CryptoManager::instance()->randbytes(req.data() + HMACSIZE, TUNNONCESIZE);
+      m_HandshakeBusy = true;
+      m_Parent->QueueHandshake(
+          [self = shared_from_this(), req = std::move(req), N, secret, remote = m_ChosenAI.pubkey]()
+              mutable {
+            Signature Z;
+            const llarp_buffer_t signbuf(
+                req.data() + PacketOverhead, Introduction::SIZE - Signature::SIZE);
+            bool ok = self->m_Parent->Sign(Z, signbuf);
+            std::copy_n(
+                Z.data(),
+                Z.size(),
+                req.data() + PacketOverhead + (Introduction::SIZE - Signature::SIZE));
+            SharedSecret key;
+            if (ok and not CryptoManager::instance()->transport_dh_client(key, remote, secret, N))
+            {
+              LogError("failed to transport_dh_client on outbound session to ", self->m_RemoteAddr);
+              ok = false;
+            }
+            LogicCall(
+                self->m_Parent->logic(), [self, ok, req = std::move(req), key]() mutable {
+                  self->IntroSigned(ok, std::move(req), key);
+                });
+          },
+          false);
+    }
+
+    void
+    Session::IntroSigned(bool ok, Packet_t req, const SharedSecret& key)
+    {
+      m_HandshakeBusy = false;
+      if (not ok or m_State == State::Closed)
+        return;
+      // intros go out under the intro key, including ones we send again with a cookie
+      m_SessionKey = m_IntroKey;
+      EncryptAndSend(std::move(req));
+      m_State = State::Introduction;
+      m_SessionKey = key;
       LogDebug("sent intro to ", m_RemoteAddr);
     }
 
@@ -464,45 +901,197 @@ namespace llarp
       SendOurLIM();
     }
 
-    void
+    bool
     Session::HandleGotIntro(Packet_t pkt)
     {
+      // the remote sent its intro again while we still check the first
+      if (m_HandshakeBusy)
+        return true;
       if (pkt.size() < (Introduction::SIZE + PacketOverhead))
       {
         LogWarn("intro too small from ", m_RemoteAddr);
-        return;
+        return true;
       }
-      byte_t* ptr = pkt.data() + PacketOverhead;
+      m_HandshakeBusy = true;
+      auto check = [self = shared_from_this(),
+                    pkt = std::move(pkt),
+                    secret = m_Parent->TransportSecretKey()]() {
+        const byte_t* ptr = pkt.data() + PacketOverhead;
+        PubKey ident;
+        PubKey onionKey;
+        TunnelNonce N;
+        Signature Z;
+        std::copy_n(ptr, PubKey::SIZE, ident.data());
+        ptr += PubKey::SIZE;
+        std::copy_n(ptr, PubKey::SIZE, onionKey.data());
+        ptr += PubKey::SIZE;
+        std::copy_n(ptr, TunnelNonce::SIZE, N.data());
+        ptr += TunnelNonce::SIZE;
+        std::copy_n(ptr, Z.size(), Z.data());
+        const llarp_buffer_t verifybuf(
+            pkt.data() + PacketOverhead, Introduction::SIZE - Signature::SIZE);
+        SharedSecret key;
+        bool ok = CryptoManager::instance()->verify(ident, verifybuf, Z);
+        if (not ok)
+          LogError("intro verify failed from ", self->m_RemoteAddr);
+        else if (not CryptoManager::instance()->transport_dh_server(key, onionKey, secret, N))
+        {
+          LogError("failed to transport_dh_server on inbound intro from ", self->m_RemoteAddr);
+          ok = false;
+        }
+        LogicCall(self->m_Parent->logic(), [self, ok, ident, onionKey, key]() {
+          self->IntroChecked(ok, ident, onionKey, key);
+        });
+      };
+      // intros are cheap to send and costly to check, past the queue limit we let them go
+      if (not m_Parent->QueueHandshake(std::move(check), true))
+      {
+        m_HandshakeBusy = false;
+        LogWarn("too many handshakes queued, dropping intro from ", m_RemoteAddr);
+        return false;
+      }
+      return true;
+    }
+
+    void
+    Session::IntroChecked(
+        bool ok, const PubKey& ident, const PubKey& onionKey, const SharedSecret& key)
+    {
+      m_HandshakeBusy = false;
+      if (not ok or m_State != State::Initial)
+        return;
+      m_RemoteOnionKey = onionKey;
+      LogDebug("got intro: remote-pk=", m_RemoteOnionKey.ToHex(), " from ", m_RemoteAddr);
+      SendIntroAck(ident, key);
+    }
+
+    void
+    Session::SendResumption(const Ticket_t& ticket, const SharedSecret& secret)
+    {
       TunnelNonce N;
-      std::copy_n(ptr, PubKey::SIZE, m_ExpectedIdent.data());
-      ptr += PubKey::SIZE;
-      std::copy_n(ptr, PubKey::SIZE, m_RemoteOnionKey.data());
-      ptr += PubKey::SIZE;
-      std::copy_n(ptr, TunnelNonce::SIZE, N.data());
-      ptr += TunnelNonce::SIZE;
-      Signature Z;
-      std::copy_n(ptr, Z.size(), Z.data());
-      const llarp_buffer_t verifybuf(
-          pkt.data() + PacketOverhead, Introduction::SIZE - Signature::SIZE);
-      if (!CryptoManager::instance()->verify(m_ExpectedIdent, verifybuf, Z))
-      {
-        LogError("intro verify failed from ", m_RemoteAddr);
-        return;
-      }
-      const PubKey pk = m_Parent->TransportSecretKey().toPublic();
-      LogDebug(
-          "got intro: remote-pk=",
-          m_RemoteOnionKey.ToHex(),
-          " N=",
-          N.ToHex(),
-          " local-pk=",
-          pk.ToHex());
-      if (not CryptoManager::instance()->transport_dh_server(
-              m_SessionKey, m_RemoteOnionKey, m_Parent->TransportSecretKey(), N))
-      {
-        LogError("failed to transport_dh_server on inbound intro from ", m_RemoteAddr);
+      N.Randomize();
+      Packet_t req(Resumption::SIZE + PacketOverhead);
+      std::copy_n(ticket.data(), ticket.size(), req.data() + PacketOverhead);
+      std::copy_n(N.data(), N.size(), req.data() + PacketOverhead + ticket.size());
+      CryptoManager::instance()->randbytes(req.data() + HMACSIZE, TUNNONCESIZE);
+      // under the intro key like an intro, the remote tells them apart by size
+      m_SessionKey = m_IntroKey;
+      EncryptAndSend(std::move(req));
+      m_State = State::Introduction;
+      m_SessionKey = ResumedKeyFor(secret, N);
+      m_Resuming = true;
+      m_ResumeSentAt = m_Parent->Now();
+      LogDebug("sent resumption to ", m_RemoteAddr);
+    }
+
+    void
+    Session::HandleResumption(Packet_t pkt)
+    {
+      const Ticket_t ticket{pkt.data() + PacketOverhead};
+      const TunnelNonce N{pkt.data() + PacketOverhead + Ticket_t::SIZE};
+      PubKey ident;
+      SharedSecret secret;
+      if (not m_Parent->OpenTicket(ticket, ident, secret, true))
+      {
+        // the remote sends a full intro once it hears nothing back
+        LogDebug("bad or used ticket from ", m_RemoteAddr);
+        return;
+      }
+      LogDebug("resuming session from ", m_RemoteAddr);
+      SendIntroAck(ident, ResumedKeyFor(secret, N));
+    }
+
+    void
+    Session::SendTicket()
+    {
+      const auto ticket = m_Parent->MakeTicket(m_RemoteRC.pubkey, ResumeSecretFor(m_SessionKey));
+      auto pkt = CreatePacket(Command::ePING, TicketMagic.size() + Ticket_t::SIZE);
+      byte_t* body = pkt.data() + PacketOverhead + CommandOverhead;
+      std::copy(TicketMagic.begin(), TicketMagic.end(), body);
+      std::copy_n(ticket.data(), ticket.size(), body + TicketMagic.size());
+      EncryptAndSend(std::move(pkt));
+    }
+
+    bool
+    Session::Authenticates(const llarp_buffer_t& pkt) const
+    {
+      if (m_State != State::Ready or pkt.sz <= PacketOverhead)
+        return false;
+      if (IsAESGCM(pkt.base))
+      {
+        // opens in place, so on a copy
+        std::vector<byte_t> body(pkt.base + PacketOverhead, pkt.base + pkt.sz);
+        const CryptoSpan buf{body.data(), body.size()};
+        const CryptoSpan ad{pkt.base + GCMTAGSIZE, PacketOverhead - GCMTAGSIZE};
+        const TunnelNonce N{pkt.base + HMACSIZE};
+        const GCMTag tag{pkt.base};
+        bool valid = false;
+        return HotCrypto()->aes256gcm_open_batch(&buf, &ad, &N, &tag, 1, m_AESGCMKey, &valid)
+            and valid;
+      }
+      ShortHash H;
+      const llarp_buffer_t macbuf(pkt.base + HMACSIZE, pkt.sz - HMACSIZE);
+      return HotCrypto()->hmac(H.data(), macbuf, m_SessionKey) and H == ShortHash{pkt.base};
+    }
+
+    void
+    Session::ChallengeAddress(const IpAddress& addr)
+    {
+      const auto now = m_Parent->Now();
+      m_PathChallenges.erase(
+          std::remove_if(
+              m_PathChallenges.begin(),
+              m_PathChallenges.end(),
+              [now](const auto& chal) { return now - chal.sentAt > PathChallengeTimeout; }),
+          m_PathChallenges.end());
+      if (m_PathChallenges.size() >= MaxPathChallenges)
         return;
+      for (const auto& chal : m_PathChallenges)
+      {
+        if (chal.addr == addr)
+          return;
       }
+      PathChallenge_t nonce;
+      nonce.Randomize();
+      m_PathChallenges.emplace_back(PathChallenge{addr, nonce, now});
+      auto pkt = CreatePacket(Command::ePING, PathChallengeMagic.size() + PathChallenge_t::SIZE);
+      byte_t* body = pkt.data() + PacketOverhead + CommandOverhead;
+      std::copy(PathChallengeMagic.begin(), PathChallengeMagic.end(), body);
+      std::copy_n(nonce.data(), nonce.size(), body + PathChallengeMagic.size());
+      // the only packet that goes to the new address until it answers, so anyone replaying our
+      // packets from somewhere else learns nothing and moves nothing
+      auto msgs = std::make_shared<CryptoQueue_t>();
+      msgs->emplace_back(std::move(pkt));
+      m_Parent->QueueWorkFor(
+          reinterpret_cast<uintptr_t>(this),
+          [self = shared_from_this(), msgs, to = addr.createSockAddr()] {
+            self->EncryptWorker(msgs, Clock_t::now(), to);
+          });
+      LogDebug("challenging ", addr, " to prove it is ", m_PeerAddr);
+    }
+
+    void
+    Session::GotPathResponse(const PathChallenge_t& nonce)
+    {
+      const auto now = m_Parent->Now();
+      auto itr = std::find_if(
+          m_PathChallenges.begin(), m_PathChallenges.end(), [&nonce, now](const auto& chal) {
+            return chal.nonce == nonce and now - chal.sentAt <= PathChallengeTimeout;
+          });
+      if (itr == m_PathChallenges.end() or m_State != State::Ready)
+        return;
+      const IpAddress from = m_PeerAddr;
+      m_PeerAddr = itr->addr;
+      m_PathChallenges.clear();
+      LogInfo(m_RemoteRC.pubkey, " moved from ", from, " to ", m_PeerAddr);
+      m_Parent->Migrated(this, from, m_PeerAddr);
+    }
+
+    void
+    Session::SendIntroAck(const PubKey& ident, const SharedSecret& key)
+    {
+      m_ExpectedIdent = ident;
+      m_SessionKey = key;
       Packet_t reply(token.size() + PacketOverhead);
       // random nonce
       CryptoManager::instance()->randbytes(reply.data() + HMACSIZE, TUNNONCESIZE);
@@ -528,6 +1117,15 @@ namespace llarp
             m_RemoteAddr);
         return;
       }
+      // our intro is still being signed, nothing can answer it yet
+      if (m_HandshakeBusy)
+        return;
+      if (TakeCookie(pkt))
+      {
+        LogDebug("got cookie from ", m_RemoteAddr, ", sending our intro again");
+        GenerateAndSendIntro();
+        return;
+      }
       Packet_t reply(token.size() + PacketOverhead);
       if (not DecryptMessageInPlace(pkt))
       {
@@ -535,6 +1133,7 @@ namespace llarp
         return;
       }
       m_LastRX = m_Parent->Now();
+      m_Resuming = false;
       std::copy_n(pkt.data() + PacketOverhead, token.size(), token.data());
       std::copy_n(token.data(), token.size(), reply.data() + PacketOverhead);
       // random nounce
@@ -544,6 +1143,25 @@ namespace llarp
       m_State = State::LinkIntro;
     }
 
+    bool
+    Session::TakeCookie(Packet_t& pkt)
+    {
+      if (m_CookieTries >= MaxCookieTries or pkt.size() != Cookie_t::SIZE + PacketOverhead)
+        return false;
+      // an intro ack is keyed with the session key, a cookie request with the intro key
+      ShortHash H;
+      const llarp_buffer_t macbuf(pkt.data() + HMACSIZE, pkt.size() - HMACSIZE);
+      if (not HotCrypto()->hmac(H.data(), macbuf, m_IntroKey) or H != ShortHash{pkt.data()})
+        return false;
+      const TunnelNonce N{pkt.data() + HMACSIZE};
+      const llarp_buffer_t body(pkt.data() + PacketOverhead, Cookie_t::SIZE);
+      if (not HotCrypto()->xchacha20(body, m_IntroKey, N))
+        return false;
+      std::copy_n(body.base, Cookie_t::SIZE, m_Cookie.data());
+      m_CookieTries++;
+      return true;
+    }
+
     bool
     Session::DecryptMessageInPlace(Packet_t& pkt)
     {
@@ -557,7 +1175,7 @@ namespace llarp
       llarp_buffer_t curbuf(buf.base, buf.sz);
       curbuf.base += ShortHash::SIZE;
       curbuf.sz -= ShortHash::SIZE;
-      if (not CryptoManager::instance()->hmac(H.data(), curbuf, m_SessionKey))
+      if (not HotCrypto()->hmac(H.data(), curbuf, m_SessionKey))
       {
         LogError("failed to caclulate keyed hash for ", m_RemoteAddr);
         return false;
@@ -582,7 +1200,7 @@ namespace llarp
       curbuf.base += 32;
       curbuf.sz -= 32;
       LogDebug("decrypt: ", curbuf.sz, " bytes from ", m_RemoteAddr);
-      return CryptoManager::instance()->xchacha20(curbuf, m_SessionKey, N);
+      return HotCrypto()->xchacha20(curbuf, m_SessionKey, N);
     }
 
     void
@@ -597,38 +1215,99 @@ namespace llarp
     Session::HandleSessionData(Packet_t pkt)
     {
       if (m_DecryptNext == nullptr)
+      {
         m_DecryptNext = std::make_shared<CryptoQueue_t>();
+        m_DecryptQueuedAt = Clock_t::now();
+      }
       m_DecryptNext->emplace_back(std::move(pkt));
     }
 
     void
-    Session::DecryptWorker(CryptoQueue_ptr msgs)
+    Session::DecryptWorker(CryptoQueue_ptr msgs, Clock_t::time_point queued)
     {
+      alloc::Scope allocScope{alloc::LinkBuffers};
+      LLARP_ZONE("iwp::Session::DecryptWorker");
+      const auto* times = m_Parent->StageTimes();
+      const auto started = Clock_t::now();
+      if (times)
+        times->decryptWait.ObserveSince(queued);
+      // drop runts before they go into the batch
+      auto& pkts = *msgs;
+      pkts.erase(
+          std::remove_if(
+              pkts.begin(),
+              pkts.end(),
+              [](const Packet_t& pkt) { return pkt.size() <= PacketOverhead; }),
+          pkts.end());
       CryptoQueue_ptr recvMsgs = std::make_shared<CryptoQueue_t>();
-      for (auto& pkt : *msgs)
+      recvMsgs->reserve(pkts.size());
+      // once the remote knows we open aes-256-gcm it seals with that, the rest is as before
+      if (m_Parent->UseAESGCM())
+        OpenAESGCM(pkts, *recvMsgs);
+      const auto num = pkts.size();
+      LLARP_PLOT("iwp decrypt batch", num);
+      std::vector<CryptoSpan> spans;
+      std::vector<ShortHash> macs(num);
+      spans.reserve(num);
+      for (auto& pkt : pkts)
+        spans.emplace_back(CryptoSpan{pkt.data() + HMACSIZE, pkt.size() - HMACSIZE});
+      auto* crypto = HotCrypto();
+      if (not crypto->hmac_batch(macs.data(), spans.data(), num, m_SessionKey))
       {
-        if (not DecryptMessageInPlace(pkt))
-        {
-          LogError("failed to decrypt session data from ", m_RemoteAddr);
-          continue;
-        }
-        if (pkt[PacketOverhead] != LLARP_PROTO_VERSION)
+        LogError("failed to caclulate keyed hash for ", m_RemoteAddr);
+        return;
+      }
+      // only decrypt what authenticates
+      std::vector<TunnelNonce> nonces;
+      nonces.reserve(num);
+      spans.clear();
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        auto& pkt = pkts[idx];
+        if (macs[idx] != ShortHash{pkt.data()})
         {
-          LogError(
-              "protocol version mismatch ", int(pkt[PacketOverhead]), " != ", LLARP_PROTO_VERSION);
+          LogError("keyed hash mismatch from ", m_RemoteAddr, " size=", pkt.size());
           continue;
         }
+        nonces.emplace_back(pkt.data() + HMACSIZE);
+        spans.emplace_back(CryptoSpan{pkt.data() + PacketOverhead, pkt.size() - PacketOverhead});
         recvMsgs->emplace_back(std::move(pkt));
       }
+      if (not crypto->xchacha20_batch(spans.data(), nonces.data(), spans.size(), m_SessionKey))
+      {
+        LogError("failed to decrypt session data from ", m_RemoteAddr);
+        return;
+      }
+      auto& plain = *recvMsgs;
+      plain.erase(
+          std::remove_if(
+              plain.begin(),
+              plain.end(),
+              [](const Packet_t& pkt) {
+                if (pkt[PacketOverhead] == LLARP_PROTO_VERSION)
+                  return false;
+                LogError(
+                    "protocol version mismatch ",
+                    int(pkt[PacketOverhead]),
+                    " != ",
+                    LLARP_PROTO_VERSION);
+                return true;
+              }),
+          plain.end());
       LogDebug("decrypted ", recvMsgs->size(), " packets from ", m_RemoteAddr);
-      LogicCall(m_Parent->logic(), [self = shared_from_this(), msgs = recvMsgs] {
-        self->HandlePlaintext(std::move(msgs));
+      const auto decrypted = Clock_t::now();
+      if (times)
+        times->decrypt.ObserveSince(started);
+      LogicCall(m_Parent->logic(), [self = shared_from_this(), msgs = recvMsgs, decrypted] {
+        self->HandlePlaintext(std::move(msgs), decrypted);
       });
     }
 
     void
-    Session::HandlePlaintext(CryptoQueue_ptr msgs)
+    Session::HandlePlaintext(CryptoQueue_ptr msgs, Clock_t::time_point decrypted)
     {
+      if (const auto* times = m_Parent->StageTimes())
+        times->logicWait.ObserveSince(decrypted);
       for (auto& result : *msgs)
       {
         LogDebug("Command ", int(result[PacketOverhead + 1]));
@@ -643,6 +1322,9 @@ namespace llarp
           case Command::eACKS:
             HandleACKS(std::move(result));
             break;
+          case Command::eSACK:
+            HandleSACK(std::move(result));
+            break;
           case Command::ePING:
             HandlePING(std::move(result));
             break;
@@ -659,7 +1341,6 @@ namespace llarp
             LogError("invalid command ", int(result[PacketOverhead + 1]), " from ", m_RemoteAddr);
         }
       }
-      SendMACK();
       Pump();
       m_Parent->PumpDone();
     }
@@ -679,18 +1360,18 @@ namespace llarp
         return;
       }
       LogDebug("got ", int(numAcks), " mack from ", m_RemoteAddr);
+      const auto now = m_Parent->Now();
       byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
       while (numAcks > 0)
       {
         uint64_t acked = bufbe64toh(ptr);
         LogDebug("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
-        if (itr != m_TXMsgs.end())
+        if (auto msg = m_TXMsgs.Take(acked))
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
-          itr->second.Completed();
-          m_TXMsgs.erase(itr);
+          OnTXCompleted(*msg, now);
+          msg->Completed();
         }
         else
         {
@@ -711,10 +1392,9 @@ namespace llarp
       }
       uint64_t txid = bufbe64toh(data.data() + CommandOverhead + PacketOverhead);
       LogDebug("got nack on ", txid, " from ", m_RemoteAddr);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      if (const auto* msg = m_TXMsgs.Find(txid))
       {
-        EncryptAndSend(itr->second.XMIT());
+        EncryptAndSend(msg->XMIT());
       }
       m_LastRX = m_Parent->Now();
     }
@@ -722,9 +1402,7 @@ namespace llarp
     void
     Session::HandleXMIT(Packet_t data)
     {
-      static constexpr size_t XMITOverhead =
-          (CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t)
-           + ShortHash::SIZE);
+      static constexpr size_t XMITOverhead = CommandOverhead + PacketOverhead + XMITHeaderSize;
       if (data.size() < XMITOverhead)
       {
         LogError("short XMIT from ", m_RemoteAddr);
@@ -736,50 +1414,57 @@ namespace llarp
                   + PacketOverhead};
       LogDebug("rxid=", rxid, " sz=", sz, " h=", h.ToHex());
       m_LastRX = m_Parent->Now();
+      // the XMIT carries a whole fragment when there is more than one, so its size says what
+      // the remote cut the message into
+      const size_t first = data.size() - XMITOverhead;
+      const size_t fragsz = sz > first ? first : FragmentSize;
+      if (fragsz < FragmentSize or fragsz > MaxFragmentSize)
       {
-        // check for replay
-        auto itr = m_ReplayFilter.find(rxid);
-        if (itr != m_ReplayFilter.end())
-        {
-          m_SendMACKs.emplace(rxid);
-          LogDebug("duplicate rxid=", rxid, " from ", m_RemoteAddr);
-          return;
-        }
+        LogError("bad fragment size ", fragsz, " in XMIT from ", m_RemoteAddr);
+        return;
+      }
+      // check for replay
+      if (m_ReplayFilter.Contains(rxid))
+      {
+        QueueMACK(rxid);
+        LogDebug("duplicate rxid=", rxid, " from ", m_RemoteAddr);
+        return;
       }
       {
         const auto now = m_Parent->Now();
-        auto itr = m_RXMsgs.find(rxid);
-        if (itr == m_RXMsgs.end())
+        const auto [rxmsg, inserted] = m_RXMsgs.Emplace(rxid, rxid, sz, std::move(h), now, fragsz);
+        if (rxmsg == nullptr)
+        {
+          LogDebug("rxid=", rxid, " too far from messages in flight from ", m_RemoteAddr);
+          return;
+        }
+        if (not inserted)
+        {
+          LogDebug("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
+          return;
+        }
+        sz = std::min(size_t{sz}, fragsz);
+        if (first == sz)
         {
-          itr =
-              m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, std::move(h), m_Parent->Now()}).first;
-          sz = std::min(sz, uint16_t{FragmentSize});
-          if ((data.size() - XMITOverhead) == sz)
           {
+            const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
+            rxmsg->HandleData(0, buf, now);
+            if (not rxmsg->IsCompleted())
             {
-              const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
-              itr->second.HandleData(0, buf, now);
-              if (not itr->second.IsCompleted())
-              {
-                return;
-              }
+              return;
+            }
 
-              if (not itr->second.Verify())
-              {
-                LogError("bad short xmit hash from ", m_RemoteAddr);
-                return;
-              }
+            if (not rxmsg->Verify())
+            {
+              LogError("bad short xmit hash from ", m_RemoteAddr);
+              return;
             }
-            auto msg = std::move(itr->second);
-            const llarp_buffer_t buf(msg.m_Data);
-            m_Parent->HandleMessage(this, buf);
-            if (m_ReplayFilter.emplace(rxid, m_Parent->Now()).second)
-              m_SendMACKs.emplace(rxid);
-            m_RXMsgs.erase(rxid);
           }
+          auto msg = m_RXMsgs.Take(rxid);
+          DeliverMessage(llarp_buffer_t(msg->m_Data));
+          if (m_ReplayFilter.Insert(rxid))
+            QueueMACK(rxid);
         }
-        else
-          LogDebug("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
       }
     }
 
@@ -794,10 +1479,10 @@ namespace llarp
       m_LastRX = m_Parent->Now();
       uint16_t sz = bufbe16toh(data.data() + CommandOverhead + PacketOverhead);
       uint64_t rxid = bufbe64toh(data.data() + CommandOverhead + sizeof(uint16_t) + PacketOverhead);
-      auto itr = m_RXMsgs.find(rxid);
-      if (itr == m_RXMsgs.end())
+      auto* rxmsg = m_RXMsgs.Find(rxid);
+      if (rxmsg == nullptr)
       {
-        if (m_ReplayFilter.find(rxid) == m_ReplayFilter.end())
+        if (not m_ReplayFilter.Contains(rxid))
         {
           LogDebug("no rxid=", rxid, " for ", m_RemoteAddr);
           auto nack = CreatePacket(Command::eNACK, 8);
@@ -807,7 +1492,7 @@ namespace llarp
         else
         {
           LogDebug("replay hit for rxid=", rxid, " for ", m_RemoteAddr);
-          m_SendMACKs.emplace(rxid);
+          QueueMACK(rxid);
         }
         return;
       }
@@ -815,25 +1500,43 @@ namespace llarp
       {
         const llarp_buffer_t buf(
             data.data() + PacketOverhead + 12, data.size() - (PacketOverhead + 12));
-        itr->second.HandleData(sz, buf, m_Parent->Now());
+        rxmsg->HandleData(sz, buf, m_Parent->Now());
       }
 
-      if (itr->second.IsCompleted())
+      if (rxmsg->IsCompleted())
       {
-        if (itr->second.Verify())
+        auto msg = m_RXMsgs.Take(rxid);
+        if (msg->Verify())
         {
-          auto msg = std::move(itr->second);
-          const llarp_buffer_t buf(msg.m_Data);
-          m_Parent->HandleMessage(this, buf);
-          if (m_ReplayFilter.emplace(itr->first, m_Parent->Now()).second)
-            m_SendMACKs.emplace(itr->first);
+          DeliverMessage(llarp_buffer_t(msg->m_Data));
+          if (m_ReplayFilter.Insert(rxid))
+            QueueMACK(rxid);
         }
         else
         {
-          LogError("hash mismatch for message ", itr->first);
+          LogError("hash mismatch for message ", rxid);
+        }
+      }
+    }
+
+    void
+    Session::SendACKSFor(InboundMessage& msg, llarp_time_t now)
+    {
+      if (m_RemoteSACK)
+      {
+        EncryptAndSend(msg.SACK());
+      }
+      else
+      {
+        // older routers log and drop commands they do not know so we only probe for a bit
+        EncryptAndSend(msg.ACKS());
+        if (m_SACKProbes < MaxSACKProbes)
+        {
+          m_SACKProbes++;
+          EncryptAndSend(msg.SACK());
         }
-        m_RXMsgs.erase(itr);
       }
+      msg.ACKSSent(now);
     }
 
     void
@@ -847,23 +1550,92 @@ namespace llarp
       const auto now = m_Parent->Now();
       m_LastRX = now;
       uint64_t txid = bufbe64toh(data.data() + 2 + PacketOverhead);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr == m_TXMsgs.end())
+      HandleFragmentAcks(txid, FragmentBits{data[10 + PacketOverhead]}, now);
+    }
+
+    void
+    Session::HandleSACK(Packet_t data)
+    {
+      static constexpr size_t SACKOverhead = CommandOverhead + PacketOverhead + 9;
+      if (data.size() < SACKOverhead)
+      {
+        LogError("short SACK from ", m_RemoteAddr);
+        return;
+      }
+      const byte_t* ptr = data.data() + CommandOverhead + PacketOverhead;
+      const uint64_t txid = bufbe64toh(ptr);
+      const size_t numBlocks = ptr[sizeof(uint64_t)];
+      if (numBlocks > MaxSACKBlocks or data.size() < SACKOverhead + (numBlocks * 4))
+      {
+        LogError("bad SACK from ", m_RemoteAddr);
+        return;
+      }
+      const auto now = m_Parent->Now();
+      m_LastRX = now;
+      m_RemoteSACK = true;
+      ptr += sizeof(uint64_t) + 1;
+      FragmentBits acks;
+      for (size_t n = 0; n < numBlocks; ++n)
+      {
+        const size_t start = bufbe16toh(ptr);
+        const size_t len = bufbe16toh(ptr + sizeof(uint16_t));
+        ptr += 2 * sizeof(uint16_t);
+        if (start + len > MaxFragments)
+        {
+          LogError("SACK range out of bounds from ", m_RemoteAddr);
+          return;
+        }
+        for (size_t idx = start; idx < start + len; ++idx)
+          acks.set(idx);
+      }
+      HandleFragmentAcks(txid, acks, now);
+    }
+
+    void
+    Session::HandleFragmentAcks(uint64_t txid, const FragmentBits& acks, llarp_time_t now)
+    {
+      auto* txmsg = m_TXMsgs.Find(txid);
+      if (txmsg == nullptr)
       {
         LogDebug("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      auto& msg = *txmsg;
+      const auto before = msg.InFlight();
+      msg.Ack(acks);
+      const auto after = msg.InFlight();
+      if (after < before)
+      {
+        m_CC.OnAcked(before - after, now);
+        m_InFlight -= std::min(m_InFlight, before - after);
+      }
 
-      if (itr->second.IsTransmitted())
+      if (msg.IsTransmitted())
       {
-        LogDebug("sent message ", itr->first);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
+        LogDebug("sent message ", txid);
+        // take it out first as the completion handler may queue more messages
+        auto done = m_TXMsgs.Take(txid);
+        OnTXCompleted(*done, now);
+        done->Completed();
+        return;
       }
-      else
+      // fragments acked past a hole tell us it was lost before the retransmit timeout does
+      const auto lost = msg.FindLost(now, m_CC.SmoothedRTT() / 2);
+      if (lost.any())
+      {
+        LogDebug("fast retransmit ", lost.count(), " fragments of ", txid, " to ", m_RemoteAddr);
+        m_CC.OnLoss(now);
+        msg.m_Retransmits++;
+        m_Stats.totalRetransmitTX++;
+        msg.RetransmitFragments(lost, util::memFn(&Session::EncryptAndSend, this), now);
+      }
+      else if (msg.ShouldFlush(now, RetransmitTimeout()))
       {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        // acks come right after the xmit lands so anything missing this long is lost
+        m_CC.OnLoss(now);
+        msg.m_Retransmits++;
+        m_Stats.totalRetransmitTX++;
+        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
       }
     }
 
@@ -873,9 +1645,111 @@ namespace llarp
       Close();
     }
 
-    void Session::HandlePING(Packet_t)
+    void Session::HandlePING(Packet_t pkt)
     {
       m_LastRX = m_Parent->Now();
+      if (pkt.size() < PacketOverhead + CommandOverhead)
+        return;
+      const byte_t* body = pkt.data() + PacketOverhead + CommandOverhead;
+      const size_t sz = pkt.size() - (PacketOverhead + CommandOverhead);
+      if (HasMagic(CipherMagic, body, sz, 1))
+      {
+        const byte_t ciphers = body[CipherMagic.size()];
+        if ((ciphers & eCipherAESGCM) and m_Parent->UseAESGCM()
+            and not m_RemoteAESGCM.exchange(true, std::memory_order_release))
+          LogDebug("sealing with aes-256-gcm to ", m_RemoteAddr);
+      }
+      else if (HasMagic(MTUProbeMagic, body, sz, sizeof(uint16_t)))
+      {
+        // only ack what really made it here whole
+        const uint16_t fragsz = bufbe16toh(body + MTUProbeMagic.size());
+        if (sz < XMITHeaderSize + fragsz)
+          return;
+        auto ack = CreatePacket(Command::ePING, MTUAckMagic.size() + sizeof(uint16_t));
+        byte_t* ackBody = ack.data() + PacketOverhead + CommandOverhead;
+        std::copy(MTUAckMagic.begin(), MTUAckMagic.end(), ackBody);
+        htobe16buf(ackBody + MTUAckMagic.size(), fragsz);
+        EncryptAndSend(std::move(ack));
+      }
+      else if (HasMagic(MTUAckMagic, body, sz, sizeof(uint16_t)))
+        GotMTUProbeAck(bufbe16toh(body + MTUAckMagic.size()));
+      else if (HasMagic(PathChallengeMagic, body, sz, PathChallenge_t::SIZE))
+      {
+        auto resp = CreatePacket(Command::ePING, PathResponseMagic.size() + PathChallenge_t::SIZE);
+        byte_t* respBody = resp.data() + PacketOverhead + CommandOverhead;
+        std::copy(PathResponseMagic.begin(), PathResponseMagic.end(), respBody);
+        std::copy_n(
+            body + PathChallengeMagic.size(),
+            PathChallenge_t::SIZE,
+            respBody + PathResponseMagic.size());
+        EncryptAndSend(std::move(resp));
+      }
+      else if (HasMagic(PathResponseMagic, body, sz, PathChallenge_t::SIZE))
+        GotPathResponse(PathChallenge_t{body + PathResponseMagic.size()});
+      else if (HasMagic(TicketMagic, body, sz, Ticket_t::SIZE) and not m_Inbound)
+      {
+        m_Parent->PutTicket(
+            m_RemoteRC.pubkey,
+            Ticket_t{body + TicketMagic.size()},
+            ResumeSecretFor(m_SessionKey));
+      }
+    }
+
+    void
+    Session::ProbeMTU(llarp_time_t now)
+    {
+      if (m_ProbeIdx >= FragmentSizes.size() or now < m_NextProbeAt)
+        return;
+      if (m_ProbeSentAt > 0s)
+      {
+        if (now - m_ProbeSentAt < MTUProbeTimeout)
+          return;
+        m_ProbeSentAt = 0s;
+        if (++m_ProbeTries >= MaxMTUProbeTries)
+        {
+          LogDebug("settled on ", m_FragSize, " byte fragments to ", m_RemoteAddr);
+          m_ProbeTries = 0;
+          m_NextProbeAt = now + MTUReprobeInterval;
+          return;
+        }
+      }
+      // the probe makes the same datagram an XMIT at that fragment size does
+      const size_t fragsz = FragmentSizes[m_ProbeIdx];
+      auto pkt = CreatePacket(Command::ePING, XMITHeaderSize + fragsz, 0, 0);
+      byte_t* body = pkt.data() + PacketOverhead + CommandOverhead;
+      std::copy(MTUProbeMagic.begin(), MTUProbeMagic.end(), body);
+      htobe16buf(body + MTUProbeMagic.size(), fragsz);
+      m_ProbeSentAt = now;
+      EncryptAndSend(std::move(pkt));
+    }
+
+    void
+    Session::GotMTUProbeAck(size_t fragsz)
+    {
+      // a late ack for a probe we gave up on still counts
+      if (m_ProbeIdx >= FragmentSizes.size() or fragsz != FragmentSizes[m_ProbeIdx])
+        return;
+      LogDebug("path to ", m_RemoteAddr, " carries ", fragsz, " byte fragments");
+      m_FragSize = fragsz;
+      m_ProbeIdx++;
+      m_ProbeSentAt = 0s;
+      m_ProbeTries = 0;
+      m_NextProbeAt = 0s;
+    }
+
+    void
+    Session::MTUBlackHole(llarp_time_t now)
+    {
+      if (m_FragSize == FragmentSize)
+        return;
+      LogInfo(
+          "messages with ", m_FragSize, " byte fragments to ", m_RemoteAddr, " time out, back to ",
+          FragmentSize);
+      m_FragSize = FragmentSize;
+      m_ProbeIdx = 1;
+      m_ProbeSentAt = 0s;
+      m_ProbeTries = 0;
+      m_NextProbeAt = now + MTUReprobeInterval;
     }
 
     bool
@@ -883,12 +1757,103 @@ namespace llarp
     {
       if (m_State == State::Ready)
       {
-        EncryptAndSend(CreatePacket(Command::ePING, 0));
+        // the ciphers we open go in every ping so a lost one does not matter
+        auto pkt = CreatePacket(Command::ePING, CipherMagic.size() + 1);
+        byte_t* body = pkt.data() + PacketOverhead + CommandOverhead;
+        std::copy(CipherMagic.begin(), CipherMagic.end(), body);
+        body[CipherMagic.size()] = eCipherXChaCha | (m_Parent->UseAESGCM() ? eCipherAESGCM : 0);
+        EncryptAndSend(std::move(pkt));
         return true;
       }
       return false;
     }
 
+    void
+    Session::AdvertiseCiphers()
+    {
+      DeriveAESGCMKey();
+      SendKeepAlive();
+    }
+
+    void
+    Session::DeriveAESGCMKey()
+    {
+      if (m_Parent->UseAESGCM())
+      {
+        const std::string_view context{"iwp aes-256-gcm"};
+        HotCrypto()->hmac(
+            m_AESGCMKey.data(), llarp_buffer_t(context.data(), context.size()), m_SessionKey);
+      }
+    }
+
+    void
+    Session::SealAESGCM(CryptoQueue_t& pkts)
+    {
+      const auto num = pkts.size();
+      std::vector<CryptoSpan> bufs;
+      std::vector<CryptoSpan> ads;
+      std::vector<TunnelNonce> nonces;
+      std::vector<GCMTag> tags(num);
+      bufs.reserve(num);
+      ads.reserve(num);
+      nonces.reserve(num);
+      for (auto& pkt : pkts)
+      {
+        std::copy(AESGCMMarker.begin(), AESGCMMarker.end(), pkt.data() + GCMTAGSIZE);
+        // the random nonce from CreatePacket, with which side we are and a counter in front
+        byte_t* nonce = pkt.data() + HMACSIZE;
+        nonce[0] = m_Inbound ? 1 : 0;
+        nonce[1] = nonce[2] = nonce[3] = 0;
+        htobe64buf(nonce + 4, m_AESGCMSeq.fetch_add(1, std::memory_order_relaxed));
+        nonces.emplace_back(nonce);
+        bufs.emplace_back(CryptoSpan{pkt.data() + PacketOverhead, pkt.size() - PacketOverhead});
+        // the marker and the whole nonce are authenticated like the keyed hash covered them
+        ads.emplace_back(CryptoSpan{pkt.data() + GCMTAGSIZE, PacketOverhead - GCMTAGSIZE});
+      }
+      HotCrypto()->aes256gcm_seal_batch(
+          bufs.data(), ads.data(), nonces.data(), tags.data(), num, m_AESGCMKey);
+      for (size_t idx = 0; idx < num; ++idx)
+        std::copy_n(tags[idx].begin(), GCMTAGSIZE, pkts[idx].data());
+    }
+
+    void
+    Session::OpenAESGCM(CryptoQueue_t& pkts, CryptoQueue_t& out)
+    {
+      const auto sealed = std::partition(
+          pkts.begin(), pkts.end(), [](const Packet_t& pkt) { return not IsAESGCM(pkt); });
+      const size_t num = std::distance(sealed, pkts.end());
+      if (num == 0)
+        return;
+      std::vector<CryptoSpan> bufs;
+      std::vector<CryptoSpan> ads;
+      std::vector<TunnelNonce> nonces;
+      std::vector<GCMTag> tags;
+      bufs.reserve(num);
+      ads.reserve(num);
+      nonces.reserve(num);
+      tags.reserve(num);
+      for (auto itr = sealed; itr != pkts.end(); ++itr)
+      {
+        auto& pkt = *itr;
+        tags.emplace_back(pkt.data());
+        nonces.emplace_back(pkt.data() + HMACSIZE);
+        bufs.emplace_back(CryptoSpan{pkt.data() + PacketOverhead, pkt.size() - PacketOverhead});
+        ads.emplace_back(CryptoSpan{pkt.data() + GCMTAGSIZE, PacketOverhead - GCMTAGSIZE});
+      }
+      std::unique_ptr<bool[]> valid{new bool[num]};
+      HotCrypto()->aes256gcm_open_batch(
+          bufs.data(), ads.data(), nonces.data(), tags.data(), num, m_AESGCMKey, valid.get());
+      size_t idx = 0;
+      for (auto itr = sealed; itr != pkts.end(); ++itr, ++idx)
+      {
+        if (valid[idx])
+          out.emplace_back(std::move(*itr));
+        else
+          LogError("aes-256-gcm tag mismatch from ", m_RemoteAddr, " size=", itr->size());
+      }
+      pkts.erase(sealed, pkts.end());
+    }
+
     bool
     Session::IsEstablished() const
     {
@@ -898,7 +1863,8 @@ namespace llarp
     bool
     Session::Recv_LL(ILinkSession::Packet_t data)
     {
-      m_RXRate += data.size();
+      alloc::Scope allocScope{alloc::LinkBuffers};
+      m_RXRate.Add(data.size());
 
       // TODO: differentiate between good and bad RX packets here
       m_Stats.totalPacketsRX++;
@@ -911,7 +1877,12 @@ namespace llarp
             // enter introduction phase
             if (DecryptMessageInPlace(data))
             {
-              HandleGotIntro(std::move(data));
+              if (data.size() == Resumption::SIZE + PacketOverhead)
+              {
+                HandleResumption(std::move(data));
+                return true;
+              }
+              return HandleGotIntro(std::move(data));
             }
             else
             {
@@ -2,10 +2,16 @@
 #define LLARP_IWP_SESSION_HPP
 
 #include <link/session.hpp>
+#include <iwp/congestion.hpp>
 #include <iwp/linklayer.hpp>
 #include <iwp/message_buffer.hpp>
 #include <net/ip_address.hpp>
+#include <util/id_ring.hpp>
+#include <util/rate_estimator.hpp>
+#include <util/replay_window.hpp>
 
+#include <array>
+#include <atomic>
 #include <unordered_set>
 #include <deque>
 #include <queue>
@@ -18,21 +24,58 @@ namespace llarp
     static constexpr size_t PacketOverhead = HMACSIZE + TUNNONCESIZE;
     /// creates a packet with plaintext size + wire overhead + random pad
     ILinkSession::Packet_t
-    CreatePacket(Command cmd, size_t plainsize, size_t min_pad = 16, size_t pad_variance = 16);
+    CreatePacket(Command cmd, size_t plainsize, size_t min_pad, size_t pad_variance);
+    /// a control packet padded as the link padding profile says
+    ILinkSession::Packet_t
+    CreatePacket(Command cmd, size_t plainsize);
+    /// identity key, transport key, nonce and signature a remote opens a session with
+    using Introduction =
+        AlignedBuffer<PubKey::SIZE + PubKey::SIZE + TunnelNonce::SIZE + Signature::SIZE>;
+    /// a ticket and a fresh nonce a remote sends in place of an intro to resume a session
+    using Resumption = AlignedBuffer<Ticket_t::SIZE + TunnelNonce::SIZE>;
+    static_assert(
+        Resumption::SIZE != Introduction::SIZE
+        and Resumption::SIZE != Introduction::SIZE + Cookie_t::SIZE);
+    /// what a remote that moved echoes to prove it is at its new address
+    using PathChallenge_t = AlignedBuffer<16>;
+    /// how long a new address has to answer our challenge
+    static constexpr std::chrono::milliseconds PathChallengeTimeout = 5s;
+    /// addresses we challenge at once for one session
+    static constexpr size_t MaxPathChallenges = 4;
+    /// how long we wait on the intro ack to a resumption before we send a full intro
+    static constexpr std::chrono::milliseconds ResumeTimeout = 1s;
     /// Time how long we try delivery for
     static constexpr std::chrono::milliseconds DeliveryTimeout = 500ms;
     /// Time how long we wait to recieve a message
     static constexpr auto ReceivalTimeout = (DeliveryTimeout * 8) / 5;
-    /// How long to keep a replay window for
-    static constexpr auto ReplayWindow = (ReceivalTimeout * 3) / 2;
     /// How often to acks RX messages
     static constexpr auto ACKResendInterval = DeliveryTimeout / 2;
     /// How often to retransmit TX fragments
     static constexpr auto TXFlushInterval = (DeliveryTimeout / 5) * 4;
+    /// Shortest time we wait on acks before resending fragments
+    static constexpr std::chrono::milliseconds MinRetransmitTimeout = 100ms;
     /// How often we send a keepalive
     static constexpr std::chrono::milliseconds PingInterval = 5s;
     /// How long we wait for a session to die with no tx from them
     static constexpr auto SessionAliveTimeout = PingInterval * 5;
+    /// How often we send a keepalive while idle, the link only ticks once per IdleWakeupWindow
+    /// then so a ping can go out up to a window late
+    static constexpr std::chrono::milliseconds IdlePingInterval =
+        SessionAliveTimeout - IdleWakeupWindow - PingInterval;
+    static_assert(IdlePingInterval >= PingInterval);
+    /// how long we wait on the ack for a path mtu probe before we count it lost
+    static constexpr std::chrono::milliseconds MTUProbeTimeout = 1s;
+    /// lost probes in a row before we settle on the fragment size below
+    static constexpr size_t MaxMTUProbeTries = 3;
+    /// how long we stay settled before probing again, the path may have changed
+    static constexpr std::chrono::milliseconds MTUReprobeInterval = 10min;
+
+    /// ciphers a session can seal with, a bitmask in the pings we send
+    enum CipherSuite : byte_t
+    {
+      eCipherXChaCha = 1 << 0,
+      eCipherAESGCM = 1 << 1
+    };
 
     struct Session : public ILinkSession, public std::enable_shared_from_this<Session>
     {
@@ -40,6 +83,17 @@ namespace llarp
 
       /// maximum number of messages we can ack in a multiack
       static constexpr std::size_t MaxACKSInMACK = 1024 / sizeof(uint64_t);
+      /// how many eSACK we send next to eACKS before we give up on the remote understanding them
+      static constexpr std::size_t MaxSACKProbes = 8;
+      /// how many cookies we take before we stop sending intros, anyone can forge a cookie
+      /// request so this bounds how long one can keep us from getting an intro ack
+      static constexpr std::size_t MaxCookieTries = 3;
+      /// datagrams interactive and bulk messages may send per round once control and path
+      /// builds are out, so interactive gets three quarters of a window both want
+      static constexpr std::array<std::size_t, NumTrafficClasses> TXQuantum = {
+          0, 0, 3 * MaxFragments, MaxFragments};
+      /// messages we hold back behind a LIM while its signature is checked
+      static constexpr std::size_t MaxHeldMessages = 64;
 
       /// outbound session
       Session(LinkLayer* parent, const RouterContact& rc, const AddressInfo& ai);
@@ -55,7 +109,10 @@ namespace llarp
       Tick(llarp_time_t now) override;
 
       bool
-      SendMessageBuffer(ILinkSession::Message_t msg, CompletionHandler resultHandler) override;
+      SendMessageBuffer(
+          ILinkSession::Message_t msg,
+          CompletionHandler resultHandler,
+          TrafficClass cls) override;
 
       void
       Send_LL(const byte_t* buf, size_t sz);
@@ -76,6 +133,24 @@ namespace llarp
       bool
       IsEstablished() const override;
 
+      bool
+      HandleLIM(const LinkIntroMessage* msg) override;
+
+      /// make this a ready session keyed as one a capture logged, so the traffic that capture
+      /// has for it opens when it is replayed offline. sends nothing
+      void
+      RestoreForReplay(const RouterID& remote, const SharedSecret& key);
+
+      /// true if a packet from an address we do not know is keyed for this session, the remote
+      /// may have moved
+      bool
+      Authenticates(const llarp_buffer_t& pkt) const;
+
+      /// a packet keyed for us came from another address, have the address prove it is the
+      /// remote before we send there
+      void
+      ChallengeAddress(const IpAddress& addr);
+
       bool
       TimedOut(llarp_time_t now) const override;
 
@@ -88,7 +163,7 @@ namespace llarp
       IpAddress
       GetRemoteEndpoint() const override
       {
-        return m_RemoteAddr;
+        return m_PeerAddr;
       }
 
       RouterContact
@@ -97,6 +172,12 @@ namespace llarp
         return m_RemoteRC;
       }
 
+      std::optional<RouterVersion>
+      GetRemoteVersion() const override
+      {
+        return m_RemoteRC.routerVersion;
+      }
+
       size_t
       SendQueueBacklog() const override
       {
@@ -151,7 +232,19 @@ namespace llarp
       /// parent link layer
       LinkLayer* const m_Parent;
       const llarp_time_t m_CreatedAt;
+      /// where the session started, what we log it by
       const IpAddress m_RemoteAddr;
+      /// where the remote is now, it only differs from m_RemoteAddr once the remote moved.
+      /// only touched on the logic thread, workers get it handed to them
+      IpAddress m_PeerAddr;
+      /// addresses we asked to prove they are the remote, and what they must echo
+      struct PathChallenge
+      {
+        IpAddress addr;
+        PathChallenge_t nonce;
+        llarp_time_t sentAt;
+      };
+      std::vector<PathChallenge> m_PathChallenges;
 
       AddressInfo m_ChosenAI;
       /// remote rc
@@ -160,55 +253,202 @@ namespace llarp
       SharedSecret m_SessionKey;
       /// session token
       AlignedBuffer<24> token;
+      /// the remote's identity key hashed, what intros and cookie requests are keyed with
+      SharedSecret m_IntroKey;
+      /// cookie the remote asked us to send back in our intro, zero until it asks
+      Cookie_t m_Cookie;
+      size_t m_CookieTries = 0;
+
+      /// set while we wait on the answer to a resumption
+      bool m_Resuming = false;
+      llarp_time_t m_ResumeSentAt = 0s;
 
       PubKey m_ExpectedIdent;
       PubKey m_RemoteOnionKey;
+      /// set while our intro is signed or the remote's is checked on a worker
+      bool m_HandshakeBusy = false;
+      /// set while a LIM from the remote is checked on a worker
+      bool m_LIMPending = false;
+      /// messages that came in behind a LIM being checked, in order
+      std::vector<std::vector<byte_t>> m_HeldRX;
 
       llarp_time_t m_LastTX = 0s;
       llarp_time_t m_LastRX = 0s;
 
       // accumulate for periodic rate calculation
-      uint64_t m_TXRate = 0;
-      uint64_t m_RXRate = 0;
+      util::RateEstimator m_TXRate;
+      util::RateEstimator m_RXRate;
 
       llarp_time_t m_ResetRatesAt = 0s;
 
+      /// the remote said it opens aes-256-gcm, what we send is sealed with it from then on
+      std::atomic<bool> m_RemoteAESGCM{false};
+      /// m_SessionKey hashed for aes-256-gcm, set once we are ready
+      SharedSecret m_AESGCMKey;
+      /// counts our aes-256-gcm nonces, both directions share the key so the nonce also carries
+      /// which side we are
+      std::atomic<uint64_t> m_AESGCMSeq{0};
+
       uint64_t m_TXID = 0;
 
       bool
       ShouldResetRates(llarp_time_t now) const;
 
       void
-      ResetRates();
+      ResetRates(llarp_time_t now);
+
+      /// messages by id, the remote hands out sequential ids just like we do
+      util::IdRing<InboundMessage, MaxSendQueueSize> m_RXMsgs;
+      util::IdRing<OutboundMessage, MaxSendQueueSize> m_TXMsgs;
+      /// txids of messages waiting on the congestion window by traffic class, each in the order
+      /// they were queued
+      std::array<std::deque<uint64_t>, NumTrafficClasses> m_TXPending;
+      /// datagrams interactive and bulk may still send this round
+      std::array<std::size_t, NumTrafficClasses> m_TXDeficit{};
+
+      CongestionControl m_CC;
+      /// datagrams of transmitted messages that are not acked yet, recounted every pump
+      size_t m_InFlight = 0;
+
+      /// put queued messages on the wire as far as the congestion window and pacing allow,
+      /// control then path builds strictly first, then interactive and bulk by TXQuantum
+      void
+      TransmitPending(llarp_time_t now);
+
+      /// send what of cls fits in budget datagrams, false if congestion control stopped us
+      bool
+      TransmitClass(TrafficClass cls, size_t& budget, llarp_time_t now);
+
+      /// how long we wait on acks for a fragment before we resend it
+      llarp_time_t
+      RetransmitTimeout() const;
+
+      /// a transmitted message was fully acked
+      void
+      OnTXCompleted(const OutboundMessage& msg, llarp_time_t now);
+
+      /// set once the remote sent us an eSACK, we then stop sending them eACKS
+      bool m_RemoteSACK = false;
+      size_t m_SACKProbes = 0;
+
+      /// send fragment acks for an inbound message in whatever format the remote understands
+      void
+      SendACKSFor(InboundMessage& msg, llarp_time_t now);
 
-      std::unordered_map<uint64_t, InboundMessage> m_RXMsgs;
-      std::unordered_map<uint64_t, OutboundMessage> m_TXMsgs;
+      /// apply fragment acks from eACKS or eSACK
+      void
+      HandleFragmentAcks(uint64_t txid, const FragmentBits& acks, llarp_time_t now);
 
-      /// maps rxid to time recieved
-      std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
+      /// rxids we got recently
+      util::ReplayWindow<MaxSendQueueSize> m_ReplayFilter;
       /// rx messages to send in next round of multiacks
-      std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_SendMACKs;
+      std::vector<uint64_t> m_SendMACKs;
+      /// when the oldest ack in m_SendMACKs has waited long enough
+      llarp_time_t m_MACKDue = 0s;
+
+      /// hold an ack for rxid so it folds into one multiack with the others
+      void
+      QueueMACK(uint64_t rxid);
+
+      /// true if the held acks are over budget, due, or can go out with data we are sending
+      bool
+      ShouldSendMACK(llarp_time_t now) const;
 
-      using CryptoQueue_t = std::list<Packet_t>;
+      /// contiguous so the workers can hand the whole batch to the crypto backend
+      using CryptoQueue_t = std::vector<Packet_t>;
       using CryptoQueue_ptr = std::shared_ptr<CryptoQueue_t>;
       CryptoQueue_ptr m_EncryptNext;
       CryptoQueue_ptr m_DecryptNext;
+      /// when the first packet went into each, for the stage times
+      using Clock_t = metrics::Histogram::Clock_t;
+      Clock_t::time_point m_EncryptQueuedAt;
+      Clock_t::time_point m_DecryptQueuedAt;
 
       void
-      EncryptWorker(CryptoQueue_ptr msgs);
+      EncryptWorker(CryptoQueue_ptr msgs, Clock_t::time_point queued, SockAddr to);
 
+      /// seal pkts with aes-256-gcm in place of xchacha20 and the keyed hash
       void
-      DecryptWorker(CryptoQueue_ptr msgs);
+      SealAESGCM(CryptoQueue_t& pkts);
 
+      /// open the aes-256-gcm sealed packets in pkts and move the ones that authenticate to out,
+      /// leaving the rest in pkts
       void
-      HandlePlaintext(CryptoQueue_ptr msgs);
+      OpenAESGCM(CryptoQueue_t& pkts, CryptoQueue_t& out);
+
+      /// what we cut messages into, raised as the remote acks our path mtu probes
+      size_t m_FragSize = FragmentSize;
+      /// index in FragmentSizes of the size we probe for next
+      size_t m_ProbeIdx = 1;
+      /// when the probe we wait on went out, zero if none is out
+      llarp_time_t m_ProbeSentAt = 0s;
+      size_t m_ProbeTries = 0;
+      llarp_time_t m_NextProbeAt = 0s;
+
+      /// send a datagram as big as an XMIT at the next fragment size up if it is time
+      void
+      ProbeMTU(llarp_time_t now);
+
+      /// the remote got a probe of size fragsz, send bigger fragments from now on
+      void
+      GotMTUProbeAck(size_t fragsz);
 
+      /// a message with fragments above the smallest size timed out, the path may no longer
+      /// carry them
       void
+      MTUBlackHole(llarp_time_t now);
+
+      /// once we are ready, key aes-256-gcm if we use it and tell the remote what we open
+      void
+      AdvertiseCiphers();
+
+      /// hash m_SessionKey into m_AESGCMKey if we use aes-256-gcm
+      void
+      DeriveAESGCMKey();
+
+      /// send encrypted datagrams, coalescing runs of equally sized ones into segmented sends
+      void
+      SendCoalesced(const std::vector<llarp_udp_pkt>& pkts);
+
+      void
+      DecryptWorker(CryptoQueue_ptr msgs, Clock_t::time_point queued);
+
+      void
+      HandlePlaintext(CryptoQueue_ptr msgs, Clock_t::time_point decrypted);
+
+      /// false if the intro was dropped because too many handshakes are queued
+      bool
       HandleGotIntro(Packet_t pkt);
 
+      /// back on the logic thread once an inbound intro was checked and the key made from it
+      void
+      IntroChecked(bool ok, const PubKey& ident, const PubKey& onionKey, const SharedSecret& key);
+
+      /// answer an intro or resumption, from here on we run under key
+      void
+      SendIntroAck(const PubKey& ident, const SharedSecret& key);
+
+      void
+      SendResumption(const Ticket_t& ticket, const SharedSecret& secret);
+
+      void
+      HandleResumption(Packet_t pkt);
+
+      /// give the remote a ticket to resume this session with, we only hand them out inbound
+      void
+      SendTicket();
+
+      /// an answer to our challenge came back, the address it went to is where the remote is
+      void
+      GotPathResponse(const PathChallenge_t& nonce);
+
       void
       HandleGotIntroAck(Packet_t pkt);
 
+      /// true if pkt is the remote asking for a cookie in our intro rather than our intro ack
+      bool
+      TakeCookie(Packet_t& pkt);
+
       void
       HandleCreateSessionRequest(Packet_t pkt);
 
@@ -227,6 +467,18 @@ namespace llarp
       void
       GenerateAndSendIntro();
 
+      /// back on the logic thread once our intro is signed and the key for it made
+      void
+      IntroSigned(bool ok, Packet_t req, const SharedSecret& key);
+
+      /// back on the logic thread once a LIM from the remote was checked
+      void
+      LIMChecked(const LinkIntroMessage& msg, bool valid);
+
+      /// hand a message up, or hold it while a LIM is checked
+      void
+      DeliverMessage(const llarp_buffer_t& buf);
+
       bool
       GotInboundLIM(const LinkIntroMessage* msg);
 
@@ -239,6 +491,9 @@ namespace llarp
       void
       SendOurLIM(ILinkSession::CompletionHandler h = nullptr);
 
+      void
+      SendSignedLIM(const LinkIntroMessage& msg, ILinkSession::CompletionHandler h);
+
       void
       HandleXMIT(Packet_t msg);
 
@@ -248,6 +503,9 @@ namespace llarp
       void
       HandleACKS(Packet_t msg);
 
+      void
+      HandleSACK(Packet_t msg);
+
       void
       HandleNACK(Packet_t msg);
 
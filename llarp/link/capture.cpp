@@ -0,0 +1,123 @@
+#include <link/capture.hpp>
+
+#include <util/endian.hpp>
+#include <util/logging/logger.hpp>
+
+#include <array>
+#include <cstring>
+
+namespace llarp
+{
+  namespace capture
+  {
+    enum Kind : byte_t
+    {
+      eDatagram = 1,
+      eSessionKey = 2
+    };
+
+    /// kind, microseconds, v6 address, port
+    static constexpr size_t HeaderSize = 1 + 8 + 16 + 2;
+
+    bool
+    Writer::Open(const fs::path& file, bool keys)
+    {
+      m_File.open(file, std::ios::binary | std::ios::trunc);
+      if (not m_File.is_open())
+      {
+        LogError("cannot open capture file ", file);
+        return false;
+      }
+      m_File.write(Magic.data(), Magic.size());
+      m_Started = Clock_t::now();
+      m_Keys = keys;
+      if (keys)
+        LogWarn("writing session keys to ", file, ", anyone who has it can read that traffic");
+      return true;
+    }
+
+    void
+    Writer::WriteHeader(byte_t kind, const SockAddr& from)
+    {
+      std::array<byte_t, HeaderSize> hdr;
+      const auto at =
+          std::chrono::duration_cast<std::chrono::microseconds>(Clock_t::now() - m_Started);
+      const sockaddr_in6* addr = from;
+      hdr[0] = kind;
+      htobe64buf(hdr.data() + 1, at.count());
+      std::memcpy(hdr.data() + 9, &addr->sin6_addr, 16);
+      // already in network order
+      std::memcpy(hdr.data() + 25, &addr->sin6_port, 2);
+      m_File.write(reinterpret_cast<const char*>(hdr.data()), hdr.size());
+    }
+
+    void
+    Writer::Write(const SockAddr& from, const byte_t* data, size_t sz)
+    {
+      if (not IsOpen())
+        return;
+      WriteHeader(eDatagram, from);
+      std::array<byte_t, 4> len;
+      htobe32buf(len.data(), sz);
+      m_File.write(reinterpret_cast<const char*>(len.data()), len.size());
+      m_File.write(reinterpret_cast<const char*>(data), sz);
+    }
+
+    void
+    Writer::WriteKey(const SockAddr& from, const RouterID& remote, const SharedSecret& key)
+    {
+      if (not IsOpen() or not m_Keys)
+        return;
+      WriteHeader(eSessionKey, from);
+      m_File.write(reinterpret_cast<const char*>(remote.data()), remote.size());
+      m_File.write(reinterpret_cast<const char*>(key.data()), key.size());
+    }
+
+    bool
+    Reader::Open(const fs::path& file)
+    {
+      m_File.open(file, std::ios::binary);
+      std::array<char, Magic.size()> magic;
+      if (not m_File.read(magic.data(), magic.size())
+          or std::string_view{magic.data(), magic.size()} != Magic)
+      {
+        LogError(file, " is not a lokinet capture");
+        return false;
+      }
+      return true;
+    }
+
+    std::optional<Record>
+    Reader::Next()
+    {
+      std::array<byte_t, HeaderSize> hdr;
+      if (not m_File.read(reinterpret_cast<char*>(hdr.data()), hdr.size()))
+        return std::nullopt;
+      const std::chrono::microseconds at{bufbe64toh(hdr.data() + 1)};
+      sockaddr_in6 addr{};
+      addr.sin6_family = AF_INET6;
+      std::memcpy(&addr.sin6_addr, hdr.data() + 9, 16);
+      std::memcpy(&addr.sin6_port, hdr.data() + 25, 2);
+      if (hdr[0] == eDatagram)
+      {
+        std::array<byte_t, 4> len;
+        if (not m_File.read(reinterpret_cast<char*>(len.data()), len.size()))
+          return std::nullopt;
+        Datagram dgram{at, SockAddr{addr}, std::vector<byte_t>(bufbe32toh(len.data()))};
+        if (not m_File.read(reinterpret_cast<char*>(dgram.data.data()), dgram.data.size()))
+          return std::nullopt;
+        return dgram;
+      }
+      if (hdr[0] == eSessionKey)
+      {
+        SessionKey key{at, SockAddr{addr}, {}, {}};
+        if (not m_File.read(reinterpret_cast<char*>(key.remote.data()), key.remote.size())
+            or not m_File.read(reinterpret_cast<char*>(key.key.data()), key.key.size()))
+          return std::nullopt;
+        return key;
+      }
+      LogError("unknown capture record kind ", int{hdr[0]});
+      return std::nullopt;
+    }
+  }  // namespace capture
+}  // namespace llarp
@@ -0,0 +1,97 @@
+#ifndef LLARP_LINK_CAPTURE_HPP
+#define LLARP_LINK_CAPTURE_HPP
+
+#include <crypto/types.hpp>
+#include <net/sock_addr.hpp>
+#include <router_id.hpp>
+#include <util/fs.hpp>
+#include <util/types.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <variant>
+#include <vector>
+
+namespace llarp
+{
+  /// what link layers read off their sockets, written to a file as it came in so it can be fed
+  /// to a link layer again offline. a file is 8 magic bytes then records one after another,
+  /// each a kind byte, big endian microseconds since the capture started and the remote's
+  /// address and port as a v6 address, followed by a big endian length and the datagram or
+  /// by the remote's router id and the session key
+  namespace capture
+  {
+    constexpr std::string_view Magic{"lokicap1"};
+
+    struct Datagram
+    {
+      std::chrono::microseconds at;
+      SockAddr from;
+      std::vector<byte_t> data;
+    };
+
+    /// the key of a session of ours once it was set up, which is enough to open its traffic.
+    /// only ever written when asked for, for our own test nodes
+    struct SessionKey
+    {
+      std::chrono::microseconds at;
+      SockAddr from;
+      RouterID remote;
+      SharedSecret key;
+    };
+
+    using Record = std::variant<Datagram, SessionKey>;
+
+    /// appends to a capture file, only from the thread that reads the link sockets
+    struct Writer
+    {
+      /// truncates file, keys says whether session keys are written too
+      bool
+      Open(const fs::path& file, bool keys);
+
+      bool
+      IsOpen() const
+      {
+        return m_File.is_open();
+      }
+
+      bool
+      WantsKeys() const
+      {
+        return m_Keys;
+      }
+
+      void
+      Write(const SockAddr& from, const byte_t* data, size_t sz);
+
+      void
+      WriteKey(const SockAddr& from, const RouterID& remote, const SharedSecret& key);
+
+     private:
+      using Clock_t = std::chrono::steady_clock;
+
+      void
+      WriteHeader(byte_t kind, const SockAddr& from);
+
+      std::ofstream m_File;
+      Clock_t::time_point m_Started;
+      bool m_Keys = false;
+    };
+
+    struct Reader
+    {
+      bool
+      Open(const fs::path& file);
+
+      /// the next record, nullopt at the end of the file or at one cut short
+      std::optional<Record>
+      Next();
+
+     private:
+      std::ifstream m_File;
+    };
+  }  // namespace capture
+}  // namespace llarp
+
+#endif
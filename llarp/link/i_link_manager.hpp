@@ -7,6 +7,7 @@
 #include <peerstats/peer_db.hpp>
 
 #include <functional>
+#include <vector>
 
 struct llarp_buffer_t;
 
@@ -26,18 +27,39 @@ namespace llarp
     virtual LinkLayer_ptr
     GetCompatibleLink(const RouterContact& rc) const = 0;
 
+    /// every outbound link that can reach rc, the one GetCompatibleLink picks first
+    virtual std::vector<LinkLayer_ptr>
+    GetCompatibleLinks(const RouterContact& rc) const = 0;
+
     virtual IOutboundSessionMaker*
     GetSessionMaker() const = 0;
 
+    /// send an encoded link message in traffic class cls, handing msg over to the session as is
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
-        ILinkSession::CompletionHandler completed) = 0;
+        ILinkSession::Message_t msg,
+        ILinkSession::CompletionHandler completed,
+        TrafficClass cls) = 0;
 
     virtual bool
     HasSessionTo(const RouterID& remote) const = 0;
 
+    /// messages queued on the session SendTo would use for remote, the max size_t if there is
+    /// no session to it
+    virtual size_t
+    SendQueueBacklogTo(const RouterID& remote) const = 0;
+
+    /// router version of remote as its session has it, nullopt if there is no session to it
+    /// or its rc has none
+    virtual std::optional<RouterVersion>
+    RemoteVersionOf(const RouterID& remote) const = 0;
+
+    /// smoothed rtt of our session to remote, nullopt if there is none or it has not measured
+    /// one yet
+    virtual std::optional<llarp_time_t>
+    RTTTo(const RouterID& remote) const = 0;
+
     virtual void
     PumpLinks() = 0;
 
@@ -63,6 +85,9 @@ namespace llarp
     virtual void
     ForEachInboundLink(std::function<void(LinkLayer_ptr)> visit) const = 0;
 
+    virtual void
+    ForEachOutboundLink(std::function<void(LinkLayer_ptr)> visit) const = 0;
+
     virtual size_t
     NumberOfConnectedRouters() const = 0;
 
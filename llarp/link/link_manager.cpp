@@ -4,6 +4,7 @@
 #include <crypto/crypto.hpp>
 
 #include <algorithm>
+#include <limits>
 #include <set>
 
 namespace llarp
@@ -28,6 +29,20 @@ namespace llarp
     return nullptr;
   }
 
+  std::vector<LinkLayer_ptr>
+  LinkManager::GetCompatibleLinks(const RouterContact& rc) const
+  {
+    std::vector<LinkLayer_ptr> links;
+    if (stopping)
+      return links;
+    for (const auto& link : outboundLinks)
+    {
+      if (link->IsCompatable(rc))
+        links.push_back(link);
+    }
+    return links;
+  }
+
   IOutboundSessionMaker*
   LinkManager::GetSessionMaker() const
   {
@@ -36,7 +51,10 @@ namespace llarp
 
   bool
   LinkManager::SendTo(
-      const RouterID& remote, const llarp_buffer_t& buf, ILinkSession::CompletionHandler completed)
+      const RouterID& remote,
+      ILinkSession::Message_t msg,
+      ILinkSession::CompletionHandler completed,
+      TrafficClass cls)
   {
     if (stopping)
       return false;
@@ -51,7 +69,7 @@ namespace llarp
       return false;
     }
 
-    return link->SendTo(remote, buf, completed);
+    return link->SendTo(remote, std::move(msg), completed, cls);
   }
 
   bool
@@ -60,6 +78,33 @@ namespace llarp
     return GetLinkWithSessionTo(remote) != nullptr;
   }
 
+  size_t
+  LinkManager::SendQueueBacklogTo(const RouterID& remote) const
+  {
+    auto link = GetLinkWithSessionTo(remote);
+    if (link == nullptr)
+      return std::numeric_limits<size_t>::max();
+    return link->SendQueueBacklogTo(remote);
+  }
+
+  std::optional<RouterVersion>
+  LinkManager::RemoteVersionOf(const RouterID& remote) const
+  {
+    auto link = GetLinkWithSessionTo(remote);
+    if (link == nullptr)
+      return std::nullopt;
+    return link->RemoteVersionOf(remote);
+  }
+
+  std::optional<llarp_time_t>
+  LinkManager::RTTTo(const RouterID& remote) const
+  {
+    auto link = GetLinkWithSessionTo(remote);
+    if (link == nullptr)
+      return std::nullopt;
+    return link->RTTTo(remote);
+  }
+
   void
   LinkManager::PumpLinks()
   {
@@ -193,6 +238,15 @@ namespace llarp
     }
   }
 
+  void
+  LinkManager::ForEachOutboundLink(std::function<void(LinkLayer_ptr)> visit) const
+  {
+    for (const auto& link : outboundLinks)
+    {
+      visit(link);
+    }
+  }
+
   size_t
   LinkManager::NumberOfConnectedRouters() const
   {
@@ -345,6 +399,8 @@ namespace llarp
       // TODO: operator overloads / member func for diff
       diff.currentRateRX = std::max(sessionStats.currentRateRX, lastStats.currentRateRX);
       diff.currentRateTX = std::max(sessionStats.currentRateTX, lastStats.currentRateTX);
+      diff.p95RateRX = sessionStats.p95RateRX;
+      diff.p95RateTX = sessionStats.p95RateTX;
       diff.totalPacketsRX = sessionStats.totalPacketsRX - lastStats.totalPacketsRX;
       diff.totalAckedTX = sessionStats.totalAckedTX - lastStats.totalAckedTX;
       diff.totalDroppedTX = sessionStats.totalDroppedTX - lastStats.totalDroppedTX;
@@ -363,10 +419,9 @@ namespace llarp
         // TODO: store separate stats for up vs down
         const auto& diff = routerStats.second;
 
-        // note that 'currentRateRX' and 'currentRateTX' are per-second
+        // the 95th percentile of the per second rates, so one burst does not set the peak
         stats.peakBandwidthBytesPerSec = std::max(
-            stats.peakBandwidthBytesPerSec,
-            (double)std::max(diff.currentRateRX, diff.currentRateTX));
+            stats.peakBandwidthBytesPerSec, (double)std::max(diff.p95RateRX, diff.p95RateTX));
         stats.numPacketsDropped += diff.totalDroppedTX;
         stats.numPacketsSent = diff.totalAckedTX;
         stats.numPacketsAttempted = diffTotalTX;
@@ -22,18 +22,31 @@ namespace llarp
     LinkLayer_ptr
     GetCompatibleLink(const RouterContact& rc) const override;
 
+    std::vector<LinkLayer_ptr>
+    GetCompatibleLinks(const RouterContact& rc) const override;
+
     IOutboundSessionMaker*
     GetSessionMaker() const override;
 
     bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
-        ILinkSession::CompletionHandler completed) override;
+        ILinkSession::Message_t msg,
+        ILinkSession::CompletionHandler completed,
+        TrafficClass cls) override;
 
     bool
     HasSessionTo(const RouterID& remote) const override;
 
+    size_t
+    SendQueueBacklogTo(const RouterID& remote) const override;
+
+    std::optional<RouterVersion>
+    RemoteVersionOf(const RouterID& remote) const override;
+
+    std::optional<llarp_time_t>
+    RTTTo(const RouterID& remote) const override;
+
     void
     PumpLinks() override;
 
@@ -59,6 +72,9 @@ namespace llarp
     void
     ForEachInboundLink(std::function<void(LinkLayer_ptr)> visit) const override;
 
+    void
+    ForEachOutboundLink(std::function<void(LinkLayer_ptr)> visit) const override;
+
     size_t
     NumberOfConnectedRouters() const override;
 
@@ -4,6 +4,7 @@
 #include <config/key_manager.hpp>
 #include <memory>
 #include <util/fs.hpp>
+#include <util/numa.hpp>
 #include <utility>
 #include <unordered_set>
 
@@ -13,6 +14,29 @@ namespace llarp
 {
   static constexpr size_t MaxSessionsPerKey = 16;
 
+  LinkStageTimes::LinkStageTimes(metrics::Registry& registry)
+      : decryptWait(registry.AddHistogram(
+            "llarp_link_decrypt_wait_us",
+            "from a datagram arriving to its batch being decrypted",
+            metrics::LatencyBounds()))
+      , decrypt(registry.AddHistogram(
+            "llarp_link_decrypt_us", "decrypting a batch of datagrams", metrics::LatencyBounds()))
+      , logicWait(registry.AddHistogram(
+            "llarp_link_logic_wait_us",
+            "from a batch being decrypted to the logic thread handling it",
+            metrics::LatencyBounds()))
+      , encryptWait(registry.AddHistogram(
+            "llarp_link_encrypt_wait_us",
+            "from a datagram being queued to its batch being encrypted",
+            metrics::LatencyBounds()))
+      , encrypt(registry.AddHistogram(
+            "llarp_link_encrypt_us", "encrypting a batch of datagrams", metrics::LatencyBounds()))
+      , send(registry.AddHistogram(
+            "llarp_link_send_us",
+            "handing a batch of datagrams to the socket",
+            metrics::LatencyBounds()))
+  {}
+
   ILinkLayer::ILinkLayer(
       std::shared_ptr<KeyManager> keyManager,
       GetRCFunc getrc,
@@ -39,7 +63,10 @@ namespace llarp
       , m_SecretKey(keyManager->transportKey)
   {}
 
-  ILinkLayer::~ILinkLayer() = default;
+  ILinkLayer::~ILinkLayer()
+  {
+    StopShards();
+  }
 
   bool
   ILinkLayer::HasSessionTo(const RouterID& id)
@@ -124,7 +151,15 @@ namespace llarp
       auto& buf = pktbuf.underlying;
       pkt.resize(buf.sz);
       std::copy_n(buf.base, buf.sz, pkt.data());
-      static_cast<ILinkLayer*>(udp->user)->RecvFrom(from, std::move(pkt));
+      auto* self = static_cast<ILinkLayer*>(udp->user);
+      self->Capture(from, pkt.data(), pkt.size());
+      self->RecvFrom(from, std::move(pkt));
+    };
+    m_udp.recvfrom_batch = [](llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num) {
+      auto* self = static_cast<ILinkLayer*>(udp->user);
+      for (size_t idx = 0; self->m_Capture and idx < num; ++idx)
+        self->Capture(pkts[idx].addr, pkts[idx].data, pkts[idx].sz);
+      self->RecvBurst(pkts, num);
     };
     m_udp.tick = &ILinkLayer::udp_tick;
     if (ifname == "*")
@@ -137,6 +172,8 @@ namespace llarp
       if (const auto maybe = GetIFAddr(ifname, af))
       {
         m_ourAddr = *maybe;
+        if (m_WantXDP)
+          m_udp.xdp_ifname = ifname;
       }
       else
       {
@@ -151,8 +188,88 @@ namespace llarp
         }
       }
     }
+    if (m_WantXDP and m_udp.xdp_ifname.empty())
+      LogWarn("xdp needs an interface name to bind to, not ", ifname, ", ignoring it");
     m_ourAddr.setPort(port);
-    return llarp_ev_add_udp(m_Loop.get(), &m_udp, m_ourAddr.createSockAddr()) != -1;
+    const bool sharded = m_NumShards > 1 and port != 0;
+    m_udp.reuseport = sharded;
+    if (llarp_ev_add_udp(m_Loop.get(), &m_udp, m_ourAddr.createSockAddr()) == -1)
+      return false;
+    if (not sharded)
+      return true;
+    // the kernel picks the socket by hashing the remote address so every session is only ever
+    // read from one of them, and our sends can go out any of them as they share our address
+    for (size_t idx = 1; idx < m_NumShards; ++idx)
+    {
+      auto shard = std::make_unique<SocketShard>();
+      shard->loop = llarp_make_ev_loop();
+      shard->udp.user = this;
+      shard->udp.reuseport = true;
+      shard->udp.want_offload = m_udp.want_offload;
+      shard->udp.want_uring = m_udp.want_uring;
+      shard->udp.busy_poll_us = m_udp.busy_poll_us;
+      shard->loop->set_busy_poll(std::chrono::microseconds{m_udp.busy_poll_us});
+      // xdp takes the port off the interface for all of them, the first socket reads it
+      shard->udp.recvfrom = [](llarp_udp_io* udp, const SockAddr& from, ManagedBuffer pktbuf) {
+        auto& buf = pktbuf.underlying;
+        std::vector<std::pair<SockAddr, ILinkSession::Packet_t>> pkts;
+        pkts.emplace_back(from, ILinkSession::Packet_t(buf.base, buf.base + buf.sz));
+        static_cast<ILinkLayer*>(udp->user)->RecvFromShard(std::move(pkts));
+      };
+      shard->udp.recvfrom_batch = [](llarp_udp_io* udp, const llarp_udp_pkt* pkts, size_t num) {
+        std::vector<std::pair<SockAddr, ILinkSession::Packet_t>> copied;
+        copied.reserve(num);
+        for (size_t idx = 0; idx < num; ++idx)
+        {
+          const auto& pkt = pkts[idx];
+          copied.emplace_back(pkt.addr, ILinkSession::Packet_t(pkt.data, pkt.data + pkt.sz));
+        }
+        static_cast<ILinkLayer*>(udp->user)->RecvFromShard(std::move(copied));
+      };
+      if (llarp_ev_add_udp(shard->loop.get(), &shard->udp, m_ourAddr.createSockAddr()) == -1)
+      {
+        LogError("failed to open socket ", idx, " of ", m_NumShards, " on ", m_ourAddr);
+        return false;
+      }
+      m_Shards.emplace_back(std::move(shard));
+    }
+    LogInfo(Name(), " reading ", m_ourAddr, " with ", m_NumShards, " sockets");
+    return true;
+  }
+
+  void
+  ILinkLayer::RecvFromShard(std::vector<std::pair<SockAddr, ILinkSession::Packet_t>> pkts)
+  {
+    m_Loop->call_soon([self = this, pkts = std::move(pkts)]() mutable {
+      for (auto& [from, pkt] : pkts)
+      {
+        self->Capture(from, pkt.data(), pkt.size());
+        self->RecvFrom(from, std::move(pkt));
+      }
+    });
+  }
+
+  void
+  ILinkLayer::StopShards()
+  {
+    for (auto& shard : m_Shards)
+    {
+      if (not shard->thread.joinable())
+        continue;
+      shard->loop->call_soon([loop = shard->loop.get()]() { loop->stop(); });
+      shard->thread.join();
+    }
+    m_Shards.clear();
+  }
+
+  void
+  ILinkLayer::RecvBurst(const llarp_udp_pkt* pkts, size_t num)
+  {
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      ILinkSession::Packet_t pkt(pkts[idx].data, pkts[idx].data + pkts[idx].sz);
+      RecvFrom(pkts[idx].addr, std::move(pkt));
+    }
   }
 
   void
@@ -223,7 +340,7 @@ namespace llarp
   {
     Lock_t l_authed(m_AuthedLinksMutex);
     Lock_t l_pending(m_PendingMutex);
-    IpAddress addr = s->GetRemoteEndpoint();
+    const EndpointKey addr{s->GetRemoteEndpoint()};
     auto itr = m_Pending.find(addr);
     if (itr != m_Pending.end())
     {
@@ -255,6 +372,19 @@ namespace llarp
     return false;
   }
 
+  std::vector<AddressInfo>
+  ILinkLayer::PickAddresses(const RouterContact& rc) const
+  {
+    const std::string OurDialect = Name();
+    std::vector<AddressInfo> picked;
+    for (const auto& addr : rc.addrs)
+    {
+      if (addr.dialect == OurDialect)
+        picked.push_back(addr);
+    }
+    return picked;
+  }
+
   util::StatusObject
   ILinkLayer::ExtractStatus() const
   {
@@ -285,6 +415,15 @@ namespace llarp
 
   bool
   ILinkLayer::TryEstablishTo(RouterContact rc)
+  {
+    llarp::AddressInfo to;
+    if (!PickAddress(rc, to))
+      return false;
+    return TryEstablishTo(std::move(rc), to);
+  }
+
+  bool
+  ILinkLayer::TryEstablishTo(RouterContact rc, const AddressInfo& to)
   {
     {
       Lock_t l(m_AuthedLinksMutex);
@@ -294,13 +433,10 @@ namespace llarp
         return false;
       }
     }
-    llarp::AddressInfo to;
-    if (!PickAddress(rc, to))
-      return false;
     const IpAddress address = to.toIpAddress();
     {
       Lock_t l(m_PendingMutex);
-      if (m_Pending.count(address) >= MaxSessionsPerKey)
+      if (m_Pending.count(EndpointKey{address}) >= MaxSessionsPerKey)
       {
         LogDebug(
             "Too many pending connections to ",
@@ -328,6 +464,14 @@ namespace llarp
   ILinkLayer::Start(std::shared_ptr<Logic> l)
   {
     m_Logic = l;
+    for (auto& shard : m_Shards)
+    {
+      shard->thread = std::thread{[loop = shard->loop]() {
+        util::SetThreadName("llarp-udp");
+        util::PinThisThread();
+        loop->run();
+      }};
+    }
     ScheduleTick(LINK_LAYER_TICK_INTERVAL);
     return true;
   }
@@ -372,6 +516,7 @@ namespace llarp
   {
     if (m_Logic && tick_id)
       m_Logic->remove_call(tick_id);
+    StopShards();
     {
       Lock_t l(m_AuthedLinksMutex);
       auto itr = m_AuthedLinks.begin();
@@ -405,7 +550,8 @@ namespace llarp
     while (itr != range.second)
     {
       itr->second->Close();
-      m_RecentlyClosed.emplace(itr->second->GetRemoteEndpoint(), now + CloseGraceWindow);
+      m_RecentlyClosed.emplace(
+          EndpointKey{itr->second->GetRemoteEndpoint()}, now + CloseGraceWindow);
       itr = m_AuthedLinks.erase(itr);
     }
   }
@@ -429,7 +575,10 @@ namespace llarp
 
   bool
   ILinkLayer::SendTo(
-      const RouterID& remote, const llarp_buffer_t& buf, ILinkSession::CompletionHandler completed)
+      const RouterID& remote,
+      ILinkSession::Message_t msg,
+      ILinkSession::CompletionHandler completed,
+      TrafficClass cls)
   {
     std::shared_ptr<ILinkSession> s;
     {
@@ -450,9 +599,46 @@ namespace llarp
         ++itr;
       }
     }
-    ILinkSession::Message_t pkt(buf.sz);
-    std::copy_n(buf.base, buf.sz, pkt.begin());
-    return s && s->SendMessageBuffer(std::move(pkt), completed);
+    return s && s->SendMessageBuffer(std::move(msg), completed, cls);
+  }
+
+  size_t
+  ILinkLayer::SendQueueBacklogTo(const RouterID& remote) const
+  {
+    Lock_t l(m_AuthedLinksMutex);
+    size_t min = std::numeric_limits<size_t>::max();
+    auto range = m_AuthedLinks.equal_range(remote);
+    for (auto itr = range.first; itr != range.second; ++itr)
+      min = std::min(min, itr->second->SendQueueBacklog());
+    return min;
+  }
+
+  std::optional<RouterVersion>
+  ILinkLayer::RemoteVersionOf(const RouterID& remote) const
+  {
+    Lock_t l(m_AuthedLinksMutex);
+    auto itr = m_AuthedLinks.find(remote);
+    if (itr == m_AuthedLinks.end())
+      return std::nullopt;
+    return itr->second->GetRemoteVersion();
+  }
+
+  std::optional<llarp_time_t>
+  ILinkLayer::RTTTo(const RouterID& remote) const
+  {
+    Lock_t l(m_AuthedLinksMutex);
+    std::optional<llarp_time_t> rtt;
+    auto range = m_AuthedLinks.equal_range(remote);
+    for (auto itr = range.first; itr != range.second; ++itr)
+    {
+      const auto ms = itr->second->GetSessionStats().smoothedRTTMs;
+      if (ms == 0)
+        continue;
+      const llarp_time_t sessionRTT{ms};
+      if (not rtt or sessionRTT < *rtt)
+        rtt = sessionRTT;
+    }
+    return rtt;
   }
 
   bool
@@ -482,7 +668,7 @@ namespace llarp
   {
     static constexpr size_t MaxSessionsPerEndpoint = 5;
     Lock_t lock(m_PendingMutex);
-    IpAddress address = s->GetRemoteEndpoint();
+    const EndpointKey address{s->GetRemoteEndpoint()};
     if (m_Pending.count(address) >= MaxSessionsPerEndpoint)
       return false;
     m_Pending.emplace(address, s);
@@ -494,7 +680,21 @@ namespace llarp
   {
     auto now = Now();
     Tick(now);
-    ScheduleTick(LINK_LAYER_TICK_INTERVAL);
+    ScheduleTick(m_Idle ? time_until_aligned(now, IdleWakeupWindow) : LINK_LAYER_TICK_INTERVAL);
+  }
+
+  void
+  ILinkLayer::SetIdle(bool idle)
+  {
+    if (m_Idle == idle)
+      return;
+    m_Idle = idle;
+    if (not idle and m_Logic)
+    {
+      // the tick we have waiting could be a whole window out
+      m_Logic->cancel_call(tick_id);
+      OnTick();
+    }
   }
 
   void
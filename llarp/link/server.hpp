@@ -1,19 +1,26 @@
 #ifndef LLARP_LINK_SERVER_HPP
 #define LLARP_LINK_SERVER_HPP
 
+#include <crypto/crypto.hpp>
 #include <crypto/types.hpp>
 #include <ev/ev.h>
+#include <link/capture.hpp>
 #include <link/session.hpp>
+#include <net/endpoint_key.hpp>
 #include <net/sock_addr.hpp>
 #include <router_contact.hpp>
+#include <util/metrics.hpp>
 #include <util/status.hpp>
 #include <util/thread/logic.hpp>
 #include <util/thread/threading.hpp>
 #include <config/key_manager.hpp>
+#include <constants/link_layer.hpp>
 
 #include <list>
 #include <memory>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace llarp
 {
@@ -69,10 +76,29 @@ namespace llarp
   using Work_t = std::function<void(void)>;
   /// queue work to worker thread
   using WorkerFunc_t = std::function<void(Work_t)>;
+  /// queue work to the worker thread that owns a key
+  using KeyedWorkerFunc_t = std::function<void(uint64_t, Work_t)>;
 
   /// before connection hook, called before we try connecting via outbound link
   using BeforeConnectFunc_t = std::function<void(llarp::RouterContact)>;
 
+  /// how long link traffic spends in each step on its way in and out, in microseconds
+  struct LinkStageTimes
+  {
+    explicit LinkStageTimes(metrics::Registry& registry);
+
+    /// from the first datagram of a batch arriving to the batch being decrypted
+    metrics::Histogram& decryptWait;
+    metrics::Histogram& decrypt;
+    /// from a batch being decrypted to the logic thread handling what is in it
+    metrics::Histogram& logicWait;
+    /// from the first datagram of a batch being queued to the batch being encrypted
+    metrics::Histogram& encryptWait;
+    metrics::Histogram& encrypt;
+    /// handing an encrypted batch to the socket
+    metrics::Histogram& send;
+  };
+
   struct ILinkLayer
   {
     ILinkLayer(
@@ -115,6 +141,164 @@ namespace llarp
       llarp_ev_udp_sendto(&m_udp, to, pkt);
     }
 
+    /// send many datagrams with as few syscalls as the event loop allows
+    void
+    SendBatchTo_LL(const llarp_udp_pkt* pkts, size_t num)
+    {
+      llarp_ev_udp_sendto_batch(&m_udp, pkts, num);
+    }
+
+    /// return true if we can hand the kernel one buffer to be split into many datagrams
+    bool
+    CanSendSegmented() const
+    {
+      return m_udp.sendto_segmented != nullptr;
+    }
+
+    /// send buf as datagrams of segsz bytes each using segmentation offload
+    /// returns false if it was not sent, in which case the caller should send each datagram
+    bool
+    SendSegmentedTo_LL(const SockAddr& to, const byte_t* buf, size_t sz, size_t segsz)
+    {
+      auto sendto = m_udp.sendto_segmented;
+      return sendto and sendto(&m_udp, to, buf, sz, segsz) >= 0;
+    }
+
+    /// ask the kernel for udp segmentation and receive offload when we bind
+    /// must be called before Configure, we fall back silently when unsupported
+    void
+    EnableUDPOffload(bool enable)
+    {
+      m_udp.want_offload = enable;
+    }
+
+    /// do our udp io through io_uring when we bind, replaces offload
+    /// must be called before Configure, we fall back to regular io when unsupported
+    void
+    EnableIOUring(bool enable)
+    {
+      m_udp.want_uring = enable;
+    }
+
+    /// have reads on our sockets, and the loops of our extra sockets, spin for this long
+    /// waiting on a datagram before they sleep. must be called before Configure
+    void
+    EnableBusyPoll(std::chrono::microseconds spin)
+    {
+      m_udp.busy_poll_us = spin.count();
+    }
+
+    /// seal with aes-256-gcm on sessions whose remote opens it too, only where the cpu has
+    /// instructions for it. must be called before sessions are made
+    void
+    EnableAESGCM(bool enable)
+    {
+      m_AESGCM = enable and CryptoManager::instance()->aes256gcm_available();
+    }
+
+    bool
+    UseAESGCM() const
+    {
+      return m_AESGCM;
+    }
+
+    /// read our port off the interface we bind to with AF_XDP, replaces offload and io_uring
+    /// must be called before Configure, we fall back to regular io when unsupported or when we
+    /// bind to an address rather than an interface
+    void
+    EnableXDP(bool enable)
+    {
+      m_WantXDP = enable;
+    }
+
+    /// where to queue work that has to run in order for one key, falls back to QueueWork
+    void
+    SetKeyedWorker(KeyedWorkerFunc_t work)
+    {
+      m_QueueWorkFor = std::move(work);
+    }
+
+    /// queue work behind everything queued before it under the same key
+    void
+    QueueWorkFor(uint64_t key, Work_t work)
+    {
+      if (m_QueueWorkFor)
+        m_QueueWorkFor(key, std::move(work));
+      else
+        QueueWork(std::move(work));
+    }
+
+    /// how long sessions may hold acks to fold them into one datagram, and how many they hold
+    /// at most before sending right away
+    void
+    SetAckPolicy(llarp_time_t delay, size_t budget)
+    {
+      m_AckDelay = delay;
+      m_AckBudget = std::max(budget, size_t{1});
+    }
+
+    llarp_time_t
+    AckDelay() const
+    {
+      return m_AckDelay;
+    }
+
+    size_t
+    AckBudget() const
+    {
+      return m_AckBudget;
+    }
+
+    /// while idle the tick waits for the next IdleWakeupWindow boundary and sessions ping less,
+    /// leaving idle ticks right away
+    void
+    SetIdle(bool idle);
+
+    bool
+    IsIdle() const
+    {
+      return m_Idle;
+    }
+
+    /// time the steps of our traffic into registry
+    void
+    SetMetrics(metrics::Registry& registry)
+    {
+      m_StageTimes = std::make_unique<LinkStageTimes>(registry);
+    }
+
+    /// nullptr unless SetMetrics was called
+    const LinkStageTimes*
+    StageTimes() const
+    {
+      return m_StageTimes.get();
+    }
+
+    /// write every datagram we read, and session keys if it wants them, to capture. links on
+    /// one event loop can share one
+    void
+    SetCapture(std::shared_ptr<capture::Writer> capture)
+    {
+      m_Capture = std::move(capture);
+    }
+
+    /// log the key of a session that was just set up, when the capture asks for keys
+    void
+    CaptureSessionKey(const SockAddr& from, const RouterID& remote, const SharedSecret& key)
+    {
+      if (m_Capture and m_Capture->WantsKeys())
+        m_Capture->WriteKey(from, remote, key);
+    }
+
+    /// open num sockets on our port with SO_REUSEPORT instead of one, each extra socket is read
+    /// by its own event loop thread which hands the packets over to ours
+    /// must be called before Configure, has no effect when we bind to a random port
+    void
+    SetSocketShards(size_t num)
+    {
+      m_NumShards = std::max(num, size_t{1});
+    }
+
     virtual bool
     Configure(llarp_ev_loop_ptr loop, const std::string& ifname, int af, uint16_t port);
 
@@ -127,12 +311,26 @@ namespace llarp
     virtual void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
 
+    /// handle every datagram read from the socket in one event loop wakeup
+    /// by default this hands each of them to RecvFrom
+    virtual void
+    RecvBurst(const llarp_udp_pkt* pkts, size_t num);
+
     bool
     PickAddress(const RouterContact& rc, AddressInfo& picked) const;
 
+    /// every address of rc we speak the dialect of, in the order rc lists them
+    std::vector<AddressInfo>
+    PickAddresses(const RouterContact& rc) const;
+
+    /// establish to the first address of rc PickAddress finds
     bool
     TryEstablishTo(RouterContact rc);
 
+    /// establish to rc on one of its addresses, to
+    bool
+    TryEstablishTo(RouterContact rc, const AddressInfo& to);
+
     bool
     Start(std::shared_ptr<llarp::Logic> l);
 
@@ -142,7 +340,7 @@ namespace llarp
     virtual const char*
     Name() const = 0;
 
-    util::StatusObject
+    virtual util::StatusObject
     ExtractStatus() const EXCLUDES(m_AuthedLinksMutex);
 
     void
@@ -154,8 +352,22 @@ namespace llarp
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
-        ILinkSession::CompletionHandler completed);
+        ILinkSession::Message_t msg,
+        ILinkSession::CompletionHandler completed,
+        TrafficClass cls);
+
+    /// lowest backlog of our sessions to remote, the one SendTo picks, the max size_t if
+    /// there are none
+    size_t
+    SendQueueBacklogTo(const RouterID& remote) const EXCLUDES(m_AuthedLinksMutex);
+
+    /// router version any of our sessions to remote has for it
+    std::optional<RouterVersion>
+    RemoteVersionOf(const RouterID& remote) const EXCLUDES(m_AuthedLinksMutex);
+
+    /// lowest smoothed rtt of our sessions to remote that have measured one
+    std::optional<llarp_time_t>
+    RTTTo(const RouterID& remote) const EXCLUDES(m_AuthedLinksMutex);
 
     virtual bool
     GetOurAddressInfo(AddressInfo& addr) const;
@@ -206,6 +418,7 @@ namespace llarp
     PumpDoneHandler PumpDone;
     std::shared_ptr<KeyManager> keyManager;
     WorkerFunc_t QueueWork;
+    KeyedWorkerFunc_t m_QueueWorkFor;
 
     std::shared_ptr<Logic>
     logic()
@@ -235,6 +448,39 @@ namespace llarp
     void
     OnTick();
 
+    /// hand packets read by a shard thread over to our event loop
+    void
+    RecvFromShard(std::vector<std::pair<SockAddr, ILinkSession::Packet_t>> pkts);
+
+    void
+    StopShards();
+
+    /// an extra socket on our port and the thread that reads it
+    struct SocketShard
+    {
+      llarp_ev_loop_ptr loop;
+      llarp_udp_io udp{};
+      std::thread thread;
+    };
+
+    size_t m_NumShards = 1;
+    bool m_WantXDP = false;
+    bool m_AESGCM = false;
+    std::vector<std::unique_ptr<SocketShard>> m_Shards;
+
+    llarp_time_t m_AckDelay = DefaultAckDelay;
+    size_t m_AckBudget = DefaultAckBudget;
+    std::unique_ptr<LinkStageTimes> m_StageTimes;
+    std::shared_ptr<capture::Writer> m_Capture;
+    bool m_Idle = false;
+
+    void
+    Capture(const SockAddr& from, const byte_t* data, size_t sz)
+    {
+      if (m_Capture)
+        m_Capture->Write(from, data, sz);
+    }
+
     void
     ScheduleTick(llarp_time_t interval);
 
@@ -261,13 +507,13 @@ namespace llarp
     using AuthedLinks =
         std::unordered_multimap<RouterID, std::shared_ptr<ILinkSession>, RouterID::Hash>;
     using Pending =
-        std::unordered_multimap<IpAddress, std::shared_ptr<ILinkSession>, IpAddress::Hash>;
+        std::unordered_multimap<EndpointKey, std::shared_ptr<ILinkSession>, EndpointKey::Hash>;
     mutable DECLARE_LOCK(Mutex_t, m_AuthedLinksMutex, ACQUIRED_BEFORE(m_PendingMutex));
     AuthedLinks m_AuthedLinks GUARDED_BY(m_AuthedLinksMutex);
     mutable DECLARE_LOCK(Mutex_t, m_PendingMutex, ACQUIRED_AFTER(m_AuthedLinksMutex));
     Pending m_Pending GUARDED_BY(m_PendingMutex);
 
-    std::unordered_map<IpAddress, llarp_time_t, IpAddress::Hash> m_RecentlyClosed;
+    std::unordered_map<EndpointKey, llarp_time_t, EndpointKey::Hash> m_RecentlyClosed;
   };
 
   using LinkLayer_ptr = std::shared_ptr<ILinkLayer>;
@@ -5,9 +5,11 @@
 #include <net/net.hpp>
 #include <ev/ev.hpp>
 #include <router_contact.hpp>
+#include <util/pool.hpp>
 #include <util/types.hpp>
 
 #include <functional>
+#include <optional>
 
 namespace llarp
 {
@@ -15,17 +17,46 @@ namespace llarp
   struct ILinkMessage;
   struct ILinkLayer;
 
+  /// what a link message carries, sessions send the classes in this order, interactive and
+  /// bulk by weight so neither starves the other
+  enum class TrafficClass : uint8_t
+  {
+    /// link intros, dht and anything else that keeps the network running
+    Control = 0,
+    /// path builds and their status replies
+    PathBuild = 1,
+    /// relay cells that fit in a single datagram
+    Interactive = 2,
+    /// relay cells and gossip, a session sends the ones that fit in a single datagram as
+    /// interactive
+    Bulk = 3
+  };
+
+  static constexpr size_t NumTrafficClasses = 4;
+
   struct SessionStats
   {
     // rate
     uint64_t currentRateRX = 0;
     uint64_t currentRateTX = 0;
+    /// 95th percentile of the recent per second rates
+    uint64_t p95RateRX = 0;
+    uint64_t p95RateTX = 0;
 
     uint64_t totalPacketsRX = 0;
 
     uint64_t totalAckedTX = 0;
     uint64_t totalDroppedTX = 0;
     uint64_t totalInFlightTX = 0;
+
+    // congestion control
+    uint64_t congestionWindow = 0;
+    uint64_t smoothedRTTMs = 0;
+    uint64_t totalRetransmitTX = 0;
+    uint64_t totalLossEventsTX = 0;
+
+    /// largest fragment we send, what path mtu probing found the path carries
+    uint64_t fragmentSize = 0;
   };
 
   struct ILinkSession
@@ -53,12 +84,14 @@ namespace llarp
     /// message delivery result hook function
     using CompletionHandler = std::function<void(DeliveryStatus)>;
 
-    using Packet_t = std::vector<byte_t>;
-    using Message_t = std::vector<byte_t>;
+    /// buffers are recycled per thread instead of going back to the heap, we make and drop one
+    /// for every datagram and fragment
+    using Packet_t = util::PooledVector<byte_t>;
+    using Message_t = util::PooledVector<byte_t>;
 
     /// send a message buffer to the remote endpoint
     virtual bool
-    SendMessageBuffer(Message_t, CompletionHandler handler) = 0;
+    SendMessageBuffer(Message_t, CompletionHandler handler, TrafficClass cls) = 0;
 
     /// start the connection
     virtual void
@@ -102,9 +135,18 @@ namespace llarp
     virtual RouterContact
     GetRemoteRC() const = 0;
 
+    /// the router version in the remote rc, without copying the rc
+    virtual std::optional<RouterVersion>
+    GetRemoteVersion() const = 0;
+
     /// handle a valid LIM
     std::function<bool(const LinkIntroMessage* msg)> GotLIM;
 
+    /// check the signature on a LIM and hand it to GotLIM if it is good, the check may finish
+    /// later off the calling thread
+    virtual bool
+    HandleLIM(const LinkIntroMessage* msg) = 0;
+
     /// send queue current blacklog
     virtual size_t
     SendQueueBacklog() const = 0;
@@ -1,6 +1,8 @@
 #include <messages/dht_immediate.hpp>
 
 #include <router/abstractrouter.hpp>
+#include <util/alloc_stats.hpp>
+#include <util/tracy.hpp>
 
 namespace llarp
 {
@@ -63,6 +65,8 @@ namespace llarp
   bool
   DHTImmediateMessage::HandleMessage(AbstractRouter* router) const
   {
+    alloc::Scope allocScope{alloc::DHTMessages};
+    LLARP_ZONE("DHTImmediateMessage::HandleMessage");
     DHTImmediateMessage reply;
     reply.session = session;
     bool result = true;
@@ -100,9 +100,7 @@ namespace llarp
   bool
   LinkIntroMessage::HandleMessage(AbstractRouter* /*router*/) const
   {
-    if (!Verify())
-      return false;
-    return session->GotLIM(this);
+    return session->HandleLIM(this);
   }
 
   void
@@ -13,6 +13,13 @@ namespace llarp
   struct ILinkSession;
   struct AbstractRouter;
 
+  /// first router version that reads messages in their compact framing
+  static constexpr RouterVersion::Version_t CompactFramingVersion{{0, 8, 1}};
+  /// first router version that reads compact relay cells bundled into one link message
+  static constexpr RouterVersion::Version_t CellBundleVersion{{0, 8, 2}};
+  /// first router version that reads the congestion bit of a compact relay cell
+  static constexpr RouterVersion::Version_t CongestionFlagVersion{{0, 8, 2}};
+
   /// parsed link layer message
   struct ILinkMessage
   {
@@ -46,6 +53,22 @@ namespace llarp
     virtual bool
     BEncode(llarp_buffer_t* buf) const = 0;
 
+    /// exact size BEncode will write, so it can encode straight into a buffer of that size.
+    /// 0 if it is not known without encoding
+    virtual size_t
+    EncodedSize() const
+    {
+      return 0;
+    }
+
+    /// encode into out with fixed headers instead of bencode, for peers from
+    /// CompactFramingVersion on. false if this kind of message has no compact framing
+    virtual bool
+    CompactEncode(ILinkSession::Message_t&) const
+    {
+      return false;
+    }
+
     virtual bool
     HandleMessage(AbstractRouter* router) const = 0;
 
@@ -62,6 +85,13 @@ namespace llarp
     {
       return 1;
     }
+
+    /// traffic class the link session sends it in
+    virtual TrafficClass
+    Class() const
+    {
+      return TrafficClass::Control;
+    }
   };
 
 }  // namespace llarp
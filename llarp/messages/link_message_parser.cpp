@@ -7,9 +7,11 @@
 #include <messages/relay_commit.hpp>
 #include <messages/relay_status.hpp>
 #include <messages/relay.hpp>
+#include <router/abstractrouter.hpp>
 #include <router_contact.hpp>
 #include <util/buffer.hpp>
 #include <util/logging/logger.hpp>
+#include <util/metrics.hpp>
 
 #include <memory>
 
@@ -29,7 +31,18 @@ namespace llarp
   };
 
   LinkMessageParser::LinkMessageParser(AbstractRouter* _router)
-      : router(_router), from(nullptr), msg(nullptr), holder(std::make_unique<msg_holder_t>())
+      : router(_router)
+      , from(nullptr)
+      , msg(nullptr)
+      , holder(std::make_unique<msg_holder_t>())
+      , m_ReceivedMetric(router->metrics().AddCounter(
+            "llarp_link_messages_received_total", "link messages from our sessions"))
+      , m_RelayCellsMetric(router->metrics().AddCounter(
+            "llarp_link_relay_cells_received_total", "relay messages handled without a parse"))
+      , m_HandleMetric(router->metrics().AddHistogram(
+            "llarp_link_message_us",
+            "parsing a link message and handing it on, finding its path included",
+            metrics::LatencyBounds()))
   {}
 
   LinkMessageParser::~LinkMessageParser() = default;
@@ -123,10 +136,21 @@ namespace llarp
       return false;
     }
 
+    m_ReceivedMetric.Inc();
+    const auto started = metrics::Histogram::Clock_t::now();
+    // relay cells are most of what comes in and have one layout, so they skip the dict parse
+    if (auto handled = HandleRelayCell(router, src, buf))
+    {
+      m_RelayCellsMetric.Inc();
+      m_HandleMetric.ObserveSince(started);
+      return *handled;
+    }
     from = src;
     firstkey = true;
     ManagedBuffer copy(buf);
-    return bencode_read_dict(*this, &copy.underlying);
+    const bool handled = bencode_read_dict(*this, &copy.underlying);
+    m_HandleMetric.ObserveSince(started);
+    return handled;
   }
 
   void
@@ -12,6 +12,12 @@ namespace llarp
   struct ILinkMessage;
   struct ILinkSession;
 
+  namespace metrics
+  {
+    struct Counter;
+    struct Histogram;
+  }
+
   struct LinkMessageParser
   {
     LinkMessageParser(AbstractRouter* router);
@@ -46,6 +52,10 @@ namespace llarp
     struct msg_holder_t;
 
     std::unique_ptr<msg_holder_t> holder;
+
+    metrics::Counter& m_ReceivedMetric;
+    metrics::Counter& m_RelayCellsMetric;
+    metrics::Histogram& m_HandleMetric;
   };
 }  // namespace llarp
 #endif
@@ -4,13 +4,276 @@
 #include <router/abstractrouter.hpp>
 #include <util/bencode.hpp>
 
+#include <algorithm>
+
 namespace llarp
 {
+  namespace
+  {
+    template <char type, typename Msg_t>
+    using RelaySchema = BEncodeSchema<
+        BEncodeDictMsgType<'a', type>,
+        BEncodeDictEntry<'p', &ILinkMessage::pathid>,
+        BEncodeDictVersion<'v'>,
+        BEncodeDictViewOr<'x', &Msg_t::XView, &Msg_t::X>,
+        BEncodeDictEntry<'y', &Msg_t::Y>>;
+  }  // namespace
+
+  namespace
+  {
+    /// how the version reads on the wire, the Decode for it refuses any other
+    const std::string&
+    VersionField()
+    {
+      static const std::string field = "1:vi" + std::to_string(LLARP_PROTO_VERSION) + "e";
+      return field;
+    }
+
+    /// true for the first byte of a single compact cell
+    bool
+    IsCompactType(byte_t type)
+    {
+      type &= ~RelayCell::CompactCongested;
+      return type == RelayCell::CompactUpstream or type == RelayCell::CompactDownstream;
+    }
+
+    /// consume str from the front of data, return false if it is not there
+    bool
+    Expect(std::string_view& data, std::string_view str)
+    {
+      if (data.substr(0, str.size()) != str)
+        return false;
+      data.remove_prefix(str.size());
+      return true;
+    }
+  }  // namespace
+
+  /// the compact framing has the header at fixed offsets and X to the end of buf
+  static std::optional<RelayCell>
+  ReadCompact(const llarp_buffer_t& buf)
+  {
+    if (buf.sz < RelayCell::CompactHeaderSize)
+      return std::nullopt;
+    RelayCell cell;
+    const byte_t type = buf.base[0] & ~RelayCell::CompactCongested;
+    cell.type = type == RelayCell::CompactUpstream ? 'u' : 'd';
+    cell.congested = buf.base[0] & RelayCell::CompactCongested;
+    const byte_t* ptr = buf.base + 1;
+    std::copy_n(ptr, cell.pathid.size(), cell.pathid.begin());
+    ptr += cell.pathid.size();
+    std::copy_n(ptr, cell.Y.size(), cell.Y.begin());
+    ptr += cell.Y.size();
+    cell.XSize = (size_t{ptr[0]} << 8) | ptr[1];
+    if (cell.XSize > MAX_LINK_MSG_SIZE - 128
+        or buf.sz != RelayCell::CompactHeaderSize + cell.XSize)
+      return std::nullopt;
+    cell.X = buf.base + RelayCell::CompactHeaderSize;
+    return cell;
+  }
+
+  std::optional<RelayCell>
+  RelayCell::Read(const llarp_buffer_t& buf)
+  {
+    if (buf.sz and IsCompactType(buf.base[0]))
+      return ReadCompact(buf);
+    std::string_view data{reinterpret_cast<const char*>(buf.base), buf.sz};
+    RelayCell cell;
+    if (not Expect(data, "d1:a1:") or data.empty())
+      return std::nullopt;
+    cell.type = data[0];
+    data.remove_prefix(1);
+    if ((cell.type != 'u' and cell.type != 'd') or not Expect(data, "1:p16:")
+        or data.size() < cell.pathid.size())
+      return std::nullopt;
+    std::copy_n(data.data(), cell.pathid.size(), cell.pathid.begin());
+    data.remove_prefix(cell.pathid.size());
+    if (not Expect(data, VersionField()) or not Expect(data, "1:x"))
+      return std::nullopt;
+    size_t len = 0;
+    size_t digits = 0;
+    while (digits < data.size() and digits < 5 and data[digits] >= '0' and data[digits] <= '9')
+      len = len * 10 + (data[digits++] - '0');
+    if (digits == 0 or digits >= data.size() or data[digits] != ':')
+      return std::nullopt;
+    data.remove_prefix(digits + 1);
+    if (len > MAX_LINK_MSG_SIZE - 128 or data.size() < len)
+      return std::nullopt;
+    cell.X = buf.base + (buf.sz - data.size());
+    cell.XSize = len;
+    data.remove_prefix(len);
+    if (not Expect(data, "1:y32:") or data.size() != cell.Y.size() + 1 or data.back() != 'e')
+      return std::nullopt;
+    std::copy_n(data.data(), cell.Y.size(), cell.Y.begin());
+    return cell;
+  }
+
+  bool
+  RelayCell::WriteCompact(
+      char type,
+      const PathID_t& pathid,
+      const llarp_buffer_t& X,
+      const TunnelNonce& Y,
+      ILinkSession::Message_t& out,
+      bool congested)
+  {
+    if (X.sz > MAX_LINK_MSG_SIZE - 128)
+      return false;
+    out.resize(CompactHeaderSize + X.sz);
+    byte_t* ptr = out.data();
+    if (type == 'u')
+      *ptr++ = CompactUpstream;
+    else
+      *ptr++ = CompactDownstream | (congested ? CompactCongested : 0);
+    ptr = std::copy(pathid.begin(), pathid.end(), ptr);
+    ptr = std::copy(Y.begin(), Y.end(), ptr);
+    *ptr++ = X.sz >> 8;
+    *ptr++ = X.sz;
+    std::copy_n(X.base, X.sz, ptr);
+    return true;
+  }
+
+  bool
+  RelayCell::IsCompact(const ILinkSession::Message_t& msg)
+  {
+    return not msg.empty() and IsCompactType(msg[0]);
+  }
+
+  void
+  RelayCell::ClearCongested(ILinkSession::Message_t& msg)
+  {
+    if (IsCompact(msg))
+      msg[0] &= ~CompactCongested;
+  }
+
+  size_t
+  RelayCell::BundledSize(const ILinkSession::Message_t& bundle, size_t cellSize)
+  {
+    if (bundle.empty())
+      return cellSize;
+    if (bundle[0] == CompactBundle)
+      return bundle.size() + BundleOverhead + cellSize;
+    // the lone cell gets its size and the bundle its type byte
+    return 1 + BundleOverhead + bundle.size() + BundleOverhead + cellSize;
+  }
+
+  /// put the size of what follows in front of it in a bundle
+  static void
+  AppendSized(ILinkSession::Message_t& bundle, const byte_t* data, size_t sz)
+  {
+    bundle.push_back(sz >> 8);
+    bundle.push_back(sz);
+    bundle.insert(bundle.end(), data, data + sz);
+  }
+
+  void
+  RelayCell::AddToBundle(ILinkSession::Message_t& bundle, const ILinkSession::Message_t& cell)
+  {
+    if (bundle.empty())
+    {
+      bundle = cell;
+      return;
+    }
+    if (bundle[0] != CompactBundle)
+    {
+      ILinkSession::Message_t first;
+      first.swap(bundle);
+      bundle.reserve(BundledSize(first, cell.size()));
+      bundle.push_back(CompactBundle);
+      AppendSized(bundle, first.data(), first.size());
+    }
+    AppendSized(bundle, cell.data(), cell.size());
+  }
+
+  /// call visit with each sized cell in the bundle, false at the first one that does not read
+  template <typename Visit_t>
+  static bool
+  WalkBundle(const llarp_buffer_t& buf, Visit_t&& visit)
+  {
+    size_t pos = 1;
+    while (pos < buf.sz)
+    {
+      if (buf.sz - pos < RelayCell::BundleOverhead)
+        return false;
+      const size_t sz = (size_t{buf.base[pos]} << 8) | buf.base[pos + 1];
+      pos += RelayCell::BundleOverhead;
+      if (buf.sz - pos < sz)
+        return false;
+      const llarp_buffer_t cellBuf{buf.base + pos, sz};
+      // a bundle only holds single compact cells
+      if (sz == 0 or not IsCompactType(buf.base[pos]))
+        return false;
+      const auto cell = ReadCompact(cellBuf);
+      if (not cell)
+        return false;
+      visit(*cell);
+      pos += sz;
+    }
+    return pos > 1;
+  }
+
+  bool
+  RelayCell::ReadBundle(
+      const llarp_buffer_t& buf, const std::function<void(const RelayCell&)>& visit)
+  {
+    if (buf.sz == 0 or buf.base[0] != CompactBundle)
+      return false;
+    // all of it is checked first so a bad bundle is dropped whole
+    if (not WalkBundle(buf, [](const RelayCell&) {}))
+      return false;
+    return WalkBundle(buf, visit);
+  }
+
+  static bool
+  HandleCell(AbstractRouter* r, ILinkSession* from, const RelayCell& cell)
+  {
+    const llarp_buffer_t X{cell.X, cell.XSize};
+    if (cell.type == 'u')
+    {
+      auto path = r->pathContext().GetByDownstream(from->GetPubKey(), cell.pathid);
+      return path and path->HandleUpstream(X, cell.Y, r);
+    }
+    auto path = r->pathContext().GetByUpstream(from->GetPubKey(), cell.pathid);
+    if (path)
+    {
+      if (cell.congested)
+        path->NoteCongestion(r->Now());
+      return path->HandleDownstream(X, cell.Y, r);
+    }
+    llarp::LogWarn("unhandled downstream message id=", cell.pathid);
+    return false;
+  }
+
+  std::optional<bool>
+  HandleRelayCell(AbstractRouter* r, ILinkSession* from, const llarp_buffer_t& buf)
+  {
+    if (buf.sz and buf.base[0] == RelayCell::CompactBundle)
+    {
+      bool handled = true;
+      const bool read = RelayCell::ReadBundle(buf, [&](const RelayCell& cell) {
+        handled = HandleCell(r, from, cell) and handled;
+      });
+      return read and handled;
+    }
+    const auto cell = RelayCell::Read(buf);
+    if (not cell)
+      return std::nullopt;
+    return HandleCell(r, from, *cell);
+  }
+
+  llarp_buffer_t
+  RelayPayloadView::Or(const Encrypted<MAX_LINK_MSG_SIZE - 128>& owned) const
+  {
+    if (data())
+      return llarp_buffer_t(data(), size());
+    return llarp_buffer_t(owned);
+  }
+
   void
   RelayUpstreamMessage::Clear()
   {
     pathid.Zero();
     X.Clear();
+    XView = {};
     Y.Zero();
     version = 0;
   }
@@ -18,35 +281,25 @@ namespace llarp
   bool
   RelayUpstreamMessage::BEncode(llarp_buffer_t* buf) const
   {
-    if (!bencode_start_dict(buf))
-      return false;
-    if (!BEncodeWriteDictMsgType(buf, "a", "u"))
-      return false;
+    return RelaySchema<'u', RelayUpstreamMessage>::Encode(*this, buf);
+  }
 
-    if (!BEncodeWriteDictEntry("p", pathid, buf))
-      return false;
-    if (!BEncodeWriteDictInt("v", LLARP_PROTO_VERSION, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("y", Y, buf))
-      return false;
-    return bencode_end(buf);
+  size_t
+  RelayUpstreamMessage::EncodedSize() const
+  {
+    return RelaySchema<'u', RelayUpstreamMessage>::EncodedSize(*this);
+  }
+
+  bool
+  RelayUpstreamMessage::CompactEncode(ILinkSession::Message_t& out) const
+  {
+    return RelayCell::WriteCompact('u', pathid, XView.Or(X), Y, out);
   }
 
   bool
   RelayUpstreamMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf)
   {
-    bool read = false;
-    if (!BEncodeMaybeReadDictEntry("p", pathid, read, key, buf))
-      return false;
-    if (!BEncodeMaybeVerifyVersion("v", version, LLARP_PROTO_VERSION, read, key, buf))
-      return false;
-    if (!BEncodeMaybeReadDictEntry("x", X, read, key, buf))
-      return false;
-    if (!BEncodeMaybeReadDictEntry("y", Y, read, key, buf))
-      return false;
-    return read;
+    return RelaySchema<'u', RelayUpstreamMessage>::DecodeKey(*this, key, buf);
   }
 
   bool
@@ -55,7 +308,7 @@ namespace llarp
     auto path = r->pathContext().GetByDownstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleUpstream(llarp_buffer_t(X), Y, r);
+      return path->HandleUpstream(XView.Or(X), Y, r);
     }
     return false;
   }
@@ -65,42 +318,34 @@ namespace llarp
   {
     pathid.Zero();
     X.Clear();
+    XView = {};
     Y.Zero();
+    congested = false;
     version = 0;
   }
 
   bool
   RelayDownstreamMessage::BEncode(llarp_buffer_t* buf) const
   {
-    if (!bencode_start_dict(buf))
-      return false;
-    if (!BEncodeWriteDictMsgType(buf, "a", "d"))
-      return false;
+    return RelaySchema<'d', RelayDownstreamMessage>::Encode(*this, buf);
+  }
 
-    if (!BEncodeWriteDictEntry("p", pathid, buf))
-      return false;
-    if (!BEncodeWriteDictInt("v", LLARP_PROTO_VERSION, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
-      return false;
-    if (!BEncodeWriteDictEntry("y", Y, buf))
-      return false;
-    return bencode_end(buf);
+  size_t
+  RelayDownstreamMessage::EncodedSize() const
+  {
+    return RelaySchema<'d', RelayDownstreamMessage>::EncodedSize(*this);
+  }
+
+  bool
+  RelayDownstreamMessage::CompactEncode(ILinkSession::Message_t& out) const
+  {
+    return RelayCell::WriteCompact('d', pathid, XView.Or(X), Y, out, congested);
   }
 
   bool
   RelayDownstreamMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf)
   {
-    bool read = false;
-    if (!BEncodeMaybeReadDictEntry("p", pathid, read, key, buf))
-      return false;
-    if (!BEncodeMaybeVerifyVersion("v", version, LLARP_PROTO_VERSION, read, key, buf))
-      return false;
-    if (!BEncodeMaybeReadDictEntry("x", X, read, key, buf))
-      return false;
-    if (!BEncodeMaybeReadDictEntry("y", Y, read, key, buf))
-      return false;
-    return read;
+    return RelaySchema<'d', RelayDownstreamMessage>::DecodeKey(*this, key, buf);
   }
 
   bool
@@ -109,7 +354,7 @@ namespace llarp
     auto path = r->pathContext().GetByUpstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleDownstream(llarp_buffer_t(X), Y, r);
+      return path->HandleDownstream(XView.Or(X), Y, r);
     }
     llarp::LogWarn("unhandled downstream message id=", pathid);
     return false;
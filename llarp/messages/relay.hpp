@@ -5,15 +5,30 @@
 #include <crypto/types.hpp>
 #include <messages/link_message.hpp>
 #include <path/path_types.hpp>
+#include <util/bencode.hpp>
 
+#include <functional>
+#include <optional>
 #include <vector>
 
 namespace llarp
 {
+  /// non owning view of a relay message's x value inside the link message buffer it was decoded
+  /// from, lets inbound relay traffic skip the copy into Encrypted
+  struct RelayPayloadView : public BEncodeView<MAX_LINK_MSG_SIZE - 128>
+  {
+    /// returns the view if set otherwise the owned copy
+    llarp_buffer_t
+    Or(const Encrypted<MAX_LINK_MSG_SIZE - 128>& owned) const;
+  };
+
   struct RelayUpstreamMessage : public ILinkMessage
   {
     Encrypted<MAX_LINK_MSG_SIZE - 128> X;
     TunnelNonce Y;
+    /// set instead of X when decoded, only valid until HandleMessage returns, or by a hop
+    /// forwarding a cell it holds, valid while it holds it
+    RelayPayloadView XView;
 
     bool
     DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf) override;
@@ -21,6 +36,12 @@ namespace llarp
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    size_t
+    EncodedSize() const override;
+
+    bool
+    CompactEncode(ILinkSession::Message_t& out) const override;
+
     bool
     HandleMessage(AbstractRouter* router) const override;
 
@@ -37,12 +58,24 @@ namespace llarp
     {
       return 0;
     }
+
+    TrafficClass
+    Class() const override
+    {
+      return TrafficClass::Bulk;
+    }
   };
 
   struct RelayDownstreamMessage : public ILinkMessage
   {
     Encrypted<MAX_LINK_MSG_SIZE - 128> X;
     TunnelNonce Y;
+    /// set instead of X when decoded, only valid until HandleMessage returns, or by a hop
+    /// forwarding a cell it holds, valid while it holds it
+    RelayPayloadView XView;
+    /// some hop on the way down found its link toward us congested, only the compact framing
+    /// carries it
+    bool congested = false;
 
     bool
     DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf) override;
@@ -50,6 +83,12 @@ namespace llarp
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    size_t
+    EncodedSize() const override;
+
+    bool
+    CompactEncode(ILinkSession::Message_t& out) const override;
+
     bool
     HandleMessage(AbstractRouter* router) const override;
 
@@ -67,7 +106,89 @@ namespace llarp
     {
       return 0;
     }
+
+    TrafficClass
+    Class() const override
+    {
+      return TrafficClass::Bulk;
+    }
+  };
+
+  /// the fields of a relay message read where they lie in the link message
+  struct RelayCell
+  {
+    /// first byte of a relay message in the compact framing, which a bencoded link message
+    /// never starts with. after it come the path id, Y, the size of X as a big endian u16
+    /// and X itself
+    enum CompactType : byte_t
+    {
+      CompactUpstream = 0x01,
+      CompactDownstream = 0x02,
+      /// compact cells for one next hop sent as one link message, each after its size as a
+      /// big endian u16
+      CompactBundle = 0x03,
+      /// or'd into the type of a downstream cell that met congestion on the way, see
+      /// RelayDownstreamMessage::congested
+      CompactCongested = 0x80,
+    };
+
+    static constexpr size_t CompactHeaderSize = 1 + PathID_t::SIZE + TunnelNonce::SIZE + 2;
+    /// what each cell after the first adds to a bundle besides itself
+    static constexpr size_t BundleOverhead = 2;
+
+    /// 'u' for upstream, 'd' for downstream
+    char type;
+    PathID_t pathid;
+    /// X points into the buffer the cell was read from
+    byte_t* X;
+    size_t XSize;
+    TunnelNonce Y;
+    bool congested = false;
+
+    /// read buf as a relay message if it is in the compact framing or laid out exactly as we
+    /// bencode them, which it is unless the other side is odd, nullopt for anything else
+    static std::optional<RelayCell>
+    Read(const llarp_buffer_t& buf);
+
+    /// put a relay message in the compact framing into out, false if X is too big for it
+    static bool
+    WriteCompact(
+        char type,
+        const PathID_t& pathid,
+        const llarp_buffer_t& X,
+        const TunnelNonce& Y,
+        ILinkSession::Message_t& out,
+        bool congested = false);
+
+    /// true if msg is a relay message in the compact framing, which can go in a bundle
+    static bool
+    IsCompact(const ILinkSession::Message_t& msg);
+
+    /// take the congestion bit off a compact cell for a peer too old to read it
+    static void
+    ClearCongested(ILinkSession::Message_t& msg);
+
+    /// how big bundle is once cellSize more bytes of cell are added to it
+    static size_t
+    BundledSize(const ILinkSession::Message_t& bundle, size_t cellSize);
+
+    /// add a compact cell to bundle. a bundle of one cell is just the cell, it only takes the
+    /// bundle framing when a second one joins it
+    static void
+    AddToBundle(ILinkSession::Message_t& bundle, const ILinkSession::Message_t& cell);
+
+    /// call visit with each cell of a bundle in the order they were added, false if buf is
+    /// not a well formed bundle, in which case nothing is visited
+    static bool
+    ReadBundle(const llarp_buffer_t& buf, const std::function<void(const RelayCell&)>& visit);
   };
+
+  /// hand a relay message straight to its path without going through LinkMessageParser,
+  /// nullopt if buf is not a relay message we can read that way. otherwise what handling it
+  /// as RelayUpstreamMessage or RelayDownstreamMessage would have returned, for a bundle
+  /// true if every cell in it was handled
+  std::optional<bool>
+  HandleRelayCell(AbstractRouter* r, ILinkSession* from, const llarp_buffer_t& buf);
 }  // namespace llarp
 
 #endif
@@ -94,6 +94,16 @@ namespace llarp
     }
     if (!BEncodeWriteDictEntry("n", tunnelNonce, buf))
       return false;
+    if (padding != padding::DefaultProfile)
+    {
+      if (!BEncodeWriteDictInt("p", static_cast<uint64_t>(padding), buf))
+        return false;
+    }
+    if (wantLoad)
+    {
+      if (!BEncodeWriteDictInt("q", 1, buf))
+        return false;
+    }
     if (!BEncodeWriteDictEntry("r", rxid, buf))
       return false;
     if (!BEncodeWriteDictEntry("t", txid, buf))
@@ -127,6 +137,23 @@ namespace llarp
       return false;
     if (!BEncodeMaybeReadDictEntry("n", tunnelNonce, read, *key, buffer))
       return false;
+    if (*key == "p")
+    {
+      uint64_t profile = 0;
+      if (!bencode_read_integer(buffer, &profile)
+          or profile > static_cast<uint64_t>(padding::Profile::ConstantRate))
+        return false;
+      padding = static_cast<padding::Profile>(profile);
+      return true;
+    }
+    if (*key == "q")
+    {
+      uint64_t want = 0;
+      if (!bencode_read_integer(buffer, &want))
+        return false;
+      wantLoad = want != 0;
+      return true;
+    }
     if (!BEncodeMaybeReadDictEntry("r", rxid, read, *key, buffer))
       return false;
     if (!BEncodeMaybeReadDictEntry("t", txid, read, *key, buffer))
@@ -171,8 +198,13 @@ namespace llarp
         && rxid == other.rxid;
   }
 
+  /// a path build request that waited on us longer than this is answered busy instead of
+  /// accepted, its builder is better off trying another hop
+  static constexpr auto MaxPathBuildWait = 2s;
+
   struct LRCMFrameDecrypt
   {
+    using Clock_t = metrics::Histogram::Clock_t;
     using Context = llarp::path::PathContext;
     using Hop = llarp::path::TransitHop;
     using Decrypter = AsyncFrameDecrypter<LRCMFrameDecrypt>;
@@ -186,6 +218,8 @@ namespace llarp
     std::shared_ptr<Hop> hop;
 
     const std::optional<IpAddress> fromAddr;
+    /// when the request got to us, for how long it waits in our queues
+    const Clock_t::time_point arrived = Clock_t::now();
 
     LRCMFrameDecrypt(Context* ctx, Decrypter_ptr dec, const LR_CommitMessage* commit)
         : decrypter(std::move(dec))
@@ -238,16 +272,37 @@ namespace llarp
           break;
       }
 
-      auto func =
-          std::bind(&LR_StatusMessage::CreateAndSend, router, pathid, nextHop, pathKey, status);
+      router->QueueWork([router, pathid, nextHop, pathKey, status]() {
+        LR_StatusMessage::CreateAndSend(router, pathid, nextHop, pathKey, status);
+      });
+    }
 
-      router->QueueWork(func);
+    /// logic thread, answer busy if the request sat in our queues too long to still be worth
+    /// taking, returns true if it did
+    static bool
+    RejectIfLate(const std::shared_ptr<LRCMFrameDecrypt>& self)
+    {
+      self->context->PathBuildAcceptTimes().ObserveSince(self->arrived);
+      if (Clock_t::now() - self->arrived <= MaxPathBuildWait)
+        return false;
+      llarp::LogWarn("path build ", self->hop->info, " waited too long, answering busy");
+      self->context->PathBuildBusy();
+      OnForwardLRCMResult(
+          self->context->Router(),
+          self->hop->info.rxID,
+          self->hop->info.downstream,
+          self->hop->pathKey,
+          SendStatus::Congestion);
+      self->hop = nullptr;
+      return true;
     }
 
     /// this is done from logic thread
     static void
     SendLRCM(std::shared_ptr<LRCMFrameDecrypt> self)
     {
+      if (RejectIfLate(self))
+        return;
       if (self->context->HasTransitHop(self->hop->info))
       {
         llarp::LogError("duplicate transit hop ", self->hop->info);
@@ -336,6 +391,8 @@ namespace llarp
     static void
     SendPathConfirm(std::shared_ptr<LRCMFrameDecrypt> self)
     {
+      if (RejectIfLate(self))
+        return;
       // send path confirmation
       // TODO: other status flags?
       uint64_t status = LR_StatusRecord::SUCCESS;
@@ -357,7 +414,8 @@ namespace llarp
               self->hop->info.rxID,
               self->hop->info.downstream,
               self->hop->pathKey,
-              status))
+              status,
+              self->hop->LoadReport(self->context->Router())))
       {
         llarp::LogError("failed to send path confirmation for ", self->hop->info);
       }
@@ -425,6 +483,8 @@ namespace llarp
         self->hop->lifetime = self->record.lifetime;
         llarp::LogDebug("LRCM short lifespan set to ", self->hop->lifetime, " for ", info);
       }
+      self->hop->padding = self->record.padding;
+      self->hop->reportLoad = self->record.wantLoad;
 
       // TODO: check if we really want to accept it
       self->hop->started = now;
@@ -477,11 +537,19 @@ namespace llarp
     // copy frames so we own them
     auto frameDecrypt = std::make_shared<LRCMFrameDecrypt>(context, std::move(decrypter), this);
 
-    // decrypt frames async
+    // decrypt frames async, behind the crypto of paths already built so a storm of builds
+    // does not hold up their traffic
+    bool queued = false;
     frameDecrypt->decrypter->AsyncDecrypt(
-        frameDecrypt->frames[0], frameDecrypt, [r = context->Router()](auto func) {
-          r->QueueWork(std::move(func));
+        frameDecrypt->frames[0], frameDecrypt, [r = context->Router(), &queued](auto func) {
+          queued = r->QueuePathBuildWork(std::move(func));
         });
+    if (not queued)
+    {
+      // we can not even say we are busy without decrypting, the builder times out instead
+      llarp::LogDebug("too many path builds waiting, dropping one from ", session->GetPubKey());
+      context->PathBuildShed();
+    }
     return true;
   }
 }  // namespace llarp
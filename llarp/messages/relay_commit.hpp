@@ -6,6 +6,7 @@
 #include <messages/link_message.hpp>
 #include <path/path_types.hpp>
 #include <pow.hpp>
+#include <util/padding.hpp>
 
 #include <array>
 #include <memory>
@@ -20,6 +21,12 @@ namespace llarp
     struct PathContext;
   }
 
+  /// first router version that reads the padding profile of a commit record
+  static constexpr RouterVersion::Version_t PaddingPolicyVersion{{0, 8, 2}};
+
+  /// first router version that reports its load in its build status record when asked
+  static constexpr RouterVersion::Version_t LoadReportVersion{{0, 8, 2}};
+
   struct LR_CommitRecord
   {
     PubKey commkey;
@@ -31,6 +38,11 @@ namespace llarp
     std::unique_ptr<PoW> work;
     uint64_t version = 0;
     llarp_time_t lifetime = 0s;
+    /// what the hop pads the cells it sends us to, only sent when not the default and only
+    /// to hops new enough to know it, as older ones reject a record with a key they lack
+    padding::Profile padding = padding::DefaultProfile;
+    /// put our load in the status record we send back, asked of hops new enough to know it
+    bool wantLoad = false;
 
     bool
     BDecode(llarp_buffer_t* buf);
@@ -84,6 +96,12 @@ namespace llarp
     {
       return 5;
     }
+
+    TrafficClass
+    Class() const override
+    {
+      return TrafficClass::PathBuild;
+    }
   };
 }  // namespace llarp
 
@@ -161,7 +161,8 @@ namespace llarp
       const PathID_t pathid,
       const RouterID nextHop,
       const SharedSecret pathKey,
-      uint64_t status)
+      uint64_t status,
+      std::optional<path::RelayLoad> load)
   {
     auto message = std::make_shared<LR_StatusMessage>();
 
@@ -170,7 +171,7 @@ namespace llarp
 
     message->SetDummyFrames();
 
-    if (!message->AddFrame(pathKey, status))
+    if (!message->AddFrame(pathKey, status, load))
     {
       return false;
     }
@@ -180,7 +181,8 @@ namespace llarp
   }
 
   bool
-  LR_StatusMessage::AddFrame(const SharedSecret& pathKey, uint64_t newStatus)
+  LR_StatusMessage::AddFrame(
+      const SharedSecret& pathKey, uint64_t newStatus, std::optional<path::RelayLoad> load)
   {
     frames[7] = frames[6];
     frames[6] = frames[5];
@@ -198,6 +200,7 @@ namespace llarp
 
     record.status = newStatus;
     record.version = LLARP_PROTO_VERSION;
+    record.load = load;
 
     llarp_buffer_t buf(frame.data(), frame.size());
     buf.cur = buf.base + EncryptedFrameOverheadSize;
@@ -242,7 +245,11 @@ namespace llarp
   bool
   LR_StatusRecord::BEncode(llarp_buffer_t* buf) const
   {
-    return bencode_start_dict(buf) && BEncodeWriteDictInt("s", status, buf)
+    if (!bencode_start_dict(buf))
+      return false;
+    if (load and !BEncodeWriteDictInt("l", *load, buf))
+      return false;
+    return BEncodeWriteDictInt("s", status, buf)
         && bencode_write_uint64_entry(buf, "v", 1, LLARP_PROTO_VERSION) && bencode_end(buf);
   }
 
@@ -254,6 +261,14 @@ namespace llarp
 
     bool read = false;
 
+    if (*key == "l")
+    {
+      uint64_t level = 0;
+      if (!bencode_read_integer(buffer, &level) or level > path::MaxRelayLoad)
+        return false;
+      load = level;
+      return true;
+    }
     if (!BEncodeMaybeReadDictInt("s", status, read, *key, buffer))
       return false;
     if (!BEncodeMaybeVerifyVersion("v", version, LLARP_PROTO_VERSION, read, *key, buffer))
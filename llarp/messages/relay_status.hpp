@@ -5,6 +5,7 @@
 #include <crypto/types.hpp>
 #include <messages/link_message.hpp>
 #include <path/path_types.hpp>
+#include <path/relay_load.hpp>
 #include <pow.hpp>
 
 #include <array>
@@ -35,6 +36,8 @@ namespace llarp
 
     uint64_t status = 0;
     uint64_t version = 0;
+    /// the hop's load, only there when the builder asked for it in the commit record
+    std::optional<path::RelayLoad> load;
 
     bool
     BDecode(llarp_buffer_t* buf);
@@ -87,10 +90,14 @@ namespace llarp
         const PathID_t pathid,
         const RouterID nextHop,
         const SharedSecret pathKey,
-        uint64_t status);
+        uint64_t status,
+        std::optional<path::RelayLoad> load = std::nullopt);
 
     bool
-    AddFrame(const SharedSecret& pathKey, uint64_t newStatus);
+    AddFrame(
+        const SharedSecret& pathKey,
+        uint64_t newStatus,
+        std::optional<path::RelayLoad> load = std::nullopt);
 
     static void
     QueueSendMessage(
@@ -110,6 +117,12 @@ namespace llarp
     {
       return 6;
     }
+
+    TrafficClass
+    Class() const override
+    {
+      return TrafficClass::PathBuild;
+    }
   };
 }  // namespace llarp
 
@@ -0,0 +1,143 @@
+#include <net/address_pool.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace llarp
+{
+  namespace net
+  {
+    void
+    AddressPool::Reset(huint128_t first, huint128_t last)
+    {
+      m_First = first;
+      m_Last = std::max(first, last);
+      m_Top = first;
+      m_Free.clear();
+      m_Held.clear();
+      m_ByActivity.clear();
+    }
+
+    std::optional<huint128_t>
+    AddressPool::Allocate()
+    {
+      while (not m_Free.empty())
+      {
+        const huint128_t ip = m_Free.back();
+        m_Free.pop_back();
+        if (IsHeld(ip))
+          continue;
+        Hold(ip);
+        return ip;
+      }
+      // addresses taken by hand from the unused part of the range are stepped over
+      while (m_Top < m_Last)
+      {
+        const huint128_t ip = ++m_Top;
+        if (IsHeld(ip))
+          continue;
+        Hold(ip);
+        return ip;
+      }
+      return std::nullopt;
+    }
+
+    void
+    AddressPool::Take(huint128_t ip)
+    {
+      Hold(ip);
+    }
+
+    void
+    AddressPool::Release(huint128_t ip)
+    {
+      auto itr = m_Held.find(ip);
+      if (itr == m_Held.end())
+        return;
+      if (not itr->second.pinned)
+        m_ByActivity.erase(itr->second.pos);
+      m_Held.erase(itr);
+      if (InRange(ip))
+        m_Free.push_back(ip);
+    }
+
+    void
+    AddressPool::MarkActive(huint128_t ip, llarp_time_t now)
+    {
+      auto& entry = Hold(ip);
+      if (entry.pinned or now < entry.lastActive)
+        return;
+      entry.lastActive = now;
+      m_ByActivity.splice(m_ByActivity.end(), m_ByActivity, entry.pos);
+    }
+
+    void
+    AddressPool::Pin(huint128_t ip)
+    {
+      auto& entry = Hold(ip);
+      if (entry.pinned)
+        return;
+      m_ByActivity.erase(entry.pos);
+      entry.pinned = true;
+      entry.lastActive = llarp_time_t::max();
+    }
+
+    std::optional<huint128_t>
+    AddressPool::Oldest() const
+    {
+      if (m_ByActivity.empty())
+        return std::nullopt;
+      return m_ByActivity.front();
+    }
+
+    std::optional<llarp_time_t>
+    AddressPool::LastActive(huint128_t ip) const
+    {
+      const auto itr = m_Held.find(ip);
+      if (itr == m_Held.end())
+        return std::nullopt;
+      return itr->second.lastActive;
+    }
+
+    size_t
+    AddressPool::Capacity() const
+    {
+      const auto num = (m_Last - m_First).h;
+      // an ipv6 range can hold more than we could ever count
+      if (num.upper or num.lower > std::numeric_limits<size_t>::max())
+        return std::numeric_limits<size_t>::max();
+      return num.lower;
+    }
+
+    util::StatusObject
+    AddressPool::ExtractStatus() const
+    {
+      const size_t capacity = Capacity();
+      size_t usedInRange = 0;
+      for (const auto& item : m_Held)
+      {
+        if (InRange(item.first))
+          usedInRange++;
+      }
+      return util::StatusObject{
+          {"used", Used()},
+          {"capacity", capacity},
+          {"utilization", capacity ? double(usedInRange) / capacity : 0.0}};
+    }
+
+    AddressPool::Entry&
+    AddressPool::Hold(huint128_t ip)
+    {
+      auto [itr, inserted] = m_Held.try_emplace(ip);
+      if (inserted)
+        itr->second.pos = m_ByActivity.insert(m_ByActivity.begin(), ip);
+      return itr->second;
+    }
+
+    bool
+    AddressPool::InRange(huint128_t ip) const
+    {
+      return m_First < ip and not(m_Last < ip);
+    }
+  }  // namespace net
+}  // namespace llarp
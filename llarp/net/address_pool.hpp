@@ -0,0 +1,112 @@
+#ifndef LLARP_NET_ADDRESS_POOL_HPP
+#define LLARP_NET_ADDRESS_POOL_HPP
+
+#include <net/net_int.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// the addresses of a range we hand out to remotes. never used addresses come off the top
+    /// of the range and released ones off a free list, and held addresses are kept in order of
+    /// when they last saw traffic, so allocating, reclaiming the least active address and
+    /// noting activity are all O(1) however big the range is
+    class AddressPool
+    {
+     public:
+      /// hand out the addresses after first up to and including last, forgetting all held
+      void
+      Reset(huint128_t first, huint128_t last);
+
+      /// hold an address nobody holds, nullopt when every one is held
+      std::optional<huint128_t>
+      Allocate();
+
+      /// hold ip whether or not it is in our range, so it is never handed out
+      void
+      Take(huint128_t ip);
+
+      /// stop holding ip, it can be handed out again
+      void
+      Release(huint128_t ip);
+
+      /// note traffic on ip at now, holding it if it was not held
+      void
+      MarkActive(huint128_t ip, llarp_time_t now);
+
+      /// hold ip and never offer it as the least active
+      void
+      Pin(huint128_t ip);
+
+      /// the held address that went longest without traffic, pinned ones aside
+      std::optional<huint128_t>
+      Oldest() const;
+
+      /// when ip last saw traffic, llarp_time_t::max() if pinned, nullopt if not held
+      std::optional<llarp_time_t>
+      LastActive(huint128_t ip) const;
+
+      bool
+      IsHeld(huint128_t ip) const
+      {
+        return m_Held.count(ip) != 0;
+      }
+
+      /// visit each held address with when it last saw traffic
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t visit) const
+      {
+        for (const auto& item : m_Held)
+          visit(item.first, item.second.lastActive);
+      }
+
+      size_t
+      Used() const
+      {
+        return m_Held.size();
+      }
+
+      /// how many addresses the range has to hand out
+      size_t
+      Capacity() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Entry
+      {
+        llarp_time_t lastActive = 0s;
+        bool pinned = false;
+        /// place in m_ByActivity, unset when pinned
+        std::list<huint128_t>::iterator pos;
+      };
+
+      Entry&
+      Hold(huint128_t ip);
+
+      bool
+      InRange(huint128_t ip) const;
+
+      huint128_t m_First = {0};
+      huint128_t m_Last = {0};
+      /// the next never used address is one after this
+      huint128_t m_Top = {0};
+      /// released addresses, some may have been taken again since
+      std::vector<huint128_t> m_Free;
+      std::unordered_map<huint128_t, Entry> m_Held;
+      /// held addresses that are not pinned, least recently active first
+      std::list<huint128_t> m_ByActivity;
+    };
+  }  // namespace net
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef LLARP_NET_ENDPOINT_KEY_HPP
+#define LLARP_NET_ENDPOINT_KEY_HPP
+
+#include <net/ip_address.hpp>
+#include <net/sock_addr.hpp>
+#include <util/keyed_hash.hpp>
+
+#include <array>
+#include <cstring>
+#include <ostream>
+
+namespace llarp
+{
+  /// a remote's ipv6 (or ipv4 mapped) address and port as 18 bytes, the key for the maps the
+  /// link layer looks sessions up in for every datagram. made from the SockAddr a datagram
+  /// came from it is two copies, where an IpAddress is a string built and hashed
+  struct EndpointKey
+  {
+    static constexpr size_t SIZE = 16 + 2;
+
+    EndpointKey() = default;
+
+    explicit EndpointKey(const SockAddr& addr)
+    {
+      const sockaddr_in6* in6 = addr;
+      std::memcpy(m_data.data(), in6->sin6_addr.s6_addr, 16);
+      std::memcpy(m_data.data() + 16, &in6->sin6_port, 2);
+    }
+
+    /// parses the string IpAddress holds, keep it off the per datagram path
+    explicit EndpointKey(const IpAddress& addr) : EndpointKey{addr.createSockAddr()}
+    {}
+
+    SockAddr
+    ToSockAddr() const
+    {
+      sockaddr_in6 in6{};
+      in6.sin6_family = AF_INET6;
+      std::memcpy(in6.sin6_addr.s6_addr, m_data.data(), 16);
+      std::memcpy(&in6.sin6_port, m_data.data() + 16, 2);
+      return SockAddr{in6};
+    }
+
+    bool
+    operator==(const EndpointKey& other) const
+    {
+      return m_data == other.m_data;
+    }
+
+    bool
+    operator!=(const EndpointKey& other) const
+    {
+      return m_data != other.m_data;
+    }
+
+    bool
+    operator<(const EndpointKey& other) const
+    {
+      return m_data < other.m_data;
+    }
+
+    struct Hash
+    {
+      size_t
+      operator()(const EndpointKey& key) const noexcept
+      {
+        return KeyedHash(key.m_data.data(), SIZE);
+      }
+    };
+
+   private:
+    std::array<uint8_t, SIZE> m_data{};
+  };
+
+  inline std::ostream&
+  operator<<(std::ostream& out, const EndpointKey& key)
+  {
+    return out << key.ToSockAddr();
+  }
+}  // namespace llarp
+
+#endif
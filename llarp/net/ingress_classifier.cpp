@@ -0,0 +1,108 @@
+#include <net/ingress_classifier.hpp>
+
+#include <net/net.hpp>
+#include <util/bits.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace net
+  {
+    void
+    IngressClassifier::Reset(
+        std::optional<IPRange> sourceRange,
+        const std::vector<IPRange>& local,
+        const std::vector<IPRange>& routed)
+    {
+      m_SourceRange = std::move(sourceRange);
+      m_Local.clear();
+      m_Routed.clear();
+      AddRules(m_Local, local);
+      AddRules(m_Routed, routed);
+    }
+
+    void
+    IngressClassifier::AddRules(std::vector<Rule>& rules, const std::vector<IPRange>& ranges)
+    {
+      for (const auto& range : ranges)
+        rules.emplace_back(Rule{range.addr & range.netmask_bits, range.netmask_bits, range});
+      // first match wins so the narrowest ranges go first
+      std::stable_sort(rules.begin(), rules.end(), [](const auto& lhs, const auto& rhs) {
+        return bits::count_bits_128(lhs.mask.h) > bits::count_bits_128(rhs.mask.h);
+      });
+    }
+
+    IngressClassifier::Rule*
+    IngressClassifier::Match(std::vector<Rule>& rules, huint128_t ip)
+    {
+      for (auto& rule : rules)
+      {
+        if (rule.Matches(ip))
+          return &rule;
+      }
+      return nullptr;
+    }
+
+    IngressVerdict
+    IngressClassifier::Classify(const IPPacket& pkt)
+    {
+      huint128_t src, dst;
+      if (pkt.IsV4() and pkt.sz >= 20)
+      {
+        src = pkt.src4to6();
+        dst = pkt.dst4to6();
+      }
+      else if (pkt.IsV6() and pkt.sz >= 40)
+      {
+        src = pkt.srcv6();
+        dst = pkt.dstv6();
+      }
+      else
+      {
+        m_Malformed++;
+        return IngressVerdict::Drop;
+      }
+      if (m_SourceRange and not m_SourceRange->Contains(src))
+      {
+        m_Spoofed++;
+        return IngressVerdict::Drop;
+      }
+      if (auto rule = Match(m_Local, dst))
+      {
+        rule->hits++;
+        return IngressVerdict::Forward;
+      }
+      if (IsBogon(dst))
+      {
+        m_Bogon++;
+        return IngressVerdict::Unreachable;
+      }
+      if (auto rule = Match(m_Routed, dst))
+      {
+        rule->hits++;
+        return IngressVerdict::Forward;
+      }
+      m_Unrouted++;
+      return IngressVerdict::Unreachable;
+    }
+
+    util::StatusObject
+    IngressClassifier::ExtractStatus() const
+    {
+      const auto rulesStatus = [](const std::vector<Rule>& rules) {
+        util::StatusObject obj{};
+        for (const auto& rule : rules)
+          obj[rule.range.ToString()] = rule.hits;
+        return obj;
+      };
+      return util::StatusObject{
+          {"local", rulesStatus(m_Local)},
+          {"routed", rulesStatus(m_Routed)},
+          {"malformed", m_Malformed},
+          {"spoofed", m_Spoofed},
+          {"bogon", m_Bogon},
+          {"unrouted", m_Unrouted}};
+    }
+  }  // namespace net
+}  // namespace llarp
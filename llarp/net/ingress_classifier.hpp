@@ -0,0 +1,79 @@
+#ifndef LLARP_NET_INGRESS_CLASSIFIER_HPP
+#define LLARP_NET_INGRESS_CLASSIFIER_HPP
+
+#include <net/ip_packet.hpp>
+#include <net/ip_range.hpp>
+#include <util/status.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// what to do with a packet read from the tun
+    enum class IngressVerdict : uint8_t
+    {
+      /// queue it to go out over the network
+      Forward,
+      /// nothing can take it, answer with icmp unreachable
+      Unreachable,
+      /// let it go without a reply
+      Drop
+    };
+
+    /// verdicts on packets as they are read from the tun, so ones we could never send are not
+    /// copied into the send queues first. destinations are matched against a flat table of
+    /// masked ranges, local ones, then bogons, then ranges routed to exits, most specific
+    /// first in each, and every rule counts its hits. not thread safe.
+    class IngressClassifier
+    {
+     public:
+      /// replace the table. packets from outside sourceRange are dropped when it is set,
+      /// packets to local ranges are forwarded as are those to routed ranges that are not bogons
+      void
+      Reset(
+          std::optional<IPRange> sourceRange,
+          const std::vector<IPRange>& local,
+          const std::vector<IPRange>& routed);
+
+      IngressVerdict
+      Classify(const IPPacket& pkt);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Rule
+      {
+        huint128_t net;
+        huint128_t mask;
+        IPRange range;
+        uint64_t hits = 0;
+
+        bool
+        Matches(huint128_t ip) const
+        {
+          return (ip & mask) == net;
+        }
+      };
+
+      static void
+      AddRules(std::vector<Rule>& rules, const std::vector<IPRange>& ranges);
+
+      static Rule*
+      Match(std::vector<Rule>& rules, huint128_t ip);
+
+      std::optional<IPRange> m_SourceRange;
+      std::vector<Rule> m_Local;
+      std::vector<Rule> m_Routed;
+      uint64_t m_Malformed = 0;
+      uint64_t m_Spoofed = 0;
+      uint64_t m_Bogon = 0;
+      uint64_t m_Unrouted = 0;
+    };
+  }  // namespace net
+}  // namespace llarp
+
+#endif
@@ -10,6 +10,7 @@
 #endif
 
 #include <algorithm>
+#include <cstring>
 #include <map>
 
 constexpr uint32_t ipv6_flowlabel_mask = 0b0000'0000'0000'1111'1111'1111'1111'1111;
@@ -32,6 +33,93 @@ namespace llarp
 {
   namespace net
   {
+    /// fnv-1a
+    static uint32_t
+    HashBytes(uint32_t h, const byte_t* ptr, size_t sz)
+    {
+      for (size_t idx = 0; idx < sz; ++idx)
+      {
+        h ^= ptr[idx];
+        h *= 16777619u;
+      }
+      return h;
+    }
+
+    uint32_t
+    FlowHash(const byte_t* pkt, size_t sz)
+    {
+      constexpr byte_t TCP = 6;
+      constexpr byte_t UDP = 17;
+      if (sz == 0)
+        return 0;
+      uint32_t h = 2166136261u;
+      byte_t proto;
+      size_t l4;
+      switch (pkt[0] >> 4)
+      {
+        case 4:
+          if (sz < 20)
+            return 0;
+          proto = pkt[9];
+          l4 = (pkt[0] & 0x0f) * 4;
+          // later fragments carry no ports
+          if (((pkt[6] & 0x1f) | pkt[7]) != 0)
+            l4 = sz;
+          h = HashBytes(h, pkt + 12, 8);
+          break;
+        case 6:
+          if (sz < 40)
+            return 0;
+          proto = pkt[6];
+          l4 = 40;
+          h = HashBytes(h, pkt + 8, 32);
+          break;
+        default:
+          return 0;
+      }
+      h = HashBytes(h, &proto, 1);
+      if ((proto == TCP or proto == UDP) and l4 + 4 <= sz)
+        h = HashBytes(h, pkt + l4, 4);
+      return h;
+    }
+
+    bool
+    IsInteractive(const byte_t* pkt, size_t sz)
+    {
+      constexpr byte_t TCP = 6;
+      constexpr byte_t UDP = 17;
+      constexpr uint16_t DNSPort = 53;
+      if (sz <= InteractiveSize)
+        return true;
+      byte_t proto;
+      size_t l4;
+      switch (pkt[0] >> 4)
+      {
+        case 4:
+          proto = pkt[9];
+          l4 = (pkt[0] & 0x0f) * 4;
+          // later fragments carry no header to go by
+          if (((pkt[6] & 0x1f) | pkt[7]) != 0)
+            return false;
+          break;
+        case 6:
+          proto = pkt[6];
+          l4 = 40;
+          break;
+        default:
+          return false;
+      }
+      if (proto == UDP and l4 + 4 <= sz)
+      {
+        const uint16_t srcPort = (uint16_t{pkt[l4]} << 8) | pkt[l4 + 1];
+        const uint16_t dstPort = (uint16_t{pkt[l4 + 2]} << 8) | pkt[l4 + 3];
+        return srcPort == DNSPort or dstPort == DNSPort;
+      }
+      if (proto == TCP and l4 + 20 <= sz)
+        return l4 + size_t(pkt[l4 + 12] >> 4) * 4 >= sz;
+      return false;
+    }
+
     inline static uint32_t*
     in6_uint32_ptr(in6_addr& addr)
     {
@@ -112,29 +200,45 @@ namespace llarp
       return ExpandV4(srcv4());
     }
 
-    static uint16_t
-    ipchksum(const byte_t* buf, size_t sz, uint32_t sum = 0)
+    uint16_t
+    IPChecksum(const byte_t* buf, size_t sz, uint32_t sum)
     {
-      while (sz > 1)
+      // one's complement sums do not care how wide the words are as long as the carries are
+      // folded back in at the end, so add 32 bit words into 64 bits, which compilers turn
+      // into vector adds, and fold once
+      uint64_t acc = sum;
+      while (sz >= 16)
+      {
+        uint32_t words[4];
+        std::memcpy(words, buf, sizeof(words));
+        acc += uint64_t{words[0]} + words[1] + words[2] + words[3];
+        sz -= sizeof(words);
+        buf += sizeof(words);
+      }
+      while (sz >= 4)
       {
-        sum += *(const uint16_t*)buf;
-        sz -= sizeof(uint16_t);
-        buf += sizeof(uint16_t);
+        uint32_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        acc += word;
+        sz -= sizeof(word);
+        buf += sizeof(word);
       }
       if (sz != 0)
       {
-        uint16_t x = 0;
-
-        *(byte_t*)&x = *(const byte_t*)buf;
-        sum += x;
+        // the odd bytes are padded with zeros after them
+        uint32_t word = 0;
+        std::memcpy(&word, buf, sz);
+        acc += word;
       }
-
+      acc = (acc & 0xFFffFFff) + (acc >> 32);
+      acc = (acc & 0xFFffFFff) + (acc >> 32);
       // only need to do it 2 times to be sure
       // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-      sum = (sum & 0xFFff) + (sum >> 16);
-      sum += sum >> 16;
+      uint32_t folded = (acc & 0xFFff) + (acc >> 16);
+      folded = (folded & 0xFFff) + (folded >> 16);
+      folded += folded >> 16;
 
-      return uint16_t((~sum) & 0xFFff);
+      return uint16_t((~folded) & 0xFFff);
     }
 
 #define ADD32CS(x) ((uint32_t)(x & 0xFFff) + (uint32_t)(x >> 16))
@@ -466,6 +570,126 @@ namespace llarp
       }
     }
 
+    bool
+    IPPacket::ClampTCPMSS()
+    {
+      size_t ipHeaderSize = 0;
+      if (IsV4())
+      {
+        ipHeaderSize = size_t{buf[0] & 0x0fu} * 4;
+        const bool firstFragment = (buf[6] & 0x1f) == 0 and buf[7] == 0;
+        if (buf[9] != 6 or not firstFragment)
+          return false;
+      }
+      else if (IsV6())
+      {
+        // an mss behind extension headers is left alone
+        ipHeaderSize = 40;
+        if (buf[6] != 6)
+          return false;
+      }
+      else
+        return false;
+      if (sz < ipHeaderSize + 20)
+        return false;
+      byte_t* tcp = buf + ipHeaderSize;
+      // only syns carry an mss
+      if ((tcp[13] & 0x02) == 0)
+        return false;
+      const size_t tcpHeaderSize = size_t{tcp[12] >> 4u} * 4;
+      if (tcpHeaderSize < 20 or sz < ipHeaderSize + tcpHeaderSize)
+        return false;
+      const uint16_t maxMSS = MaxSize - ipHeaderSize - 20;
+
+      size_t idx = 20;
+      while (idx + 1 < tcpHeaderSize)
+      {
+        const byte_t kind = tcp[idx];
+        // end of options
+        if (kind == 0)
+          return false;
+        // nop
+        if (kind == 1)
+        {
+          ++idx;
+          continue;
+        }
+        const size_t len = tcp[idx + 1];
+        if (len < 2 or idx + len > tcpHeaderSize)
+          return false;
+        if (kind != 2 or len != 4)
+        {
+          idx += len;
+          continue;
+        }
+        const uint16_t mss = (uint16_t{tcp[idx + 2]} << 8) | tcp[idx + 3];
+        if (mss <= maxMSS)
+          return false;
+        tcp[idx + 2] = maxMSS >> 8;
+        tcp[idx + 3] = maxMSS & 0xff;
+        // HC' = ~(~HC + ~m + m') from rfc 1624. an mss at an odd offset has its bytes in the
+        // other halves of the two words it straddles, which comes to the same sum with the
+        // bytes swapped
+        const bool odd = idx % 2;
+        const uint16_t oldWord = odd ? uint16_t((mss << 8) | (mss >> 8)) : mss;
+        const uint16_t newWord = odd ? uint16_t((maxMSS << 8) | (maxMSS >> 8)) : maxMSS;
+        const uint16_t check = (uint16_t{tcp[16]} << 8) | tcp[17];
+        uint32_t sum = uint32_t{uint16_t(~check)} + uint16_t(~oldWord) + newWord;
+        sum = (sum & 0xFFff) + (sum >> 16);
+        sum += sum >> 16;
+        const uint16_t newCheck = ~sum;
+        tcp[16] = newCheck >> 8;
+        tcp[17] = newCheck & 0xff;
+        return true;
+      }
+      return false;
+    }
+
+    bool
+    MarkCE(byte_t* pkt, size_t sz)
+    {
+      if (sz < 20)
+        return false;
+      const int version = pkt[0] >> 4;
+      if (version == 4)
+      {
+        const byte_t ecn = pkt[1] & 0x03;
+        // not ect, or already marked
+        if (ecn == 0)
+          return false;
+        if (ecn == 0x03)
+          return true;
+        const uint16_t oldWord = (uint16_t{pkt[0]} << 8) | pkt[1];
+        pkt[1] |= 0x03;
+        const uint16_t newWord = (uint16_t{pkt[0]} << 8) | pkt[1];
+        // rfc 1624 as in ClampTCPMSS, the header checksum is the only one covering tos
+        const uint16_t check = (uint16_t{pkt[10]} << 8) | pkt[11];
+        uint32_t sum = uint32_t{uint16_t(~check)} + uint16_t(~oldWord) + newWord;
+        sum = (sum & 0xFFff) + (sum >> 16);
+        sum += sum >> 16;
+        const uint16_t newCheck = ~sum;
+        pkt[10] = newCheck >> 8;
+        pkt[11] = newCheck & 0xff;
+        return true;
+      }
+      if (version == 6 and sz >= 40)
+      {
+        // the traffic class straddles the first two bytes, ecn is its low 2 bits
+        const byte_t ecn = (pkt[1] >> 4) & 0x03;
+        if (ecn == 0)
+          return false;
+        pkt[1] |= 0x30;
+        return true;
+      }
+      return false;
+    }
+
+    bool
+    IPPacket::MarkCE()
+    {
+      return net::MarkCE(buf, sz);
+    }
+
     std::optional<IPPacket>
     IPPacket::MakeICMPUnreachable() const
     {
@@ -509,10 +733,10 @@ namespace llarp
         std::copy_n(buf, l4_PacketSize + l3_HeaderSize, itr);
         itr += l4_PacketSize + l3_HeaderSize;
         // calculate checksum of ip header
-        pkt_Header->check = ipchksum(pkt.buf, pkt_Header->ihl * 4);
+        pkt_Header->check = IPChecksum(pkt.buf, pkt_Header->ihl * 4);
         const auto icmp_size = std::distance(icmp_begin, itr);
         // calculate icmp checksum
-        *checksum = ipchksum(icmp_begin, icmp_size);
+        *checksum = IPChecksum(icmp_begin, icmp_size);
         pkt.sz = ntohs(pkt_Header->tot_len);
         return pkt;
       }
@@ -115,6 +115,31 @@ namespace llarp
 {
   namespace net
   {
+    /// hash the addresses, protocol and tcp or udp ports of a raw ip packet so every packet of a
+    /// flow hashes the same, 0 for anything too short to be an ip packet
+    uint32_t
+    FlowHash(const byte_t* pkt, size_t sz);
+
+    /// the internet checksum of sz bytes at buf, with sum as the running sum of whatever came
+    /// before, in the byte order it sits in the packet
+    uint16_t
+    IPChecksum(const byte_t* buf, size_t sz, uint32_t sum = 0);
+
+    /// set the ecn field of the raw ip packet at pkt to congestion experienced if it is ect,
+    /// fixing the ipv4 header checksum. false if it is not ect, in which case it is left alone
+    /// and has to be dropped to tell the sender
+    bool
+    MarkCE(byte_t* pkt, size_t sz);
+
+    /// packets no bigger than this are interactive whatever they carry
+    constexpr size_t InteractiveSize = 128;
+
+    /// true if the raw ip packet at pkt is one a person is waiting on rather than part of a bulk
+    /// transfer: tcp segments with no payload, so acks and connection setup and teardown, dns
+    /// over udp and anything no bigger than InteractiveSize
+    bool
+    IsInteractive(const byte_t* pkt, size_t sz);
+
     /// an Packet
     struct IPPacket
     {
@@ -165,6 +190,16 @@ namespace llarp
         }
       };
 
+      /// marks instead of dropping for queues that can, see MarkCE
+      struct MarkCongestion
+      {
+        bool
+        operator()(IPPacket& pkt) const
+        {
+          return pkt.MarkCE();
+        }
+      };
+
       struct CompareSize
       {
         bool
@@ -269,6 +304,15 @@ namespace llarp
       void
       ZeroSourceAddress(std::optional<nuint32_t> flowlabel = std::nullopt);
 
+      /// if this is a tcp syn asking for segments too big to fit in MaxSize once headers go on,
+      /// lower its mss option so they fit and fix the checksum. return true if it changed
+      bool
+      ClampTCPMSS();
+
+      /// net::MarkCE on this packet
+      bool
+      MarkCE();
+
       /// make an icmp unreachable reply packet based of this ip packet
       std::optional<IPPacket>
       MakeICMPUnreachable() const;
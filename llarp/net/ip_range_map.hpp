@@ -2,17 +2,24 @@
 #define LLARP_NET_IP_RANGE_MAP_HPP
 
 #include <net/ip_range.hpp>
+#include <util/bits.hpp>
 #include <util/status.hpp>
+
+#include <array>
+#include <functional>
 #include <list>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
 
 namespace llarp
 {
   namespace net
   {
     /// a container that maps an ip range to a value that allows you to lookup
-    /// key by range hit
-    /// TODO: do some kind of magic shit to ensure near constant time for
-    /// lookups
+    /// key by range hit. ranges are also kept in a binary trie keyed on their prefix bits so a
+    /// lookup walks at most 128 nodes no matter how many ranges there are
     template <typename Value_t>
     struct IPRangeMap
     {
@@ -41,12 +48,7 @@ namespace llarp
       bool
       ContainsValue(const Value_t& val) const
       {
-        for (const auto& entry : m_Entries)
-        {
-          if (entry.second == val)
-            return true;
-        }
-        return false;
+        return m_ValueCounts.count(val) != 0;
       }
 
       void
@@ -82,9 +84,18 @@ namespace llarp
       std::optional<Value_t>
       GetExact(Range_t range) const
       {
-        for (const auto& [r, value] : m_Entries)
+        const IP_t base = range.addr & range.netmask_bits;
+        const size_t prefix = PrefixLength(range);
+        size_t idx = 0;
+        for (size_t bit = 0; bit < prefix; ++bit)
+        {
+          idx = m_Nodes[idx].next[BitAt(base, bit)];
+          if (idx == 0)
+            return std::nullopt;
+        }
+        for (const auto& [r, value] : m_Nodes[idx].here)
         {
-          if (r == range)
+          if (r.addr == range.addr and r.netmask_bits == range.netmask_bits)
             return value;
         }
         return std::nullopt;
@@ -95,10 +106,19 @@ namespace llarp
       FindAll(const IP_t& addr) const
       {
         std::set<Value_t> found;
-        for (const auto& entry : m_Entries)
+        if (m_Entries.empty())
+          return found;
+        // every range on the way down to the longest prefix of addr we know contains it
+        size_t idx = 0;
+        for (size_t bit = 0; bit <= 128; ++bit)
         {
-          if (entry.first.Contains(addr))
+          for (const auto& entry : m_Nodes[idx].here)
             found.insert(entry.second);
+          if (bit == 128)
+            break;
+          idx = m_Nodes[idx].next[BitAt(addr, bit)];
+          if (idx == 0)
+            break;
         }
         return found;
       }
@@ -116,6 +136,7 @@ namespace llarp
       Insert(const Range_t& addr, const Value_t& val)
       {
         m_Entries.emplace_front(addr, val);
+        Index(m_Entries.front());
         m_Entries.sort(CompareEntry{});
       }
 
@@ -131,6 +152,11 @@ namespace llarp
           else
             ++itr;
         }
+        // removals are rare enough that building the index again beats unlinking nodes
+        m_Nodes.assign(1, Node{});
+        m_ValueCounts.clear();
+        for (const auto& entry : m_Entries)
+          Index(entry);
       }
 
       util::StatusObject
@@ -145,7 +171,53 @@ namespace llarp
       }
 
      private:
+      struct Node
+      {
+        /// index of the child for a 0 or 1 next bit, 0 for none as the root is never a child
+        std::array<size_t, 2> next{};
+        /// ranges whose prefix ends here
+        std::vector<Entry_t> here;
+      };
+
+      static size_t
+      PrefixLength(const Range_t& range)
+      {
+        return bits::count_bits_128(range.netmask_bits.h);
+      }
+
+      /// bit number bit of ip counting from the most significant
+      static size_t
+      BitAt(const IP_t& ip, size_t bit)
+      {
+        if (bit < 64)
+          return (ip.h.upper >> (63 - bit)) & 1;
+        return (ip.h.lower >> (127 - bit)) & 1;
+      }
+
+      void
+      Index(const Entry_t& entry)
+      {
+        const IP_t base = entry.first.addr & entry.first.netmask_bits;
+        const size_t prefix = PrefixLength(entry.first);
+        size_t idx = 0;
+        for (size_t bit = 0; bit < prefix; ++bit)
+        {
+          const size_t side = BitAt(base, bit);
+          if (m_Nodes[idx].next[side] == 0)
+          {
+            m_Nodes[idx].next[side] = m_Nodes.size();
+            m_Nodes.emplace_back();
+          }
+          idx = m_Nodes[idx].next[side];
+        }
+        m_Nodes[idx].here.emplace_back(entry);
+        m_ValueCounts[entry.second]++;
+      }
+
       Container_t m_Entries;
+      /// the trie, the root is always there
+      std::vector<Node> m_Nodes = std::vector<Node>(1);
+      std::map<Value_t, size_t> m_ValueCounts;
     };
   }  // namespace net
 }  // namespace llarp
@@ -13,6 +13,7 @@
 #include <net/net.hpp>
 #include <exception>
 #include <charconv>
+#include <cerrno>
 #endif
 #ifdef __APPLE__
 #include <net/net.hpp>
@@ -138,16 +139,23 @@ namespace llarp::net
     return 0;
   }
 
-  int
-  do_route(int sock, int cmd, int flags, _inet_addr* dst, _inet_addr* gw, int def_gw, int if_idx)
+  struct nl_route_request
   {
-    struct
-    {
-      struct nlmsghdr n;
-      struct rtmsg r;
-      char buf[4096];
-    } nl_request{};
+    struct nlmsghdr n;
+    struct rtmsg r;
+    char buf[4096];
+  };
 
+  void
+  make_route(
+      nl_route_request& nl_request,
+      int cmd,
+      int flags,
+      _inet_addr* dst,
+      _inet_addr* gw,
+      int def_gw,
+      int if_idx)
+  {
     /* Initialize request structure */
     nl_request.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
     nl_request.n.nlmsg_flags = NLM_F_REQUEST | flags;
@@ -201,6 +209,13 @@ namespace llarp::net
       /* Set interface */
       rtattr_add(&nl_request.n, sizeof(nl_request), RTA_OIF, &if_idx, sizeof(int));
     }
+  }
+
+  int
+  do_route(int sock, int cmd, int flags, _inet_addr* dst, _inet_addr* gw, int def_gw, int if_idx)
+  {
+    nl_route_request nl_request{};
+    make_route(nl_request, cmd, flags, dst, gw, def_gw, if_idx);
 
     /* Send message to the netlink */
     return send(sock, &nl_request, sizeof(nl_request), 0);
@@ -222,6 +237,51 @@ namespace llarp::net
     return inet_pton(res->family, addr, res->data);
   }
 
+
+  /// how much of a batch of route requests goes in one datagram
+  static constexpr size_t MaxRouteBatchBytes = 32 * 1024;
+
+  /// send every change as one request, packed back to back into as few datagrams as fit
+  void
+  do_routes(int sock, const std::vector<RouteChange>& changes)
+  {
+    std::vector<char> batch;
+    batch.reserve(MaxRouteBatchBytes);
+    const auto flush = [&batch, sock]() {
+      if (batch.empty())
+        return;
+      if (send(sock, batch.data(), batch.size(), 0) == -1)
+        LogError("failed to send route batch: ", strerror(errno));
+      batch.clear();
+    };
+    uint32_t seq = 0;
+    for (const auto& change : changes)
+    {
+      _inet_addr to_addr{};
+      _inet_addr gw_addr{};
+      if (read_addr(change.gateway.c_str(), &gw_addr) != 1
+          or read_addr(change.ip.c_str(), &to_addr) != 1)
+      {
+        LogError("bad route ", change.ip, " via ", change.gateway);
+        continue;
+      }
+      nl_route_request nl_request{};
+      if (change.add)
+        make_route(nl_request, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, &to_addr, &gw_addr, 0, 0);
+      else
+        make_route(nl_request, RTM_DELROUTE, 0, &to_addr, &gw_addr, 0, 0);
+      nl_request.n.nlmsg_seq = ++seq;
+      const size_t len = NLMSG_ALIGN(nl_request.n.nlmsg_len);
+      if (batch.size() + len > MaxRouteBatchBytes)
+        flush();
+      const char* msg = reinterpret_cast<const char*>(&nl_request);
+      batch.insert(batch.end(), msg, msg + nl_request.n.nlmsg_len);
+      // every request starts aligned
+      batch.resize(batch.size() + len - nl_request.n.nlmsg_len, 0);
+    }
+    flush();
+  }
+
 #endif
 #endif
 
@@ -348,6 +408,45 @@ namespace llarp::net
 #endif
   }
 
+  std::vector<RouteChange>
+  DiffRoutes(const RouteMap_t& from, const RouteMap_t& to)
+  {
+    std::vector<RouteChange> changes;
+    for (const auto& [ip, gateway] : from)
+    {
+      const auto itr = to.find(ip);
+      if (itr == to.end() or itr->second != gateway)
+        changes.push_back(RouteChange{ip, gateway, false});
+    }
+    for (const auto& [ip, gateway] : to)
+    {
+      const auto itr = from.find(ip);
+      if (itr == from.end() or itr->second != gateway)
+        changes.push_back(RouteChange{ip, gateway, true});
+    }
+    return changes;
+  }
+
+  void
+  ApplyRoutes(const std::vector<RouteChange>& changes)
+  {
+    if (changes.empty())
+      return;
+    LogInfo("Apply ", changes.size(), " route changes");
+#if defined(__linux__) and not defined(ANDROID)
+    NLSocket sock;
+    do_routes(sock.fd, changes);
+#else
+    for (const auto& change : changes)
+    {
+      if (change.add)
+        AddRoute(change.ip, change.gateway);
+      else
+        DelRoute(change.ip, change.gateway);
+    }
+#endif
+  }
+
   void
   AddDefaultRouteViaInterface(std::string ifname)
   {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace llarp::net
@@ -17,6 +18,33 @@ namespace llarp::net
   void
   DelRoute(std::string ipaddr, std::string gateway);
 
+  /// a route to ipaddr via gateway ip to add or to delete
+  struct RouteChange
+  {
+    std::string ip;
+    std::string gateway;
+    bool add = true;
+
+    bool
+    operator==(const RouteChange& other) const
+    {
+      return ip == other.ip and gateway == other.gateway and add == other.add;
+    }
+  };
+
+  /// routes by the ip they go to, to the gateway they go via
+  using RouteMap_t = std::unordered_map<std::string, std::string>;
+
+  /// the changes that take the routes in from to the ones in to, deletes first, routes that
+  /// are the same in both are left alone
+  std::vector<RouteChange>
+  DiffRoutes(const RouteMap_t& from, const RouteMap_t& to);
+
+  /// apply many route changes in order, on linux as netlink requests packed into as few
+  /// datagrams on one socket as they fit in instead of a socket and a send per route
+  void
+  ApplyRoutes(const std::vector<RouteChange>& changes);
+
   /// add default route via interface with name ifname
   void
   AddDefaultRouteViaInterface(std::string ifname);
@@ -0,0 +1,310 @@
+#include <net/tun_offload.hpp>
+#include <net/ip_packet.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace llarp
+{
+  namespace net
+  {
+    static constexpr byte_t TCP = 6;
+
+    /// ones complement sum of buf, not folded
+    static uint32_t
+    SumWords(const byte_t* buf, size_t sz, uint32_t sum = 0)
+    {
+      while (sz > 1)
+      {
+        uint16_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        sum += word;
+        buf += sizeof(word);
+        sz -= sizeof(word);
+      }
+      if (sz != 0)
+      {
+        uint16_t word = 0;
+        std::memcpy(&word, buf, 1);
+        sum += word;
+      }
+      return sum;
+    }
+
+    static uint16_t
+    Fold(uint32_t sum)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+      sum += sum >> 16;
+      return uint16_t(~sum & 0xffff);
+    }
+
+    static uint16_t
+    ReadU16(const byte_t* ptr)
+    {
+      return (uint16_t{ptr[0]} << 8) | ptr[1];
+    }
+
+    static void
+    WriteU16(byte_t* ptr, uint16_t val)
+    {
+      ptr[0] = val >> 8;
+      ptr[1] = val & 0xff;
+    }
+
+    /// tcp checksum of the segment at seg, which starts with an ip header of iphl bytes
+    static void
+    FillTCPChecksum(byte_t* seg, size_t sz, size_t iphl, bool v4)
+    {
+      byte_t* tcp = seg + iphl;
+      const size_t tcplen = sz - iphl;
+      tcp[16] = 0;
+      tcp[17] = 0;
+      uint32_t sum;
+      if (v4)
+        sum = SumWords(seg + 12, 8);
+      else
+        sum = SumWords(seg + 8, 32);
+      byte_t trailer[4] = {0, TCP, 0, 0};
+      WriteU16(trailer + 2, tcplen);
+      sum = SumWords(trailer, sizeof(trailer), sum);
+      const uint16_t check = Fold(SumWords(tcp, tcplen, sum));
+      std::memcpy(tcp + 16, &check, sizeof(check));
+    }
+
+    bool
+    SplitOffloadedPacket(
+        byte_t* pkt, size_t sz, const std::function<void(const byte_t*, size_t)>& visit)
+    {
+      if (sz <= sizeof(VirtioNetHdr))
+        return false;
+      VirtioNetHdr hdr;
+      std::memcpy(&hdr, pkt, sizeof(hdr));
+      byte_t* const data = pkt + sizeof(hdr);
+      const size_t len = sz - sizeof(hdr);
+
+      const uint8_t gso = hdr.gso_type & ~VirtioNetHdr::GSOECN;
+      if (gso == VirtioNetHdr::GSONone)
+      {
+        if (hdr.flags & VirtioNetHdr::NeedsCsum)
+        {
+          // the kernel left the pseudo header sum in the checksum field, sum the rest over it
+          const size_t off = size_t{hdr.csum_start} + hdr.csum_offset;
+          if (hdr.csum_start >= len or off + 2 > len)
+            return false;
+          const uint16_t check = Fold(SumWords(data + hdr.csum_start, len - hdr.csum_start));
+          std::memcpy(data + off, &check, sizeof(check));
+        }
+        visit(data, len);
+        return true;
+      }
+      if (gso != VirtioNetHdr::GSOTCPv4 and gso != VirtioNetHdr::GSOTCPv6)
+        return false;
+
+      const bool v4 = gso == VirtioNetHdr::GSOTCPv4;
+      size_t iphl;
+      if (v4)
+      {
+        if (len < 20 or (data[0] >> 4) != 4)
+          return false;
+        iphl = (data[0] & 0x0f) * 4;
+      }
+      else
+      {
+        // we only ask for tso, which never puts extension headers in front of tcp
+        if (len < 40 or (data[0] >> 4) != 6 or data[6] != TCP)
+          return false;
+        iphl = 40;
+      }
+      if (iphl + 20 > len)
+        return false;
+      const size_t hdrlen = iphl + (data[iphl + 12] >> 4) * 4;
+      const size_t mss = hdr.gso_size;
+      if (hdrlen > len or mss == 0 or hdrlen + mss > IPPacket::MaxSize)
+        return false;
+
+      byte_t seg[IPPacket::MaxSize];
+      const uint16_t ipid = v4 ? ReadU16(data + 4) : 0;
+      uint32_t seqno;
+      std::memcpy(&seqno, data + iphl + 4, sizeof(seqno));
+      seqno = ntohl(seqno);
+      const byte_t flags = data[iphl + 13];
+
+      size_t offset = hdrlen;
+      for (uint16_t idx = 0; offset < len; ++idx)
+      {
+        const size_t chunk = std::min(mss, len - offset);
+        const size_t segsz = hdrlen + chunk;
+        std::memcpy(seg, data, hdrlen);
+        std::memcpy(seg + hdrlen, data + offset, chunk);
+        offset += chunk;
+
+        byte_t* tcp = seg + iphl;
+        const uint32_t segseq = htonl(seqno + (offset - chunk - hdrlen));
+        std::memcpy(tcp + 4, &segseq, sizeof(segseq));
+        byte_t segflags = flags;
+        // cwr only on the first segment, fin and psh only on the last, like the kernel's gso
+        if (idx > 0)
+          segflags &= ~0x80;
+        if (offset < len)
+          segflags &= ~(0x01 | 0x08);
+        tcp[13] = segflags;
+
+        if (v4)
+        {
+          WriteU16(seg + 2, segsz);
+          WriteU16(seg + 4, ipid + idx);
+          seg[10] = 0;
+          seg[11] = 0;
+          const uint16_t check = Fold(SumWords(seg, iphl));
+          std::memcpy(seg + 10, &check, sizeof(check));
+        }
+        else
+          WriteU16(seg + 4, segsz - 40);
+
+        FillTCPChecksum(seg, segsz, iphl, v4);
+        visit(seg, segsz);
+      }
+      return true;
+    }
+
+    static constexpr byte_t TCPFlagACK = 0x10;
+    static constexpr byte_t TCPFlagPSH = 0x08;
+
+    /// ip header size of a tcp packet we are willing to coalesce, 0 if it is not one
+    static size_t
+    CoalescableIPHeader(const llarp_tun_pkt& pkt)
+    {
+      if (pkt.sz < 20)
+        return 0;
+      const byte_t* ip = pkt.base;
+      switch (ip[0] >> 4)
+      {
+        case 4:
+          // no ip options and not a fragment
+          if (ip[0] != 0x45 or ip[9] != TCP or (ip[6] & 0x3f) != 0 or ip[7] != 0)
+            return 0;
+          return pkt.sz >= 40 ? 20 : 0;
+        case 6:
+          if (ip[6] != TCP)
+            return 0;
+          return pkt.sz >= 60 ? 40 : 0;
+        default:
+          return 0;
+      }
+    }
+
+    static size_t
+    TCPHeaderSize(const byte_t* tcp)
+    {
+      return (tcp[12] >> 4) * 4;
+    }
+
+    static uint32_t
+    ReadU32(const byte_t* ptr)
+    {
+      return (uint32_t{ptr[0]} << 24) | (uint32_t{ptr[1]} << 16) | (uint32_t{ptr[2]} << 8) | ptr[3];
+    }
+
+    size_t
+    CoalescableRun(const llarp_tun_pkt* pkts, size_t n)
+    {
+      if (n < 2)
+        return n;
+      const auto& first = pkts[0];
+      const size_t iphl = CoalescableIPHeader(first);
+      if (iphl == 0)
+        return 1;
+      const byte_t* fip = first.base;
+      const byte_t* ftcp = fip + iphl;
+      const size_t thl = TCPHeaderSize(ftcp);
+      const size_t hdrlen = iphl + thl;
+      // a bare ack or anything with flags the kernel treats specially goes on its own
+      if (thl < 20 or hdrlen >= first.sz or hdrlen > MaxCoalescedHeaderSize
+          or ftcp[13] != TCPFlagACK)
+        return 1;
+      const size_t mss = first.sz - hdrlen;
+      uint32_t nextseq = ReadU32(ftcp + 4) + mss;
+      size_t total = first.sz;
+      size_t run = 1;
+      while (run < n and run < MaxCoalescedPackets)
+      {
+        const auto& pkt = pkts[run];
+        if (CoalescableIPHeader(pkt) != iphl or pkt.sz <= hdrlen or pkt.sz - hdrlen > mss
+            or total + pkt.sz - hdrlen > 65535)
+          break;
+        const byte_t* ip = pkt.base;
+        const byte_t* tcp = ip + iphl;
+        if (TCPHeaderSize(tcp) != thl)
+          break;
+        // everything but lengths, ip ids and checksums has to match
+        bool same;
+        if (iphl == 20)
+          same = std::memcmp(ip, fip, 2) == 0 and std::memcmp(ip + 6, fip + 6, 4) == 0
+              and std::memcmp(ip + 12, fip + 12, 8) == 0;
+        else
+          same = std::memcmp(ip, fip, 4) == 0 and std::memcmp(ip + 6, fip + 6, 34) == 0;
+        same = same and std::memcmp(tcp, ftcp, 4) == 0 and std::memcmp(tcp + 8, ftcp + 8, 5) == 0
+            and std::memcmp(tcp + 14, ftcp + 14, 2) == 0
+            and std::memcmp(tcp + 18, ftcp + 18, thl - 18) == 0;
+        const byte_t flags = tcp[13];
+        if (not same or ReadU32(tcp + 4) != nextseq
+            or (flags != TCPFlagACK and flags != (TCPFlagACK | TCPFlagPSH)))
+          break;
+        const size_t payload = pkt.sz - hdrlen;
+        nextseq += payload;
+        total += payload;
+        run++;
+        // a short segment or a push ends the super packet
+        if (payload < mss or flags != TCPFlagACK)
+          break;
+      }
+      return run;
+    }
+
+    size_t
+    MakeCoalescedHeader(const llarp_tun_pkt* pkts, size_t n, VirtioNetHdr& vhdr, byte_t* header)
+    {
+      const auto& first = pkts[0];
+      const size_t iphl = CoalescableIPHeader(first);
+      const size_t hdrlen = iphl + TCPHeaderSize(first.base + iphl);
+      size_t total = hdrlen;
+      for (size_t idx = 0; idx < n; ++idx)
+        total += pkts[idx].sz - hdrlen;
+
+      std::memcpy(header, first.base, hdrlen);
+      byte_t* tcp = header + iphl;
+      // the last segment may carry a push
+      tcp[13] = pkts[n - 1].base[iphl + 13];
+      uint32_t pseudo;
+      if (iphl == 20)
+      {
+        WriteU16(header + 2, total);
+        header[10] = 0;
+        header[11] = 0;
+        const uint16_t check = Fold(SumWords(header, iphl));
+        std::memcpy(header + 10, &check, sizeof(check));
+        pseudo = SumWords(header + 12, 8);
+      }
+      else
+      {
+        WriteU16(header + 4, total - 40);
+        pseudo = SumWords(header + 8, 32);
+      }
+      byte_t trailer[4] = {0, TCP, 0, 0};
+      WriteU16(trailer + 2, total - iphl);
+      // partial checksum, the pseudo header sum without the final inversion
+      const uint16_t partial = ~Fold(SumWords(trailer, sizeof(trailer), pseudo));
+      std::memcpy(tcp + 16, &partial, sizeof(partial));
+
+      vhdr = VirtioNetHdr{};
+      vhdr.flags = VirtioNetHdr::NeedsCsum;
+      vhdr.gso_type = iphl == 20 ? VirtioNetHdr::GSOTCPv4 : VirtioNetHdr::GSOTCPv6;
+      vhdr.hdr_len = hdrlen;
+      vhdr.gso_size = first.sz - hdrlen;
+      vhdr.csum_start = iphl;
+      vhdr.csum_offset = 16;
+      return hdrlen;
+    }
+  }  // namespace net
+}  // namespace llarp
@@ -0,0 +1,67 @@
+#ifndef LLARP_NET_TUN_OFFLOAD_HPP
+#define LLARP_NET_TUN_OFFLOAD_HPP
+
+#include <ev/ev.h>
+#include <util/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace llarp
+{
+  namespace net
+  {
+    /// the struct virtio_net_hdr a tun opened with IFF_VNET_HDR puts in front of every packet,
+    /// in host byte order
+    struct VirtioNetHdr
+    {
+      static constexpr uint8_t NeedsCsum = 1;
+
+      static constexpr uint8_t GSONone = 0;
+      static constexpr uint8_t GSOTCPv4 = 1;
+      static constexpr uint8_t GSOTCPv6 = 4;
+      static constexpr uint8_t GSOECN = 0x80;
+
+      uint8_t flags;
+      uint8_t gso_type;
+      uint16_t hdr_len;
+      uint16_t gso_size;
+      uint16_t csum_start;
+      uint16_t csum_offset;
+    };
+    static_assert(sizeof(VirtioNetHdr) == 10);
+
+    /// largest packet a tun with tso enabled hands us, header included
+    constexpr size_t MaxOffloadPacketSize = sizeof(VirtioNetHdr) + 65535;
+
+    /// take a packet read from a vnet header tun, fill in the checksum the kernel left for us
+    /// and cut tso super packets into segments of at most gso_size bytes of payload
+    /// calls visit on each resulting ip packet, which stays valid until visit returns
+    /// returns false and visits nothing for anything malformed or of a gso type we didn't ask for
+    bool
+    SplitOffloadedPacket(
+        byte_t* pkt, size_t sz, const std::function<void(const byte_t*, size_t)>& visit);
+
+    /// most packets we glue into one super packet when writing
+    constexpr size_t MaxCoalescedPackets = 64;
+
+    /// room MakeCoalescedHeader needs for the ip and tcp headers
+    constexpr size_t MaxCoalescedHeaderSize = 120;
+
+    /// how many packets from the start of pkts carry one tcp stream in order with nothing but
+    /// acks between them, so a vnet header tun can take them as one tso super packet
+    /// always at least 1 when n is not 0
+    size_t
+    CoalescableRun(const llarp_tun_pkt* pkts, size_t n);
+
+    /// fill in the virtio header and the ip and tcp headers for writing a run found by
+    /// CoalescableRun as one super packet, which is the header followed by each packet's payload
+    /// returns the size of the headers written to header
+    size_t
+    MakeCoalescedHeader(
+        const llarp_tun_pkt* pkts, size_t n, VirtioNetHdr& vhdr, byte_t* header);
+  }  // namespace net
+}  // namespace llarp
+
+#endif
@@ -9,18 +9,30 @@
 #include <util/mem.hpp>
 #include <util/thread/logic.hpp>
 #include <util/str.hpp>
-#include <dht/kademlia.hpp>
 
 #include <algorithm>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
 static const char skiplist_subdirs[] = "0123456789abcdef";
 static const std::string RC_FILE_EXT = ".signed";
 
-llarp_nodedb::NetDBEntry::NetDBEntry(llarp::RouterContact value)
-    : rc(std::move(value)), inserted(llarp::time_now_ms())
+/// an rc to keep for a while, without the spare capacity decoding or copying left in it
+static llarp_nodedb::RCPtr_t
+Trimmed(llarp::RouterContact rc)
+{
+  rc.addrs.shrink_to_fit();
+  rc.signed_bt_dict.shrink_to_fit();
+  return std::make_shared<const llarp::RouterContact>(std::move(rc));
+}
+
+llarp_nodedb::NetDBEntry::NetDBEntry(llarp::RouterContact value, uint64_t gen)
+    : rc(Trimmed(std::move(value))), inserted(llarp::time_now_ms()), generation(gen)
 {}
 
 bool
@@ -41,98 +53,119 @@ llarp_nodedb::Remove(const llarp::RouterID& pk)
 void
 llarp_nodedb::Clear()
 {
-  llarp::util::Lock lock(access);
+  Lock_t lock(access);
   entries.clear();
+  index.Clear();
+  publicRouters.Clear();
+  exits.Clear();
 }
 
 bool
 llarp_nodedb::Get(const llarp::RouterID& pk, llarp::RouterContact& result)
 {
-  llarp::util::Lock l(access);
+  ReadLock_t l(access);
   auto itr = entries.find(pk);
   if (itr == entries.end())
     return false;
-  result = itr->second.rc;
+  result = *itr->second.rc;
   return true;
 }
 
+llarp_nodedb::RCPtr_t
+llarp_nodedb::GetShared(const llarp::RouterID& pk)
+{
+  ReadLock_t lock(access);
+  auto itr = entries.find(pk);
+  if (itr == entries.end())
+    return nullptr;
+  return itr->second.rc;
+}
+
 void
 llarp_nodedb::RemoveIf(std::function<bool(const llarp::RouterContact& rc)> filter)
 {
-  std::set<std::string> files;
+  Lock_t l(access);
+  auto itr = entries.begin();
+  while (itr != entries.end())
   {
-    llarp::util::Lock l(access);
-    auto itr = entries.begin();
-    while (itr != entries.end())
+    if (filter(*itr->second.rc))
     {
-      if (filter(itr->second.rc))
-      {
-        files.insert(getRCFilePath(itr->second.rc.pubkey));
-        itr = entries.erase(itr);
-      }
-      else
-        ++itr;
+      unindexRC(itr->first);
+      removed.insert(itr->first);
+      itr = entries.erase(itr);
     }
+    else
+      ++itr;
   }
-  disk([files = std::move(files)]() {
-    for (const auto& file : files)
-      fs::remove(file);
-  });
 }
 
 bool
 llarp_nodedb::Has(const llarp::RouterID& pk)
 {
-  llarp::util::Lock lock(access);
+  ReadLock_t lock(access);
   return entries.find(pk) != entries.end();
 }
 
 llarp::RouterContact
 llarp_nodedb::FindClosestTo(const llarp::dht::Key_t& location)
 {
-  llarp::RouterContact rc;
-  const llarp::dht::XorMetric compare(location);
-  visit([&rc, compare](const auto& otherRC) -> bool {
-    if (rc.pubkey.IsZero())
-    {
-      rc = otherRC;
-      return true;
-    }
-    if (compare(
-            llarp::dht::Key_t{otherRC.pubkey.as_array()}, llarp::dht::Key_t{rc.pubkey.as_array()}))
-      rc = otherRC;
-    return true;
-  });
-  return rc;
+  ReadLock_t lock(access);
+  const auto closest = index.FindClosest(location, 1);
+  if (closest.empty())
+    return {};
+  return *entries.at(closest.front()).rc;
 }
 
 std::vector<llarp::RouterContact>
 llarp_nodedb::FindClosestTo(const llarp::dht::Key_t& location, uint32_t numRouters)
 {
-  llarp::util::Lock lock(access);
-  std::vector<const llarp::RouterContact*> all;
-
-  all.reserve(entries.size());
-  for (auto& entry : entries)
-  {
-    all.push_back(&entry.second.rc);
-  }
-
-  auto it_mid = numRouters < all.size() ? all.begin() + numRouters : all.end();
-  std::partial_sort(
-      all.begin(),
-      it_mid,
-      all.end(),
-      [compare = llarp::dht::XorMetric{location}](auto* a, auto* b) { return compare(*a, *b); });
-
+  ReadLock_t lock(access);
   std::vector<llarp::RouterContact> closest;
-  closest.reserve(numRouters);
-  for (auto it = all.begin(); it != it_mid; ++it)
-    closest.push_back(**it);
+  const auto ids = index.FindClosest(location, numRouters);
+  closest.reserve(ids.size());
+  for (const auto& id : ids)
+    closest.push_back(*entries.at(id).rc);
+  return closest;
+}
 
+std::vector<llarp_nodedb::RCPtr_t>
+llarp_nodedb::FindClosestShared(const llarp::dht::Key_t& location, uint32_t numRouters)
+{
+  ReadLock_t lock(access);
+  std::vector<RCPtr_t> closest;
+  const auto ids = index.FindClosest(location, numRouters);
+  closest.reserve(ids.size());
+  for (const auto& id : ids)
+    closest.push_back(entries.at(id).rc);
   return closest;
 }
 
+llarp::RouterID
+llarp_nodedb::PageUpdatedSince(
+    llarp_time_t since,
+    const llarp::RouterID& after,
+    size_t max,
+    size_t scan,
+    std::vector<llarp::RouterContact>& out)
+{
+  ReadLock_t lock(access);
+  llarp::RouterID last = after;
+  bool done = true;
+  index.ForEachAfter(after, [&](const llarp::RouterID& id) {
+    if (out.size() >= max or scan-- == 0)
+    {
+      done = false;
+      return false;
+    }
+    const auto& rc = *entries.at(id).rc;
+    if (rc.IsPublicRouter() and rc.last_updated > since)
+      out.push_back(rc);
+    last = id;
+    return true;
+  });
+  return done ? llarp::RouterID{} : last;
+}
+
 /// skiplist directory is hex encoded first nibble
 /// skiplist filename is <base32encoded>.snode.signed
 std::string
@@ -171,9 +204,9 @@ llarp_nodedb::UpdateAsyncIfNewer(
     std::shared_ptr<llarp::Logic> logic,
     std::function<void(void)> completionHandler)
 {
-  llarp::util::Lock lock(access);
+  Lock_t lock(access);
   auto itr = entries.find(rc.pubkey);
-  if (itr == entries.end() || itr->second.rc.OtherIsNewer(rc))
+  if (itr == entries.end() || itr->second.rc->OtherIsNewer(rc))
   {
     InsertAsync(rc, logic, completionHandler);
     return true;
@@ -192,11 +225,16 @@ llarp_nodedb::UpdateAsyncIfNewer(
 bool
 llarp_nodedb::Insert(const llarp::RouterContact& rc)
 {
-  llarp::util::Lock lock(access);
+  Lock_t lock(access);
   auto itr = entries.find(rc.pubkey.as_array());
   if (itr != entries.end())
+  {
+    unindexRC(itr->first);
     entries.erase(itr);
-  entries.emplace(rc.pubkey.as_array(), rc);
+  }
+  entries.emplace(rc.pubkey.as_array(), NetDBEntry{rc, ++generation});
+  indexRC(rc);
+  removed.erase(rc.pubkey);
   LogDebug(
       "Added or updated RC for ",
       llarp::RouterID(rc.pubkey),
@@ -205,54 +243,179 @@ llarp_nodedb::Insert(const llarp::RouterContact& rc)
   return true;
 }
 
+/// below this many rcs a batch costs more to hand out than it saves
+static constexpr size_t MinPerBatch = 256;
+
+/// run func over [0, num) in at most one batch per core of at least per each. the batches go
+/// to work when given and to threads of our own when not, the calling thread runs the last
+/// one itself, and this returns once every batch is done
+static void
+RunBatches(
+    const llarp_nodedb::WorkCaller_t& work,
+    size_t num,
+    size_t per,
+    const std::function<void(size_t, size_t)>& func)
+{
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  const size_t batches = std::min(cores, num / per);
+  if (batches <= 1)
+  {
+    func(0, num);
+    return;
+  }
+  const size_t chunk = (num + batches - 1) / batches;
+  std::mutex mutex;
+  std::condition_variable done;
+  size_t pending = (num - 1) / chunk;
+  std::vector<std::thread> threads;
+  size_t begin = 0;
+  for (; begin + chunk < num; begin += chunk)
+  {
+    auto job = [&, begin]() {
+      func(begin, begin + chunk);
+      // notify under the lock, the waiter takes done with it as soon as it can return
+      std::lock_guard lock{mutex};
+      if (--pending == 0)
+        done.notify_one();
+    };
+    if (work)
+      work(std::move(job));
+    else
+      threads.emplace_back(std::move(job));
+  }
+  func(begin, num);
+  {
+    std::unique_lock lock{mutex};
+    done.wait(lock, [&pending]() { return pending == 0; });
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+
 ssize_t
-llarp_nodedb::Load(const fs::path& path)
+llarp_nodedb::Load(const fs::path& path, WorkCaller_t work)
 {
   std::error_code ec;
   if (!fs::exists(path, ec))
   {
     return -1;
   }
-  ssize_t loaded = 0;
+  loadStats = LoadStats{};
+  const auto started = llarp::time_now_ms();
+  // read everything first so the signatures can be checked in bulk
+  std::vector<llarp::RouterContact> rcs;
+  const bool opened = store.Open(
+      path / llarp::NodeDBStore::FileName,
+      rcs,
+      [&work](size_t num, const std::function<void(size_t, size_t)>& batch) {
+        RunBatches(work, num, MinPerBatch, batch);
+      });
+  if (not opened)
+  {
+    // no store yet, read the one file per rc layout older versions wrote, a subdir a batch
+    const size_t numSubdirs = sizeof(skiplist_subdirs) - 1;
+    std::vector<std::vector<llarp::RouterContact>> subdirs(numSubdirs);
+    RunBatches(work, numSubdirs, 1, [&](size_t begin, size_t end) {
+      for (size_t idx = begin; idx < end; ++idx)
+        readSubdir(path / std::string(1, skiplist_subdirs[idx]), subdirs[idx]);
+    });
+    for (auto& sub : subdirs)
+    {
+      for (auto& rc : sub)
+        rcs.emplace_back(std::move(rc));
+    }
+  }
+  loadStats.read = rcs.size();
+  loadStats.readTime = llarp::time_now_ms() - started;
+  LogInfo("read ", rcs.size(), " RCs from ", path, " in ", loadStats.readTime.count(), "ms");
+  std::vector<llarp::RouterID> ids;
+  ids.reserve(rcs.size());
+  for (const auto& rc : rcs)
+    ids.emplace_back(rc.pubkey);
+  const ssize_t loaded = insertVerified(std::move(rcs), work);
+  if (not opened)
+    migrateSubdirs(path);
+  else if (static_cast<size_t>(loaded) != ids.size())
+  {
+    // drop the records that no longer verify from the store on the next save
+    Lock_t lock(access);
+    for (const auto& id : ids)
+    {
+      if (entries.count(id) == 0)
+        removed.insert(id);
+    }
+  }
+  m_NextSaveToDisk = llarp::time_now_ms() + m_SaveInterval;
+  return loaded;
+}
 
+void
+llarp_nodedb::migrateSubdirs(const fs::path& path)
+{
+  std::vector<llarp::RouterContact> rcs;
+  {
+    ReadLock_t lock(access);
+    rcs.reserve(entries.size());
+    for (const auto& item : entries)
+      rcs.push_back(*item.second.rc);
+  }
+  if (not store.Rewrite(rcs))
+    return;
+  size_t migrated = 0;
   for (const char& ch : skiplist_subdirs)
   {
     if (!ch)
       continue;
-    std::string p;
-    p += ch;
-    fs::path sub = path / p;
-
-    ssize_t l = loadSubdir(sub);
-    if (l > 0)
-      loaded += l;
+    const fs::path sub = path / std::string(&ch, 1);
+    std::vector<fs::path> files;
+    llarp::util::IterDir(sub, [&files](const fs::path& f) -> bool {
+      if (fs::is_regular_file(f) and f.extension() == RC_FILE_EXT)
+        files.push_back(f);
+      return true;
+    });
+    std::error_code ec;
+    for (const auto& file : files)
+    {
+      if (fs::remove(file, ec))
+        migrated++;
+    }
+    // only goes if it is empty now
+    fs::remove(sub, ec);
   }
-  m_NextSaveToDisk = llarp::time_now_ms() + m_SaveInterval;
-  return loaded;
+  if (migrated)
+    LogInfo("moved ", migrated, " rc files into ", path / llarp::NodeDBStore::FileName);
 }
 
 void
 llarp_nodedb::SaveAll()
 {
-  std::array<byte_t, MAX_RC_SIZE> tmp;
-  llarp::util::Lock lock(access);
-  for (const auto& item : entries)
+  std::vector<llarp::RouterContact> puts;
+  std::vector<llarp::RouterID> removes;
+  uint64_t upto;
   {
-    llarp_buffer_t buf(tmp);
-
-    if (!item.second.rc.BEncode(&buf))
-      continue;
-
-    buf.sz = buf.cur - buf.base;
-    const auto filepath = getRCFilePath(item.second.rc.pubkey);
-    auto optional_ofs = llarp::util::OpenFileStream<std::ofstream>(
-        filepath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
-    if (!optional_ofs)
-      continue;
-    auto& ofs = *optional_ofs;
-    ofs.write((char*)buf.base, buf.sz);
-    ofs.flush();
-    ofs.close();
+    Lock_t lock(access);
+    upto = generation;
+    for (const auto& item : entries)
+    {
+      if (item.second.generation > savedGeneration)
+        puts.push_back(*item.second.rc);
+    }
+    removes.assign(removed.begin(), removed.end());
+    removed.clear();
+  }
+  const bool saved = store.Append(puts, removes);
+  Lock_t lock(access);
+  if (saved)
+  {
+    // anything put while we wrote has a later generation and goes next time
+    savedGeneration = upto;
+    return;
+  }
+  // the puts are still past savedGeneration, keep the removes unless they came back since
+  for (const auto& id : removes)
+  {
+    if (entries.count(id) == 0)
+      removed.insert(id);
   }
 }
 
@@ -264,23 +427,98 @@ llarp_nodedb::ShouldSaveToDisk(llarp_time_t now) const
   return m_NextSaveToDisk > 0s && m_NextSaveToDisk <= now;
 }
 
+bool
+llarp_nodedb::HasUnsaved() const
+{
+  ReadLock_t lock(access);
+  return generation != savedGeneration or not removed.empty();
+}
+
 void
 llarp_nodedb::AsyncFlushToDisk()
 {
-  disk([this]() { SaveAll(); });
+  // nothing to write, leave the disk alone
+  if (HasUnsaved())
+    disk([this]() { SaveAll(); });
   m_NextSaveToDisk = llarp::time_now_ms() + m_SaveInterval;
 }
 
 ssize_t
 llarp_nodedb::loadSubdir(const fs::path& dir)
 {
-  ssize_t sz = 0;
+  std::vector<llarp::RouterContact> rcs;
+  readSubdir(dir, rcs);
+  return insertVerified(std::move(rcs));
+}
+
+void
+llarp_nodedb::readSubdir(const fs::path& dir, std::vector<llarp::RouterContact>& rcs) const
+{
   llarp::util::IterDir(dir, [&](const fs::path& f) -> bool {
-    if (fs::is_regular_file(f) && loadfile(f))
-      sz++;
+    if (not fs::is_regular_file(f) or f.extension() != RC_FILE_EXT)
+      return true;
+    llarp::RouterContact rc;
+    if (rc.Read(f))
+      rcs.emplace_back(std::move(rc));
+    else
+      llarp::LogError("failed to read file ", f);
     return true;
   });
-  return sz;
+}
+
+/// check the signatures of a bulk load in batches, they are most of the time it takes to load
+/// a big nodedb
+static void
+VerifyLoaded(
+    const std::vector<llarp::RouterContact>& rcs,
+    bool* valid,
+    const llarp_nodedb::WorkCaller_t& work)
+{
+  const auto now = llarp::time_now_ms();
+  RunBatches(work, rcs.size(), MinPerBatch, [&rcs, valid, now](size_t begin, size_t end) {
+    llarp::RouterContact::VerifyMany(rcs.data() + begin, end - begin, now, valid + begin);
+  });
+}
+
+size_t
+llarp_nodedb::insertVerified(std::vector<llarp::RouterContact> rcs, const WorkCaller_t& work)
+{
+  if (rcs.empty())
+    return 0;
+  auto started = llarp::time_now_ms();
+  auto valid = std::make_unique<bool[]>(rcs.size());
+  VerifyLoaded(rcs, valid.get(), work);
+  loadStats.verifyTime = llarp::time_now_ms() - started;
+  started = llarp::time_now_ms();
+  size_t loaded = 0;
+  {
+    Lock_t lock(access);
+    entries.reserve(entries.size() + rcs.size());
+    for (size_t idx = 0; idx < rcs.size(); ++idx)
+    {
+      if (not valid[idx])
+        continue;
+      const auto [itr, inserted] =
+          entries.try_emplace(rcs[idx].pubkey.as_array(), std::move(rcs[idx]));
+      if (not inserted)
+        continue;
+      indexRC(*itr->second.rc);
+      loaded++;
+    }
+  }
+  loadStats.loaded = loaded;
+  loadStats.mergeTime = llarp::time_now_ms() - started;
+  LogInfo(
+      "verified ",
+      loaded,
+      " of ",
+      rcs.size(),
+      " RCs in ",
+      loadStats.verifyTime.count(),
+      "ms, merged in ",
+      loadStats.mergeTime.count(),
+      "ms");
+  return loaded;
 }
 
 bool
@@ -300,8 +538,9 @@ llarp_nodedb::loadfile(const fs::path& fpath)
     return false;
   }
   {
-    llarp::util::Lock lock(access);
-    entries.emplace(rc.pubkey.as_array(), rc);
+    Lock_t lock(access);
+    if (entries.emplace(rc.pubkey.as_array(), rc).second)
+      indexRC(rc);
   }
   return true;
 }
@@ -309,11 +548,11 @@ llarp_nodedb::loadfile(const fs::path& fpath)
 void
 llarp_nodedb::visit(std::function<bool(const llarp::RouterContact&)> visit)
 {
-  llarp::util::Lock lock(access);
+  ReadLock_t lock(access);
   auto itr = entries.begin();
   while (itr != entries.end())
   {
-    if (!visit(itr->second.rc))
+    if (!visit(*itr->second.rc))
       return;
     ++itr;
   }
@@ -323,12 +562,12 @@ void
 llarp_nodedb::VisitInsertedBefore(
     std::function<void(const llarp::RouterContact&)> visit, llarp_time_t insertedAfter)
 {
-  llarp::util::Lock lock(access);
+  ReadLock_t lock(access);
   auto itr = entries.begin();
   while (itr != entries.end())
   {
     if (itr->second.inserted < insertedAfter)
-      visit(itr->second.rc);
+      visit(*itr->second.rc);
     ++itr;
   }
 }
@@ -411,98 +650,116 @@ llarp_nodedb::ensure_dir(const fs::path& nodedbDir)
 
   if (not fs::is_directory(nodedbDir))
     throw std::runtime_error(llarp::stringify("nodedb ", nodedbDir, " is not a directory"));
+}
 
-  for (const char& ch : skiplist_subdirs)
-  {
-    // this seems to be a problem on all targets
-    // perhaps cpp17::fs is just as screwed-up
-    // attempting to create a folder with no name
-    // what does this mean...?
-    if (!ch)
-      continue;
+ssize_t
+llarp_nodedb::LoadAll(WorkCaller_t work)
+{
+  return Load(nodePath.c_str(), std::move(work));
+}
 
-    fs::path sub = nodedbDir / std::string(&ch, 1);
-    fs::create_directory(sub);
-  }
+llarp::util::StatusObject
+llarp_nodedb::ExtractStatus() const
+{
+  const auto counts = access.GetCounts();
+  return llarp::util::StatusObject{{"entries", num_loaded()},
+                                   {"load", loadStats.ExtractStatus()},
+                                   {"lock",
+                                    {{"shared", counts.shared},
+                                     {"sharedWaits", counts.sharedWaits},
+                                     {"exclusive", counts.exclusive},
+                                     {"exclusiveWaits", counts.exclusiveWaits}}}};
 }
 
-ssize_t
-llarp_nodedb::LoadAll()
+llarp::util::StatusObject
+llarp_nodedb::LoadStats::ExtractStatus() const
 {
-  return Load(nodePath.c_str());
+  return llarp::util::StatusObject{{"read", read},
+                                   {"loaded", loaded},
+                                   {"readTime", llarp::to_json(readTime)},
+                                   {"verifyTime", llarp::to_json(verifyTime)},
+                                   {"mergeTime", llarp::to_json(mergeTime)}};
 }
 
 size_t
 llarp_nodedb::num_loaded() const
 {
-  std::shared_lock l{access};
+  ReadLock_t lock(access);
   return entries.size();
 }
 
-bool
-llarp_nodedb::select_random_exit(llarp::RouterContact& result)
+/// a random member of candidates that accept takes. the probe goes on from a random start
+/// past the ones it does not take, so it stays O(1) while few are turned down
+template <typename Accept_t>
+static bool
+PickRandom(
+    const llarp::util::DenseSet<llarp::RouterID>& candidates,
+    Accept_t accept,
+    llarp::RouterID& picked)
 {
-  llarp::util::Lock lock(access);
-  const auto sz = entries.size();
-  auto itr = entries.begin();
-  if (sz < 3)
+  const size_t sz = candidates.Size();
+  if (sz == 0)
     return false;
-  auto idx = llarp::randint() % sz;
-  if (idx)
-    std::advance(itr, idx - 1);
-  while (itr != entries.end())
-  {
-    if (itr->second.rc.IsExit())
-    {
-      result = itr->second.rc;
-      return true;
-    }
-    ++itr;
-  }
-  // wrap around
-  itr = entries.begin();
-  while (idx--)
+  const size_t start = llarp::randint() % sz;
+  for (size_t step = 0; step < sz; ++step)
   {
-    if (itr->second.rc.IsExit())
+    const auto& id = candidates[(start + step) % sz];
+    if (accept(id))
     {
-      result = itr->second.rc;
+      picked = id;
       return true;
     }
-    ++itr;
   }
   return false;
 }
 
+bool
+llarp_nodedb::select_random_exit(llarp::RouterContact& result)
+{
+  ReadLock_t lock(access);
+  if (entries.size() < 3)
+    return false;
+  llarp::RouterID picked;
+  if (not PickRandom(exits, [](const auto&) { return true; }, picked))
+    return false;
+  result = *entries.at(picked).rc;
+  return true;
+}
+
 bool
 llarp_nodedb::select_random_hop_excluding(
     llarp::RouterContact& result, const std::set<llarp::RouterID>& exclude)
 {
-  llarp::util::Lock lock(access);
+  ReadLock_t lock(access);
   /// checking for "guard" status for N = 0 is done by caller inside of
   /// pathbuilder's scope
-  const size_t sz = entries.size();
-  if (sz < 3)
+  if (entries.size() < 3)
   {
     return false;
   }
+  llarp::RouterID picked;
+  const auto notExcluded = [&exclude](const auto& id) { return exclude.count(id) == 0; };
+  if (not PickRandom(publicRouters, notExcluded, picked))
+    return false;
+  result = *entries.at(picked).rc;
+  return true;
+}
 
-  const size_t pos = llarp::randint() % sz;
-  const auto start = std::next(entries.begin(), pos);
-  for (auto itr = start; itr != entries.end(); ++itr)
-  {
-    if (exclude.count(itr->first) == 0 and itr->second.rc.IsPublicRouter())
-    {
-      result = itr->second.rc;
-      return true;
-    }
-  }
-  for (auto itr = entries.begin(); itr != start; ++itr)
-  {
-    if (exclude.count(itr->first) == 0 and itr->second.rc.IsPublicRouter())
-    {
-      result = itr->second.rc;
-      return true;
-    }
-  }
-  return false;
+void
+llarp_nodedb::indexRC(const llarp::RouterContact& rc)
+{
+  const llarp::RouterID id{rc.pubkey};
+  index.Insert(id);
+  if (rc.IsPublicRouter())
+    publicRouters.Insert(id);
+  if (rc.IsExit())
+    exits.Insert(id);
+}
+
+void
+llarp_nodedb::unindexRC(const llarp::RouterID& id)
+{
+  index.Remove(id);
+  publicRouters.Remove(id);
+  exits.Remove(id);
 }
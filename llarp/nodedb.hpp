@@ -5,11 +5,17 @@
 #include <router_id.hpp>
 #include <util/common.hpp>
 #include <util/fs.hpp>
+#include <util/dense_set.hpp>
+#include <util/status.hpp>
 #include <util/thread/threading.hpp>
 #include <util/thread/annotations.hpp>
 #include <dht/key.hpp>
+#include <dht/xor_index.hpp>
+#include <nodedb_store.hpp>
 
+#include <memory>
 #include <set>
+#include <unordered_set>
 #include <utility>
 
 /**
@@ -40,24 +46,62 @@ struct llarp_nodedb
   }
 
   const DiskCaller_t disk;
-  mutable llarp::util::Mutex access;  // protects entries
+  /// lookups take access shared, only changes to the entries take it exclusive
+  using Mutex_t = llarp::util::CountingMutex;
+  using Lock_t = std::lock_guard<Mutex_t>;
+  using ReadLock_t = std::shared_lock<Mutex_t>;
+  mutable Mutex_t access;  // protects entries
   /// time for next save to disk event, 0 if never happened
   llarp_time_t m_NextSaveToDisk = 0s;
   /// how often to save to disk
   const llarp_time_t m_SaveInterval = 5min;
 
+  /// an rc as the nodedb keeps it, immutable so lookups can share it instead of copying
+  using RCPtr_t = std::shared_ptr<const llarp::RouterContact>;
+
   struct NetDBEntry
   {
-    const llarp::RouterContact rc;
+    const RCPtr_t rc;
     llarp_time_t inserted;
+    /// the generation this was put in at, 0 for what was loaded from disk
+    uint64_t generation;
 
-    NetDBEntry(llarp::RouterContact data);
+    NetDBEntry(llarp::RouterContact data, uint64_t gen = 0);
   };
 
   using NetDBMap_t = std::unordered_map<llarp::RouterID, NetDBEntry, llarp::RouterID::Hash>;
 
   NetDBMap_t entries GUARDED_BY(access);
+  /// the keys of entries, for closest by xor lookups, kept in step with it
+  llarp::dht::XorIndex index GUARDED_BY(access);
+  /// the keys of the public routers and the exits in entries, to pick one at random from
+  llarp::util::DenseSet<llarp::RouterID> publicRouters GUARDED_BY(access);
+  llarp::util::DenseSet<llarp::RouterID> exits GUARDED_BY(access);
   fs::path nodePath;
+  /// where the entries are saved
+  llarp::NodeDBStore store;
+  /// bumped on every put, entries with a generation past savedGeneration are not on disk yet
+  uint64_t generation GUARDED_BY(access) = 0;
+  uint64_t savedGeneration GUARDED_BY(access) = 0;
+  /// entries removed since the last save
+  std::unordered_set<llarp::RouterID, llarp::RouterID::Hash> removed GUARDED_BY(access);
+
+  /// how the last Load went, to see what it costs of the startup budget
+  struct LoadStats
+  {
+    /// rcs read off disk before verifying
+    size_t read = 0;
+    /// rcs that verified and went into entries
+    size_t loaded = 0;
+    llarp_time_t readTime = 0s;
+    llarp_time_t verifyTime = 0s;
+    llarp_time_t mergeTime = 0s;
+
+    llarp::util::StatusObject
+    ExtractStatus() const;
+  };
+
+  LoadStats loadStats;
 
   llarp::RouterContact
   FindClosestTo(const llarp::dht::Key_t& location);
@@ -66,6 +110,21 @@ struct llarp_nodedb
   std::vector<llarp::RouterContact>
   FindClosestTo(const llarp::dht::Key_t& location, uint32_t numRouters);
 
+  /// FindClosestTo sharing the rcs instead of copying them
+  std::vector<RCPtr_t>
+  FindClosestShared(const llarp::dht::Key_t& location, uint32_t numRouters) EXCLUDES(access);
+
+  /// one page of a walk over the public routers in key order: up to max of the rcs past after
+  /// that were updated after since, looking at no more than scan entries. returns where the
+  /// next page starts, zero once the walk is done
+  llarp::RouterID
+  PageUpdatedSince(
+      llarp_time_t since,
+      const llarp::RouterID& after,
+      size_t max,
+      size_t scan,
+      std::vector<llarp::RouterContact>& out) EXCLUDES(access);
+
   /// return true if we should save our nodedb to disk
   bool
   ShouldSaveToDisk(llarp_time_t now = 0s) const;
@@ -82,6 +141,10 @@ struct llarp_nodedb
   bool
   Get(const llarp::RouterID& pk, llarp::RouterContact& result) EXCLUDES(access);
 
+  /// the rc for pk without copying it, nullptr if we have none
+  RCPtr_t
+  GetShared(const llarp::RouterID& pk) EXCLUDES(access);
+
   bool
   Has(const llarp::RouterID& pk) EXCLUDES(access);
 
@@ -109,14 +172,33 @@ struct llarp_nodedb
       std::shared_ptr<llarp::Logic> l = nullptr,
       std::function<void(void)> completionHandler = nullptr) EXCLUDES(access);
 
+  /// load the nodedb at path, decoding and verifying in batches on work when given and on
+  /// threads of our own when not
   ssize_t
-  Load(const fs::path& path);
+  Load(const fs::path& path, WorkCaller_t work = nullptr);
 
   ssize_t
   loadSubdir(const fs::path& dir);
-  /// save all entries to disk async
+
+  /// move rc files from the one file per rc layout into the store and delete them
+  void
+  migrateSubdirs(const fs::path& path) EXCLUDES(access);
+
+  /// read every rc file in dir into rcs without verifying them
   void
-  AsyncFlushToDisk();
+  readSubdir(const fs::path& dir, std::vector<llarp::RouterContact>& rcs) const;
+
+  /// verify rcs in batches and insert the valid ones under one lock, return how many that was
+  size_t
+  insertVerified(std::vector<llarp::RouterContact> rcs, const WorkCaller_t& work = nullptr)
+      EXCLUDES(access);
+  /// save the entries changed since the last save to disk async, in one disk job
+  void
+  AsyncFlushToDisk() EXCLUDES(access);
+
+  /// return true if anything was put or removed since the last save
+  bool
+  HasUnsaved() const EXCLUDES(access);
 
   bool
   loadfile(const fs::path& fpath) EXCLUDES(access);
@@ -128,7 +210,7 @@ struct llarp_nodedb
   set_dir(const char* dir);
 
   ssize_t
-  LoadAll();
+  LoadAll(WorkCaller_t work = nullptr);
 
   ssize_t
   store_dir(const char* dir);
@@ -145,9 +227,16 @@ struct llarp_nodedb
   size_t
   num_loaded() const EXCLUDES(access);
 
+  /// entry count, the last load and how contended access is
+  llarp::util::StatusObject
+  ExtractStatus() const EXCLUDES(access);
+
+  /// pick an exit uniformly at random, O(1)
   bool
   select_random_exit(llarp::RouterContact& rc) EXCLUDES(access);
 
+  /// pick a public router not in exclude uniformly at random, O(1) while exclude is small
+
   bool
   select_random_hop_excluding(
       llarp::RouterContact& result, const std::set<llarp::RouterID>& exclude) EXCLUDES(access);
@@ -161,6 +250,15 @@ struct llarp_nodedb
 
   void
   SaveAll() EXCLUDES(access);
+
+ private:
+  /// add rc to the indexes kept over entries
+  void
+  indexRC(const llarp::RouterContact& rc) REQUIRES(access);
+
+  /// take id out of the indexes kept over entries
+  void
+  unindexRC(const llarp::RouterID& id) REQUIRES(access);
 };
 
 /// struct for async rc verification
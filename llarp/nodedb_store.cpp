@@ -0,0 +1,344 @@
+#include <nodedb_store.hpp>
+
+#include <util/buffer.hpp>
+#include <util/endian.hpp>
+#include <util/logging/logger.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace llarp
+{
+  namespace
+  {
+    /// a whole file read only in memory, mapped where we can
+    struct MappedFile
+    {
+      const byte_t* data = nullptr;
+      size_t size = 0;
+
+      explicit MappedFile(const fs::path& file)
+      {
+#ifdef _WIN32
+        std::ifstream f(file.string(), std::ios::binary | std::ios::ate);
+        if (not f.is_open())
+          return;
+        m_Copy.resize(f.tellg());
+        f.seekg(0);
+        if (not f.read(reinterpret_cast<char*>(m_Copy.data()), m_Copy.size()))
+          return;
+        data = m_Copy.data();
+        size = m_Copy.size();
+#else
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1)
+          return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 and st.st_size > 0)
+        {
+          void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (ptr != MAP_FAILED)
+          {
+            data = static_cast<const byte_t*>(ptr);
+            size = st.st_size;
+          }
+        }
+        ::close(fd);
+#endif
+      }
+
+      ~MappedFile()
+      {
+#ifndef _WIN32
+        if (data)
+          ::munmap(const_cast<byte_t*>(data), size);
+#endif
+      }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile&
+      operator=(const MappedFile&) = delete;
+
+     private:
+#ifdef _WIN32
+      std::vector<byte_t> m_Copy;
+#endif
+    };
+  }  // namespace
+
+  bool
+  NodeDBStore::Open(const fs::path& file, std::vector<RouterContact>& rcs, const Batches_t& batches)
+  {
+    util::Lock lock(m_Access);
+    m_File = file;
+    m_Records.clear();
+    m_End = 0;
+    m_LiveBytes = 0;
+    m_DeadBytes = 0;
+
+    std::error_code ec;
+    if (not fs::exists(file, ec))
+      return false;
+    const MappedFile map(file);
+    if (map.size < sizeof(Magic) or std::memcmp(map.data, Magic, sizeof(Magic)))
+    {
+      LogError("nodedb store ", file, " is not a nodedb store");
+      return false;
+    }
+
+    uint64_t offset = sizeof(Magic);
+    while (offset + RecordHeaderSize <= map.size)
+    {
+      const byte_t* ptr = map.data + offset;
+      const uint32_t len = bufbe32toh(ptr);
+      if (len > MAX_RC_SIZE or offset + RecordHeaderSize + len > map.size)
+        break;
+      const RouterID id{ptr + 4};
+      const uint32_t size = RecordHeaderSize + len;
+      auto itr = m_Records.find(id);
+      if (itr != m_Records.end())
+      {
+        m_DeadBytes += itr->second.size;
+        m_LiveBytes -= itr->second.size;
+        m_Records.erase(itr);
+      }
+      if (len == 0)
+        m_DeadBytes += size;
+      else
+      {
+        m_Records.emplace(id, Record{offset, size});
+        m_LiveBytes += size;
+      }
+      offset += size;
+    }
+    if (offset != map.size)
+      LogWarn("nodedb store ", file, " ends in a cut short record, dropping it");
+    m_End = offset;
+
+    // decode from a copy of the index so the batches need nothing but the map
+    const std::vector<std::pair<RouterID, Record>> live(m_Records.begin(), m_Records.end());
+    std::vector<RouterContact> decoded(live.size());
+    auto ok = std::make_unique<bool[]>(live.size());
+    const auto decode = [&map, &live, &decoded, &ok](size_t begin, size_t end) {
+      for (size_t idx = begin; idx < end; ++idx)
+      {
+        const auto& [id, record] = live[idx];
+        llarp_buffer_t buf(
+            const_cast<byte_t*>(map.data) + record.offset + RecordHeaderSize,
+            record.size - RecordHeaderSize);
+        ok[idx] = decoded[idx].BDecode(&buf) and decoded[idx].pubkey == id;
+      }
+    };
+    if (batches)
+      batches(live.size(), decode);
+    else
+      decode(0, live.size());
+
+    rcs.reserve(rcs.size() + live.size());
+    for (size_t idx = 0; idx < live.size(); ++idx)
+    {
+      const auto& [id, record] = live[idx];
+      if (ok[idx])
+      {
+        rcs.emplace_back(std::move(decoded[idx]));
+        continue;
+      }
+      LogError("nodedb store has a bad record for ", id);
+      m_DeadBytes += record.size;
+      m_LiveBytes -= record.size;
+      m_Records.erase(id);
+    }
+    return true;
+  }
+
+  bool
+  NodeDBStore::WriteRecords(
+      std::ostream& out,
+      uint64_t offset,
+      const std::vector<RouterContact>& puts,
+      const std::vector<RouterID>& removes)
+  {
+    std::array<byte_t, RecordHeaderSize + MAX_RC_SIZE> tmp;
+    for (const auto& rc : puts)
+    {
+      llarp_buffer_t buf(tmp.data() + RecordHeaderSize, MAX_RC_SIZE);
+      if (not rc.BEncode(&buf))
+      {
+        LogError("failed to encode rc for ", RouterID{rc.pubkey});
+        continue;
+      }
+      const uint32_t len = buf.cur - buf.base;
+      const RouterID id{rc.pubkey};
+      htobe32buf(tmp.data(), len);
+      std::copy(id.begin(), id.end(), tmp.begin() + 4);
+      const uint32_t size = RecordHeaderSize + len;
+      if (not out.write(reinterpret_cast<const char*>(tmp.data()), size))
+        return false;
+      auto itr = m_Records.find(id);
+      if (itr != m_Records.end())
+      {
+        m_DeadBytes += itr->second.size;
+        m_LiveBytes -= itr->second.size;
+        itr->second = Record{offset, size};
+      }
+      else
+        m_Records.emplace(id, Record{offset, size});
+      m_LiveBytes += size;
+      offset += size;
+      m_End = offset;
+    }
+    for (const auto& id : removes)
+    {
+      auto itr = m_Records.find(id);
+      if (itr == m_Records.end())
+        continue;
+      htobe32buf(tmp.data(), 0);
+      std::copy(id.begin(), id.end(), tmp.begin() + 4);
+      if (not out.write(reinterpret_cast<const char*>(tmp.data()), RecordHeaderSize))
+        return false;
+      m_DeadBytes += itr->second.size + RecordHeaderSize;
+      m_LiveBytes -= itr->second.size;
+      m_Records.erase(itr);
+      offset += RecordHeaderSize;
+      m_End = offset;
+    }
+    return true;
+  }
+
+  bool
+  NodeDBStore::Append(const std::vector<RouterContact>& puts, const std::vector<RouterID>& removes)
+  {
+    util::Lock lock(m_Access);
+    if (m_File.empty())
+      return false;
+    if (puts.empty() and removes.empty())
+      return true;
+    std::error_code ec;
+    if (m_End == 0 or not fs::exists(m_File, ec))
+    {
+      // nothing good on disk to add to, start the file over
+      m_Records.clear();
+      m_LiveBytes = 0;
+      m_DeadBytes = 0;
+      std::ofstream out(m_File.string(), std::ios::binary | std::ios::trunc);
+      if (not out.write(Magic, sizeof(Magic)))
+        return false;
+      m_End = sizeof(Magic);
+    }
+    else if (fs::file_size(m_File, ec) != m_End)
+    {
+      // drop a record a crash cut short before adding after it
+      fs::resize_file(m_File, m_End, ec);
+      if (ec)
+      {
+        LogError("failed to trim nodedb store ", m_File, ": ", ec.message());
+        return false;
+      }
+    }
+    {
+      std::ofstream out(m_File.string(), std::ios::binary | std::ios::app);
+      if (not out.is_open() or not WriteRecords(out, m_End, puts, removes) or not out.flush())
+      {
+        LogError("failed to append to nodedb store ", m_File);
+        return false;
+      }
+    }
+    // the records are saved either way, a failed compaction is tried again next save
+    if (m_DeadBytes >= MinCompactBytes and m_DeadBytes > m_LiveBytes and not Compact())
+      LogWarn("failed to compact nodedb store ", m_File);
+    return true;
+  }
+
+  bool
+  NodeDBStore::Compact()
+  {
+    const fs::path tmpfile = m_File.string() + ".tmp";
+    auto records = m_Records;
+    uint64_t offset = sizeof(Magic);
+    {
+      const MappedFile map(m_File);
+      if (map.size < m_End)
+        return false;
+      std::ofstream out(tmpfile.string(), std::ios::binary | std::ios::trunc);
+      if (not out.write(Magic, sizeof(Magic)))
+        return false;
+      for (auto& [id, record] : records)
+      {
+        if (not out.write(reinterpret_cast<const char*>(map.data) + record.offset, record.size))
+          return false;
+        record.offset = offset;
+        offset += record.size;
+      }
+      if (not out.flush())
+        return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpfile, m_File, ec);
+    if (ec)
+    {
+      LogError("failed to compact nodedb store ", m_File, ": ", ec.message());
+      return false;
+    }
+    m_Records = std::move(records);
+    m_End = offset;
+    m_DeadBytes = 0;
+    return true;
+  }
+
+  bool
+  NodeDBStore::Rewrite(const std::vector<RouterContact>& rcs)
+  {
+    util::Lock lock(m_Access);
+    if (m_File.empty())
+      return false;
+    const fs::path tmpfile = m_File.string() + ".tmp";
+    m_Records.clear();
+    m_LiveBytes = 0;
+    m_DeadBytes = 0;
+    m_End = 0;
+    {
+      std::ofstream out(tmpfile.string(), std::ios::binary | std::ios::trunc);
+      if (not out.write(Magic, sizeof(Magic))
+          or not WriteRecords(out, sizeof(Magic), rcs, {}) or not out.flush())
+      {
+        LogError("failed to write nodedb store ", tmpfile);
+        m_Records.clear();
+        m_End = 0;
+        return false;
+      }
+    }
+    std::error_code ec;
+    fs::rename(tmpfile, m_File, ec);
+    if (ec)
+    {
+      LogError("failed to write nodedb store ", m_File, ": ", ec.message());
+      m_Records.clear();
+      m_End = 0;
+      return false;
+    }
+    return true;
+  }
+
+  size_t
+  NodeDBStore::Live() const
+  {
+    util::Lock lock(m_Access);
+    return m_Records.size();
+  }
+
+  size_t
+  NodeDBStore::DeadBytes() const
+  {
+    util::Lock lock(m_Access);
+    return m_DeadBytes;
+  }
+}  // namespace llarp
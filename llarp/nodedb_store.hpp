@@ -0,0 +1,88 @@
+#ifndef LLARP_NODEDB_STORE_HPP
+#define LLARP_NODEDB_STORE_HPP
+
+#include <router_contact.hpp>
+#include <router_id.hpp>
+#include <util/fs.hpp>
+#include <util/thread/annotations.hpp>
+#include <util/thread/threading.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  /// the nodedb on disk as one append only file. each record is a signed rc or a tombstone
+  /// for one, the last record for a key wins. opening maps the file once and decodes the rcs
+  /// in place, a save appends only what changed, and once more of the file is dead records
+  /// than live ones it is rewritten with just the live ones.
+  ///
+  /// file layout: 8 byte magic, then records of a 4 byte big endian length, the 32 byte
+  /// router id and length bytes of bencoded rc, length 0 is a tombstone. a record cut short
+  /// at the end, from a crash mid save, is dropped and written over by the next save
+  struct NodeDBStore
+  {
+    static constexpr auto FileName = "nodedb.dat";
+    static constexpr char Magic[8] = {'l', 'l', 'n', 'o', 'd', 'e', 0, 1};
+    static constexpr size_t RecordHeaderSize = 4 + RouterID::SIZE;
+    /// no compaction until at least this many bytes are dead
+    static constexpr size_t MinCompactBytes = 64 * 1024;
+
+    /// runs batch over every index in [0, num), in pieces and maybe in parallel, and returns
+    /// once they are all done
+    using Batches_t =
+        std::function<void(size_t num, const std::function<void(size_t begin, size_t end)>& batch)>;
+
+    /// open the store file and read every live rc in it into rcs, without verifying
+    /// them, decoding through batches when given. return false if there is no store file
+    /// there yet, or it is not one
+    bool
+    Open(const fs::path& file, std::vector<RouterContact>& rcs, const Batches_t& batches = nullptr)
+        EXCLUDES(m_Access);
+
+    /// append puts and tombstones for removes, compacting after if it is due
+    bool
+    Append(const std::vector<RouterContact>& puts, const std::vector<RouterID>& removes)
+        EXCLUDES(m_Access);
+
+    /// replace the whole file with only these rcs
+    bool
+    Rewrite(const std::vector<RouterContact>& rcs) EXCLUDES(m_Access);
+
+    /// keys with a live record
+    size_t
+    Live() const EXCLUDES(m_Access);
+
+    /// bytes of the file that records since have replaced
+    size_t
+    DeadBytes() const EXCLUDES(m_Access);
+
+   private:
+    struct Record
+    {
+      uint64_t offset;
+      uint32_t size;
+    };
+
+    bool
+    Compact() REQUIRES(m_Access);
+
+    bool
+    WriteRecords(
+        std::ostream& out,
+        uint64_t offset,
+        const std::vector<RouterContact>& puts,
+        const std::vector<RouterID>& removes) REQUIRES(m_Access);
+
+    mutable util::Mutex m_Access;
+    fs::path m_File GUARDED_BY(m_Access);
+    std::unordered_map<RouterID, Record, RouterID::Hash> m_Records GUARDED_BY(m_Access);
+    /// where the last good record ends
+    uint64_t m_End GUARDED_BY(m_Access) = 0;
+    uint64_t m_LiveBytes GUARDED_BY(m_Access) = 0;
+    uint64_t m_DeadBytes GUARDED_BY(m_Access) = 0;
+  };
+}  // namespace llarp
+
+#endif
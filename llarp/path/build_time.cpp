@@ -0,0 +1,60 @@
+#include <path/build_time.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    void
+    BuildTimeEstimator::Observe(llarp_time_t took)
+    {
+      if (m_Samples++ == 0)
+      {
+        m_Smoothed = took;
+        m_Variance = took / 2;
+        return;
+      }
+      // rfc 6298 gains, 1/4 for the variance and 1/8 for the mean
+      const auto err = took > m_Smoothed ? took - m_Smoothed : m_Smoothed - took;
+      m_Variance = (m_Variance * 3 + err) / 4;
+      m_Smoothed = (m_Smoothed * 7 + took) / 8;
+    }
+
+    llarp_time_t
+    BuildTimeEstimator::Timeout(
+        size_t numHops, std::optional<llarp_time_t> firstHopRTT, size_t unknownHops) const
+    {
+      if (not HasHistory() and not firstHopRTT)
+        return build_timeout;
+      llarp_time_t timeout = 0s;
+      if (HasHistory())
+        timeout = m_Smoothed + 4 * m_Variance;
+      // the commit goes out over every hop and the status comes back over them, each taken
+      // to be as far as the one hop we know
+      if (firstHopRTT)
+      {
+        const llarp_time_t perHop = *firstHopRTT * 2 + HopAllowance;
+        timeout = std::max(timeout, int64_t(numHops) * perHop);
+      }
+      timeout += int64_t(unknownHops) * UnknownHopAllowance;
+      return std::clamp<llarp_time_t>(timeout, MinTimeout, build_timeout);
+    }
+
+    llarp_time_t
+    BuildTimeEstimator::LateAfter(llarp_time_t timeout) const
+    {
+      if (not HasHistory())
+        return timeout / 2;
+      return std::min<llarp_time_t>(m_Smoothed + 2 * m_Variance, timeout / 2);
+    }
+
+    util::StatusObject
+    BuildTimeEstimator::ExtractStatus() const
+    {
+      return util::StatusObject{{"smoothed", to_json(m_Smoothed)},
+                                {"variance", to_json(m_Variance)},
+                                {"samples", m_Samples}};
+    }
+  }  // namespace path
+}  // namespace llarp
@@ -0,0 +1,59 @@
+#ifndef LLARP_PATH_BUILD_TIME_HPP
+#define LLARP_PATH_BUILD_TIME_HPP
+
+#include <constants/path.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstddef>
+#include <optional>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// how long the path builds of one path set take, smoothed as tcp smooths its rtt, so a
+    /// build is given up on once it is later than builds like it have been rather than after
+    /// a fixed build_timeout. only touched from the logic thread
+    struct BuildTimeEstimator
+    {
+      /// no build is given up on sooner
+      static constexpr auto MinTimeout = 3s;
+      /// what each hop is given for its crypto and queueing on top of the link rtt
+      static constexpr auto HopAllowance = 500ms;
+      /// added for each hop our profiles have never seen a path built over
+      static constexpr auto UnknownHopAllowance = 1s;
+
+      /// a build took this long from commit to established
+      void
+      Observe(llarp_time_t took);
+
+      bool
+      HasHistory() const
+      {
+        return m_Samples > 0;
+      }
+
+      /// how long to wait on a build over numHops hops before giving up on it. firstHopRTT is
+      /// the rtt of our session to the first hop if we have one, unknownHops how many of the
+      /// hops have no path history. build_timeout when there is nothing to go on
+      llarp_time_t
+      Timeout(size_t numHops, std::optional<llarp_time_t> firstHopRTT, size_t unknownHops) const;
+
+      /// how far into a build with this timeout it is running late enough that another is
+      /// started alongside it
+      llarp_time_t
+      LateAfter(llarp_time_t timeout) const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      llarp_time_t m_Smoothed = 0s;
+      llarp_time_t m_Variance = 0s;
+      uint64_t m_Samples = 0;
+    };
+  }  // namespace path
+}  // namespace llarp
+
+#endif
@@ -1,4 +1,7 @@
 #include <path/ihophandler.hpp>
+#include <path/path_context.hpp>
+#include <router/abstractrouter.hpp>
+#include <util/alloc_stats.hpp>
 
 namespace llarp
 {
@@ -6,33 +9,46 @@ namespace llarp
   {
     // handle data in upstream direction
     bool
-    IHopHandler::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*)
+    IHopHandler::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      if (not m_UpstreamReplayFilter.Insert(Y))
+      alloc::Scope allocScope{alloc::PathQueues};
+      if (not m_UpstreamReplayFilter.Insert(Y, r->Now()))
         return false;
+      if (UpstreamBackedUp(r))
+      {
+        r->pathContext().CellShed();
+        return true;
+      }
       if (m_UpstreamQueue == nullptr)
+      {
         m_UpstreamQueue = std::make_shared<TrafficQueue_t>();
-      m_UpstreamQueue->emplace_back();
-      auto& pkt = m_UpstreamQueue->back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+        m_UpstreamQueuedAt = metrics::Histogram::Clock_t::now();
+        r->pathContext().QueueUpstreamFlush(HopHandlerPtr());
+      }
+      m_UpstreamQueue->emplace_back(util::PooledVector<byte_t>(X.base, X.base + X.sz), Y);
       return true;
     }
 
     // handle data in downstream direction
     bool
-    IHopHandler::HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*)
+    IHopHandler::HandleDownstream(
+        const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      if (not m_DownstreamReplayFilter.Insert(Y))
+      alloc::Scope allocScope{alloc::PathQueues};
+      if (not m_DownstreamReplayFilter.Insert(Y, r->Now()))
         return false;
+      if (DownstreamBackedUp(r))
+      {
+        r->pathContext().CellShed();
+        return true;
+      }
       if (m_DownstreamQueue == nullptr)
+      {
         m_DownstreamQueue = std::make_shared<TrafficQueue_t>();
-      m_DownstreamQueue->emplace_back();
-      auto& pkt = m_DownstreamQueue->back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+        m_DownstreamQueuedAt = metrics::Histogram::Clock_t::now();
+        r->pathContext().QueueDownstreamFlush(HopHandlerPtr());
+      }
+      m_DownstreamQueue->emplace_back(util::PooledVector<byte_t>(X.base, X.base + X.sz), Y);
       return true;
     }
 
@@ -4,8 +4,11 @@
 #include <crypto/types.hpp>
 #include <util/types.hpp>
 #include <crypto/encrypted_frame.hpp>
-#include <util/decaying_hashset.hpp>
+#include <constants/path.hpp>
+#include <util/decaying_bloom_filter.hpp>
 #include <messages/relay.hpp>
+#include <util/metrics.hpp>
+#include <util/pool.hpp>
 #include <vector>
 
 #include <memory>
@@ -25,8 +28,12 @@ namespace llarp
   {
     struct IHopHandler
     {
-      using TrafficEvent_t = std::pair<std::vector<byte_t>, TunnelNonce>;
-      using TrafficQueue_t = std::list<TrafficEvent_t>;
+      /// a cell in a pooled block. cells are queued and sent on from the logic thread, so it
+      /// mostly gets back the block of a cell it just sent on instead of going to the heap.
+      /// crypto runs in place on it and the cell is forwarded as a view into it
+      using TrafficEvent_t = std::pair<util::PooledVector<byte_t>, TunnelNonce>;
+      /// contiguous, so a queue grows by doubling rather than by a list node per cell
+      using TrafficQueue_t = std::vector<TrafficEvent_t>;
       using TrafficQueue_ptr = std::shared_ptr<TrafficQueue_t>;
 
       virtual ~IHopHandler() = default;
@@ -34,6 +41,20 @@ namespace llarp
       void
       DecayFilters(llarp_time_t now);
 
+      /// bytes held by both replay filters
+      size_t
+      ReplayFilterMemory() const
+      {
+        return m_UpstreamReplayFilter.MemoryUsage() + m_DownstreamReplayFilter.MemoryUsage();
+      }
+
+      /// how long after the last cell a DecayFilters call frees both replay filters
+      llarp_time_t
+      ReplayFilterIdleAfter() const
+      {
+        return 2 * m_UpstreamReplayFilter.DecayInterval() + 1s;
+      }
+
       virtual bool
       Expired(llarp_time_t now) const = 0;
 
@@ -51,6 +72,32 @@ namespace llarp
       virtual bool
       HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*);
 
+      /// true when what we send on upstream would only wait behind a backed up link, cells
+      /// are then dropped as they come in instead of after we spend crypto on them
+      virtual bool
+      UpstreamBackedUp(AbstractRouter* r) = 0;
+
+      /// as UpstreamBackedUp for what we send on downstream
+      virtual bool
+      DownstreamBackedUp(AbstractRouter* r) = 0;
+
+      /// how long a cell marked congested keeps this hop counted as congested
+      static constexpr auto CongestionHold = 500ms;
+
+      /// a downstream cell came marked congested
+      void
+      NoteCongestion(llarp_time_t now)
+      {
+        m_CongestedUntil = now + CongestionHold;
+      }
+
+      /// true while a hop below us lately found its link congested
+      bool
+      Congested(llarp_time_t now) const
+      {
+        return now < m_CongestedUntil;
+      }
+
       /// return timestamp last remote activity happened at
       virtual llarp_time_t
       LastRemoteActivityAt() const = 0;
@@ -70,12 +117,22 @@ namespace llarp
       virtual void
       FlushDownstream(AbstractRouter* r) = 0;
 
+      /// owning pointer to this hop, held by the path context while it has traffic queued
+      virtual std::shared_ptr<IHopHandler>
+      HopHandlerPtr() = 0;
+
      protected:
       uint64_t m_SequenceNum = 0;
+      llarp_time_t m_CongestedUntil = 0s;
       TrafficQueue_ptr m_UpstreamQueue;
       TrafficQueue_ptr m_DownstreamQueue;
-      util::DecayingHashSet<TunnelNonce> m_UpstreamReplayFilter;
-      util::DecayingHashSet<TunnelNonce> m_DownstreamReplayFilter;
+      /// when the first cell went into each queue
+      metrics::Histogram::Clock_t::time_point m_UpstreamQueuedAt;
+      metrics::Histogram::Clock_t::time_point m_DownstreamQueuedAt;
+      util::DecayingBloomFilter<TunnelNonce> m_UpstreamReplayFilter{
+          replay_filter_capacity, replay_filter_fp_rate};
+      util::DecayingBloomFilter<TunnelNonce> m_DownstreamReplayFilter{
+          replay_filter_capacity, replay_filter_fp_rate};
 
       virtual void
       UpstreamWork(TrafficQueue_ptr queue, AbstractRouter* r) = 0;
@@ -0,0 +1,31 @@
+#ifndef LLARP_PATH_LATENCY_PROBE_HPP
+#define LLARP_PATH_LATENCY_PROBE_HPP
+
+#include <constants/path.hpp>
+#include <util/time.hpp>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// true if an established path with no probe out should send a latency probe now.
+    /// lastActive is the last time anything went up or came down it, lastSample the last time
+    /// its rtt was measured by a probe or a reply to a request. a path in use is probed once
+    /// its rtt is stale, an idle one only often enough to see that it is still up
+    constexpr bool
+    ShouldProbeLatency(llarp_time_t now, llarp_time_t lastActive, llarp_time_t lastSample)
+    {
+      const bool busy = now < lastActive + latency_interval;
+      return now > lastSample + (busy ? latency_interval : idle_latency_interval);
+    }
+
+    /// true once a probe sent at probeSent has been out too long to wait on any more
+    constexpr bool
+    ProbeTimedOut(llarp_time_t now, llarp_time_t probeSent)
+    {
+      return now >= probeSent + latency_timeout;
+    }
+  }  // namespace path
+}  // namespace llarp
+
+#endif
@@ -1,20 +1,27 @@
 #include <path/path.hpp>
 
+#include <crypto/hot_crypto.hpp>
 #include <exit/exit_messages.hpp>
 #include <link/i_link_manager.hpp>
 #include <messages/discard.hpp>
 #include <messages/relay_commit.hpp>
 #include <messages/relay_status.hpp>
+#include <net/ip_packet.hpp>
+#include <path/latency_probe.hpp>
+#include <path/path_context.hpp>
 #include <path/pathbuilder.hpp>
 #include <path/transit_hop.hpp>
 #include <profiling.hpp>
 #include <router/abstractrouter.hpp>
+#include <router/i_outbound_message_handler.hpp>
 #include <routing/dht_message.hpp>
 #include <routing/path_latency_message.hpp>
 #include <routing/transfer_traffic_message.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/buffer.hpp>
 #include <util/endian.hpp>
 #include <util/thread/logic.hpp>
+#include <util/tracy.hpp>
 #include <tooling/path_event.hpp>
 
 #include <deque>
@@ -153,6 +160,8 @@ namespace llarp
           break;
         }
         llarp::LogDebug("Decoded LR Status Record from ", hops[index].rc.pubkey);
+        if (record.load)
+          r->pathContext().RelayLoadReports().Put(hops[index].rc.pubkey, *record.load, r->Now());
 
         currentStatus = record.status;
         if ((record.status & LR_StatusRecord::SUCCESS) != LR_StatusRecord::SUCCESS)
@@ -246,6 +255,7 @@ namespace llarp
       {
         _status = st;
         m_PathSet->HandlePathBuildFailed(shared_from_this());
+        m_PathSet->PathExpiring(shared_from_this());
         return;
       }
       if (st == ePathExpired && _status == ePathBuilding)
@@ -273,6 +283,9 @@ namespace llarp
         LogInfo("path ", Name(), " reanimated");
       }
       _status = st;
+      // expired by state rather than by time, so its set should not wait for its expiry time
+      if (Expired(now))
+        m_PathSet->PathExpiring(shared_from_this());
     }
 
     util::StatusObject
@@ -293,14 +306,29 @@ namespace llarp
       util::StatusObject obj{{"intro", intro.ExtractStatus()},
                              {"lastRecvMsg", to_json(m_LastRecvMessage)},
                              {"lastLatencyTest", to_json(m_LastLatencyTestTime)},
+                             {"lastLatencySample", to_json(m_LastLatencySample)},
+                             {"latencyProbes", m_LatencyProbes},
+                             {"replyLatencySamples", m_ReplyLatencySamples},
                              {"buildStarted", to_json(buildStarted)},
                              {"expired", Expired(now)},
                              {"expiresSoon", ExpiresSoon(now)},
                              {"expiresAt", to_json(ExpireTime())},
                              {"ready", IsReady()},
-                             {"txRateCurrent", m_LastTXRate},
-                             {"rxRateCurrent", m_LastRXRate},
-                             {"hasExit", SupportsAnyRoles(ePathRoleExit)}};
+                             {"txRateCurrent", uint64_t(m_TXRate.Last())},
+                             {"rxRateCurrent", uint64_t(m_RXRate.Last())},
+                             {"txRate", m_TXRate.ExtractStatus()},
+                             {"rxRate", m_RXRate.ExtractStatus()},
+                             {"hasExit", SupportsAnyRoles(ePathRoleExit)},
+                             {"replayFilterBytes", ReplayFilterMemory()},
+                             {"score", m_Score.ExtractStatus()},
+                             {"batching", m_UpstreamBatch.enabled},
+                             {"batched", m_UpstreamBatch.Batched()},
+                             {"batches", m_UpstreamBatch.Batches()},
+                             {"padding", padding::ToString(padding)},
+                             {"cost", Cost()},
+                             {"backedUp", m_BackedUp},
+                             {"congested", Congested(now)},
+                             {"congestionMarks", m_CongestionMarks}};
 
       std::vector<util::StatusObject> hopsObj;
       std::transform(
@@ -353,11 +381,11 @@ namespace llarp
       if (Expired(now))
         return;
 
-      m_LastRXRate = m_RXRate;
-      m_LastTXRate = m_TXRate;
+      DecayFilters(now);
+      m_Score.Tick(now, m_RXRate.Tick(now) + m_TXRate.Tick(now));
 
-      m_RXRate = 0;
-      m_TXRate = 0;
+      // so an idle path that was backed up gets picked again once its link drains
+      UpstreamBackedUp(r);
 
       if (_status == ePathBuilding)
       {
@@ -366,7 +394,7 @@ namespace llarp
         if (now >= buildStarted)
         {
           const auto dlt = now - buildStarted;
-          if (dlt >= path::build_timeout)
+          if (dlt >= buildTimeout)
           {
             LogWarn(Name(), " waited for ", dlt, " and no path was built");
             r->routerProfiling().MarkPathFail(this);
@@ -378,26 +406,29 @@ namespace llarp
       // check to see if this path is dead
       if (_status == ePathEstablished)
       {
-        auto dlt = now - m_LastLatencyTestTime;
-        if (dlt > path::latency_interval && m_LastLatencyTestID == 0)
+        SendCover(now, r);
+        if (m_LastLatencyTestID and ProbeTimedOut(now, m_LastLatencyTestTime))
         {
-          // bail doing test if we are active
-          if (now - m_LastRecvMessage < path::latency_interval)
+          if (m_LastRecvMessage < m_LastLatencyTestTime)
+          {
+            LogWarn(Name(), " waited for ", now - m_LastRecvMessage, " and path looks dead");
+            r->routerProfiling().MarkPathFail(this);
+            EnterState(ePathTimeout, now);
             return;
+          }
+          // lost, but the path is still carrying things so it is up
+          m_LastLatencyTestID = 0;
+        }
+        const auto lastActive = std::max(m_LastRecvMessage, m_LastSendMessage);
+        if (m_LastLatencyTestID == 0 and ShouldProbeLatency(now, lastActive, m_LastLatencySample))
+        {
           routing::PathLatencyMessage latency;
           latency.T = randint();
           m_LastLatencyTestID = latency.T;
           m_LastLatencyTestTime = now;
+          m_LatencyProbes++;
           SendRoutingMessage(latency, r);
           FlushUpstream(r);
-          return;
-        }
-        dlt = now - m_LastRecvMessage;
-        if (dlt >= path::alive_timeout)
-        {
-          LogWarn(Name(), " waited for ", dlt, " and path looks dead");
-          r->routerProfiling().MarkPathFail(this);
-          EnterState(ePathTimeout, now);
         }
       }
     }
@@ -409,7 +440,9 @@ namespace llarp
       {
         if (r->SendToOrQueue(Upstream(), &msg))
         {
-          m_TXRate += msg.X.size();
+          m_TXRate.Add(msg.XView.Or(msg.X).sz);
+          m_Score.AddSent();
+          m_LastSendMessage = r->Now();
         }
         else
         {
@@ -422,37 +455,73 @@ namespace llarp
     void
     Path::UpstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      alloc::Scope allocScope{alloc::PathQueues};
+      LLARP_ZONE("Path::UpstreamWork");
+      LLARP_PLOT("path upstream batch", msgs->size());
       std::vector<RelayUpstreamMessage> sendmsgs(msgs->size());
-      size_t idx = 0;
+      std::vector<CryptoSpan> spans;
+      std::vector<TunnelNonce> nonces;
+      spans.reserve(msgs->size());
+      nonces.reserve(msgs->size());
       for (auto& ev : *msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        TunnelNonce n = ev.second;
-        for (const auto& hop : hops)
-        {
-          CryptoManager::instance()->xchacha20(buf, hop.shared, n);
+        spans.push_back({ev.first.data(), ev.first.size()});
+        nonces.push_back(ev.second);
+      }
+      // one layer at a time so each hop key sees the whole batch at once
+      const auto started = metrics::Histogram::Clock_t::now();
+      for (const auto& hop : hops)
+      {
+        HotCrypto()->xchacha20_batch(
+            spans.data(), nonces.data(), spans.size(), hop.shared);
+        for (auto& n : nonces)
           n ^= hop.nonceXOR;
-        }
+      }
+      r->pathContext().OnionCryptoTimes().ObserveSince(started);
+      size_t idx = 0;
+      for (auto& ev : *msgs)
+      {
         auto& msg = sendmsgs[idx];
-        msg.X = buf;
+        msg.XView.Assign(ev.first.data(), ev.first.size());
         msg.Y = ev.second;
         msg.pathid = TXID();
         ++idx;
       }
-      LogicCall(r->logic(), [self = shared_from_this(), data = std::move(sendmsgs), r]() {
-        self->HandleAllUpstream(std::move(data), r);
-      });
+      // the messages view the cells in msgs, which the logic thread frees once they are sent
+      LogicCall(
+          r->logic(),
+          [self = shared_from_this(), data = std::move(sendmsgs), held = std::move(msgs), r]() {
+            self->HandleAllUpstream(std::move(data), r);
+          });
+    }
+
+    bool
+    Path::UpstreamBackedUp(AbstractRouter* r)
+    {
+      m_BackedUp = r->outboundMessageHandler().IsBackedUp(Upstream(), TXID());
+      return m_BackedUp;
     }
 
     void
     Path::FlushUpstream(AbstractRouter* r)
     {
+      if (not m_UpstreamBatch.Empty())
+      {
+        if (r->Now() >= m_UpstreamBatch.Started() + r->pathContext().CellBatchDelay())
+          SendBatch(r);
+        else
+          r->pathContext().QueueUpstreamFlush(HopHandlerPtr());
+      }
       if (m_UpstreamQueue && not m_UpstreamQueue->empty())
       {
         TrafficQueue_ptr data = nullptr;
         std::swap(m_UpstreamQueue, data);
-        r->QueueWork(
-            [self = shared_from_this(), data, r]() { self->UpstreamWork(std::move(data), r); });
+        r->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data, r, queued = m_UpstreamQueuedAt]() {
+              r->pathContext().OnionWaitTimes().ObserveSince(queued);
+              self->UpstreamWork(std::move(data), r);
+            });
       }
     }
 
@@ -463,8 +532,12 @@ namespace llarp
       {
         TrafficQueue_ptr data = nullptr;
         std::swap(m_DownstreamQueue, data);
-        r->QueueWork(
-            [self = shared_from_this(), data, r]() { self->DownstreamWork(std::move(data), r); });
+        r->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data, r, queued = m_DownstreamQueuedAt]() {
+              r->pathContext().OnionWaitTimes().ObserveSince(queued);
+              self->DownstreamWork(std::move(data), r);
+            });
       }
     }
 
@@ -495,23 +568,41 @@ namespace llarp
     void
     Path::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
+      alloc::Scope allocScope{alloc::PathQueues};
+      LLARP_ZONE("Path::DownstreamWork");
+      LLARP_PLOT("path downstream batch", msgs->size());
       std::vector<RelayDownstreamMessage> sendMsgs(msgs->size());
+      std::vector<CryptoSpan> spans;
+      std::vector<TunnelNonce> nonces;
+      spans.reserve(msgs->size());
+      nonces.reserve(msgs->size());
+      for (auto& ev : *msgs)
+      {
+        spans.push_back({ev.first.data(), ev.first.size()});
+        nonces.push_back(ev.second);
+      }
+      // one layer at a time so each hop key sees the whole batch at once
+      const auto started = metrics::Histogram::Clock_t::now();
+      for (const auto& hop : hops)
+      {
+        for (auto& n : nonces)
+          n ^= hop.nonceXOR;
+        HotCrypto()->xchacha20_batch(
+            spans.data(), nonces.data(), spans.size(), hop.shared);
+      }
+      r->pathContext().OnionCryptoTimes().ObserveSince(started);
       size_t idx = 0;
       for (auto& ev : *msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        sendMsgs[idx].Y = ev.second;
-        for (const auto& hop : hops)
-        {
-          sendMsgs[idx].Y ^= hop.nonceXOR;
-          CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
-        }
-        sendMsgs[idx].X = buf;
+        sendMsgs[idx].Y = nonces[idx];
+        sendMsgs[idx].XView.Assign(ev.first.data(), ev.first.size());
         ++idx;
       }
-      LogicCall(r->logic(), [self = shared_from_this(), msgs = std::move(sendMsgs), r]() {
-        self->HandleAllDownstream(std::move(msgs), r);
-      });
+      LogicCall(
+          r->logic(),
+          [self = shared_from_this(), sendMsgs = std::move(sendMsgs), held = std::move(msgs), r]() {
+            self->HandleAllDownstream(std::move(sendMsgs), r);
+          });
     }
 
     void
@@ -519,8 +610,8 @@ namespace llarp
     {
       for (const auto& msg : msgs)
       {
-        const llarp_buffer_t buf(msg.X);
-        m_RXRate += buf.sz;
+        const llarp_buffer_t buf = msg.XView.Or(msg.X);
+        m_RXRate.Add(buf.sz);
         if (!HandleRoutingMessage(buf, r))
         {
           LogWarn("failed to handle downstream message");
@@ -575,19 +666,120 @@ namespace llarp
         DumpBuffer(buf);
         return false;
       }
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      if (m_UpstreamBatch.Batchable(buf))
+      {
+        const bool first = m_UpstreamBatch.Empty();
+        if (not m_UpstreamBatch.Add(buf, r->Now()))
+        {
+          SendBatch(r);
+          m_UpstreamBatch.Add(buf, r->Now());
+        }
+        // goes out from FlushUpstream on the next pump at the earliest
+        if (first)
+          r->pathContext().QueueUpstreamFlush(HopHandlerPtr());
+        return true;
+      }
+      // anything batched was sent before this
+      if (not m_UpstreamBatch.Empty())
+        SendBatch(r);
+      return SendCell(buf, r);
+    }
+
+    bool
+    Path::SendCell(llarp_buffer_t& buf, AbstractRouter* r)
+    {
       // make nonce
       TunnelNonce N;
       N.Randomize();
-      buf.sz = buf.cur - buf.base;
-      // pad smaller messages
-      if (buf.sz < pad_size)
+      // every caller encodes into MAX_LINK_MSG_SIZE / 2 bytes
+      const auto pad = padding::CellPadding(padding, buf.sz, MAX_LINK_MSG_SIZE / 2);
+      if (pad)
+        HotCrypto()->randbytes(buf.base + buf.sz, pad);
+      padding::CountCell(buf.sz, pad);
+      buf.sz += pad;
+      buf.cur = buf.base;
+      m_LastCellSent = r->Now();
+      return HandleUpstream(buf, N, r);
+    }
+
+    bool
+    Path::SendBatch(AbstractRouter* r)
+    {
+      routing::BatchMessage batch;
+      m_UpstreamBatch.Take(batch);
+      batch.S = NextSeqNo();
+      std::array<byte_t, MAX_LINK_MSG_SIZE / 2> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not batch.BEncode(&buf))
       {
-        // randomize padding
-        CryptoManager::instance()->randbytes(buf.cur, pad_size - buf.sz);
-        buf.sz = pad_size;
+        LogError(Name(), " failed to encode batch of ", batch.M.size(), " routing messages");
+        return false;
       }
+      buf.sz = buf.cur - buf.base;
+      return SendCell(buf, r);
+    }
+
+    void
+    Path::SendCover(llarp_time_t now, AbstractRouter* r)
+    {
+      // the endpoint drops an empty batch, so only once it has shown it reads them
+      if (padding != padding::Profile::ConstantRate or not m_UpstreamBatch.enabled)
+        return;
+      if (not m_UpstreamBatch.Empty() or now < m_LastCellSent + padding::CoverInterval)
+        return;
+      routing::BatchMessage batch;
+      batch.S = NextSeqNo();
+      std::array<byte_t, padding::ConstantCellSize> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not batch.BEncode(&buf))
+        return;
+      buf.sz = buf.cur - buf.base;
+      TunnelNonce N;
+      N.Randomize();
+      HotCrypto()->randbytes(buf.base + buf.sz, tmp.size() - buf.sz);
+      padding::CountCell(buf.sz, tmp.size() - buf.sz, true);
+      buf.sz = tmp.size();
       buf.cur = buf.base;
-      return HandleUpstream(buf, N, r);
+      m_LastCellSent = now;
+      HandleUpstream(buf, N, r);
+    }
+
+    void
+    Path::SendBatchProbe(AbstractRouter* r)
+    {
+      m_BatchProbed = true;
+      routing::PathLatencyMessage probe;
+      probe.T = randint();
+      probe.S = NextSeqNo();
+      m_BatchProbeID = probe.T;
+      m_BatchProbeTime = r->Now();
+      std::array<byte_t, 128> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not probe.BEncode(&buf))
+        return;
+      routing::BatchMessage batch;
+      batch.M.emplace_back(reinterpret_cast<const char*>(tmp.data()), buf.cur - buf.base);
+      batch.S = NextSeqNo();
+      // not batchable yet, so this goes as a cell of its own
+      SendRoutingMessage(batch, r);
+    }
+
+    void
+    Path::SampleLatency(llarp_time_t rtt, llarp_time_t now)
+    {
+      intro.latency = rtt;
+      m_Score.AddLatencySample(rtt);
+      m_LastLatencySample = now;
+    }
+
+    bool
+    Path::HandleBatchMessage(const routing::BatchMessage&, AbstractRouter* r)
+    {
+      MarkActive(r->Now());
+      m_UpstreamBatch.enabled = true;
+      return true;
     }
 
     bool
@@ -602,6 +794,7 @@ namespace llarp
     Path::HandleDataDiscardMessage(const routing::DataDiscardMessage& msg, AbstractRouter* r)
     {
       MarkActive(r->Now());
+      m_Score.AddDrop();
       if (m_DropHandler)
         return m_DropHandler(shared_from_this(), msg.P, msg.S);
       return true;
@@ -654,11 +847,22 @@ namespace llarp
     {
       const auto now = r->Now();
       MarkActive(now);
+      if (m_BatchProbeID and msg.L == m_BatchProbeID)
+      {
+        LogDebug(Name(), " endpoint understands batched routing messages");
+        m_BatchProbeID = 0;
+        SampleLatency(now - m_BatchProbeTime, now);
+        m_ReplyLatencySamples++;
+        m_UpstreamBatch.enabled = true;
+        return true;
+      }
       if (msg.L == m_LastLatencyTestID)
       {
-        intro.latency = now - m_LastLatencyTestTime;
+        SampleLatency(now - m_LastLatencyTestTime, now);
         m_LastLatencyTestID = 0;
         EnterState(ePathEstablished, now);
+        if (not m_BatchProbed)
+          SendBatchProbe(r);
         if (m_BuiltHook)
           m_BuiltHook(shared_from_this());
         m_BuiltHook = nullptr;
@@ -709,6 +913,7 @@ namespace llarp
     {
       LogInfo(Name(), " sending exit request to ", Endpoint());
       m_ExitObtainTX = msg.T;
+      m_ExitObtainTime = r->Now();
       return SendRoutingMessage(msg, r);
     }
 
@@ -749,6 +954,8 @@ namespace llarp
           LogError(Name(), "RXM invalid signature");
           return false;
         }
+        SampleLatency(r->Now() - m_ExitObtainTime, r->Now());
+        m_ReplyLatencySamples++;
         LogInfo(Name(), " ", Endpoint(), " Rejected exit");
         MarkActive(r->Now());
         return InformExitResult(llarp_time_t(msg.B));
@@ -767,6 +974,8 @@ namespace llarp
           LogError(Name(), " GXM signature failed");
           return false;
         }
+        SampleLatency(r->Now() - m_ExitObtainTime, r->Now());
+        m_ReplyLatencySamples++;
         // we now can send exit traffic
         _role |= ePathRoleExit;
         LogInfo(Name(), " ", Endpoint(), " Granted exit");
@@ -788,6 +997,13 @@ namespace llarp
       return result;
     }
 
+    void
+    Path::MarkIfCongested(byte_t* pkt, size_t sz, llarp_time_t now)
+    {
+      if (Congested(now) and net::MarkCE(pkt, sz))
+        m_CongestionMarks++;
+    }
+
     bool
     Path::HandleTransferTrafficMessage(
         const routing::TransferTrafficMessage& msg, AbstractRouter* r)
@@ -798,19 +1014,23 @@ namespace llarp
       // handle traffic if we have a handler
       if (!m_ExitTrafficHandler)
         return false;
-      bool sent = msg.X.size() > 0;
+      bool sent = msg.X.size() + msg.XView.size() > 0;
       auto self = shared_from_this();
-      for (const auto& pkt : msg.X)
-      {
-        if (pkt.size() <= 8)
+      msg.ForEachPacket([&](const llarp_buffer_t& pkt) {
+        if (pkt.sz <= 8)
+        {
+          sent = false;
           return false;
-        uint64_t counter = bufbe64toh(pkt.data());
-        if (m_ExitTrafficHandler(self, llarp_buffer_t(pkt.data() + 8, pkt.size() - 8), counter))
+        }
+        uint64_t counter = bufbe64toh(pkt.base);
+        MarkIfCongested(pkt.base + 8, pkt.sz - 8, r->Now());
+        if (m_ExitTrafficHandler(self, llarp_buffer_t(pkt.base + 8, pkt.sz - 8), counter))
         {
           MarkActive(r->Now());
           EnterState(ePathEstablished, r->Now());
         }
-      }
+        return true;
+      });
       return sent;
     }
 
@@ -6,15 +6,18 @@
 #include <crypto/types.hpp>
 #include <messages/relay.hpp>
 #include <path/ihophandler.hpp>
+#include <path/path_score.hpp>
 #include <path/path_types.hpp>
 #include <path/pathbuilder.hpp>
 #include <path/pathset.hpp>
 #include <router_id.hpp>
+#include <routing/batch_message.hpp>
 #include <routing/handler.hpp>
 #include <routing/message.hpp>
 #include <service/intro.hpp>
 #include <util/aligned.hpp>
 #include <util/compare_ptr.hpp>
+#include <util/rate_estimator.hpp>
 #include <util/thread/threading.hpp>
 #include <util/time.hpp>
 
@@ -88,12 +91,26 @@ namespace llarp
 
       HopList hops;
 
-      PathSet* const m_PathSet;
+      /// changes when the path pool hands the path to a new owner
+      PathSet* m_PathSet;
 
       service::Introduction intro;
 
       llarp_time_t buildStarted = 0s;
 
+      /// how long after buildStarted the build is given up on, set by the builder from how
+      /// long its builds have been taking
+      llarp_time_t buildTimeout = path::build_timeout;
+
+      /// how long after buildStarted the builder starts another build alongside this one
+      llarp_time_t buildLateAfter = path::build_timeout;
+
+      /// the builder has started another build because this one was running late
+      bool speculated = false;
+
+      /// what our cells and the ones the hops send back are padded to, set before the build
+      padding::Profile padding = padding::DefaultProfile;
+
       Path(
           const std::vector<RouterContact>& routers,
           PathSet* parent,
@@ -114,15 +131,9 @@ namespace llarp
         size_t
         operator()(const Path& p) const
         {
-          const auto& tx = p.hops[0].txID;
-          const auto& rx = p.hops[0].rxID;
-          const auto& r = p.hops[0].upstream;
-          const size_t rhash = std::accumulate(r.begin(), r.end(), 0, std::bit_xor<size_t>());
-          return std::accumulate(
-              rx.begin(),
-              rx.begin(),
-              std::accumulate(tx.begin(), tx.end(), rhash, std::bit_xor<size_t>()),
-              std::bit_xor<size_t>());
+          const auto& hop = p.hops[0];
+          return RouterID::Hash()(hop.upstream) ^ (PathID_t::Hash()(hop.txID) << 1)
+              ^ (PathID_t::Hash()(hop.rxID) << 2);
         }
       };
 
@@ -319,6 +330,9 @@ namespace llarp
       bool
       HandlePathLatencyMessage(const routing::PathLatencyMessage& msg, AbstractRouter* r) override;
 
+      bool
+      HandleBatchMessage(const routing::BatchMessage& msg, AbstractRouter* r) override;
+
       bool
       HandlePathTransferMessage(
           const routing::PathTransferMessage& msg, AbstractRouter* r) override;
@@ -338,6 +352,20 @@ namespace llarp
       bool
       IsReady() const;
 
+      /// how this path has been doing, logic thread only
+      const PathScore&
+      Score() const
+      {
+        return m_Score;
+      }
+
+      /// roughly the ms it takes to get a frame through this path, lower is better
+      double
+      Cost() const
+      {
+        return m_Score.Cost();
+      }
+
       // Is this deprecated?
       // nope not deprecated :^DDDD
       PathID_t
@@ -373,12 +401,41 @@ namespace llarp
       bool
       SendExitClose(const routing::CloseExitMessage& msg, AbstractRouter* r);
 
+      /// checks our first hop's link and refreshes IsBackedUp
+      bool
+      UpstreamBackedUp(AbstractRouter* r) override;
+
+      /// downstream cells are ours, there is no link they wait on
+      bool
+      DownstreamBackedUp(AbstractRouter*) override
+      {
+        return false;
+      }
+
+      /// what UpstreamBackedUp last found, path sets send on other paths while it is set
+      bool
+      IsBackedUp() const
+      {
+        return m_BackedUp;
+      }
+
+      /// mark the raw ip packet at pkt, which came down this path, congestion experienced if
+      /// a hop on the way lately flagged its cells congested
+      void
+      MarkIfCongested(byte_t* pkt, size_t sz, llarp_time_t now);
+
       void
       FlushUpstream(AbstractRouter* r) override;
 
       void
       FlushDownstream(AbstractRouter* r) override;
 
+      std::shared_ptr<IHopHandler>
+      HopHandlerPtr() override
+      {
+        return shared_from_this();
+      }
+
      protected:
       void
       UpstreamWork(TrafficQueue_ptr queue, AbstractRouter* r) override;
@@ -397,6 +454,27 @@ namespace llarp
       bool
       InformExitResult(llarp_time_t b);
 
+      /// pad an encoded routing message and send it upstream as one cell
+      bool
+      SendCell(llarp_buffer_t& buf, AbstractRouter* r);
+
+      /// send everything waiting in the upstream batch as one cell
+      bool
+      SendBatch(AbstractRouter* r);
+
+      /// send an empty batch as cover when a constant rate path sent nothing for a while
+      void
+      SendCover(llarp_time_t now, AbstractRouter* r);
+
+      /// send a latency test inside a batch, the endpoint only answers it if it understands
+      /// batches
+      void
+      SendBatchProbe(AbstractRouter* r);
+
+      /// take rtt as the path's latency, measured at now
+      void
+      SampleLatency(llarp_time_t rtt, llarp_time_t now);
+
       BuildResultHookFunc m_BuiltHook;
       DataHandlerFunc m_DataHandler;
       DropHandlerFunc m_DropHandler;
@@ -406,17 +484,31 @@ namespace llarp
       ExitTrafficHandlerFunc m_ExitTrafficHandler;
       std::vector<ObtainedExitHandler> m_ObtainedExitHooks;
       llarp_time_t m_LastRecvMessage = 0s;
+      llarp_time_t m_LastCellSent = 0s;
+      llarp_time_t m_LastSendMessage = 0s;
       llarp_time_t m_LastLatencyTestTime = 0s;
       uint64_t m_LastLatencyTestID = 0;
+      llarp_time_t m_LastLatencySample = 0s;
+      /// latency probes sent once the path was up
+      uint64_t m_LatencyProbes = 0;
+      /// rtt samples taken from replies to other requests instead of a probe
+      uint64_t m_ReplyLatencySamples = 0;
+      uint64_t m_BatchProbeID = 0;
+      llarp_time_t m_BatchProbeTime = 0s;
+      bool m_BatchProbed = false;
+      routing::MessageBatcher m_UpstreamBatch;
       uint64_t m_UpdateExitTX = 0;
       uint64_t m_CloseExitTX = 0;
       uint64_t m_ExitObtainTX = 0;
+      llarp_time_t m_ExitObtainTime = 0s;
       PathStatus _status;
       PathRole _role;
-      uint64_t m_LastRXRate = 0;
-      uint64_t m_RXRate = 0;
-      uint64_t m_LastTXRate = 0;
-      uint64_t m_TXRate = 0;
+      util::RateEstimator m_RXRate;
+      util::RateEstimator m_TXRate;
+      PathScore m_Score;
+      bool m_BackedUp = false;
+      /// packets MarkIfCongested marked
+      uint64_t m_CongestionMarks = 0;
 
       const std::string m_shortName;
     };
@@ -4,6 +4,7 @@
 #include <path/path.hpp>
 #include <router/abstractrouter.hpp>
 #include <router/i_outbound_message_handler.hpp>
+#include <util/alloc_stats.hpp>
 
 namespace llarp
 {
@@ -12,7 +13,25 @@ namespace llarp
     static constexpr auto DefaultPathBuildLimit = 500ms;
 
     PathContext::PathContext(AbstractRouter* router)
-        : m_Router(router), m_AllowTransit(false), m_PathLimits(DefaultPathBuildLimit)
+        : m_Router(router)
+        , m_AllowTransit(false)
+        , m_PathLimits(DefaultPathBuildLimit)
+        , m_TransitHopsMetric(router->metrics().AddCounter(
+              "llarp_path_transit_hops_total", "transit hops we have agreed to be"))
+        , m_TransitPathsMetric(router->metrics().AddGauge(
+              "llarp_path_transit_paths", "paths we are a hop on for others"))
+        , m_OnionWaitMetric(router->metrics().AddHistogram(
+              "llarp_path_onion_wait_us",
+              "from a cell being queued on a path to its onion crypto starting",
+              metrics::LatencyBounds()))
+        , m_OnionCryptoMetric(router->metrics().AddHistogram(
+              "llarp_path_onion_crypto_us",
+              "the onion crypto of a batch of cells",
+              metrics::LatencyBounds()))
+        , m_BuildAcceptMetric(router->metrics().AddHistogram(
+              "llarp_path_build_accept_us",
+              "from a path build request arriving to us answering or forwarding it",
+              metrics::LatencyBounds()))
     {}
 
     void
@@ -161,15 +180,71 @@ namespace llarp
       set->AddPath(path);
       MapPut<util::Lock>(m_OurPaths, path->TXID(), path);
       MapPut<util::Lock>(m_OurPaths, path->RXID(), path);
+      m_OwnExpiry.emplace(path->ExpireTime(), path);
+    }
+
+    void
+    PathContext::RemoveOwnPaths(const std::vector<Path_ptr>& paths)
+    {
+      util::Lock lock(m_OurPaths.first);
+      auto& map = m_OurPaths.second;
+      for (const auto& path : paths)
+      {
+        for (const auto& id : {path->TXID(), path->RXID()})
+        {
+          auto itr = map.find(id);
+          if (itr != map.end() and itr->second == path)
+            map.erase(itr);
+        }
+      }
+    }
+
+    PathContext::SyncTransitMap_t&
+    PathContext::TransitShard(const PathID_t& id)
+    {
+      return m_TransitShards[PathID_t::Hash{}(id) % NumTransitShards];
+    }
+
+    void
+    PathContext::ForEachTransitHop(std::function<void(const TransitHop_ptr&)> visit) const
+    {
+      for (const auto& shard : m_TransitShards)
+        shard.ForEach(visit);
+    }
+
+    util::StatusObject
+    PathContext::ExtractTransitStatus() const
+    {
+      // every hop is in there under both its ids
+      size_t entries = 0;
+      size_t filterBytes = 0;
+      size_t gatherBytes = 0;
+      ForEachTransitHop([&entries, &filterBytes, &gatherBytes](const TransitHop_ptr& hop) {
+        entries++;
+        filterBytes += hop->ReplayFilterMemory();
+        gatherBytes += hop->GatherMemory();
+      });
+      const size_t hops = entries / 2;
+      filterBytes /= 2;
+      gatherBytes /= 2;
+      const size_t hopBytes = hops * sizeof(TransitHop) + filterBytes + gatherBytes;
+      return util::StatusObject{{"hops", hops},
+                                {"replayFilterBytes", filterBytes},
+                                {"replayFilterBytesPerHop", hops ? filterBytes / hops : 0},
+                                {"gatherBytes", gatherBytes},
+                                {"bytesPerHop", hops ? hopBytes / hops : 0},
+                                {"cellsShed", m_CellsShed},
+                                {"buildsShed", m_BuildsShed},
+                                {"buildsBusy", m_BuildsBusy}};
     }
 
     bool
     PathContext::HasTransitHop(const TransitHopInfo& info)
     {
-      return MapHas<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths, info.txID, [info](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return info == hop->info;
-          });
+      return MapHas<SyncTransitMap_t::ReadLock_t>(
+          TransitShard(info.txID),
+          info.txID,
+          [info](const std::shared_ptr<TransitHop>& hop) -> bool { return info == hop->info; });
     }
 
     HopHandler_ptr
@@ -186,8 +261,8 @@ namespace llarp
       if (own)
         return own;
 
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
+      return MapGet<SyncTransitMap_t::ReadLock_t>(
+          TransitShard(id),
           id,
           [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
             return hop->info.upstream == remote;
@@ -198,9 +273,10 @@ namespace llarp
     bool
     PathContext::TransitHopPreviousIsRouter(const PathID_t& path, const RouterID& otherRouter)
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      auto itr = m_TransitPaths.second.find(path);
-      if (itr == m_TransitPaths.second.end())
+      auto& shard = TransitShard(path);
+      SyncTransitMap_t::ReadLock_t lock(shard.first);
+      auto itr = shard.second.find(path);
+      if (itr == shard.second.end())
         return false;
       return itr->second->info.downstream == otherRouter;
     }
@@ -208,8 +284,8 @@ namespace llarp
     HopHandler_ptr
     PathContext::GetByDownstream(const RouterID& remote, const PathID_t& id)
     {
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
+      return MapGet<SyncTransitMap_t::ReadLock_t>(
+          TransitShard(id),
           id,
           [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
             return hop->info.downstream == remote;
@@ -246,9 +322,9 @@ namespace llarp
     PathContext::GetPathForTransfer(const PathID_t& id)
     {
       const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
+      auto& map = TransitShard(id);
       {
-        SyncTransitMap_t::Lock_t lock(map.first);
+        SyncTransitMap_t::ReadLock_t lock(map.first);
         auto range = map.second.equal_range(id);
         for (auto i = range.first; i != range.second; ++i)
         {
@@ -259,33 +335,78 @@ namespace llarp
       return nullptr;
     }
 
+    void
+    PathContext::QueueUpstreamFlush(HopHandler_ptr hop)
+    {
+      m_PendingUpstream.emplace_back(std::move(hop));
+    }
+
+    void
+    PathContext::QueueDownstreamFlush(HopHandler_ptr hop)
+    {
+      m_PendingDownstream.emplace_back(std::move(hop));
+    }
+
     void
     PathContext::PumpUpstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
+      alloc::Scope allocScope{alloc::PathQueues};
+      // flushing can queue more traffic on other hops, that waits for the next pump
+      m_Pumping.swap(m_PendingUpstream);
+      for (const auto& hop : m_Pumping)
+        hop->FlushUpstream(m_Router);
+      m_HopsFlushed += m_Pumping.size();
+      m_Pumping.clear();
     }
 
     void
     PathContext::PumpDownstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
+      alloc::Scope allocScope{alloc::PathQueues};
+      m_Pumping.swap(m_PendingDownstream);
+      for (const auto& hop : m_Pumping)
+        hop->FlushDownstream(m_Router);
+      m_HopsFlushed += m_Pumping.size();
+      m_Pumping.clear();
     }
 
     uint64_t
     PathContext::CurrentTransitPaths()
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      auto& map = m_TransitPaths.second;
-      return map.size() / 2;
+      size_t entries = 0;
+      for (auto& shard : m_TransitShards)
+      {
+        SyncTransitMap_t::ReadLock_t lock(shard.first);
+        entries += shard.second.size();
+      }
+      return entries / 2;
     }
 
     void
     PathContext::PutTransitHop(std::shared_ptr<TransitHop> hop)
     {
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.txID, hop);
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.rxID, hop);
+      MapPut<SyncTransitMap_t::Lock_t>(TransitShard(hop->info.txID), hop->info.txID, hop);
+      MapPut<SyncTransitMap_t::Lock_t>(TransitShard(hop->info.rxID), hop->info.rxID, hop);
+      m_TransitExpiry.emplace(hop->ExpireTime(), hop);
+      m_TransitHopsMetric.Inc();
+    }
+
+    void
+    PathContext::QueueIdleDecay(const TransitHop_ptr& hop)
+    {
+      hop->m_IdleDecayQueued = true;
+      m_TransitIdleDecay.emplace(m_Router->Now() + hop->ReplayFilterIdleAfter(), hop);
+    }
+
+    void
+    PathContext::RemoveTransitHop(const TransitHop_ptr& hop)
+    {
+      for (const auto& id : {hop->info.txID, hop->info.rxID})
+      {
+        MapDel<SyncTransitMap_t::Lock_t>(
+            TransitShard(id), id, [&hop](const TransitHop_ptr& other) { return other == hop; });
+        m_Router->outboundMessageHandler().QueueRemoveEmptyPath(id);
+      }
     }
 
     void
@@ -294,41 +415,41 @@ namespace llarp
       // decay limits
       m_PathLimits.Decay(now);
 
+      // transit hops decay their replay filters as traffic comes in, see IHopHandler, and
+      // once more after it stops so idle ones hold no filter
+      while (not m_TransitExpiry.empty() and m_TransitExpiry.begin()->first <= now)
       {
-        SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-        auto& map = m_TransitPaths.second;
-        auto itr = map.begin();
-        while (itr != map.end())
-        {
-          if (itr->second->Expired(now))
-          {
-            m_Router->outboundMessageHandler().QueueRemoveEmptyPath(itr->first);
-            itr = map.erase(itr);
-          }
-          else
-          {
-            itr->second->DecayFilters(now);
-            ++itr;
-          }
-        }
+        auto hop = m_TransitExpiry.begin()->second.lock();
+        m_TransitExpiry.erase(m_TransitExpiry.begin());
+        if (hop)
+          RemoveTransitHop(hop);
       }
+      while (not m_TransitIdleDecay.empty() and m_TransitIdleDecay.begin()->first <= now)
       {
-        util::Lock lock(m_OurPaths.first);
-        auto& map = m_OurPaths.second;
-        auto itr = map.begin();
-        while (itr != map.end())
-        {
-          if (itr->second->Expired(now))
-          {
-            itr = map.erase(itr);
-          }
-          else
-          {
-            itr->second->DecayFilters(now);
-            ++itr;
-          }
-        }
+        auto hop = m_TransitIdleDecay.begin()->second.lock();
+        m_TransitIdleDecay.erase(m_TransitIdleDecay.begin());
+        if (not hop)
+          continue;
+        hop->m_IdleDecayQueued = false;
+        hop->DecayFilters(now);
+      }
+      m_TransitPathsMetric.Set(CurrentTransitPaths());
+      // our paths go when their set expires them, this only catches the ones of sets that
+      // stopped ticking. their filters decay as their set ticks them
+      std::vector<Path_ptr> expired;
+      while (not m_OwnExpiry.empty() and m_OwnExpiry.begin()->first <= now)
+      {
+        auto path = m_OwnExpiry.begin()->second.lock();
+        m_OwnExpiry.erase(m_OwnExpiry.begin());
+        if (path == nullptr)
+          continue;
+        if (path->Expired(now))
+          expired.emplace_back(std::move(path));
+        else
+          m_OwnExpiry.emplace(now + ExpiryRecheckInterval, std::move(path));
       }
+      if (not expired.empty())
+        RemoveOwnPaths(expired);
     }
 
     routing::MessageHandler_ptr
@@ -343,9 +464,9 @@ namespace llarp
       if (h)
         return h;
       const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
+      auto& map = TransitShard(id);
       {
-        SyncTransitMap_t::Lock_t lock(map.first);
+        SyncTransitMap_t::ReadLock_t lock(map.first);
         auto range = map.second.equal_range(id);
         for (auto i = range.first; i != range.second; ++i)
         {
@@ -2,19 +2,27 @@
 #define LLARP_PATH_CONTEXT_HPP
 
 #include <crypto/encrypted_frame.hpp>
+#include <dht/request_limiter.hpp>
 #include <net/ip_address.hpp>
 #include <path/ihophandler.hpp>
 #include <path/path_types.hpp>
 #include <path/pathset.hpp>
+#include <path/relay_load.hpp>
 #include <path/transit_hop.hpp>
 #include <routing/handler.hpp>
 #include <router/i_outbound_message_handler.hpp>
 #include <util/compare_ptr.hpp>
 #include <util/decaying_hashset.hpp>
+#include <util/metrics.hpp>
 #include <util/types.hpp>
 
+#include <array>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace llarp
 {
@@ -40,12 +48,131 @@ namespace llarp
       void
       ExpirePaths(llarp_time_t now);
 
+      /// flush the upstream queue of every hop that got traffic since the last pump
       void
       PumpUpstream();
 
+      /// flush the downstream queue of every hop that got traffic since the last pump
       void
       PumpDownstream();
 
+      /// called when a hop's upstream queue goes from empty to non empty
+      void
+      QueueUpstreamFlush(HopHandler_ptr hop);
+
+      /// called when a hop's downstream queue goes from empty to non empty
+      void
+      QueueDownstreamFlush(HopHandler_ptr hop);
+
+      /// how long routing messages may wait to share a relay cell with the ones after them,
+      /// 0 only batches what is sent between two pumps
+      void
+      SetCellBatchDelay(llarp_time_t delay)
+      {
+        m_CellBatchDelay = delay;
+      }
+
+      llarp_time_t
+      CellBatchDelay() const
+      {
+        return m_CellBatchDelay;
+      }
+
+      /// number of hop queues flushed by pumping so far
+      uint64_t
+      HopsFlushed() const
+      {
+        return m_HopsFlushed;
+      }
+
+      /// a cell was dropped on the way in because where it goes next is backed up
+      void
+      CellShed()
+      {
+        m_CellsShed++;
+      }
+
+      uint64_t
+      CellsShed() const
+      {
+        return m_CellsShed;
+      }
+
+      /// from the first cell of a batch being queued on a path or hop to its onion crypto
+      /// starting, in microseconds
+      metrics::Histogram&
+      OnionWaitTimes()
+      {
+        return m_OnionWaitMetric;
+      }
+
+      /// the onion crypto of a batch of cells, in microseconds
+      metrics::Histogram&
+      OnionCryptoTimes()
+      {
+        return m_OnionCryptoMetric;
+      }
+
+      /// from a path build request arriving to us answering or forwarding it, in microseconds
+      metrics::Histogram&
+      PathBuildAcceptTimes()
+      {
+        return m_BuildAcceptMetric;
+      }
+
+      /// a path build request was dropped as too many were waiting on the workers
+      void
+      PathBuildShed()
+      {
+        m_BuildsShed++;
+      }
+
+      /// a path build request waited so long we told the builder we are busy
+      void
+      PathBuildBusy()
+      {
+        m_BuildsBusy++;
+      }
+
+      /// the load we report to builders that ask for it, set by the router each tick
+      RelayLoad
+      OurLoad() const
+      {
+        return m_OurLoad.load(std::memory_order_relaxed);
+      }
+
+      void
+      SetOurLoad(RelayLoad load)
+      {
+        m_OurLoad.store(load, std::memory_order_relaxed);
+      }
+
+      /// what the relays our paths went through said their load was
+      RelayLoads&
+      RelayLoadReports()
+      {
+        return m_RelayLoads;
+      }
+
+      const RelayLoads&
+      RelayLoadReports() const
+      {
+        return m_RelayLoads;
+      }
+
+      /// limits on the dht requests that come in over the paths that end at us
+      dht::RequestLimiter&
+      DHTRequests()
+      {
+        return m_DHTRequests;
+      }
+
+      const dht::RequestLimiter&
+      DHTRequests() const
+      {
+        return m_DHTRequests;
+      }
+
       void
       AllowTransit();
 
@@ -67,6 +194,10 @@ namespace llarp
       void
       PutTransitHop(std::shared_ptr<TransitHop> hop);
 
+      /// drop a transit hop now instead of when its lifetime is up
+      void
+      RemoveTransitHop(const TransitHop_ptr& hop);
+
       HopHandler_ptr
       GetByUpstream(const RouterID& id, const PathID_t& path);
 
@@ -108,23 +239,30 @@ namespace llarp
       void
       AddOwnPath(PathSet_ptr set, Path_ptr p);
 
+      /// forget our paths that their set expired, in one go
+      void
+      RemoveOwnPaths(const std::vector<Path_ptr>& paths);
+
       void
       RemovePathSet(PathSet_ptr set);
 
       using TransitHopsMap_t = std::unordered_multimap<PathID_t, TransitHop_ptr, PathID_t::Hash>;
 
-      struct SyncTransitMap_t
+      /// lookups take the shard shared so workers can find hops while logic reads too
+      /// only putting and expiring hops take it exclusively
+      struct alignas(64) SyncTransitMap_t
       {
-        using Mutex_t = util::NullMutex;
-        using Lock_t = util::NullLock;
+        using Mutex_t = util::Mutex;
+        using Lock_t = util::Lock;
+        using ReadLock_t = std::shared_lock<Mutex_t>;
 
-        Mutex_t first;  // protects second
+        mutable Mutex_t first;  // protects second
         TransitHopsMap_t second GUARDED_BY(first);
 
         void
-        ForEach(std::function<void(const TransitHop_ptr&)> visit) EXCLUDES(first)
+        ForEach(std::function<void(const TransitHop_ptr&)> visit) const EXCLUDES(first)
         {
-          Lock_t lock(first);
+          ReadLock_t lock(first);
           for (const auto& item : second)
             visit(item.second);
         }
@@ -163,12 +301,57 @@ namespace llarp
       uint64_t
       CurrentTransitPaths();
 
+      /// transit hops are partitioned by path id, each entry lives in the shard of its own key
+      static constexpr size_t NumTransitShards = 16;
+
+      /// visit every transit hop entry, which is every hop twice, once under each of its ids
+      void
+      ForEachTransitHop(std::function<void(const TransitHop_ptr&)> visit) const;
+
+      /// transit hop count and what their replay filters and gathers cost us
+      util::StatusObject
+      ExtractTransitStatus() const;
+
+      /// decay hop's replay filters once they would be stale if it stays quiet, so a hop that
+      /// went idle gives their memory back. logic thread
+      void
+      QueueIdleDecay(const TransitHop_ptr& hop);
+
      private:
+      SyncTransitMap_t&
+      TransitShard(const PathID_t& id);
+
       AbstractRouter* m_Router;
-      SyncTransitMap_t m_TransitPaths;
+      std::array<SyncTransitMap_t, NumTransitShards> m_TransitShards;
+      /// transit hops by when they expire, so expiring them never walks the shards
+      /// hops carry their own lifetime and go from here too, logic thread only
+      std::multimap<llarp_time_t, std::weak_ptr<TransitHop>> m_TransitExpiry;
+      /// transit hops that went quiet by when to decay their replay filters, logic thread only
+      std::multimap<llarp_time_t, std::weak_ptr<TransitHop>> m_TransitIdleDecay;
       SyncOwnedPathsMap_t m_OurPaths;
+      /// our paths by when they expire, for the ones whose set stopped expiring them, logic
+      /// thread only
+      std::multimap<llarp_time_t, std::weak_ptr<Path>> m_OwnExpiry;
+      /// hops with traffic waiting for the next pump, so pumping never walks idle paths
+      std::vector<HopHandler_ptr> m_PendingUpstream;
+      std::vector<HopHandler_ptr> m_PendingDownstream;
+      /// reused by the pumps so swapping the pending lists out doesn't allocate
+      std::vector<HopHandler_ptr> m_Pumping;
+      uint64_t m_HopsFlushed = 0;
+      uint64_t m_CellsShed = 0;
+      uint64_t m_BuildsShed = 0;
+      uint64_t m_BuildsBusy = 0;
+      llarp_time_t m_CellBatchDelay = 0s;
+      std::atomic<RelayLoad> m_OurLoad{0};
+      RelayLoads m_RelayLoads;
+      dht::RequestLimiter m_DHTRequests;
       bool m_AllowTransit;
       util::DecayingHashSet<IpAddress> m_PathLimits;
+      metrics::Counter& m_TransitHopsMetric;
+      metrics::Gauge& m_TransitPathsMetric;
+      metrics::Histogram& m_OnionWaitMetric;
+      metrics::Histogram& m_OnionCryptoMetric;
+      metrics::Histogram& m_BuildAcceptMetric;
     };
   }  // namespace path
 }  // namespace llarp
@@ -0,0 +1,106 @@
+#include <path/path_pool.hpp>
+
+#include <path/path.hpp>
+#include <router/abstractrouter.hpp>
+#include <util/time.hpp>
+
+namespace llarp
+{
+  namespace path
+  {
+    PathPool::PathPool(AbstractRouter* router, size_t low, size_t high, size_t hops)
+        : Builder(router, high, hops), m_Low(low), m_High(high)
+    {}
+
+    size_t
+    PathPool::NumUsable(llarp_time_t now) const
+    {
+      Lock_t l(m_PathsMutex);
+      size_t num = 0;
+      for (const auto& item : m_Paths)
+      {
+        if (item.second->IsReady() and not item.second->ExpiresSoon(now, MinLifetimeLeft))
+          ++num;
+      }
+      return num;
+    }
+
+    bool
+    PathPool::ShouldBuildMore(llarp_time_t now) const
+    {
+      // not PathSet::ShouldBuildMore, paths about to expire count as established there
+      if (IsStopped() or BuildCooldownHit(now))
+        return false;
+      if (m_router->NumberOfConnectedRouters() == 0)
+        return false;
+      const auto usable = NumUsable(now);
+      const auto building = NumInStatus(ePathBuilding);
+      if (usable < m_Low)
+        m_Refilling = true;
+      else if (usable + building >= m_High)
+        m_Refilling = false;
+      return m_Refilling and usable + building < m_High;
+    }
+
+    void
+    PathPool::HandlePathBuilt(Path_ptr p)
+    {
+      // the path is marked good in the profiles by whoever takes it, in Builder::HandlePathBuilt
+      buildIntervalLimit = MIN_PATH_BUILD_INTERVAL;
+      m_BuildStats.success++;
+      const auto took = Now() - p->buildStarted;
+      m_Built++;
+      m_BuildTimeTotal += took;
+      m_BuildTimeMax = std::max(m_BuildTimeMax, took);
+      LogDebug(Name(), " pooled ", p->ShortName(), " built in ", took);
+    }
+
+    Path_ptr
+    PathPool::Take(
+        PathSet& owner, size_t hops, const std::function<bool(const Path_ptr&)>& accept)
+    {
+      const auto now = Now();
+      Path_ptr taken;
+      {
+        Lock_t l(m_PathsMutex);
+        for (auto itr = m_Paths.begin(); itr != m_Paths.end(); ++itr)
+        {
+          const auto& p = itr->second;
+          if (not p->IsReady() or p->hops.size() != hops or p->ExpiresSoon(now, MinLifetimeLeft))
+            continue;
+          if (not accept(p))
+            continue;
+          taken = p;
+          m_Paths.erase(itr);
+          break;
+        }
+      }
+      if (taken == nullptr)
+      {
+        m_Misses++;
+        return nullptr;
+      }
+      m_Hits++;
+      // the path context finds a path's owner through this, so the move is complete here
+      taken->m_PathSet = &owner;
+      owner.AddPath(taken);
+      return taken;
+    }
+
+    util::StatusObject
+    PathPool::ExtractStatus() const
+    {
+      const auto now = Now();
+      auto obj = Builder::ExtractStatus();
+      obj["low"] = uint64_t{m_Low};
+      obj["high"] = uint64_t{m_High};
+      obj["usable"] = uint64_t{NumUsable(now)};
+      obj["hits"] = m_Hits;
+      obj["misses"] = m_Misses;
+      obj["built"] = m_Built;
+      obj["buildTimeAvg"] = to_json(m_Built ? m_BuildTimeTotal / m_Built : 0s);
+      obj["buildTimeMax"] = to_json(m_BuildTimeMax);
+      return obj;
+    }
+  }  // namespace path
+}  // namespace llarp
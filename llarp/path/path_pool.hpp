@@ -0,0 +1,88 @@
+#ifndef LLARP_PATH_POOL_HPP
+#define LLARP_PATH_POOL_HPP
+
+#include <path/pathbuilder.hpp>
+#include <util/status.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// router wide stock of generic paths built ahead of time, so a path set that needs a path
+    /// can take an established one instead of waiting out an LR commit round trip
+    struct PathPool : public Builder, public std::enable_shared_from_this<PathPool>
+    {
+      /// pooled paths with less than this left to live are not handed out
+      static constexpr auto MinLifetimeLeft = 2min;
+
+      /// once usable paths drop below low build back up to high
+      PathPool(AbstractRouter* router, size_t low, size_t high, size_t hops);
+
+      PathSet_ptr
+      GetSelf() override
+      {
+        return shared_from_this();
+      }
+
+      std::string
+      Name() const override
+      {
+        return "path-pool";
+      }
+
+      bool
+      ShouldBundleRC() const override
+      {
+        return false;
+      }
+
+      bool
+      ShouldBuildMore(llarp_time_t now) const override;
+
+      void
+      HandlePathBuilt(Path_ptr p) override;
+
+      /// dead pooled paths are never handed out and go when they expire
+      void
+      HandlePathDied(Path_ptr) override
+      {}
+
+      void
+      BlacklistSNode(const RouterID) override
+      {}
+
+      void
+      SendPacketToRemote(const llarp_buffer_t&) override
+      {}
+
+      /// move an established path with this many hops that accept likes over to owner
+      /// returns nullptr if there is none
+      Path_ptr
+      Take(PathSet& owner, size_t hops, const std::function<bool(const Path_ptr&)>& accept);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      /// established paths we would hand out
+      size_t
+      NumUsable(llarp_time_t now) const;
+
+      const size_t m_Low;
+      const size_t m_High;
+      /// set when we fall under the low watermark until we are back at the high one
+      mutable bool m_Refilling = true;
+      uint64_t m_Hits = 0;
+      uint64_t m_Misses = 0;
+      uint64_t m_Built = 0;
+      llarp_time_t m_BuildTimeTotal = 0s;
+      llarp_time_t m_BuildTimeMax = 0s;
+    };
+  }  // namespace path
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,60 @@
+#include <path/path_score.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    void
+    PathScore::AddLatencySample(llarp_time_t rtt)
+    {
+      const double sample = rtt.count();
+      if (m_LatencySamples++ == 0)
+        m_Latency = sample;
+      else
+        m_Latency += Alpha * (sample - m_Latency);
+    }
+
+    void
+    PathScore::Tick(llarp_time_t now, uint64_t bytes)
+    {
+      const auto sent = m_SentSinceTick;
+      const auto drops = m_DropsSinceTick;
+      m_SentSinceTick = 0;
+      m_DropsSinceTick = 0;
+      if (sent or drops)
+      {
+        // drops can be reported for frames sent before the last tick
+        const double sample = sent ? std::min(1.0, double(drops) / sent) : 1.0;
+        m_Loss += Alpha * (sample - m_Loss);
+      }
+      if (m_LastTick > 0s and now > m_LastTick)
+      {
+        const std::chrono::duration<double> dlt = now - m_LastTick;
+        m_Throughput += Alpha * (bytes / dlt.count() - m_Throughput);
+      }
+      m_LastTick = now;
+    }
+
+    double
+    PathScore::Cost() const
+    {
+      const double latency = HasLatency() ? std::max(m_Latency, 1.0) : UnknownLatency;
+      // a path that has carried bulk traffic well gets up to half off, so between two
+      // similar paths the proven one wins without throughput alone deciding
+      const double proven = std::min(1.0, m_Throughput / GoodThroughput) * (1.0 - m_Loss);
+      return latency * (1.0 + LossPenalty * m_Loss) / (1.0 + proven);
+    }
+
+    util::StatusObject
+    PathScore::ExtractStatus() const
+    {
+      return util::StatusObject{{"latency", m_Latency},
+                                {"loss", m_Loss},
+                                {"throughput", m_Throughput},
+                                {"sent", m_TotalSent},
+                                {"drops", m_TotalDrops}};
+    }
+  }  // namespace path
+}  // namespace llarp
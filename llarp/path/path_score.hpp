@@ -0,0 +1,108 @@
+#ifndef LLARP_PATH_PATH_SCORE_HPP
+#define LLARP_PATH_PATH_SCORE_HPP
+
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstdint>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// moving averages of how well a path carries traffic, fed from latency tests, data drop
+    /// notices and the bytes the path moves. only touched from the logic thread
+    struct PathScore
+    {
+      /// weight of a new sample, 1/8 as tcp uses for its smoothed rtt
+      static constexpr double Alpha = 0.125;
+      /// how much worse than its rtt a path that drops everything is
+      static constexpr double LossPenalty = 10.0;
+      /// throughput in bytes per second at which a path has shown it carries bulk traffic
+      static constexpr double GoodThroughput = 256.0 * 1024;
+      /// loss at which a path is not worth keeping
+      static constexpr double RetireLoss = 0.5;
+      /// frames a path must have been sent before its loss counts for retiring it
+      static constexpr uint64_t MinSentToRetire = 64;
+      /// rtt in ms we assume for a path that has not been measured yet
+      static constexpr double UnknownLatency = 1000.0;
+
+      void
+      AddLatencySample(llarp_time_t rtt);
+
+      /// a frame went up the path
+      void
+      AddSent()
+      {
+        m_SentSinceTick++;
+        m_TotalSent++;
+      }
+
+      /// the path endpoint told us it dropped a frame
+      void
+      AddDrop()
+      {
+        m_DropsSinceTick++;
+        m_TotalDrops++;
+      }
+
+      /// fold in what happened since the last tick, bytes is what the path moved in that time
+      void
+      Tick(llarp_time_t now, uint64_t bytes);
+
+      bool
+      HasLatency() const
+      {
+        return m_LatencySamples > 0;
+      }
+
+      /// smoothed rtt in ms
+      double
+      Latency() const
+      {
+        return m_Latency;
+      }
+
+      /// smoothed fraction of frames dropped
+      double
+      Loss() const
+      {
+        return m_Loss;
+      }
+
+      /// smoothed bytes per second
+      double
+      Throughput() const
+      {
+        return m_Throughput;
+      }
+
+      /// roughly the ms it takes to get a frame through, lower is better
+      double
+      Cost() const;
+
+      /// true if the path drops enough of what we send that a fresh one would do better
+      bool
+      ShouldRetire() const
+      {
+        return m_TotalSent >= MinSentToRetire and m_Loss >= RetireLoss;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      double m_Latency = 0;
+      double m_Loss = 0;
+      double m_Throughput = 0;
+      uint64_t m_LatencySamples = 0;
+      uint64_t m_SentSinceTick = 0;
+      uint64_t m_DropsSinceTick = 0;
+      uint64_t m_TotalSent = 0;
+      uint64_t m_TotalDrops = 0;
+      llarp_time_t m_LastTick = 0s;
+    };
+  }  // namespace path
+}  // namespace llarp
+
+#endif
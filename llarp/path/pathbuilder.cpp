@@ -1,15 +1,21 @@
 #include <path/pathbuilder.hpp>
 
+#include <consensus/table.hpp>
 #include <crypto/crypto.hpp>
+#include <link/i_link_manager.hpp>
 #include <messages/relay_commit.hpp>
 #include <nodedb.hpp>
 #include <path/path_context.hpp>
+#include <path/path_pool.hpp>
 #include <profiling.hpp>
 #include <router/abstractrouter.hpp>
+#include <router/i_outbound_session_maker.hpp>
+#include <router/i_rc_lookup_handler.hpp>
 #include <util/buffer.hpp>
 #include <util/thread/logic.hpp>
 #include <tooling/path_event.hpp>
 
+#include <atomic>
 #include <functional>
 
 namespace llarp
@@ -25,14 +31,19 @@ namespace llarp
     using Handler = std::function<void(std::shared_ptr<AsyncPathKeyExchangeContext>)>;
 
     Handler result;
-    size_t idx = 0;
     AbstractRouter* router = nullptr;
     WorkerFunc_t work;
     std::shared_ptr<Logic> logic;
     LR_CommitMessage LRCM;
 
-    void
-    GenerateNextKey()
+    /// hops left to generate keys for, whoever finishes the last one hands the result to logic
+    std::atomic<size_t> pending{0};
+    std::atomic<bool> failed{false};
+
+    /// generate keys and the commit record for one hop
+    /// a hop only needs its own keys and the next hop's rc so all hops are done at once
+    bool
+    GenerateKeysFor(size_t idx)
     {
       // current hop
       auto& hop = path->hops[idx];
@@ -41,19 +52,18 @@ namespace llarp
       auto crypto = CryptoManager::instance();
 
       // generate key
-      crypto->encryption_keygen(hop.commkey);
+      router->GenerateEphemeralKey(hop.commkey);
       hop.nonce.Randomize();
       // do key exchange
       if (!crypto->dh_client(hop.shared, hop.rc.enckey, hop.commkey, hop.nonce))
       {
         LogError(pathset->Name(), " Failed to generate shared key for path build");
-        return;
+        return false;
       }
       // generate nonceXOR valueself->hop->pathKey
       crypto->shorthash(hop.nonceXOR, llarp_buffer_t(hop.shared));
-      ++idx;
 
-      bool isFarthestHop = idx == path->hops.size();
+      const bool isFarthestHop = idx + 1 == path->hops.size();
 
       LR_CommitRecord record;
       if (isFarthestHop)
@@ -62,8 +72,8 @@ namespace llarp
       }
       else
       {
-        hop.upstream = path->hops[idx].rc.pubkey;
-        record.nextRC = std::make_unique<RouterContact>(path->hops[idx].rc);
+        hop.upstream = path->hops[idx + 1].rc.pubkey;
+        record.nextRC = std::make_unique<RouterContact>(path->hops[idx + 1].rc);
       }
       // build record
       record.lifetime = path::default_lifetime;
@@ -73,6 +83,11 @@ namespace llarp
       record.tunnelNonce = hop.nonce;
       record.nextHop = hop.upstream;
       record.commkey = seckey_topublic(hop.commkey);
+      // a hop too old for it pads as it always did
+      if (hop.rc.routerVersion and hop.rc.routerVersion->IsAtLeast(PaddingPolicyVersion))
+        record.padding = path->padding;
+      record.wantLoad =
+          hop.rc.routerVersion and hop.rc.routerVersion->IsAtLeast(LoadReportVersion);
 
       llarp_buffer_t buf(frame.data(), frame.size());
       buf.cur = buf.base + EncryptedFrameOverheadSize;
@@ -82,28 +97,28 @@ namespace llarp
         // failed to encode?
         LogError(pathset->Name(), " Failed to generate Commit Record");
         DumpBuffer(buf);
-        return;
+        return false;
       }
       // use ephemeral keypair for frame
       SecretKey framekey;
-      crypto->encryption_keygen(framekey);
+      router->GenerateEphemeralKey(framekey);
       if (!frame.EncryptInPlace(framekey, hop.rc.enckey))
       {
         LogError(pathset->Name(), " Failed to encrypt LRCR");
-        return;
+        return false;
       }
+      return true;
+    }
 
-      if (isFarthestHop)
-      {
-        // farthest hop
-        // TODO: encrypt junk frames because our public keys are not eligator
-        LogicCall(logic, std::bind(result, shared_from_this()));
-      }
-      else
-      {
-        // next hop
-        work(std::bind(&AsyncPathKeyExchangeContext::GenerateNextKey, shared_from_this()));
-      }
+    void
+    GenerateHop(size_t idx)
+    {
+      if (not GenerateKeysFor(idx))
+        failed = true;
+      if (pending.fetch_sub(1) != 1 or failed)
+        return;
+      // TODO: encrypt junk frames because our public keys are not eligator
+      LogicCall(logic, std::bind(result, shared_from_this()));
     }
 
     /// Generate all keys asynchronously and call handler when done
@@ -119,7 +134,9 @@ namespace llarp
       {
         LRCM.frames[i].Randomize();
       }
-      work(std::bind(&AsyncPathKeyExchangeContext::GenerateNextKey, shared_from_this()));
+      pending = path->hops.size();
+      for (size_t idx = 0; idx < path->hops.size(); ++idx)
+        work(std::bind(&AsyncPathKeyExchangeContext::GenerateHop, shared_from_this(), idx));
     }
   };
 
@@ -173,8 +190,11 @@ namespace llarp
     {
       const auto now = llarp::time_now_ms();
       ExpirePaths(now, m_router);
+      RetirePoorPaths(now);
       if (ShouldBuildMore(now))
         BuildOne();
+      else
+        BuildAlongsideLate(now);
       TickPaths(m_router);
       if (m_BuildStats.attempts > 50)
       {
@@ -191,7 +211,9 @@ namespace llarp
     {
       util::StatusObject obj{{"buildStats", m_BuildStats.ExtractStatus()},
                              {"numHops", uint64_t(numHops)},
-                             {"numPaths", uint64_t(numPaths)}};
+                             {"numPaths", uint64_t(numPaths)},
+                             {"padding", padding::ToString(padding)},
+                             {"buildTimes", m_BuildTimes.ExtractStatus()}};
       std::transform(
           m_Paths.begin(),
           m_Paths.end(),
@@ -236,6 +258,28 @@ namespace llarp
         return got;
       }
 
+      // relays that said they are busy are passed over in proportion to how busy
+      const auto& loads = m_router->pathContext().RelayLoadReports();
+      const auto now = m_router->Now();
+      // with lokid's list, drawn by weight from the table without a nodedb scan
+      const auto table = m_router->rcLookupHandler().ConsensusTable();
+      if (not table->Empty())
+      {
+        for (size_t draws = 0; draws < tries; ++draws)
+        {
+          const auto& picked = table->Pick();
+          if (exclude.count(picked) or m_router->routerProfiling().IsBadForPath(picked))
+            continue;
+          if (not loads.Accept(picked, now, randint()))
+            continue;
+          if (const auto rc = db->GetShared(picked); rc and rc->IsPublicRouter())
+          {
+            cur = *rc;
+            return true;
+          }
+        }
+      }
+
       do
       {
         cur.Clear();
@@ -244,7 +288,8 @@ namespace llarp
         if (db->select_random_hop_excluding(cur, excluding))
         {
           excluding.insert(cur.pubkey);
-          if (!m_router->routerProfiling().IsBadForPath(cur.pubkey))
+          if (!m_router->routerProfiling().IsBadForPath(cur.pubkey)
+              and loads.Accept(cur.pubkey, now, randint()))
             return true;
         }
       } while (tries > 0);
@@ -290,17 +335,73 @@ namespace llarp
         return false;
       if (BuildCooldownHit(now))
         return false;
+      if (m_router->IsIdle())
+        return NumInStatus(ePathBuilding) == 0
+            and NumInStatus(ePathEstablished) < std::min(numPaths, idle_min_paths);
       return PathSet::ShouldBuildMore(now);
     }
 
+    bool
+    Builder::TakePooledPaths()
+    {
+      auto pool = m_router->pathPool();
+      if (pool == nullptr or pool == this or not UsesPathPool())
+        return false;
+      // the pool builds its paths padded as the default has them
+      const auto accept = [this](const Path_ptr& p) -> bool {
+        return p->padding == padding and AcceptPooledPath(p);
+      };
+      size_t taken = 0;
+      // fill up to what we want established in one go, that is the wait the pool is there to cut
+      while (NumInStatus(ePathEstablished) < numPaths)
+      {
+        auto path = pool->Take(*this, numHops, accept);
+        if (path == nullptr)
+          break;
+        LogInfo(Name(), " took ", path->ShortName(), " from the path pool");
+        m_BuildStats.attempts++;
+        HandlePathBuilt(path);
+        ++taken;
+      }
+      if (taken == 0)
+        return false;
+      lastBuild = Now();
+      return true;
+    }
+
     void
     Builder::BuildOne(PathRole roles)
     {
+      if (roles == ePathRoleAny and TakePooledPaths())
+        return;
       std::vector<RouterContact> hops(numHops);
       if (SelectHops(m_router->nodedb(), hops, roles))
         Build(hops, roles);
     }
 
+    bool
+    Builder::BuildAlongsideLate(llarp_time_t now)
+    {
+      if (IsStopped() or BuildCooldownHit(now) or m_router->IsIdle())
+        return false;
+      if (NumInStatus(ePathEstablished) >= numPaths)
+        return false;
+      Path_ptr late;
+      ForEachPath([now, &late](const Path_ptr& p) {
+        if (late == nullptr and p->Status() == ePathBuilding and not p->speculated
+            and p->buildStarted > 0s and now >= p->buildStarted + p->buildLateAfter)
+          late = p;
+      });
+      if (late == nullptr)
+        return false;
+      // the late one is left to finish or time out, whichever of the two comes in first is used
+      late->speculated = true;
+      LogInfo(Name(), " ", late->ShortName(), " is running late, building another alongside it");
+      m_BuildStats.speculative++;
+      BuildOne();
+      return true;
+    }
+
     bool Builder::UrgentBuild(llarp_time_t) const
     {
       return buildIntervalLimit > MIN_PATH_BUILD_INTERVAL * 4;
@@ -436,9 +537,38 @@ namespace llarp
       std::string path_shortName = "[path " + m_router->ShortName() + "-";
       path_shortName = path_shortName + std::to_string(m_router->NextPathBuildNumber()) + "]";
       auto path = std::make_shared<path::Path>(hops, self.get(), roles, std::move(path_shortName));
-      LogInfo(Name(), " build ", path->ShortName(), ": ", path->HopsString());
-
-      path->SetBuildResultHook([self](Path_ptr p) { self->HandlePathBuilt(p); });
+      path->padding = padding;
+      {
+        std::optional<llarp_time_t> firstHopRTT = m_router->linkManager().RTTTo(hops[0].pubkey);
+        size_t unknownHops = 0;
+        for (const auto& hop : hops)
+        {
+          if (not m_router->routerProfiling().HasPathHistory(hop.pubkey))
+            ++unknownHops;
+        }
+        path->buildTimeout = m_BuildTimes.Timeout(hops.size(), firstHopRTT, unknownHops);
+        path->buildLateAfter = m_BuildTimes.LateAfter(path->buildTimeout);
+      }
+      LogInfo(
+          Name(),
+          " build ",
+          path->ShortName(),
+          ": ",
+          path->HopsString(),
+          " timeout=",
+          path->buildTimeout);
+
+      // only builds of our own are timed, not paths taken from the pool
+      // self keeps this alive
+      path->SetBuildResultHook([self, this](Path_ptr p) {
+        m_BuildTimes.Observe(Now() - p->buildStarted);
+        self->HandlePathBuilt(p);
+      });
+      // start the handshake with a first hop we have no session to now, so it runs while the
+      // keys are made instead of after, when the commit goes out
+      if (not m_router->linkManager().HasSessionTo(hops[0].pubkey)
+          and not m_router->outboundSessionMaker().HavePendingSessionTo(hops[0].pubkey))
+        m_router->outboundSessionMaker().CreateSessionTo(hops[0], nullptr);
       ctx->AsyncGenerateKeys(
           path,
           m_router->logic(),
@@ -1,7 +1,9 @@
 #ifndef LLARP_PATHBUILDER_HPP
 #define LLARP_PATHBUILDER_HPP
 
+#include <path/build_time.hpp>
 #include <path/pathset.hpp>
+#include <util/padding.hpp>
 #include <util/status.hpp>
 
 #include <atomic>
@@ -26,6 +28,21 @@ namespace llarp
       virtual bool
       UrgentBuild(llarp_time_t now) const;
 
+      /// should BuildOne try the router's path pool before building
+      /// only for path sets whose hop selection has no constraints a generic path could break
+      virtual bool
+      UsesPathPool() const
+      {
+        return false;
+      }
+
+      /// would we take this pooled path
+      virtual bool
+      AcceptPooledPath(const Path_ptr&) const
+      {
+        return true;
+      }
+
      private:
       void
       DoPathBuildBackoff();
@@ -36,12 +53,20 @@ namespace llarp
       bool
       DoBuildAlignedTo(const RouterID remote, std::vector<RouterContact>& hops);
 
+      /// take established paths from the path pool, return false if we got none
+      bool
+      TakePooledPaths();
+
      public:
       AbstractRouter* m_router;
       SecretKey enckey;
       size_t numHops;
+      /// what the paths we build pad their cells to, both ways
+      padding::Profile padding = padding::DefaultProfile;
       llarp_time_t lastBuild = 0s;
       llarp_time_t buildIntervalLimit = MIN_PATH_BUILD_INTERVAL;
+      /// how long our builds take, for their timeouts
+      BuildTimeEstimator m_BuildTimes;
 
       /// construct
       Builder(AbstractRouter* p_router, size_t numPaths, size_t numHops);
@@ -104,6 +129,11 @@ namespace llarp
       void
       BuildOne(PathRole roles = ePathRoleAny) override;
 
+      /// start another build if one is running late and we are short of paths, returns true
+      /// if it did
+      bool
+      BuildAlongsideLate(llarp_time_t now);
+
       bool
       BuildOneAlignedTo(const RouterID endpoint) override;
 
@@ -3,14 +3,47 @@
 #include <dht/messages/pubintro.hpp>
 #include <path/path.hpp>
 #include <routing/dht_message.hpp>
+#include <path/path_context.hpp>
 #include <router/abstractrouter.hpp>
 
+#include <algorithm>
 #include <random>
 
 namespace llarp
 {
   namespace path
   {
+    /// paths cost this many times the best one before they are retired for being slow
+    static constexpr double SlowPathFactor = 4.0;
+
+    /// pick one of paths with odds in proportion to how cheaply each gets frames through,
+    /// leaving out backed up paths unless every one is
+    static Path_ptr
+    PickByScore(const std::vector<Path_ptr>& paths)
+    {
+      if (paths.empty())
+        return nullptr;
+      const bool anyClear = std::any_of(
+          paths.begin(), paths.end(), [](const auto& path) { return not path->IsBackedUp(); });
+      std::vector<double> weights;
+      weights.reserve(paths.size());
+      double total = 0;
+      for (const auto& path : paths)
+      {
+        weights.emplace_back(anyClear and path->IsBackedUp() ? 0.0 : 1.0 / path->Cost());
+        total += weights.back();
+      }
+      // top 53 bits of randint as a double in [0, 1)
+      double pick = total * double(randint() >> 11) / double(uint64_t{1} << 53);
+      for (size_t idx = 0; idx < paths.size(); ++idx)
+      {
+        if (pick < weights[idx])
+          return paths[idx];
+        pick -= weights[idx];
+      }
+      return paths.back();
+    }
+
     PathSet::PathSet(size_t num) : numPaths(num)
     {}
 
@@ -76,19 +109,80 @@ namespace llarp
     void
     PathSet::ExpirePaths(llarp_time_t now, AbstractRouter* router)
     {
-      Lock_t l(m_PathsMutex);
-      if (m_Paths.size() == 0)
-        return;
-      auto itr = m_Paths.begin();
-      while (itr != m_Paths.end())
+      std::vector<Path_ptr> expired;
       {
-        if (itr->second->Expired(now))
+        Lock_t l(m_PathsMutex);
+        const auto expire = [&](const Path_ptr& path) {
+          auto itr = m_Paths.find({path->Upstream(), path->RXID()});
+          if (itr == m_Paths.end() or itr->second != path)
+            return;
+          m_Paths.erase(itr);
+          expired.emplace_back(path);
+        };
+        for (const auto& path : m_Expiring)
+        {
+          if (path->Expired(now))
+            expire(path);
+        }
+        m_Expiring.clear();
+        while (not m_Expiry.empty() and m_Expiry.begin()->first <= now)
         {
-          router->outboundMessageHandler().QueueRemoveEmptyPath(itr->second->TXID());
-          itr = m_Paths.erase(itr);
+          auto path = m_Expiry.begin()->second.lock();
+          m_Expiry.erase(m_Expiry.begin());
+          if (path == nullptr)
+            continue;
+          if (path->Expired(now))
+            expire(path);
+          else
+            m_Expiry.emplace(now + ExpiryRecheckInterval, path);
         }
-        else
-          ++itr;
+      }
+      if (expired.empty())
+        return;
+      for (const auto& path : expired)
+        router->outboundMessageHandler().QueueRemoveEmptyPath(path->TXID());
+      router->pathContext().RemoveOwnPaths(expired);
+    }
+
+    void
+    PathSet::PathExpiring(Path_ptr path)
+    {
+      Lock_t l(m_PathsMutex);
+      m_Expiring.emplace_back(std::move(path));
+    }
+
+    void
+    PathSet::RetirePoorPaths(llarp_time_t now)
+    {
+      Lock_t l(m_PathsMutex);
+      Path_ptr best;
+      Path_ptr worst;
+      size_t ready = 0;
+      for (const auto& item : m_Paths)
+      {
+        const auto& path = item.second;
+        if (not path->IsReady())
+          continue;
+        ready++;
+        if (best == nullptr or path->Cost() < best->Cost())
+          best = path;
+        if (worst == nullptr or path->Cost() > worst->Cost())
+          worst = path;
+      }
+      // never leave ourselves without a path, and retire one per tick so the builder keeps up
+      if (ready < 2)
+        return;
+      if (worst->Score().ShouldRetire() or worst->Cost() > best->Cost() * SlowPathFactor)
+      {
+        LogInfo(
+            Name(),
+            " retiring ",
+            worst->Name(),
+            " early, cost ",
+            worst->Cost(),
+            " against best ",
+            best->Cost());
+        worst->EnterState(ePathExpired, now);
       }
     }
 
@@ -151,9 +245,12 @@ namespace llarp
         {
           if (itr->second->Endpoint() == id)
           {
-            if (chosen == nullptr)
+            // a path that is not backed up beats any that is
+            if (chosen == nullptr or chosen->IsBackedUp() > itr->second->IsBackedUp())
               chosen = itr->second;
-            else if (chosen->intro.latency > itr->second->intro.latency)
+            else if (
+                chosen->IsBackedUp() == itr->second->IsBackedUp()
+                and chosen->Cost() > itr->second->Cost())
               chosen = itr->second;
           }
         }
@@ -179,14 +276,7 @@ namespace llarp
         }
         ++itr;
       }
-      if (chosen.empty())
-        return nullptr;
-      size_t idx = 0;
-      if (chosen.size() >= 2)
-      {
-        idx = rand() % chosen.size();
-      }
-      return chosen[idx];
+      return PickByScore(chosen);
     }
 
     Path_ptr
@@ -249,6 +339,15 @@ namespace llarp
       return count;
     }
 
+    size_t
+    PathSet::NumBackedUp() const
+    {
+      Lock_t l(m_PathsMutex);
+      return std::count_if(m_Paths.begin(), m_Paths.end(), [](const auto& item) {
+        return item.second->Status() == ePathEstablished and item.second->IsBackedUp();
+      });
+    }
+
     void
     PathSet::AddPath(Path_ptr path)
     {
@@ -263,7 +362,9 @@ namespace llarp
             upstream,
             " rxid=",
             RXID);
+        return;
       }
+      m_Expiry.emplace(path->ExpireTime(), path);
     }
 
     void
@@ -347,8 +448,11 @@ namespace llarp
     util::StatusObject
     BuildStats::ExtractStatus() const
     {
-      return util::StatusObject{
-          {"success", success}, {"attempts", attempts}, {"timeouts", timeouts}, {"fails", fails}};
+      return util::StatusObject{{"success", success},
+                                {"attempts", attempts},
+                                {"timeouts", timeouts},
+                                {"fails", fails},
+                                {"speculative", speculative}};
     }
 
     std::string
@@ -359,7 +463,8 @@ namespace llarp
       ss << "(success=" << success << " ";
       ss << "attempts=" << attempts << " ";
       ss << "timeouts=" << timeouts << " ";
-      ss << "fails=" << fails << ")";
+      ss << "fails=" << fails << " ";
+      ss << "speculative=" << speculative << ")";
       return ss.str();
     }
 
@@ -402,13 +507,7 @@ namespace llarp
           established.push_back(itr->second);
         ++itr;
       }
-      auto sz = established.size();
-      if (sz)
-      {
-        return established[randint() % sz];
-      }
-
-      return nullptr;
+      return PickByScore(established);
     }
 
     void
@@ -40,6 +40,9 @@ namespace llarp
       ePathExpired
     };
 
+    /// how long until we look again at a path that is past its expiry time but not expired yet
+    static constexpr auto ExpiryRecheckInterval = 10s;
+
     /// Stats about all our path builds
     struct BuildStats
     {
@@ -49,6 +52,8 @@ namespace llarp
       uint64_t success = 0;
       uint64_t fails = 0;
       uint64_t timeouts = 0;
+      /// builds started alongside one that was running late
+      uint64_t speculative = 0;
 
       util::StatusObject
       ExtractStatus() const;
@@ -147,13 +152,28 @@ namespace llarp
       Path_ptr
       GetByUpstream(RouterID remote, PathID_t rxid) const;
 
+      /// drop the paths that expired, only looking at ones due by their expiry time and ones
+      /// that went PathExpiring since the last call
       void
       ExpirePaths(llarp_time_t now, AbstractRouter* router);
 
+      /// a path of ours failed or was retired before its time, the next ExpirePaths drops it
+      void
+      PathExpiring(Path_ptr path);
+
+      /// expire the worst ready path if it drops most of what we send or costs far more than
+      /// the best one, so it gets replaced before it would have expired
+      void
+      RetirePoorPaths(llarp_time_t now);
+
       /// get the number of paths in this status
       size_t
       NumInStatus(PathStatus st) const;
 
+      /// get the number of established paths that are backed up
+      size_t
+      NumBackedUp() const;
+
       /// get the number of paths that match the role that are available
       size_t
       AvailablePaths(PathRole role) const;
@@ -228,15 +248,19 @@ namespace llarp
       Path_ptr
       GetEstablishedPathClosestTo(RouterID router, PathRole roles = ePathRoleAny) const;
 
+      /// ready paths are picked with odds in proportion to their score, so traffic spread
+      /// over them leans towards the faster ones
       Path_ptr
       PickRandomEstablishedPath(PathRole roles = ePathRoleAny) const;
 
+      /// the best scoring ready path to router
       Path_ptr
       GetPathByRouter(RouterID router, PathRole roles = ePathRoleAny) const;
 
       Path_ptr
       GetNewestPathByRouter(RouterID router, PathRole roles = ePathRoleAny) const;
 
+      /// a ready path to router, picked by score as PickRandomEstablishedPath does
       Path_ptr
       GetRandomPathByRouter(RouterID router, PathRole roles = ePathRoleAny) const;
 
@@ -329,6 +353,9 @@ namespace llarp
       using PathMap_t = std::unordered_map<PathInfo_t, Path_ptr, PathInfoHash, PathInfoEquals>;
       mutable Mtx_t m_PathsMutex;
       PathMap_t m_Paths;
+      /// our paths by when they expire
+      std::multimap<llarp_time_t, std::weak_ptr<Path>> m_Expiry;
+      std::vector<Path_ptr> m_Expiring;
     };
 
   }  // namespace path
@@ -0,0 +1,71 @@
+#include <path/relay_load.hpp>
+
+#include <algorithm>
+#include <shared_mutex>
+
+namespace llarp
+{
+  namespace path
+  {
+    RelayLoad
+    ToRelayLoad(double fill)
+    {
+      if (not(fill > 0.0))
+        return 0;
+      const auto level = static_cast<uint64_t>(fill * (MaxRelayLoad + 1));
+      return std::min<uint64_t>(level, MaxRelayLoad);
+    }
+
+    void
+    RelayLoads::Put(const RouterID& relay, RelayLoad load, llarp_time_t now)
+    {
+      util::Lock lock(m_Mutex);
+      m_Reports[relay] = Report{std::min(load, MaxRelayLoad), now};
+    }
+
+    std::optional<RelayLoad>
+    RelayLoads::Get(const RouterID& relay, llarp_time_t now) const
+    {
+      std::shared_lock lock(m_Mutex);
+      const auto itr = m_Reports.find(relay);
+      if (itr == m_Reports.end() or now >= itr->second.at + ReportLifetime)
+        return std::nullopt;
+      return itr->second.load;
+    }
+
+    bool
+    RelayLoads::Accept(const RouterID& relay, llarp_time_t now, uint64_t random) const
+    {
+      const auto load = Get(relay, now);
+      if (not load)
+        return true;
+      return random % (MaxRelayLoad + 1) >= *load;
+    }
+
+    void
+    RelayLoads::Expire(llarp_time_t now)
+    {
+      util::Lock lock(m_Mutex);
+      for (auto itr = m_Reports.begin(); itr != m_Reports.end();)
+      {
+        if (now >= itr->second.at + ReportLifetime)
+          itr = m_Reports.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    util::StatusObject
+    RelayLoads::ExtractStatus() const
+    {
+      std::shared_lock lock(m_Mutex);
+      uint64_t loaded = 0;
+      for (const auto& item : m_Reports)
+      {
+        if (item.second.load > MaxRelayLoad / 2)
+          ++loaded;
+      }
+      return util::StatusObject{{"reports", uint64_t(m_Reports.size())}, {"loaded", loaded}};
+    }
+  }  // namespace path
+}  // namespace llarp
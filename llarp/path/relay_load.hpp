@@ -0,0 +1,67 @@
+#ifndef LLARP_PATH_RELAY_LOAD_HPP
+#define LLARP_PATH_RELAY_LOAD_HPP
+
+#include <router_id.hpp>
+#include <util/status.hpp>
+#include <util/thread/threading.hpp>
+#include <util/time.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// how busy a relay says it is in the build status records it writes, from 0 for idle to
+    /// MaxRelayLoad for saturated. kept coarse so it says little about the traffic through it
+    using RelayLoad = uint8_t;
+
+    static constexpr RelayLoad MaxRelayLoad = 7;
+
+    /// the load level of a relay whose busiest queue is fill full, fill from 0 to 1
+    RelayLoad
+    ToRelayLoad(double fill);
+
+    /// the loads relays reported in the builds we made through them, for picking hops away
+    /// from the busy ones. written from the workers decrypting build status, read by the
+    /// builders on the logic thread
+    struct RelayLoads
+    {
+      /// a report older than this is taken as no report
+      static constexpr auto ReportLifetime = 10min;
+
+      void
+      Put(const RouterID& relay, RelayLoad load, llarp_time_t now) EXCLUDES(m_Mutex);
+
+      std::optional<RelayLoad>
+      Get(const RouterID& relay, llarp_time_t now) const EXCLUDES(m_Mutex);
+
+      /// whether to keep relay when picked as a hop, drawn with random. a relay with no recent
+      /// report is always kept and one at MaxRelayLoad kept one time in MaxRelayLoad + 1, so
+      /// load spreads out without any relay being left out altogether
+      bool
+      Accept(const RouterID& relay, llarp_time_t now, uint64_t random) const EXCLUDES(m_Mutex);
+
+      /// forget reports past ReportLifetime
+      void
+      Expire(llarp_time_t now) EXCLUDES(m_Mutex);
+
+      util::StatusObject
+      ExtractStatus() const EXCLUDES(m_Mutex);
+
+     private:
+      struct Report
+      {
+        RelayLoad load = 0;
+        llarp_time_t at = 0s;
+      };
+
+      mutable util::Mutex m_Mutex;  // protects m_Reports
+      std::unordered_map<RouterID, Report, RouterID::Hash> m_Reports GUARDED_BY(m_Mutex);
+    };
+  }  // namespace path
+}  // namespace llarp
+
+#endif
@@ -1,5 +1,6 @@
 #include <path/path.hpp>
 
+#include <crypto/hot_crypto.hpp>
 #include <dht/context.hpp>
 #include <exit/context.hpp>
 #include <exit/exit_messages.hpp>
@@ -10,11 +11,16 @@
 #include <path/path_context.hpp>
 #include <path/transit_hop.hpp>
 #include <router/abstractrouter.hpp>
+#include <router/i_outbound_message_handler.hpp>
 #include <routing/path_latency_message.hpp>
 #include <routing/path_transfer_message.hpp>
 #include <routing/handler.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/buffer.hpp>
 #include <util/endian.hpp>
+#include <util/tracy.hpp>
+
+#include <thread>
 
 namespace llarp
 {
@@ -32,14 +38,7 @@ namespace llarp
       return stream;
     }
 
-    TransitHop::TransitHop()
-        : m_UpstreamGather(transit_hop_queue_size), m_DownstreamGather(transit_hop_queue_size)
-    {
-      m_UpstreamGather.enable();
-      m_DownstreamGather.enable();
-      m_UpstreamWorkCounter = 0;
-      m_DownstreamWorkCounter = 0;
-    }
+    TransitHop::TransitHop() = default;
 
     bool
     TransitHop::Expired(llarp_time_t now) const
@@ -64,7 +63,7 @@ namespace llarp
       // TODO: add to IHopHandler some notion of "path status"
 
       const uint64_t ourStatus = LR_StatusRecord::SUCCESS;
-      if (!msg->AddFrame(pathKey, ourStatus))
+      if (!msg->AddFrame(pathKey, ourStatus, LoadReport(r)))
       {
         return false;
       }
@@ -83,6 +82,14 @@ namespace llarp
       return true;
     }
 
+    std::optional<RelayLoad>
+    TransitHop::LoadReport(AbstractRouter* r) const
+    {
+      if (not reportLoad)
+        return std::nullopt;
+      return r->pathContext().OurLoad();
+    }
+
     TransitHopInfo::TransitHopInfo(const RouterID& down, const LR_CommitRecord& record)
         : txID(record.txid), rxID(record.rxid), upstream(record.nextHop), downstream(down)
     {}
@@ -100,91 +107,215 @@ namespace llarp
         llarp::LogError("failed to encode routing message");
         return false;
       }
-      TunnelNonce N;
-      N.Randomize();
       buf.sz = buf.cur - buf.base;
-      // pad to nearest MESSAGE_PAD_SIZE bytes
-      auto dlt = buf.sz % pad_size;
-      if (dlt)
+      buf.cur = buf.base;
+      if (m_DownstreamBatch.Batchable(buf))
       {
-        dlt = pad_size - dlt;
-        // randomize padding
-        CryptoManager::instance()->randbytes(buf.cur, dlt);
-        buf.sz += dlt;
+        const bool first = m_DownstreamBatch.Empty();
+        if (not m_DownstreamBatch.Add(buf, r->Now()))
+        {
+          SendBatch(r);
+          m_DownstreamBatch.Add(buf, r->Now());
+        }
+        // goes out from FlushDownstream on the next pump at the earliest
+        if (first)
+          r->pathContext().QueueDownstreamFlush(HopHandlerPtr());
+        return true;
       }
+      // anything batched was sent before this
+      if (not m_DownstreamBatch.Empty())
+        SendBatch(r);
+      return SendCell(buf, r);
+    }
+
+    bool
+    TransitHop::SendCell(llarp_buffer_t& buf, AbstractRouter* r)
+    {
+      TunnelNonce N;
+      N.Randomize();
+      // every caller encodes into MAX_LINK_MSG_SIZE - 128 bytes
+      const auto pad = padding::CellPadding(padding, buf.sz, MAX_LINK_MSG_SIZE - 128);
+      if (pad)
+        HotCrypto()->randbytes(buf.base + buf.sz, pad);
+      padding::CountCell(buf.sz, pad);
+      buf.sz += pad;
       buf.cur = buf.base;
       return HandleDownstream(buf, N, r);
     }
 
+    bool
+    TransitHop::SendBatch(AbstractRouter* r)
+    {
+      routing::BatchMessage batch;
+      m_DownstreamBatch.Take(batch);
+      std::array<byte_t, MAX_LINK_MSG_SIZE - 128> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not batch.BEncode(&buf))
+      {
+        llarp::LogError("failed to encode batch of ", batch.M.size(), " routing messages");
+        return false;
+      }
+      buf.sz = buf.cur - buf.base;
+      return SendCell(buf, r);
+    }
+
+    bool
+    TransitHop::HandleBatchMessage(const routing::BatchMessage&, AbstractRouter*)
+    {
+      // the client sent us a batch so it can take them back too
+      m_DownstreamBatch.enabled = true;
+      return true;
+    }
+
+    void
+    TransitHop::CryptBatch(TrafficQueue_t& msgs)
+    {
+      std::vector<CryptoSpan> spans;
+      std::vector<TunnelNonce> nonces;
+      spans.reserve(msgs.size());
+      nonces.reserve(msgs.size());
+      for (auto& ev : msgs)
+      {
+        spans.push_back({ev.first.data(), ev.first.size()});
+        nonces.push_back(ev.second);
+      }
+      HotCrypto()->xchacha20_batch(
+          spans.data(), nonces.data(), spans.size(), pathKey);
+    }
+
+    /// hand a decrypted batch to the logic thread through gather in as few pushes as fit,
+    /// making room by flushing whenever it fills up. the last flush is told it is the last
+    template <typename Flush_t>
+    static void
+    GatherAndFlush(
+        thread::SpscQueue<IHopHandler::TrafficEvent_t>& gather,
+        std::vector<IHopHandler::TrafficEvent_t>& batch,
+        AbstractRouter* r,
+        const Flush_t& flushIt)
+    {
+      size_t pushed = 0;
+      for (;;)
+      {
+        pushed += gather.tryPushBack(batch.data() + pushed, batch.size() - pushed);
+        if (pushed == batch.size() or not gather.enabled())
+          break;
+        LogicCall(r->logic(), [flushIt]() { flushIt(false); });
+        while (gather.full() and gather.enabled())
+          std::this_thread::yield();
+      }
+      LogicCall(r->logic(), [flushIt]() { flushIt(true); });
+    }
+
+    /// turn what the worker left in gather into relay messages for pathid, which view the
+    /// cells left in events rather than copy them
+    template <typename Msg_t>
+    static std::vector<Msg_t>
+    DrainGather(
+        thread::SpscQueue<IHopHandler::TrafficEvent_t>& gather,
+        const PathID_t& pathid,
+        std::vector<IHopHandler::TrafficEvent_t>& events)
+    {
+      gather.popAll(events);
+      std::vector<Msg_t> msgs(events.size());
+      for (size_t idx = 0; idx < events.size(); ++idx)
+      {
+        msgs[idx].pathid = pathid;
+        msgs[idx].Y = events[idx].second;
+        msgs[idx].XView.Assign(events[idx].first.data(), events[idx].first.size());
+      }
+      return msgs;
+    }
+
+    void
+    TransitHop::HoldGather(std::unique_ptr<Gather_t>& gather, uint32_t& jobs)
+    {
+      if (not gather)
+      {
+        gather = std::make_unique<Gather_t>(transit_hop_queue_size);
+        if (m_Stopped)
+          gather->disable();
+      }
+      jobs++;
+    }
+
+    void
+    TransitHop::ReleaseGather(
+        std::unique_ptr<Gather_t>& gather, uint32_t& jobs, AbstractRouter* r)
+    {
+      if (--jobs > 0)
+        return;
+      gather.reset();
+      if (not m_UpstreamGather and not m_DownstreamGather and not m_IdleDecayQueued)
+        r->pathContext().QueueIdleDecay(shared_from_this());
+    }
+
+    size_t
+    TransitHop::GatherMemory() const
+    {
+      size_t bytes = 0;
+      for (const auto* gather : {m_UpstreamGather.get(), m_DownstreamGather.get()})
+      {
+        if (gather)
+          bytes += sizeof(Gather_t) + gather->capacity() * sizeof(TrafficEvent_t);
+      }
+      return bytes;
+    }
+
     void
     TransitHop::DownstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
-      auto flushIt = [self = shared_from_this(), r]() {
-        std::vector<RelayDownstreamMessage> msgs;
-        do
-        {
-          auto maybe = self->m_DownstreamGather.tryPopFront();
-          if (not maybe)
-            break;
-          msgs.emplace_back(*maybe);
-        } while (true);
-        self->HandleAllDownstream(std::move(msgs), r);
+      alloc::Scope allocScope{alloc::PathQueues};
+      LLARP_ZONE("TransitHop::DownstreamWork");
+      LLARP_PLOT("transit downstream batch", msgs->size());
+      auto flushIt = [self = shared_from_this(), r](bool last) {
+        std::vector<TrafficEvent_t> events;
+        auto msgs = DrainGather<RelayDownstreamMessage>(
+            *self->m_DownstreamGather, self->info.rxID, events);
+        if (not msgs.empty())
+          self->HandleAllDownstream(std::move(msgs), r);
+        if (last)
+          self->ReleaseGather(self->m_DownstreamGather, self->m_DownstreamJobs, r);
       };
+      const auto started = metrics::Histogram::Clock_t::now();
+      CryptBatch(*msgs);
+      r->pathContext().OnionCryptoTimes().ObserveSince(started);
+      std::vector<TrafficEvent_t> batch;
+      batch.reserve(msgs->size());
       for (auto& ev : *msgs)
       {
-        RelayDownstreamMessage msg;
-        const llarp_buffer_t buf(ev.first);
-        msg.pathid = info.rxID;
-        msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.X = buf;
-        llarp::LogDebug(
-            "relay ",
-            msg.X.size(),
-            " bytes downstream from ",
-            info.upstream,
-            " to ",
-            info.downstream);
-        if (m_DownstreamGather.full())
-        {
-          LogicCall(r->logic(), flushIt);
-        }
-        if (m_DownstreamGather.enabled())
-          m_DownstreamGather.pushBack(msg);
+        ev.second = ev.second ^ nonceXOR;
+        batch.emplace_back(std::move(ev));
       }
-      LogicCall(r->logic(), flushIt);
+      // the logic thread keeps the gather until our last flush has run
+      GatherAndFlush(*m_DownstreamGather, batch, r, flushIt);
     }
 
     void
     TransitHop::UpstreamWork(TrafficQueue_ptr msgs, AbstractRouter* r)
     {
-      auto flushIt = [self = shared_from_this(), r]() {
-        std::vector<RelayUpstreamMessage> msgs;
-        do
-        {
-          auto maybe = self->m_UpstreamGather.tryPopFront();
-          if (not maybe)
-            break;
-          msgs.emplace_back(*maybe);
-        } while (true);
-        self->HandleAllUpstream(std::move(msgs), r);
+      alloc::Scope allocScope{alloc::PathQueues};
+      LLARP_ZONE("TransitHop::UpstreamWork");
+      LLARP_PLOT("transit upstream batch", msgs->size());
+      auto flushIt = [self = shared_from_this(), r](bool last) {
+        std::vector<TrafficEvent_t> events;
+        auto msgs =
+            DrainGather<RelayUpstreamMessage>(*self->m_UpstreamGather, self->info.txID, events);
+        if (not msgs.empty())
+          self->HandleAllUpstream(std::move(msgs), r);
+        if (last)
+          self->ReleaseGather(self->m_UpstreamGather, self->m_UpstreamJobs, r);
       };
+      const auto started = metrics::Histogram::Clock_t::now();
+      CryptBatch(*msgs);
+      r->pathContext().OnionCryptoTimes().ObserveSince(started);
+      std::vector<TrafficEvent_t> batch;
+      batch.reserve(msgs->size());
       for (auto& ev : *msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.pathid = info.txID;
-        msg.Y = ev.second ^ nonceXOR;
-        msg.X = buf;
-        if (m_UpstreamGather.full())
-        {
-          LogicCall(r->logic(), flushIt);
-        }
-        if (m_UpstreamGather.enabled())
-          m_UpstreamGather.pushBack(msg);
+        ev.second = ev.second ^ nonceXOR;
+        batch.emplace_back(std::move(ev));
       }
-      LogicCall(r->logic(), flushIt);
+      GatherAndFlush(*m_UpstreamGather, batch, r, flushIt);
     }
 
     void
@@ -194,7 +325,7 @@ namespace llarp
       {
         for (const auto& msg : msgs)
         {
-          const llarp_buffer_t buf(msg.X);
+          const llarp_buffer_t buf = msg.XView.Or(msg.X);
           if (!r->ParseRoutingMessageBuffer(buf, this, info.rxID))
           {
             LogWarn("invalid upstream data on endpoint ", info);
@@ -214,7 +345,7 @@ namespace llarp
         {
           llarp::LogDebug(
               "relay ",
-              msg.X.size(),
+              msg.XView.Or(msg.X).sz,
               " bytes upstream from ",
               info.downstream,
               " to ",
@@ -228,11 +359,15 @@ namespace llarp
     void
     TransitHop::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
     {
-      for (const auto& msg : msgs)
+      // the flag goes on down to the path owner, who marks what it hands on with it
+      const bool congested = Congested(r->Now())
+          or r->outboundMessageHandler().IsCongested(info.downstream, info.rxID);
+      for (auto& msg : msgs)
       {
+        msg.congested = congested;
         llarp::LogDebug(
             "relay ",
-            msg.X.size(),
+            msg.XView.Or(msg.X).sz,
             " bytes downstream from ",
             info.upstream,
             " to ",
@@ -242,14 +377,36 @@ namespace llarp
       r->linkManager().PumpLinks();
     }
 
+    bool
+    TransitHop::UpstreamBackedUp(AbstractRouter* r)
+    {
+      // upstream cells end here on the endpoint
+      if (IsEndpoint(r->pubkey()))
+        return false;
+      return r->outboundMessageHandler().IsBackedUp(info.upstream, info.txID);
+    }
+
+    bool
+    TransitHop::DownstreamBackedUp(AbstractRouter* r)
+    {
+      return r->outboundMessageHandler().IsBackedUp(info.downstream, info.rxID);
+    }
+
     void
     TransitHop::FlushUpstream(AbstractRouter* r)
     {
       if (m_UpstreamQueue && not m_UpstreamQueue->empty())
       {
-        r->QueueWork([self = shared_from_this(), data = std::move(m_UpstreamQueue), r]() mutable {
-          self->UpstreamWork(std::move(data), r);
-        });
+        HoldGather(m_UpstreamGather, m_UpstreamJobs);
+        r->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(),
+             data = std::move(m_UpstreamQueue),
+             r,
+             queued = m_UpstreamQueuedAt]() mutable {
+              r->pathContext().OnionWaitTimes().ObserveSince(queued);
+              self->UpstreamWork(std::move(data), r);
+            });
       }
       m_UpstreamQueue = nullptr;
     }
@@ -257,11 +414,25 @@ namespace llarp
     void
     TransitHop::FlushDownstream(AbstractRouter* r)
     {
+      if (not m_DownstreamBatch.Empty())
+      {
+        if (r->Now() >= m_DownstreamBatch.Started() + r->pathContext().CellBatchDelay())
+          SendBatch(r);
+        else
+          r->pathContext().QueueDownstreamFlush(HopHandlerPtr());
+      }
       if (m_DownstreamQueue && not m_DownstreamQueue->empty())
       {
-        r->QueueWork([self = shared_from_this(), data = std::move(m_DownstreamQueue), r]() mutable {
-          self->DownstreamWork(std::move(data), r);
-        });
+        HoldGather(m_DownstreamGather, m_DownstreamJobs);
+        r->QueueWorkFor(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(),
+             data = std::move(m_DownstreamQueue),
+             r,
+             queued = m_DownstreamQueuedAt]() mutable {
+              r->pathContext().OnionWaitTimes().ObserveSince(queued);
+              self->DownstreamWork(std::move(data), r);
+            });
       }
       m_DownstreamQueue = nullptr;
     }
@@ -271,9 +442,23 @@ namespace llarp
     bool
     TransitHop::HandleDHTMessage(const llarp::dht::IMessage& msg, AbstractRouter* r)
     {
+      auto& limiter = r->pathContext().DHTRequests();
+      if (not limiter.Allow(
+              info.downstream, info.rxID, dht::RequestLimiter::KindOf(msg), r->Now()))
+      {
+        // dropped without a reply, the client's lookup times out and it asks elsewhere
+        LogDebug("dht request over ", info, " is over its limit");
+        return true;
+      }
       return r->dht()->impl->RelayRequestForPath(info.rxID, msg);
     }
 
+    bool
+    TransitHop::AcceptingDHTMessages(AbstractRouter* r)
+    {
+      return not r->pathContext().DHTRequests().Exhausted(info.downstream, info.rxID, r->Now());
+    }
+
     bool
     TransitHop::HandlePathLatencyMessage(
         const llarp::routing::PathLatencyMessage& msg, AbstractRouter* r)
@@ -414,15 +599,15 @@ namespace llarp
       if (endpoint)
       {
         bool sent = true;
-        for (const auto& pkt : msg.X)
-        {
+        msg.ForEachPacket([&](const llarp_buffer_t& pkt) {
           // check short packet buffer
-          if (pkt.size() <= 8)
-            continue;
-          uint64_t counter = bufbe64toh(pkt.data());
+          if (pkt.sz <= 8)
+            return true;
+          uint64_t counter = bufbe64toh(pkt.base);
           sent &= endpoint->QueueOutboundTraffic(
-              ManagedBuffer(llarp_buffer_t(pkt.data() + 8, pkt.size() - 8)), counter);
-        }
+              ManagedBuffer(llarp_buffer_t(pkt.base + 8, pkt.sz - 8)), counter);
+          return true;
+        });
         return sent;
       }
 
@@ -475,8 +660,12 @@ namespace llarp
     void
     TransitHop::Stop()
     {
-      m_UpstreamGather.disable();
-      m_DownstreamGather.disable();
+      m_Stopped = true;
+      for (auto* gather : {m_UpstreamGather.get(), m_DownstreamGather.get()})
+      {
+        if (gather)
+          gather->disable();
+      }
     }
 
     void
@@ -488,8 +677,10 @@ namespace llarp
     void
     TransitHop::QueueDestroySelf(AbstractRouter* r)
     {
-      auto func = std::bind(&TransitHop::SetSelfDestruct, shared_from_this());
-      LogicCall(r->logic(), func);
+      LogicCall(r->logic(), [self = shared_from_this(), r]() {
+        self->SetSelfDestruct();
+        r->pathContext().RemoveTransitHop(self);
+      });
     }
   }  // namespace path
 }  // namespace llarp
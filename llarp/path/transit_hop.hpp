@@ -4,10 +4,13 @@
 #include <constants/path.hpp>
 #include <path/ihophandler.hpp>
 #include <path/path_types.hpp>
+#include <path/relay_load.hpp>
+#include <routing/batch_message.hpp>
 #include <routing/handler.hpp>
 #include <router_id.hpp>
 #include <util/compare_ptr.hpp>
-#include <util/thread/queue.hpp>
+#include <util/padding.hpp>
+#include <util/thread/spsc_queue.hpp>
 
 namespace llarp
 {
@@ -95,6 +98,14 @@ namespace llarp
       llarp_time_t lifetime = default_lifetime;
       llarp_proto_version_t version;
       llarp_time_t m_LastActivity = 0s;
+      /// what the cells we send back down are padded to, as the path's builder asked
+      padding::Profile padding = padding::DefaultProfile;
+      /// the builder asked for our load in the status records we write for it
+      bool reportLoad = false;
+
+      /// our load for the status records we write, if the builder asked for it
+      std::optional<RelayLoad>
+      LoadReport(AbstractRouter* r) const;
 
       void
       Stop();
@@ -160,6 +171,9 @@ namespace llarp
       bool
       HandlePathLatencyMessage(const routing::PathLatencyMessage& msg, AbstractRouter* r) override;
 
+      bool
+      HandleBatchMessage(const routing::BatchMessage& msg, AbstractRouter* r) override;
+
       bool
       HandleObtainExitMessage(const routing::ObtainExitMessage& msg, AbstractRouter* r) override;
 
@@ -196,12 +210,35 @@ namespace llarp
       bool
       HandleDHTMessage(const dht::IMessage& msg, AbstractRouter* r) override;
 
+      bool
+      AcceptingDHTMessages(AbstractRouter* r) override;
+
+      bool
+      UpstreamBackedUp(AbstractRouter* r) override;
+
+      bool
+      DownstreamBackedUp(AbstractRouter* r) override;
+
       void
       FlushUpstream(AbstractRouter* r) override;
 
       void
       FlushDownstream(AbstractRouter* r) override;
 
+      std::shared_ptr<IHopHandler>
+      HopHandlerPtr() override
+      {
+        return shared_from_this();
+      }
+
+      /// bytes held by the gathers, none while the hop is idle
+      size_t
+      GatherMemory() const;
+
+      /// logic thread, for the path context to decay our replay filters once we have been
+      /// quiet, true while that is queued
+      bool m_IdleDecayQueued = false;
+
      protected:
       void
       UpstreamWork(TrafficQueue_ptr queue, AbstractRouter* r) override;
@@ -216,17 +253,46 @@ namespace llarp
       HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) override;
 
      private:
+      /// decrypted cells on their way from the worker that owns this hop's keyed work to the
+      /// logic thread, nonces already mutated
+      using Gather_t = thread::SpscQueue<TrafficEvent_t>;
+
+      /// logic thread, make gather if there is none and count a job that will drain into it
+      void
+      HoldGather(std::unique_ptr<Gather_t>& gather, uint32_t& jobs);
+
+      /// logic thread, a job's last drain is done, free gather once no job is left on it
+      void
+      ReleaseGather(std::unique_ptr<Gather_t>& gather, uint32_t& jobs, AbstractRouter* r);
+
       void
       SetSelfDestruct();
 
+      /// add or peel our onion layer on every message in msgs in one batched cipher call
+      void
+      CryptBatch(TrafficQueue_t& msgs);
+
+      /// pad an encoded routing message and send it downstream as one cell
+      bool
+      SendCell(llarp_buffer_t& buf, AbstractRouter* r);
+
+      /// send everything waiting in the downstream batch as one cell
+      bool
+      SendBatch(AbstractRouter* r);
+
       void
       QueueDestroySelf(AbstractRouter* r);
 
       std::set<std::shared_ptr<TransitHop>, ComparePtr<std::shared_ptr<TransitHop>>> m_FlushOthers;
-      thread::Queue<RelayUpstreamMessage> m_UpstreamGather;
-      thread::Queue<RelayDownstreamMessage> m_DownstreamGather;
-      std::atomic<uint32_t> m_UpstreamWorkCounter;
-      std::atomic<uint32_t> m_DownstreamWorkCounter;
+      /// filled by the worker that owns this hop's keyed work, drained on the logic thread
+      /// made when traffic comes and freed once it is all drained, so idle hops hold none
+      std::unique_ptr<Gather_t> m_UpstreamGather;
+      std::unique_ptr<Gather_t> m_DownstreamGather;
+      /// logic thread, jobs queued that have yet to finish draining into each gather
+      uint32_t m_UpstreamJobs = 0;
+      uint32_t m_DownstreamJobs = 0;
+      bool m_Stopped = false;
+      routing::MessageBatcher m_DownstreamBatch;
     };
 
     inline std::ostream&
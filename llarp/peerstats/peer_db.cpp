@@ -11,15 +11,31 @@ namespace llarp
     m_lastFlush.store({});
   }
 
+  PeerDb::StatsShard&
+  PeerDb::shardFor(const RouterID& routerId)
+  {
+    return m_shards[RouterID::Hash()(routerId) % NumShards];
+  }
+
+  const PeerDb::StatsShard&
+  PeerDb::shardFor(const RouterID& routerId) const
+  {
+    return m_shards[RouterID::Hash()(routerId) % NumShards];
+  }
+
   void
   PeerDb::loadDatabase(std::optional<fs::path> file)
   {
-    std::lock_guard guard(m_statsLock);
+    std::lock_guard storageGuard(m_storageLock);
 
     if (m_storage)
       throw std::runtime_error("Reloading database not supported");  // TODO
 
-    m_peerStats.clear();
+    for (auto& shard : m_shards)
+    {
+      std::lock_guard guard(shard.lock);
+      shard.peerStats.clear();
+    }
 
     // sqlite_orm treats empty-string as an indicator to load a memory-backed database, which we'll
     // use if file is an empty-optional
@@ -41,11 +57,14 @@ namespace llarp
     LogInfo("Loading ", allStats.size(), " PeerStats from table peerstats...");
     for (PeerStats& stats : allStats)
     {
-      // we cleared m_peerStats, and the database should enforce that routerId is unique...
-      assert(m_peerStats.find(stats.routerId) == m_peerStats.end());
+      auto& shard = shardFor(stats.routerId);
+      std::lock_guard guard(shard.lock);
+
+      // we cleared the shards, and the database should enforce that routerId is unique...
+      assert(shard.peerStats.find(stats.routerId) == shard.peerStats.end());
 
       stats.stale = false;
-      m_peerStats[stats.routerId] = stats;
+      shard.peerStats[stats.routerId] = stats;
     }
   }
 
@@ -61,16 +80,19 @@ namespace llarp
       return;
     }
 
+    std::lock_guard storageGuard(m_storageLock);
+
     if (not m_storage)
       throw std::runtime_error("Cannot flush database before it has been loaded");
 
     std::vector<PeerStats> staleStats;
 
+    // copy all stale entries, one shard at a time so the hot path only ever waits on one
+    for (auto& shard : m_shards)
     {
-      std::lock_guard guard(m_statsLock);
+      std::lock_guard guard(shard.lock);
 
-      // copy all stale entries
-      for (auto& entry : m_peerStats)
+      for (auto& entry : shard.peerStats)
       {
         if (entry.second.stale)
         {
@@ -82,12 +104,16 @@ namespace llarp
 
     LogDebug("Updating ", staleStats.size(), " stats");
 
+    if (not staleStats.empty())
     {
       auto guard = m_storage->transaction_guard();
 
+      // the statement is compiled once and rebound for each row
+      auto statement = m_storage->prepare(sqlite_orm::replace(staleStats.front()));
       for (const auto& stats : staleStats)
       {
-        m_storage->replace(stats);
+        sqlite_orm::get<0>(statement) = stats;
+        m_storage->execute(statement);
       }
 
       guard.commit();
@@ -108,10 +134,11 @@ namespace llarp
       throw std::invalid_argument(
           stringify("routerId ", routerId, " doesn't match ", delta.routerId));
 
-    std::lock_guard guard(m_statsLock);
-    auto itr = m_peerStats.find(routerId);
-    if (itr == m_peerStats.end())
-      itr = m_peerStats.insert({routerId, delta}).first;
+    auto& shard = shardFor(routerId);
+    std::lock_guard guard(shard.lock);
+    auto itr = shard.peerStats.find(routerId);
+    if (itr == shard.peerStats.end())
+      itr = shard.peerStats.insert({routerId, delta}).first;
     else
       itr->second += delta;
 
@@ -121,9 +148,10 @@ namespace llarp
   void
   PeerDb::modifyPeerStats(const RouterID& routerId, std::function<void(PeerStats&)> callback)
   {
-    std::lock_guard guard(m_statsLock);
+    auto& shard = shardFor(routerId);
+    std::lock_guard guard(shard.lock);
 
-    PeerStats& stats = m_peerStats[routerId];
+    PeerStats& stats = shard.peerStats[routerId];
     stats.routerId = routerId;
     stats.stale = true;
     callback(stats);
@@ -132,9 +160,10 @@ namespace llarp
   std::optional<PeerStats>
   PeerDb::getCurrentPeerStats(const RouterID& routerId) const
   {
-    std::lock_guard guard(m_statsLock);
-    auto itr = m_peerStats.find(routerId);
-    if (itr == m_peerStats.end())
+    const auto& shard = shardFor(routerId);
+    std::lock_guard guard(shard.lock);
+    auto itr = shard.peerStats.find(routerId);
+    if (itr == shard.peerStats.end())
       return std::nullopt;
     else
       return itr->second;
@@ -143,14 +172,16 @@ namespace llarp
   std::vector<PeerStats>
   PeerDb::listAllPeerStats() const
   {
-    std::lock_guard guard(m_statsLock);
-
     std::vector<PeerStats> statsList;
-    statsList.reserve(m_peerStats.size());
 
-    for (const auto& [routerId, stats] : m_peerStats)
+    for (const auto& shard : m_shards)
     {
-      statsList.push_back(stats);
+      std::lock_guard guard(shard.lock);
+
+      for (const auto& [routerId, stats] : shard.peerStats)
+      {
+        statsList.push_back(stats);
+      }
     }
 
     return statsList;
@@ -159,15 +190,15 @@ namespace llarp
   std::vector<PeerStats>
   PeerDb::listPeerStats(const std::vector<RouterID>& ids) const
   {
-    std::lock_guard guard(m_statsLock);
-
     std::vector<PeerStats> statsList;
     statsList.reserve(ids.size());
 
     for (const auto& id : ids)
     {
-      const auto itr = m_peerStats.find(id);
-      if (itr != m_peerStats.end())
+      const auto& shard = shardFor(id);
+      std::lock_guard guard(shard.lock);
+      const auto itr = shard.peerStats.find(id);
+      if (itr != shard.peerStats.end())
         statsList.push_back(itr->second);
     }
 
@@ -224,10 +255,11 @@ namespace llarp
   void
   PeerDb::handleGossipedRC(const RouterContact& rc, llarp_time_t now)
   {
-    std::lock_guard guard(m_statsLock);
-
     RouterID id(rc.pubkey);
-    auto& stats = m_peerStats[id];
+    auto& shard = shardFor(id);
+    std::lock_guard guard(shard.lock);
+
+    auto& stats = shard.peerStats[id];
     stats.routerId = id;
 
     const bool isNewRC = (stats.lastRCUpdated < rc.last_updated);
@@ -274,18 +306,23 @@ namespace llarp
   util::StatusObject
   PeerDb::ExtractStatus() const
   {
-    std::lock_guard guard(m_statsLock);
-
-    bool loaded = (m_storage.get() != nullptr);
+    bool loaded = false;
     util::StatusObject dbFile = nullptr;
-    if (loaded)
-      dbFile = m_storage->filename();
+    {
+      std::lock_guard guard(m_storageLock);
+      loaded = (m_storage.get() != nullptr);
+      if (loaded)
+        dbFile = m_storage->filename();
+    }
 
     std::vector<util::StatusObject> statsObjs;
-    statsObjs.reserve(m_peerStats.size());
-    for (const auto& pair : m_peerStats)
+    for (const auto& shard : m_shards)
     {
-      statsObjs.push_back(pair.second.toJson());
+      std::lock_guard guard(shard.lock);
+      for (const auto& pair : shard.peerStats)
+      {
+        statsObjs.push_back(pair.second.toJson());
+      }
     }
 
     util::StatusObject obj{
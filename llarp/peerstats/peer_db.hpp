@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <filesystem>
 #include <functional>
+#include <mutex>
 #include <unordered_map>
 
 #include <sqlite_orm/sqlite_orm.h>
@@ -42,6 +44,8 @@ namespace llarp
     /// and should be called in an appropriate threading context. However, it will make a temporary
     /// copy of the peer stats so as to avoid sitting on a mutex lock during disk I/O.
     ///
+    /// All stale peers are written in one transaction through a single prepared statement.
+    ///
     /// @throws if the database could not be written to (esp. if loadDatabase() has not been called)
     void
     flushDatabase();
@@ -66,8 +70,8 @@ namespace llarp
     /// is an alternative means of incrementing peer stats that is suitable for one-off
     /// modifications.
     ///
-    /// Note that this holds m_statsLock during the callback invocation, so the callback should
-    /// return as quickly as possible.
+    /// Note that this holds the lock of the peer's shard during the callback invocation, so the
+    /// callback should return as quickly as possible.
     ///
     /// @param routerId is the id of the router whose stats should be modified.
     /// @param callback is a function which will be called immediately with mutex held
@@ -126,11 +130,28 @@ namespace llarp
     util::StatusObject
     ExtractStatus() const;
 
+    /// How many ways the peer stats are split, each part behind its own lock
+    static constexpr size_t NumShards = 16;
+
    private:
-    std::unordered_map<RouterID, PeerStats, RouterID::Hash> m_peerStats;
-    mutable std::mutex m_statsLock;
+    /// Peers are spread over the shards by RouterID so that events from the link and path layers
+    /// about different peers do not wait on one another
+    struct StatsShard
+    {
+      std::unordered_map<RouterID, PeerStats, RouterID::Hash> peerStats;
+      mutable std::mutex lock;
+    };
+
+    StatsShard&
+    shardFor(const RouterID& routerId);
+
+    const StatsShard&
+    shardFor(const RouterID& routerId) const;
+
+    std::array<StatsShard, NumShards> m_shards;
 
     std::unique_ptr<PeerDbStorage> m_storage;
+    mutable std::mutex m_storageLock;
 
     std::atomic<llarp_time_t> m_lastFlush;
   };
@@ -28,7 +28,7 @@ namespace llarp
   bool
   PoW::IsValid(llarp_time_t now) const
   {
-    if (now - timestamp > extendedLifetime)
+    if (IsExpired(now))
       return false;
 
     ShortHash digest;
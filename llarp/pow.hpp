@@ -17,6 +17,13 @@ namespace llarp
 
     ~PoW();
 
+    /// true once the extended lifetime is over, the part of IsValid that changes with time
+    bool
+    IsExpired(llarp_time_t now) const
+    {
+      return now - timestamp > extendedLifetime;
+    }
+
     bool
     IsValid(llarp_time_t now) const;
 
@@ -1,6 +1,7 @@
 #include <profiling.hpp>
 
 #include <fstream>
+#include <shared_mutex>
 #include <util/fs.hpp>
 
 namespace llarp
@@ -95,6 +96,32 @@ namespace llarp
     return checkIsGood(pathFailCount, pathSuccessCount, chances);
   }
 
+  RouterProfile
+  Profiling::Entry::Get() const
+  {
+    RouterProfile profile;
+    profile.connectTimeoutCount = connectTimeoutCount.load(std::memory_order_relaxed);
+    profile.connectGoodCount = connectGoodCount.load(std::memory_order_relaxed);
+    profile.pathSuccessCount = pathSuccessCount.load(std::memory_order_relaxed);
+    profile.pathFailCount = pathFailCount.load(std::memory_order_relaxed);
+    profile.lastUpdated = lastUpdated.load(std::memory_order_relaxed);
+    profile.lastDecay = lastDecay;
+    profile.version = version;
+    return profile;
+  }
+
+  void
+  Profiling::Entry::Set(const RouterProfile& profile)
+  {
+    connectTimeoutCount.store(profile.connectTimeoutCount, std::memory_order_relaxed);
+    connectGoodCount.store(profile.connectGoodCount, std::memory_order_relaxed);
+    pathSuccessCount.store(profile.pathSuccessCount, std::memory_order_relaxed);
+    pathFailCount.store(profile.pathFailCount, std::memory_order_relaxed);
+    lastUpdated.store(profile.lastUpdated, std::memory_order_relaxed);
+    lastDecay = profile.lastDecay;
+    version = profile.version;
+  }
+
   Profiling::Profiling() : m_DisableProfiling(false)
   {}
 
@@ -110,92 +137,146 @@ namespace llarp
     m_DisableProfiling.store(false);
   }
 
+  Profiling::Shard&
+  Profiling::ShardFor(const RouterID& r)
+  {
+    return m_Shards[RouterID::Hash()(r) % NumShards];
+  }
+
+  const Profiling::Shard&
+  Profiling::ShardFor(const RouterID& r) const
+  {
+    return m_Shards[RouterID::Hash()(r) % NumShards];
+  }
+
+  template <typename Check>
   bool
-  Profiling::IsBadForConnect(const RouterID& r, uint64_t chances)
+  Profiling::IsBadWith(const RouterID& r, Check check) const
   {
     if (m_DisableProfiling.load())
       return false;
-    util::Lock lock(m_ProfilesMutex);
-    auto itr = m_Profiles.find(r);
-    if (itr == m_Profiles.end())
+    const auto& shard = ShardFor(r);
+    std::shared_lock lock{shard.mutex};
+    auto itr = shard.profiles.find(r);
+    if (itr == shard.profiles.end())
       return false;
-    return !itr->second.IsGoodForConnect(chances);
+    return !check(itr->second.Get());
+  }
+
+  template <typename Update>
+  void
+  Profiling::UpdateProfile(const RouterID& r, Update update)
+  {
+    auto& shard = ShardFor(r);
+    const auto now = llarp::time_now_ms();
+    {
+      // known routers are only bumped, which the atomics let us do next to readers
+      std::shared_lock lock{shard.mutex};
+      auto itr = shard.profiles.find(r);
+      if (itr != shard.profiles.end())
+      {
+        update(itr->second);
+        itr->second.lastUpdated.store(now, std::memory_order_relaxed);
+        shard.dirty.store(true);
+        return;
+      }
+    }
+    util::Lock lock(shard.mutex);
+    auto& entry = shard.profiles[r];
+    update(entry);
+    entry.lastUpdated.store(now, std::memory_order_relaxed);
+    shard.dirty.store(true);
+  }
+
+  bool
+  Profiling::IsBadForConnect(const RouterID& r, uint64_t chances)
+  {
+    return IsBadWith(
+        r, [chances](const RouterProfile& profile) { return profile.IsGoodForConnect(chances); });
   }
 
   bool
   Profiling::IsBadForPath(const RouterID& r, uint64_t chances)
   {
-    if (m_DisableProfiling.load())
-      return false;
-    util::Lock lock(m_ProfilesMutex);
-    auto itr = m_Profiles.find(r);
-    if (itr == m_Profiles.end())
-      return false;
-    return !itr->second.IsGoodForPath(chances);
+    return IsBadWith(
+        r, [chances](const RouterProfile& profile) { return profile.IsGoodForPath(chances); });
+  }
+
+  bool
+  Profiling::HasPathHistory(const RouterID& r) const
+  {
+    const auto& shard = ShardFor(r);
+    std::shared_lock lock{shard.mutex};
+    auto itr = shard.profiles.find(r);
+    return itr != shard.profiles.end() and itr->second.pathSuccessCount.load() > 0;
   }
 
   bool
   Profiling::IsBad(const RouterID& r, uint64_t chances)
   {
-    if (m_DisableProfiling.load())
-      return false;
-    util::Lock lock(m_ProfilesMutex);
-    auto itr = m_Profiles.find(r);
-    if (itr == m_Profiles.end())
-      return false;
-    return !itr->second.IsGood(chances);
+    return IsBadWith(
+        r, [chances](const RouterProfile& profile) { return profile.IsGood(chances); });
   }
 
   void
   Profiling::Tick()
   {
-    util::Lock lock(m_ProfilesMutex);
-    std::for_each(m_Profiles.begin(), m_Profiles.end(), [](auto& item) { item.second.Tick(); });
+    for (auto& shard : m_Shards)
+    {
+      util::Lock lock(shard.mutex);
+      for (auto& item : shard.profiles)
+      {
+        auto profile = item.second.Get();
+        profile.Tick();
+        const auto before = item.second.Get();
+        item.second.Set(profile);
+        // decaying empty counters changes nothing that is saved
+        if (profile.connectTimeoutCount != before.connectTimeoutCount
+            or profile.connectGoodCount != before.connectGoodCount
+            or profile.pathSuccessCount != before.pathSuccessCount
+            or profile.pathFailCount != before.pathFailCount)
+          shard.dirty.store(true);
+      }
+    }
   }
 
   void
   Profiling::MarkConnectTimeout(const RouterID& r)
   {
-    util::Lock lock(m_ProfilesMutex);
-    m_Profiles[r].connectTimeoutCount += 1;
-    m_Profiles[r].lastUpdated = llarp::time_now_ms();
+    UpdateProfile(r, [](Entry& entry) { entry.connectTimeoutCount += 1; });
   }
 
   void
   Profiling::MarkConnectSuccess(const RouterID& r)
   {
-    util::Lock lock(m_ProfilesMutex);
-    m_Profiles[r].connectGoodCount += 1;
-    m_Profiles[r].lastUpdated = llarp::time_now_ms();
+    UpdateProfile(r, [](Entry& entry) { entry.connectGoodCount += 1; });
   }
 
   void
   Profiling::ClearProfile(const RouterID& r)
   {
-    util::Lock lock(m_ProfilesMutex);
-    m_Profiles.erase(r);
+    auto& shard = ShardFor(r);
+    util::Lock lock(shard.mutex);
+    if (shard.profiles.erase(r))
+      shard.dirty.store(true);
   }
 
   void
   Profiling::MarkHopFail(const RouterID& r)
   {
-    util::Lock lock(m_ProfilesMutex);
-    m_Profiles[r].pathFailCount += 1;
-    m_Profiles[r].lastUpdated = llarp::time_now_ms();
+    UpdateProfile(r, [](Entry& entry) { entry.pathFailCount += 1; });
   }
 
   void
   Profiling::MarkPathFail(path::Path* p)
   {
-    util::Lock lock(m_ProfilesMutex);
     size_t idx = 0;
     for (const auto& hop : p->hops)
     {
       // don't mark first hop as failure because we are connected to it directly
       if (idx)
       {
-        m_Profiles[hop.rc.pubkey].pathFailCount += 1;
-        m_Profiles[hop.rc.pubkey].lastUpdated = llarp::time_now_ms();
+        UpdateProfile(hop.rc.pubkey, [](Entry& entry) { entry.pathFailCount += 1; });
       }
       ++idx;
     }
@@ -204,62 +285,72 @@ namespace llarp
   void
   Profiling::MarkPathSuccess(path::Path* p)
   {
-    util::Lock lock(m_ProfilesMutex);
     const auto sz = p->hops.size();
     for (const auto& hop : p->hops)
     {
-      m_Profiles[hop.rc.pubkey].pathSuccessCount += sz;
-      m_Profiles[hop.rc.pubkey].lastUpdated = llarp::time_now_ms();
+      UpdateProfile(hop.rc.pubkey, [sz](Entry& entry) { entry.pathSuccessCount += sz; });
     }
   }
 
   bool
   Profiling::Save(const char* fname)
   {
-    std::shared_lock lock{m_ProfilesMutex};
-    size_t sz = (m_Profiles.size() * (RouterProfile::MaxSize + 32 + 8)) + 8;
-
-    std::vector<byte_t> tmp(sz, 0);
-    llarp_buffer_t buf(tmp);
-    auto res = BEncodeNoLock(&buf);
-    if (res)
+    std::lock_guard saveLock{m_SaveMutex};
+    for (auto& shard : m_Shards)
     {
-      buf.sz = buf.cur - buf.base;
-      const fs::path fpath = std::string(fname);
-      auto optional_f = util::OpenFileStream<std::ofstream>(fpath, std::ios::binary);
-      if (!optional_f)
-        return false;
-      auto& f = *optional_f;
-      if (f.is_open())
+      // cleared first so a change made while we encode marks it again for next time
+      if (not shard.dirty.exchange(false))
+        continue;
+      std::shared_lock lock{shard.mutex};
+      size_t sz = (shard.profiles.size() * (RouterProfile::MaxSize + 32 + 8)) + 8;
+
+      std::vector<byte_t> tmp(sz, 0);
+      llarp_buffer_t buf(tmp);
+      for (const auto& item : shard.profiles)
       {
-        f.write((char*)buf.base, buf.sz);
-        m_LastSave = llarp::time_now_ms();
+        if (not item.first.BEncode(&buf) or not item.second.Get().BEncode(&buf))
+        {
+          shard.dirty.store(true);
+          return false;
+        }
       }
+      tmp.resize(buf.cur - buf.base);
+      shard.encoded = std::move(tmp);
     }
-    return res;
-  }
 
-  bool
-  Profiling::BEncode(llarp_buffer_t* buf) const
-  {
-    std::shared_lock lock{m_ProfilesMutex};
-    return BEncodeNoLock(buf);
+    const fs::path fpath = std::string(fname);
+    auto optional_f = util::OpenFileStream<std::ofstream>(fpath, std::ios::binary);
+    if (!optional_f)
+      return false;
+    auto& f = *optional_f;
+    if (f.is_open())
+    {
+      // the shards are written as one dict, they never share a key
+      f.put('d');
+      for (const auto& shard : m_Shards)
+        f.write((const char*)shard.encoded.data(), shard.encoded.size());
+      f.put('e');
+      m_LastSave = llarp::time_now_ms();
+    }
+    return true;
   }
 
   bool
-  Profiling::BEncodeNoLock(llarp_buffer_t* buf) const
+  Profiling::BEncode(llarp_buffer_t* buf) const
   {
     if (!bencode_start_dict(buf))
       return false;
 
-    auto itr = m_Profiles.begin();
-    while (itr != m_Profiles.end())
+    for (const auto& shard : m_Shards)
     {
-      if (!itr->first.BEncode(buf))
-        return false;
-      if (!itr->second.BEncode(buf))
-        return false;
-      ++itr;
+      std::shared_lock lock{shard.mutex};
+      for (const auto& item : shard.profiles)
+      {
+        if (!item.first.BEncode(buf))
+          return false;
+        if (!item.second.Get().BEncode(buf))
+          return false;
+      }
     }
     return bencode_end(buf);
   }
@@ -273,14 +364,25 @@ namespace llarp
     if (!bencode_decode_dict(profile, buf))
       return false;
     RouterID pk = k.base;
-    return m_Profiles.emplace(pk, profile).second;
+    auto& shard = ShardFor(pk);
+    util::Lock lock(shard.mutex);
+    auto [itr, inserted] = shard.profiles.try_emplace(pk);
+    if (not inserted)
+      return false;
+    itr->second.Set(profile);
+    shard.dirty.store(true);
+    return true;
   }
 
   bool
   Profiling::Load(const char* fname)
   {
-    util::Lock lock(m_ProfilesMutex);
-    m_Profiles.clear();
+    for (auto& shard : m_Shards)
+    {
+      util::Lock lock(shard.mutex);
+      shard.profiles.clear();
+      shard.dirty.store(true);
+    }
     if (!BDecodeReadFromFile(fname, *this))
     {
       llarp::LogWarn("failed to load router profiles from ", fname);
@@ -293,7 +395,7 @@ namespace llarp
   bool
   Profiling::ShouldSave(llarp_time_t now) const
   {
-    auto dlt = now - m_LastSave;
+    auto dlt = now - m_LastSave.load();
     return dlt > 1min;
   }
 }  // namespace llarp
@@ -7,7 +7,12 @@
 #include <util/thread/threading.hpp>
 
 #include <util/thread/annotations.hpp>
-#include <map>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace llarp
 {
@@ -52,49 +57,53 @@ namespace llarp
 
     /// generic variant
     bool
-    IsBad(const RouterID& r, uint64_t chances = 8) EXCLUDES(m_ProfilesMutex);
+    IsBad(const RouterID& r, uint64_t chances = 8);
 
     /// check if this router should have paths built over it
     bool
-    IsBadForPath(const RouterID& r, uint64_t chances = 8) EXCLUDES(m_ProfilesMutex);
+    IsBadForPath(const RouterID& r, uint64_t chances = 8);
 
     /// check if this router should be connected directly to
     bool
-    IsBadForConnect(const RouterID& r, uint64_t chances = 8) EXCLUDES(m_ProfilesMutex);
+    IsBadForConnect(const RouterID& r, uint64_t chances = 8);
+
+    /// true if a path built over r has worked before
+    bool
+    HasPathHistory(const RouterID& r) const;
 
     void
-    MarkConnectTimeout(const RouterID& r) EXCLUDES(m_ProfilesMutex);
+    MarkConnectTimeout(const RouterID& r);
 
     void
-    MarkConnectSuccess(const RouterID& r) EXCLUDES(m_ProfilesMutex);
+    MarkConnectSuccess(const RouterID& r);
 
     void
-    MarkPathFail(path::Path* p) EXCLUDES(m_ProfilesMutex);
+    MarkPathFail(path::Path* p);
 
     void
-    MarkPathSuccess(path::Path* p) EXCLUDES(m_ProfilesMutex);
+    MarkPathSuccess(path::Path* p);
 
     void
-    MarkHopFail(const RouterID& r) EXCLUDES(m_ProfilesMutex);
+    MarkHopFail(const RouterID& r);
 
     void
-    ClearProfile(const RouterID& r) EXCLUDES(m_ProfilesMutex);
+    ClearProfile(const RouterID& r);
 
     void
-    Tick() EXCLUDES(m_ProfilesMutex);
+    Tick();
 
     bool
-    BEncode(llarp_buffer_t* buf) const EXCLUDES(m_ProfilesMutex);
+    BEncode(llarp_buffer_t* buf) const;
 
     bool
-    DecodeKey(const llarp_buffer_t& k, llarp_buffer_t* buf) NO_THREAD_SAFETY_ANALYSIS;
-    // disabled because we do load -> bencode::BDecodeReadFromFile -> DecodeKey
+    DecodeKey(const llarp_buffer_t& k, llarp_buffer_t* buf);
 
     bool
-    Load(const char* fname) EXCLUDES(m_ProfilesMutex);
+    Load(const char* fname);
 
+    /// only shards that changed since the last save are encoded again
     bool
-    Save(const char* fname) EXCLUDES(m_ProfilesMutex);
+    Save(const char* fname);
 
     bool
     ShouldSave(llarp_time_t now) const;
@@ -105,12 +114,58 @@ namespace llarp
     void
     Enable();
 
+    /// how many ways the profiles are split, each part behind its own lock
+    static constexpr size_t NumShards = 16;
+
    private:
+    /// a RouterProfile whose counters can be bumped while the shard is only held shared
+    struct Entry
+    {
+      std::atomic<uint64_t> connectTimeoutCount{0};
+      std::atomic<uint64_t> connectGoodCount{0};
+      std::atomic<uint64_t> pathSuccessCount{0};
+      std::atomic<uint64_t> pathFailCount{0};
+      std::atomic<llarp_time_t> lastUpdated{0s};
+      llarp_time_t lastDecay = 0s;
+      uint64_t version = LLARP_PROTO_VERSION;
+
+      RouterProfile
+      Get() const;
+
+      void
+      Set(const RouterProfile& profile);
+    };
+
+    struct Shard
+    {
+      /// taken exclusive only to add, remove or decay entries
+      mutable util::Mutex mutex;
+      std::unordered_map<RouterID, Entry, RouterID::Hash> profiles GUARDED_BY(mutex);
+      /// set when anything in the shard changed since it was last encoded
+      std::atomic<bool> dirty{true};
+      /// the shard's entries as bencoded at the last save, only touched by Save
+      std::vector<byte_t> encoded;
+    };
+
+    Shard&
+    ShardFor(const RouterID& r);
+
+    const Shard&
+    ShardFor(const RouterID& r) const;
+
+    /// checks the profile of r with check, not bad if we have none
+    template <typename Check>
     bool
-    BEncodeNoLock(llarp_buffer_t* buf) const REQUIRES_SHARED(m_ProfilesMutex);
-    mutable util::Mutex m_ProfilesMutex;  // protects m_Profiles
-    std::map<RouterID, RouterProfile> m_Profiles GUARDED_BY(m_ProfilesMutex);
-    llarp_time_t m_LastSave = 0s;
+    IsBadWith(const RouterID& r, Check check) const;
+
+    /// runs update on the profile of r, creating it if needed
+    template <typename Update>
+    void
+    UpdateProfile(const RouterID& r, Update update);
+
+    std::array<Shard, NumShards> m_Shards;
+    std::mutex m_SaveMutex;
+    std::atomic<llarp_time_t> m_LastSave{0s};
     std::atomic<bool> m_DisableProfiling;
   };
 
@@ -43,12 +43,14 @@ namespace llarp
   struct IOutboundSessionMaker;
   struct ILinkManager;
   struct I_RCLookupHandler;
+  struct I_RCGossiper;
   struct RoutePoker;
 
   namespace exit
   {
     struct Context;
-  }
+    struct SNodeSessionRegistry;
+  }  // namespace exit
 
   namespace rpc
   {
@@ -58,6 +60,7 @@ namespace llarp
   namespace path
   {
     struct PathContext;
+    struct PathPool;
   }
 
   namespace routing
@@ -75,6 +78,11 @@ namespace llarp
     class ThreadPool;
   }
 
+  namespace metrics
+  {
+    struct Registry;
+  }
+
   using LMQ_ptr = std::shared_ptr<lokimq::LokiMQ>;
 
   struct AbstractRouter
@@ -109,12 +117,20 @@ namespace llarp
     virtual path::PathContext&
     pathContext() = 0;
 
+    /// pre built paths to hand out, nullptr when the pool is off
+    virtual path::PathPool*
+    pathPool() = 0;
+
     virtual const RouterContact&
     rc() const = 0;
 
     virtual exit::Context&
     exitContext() = 0;
 
+    /// the snode sessions our endpoints share
+    virtual exit::SNodeSessionRegistry&
+    snodeSessions() = 0;
+
     virtual std::shared_ptr<KeyManager>
     keyManager() const = 0;
 
@@ -133,6 +149,21 @@ namespace llarp
     /// call function in crypto worker
     virtual void QueueWork(std::function<void(void)>) = 0;
 
+    /// fresh encryption keypair for a handshake, from the ephemeral key cache when it has one
+    /// safe to call from any thread
+    virtual void
+    GenerateEphemeralKey(SecretKey& key) = 0;
+
+    /// call function in the crypto worker that owns key, after anything queued before it under
+    /// the same key
+    virtual void
+    QueueWorkFor(uint64_t key, std::function<void(void)>) = 0;
+
+    /// call function in a crypto worker behind everything else queued there, returns false
+    /// without taking it if too many path builds are already waiting
+    virtual bool
+    QueuePathBuildWork(std::function<void(void)>) = 0;
+
     /// call function in disk io thread
     virtual void QueueDiskIO(std::function<void(void)>) = 0;
 
@@ -142,6 +173,11 @@ namespace llarp
       return nullptr;
     }
 
+    /// apply what can change while we run from conf, our config file read again, and keep it
+    /// as our config. returns the options that changed but wait for a restart to take effect
+    virtual std::vector<std::string>
+    Reconfigure(std::shared_ptr<Config> conf) = 0;
+
     virtual service::Context&
     hiddenServiceContext() = 0;
 
@@ -163,9 +199,16 @@ namespace llarp
     virtual I_RCLookupHandler&
     rcLookupHandler() = 0;
 
+    virtual I_RCGossiper&
+    rcGossiper() = 0;
+
     virtual std::shared_ptr<PeerDb>
     peerDb() = 0;
 
+    /// where subsystems register their metrics for the rpc server to scrape
+    virtual metrics::Registry&
+    metrics() = 0;
+
     virtual bool
     Sign(Signature& sig, const llarp_buffer_t& buf) const = 0;
 
@@ -195,7 +238,7 @@ namespace llarp
     virtual void
     Die() = 0;
 
-    /// pump low level links
+    /// pump low level links, soon rather than right away so bursts of calls pump once
     virtual void
     PumpLL() = 0;
 
@@ -216,7 +259,7 @@ namespace llarp
     virtual void
     SessionClosed(RouterID remote) = 0;
 
-    /// returns system clock milliseconds since epoch
+    /// returns system clock milliseconds since epoch as of the last event loop wakeup
     virtual llarp_time_t
     Now() const = 0;
 
@@ -271,6 +314,11 @@ namespace llarp
     virtual void
     SetRouterWhitelist(const std::vector<RouterID> routers) = 0;
 
+    /// change the service node whitelist by what joined and left it since it was last set
+    virtual void
+    UpdateRouterWhitelist(
+        const std::vector<RouterID>& added, const std::vector<RouterID>& removed) = 0;
+
     /// visit each connected link session
     virtual void
     ForEachPeer(std::function<void(const ILinkSession*, bool)> visit, bool randomize) const = 0;
@@ -296,6 +344,19 @@ namespace llarp
     virtual void
     GossipRCIfNeeded(const RouterContact rc) = 0;
 
+    /// let a client go idle once its user has been quiet a while, for devices on battery.
+    /// idle coalesces timers, keeps fewer paths and pings less. safe from any thread
+    virtual void
+    SetIdleAllowed(bool allowed) = 0;
+
+    /// true while we are idle
+    virtual bool
+    IsIdle() const = 0;
+
+    /// the user sent traffic, leaves idle right away. safe from any thread
+    virtual void
+    NotifyUserActivity() = 0;
+
     /// Templated convenience function to generate a RouterHive event and
     /// delegate to non-templated (and overridable) function for handling.
     template <class EventType, class... Params>
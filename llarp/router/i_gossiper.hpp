@@ -1,6 +1,7 @@
 #ifndef LLARP_GOSSIPER_HPP
 #define LLARP_GOSSIPER_HPP
 #include <router_contact.hpp>
+#include <router/rc_digest.hpp>
 
 namespace llarp
 {
@@ -25,6 +26,14 @@ namespace llarp
     /// return true if that rc is owned by us
     virtual bool
     IsOurRC(const RouterContact& rc) const = 0;
+
+    /// send our digest to our peers when it is due
+    virtual void
+    Tick(Time_t now) = 0;
+
+    /// a peer sent us a digest of the rcs it has, send it what it is missing
+    virtual void
+    HandleDigest(const RouterID& from, RCDigest digest) = 0;
   };
 }  // namespace llarp
 
@@ -41,6 +41,20 @@ namespace llarp
     virtual void
     QueueRemoveEmptyPath(const PathID_t& pathid) = 0;
 
+    /// true when more for pathid to remote would only wait behind a backed up path queue or
+    /// link session, so whoever makes it should drop it before doing any work on it
+    virtual bool
+    IsBackedUp(const RouterID& remote, const PathID_t& pathid) const = 0;
+
+    /// true when what goes for pathid to remote waits long enough behind its path queue or
+    /// link session that it should carry a congestion mark, well before IsBackedUp
+    virtual bool
+    IsCongested(const RouterID& remote, const PathID_t& pathid) const = 0;
+
+    /// the fraction of paths with messages waiting that are congested, from 0 to 1
+    virtual double
+    CongestedFraction() const = 0;
+
     virtual util::StatusObject
     ExtractStatus() const = 0;
   };
@@ -12,6 +12,11 @@ namespace llarp
 {
   struct RouterContact;
 
+  namespace consensus
+  {
+    struct Table;
+  }
+
   enum class RCRequestResult
   {
     Success,
@@ -36,6 +41,18 @@ namespace llarp
     virtual void
     SetRouterWhitelist(const std::vector<RouterID>& routers) = 0;
 
+    virtual void
+    UpdateRouterWhitelist(
+        const std::vector<RouterID>& added, const std::vector<RouterID>& removed) = 0;
+
+    /// put a new weighted service node list in place, safe from any thread
+    virtual void
+    SetConsensusTable(std::shared_ptr<const consensus::Table> table) = 0;
+
+    /// the weighted service node list, empty until lokid gave us one. read without a lock
+    virtual std::shared_ptr<const consensus::Table>
+    ConsensusTable() const = 0;
+
     virtual void
     GetRC(const RouterID& router, RCRequestCallback callback, bool forceLookup = false) = 0;
 
@@ -45,6 +62,11 @@ namespace llarp
     virtual bool
     CheckRC(const RouterContact& rc) const = 0;
 
+    /// CheckRC over many rcs with their signatures checked as one batch, drops the ones that
+    /// fail from rcs
+    virtual void
+    CheckRCs(std::vector<RouterContact>& rcs) const = 0;
+
     virtual bool
     GetRandomWhitelistRouter(RouterID& router) const = 0;
 
@@ -59,6 +81,20 @@ namespace llarp
 
     virtual size_t
     NumberOfStrictConnectRouters() const = 0;
+
+    /// fetch every rc peer has that was updated after since, a page at a time, unless a fetch
+    /// from peer is going already
+    virtual void
+    FetchRCsFrom(const RouterID& peer, llarp_time_t since) = 0;
+
+    /// a page of a fetch from peer came in, return false if we asked peer for no such thing
+    virtual bool
+    HandleRCPage(
+        const RouterID& peer,
+        uint64_t txid,
+        std::vector<RouterContact> rcs,
+        const RouterID& next,
+        bool last) = 0;
   };
 
 }  // namespace llarp
@@ -1,21 +1,24 @@
 #include <router/outbound_message_handler.hpp>
 
 #include <messages/link_message.hpp>
+#include <messages/relay.hpp>
 #include <router/i_outbound_session_maker.hpp>
 #include <link/i_link_manager.hpp>
 #include <constants/link_layer.hpp>
 #include <util/meta/memfn.hpp>
 #include <util/status.hpp>
+#include <util/tracy.hpp>
 
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 
 namespace llarp
 {
   const PathID_t OutboundMessageHandler::zeroID;
 
   OutboundMessageHandler::OutboundMessageHandler(size_t maxQueueSize)
-      : outboundQueue(maxQueueSize), removedPaths(20), removedSomePaths(false)
+      : outboundQueue(maxQueueSize), removedPaths(20)
   {}
 
   bool
@@ -23,23 +26,25 @@ namespace llarp
       const RouterID& remote, const ILinkMessage* msg, SendStatusHandler callback)
   {
     const uint16_t priority = msg->Priority();
-    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
-    llarp_buffer_t buf(linkmsg_buffer);
-
-    if (!EncodeBuffer(msg, buf))
-    {
-      return false;
-    }
-
+    const TrafficClass cls = msg->Class();
     Message message;
-    message.first.resize(buf.sz);
+    // peers that read the compact framing get it, messages still waiting on a session to be
+    // made go as bencode as the version is not known yet
+    const auto remoteVersion = _linkManager->RemoteVersionOf(remote);
+    const bool compact = remoteVersion and remoteVersion->IsAtLeast(CompactFramingVersion)
+        and msg->CompactEncode(message.first);
+    if (not compact and not EncodeMessage(msg, message.first))
+      return false;
+    if (compact and not remoteVersion->IsAtLeast(CongestionFlagVersion))
+      RelayCell::ClearCongested(message.first);
     message.second = callback;
-
-    std::copy_n(buf.base, buf.sz, message.first.data());
+    // relay cells from every path to this remote may share link messages
+    const bool bundle = compact and remoteVersion->IsAtLeast(CellBundleVersion)
+        and RelayCell::IsCompact(message.first);
 
     if (_linkManager->HasSessionTo(remote))
     {
-      QueueOutboundMessage(remote, std::move(message), msg->pathid, priority);
+      QueueOutboundMessage(remote, std::move(message), msg->pathid, cls, priority, bundle);
       return true;
     }
 
@@ -52,7 +57,8 @@ namespace llarp
 
       MessageQueueEntry entry;
       entry.priority = priority;
-      entry.message = message;
+      entry.cls = cls;
+      entry.message = std::move(message);
       entry.router = remote;
       itr_pair.first->second.push(std::move(entry));
 
@@ -71,9 +77,13 @@ namespace llarp
   OutboundMessageHandler::Tick()
   {
     m_Killer.TryAccess([self = this]() {
+      LLARP_ZONE("OutboundMessageHandler::Tick");
+      LLARP_PLOT("outbound queue", self->outboundQueue.size());
+      LLARP_PLOT("active path queues", self->activePaths.size());
       self->ProcessOutboundQueue();
       self->RemoveEmptyPathQueues();
-      self->SendRoundRobin();
+      self->SendDeficitRoundRobin();
+      self->FlushBundles();
     });
   }
 
@@ -89,6 +99,45 @@ namespace llarp
     });
   }
 
+  bool
+  OutboundMessageHandler::IsBackedUp(const RouterID& remote, const PathID_t& pathid) const
+  {
+    auto itr = outboundMessageQueues.find(pathid);
+    if (itr != outboundMessageQueues.end()
+        and itr->second.messages.size() >= BackedUpPathQueueSize)
+      return true;
+    // with no session yet the messages wait for one to be made, not for a window to drain
+    const size_t backlog = _linkManager->SendQueueBacklogTo(remote);
+    return backlog != std::numeric_limits<size_t>::max() and backlog >= BackedUpSendQueueSize;
+  }
+
+  bool
+  OutboundMessageHandler::IsCongested(const RouterID& remote, const PathID_t& pathid) const
+  {
+    auto itr = outboundMessageQueues.find(pathid);
+    if (itr != outboundMessageQueues.end()
+        and itr->second.messages.size() >= CongestedPathQueueSize)
+      return true;
+    const size_t backlog = _linkManager->SendQueueBacklogTo(remote);
+    return backlog != std::numeric_limits<size_t>::max() and backlog >= CongestedSendQueueSize;
+  }
+
+  double
+  OutboundMessageHandler::CongestedFraction() const
+  {
+    if (activePaths.empty())
+      return 0.0;
+    size_t congested = 0;
+    for (const auto& pathid : activePaths)
+    {
+      auto itr = outboundMessageQueues.find(pathid);
+      if (itr != outboundMessageQueues.end()
+          and itr->second.messages.size() >= CongestedPathQueueSize)
+        ++congested;
+    }
+    return double(congested) / double(activePaths.size());
+  }
+
   // TODO: this
   util::StatusObject
   OutboundMessageHandler::ExtractStatus() const
@@ -97,6 +146,10 @@ namespace llarp
                               {{"queued", m_queueStats.queued},
                                {"dropped", m_queueStats.dropped},
                                {"sent", m_queueStats.sent},
+                               {"deferred", m_queueStats.deferred},
+                               {"bundled", m_queueStats.bundled},
+                               {"bundlesWaiting", m_Bundles.size()},
+                               {"activePaths", activePaths.size()},
                                {"queueWatermark", m_queueStats.queueWatermark},
                                {"perTickMax", m_queueStats.perTickMax},
                                {"numTicks", m_queueStats.numTicks}}};
@@ -110,7 +163,7 @@ namespace llarp
     _linkManager = linkManager;
     _logic = logic;
 
-    outboundMessageQueues.emplace(zeroID, MessageQueue());
+    outboundMessageQueues.emplace(zeroID, PathQueue());
   }
 
   void
@@ -203,34 +256,143 @@ namespace llarp
   }
 
   bool
-  OutboundMessageHandler::Send(const RouterID& remote, const Message& msg)
+  OutboundMessageHandler::EncodeMessage(const ILinkMessage* msg, ILinkSession::Message_t& out)
+  {
+    const size_t size = msg->EncodedSize();
+    if (size > 0 and size <= MAX_LINK_MSG_SIZE)
+    {
+      out.resize(size);
+      llarp_buffer_t buf(out);
+      if (msg->BEncode(&buf))
+      {
+        out.resize(buf.cur - buf.base);
+        return true;
+      }
+      LogWarn(msg->Name(), " did not encode in the ", size, " bytes it said it needs");
+    }
+    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
+    llarp_buffer_t buf(linkmsg_buffer);
+    if (not EncodeBuffer(msg, buf))
+      return false;
+    out.assign(buf.base, buf.base + buf.sz);
+    return true;
+  }
+
+  OutboundMessageHandler::MessageQueueEntry
+  OutboundMessageHandler::PopTop(MessageQueue& queue)
+  {
+    MessageQueueEntry entry = std::move(const_cast<MessageQueueEntry&>(queue.top()));
+    queue.pop();
+    return entry;
+  }
+
+  bool
+  OutboundMessageHandler::Send(const RouterID& remote, Message&& msg, TrafficClass cls)
   {
-    const llarp_buffer_t buf(msg.first);
     auto callback = msg.second;
     m_queueStats.sent++;
-    return _linkManager->SendTo(remote, buf, [=](ILinkSession::DeliveryStatus status) {
-      if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
-        DoCallback(callback, SendStatus::Success);
-      else
+    return _linkManager->SendTo(
+        remote,
+        std::move(msg.first),
+        [=](ILinkSession::DeliveryStatus status) {
+          if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
+            DoCallback(callback, SendStatus::Success);
+          else
+          {
+            DoCallback(callback, SendStatus::Congestion);
+          }
+        },
+        cls);
+  }
+
+  bool
+  OutboundMessageHandler::JoinsBundle(const RouterID& remote, const MessageQueueEntry& entry) const
+  {
+    if (not entry.bundle)
+      return false;
+    auto itr = m_Bundles.find(remote);
+    return itr != m_Bundles.end()
+        and RelayCell::BundledSize(itr->second.data, entry.message.first.size())
+        <= MAX_LINK_MSG_SIZE;
+  }
+
+  void
+  OutboundMessageHandler::AddToBundle(const RouterID& remote, Message&& msg, TrafficClass cls)
+  {
+    auto [itr, inserted] = m_Bundles.try_emplace(remote);
+    auto& bundle = itr->second;
+    if (not inserted
+        and RelayCell::BundledSize(bundle.data, msg.first.size()) > MAX_LINK_MSG_SIZE)
+    {
+      FlushBundle(remote, bundle);
+      inserted = true;
+    }
+    if (inserted)
+      bundle.started = coarse_now_ms();
+    else
+      m_queueStats.bundled++;
+    RelayCell::AddToBundle(bundle.data, msg.first);
+    if (msg.second)
+      bundle.callbacks.emplace_back(std::move(msg.second));
+    // the bundle goes in the class of the most urgent cell in it
+    bundle.cls = std::min(bundle.cls, cls);
+  }
+
+  void
+  OutboundMessageHandler::FlushBundle(const RouterID& remote, CellBundle& bundle)
+  {
+    Message msg;
+    msg.first = std::move(bundle.data);
+    if (bundle.callbacks.size() == 1)
+      msg.second = std::move(bundle.callbacks.front());
+    else if (not bundle.callbacks.empty())
+    {
+      msg.second = [callbacks = std::move(bundle.callbacks)](SendStatus status) {
+        for (const auto& callback : callbacks)
+          callback(status);
+      };
+    }
+    const auto cls = bundle.cls;
+    bundle = CellBundle{};
+    Send(remote, std::move(msg), cls);
+  }
+
+  void
+  OutboundMessageHandler::FlushBundles()
+  {
+    if (m_Bundles.empty())
+      return;
+    const auto now = coarse_now_ms();
+    for (auto itr = m_Bundles.begin(); itr != m_Bundles.end();)
+    {
+      if (now >= itr->second.started + m_BundleDelay)
       {
-        DoCallback(callback, SendStatus::Congestion);
+        FlushBundle(itr->first, itr->second);
+        itr = m_Bundles.erase(itr);
       }
-    });
+      else
+        ++itr;
+    }
   }
 
   bool
-  OutboundMessageHandler::SendIfSession(const RouterID& remote, const Message& msg)
+  OutboundMessageHandler::SendIfSession(const RouterID& remote, Message&& msg, TrafficClass cls)
   {
     if (_linkManager->HasSessionTo(remote))
     {
-      return Send(remote, msg);
+      return Send(remote, std::move(msg), cls);
     }
     return false;
   }
 
   bool
   OutboundMessageHandler::QueueOutboundMessage(
-      const RouterID& remote, Message&& msg, const PathID_t& pathid, uint16_t priority)
+      const RouterID& remote,
+      Message&& msg,
+      const PathID_t& pathid,
+      TrafficClass cls,
+      uint16_t priority,
+      bool bundle)
   {
     MessageQueueEntry entry;
     entry.message = std::move(msg);
@@ -238,6 +400,8 @@ namespace llarp
     entry.router = remote;
     entry.pathid = pathid;
     entry.priority = priority;
+    entry.cls = cls;
+    entry.bundle = bundle;
     if (outboundQueue.tryPushBack(std::move(entry)) != llarp::thread::QueueReturn::Success)
     {
       m_queueStats.dropped++;
@@ -266,18 +430,16 @@ namespace llarp
       // TODO: can we add util::thread::Queue::front() for move semantics here?
       MessageQueueEntry entry = outboundQueue.popFront();
 
-      auto itr_pair = outboundMessageQueues.emplace(entry.pathid, MessageQueue());
+      PathQueue& path_queue = outboundMessageQueues[entry.pathid];
 
-      if (itr_pair.second && !entry.pathid.IsZero())
+      if (path_queue.messages.size() < MAX_PATH_QUEUE_SIZE || entry.pathid.IsZero())
       {
-        roundRobinOrder.push(entry.pathid);
-      }
-
-      MessageQueue& path_queue = itr_pair.first->second;
-
-      if (path_queue.size() < MAX_PATH_QUEUE_SIZE || entry.pathid.IsZero())
-      {
-        path_queue.push(std::move(entry));
+        if (not path_queue.active and not entry.pathid.IsZero())
+        {
+          path_queue.active = true;
+          activePaths.push_back(entry.pathid);
+        }
+        path_queue.messages.push(std::move(entry));
       }
       else
       {
@@ -294,86 +456,98 @@ namespace llarp
   void
   OutboundMessageHandler::RemoveEmptyPathQueues()
   {
-    removedSomePaths = false;
-    if (removedPaths.empty())
-      return;
-
     while (not removedPaths.empty())
     {
-      auto itr = outboundMessageQueues.find(removedPaths.popFront());
-      if (itr != outboundMessageQueues.end())
-      {
-        outboundMessageQueues.erase(itr);
-      }
+      const PathID_t pathid = removedPaths.popFront();
+      auto itr = outboundMessageQueues.find(pathid);
+      if (itr == outboundMessageQueues.end())
+        continue;
+      if (itr->second.active)
+        activePaths.erase(std::find(activePaths.begin(), activePaths.end(), pathid));
+      outboundMessageQueues.erase(itr);
     }
-    removedSomePaths = true;
   }
 
   void
-  OutboundMessageHandler::SendRoundRobin()
+  OutboundMessageHandler::SendDeficitRoundRobin()
   {
     m_queueStats.numTicks++;
 
+    // messages each remote's link can take this tick, from how many it has queued already
+    std::unordered_map<RouterID, size_t, RouterID::Hash> budgets;
+    const auto budgetFor = [&](const RouterID& remote) -> size_t& {
+      auto [itr, inserted] = budgets.try_emplace(remote, 0);
+      if (inserted)
+      {
+        const size_t backlog = _linkManager->SendQueueBacklogTo(remote);
+        itr->second = backlog < MaxSendQueueSize ? MaxSendQueueSize - backlog : 0;
+      }
+      return itr->second;
+    };
+
     // send non-routing messages first priority
-    auto& non_routing_mq = outboundMessageQueues[zeroID];
+    auto& non_routing_mq = outboundMessageQueues[zeroID].messages;
     while (not non_routing_mq.empty())
     {
-      const MessageQueueEntry& entry = non_routing_mq.top();
-      Send(entry.router, entry.message);
-      non_routing_mq.pop();
+      auto entry = PopTop(non_routing_mq);
+      auto& budget = budgetFor(entry.router);
+      if (budget > 0)
+        budget--;
+      Send(entry.router, std::move(entry.message), entry.cls);
     }
 
-    size_t empty_count = 0;
-    size_t num_queues = roundRobinOrder.size();
-
-    if (removedSomePaths)
+    // each round every path with something queued may send up to Quantum more bytes than it
+    // has sent so far, so paths share the link by bytes however big their messages are. a
+    // path whose next message goes to a link that is full waits for the next tick. relay
+    // cells gather in one bundle per remote, which only takes its link slot once
+    size_t sent_count = 0;
+    bool progress = true;
+    while (progress and sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK)
     {
-      for (size_t i = 0; i < num_queues; i++)
+      progress = false;
+      for (size_t num = activePaths.size(); num > 0; --num)
       {
-        PathID_t pathid = std::move(roundRobinOrder.front());
-        roundRobinOrder.pop();
+        const PathID_t pathid = activePaths.front();
+        activePaths.pop_front();
+        PathQueue& path_queue = outboundMessageQueues[pathid];
+        path_queue.deficit += Quantum;
 
-        if (outboundMessageQueues.find(pathid) != outboundMessageQueues.end())
+        while (not path_queue.messages.empty() and sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK)
         {
-          roundRobinOrder.push(std::move(pathid));
+          const auto& top = path_queue.messages.top();
+          const size_t size = top.message.first.size();
+          if (size > path_queue.deficit)
+            break;
+          auto& budget = budgetFor(top.router);
+          const bool joins = JoinsBundle(top.router, top);
+          if (budget == 0 and not joins)
+          {
+            m_queueStats.deferred++;
+            break;
+          }
+          if (not joins)
+            budget--;
+          path_queue.deficit -= size;
+          auto entry = PopTop(path_queue.messages);
+          if (entry.bundle)
+            AddToBundle(entry.router, std::move(entry.message), entry.cls);
+          else
+            Send(entry.router, std::move(entry.message), entry.cls);
+          sent_count++;
+          progress = true;
         }
-      }
-    }
-
-    num_queues = roundRobinOrder.size();
-    size_t sent_count = 0;
-    if (num_queues == 0)  // if no queues, return
-    {
-      return;
-    }
-
-    while (sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK)  // TODO: better stop condition
-    {
-      PathID_t pathid = std::move(roundRobinOrder.front());
-      roundRobinOrder.pop();
-
-      auto& message_queue = outboundMessageQueues[pathid];
-      if (message_queue.size() > 0)
-      {
-        const MessageQueueEntry& entry = message_queue.top();
 
-        Send(entry.router, entry.message);
-        message_queue.pop();
-
-        empty_count = 0;
-        sent_count++;
-      }
-      else
-      {
-        empty_count++;
-      }
-
-      roundRobinOrder.push(std::move(pathid));
-
-      // if num_queues empty queues in a row, all queues empty.
-      if (empty_count == num_queues)
-      {
-        break;
+        if (path_queue.messages.empty())
+        {
+          path_queue.deficit = 0;
+          path_queue.active = false;
+        }
+        else
+        {
+          // a path held back by its link does not bank credit while it waits
+          path_queue.deficit = std::min(path_queue.deficit, Quantum);
+          activePaths.push_back(pathid);
+        }
       }
     }
 
@@ -400,17 +574,16 @@ namespace llarp
 
     while (!movedMessages.empty())
     {
-      const MessageQueueEntry& entry = movedMessages.top();
+      auto entry = PopTop(movedMessages);
 
       if (status == SendStatus::Success)
       {
-        Send(entry.router, entry.message);
+        Send(entry.router, std::move(entry.message), entry.cls);
       }
       else
       {
         DoCallback(entry.message.second, status);
       }
-      movedMessages.pop();
     }
   }
 
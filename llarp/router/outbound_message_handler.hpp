@@ -3,15 +3,20 @@
 
 #include <router/i_outbound_message_handler.hpp>
 
+#include <constants/link_layer.hpp>
+#include <link/session.hpp>
 #include <util/thread/logic.hpp>
 #include <util/thread/queue.hpp>
+#include <util/time.hpp>
 #include <path/path_types.hpp>
 #include <router_id.hpp>
 
+#include <deque>
 #include <list>
 #include <unordered_map>
 #include <utility>
 #include <queue>
+#include <vector>
 
 struct llarp_buffer_t;
 
@@ -38,21 +43,42 @@ namespace llarp
     void
     QueueRemoveEmptyPath(const PathID_t& pathid) override;
 
+    bool
+    IsBackedUp(const RouterID& remote, const PathID_t& pathid) const override;
+
+    bool
+    IsCongested(const RouterID& remote, const PathID_t& pathid) const override;
+
+    double
+    CongestedFraction() const override;
+
     util::StatusObject
     ExtractStatus() const override;
 
     void
     Init(ILinkManager* linkManager, std::shared_ptr<Logic> logic);
 
+    /// how long relay cells to a next hop may wait for more to share their link message,
+    /// 0 only bundles what is sent in the same tick
+    void
+    SetBundleDelay(llarp_time_t delay)
+    {
+      m_BundleDelay = delay;
+    }
+
    private:
-    using Message = std::pair<std::vector<byte_t>, SendStatusHandler>;
+    /// encoded straight into the buffer the link session is handed
+    using Message = std::pair<ILinkSession::Message_t, SendStatusHandler>;
 
     struct MessageQueueEntry
     {
       uint16_t priority;
+      TrafficClass cls = TrafficClass::Control;
       Message message;
       PathID_t pathid;
       RouterID router;
+      /// a compact relay cell to a remote that reads bundles
+      bool bundle = false;
 
       bool
       operator<(const MessageQueueEntry& other) const
@@ -66,6 +92,10 @@ namespace llarp
       uint64_t queued = 0;
       uint64_t dropped = 0;
       uint64_t sent = 0;
+      /// times a path's next message waited a tick for its link to drain
+      uint64_t deferred = 0;
+      /// relay cells that went in a bundle with others instead of their own link message
+      uint64_t bundled = 0;
       uint32_t queueWatermark = 0;
 
       uint32_t perTickMax = 0;
@@ -74,6 +104,41 @@ namespace llarp
 
     using MessageQueue = std::priority_queue<MessageQueueEntry>;
 
+    /// a path's messages and its deficit round robin state
+    struct PathQueue
+    {
+      MessageQueue messages;
+      /// bytes it may still send this round
+      size_t deficit = 0;
+      /// set while it is in activePaths
+      bool active = false;
+    };
+
+    /// relay cells for one next hop waiting to go as one link message
+    struct CellBundle
+    {
+      ILinkSession::Message_t data;
+      std::vector<SendStatusHandler> callbacks;
+      TrafficClass cls = TrafficClass::Bulk;
+      llarp_time_t started = 0s;
+    };
+
+    /// bytes each path is credited per round, enough for the largest message
+    static constexpr size_t Quantum = MAX_LINK_MSG_SIZE;
+
+    /// a path queue this full is backed up
+    static constexpr size_t BackedUpPathQueueSize = MAX_PATH_QUEUE_SIZE * 3 / 4;
+    /// a link session with this many messages in its send window is backed up
+    static constexpr size_t BackedUpSendQueueSize = MaxSendQueueSize * 3 / 4;
+    /// half way there traffic through is congested, but still goes
+    static constexpr size_t CongestedPathQueueSize = MAX_PATH_QUEUE_SIZE / 2;
+    static constexpr size_t CongestedSendQueueSize = MaxSendQueueSize / 2;
+
+    /// pop the top entry, moving its message out. the queue orders only by priority, which the
+    /// move leaves alone, so the pop still sees a good heap
+    static MessageQueueEntry
+    PopTop(MessageQueue& queue);
+
     void
     OnSessionEstablished(const RouterID& router);
 
@@ -101,15 +166,40 @@ namespace llarp
     bool
     EncodeBuffer(const ILinkMessage* msg, llarp_buffer_t& buf);
 
+    /// encode msg into out, sized exactly when msg knows its size up front
+    bool
+    EncodeMessage(const ILinkMessage* msg, ILinkSession::Message_t& out);
+
+    bool
+    Send(const RouterID& remote, Message&& msg, TrafficClass cls);
+
+    /// true if msg can join the bundle already waiting for remote
     bool
-    Send(const RouterID& remote, const Message& msg);
+    JoinsBundle(const RouterID& remote, const MessageQueueEntry& entry) const;
+
+    /// add a relay cell to remote's bundle, sending what is there first if it will not fit
+    void
+    AddToBundle(const RouterID& remote, Message&& msg, TrafficClass cls);
+
+    /// send bundle to remote as one link message and empty it
+    void
+    FlushBundle(const RouterID& remote, CellBundle& bundle);
+
+    /// send the bundles that have waited long enough
+    void
+    FlushBundles();
 
     bool
-    SendIfSession(const RouterID& remote, const Message& msg);
+    SendIfSession(const RouterID& remote, Message&& msg, TrafficClass cls);
 
     bool
     QueueOutboundMessage(
-        const RouterID& remote, Message&& msg, const PathID_t& pathid, uint16_t priority = 0);
+        const RouterID& remote,
+        Message&& msg,
+        const PathID_t& pathid,
+        TrafficClass cls,
+        uint16_t priority = 0,
+        bool bundle = false);
 
     void
     ProcessOutboundQueue();
@@ -118,23 +208,26 @@ namespace llarp
     RemoveEmptyPathQueues();
 
     void
-    SendRoundRobin();
+    SendDeficitRoundRobin();
 
     void
     FinalizeSessionRequest(const RouterID& router, SendStatus status) EXCLUDES(_mutex);
 
     llarp::thread::Queue<MessageQueueEntry> outboundQueue;
     llarp::thread::Queue<PathID_t> removedPaths;
-    bool removedSomePaths;
 
     mutable util::Mutex _mutex;  // protects pendingSessionMessageQueues
 
     std::unordered_map<RouterID, MessageQueue, RouterID::Hash> pendingSessionMessageQueues
         GUARDED_BY(_mutex);
 
-    std::unordered_map<PathID_t, MessageQueue, PathID_t::Hash> outboundMessageQueues;
+    std::unordered_map<PathID_t, PathQueue, PathID_t::Hash> outboundMessageQueues;
+
+    /// paths with messages queued, in the order they are served
+    std::deque<PathID_t> activePaths;
 
-    std::queue<PathID_t> roundRobinOrder;
+    std::unordered_map<RouterID, CellBundle, RouterID::Hash> m_Bundles;
+    llarp_time_t m_BundleDelay = 0s;
 
     ILinkManager* _linkManager;
     std::shared_ptr<Logic> _logic;
@@ -13,21 +13,28 @@
 #include <util/status.hpp>
 #include <crypto/crypto.hpp>
 #include <utility>
+#include <vector>
 
 namespace llarp
 {
   struct PendingSession
   {
-    // TODO: add session establish status metadata, e.g. num retries
-
     const RouterContact rc;
-    LinkLayer_ptr link;
-
-    size_t attemptCount = 0;
-
-    PendingSession(RouterContact _rc, LinkLayer_ptr _link)
-        : rc(std::move(_rc)), link(std::move(_link))
+    /// every link and address rc can be reached on, raced in this order
+    std::vector<std::pair<LinkLayer_ptr, AddressInfo>> candidates;
+    /// the next candidate to start
+    size_t next = 0;
+    /// attempts started that have not timed out
+    size_t inFlight = 0;
+
+    explicit PendingSession(RouterContact _rc) : rc(std::move(_rc))
     {}
+
+    bool
+    Exhausted() const
+    {
+      return next >= candidates.size();
+    }
   };
 
   bool
@@ -55,13 +62,27 @@ namespace llarp
   void
   OutboundSessionMaker::OnConnectTimeout(ILinkSession* session)
   {
-    // TODO: retry/num attempts
+    const RouterID router{session->GetPubKey()};
+    bool failed = false;
+    bool next = false;
+    {
+      util::Lock l(_mutex);
+      auto itr = pendingSessions.find(router);
+      // an attempt that lost the race to one that got through
+      if (itr == pendingSessions.end() or itr->second == nullptr)
+        return;
+      auto& job = *itr->second;
+      if (job.inFlight > 0)
+        job.inFlight--;
+      next = not job.Exhausted();
+      failed = job.inFlight == 0 and not next;
+    }
     LogWarn(
-        "Session establish attempt to ",
-        RouterID(session->GetPubKey()),
-        " timed out.",
-        session->GetRemoteEndpoint());
-    FinalizeRequest(session->GetPubKey(), SessionResult::Timeout);
+        "Session establish attempt to ", router, " timed out.", session->GetRemoteEndpoint());
+    if (failed)
+      FinalizeRequest(router, SessionResult::Timeout);
+    else if (next)
+      DoEstablish(router);
   }
 
   void
@@ -143,12 +164,14 @@ namespace llarp
         "connecting to ", numDesired - remainingDesired, " out of ", numDesired, " random routers");
   }
 
-  // TODO: this
   util::StatusObject
   OutboundSessionMaker::ExtractStatus() const
   {
-    util::StatusObject status{};
-    return status;
+    util::Lock l(_mutex);
+    return util::StatusObject{
+        {"pending", pendingSessions.size()},
+        {"attempts", _attempts},
+        {"racedAttempts", _racedAttempts}};
   }
 
   void
@@ -173,23 +196,39 @@ namespace llarp
   void
   OutboundSessionMaker::DoEstablish(const RouterID& router)
   {
-    std::unique_lock l{_mutex};
-
-    auto itr = pendingSessions.find(router);
-
-    if (itr == pendingSessions.end())
+    bool failed = false;
+    bool more = false;
     {
-      return;
+      util::Lock l(_mutex);
+      auto itr = pendingSessions.find(router);
+      if (itr == pendingSessions.end() or itr->second == nullptr)
+        return;
+      auto& job = *itr->second;
+      // start the next candidate that takes, one that can't start now is skipped
+      while (not job.Exhausted())
+      {
+        const auto& [link, addr] = job.candidates[job.next++];
+        if (link->TryEstablishTo(job.rc, addr))
+        {
+          if (job.inFlight++ > 0)
+            _racedAttempts++;
+          _attempts++;
+          break;
+        }
+      }
+      failed = job.inFlight == 0;
+      more = not job.Exhausted();
     }
-
-    const auto& job = itr->second;
-    if (!job->link->TryEstablishTo(job->rc))
+    if (failed)
     {
       // TODO: maybe different failure type?
-
-      l.unlock();
       FinalizeRequest(router, SessionResult::NoLink);
+      return;
     }
+    // happy eyeballs: if this one has not got through by the time the stagger is up, race the
+    // next one against it. whichever establishes first finalizes the request
+    if (more)
+      _logic->call_later(ConnectStagger, [this, router]() { DoEstablish(router); });
   }
 
   void
@@ -205,18 +244,32 @@ namespace llarp
       {
         return;
       }
+      // a second lookup finding the rc while the first is already racing changes nothing
+      if (itr->second)
+        return;
 
-      LinkLayer_ptr link = _linkManager->GetCompatibleLink(rc);
+      // take turns between the links so each gets its first address in early
+      std::vector<std::vector<AddressInfo>> addrs;
+      const auto links = _linkManager->GetCompatibleLinks(rc);
+      for (const auto& link : links)
+        addrs.emplace_back(link->PickAddresses(rc));
+      auto session = std::make_shared<PendingSession>(rc);
+      for (size_t idx = 0; idx < rc.addrs.size(); ++idx)
+      {
+        for (size_t link = 0; link < links.size(); ++link)
+        {
+          if (idx < addrs[link].size())
+            session->candidates.emplace_back(links[link], addrs[link][idx]);
+        }
+      }
 
-      if (!link)
+      if (session->candidates.empty())
       {
         l.unlock();
         FinalizeRequest(router, SessionResult::NoLink);
         return;
       }
 
-      auto session = std::make_shared<PendingSession>(rc, link);
-
       itr->second = session;
     }
     if (ShouldConnectTo(router))
@@ -77,6 +77,9 @@ namespace llarp
     /// hard upperbound limit on the number of router to router connections
     size_t maxConnectedRouters = 6;
 
+    /// how long an attempt gets to itself before the next address is raced against it
+    static constexpr llarp_time_t ConnectStagger = 250ms;
+
    private:
     void
     DoEstablish(const RouterID& router) EXCLUDES(_mutex);
@@ -111,6 +114,10 @@ namespace llarp
     std::unordered_map<RouterID, CallbacksQueue, RouterID::Hash> pendingCallbacks
         GUARDED_BY(_mutex);
 
+    /// attempts started, and of those how many were raced against one already going
+    uint64_t _attempts GUARDED_BY(_mutex) = 0;
+    uint64_t _racedAttempts GUARDED_BY(_mutex) = 0;
+
     AbstractRouter* _router = nullptr;
     ILinkManager* _linkManager = nullptr;
     I_RCLookupHandler* _rcLookup = nullptr;
@@ -0,0 +1,84 @@
+#include <router/peer_usage.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  double
+  PeerUsage::ScoreAt(const Entry& entry, llarp_time_t now)
+  {
+    if (now <= entry.updated)
+      return entry.score;
+    const auto age = std::chrono::duration<double>(now - entry.updated);
+    return entry.score * std::exp2(-(age / HalfLife));
+  }
+
+  void
+  PeerUsage::Use(const RouterID& peer, llarp_time_t now)
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    auto& entry = m_Peers[peer];
+    entry.score = ScoreAt(entry, now) + 1.0;
+    entry.updated = now;
+  }
+
+  std::vector<RouterID>
+  PeerUsage::Busiest(size_t num, llarp_time_t now) const
+  {
+    std::vector<std::pair<double, RouterID>> scored;
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      scored.reserve(m_Peers.size());
+      for (const auto& [peer, entry] : m_Peers)
+      {
+        const auto score = ScoreAt(entry, now);
+        if (score >= MinScore)
+          scored.emplace_back(score, peer);
+      }
+    }
+    num = std::min(num, scored.size());
+    std::partial_sort(
+        scored.begin(), scored.begin() + num, scored.end(), [](const auto& a, const auto& b) {
+          return a.first > b.first;
+        });
+    std::vector<RouterID> busiest;
+    busiest.reserve(num);
+    for (size_t idx = 0; idx < num; ++idx)
+      busiest.emplace_back(scored[idx].second);
+    return busiest;
+  }
+
+  void
+  PeerUsage::Decay(llarp_time_t now)
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    for (auto itr = m_Peers.begin(); itr != m_Peers.end();)
+    {
+      if (ScoreAt(itr->second, now) < MinScore)
+        itr = m_Peers.erase(itr);
+      else
+        ++itr;
+    }
+  }
+
+  size_t
+  PeerUsage::Size() const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    return m_Peers.size();
+  }
+
+  util::StatusObject
+  PeerUsage::ExtractStatus(llarp_time_t now) const
+  {
+    std::lock_guard<std::mutex> lock{m_Mutex};
+    size_t busy = 0;
+    for (const auto& item : m_Peers)
+    {
+      if (ScoreAt(item.second, now) >= MinScore)
+        busy++;
+    }
+    return {{"tracked", m_Peers.size()}, {"busy", busy}};
+  }
+}  // namespace llarp
@@ -0,0 +1,55 @@
+#ifndef LLARP_PEER_USAGE_HPP
+#define LLARP_PEER_USAGE_HPP
+
+#include <router_id.hpp>
+#include <util/status.hpp>
+#include <util/types.hpp>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  /// how much our paths, transit hops and dht lookups go through each peer, with old use
+  /// decaying away, so we know which sessions are worth keeping warm. safe from any thread
+  struct PeerUsage
+  {
+    /// a use counts half as much after this long
+    static constexpr std::chrono::milliseconds HalfLife = 10min;
+    /// peers used less than this are idle, a single use stays above it for one half life
+    static constexpr double MinScore = 0.5;
+
+    void
+    Use(const RouterID& peer, llarp_time_t now);
+
+    /// up to num peers that are not idle, most used first
+    std::vector<RouterID>
+    Busiest(size_t num, llarp_time_t now) const;
+
+    /// forget the idle peers
+    void
+    Decay(llarp_time_t now);
+
+    size_t
+    Size() const;
+
+    util::StatusObject
+    ExtractStatus(llarp_time_t now) const;
+
+   private:
+    struct Entry
+    {
+      double score = 0;
+      llarp_time_t updated = 0s;
+    };
+
+    static double
+    ScoreAt(const Entry& entry, llarp_time_t now);
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<RouterID, Entry, RouterID::Hash> m_Peers;
+  };
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,76 @@
+#include <router/rc_digest.hpp>
+
+#include <util/endian.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  static uint64_t
+  Mix(uint64_t x)
+  {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  RCDigest::RCDigest(size_t num, uint64_t _seed) : seed(_seed)
+  {
+    num = std::max(num, size_t{1});
+    const double ln2 = std::log(2.0);
+    const double wanted = -double(num) * std::log(FalsePositiveRate) / (ln2 * ln2);
+    bits.resize(std::clamp<size_t>(std::ceil(wanted / 8), 8, MaxBytes));
+    hashes = std::clamp<size_t>(std::lround(double(bits.size() * 8) / num * ln2), 1, MaxHashes);
+  }
+
+  /// double hashing of the id and last updated time mixed with the seed. the id words are read
+  /// big endian so hosts of either byte order find the same bits
+  template <typename Visit_t>
+  void
+  RCDigest::ForEachBit(const RouterContact& rc, Visit_t visit) const
+  {
+    const uint64_t updated = rc.last_updated.count();
+    const uint64_t h1 = Mix(bufbe64toh(rc.pubkey.data()) ^ seed ^ updated);
+    const uint64_t h2 = Mix(bufbe64toh(rc.pubkey.data() + 8) ^ Mix(h1)) | 1;
+    const uint64_t numBits = bits.size() * 8;
+    for (uint64_t idx = 0; idx < hashes; ++idx)
+    {
+      if (not visit((h1 + idx * h2) % numBits))
+        return;
+    }
+  }
+
+  void
+  RCDigest::Add(const RouterContact& rc)
+  {
+    if (not IsValid())
+      return;
+    ForEachBit(rc, [this](uint64_t bit) {
+      bits[bit / 8] |= 1 << (bit % 8);
+      return true;
+    });
+  }
+
+  bool
+  RCDigest::Contains(const RouterContact& rc) const
+  {
+    if (not IsValid())
+      return false;
+    bool all = true;
+    ForEachBit(rc, [this, &all](uint64_t bit) {
+      all = bits[bit / 8] & (1 << (bit % 8));
+      return all;
+    });
+    return all;
+  }
+
+  bool
+  RCDigest::IsValid() const
+  {
+    return not bits.empty() and bits.size() <= MaxBytes and hashes > 0 and hashes <= MaxHashes;
+  }
+}  // namespace llarp
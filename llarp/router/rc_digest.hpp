@@ -0,0 +1,50 @@
+#ifndef LLARP_RC_DIGEST_HPP
+#define LLARP_RC_DIGEST_HPP
+
+#include <router_contact.hpp>
+#include <util/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace llarp
+{
+  /// a bloom filter of the rcs a router has, by router id and last updated, that it sends its
+  /// peers so they send it only the rcs it is missing or holds an older copy of. the seed goes
+  /// with the bits so both ends hash the same, a fresh seed per digest keeps a false positive
+  /// from hiding the same rc from a peer digest after digest
+  struct RCDigest
+  {
+    /// largest digest we make or take
+    static constexpr size_t MaxBytes = 4096;
+    static constexpr size_t MaxHashes = 16;
+    static constexpr double FalsePositiveRate = 0.01;
+
+    RCDigest() = default;
+
+    /// an empty digest sized for num rcs, at most MaxBytes however many that is
+    RCDigest(size_t num, uint64_t seed);
+
+    void
+    Add(const RouterContact& rc);
+
+    /// true if we have this rc or a copy as new, or by chance
+    bool
+    Contains(const RouterContact& rc) const;
+
+    /// true if the sizes are ones we would make, so a peer's digest is safe to look in
+    bool
+    IsValid() const;
+
+    std::vector<byte_t> bits;
+    uint64_t hashes = 0;
+    uint64_t seed = 0;
+
+   private:
+    template <typename Visit_t>
+    void
+    ForEachBit(const RouterContact& rc, Visit_t visit) const;
+  };
+}  // namespace llarp
+
+#endif
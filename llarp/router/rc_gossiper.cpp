@@ -1,9 +1,14 @@
 #include <router/rc_gossiper.hpp>
 #include <messages/dht_immediate.hpp>
 #include <dht/messages/gotrouter.hpp>
+#include <dht/messages/rcdigest.hpp>
+#include <nodedb.hpp>
 #include <util/time.hpp>
 #include <constants/link_layer.hpp>
 #include <tooling/rc_event.hpp>
+#include <crypto/crypto.hpp>
+
+#include <algorithm>
 
 namespace llarp
 {
@@ -11,6 +16,13 @@ namespace llarp
   static constexpr auto RCGossipFilterDecayInterval = 30min;
   // (30 minutes * 2) - 5 minutes
   static constexpr auto GossipOurRCInterval = (RCGossipFilterDecayInterval * 2) - (5min);
+  /// how often we send our peers a digest of our nodedb, well inside the filter decay so a
+  /// peer's digest is fresh when an rc it has comes around again
+  static constexpr auto RCDigestInterval = 10min;
+  /// most rcs we send for one digest, the rest wait for the next one
+  static constexpr size_t MaxPushPerDigest = 64;
+  /// rcs per gossip message we send for a digest, MAX_RC_SIZE each fits a link message
+  static constexpr size_t RCsPerPush = 4;
 
   RCGossiper::RCGossiper()
       : I_RCGossiper(), m_Filter(std::chrono::duration_cast<Time_t>(RCGossipFilterDecayInterval))
@@ -75,8 +87,13 @@ namespace llarp
     // send a GRCM as gossip method
     DHTImmediateMessage gossip;
     gossip.msgs.emplace_back(new dht::GotRouterMessage(dht::Key_t{}, 0, {rc}, false));
+    ILinkSession::Message_t encoded(MAX_LINK_MSG_SIZE / 2);
+    llarp_buffer_t buf(encoded);
+    if (not gossip.BEncode(&buf))
+      return false;
+    encoded.resize(buf.cur - buf.base);
 
-    // send it to everyone
+    // send it to everyone without it
     m_LinkManager->ForEachPeer([&](ILinkSession* peerSession) {
       // ensure connected session
       if (not(peerSession && peerSession->IsEstablished()))
@@ -85,20 +102,89 @@ namespace llarp
       const auto other_rc = peerSession->GetRemoteRC();
       if (not other_rc.IsPublicRouter())
         return;
-      // encode message
-      ILinkSession::Message_t msg;
-      msg.resize(MAX_LINK_MSG_SIZE / 2);
-      llarp_buffer_t buf(msg);
-      if (not gossip.BEncode(&buf))
+      // the peer told us it has this one
+      auto itr = m_PeerDigests.find(RouterID{other_rc.pubkey});
+      if (itr != m_PeerDigests.end() and itr->second.digest.Contains(rc))
+      {
+        m_Skipped++;
         return;
-      msg.resize(buf.cur - buf.base);
+      }
 
       m_router->NotifyRouterEvent<tooling::RCGossipSentEvent>(m_router->pubkey(), rc);
 
       // send message
-      peerSession->SendMessageBuffer(std::move(msg), nullptr);
+      peerSession->SendMessageBuffer(encoded, nullptr, TrafficClass::Bulk);
     });
     return true;
   }
 
+  void
+  RCGossiper::Tick(Time_t now)
+  {
+    // peers that went away, or stopped sending digests, get the full flood again
+    for (auto itr = m_PeerDigests.begin(); itr != m_PeerDigests.end();)
+    {
+      if (itr->second.received + 2 * RCDigestInterval < now)
+        itr = m_PeerDigests.erase(itr);
+      else
+        ++itr;
+    }
+    if (m_LinkManager == nullptr or now < m_NextDigestAt)
+      return;
+    m_NextDigestAt = now + RCDigestInterval;
+
+    auto nodedb = m_router->nodedb();
+    RCDigest digest(nodedb->num_loaded(), randint());
+    nodedb->visit([&digest](const RouterContact& rc) {
+      if (rc.IsPublicRouter())
+        digest.Add(rc);
+      return true;
+    });
+    DHTImmediateMessage msg;
+    msg.msgs.emplace_back(new dht::RCDigestMessage(dht::Key_t{}, std::move(digest)));
+    ILinkSession::Message_t encoded(MAX_LINK_MSG_SIZE);
+    llarp_buffer_t buf(encoded);
+    if (not msg.BEncode(&buf))
+    {
+      LogWarn("failed to encode our rc digest");
+      return;
+    }
+    encoded.resize(buf.cur - buf.base);
+
+    m_LinkManager->ForEachPeer([&encoded](ILinkSession* peerSession) {
+      if (peerSession and peerSession->IsEstablished()
+          and peerSession->GetRemoteRC().IsPublicRouter())
+        peerSession->SendMessageBuffer(encoded, nullptr, TrafficClass::Bulk);
+    });
+  }
+
+  void
+  RCGossiper::HandleDigest(const RouterID& from, RCDigest digest)
+  {
+    std::vector<RouterContact> missing;
+    m_router->nodedb()->visit([&](const RouterContact& rc) {
+      if (rc.IsPublicRouter() and RouterID{rc.pubkey} != from and not digest.Contains(rc))
+        missing.push_back(rc);
+      return missing.size() < MaxPushPerDigest;
+    });
+    m_PeerDigests[from] = PeerDigest{std::move(digest), time_now_ms()};
+
+    for (size_t idx = 0; idx < missing.size(); idx += RCsPerPush)
+    {
+      const auto end = missing.begin() + std::min(idx + RCsPerPush, missing.size());
+      DHTImmediateMessage push;
+      push.msgs.emplace_back(new dht::GotRouterMessage(
+          dht::Key_t{}, 0, std::vector<RouterContact>(missing.begin() + idx, end), false));
+      m_router->SendToOrQueue(from, &push);
+    }
+    m_Pushed += missing.size();
+  }
+
+  util::StatusObject
+  RCGossiper::ExtractStatus() const
+  {
+    return util::StatusObject{
+        {"peerDigests", m_PeerDigests.size()}, {"skipped", m_Skipped}, {"pushed", m_Pushed}};
+  }
+
 }  // namespace llarp
@@ -6,6 +6,10 @@
 #include <router/i_outbound_message_handler.hpp>
 #include <link/i_link_manager.hpp>
 #include <router/abstractrouter.hpp>
+#include <router/rc_digest.hpp>
+#include <util/status.hpp>
+
+#include <unordered_map>
 
 namespace llarp
 {
@@ -27,6 +31,15 @@ namespace llarp
     bool
     IsOurRC(const RouterContact& rc) const override;
 
+    void
+    Tick(Time_t now) override;
+
+    void
+    HandleDigest(const RouterID& from, RCDigest digest) override;
+
+    util::StatusObject
+    ExtractStatus() const;
+
     void
     Init(ILinkManager*, const RouterID&, AbstractRouter*);
 
@@ -36,6 +49,19 @@ namespace llarp
     ILinkManager* m_LinkManager = nullptr;
     util::DecayingHashSet<RouterID> m_Filter;
 
+    struct PeerDigest
+    {
+      RCDigest digest;
+      Time_t received;
+    };
+
+    /// the last digest from each peer, gossip skips peers that have the rc already
+    std::unordered_map<RouterID, PeerDigest, RouterID::Hash> m_PeerDigests;
+    Time_t m_NextDigestAt = 0s;
+    /// sends gossip left out because the peer had the rc, and rcs sent for digests
+    uint64_t m_Skipped = 0;
+    uint64_t m_Pushed = 0;
+
     AbstractRouter* m_router;
   };
 }  // namespace llarp
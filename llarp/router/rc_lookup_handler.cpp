@@ -10,26 +10,43 @@
 #include <util/thread/threading.hpp>
 #include <nodedb.hpp>
 #include <dht/context.hpp>
+#include <dht/messages/findrcs.hpp>
 #include <router/abstractrouter.hpp>
 
+#include <algorithm>
 #include <iterator>
 #include <functional>
+#include <memory>
 #include <random>
 
 namespace llarp
 {
+  std::shared_ptr<const RCLookupHandler::Whitelist_t>
+  RCLookupHandler::Whitelist() const
+  {
+    return std::atomic_load(&_whitelist);
+  }
+
   void
-  RCLookupHandler::AddValidRouter(const RouterID& router)
+  RCLookupHandler::ChangeWhitelist(std::function<void(Whitelist_t&)> change)
   {
+    // writers take turns so none of them lose another's change
     util::Lock l(_mutex);
-    whitelistRouters.insert(router);
+    auto next = std::make_shared<Whitelist_t>(*Whitelist());
+    change(*next);
+    std::atomic_store(&_whitelist, std::shared_ptr<const Whitelist_t>(std::move(next)));
+  }
+
+  void
+  RCLookupHandler::AddValidRouter(const RouterID& router)
+  {
+    ChangeWhitelist([&router](Whitelist_t& whitelist) { whitelist.Insert(router); });
   }
 
   void
   RCLookupHandler::RemoveValidRouter(const RouterID& router)
   {
-    util::Lock l(_mutex);
-    whitelistRouters.erase(router);
+    ChangeWhitelist([&router](Whitelist_t& whitelist) { whitelist.Remove(router); });
   }
 
   void
@@ -37,22 +54,53 @@ namespace llarp
   {
     if (routers.empty())
       return;
+    auto next = std::make_shared<Whitelist_t>();
+    for (const auto& router : routers)
+      next->Insert(router);
+    LogInfo("lokinet service node list now has ", next->Size(), " routers");
+
     util::Lock l(_mutex);
+    std::atomic_store(&_whitelist, std::shared_ptr<const Whitelist_t>(std::move(next)));
+  }
 
-    whitelistRouters.clear();
-    for (auto& router : routers)
-    {
-      whitelistRouters.emplace(router);
-    }
+  void
+  RCLookupHandler::UpdateRouterWhitelist(
+      const std::vector<RouterID>& added, const std::vector<RouterID>& removed)
+  {
+    size_t size = 0;
+    ChangeWhitelist([&](Whitelist_t& whitelist) {
+      for (const auto& router : removed)
+        whitelist.Remove(router);
+      for (const auto& router : added)
+        whitelist.Insert(router);
+      size = whitelist.Size();
+    });
+    LogInfo(
+        "lokinet service node list gained ",
+        added.size(),
+        " and lost ",
+        removed.size(),
+        " routers, now has ",
+        size);
+  }
+
+  void
+  RCLookupHandler::SetConsensusTable(std::shared_ptr<const consensus::Table> table)
+  {
+    LogInfo("consensus table now has ", table->Size(), " routers");
+    std::atomic_store(&_consensus, std::move(table));
+  }
 
-    LogInfo("lokinet service node list now has ", whitelistRouters.size(), " routers");
+  std::shared_ptr<const consensus::Table>
+  RCLookupHandler::ConsensusTable() const
+  {
+    return std::atomic_load(&_consensus);
   }
 
   bool
   RCLookupHandler::HaveReceivedWhitelist()
   {
-    util::Lock l(_mutex);
-    return not whitelistRouters.empty();
+    return not Whitelist()->Empty();
   }
 
   void
@@ -83,6 +131,10 @@ namespace llarp
         itr_pair.first->second.push_back(callback);
       }
       shouldDoLookup = itr_pair.second;
+      if (shouldDoLookup)
+        lookupsStarted++;
+      else
+        lookupsCoalesced++;
     }
 
     if (shouldDoLookup)
@@ -126,9 +178,7 @@ namespace llarp
       return false;
     }
 
-    util::Lock l(_mutex);
-
-    if (useWhitelist && whitelistRouters.find(remote) == whitelistRouters.end())
+    if (useWhitelist && not Whitelist()->Contains(remote))
     {
       return false;
     }
@@ -162,24 +212,227 @@ namespace llarp
     return true;
   }
 
+  void
+  RCLookupHandler::CheckRCs(std::vector<RouterContact>& rcs) const
+  {
+    rcs.erase(
+        std::remove_if(
+            rcs.begin(),
+            rcs.end(),
+            [this](const RouterContact& rc) {
+              if (RemoteIsAllowed(rc.pubkey))
+                return false;
+              _dht->impl->DelRCNodeAsync(dht::Key_t{rc.pubkey});
+              return true;
+            }),
+        rcs.end());
+    if (rcs.empty())
+      return;
+
+    auto valid = std::make_unique<bool[]>(rcs.size());
+    RouterContact::VerifyMany(rcs.data(), rcs.size(), _dht->impl->Now(), valid.get());
+    size_t idx = 0;
+    rcs.erase(
+        std::remove_if(
+            rcs.begin(),
+            rcs.end(),
+            [&valid, &idx](const RouterContact& rc) {
+              if (valid[idx++])
+                return false;
+              LogWarn("RC for ", RouterID(rc.pubkey), " is invalid");
+              return true;
+            }),
+        rcs.end());
+
+    for (const auto& rc : rcs)
+    {
+      if (not rc.IsPublicRouter())
+        continue;
+      LogDebug("Adding or updating RC for ", RouterID(rc.pubkey), " to nodedb and dht.");
+      _nodedb->UpdateAsyncIfNewer(rc);
+      _dht->impl->PutRCNodeAsync(rc);
+    }
+  }
+
   size_t
   RCLookupHandler::NumberOfStrictConnectRouters() const
   {
     return _strictConnectPubkeys.size();
   }
 
-  bool
-  RCLookupHandler::GetRandomWhitelistRouter(RouterID& router) const
+  util::StatusObject
+  RCLookupHandler::ExtractStatus() const
   {
     util::Lock l(_mutex);
+    return util::StatusObject{{"pending", pendingCallbacks.size()},
+                              {"started", lookupsStarted},
+                              {"coalesced", lookupsCoalesced},
+                              {"rcFetches", _rcFetches.size()},
+                              {"rcPagesFetched", _rcPagesFetched},
+                              {"rcsFetched", _rcsFetched},
+                              {"seedTakeovers", _seedTakeovers}};
+  }
+
+  /// how long a fetch may go without a page before another may start in its place
+  static constexpr auto RCFetchTimeout = 30s;
+  /// how long a bootstrap may go without a page before its share of the seed moves elsewhere
+  static constexpr auto SeedFetchTimeout = 5s;
+  /// most bootstraps the seed is split over
+  static constexpr size_t MaxSeedShares = 8;
+
+  void
+  RCLookupHandler::FetchRCsFrom(const RouterID& peer, llarp_time_t since)
+  {
+    const auto now = _dht->impl->Now();
+    const uint64_t txid = llarp::randint();
+    {
+      util::Lock l(_mutex);
+      auto itr = _rcFetches.find(peer);
+      if (itr != _rcFetches.end() and now < itr->second.lastPage + RCFetchTimeout)
+        return;
+      _rcFetches.insert_or_assign(peer, RCFetch{txid, since, now, RouterID{}, RouterID{}});
+    }
+    LogInfo("fetching rcs from ", peer);
+    _dht->impl->DHTSendTo(
+        peer, new dht::FindRCsMessage(txid, since, RouterID{}, dht::FindRCsMessage::MaxPages));
+  }
 
-    const auto sz = whitelistRouters.size();
-    auto itr = whitelistRouters.begin();
+  void
+  RCLookupHandler::SeedFromBootstraps(llarp_time_t now, bool start)
+  {
+    std::vector<std::pair<RouterID, RCFetch>> asks;
+    {
+      util::Lock l(_mutex);
+      std::vector<RouterID> idle;
+      std::vector<RouterID> quiet;
+      bool going = false;
+      for (const auto& id : _bootstrapRouterIDList)
+      {
+        const auto itr = _rcFetches.find(id);
+        if (itr == _rcFetches.end())
+          idle.emplace_back(id);
+        else if (now > itr->second.lastPage + SeedFetchTimeout)
+          quiet.emplace_back(id);
+        else
+          going = true;
+      }
+      static std::mt19937_64 rng{llarp::randint()};
+      std::shuffle(idle.begin(), idle.end(), rng);
+      if (not quiet.empty() and not idle.empty())
+      {
+        // shares that went quiet go to bootstraps that are not busy, from where the quiet
+        // one got to
+        while (not quiet.empty() and not idle.empty())
+        {
+          auto fetch = _rcFetches.extract(quiet.back());
+          quiet.pop_back();
+          LogInfo(
+              "bootstrap ", fetch.key(), " is slow, fetching its share from ", idle.back());
+          fetch.mapped().txid = llarp::randint();
+          fetch.mapped().lastPage = now;
+          asks.emplace_back(idle.back(), fetch.mapped());
+          idle.pop_back();
+          _seedTakeovers++;
+        }
+      }
+      else if (start and not going)
+      {
+        // none of them is getting anywhere, start over across all of them
+        for (const auto& id : quiet)
+        {
+          _rcFetches.erase(id);
+          idle.emplace_back(id);
+        }
+        // share i of n starts at the key whose first byte is 256 * i / n
+        const size_t shares = std::min(idle.size(), MaxSeedShares);
+        for (size_t i = 0; i < shares; ++i)
+        {
+          RouterID after;
+          RouterID until;
+          if (i > 0)
+          {
+            // the walk starts past after, so the share's first key is the one just past it
+            std::fill(after.begin(), after.end(), 0xff);
+            after[0] = (256 * i) / shares - 1;
+          }
+          if (i + 1 < shares)
+            until[0] = (256 * (i + 1)) / shares;
+          asks.emplace_back(idle[i], RCFetch{llarp::randint(), 0s, now, after, until});
+        }
+      }
+      for (const auto& [peer, fetch] : asks)
+        _rcFetches.insert_or_assign(peer, fetch);
+    }
+    for (const auto& [peer, fetch] : asks)
+    {
+      LogInfo("fetching rcs from ", peer);
+      _dht->impl->DHTSendTo(
+          peer,
+          new dht::FindRCsMessage(
+              fetch.txid, fetch.since, fetch.after, dht::FindRCsMessage::MaxPages));
+    }
+  }
+
+  bool
+  RCLookupHandler::HandleRCPage(
+      const RouterID& peer,
+      uint64_t txid,
+      std::vector<RouterContact> rcs,
+      const RouterID& next,
+      bool last)
+  {
+    bool askMore = false;
+    llarp_time_t since = 0s;
+    {
+      util::Lock l(_mutex);
+      auto itr = _rcFetches.find(peer);
+      if (itr == _rcFetches.end() or itr->second.txid != txid)
+        return false;
+      itr->second.lastPage = _dht->impl->Now();
+      _rcPagesFetched++;
+      _rcsFetched += rcs.size();
+      const auto& until = itr->second.until;
+      if (last and (next.IsZero() or (not until.IsZero() and not(next < until))))
+      {
+        LogInfo("fetched rcs from ", peer);
+        _rcFetches.erase(itr);
+      }
+      else if (last)
+      {
+        askMore = true;
+        since = itr->second.since;
+        itr->second.after = next;
+      }
+    }
+    if (askMore)
+    {
+      _dht->impl->DHTSendTo(
+          peer, new dht::FindRCsMessage(txid, since, next, dht::FindRCsMessage::MaxPages));
+    }
+    else if (last and RemoteInBootstrap(peer))
+    {
+      // done with its share, it can take over one that went quiet
+      SeedFromBootstraps(_dht->impl->Now(), false);
+    }
+    if (not rcs.empty())
+      _work([this, rcs = std::move(rcs)]() mutable { CheckRCs(rcs); });
+    return true;
+  }
+
+  bool
+  RCLookupHandler::GetRandomWhitelistRouter(RouterID& router) const
+  {
+    // weighted by uptime once lokid gave us the table
+    if (const auto table = ConsensusTable(); not table->Empty())
+    {
+      router = table->Pick();
+      return true;
+    }
+    const auto whitelist = Whitelist();
+    const auto sz = whitelist->Size();
     if (sz == 0)
       return false;
-    if (sz > 1)
-      std::advance(itr, randint() % sz);
-    router = *itr;
+    router = (*whitelist)[randint() % sz];
     return true;
   }
 
@@ -243,6 +496,8 @@ namespace llarp
         LogInfo("Doing explore via bootstrap node: ", RouterID(rc.pubkey));
         _dht->impl->ExploreNetworkVia(dht::Key_t{rc.pubkey});
       }
+      // and take everything they have in pages instead of a router at a time
+      SeedFromBootstraps(_dht->impl->Now(), true);
     }
 
     if (useWhitelist)
@@ -257,9 +512,11 @@ namespace llarp
 
       {
         // if we are using a whitelist look up a few routers we don't have
+        const auto whitelist = Whitelist();
         util::Lock l(_mutex);
-        for (const auto& r : whitelistRouters)
+        for (size_t idx = 0; idx < whitelist->Size(); ++idx)
         {
+          const auto& r = (*whitelist)[idx];
           if (now > _routerLookupTimes[r] + RerequestInterval and not _nodedb->Has(r))
           {
             lookupRouters.emplace_back(r);
@@ -311,7 +568,7 @@ namespace llarp
     _nodedb = nodedb;
     _work = dowork;
     _hiddenServiceContext = hiddenServiceContext;
-    _strictConnectPubkeys = strictConnectPubkeys;
+    _strictConnectPubkeys.insert(strictConnectPubkeys.begin(), strictConnectPubkeys.end());
     _bootstrapRCList = bootstrapRCList;
     _linkManager = linkManager;
     useWhitelist = useWhitelist_arg;
@@ -357,14 +614,7 @@ namespace llarp
   bool
   RCLookupHandler::RemoteInBootstrap(const RouterID& remote) const
   {
-    for (const auto& rc : _bootstrapRCList)
-    {
-      if (rc.pubkey == remote)
-      {
-        return true;
-      }
-    }
-    return false;
+    return _bootstrapRouterIDList.count(remote) != 0;
   }
 
   void
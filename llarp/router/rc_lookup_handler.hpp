@@ -4,9 +4,14 @@
 #include <chrono>
 #include <router/i_rc_lookup_handler.hpp>
 
+#include <consensus/table.hpp>
+#include <util/dense_set.hpp>
+#include <util/status.hpp>
 #include <util/thread/threading.hpp>
 
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
 #include <set>
 #include <list>
 
@@ -41,6 +46,17 @@ namespace llarp
     void
     SetRouterWhitelist(const std::vector<RouterID>& routers) override EXCLUDES(_mutex);
 
+    void
+    UpdateRouterWhitelist(
+        const std::vector<RouterID>& added, const std::vector<RouterID>& removed) override
+        EXCLUDES(_mutex);
+
+    void
+    SetConsensusTable(std::shared_ptr<const consensus::Table> table) override;
+
+    std::shared_ptr<const consensus::Table>
+    ConsensusTable() const override;
+
     bool
     HaveReceivedWhitelist();
 
@@ -54,6 +70,9 @@ namespace llarp
     bool
     CheckRC(const RouterContact& rc) const override;
 
+    void
+    CheckRCs(std::vector<RouterContact>& rcs) const override;
+
     bool
     GetRandomWhitelistRouter(RouterID& router) const override EXCLUDES(_mutex);
 
@@ -69,6 +88,21 @@ namespace llarp
     size_t
     NumberOfStrictConnectRouters() const override;
 
+    void
+    FetchRCsFrom(const RouterID& peer, llarp_time_t since) override EXCLUDES(_mutex);
+
+    bool
+    HandleRCPage(
+        const RouterID& peer,
+        uint64_t txid,
+        std::vector<RouterContact> rcs,
+        const RouterID& next,
+        bool last) override EXCLUDES(_mutex);
+
+    /// lookups started and lookups that joined one already out for the same router
+    util::StatusObject
+    ExtractStatus() const EXCLUDES(_mutex);
+
     void
     Init(
         llarp_dht_context* dht,
@@ -91,11 +125,29 @@ namespace llarp
     bool
     RemoteInBootstrap(const RouterID& remote) const;
 
+    /// seed an empty nodedb from every bootstrap at once, each fetching its own share of the
+    /// keyspace. a share whose bootstrap goes quiet is taken over by one that is done with its
+    /// own, so a slow or unreachable bootstrap holds nothing up for long. start begins a new
+    /// seed when none is getting anywhere, without it only quiet shares are moved
+    void
+    SeedFromBootstraps(llarp_time_t now, bool start) EXCLUDES(_mutex);
+
     void
     FinalizeRequest(const RouterID& router, const RouterContact* const rc, RCRequestResult result)
         EXCLUDES(_mutex);
 
-    mutable util::Mutex _mutex;  // protects pendingCallbacks, whitelistRouters
+    /// the service node list as it was last set, never changed once made
+    using Whitelist_t = util::DenseSet<RouterID>;
+
+    /// the current whitelist, read without a lock
+    std::shared_ptr<const Whitelist_t>
+    Whitelist() const;
+
+    /// make a new whitelist from the current one and put it in its place
+    void
+    ChangeWhitelist(std::function<void(Whitelist_t&)> change) EXCLUDES(_mutex);
+
+    mutable util::Mutex _mutex;  // protects pendingCallbacks, changes to the whitelist
 
     llarp_dht_context* _dht = nullptr;
     llarp_nodedb* _nodedb = nullptr;
@@ -105,18 +157,44 @@ namespace llarp
 
     /// explicit whitelist of routers we will connect to directly (not for
     /// service nodes)
-    std::set<RouterID> _strictConnectPubkeys;
+    std::unordered_set<RouterID, RouterID::Hash> _strictConnectPubkeys;
 
     std::set<RouterContact> _bootstrapRCList;
     std::set<RouterID> _bootstrapRouterIDList;
 
     std::unordered_map<RouterID, CallbacksQueue, RouterID::Hash> pendingCallbacks
         GUARDED_BY(_mutex);
+    uint64_t lookupsStarted GUARDED_BY(_mutex) = 0;
+    uint64_t lookupsCoalesced GUARDED_BY(_mutex) = 0;
+
+    /// a paged fetch of rcs going on from one peer
+    struct RCFetch
+    {
+      uint64_t txid;
+      llarp_time_t since;
+      /// when we last heard from it, a fetch that goes quiet is given up on
+      llarp_time_t lastPage;
+      /// where the next page starts
+      RouterID after;
+      /// done once it walks past this, zero walks to the end
+      RouterID until;
+    };
+
+    std::unordered_map<RouterID, RCFetch, RouterID::Hash> _rcFetches GUARDED_BY(_mutex);
+    uint64_t _rcPagesFetched GUARDED_BY(_mutex) = 0;
+    uint64_t _rcsFetched GUARDED_BY(_mutex) = 0;
+    uint64_t _seedTakeovers GUARDED_BY(_mutex) = 0;
 
     bool useWhitelist = false;
     bool isServiceNode = false;
 
-    std::set<RouterID> whitelistRouters GUARDED_BY(_mutex);
+    /// swapped whole with the atomic shared_ptr functions, so every session and path build
+    /// checking a router against it takes no lock
+    std::shared_ptr<const Whitelist_t> _whitelist = std::make_shared<const Whitelist_t>();
+
+    /// swapped whole like the whitelist
+    std::shared_ptr<const consensus::Table> _consensus =
+        std::make_shared<const consensus::Table>();
 
     using TimePoint = std::chrono::steady_clock::time_point;
     std::unordered_map<RouterID, TimePoint, RouterID::Hash> _routerLookupTimes;
@@ -74,18 +74,38 @@ namespace llarp
   void
   RoutePoker::DisableAllRoutes()
   {
+    std::vector<net::RouteChange> changes;
     for (const auto& [ip, gateway] : m_PokedRoutes)
-      DisableRoute(ip, gateway);
+      changes.push_back(net::RouteChange{ip.ToString(), gateway.ToString(), false});
+    net::ApplyRoutes(changes);
   }
 
   void
   RoutePoker::EnableAllRoutes()
   {
+    std::vector<net::RouteChange> changes;
     for (auto& [ip, gateway] : m_PokedRoutes)
     {
       gateway = m_CurrentGateway;
-      EnableRoute(ip, m_CurrentGateway);
+      changes.push_back(net::RouteChange{ip.ToString(), m_CurrentGateway.ToString(), true});
+    }
+    net::ApplyRoutes(changes);
+  }
+
+  void
+  RoutePoker::MoveAllRoutes()
+  {
+    // only what is not already via the new gateway changes, in one batch
+    net::RouteMap_t before, after;
+    for (auto& [ip, gateway] : m_PokedRoutes)
+    {
+      // a route poked while we had no gateway was never set
+      if (gateway.h != 0)
+        before.emplace(ip.ToString(), gateway.ToString());
+      gateway = m_CurrentGateway;
+      after.emplace(ip.ToString(), m_CurrentGateway.ToString());
     }
+    net::ApplyRoutes(net::DiffRoutes(before, after));
   }
 
   RoutePoker::~RoutePoker()
@@ -125,9 +145,10 @@ namespace llarp
       LogInfo("found default gateway: ", gateway);
       m_CurrentGateway = gateway;
 
-      if (not m_Enabling)  // if route was already set up
-        DisableAllRoutes();
-      EnableAllRoutes();
+      if (m_Enabling)
+        EnableAllRoutes();
+      else  // routes were already set up
+        MoveAllRoutes();
 
       const auto ep = m_Router->hiddenServiceContext().GetDefault();
       net::AddDefaultRouteViaInterface(ep->GetIfName());
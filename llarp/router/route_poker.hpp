@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <unordered_map>
 #include <string>
 #include <net/net_int.hpp>
@@ -44,6 +45,10 @@ namespace llarp
     void
     EnableAllRoutes();
 
+    /// move every route onto the current gateway
+    void
+    MoveAllRoutes();
+
     void
     EnableRoute(huint32_t ip, huint32_t gateway);
 
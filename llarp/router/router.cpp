@@ -20,7 +20,10 @@
 #include <util/logging/logger_syslog.hpp>
 #include <util/logging/logger.hpp>
 #include <util/meta/memfn.hpp>
+#include <util/numa.hpp>
+#include <util/padding.hpp>
 #include <util/str.hpp>
+#include <util/tracy.hpp>
 #include <ev/ev.hpp>
 #include <tooling/peer_stats_event.hpp>
 
@@ -43,6 +46,12 @@
 #include <lokimq/lokimq.h>
 
 static constexpr std::chrono::milliseconds ROUTER_TICK_INTERVAL = 1s;
+/// how long the user has to be quiet before a client that may idle does
+static constexpr auto IDLE_AFTER_QUIET = 30s;
+/// enough fresh keys for a handful of path builds, two per hop
+static constexpr size_t EphemeralKeysCached = 128;
+/// path build requests waiting on a worker before we turn more away, a few seconds of work
+static constexpr size_t MaxQueuedPathBuilds = 512;
 
 namespace llarp
 {
@@ -53,6 +62,7 @@ namespace llarp
       , _logic(std::move(l))
       , paths(this)
       , _exitContext(this)
+      , m_SNodeSessions(this)
       , _dht(llarp_dht_context_new(this))
       , m_DiskThread(m_lmq->add_tagged_thread("disk"))
       , inbound_link_msg_parser(this)
@@ -71,7 +81,22 @@ namespace llarp
     _stopping.store(false);
     _running.store(false);
     _lastTick = llarp::time_now_ms();
-    m_NextExploreAt = Clock_t::now();
+    m_TickMetric = &m_Metrics.AddHistogram(
+        "llarp_router_tick_microseconds",
+        "how long each router tick took",
+        {100, 1000, 10000, 100000, 1000000});
+    m_RoutersMetric =
+        &m_Metrics.AddGauge("llarp_router_connected_routers", "routers we have sessions with");
+    m_ClientsMetric =
+        &m_Metrics.AddGauge("llarp_router_connected_clients", "clients we have sessions with");
+    m_CryptoQueuedMetric = &m_Metrics.AddGauge(
+        "llarp_router_crypto_jobs_queued", "jobs waiting on the crypto workers, set each tick");
+    m_DiskQueuedMetric =
+        &m_Metrics.AddGauge("llarp_router_disk_jobs_queued", "disk jobs waiting or running");
+    m_DiskWaitMetric = &m_Metrics.AddHistogram(
+        "llarp_router_disk_wait_microseconds",
+        "how long disk jobs waited for the disk thread",
+        metrics::LatencyBounds());
   }
 
   Router::~Router()
@@ -88,14 +113,46 @@ namespace llarp
       if (m_peerDb)
         peerStatsObj = m_peerDb->ExtractStatus();
 
+      util::StatusObject pathPoolObj = nullptr;
+      if (m_PathPool)
+        pathPoolObj = m_PathPool->ExtractStatus();
+
+      util::StatusObject ephemeralKeysObj = nullptr;
+      if (m_EphemeralKeys)
+        ephemeralKeysObj = m_EphemeralKeys->ExtractStatus();
+
+      util::StatusObject cryptoWorkersObj = nullptr;
+      if (m_CryptoWorkers)
+        cryptoWorkersObj = m_CryptoWorkers->ExtractStatus();
+
       return util::StatusObject{{"running", true},
                                 {"numNodesKnown", _nodedb->num_loaded()},
+                                {"nodedb", _nodedb->ExtractStatus()},
                                 {"dht", _dht->impl->ExtractStatus()},
+                                {"rcLookups", _rcLookupHandler.ExtractStatus()},
                                 {"services", _hiddenServiceContext.ExtractStatus()},
                                 {"exit", _exitContext.ExtractStatus()},
+                                {"snodeSessions", m_SNodeSessions.ExtractStatus()},
                                 {"links", _linkManager.ExtractStatus()},
                                 {"outboundMessages", _outboundMessageHandler.ExtractStatus()},
-                                {"peerStats", peerStatsObj}};
+                                {"peerStats", peerStatsObj},
+                                {"pathPool", pathPoolObj},
+                                {"cryptoWorkers", cryptoWorkersObj},
+                                {"diskJobsQueued", m_DiskQueuedMetric->Value()},
+                                {"memory", util::MemoryPolicyStatus()},
+                                {"padding", padding::ExtractStatus()},
+                                {"ephemeralKeys", ephemeralKeysObj},
+                                {"transit", paths.ExtractTransitStatus()},
+                                {"load", uint64_t(paths.OurLoad())},
+                                {"relayLoads", paths.RelayLoadReports().ExtractStatus()},
+                                {"dhtRequests", paths.DHTRequests().ExtractStatus()},
+                                {"rcGossip", _rcGossiper.ExtractStatus()},
+                                {"peerUsage", m_PeerUsage.ExtractStatus(Now())},
+                                {"tick", m_TickTimes.ExtractStatus()},
+                                {"pump",
+                                 util::StatusObject{{"run", m_PumpsRun},
+                                                    {"coalesced", m_PumpsCoalesced},
+                                                    {"hopsFlushed", paths.HopsFlushed()}}}};
     }
     else
     {
@@ -120,6 +177,8 @@ namespace llarp
   void
   Router::PersistSessionUntil(const RouterID& remote, llarp_time_t until)
   {
+    // everything that goes through a peer persists its session, paths, transit hops and dht
+    m_PeerUsage.Use(remote, Now());
     _linkManager.PersistSessionUntil(remote, until);
   }
 
@@ -164,14 +223,35 @@ namespace llarp
   void
   Router::PumpLL()
   {
-    llarp::LogTrace("Router::PumpLL() start");
     if (_stopping.load())
       return;
+    if (m_PumpPending)
+    {
+      m_PumpsCoalesced++;
+      return;
+    }
+    m_PumpPending = true;
+    // the loop ticker may already have run this iteration, make sure the loop doesn't sleep on us
+    LogicCall(_logic, [self = this]() {
+      if (self->m_PumpPending)
+        self->DoPump();
+    });
+  }
+
+  void
+  Router::DoPump()
+  {
+    llarp::LogTrace("Router::DoPump() start");
+    m_PumpPending = false;
+    if (_stopping.load())
+      return;
+    LLARP_ZONE("Router::DoPump");
+    m_PumpsRun++;
     paths.PumpDownstream();
     paths.PumpUpstream();
     _outboundMessageHandler.Tick();
     _linkManager.PumpLinks();
-    llarp::LogTrace("Router::PumpLL() end");
+    llarp::LogTrace("Router::DoPump() end");
   }
 
   bool
@@ -268,6 +348,8 @@ namespace llarp
   bool
   Router::Configure(std::shared_ptr<Config> c, bool isRouter, llarp_nodedb* nodedb)
   {
+    using Clock_t = std::chrono::steady_clock;
+    const auto started = Clock_t::now();
     m_Config = c;
     auto& conf = *m_Config;
     whitelistRouters = conf.lokid.whitelistRouters;
@@ -281,8 +363,20 @@ namespace llarp
     if (not StartRpcServer())
       throw std::runtime_error("Failed to start rpc server");
 
-    if (conf.router.m_workerThreads > 0)
-      m_lmq->set_general_threads(conf.router.m_workerThreads);
+    // crypto has m_CryptoWorkers and disk m_DiskThread, what is left for lokimq's own is rpc
+    m_lmq->set_general_threads(conf.router.m_rpcThreads);
+
+    // before any thread it pins starts
+    util::SetMemoryPolicy(
+        {conf.router.m_hugePages, conf.router.m_numaLocal, conf.router.m_cpuAffinity});
+    padding::SetLinkProfile(conf.router.m_linkPadding);
+
+    m_CryptoWorkers = std::make_unique<thread::WorkerPool>(
+        static_cast<size_t>(std::max(conf.router.m_workerThreads, 0)), "llarp-crypto");
+    m_CryptoWorkers->Start();
+    m_EphemeralKeys = std::make_unique<EphemeralKeyCache>(
+        EphemeralKeysCached, [this](auto work) { m_CryptoWorkers->Queue(std::move(work)); });
+    m_EphemeralKeys->RequestRefill();
 
     m_lmq->start();
 
@@ -296,18 +390,39 @@ namespace llarp
     }
 
     // fetch keys
+    const auto keysStarted = Clock_t::now();
     if (not m_keyManager->initialize(conf, true, isRouter))
       throw std::runtime_error("KeyManager failed to initialize");
+    const auto configStarted = Clock_t::now();
     if (!FromConfig(conf))
       throw std::runtime_error("FromConfig() failed");
 
+    const auto linksStarted = Clock_t::now();
     if (!InitOutboundLinks())
       throw std::runtime_error("InitOutboundLinks() failed");
 
+    const auto identityStarted = Clock_t::now();
     if (not EnsureIdentity())
       throw std::runtime_error("EnsureIdentity() failed");
 
     m_RoutePoker.Init(this);
+
+    const auto ms = [](auto dlt) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(dlt);
+    };
+    LogInfo(
+        "router configured in ",
+        ms(Clock_t::now() - started),
+        ": rpc and workers ",
+        ms(keysStarted - started),
+        ", keys ",
+        ms(configStarted - keysStarted),
+        ", config and endpoints ",
+        ms(linksStarted - configStarted),
+        ", outbound links ",
+        ms(identityStarted - linksStarted),
+        ", identity ",
+        ms(Clock_t::now() - identityStarted));
     return true;
   }
 
@@ -354,7 +469,61 @@ namespace llarp
   {
     ticker_job_id = 0;
     Tick();
-    ScheduleTicker(ROUTER_TICK_INTERVAL);
+    ScheduleTicker(
+        IsIdle() ? time_until_aligned(Now(), IdleWakeupWindow) : ROUTER_TICK_INTERVAL);
+  }
+
+  void
+  Router::SetIdleAllowed(bool allowed)
+  {
+    m_IdleAllowed = allowed;
+    if (not allowed)
+      LeaveIdle();
+  }
+
+  void
+  Router::NotifyUserActivity()
+  {
+    m_LastUserActivity.store(Now(), std::memory_order_relaxed);
+    if (IsIdle())
+      LeaveIdle();
+  }
+
+  void
+  Router::UpdateIdle(llarp_time_t now)
+  {
+    if (IsIdle() or IsServiceNode() or not m_IdleAllowed)
+      return;
+    if (now - m_LastUserActivity.load(std::memory_order_relaxed) < IDLE_AFTER_QUIET)
+      return;
+    LogInfo("no user traffic for ", IDLE_AFTER_QUIET, ", going idle");
+    m_Idle = true;
+    SetLinksIdle(true);
+  }
+
+  void
+  Router::LeaveIdle()
+  {
+    if (not m_Idle.exchange(false))
+      return;
+    LogicCall(_logic, [this]() {
+      LogInfo("leaving idle");
+      SetLinksIdle(false);
+      // the tick we have waiting could be a whole window out
+      if (ticker_job_id)
+      {
+        _logic->cancel_call(ticker_job_id);
+        handle_router_ticker();
+      }
+    });
+  }
+
+  void
+  Router::SetLinksIdle(bool idle)
+  {
+    const auto visit = [idle](LinkLayer_ptr link) { link->SetIdle(idle); };
+    _linkManager.ForEachInboundLink(visit);
+    _linkManager.ForEachOutboundLink(visit);
   }
 
   bool
@@ -441,6 +610,23 @@ namespace llarp
 
     // IWP config
     m_OutboundPort = conf.links.m_OutboundLink.port;
+    m_UDPOffload = conf.router.m_udpOffload;
+    m_IOUring = conf.router.m_ioUring;
+    m_BusyPoll = conf.router.m_busyPoll;
+    _netloop->set_busy_poll(m_BusyPoll);
+    _netloop->set_loop_cpu(conf.router.m_loopCpu);
+    if (conf.router.m_captureFile)
+    {
+      m_Capture = std::make_shared<capture::Writer>();
+      if (not m_Capture->Open(*conf.router.m_captureFile, conf.router.m_captureKeys))
+        m_Capture = nullptr;
+    }
+    m_AESGCM = conf.router.m_aesGCM;
+    m_LinkSockets = conf.router.m_linkSockets;
+    m_AckDelay = conf.router.m_ackDelay;
+    m_AckBudget = conf.router.m_ackBudget;
+    paths.SetCellBatchDelay(conf.router.m_cellBatchDelay);
+    _outboundMessageHandler.SetBundleDelay(conf.router.m_cellBundleDelay);
     // Router config
     _rc.SetNick(conf.router.m_nickname);
     _outboundSessionMaker.maxConnectedRouters = conf.router.m_maxConnectedRouters;
@@ -463,6 +649,16 @@ namespace llarp
 
     networkConfig = conf.network;
 
+    if (networkConfig.m_PathPoolMax > 0 and not m_isServiceNode)
+    {
+      const size_t high = networkConfig.m_PathPoolMax;
+      const size_t low = networkConfig.m_PathPoolMin ? networkConfig.m_PathPoolMin : (high + 1) / 2;
+      if (low > high)
+        throw std::invalid_argument("[network]:path-pool-min must not be above path-pool-max");
+      m_PathPool = std::make_shared<path::PathPool>(
+          this, low, high, networkConfig.m_Hops.value_or(path::default_len));
+    }
+
     /// build a set of  strictConnectPubkeys (
     /// TODO: make this consistent with config -- do we support multiple strict connections
     //        or not?
@@ -605,6 +801,16 @@ namespace llarp
       const std::string& key = serverConfig.interface;
       int af = serverConfig.addressFamily;
       uint16_t port = serverConfig.port;
+      server->EnableUDPOffload(m_UDPOffload);
+      server->EnableIOUring(m_IOUring);
+      server->EnableBusyPoll(m_BusyPoll);
+      server->SetCapture(m_Capture);
+      server->EnableAESGCM(m_AESGCM);
+      server->EnableXDP(serverConfig.xdp);
+      server->SetKeyedWorker(util::memFn(&AbstractRouter::QueueWorkFor, this));
+      server->SetMetrics(m_Metrics);
+      server->SetSocketShards(m_LinkSockets);
+      server->SetAckPolicy(m_AckDelay, m_AckBudget);
       if (!server->Configure(netloop(), key, af, port))
       {
         throw std::runtime_error(stringify("failed to bind inbound link on ", key, " port ", port));
@@ -649,6 +855,44 @@ namespace llarp
     return true;
   }
 
+  /// options Reconfigure puts in place while we run
+  static const std::set<std::string_view> HotOptions{
+      "logging:level",
+      "network:paths",
+      "network:hops",
+      "network:exit-node",
+      "network:exit-auth",
+      "dns:upstream",
+      "dns:upstream-contexts",
+  };
+
+  std::vector<std::string>
+  Router::Reconfigure(std::shared_ptr<Config> conf)
+  {
+    std::vector<std::string> restart;
+    for (auto& option : m_Config->ChangedOptions(*conf))
+    {
+      if (HotOptions.count(option) == 0)
+        restart.emplace_back(std::move(option));
+    }
+
+    if (conf->logging.m_logLevel != m_Config->logging.m_logLevel)
+      SetLogLevel(conf->logging.m_logLevel);
+
+    hiddenServiceContext().ForEachService(
+        [&](const std::string&, const std::shared_ptr<service::Endpoint>& ep) {
+          ep->Reconfigure(*m_Config, *conf);
+          return true;
+        });
+
+    m_Config = std::move(conf);
+    if (not restart.empty())
+      LogWarn("config reloaded, changes to ", restart.size(), " options wait for a restart");
+    else
+      LogInfo("config reloaded");
+    return restart;
+  }
+
   bool
   Router::CheckRenegotiateValid(RouterContact newrc, RouterContact oldrc)
   {
@@ -690,12 +934,99 @@ namespace llarp
     m_LastStatsReport = now;
   }
 
+  /// a tick that takes this long holds up everything else on the logic thread
+  static constexpr auto TickStallWarning = 100ms;
+
+  namespace
+  {
+    /// ids of the chores Tick runs on intervals of their own
+    enum Chore : uint32_t
+    {
+      ChoreProfiles,
+      ChoreRCLookups,
+      ChoreNodeDBPolicy,
+      ChorePeerDb,
+      ChoreDHTNodes,
+    };
+  }  // namespace
+
+  void
+  Router::StartChores()
+  {
+    // first runs staggered so no two sweeps land on the same tick
+    ScheduleChore(ChoreProfiles, 1s, 5s, [this]() { routerProfiling().Tick(); });
+
+    ScheduleChore(ChoreRCLookups, 2s, 10s, [this]() { _rcLookupHandler.PeriodicUpdate(Now()); });
+
+    ScheduleChore(ChoreNodeDBPolicy, 3s, 30s, [this]() {
+      const bool isSvcNode = IsServiceNode();
+      const bool gotWhitelist = _rcLookupHandler.HaveReceivedWhitelist();
+      // remove RCs for nodes that are no longer allowed by network policy
+      nodedb()->RemoveIf([&](const RouterContact& rc) -> bool {
+        // don't purge bootstrap nodes from nodedb
+        if (IsBootstrapNode(rc.pubkey))
+          return false;
+        // if for some reason we stored an RC that isn't a valid router
+        // purge this entry
+        if (not rc.IsPublicRouter())
+          return true;
+        // clients have a notion of a whilelist
+        // we short circuit logic here so we dont remove
+        // routers that are not whitelisted for first hops
+        if (not isSvcNode)
+          return false;
+        // if we have a whitelist enabled and we don't
+        // have the whitelist yet don't remove the entry
+        if (whitelistRouters and not gotWhitelist)
+          return false;
+        // if we have no whitelist enabled or we have
+        // the whitelist enabled and we got the whitelist
+        // check against the whitelist and remove if it's not
+        // in the whitelist OR if there is no whitelist don't remove
+        return not _rcLookupHandler.RemoteIsAllowed(rc.pubkey);
+      });
+    });
+
+    ScheduleChore(ChorePeerDb, 4s, 5s, [this]() {
+      // TODO: need to capture session stats when session terminates / is removed from link manager
+      if (m_peerDb)
+        _linkManager.updatePeerDb(m_peerDb);
+    });
+
+    // sessions that close take their dht node with them, this catches any left behind
+    ScheduleChore(ChoreDHTNodes, 6s, 10s, [this]() {
+      // get connected peers
+      std::set<dht::Key_t> peersWeHave;
+      _linkManager.ForEachPeer([&peersWeHave](ILinkSession* s) {
+        if (!s->IsEstablished())
+          return;
+        peersWeHave.emplace(s->GetPubKey());
+      });
+      // remove any nodes we don't have connections to
+      _dht->impl->Nodes()->RemoveIf(
+          [&peersWeHave](const dht::Key_t& k) -> bool { return peersWeHave.count(k) == 0; });
+    });
+  }
+
+  void
+  Router::ScheduleChore(
+      uint32_t id, llarp_time_t first, llarp_time_t interval, std::function<void(void)> chore)
+  {
+    m_Chores.Schedule(id, Now(), first, [this, id, interval, chore]() {
+      chore();
+      ScheduleChore(id, interval, interval, chore);
+    });
+  }
+
   void
   Router::Tick()
   {
     if (_stopping)
       return;
+    LLARP_ZONE("Router::Tick");
     // LogDebug("tick router");
+    using Clock_t = std::chrono::steady_clock;
+    const auto started = Clock_t::now();
     const auto now = Now();
 
 #if defined(WITH_SYSTEMD)
@@ -723,8 +1054,6 @@ namespace llarp
     }
 #endif
 
-    routerProfiling().Tick();
-
     if (ShouldReportStats(now))
     {
       ReportStats();
@@ -732,9 +1061,9 @@ namespace llarp
 
     _rcGossiper.Decay(now);
 
-    _rcLookupHandler.PeriodicUpdate(now);
-
     const bool isSvcNode = IsServiceNode();
+    if (isSvcNode and not disableGossipingRC_TestingOnly())
+      _rcGossiper.Tick(now);
 
     if (_rc.ExpiresSoon(now, std::chrono::milliseconds(randint() % 10000))
         || (now - _rc.last_updated) > rcRegenInterval)
@@ -747,32 +1076,11 @@ namespace llarp
     {
       GossipRCIfNeeded(_rc);
     }
-    const bool gotWhitelist = _rcLookupHandler.HaveReceivedWhitelist();
-    // remove RCs for nodes that are no longer allowed by network policy
-    nodedb()->RemoveIf([&](const RouterContact& rc) -> bool {
-      // don't purge bootstrap nodes from nodedb
-      if (IsBootstrapNode(rc.pubkey))
-        return false;
-      // if for some reason we stored an RC that isn't a valid router
-      // purge this entry
-      if (not rc.IsPublicRouter())
-        return true;
-      // clients have a notion of a whilelist
-      // we short circuit logic here so we dont remove
-      // routers that are not whitelisted for first hops
-      if (not isSvcNode)
-        return false;
-      // if we have a whitelist enabled and we don't
-      // have the whitelist yet don't remove the entry
-      if (whitelistRouters and not gotWhitelist)
-        return false;
-      // if we have no whitelist enabled or we have
-      // the whitelist enabled and we got the whitelist
-      // check against the whitelist and remove if it's not
-      // in the whitelist OR if there is no whitelist don't remove
-      return not _rcLookupHandler.RemoteIsAllowed(rc.pubkey);
-    });
-
+    // the peers we use most keep their sessions, so paths through them do not wait on a
+    // handshake. the rest close once nothing else persists them
+    m_PeerUsage.Decay(now);
+    for (const auto& peer : m_PeerUsage.Busiest(_outboundSessionMaker.maxConnectedRouters, now))
+      _linkManager.PersistSessionUntil(peer, now + WarmSessionHold);
     _linkManager.CheckPersistingSessions(now);
 
     if (HasClientExit())
@@ -789,13 +1097,13 @@ namespace llarp
       connected += _linkManager.NumberOfPendingConnections();
     }
 
-    const int interval = isSvcNode ? 5 : 2;
-    const auto timepoint_now = Clock_t::now();
-    if (timepoint_now >= m_NextExploreAt)
-    {
+    UpdateIdle(now);
+
+    const auto exploreFloor = isSvcNode ? 5s : 2s;
+    // exploring can wait until we are back in use
+    if (not IsIdle()
+        and _dht->impl->exploreScheduler().Due(now, _dht->impl->Nodes()->size(), exploreFloor))
       _rcLookupHandler.ExploreNetwork();
-      m_NextExploreAt = timepoint_now + std::chrono::seconds(interval);
-    }
     size_t connectToNum = _outboundSessionMaker.minConnectedRouters;
     const auto strictConnect = _rcLookupHandler.NumberOfStrictConnectRouters();
     if (strictConnect > 0 && connectToNum > strictConnect)
@@ -803,6 +1111,23 @@ namespace llarp
       connectToNum = strictConnect;
     }
 
+    m_RoutersMetric->Set(NumberOfConnectedRouters());
+    m_ClientsMetric->Set(NumberOfConnectedClients());
+    if (m_CryptoWorkers)
+      m_CryptoQueuedMetric->Set(m_CryptoWorkers->Queued());
+    {
+      // our load is that of whichever is fuller, the crypto workers or our links
+      double fill = _outboundMessageHandler.CongestedFraction();
+      if (m_CryptoWorkers)
+        fill = std::max(fill, double(m_CryptoWorkers->Queued()) / double(MaxQueuedPathBuilds));
+      paths.SetOurLoad(path::ToRelayLoad(fill));
+      paths.RelayLoadReports().Expire(now);
+      paths.DHTRequests().Expire(now);
+    }
+    LLARP_PLOT("connected routers", NumberOfConnectedRouters());
+    LLARP_PLOT("connected clients", NumberOfConnectedClients());
+    LLARP_PLOT("transit paths", pathContext().CurrentTransitPaths());
+
     if (connected < connectToNum)
     {
       size_t dlt = connectToNum - connected;
@@ -810,7 +1135,10 @@ namespace llarp
       _outboundSessionMaker.ConnectToRandomRouters(dlt);
     }
 
+    if (m_PathPool)
+      m_PathPool->Tick(now);
     _hiddenServiceContext.Tick(now);
+    m_SNodeSessions.Tick(now);
     _exitContext.Tick(now);
 
     // save profiles
@@ -824,33 +1152,24 @@ namespace llarp
       nodedb()->AsyncFlushToDisk();
     }
 
-    if (m_peerDb)
+    if (m_peerDb and m_peerDb->shouldFlush(now))
     {
-      // TODO: throttle this?
-      // TODO: need to capture session stats when session terminates / is removed from link manager
-      _linkManager.updatePeerDb(m_peerDb);
-
-      if (m_peerDb->shouldFlush(now))
-      {
-        LogDebug("Queing database flush...");
-        QueueDiskIO([this]() { m_peerDb->flushDatabase(); });
-      }
+      LogDebug("Queing database flush...");
+      QueueDiskIO([this]() { m_peerDb->flushDatabase(); });
     }
 
-    // get connected peers
-    std::set<dht::Key_t> peersWeHave;
-    _linkManager.ForEachPeer([&peersWeHave](ILinkSession* s) {
-      if (!s->IsEstablished())
-        return;
-      peersWeHave.emplace(s->GetPubKey());
-    });
-    // remove any nodes we don't have connections to
-    _dht->impl->Nodes()->RemoveIf(
-        [&peersWeHave](const dht::Key_t& k) -> bool { return peersWeHave.count(k) == 0; });
     // expire paths
     paths.ExpirePaths(now);
+    m_Chores.Advance(now);
     // update tick timestamp
     _lastTick = llarp::time_now_ms();
+
+    const auto took =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock_t::now() - started);
+    m_TickTimes.Add(took);
+    m_TickMetric->Observe(took.count());
+    if (took > TickStallWarning)
+      LogWarn("router tick took ", took.count() / 1000, "ms");
   }
 
   bool
@@ -914,10 +1233,8 @@ namespace llarp
   void
   Router::HandleDHTLookupForExplore(RouterID /*remote*/, const std::vector<RouterContact>& results)
   {
-    for (const auto& rc : results)
-    {
-      _rcLookupHandler.CheckRC(rc);
-    }
+    std::vector<RouterContact> rcs = results;
+    _rcLookupHandler.CheckRCs(rcs);
   }
 
   // TODO: refactor callers and remove this function
@@ -946,6 +1263,21 @@ namespace llarp
     _rcLookupHandler.SetRouterWhitelist(routers);
   }
 
+  void
+  Router::UpdateRouterWhitelist(
+      const std::vector<RouterID>& added, const std::vector<RouterID>& removed)
+  {
+    _rcLookupHandler.UpdateRouterWhitelist(added, removed);
+    if (not IsServiceNode() or not whitelistRouters)
+      return;
+    // what the node db policy chore would drop on its next run goes now
+    for (const auto& router : removed)
+    {
+      if (not IsBootstrapNode(router))
+        _nodedb->Remove(router);
+    }
+  }
+
   bool
   Router::StartRpcServer()
   {
@@ -1065,8 +1397,15 @@ namespace llarp
     }
 
     {
-      ssize_t loaded = _nodedb->LoadAll();
-      llarp::LogInfo("loaded ", loaded, " RCs");
+      // decode and verify on the crypto workers, nothing else is using them yet
+      ssize_t loaded = _nodedb->LoadAll(util::memFn(&AbstractRouter::QueueWork, this));
+      const auto& stats = _nodedb->loadStats;
+      llarp::LogInfo(
+          "loaded ",
+          loaded,
+          " RCs in ",
+          (stats.readTime + stats.verifyTime + stats.mergeTime).count(),
+          "ms");
       if (loaded < 0)
       {
         // shouldn't be possible
@@ -1091,11 +1430,17 @@ namespace llarp
 
     LogInfo("have ", _nodedb->num_loaded(), " routers");
 
-    _netloop->add_ticker(std::bind(&Router::PumpLL, this));
+    // the ticker runs once per event loop iteration so it marks the frames too
+    _netloop->add_ticker([this]() {
+      DoPump();
+      LLARP_FRAME();
+    });
 
+    StartChores();
     ScheduleTicker(ROUTER_TICK_INTERVAL);
     _running.store(true);
     _startedAt = Now();
+    m_LastUserActivity = _startedAt;
 #if defined(WITH_SYSTEMD)
     ::sd_notify(0, "READY=1");
 #endif
@@ -1122,6 +1467,8 @@ namespace llarp
   Router::AfterStopLinks()
   {
     Close();
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->Stop();
     m_lmq.reset();
   }
 
@@ -1155,6 +1502,8 @@ namespace llarp
 #endif
     hiddenServiceContext().StopAll();
     _exitContext.Stop();
+    if (m_PathPool)
+      m_PathPool->Stop();
     StopLinks();
     Close();
   }
@@ -1175,6 +1524,8 @@ namespace llarp
 #endif
     hiddenServiceContext().StopAll();
     _exitContext.Stop();
+    if (m_PathPool)
+      m_PathPool->Stop();
     paths.PumpUpstream();
     _linkManager.PumpLinks();
     _logic->call_later(200ms, std::bind(&Router::AfterStopIssued, this));
@@ -1245,13 +1596,52 @@ namespace llarp
   void
   Router::QueueWork(std::function<void(void)> func)
   {
-    m_lmq->job(std::move(func));
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->Queue(std::move(func));
+    else
+      m_lmq->job(std::move(func));
+  }
+
+  void
+  Router::GenerateEphemeralKey(SecretKey& key)
+  {
+    if (m_EphemeralKeys)
+      m_EphemeralKeys->Take(key);
+    else
+      CryptoManager::instance()->encryption_keygen(key);
+  }
+
+  void
+  Router::QueueWorkFor(uint64_t key, std::function<void(void)> func)
+  {
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->QueueFor(key, std::move(func));
+    else
+      m_lmq->job(std::move(func));
+  }
+
+  bool
+  Router::QueuePathBuildWork(std::function<void(void)> func)
+  {
+    if (not m_CryptoWorkers)
+    {
+      m_lmq->job(std::move(func));
+      return true;
+    }
+    return m_CryptoWorkers->TryQueueBackground(std::move(func), MaxQueuedPathBuilds);
   }
 
   void
   Router::QueueDiskIO(std::function<void(void)> func)
   {
-    m_lmq->job(std::move(func), m_DiskThread);
+    m_DiskQueuedMetric->Add(1);
+    m_lmq->job(
+        [this, func = std::move(func), queued = metrics::Histogram::Clock_t::now()]() {
+          m_DiskWaitMetric->ObserveSince(queued);
+          func();
+          m_DiskQueuedMetric->Add(-1);
+        },
+        m_DiskThread);
   }
 
   bool
@@ -1292,6 +1682,14 @@ namespace llarp
 
     const auto afs = {AF_INET, AF_INET6};
 
+    link->EnableUDPOffload(m_UDPOffload);
+    link->EnableIOUring(m_IOUring);
+    link->EnableBusyPoll(m_BusyPoll);
+    link->SetCapture(m_Capture);
+    link->EnableAESGCM(m_AESGCM);
+    link->SetKeyedWorker(util::memFn(&AbstractRouter::QueueWorkFor, this));
+    link->SetMetrics(m_Metrics);
+    link->SetAckPolicy(m_AckDelay, m_AckBudget);
     for (const auto af : afs)
     {
       if (not link->Configure(netloop(), "*", af, m_OutboundPort))
@@ -6,21 +6,25 @@
 #include <bootstrap.hpp>
 #include <config/config.hpp>
 #include <config/key_manager.hpp>
+#include <crypto/key_cache.hpp>
 #include <constants/link_layer.hpp>
 #include <crypto/types.hpp>
 #include <ev/ev.h>
 #include <exit/context.hpp>
+#include <exit/snode_registry.hpp>
 #include <handlers/tun.hpp>
 #include <link/link_manager.hpp>
 #include <link/server.hpp>
 #include <messages/link_message_parser.hpp>
 #include <nodedb.hpp>
 #include <path/path_context.hpp>
+#include <path/path_pool.hpp>
 #include <peerstats/peer_db.hpp>
 #include <profiling.hpp>
 #include <router_contact.hpp>
 #include <router/outbound_message_handler.hpp>
 #include <router/outbound_session_maker.hpp>
+#include <router/peer_usage.hpp>
 #include <router/rc_gossiper.hpp>
 #include <router/rc_lookup_handler.hpp>
 #include <router/route_poker.hpp>
@@ -32,11 +36,15 @@
 #include <stdexcept>
 #include <util/buffer.hpp>
 #include <util/fs.hpp>
+#include <util/histogram.hpp>
 #include <util/mem.hpp>
+#include <util/metrics.hpp>
 #include <util/status.hpp>
 #include <util/str.hpp>
 #include <util/thread/logic.hpp>
+#include <util/thread/worker_pool.hpp>
 #include <util/time.hpp>
+#include <util/timer_wheel.hpp>
 
 #include <functional>
 #include <list>
@@ -52,6 +60,15 @@ namespace llarp
 {
   struct Router : public AbstractRouter
   {
+    /// declared first so the members made in our constructor can register their metrics
+    metrics::Registry m_Metrics;
+
+    metrics::Registry&
+    metrics() override
+    {
+      return m_Metrics;
+    }
+
     llarp_time_t _lastPump = 0s;
     bool ready;
     // transient iwp encryption key
@@ -121,6 +138,12 @@ namespace llarp
       return paths;
     }
 
+    path::PathPool*
+    pathPool() override
+    {
+      return m_PathPool.get();
+    }
+
     const RouterContact&
     rc() const override
     {
@@ -130,12 +153,22 @@ namespace llarp
     void
     SetRouterWhitelist(const std::vector<RouterID> routers) override;
 
+    void
+    UpdateRouterWhitelist(
+        const std::vector<RouterID>& added, const std::vector<RouterID>& removed) override;
+
     exit::Context&
     exitContext() override
     {
       return _exitContext;
     }
 
+    exit::SNodeSessionRegistry&
+    snodeSessions() override
+    {
+      return m_SNodeSessions;
+    }
+
     std::shared_ptr<KeyManager>
     keyManager() const override
     {
@@ -169,6 +202,15 @@ namespace llarp
     void
     QueueWork(std::function<void(void)> func) override;
 
+    void
+    GenerateEphemeralKey(SecretKey& key) override;
+
+    void
+    QueueWorkFor(uint64_t key, std::function<void(void)> func) override;
+
+    bool
+    QueuePathBuildWork(std::function<void(void)> func) override;
+
     void
     QueueDiskIO(std::function<void(void)> func) override;
 
@@ -178,6 +220,7 @@ namespace llarp
     std::shared_ptr<Logic> _logic;
     path::PathContext paths;
     exit::Context _exitContext;
+    exit::SNodeSessionRegistry m_SNodeSessions;
     SecretKey _identity;
     SecretKey _encryption;
     llarp_dht_context* _dht = nullptr;
@@ -192,6 +235,18 @@ namespace llarp
     Sign(Signature& sig, const llarp_buffer_t& buf) const override;
 
     uint16_t m_OutboundPort = 0;
+    /// use udp segmentation and receive offload on our links
+    bool m_UDPOffload = true;
+    bool m_IOUring = false;
+    std::chrono::microseconds m_BusyPoll = 0us;
+    /// what our links read goes in here when the config asks for it
+    std::shared_ptr<capture::Writer> m_Capture;
+    bool m_AESGCM = true;
+    /// number of reuseport sockets for each inbound link
+    size_t m_LinkSockets = 1;
+    /// how long and how many acks link sessions may hold
+    llarp_time_t m_AckDelay = DefaultAckDelay;
+    size_t m_AckBudget = DefaultAckBudget;
     /// how often do we resign our RC? milliseconds.
     // TODO: make configurable
     llarp_time_t rcRegenInterval = 1h;
@@ -260,6 +315,7 @@ namespace llarp
 
     RoutePoker m_RoutePoker;
 
+    /// ask for the low level links to be pumped, requests before the next pump share it
     void
     PumpLL() override;
 
@@ -283,14 +339,13 @@ namespace llarp
     OutboundMessageHandler _outboundMessageHandler;
     OutboundSessionMaker _outboundSessionMaker;
     LinkManager _linkManager;
+    /// which peers our paths, transit hops and lookups go through
+    PeerUsage m_PeerUsage;
+    /// how long a warm session outlives the busiest peers list it fell off
+    static constexpr auto WarmSessionHold = 30s;
     RCLookupHandler _rcLookupHandler;
     RCGossiper _rcGossiper;
 
-    using Clock_t = std::chrono::steady_clock;
-    using TimePoint_t = Clock_t::time_point;
-
-    TimePoint_t m_NextExploreAt;
-
     IOutboundMessageHandler&
     outboundMessageHandler() override
     {
@@ -315,6 +370,12 @@ namespace llarp
       return _rcLookupHandler;
     }
 
+    I_RCGossiper&
+    rcGossiper() override
+    {
+      return _rcGossiper;
+    }
+
     std::shared_ptr<PeerDb>
     peerDb() override
     {
@@ -324,6 +385,18 @@ namespace llarp
     void
     GossipRCIfNeeded(const RouterContact rc) override;
 
+    void
+    SetIdleAllowed(bool allowed) override;
+
+    bool
+    IsIdle() const override
+    {
+      return m_Idle.load(std::memory_order_relaxed);
+    }
+
+    void
+    NotifyUserActivity() override;
+
     explicit Router(llarp_ev_loop_ptr __netloop, std::shared_ptr<Logic> logic);
 
     virtual ~Router() override;
@@ -451,13 +524,23 @@ namespace llarp
     llarp_time_t
     Now() const override
     {
-      return llarp::time_now_ms();
+      return llarp::coarse_now_ms();
     }
 
     /// schedule ticker to call i ms from now
     void
     ScheduleTicker(llarp_time_t i = 1s);
 
+    /// run chore from Tick first from now and every interval after, for the sweeps that have
+    /// no need to run on every tick, so they spread out instead of all landing on one
+    void
+    ScheduleChore(
+        uint32_t id, llarp_time_t first, llarp_time_t interval, std::function<void(void)> chore);
+
+    /// schedule every chore, once at startup
+    void
+    StartChores();
+
     /// parse a routing message in a buffer and handle it with a handler if
     /// successful parsing return true on parse and handle success otherwise
     /// return false
@@ -497,6 +580,16 @@ namespace llarp
     void
     handle_router_ticker();
 
+    /// goes idle from Tick once the user has been quiet long enough
+    void
+    UpdateIdle(llarp_time_t now);
+
+    void
+    LeaveIdle();
+
+    void
+    SetLinksIdle(bool idle);
+
     void
     AfterStopLinks();
 
@@ -511,6 +604,9 @@ namespace llarp
       return m_Config;
     }
 
+    std::vector<std::string>
+    Reconfigure(std::shared_ptr<Config> conf) override;
+
    private:
     std::atomic<bool> _stopping;
     std::atomic<bool> _running;
@@ -519,11 +615,46 @@ namespace llarp
 
     llarp_time_t m_LastStatsReport = 0s;
 
+    std::atomic<bool> m_IdleAllowed{false};
+    std::atomic<bool> m_Idle{false};
+    std::atomic<llarp_time_t> m_LastUserActivity{0s};
+
     std::shared_ptr<llarp::KeyManager> m_keyManager;
     std::shared_ptr<PeerDb> m_peerDb;
 
     uint32_t path_build_count = 0;
 
+    /// the chores Tick runs on intervals of their own
+    util::TimerWheel m_Chores;
+    /// how long each Tick took, to see the logic thread stall
+    util::DurationHistogram m_TickTimes;
+
+    /// ours in m_Metrics, set each Tick
+    metrics::Histogram* m_TickMetric = nullptr;
+    metrics::Gauge* m_RoutersMetric = nullptr;
+    metrics::Gauge* m_ClientsMetric = nullptr;
+    metrics::Gauge* m_CryptoQueuedMetric = nullptr;
+    /// what QueueDiskIO has given the disk thread, set from any thread
+    metrics::Gauge* m_DiskQueuedMetric = nullptr;
+    metrics::Histogram* m_DiskWaitMetric = nullptr;
+
+    std::shared_ptr<path::PathPool> m_PathPool;
+
+    /// a pump was asked for and hasn't run yet
+    bool m_PumpPending = false;
+    uint64_t m_PumpsRun = 0;
+    uint64_t m_PumpsCoalesced = 0;
+
+    /// called once per event loop iteration and for pending pump requests
+    void
+    DoPump();
+
+    /// refilled on the crypto workers
+    std::unique_ptr<EphemeralKeyCache> m_EphemeralKeys;
+
+    /// declared last so the workers are joined before anything their jobs use goes away
+    std::unique_ptr<thread::WorkerPool> m_CryptoWorkers;
+
     bool
     ShouldReportStats(llarp_time_t now) const;
 
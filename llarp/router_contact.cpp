@@ -2,6 +2,7 @@
 
 #include <constants/version.hpp>
 #include <crypto/crypto.hpp>
+#include <crypto/verified_cache.hpp>
 #include <net/net.hpp>
 #include <util/bencode.hpp>
 #include <util/buffer.hpp>
@@ -12,7 +13,9 @@
 
 #include <lokimq/bt_serialize.h>
 
+#include <algorithm>
 #include <fstream>
+#include <memory>
 #include <util/fs.hpp>
 
 namespace llarp
@@ -38,6 +41,37 @@ namespace llarp
   /// update RCs shortly before they are about to expire
   llarp_time_t RouterContact::UpdateInterval = RouterContact::StaleInsertionAge - 5min;
 
+  /// rcs whose signature we checked, shared by the nodedb, lookups and gossip which see the
+  /// same rc from many peers
+  static VerifiedCache&
+  VerifiedRCs()
+  {
+    static VerifiedCache cache{1h, 8192};
+    return cache;
+  }
+
+  /// digest of the key and the whole encoding, signature included, so neither a copy with a
+  /// bad signature nor one put under another key matches one we verified
+  static bool
+  VerifiedDigest(const RouterContact& rc, ShortHash& digest)
+  {
+    std::array<byte_t, PUBKEYSIZE + MAX_RC_SIZE> tmp;
+    llarp_buffer_t buf(tmp);
+    if (not buf.write(rc.pubkey.begin(), rc.pubkey.end()))
+      return false;
+    if (not rc.BEncode(&buf))
+      return false;
+    buf.sz = buf.cur - buf.base;
+    buf.cur = buf.base;
+    return VerifiedCache::Digest(digest, buf);
+  }
+
+  util::StatusObject
+  VerifiedRCStatus()
+  {
+    return VerifiedRCs().ExtractStatus();
+  }
+
   NetID::NetID(const byte_t* val)
   {
     size_t len = strnlen(reinterpret_cast<const char*>(val), size());
@@ -448,6 +482,25 @@ namespace llarp
 
   bool
   RouterContact::Verify(llarp_time_t now, bool allowExpired) const
+  {
+    if (!VerifyFields(now, allowExpired))
+      return false;
+    ShortHash digest;
+    const bool cacheable = VerifiedDigest(*this, digest);
+    if (cacheable and VerifiedRCs().Contains(digest, now))
+      return true;
+    if (!VerifySignature())
+    {
+      llarp::LogError("invalid signature: ", *this);
+      return false;
+    }
+    if (cacheable)
+      VerifiedRCs().Add(digest, now);
+    return true;
+  }
+
+  bool
+  RouterContact::VerifyFields(llarp_time_t now, bool allowExpired) const
   {
     if (netID != NetID::DefaultValue())
     {
@@ -472,12 +525,84 @@ namespace llarp
         return false;
       }
     }
-    if (!VerifySignature())
+    return true;
+  }
+
+  size_t
+  RouterContact::VerifyMany(
+      const RouterContact* rcs, size_t num, llarp_time_t now, bool* valid, bool allowExpired)
+  {
+    // version 0 signs its own encoding with the signature zeroed, which needs somewhere to
+    // live until the batch is checked
+    std::vector<std::array<byte_t, MAX_RC_SIZE>> encoded;
+    std::vector<SignatureCheck> checks;
+    std::vector<size_t> checked;
+    // digest of each checked rc, zero for one we could not digest
+    std::vector<ShortHash> digests;
+    checks.reserve(num);
+    checked.reserve(num);
+    digests.reserve(num);
+    size_t numValid = 0;
+    encoded.reserve(std::count_if(
+        rcs, rcs + num, [](const RouterContact& rc) { return rc.version == 0; }));
+    for (size_t idx = 0; idx < num; ++idx)
     {
-      llarp::LogError("invalid signature: ", *this);
-      return false;
+      const auto& rc = rcs[idx];
+      valid[idx] = false;
+      if (not rc.VerifyFields(now, allowExpired))
+        continue;
+      ShortHash digest;
+      if (not VerifiedDigest(rc, digest))
+        digest.Zero();
+      else if (VerifiedRCs().Contains(digest, now))
+      {
+        valid[idx] = true;
+        numValid++;
+        continue;
+      }
+      if (rc.version == 0)
+      {
+        RouterContact copy;
+        copy = rc;
+        copy.signature.Zero();
+        llarp_buffer_t buf(encoded.emplace_back());
+        if (!copy.BEncode(&buf))
+        {
+          llarp::LogError("bencode failed");
+          encoded.pop_back();
+          continue;
+        }
+        checks.push_back({&rc.pubkey, buf.base, size_t(buf.cur - buf.base), &rc.signature});
+      }
+      else if (rc.version == 1)
+      {
+        checks.push_back({&rc.pubkey,
+                          reinterpret_cast<const byte_t*>(rc.signed_bt_dict.data()),
+                          rc.signed_bt_dict.size(),
+                          &rc.signature});
+      }
+      else
+        continue;
+      checked.push_back(idx);
+      digests.push_back(digest);
     }
-    return true;
+    if (checks.empty())
+      return numValid;
+    auto results = std::make_unique<bool[]>(checks.size());
+    CryptoManager::instance()->verify_batch(checks.data(), checks.size(), results.get());
+    for (size_t idx = 0; idx < checked.size(); ++idx)
+    {
+      valid[checked[idx]] = results[idx];
+      if (results[idx])
+      {
+        numValid++;
+        if (not digests[idx].IsZero())
+          VerifiedRCs().Add(digests[idx], now);
+      }
+      else
+        llarp::LogError("invalid signature: ", rcs[checked[idx]]);
+    }
+    return numValid;
   }
 
   bool
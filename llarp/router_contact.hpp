@@ -188,6 +188,20 @@ namespace llarp
     bool
     Verify(llarp_time_t now, bool allowExpired = true) const;
 
+    /// the checks Verify does other than the signature
+    bool
+    VerifyFields(llarp_time_t now, bool allowExpired = true) const;
+
+    /// Verify rcs[0] to rcs[num - 1] with one batched signature check, sets valid[i] for
+    /// rcs[i] and returns how many are valid
+    static size_t
+    VerifyMany(
+        const RouterContact* rcs,
+        size_t num,
+        llarp_time_t now,
+        bool* valid,
+        bool allowExpired = true);
+
     bool
     Sign(const llarp::SecretKey& secret);
 
@@ -239,6 +253,10 @@ namespace llarp
     return rc.print(out, -1, -1);
   }
 
+  /// hits and size of the cache of rcs whose signature was already checked
+  util::StatusObject
+  VerifiedRCStatus();
+
   using RouterLookupHandler = std::function<void(const std::vector<RouterContact>&)>;
 }  // namespace llarp
 
@@ -1,5 +1,5 @@
 #include <router_id.hpp>
-#include <lokimq/base32z.h>
+#include <util/base32z.hpp>
 
 namespace llarp
 {
@@ -8,7 +8,9 @@ namespace llarp
   std::string
   RouterID::ToString() const
   {
-    std::string b32 = lokimq::to_base32z(begin(), end());
+    std::string b32;
+    b32.reserve(base32z::EncodedSize(SIZE) + SNODE_TLD.size());
+    base32z::AppendKey(b32, data());
     b32 += SNODE_TLD;
     return b32;
   }
@@ -17,7 +19,7 @@ namespace llarp
   RouterID::ShortString() const
   {
     // 5 bytes produces exactly 8 base32z characters:
-    return lokimq::to_base32z(begin(), begin() + 5);
+    return base32z::Encode(data(), 5);
   }
 
   util::StatusObject
@@ -38,9 +40,8 @@ namespace llarp
     // - must end in a 1-bit value: 'o' or 'y' (i.e. 10000 or 00000)
     // - must have 51 preceeding base32z chars
     // - thus we get 51*5+1 = 256 bits = 32 bytes of output
-    if (str.size() != 52 || !lokimq::is_base32z(str) || !(str.back() == 'o' || str.back() == 'y'))
+    if (str.size() != 52 || !(str.back() == 'o' || str.back() == 'y'))
       return false;
-    lokimq::from_base32z(str.begin(), str.end(), begin());
-    return true;
+    return base32z::Decode(str, data(), SIZE);
   }
 }  // namespace llarp
@@ -37,6 +37,13 @@ namespace llarp
     bool
     IsCompatableWith(const RouterVersion& other) const;
 
+    /// return true if the router version is routerVersion or later, whatever the protocol
+    bool
+    IsAtLeast(const Version_t& routerVersion) const
+    {
+      return m_Version >= routerVersion;
+    }
+
     /// compare router versions
     bool
     operator<(const RouterVersion& other) const
@@ -0,0 +1,104 @@
+#include <routing/batch_message.hpp>
+
+#include <routing/handler.hpp>
+#include <util/bencode.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace routing
+  {
+    bool
+    BatchMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
+    {
+      bool read = false;
+      if (key == "M")
+      {
+        read = true;
+        M.clear();
+        const bool decoded = bencode_read_list(
+            [this](llarp_buffer_t* buffer, bool has) {
+              if (not has)
+                return true;
+              llarp_buffer_t item;
+              if (not bencode_read_string(buffer, &item))
+                return false;
+              M.emplace_back(reinterpret_cast<const char*>(item.base), item.sz);
+              return true;
+            },
+            val);
+        if (not decoded)
+          return false;
+      }
+      if (!BEncodeMaybeReadDictInt("S", S, read, key, val))
+        return false;
+      if (!BEncodeMaybeReadDictInt("V", version, read, key, val))
+        return false;
+      return read;
+    }
+
+    bool
+    BatchMessage::BEncode(llarp_buffer_t* buf) const
+    {
+      if (!bencode_start_dict(buf))
+        return false;
+      if (!BEncodeWriteDictMsgType(buf, "A", "B"))
+        return false;
+      if (!bencode_write_bytestring(buf, "M", 1))
+        return false;
+      if (!bencode_start_list(buf))
+        return false;
+      for (const auto& item : M)
+      {
+        if (!bencode_write_bytestring(buf, item.data(), item.size()))
+          return false;
+      }
+      if (!bencode_end(buf))
+        return false;
+      if (!BEncodeWriteDictInt("S", S, buf))
+        return false;
+      if (!BEncodeWriteDictInt("V", LLARP_PROTO_VERSION, buf))
+        return false;
+      return bencode_end(buf);
+    }
+
+    bool
+    BatchMessage::HandleMessage(IMessageHandler* h, AbstractRouter* r) const
+    {
+      return h->HandleBatchMessage(*this, r);
+    }
+
+    bool
+    MessageBatcher::Add(const llarp_buffer_t& encoded, llarp_time_t now)
+    {
+      if (not Batchable(encoded))
+        return false;
+      if (m_Taken)
+      {
+        m_Bytes.clear();
+        m_Items.clear();
+        m_Taken = false;
+      }
+      if (m_Bytes.size() + encoded.sz > MaxBatchSize)
+        return false;
+      if (m_Items.empty())
+        m_Started = now;
+      m_Items.emplace_back(m_Bytes.size(), encoded.sz);
+      m_Bytes.insert(m_Bytes.end(), encoded.base, encoded.base + encoded.sz);
+      return true;
+    }
+
+    void
+    MessageBatcher::Take(BatchMessage& msg)
+    {
+      msg.M.clear();
+      for (const auto& [offset, size] : m_Items)
+        msg.M.emplace_back(reinterpret_cast<const char*>(m_Bytes.data()) + offset, size);
+      m_Batched += m_Items.size();
+      m_Batches++;
+      m_Items.clear();
+      m_Taken = true;
+    }
+  }  // namespace routing
+}  // namespace llarp
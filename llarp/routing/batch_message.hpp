@@ -0,0 +1,107 @@
+#ifndef LLARP_ROUTING_BATCH_MESSAGE_HPP
+#define LLARP_ROUTING_BATCH_MESSAGE_HPP
+
+#include <routing/message.hpp>
+#include <util/time.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace llarp
+{
+  namespace routing
+  {
+    /// several small routing messages sent as one, so they share one relay cell and one pass
+    /// of onion crypto per hop. only sent to the far end of a path once it has shown it
+    /// understands them
+    struct BatchMessage final : public IMessage
+    {
+      /// encoded routing messages, views into the buffer this was decoded from or into the
+      /// batcher that packed them
+      std::vector<std::string_view> M;
+
+      bool
+      BEncode(llarp_buffer_t* buf) const override;
+
+      bool
+      DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
+
+      void
+      Clear() override
+      {
+        M.clear();
+        version = 0;
+      }
+
+      bool
+      HandleMessage(IMessageHandler* h, AbstractRouter* r) const override;
+    };
+
+    /// collects encoded routing messages for one direction of a hop until they go out as one
+    /// BatchMessage
+    struct MessageBatcher
+    {
+      /// messages bigger than this go on their own, they fill a cell by themselves anyway
+      static constexpr size_t MaxItemSize = 1024;
+      /// most bytes of messages one batch carries, leaving room in the cell for its framing
+      static constexpr size_t MaxBatchSize = 3584;
+
+      /// set once the far end has shown it understands batches
+      bool enabled = false;
+
+      /// copy an encoded message into the batch, return false if it has to be sent on its own
+      /// or the batch has to be taken first to make room for it
+      bool
+      Add(const llarp_buffer_t& encoded, llarp_time_t now);
+
+      /// return true if encoded would go in the batch if it was taken first
+      bool
+      Batchable(const llarp_buffer_t& encoded) const
+      {
+        return enabled and encoded.sz <= MaxItemSize;
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Items.empty();
+      }
+
+      /// when the oldest message in the batch was added
+      llarp_time_t
+      Started() const
+      {
+        return m_Started;
+      }
+
+      /// move the batch into msg, whose views stay valid until the next Add
+      void
+      Take(BatchMessage& msg);
+
+      /// messages and batches that went out through Take
+      uint64_t
+      Batched() const
+      {
+        return m_Batched;
+      }
+
+      uint64_t
+      Batches() const
+      {
+        return m_Batches;
+      }
+
+     private:
+      std::vector<byte_t> m_Bytes;
+      /// offset and size of each message in m_Bytes
+      std::vector<std::pair<size_t, size_t>> m_Items;
+      /// set after Take so the next Add starts over
+      bool m_Taken = false;
+      llarp_time_t m_Started = 0s;
+      uint64_t m_Batched = 0;
+      uint64_t m_Batches = 0;
+    };
+  }  // namespace routing
+}  // namespace llarp
+
+#endif
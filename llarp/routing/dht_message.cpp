@@ -2,6 +2,8 @@
 
 #include <router/abstractrouter.hpp>
 #include <routing/handler.hpp>
+#include <util/alloc_stats.hpp>
+#include <util/tracy.hpp>
 
 namespace llarp
 {
@@ -53,16 +55,19 @@ namespace llarp
     bool
     DHTMessage::HandleMessage(IMessageHandler* h, AbstractRouter* r) const
     {
+      alloc::Scope allocScope{alloc::DHTMessages};
+      LLARP_ZONE("routing::DHTMessage::HandleMessage");
       // set source as us
       const llarp::dht::Key_t us(r->pubkey());
+      // handle all of them, one bad reply in a batch must not drop the ones after it
+      bool result = true;
       for (const auto& msg : M)
       {
         msg->From = us;
         msg->pathID = from;
-        if (!h->HandleDHTMessage(*msg, r))
-          return false;
+        result &= h->HandleDHTMessage(*msg, r);
       }
-      return true;
+      return result;
     }
   }  // namespace routing
 }  // namespace llarp
@@ -19,6 +19,7 @@ namespace llarp
 
   namespace routing
   {
+    struct BatchMessage;
     struct DataDiscardMessage;
     struct GrantExitMessage;
     struct ObtainExitMessage;
@@ -69,8 +70,20 @@ namespace llarp
 
       virtual bool
       HandlePathLatencyMessage(const PathLatencyMessage& msg, AbstractRouter* r) = 0;
+
+      /// a batch came in, its messages are handled one by one after this
+      virtual bool
+      HandleBatchMessage(const BatchMessage& msg, AbstractRouter* r) = 0;
+
       virtual bool
       HandleDHTMessage(const dht::IMessage& msg, AbstractRouter* r) = 0;
+
+      /// false to turn away the dht messages that come in next without decoding them
+      virtual bool
+      AcceptingDHTMessages(AbstractRouter*)
+      {
+        return true;
+      }
     };
 
     using MessageHandler_ptr = std::shared_ptr<IMessageHandler>;
@@ -3,6 +3,7 @@
 #include <exit/exit_messages.hpp>
 #include <messages/discard.hpp>
 #include <path/path_types.hpp>
+#include <routing/batch_message.hpp>
 #include <routing/dht_message.hpp>
 #include <routing/path_confirm_message.hpp>
 #include <routing/path_latency_message.hpp>
@@ -10,6 +11,8 @@
 #include <routing/transfer_traffic_message.hpp>
 #include <util/mem.hpp>
 
+#include <string_view>
+
 namespace llarp
 {
   namespace routing
@@ -28,6 +31,7 @@ namespace llarp
       ObtainExitMessage O;
       UpdateExitMessage U;
       CloseExitMessage C;
+      BatchMessage B;
     };
 
     InboundMessageParser::InboundMessageParser() : m_Holder(std::make_unique<MessageHolder>())
@@ -94,6 +98,12 @@ namespace llarp
           case 'C':
             msg = &m_Holder->C;
             break;
+          case 'B':
+            if (inBatch)
+              llarp::LogError("batch routing message inside a batch");
+            else
+              msg = &m_Holder->B;
+            break;
           default:
             llarp::LogError("invalid routing message id: ", *strbuf.cur);
         }
@@ -110,6 +120,14 @@ namespace llarp
     InboundMessageParser::ParseMessageBuffer(
         const llarp_buffer_t& buf, IMessageHandler* h, const PathID_t& from, AbstractRouter* r)
     {
+      // the type is always the first key, so dht messages a handler is not taking any more of
+      // are turned away here without decoding the lookups inside
+      static constexpr std::string_view DHTPrefix{"d1:A1:M"};
+      if (buf.sz >= DHTPrefix.size()
+          and std::string_view{reinterpret_cast<const char*>(buf.base), DHTPrefix.size()}
+              == DHTPrefix
+          and not h->AcceptingDHTMessages(r))
+        return true;
       bool result = false;
       msg = nullptr;
       firstKey = true;
@@ -128,6 +146,12 @@ namespace llarp
         {
           llarp::LogWarn("Failed to handle inbound routing message ", ourKey);
         }
+        else if (ourKey == 'B')
+        {
+          // views into copy, which outlives parsing them. swapped so neither vector lets go
+          // of its storage
+          m_Batch.swap(m_Holder->B.M);
+        }
       }
       else
       {
@@ -138,6 +162,18 @@ namespace llarp
         msg->Clear();
       msg = nullptr;
       version = 0;
+      if (not m_Batch.empty())
+      {
+        // the messages in a batch can not be batches, so m_Batch is left alone until done
+        inBatch = true;
+        for (const auto& item : m_Batch)
+        {
+          if (not ParseMessageBuffer(llarp_buffer_t(item.data(), item.size()), h, from, r))
+            result = false;
+        }
+        inBatch = false;
+        m_Batch.clear();
+      }
       return result;
     }
   }  // namespace routing
@@ -5,6 +5,8 @@
 #include <util/buffer.hpp>
 
 #include <memory>
+#include <string_view>
+#include <vector>
 
 namespace llarp
 {
@@ -34,11 +36,15 @@ namespace llarp
      private:
       uint64_t version = 0;
       bool firstKey{false};
+      /// set while parsing the messages of a batch, which may not hold batches themselves
+      bool inBatch{false};
       char ourKey{'\0'};
       struct MessageHolder;
 
       IMessage* msg{nullptr};
       std::unique_ptr<MessageHolder> m_Holder;
+      /// the messages of the batch being handled, kept so its storage is reused
+      std::vector<std::string_view> m_Batch;
     };
   }  // namespace routing
 }  // namespace llarp
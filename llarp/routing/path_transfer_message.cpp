@@ -1,51 +1,35 @@
 #include <routing/path_transfer_message.hpp>
 
 #include <routing/handler.hpp>
+#include <util/bencode.hpp>
 #include <util/buffer.hpp>
 
 namespace llarp
 {
   namespace routing
   {
+    namespace
+    {
+      // the version is read but not checked
+      using PathTransferSchema = BEncodeSchema<
+          BEncodeDictMsgType<'A', 'T'>,
+          BEncodeDictEntry<'P', &PathTransferMessage::P>,
+          BEncodeDictInt<'S', &IMessage::S>,
+          BEncodeDictEntry<'T', &PathTransferMessage::T>,
+          BEncodeDictVersion<'V', false>,
+          BEncodeDictEntry<'Y', &PathTransferMessage::Y>>;
+    }  // namespace
+
     bool
     PathTransferMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val)
     {
-      bool read = false;
-      if (!BEncodeMaybeReadDictEntry("P", P, read, key, val))
-        return false;
-      if (!BEncodeMaybeReadDictInt("S", S, read, key, val))
-        return false;
-      if (!BEncodeMaybeReadDictEntry("T", T, read, key, val))
-        return false;
-      if (!BEncodeMaybeReadDictInt("V", version, read, key, val))
-        return false;
-      if (!BEncodeMaybeReadDictEntry("Y", Y, read, key, val))
-        return false;
-      return read;
+      return PathTransferSchema::DecodeKey(*this, key, val);
     }
 
     bool
     PathTransferMessage::BEncode(llarp_buffer_t* buf) const
     {
-      if (!bencode_start_dict(buf))
-        return false;
-      if (!BEncodeWriteDictMsgType(buf, "A", "T"))
-        return false;
-      if (!BEncodeWriteDictEntry("P", P, buf))
-        return false;
-
-      if (!BEncodeWriteDictInt("S", S, buf))
-        return false;
-
-      if (!BEncodeWriteDictEntry("T", T, buf))
-        return false;
-
-      if (!BEncodeWriteDictInt("V", LLARP_PROTO_VERSION, buf))
-        return false;
-      if (!BEncodeWriteDictEntry("Y", Y, buf))
-        return false;
-
-      return bencode_end(buf);
+      return PathTransferSchema::Encode(*this, buf);
     }
 
     bool
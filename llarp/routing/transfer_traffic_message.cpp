@@ -34,7 +34,12 @@ namespace llarp
         return false;
       if (!BEncodeWriteDictInt("V", version, buf))
         return false;
-      if (!BEncodeWriteDictList("X", X, buf))
+      if (XView.empty())
+      {
+        if (!BEncodeWriteDictList("X", X, buf))
+          return false;
+      }
+      else if (!BEncodeWriteDictList("X", XView, buf))
         return false;
       return bencode_end(buf);
     }
@@ -47,7 +52,7 @@ namespace llarp
         return false;
       if (!BEncodeMaybeReadDictInt("V", version, read, key, buf))
         return false;
-      if (!BEncodeMaybeReadDictList("X", X, read, key, buf))
+      if (!BEncodeMaybeReadDictList("X", XView, read, key, buf))
         return false;
       return read;
     }
@@ -3,6 +3,7 @@
 
 #include <crypto/encrypted.hpp>
 #include <routing/message.hpp>
+#include <util/bencode.hpp>
 
 #include <vector>
 
@@ -16,16 +17,33 @@ namespace llarp
     struct TransferTrafficMessage final : public IMessage
     {
       std::vector<llarp::Encrypted<MaxExitMTU + ExitOverhead>> X;
+      /// set instead of X when decoded, views into the routing message buffer that are only
+      /// valid until HandleMessage returns
+      std::vector<BEncodeView<MaxExitMTU + ExitOverhead>> XView;
       size_t _size = 0;
 
       void
       Clear() override
       {
         X.clear();
+        XView.clear();
         _size = 0;
         version = 0;
       }
 
+      /// call visit with each packet, decoded or put, until it returns false
+      template <typename Visit_t>
+      void
+      ForEachPacket(Visit_t visit) const
+      {
+        for (const auto& pkt : XView)
+          if (not visit(llarp_buffer_t(pkt.data(), pkt.size())))
+            return;
+        for (const auto& pkt : X)
+          if (not visit(llarp_buffer_t(pkt.data(), pkt.size())))
+            return;
+      }
+
       size_t
       Size() const
       {
@@ -4,9 +4,14 @@
 #include <util/logging/logger.hpp>
 
 #include <router/abstractrouter.hpp>
+#include <router/i_rc_lookup_handler.hpp>
+#include <consensus/table.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <iterator>
+
 #include <util/time.hpp>
 #include <util/thread/logic.hpp>
 
@@ -73,6 +78,7 @@ namespace llarp
     {
       nlohmann::json request, fields;
       fields["pubkey_ed25519"] = true;
+      fields["active_since_height"] = true;
       request["fields"] = fields;
       request["active_only"] = true;
       if (not m_CurrentBlockHash.empty())
@@ -124,6 +130,19 @@ namespace llarp
       UpdateServiceNodeList();
     }
 
+    /// blocks in a day, a router gains a weight for each day it has been active
+    static constexpr uint64_t BlocksPerDay = 720;
+    /// past a month of being active a router is as good as any other that long up
+    static constexpr uint64_t MaxUptimeDays = 30;
+
+    /// how strongly a router is drawn from the consensus table for how long it has been up.
+    /// lokid tells us nothing of bandwidth so uptime is all it goes on
+    static uint32_t
+    UptimeWeight(uint64_t activeBlocks)
+    {
+      return 1 + std::min(activeBlocks / BlocksPerDay, MaxUptimeDays);
+    }
+
     void
     LokidRpcClient::HandleGotServiceNodeList(std::string data)
     {
@@ -147,7 +166,9 @@ namespace llarp
         }
       }
 
+      const uint64_t height = j.value("height", uint64_t{0});
       std::vector<RouterID> nodeList;
+      std::vector<consensus::Table::Entry> entries;
       {
         const auto itr = j.find("service_node_states");
         if (itr != j.end() and itr->is_array())
@@ -158,8 +179,11 @@ namespace llarp
             if (ed_itr == j_itr->end() or not ed_itr->is_string())
               continue;
             RouterID rid;
-            if (rid.FromHex(ed_itr->get<std::string>()))
-              nodeList.emplace_back(std::move(rid));
+            if (not rid.FromHex(ed_itr->get<std::string>()))
+              continue;
+            const uint64_t since = j_itr->value("active_since_height", height);
+            entries.push_back({rid, UptimeWeight(height > since ? height - since : 0)});
+            nodeList.emplace_back(std::move(rid));
           }
         }
       }
@@ -169,10 +193,49 @@ namespace llarp
         LogWarn("got empty service node list from lokid");
         return;
       }
-      // inform router about the new list
-      LogicCall(m_Router->logic(), [r = m_Router, nodeList = std::move(nodeList)]() mutable {
-        r->SetRouterWhitelist(std::move(nodeList));
-      });
+      // the weights move with every block so the table is made again whole each time
+      m_Router->rcLookupHandler().SetConsensusTable(
+          std::make_shared<const consensus::Table>(std::move(entries)));
+      std::sort(nodeList.begin(), nodeList.end());
+      nodeList.erase(std::unique(nodeList.begin(), nodeList.end()), nodeList.end());
+
+      std::unique_lock lock{m_ServiceNodesMutex};
+      if (m_ServiceNodes.empty())
+      {
+        m_ServiceNodes = nodeList;
+        lock.unlock();
+        // inform router about the new list
+        LogicCall(m_Router->logic(), [r = m_Router, nodeList = std::move(nodeList)]() mutable {
+          r->SetRouterWhitelist(std::move(nodeList));
+        });
+        return;
+      }
+      // from one block to the next only a few join or leave, so the router only hears of those
+      std::vector<RouterID> added, removed;
+      std::set_difference(
+          nodeList.begin(),
+          nodeList.end(),
+          m_ServiceNodes.begin(),
+          m_ServiceNodes.end(),
+          std::back_inserter(added));
+      std::set_difference(
+          m_ServiceNodes.begin(),
+          m_ServiceNodes.end(),
+          nodeList.begin(),
+          nodeList.end(),
+          std::back_inserter(removed));
+      m_ServiceNodes = std::move(nodeList);
+      lock.unlock();
+      if (added.empty() and removed.empty())
+      {
+        LogDebug("service node list unchanged");
+        return;
+      }
+      LogicCall(
+          m_Router->logic(),
+          [r = m_Router, added = std::move(added), removed = std::move(removed)]() {
+            r->UpdateRouterWhitelist(added, removed);
+          });
     }
 
     SecretKey
@@ -8,6 +8,9 @@
 #include <dht/key.hpp>
 #include <service/name.hpp>
 
+#include <mutex>
+#include <vector>
+
 namespace llarp
 {
   struct AbstractRouter;
@@ -71,6 +74,10 @@ namespace llarp
       std::optional<lokimq::ConnectionID> m_Connection;
       LMQ_ptr m_lokiMQ;
       std::string m_CurrentBlockHash;
+      /// the service node list as we last gave it to the router, sorted so the next one can
+      /// go to it as a diff
+      std::vector<RouterID> m_ServiceNodes;
+      std::mutex m_ServiceNodesMutex;
 
       AbstractRouter* const m_Router;
     };
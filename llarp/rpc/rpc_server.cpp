@@ -8,12 +8,45 @@
 #include <service/context.hpp>
 #include <service/auth.hpp>
 #include <service/name.hpp>
+#include <util/alloc_stats.hpp>
+#include <util/cpu_profiler.hpp>
+#include <util/metrics.hpp>
 
 namespace llarp::rpc
 {
-  RpcServer::RpcServer(LMQ_ptr lmq, AbstractRouter* r) : m_LMQ(std::move(lmq)), m_Router(r)
+  RpcServer::RpcServer(LMQ_ptr lmq, AbstractRouter* r)
+      : m_LMQ(std::move(lmq))
+      , m_Router(r)
+      , m_Running(&r->metrics().AddGauge(
+            "llarp_rpc_requests_running", "rpc requests an lmq thread is serving"))
+      , m_RequestTimes(&r->metrics().AddHistogram(
+            "llarp_rpc_request_microseconds",
+            "how long each rpc request held its lmq thread",
+            metrics::LatencyBounds()))
   {}
 
+  template <typename Handler_t>
+  std::function<void(lokimq::Message&)>
+  RpcServer::Timed(Handler_t handler)
+  {
+    return [this, handler = std::move(handler)](lokimq::Message& msg) {
+      const auto started = metrics::Histogram::Clock_t::now();
+      m_Running->Add(1);
+      // lokimq catches what a handler throws, the count has to come down either way
+      try
+      {
+        handler(msg);
+      }
+      catch (...)
+      {
+        m_Running->Add(-1);
+        throw;
+      }
+      m_Running->Add(-1);
+      m_RequestTimes->ObserveSince(started);
+    };
+  }
+
   /// maybe parse json from message paramter at index
   std::optional<nlohmann::json>
   MaybeParseJSON(const lokimq::Message& msg, size_t index = 0)
@@ -52,6 +85,25 @@ namespace llarp::rpc
   /// a function that replies to an rpc request
   using ReplyFunction_t = std::function<void(std::string)>;
 
+  std::shared_ptr<const RpcServer::StatusSnapshot>
+  RpcServer::CachedStatus()
+  {
+    std::lock_guard lock{m_StatusMutex};
+    if (m_Status and std::chrono::steady_clock::now() - m_StatusAt < StatusCacheInterval)
+      return m_Status;
+    std::promise<util::StatusObject> result;
+    LogicCall(m_Router->logic(), [&result, r = m_Router]() {
+      result.set_value(r->ExtractStatus());
+    });
+    auto snapshot = std::make_shared<StatusSnapshot>();
+    snapshot->status = result.get_future().get();
+    // serialized here, off the logic thread
+    snapshot->reply = CreateJSONResponse(snapshot->status);
+    m_Status = std::move(snapshot);
+    m_StatusAt = std::chrono::steady_clock::now();
+    return m_Status;
+  }
+
   void
   HandleJSONRequest(
       lokimq::Message& msg, std::function<void(nlohmann::json, ReplyFunction_t)> handleRequest)
@@ -84,10 +136,10 @@ namespace llarp::rpc
   RpcServer::AsyncServeRPC(lokimq::address url)
   {
     m_LMQ->listen_plain(url.zmq_address());
-    m_LMQ->add_category("llarp", lokimq::AuthLevel::none)
+    m_LMQ->add_category("llarp", lokimq::AuthLevel::none, 0, MaxQueuedRequests)
         .add_command(
             "halt",
-            [&](lokimq::Message& msg) {
+            Timed([&](lokimq::Message& msg) {
               if (not m_Router->IsRunning())
               {
                 msg.send_reply(CreateJSONError("router is not running"));
@@ -95,28 +147,130 @@ namespace llarp::rpc
               }
               m_Router->Stop();
               msg.send_reply(CreateJSONResponse("OK"));
-            })
+            }))
         .add_request_command(
             "version",
-            [r = m_Router](lokimq::Message& msg) {
+            Timed([r = m_Router](lokimq::Message& msg) {
               util::StatusObject result{{"version", llarp::VERSION_FULL},
                                         {"uptime", to_json(r->Uptime())}};
               msg.send_reply(CreateJSONResponse(result));
-            })
+            }))
         .add_request_command(
             "status",
-            [&](lokimq::Message& msg) {
-              std::promise<util::StatusObject> result;
-              LogicCall(m_Router->logic(), [&result, r = m_Router]() {
-                const auto state = r->ExtractStatus();
-                result.set_value(state);
-              });
-              auto ftr = result.get_future();
-              msg.send_reply(CreateJSONResponse(ftr.get()));
-            })
+            Timed([&](lokimq::Message& msg) {
+              // replies with a snapshot up to StatusCacheInterval old. {"fields": [...]} picks
+              // which of its top level fields come back
+              if (msg.data.empty())
+              {
+                msg.send_reply(CachedStatus()->reply);
+                return;
+              }
+              const auto maybe = MaybeParseJSON(msg);
+              if (not maybe or not maybe->is_object())
+              {
+                msg.send_reply(CreateJSONError("request data not a json object"));
+                return;
+              }
+              const auto fields = maybe->find("fields");
+              if (fields == maybe->end())
+              {
+                msg.send_reply(CachedStatus()->reply);
+                return;
+              }
+              if (not fields->is_array())
+              {
+                msg.send_reply(CreateJSONError("fields must be a list of strings"));
+                return;
+              }
+              const auto snapshot = CachedStatus();
+              util::StatusObject picked = util::StatusObject::object();
+              for (const auto& field : *fields)
+              {
+                if (not field.is_string())
+                {
+                  msg.send_reply(CreateJSONError("fields must be a list of strings"));
+                  return;
+                }
+                const auto& name = field.get_ref<const std::string&>();
+                const auto itr = snapshot->status.find(name);
+                if (itr != snapshot->status.end())
+                  picked[name] = *itr;
+              }
+              msg.send_reply(CreateJSONResponse(std::move(picked)));
+            }))
+        .add_request_command(
+            "metrics",
+            Timed([r = m_Router](lokimq::Message& msg) {
+              // counters are read as they are, so scraping never waits on the logic thread.
+              // replies with the prometheus text, or bt if asked with {"format": "bt"}
+              bool bt = false;
+              if (not msg.data.empty())
+              {
+                const auto maybe = MaybeParseJSON(msg);
+                if (not maybe or not maybe->is_object())
+                {
+                  msg.send_reply(CreateJSONError("request data not a json object"));
+                  return;
+                }
+                const auto format = maybe->value("format", std::string{"prometheus"});
+                if (format != "prometheus" and format != "bt")
+                {
+                  msg.send_reply(CreateJSONError("unknown format: " + format));
+                  return;
+                }
+                bt = format == "bt";
+              }
+              msg.send_reply(bt ? r->metrics().BTEncoded() : r->metrics().PrometheusText());
+            }))
+        .add_request_command(
+            "allocations",
+            Timed([](lokimq::Message& msg) {
+              // counted with atomics as they happen, so this does not go through the logic
+              // thread either. only has numbers in a build with WITH_ALLOC_STATS
+              msg.send_reply(CreateJSONResponse(alloc::ExtractStatus()));
+            }))
+        .add_request_command(
+            "cpuprofile",
+            Timed([](lokimq::Message& msg) {
+              // samples in process for {"seconds": n}, holding this rpc thread meanwhile, and
+              // replies with folded stacks for a flamegraph
+              if (not util::CpuProfilingSupported())
+              {
+                msg.send_reply(CreateJSONError("cpu profiling not supported on this platform"));
+                return;
+              }
+              int64_t seconds = 10;
+              int64_t hz = 99;
+              if (not msg.data.empty())
+              {
+                const auto maybe = MaybeParseJSON(msg);
+                if (not maybe or not maybe->is_object())
+                {
+                  msg.send_reply(CreateJSONError("request data not a json object"));
+                  return;
+                }
+                seconds = maybe->value("seconds", seconds);
+                hz = maybe->value("hz", hz);
+              }
+              if (seconds < 1 or seconds > 60 or hz < 1 or hz > 1000)
+              {
+                msg.send_reply(CreateJSONError("seconds must be 1 to 60 and hz 1 to 1000"));
+                return;
+              }
+              const auto profile = util::ProfileCpu(std::chrono::seconds{seconds}, hz);
+              if (not profile)
+              {
+                msg.send_reply(CreateJSONError("a cpu profile is already running"));
+                return;
+              }
+              msg.send_reply(CreateJSONResponse(util::StatusObject{
+                  {"samples", profile->samples},
+                  {"dropped", profile->dropped},
+                  {"folded", profile->folded}}));
+            }))
         .add_request_command(
             "exit",
-            [&](lokimq::Message& msg) {
+            Timed([&](lokimq::Message& msg) {
               HandleJSONRequest(msg, [r = m_Router](nlohmann::json obj, ReplyFunction_t reply) {
                 if (r->IsServiceNode())
                 {
@@ -259,8 +413,30 @@ namespace llarp::rpc
                       reply(CreateJSONResponse("OK"));
                     });
               });
-            })
-        .add_request_command("config", [&](lokimq::Message& msg) {
+            }))
+        .add_request_command(
+            "reload",
+            Timed([&](lokimq::Message& msg) {
+              // the file is read and parsed here so the logic thread only applies the changes
+              std::promise<std::shared_ptr<Config>> current;
+              LogicCall(m_Router->logic(), [&current, r = m_Router]() {
+                current.set_value(r->GetConfig());
+              });
+              const auto conf = current.get_future().get();
+              auto reloaded = conf ? conf->Reload() : nullptr;
+              if (not reloaded)
+              {
+                msg.send_reply(CreateJSONError("failed to load config file"));
+                return;
+              }
+              std::promise<std::vector<std::string>> restart;
+              LogicCall(m_Router->logic(), [&restart, r = m_Router, reloaded]() {
+                restart.set_value(r->Reconfigure(reloaded));
+              });
+              const util::StatusObject result{{"restartRequired", restart.get_future().get()}};
+              msg.send_reply(CreateJSONResponse(result));
+            }))
+        .add_request_command("config", Timed([&](lokimq::Message& msg) {
           HandleJSONRequest(msg, [r = m_Router](nlohmann::json obj, ReplyFunction_t reply) {
             {
               const auto itr = obj.find("override");
@@ -301,6 +477,6 @@ namespace llarp::rpc
             }
             reply(CreateJSONResponse("OK"));
           });
-        });
+        }));
   }
 }  // namespace llarp::rpc
@@ -3,10 +3,23 @@
 #include <string_view>
 #include <lokimq/lokimq.h>
 #include <lokimq/address.h>
+#include <util/status.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace llarp
 {
   struct AbstractRouter;
+
+  namespace metrics
+  {
+    struct Gauge;
+    struct Histogram;
+  }  // namespace metrics
 }
 
 namespace llarp::rpc
@@ -21,7 +34,36 @@ namespace llarp::rpc
     AsyncServeRPC(lokimq::address addr);
 
    private:
+    /// requests waiting on an lmq thread past this many are turned away by lokimq
+    static constexpr int MaxQueuedRequests = 64;
+
+    /// handler counted in m_Running and m_RequestTimes while it runs
+    template <typename Handler_t>
+    std::function<void(lokimq::Message&)>
+    Timed(Handler_t handler);
+
+    /// how long one status snapshot answers requests for
+    static constexpr std::chrono::seconds StatusCacheInterval{1};
+
+    struct StatusSnapshot
+    {
+      util::StatusObject status;
+      /// the reply to a request for all of it, made once
+      std::string reply;
+    };
+
+    /// the router's status no older than StatusCacheInterval. it is only taken on the logic
+    /// thread when the last one went stale, so however often status is polled the logic
+    /// thread builds it at most once an interval, and requests made meanwhile share it
+    std::shared_ptr<const StatusSnapshot>
+    CachedStatus();
+
     LMQ_ptr m_LMQ;
     AbstractRouter* const m_Router;
+    std::mutex m_StatusMutex;
+    std::shared_ptr<const StatusSnapshot> m_Status;
+    std::chrono::steady_clock::time_point m_StatusAt;
+    metrics::Gauge* m_Running;
+    metrics::Histogram* m_RequestTimes;
   };
 }  // namespace llarp::rpc
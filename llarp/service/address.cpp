@@ -1,6 +1,6 @@
 #include <service/address.hpp>
 #include <crypto/crypto.hpp>
-#include <lokimq/base32z.h>
+#include <util/base32z.hpp>
 #include <algorithm>
 
 namespace llarp
@@ -28,7 +28,7 @@ namespace llarp
         str = subdomain;
         str += '.';
       }
-      str += lokimq::to_base32z(begin(), end());
+      base32z::AppendKey(str, data());
       str += tld;
       return str;
     }
@@ -58,11 +58,10 @@ namespace llarp
       // - must end in a 1-bit value: 'o' or 'y' (i.e. 10000 or 00000)
       // - must have 51 preceeding base32z chars
       // - thus we get 51*5+1 = 256 bits = 32 bytes of output
-      if (str.size() != 52 || !lokimq::is_base32z(str) || !(str.back() == 'o' || str.back() == 'y'))
+      if (str.size() != 52 || !(str.back() == 'o' || str.back() == 'y'))
         return false;
 
-      lokimq::from_base32z(str.begin(), str.end(), begin());
-      return true;
+      return base32z::Decode(str, data(), SIZE);
     }
 
     dht::Key_t
@@ -96,7 +96,7 @@ namespace llarp
         size_t
         operator()(const Address& buf) const
         {
-          return std::accumulate(buf.begin(), buf.end(), 0, std::bit_xor<size_t>());
+          return AlignedBuffer<32>::Hash()(buf);
         }
       };
     };
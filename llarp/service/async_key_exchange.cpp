@@ -4,6 +4,7 @@
 #include <crypto/types.hpp>
 #include <util/meta/memfn.hpp>
 #include <util/thread/logic.hpp>
+#include <util/time.hpp>
 #include <utility>
 
 namespace llarp
@@ -49,14 +50,29 @@ namespace llarp
       // derive ntru session key component
       SharedSecret K;
       auto crypto = CryptoManager::instance();
-      crypto->pqe_encrypt(frame->C, K, self->introPubKey);
+      const auto now = time_now_ms();
+      if (self->handshakes)
+        self->handshakes->Encapsulate(frame->C, K, self->introPubKey, now);
+      else
+        crypto->pqe_encrypt(frame->C, K, self->introPubKey);
       // randomize Nonce
       frame->N.Randomize();
       // compure post handshake session key
       // PKE (A, B, N)
       SharedSecret sharedSecret;
-      path_dh_func dh_client = util::memFn(&Crypto::dh_client, crypto);
-      if (!self->m_LocalIdentity.KeyExchange(dh_client, sharedSecret, self->m_remote, frame->N))
+      bool exchanged = false;
+      if (self->handshakes)
+      {
+        exchanged = self->handshakes->ClientDH(
+            sharedSecret, self->m_LocalIdentity, self->m_remote, frame->N, now);
+      }
+      else
+      {
+        path_dh_func dh_client = util::memFn(&Crypto::dh_client, crypto);
+        exchanged =
+            self->m_LocalIdentity.KeyExchange(dh_client, sharedSecret, self->m_remote, frame->N);
+      }
+      if (not exchanged)
       {
         LogError("failed to derive x25519 shared key component");
       }
@@ -71,7 +87,7 @@ namespace llarp
       // set sender
       self->msg.sender = self->m_LocalIdentity.pub;
       // set version
-      self->msg.version = LLARP_PROTO_VERSION;
+      self->msg.version = ProtocolMessage::RepairFramesVersion;
       // encrypt and sign
       if (frame->EncryptAndSign(self->msg, K, self->m_LocalIdentity))
         LogicCall(self->logic, std::bind(&AsyncKeyExchange::Result, self, frame));
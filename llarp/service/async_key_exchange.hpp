@@ -2,6 +2,7 @@
 #define LLARP_SERVICE_ASYNC_KEY_EXCHANGE_HPP
 
 #include <crypto/types.hpp>
+#include <service/handshake_cache.hpp>
 #include <service/identity.hpp>
 #include <service/protocol.hpp>
 
@@ -24,6 +25,8 @@ namespace llarp
       std::function<void(std::shared_ptr<ProtocolFrame>)> hook;
       IDataHandler* handler;
       ConvoTag tag;
+      /// where to reuse handshake secrets from, none does the full handshake every time
+      HandshakeCache* handshakes = nullptr;
 
       AsyncKeyExchange(
           std::shared_ptr<Logic> l,
@@ -0,0 +1,13 @@
+#include <service/bundle.hpp>
+
+namespace llarp
+{
+  namespace service
+  {
+    bool
+    Bundle::Takes(ProtocolType proto)
+    {
+      return proto == eProtocolTrafficV4 or proto == eProtocolTrafficV6 or proto == eProtocolExit;
+    }
+  }  // namespace service
+}  // namespace llarp
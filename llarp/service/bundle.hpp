@@ -0,0 +1,76 @@
+#ifndef LLARP_SERVICE_BUNDLE_HPP
+#define LLARP_SERVICE_BUNDLE_HPP
+
+#include <service/protocol_type.hpp>
+#include <util/endian.hpp>
+#include <util/types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// several ip packets of one convo sent as the payload of one eProtocolBundle message, so
+    /// a burst of small packets takes one frame's encryption, signature and cell rather than
+    /// one each. each packet goes in as its proto byte, 2 byte length and the packet
+    struct Bundle
+    {
+      /// most bytes of packets and their headers one bundle holds, the largest ip packet a
+      /// message carries on its own, so a bundle fits in a frame wherever that packet does
+      static constexpr size_t MaxSize = 1500;
+      /// the proto and length in front of each packet
+      static constexpr size_t ItemHeaderSize = 1 + 2;
+
+      /// true for the protos whose messages may go in a bundle
+      static bool
+      Takes(ProtocolType proto);
+
+      /// true if a bundle of sz bytes has room for a packet of itemsz more
+      static constexpr bool
+      Fits(size_t sz, size_t itemsz)
+      {
+        return sz + ItemHeaderSize + itemsz <= MaxSize;
+      }
+
+      /// append a packet to the bundle in into, which must have room for it
+      template <typename Bytes_t>
+      static void
+      Append(Bytes_t& into, ProtocolType proto, const byte_t* data, size_t sz)
+      {
+        const size_t at = into.size();
+        into.resize(at + ItemHeaderSize + sz);
+        into[at] = proto;
+        htobe16buf(into.data() + at + 1, sz);
+        std::copy_n(data, sz, into.data() + at + ItemHeaderSize);
+      }
+
+      /// call visit with the proto, start and size of each packet in bundle in order. false if
+      /// it was cut short or holds something not Takes, though every packet before that was
+      /// visited
+      template <typename Bytes_t, typename Visit>
+      static bool
+      ForEach(Bytes_t& bundle, Visit visit)
+      {
+        size_t idx = 0;
+        while (idx < bundle.size())
+        {
+          if (idx + ItemHeaderSize > bundle.size())
+            return false;
+          const ProtocolType proto = bundle[idx];
+          const size_t sz = bufbe16toh(bundle.data() + idx + 1);
+          idx += ItemHeaderSize;
+          if (not Takes(proto) or idx + sz > bundle.size())
+            return false;
+          visit(proto, bundle.data() + idx, sz);
+          idx += sz;
+        }
+        return true;
+      }
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
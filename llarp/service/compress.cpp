@@ -0,0 +1,112 @@
+#include <service/compress.hpp>
+
+#include <service/bundle.hpp>
+#include <util/endian.hpp>
+#include <util/lz4.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace llarp
+{
+  namespace service
+  {
+    bool
+    Compression::Takes(ProtocolType proto)
+    {
+      return Bundle::Takes(proto) or proto == eProtocolBundle;
+    }
+
+    bool
+    Compression::Compress(
+        ProtocolType proto, const byte_t* data, size_t sz, util::PooledVector<byte_t>& out)
+    {
+      if (not Takes(proto) or sz < MinSize or sz > MaxSize)
+        return false;
+      std::array<byte_t, HeaderSize + lz4::CompressBound(MaxSize)> tmp;
+      // anything that does not fit in sz less the header is no saving
+      const size_t compressed = lz4::Compress(data, sz, tmp.data() + HeaderSize, sz - HeaderSize);
+      if (compressed == 0 or PaddedSize(compressed) >= sz)
+        return false;
+      tmp[0] = proto;
+      htobe16buf(tmp.data() + 1, sz);
+      htobe16buf(tmp.data() + 3, compressed);
+      out.assign(tmp.begin(), tmp.begin() + HeaderSize + compressed);
+      out.resize(PaddedSize(compressed), 0);
+      return true;
+    }
+
+    bool
+    Compression::Decompress(
+        const byte_t* data, size_t sz, ProtocolType& proto, util::PooledVector<byte_t>& out)
+    {
+      if (sz < HeaderSize or not Takes(data[0]))
+        return false;
+      const size_t original = bufbe16toh(data + 1);
+      const size_t compressed = bufbe16toh(data + 3);
+      if (original > MaxSize or compressed > sz - HeaderSize)
+        return false;
+      util::PooledVector<byte_t> expanded(original);
+      if (not lz4::Decompress(data + HeaderSize, compressed, expanded.data(), original))
+        return false;
+      proto = data[0];
+      out = std::move(expanded);
+      return true;
+    }
+
+    bool
+    CompressionGate::ShouldTry()
+    {
+      util::Lock lock(m_Mutex);
+      if (m_Skip == 0)
+        return true;
+      m_Skip--;
+      m_Bypassed++;
+      return false;
+    }
+
+    void
+    CompressionGate::Tried(bool saved)
+    {
+      util::Lock lock(m_Mutex);
+      if (saved)
+      {
+        m_Compressed++;
+        m_Misses = 0;
+        m_Backoff = MinBackoff;
+        return;
+      }
+      if (++m_Misses < Misses)
+        return;
+      m_Misses = 0;
+      m_Skip = m_Backoff;
+      m_Backoff = std::min(m_Backoff * 2, MaxBackoff);
+    }
+
+    void
+    CompressionGate::Apply(ProtocolType& proto, util::PooledVector<byte_t>& payload)
+    {
+      if (not Compression::Takes(proto) or payload.size() < Compression::MinSize
+          or not ShouldTry())
+        return;
+      const bool saved = Compression::Compress(proto, payload.data(), payload.size(), payload);
+      if (saved)
+        proto = eProtocolCompressed;
+      Tried(saved);
+    }
+
+    uint64_t
+    CompressionGate::Compressed() const
+    {
+      util::Lock lock(m_Mutex);
+      return m_Compressed;
+    }
+
+    uint64_t
+    CompressionGate::Bypassed() const
+    {
+      util::Lock lock(m_Mutex);
+      return m_Bypassed;
+    }
+  }  // namespace service
+}  // namespace llarp
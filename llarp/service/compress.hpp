@@ -0,0 +1,94 @@
+#ifndef LLARP_SERVICE_COMPRESS_HPP
+#define LLARP_SERVICE_COMPRESS_HPP
+
+#include <service/protocol_type.hpp>
+#include <util/pool.hpp>
+#include <util/thread/threading.hpp>
+#include <util/types.hpp>
+
+#include <cstdint>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// the payload of an eProtocolCompressed message: the proto and size of the payload it
+    /// stands for, the size of that payload lz4 compressed, then the compressed bytes padded
+    /// with zeros to a multiple of SizeClass. the padding keeps how well a payload compressed,
+    /// which says something about what is in it, to a few steps rather than to the byte
+    struct Compression
+    {
+      /// proto, 2 byte size and 2 byte compressed size
+      static constexpr size_t HeaderSize = 1 + 2 + 2;
+      /// payloads under this are sent as they are, too little repeats in them to be worth it
+      static constexpr size_t MinSize = 256;
+      /// most bytes a payload decompresses to, more than any message carries
+      static constexpr size_t MaxSize = 2048;
+      static constexpr size_t SizeClass = 64;
+
+      /// true for the protos whose payloads may be compressed
+      static bool
+      Takes(ProtocolType proto);
+
+      /// the padded size of a compressed payload of sz bytes, header included
+      static constexpr size_t
+      PaddedSize(size_t sz)
+      {
+        return (HeaderSize + sz + SizeClass - 1) / SizeClass * SizeClass;
+      }
+
+      /// put the sz bytes of proto's payload at data into out compressed, false with out left
+      /// as it was if proto is not Takes or it would not come out smaller
+      static bool
+      Compress(
+          ProtocolType proto, const byte_t* data, size_t sz, util::PooledVector<byte_t>& out);
+
+      /// the proto and payload the compressed payload of sz bytes at data stands for, false if
+      /// it is malformed or stands for a proto that is not Takes
+      static bool
+      Decompress(
+          const byte_t* data, size_t sz, ProtocolType& proto, util::PooledVector<byte_t>& out);
+    };
+
+    /// whether a convo's next payload is worth trying to compress. after Misses payloads in a
+    /// row that did not come out smaller, encrypted or already compressed traffic most likely,
+    /// it stops trying for a while, twice as long each time up to MaxBackoff, so a convo that
+    /// does not compress stops paying for it. safe from any thread
+    struct CompressionGate
+    {
+      static constexpr uint64_t Misses = 8;
+      static constexpr uint64_t MinBackoff = 16;
+      static constexpr uint64_t MaxBackoff = 1024;
+
+      /// false while backing off, which counts as one payload skipped
+      bool
+      ShouldTry();
+
+      /// tell the gate whether the payload it let through came out smaller
+      void
+      Tried(bool saved);
+
+      /// compress proto's payload in place, making it eProtocolCompressed, if it is worth
+      /// trying and comes out smaller
+      void
+      Apply(ProtocolType& proto, util::PooledVector<byte_t>& payload);
+
+      uint64_t
+      Compressed() const;
+
+      /// payloads sent as they were without trying, while backing off
+      uint64_t
+      Bypassed() const;
+
+     private:
+      mutable util::Mutex m_Mutex;
+      uint64_t m_Misses GUARDED_BY(m_Mutex) = 0;
+      uint64_t m_Skip GUARDED_BY(m_Mutex) = 0;
+      uint64_t m_Backoff GUARDED_BY(m_Mutex) = MinBackoff;
+      uint64_t m_Compressed GUARDED_BY(m_Mutex) = 0;
+      uint64_t m_Bypassed GUARDED_BY(m_Mutex) = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
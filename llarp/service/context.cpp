@@ -1,5 +1,6 @@
 #include <service/context.hpp>
 
+#include <handlers/embedded.hpp>
 #include <handlers/null.hpp>
 #include <handlers/tun.hpp>
 #include <nodedb.hpp>
@@ -30,12 +31,21 @@ namespace llarp
            [](AbstractRouter* r, service::Context* c) {
              return std::make_shared<handlers::TunEndpoint>(r, c, true);
            }},
+          {"embedded",
+           [](AbstractRouter* r, service::Context* c) {
+             return std::make_shared<handlers::EmbeddedEndpoint>(r, c);
+           }},
           {"null", [](AbstractRouter* r, service::Context* c) {
              return std::make_shared<handlers::NullEndpoint>(r, c);
            }}};
 
     }  // namespace
-    Context::Context(AbstractRouter* r) : m_Router(r)
+    Context::Context(AbstractRouter* r)
+        : m_Router(r)
+        , m_EndpointsMetric(
+              r->metrics().AddGauge("llarp_service_endpoints", "hidden service endpoints we run"))
+        , m_PathsMetric(r->metrics().AddGauge(
+              "llarp_service_paths", "established paths of our hidden service endpoints"))
     {}
 
     Context::~Context() = default;
@@ -108,10 +118,14 @@ namespace llarp
         }
       }
       // tick active endpoints
+      size_t paths = 0;
       for (const auto& item : m_Endpoints)
       {
         item.second->Tick(now);
+        paths += item.second->NumInStatus(path::ePathEstablished);
       }
+      m_EndpointsMetric.Set(m_Endpoints.size());
+      m_PathsMetric.Set(paths);
     }
 
     bool
@@ -137,15 +151,34 @@ namespace llarp
     bool
     Context::StartAll()
     {
+      using Clock_t = std::chrono::steady_clock;
       auto itr = m_Endpoints.begin();
       while (itr != m_Endpoints.end())
       {
+        const auto started = Clock_t::now();
+        if (auto loading = m_LoadingKeys.find(itr->first); loading != m_LoadingKeys.end())
+        {
+          const bool loaded = loading->second.get();
+          m_LoadingKeys.erase(loading);
+          if (not loaded)
+          {
+            LogError(itr->first, " keyfile could not be loaded");
+            return false;
+          }
+        }
+        const auto keysDone = Clock_t::now();
         if (!itr->second->Start())
         {
           LogError(itr->first, " failed to start");
           return false;
         }
-        LogInfo(itr->first, " started");
+        LogInfo(
+            itr->first,
+            " started in ",
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock_t::now() - started),
+            ", waited ",
+            std::chrono::duration_cast<std::chrono::milliseconds>(keysDone - started),
+            " of that for its keyfile");
         ++itr;
       }
       return true;
@@ -191,12 +224,26 @@ namespace llarp
       // pass conf to service
       service->Configure(conf.network, conf.dns);
 
-      if (not service->LoadKeyFile())
-        throw std::runtime_error("Endpoint's keyfile could not be loaded");
-
-      // autostart if requested
-      if (autostart)
+      if (not autostart)
+      {
+        // reading or making the keys can take a while, so it overlaps loading the nodedb
+        auto loaded = std::make_shared<std::promise<bool>>();
+        m_LoadingKeys.emplace(endpointName, loaded->get_future());
+        m_Router->QueueDiskIO([service, loaded]() {
+          try
+          {
+            loaded->set_value(service->LoadKeyFile());
+          }
+          catch (...)
+          {
+            loaded->set_exception(std::current_exception());
+          }
+        });
+      }
+      else
       {
+        if (not service->LoadKeyFile())
+          throw std::runtime_error("Endpoint's keyfile could not be loaded");
         if (service->Start())
           LogInfo("autostarting hidden service endpoint ", service->Name());
         else
@@ -5,7 +5,9 @@
 #include <net/net.hpp>
 #include <config/config.hpp>
 #include <service/endpoint.hpp>
+#include <util/metrics.hpp>
 
+#include <future>
 #include <unordered_map>
 
 namespace llarp
@@ -37,7 +39,8 @@ namespace llarp
       void
       ForEachService(std::function<bool(const std::string&, const Endpoint_ptr&)> visit) const;
 
-      /// add endpoint via config
+      /// add endpoint via config. unless it autostarts its keyfile loads on the disk thread
+      /// while the router sets up the rest, StartAll waits for it
       void
       AddEndpoint(const Config& conf, bool autostart = false);
 
@@ -66,6 +69,10 @@ namespace llarp
       AbstractRouter* const m_Router;
       std::unordered_map<std::string, std::shared_ptr<Endpoint>> m_Endpoints;
       std::list<std::shared_ptr<Endpoint>> m_Stopped;
+      /// keyfiles of endpoints not started yet, by endpoint name
+      std::unordered_map<std::string, std::future<bool>> m_LoadingKeys;
+      metrics::Gauge& m_EndpointsMetric;
+      metrics::Gauge& m_PathsMetric;
     };
   }  // namespace service
 }  // namespace llarp
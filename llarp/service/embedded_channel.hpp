@@ -0,0 +1,130 @@
+#ifndef LLARP_SERVICE_EMBEDDED_CHANNEL_HPP
+#define LLARP_SERVICE_EMBEDDED_CHANNEL_HPP
+
+#include <util/buffer.hpp>
+#include <util/endian.hpp>
+#include <util/time.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// datagrams are handed on as they arrive, streams in the order they were sent. reliable
+    /// streams also get back what is lost, see ReliableSender
+    enum class ChannelKind : uint8_t
+    {
+      Datagram = 0,
+      Stream = 1,
+      Reliable = 2,
+      /// a StreamAck for a reliable stream the receiver of it sends on, never listened on
+      Ack = 3
+    };
+
+    /// goes in front of every buffer an embedded endpoint sends, in place of the ip and
+    /// transport headers a tun would need
+    struct ChannelHeader
+    {
+      static constexpr size_t Size = 8;
+
+      ChannelKind kind = ChannelKind::Datagram;
+      uint16_t port = 0;
+      /// counts up from 0 on each stream, 0 on datagrams and acks
+      uint32_t seqno = 0;
+
+      void
+      Encode(byte_t* out) const
+      {
+        out[0] = static_cast<byte_t>(kind);
+        out[1] = 0;
+        htobe16buf(out + 2, port);
+        htobe32buf(out + 4, seqno);
+      }
+
+      /// nothing if buf is too short to hold one or is of a kind we do not know
+      static std::optional<ChannelHeader>
+      Decode(const llarp_buffer_t& buf)
+      {
+        if (buf.sz < Size or buf.base[0] > static_cast<byte_t>(ChannelKind::Ack))
+          return std::nullopt;
+        ChannelHeader hdr;
+        hdr.kind = static_cast<ChannelKind>(buf.base[0]);
+        hdr.port = bufbe16toh(buf.base + 2);
+        hdr.seqno = bufbe32toh(buf.base + 4);
+        return hdr;
+      }
+    };
+
+    /// puts one stream back in order. a stream never skips data, so once a gap has held
+    /// buffers back for HoleTimeout, or MaxHeld are waiting behind it, the stream is broken and
+    /// takes nothing more
+    struct StreamReassembly
+    {
+      static constexpr auto HoleTimeout = 2s;
+      static constexpr size_t MaxHeld = 256;
+
+      /// take the buffer sent as seqno, calling deliver with every buffer now in order. false
+      /// once the stream is broken
+      template <typename Deliver_t>
+      bool
+      Push(uint32_t seqno, std::vector<byte_t> data, llarp_time_t now, Deliver_t&& deliver)
+      {
+        if (m_Broken)
+          return false;
+        // already had it
+        if (seqno < m_Next)
+          return true;
+        if (seqno > m_Next)
+        {
+          m_Held.emplace(seqno, std::make_pair(now, std::move(data)));
+          if (m_Held.size() > MaxHeld)
+            m_Broken = true;
+          return not m_Broken;
+        }
+        deliver(data);
+        m_Next++;
+        auto itr = m_Held.begin();
+        while (itr != m_Held.end() and itr->first == m_Next)
+        {
+          deliver(itr->second.second);
+          m_Next++;
+          itr = m_Held.erase(itr);
+        }
+        return true;
+      }
+
+      /// false once the stream is broken
+      bool
+      Expire(llarp_time_t now)
+      {
+        if (not m_Held.empty() and m_Held.begin()->second.first + HoleTimeout <= now)
+          m_Broken = true;
+        return not m_Broken;
+      }
+
+      bool
+      Broken() const
+      {
+        return m_Broken;
+      }
+
+      size_t
+      Held() const
+      {
+        return m_Held.size();
+      }
+
+     private:
+      uint32_t m_Next = 0;
+      bool m_Broken = false;
+      std::map<uint32_t, std::pair<llarp_time_t, std::vector<byte_t>>> m_Held;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -11,41 +11,55 @@
 #include <dht/messages/gotname.hpp>
 #include <dht/messages/gotrouter.hpp>
 #include <dht/messages/pubintro.hpp>
+#include <exit/snode_registry.hpp>
+#include <net/ip_packet.hpp>
 #include <nodedb.hpp>
 #include <profiling.hpp>
 #include <router/abstractrouter.hpp>
+#include <router/i_outbound_session_maker.hpp>
 #include <routing/dht_message.hpp>
 #include <routing/path_transfer_message.hpp>
+#include <service/bundle.hpp>
 #include <service/endpoint_state.hpp>
 #include <service/endpoint_util.hpp>
 #include <service/hidden_service_address_lookup.hpp>
 #include <service/outbound_context.hpp>
+#include <service/warm_state.hpp>
 #include <service/protocol.hpp>
 #include <util/thread/logic.hpp>
 #include <util/str.hpp>
 #include <util/buffer.hpp>
 #include <util/meta/memfn.hpp>
+#include <util/alloc_stats.hpp>
 #include <hook/shell.hpp>
 #include <link/link_manager.hpp>
 #include <tooling/dht_event.hpp>
 
+#include <algorithm>
 #include <utility>
 
 namespace llarp
 {
   namespace service
   {
+    /// how many queues opened frames are spread over and how deep each is
+    static constexpr size_t RecvQueueShards = 4;
+    static constexpr size_t RecvQueueSize = 512;
+
     Endpoint::Endpoint(AbstractRouter* r, Context* parent)
         : path::Builder(r, 3, path::default_len)
         , context(parent)
         , m_InboundTrafficQueue(512)
         , m_SendQueue(512)
-        , m_RecvQueue(512)
     {
       m_state = std::make_unique<EndpointState>();
       m_state->m_Router = r;
       m_state->m_Name = "endpoint";
-      m_RecvQueue.enable();
+      for (size_t idx = 0; idx < RecvQueueShards; ++idx)
+      {
+        m_RecvQueues.emplace_back(std::make_unique<thread::Queue<RecvDataEvent>>(RecvQueueSize));
+        m_RecvQueues.back()->enable();
+      }
     }
 
     bool
@@ -56,6 +70,7 @@ namespace llarp
 
       if (conf.m_Hops.has_value())
         numHops = *conf.m_Hops;
+      padding = conf.m_Padding;
 
       conf.m_ExitMap.ForEachEntry(
           [&](const IPRange& range, const service::Address& addr) { MapExitRange(range, addr); });
@@ -76,6 +91,61 @@ namespace llarp
       return m_state->Configure(conf);
     }
 
+    void
+    Endpoint::Reconfigure(const Config& prev, const Config& conf)
+    {
+      // paths already built keep their length and padding, the next ones get the new ones
+      if (conf.network.m_Paths.has_value())
+        numPaths = *conf.network.m_Paths;
+      if (conf.network.m_Hops.has_value())
+        numHops = *conf.network.m_Hops;
+      padding = conf.network.m_Padding;
+
+      // only the exact range goes, UnmapExitRange would take the ranges inside it too
+      const auto unmap = [this](const IPRange& range) {
+        m_ExitMap.RemoveIf([&](const auto& item) -> bool {
+          if (item.first.addr != range.addr or item.first.netmask_bits != range.netmask_bits)
+            return false;
+          LogInfo(Name(), " unmap ", item.first, " from exit at ", item.second);
+          return true;
+        });
+        m_ExitMapVersion++;
+      };
+      prev.network.m_ExitMap.ForEachEntry([&](const IPRange& range, const Address& addr) {
+        if (conf.network.m_ExitMap.GetExact(range) != addr)
+          unmap(range);
+      });
+      conf.network.m_ExitMap.ForEachEntry([&](const IPRange& range, const Address& addr) {
+        if (prev.network.m_ExitMap.GetExact(range) != addr)
+          MapExitRange(range, addr);
+      });
+
+      for (const auto& [exit, auth] : prev.network.m_ExitAuths)
+      {
+        if (conf.network.m_ExitAuths.count(exit) == 0)
+          m_RemoteAuthInfos.erase(exit);
+      }
+      for (const auto& [exit, auth] : conf.network.m_ExitAuths)
+        SetAuthInfoForEndpoint(exit, auth);
+
+      // names are looked up again on tick like at startup, ranges of names that went are let go
+      prev.network.m_LNSExitMap.ForEachEntry([&](const IPRange& range, const std::string& name) {
+        if (conf.network.m_LNSExitMap.GetExact(range) == name)
+          return;
+        m_StartupLNSMappings.erase(name);
+        unmap(range);
+      });
+      conf.network.m_LNSExitMap.ForEachEntry([&](const IPRange& range, const std::string& name) {
+        if (prev.network.m_LNSExitMap.GetExact(range) == name)
+          return;
+        std::optional<AuthInfo> auth;
+        const auto itr = conf.network.m_LNSExitAuths.find(name);
+        if (itr != conf.network.m_LNSExitAuths.end())
+          auth = itr->second;
+        m_StartupLNSMappings[name] = std::make_pair(range, auth);
+      });
+    }
+
     llarp_ev_loop_ptr
     Endpoint::EndpointNetLoop()
     {
@@ -120,6 +190,8 @@ namespace llarp
       {
         introSet().I.emplace_back(std::move(intro));
       }
+      if (m_state->m_AggregateIntroSets and not introSet().I.empty())
+        AddPeerIntros(now);
       if (introSet().I.size() == 0)
       {
         LogWarn("not enough intros to publish introset for ", Name());
@@ -127,12 +199,34 @@ namespace llarp
           ManualRebuild(1);
         return;
       }
+      auto& published = m_state->m_PublishedIntroSet;
+      // a forced rebuild signs again only if it changed something, a dead path that was not in
+      // what we published does not
+      if (published and introSet().SameContentAs(m_state->m_PublishedContent)
+          and now < published->signedAt + INTROSET_RESIGN_AGE)
+      {
+        // nothing changed since we signed it, only storage that did not confirm hears it again
+        if (m_state->m_PublishConfirmed.size() >= llarp::dht::IntroSetStorageRedundancy)
+        {
+          LogDebug(Name(), " introset unchanged and stored, not republishing");
+          m_state->m_LastPublishAttempt = now;
+          m_state->m_PublishesSkipped++;
+          return;
+        }
+        m_state->m_PublishesResent++;
+        if (not RepublishUnconfirmed(*published, Router()))
+          LogWarn("failed to republish intro set for endpoint ", Name());
+        return;
+      }
       auto maybe = m_Identity.EncryptAndSignIntroSet(introSet(), now);
       if (not maybe)
       {
         LogWarn("failed to generate introset for endpoint ", Name());
         return;
       }
+      published = *maybe;
+      m_state->m_PublishedContent = introSet();
+      m_state->m_PublishConfirmed.clear();
       if (PublishIntroSet(*maybe, Router()))
       {
         LogInfo("(re)publishing introset for endpoint ", Name());
@@ -143,6 +237,90 @@ namespace llarp
       }
     }
 
+    /// most intros we put in one introset counting those of our peers, well inside what fits
+    static constexpr size_t MaxAggregateIntros = 16;
+    /// how often an aggregating endpoint looks up its own introset for its peers' intros
+    static constexpr auto PeerIntroLookupInterval = 1min;
+
+    void
+    Endpoint::AddPeerIntros(llarp_time_t now)
+    {
+      auto& own = m_state->m_OwnIntros;
+      for (auto itr = own.begin(); itr != own.end();)
+      {
+        if (itr->second <= now)
+          itr = own.erase(itr);
+        else
+          ++itr;
+      }
+      for (const auto& intro : introSet().I)
+        own[intro.pathID] = intro.expiresAt;
+
+      auto& peers = m_state->m_PeerIntros;
+      const auto expiring = [now](const auto& intro) {
+        return intro.ExpiresSoon(now, path::min_intro_lifetime);
+      };
+      peers.erase(std::remove_if(peers.begin(), peers.end(), expiring), peers.end());
+      // freshest first so a full introset keeps the ones that last longest
+      std::sort(peers.begin(), peers.end(), [](const auto& left, const auto& right) {
+        return left.expiresAt > right.expiresAt;
+      });
+      for (const auto& intro : peers)
+      {
+        if (introSet().I.size() >= MaxAggregateIntros)
+          break;
+        introSet().I.emplace_back(intro);
+      }
+    }
+
+    void
+    Endpoint::LookupPeerIntros(llarp_time_t now)
+    {
+      const auto paths = GetManyPathsWithUniqueEndpoints(this, 1);
+      if (paths.empty())
+        return;
+      m_state->m_LastPeerIntroLookup = now;
+      const Address addr = m_Identity.pub.Addr();
+      auto* job = new HiddenServiceAddressLookup(
+          this,
+          [this](const Address&, auto introset, const RouterID&) {
+            return OnPeerIntroSet(std::move(introset));
+          },
+          addr.ToKey(),
+          PubKey{addr.as_array()},
+          0,
+          GenTXID());
+      if (not job->SendRequestViaPath(*paths.begin(), Router()))
+        LogWarn(Name(), " could not look up our own introset for our peers' intros");
+    }
+
+    bool
+    Endpoint::OnPeerIntroSet(std::optional<IntroSet> introset)
+    {
+      if (not introset)
+        return true;
+      const auto now = Now();
+      auto& peers = m_state->m_PeerIntros;
+      bool fresh = false;
+      for (const auto& intro : introset->I)
+      {
+        if (intro.ExpiresSoon(now, path::min_intro_lifetime)
+            or m_state->m_OwnIntros.count(intro.pathID))
+          continue;
+        if (std::find(peers.begin(), peers.end(), intro) != peers.end())
+          continue;
+        peers.emplace_back(intro);
+        fresh = true;
+      }
+      // only new intros make us publish, so instances that already agree stay quiet
+      if (fresh)
+      {
+        LogInfo(Name(), " has ", peers.size(), " intros from its peers, republishing");
+        RegenAndPublishIntroSet();
+      }
+      return true;
+    }
+
     bool
     Endpoint::IsReady() const
     {
@@ -206,6 +384,20 @@ namespace llarp
       }
       obj["authCodes"] = authCodes;
 
+      size_t held = 0;
+      for (const auto& item : m_InboundReorder)
+        held += item.second.Held();
+      obj["multipath"] = util::StatusObject{{"width", MultipathWidth()},
+                                            {"reorderingConvos", m_InboundReorder.size()},
+                                            {"held", held}};
+      uint64_t repaired = m_Repaired;
+      for (const auto& item : m_InboundRepair)
+        repaired += item.second.first.Repaired();
+      obj["repair"] = util::StatusObject{{"enabled", UsesRepairFrames()},
+                                         {"repairingConvos", m_InboundRepair.size()},
+                                         {"repaired", repaired}};
+      obj["handshakes"] = m_Handshakes.ExtractStatus();
+
       return m_state->ExtractStatus(obj);
     }
 
@@ -218,11 +410,22 @@ namespace llarp
       {
         RegenAndPublishIntroSet();
       }
+      if (m_state->m_AggregateIntroSets and IsReady()
+          and now >= m_state->m_LastPeerIntroLookup + PeerIntroLookupInterval)
+      {
+        LookupPeerIntros(now);
+      }
+      if (not m_state->m_TimeToReady and IsReady())
+      {
+        m_state->m_TimeToReady = now - m_state->m_StartedAt;
+        LogInfo(Name(), " ready ", m_state->m_TimeToReady->count(), "ms after starting");
+      }
 
       // expire name cache
-      m_state->nameCache.Decay(now);
-      // expire snode sessions
-      EndpointUtil::ExpireSNodeSessions(now, m_state->m_SNodeSessions);
+      m_state->m_NameCache.Expire(now);
+      m_state->m_IntroSetCache.Expire(now);
+      // forget snode sessions that stopped, the router's registry ticks them
+      EndpointUtil::ExpireSNodeSessions(m_state->m_SNodeSessions);
       // expire pending tx
       EndpointUtil::ExpirePendingTx(now, m_state->m_PendingLookups);
       // expire pending router lookups
@@ -235,6 +438,19 @@ namespace llarp
           now, m_state->m_RemoteSessions, m_state->m_DeadSessions, Sessions());
       // expire convotags
       EndpointUtil::ExpireConvoSessions(now, Sessions());
+      // prefetches no traffic followed
+      for (auto itr = m_state->m_Prefetches.begin(); itr != m_state->m_Prefetches.end();)
+      {
+        if (now >= itr->second + PrefetchWindow)
+        {
+          m_state->m_PrefetchWasted++;
+          itr = m_state->m_Prefetches.erase(itr);
+        }
+        else
+          ++itr;
+      }
+      // expire cached handshake secrets
+      m_Handshakes.Expire(now);
 
       if (NumInStatus(path::ePathEstablished) > 1)
       {
@@ -250,7 +466,7 @@ namespace llarp
                   m_StartupLNSMappings.erase(name);
 
                   if (maybe_range.has_value())
-                    m_ExitMap.Insert(*maybe_range, *maybe_addr);
+                    MapExitRange(*maybe_range, *maybe_addr);
 
                   if (maybe_auth.has_value())
                     SetAuthInfoForEndpoint(*maybe_addr, *maybe_auth);
@@ -260,13 +476,93 @@ namespace llarp
       }
     }
 
+    std::optional<fs::path>
+    Endpoint::WarmStatePath() const
+    {
+      if (not m_state->m_WarmRestart or m_state->m_Keyfile.empty())
+        return std::nullopt;
+      return fs::path{m_state->m_Keyfile + ".warm"};
+    }
+
+    void
+    Endpoint::SaveWarmState() const
+    {
+      const auto fpath = WarmStatePath();
+      if (not fpath)
+        return;
+      WarmState state;
+      std::set<Address> seen;
+      for (const auto& [addr, session] : m_state->m_RemoteSessions)
+      {
+        if (state.introsets.size() >= WarmState::MaxIntroSets)
+          break;
+        if (seen.insert(addr).second)
+          state.introsets.push_back(session->GetCurrentIntroSet());
+      }
+      ForEachPath([&state](const path::Path_ptr& p) {
+        const auto& hops = state.firstHops;
+        if (not p->IsReady() or hops.size() >= WarmState::MaxFirstHops
+            or std::find(hops.begin(), hops.end(), p->Upstream()) != hops.end())
+          return;
+        state.firstHops.push_back(p->Upstream());
+      });
+      if (state.Save(*fpath, m_Identity))
+      {
+        LogInfo(
+            Name(),
+            " saved ",
+            state.introsets.size(),
+            " introsets and ",
+            state.firstHops.size(),
+            " first hops for a warm restart");
+      }
+      else
+        LogWarn(Name(), " failed to save warm state to ", *fpath);
+    }
+
+    void
+    Endpoint::LoadWarmState()
+    {
+      const auto fpath = WarmStatePath();
+      if (not fpath or not fs::exists(*fpath))
+        return;
+      WarmState state;
+      if (not state.Load(*fpath, m_Identity))
+        return;
+      const auto now = Now();
+      for (const auto& introset : state.introsets)
+      {
+        // what expired while we were down is dropped by the cache
+        if (not introset.Verify(now))
+          continue;
+        m_state->m_IntroSetCache.Put(introset.A.Addr().ToKey(), introset, now);
+        m_state->m_WarmIntroSets++;
+      }
+      // connect to the hops that carried our paths last run while the first paths are built
+      for (const auto& hop : state.firstHops)
+      {
+        if (not Router()->nodedb()->Has(hop))
+          continue;
+        Router()->outboundSessionMaker().CreateSessionTo(hop, nullptr);
+        m_state->m_WarmFirstHops++;
+      }
+      LogInfo(
+          Name(),
+          " warm start from ",
+          m_state->m_WarmIntroSets,
+          " introsets and ",
+          m_state->m_WarmFirstHops,
+          " first hops");
+    }
+
     bool
     Endpoint::Stop()
     {
+      SaveWarmState();
       // stop remote sessions
       EndpointUtil::StopRemoteSessions(m_state->m_RemoteSessions);
-      // stop snode sessions
-      EndpointUtil::StopSnodeSessions(m_state->m_SNodeSessions);
+      // let go of snode sessions, they stop once no other endpoint holds them
+      Router()->snodeSessions().ReleaseAll(this);
       if (m_OnDown)
         m_OnDown->NotifyAsync(NotifyParams());
       return path::Builder::Stop();
@@ -472,9 +768,23 @@ namespace llarp
           return false;
         }
       }
+      m_state->m_StartedAt = Now();
+      m_state->m_WaitingForUse = m_state->m_LazyStart;
+      if (m_state->m_WaitingForUse)
+        LogInfo(Name(), " building no paths until first used");
+      LoadWarmState();
       return true;
     }
 
+    void
+    Endpoint::NoteUse()
+    {
+      if (not m_state->m_WaitingForUse)
+        return;
+      m_state->m_WaitingForUse = false;
+      LogInfo(Name(), " first used ", Now() - m_state->m_StartedAt, " after start, building paths");
+    }
+
     Endpoint::~Endpoint()
     {
       if (m_OnUp)
@@ -551,7 +861,7 @@ namespace llarp
       HandleIntrosetResponse(const std::set<EncryptedIntroSet>& response) override
       {
         if (not response.empty())
-          m_Endpoint->IntroSetPublished();
+          m_Endpoint->IntroSetPublished(m_IntroSet.signedAt, m_relayOrder);
         else
           m_Endpoint->IntroSetPublishFail();
 
@@ -590,6 +900,27 @@ namespace llarp
       return false;
     }
 
+    bool
+    Endpoint::RepublishUnconfirmed(const EncryptedIntroSet& introset, AbstractRouter* r)
+    {
+      const auto unique =
+          GetManyPathsWithUniqueEndpoints(this, llarp::dht::IntroSetRelayRedundancy);
+      if (unique.empty())
+        return false;
+      // the same relay order lands on the same storage node whichever relay takes it
+      const std::vector<path::Path_ptr> paths(unique.begin(), unique.end());
+      bool sent = false;
+      for (uint64_t order = 0; order < llarp::dht::IntroSetStorageRedundancy; ++order)
+      {
+        if (m_state->m_PublishConfirmed.count(order))
+          continue;
+        const auto& path = paths[(order / llarp::dht::IntroSetRequestsPerRelay) % paths.size()];
+        if (PublishIntroSetVia(introset, r, path, order))
+          sent = true;
+      }
+      return sent;
+    }
+
     void
     Endpoint::ResetInternalState()
     {
@@ -609,17 +940,27 @@ namespace llarp
       if (not m_PublishIntroSet)
         return false;
 
-      auto next_pub = m_state->m_LastPublishAttempt
-          + (m_state->m_IntroSet.HasExpiredIntros(now) ? INTROSET_PUBLISH_RETRY_INTERVAL
-                                                       : INTROSET_PUBLISH_INTERVAL);
-
-      return now >= next_pub;
+      const auto lastAttempt = m_state->m_LastPublishAttempt;
+      if (now < lastAttempt + INTROSET_PUBLISH_RETRY_INTERVAL)
+        return false;
+      if (m_state->m_IntroSet.HasExpiredIntros(now))
+        return true;
+      // an intro we published that is about to expire is replaced now, not at the interval
+      const auto& intros = m_state->m_PublishedContent.I;
+      if (std::any_of(intros.begin(), intros.end(), [now](const auto& intro) {
+            return intro.ExpiresSoon(now, path::min_intro_lifetime);
+          }))
+        return true;
+      return now >= lastAttempt + INTROSET_PUBLISH_INTERVAL;
     }
 
     void
-    Endpoint::IntroSetPublished()
+    Endpoint::IntroSetPublished(llarp_time_t signedAt, uint64_t relayOrder)
     {
       const auto now = Now();
+      const auto& published = m_state->m_PublishedIntroSet;
+      if (published and published->signedAt == signedAt)
+        m_state->m_PublishConfirmed.insert(relayOrder);
       // We usually get 4 confirmations back (one for each DHT location), which
       // is noisy: suppress this log message if we already had a confirmation in
       // the last second.
@@ -668,6 +1009,24 @@ namespace llarp
       return path::Builder::SelectHop(db, exclude, cur, hop, roles);
     }
 
+    bool
+    Endpoint::AcceptPooledPath(const path::Path_ptr& p) const
+    {
+      const auto& blacklist = SnodeBlacklist();
+      for (const auto& hop : p->hops)
+      {
+        if (blacklist.count(hop.rc.pubkey))
+          return false;
+      }
+      if (numHops < 2)
+        return true;
+      bool diverse = true;
+      ForEachPath([&diverse, endpoint = p->Endpoint()](const path::Path_ptr& path) {
+        diverse = diverse and path->Endpoint() != endpoint;
+      });
+      return diverse;
+    }
+
     void
     Endpoint::PathBuildStarted(path::Path_ptr path)
     {
@@ -704,7 +1063,7 @@ namespace llarp
       // inform pending
       auto range = serviceLookups.equal_range(addr);
       auto itr = range.first;
-      if (itr != range.second)
+      while (itr != range.second)
       {
         itr->second(addr, it->second.get());
         ++itr;
@@ -817,19 +1176,49 @@ namespace llarp
     bool
     Endpoint::LookupNameAsync(std::string name, std::function<void(std::optional<Address>)> handler)
     {
-      auto& cache = m_state->nameCache;
-      const auto maybe = cache.Get(name);
+      NoteUse();
+      auto& cache = m_state->m_NameCache;
+      const auto now = Now();
+      const auto maybe = cache.Get(name, now);
       if (maybe.has_value())
       {
         handler(maybe);
-        return true;
+        // a stale name is served as is while one lookup refreshes it
+        if (not cache.ShouldRefresh(name, now))
+          return true;
       }
+      auto& pending = m_state->m_PendingNameLookups;
+      const bool inFlight = pending.count(name) > 0;
+      if (not maybe.has_value())
+        pending.emplace(name, std::move(handler));
+      if (inFlight)
+        return true;
       auto path = PickRandomEstablishedPath();
       if (path == nullptr)
-        return false;
+      {
+        pending.erase(name);
+        if (maybe.has_value())
+          cache.RefreshFailed(name, now);
+        return maybe.has_value();
+      }
       LogInfo(Name(), " looking up LNS name: ", name);
-      auto job = new LookupNameJob(this, GenTXID(), name, handler);
-      return job->SendRequestViaPath(path, m_router);
+      auto job = new LookupNameJob(
+          this, GenTXID(), name, [this, name](std::optional<Address> result) {
+            auto& state = *m_state;
+            if (result.has_value())
+              state.m_NameCache.Put(name, *result, Now());
+            else
+              state.m_NameCache.RefreshFailed(name, Now());
+            // taken out first, a handler may look the name up again
+            std::vector<std::function<void(std::optional<Address>)>> handlers;
+            const auto range = state.m_PendingNameLookups.equal_range(name);
+            for (auto itr = range.first; itr != range.second; ++itr)
+              handlers.emplace_back(std::move(itr->second));
+            state.m_PendingNameLookups.erase(name);
+            for (const auto& h : handlers)
+              h(result);
+          });
+      return job->SendRequestViaPath(path, m_router) or maybe.has_value();
     }
 
     bool
@@ -840,14 +1229,9 @@ namespace llarp
       if (itr == lookups.end())
         return false;
 
-      // decrypt entry
+      // decrypt entry, the job caches it
       const auto maybe = msg->result.Decrypt(itr->second->name);
 
-      if (maybe.has_value())
-      {
-        // put cache entry for result
-        m_state->nameCache.Put(itr->second->name, *maybe);
-      }
       // inform result
       itr->second->HandleNameResponse(maybe);
       lookups.erase(itr);
@@ -920,25 +1304,53 @@ namespace llarp
     void
     Endpoint::FlushRecvData()
     {
-      do
+      for (auto& queue : m_RecvQueues)
       {
-        auto maybe = m_RecvQueue.tryPopFront();
-        if (not maybe)
-          return;
-        auto ev = std::move(*maybe);
-        ProtocolMessage::ProcessAsync(ev.fromPath, ev.pathid, ev.msg);
-      } while (true);
+        do
+        {
+          auto maybe = queue->tryPopFront();
+          if (not maybe)
+            break;
+          auto ev = std::move(*maybe);
+          ProtocolMessage::ProcessAsync(ev.fromPath, ev.pathid, ev.msg);
+        } while (true);
+      }
     }
 
     void
     Endpoint::QueueRecvData(RecvDataEvent ev)
     {
-      if (m_RecvQueue.full() || m_RecvQueue.empty())
+      auto& queue = *m_RecvQueues[ConvoTag::Hash{}(ev.msg->tag) % m_RecvQueues.size()];
+      if (queue.full() || queue.empty())
       {
         auto self = this;
         LogicCall(m_router->logic(), [self]() { self->FlushRecvData(); });
       }
-      m_RecvQueue.pushBack(std::move(ev));
+      queue.pushBack(std::move(ev));
+    }
+
+    void
+    Endpoint::QueueDecrypt(AsyncDecrypt item)
+    {
+      // the rest of the burst queues up behind this before the flush runs
+      if (m_DecryptNext.empty())
+        LogicCall(m_router->logic(), [self = this]() { self->FlushDecrypt(); });
+      const ConvoTag tag = item.frame.T;
+      m_DecryptNext[tag].emplace_back(std::move(item));
+    }
+
+    void
+    Endpoint::FlushDecrypt()
+    {
+      for (auto& [tag, items] : m_DecryptNext)
+      {
+        auto frames = std::make_shared<std::vector<AsyncDecrypt>>(std::move(items));
+        Router()->QueueWorkFor(ConvoTag::Hash{}(tag), [self = this, frames]() {
+          for (auto& item : *frames)
+            item.Work(self);
+        });
+      }
+      m_DecryptNext.clear();
     }
 
     bool
@@ -948,14 +1360,126 @@ namespace llarp
       msg->sender.UpdateAddr();
       PutSenderFor(msg->tag, msg->sender, true);
       PutReplyIntroFor(msg->tag, path->intro);
+      auto itr = Sessions().find(msg->tag);
+      if (itr != Sessions().end() and not itr->second.intro.pathID.IsZero()
+          and itr->second.intro.pathID != from)
+        itr->second.lastIntroSwitch = Now();
+      if (itr != Sessions().end() and msg->version >= ProtocolMessage::MACFramesVersion)
+        itr->second.remoteTakesMAC = true;
+      if (itr != Sessions().end() and msg->version >= ProtocolMessage::RepairFramesVersion)
+        itr->second.remoteTakesRepair = true;
+      if (itr != Sessions().end() and msg->version >= ProtocolMessage::BundleVersion)
+        itr->second.remoteTakesBundles = true;
+      if (itr != Sessions().end() and msg->version >= ProtocolMessage::CompressionVersion
+          and not itr->second.remoteTakesCompression)
+      {
+        itr->second.remoteTakesCompression = true;
+        itr->second.compression = std::make_shared<CompressionGate>();
+      }
       Introduction intro;
       intro.pathID = from;
       intro.router = PubKey(path->Endpoint());
       intro.expiresAt = std::min(path->ExpireTime(), msg->introReply.expiresAt);
       PutIntroFor(msg->tag, intro);
+      msg->congested = path->Congested(Now());
       return ProcessDataMessage(msg);
     }
 
+    /// how long after the remote last switched intros we keep putting a convo back in order
+    static constexpr auto ReorderWindow = 10s;
+
+    static void
+    HandleInboundMessage(Endpoint* ep, const ProtocolMessagePtr& msg)
+    {
+      // marked only now as repair frames were made over the payloads as they were sent
+      if (msg->proto == eProtocolBundle)
+      {
+        // the packets share the bundle's seqno and go on in the order they were packed
+        Bundle::ForEach(msg->payload, [&](ProtocolType proto, byte_t* data, size_t sz) {
+          if (msg->congested)
+            net::MarkCE(data, sz);
+          ep->HandleInboundPacket(msg->tag, llarp_buffer_t(data, sz), proto, msg->seqno);
+        });
+        return;
+      }
+      const bool ip = msg->proto == eProtocolTrafficV4 or msg->proto == eProtocolTrafficV6
+          or msg->proto == eProtocolExit;
+      if (msg->congested and ip)
+        net::MarkCE(msg->payload.data(), msg->payload.size());
+      const llarp_buffer_t buf(msg->payload);
+      ep->HandleInboundPacket(msg->tag, buf, msg->proto, msg->seqno);
+    }
+
+    /// how long after the last repair from a remote we keep its messages to rebuild from
+    static constexpr auto RepairWindow = 30s;
+
+    void
+    Endpoint::DeliverInbound(ProtocolMessagePtr msg, llarp_time_t now)
+    {
+      auto repair = m_InboundRepair.find(msg->tag);
+      if (msg->proto == eProtocolRepair)
+      {
+        if (repair == m_InboundRepair.end())
+          repair = m_InboundRepair.emplace(msg->tag, std::make_pair(RepairDecoder{}, now)).first;
+        repair->second.second = now;
+        auto rebuilt = repair->second.first.Repair(msg->payload);
+        if (not rebuilt)
+          return;
+        auto copy = std::make_shared<ProtocolMessage>(*msg);
+        copy->seqno = rebuilt->seqno;
+        copy->proto = rebuilt->proto;
+        copy->payload.assign(rebuilt->payload.begin(), rebuilt->payload.end());
+        if (not IsInboundTraffic(*copy))
+          return;
+        msg = std::move(copy);
+      }
+      else if (
+          repair != m_InboundRepair.end()
+          and not repair->second.first.Keep(msg->seqno, msg->proto, msg->payload))
+        return;
+
+      auto deliver = [this](const ProtocolMessagePtr& m) { HandleInboundMessage(this, m); };
+      auto itr = m_InboundReorder.find(msg->tag);
+      if (itr == m_InboundReorder.end())
+      {
+        const auto session = Sessions().find(msg->tag);
+        if (session == Sessions().end() or session->second.lastIntroSwitch == 0s
+            or session->second.lastIntroSwitch + ReorderWindow <= now)
+        {
+          deliver(msg);
+          return;
+        }
+        itr = m_InboundReorder.emplace(msg->tag, ReorderBuffer<ProtocolMessagePtr>{}).first;
+      }
+      itr->second.Push(std::move(msg), now, deliver);
+    }
+
+    void
+    Endpoint::ExpireHeldInbound(llarp_time_t now)
+    {
+      auto deliver = [this](const ProtocolMessagePtr& m) { HandleInboundMessage(this, m); };
+      auto itr = m_InboundReorder.begin();
+      while (itr != m_InboundReorder.end())
+      {
+        itr->second.Expire(now, deliver);
+        // quiet for a while, so whatever comes next starts a fresh run of seqnos
+        if (itr->second.Empty() and itr->second.LastPush() + ReorderWindow <= now)
+          itr = m_InboundReorder.erase(itr);
+        else
+          ++itr;
+      }
+      for (auto repair = m_InboundRepair.begin(); repair != m_InboundRepair.end();)
+      {
+        if (repair->second.second + RepairWindow <= now)
+        {
+          m_Repaired += repair->second.first.Repaired();
+          repair = m_InboundRepair.erase(repair);
+        }
+        else
+          ++repair;
+      }
+    }
+
     bool
     Endpoint::HasPathToSNode(const RouterID ident) const
     {
@@ -972,12 +1496,48 @@ namespace llarp
       return false;
     }
 
+    bool
+    Endpoint::TrafficBackedUp() const
+    {
+      size_t ready = NumInStatus(path::ePathEstablished);
+      size_t backedUp = NumBackedUp();
+      const auto count = [&ready, &backedUp](const path::PathSet& paths) {
+        ready += paths.NumInStatus(path::ePathEstablished);
+        backedUp += paths.NumBackedUp();
+      };
+      // TODO: locking on this container
+      for (const auto& item : m_state->m_RemoteSessions)
+        count(*item.second);
+      // TODO: locking on this container
+      for (const auto& item : m_state->m_SNodeSessions)
+        count(*item.second.first);
+      return ready > 0 and backedUp == ready;
+    }
+
+    bool
+    Endpoint::IsInboundTraffic(const ProtocolMessage& msg) const
+    {
+      const auto allowed = [&](ProtocolType proto) {
+        return (proto == eProtocolExit
+                && (m_state->m_ExitEnabled || m_ExitMap.ContainsValue(msg.sender.Addr())))
+            || proto == eProtocolTrafficV4 || proto == eProtocolTrafficV6;
+      };
+      if (msg.proto == eProtocolBundle)
+      {
+        // the whole bundle or none of it
+        bool all = true;
+        const bool whole = Bundle::ForEach(
+            msg.payload, [&](ProtocolType proto, const byte_t*, size_t) { all &= allowed(proto); });
+        return whole and all;
+      }
+      return allowed(msg.proto) || msg.proto == eProtocolEmbedded;
+    }
+
     bool
     Endpoint::ProcessDataMessage(std::shared_ptr<ProtocolMessage> msg)
     {
-      if ((msg->proto == eProtocolExit
-           && (m_state->m_ExitEnabled || m_ExitMap.ContainsValue(msg->sender.Addr())))
-          || msg->proto == eProtocolTrafficV4 || msg->proto == eProtocolTrafficV6)
+      // repairs go in line with the traffic they cover
+      if (IsInboundTraffic(*msg) or msg->proto == eProtocolRepair)
       {
         m_InboundTrafficQueue.tryPushBack(std::move(msg));
         return true;
@@ -1032,6 +1592,7 @@ namespace llarp
     bool
     Endpoint::HandleHiddenServiceFrame(path::Path_ptr p, const ProtocolFrame& frame)
     {
+      alloc::Scope allocScope{alloc::ServiceFrames};
       if (frame.R)
       {
         // handle discard
@@ -1078,27 +1639,49 @@ namespace llarp
 
     bool
     Endpoint::OnLookup(
-        const Address& addr, std::optional<IntroSet> introset, const RouterID& endpoint)
+        const Address& addr,
+        std::optional<IntroSet> introset,
+        const RouterID& endpoint,
+        uint64_t txid)
     {
       const auto now = Router()->Now();
       auto& fails = m_state->m_ServiceLookupFails;
       auto& lookups = m_state->m_PendingServiceLookups;
+      auto& txs = m_state->m_IntroSetLookupTXs;
+      // drop our own tx, a sibling that already answered took it with the rest
+      auto range = txs.equal_range(addr);
+      auto itr = std::find_if(
+          range.first, range.second, [txid](const auto& item) { return item.second == txid; });
+      if (itr == range.second)
+        return false;
+      txs.erase(itr);
       if (not introset or introset->IsExpired(now))
       {
         LogError(Name(), " failed to lookup ", addr.ToString(), " from ", endpoint);
         fails[endpoint] = fails[endpoint] + 1;
-        // inform one
-        auto range = lookups.equal_range(addr);
-        auto itr = range.first;
-        if (itr != range.second)
+        // only fail the hooks once no other lookup for addr can still answer
+        if (txs.count(addr) == 0)
         {
-          itr->second(addr, nullptr);
-          itr = lookups.erase(itr);
+          m_state->m_IntroSetCache.PutMissing(addr.ToKey(), now);
+          // take the hooks out first, one may ask for addr again
+          std::vector<PathEnsureHook> hooks;
+          auto waiting = lookups.equal_range(addr);
+          for (auto hook = waiting.first; hook != waiting.second; ++hook)
+            hooks.emplace_back(std::move(hook->second));
+          lookups.erase(addr);
+          for (const auto& hook : hooks)
+            hook(addr, nullptr);
         }
         return false;
       }
-      // check for established outbound context
+      // first answer wins, cancel the rest so their replies and timeouts are dropped
+      range = txs.equal_range(addr);
+      for (auto sibling = range.first; sibling != range.second; ++sibling)
+        m_state->m_PendingLookups.erase(sibling->second);
+      txs.erase(addr);
+      m_state->m_IntroSetCache.Put(addr.ToKey(), *introset, now);
 
+      // check for established outbound context
       if (m_state->m_RemoteSessions.count(addr) > 0)
         return true;
 
@@ -1122,11 +1705,7 @@ namespace llarp
     Endpoint::EnsurePathToService(
         const Address remote, PathEnsureHook hook, llarp_time_t /*timeoutMS*/)
     {
-      /// how many routers to use for lookups
-      static constexpr size_t NumParallelLookups = 2;
-      /// how many requests per router
-      static constexpr size_t RequestsPerLookup = 2;
-
+      NoteUse();
       MarkAddressOutbound(remote);
 
       auto& sessions = m_state->m_RemoteSessions;
@@ -1140,61 +1719,85 @@ namespace llarp
         }
       }
 
+      const auto now = Now();
+      const dht::Key_t location = remote.ToKey();
+      auto& cache = m_state->m_IntroSetCache;
+      // a remote that was just looked up, or just found missing, needs no lookup
+      if (cache.IsMissing(location, now))
+      {
+        hook(remote, nullptr);
+        return true;
+      }
+
       // add response hook to list for address.
       m_state->m_PendingServiceLookups.emplace(remote, hook);
 
+      if (const auto introset = cache.Get(location, now))
+      {
+        LogDebug(Name(), " using cached introset for ", remote);
+        PutNewOutboundContext(*introset);
+        return true;
+      }
+
       auto& lookupTimes = m_state->m_LastServiceLookupTimes;
-      const auto now = Now();
 
       // if most recent lookup was within last INTROSET_LOOKUP_RETRY_COOLDOWN
       // just add callback to the list and return
       if (lookupTimes.find(remote) != lookupTimes.end()
           && now < (lookupTimes[remote] + INTROSET_LOOKUP_RETRY_COOLDOWN))
+      {
+        m_state->m_ServiceLookupsCoalesced++;
         return true;
+      }
+      m_state->m_ServiceLookupsStarted++;
 
-      const auto paths = GetManyPathsWithUniqueEndpoints(this, NumParallelLookups);
-
-      using namespace std::placeholders;
-      const dht::Key_t location = remote.ToKey();
-      uint64_t order = 0;
+      // ask fanout storage nodes at once, over as many paths to different routers as we
+      // have, the first good answer wins and cancels the rest
+      const size_t fanout = m_state->m_LookupFanout;
+      const auto paths = GetManyPathsWithUniqueEndpoints(this, fanout);
 
       // flag to only add callback to list of callbacks for
       // address once.
       bool hookAdded = false;
 
-      for (const auto& path : paths)
-      {
-        for (size_t count = 0; count < RequestsPerLookup; ++count)
+      auto pathItr = paths.begin();
+      for (uint64_t order = 0; order < fanout and not paths.empty(); ++order)
+      {
+        const auto path = *pathItr;
+        if (++pathItr == paths.end())
+          pathItr = paths.begin();
+        const uint64_t txid = GenTXID();
+        HiddenServiceAddressLookup* job = new HiddenServiceAddressLookup(
+            this,
+            [this, txid](const Address& addr, auto introset, const RouterID& endpoint) {
+              return OnLookup(addr, std::move(introset), endpoint, txid);
+            },
+            location,
+            PubKey{remote.as_array()},
+            order,
+            txid);
+        // tracked even if the send fails, it times out into a failure like the others
+        m_state->m_IntroSetLookupTXs.emplace(remote, txid);
+        LogInfo(
+            "doing lookup for ",
+            remote,
+            " via ",
+            path->Endpoint(),
+            " at ",
+            location,
+            " order=",
+            order);
+        if (job->SendRequestViaPath(path, Router()))
         {
-          HiddenServiceAddressLookup* job = new HiddenServiceAddressLookup(
-              this,
-              util::memFn(&Endpoint::OnLookup, this),
-              location,
-              PubKey{remote.as_array()},
-              order,
-              GenTXID());
-          LogInfo(
-              "doing lookup for ",
-              remote,
-              " via ",
-              path->Endpoint(),
-              " at ",
-              location,
-              " order=",
-              order);
-          order++;
-          if (job->SendRequestViaPath(path, Router()))
+          if (not hookAdded)
           {
-            if (not hookAdded)
-            {
-              // if any of the lookups is successful, set last lookup time
-              lookupTimes[remote] = now;
-              hookAdded = true;
-            }
+            // if any of the lookups is successful, set last lookup time
+            lookupTimes[remote] = now;
+            hookAdded = true;
           }
-          else
-            LogError(Name(), " send via path failed for lookup");
         }
+        else
+          LogError(Name(), " send via path failed for lookup");
       }
       return hookAdded;
     }
@@ -1202,6 +1805,7 @@ namespace llarp
     bool
     Endpoint::EnsurePathToSNode(const RouterID snode, SNodeEnsureHook h)
     {
+      NoteUse();
       static constexpr size_t MaxConcurrentSNodeSessions = 16;
       auto& nodeSessions = m_state->m_SNodeSessions;
       if (nodeSessions.size() >= MaxConcurrentSNodeSessions)
@@ -1220,8 +1824,10 @@ namespace llarp
         const auto src = xhtonl(net::TruncateV6(GetIfAddr()));
         const auto dst = xhtonl(net::TruncateV6(ObtainIPForAddr(snode, true)));
 
-        auto session = std::make_shared<exit::SNodeSession>(
+        // shared with our other endpoints going to snode, made as we would if we are first
+        auto session = Router()->snodeSessions().Obtain(
             snode,
+            this,
             [=](const llarp_buffer_t& buf) -> bool {
               net::IPPacket pkt;
               if (not pkt.Load(buf))
@@ -1230,11 +1836,10 @@ namespace llarp
               /// TODO: V6
               return HandleInboundPacket(tag, pkt.ConstBuffer(), eProtocolTrafficV4, 0);
             },
-            Router(),
             numPaths,
             numHops,
-            false,
-            ShouldBundleRC());
+            ShouldBundleRC(),
+            m_state->m_ExitBatchDelay);
 
         m_state->m_SNodeSessions.emplace(snode, std::make_pair(session, tag));
       }
@@ -1255,16 +1860,80 @@ namespace llarp
       return true;
     }
 
+    std::shared_ptr<OutboundContext>
+    Endpoint::GetReadyOutboundContext(const Address& remote) const
+    {
+      const auto range = m_state->m_RemoteSessions.equal_range(remote);
+      for (auto itr = range.first; itr != range.second; ++itr)
+      {
+        if (itr->second->ReadyToSend())
+          return HasInboundConvo(remote) ? nullptr : itr->second;
+      }
+      return nullptr;
+    }
+
+    void
+    Endpoint::PrefetchService(const Address& remote)
+    {
+      if (not m_state->m_DNSPrefetch or remote == m_Identity.pub.Addr())
+        return;
+      if (m_state->m_RemoteSessions.count(remote) or m_state->m_Prefetches.count(remote))
+        return;
+      m_state->m_Prefetches.emplace(remote, Now());
+      m_state->m_PrefetchStarted++;
+      // the outbound context builds its paths to the remote as soon as it is made
+      EnsurePathToService(remote, [](Address, OutboundContext*) {}, PrefetchWindow);
+    }
+
+    void
+    Endpoint::PrefetchSNode(const RouterID& snode)
+    {
+      const Address remote{snode.as_array()};
+      if (not m_state->m_DNSPrefetch or m_state->m_SNodeSessions.count(snode)
+          or m_state->m_Prefetches.count(remote))
+        return;
+      m_state->m_Prefetches.emplace(remote, Now());
+      m_state->m_PrefetchStarted++;
+      EnsurePathToSNode(snode, [](RouterID, exit::BaseSession_ptr) {});
+    }
+
+    void
+    Endpoint::NotePrefetchUse(const Address& remote, bool ready)
+    {
+      auto& prefetches = m_state->m_Prefetches;
+      if (prefetches.empty())
+        return;
+      auto itr = prefetches.find(remote);
+      if (itr == prefetches.end())
+        return;
+      prefetches.erase(itr);
+      if (ready)
+        m_state->m_PrefetchReady++;
+      else
+        m_state->m_PrefetchLate++;
+    }
+
     bool
     Endpoint::SendToSNodeOrQueue(const RouterID& addr, const llarp_buffer_t& buf)
     {
       auto pkt = std::make_shared<net::IPPacket>();
       if (!pkt->Load(buf))
         return false;
-      EnsurePathToSNode(addr, [pkt](RouterID, exit::BaseSession_ptr s) {
-        if (s)
-          s->QueueUpstreamTraffic(*pkt, routing::ExitPadSize);
-      });
+      if (not m_state->m_Prefetches.empty())
+      {
+        const auto range = m_state->m_SNodeSessions.equal_range(addr);
+        const bool ready = std::any_of(range.first, range.second, [](const auto& item) {
+          return item.second.first->IsReady();
+        });
+        NotePrefetchUse(Address{addr.as_array()}, ready);
+      }
+      // the session may be shared, so it goes through the registry to learn whose flow it is
+      auto& registry = Router()->snodeSessions();
+      EnsurePathToSNode(
+          addr, [pkt, &registry, owner = this](RouterID snode, exit::BaseSession_ptr s) {
+            if (s)
+              registry.QueueUpstream(snode, owner, *pkt);
+          });
       return true;
     }
 
@@ -1279,12 +1948,10 @@ namespace llarp
         for (const auto& item : sessions)
           item.second.first->FlushDownstream();
         // send downstream traffic to user for hidden service
+        const auto now = Now();
         while (not queue.empty())
-        {
-          auto msg = queue.popFront();
-          const llarp_buffer_t buf(msg->payload);
-          HandleInboundPacket(msg->tag, buf, msg->proto, msg->seqno);
-        }
+          DeliverInbound(queue.popFront(), now);
+        ExpireHeldInbound(now);
       };
 
       if (NetworkIsIsolated())
@@ -1331,6 +1998,7 @@ namespace llarp
     Endpoint::SendToServiceOrQueue(
         const service::Address& remote, const llarp_buffer_t& data, ProtocolType t)
     {
+      alloc::Scope allocScope{alloc::ServiceFrames};
       if (data.sz == 0)
         return false;
       // inbound converstation
@@ -1381,7 +2049,8 @@ namespace llarp
           if (p)
           {
             // TODO: check expiration of our end
-            auto m = std::make_shared<ProtocolMessage>(f.T);
+            auto m = ProtocolMessage::MakePooled();
+            m->tag = f.T;
             m->PutBuffer(data);
             f.N.Randomize();
             f.C.Zero();
@@ -1395,8 +2064,20 @@ namespace llarp
             f.F = m->introReply.pathID;
             transfer->P = remoteIntro.pathID;
             auto self = this;
-            Router()->QueueWork([transfer, p, m, K, self]() {
-              if (not transfer->T.EncryptAndSign(*m, K, self->m_Identity))
+            const bool mac = TakesMACFrames(f.T);
+            std::shared_ptr<CompressionGate> compression;
+            if (CompressesPayloads())
+            {
+              const auto session = Sessions().find(f.T);
+              if (session != Sessions().end())
+                compression = session->second.compression;
+            }
+            Router()->QueueWork([transfer, p, m, K, self, mac, compression]() {
+              if (compression)
+                compression->Apply(m->proto, m->payload);
+              const bool sealed = mac ? transfer->T.EncryptAndMAC(*m, K)
+                                      : transfer->T.EncryptAndSign(*m, K, self->m_Identity);
+              if (not sealed)
               {
                 LogError("failed to encrypt and sign");
                 return;
@@ -1417,29 +2098,41 @@ namespace llarp
         {
           if (itr->second->ReadyToSend())
           {
+            NotePrefetchUse(remote, true);
             itr->second->AsyncEncryptAndSendTo(data, t);
             return true;
           }
           ++itr;
         }
+        NotePrefetchUse(remote, false);
         // if we want to make an outbound session
         if (WantsOutboundSession(remote))
         {
-          // add pending traffic
-          auto& traffic = m_state->m_PendingTraffic;
-          traffic[remote].emplace_back(data, t);
+          // add pending traffic, the first packet waiting asks for the session for the rest
+          auto& queue = m_state->m_PendingTraffic[remote];
+          const bool first = queue.empty();
+          if (not queue.Push(data, t, Now(), m_state->m_PendingPool))
+            m_state->m_PendingDropped++;
+          if (not first)
+            return true;
           return EnsurePathToService(
               remote,
               [self = this](Address addr, OutboundContext* ctx) {
+                auto& state = *self->m_state;
+                auto itr = state.m_PendingTraffic.find(addr);
+                if (itr == state.m_PendingTraffic.end())
+                  return;
                 if (ctx)
                 {
                   ctx->UpdateIntroSet();
-                  for (auto& pending : self->m_state->m_PendingTraffic[addr])
-                  {
-                    ctx->AsyncEncryptAndSendTo(pending.Buffer(), pending.protocol);
-                  }
+                  state.m_PendingDropped += itr->second.Drain(
+                      self->Now(), state.m_PendingPool, state.m_PendingWait, [ctx](auto& pending) {
+                        ctx->AsyncEncryptAndSendTo(pending.Buffer(), pending.protocol);
+                      });
                 }
-                self->m_state->m_PendingTraffic.erase(addr);
+                else
+                  state.m_PendingDropped += itr->second.Clear(state.m_PendingPool);
+                state.m_PendingTraffic.erase(itr);
               },
               1500ms);
         }
@@ -1453,6 +2146,34 @@ namespace llarp
       return Sessions().find(t) != Sessions().end();
     }
 
+    bool
+    Endpoint::TakesMACFrames(const ConvoTag& t) const
+    {
+      const auto itr = Sessions().find(t);
+      return itr != Sessions().end() and itr->second.remoteTakesMAC;
+    }
+
+    bool
+    Endpoint::TakesRepairFrames(const ConvoTag& t) const
+    {
+      const auto itr = Sessions().find(t);
+      return itr != Sessions().end() and itr->second.remoteTakesRepair;
+    }
+
+    bool
+    Endpoint::TakesBundles(const ConvoTag& t) const
+    {
+      const auto itr = Sessions().find(t);
+      return itr != Sessions().end() and itr->second.remoteTakesBundles;
+    }
+
+    bool
+    Endpoint::TakesCompression(const ConvoTag& t) const
+    {
+      const auto itr = Sessions().find(t);
+      return itr != Sessions().end() and itr->second.remoteTakesCompression;
+    }
+
     uint64_t
     Endpoint::GetSeqNoForConvo(const ConvoTag& tag)
     {
@@ -1466,6 +2187,8 @@ namespace llarp
     bool
     Endpoint::ShouldBuildMore(llarp_time_t now) const
     {
+      if (m_state->m_WaitingForUse)
+        return false;
       if (path::Builder::BuildCooldownHit(now))
         return false;
 
@@ -1473,6 +2196,9 @@ namespace llarp
       if (numBuilding > 0)
         return false;
 
+      if (m_router->IsIdle())
+        return NumInStatus(path::ePathEstablished) < path::idle_min_paths;
+
       return ((now - lastBuild) > path::intro_path_spread)
           || NumInStatus(path::ePathEstablished) < path::min_intro_paths;
     }
@@ -1507,6 +2233,24 @@ namespace llarp
       return m_state->m_SnodeBlacklist;
     }
 
+    size_t
+    Endpoint::MultipathWidth() const
+    {
+      return m_state->m_MultipathWidth;
+    }
+
+    bool
+    Endpoint::UsesRepairFrames() const
+    {
+      return m_state->m_RepairFrames;
+    }
+
+    bool
+    Endpoint::CompressesPayloads() const
+    {
+      return m_state->m_Compress;
+    }
+
     const IntroSet&
     Endpoint::introSet() const
     {
@@ -1542,6 +2286,7 @@ namespace llarp
     {
       LogInfo(Name(), " map ", range, " to exit at ", exit);
       m_ExitMap.Insert(range, exit);
+      m_ExitMapVersion++;
     }
 
     void
@@ -1554,6 +2299,7 @@ namespace llarp
         LogInfo(Name(), " unmap ", item.first, " from exit at ", item.second);
         return true;
       });
+      m_ExitMapVersion++;
     }
 
     std::optional<AuthInfo>
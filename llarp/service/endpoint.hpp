@@ -10,9 +10,12 @@
 #include <path/pathbuilder.hpp>
 #include <service/address.hpp>
 #include <service/handler.hpp>
+#include <service/handshake_cache.hpp>
 #include <service/identity.hpp>
 #include <service/pendingbuffer.hpp>
 #include <service/protocol.hpp>
+#include <service/reorder_buffer.hpp>
+#include <service/repair.hpp>
 #include <service/sendcontext.hpp>
 #include <service/session.hpp>
 #include <service/lookup.hpp>
@@ -68,6 +71,11 @@ namespace llarp
 
     static constexpr auto INTROSET_PUBLISH_RETRY_INTERVAL = 5s;
 
+    /// an introset whose intros did not change is signed again once it is this old, well before
+    /// storage nodes drop it
+    static constexpr auto INTROSET_RESIGN_AGE =
+        std::chrono::milliseconds(path::default_lifetime) / 2;
+
     static constexpr auto INTROSET_LOOKUP_RETRY_COOLDOWN = 3s;
 
     struct Endpoint : public path::Builder, public ILookupHolder, public IDataHandler
@@ -84,6 +92,12 @@ namespace llarp
       void
       QueueRecvData(RecvDataEvent ev) override;
 
+      /// queue a frame on an established convo to be checked and opened, in router logic.
+      /// each convo's share of a burst goes to the worker keyed by its tag in one job, so convos
+      /// spread over the workers and each keeps its order
+      void
+      QueueDecrypt(AsyncDecrypt item);
+
       /// return true if our introset has expired intros
       bool
       IntrosetIsStale() const;
@@ -101,6 +115,11 @@ namespace llarp
       virtual bool
       Configure(const NetworkConfig& conf, const DnsConfig& dnsConf);
 
+      /// apply what changed from prev to conf that can change while we run, the paths we have
+      /// are kept. exit mappings made over rpc are in neither and stay as they are
+      virtual void
+      Reconfigure(const Config& prev, const Config& conf);
+
       void
       Tick(llarp_time_t now) override;
 
@@ -172,6 +191,10 @@ namespace llarp
       PublishIntroSetVia(
           const EncryptedIntroSet& i, AbstractRouter* r, path::Path_ptr p, uint64_t relayOrder);
 
+      /// publish i again only at the relay orders that did not confirm storing it
+      bool
+      RepublishUnconfirmed(const EncryptedIntroSet& i, AbstractRouter* r);
+
       bool
       HandleGotIntroMessage(std::shared_ptr<const dht::GotIntroMessage> msg) override;
 
@@ -243,12 +266,26 @@ namespace llarp
         return m_Identity;
       }
 
+      /// handshake secrets kept between convos with the same remote
+      HandshakeCache&
+      Handshakes()
+      {
+        return m_Handshakes;
+      }
+
       void
       MapExitRange(IPRange range, service::Address exit);
 
       void
       UnmapExitRange(IPRange range);
 
+      /// goes up whenever the exit map changes
+      uint64_t
+      ExitMapVersion() const
+      {
+        return m_ExitMapVersion;
+      }
+
       void
       PutLookup(IServiceLookup* lookup, uint64_t txid) override;
 
@@ -267,8 +304,6 @@ namespace llarp
       bool
       CheckPathIsDead(path::Path_ptr p, llarp_time_t latency);
 
-      using PendingBufferQueue = std::deque<PendingBuffer>;
-
       bool
       WantsOutboundSession(const Address&) const override;
 
@@ -295,6 +330,18 @@ namespace llarp
       bool
       HasConvoTag(const ConvoTag& t) const override;
 
+      bool
+      TakesMACFrames(const ConvoTag& t) const override;
+
+      bool
+      TakesRepairFrames(const ConvoTag& t) const override;
+
+      bool
+      TakesBundles(const ConvoTag& t) const override;
+
+      bool
+      TakesCompression(const ConvoTag& t) const override;
+
       bool
       ShouldBuildMore(llarp_time_t now) const override;
 
@@ -313,6 +360,14 @@ namespace llarp
       bool
       EnsurePathToSNode(const RouterID remote, SNodeEnsureHook h);
 
+      /// look up a remote whose name was just resolved and build paths to it in the background,
+      /// so the traffic that follows finds a session ready. only with [network]:dns-prefetch
+      void
+      PrefetchService(const Address& remote);
+
+      void
+      PrefetchSNode(const RouterID& snode);
+
       /// return true if this endpoint is trying to lookup this router right now
       bool
       HasPendingRouterLookup(const RouterID remote) const;
@@ -320,6 +375,11 @@ namespace llarp
       bool
       HasPathToSNode(const RouterID remote) const;
 
+      /// true when every established path we could send traffic on is backed up, user packets then
+      /// wait in their codel queues, which drop what waits too long, instead of going out
+      bool
+      TrafficBackedUp() const;
+
       void
       PutSenderFor(const ConvoTag& tag, const ServiceInfo& info, bool inbound) override;
 
@@ -372,13 +432,24 @@ namespace llarp
           size_t hop,
           path::PathRole roles) override;
 
+      bool
+      UsesPathPool() const override
+      {
+        return true;
+      }
+
+      /// apply our snode blacklist and endpoint diversity to pooled paths too
+      bool
+      AcceptPooledPath(const path::Path_ptr& p) const override;
+
       virtual void
       PathBuildStarted(path::Path_ptr path) override;
 
       virtual void
       IntroSetPublishFail();
+      /// a storage node confirmed the introset signed at signedAt, published at relayOrder
       virtual void
-      IntroSetPublished();
+      IntroSetPublished(llarp_time_t signedAt, uint64_t relayOrder);
 
       void
       AsyncProcessAuthMessage(
@@ -393,12 +464,29 @@ namespace llarp
       const std::set<RouterID>&
       SnodeBlacklist() const;
 
+      /// how many remote intros outbound contexts spread their traffic over
+      size_t
+      MultipathWidth() const;
+
+      /// whether outbound contexts send repair messages down paths that lose traffic
+      bool
+      UsesRepairFrames() const;
+
+      /// whether outbound contexts compress payloads for remotes that take them
+      bool
+      CompressesPayloads() const;
+
       bool
       SendToServiceOrQueue(
           const service::Address& addr, const llarp_buffer_t& payload, ProtocolType t);
       bool
       SendToSNodeOrQueue(const RouterID& addr, const llarp_buffer_t& payload);
 
+      /// the outbound context SendToServiceOrQueue would send to remote through right now, if
+      /// it would use one, for callers that send to the same remote often to hold on to
+      std::shared_ptr<OutboundContext>
+      GetReadyOutboundContext(const Address& remote) const;
+
       std::optional<AuthInfo>
       MaybeGetAuthInfoForEndpoint(service::Address addr);
 
@@ -412,6 +500,24 @@ namespace llarp
       void
       RegenAndPublishIntroSet(bool forceRebuild = false);
 
+      /// put the intros of other instances sharing our identity after our own in our introset
+      void
+      AddPeerIntros(llarp_time_t now);
+
+      /// look up our own introset for the intros other instances sharing our identity publish
+      void
+      LookupPeerIntros(llarp_time_t now);
+
+      bool
+      OnPeerIntroSet(std::optional<IntroSet> introset);
+
+      /// how long traffic has after a prefetch before we call it wasted
+      static constexpr auto PrefetchWindow = 30s;
+
+      /// traffic went to remote, count the prefetch for it if there was one
+      void
+      NotePrefetchUse(const Address& remote, bool ready);
+
       IServiceLookup*
       GenerateLookupByTag(const Tag& tag);
 
@@ -435,15 +541,37 @@ namespace llarp
       IsolatedNetworkMainLoop();
 
      private:
+      /// something needs us, ends lazy-start holding off path building
+      void
+      NoteUse();
+
       void
       HandleVerifyGotRouter(dht::GotRouterMessage_constptr msg, llarp_async_verify_rc* j);
 
+      /// handle the answer to introset lookup txid for addr
       bool
-      OnLookup(const service::Address& addr, std::optional<IntroSet> i, const RouterID& endpoint);
+      OnLookup(
+          const service::Address& addr,
+          std::optional<IntroSet> i,
+          const RouterID& endpoint,
+          uint64_t txid);
 
       bool
       DoNetworkIsolation(bool failed);
 
+      /// where our WarmState goes, beside the keyfile, nullopt when warm restart is off or we
+      /// have no keyfile
+      std::optional<fs::path>
+      WarmStatePath() const;
+
+      /// save the introsets of our remote sessions and the first hops of our paths
+      void
+      SaveWarmState() const;
+
+      /// start from the last saved WarmState: cache its introsets and connect to its hops
+      void
+      LoadWarmState();
+
       virtual bool
       SetupNetworking()
       {
@@ -462,6 +590,7 @@ namespace llarp
       IDataHandler* m_DataHandler = nullptr;
       Identity m_Identity;
       net::IPRangeMap<service::Address> m_ExitMap;
+      uint64_t m_ExitMapVersion = 0;
       hooks::Backend_ptr m_OnUp;
       hooks::Backend_ptr m_OnDown;
       hooks::Backend_ptr m_OnReady;
@@ -480,6 +609,35 @@ namespace llarp
       void
       FlushRecvData();
 
+      /// hand the frames queued by QueueDecrypt to a worker
+      void
+      FlushDecrypt();
+
+      std::unordered_map<ConvoTag, std::vector<AsyncDecrypt>, ConvoTag::Hash> m_DecryptNext;
+
+      /// hand inbound traffic on to HandleInboundPacket, back in seqno order for convos whose
+      /// sender is spreading it over several of our intros
+      void
+      DeliverInbound(ProtocolMessagePtr msg, llarp_time_t now);
+
+      /// let go of held inbound traffic that has waited too long for what comes before it
+      void
+      ExpireHeldInbound(llarp_time_t now);
+
+      /// convos we are putting back in order, only those seen arriving on more than one intro
+      std::unordered_map<ConvoTag, ReorderBuffer<ProtocolMessagePtr>, ConvoTag::Hash>
+          m_InboundReorder;
+
+      /// convos whose sender sends repairs, with when it last sent one
+      std::unordered_map<ConvoTag, std::pair<RepairDecoder, llarp_time_t>, ConvoTag::Hash>
+          m_InboundRepair;
+      /// messages rebuilt on convos we no longer keep a decoder for
+      uint64_t m_Repaired = 0;
+
+      /// traffic we hand on to HandleInboundPacket, exit traffic only from those allowed it
+      bool
+      IsInboundTraffic(const ProtocolMessage& msg) const;
+
       friend struct EndpointUtil;
 
       // clang-format off
@@ -490,7 +648,9 @@ namespace llarp
       const ConvoMap& Sessions() const;
       ConvoMap&       Sessions();
       // clang-format on
-      thread::Queue<RecvDataEvent> m_RecvQueue;
+      /// opened frames by convo tag, so the workers rarely push onto the same queue
+      std::vector<std::unique_ptr<thread::Queue<RecvDataEvent>>> m_RecvQueues;
+      HandshakeCache m_Handshakes;
     };
 
     using Endpoint_ptr = std::shared_ptr<Endpoint>;
@@ -3,9 +3,12 @@
 #include <exit/session.hpp>
 #include <hook/shell.hpp>
 #include <service/endpoint.hpp>
+#include <service/exit_selector.hpp>
 #include <service/outbound_context.hpp>
 #include <util/str.hpp>
 
+#include <algorithm>
+
 namespace llarp
 {
   namespace service
@@ -17,11 +20,29 @@ namespace llarp
         m_Keyfile = conf.m_keyfile->string();
       m_SnodeBlacklist = conf.m_snodeBlacklist;
       m_ExitEnabled = conf.m_AllowExit;
+      m_MultipathWidth = conf.m_Multipath;
+      m_RepairFrames = conf.m_RepairFrames;
+      m_Compress = conf.m_Compress;
+      m_LookupFanout = conf.m_LookupFanout;
+      m_WarmRestart = conf.m_WarmRestart;
+      m_AggregateIntroSets = conf.m_AggregateIntroSets;
+      m_DNSPrefetch = conf.m_DNSPrefetch;
+      m_LazyStart = conf.m_LazyStart;
+      m_ExitBatchDelay = conf.m_ExitBatchDelay;
+      if (m_WarmRestart and m_Keyfile.empty())
+        LogWarn("[network]:warm-restart needs a keyfile to seal the state with, not saving it");
 
       for (const auto& record : conf.m_SRVRecords)
       {
         m_IntroSet.SRVs.push_back(record.toTuple());
       }
+      // a record every client already takes, where a new introset field would fail their
+      // signature checks
+      if (m_ExitEnabled and conf.m_ExitCapacity > 0)
+      {
+        const uint16_t capacity = std::min(conf.m_ExitCapacity, 0xffff);
+        m_IntroSet.SRVs.emplace_back(std::string{ExitSelector::CapacitySRV}, 0, capacity, 0, "");
+      }
 
       // TODO:
       /*
@@ -58,7 +79,36 @@ namespace llarp
     {
       obj["lastPublished"] = to_json(m_LastPublish);
       obj["lastPublishAttempt"] = to_json(m_LastPublishAttempt);
+      obj["publish"] = util::StatusObject{{"confirmed", m_PublishConfirmed.size()},
+                                          {"skipped", m_PublishesSkipped},
+                                          {"resent", m_PublishesResent}};
       obj["introset"] = m_IntroSet.ExtractStatus();
+      obj["introsetCache"] = m_IntroSetCache.ExtractStatus();
+      obj["nameCache"] = m_NameCache.ExtractStatus();
+      obj["serviceLookups"] = util::StatusObject{{"started", m_ServiceLookupsStarted},
+                                                 {"coalesced", m_ServiceLookupsCoalesced}};
+      util::StatusObject timeToReady = nullptr;
+      if (m_TimeToReady)
+        timeToReady = to_json(*m_TimeToReady);
+      obj["startup"] = util::StatusObject{
+          {"timeToReady", timeToReady},
+          {"warm", m_WarmRestart},
+          {"warmIntroSets", m_WarmIntroSets},
+          {"warmFirstHops", m_WarmFirstHops}};
+      size_t pending = 0;
+      for (const auto& item : m_PendingTraffic)
+        pending += item.second.size();
+      obj["pendingTraffic"] = util::StatusObject{{"waiting", pending},
+                                                 {"dropped", m_PendingDropped},
+                                                 {"wait", m_PendingWait.ExtractStatus()}};
+      obj["dnsPrefetch"] = util::StatusObject{{"enabled", m_DNSPrefetch},
+                                              {"outstanding", m_Prefetches.size()},
+                                              {"started", m_PrefetchStarted},
+                                              {"ready", m_PrefetchReady},
+                                              {"late", m_PrefetchLate},
+                                              {"wasted", m_PrefetchWasted}};
+      if (m_AggregateIntroSets)
+        obj["peerIntros"] = m_PeerIntros.size();
       static auto getSecond = [](const auto& item) -> auto
       {
         return item.second->ExtractStatus();
@@ -8,14 +8,17 @@
 #include <service/router_lookup_job.hpp>
 #include <service/session.hpp>
 #include <service/endpoint_types.hpp>
+#include <service/introset_cache.hpp>
+#include <service/name_cache.hpp>
 #include <util/compare_ptr.hpp>
-#include <util/decaying_hashtable.hpp>
 #include <util/status.hpp>
 
 #include <memory>
+#include <optional>
 #include <queue>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 struct llarp_ev_loop;
 using llarp_ev_loop_ptr = std::shared_ptr<llarp_ev_loop>;
@@ -49,8 +52,51 @@ namespace llarp
       std::string m_Name;
       std::string m_NetNS;
       bool m_ExitEnabled = false;
+      /// how many remote intros to spread traffic to one remote over
+      size_t m_MultipathWidth = 1;
+      /// send repair messages down paths that lose traffic
+      bool m_RepairFrames = true;
+      /// compress payloads to remotes that take them
+      bool m_Compress = false;
+      /// how many storage nodes one introset lookup asks at once
+      size_t m_LookupFanout = 2;
+      /// save and load a WarmState beside the keyfile
+      bool m_WarmRestart = false;
+      /// when we started and how long until our first introset went out
+      llarp_time_t m_StartedAt = 0s;
+      std::optional<llarp_time_t> m_TimeToReady;
+      /// introsets and first hops the last warm state gave us
+      size_t m_WarmIntroSets = 0;
+      size_t m_WarmFirstHops = 0;
+      /// publish the intros of other instances sharing our identity beside our own
+      bool m_AggregateIntroSets = false;
+      /// intros of those instances, as our introset last had them
+      std::vector<Introduction> m_PeerIntros;
+      /// path ids of the intros we published ourselves and when they expire, so we never take
+      /// our own old intros for a peer's
+      std::unordered_map<PathID_t, llarp_time_t, PathID_t::Hash> m_OwnIntros;
+      llarp_time_t m_LastPeerIntroLookup = 0s;
+      /// start sessions to remotes as their names resolve
+      bool m_DNSPrefetch = true;
+      bool m_LazyStart = false;
+      /// lazy-start is holding off path building until something needs us
+      bool m_WaitingForUse = false;
+      /// remotes we started a session to on a name lookup and no traffic went to yet, by when
+      std::unordered_map<Address, llarp_time_t, Address::Hash> m_Prefetches;
+      /// prefetches started, ones traffic followed and found ready or still coming up, and ones
+      /// no traffic followed
+      uint64_t m_PrefetchStarted = 0;
+      uint64_t m_PrefetchReady = 0;
+      uint64_t m_PrefetchLate = 0;
+      uint64_t m_PrefetchWasted = 0;
+      /// how long traffic to snodes may wait for more to share its message
+      llarp_time_t m_ExitBatchDelay = 0s;
 
       PendingTraffic m_PendingTraffic;
+      PendingBufferPool m_PendingPool;
+      /// how long pending traffic waited for its session, and what was dropped while waiting
+      util::DurationHistogram m_PendingWait;
+      uint64_t m_PendingDropped = 0;
 
       Sessions m_RemoteSessions;
       Sessions m_DeadSessions;
@@ -61,6 +107,13 @@ namespace llarp
 
       std::unordered_multimap<Address, PathEnsureHook, Address::Hash> m_PendingServiceLookups;
       std::unordered_map<Address, llarp_time_t, Address::Hash> m_LastServiceLookupTimes;
+      /// txids of the introset lookups still out for each address
+      std::unordered_multimap<Address, uint64_t, Address::Hash> m_IntroSetLookupTXs;
+      /// what the lookups found, and found missing, lately
+      IntroSetCache m_IntroSetCache;
+      /// introset lookup rounds sent, and hooks that waited on a round already out instead
+      uint64_t m_ServiceLookupsStarted = 0;
+      uint64_t m_ServiceLookupsCoalesced = 0;
 
       std::unordered_map<RouterID, uint32_t, RouterID::Hash> m_ServiceLookupFails;
 
@@ -68,6 +121,15 @@ namespace llarp
 
       llarp_time_t m_LastPublish = 0s;
       llarp_time_t m_LastPublishAttempt = 0s;
+      /// the introset we last signed, what went into it, and the relay orders that confirmed
+      /// storing it. it is encrypted and signed again only when that content changes or it
+      /// gets old
+      std::optional<EncryptedIntroSet> m_PublishedIntroSet;
+      IntroSet m_PublishedContent;
+      std::set<uint64_t> m_PublishConfirmed;
+      /// republishes skipped as nothing changed, and ones sent only to unconfirmed storage
+      uint64_t m_PublishesSkipped = 0;
+      uint64_t m_PublishesResent = 0;
       /// our introset
       IntroSet m_IntroSet;
       /// pending remote service lookups by id
@@ -80,7 +142,10 @@ namespace llarp
 
       OutboundSessions_t m_OutboundSessions;
 
-      util::DecayingHashTable<std::string, Address, std::hash<std::string>> nameCache;
+      /// what lns names resolved to, and the callers waiting on a lookup of a name already out
+      NameCache m_NameCache;
+      std::unordered_multimap<std::string, std::function<void(std::optional<Address>)>>
+          m_PendingNameLookups;
 
       bool
       Configure(const NetworkConfig& conf);
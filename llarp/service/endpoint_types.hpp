@@ -30,7 +30,6 @@ namespace llarp
     using SendEvent_t = std::pair<Msg_ptr, path::Path_ptr>;
     using SendMessageQueue_t = thread::Queue<SendEvent_t>;
 
-    using PendingBufferQueue = std::deque<PendingBuffer>;
     using PendingTraffic = std::unordered_map<Address, PendingBufferQueue, Address::Hash>;
 
     using ProtocolMessagePtr = std::shared_ptr<ProtocolMessage>;
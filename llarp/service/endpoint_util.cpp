@@ -10,27 +10,15 @@ namespace llarp
   namespace service
   {
     void
-    EndpointUtil::ExpireSNodeSessions(llarp_time_t now, SNodeSessions& sessions)
+    EndpointUtil::ExpireSNodeSessions(SNodeSessions& sessions)
     {
       auto itr = sessions.begin();
       while (itr != sessions.end())
       {
-        if (itr->second.first->ShouldRemove() && itr->second.first->IsStopped())
-        {
+        if (itr->second.first->IsStopped())
           itr = sessions.erase(itr);
-          continue;
-        }
-        // expunge next tick
-        if (itr->second.first->IsExpired(now))
-        {
-          itr->second.first->Stop();
-        }
         else
-        {
-          itr->second.first->Tick(now);
-        }
-
-        ++itr;
+          ++itr;
       }
     }
 
@@ -133,15 +121,6 @@ namespace llarp
       }
     }
 
-    void
-    EndpointUtil::StopSnodeSessions(SNodeSessions& sessions)
-    {
-      for (auto& item : sessions)
-      {
-        item.second.first->Stop();
-      }
-    }
-
     bool
     EndpointUtil::HasPathToService(const Address& addr, const Sessions& remoteSessions)
     {
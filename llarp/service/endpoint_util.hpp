@@ -9,8 +9,9 @@ namespace llarp
   {
     struct EndpointUtil
     {
+      /// forget the sessions that stopped
       static void
-      ExpireSNodeSessions(llarp_time_t now, SNodeSessions& sessions);
+      ExpireSNodeSessions(SNodeSessions& sessions);
 
       static void
       ExpirePendingTx(llarp_time_t now, PendingLookups& lookups);
@@ -31,9 +32,6 @@ namespace llarp
       static void
       StopRemoteSessions(Sessions& remoteSessions);
 
-      static void
-      StopSnodeSessions(SNodeSessions& sessions);
-
       static bool
       HasPathToService(const Address& addr, const Sessions& remoteSessions);
 
@@ -0,0 +1,225 @@
+#include <service/exit_selector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// how often the bytes an exit sent back are turned into a rate
+    static constexpr auto ThroughputWindow = 1s;
+    /// how much of the highest rate seen is kept over each window, so it falls off once an
+    /// exit carries less
+    static constexpr double ThroughputDecay = 0.75;
+    /// weight of a new round trip sample
+    static constexpr double RTTGain = 0.25;
+
+    /// turn the bytes since the window started into a rate once it is over
+    static void
+    RollWindow(double& measured, uint64_t& bytes, llarp_time_t& start, llarp_time_t now)
+    {
+      if (now < start + ThroughputWindow)
+        return;
+      const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+      // bits per microsecond are Mbit/s
+      const double rate = start > 0s ? double(bytes * 8) / double(elapsed.count()) : 0;
+      measured = std::max(rate, measured * ThroughputDecay);
+      bytes = 0;
+      start = now;
+    }
+
+    void
+    ExitSelector::Latency(const Address& exit, llarp_time_t rtt)
+    {
+      auto& info = m_Exits[exit];
+      if (not info.rtt.has_value())
+      {
+        info.rtt = rtt;
+        return;
+      }
+      const auto prev = std::chrono::duration<double, std::milli>(*info.rtt).count();
+      const auto sample = std::chrono::duration<double, std::milli>(rtt).count();
+      info.rtt = std::chrono::duration_cast<llarp_time_t>(
+          std::chrono::duration<double, std::milli>(prev + RTTGain * (sample - prev)));
+    }
+
+    void
+    ExitSelector::Lost(const Address& exit)
+    {
+      const auto itr = m_Exits.find(exit);
+      if (itr != m_Exits.end())
+        itr->second.rtt.reset();
+    }
+
+    void
+    ExitSelector::Advertised(const Address& exit, const IntroSet& introset)
+    {
+      auto& info = m_Exits[exit];
+      info.advertised = 0;
+      for (const auto& srv : introset.GetMatchingSRVRecords(CapacitySRV))
+        info.advertised = srv.weight;
+    }
+
+    void
+    ExitSelector::Received(const Address& exit, size_t sz, llarp_time_t now)
+    {
+      auto& info = m_Exits[exit];
+      RollWindow(info.measured, info.windowBytes, info.windowStart, now);
+      info.windowBytes += sz;
+      info.unanswered.reset();
+      info.lastReceived = now;
+    }
+
+    std::optional<double>
+    ExitSelector::Cost(const Address& exit) const
+    {
+      const auto itr = m_Exits.find(exit);
+      if (itr == m_Exits.end() or not itr->second.rtt.has_value())
+        return std::nullopt;
+      const auto& info = itr->second;
+      const double capacity = std::max<double>(info.advertised, info.measured);
+      // capacity only helps so much, a fat exit far away is still slow to every flow
+      return std::max<double>(info.rtt->count(), 1) / (1 + std::log2(1 + capacity));
+    }
+
+    bool
+    ExitSelector::IsDead(const Address& exit, llarp_time_t now) const
+    {
+      const auto itr = m_Exits.find(exit);
+      if (itr == m_Exits.end() or not itr->second.unanswered.has_value())
+        return false;
+      return now >= *itr->second.unanswered + ReplyTimeout;
+    }
+
+    std::optional<llarp_time_t>
+    ExitSelector::BestRTT(llarp_time_t now) const
+    {
+      std::optional<llarp_time_t> best;
+      for (const auto& [addr, info] : m_Exits)
+      {
+        if (info.rtt.has_value() and not IsDead(addr, now) and (not best or *info.rtt < *best))
+          best = info.rtt;
+      }
+      return best;
+    }
+
+    bool
+    ExitSelector::IsDegraded(const Address& exit, llarp_time_t now) const
+    {
+      if (IsDead(exit, now))
+        return true;
+      const auto itr = m_Exits.find(exit);
+      const auto best = BestRTT(now);
+      if (itr == m_Exits.end() or not itr->second.rtt.has_value() or not best.has_value())
+        return false;
+      return itr->second.rtt->count() > Degraded * std::max<int64_t>(best->count(), 1);
+    }
+
+    Address
+    ExitSelector::Best(const std::set<Address>& exits, llarp_time_t now) const
+    {
+      std::optional<Address> best;
+      double bestCost = std::numeric_limits<double>::max();
+      // the first live exit if none of them is measured yet
+      std::optional<Address> fallback;
+      for (const auto& exit : exits)
+      {
+        if (IsDead(exit, now))
+          continue;
+        if (not fallback)
+          fallback = exit;
+        const auto cost = Cost(exit);
+        if (not cost or IsDegraded(exit, now))
+          continue;
+        if (*cost < bestCost)
+        {
+          bestCost = *cost;
+          best = exit;
+        }
+      }
+      if (best)
+        return *best;
+      if (fallback)
+        return *fallback;
+      return *exits.begin();
+    }
+
+    Address
+    ExitSelector::Pick(uint32_t flow, const std::set<Address>& exits, llarp_time_t now)
+    {
+      auto itr = m_Flows.find(flow);
+      if (itr != m_Flows.end())
+      {
+        const auto& exit = itr->second.exit;
+        if (exits.count(exit) and not IsDead(exit, now))
+        {
+          itr->second.lastActive = now;
+          auto& info = m_Exits[exit];
+          if (not info.unanswered)
+            info.unanswered = now;
+          return exit;
+        }
+        m_Moved++;
+      }
+      const auto exit = Best(exits, now);
+      m_Flows[flow] = Flow{exit, now};
+      auto& info = m_Exits[exit];
+      if (not info.unanswered)
+        info.unanswered = now;
+      return exit;
+    }
+
+    void
+    ExitSelector::Tick(llarp_time_t now, const std::set<Address>& exits)
+    {
+      for (auto itr = m_Flows.begin(); itr != m_Flows.end();)
+      {
+        if (now >= itr->second.lastActive + FlowIdle or exits.count(itr->second.exit) == 0)
+          itr = m_Flows.erase(itr);
+        else
+          ++itr;
+      }
+      for (auto itr = m_Exits.begin(); itr != m_Exits.end();)
+      {
+        if (exits.count(itr->first) == 0)
+        {
+          itr = m_Exits.erase(itr);
+          continue;
+        }
+        auto& info = itr->second;
+        RollWindow(info.measured, info.windowBytes, info.windowStart, now);
+        // a dead exit gets another go once it has been left alone for a while, its paths or
+        // the exit itself may well have come back since
+        if (info.unanswered and now >= *info.unanswered + ReplyTimeout + FlowIdle)
+          info.unanswered.reset();
+        ++itr;
+      }
+    }
+
+    util::StatusObject
+    ExitSelector::ExtractStatus(llarp_time_t now) const
+    {
+      util::StatusObject exits{};
+      for (const auto& [addr, info] : m_Exits)
+      {
+        const auto flows = std::count_if(
+            m_Flows.begin(), m_Flows.end(), [&addr = addr](const auto& f) {
+              return f.second.exit == addr;
+            });
+        util::StatusObject obj{{"advertisedMbit", info.advertised},
+                               {"measuredMbit", info.measured},
+                               {"flows", flows},
+                               {"degraded", IsDegraded(addr, now)},
+                               {"dead", IsDead(addr, now)}};
+        if (info.rtt)
+          obj["rtt"] = to_json(*info.rtt);
+        if (info.lastReceived > 0s)
+          obj["lastReceived"] = to_json(info.lastReceived);
+        exits[addr.ToString()] = obj;
+      }
+      return {{"exits", exits}, {"flows", m_Flows.size()}, {"moved", m_Moved}};
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,120 @@
+#ifndef LLARP_SERVICE_EXIT_SELECTOR_HPP
+#define LLARP_SERVICE_EXIT_SELECTOR_HPP
+
+#include <service/address.hpp>
+#include <service/intro_set.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// picks which of the exits mapped to a range each flow goes out through when there is
+    /// more than one. exits are ranked by their round trip over the paths we keep to them,
+    /// helped along by how much they say they can carry and how much we have seen them carry.
+    /// a flow stays on the exit it started on, so its connections are not cut by a shift, and
+    /// new flows go to the best exit. an exit well slower than the best takes no new flows and
+    /// drains as its flows finish, one that stopped answering loses its flows to the best.
+    /// only from the logic thread
+    struct ExitSelector
+    {
+      /// the srv record an exit advertises its capacity with, the weight being Mbit/s
+      static constexpr std::string_view CapacitySRV{"_exit._lokinet"};
+      /// a flow nothing went out on for this long is forgotten
+      static constexpr auto FlowIdle = 30s;
+      /// an exit we sent to that sent nothing back for this long is taken as dead
+      static constexpr auto ReplyTimeout = 5s;
+      /// an exit with a round trip over this many times the best one's is degraded
+      static constexpr double Degraded = 2.0;
+
+      /// a round trip to exit over our path and its intro's
+      void
+      Latency(const Address& exit, llarp_time_t rtt);
+
+      /// no path to exit any more, it ranks as unmeasured until the next Latency
+      void
+      Lost(const Address& exit);
+
+      /// take exit's advertised capacity from its introset
+      void
+      Advertised(const Address& exit, const IntroSet& introset);
+
+      /// sz bytes came back from exit
+      void
+      Received(const Address& exit, size_t sz, llarp_time_t now);
+
+      /// the exit the flow with hash flow goes out through, of the exits mapped to where it
+      /// is going
+      Address
+      Pick(uint32_t flow, const std::set<Address>& exits, llarp_time_t now);
+
+      /// forget idle flows and exits nothing maps to any more
+      void
+      Tick(llarp_time_t now, const std::set<Address>& exits);
+
+      /// how costly sending through exit is, lower is better, nullopt until its round trip is
+      /// known
+      std::optional<double>
+      Cost(const Address& exit) const;
+
+      /// true if exit takes no new flows
+      bool
+      IsDegraded(const Address& exit, llarp_time_t now) const;
+
+      /// true if exit loses its flows to the best exit
+      bool
+      IsDead(const Address& exit, llarp_time_t now) const;
+
+      size_t
+      Flows() const
+      {
+        return m_Flows.size();
+      }
+
+      util::StatusObject
+      ExtractStatus(llarp_time_t now) const;
+
+     private:
+      struct Exit
+      {
+        std::optional<llarp_time_t> rtt;
+        /// Mbit/s it advertised, 0 for none
+        uint64_t advertised = 0;
+        /// the most Mbit/s we have seen come back from it lately
+        double measured = 0;
+        uint64_t windowBytes = 0;
+        llarp_time_t windowStart = 0s;
+        /// when the first thing we sent to it since it last sent anything back went out
+        std::optional<llarp_time_t> unanswered;
+        llarp_time_t lastReceived = 0s;
+      };
+
+      struct Flow
+      {
+        Address exit;
+        llarp_time_t lastActive;
+      };
+
+      /// the best exit of exits for a new flow
+      Address
+      Best(const std::set<Address>& exits, llarp_time_t now) const;
+
+      /// the lowest round trip of exits that are not dead
+      std::optional<llarp_time_t>
+      BestRTT(llarp_time_t now) const;
+
+      std::unordered_map<Address, Exit, Address::Hash> m_Exits;
+      std::unordered_map<uint32_t, Flow> m_Flows;
+      uint64_t m_Moved = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -44,6 +44,22 @@ namespace llarp
       virtual bool
       HasConvoTag(const ConvoTag& remote) const = 0;
 
+      /// true if we may send the remote on this convo frames with a keyed hash, not signed
+      virtual bool
+      TakesMACFrames(const ConvoTag& remote) const = 0;
+
+      /// true if the remote on this convo rebuilds lost messages from repair messages
+      virtual bool
+      TakesRepairFrames(const ConvoTag& remote) const = 0;
+
+      /// true if the remote on this convo unpacks bundles of packets
+      virtual bool
+      TakesBundles(const ConvoTag& remote) const = 0;
+
+      /// true if the remote on this convo takes compressed payloads
+      virtual bool
+      TakesCompression(const ConvoTag& remote) const = 0;
+
       virtual void
       PutSenderFor(const ConvoTag& remote, const ServiceInfo& si, bool inbound) = 0;
 
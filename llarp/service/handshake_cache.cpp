@@ -0,0 +1,216 @@
+#include <service/handshake_cache.hpp>
+
+#include <crypto/crypto.hpp>
+#include <service/identity.hpp>
+#include <service/info.hpp>
+
+namespace llarp
+{
+  namespace service
+  {
+    template <typename Key_t, typename Val_t>
+    bool
+    HandshakeCache::Get(
+        Entries_t<Key_t, Val_t>& entries, const Key_t& key, Val_t& val, llarp_time_t now)
+    {
+      auto itr = entries.find(key);
+      if (itr == entries.end())
+        return false;
+      auto& entry = itr->second;
+      if (now >= entry.made + MaxAge)
+      {
+        // keep the secret out of freed memory
+        entry.val = Val_t{};
+        entries.erase(itr);
+        return false;
+      }
+      val = entry.val;
+      m_Hits++;
+      if (++entry.uses >= MaxUses)
+      {
+        entry.val = Val_t{};
+        entries.erase(itr);
+      }
+      return true;
+    }
+
+    template <typename Key_t, typename Val_t>
+    void
+    HandshakeCache::Put(
+        Entries_t<Key_t, Val_t>& entries, const Key_t& key, const Val_t& val, llarp_time_t now)
+    {
+      if (entries.size() >= MaxEntries and entries.find(key) == entries.end())
+      {
+        auto oldest = entries.begin();
+        for (auto itr = entries.begin(); itr != entries.end(); ++itr)
+        {
+          if (itr->second.made < oldest->second.made)
+            oldest = itr;
+        }
+        oldest->second.val = Val_t{};
+        entries.erase(oldest);
+      }
+      auto& entry = entries[key];
+      entry.val = val;
+      entry.made = now;
+      entry.uses = 1;
+    }
+
+    bool
+    HandshakeCache::StaticDH(
+        bool client,
+        SharedSecret& result,
+        const Identity& local,
+        const ServiceInfo& remote,
+        const KeyExchangeNonce& N,
+        llarp_time_t now)
+    {
+      auto crypto = CryptoManager::instance();
+      const PubKey& them = remote.EncryptionPublicKey();
+      SharedSecret shared;
+      bool cached = false;
+      {
+        util::Lock lock(m_Access);
+        cached = Get(client ? m_ClientDH : m_ServerDH, them, shared, now);
+      }
+      if (not cached)
+      {
+        const bool ok = client ? crypto->dh_client_static(shared, them, local.enckey)
+                               : crypto->dh_server_static(shared, them, local.enckey);
+        if (not ok)
+          return false;
+        util::Lock lock(m_Access);
+        Put(client ? m_ClientDH : m_ServerDH, them, shared, now);
+      }
+      // the same keyed hash dh_client and dh_server finish with
+      const bool ok = crypto->hmac(result.data(), llarp_buffer_t(N), shared);
+      shared.Zero();
+      return ok;
+    }
+
+    bool
+    HandshakeCache::ClientDH(
+        SharedSecret& result,
+        const Identity& local,
+        const ServiceInfo& remote,
+        const KeyExchangeNonce& N,
+        llarp_time_t now)
+    {
+      return StaticDH(true, result, local, remote, N, now);
+    }
+
+    bool
+    HandshakeCache::ServerDH(
+        SharedSecret& result,
+        const Identity& local,
+        const ServiceInfo& remote,
+        const KeyExchangeNonce& N,
+        llarp_time_t now)
+    {
+      return StaticDH(false, result, local, remote, N, now);
+    }
+
+    bool
+    HandshakeCache::Encapsulate(
+        PQCipherBlock& C, SharedSecret& K, const PQPubKey& remote, llarp_time_t now)
+    {
+      Encapsulation sent;
+      {
+        util::Lock lock(m_Access);
+        if (Get(m_Sent, remote, sent, now))
+        {
+          C = sent.C;
+          K = sent.K;
+          sent.K.Zero();
+          return true;
+        }
+      }
+      if (not CryptoManager::instance()->pqe_encrypt(C, K, remote))
+        return false;
+      sent.C = C;
+      sent.K = K;
+      util::Lock lock(m_Access);
+      Put(m_Sent, remote, sent, now);
+      sent.K.Zero();
+      return true;
+    }
+
+    bool
+    HandshakeCache::Decapsulate(
+        const PQCipherBlock& C, SharedSecret& K, const PQKeyPair& local, llarp_time_t now)
+    {
+      {
+        util::Lock lock(m_Access);
+        if (Get(m_Received, C, K, now))
+          return true;
+      }
+      if (not CryptoManager::instance()->pqe_decrypt(C, K, pq_keypair_to_secret(local)))
+        return false;
+      util::Lock lock(m_Access);
+      Put(m_Received, C, K, now);
+      return true;
+    }
+
+    void
+    HandshakeCache::Expire(llarp_time_t now)
+    {
+      const auto expire = [now](auto& entries) {
+        auto itr = entries.begin();
+        while (itr != entries.end())
+        {
+          if (now >= itr->second.made + MaxAge)
+          {
+            itr->second.val = {};
+            itr = entries.erase(itr);
+          }
+          else
+            ++itr;
+        }
+      };
+      util::Lock lock(m_Access);
+      expire(m_ClientDH);
+      expire(m_ServerDH);
+      expire(m_Sent);
+      expire(m_Received);
+    }
+
+    void
+    HandshakeCache::Clear()
+    {
+      const auto clear = [](auto& entries) {
+        for (auto& item : entries)
+          item.second.val = {};
+        entries.clear();
+      };
+      util::Lock lock(m_Access);
+      clear(m_ClientDH);
+      clear(m_ServerDH);
+      clear(m_Sent);
+      clear(m_Received);
+    }
+
+    size_t
+    HandshakeCache::Size() const
+    {
+      util::Lock lock(m_Access);
+      return m_ClientDH.size() + m_ServerDH.size() + m_Sent.size() + m_Received.size();
+    }
+
+    uint64_t
+    HandshakeCache::Hits() const
+    {
+      util::Lock lock(m_Access);
+      return m_Hits;
+    }
+
+    util::StatusObject
+    HandshakeCache::ExtractStatus() const
+    {
+      util::Lock lock(m_Access);
+      return util::StatusObject{{"dh", m_ClientDH.size() + m_ServerDH.size()},
+                                {"pqSent", m_Sent.size()},
+                                {"pqReceived", m_Received.size()},
+                                {"hits", m_Hits}};
+    }
+  }  // namespace service
+}  // namespace llarp
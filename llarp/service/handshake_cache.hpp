@@ -0,0 +1,130 @@
+#ifndef LLARP_SERVICE_HANDSHAKE_CACHE_HPP
+#define LLARP_SERVICE_HANDSHAKE_CACHE_HPP
+
+#include <crypto/types.hpp>
+#include <util/status.hpp>
+#include <util/thread/annotations.hpp>
+#include <util/thread/threading.hpp>
+#include <util/time.hpp>
+
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace service
+  {
+    struct Identity;
+    struct ServiceInfo;
+
+    /// the handshake work that comes out the same from one convo to the next with the same
+    /// remote: the nonce free x25519 result of our and their long term keys, and the ntru
+    /// encapsulation to their introset key. keeping them lets a reconnect or re-key to the
+    /// same service skip the curve25519 and ntru work, every convo still gets its own tag,
+    /// nonce and session key.
+    ///
+    /// an entry is dropped and wiped once it is MaxAge old or has been used MaxUses times,
+    /// whichever is first, so a leaked ntru key only ever covers that many convos in that
+    /// window. used from the logic thread and the crypto workers.
+    struct HandshakeCache
+    {
+      /// how long an entry is trusted after it was made
+      static constexpr auto MaxAge = 10min;
+      /// how many handshakes one entry serves
+      static constexpr uint64_t MaxUses = 64;
+      /// entries kept per kind, the oldest goes first when full
+      static constexpr size_t MaxEntries = 512;
+
+      /// dh_client with the remote, using the cached static part when there is one
+      bool
+      ClientDH(
+          SharedSecret& result,
+          const Identity& local,
+          const ServiceInfo& remote,
+          const KeyExchangeNonce& N,
+          llarp_time_t now);
+
+      /// dh_server with the remote, using the cached static part when there is one
+      bool
+      ServerDH(
+          SharedSecret& result,
+          const Identity& local,
+          const ServiceInfo& remote,
+          const KeyExchangeNonce& N,
+          llarp_time_t now);
+
+      /// pqe_encrypt to the remote's introset key, or the ciphertext and key we last sent it
+      bool
+      Encapsulate(PQCipherBlock& C, SharedSecret& K, const PQPubKey& remote, llarp_time_t now);
+
+      /// pqe_decrypt a ciphertext, or the key it gave last time we saw it
+      bool
+      Decapsulate(
+          const PQCipherBlock& C, SharedSecret& K, const PQKeyPair& local, llarp_time_t now);
+
+      /// drop and wipe entries past MaxAge
+      void
+      Expire(llarp_time_t now);
+
+      /// drop and wipe everything, for when our keys change
+      void
+      Clear();
+
+      /// entries of every kind
+      size_t
+      Size() const;
+
+      /// handshakes served from the cache
+      uint64_t
+      Hits() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+      template <typename Val_t>
+      struct Entry
+      {
+        Val_t val;
+        llarp_time_t made = 0s;
+        uint64_t uses = 0;
+      };
+
+      template <typename Key_t, typename Val_t>
+      using Entries_t = std::unordered_map<Key_t, Entry<Val_t>, typename Key_t::Hash>;
+
+      struct Encapsulation
+      {
+        PQCipherBlock C;
+        SharedSecret K;
+      };
+
+     private:
+      template <typename Key_t, typename Val_t>
+      bool
+      Get(Entries_t<Key_t, Val_t>& entries, const Key_t& key, Val_t& val, llarp_time_t now)
+          REQUIRES(m_Access);
+
+      template <typename Key_t, typename Val_t>
+      void
+      Put(Entries_t<Key_t, Val_t>& entries, const Key_t& key, const Val_t& val, llarp_time_t now)
+          REQUIRES(m_Access);
+
+      bool
+      StaticDH(
+          bool client,
+          SharedSecret& result,
+          const Identity& local,
+          const ServiceInfo& remote,
+          const KeyExchangeNonce& N,
+          llarp_time_t now);
+
+      mutable util::Mutex m_Access;
+      Entries_t<PubKey, SharedSecret> m_ClientDH GUARDED_BY(m_Access);
+      Entries_t<PubKey, SharedSecret> m_ServerDH GUARDED_BY(m_Access);
+      Entries_t<PQPubKey, Encapsulation> m_Sent GUARDED_BY(m_Access);
+      Entries_t<PQCipherBlock, SharedSecret> m_Received GUARDED_BY(m_Access);
+      uint64_t m_Hits GUARDED_BY(m_Access) = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
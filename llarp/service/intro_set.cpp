@@ -1,5 +1,6 @@
 #include <service/intro_set.hpp>
 #include <crypto/crypto.hpp>
+#include <crypto/verified_cache.hpp>
 #include <path/path.hpp>
 
 #include <lokimq/bt_serialize.h>
@@ -8,6 +9,35 @@ namespace llarp
 {
   namespace service
   {
+    /// introsets whose signature and work we checked, shared by the dht and every endpoint
+    static VerifiedCache&
+    VerifiedIntroSets()
+    {
+      static VerifiedCache cache{path::default_lifetime, 8192};
+      return cache;
+    }
+
+    /// digest of the whole encoding, signature included, so a copy carrying a bad signature
+    /// never matches one we verified
+    template <typename IntroSet_t, size_t MaxSize>
+    static bool
+    VerifiedDigest(const IntroSet_t& set, ShortHash& digest)
+    {
+      std::array<byte_t, MaxSize> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not set.BEncode(&buf))
+        return false;
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      return VerifiedCache::Digest(digest, buf);
+    }
+
+    util::StatusObject
+    VerifiedIntroSetStatus()
+    {
+      return VerifiedIntroSets().ExtractStatus();
+    }
+
     util::StatusObject
     EncryptedIntroSet::ExtractStatus() const
     {
@@ -127,6 +157,11 @@ namespace llarp
     {
       if (IsExpired(now))
         return false;
+      ShortHash digest;
+      const bool cacheable =
+          VerifiedDigest<EncryptedIntroSet, MAX_INTROSET_SIZE + 128>(*this, digest);
+      if (cacheable and VerifiedIntroSets().Contains(digest, now))
+        return true;
       std::array<byte_t, MAX_INTROSET_SIZE + 128> tmp;
       llarp_buffer_t buf(tmp);
       EncryptedIntroSet copy(*this);
@@ -136,7 +171,30 @@ namespace llarp
       LogDebug("verify encrypted introset: ", copy, " sig = ", sig);
       buf.sz = buf.cur - buf.base;
       buf.cur = buf.base;
-      return CryptoManager::instance()->verify(derivedSigningKey, buf, sig);
+      if (not CryptoManager::instance()->verify(derivedSigningKey, buf, sig))
+        return false;
+      if (cacheable)
+        VerifiedIntroSets().Add(digest, now);
+      return true;
+    }
+
+    bool
+    VerifyAll(const std::vector<EncryptedIntroSet>& sets, llarp_time_t now)
+    {
+      return std::all_of(sets.begin(), sets.end(), [now](const auto& introset) {
+        return introset.Verify(now);
+      });
+    }
+
+    bool
+    AllVerified(const std::vector<EncryptedIntroSet>& sets, llarp_time_t now)
+    {
+      return std::all_of(sets.begin(), sets.end(), [now](const auto& introset) {
+        ShortHash digest;
+        return not introset.IsExpired(now)
+            and VerifiedDigest<EncryptedIntroSet, MAX_INTROSET_SIZE + 128>(introset, digest)
+            and VerifiedIntroSets().Contains(digest, now);
+      });
     }
 
     util::StatusObject
@@ -301,26 +359,39 @@ namespace llarp
     bool
     IntroSet::Verify(llarp_time_t now) const
     {
-      std::array<byte_t, MAX_INTROSET_SIZE> tmp;
-      llarp_buffer_t buf(tmp);
-      IntroSet copy;
-      copy = *this;
-      copy.Z.Zero();
-      if (!copy.BEncode(&buf))
+      ShortHash digest;
+      const bool cacheable = VerifiedDigest<IntroSet, MAX_INTROSET_SIZE>(*this, digest);
+      if (cacheable and VerifiedIntroSets().Contains(digest, now))
       {
-        return false;
-      }
-      // rewind and resize buffer
-      buf.sz = buf.cur - buf.base;
-      buf.cur = buf.base;
-      if (!A.Verify(buf, Z))
-      {
-        return false;
+        // the work was checked with the signature, only its lifetime can have run out since
+        if (W && W->IsExpired(now))
+          return false;
       }
-      // validate PoW
-      if (W && !W->IsValid(now))
+      else
       {
-        return false;
+        std::array<byte_t, MAX_INTROSET_SIZE> tmp;
+        llarp_buffer_t buf(tmp);
+        IntroSet copy;
+        copy = *this;
+        copy.Z.Zero();
+        if (!copy.BEncode(&buf))
+        {
+          return false;
+        }
+        // rewind and resize buffer
+        buf.sz = buf.cur - buf.base;
+        buf.cur = buf.base;
+        if (!A.Verify(buf, Z))
+        {
+          return false;
+        }
+        // validate PoW
+        if (W && !W->IsValid(now))
+        {
+          return false;
+        }
+        if (cacheable)
+          VerifiedIntroSets().Add(digest, now);
       }
       // valid timestamps
       // add max clock skew
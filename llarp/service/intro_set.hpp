@@ -43,6 +43,14 @@ namespace llarp
         return T < other.T;
       }
 
+      /// same services, intros and keys, whenever and however either was signed
+      bool
+      SameContentAs(const IntroSet& other) const
+      {
+        return std::tie(A, I, K, topic, SRVs, version)
+            == std::tie(other.A, other.I, other.K, other.topic, other.SRVs, other.version);
+      }
+
       std::ostream&
       print(std::ostream& stream, int level, int spaces) const;
 
@@ -158,6 +166,19 @@ namespace llarp
       return i.print(out, -1, -1);
     }
 
+    /// Verify on every one of sets, for a worker to run over a batch off the logic thread
+    bool
+    VerifyAll(const std::vector<EncryptedIntroSet>& sets, llarp_time_t now);
+
+    /// true if every one of sets was verified before and has not expired, answered from the
+    /// cache without checking any signature
+    bool
+    AllVerified(const std::vector<EncryptedIntroSet>& sets, llarp_time_t now);
+
+    /// hits and misses of the cache Verify answers repeats from
+    util::StatusObject
+    VerifiedIntroSetStatus();
+
     inline bool
     operator<(const EncryptedIntroSet& lhs, const EncryptedIntroSet& rhs)
     {
@@ -0,0 +1,107 @@
+#include <service/introset_cache.hpp>
+
+namespace llarp
+{
+  namespace service
+  {
+    std::optional<IntroSet>
+    IntroSetCache::Get(const dht::Key_t& location, llarp_time_t now)
+    {
+      auto itr = m_Entries.find(location);
+      if (itr == m_Entries.end() or not itr->second.introset)
+        return std::nullopt;
+      if (now >= itr->second.expiresAt)
+      {
+        m_Entries.erase(itr);
+        return std::nullopt;
+      }
+      m_Hits++;
+      return itr->second.introset;
+    }
+
+    bool
+    IntroSetCache::IsMissing(const dht::Key_t& location, llarp_time_t now)
+    {
+      auto itr = m_Entries.find(location);
+      if (itr == m_Entries.end() or itr->second.introset)
+        return false;
+      if (now >= itr->second.expiresAt)
+      {
+        m_Entries.erase(itr);
+        return false;
+      }
+      m_MissHits++;
+      return true;
+    }
+
+    void
+    IntroSetCache::Put(const dht::Key_t& location, const IntroSet& introset, llarp_time_t now)
+    {
+      const auto expiresAt = introset.GetNewestIntroExpiration() - ExpiryMargin;
+      if (now >= expiresAt)
+        return;
+      auto itr = m_Entries.find(location);
+      if (itr != m_Entries.end() and itr->second.introset
+          and not itr->second.introset->OtherIsNewer(introset))
+        return;
+      Store(location, Entry{introset, expiresAt}, now);
+    }
+
+    void
+    IntroSetCache::PutMissing(const dht::Key_t& location, llarp_time_t now)
+    {
+      Store(location, Entry{std::nullopt, now + MissTTL}, now);
+    }
+
+    void
+    IntroSetCache::Store(const dht::Key_t& location, Entry entry, llarp_time_t now)
+    {
+      if (m_Entries.size() >= MaxEntries and m_Entries.find(location) == m_Entries.end())
+      {
+        Expire(now);
+        if (m_Entries.size() >= MaxEntries)
+        {
+          auto first = m_Entries.begin();
+          for (auto itr = m_Entries.begin(); itr != m_Entries.end(); ++itr)
+          {
+            if (itr->second.expiresAt < first->second.expiresAt)
+              first = itr;
+          }
+          m_Entries.erase(first);
+        }
+      }
+      m_Entries[location] = std::move(entry);
+    }
+
+    void
+    IntroSetCache::Expire(llarp_time_t now)
+    {
+      for (auto itr = m_Entries.begin(); itr != m_Entries.end();)
+      {
+        if (now >= itr->second.expiresAt)
+          itr = m_Entries.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    size_t
+    IntroSetCache::Size() const
+    {
+      return m_Entries.size();
+    }
+
+    uint64_t
+    IntroSetCache::Hits() const
+    {
+      return m_Hits + m_MissHits;
+    }
+
+    util::StatusObject
+    IntroSetCache::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"entries", m_Entries.size()}, {"hits", m_Hits}, {"missHits", m_MissHits}};
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,78 @@
+#ifndef LLARP_SERVICE_INTROSET_CACHE_HPP
+#define LLARP_SERVICE_INTROSET_CACHE_HPP
+
+#include <dht/key.hpp>
+#include <service/intro_set.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <optional>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// the introsets our lookups found lately, by the dht location of their address, so a
+    /// new session to a remote we talked to a moment ago starts without looking it up again.
+    /// an introset is served until its newest intro is ExpiryMargin from expiring. a lookup
+    /// that found nothing is kept for MissTTL, so a remote that is not there is not asked
+    /// for again on every packet. used from the endpoint's logic thread only.
+    struct IntroSetCache
+    {
+      /// how long a lookup that found nothing is believed
+      static constexpr auto MissTTL = 5s;
+      /// an introset is dropped this long before its newest intro expires
+      static constexpr auto ExpiryMargin = 30s;
+      /// entries kept, the one expiring first goes when full
+      static constexpr size_t MaxEntries = 1024;
+
+      /// the introset for location if we have one that is still good
+      std::optional<IntroSet>
+      Get(const dht::Key_t& location, llarp_time_t now);
+
+      /// return true if a lookup for location found nothing less than MissTTL ago
+      bool
+      IsMissing(const dht::Key_t& location, llarp_time_t now);
+
+      /// keep an introset a lookup found, unless we have a newer one
+      void
+      Put(const dht::Key_t& location, const IntroSet& introset, llarp_time_t now);
+
+      /// remember that a lookup for location found nothing
+      void
+      PutMissing(const dht::Key_t& location, llarp_time_t now);
+
+      /// drop entries that are no longer good
+      void
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const;
+
+      /// lookups answered from the cache, found and missing
+      uint64_t
+      Hits() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Entry
+      {
+        /// nothing for a miss
+        std::optional<IntroSet> introset;
+        llarp_time_t expiresAt = 0s;
+      };
+
+      void
+      Store(const dht::Key_t& location, Entry entry, llarp_time_t now);
+
+      std::unordered_map<dht::Key_t, Entry, dht::Key_t::Hash> m_Entries;
+      uint64_t m_Hits = 0;
+      uint64_t m_MissHits = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,94 @@
+#include <service/name_cache.hpp>
+
+namespace llarp
+{
+  namespace service
+  {
+    std::optional<Address>
+    NameCache::Get(const std::string& name, llarp_time_t now)
+    {
+      auto itr = m_Entries.find(name);
+      if (itr == m_Entries.end())
+        return std::nullopt;
+      if (now >= itr->second.expiresAt)
+      {
+        m_Entries.erase(itr);
+        return std::nullopt;
+      }
+      if (now >= itr->second.freshUntil)
+        m_StaleHits++;
+      else
+        m_Hits++;
+      return itr->second.addr;
+    }
+
+    bool
+    NameCache::ShouldRefresh(const std::string& name, llarp_time_t now)
+    {
+      auto itr = m_Entries.find(name);
+      if (itr == m_Entries.end() or itr->second.refreshing or now < itr->second.freshUntil
+          or now >= itr->second.expiresAt)
+        return false;
+      itr->second.refreshing = true;
+      m_Refreshes++;
+      return true;
+    }
+
+    void
+    NameCache::Put(const std::string& name, const Address& addr, llarp_time_t now)
+    {
+      if (m_Entries.size() >= MaxEntries and m_Entries.find(name) == m_Entries.end())
+      {
+        Expire(now);
+        if (m_Entries.size() >= MaxEntries)
+        {
+          auto first = m_Entries.begin();
+          for (auto itr = m_Entries.begin(); itr != m_Entries.end(); ++itr)
+          {
+            if (itr->second.freshUntil < first->second.freshUntil)
+              first = itr;
+          }
+          m_Entries.erase(first);
+        }
+      }
+      m_Entries[name] = Entry{addr, now + FreshTTL, now + StaleTTL, false};
+    }
+
+    void
+    NameCache::RefreshFailed(const std::string& name, llarp_time_t now)
+    {
+      auto itr = m_Entries.find(name);
+      if (itr == m_Entries.end())
+        return;
+      itr->second.refreshing = false;
+      itr->second.freshUntil = std::min(now + RetryInterval, itr->second.expiresAt);
+    }
+
+    void
+    NameCache::Expire(llarp_time_t now)
+    {
+      for (auto itr = m_Entries.begin(); itr != m_Entries.end();)
+      {
+        if (now >= itr->second.expiresAt)
+          itr = m_Entries.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    size_t
+    NameCache::Size() const
+    {
+      return m_Entries.size();
+    }
+
+    util::StatusObject
+    NameCache::ExtractStatus() const
+    {
+      return util::StatusObject{{"entries", m_Entries.size()},
+                                {"hits", m_Hits},
+                                {"staleHits", m_StaleHits},
+                                {"refreshes", m_Refreshes}};
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,75 @@
+#ifndef LLARP_SERVICE_NAME_CACHE_HPP
+#define LLARP_SERVICE_NAME_CACHE_HPP
+
+#include <service/address.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// the addresses lns names resolved to lately, so a popular name resolves without a round
+    /// trip and a decrypt each time. a name is fresh for FreshTTL, after that it is still served
+    /// until StaleTTL while one lookup refreshes it in the background. used from the
+    /// endpoint's logic thread only.
+    struct NameCache
+    {
+      /// how long a resolved name is served without asking again
+      static constexpr auto FreshTTL = 10min;
+      /// how long a resolved name is served at all, refreshed or not
+      static constexpr auto StaleTTL = 1h;
+      /// how long after a failed refresh we try again
+      static constexpr auto RetryInterval = 30s;
+      /// names kept, the one going stale first goes when full
+      static constexpr size_t MaxEntries = 512;
+
+      /// the address name resolved to if we still serve it
+      std::optional<Address>
+      Get(const std::string& name, llarp_time_t now);
+
+      /// return true if name is served stale and nothing refreshes it yet, the caller is then
+      /// the one to refresh it and must call Put or RefreshFailed when done
+      bool
+      ShouldRefresh(const std::string& name, llarp_time_t now);
+
+      /// keep what a lookup for name found, fresh from now
+      void
+      Put(const std::string& name, const Address& addr, llarp_time_t now);
+
+      /// a lookup for name found nothing, keep serving what we had and try again later
+      void
+      RefreshFailed(const std::string& name, llarp_time_t now);
+
+      /// drop names past StaleTTL
+      void
+      Expire(llarp_time_t now);
+
+      size_t
+      Size() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Entry
+      {
+        Address addr;
+        llarp_time_t freshUntil = 0s;
+        llarp_time_t expiresAt = 0s;
+        bool refreshing = false;
+      };
+
+      std::unordered_map<std::string, Entry> m_Entries;
+      uint64_t m_Hits = 0;
+      uint64_t m_StaleHits = 0;
+      uint64_t m_Refreshes = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -1,5 +1,6 @@
 #include <service/outbound_context.hpp>
 
+#include <crypto/crypto.hpp>
 #include <router/abstractrouter.hpp>
 #include <service/async_key_exchange.hpp>
 #include <service/hidden_service_address_lookup.hpp>
@@ -61,11 +62,19 @@ namespace llarp
 
     {
       updatingIntroSet = false;
+      // start on a random intro that lasts a while rather than the newest, so new sessions to a
+      // service run by several instances spread over all of them
+      std::vector<Introduction> usable;
+      const auto now = parent->Now();
       for (const auto& intro : introset.I)
       {
+        if (not intro.ExpiresSoon(now))
+          usable.emplace_back(intro);
         if (intro.expiresAt > m_NextIntro.expiresAt)
           m_NextIntro = intro;
       }
+      if (not usable.empty())
+        m_NextIntro = usable[randint() % usable.size()];
     }
 
     OutboundContext::~OutboundContext() = default;
@@ -204,6 +213,7 @@ namespace llarp
           currentConvoTag,
           t);
 
+      ex->handshakes = &m_Endpoint->Handshakes();
       ex->hook = std::bind(&OutboundContext::Send, shared_from_this(), std::placeholders::_1, path);
 
       ex->msg.PutBuffer(payload);
@@ -252,11 +262,18 @@ namespace llarp
       obj["sessionCreatedAt"] = to_json(createdAt);
       obj["lastGoodSend"] = to_json(lastGoodSend);
       obj["seqno"] = sequenceNo;
+      obj["repairs"] = m_Repair.Repairs();
+      obj["bundled"] = m_Bundled.load();
+      obj["compressed"] = m_Compression.Compressed();
+      obj["compressionBypassed"] = m_Compression.Bypassed();
       obj["markedBad"] = markedBad;
       obj["lastShift"] = to_json(lastShift);
       obj["remoteIdentity"] = remoteIdent.Addr().ToString();
       obj["currentRemoteIntroset"] = currentIntroSet.ExtractStatus();
       obj["nextIntro"] = m_NextIntro.ExtractStatus();
+      if (const auto backup = BackupIntro(Now()))
+        obj["backupIntro"] = backup->ExtractStatus();
+      obj["failOvers"] = m_FailOvers;
 
       std::transform(
           m_BadIntros.begin(),
@@ -294,6 +311,30 @@ namespace llarp
       }
       // lookup router in intro if set and unknown
       m_Endpoint->EnsureRouterIsKnown(remoteIntro.router);
+      // keep a path up to every intro we spread traffic over
+      if (m_Endpoint->MultipathWidth() > 1 and not BuildCooldownHit(now)
+          and NumInStatus(path::ePathBuilding) == 0)
+      {
+        for (const auto& intro : StripeIntros(now))
+        {
+          if (GetPathByRouter(intro.router))
+            continue;
+          m_Endpoint->EnsureRouterIsKnown(intro.router);
+          BuildOneAlignedTo(intro.router);
+          break;
+        }
+      }
+      // once traffic flows keep a path up to a backup intro too
+      if (lastGoodSend > 0s and not BuildCooldownHit(now)
+          and NumInStatus(path::ePathBuilding) == 0)
+      {
+        const auto backup = BackupIntro(now);
+        if (backup and not GetPathByRouter(backup->router))
+        {
+          m_Endpoint->EnsureRouterIsKnown(backup->router);
+          BuildOneAlignedTo(backup->router);
+        }
+      }
       // expire bad intros
       auto itr = m_BadIntros.begin();
       while (itr != m_BadIntros.end())
@@ -384,6 +425,8 @@ namespace llarp
     {
       // insert bad intro
       m_BadIntros[intro] = now;
+      if (intro == remoteIntro and FailOver(now))
+        return true;
       // try shifting intro without rebuild
       if (ShiftIntroduction(false))
       {
@@ -409,6 +452,94 @@ namespace llarp
       return false;
     }
 
+    std::vector<Introduction>
+    OutboundContext::StripeIntros(llarp_time_t now) const
+    {
+      std::vector<Introduction> intros;
+      for (const auto& intro : currentIntroSet.I)
+      {
+        if (intro == remoteIntro or intro.ExpiresSoon(now) or m_BadIntros.count(intro)
+            or m_Endpoint->SnodeBlacklist().count(intro.router))
+          continue;
+        intros.emplace_back(intro);
+      }
+      std::sort(intros.begin(), intros.end(), [](const auto& left, const auto& right) {
+        return left.latency < right.latency;
+      });
+      intros.insert(intros.begin(), remoteIntro);
+      intros.resize(std::min(intros.size(), m_Endpoint->MultipathWidth()));
+      return intros;
+    }
+
+    std::optional<Introduction>
+    OutboundContext::BackupIntro(llarp_time_t now) const
+    {
+      std::optional<Introduction> best;
+      for (const auto& intro : currentIntroSet.I)
+      {
+        if (intro.router == remoteIntro.router or intro.ExpiresSoon(now)
+            or m_BadIntros.count(intro) or m_Endpoint->SnodeBlacklist().count(intro.router))
+          continue;
+        if (not best or intro.latency < best->latency
+            or (intro.latency == best->latency and intro.expiresAt > best->expiresAt))
+          best = intro;
+      }
+      return best;
+    }
+
+    bool
+    OutboundContext::FailOver(llarp_time_t now)
+    {
+      const auto backup = BackupIntro(now);
+      if (not backup or GetPathByRouter(backup->router) == nullptr)
+        return false;
+      LogInfo(Name(), " failing over to ", RouterID(backup->router));
+      m_NextIntro = *backup;
+      // counts as a shift so SwapIntros does not move us straight off it again
+      lastShift = now;
+      m_FailOvers++;
+      SwapIntros();
+      return true;
+    }
+
+    std::optional<llarp_time_t>
+    OutboundContext::RoundTrip() const
+    {
+      if (not ReadyToSend() or remoteIntro.latency == 0s)
+        return std::nullopt;
+      const auto path = GetPathByRouter(remoteIntro.router);
+      if (path == nullptr or path->intro.latency == 0s)
+        return std::nullopt;
+      return path->intro.latency + remoteIntro.latency;
+    }
+
+    bool
+    OutboundContext::PickStripe(Introduction& remote, path::Path_ptr& path)
+    {
+      std::vector<std::pair<Introduction, path::Path_ptr>> stripes;
+      std::vector<double> weights;
+      double total = 0;
+      for (const auto& intro : StripeIntros(Now()))
+      {
+        auto best = GetPathByRouter(intro.router);
+        if (best == nullptr)
+          continue;
+        // their side of the path counts as much as ours
+        weights.emplace_back(1.0 / (best->Cost() + std::max<double>(intro.latency.count(), 1)));
+        total += weights.back();
+        stripes.emplace_back(intro, std::move(best));
+      }
+      if (stripes.size() < 2)
+        return false;
+      double pick = total * double(randint() >> 11) / double(uint64_t{1} << 53);
+      size_t idx = 0;
+      while (idx + 1 < stripes.size() and pick >= weights[idx])
+        pick -= weights[idx++];
+      remote = stripes[idx].first;
+      path = std::move(stripes[idx].second);
+      return true;
+    }
+
     bool
     OutboundContext::ShiftIntroduction(bool rebuild)
     {
@@ -506,7 +637,9 @@ namespace llarp
         else if (num == 0)
         {
           // we have no paths to this router right now
-          // hop off it
+          // hop off it, onto the backup if its path is up
+          if (FailOver(Now()))
+            return;
           Introduction picked;
           // get the latest intro that isn't on that endpoint
           for (const auto& intro : currentIntroSet.I)
@@ -5,6 +5,7 @@
 #include <service/sendcontext.hpp>
 #include <util/status.hpp>
 
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -67,10 +68,20 @@ namespace llarp
       bool
       MarkIntroBad(const Introduction& marked, llarp_time_t now);
 
+      /// spread frames over the best few remote intros we have paths to, weighted by how fast
+      /// our path and their intro path are
+      bool
+      PickStripe(Introduction& remote, path::Path_ptr& path) override;
+
       /// return true if we are ready to send
       bool
       ReadyToSend() const;
 
+      /// round trip to the remote over our path to remoteIntro and its path, nullopt while
+      /// either is not measured yet
+      std::optional<llarp_time_t>
+      RoundTrip() const;
+
       /// for exits
       void
       SendPacketToRemote(const llarp_buffer_t&) override;
@@ -128,6 +139,21 @@ namespace llarp
       void
       SwapIntros();
 
+      /// remoteIntro and then the lowest latency good intros, up to the endpoint's multipath
+      /// width
+      std::vector<Introduction>
+      StripeIntros(llarp_time_t now) const;
+
+      /// the lowest latency good intro on a router other than remoteIntro's. once traffic
+      /// flows we keep a path up to it, so losing remoteIntro does not wait on a build
+      std::optional<Introduction>
+      BackupIntro(llarp_time_t now) const;
+
+      /// move to the backup intro right away if we have a ready path to it, return true if we
+      /// did
+      bool
+      FailOver(llarp_time_t now);
+
       void
       OnGeneratedIntroFrame(AsyncKeyExchange* k, PathID_t p);
 
@@ -144,6 +170,7 @@ namespace llarp
       uint16_t m_BuildFails = 0;
       llarp_time_t m_LastInboundTraffic = 0s;
       bool m_GotInboundTraffic = false;
+      uint64_t m_FailOvers = 0;
     };
   }  // namespace service
 
@@ -3,23 +3,55 @@
 
 #include <service/protocol.hpp>
 #include <util/buffer.hpp>
+#include <util/histogram.hpp>
+#include <util/time.hpp>
 
 #include <algorithm>
-#include <iterator>
+#include <deque>
 #include <vector>
 
 namespace llarp
 {
   namespace service
   {
+    /// payload buffers of pending traffic that went out, kept for reuse so a burst waiting on a
+    /// session does not allocate per packet
+    struct PendingBufferPool
+    {
+      static constexpr size_t MaxFree = 256;
+
+      std::vector<byte_t>
+      Take()
+      {
+        if (m_Free.empty())
+          return {};
+        auto buf = std::move(m_Free.back());
+        m_Free.pop_back();
+        return buf;
+      }
+
+      void
+      Give(std::vector<byte_t> buf)
+      {
+        if (m_Free.size() < MaxFree)
+          m_Free.emplace_back(std::move(buf));
+      }
+
+     private:
+      std::vector<std::vector<byte_t>> m_Free;
+    };
+
     struct PendingBuffer
     {
       std::vector<byte_t> payload;
       ProtocolType protocol;
+      llarp_time_t queued;
 
-      PendingBuffer(const llarp_buffer_t& buf, ProtocolType t) : payload(buf.sz), protocol(t)
+      PendingBuffer(
+          std::vector<byte_t> storage, const llarp_buffer_t& buf, ProtocolType t, llarp_time_t now)
+          : payload(std::move(storage)), protocol(t), queued(now)
       {
-        std::copy(buf.base, buf.base + buf.sz, std::back_inserter(payload));
+        payload.assign(buf.base, buf.base + buf.sz);
       }
 
       ManagedBuffer
@@ -28,6 +60,76 @@ namespace llarp
         return ManagedBuffer{llarp_buffer_t(payload)};
       }
     };
+
+    /// traffic to one remote waiting on a session to it. holds at most MaxSize packets, the
+    /// oldest make room for the newest, and what waited longer than MaxWait by the time the
+    /// session is up is dropped rather than sent stale, like codel would
+    struct PendingBufferQueue
+    {
+      static constexpr size_t MaxSize = 64;
+      static constexpr auto MaxWait = 5s;
+
+      /// false if the oldest packet was dropped to make room
+      bool
+      Push(const llarp_buffer_t& buf, ProtocolType t, llarp_time_t now, PendingBufferPool& pool)
+      {
+        bool dropped = false;
+        if (m_Pkts.size() >= MaxSize)
+        {
+          pool.Give(std::move(m_Pkts.front().payload));
+          m_Pkts.pop_front();
+          dropped = true;
+        }
+        m_Pkts.emplace_back(pool.Take(), buf, t, now);
+        return not dropped;
+      }
+
+      /// hand each packet that is still fresh to send in order, return how many were stale
+      template <typename Send_t>
+      size_t
+      Drain(llarp_time_t now, PendingBufferPool& pool, util::DurationHistogram& waits, Send_t send)
+      {
+        size_t stale = 0;
+        for (auto& pkt : m_Pkts)
+        {
+          const auto waited = now - pkt.queued;
+          waits.Add(waited);
+          if (waited > MaxWait)
+            stale++;
+          else
+            send(pkt);
+          pool.Give(std::move(pkt.payload));
+        }
+        m_Pkts.clear();
+        return stale;
+      }
+
+      /// let everything go unsent, return how many that was
+      size_t
+      Clear(PendingBufferPool& pool)
+      {
+        const size_t num = m_Pkts.size();
+        for (auto& pkt : m_Pkts)
+          pool.Give(std::move(pkt.payload));
+        m_Pkts.clear();
+        return num;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Pkts.empty();
+      }
+
+      size_t
+      size() const
+      {
+        return m_Pkts.size();
+      }
+
+     private:
+      std::deque<PendingBuffer> m_Pkts;
+    };
   }  // namespace service
 
 }  // namespace llarp
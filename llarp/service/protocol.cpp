@@ -1,10 +1,12 @@
 #include <service/protocol.hpp>
 #include <path/path.hpp>
 #include <routing/handler.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/buffer.hpp>
 #include <util/mem.hpp>
 #include <util/meta/memfn.hpp>
 #include <util/thread/logic.hpp>
+#include <service/compress.hpp>
 #include <service/endpoint.hpp>
 #include <router/abstractrouter.hpp>
 #include <utility>
@@ -26,8 +28,13 @@ namespace llarp
     void
     ProtocolMessage::PutBuffer(const llarp_buffer_t& buf)
     {
-      payload.resize(buf.sz);
-      memcpy(payload.data(), buf.base, buf.sz);
+      payload.assign(buf.base, buf.base + buf.sz);
+    }
+
+    std::shared_ptr<ProtocolMessage>
+    ProtocolMessage::MakePooled()
+    {
+      return std::allocate_shared<ProtocolMessage>(util::PoolAllocator<ProtocolMessage>{});
     }
 
     void
@@ -143,6 +150,11 @@ namespace llarp
       }
       if (!BEncodeWriteDictEntry("F", F, buf))
         return false;
+      if (!H.IsZero())
+      {
+        if (!BEncodeWriteDictEntry("H", H, buf))
+          return false;
+      }
       if (!N.IsZero())
       {
         if (!BEncodeWriteDictEntry("N", N, buf))
@@ -184,6 +196,8 @@ namespace llarp
         return false;
       if (!BEncodeMaybeReadDictEntry("C", C, read, key, val))
         return false;
+      if (!BEncodeMaybeReadDictEntry("H", H, read, key, val))
+        return false;
       if (!BEncodeMaybeReadDictEntry("N", N, read, key, val))
         return false;
       if (!BEncodeMaybeReadDictInt("S", S, read, key, val))
@@ -199,13 +213,33 @@ namespace llarp
       return read;
     }
 
+    /// put a compressed payload back as the message it was, before anything looks at its proto
+    static bool
+    ExpandPayload(ProtocolMessage& msg)
+    {
+      if (msg.proto != eProtocolCompressed)
+        return true;
+      if (Compression::Decompress(msg.payload.data(), msg.payload.size(), msg.proto, msg.payload))
+        return true;
+      LogError("bad compressed payload from ", msg.sender.Addr());
+      return false;
+    }
+
     bool
     ProtocolFrame::DecryptPayloadInto(const SharedSecret& sharedkey, ProtocolMessage& msg) const
     {
       Encrypted_t tmp = D;
       auto buf = tmp.Buffer();
       CryptoManager::instance()->xchacha20(*buf, sharedkey, N);
-      return bencode_decode_dict(msg, buf);
+      return bencode_decode_dict(msg, buf) and ExpandPayload(msg);
+    }
+
+    bool
+    ProtocolFrame::DecryptPayloadInPlace(const SharedSecret& sharedkey, ProtocolMessage& msg)
+    {
+      auto buf = D.Buffer();
+      CryptoManager::instance()->xchacha20(*buf, sharedkey, N);
+      return bencode_decode_dict(msg, buf) and ExpandPayload(msg);
     }
 
     bool
@@ -228,8 +262,7 @@ namespace llarp
     }
 
     bool
-    ProtocolFrame::EncryptAndSign(
-        const ProtocolMessage& msg, const SharedSecret& sessionKey, const Identity& localIdent)
+    ProtocolFrame::EncryptPayload(const ProtocolMessage& msg, const SharedSecret& sessionKey)
     {
       std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
       llarp_buffer_t buf(tmp);
@@ -246,21 +279,17 @@ namespace llarp
       CryptoManager::instance()->xchacha20(buf, sessionKey, N);
       // put encrypted buffer
       D = buf;
-      // zero out signature
-      Z.Zero();
-      llarp_buffer_t buf2(tmp);
-      // encode frame
-      if (!BEncode(&buf2))
-      {
-        LogError("frame too big to encode");
-        DumpBuffer(buf2);
+      return true;
+    }
+
+    bool
+    ProtocolFrame::EncryptAndSign(
+        const ProtocolMessage& msg, const SharedSecret& sessionKey, const Identity& localIdent)
+    {
+      H.Zero();
+      if (not EncryptPayload(msg, sessionKey))
         return false;
-      }
-      // rewind
-      buf2.sz = buf2.cur - buf2.base;
-      buf2.cur = buf2.base;
-      // sign
-      if (!localIdent.Sign(Z, buf2))
+      if (not Sign(localIdent))
       {
         LogError("failed to sign? wtf?!");
         return false;
@@ -268,6 +297,41 @@ namespace llarp
       return true;
     }
 
+    bool
+    ProtocolFrame::EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sessionKey)
+    {
+      Z.Zero();
+      H.Zero();
+      if (not EncryptPayload(msg, sessionKey))
+        return false;
+      ShortHash mac;
+      if (not ComputeMAC(mac, sessionKey))
+        return false;
+      H = mac;
+      return true;
+    }
+
+    bool
+    ProtocolFrame::ComputeMAC(ShortHash& mac, const SharedSecret& sessionKey) const
+    {
+      // the fields that mean anything on an established convo laid end to end, cheaper than
+      // encoding a copy of the frame. C is only ever set on intros, which are signed
+      if (not C.IsZero())
+        return false;
+      std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+      llarp_buffer_t buf(tmp);
+      if (not(buf.write(N.begin(), N.end()) and buf.write(T.begin(), T.end())
+              and buf.write(F.begin(), F.end()) and buf.put_uint64(R)
+              and buf.put_uint64(version) and buf.write(D.data(), D.data() + D.size())))
+      {
+        LogError("frame too big to authenticate");
+        return false;
+      }
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      return CryptoManager::instance()->hmac(mac.data(), buf, sessionKey);
+    }
+
     struct AsyncFrameDecrypt
     {
       path::Path_ptr path;
@@ -301,7 +365,9 @@ namespace llarp
         SharedSecret sharedKey;
         // copy
         ProtocolFrame frame(self->frame);
-        if (!crypto->pqe_decrypt(self->frame.C, K, pq_keypair_to_secret(self->m_LocalIdentity.pq)))
+        auto& handshakes = self->handler->Handshakes();
+        const auto now = time_now_ms();
+        if (not handshakes.Decapsulate(self->frame.C, K, self->m_LocalIdentity.pq, now))
         {
           LogError("pqke failed C=", self->frame.C);
           self->msg.reset();
@@ -341,10 +407,8 @@ namespace llarp
 
         // PKE (A, B, N)
         SharedSecret sharedSecret;
-        path_dh_func dh_server = util::memFn(&Crypto::dh_server, CryptoManager::instance());
-
-        if (!self->m_LocalIdentity.KeyExchange(
-                dh_server, sharedSecret, self->msg->sender, self->frame.N))
+        if (not handshakes.ServerDH(
+                sharedSecret, self->m_LocalIdentity, self->msg->sender, self->frame.N, now))
         {
           LogError("x25519 key exchange failed");
           Dump<MAX_PROTOCOL_MESSAGE_SIZE>(self->frame);
@@ -392,6 +456,7 @@ namespace llarp
       F = other.F;
       N = other.N;
       Z = other.Z;
+      H = other.H;
       T = other.T;
       R = other.R;
       S = other.S;
@@ -399,12 +464,29 @@ namespace llarp
       return *this;
     }
 
-    struct AsyncDecrypt
+    void
+    AsyncDecrypt::Work(Endpoint* handler)
     {
-      ServiceInfo si;
-      SharedSecret shared;
-      ProtocolFrame frame;
-    };
+      const bool authed = frame.H.IsZero() ? frame.Verify(si) : frame.VerifyMAC(shared);
+      if (not authed)
+      {
+        LogError("Signature failure from ", si.Addr());
+        return;
+      }
+      auto msg = ProtocolMessage::MakePooled();
+      msg->handler = handler;
+      // the frame is ours and goes with this item, so it is opened where it sits
+      if (not frame.DecryptPayloadInPlace(shared, *msg))
+      {
+        LogError("failed to decrypt message");
+        return;
+      }
+      RecvDataEvent ev;
+      ev.fromPath = std::move(fromPath);
+      ev.pathid = frame.F;
+      ev.msg = std::move(msg);
+      handler->QueueRecvData(std::move(ev));
+    }
 
     bool
     ProtocolFrame::AsyncDecryptAndVerify(
@@ -413,11 +495,12 @@ namespace llarp
         const Identity& localIdent,
         Endpoint* handler) const
     {
-      auto msg = std::make_shared<ProtocolMessage>();
-      msg->handler = handler;
+      alloc::Scope allocScope{alloc::ServiceFrames};
       if (T.IsZero())
       {
         LogInfo("Got protocol frame with new convo");
+        auto msg = ProtocolMessage::MakePooled();
+        msg->handler = handler;
         // we need to dh
         auto dh = std::make_shared<AsyncFrameDecrypt>(
             logic, localIdent, handler, msg, *this, recvPath->intro);
@@ -426,45 +509,29 @@ namespace llarp
         return true;
       }
 
-      auto v = std::make_shared<AsyncDecrypt>();
-
-      if (!handler->GetCachedSessionKeyFor(T, v->shared))
+      AsyncDecrypt item;
+      if (!handler->GetCachedSessionKeyFor(T, item.shared))
       {
         LogError("No cached session for T=", T);
         return false;
       }
 
-      if (!handler->GetSenderFor(T, v->si))
+      if (!handler->GetSenderFor(T, item.si))
       {
         LogError("No sender for T=", T);
         return false;
       }
-      v->frame = *this;
-      handler->Router()->QueueWork([v, msg = std::move(msg), recvPath = std::move(recvPath)]() {
-        if (not v->frame.Verify(v->si))
-        {
-          LogError("Signature failure from ", v->si.Addr());
-          return;
-        }
-        if (not v->frame.DecryptPayloadInto(v->shared, *msg))
-        {
-          LogError("failed to decrypt message");
-          return;
-        }
-        RecvDataEvent ev;
-        ev.fromPath = std::move(recvPath);
-        ev.pathid = v->frame.F;
-        ev.msg = std::move(msg);
-        msg->handler->QueueRecvData(std::move(ev));
-      });
+      item.frame = *this;
+      item.fromPath = std::move(recvPath);
+      handler->QueueDecrypt(std::move(item));
       return true;
     }
 
     bool
     ProtocolFrame::operator==(const ProtocolFrame& other) const
     {
-      return C == other.C && D == other.D && N == other.N && Z == other.Z && T == other.T
-          && S == other.S && version == other.version;
+      return C == other.C && D == other.D && N == other.N && Z == other.Z && H == other.H
+          && T == other.T && S == other.S && version == other.version;
     }
 
     bool
@@ -490,6 +557,15 @@ namespace llarp
       return svc.Verify(buf, Z);
     }
 
+    bool
+    ProtocolFrame::VerifyMAC(const SharedSecret& sharedkey) const
+    {
+      ShortHash mac;
+      if (not ComputeMAC(mac, sharedkey))
+        return false;
+      return mac == H;
+    }
+
     bool
     ProtocolFrame::HandleMessage(routing::IMessageHandler* h, AbstractRouter* /*r*/) const
     {
@@ -11,9 +11,11 @@
 #include <service/intro.hpp>
 #include <service/handler.hpp>
 #include <util/bencode.hpp>
+#include <util/pool.hpp>
 #include <util/time.hpp>
 #include <path/pathset.hpp>
 
+#include <memory>
 #include <vector>
 
 struct llarp_threadpool;
@@ -42,13 +44,25 @@ namespace llarp
       ~ProtocolMessage();
       ProtocolType proto = eProtocolTrafficV4;
       llarp_time_t queued = 0s;
-      std::vector<byte_t> payload;
+      /// one is made for every packet we get and send, so its storage is recycled
+      util::PooledVector<byte_t> payload;
       Introduction introReply;
       ServiceInfo sender;
       Endpoint* handler = nullptr;
       ConvoTag tag;
       uint64_t seqno = 0;
-      uint64_t version = LLARP_PROTO_VERSION;
+      /// not sent, set when the path it came down was congested so traffic in it is handed
+      /// on marked congestion experienced
+      bool congested = false;
+      /// from this version on the sender takes frames authenticated with a keyed hash
+      static constexpr uint64_t MACFramesVersion = 1;
+      /// from this version on the sender takes repair messages
+      static constexpr uint64_t RepairFramesVersion = 2;
+      /// from this version on the sender takes bundles of packets
+      static constexpr uint64_t BundleVersion = 3;
+      /// from this version on the sender takes compressed payloads
+      static constexpr uint64_t CompressionVersion = 4;
+      uint64_t version = CompressionVersion;
 
       /// encode metainfo for lmq endpoint auth
       std::vector<char>
@@ -66,6 +80,11 @@ namespace llarp
       static void
       ProcessAsync(path::Path_ptr p, PathID_t from, std::shared_ptr<ProtocolMessage> self);
 
+      /// a message made with its shared_ptr's count in one block from util::PoolAlloc rather
+      /// than the heap
+      static std::shared_ptr<ProtocolMessage>
+      MakePooled();
+
       bool
       operator<(const ProtocolMessage& other) const
       {
@@ -82,6 +101,8 @@ namespace llarp
       uint64_t R;
       KeyExchangeNonce N;
       Signature Z;
+      /// keyed hash under the convo key, in place of Z on frames of an established convo
+      ShortHash H;
       PathID_t F;
       service::ConvoTag T;
 
@@ -92,6 +113,7 @@ namespace llarp
           , R(other.R)
           , N(other.N)
           , Z(other.Z)
+          , H(other.H)
           , F(other.F)
           , T(other.T)
       {
@@ -125,6 +147,11 @@ namespace llarp
       bool
       Sign(const Identity& localIdent);
 
+      /// encrypt like EncryptAndSign but authenticate with a keyed hash rather than a signature,
+      /// for convos whose remote told us it takes those
+      bool
+      EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sharedkey);
+
       bool
       AsyncDecryptAndVerify(
           std::shared_ptr<Logic> logic,
@@ -132,9 +159,15 @@ namespace llarp
           const Identity& localIdent,
           Endpoint* handler) const;
 
+      /// decrypt and decode the message in D, with a compressed payload put back as it was
       bool
       DecryptPayloadInto(const SharedSecret& sharedkey, ProtocolMessage& into) const;
 
+      /// DecryptPayloadInto without copying D first, for a frame of our own that is done with
+      /// once its message is out. D holds the plaintext after
+      bool
+      DecryptPayloadInPlace(const SharedSecret& sharedkey, ProtocolMessage& into);
+
       bool
       DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* val) override;
 
@@ -156,6 +189,7 @@ namespace llarp
         T.Zero();
         N.Zero();
         Z.Zero();
+        H.Zero();
         R = 0;
         version = LLARP_PROTO_VERSION;
       }
@@ -163,8 +197,33 @@ namespace llarp
       bool
       Verify(const ServiceInfo& from) const;
 
+      bool
+      VerifyMAC(const SharedSecret& sharedkey) const;
+
       bool
       HandleMessage(routing::IMessageHandler* h, AbstractRouter* r) const override;
+
+     private:
+      bool
+      EncryptPayload(const ProtocolMessage& msg, const SharedSecret& sharedkey);
+
+      /// keyed hash of what the frame says on an established convo
+      bool
+      ComputeMAC(ShortHash& mac, const SharedSecret& sharedkey) const;
+    };
+
+    /// a frame on an established convo with what we need to check and open it off the logic
+    /// thread
+    struct AsyncDecrypt
+    {
+      ServiceInfo si;
+      SharedSecret shared;
+      ProtocolFrame frame;
+      path::Path_ptr fromPath;
+
+      /// check the frame and queue what is in it to handler, on a worker
+      void
+      Work(Endpoint* handler);
     };
   }  // namespace service
 }  // namespace llarp
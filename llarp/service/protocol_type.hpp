@@ -11,4 +11,12 @@ namespace llarp::service
   constexpr ProtocolType eProtocolTrafficV6 = 2UL;
   constexpr ProtocolType eProtocolExit = 3UL;
   constexpr ProtocolType eProtocolAuth = 4UL;
+  /// app buffers behind a ChannelHeader, between embedded endpoints
+  constexpr ProtocolType eProtocolEmbedded = 5UL;
+  /// the xor of a group of messages, to rebuild one of them that got lost, see RepairEncoder
+  constexpr ProtocolType eProtocolRepair = 6UL;
+  /// several ip packets packed into one message, see Bundle
+  constexpr ProtocolType eProtocolBundle = 7UL;
+  /// another message's payload lz4 compressed, see Compression
+  constexpr ProtocolType eProtocolCompressed = 8UL;
 }  // namespace llarp::service
@@ -0,0 +1,210 @@
+#include <service/reliable_stream.hpp>
+
+#include <util/endian.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace service
+  {
+    void
+    StreamAck::Encode(byte_t* out) const
+    {
+      htobe32buf(out, next);
+      htobe64buf(out + 4, sacks);
+    }
+
+    std::optional<StreamAck>
+    StreamAck::Decode(const llarp_buffer_t& buf)
+    {
+      if (buf.sz < Size)
+        return std::nullopt;
+      StreamAck ack;
+      ack.next = bufbe32toh(buf.base);
+      ack.sacks = bufbe64toh(buf.base + 4);
+      return ack;
+    }
+
+    bool
+    ReliableSender::Queue(std::vector<byte_t> data)
+    {
+      if (m_Failed or m_InFlight.size() + m_Unsent.size() >= MaxQueued)
+        return false;
+      m_Unsent.emplace_back(std::move(data));
+      return true;
+    }
+
+    llarp_time_t
+    ReliableSender::Timeout() const
+    {
+      llarp_time_t timeout = 1s;
+      if (m_SmoothedRTT > 0s)
+        timeout = std::clamp(
+            m_SmoothedRTT + 4 * m_RTTVar, llarp_time_t{MinTimeout}, llarp_time_t{MaxTimeout});
+      for (uint32_t idx = 0; idx < m_Backoff and timeout < MaxTimeout; ++idx)
+        timeout *= 2;
+      return std::min(timeout, llarp_time_t{MaxTimeout});
+    }
+
+    std::vector<uint32_t>
+    ReliableSender::TakeDue(llarp_time_t now)
+    {
+      std::vector<uint32_t> due;
+      if (m_Failed)
+        return due;
+      const auto timeout = Timeout();
+      bool timedOut = false;
+      for (auto& [seqno, segment] : m_InFlight)
+      {
+        if (not segment.lost and segment.sent + timeout <= now)
+        {
+          segment.lost = true;
+          timedOut = true;
+        }
+      }
+      if (timedOut)
+        OnLoss(true);
+      for (auto& [seqno, segment] : m_InFlight)
+      {
+        if (not segment.lost)
+          continue;
+        if (segment.tries >= MaxTries)
+        {
+          m_Failed = true;
+          return {};
+        }
+        segment.lost = false;
+        segment.sent = now;
+        segment.tries++;
+        m_Resent++;
+        due.push_back(seqno);
+      }
+      while (m_InFlight.size() < Window() and not m_Unsent.empty())
+      {
+        auto& segment = m_InFlight[m_NextSeqno];
+        segment.data = std::move(m_Unsent.front());
+        segment.sent = now;
+        segment.tries = 1;
+        m_Unsent.pop_front();
+        m_Sent++;
+        due.push_back(m_NextSeqno++);
+      }
+      return due;
+    }
+
+    void
+    ReliableSender::AddRTTSample(llarp_time_t rtt)
+    {
+      if (m_SmoothedRTT == 0s)
+      {
+        m_SmoothedRTT = rtt;
+        m_RTTVar = rtt / 2;
+        return;
+      }
+      const auto diff = rtt > m_SmoothedRTT ? rtt - m_SmoothedRTT : m_SmoothedRTT - rtt;
+      m_RTTVar = (m_RTTVar * 3 + diff) / 4;
+      m_SmoothedRTT = (m_SmoothedRTT * 7 + rtt) / 8;
+    }
+
+    void
+    ReliableSender::OnLoss(bool timeout)
+    {
+      if (timeout)
+        m_Backoff++;
+      // losses from the window already cut for count once
+      if (not m_InFlight.empty() and m_InFlight.begin()->first < m_RecoverUntil)
+        return;
+      m_Window = std::max(m_Window * LossBackoff, 2.0);
+      m_SlowStartThreshold = m_Window;
+      m_RecoverUntil = m_NextSeqno;
+    }
+
+    void
+    ReliableSender::HandleAck(const StreamAck& ack, llarp_time_t now)
+    {
+      size_t acked = 0;
+      const auto take = [&](std::map<uint32_t, Segment>::iterator itr) {
+        // only a segment sent once gives a clean rtt, karn's rule
+        if (itr->second.tries == 1)
+          AddRTTSample(now - itr->second.sent);
+        acked++;
+        return m_InFlight.erase(itr);
+      };
+      auto itr = m_InFlight.begin();
+      while (itr != m_InFlight.end() and itr->first < ack.next)
+        itr = take(itr);
+      std::optional<uint32_t> highest;
+      if (ack.next > 0)
+        highest = ack.next - 1;
+      for (uint32_t bit = 0; bit < 64; ++bit)
+      {
+        if (not(ack.sacks & (uint64_t{1} << bit)))
+          continue;
+        const uint32_t seqno = ack.next + 1 + bit;
+        highest = seqno;
+        const auto found = m_InFlight.find(seqno);
+        if (found != m_InFlight.end())
+          take(found);
+      }
+      if (acked == 0)
+        return;
+      m_Backoff = 0;
+
+      // a segment overtaken by the acks of enough later ones is lost, once it has been out
+      // long enough for a resend of it to have got there
+      bool lost = false;
+      for (auto& [seqno, segment] : m_InFlight)
+      {
+        if (not highest or seqno + ReorderThreshold > *highest)
+          break;
+        if (not segment.lost and now - segment.sent >= m_SmoothedRTT)
+        {
+          segment.lost = true;
+          lost = true;
+        }
+      }
+      if (lost)
+      {
+        OnLoss(false);
+        return;
+      }
+      for (size_t idx = 0; idx < acked; ++idx)
+      {
+        if (m_Window < m_SlowStartThreshold)
+          m_Window += 1;
+        else
+          m_Window += 1 / m_Window;
+      }
+      m_Window = std::min(m_Window, MaxWindow);
+    }
+
+    util::StatusObject
+    ReliableSender::ExtractStatus() const
+    {
+      return util::StatusObject{{"window", Window()},
+                                {"inFlight", m_InFlight.size()},
+                                {"queued", m_Unsent.size()},
+                                {"rtt", to_json(m_SmoothedRTT)},
+                                {"sent", m_Sent},
+                                {"resent", m_Resent},
+                                {"failed", m_Failed}};
+    }
+
+    StreamAck
+    ReliableReceiver::TakeAck()
+    {
+      m_Unacked = 0;
+      StreamAck ack;
+      ack.next = m_Next;
+      for (const auto& item : m_Held)
+      {
+        const uint32_t bit = item.first - m_Next - 1;
+        if (bit >= 64)
+          break;
+        ack.sacks |= uint64_t{1} << bit;
+      }
+      return ack;
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,197 @@
+#ifndef LLARP_SERVICE_RELIABLE_STREAM_HPP
+#define LLARP_SERVICE_RELIABLE_STREAM_HPP
+
+#include <util/buffer.hpp>
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// what the receiving end of a reliable stream sends back: every segment before next
+    /// arrived, and so did next + 1 + i for each bit i set in sacks
+    struct StreamAck
+    {
+      static constexpr size_t Size = 12;
+
+      uint32_t next = 0;
+      uint64_t sacks = 0;
+
+      void
+      Encode(byte_t* out) const;
+
+      static std::optional<StreamAck>
+      Decode(const llarp_buffer_t& buf);
+    };
+
+    /// the sending end of a reliable stream. segments go out as the congestion window
+    /// allows, the ones the acks show lost are sent again on their own. the window grows
+    /// like tcp's but a loss only takes a quarter off it, as onion paths drop cells for
+    /// reasons other than congestion and tcp inside a tun backs off far more than it needs to
+    struct ReliableSender
+    {
+      static constexpr double InitialWindow = 8;
+      static constexpr double MaxWindow = 1024;
+      /// what is left of the window after a loss
+      static constexpr double LossBackoff = 0.75;
+      /// acks for this many later segments and a segment not acked is taken as lost
+      static constexpr uint32_t ReorderThreshold = 3;
+      static constexpr auto MinTimeout = 300ms;
+      static constexpr auto MaxTimeout = 10s;
+      /// sends of one segment before the stream gives up
+      static constexpr uint32_t MaxTries = 8;
+      /// most segments waiting to go out or to be acked
+      static constexpr size_t MaxQueued = 4096;
+
+      /// queue a segment, false once too much is queued or the stream failed
+      bool
+      Queue(std::vector<byte_t> data);
+
+      /// call send(seqno, data) for every segment that may go out now, lost ones first
+      template <typename Send_t>
+      void
+      Flush(llarp_time_t now, Send_t&& send)
+      {
+        for (const auto seqno : TakeDue(now))
+          send(seqno, m_InFlight[seqno].data);
+      }
+
+      void
+      HandleAck(const StreamAck& ack, llarp_time_t now);
+
+      /// a segment went MaxTries times without an ack, nothing more goes
+      bool
+      Failed() const
+      {
+        return m_Failed;
+      }
+
+      /// nothing waiting or in flight
+      bool
+      Idle() const
+      {
+        return m_InFlight.empty() and m_Unsent.empty();
+      }
+
+      size_t
+      Window() const
+      {
+        return static_cast<size_t>(m_Window);
+      }
+
+      size_t
+      InFlight() const
+      {
+        return m_InFlight.size();
+      }
+
+      /// how long a segment goes unacked before it is sent again
+      llarp_time_t
+      Timeout() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Segment
+      {
+        std::vector<byte_t> data;
+        llarp_time_t sent = 0s;
+        uint32_t tries = 0;
+        bool lost = false;
+      };
+
+      /// seqnos of the segments to send now, marked as sent
+      std::vector<uint32_t>
+      TakeDue(llarp_time_t now);
+
+      void
+      OnLoss(bool timeout);
+
+      void
+      AddRTTSample(llarp_time_t rtt);
+
+      std::map<uint32_t, Segment> m_InFlight;
+      std::deque<std::vector<byte_t>> m_Unsent;
+      uint32_t m_NextSeqno = 0;
+      double m_Window = InitialWindow;
+      double m_SlowStartThreshold = MaxWindow;
+      /// the window is cut at most once for the losses of one window of segments
+      uint32_t m_RecoverUntil = 0;
+      llarp_time_t m_SmoothedRTT = 0s;
+      llarp_time_t m_RTTVar = 0s;
+      uint32_t m_Backoff = 0;
+      bool m_Failed = false;
+      uint64_t m_Sent = 0;
+      uint64_t m_Resent = 0;
+    };
+
+    /// the receiving end of a reliable stream, hands segments on in order and makes the acks
+    struct ReliableReceiver
+    {
+      /// segments held ahead of a gap, anything further ahead is dropped to be sent again
+      static constexpr uint32_t MaxAhead = 1024;
+
+      /// take segment seqno, calling deliver with every segment now in order. true if it
+      /// should be acked straight away rather than with the next one
+      template <typename Deliver_t>
+      bool
+      Push(uint32_t seqno, std::vector<byte_t> data, Deliver_t&& deliver)
+      {
+        m_Unacked++;
+        // already had it, its ack went missing
+        if (seqno < m_Next)
+          return true;
+        if (seqno >= m_Next + MaxAhead)
+          return true;
+        if (seqno > m_Next)
+        {
+          m_Held.emplace(seqno, std::move(data));
+          return true;
+        }
+        const bool filledGap = not m_Held.empty();
+        deliver(data);
+        m_Next++;
+        auto itr = m_Held.begin();
+        while (itr != m_Held.end() and itr->first == m_Next)
+        {
+          deliver(itr->second);
+          m_Next++;
+          itr = m_Held.erase(itr);
+        }
+        // the sender waits on a gap being filled, otherwise every other segment will do
+        return filledGap or m_Unacked >= 2;
+      }
+
+      /// the ack for everything so far
+      StreamAck
+      TakeAck();
+
+      bool
+      AckPending() const
+      {
+        return m_Unacked > 0;
+      }
+
+      size_t
+      Held() const
+      {
+        return m_Held.size();
+      }
+
+     private:
+      uint32_t m_Next = 0;
+      uint32_t m_Unacked = 0;
+      std::map<uint32_t, std::vector<byte_t>> m_Held;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
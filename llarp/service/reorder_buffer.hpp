@@ -0,0 +1,131 @@
+#ifndef LLARP_SERVICE_REORDER_BUFFER_HPP
+#define LLARP_SERVICE_REORDER_BUFFER_HPP
+
+#include <util/time.hpp>
+
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// puts one convo's messages back in seqno order when the sender spreads them over several
+    /// paths. messages that arrive ahead of a gap are held until the gap fills, until they have
+    /// waited MaxHold, or until MaxHeld are waiting, then the gap is given up on. anything
+    /// arriving after its turn is passed straight on, the tun sorts what it can from there.
+    /// Msg_ptr is a pointer to something with a uint64_t seqno
+    template <typename Msg_ptr>
+    struct ReorderBuffer
+    {
+      /// longest a message waits for the ones before it
+      static constexpr auto MaxHold = 100ms;
+      /// most messages we hold for one convo
+      static constexpr size_t MaxHeld = 128;
+
+      /// take msg, calling deliver with every message that is now in order
+      template <typename Deliver_t>
+      void
+      Push(Msg_ptr msg, llarp_time_t now, Deliver_t&& deliver)
+      {
+        m_LastPush = now;
+        const uint64_t seqno = msg->seqno;
+        if (m_Next == 0)
+          m_Next = seqno;
+        if (seqno < m_Next)
+        {
+          m_Late++;
+          deliver(msg);
+          return;
+        }
+        if (seqno > m_Next)
+        {
+          m_Held.emplace(seqno, std::make_pair(now, std::move(msg)));
+          if (m_Held.size() > MaxHeld)
+            SkipGap(deliver);
+          return;
+        }
+        deliver(msg);
+        m_Next++;
+        ReleaseInOrder(deliver);
+      }
+
+      /// give up on gaps that held messages have waited too long for
+      template <typename Deliver_t>
+      void
+      Expire(llarp_time_t now, Deliver_t&& deliver)
+      {
+        while (not m_Held.empty() and m_Held.begin()->second.first + MaxHold <= now)
+          SkipGap(deliver);
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Held.empty();
+      }
+
+      size_t
+      Held() const
+      {
+        return m_Held.size();
+      }
+
+      /// messages that came in after we had given up on them
+      uint64_t
+      Late() const
+      {
+        return m_Late;
+      }
+
+      /// gaps we gave up on
+      uint64_t
+      Skipped() const
+      {
+        return m_Skipped;
+      }
+
+      llarp_time_t
+      LastPush() const
+      {
+        return m_LastPush;
+      }
+
+     private:
+      template <typename Deliver_t>
+      void
+      SkipGap(Deliver_t&& deliver)
+      {
+        m_Skipped++;
+        m_Next = m_Held.begin()->first;
+        ReleaseInOrder(deliver);
+      }
+
+      template <typename Deliver_t>
+      void
+      ReleaseInOrder(Deliver_t&& deliver)
+      {
+        auto itr = m_Held.begin();
+        while (itr != m_Held.end() and itr->first <= m_Next)
+        {
+          // a duplicate of the one we just delivered goes too, the tun can sort it out
+          deliver(itr->second.second);
+          if (itr->first == m_Next)
+            m_Next++;
+          itr = m_Held.erase(itr);
+        }
+      }
+
+      /// next seqno we expect, 0 until the first message
+      uint64_t m_Next = 0;
+      /// held messages by seqno, with when they arrived
+      std::map<uint64_t, std::pair<llarp_time_t, Msg_ptr>> m_Held;
+      llarp_time_t m_LastPush = 0s;
+      uint64_t m_Late = 0;
+      uint64_t m_Skipped = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,139 @@
+#include <service/repair.hpp>
+
+#include <util/endian.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// the first seqno and the count in front of a repair payload
+    static constexpr size_t RepairHeaderSize = 8 + 1;
+    /// proto and length in front of each message as the xor has it
+    static constexpr size_t BlockHeaderSize = 1 + 2;
+
+    static void
+    XorInto(std::vector<byte_t>& into, const byte_t* data, size_t sz)
+    {
+      if (into.size() < sz)
+        into.resize(sz, 0);
+      for (size_t idx = 0; idx < sz; ++idx)
+        into[idx] ^= data[idx];
+    }
+
+    size_t
+    RepairEncoder::GroupSizeFor(double loss)
+    {
+      if (loss < MinLoss)
+        return 0;
+      // about one loss in four groups, which one repair each gets back
+      const auto group = static_cast<size_t>(0.25 / loss);
+      return std::clamp(group, MinGroup, MaxGroup);
+    }
+
+    void
+    RepairEncoder::Reset()
+    {
+      m_Offsets.clear();
+      m_Parity.clear();
+    }
+
+    std::optional<std::vector<byte_t>>
+    RepairEncoder::Add(
+        uint64_t seqno, ProtocolType proto, const llarp_buffer_t& payload, size_t groupSize)
+    {
+      if (payload.sz > 0xffff or proto > 0xff)
+        return std::nullopt;
+      // the offsets are one byte, a group that spans more starts over
+      if (not m_Offsets.empty() and (seqno <= m_First or seqno - m_First > 0xff))
+        Reset();
+      if (m_Offsets.empty())
+        m_First = seqno;
+      std::array<byte_t, BlockHeaderSize> header;
+      header[0] = proto;
+      htobe16buf(header.data() + 1, payload.sz);
+      XorInto(m_Parity, header.data(), header.size());
+      // the payload goes in after the header, lined up with the other blocks' payloads
+      if (m_Parity.size() < BlockHeaderSize + payload.sz)
+        m_Parity.resize(BlockHeaderSize + payload.sz, 0);
+      for (size_t idx = 0; idx < payload.sz; ++idx)
+        m_Parity[BlockHeaderSize + idx] ^= payload.base[idx];
+      m_Offsets.push_back(seqno - m_First);
+      if (m_Offsets.size() < std::clamp(groupSize, size_t{1}, MaxGroup))
+        return std::nullopt;
+
+      std::vector<byte_t> repair(RepairHeaderSize + m_Offsets.size() + m_Parity.size());
+      htobe64buf(repair.data(), m_First);
+      repair[8] = m_Offsets.size();
+      std::copy(m_Offsets.begin(), m_Offsets.end(), repair.begin() + RepairHeaderSize);
+      std::copy(
+          m_Parity.begin(), m_Parity.end(), repair.begin() + RepairHeaderSize + m_Offsets.size());
+      Reset();
+      m_Repairs++;
+      return repair;
+    }
+
+    bool
+    RepairDecoder::Keep(uint64_t seqno, ProtocolType proto, const llarp_buffer_t& payload)
+    {
+      if (m_Rebuilt.erase(seqno))
+        return false;
+      if (payload.sz > 0xffff or proto > 0xff)
+        return true;
+      std::vector<byte_t> block(BlockHeaderSize + payload.sz);
+      block[0] = proto;
+      htobe16buf(block.data() + 1, payload.sz);
+      std::copy(payload.begin(), payload.end(), block.begin() + BlockHeaderSize);
+      m_Kept[seqno] = std::move(block);
+      while (m_Kept.size() > MaxKept)
+        m_Kept.erase(m_Kept.begin());
+      return true;
+    }
+
+    std::optional<RepairedMessage>
+    RepairDecoder::Repair(const llarp_buffer_t& repair)
+    {
+      if (repair.sz < RepairHeaderSize)
+        return std::nullopt;
+      const uint64_t first = bufbe64toh(repair.base);
+      const size_t count = repair.base[8];
+      if (count == 0 or repair.sz < RepairHeaderSize + count + BlockHeaderSize)
+        return std::nullopt;
+      const byte_t* offsets = repair.base + RepairHeaderSize;
+      std::vector<byte_t> parity(repair.begin() + RepairHeaderSize + count, repair.end());
+
+      std::optional<uint64_t> missing;
+      for (size_t idx = 0; idx < count; ++idx)
+      {
+        const uint64_t seqno = first + offsets[idx];
+        const auto itr = m_Kept.find(seqno);
+        if (itr != m_Kept.end())
+        {
+          XorInto(parity, itr->second.data(), itr->second.size());
+          continue;
+        }
+        // one repair gets back one message
+        if (missing)
+          return std::nullopt;
+        missing = seqno;
+      }
+      if (not missing)
+        return std::nullopt;
+      const size_t sz = bufbe16toh(parity.data() + 1);
+      if (BlockHeaderSize + sz > parity.size())
+        return std::nullopt;
+      RepairedMessage msg{
+          *missing,
+          parity[0],
+          std::vector<byte_t>(
+              parity.begin() + BlockHeaderSize, parity.begin() + BlockHeaderSize + sz)};
+      m_Rebuilt.insert(*missing);
+      while (m_Rebuilt.size() > MaxKept)
+        m_Rebuilt.erase(m_Rebuilt.begin());
+      m_Repaired++;
+      return msg;
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,97 @@
+#ifndef LLARP_SERVICE_REPAIR_HPP
+#define LLARP_SERVICE_REPAIR_HPP
+
+#include <service/protocol_type.hpp>
+#include <util/buffer.hpp>
+#include <util/types.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// forward error correction for one convo: after every group of messages the sender sends
+    /// one repair message, the xor of the group, from which the receiver rebuilds any one
+    /// message of the group that got lost without waiting a round trip for tcp to resend it.
+    /// reed solomon with a single repair symbol, which is all a lossy path that drops a cell
+    /// now and then needs. a repair payload is the first seqno of its group as 8 bytes, how
+    /// many messages it covers as 1 byte, the offset of each from the first as 1 byte each,
+    /// then the xor of every message as its proto byte, 2 byte length and payload, the
+    /// shorter ones padded with zeros
+    struct RepairEncoder
+    {
+      /// most messages one repair covers
+      static constexpr size_t MaxGroup = 16;
+      /// fewest, on the lossiest paths
+      static constexpr size_t MinGroup = 4;
+      /// loss at which a path starts getting repair messages
+      static constexpr double MinLoss = 0.01;
+
+      /// messages per repair for a path with this smoothed loss, 0 for none at all
+      static size_t
+      GroupSizeFor(double loss);
+
+      /// add a sent message, returning the repair payload once groupSize messages are in
+      std::optional<std::vector<byte_t>>
+      Add(uint64_t seqno, ProtocolType proto, const llarp_buffer_t& payload, size_t groupSize);
+
+      /// repair payloads made
+      uint64_t
+      Repairs() const
+      {
+        return m_Repairs;
+      }
+
+     private:
+      void
+      Reset();
+
+      uint64_t m_First = 0;
+      std::vector<uint8_t> m_Offsets;
+      std::vector<byte_t> m_Parity;
+      uint64_t m_Repairs = 0;
+    };
+
+    struct RepairedMessage
+    {
+      uint64_t seqno;
+      ProtocolType proto;
+      std::vector<byte_t> payload;
+    };
+
+    /// the receiving half, keeps the last few messages of a convo whose sender sends repairs
+    struct RepairDecoder
+    {
+      /// messages kept to rebuild from, a few groups worth
+      static constexpr size_t MaxKept = 64;
+
+      /// a message that arrived, false if it is one we already rebuilt and it goes no further
+      bool
+      Keep(uint64_t seqno, ProtocolType proto, const llarp_buffer_t& payload);
+
+      /// the message a repair payload rebuilds, if exactly one of its group is missing
+      std::optional<RepairedMessage>
+      Repair(const llarp_buffer_t& repair);
+
+      /// messages rebuilt
+      uint64_t
+      Repaired() const
+      {
+        return m_Repaired;
+      }
+
+     private:
+      /// each kept message laid out as the repair payload has it
+      std::map<uint64_t, std::vector<byte_t>> m_Kept;
+      std::set<uint64_t> m_Rebuilt;
+      uint64_t m_Repaired = 0;
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
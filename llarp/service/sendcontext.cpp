@@ -2,7 +2,9 @@
 
 #include <router/abstractrouter.hpp>
 #include <routing/path_transfer_message.hpp>
+#include <service/bundle.hpp>
 #include <service/endpoint.hpp>
+#include <util/alloc_stats.hpp>
 #include <util/thread/logic.hpp>
 #include <utility>
 #include <unordered_set>
@@ -26,19 +28,36 @@ namespace llarp
 
     bool
     SendContext::Send(std::shared_ptr<ProtocolFrame> msg, path::Path_ptr path)
+    {
+      return SendTo(std::move(msg), std::move(path), remoteIntro.pathID);
+    }
+
+    bool
+    SendContext::SendTo(std::shared_ptr<ProtocolFrame> msg, path::Path_ptr path, PathID_t dst)
     {
       if (m_SendQueue.empty() or m_SendQueue.full())
       {
         LogicCall(m_Endpoint->RouterLogic(), [self = this]() { self->FlushUpstream(); });
       }
       m_SendQueue.pushBack(std::make_pair(
-          std::make_shared<const routing::PathTransferMessage>(*msg, remoteIntro.pathID), path));
+          std::make_shared<const routing::PathTransferMessage>(*msg, dst), std::move(path)));
       return true;
     }
 
     void
     SendContext::FlushUpstream()
     {
+      PendingFrames_ptr frames;
+      {
+        util::Lock lock(m_EncryptMutex);
+        frames = std::move(m_EncryptNext);
+        m_EncryptNext = nullptr;
+      }
+      if (frames)
+      {
+        m_Endpoint->Router()->QueueWork(
+            [self = this, frames = std::move(frames)]() { self->EncryptWorker(frames); });
+      }
       auto r = m_Endpoint->Router();
       std::unordered_set<path::Path_ptr, path::Path::Ptr_Hash> flushpaths;
       {
@@ -64,9 +83,48 @@ namespace llarp
     }
 
     /// send on an established convo tag
+    bool
+    SendContext::AddToBundle(const llarp_buffer_t& payload, ProtocolType t)
+    {
+      // stripes spread frames over paths on purpose, they are left a frame each
+      if (m_Endpoint->MultipathWidth() >= 2 or not Bundle::Takes(t)
+          or not m_DataHandler->TakesBundles(currentConvoTag))
+        return false;
+      const bool repairs =
+          m_Endpoint->UsesRepairFrames() and m_DataHandler->TakesRepairFrames(currentConvoTag);
+      util::Lock lock(m_EncryptMutex);
+      if (m_EncryptNext == nullptr or m_EncryptNext->empty())
+        return false;
+      auto& last = m_EncryptNext->back();
+      auto& msg = *last.msg;
+      if (msg.tag != currentConvoTag or last.dst != remoteIntro.pathID or not last.path->IsReady())
+        return false;
+      // a repair covers each message as it was when the encoder took it
+      if (repairs and RepairEncoder::GroupSizeFor(last.path->Score().Loss()) > 0)
+        return false;
+      if (msg.proto != eProtocolBundle)
+      {
+        if (not Bundle::Takes(msg.proto)
+            or not Bundle::Fits(Bundle::ItemHeaderSize + msg.payload.size(), payload.sz))
+          return false;
+        util::PooledVector<byte_t> bundle;
+        bundle.reserve(Bundle::MaxSize);
+        Bundle::Append(bundle, msg.proto, msg.payload.data(), msg.payload.size());
+        msg.payload = std::move(bundle);
+        msg.proto = eProtocolBundle;
+      }
+      else if (not Bundle::Fits(msg.payload.size(), payload.sz))
+        return false;
+      Bundle::Append(msg.payload, t, payload.base, payload.sz);
+      m_Bundled++;
+      return true;
+    }
+
     void
     SendContext::EncryptAndSendTo(const llarp_buffer_t& payload, ProtocolType t)
     {
+      if (AddToBundle(payload, t))
+        return;
       SharedSecret shared;
       auto f = std::make_shared<ProtocolFrame>();
       f->R = 0;
@@ -74,7 +132,10 @@ namespace llarp
       f->T = currentConvoTag;
       f->S = ++sequenceNo;
 
-      auto path = m_PathSet->GetRandomPathByRouter(remoteIntro.router);
+      Introduction remote = remoteIntro;
+      path::Path_ptr path;
+      if (m_Endpoint->MultipathWidth() < 2 or not PickStripe(remote, path))
+        path = m_PathSet->GetRandomPathByRouter(remoteIntro.router);
       if (!path)
       {
         LogWarn(m_Endpoint->Name(), " cannot encrypt and send: no path for intro ", remoteIntro);
@@ -87,7 +148,7 @@ namespace llarp
         return;
       }
 
-      auto m = std::make_shared<ProtocolMessage>();
+      auto m = ProtocolMessage::MakePooled();
       m_DataHandler->PutIntroFor(f->T, remoteIntro);
       m_DataHandler->PutReplyIntroFor(f->T, path->intro);
       m->proto = t;
@@ -97,20 +158,78 @@ namespace llarp
       m->sender = m_Endpoint->GetIdentity().pub;
       m->tag = f->T;
       m->PutBuffer(payload);
-      auto self = this;
-      m_Endpoint->Router()->QueueWork([f, m, shared, path, self]() {
-        if (not f->EncryptAndSign(*m, shared, self->m_Endpoint->GetIdentity()))
+      const bool mac = m_DataHandler->TakesMACFrames(f->T);
+
+      // a path that loses traffic gets a repair after each group, smaller the more it loses
+      std::shared_ptr<ProtocolFrame> repairFrame;
+      std::shared_ptr<ProtocolMessage> repairMsg;
+      const size_t group = m_Endpoint->UsesRepairFrames() and m_DataHandler->TakesRepairFrames(f->T)
+          ? RepairEncoder::GroupSizeFor(path->Score().Loss())
+          : 0;
+      if (group > 0)
+      {
+        if (auto repair = m_Repair.Add(m->seqno, t, payload, group))
+        {
+          repairFrame = std::make_shared<ProtocolFrame>();
+          repairFrame->R = 0;
+          repairFrame->N.Randomize();
+          repairFrame->T = f->T;
+          repairFrame->S = ++sequenceNo;
+          repairFrame->F = f->F;
+          // it takes no seqno of its own, that would leave a gap in the ones it covers
+          repairMsg = std::make_shared<ProtocolMessage>(m->tag);
+          repairMsg->proto = eProtocolRepair;
+          repairMsg->introReply = m->introReply;
+          repairMsg->sender = m->sender;
+          repairMsg->payload.assign(repair->begin(), repair->end());
+        }
+      }
+      // a repair covers payloads as they were, so they are left so while repairs go out
+      const bool compress = group == 0 and m_Endpoint->CompressesPayloads()
+          and m_DataHandler->TakesCompression(f->T);
+      bool first = false;
+      {
+        util::Lock lock(m_EncryptMutex);
+        if (m_EncryptNext == nullptr)
+        {
+          m_EncryptNext = std::make_shared<std::vector<PendingFrame>>();
+          first = true;
+        }
+        m_EncryptNext->emplace_back(
+            PendingFrame{std::move(f), std::move(m), shared, path, remote.pathID, mac, compress});
+        if (repairFrame)
+          m_EncryptNext->emplace_back(PendingFrame{
+              std::move(repairFrame), std::move(repairMsg), shared, path, remote.pathID, mac});
+      }
+      // the rest of the burst queues up behind this before the flush runs
+      if (first)
+        LogicCall(m_Endpoint->RouterLogic(), [self = this]() { self->FlushUpstream(); });
+    }
+
+    void
+    SendContext::EncryptWorker(PendingFrames_ptr frames)
+    {
+      const auto& ident = m_Endpoint->GetIdentity();
+      for (auto& item : *frames)
+      {
+        // done here so a bundle is compressed whole, and off the logic thread
+        if (item.compress)
+          m_Compression.Apply(item.msg->proto, item.msg->payload);
+        const bool sealed = item.mac ? item.frame->EncryptAndMAC(*item.msg, item.shared)
+                                     : item.frame->EncryptAndSign(*item.msg, item.shared, ident);
+        if (not sealed)
         {
-          LogError(self->m_Endpoint->Name(), " failed to sign message");
-          return;
+          LogError(m_Endpoint->Name(), " failed to sign message");
+          continue;
         }
-        self->Send(f, path);
-      });
+        SendTo(std::move(item.frame), std::move(item.path), item.dst);
+      }
     }
 
     void
     SendContext::AsyncEncryptAndSendTo(const llarp_buffer_t& data, ProtocolType protocol)
     {
+      alloc::Scope allocScope{alloc::ServiceFrames};
       if (lastGoodSend != 0s)
       {
         EncryptAndSendTo(data, protocol);
@@ -3,13 +3,19 @@
 
 #include <path/pathset.hpp>
 #include <routing/path_transfer_message.hpp>
+#include <service/compress.hpp>
 #include <service/intro.hpp>
 #include <service/protocol.hpp>
+#include <service/repair.hpp>
 #include <util/buffer.hpp>
 #include <util/types.hpp>
+#include <util/thread/annotations.hpp>
 #include <util/thread/queue.hpp>
+#include <util/thread/threading.hpp>
 
+#include <atomic>
 #include <deque>
+#include <vector>
 
 namespace llarp
 {
@@ -31,7 +37,12 @@ namespace llarp
       bool
       Send(std::shared_ptr<ProtocolFrame> f, path::Path_ptr path);
 
-      /// flush upstream traffic when in router thread
+      /// queue send a fully encrypted hidden service frame via a path to the remote path dst
+      bool
+      SendTo(std::shared_ptr<ProtocolFrame> f, path::Path_ptr path, PathID_t dst);
+
+      /// hand frames waiting on encryption to a worker and flush upstream traffic when in router
+      /// thread
       void
       FlushUpstream();
 
@@ -48,6 +59,13 @@ namespace llarp
       llarp_time_t sendTimeout = 40s;
       llarp_time_t connectTimeout = 60s;
       bool markedBad = false;
+      /// the repair for the group of messages sent since the last one
+      RepairEncoder m_Repair;
+      /// packets that went out in a bundle with the one before them rather than a frame of
+      /// their own
+      std::atomic<uint64_t> m_Bundled{0};
+      /// whether payloads on this convo are coming out smaller compressed
+      CompressionGate m_Compression;
       using Msg_ptr = std::shared_ptr<const routing::PathTransferMessage>;
       using SendEvent_t = std::pair<Msg_ptr, path::Path_ptr>;
       thread::Queue<SendEvent_t> m_SendQueue;
@@ -65,10 +83,47 @@ namespace llarp
       virtual bool
       MarkCurrentIntroBad(llarp_time_t now) = 0;
 
+      /// pick which remote intro and which of our paths the next frame goes over when
+      /// spreading traffic, return false to send down remoteIntro as usual
+      virtual bool
+      PickStripe(Introduction& remote, path::Path_ptr& path)
+      {
+        (void)remote;
+        (void)path;
+        return false;
+      }
+
      private:
+      /// a frame on an established convo waiting to be sealed and sent
+      struct PendingFrame
+      {
+        std::shared_ptr<ProtocolFrame> frame;
+        std::shared_ptr<ProtocolMessage> msg;
+        SharedSecret shared;
+        path::Path_ptr path;
+        PathID_t dst;
+        /// authenticate with a keyed hash rather than sign
+        bool mac;
+        /// try compressing the payload first
+        bool compress = false;
+      };
+      using PendingFrames_ptr = std::shared_ptr<std::vector<PendingFrame>>;
+
+      /// frames queued since the last flush, a worker seals the whole burst in one job
+      util::Mutex m_EncryptMutex;
+      PendingFrames_ptr m_EncryptNext GUARDED_BY(m_EncryptMutex);
+
+      void
+      EncryptWorker(PendingFrames_ptr frames);
+
       void
       EncryptAndSendTo(const llarp_buffer_t& payload, ProtocolType t);
 
+      /// pack payload into the message queued last if the remote takes bundles and it has room,
+      /// so packets queued in the same burst share a frame. false to send it on its own
+      bool
+      AddToBundle(const llarp_buffer_t& payload, ProtocolType t);
+
       virtual void
       AsyncGenIntro(const llarp_buffer_t& payload, ProtocolType t) = 0;
     };
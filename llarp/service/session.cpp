@@ -11,7 +11,13 @@ namespace llarp
                              {"replyIntro", replyIntro.ExtractStatus()},
                              {"remote", remote.Addr().ToString()},
                              {"seqno", seqno},
+                             {"macFrames", remoteTakesMAC},
+                             {"repairFrames", remoteTakesRepair},
+                             {"bundles", remoteTakesBundles},
+                             {"compression", remoteTakesCompression},
                              {"intro", intro.ExtractStatus()}};
+      if (compression)
+        obj["compressed"] = compression->Compressed();
       return obj;
     }
 
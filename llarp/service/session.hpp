@@ -3,11 +3,14 @@
 
 #include <crypto/types.hpp>
 #include <path/path.hpp>
+#include <service/compress.hpp>
 #include <service/info.hpp>
 #include <service/intro.hpp>
 #include <util/status.hpp>
 #include <util/types.hpp>
 
+#include <memory>
+
 namespace llarp
 {
   namespace service
@@ -25,8 +28,21 @@ namespace llarp
       /// the intro remoet last sent on
       Introduction lastInboundIntro;
       llarp_time_t lastUsed = 0s;
+      /// when the remote last switched which of our intros it sends on
+      llarp_time_t lastIntroSwitch = 0s;
       uint64_t seqno = 0;
       bool inbound = false;
+      /// the remote sent a message version that takes frames authenticated by a keyed hash
+      bool remoteTakesMAC = false;
+      /// the remote sent a message version that takes repair messages
+      bool remoteTakesRepair = false;
+      /// the remote sent a message version that takes bundles of packets
+      bool remoteTakesBundles = false;
+      /// the remote sent a message version that takes compressed payloads
+      bool remoteTakesCompression = false;
+      /// whether replies on this convo come out smaller compressed, set once the remote takes
+      /// compression. shared with the workers that seal the replies
+      std::shared_ptr<CompressionGate> compression;
 
       util::StatusObject
       ExtractStatus() const;
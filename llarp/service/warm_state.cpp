@@ -0,0 +1,151 @@
+#include <service/warm_state.hpp>
+
+#include <crypto/crypto.hpp>
+#include <crypto/types.hpp>
+#include <service/identity.hpp>
+#include <util/bencode.hpp>
+#include <util/logging/logger.hpp>
+
+#include <sodium/utils.h>
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// room for every introset and hop we keep, encoded
+    static constexpr size_t MaxStateSize =
+        WarmState::MaxIntroSets * MAX_INTROSET_SIZE + WarmState::MaxFirstHops * 64 + 64;
+
+    /// nonce then mac then the sealed state
+    static constexpr size_t HeaderSize = TUNNONCESIZE + HMACSIZE;
+
+    /// a key for purpose that only the holder of ident's secret keys can make
+    static bool
+    DeriveKey(SharedSecret& key, const Identity& ident, std::string_view purpose)
+    {
+      std::vector<byte_t> material(purpose.begin(), purpose.end());
+      material.insert(material.end(), ident.enckey.begin(), ident.enckey.end());
+      ShortHash hash;
+      const bool ok = CryptoManager::instance()->shorthash(hash, llarp_buffer_t(material));
+      sodium_memzero(material.data(), material.size());
+      std::copy(hash.begin(), hash.end(), key.begin());
+      return ok;
+    }
+
+    bool
+    WarmState::BEncode(llarp_buffer_t* buf) const
+    {
+      if (not bencode_start_dict(buf))
+        return false;
+      if (not BEncodeWriteDictList("H", firstHops, buf))
+        return false;
+      if (not BEncodeWriteDictList("I", introsets, buf))
+        return false;
+      return bencode_end(buf);
+    }
+
+    bool
+    WarmState::BDecode(llarp_buffer_t* buf)
+    {
+      return bencode_decode_dict(*this, buf);
+    }
+
+    bool
+    WarmState::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf)
+    {
+      bool read = false;
+      if (not BEncodeMaybeReadDictList("H", firstHops, read, key, buf))
+        return false;
+      if (not BEncodeMaybeReadDictList("I", introsets, read, key, buf))
+        return false;
+      return read;
+    }
+
+    bool
+    WarmState::Save(const fs::path& fpath, const Identity& ident) const
+    {
+      std::vector<byte_t> data(HeaderSize + MaxStateSize);
+      llarp_buffer_t body(data.data() + HeaderSize, MaxStateSize);
+      if (not BEncode(&body))
+        return false;
+      const size_t bodySize = body.cur - body.base;
+      data.resize(HeaderSize + bodySize);
+
+      auto crypto = CryptoManager::instance();
+      SharedSecret cipherKey, macKey;
+      if (not DeriveKey(cipherKey, ident, "lokinet warm state cipher")
+          or not DeriveKey(macKey, ident, "lokinet warm state mac"))
+        return false;
+      TunnelNonce nonce;
+      nonce.Randomize();
+      std::copy(nonce.begin(), nonce.end(), data.begin());
+      if (not crypto->xchacha20(
+              llarp_buffer_t(data.data() + HeaderSize, bodySize), cipherKey, nonce))
+        return false;
+      // the mac covers the nonce and the sealed state, it goes between them
+      std::vector<byte_t> covered(data.begin(), data.begin() + TUNNONCESIZE);
+      covered.insert(covered.end(), data.begin() + HeaderSize, data.end());
+      if (not crypto->hmac(data.data() + TUNNONCESIZE, llarp_buffer_t(covered), macKey))
+        return false;
+
+      auto f = util::OpenFileStream<std::ofstream>(fpath, std::ios::binary);
+      if (not f or not f->is_open())
+        return false;
+      f->write(reinterpret_cast<const char*>(data.data()), data.size());
+      return f->good();
+    }
+
+    bool
+    WarmState::Load(const fs::path& fpath, const Identity& ident)
+    {
+      std::vector<byte_t> data;
+      {
+        std::ifstream f(fpath.string(), std::ios::binary);
+        if (not f.is_open())
+          return false;
+        f.seekg(0, std::ios::end);
+        const std::streamoff sz = f.tellg();
+        if (sz <= std::streamoff(HeaderSize) or sz > std::streamoff(HeaderSize + MaxStateSize))
+          return false;
+        f.seekg(0, std::ios::beg);
+        data.resize(sz);
+        if (not f.read(reinterpret_cast<char*>(data.data()), sz))
+          return false;
+      }
+
+      auto crypto = CryptoManager::instance();
+      SharedSecret cipherKey, macKey;
+      if (not DeriveKey(cipherKey, ident, "lokinet warm state cipher")
+          or not DeriveKey(macKey, ident, "lokinet warm state mac"))
+        return false;
+      std::vector<byte_t> covered(data.begin(), data.begin() + TUNNONCESIZE);
+      covered.insert(covered.end(), data.begin() + HeaderSize, data.end());
+      ShortHash mac;
+      if (not crypto->hmac(mac.data(), llarp_buffer_t(covered), macKey))
+        return false;
+      if (sodium_memcmp(mac.data(), data.data() + TUNNONCESIZE, HMACSIZE) != 0)
+      {
+        LogWarn("warm state in ", fpath, " is damaged or not ours, ignoring it");
+        return false;
+      }
+      TunnelNonce nonce;
+      std::copy(data.begin(), data.begin() + TUNNONCESIZE, nonce.begin());
+      llarp_buffer_t body(data.data() + HeaderSize, data.size() - HeaderSize);
+      if (not crypto->xchacha20(body, cipherKey, nonce))
+        return false;
+      introsets.clear();
+      firstHops.clear();
+      if (not BDecode(&body))
+        return false;
+      if (introsets.size() > MaxIntroSets)
+        introsets.resize(MaxIntroSets);
+      if (firstHops.size() > MaxFirstHops)
+        firstHops.resize(MaxFirstHops);
+      return true;
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,50 @@
+#ifndef LLARP_SERVICE_WARM_STATE_HPP
+#define LLARP_SERVICE_WARM_STATE_HPP
+
+#include <router_id.hpp>
+#include <service/intro_set.hpp>
+#include <util/buffer.hpp>
+#include <util/fs.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    struct Identity;
+
+    /// what an endpoint saves on the way down so it is sending again sooner after a restart:
+    /// the introsets of the remotes it had sessions with, so they need no lookup, and the
+    /// first hops of its paths, to connect to while the first paths build. it goes on disk
+    /// encrypted and authenticated with keys derived from the endpoint's identity, so only
+    /// that identity can read it back
+    struct WarmState
+    {
+      static constexpr size_t MaxIntroSets = 32;
+      static constexpr size_t MaxFirstHops = 8;
+
+      std::vector<IntroSet> introsets;
+      std::vector<RouterID> firstHops;
+
+      bool
+      BEncode(llarp_buffer_t* buf) const;
+
+      bool
+      BDecode(llarp_buffer_t* buf);
+
+      bool
+      DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf);
+
+      /// write to fpath sealed with ident's keys
+      bool
+      Save(const fs::path& fpath, const Identity& ident) const;
+
+      /// read what Save wrote, false if it is missing, damaged or sealed by someone else
+      bool
+      Load(const fs::path& fpath, const Identity& ident);
+    };
+  }  // namespace service
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,102 @@
+#include <simulation/network.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    Network::Network(Scheduler& scheduler, uint64_t seed) : m_Scheduler(scheduler), m_Rand(seed)
+    {}
+
+    Network::Key
+    Network::KeyOf(const SockAddr& addr, bool withPort)
+    {
+      Key key{};
+      const sockaddr_in6* in6 = addr;
+      std::copy_n(in6->sin6_addr.s6_addr, key.first.size(), key.first.begin());
+      if (withPort)
+        key.second = addr.getPort();
+      return key;
+    }
+
+    void
+    Network::SetDefaultConditions(LinkConditions conditions)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      m_Default = conditions;
+    }
+
+    void
+    Network::SetConditions(const SockAddr& from, const SockAddr& to, LinkConditions conditions)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      m_Conditions[{KeyOf(from, false), KeyOf(to, false)}] = conditions;
+    }
+
+    SockAddr
+    Network::NextHost()
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      const auto idx = m_NextHost++;
+      return SockAddr{10, uint8_t(idx >> 16), uint8_t(idx >> 8), uint8_t(idx)};
+    }
+
+    bool
+    Network::Bind(const SockAddr& addr, Recv_t recv)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      return m_Bound.emplace(KeyOf(addr), std::move(recv)).second;
+    }
+
+    void
+    Network::Unbind(const SockAddr& addr)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      m_Bound.erase(KeyOf(addr));
+    }
+
+    void
+    Network::Send(const SockAddr& from, const SockAddr& to, const byte_t* data, size_t sz)
+    {
+      llarp_time_t delay;
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        m_Sent++;
+        const auto itr = m_Conditions.find({KeyOf(from, false), KeyOf(to, false)});
+        const auto& conditions = itr == m_Conditions.end() ? m_Default : itr->second;
+        if (conditions.loss > 0 and std::bernoulli_distribution{conditions.loss}(m_Rand))
+        {
+          m_Dropped++;
+          return;
+        }
+        delay = conditions.latency;
+        if (conditions.jitter > 0ms)
+          delay += llarp_time_t{std::uniform_int_distribution<llarp_time_t::rep>{
+              0, conditions.jitter.count()}(m_Rand)};
+      }
+      m_Scheduler.Schedule(
+          delay, [this, from, to, data = std::vector<byte_t>(data, data + sz)]() mutable {
+            Deliver(from, to, std::move(data));
+          });
+    }
+
+    void
+    Network::Deliver(const SockAddr& from, const SockAddr& to, std::vector<byte_t> data)
+    {
+      Recv_t recv;
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        const auto itr = m_Bound.find(KeyOf(to));
+        if (itr == m_Bound.end())
+        {
+          m_Dropped++;
+          return;
+        }
+        m_Delivered++;
+        recv = itr->second;
+      }
+      recv(from, std::move(data));
+    }
+  }  // namespace simulate
+}  // namespace llarp
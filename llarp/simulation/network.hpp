@@ -0,0 +1,109 @@
+#ifndef LLARP_SIMULATION_NETWORK_HPP
+#define LLARP_SIMULATION_NETWORK_HPP
+
+#include <net/sock_addr.hpp>
+#include <simulation/scheduler.hpp>
+#include <util/types.hpp>
+
+#include <array>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    /// how datagrams fare from one host to another
+    struct LinkConditions
+    {
+      llarp_time_t latency = 20ms;
+      /// up to this much more latency, picked for each datagram so they can overtake
+      llarp_time_t jitter = 0ms;
+      /// odds a datagram is lost
+      double loss = 0;
+    };
+
+    /// udp between simulated hosts, in memory and on a Scheduler's virtual time. losses and
+    /// jitter come from a generator seeded at construction so a run can be repeated
+    class Network
+    {
+     public:
+      using Recv_t = std::function<void(const SockAddr& from, std::vector<byte_t> data)>;
+
+      explicit Network(Scheduler& scheduler, uint64_t seed = 0);
+
+      /// conditions between hosts that have none of their own
+      void
+      SetDefaultConditions(LinkConditions conditions);
+
+      /// conditions for datagrams from one host to another, ports are ignored
+      void
+      SetConditions(const SockAddr& from, const SockAddr& to, LinkConditions conditions);
+
+      /// an address no host has had, 10.0.0.1 and up
+      SockAddr
+      NextHost();
+
+      /// deliver datagrams sent to addr to recv, false if something is bound there already
+      bool
+      Bind(const SockAddr& addr, Recv_t recv);
+
+      void
+      Unbind(const SockAddr& addr);
+
+      /// send a datagram, it is lost or delivered once the latency between the hosts passed.
+      /// safe from any thread
+      void
+      Send(const SockAddr& from, const SockAddr& to, const byte_t* data, size_t sz);
+
+      uint64_t
+      Sent() const
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        return m_Sent;
+      }
+
+      uint64_t
+      Delivered() const
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        return m_Delivered;
+      }
+
+      /// lost to the link conditions, or sent where nothing was bound by the time they got
+      /// there
+      uint64_t
+      Dropped() const
+      {
+        std::lock_guard<std::mutex> lock{m_Mutex};
+        return m_Dropped;
+      }
+
+     private:
+      void
+      Deliver(const SockAddr& from, const SockAddr& to, std::vector<byte_t> data);
+
+      /// address and port, SockAddr's own ordering is not one we can key on
+      using Key = std::pair<std::array<uint8_t, 16>, uint16_t>;
+
+      static Key
+      KeyOf(const SockAddr& addr, bool withPort = true);
+
+      Scheduler& m_Scheduler;
+      mutable std::mutex m_Mutex;
+      std::mt19937_64 m_Rand;
+      LinkConditions m_Default;
+      std::map<std::pair<Key, Key>, LinkConditions> m_Conditions;
+      std::map<Key, Recv_t> m_Bound;
+      uint32_t m_NextHost = 1;
+      uint64_t m_Sent = 0;
+      uint64_t m_Delivered = 0;
+      uint64_t m_Dropped = 0;
+    };
+  }  // namespace simulate
+}  // namespace llarp
+
+#endif
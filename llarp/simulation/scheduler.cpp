@@ -0,0 +1,101 @@
+#include <simulation/scheduler.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    Scheduler::Scheduler() = default;
+
+    Scheduler::~Scheduler()
+    {
+#ifdef LOKINET_SIMULATION
+      if (m_Installed)
+        set_virtual_time_source(nullptr);
+#endif
+    }
+
+    uint64_t
+    Scheduler::Schedule(llarp_time_t delay, thread::Job job)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      const auto id = m_NextID++;
+      const auto due = Now() + std::max(delay, 0ms);
+      m_Events.emplace(Key{due, id}, std::move(job));
+      m_Due.emplace(id, due);
+      return id;
+    }
+
+    bool
+    Scheduler::Cancel(uint64_t id)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      const auto itr = m_Due.find(id);
+      if (itr == m_Due.end())
+        return false;
+      m_Events.erase(Key{itr->second, id});
+      m_Due.erase(itr);
+      return true;
+    }
+
+    bool
+    Scheduler::PopDue(llarp_time_t deadline, thread::Job& job)
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      if (m_Events.empty())
+        return false;
+      auto itr = m_Events.begin();
+      const auto [due, id] = itr->first;
+      if (due > deadline)
+        return false;
+      job = std::move(itr->second);
+      m_Events.erase(itr);
+      m_Due.erase(id);
+      m_Now.store(due, std::memory_order_relaxed);
+      return true;
+    }
+
+    bool
+    Scheduler::Step()
+    {
+      thread::Job job;
+      if (not PopDue(llarp_time_t::max(), job))
+        return false;
+      job();
+      return true;
+    }
+
+    size_t
+    Scheduler::RunFor(llarp_time_t duration)
+    {
+      const auto deadline = Now() + duration;
+      size_t ran = 0;
+      thread::Job job;
+      while (PopDue(deadline, job))
+      {
+        job();
+        job = nullptr;
+        ran++;
+      }
+      m_Now.store(deadline, std::memory_order_relaxed);
+      return ran;
+    }
+
+    size_t
+    Scheduler::Pending() const
+    {
+      std::lock_guard<std::mutex> lock{m_Mutex};
+      return m_Events.size();
+    }
+
+    void
+    Scheduler::InstallClock()
+    {
+#ifdef LOKINET_SIMULATION
+      set_virtual_time_source(&m_Now);
+      m_Installed = true;
+#endif
+    }
+  }  // namespace simulate
+}  // namespace llarp
@@ -0,0 +1,80 @@
+#ifndef LLARP_SIMULATION_SCHEDULER_HPP
+#define LLARP_SIMULATION_SCHEDULER_HPP
+
+#include <util/thread/job.hpp>
+#include <util/time.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    /// discrete event queue on virtual time. events run one at a time on the thread driving
+    /// it, in order of when they are due and then of when they were scheduled, so a run that
+    /// only schedules from that thread comes out the same every time. time only moves when an
+    /// event is taken off the queue, however long the events take to run
+    class Scheduler
+    {
+     public:
+      /// where virtual time starts, somewhere a wall clock could be, code reads 0s as never
+      static constexpr llarp_time_t Epoch = 1600000000000ms;
+
+      Scheduler();
+      ~Scheduler();
+
+      llarp_time_t
+      Now() const
+      {
+        return m_Now.load(std::memory_order_relaxed);
+      }
+
+      /// run job once delay has passed, returns an id for Cancel that is never 0. safe from any
+      /// thread
+      uint64_t
+      Schedule(llarp_time_t delay, thread::Job job);
+
+      /// drop a job that has not run yet, true if there was one. safe from any thread
+      bool
+      Cancel(uint64_t id);
+
+      /// run the next event, false if there are none
+      bool
+      Step();
+
+      /// run every event due within duration from now and leave the clock at its end
+      /// returns how many ran
+      size_t
+      RunFor(llarp_time_t duration);
+
+      size_t
+      Pending() const;
+
+      /// make time_now_ms read our clock while we live. only does something in
+      /// LOKINET_SIMULATION builds, elsewhere code that calls time_now_ms keeps real time
+      void
+      InstallClock();
+
+     private:
+      using Key = std::pair<llarp_time_t, uint64_t>;
+
+      /// the next event, if it is due by deadline
+      bool
+      PopDue(llarp_time_t deadline, thread::Job& job);
+
+      std::atomic<llarp_time_t> m_Now{Epoch};
+      mutable std::mutex m_Mutex;
+      uint64_t m_NextID = 1;
+      std::map<Key, thread::Job> m_Events;
+      std::unordered_map<uint64_t, llarp_time_t> m_Due;
+      bool m_Installed = false;
+    };
+  }  // namespace simulate
+}  // namespace llarp
+
+#endif
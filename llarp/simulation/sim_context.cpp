@@ -5,12 +5,17 @@ namespace llarp
 {
   namespace simulate
   {
-    Simulation::Simulation() : m_CryptoManager(new sodium::CryptoLibSodium())
-    {}
+    Simulation::Simulation(uint64_t seed)
+        : m_CryptoManager(new sodium::CryptoLibSodium()), m_Network(m_Scheduler, seed)
+    {
+      m_Scheduler.InstallClock();
+    }
 
-    void
-    Simulation::NodeUp(llarp::Context*)
-    {}
+    std::shared_ptr<SimLoop>
+    Simulation::MakeLoop()
+    {
+      return std::make_shared<SimLoop>(m_Scheduler, m_Network, m_Network.NextHost());
+    }
 
     Node_ptr
     Simulation::AddNode(const std::string& name)
@@ -18,7 +23,9 @@ namespace llarp
       auto itr = m_Nodes.find(name);
       if (itr == m_Nodes.end())
       {
-        itr = m_Nodes.emplace(name, std::make_shared<llarp::Context>(shared_from_this())).first;
+        auto node = std::make_shared<llarp::Context>();
+        node->mainloop = MakeLoop();
+        itr = m_Nodes.emplace(name, std::move(node)).first;
       }
       return itr->second;
     }
@@ -28,5 +35,11 @@ namespace llarp
     {
       m_Nodes.erase(name);
     }
+
+    size_t
+    Simulation::RunFor(llarp_time_t duration)
+    {
+      return m_Scheduler.RunFor(duration);
+    }
   }  // namespace simulate
 }  // namespace llarp
@@ -1,6 +1,9 @@
 #pragma once
 #include <crypto/crypto_libsodium.hpp>
 #include <ev/ev.h>
+#include <simulation/network.hpp>
+#include <simulation/scheduler.hpp>
+#include <simulation/sim_loop.hpp>
 
 namespace llarp
 {
@@ -10,23 +13,33 @@ namespace llarp
 
   namespace simulate
   {
-    struct Simulation : public std::enable_shared_from_this<Simulation>
+    /// many nodes in one process on one virtual clock, talking over an in-memory network.
+    /// nodes are configured and set up as usual, their contexts get a SimLoop for mainloop, and
+    /// RunFor moves them all along. work nodes hand to worker or disk threads lands whenever
+    /// it is done, so only what stays on the loops is deterministic
+    struct Simulation
     {
-      Simulation();
+      explicit Simulation(uint64_t seed = 0);
 
       llarp::CryptoManager m_CryptoManager;
-      llarp_ev_loop_ptr m_NetLoop;
+      Scheduler m_Scheduler;
+      Network m_Network;
 
       std::unordered_map<std::string, Node_ptr> m_Nodes;
 
-      void
-      NodeUp(llarp::Context* node);
+      /// a loop on a host of its own
+      std::shared_ptr<SimLoop>
+      MakeLoop();
 
       Node_ptr
       AddNode(const std::string& name);
 
       void
       DelNode(const std::string& name);
+
+      /// run everything due in the next duration of virtual time
+      size_t
+      RunFor(llarp_time_t duration);
     };
 
     using Sim_ptr = std::shared_ptr<Simulation>;
@@ -0,0 +1,161 @@
+#include <simulation/sim_loop.hpp>
+
+#include <util/logging/logger.hpp>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    SimLoop::SimLoop(Scheduler& scheduler, Network& network, SockAddr host)
+        : m_Scheduler(scheduler), m_Network(network), m_Host(std::move(host))
+    {}
+
+    SimLoop::~SimLoop()
+    {
+      for (const auto& [udp, addr] : m_Sockets)
+        m_Network.Unbind(addr);
+    }
+
+    uint64_t
+    SimLoop::Post(llarp_time_t delay, thread::Job job)
+    {
+      return m_Scheduler.Schedule(
+          delay, [weak = weak_from_this(), job = std::move(job)]() mutable {
+            const auto self = weak.lock();
+            if (not self or not self->m_Running)
+              return;
+            job();
+            self->AfterEvent();
+          });
+    }
+
+    void
+    SimLoop::AfterEvent()
+    {
+      if (m_TickersPending)
+        return;
+      m_TickersPending = true;
+      // goes behind everything else due this instant, so it runs once for all of them
+      m_Scheduler.Schedule(0ms, [weak = weak_from_this()]() {
+        const auto self = weak.lock();
+        if (not self)
+          return;
+        self->m_TickersPending = false;
+        if (not self->m_Running)
+          return;
+        // by index and from a copy, either can grow while we call them
+        std::vector<llarp_udp_io*> sockets;
+        for (const auto& item : self->m_Sockets)
+          sockets.push_back(item.first);
+        for (auto* udp : sockets)
+        {
+          if (udp->tick and self->m_Sockets.count(udp))
+            udp->tick(udp);
+        }
+        for (size_t idx = 0; idx < self->m_Tickers.size(); ++idx)
+          self->m_Tickers[idx]();
+      });
+    }
+
+    uint32_t
+    SimLoop::call_after_delay(llarp_time_t delay_ms, std::function<void(void)> callback)
+    {
+      const auto id = m_NextTimer++;
+      if (m_NextTimer == 0)
+        m_NextTimer = 1;
+      m_Timers[id] = Post(delay_ms, [this, id, callback = std::move(callback)]() {
+        m_Timers.erase(id);
+        callback();
+      });
+      return id;
+    }
+
+    void
+    SimLoop::cancel_delayed_call(uint32_t call_id)
+    {
+      const auto itr = m_Timers.find(call_id);
+      if (itr == m_Timers.end())
+        return;
+      m_Scheduler.Cancel(itr->second);
+      m_Timers.erase(itr);
+    }
+
+    bool
+    SimLoop::add_ticker(std::function<void(void)> ticker)
+    {
+      m_Tickers.emplace_back(std::move(ticker));
+      return true;
+    }
+
+    void
+    SimLoop::stop()
+    {
+      m_Running = false;
+    }
+
+    void
+    SimLoop::call_soon(thread::Job f)
+    {
+      Post(0ms, std::move(f));
+    }
+
+    bool
+    SimLoop::udp_listen(llarp_udp_io* l, const SockAddr& src)
+    {
+      SockAddr addr = m_Host;
+      addr.setPort(src.getPort() ? src.getPort() : m_NextPort++);
+      const auto bound = m_Network.Bind(
+          addr, [weak = weak_from_this(), l](const SockAddr& from, std::vector<byte_t> data) {
+            const auto self = weak.lock();
+            if (not self or not self->m_Running or self->m_Sockets.count(l) == 0)
+              return;
+            if (l->recvfrom_batch)
+            {
+              const llarp_udp_pkt pkt{from, data.data(), data.size()};
+              l->recvfrom_batch(l, &pkt, 1);
+            }
+            else if (l->recvfrom)
+            {
+              const llarp_buffer_t buf(data.data(), data.size());
+              l->recvfrom(l, from, ManagedBuffer{buf});
+            }
+            self->AfterEvent();
+          });
+      if (not bound)
+      {
+        LogError("simulated host ", m_Host, " already has something on ", addr);
+        return false;
+      }
+      l->fd = -1;
+      l->impl = this;
+      l->sendto = &SimLoop::SendTo;
+      m_Sockets.emplace(l, addr);
+      return true;
+    }
+
+    bool
+    SimLoop::udp_close(llarp_udp_io* l)
+    {
+      const auto itr = m_Sockets.find(l);
+      if (itr == m_Sockets.end())
+        return false;
+      m_Network.Unbind(itr->second);
+      m_Sockets.erase(itr);
+      l->impl = nullptr;
+      return true;
+    }
+
+    int
+    SimLoop::SendTo(llarp_udp_io* udp, const SockAddr& to, const byte_t* ptr, size_t sz)
+    {
+      auto* self = static_cast<SimLoop*>(udp->impl);
+      if (self == nullptr)
+        return -1;
+      const auto itr = self->m_Sockets.find(udp);
+      if (itr == self->m_Sockets.end())
+        return -1;
+      self->m_Network.Send(itr->second, to, ptr, sz);
+      return sz;
+    }
+  }  // namespace simulate
+}  // namespace llarp
@@ -0,0 +1,153 @@
+#ifndef LLARP_SIMULATION_SIM_LOOP_HPP
+#define LLARP_SIMULATION_SIM_LOOP_HPP
+
+#include <ev/ev.hpp>
+#include <simulation/network.hpp>
+#include <simulation/scheduler.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace simulate
+  {
+    /// event loop for one simulated host. timers and calls go on the Scheduler, udp goes over
+    /// the Network from the host's address, and the tickers run once after each instant the
+    /// host had anything to do, as a real loop runs them once per wakeup. there is no tun, tcp
+    /// or polling of fds, and run returns right away, whoever owns the Scheduler drives it
+    class SimLoop final : public llarp_ev_loop, public std::enable_shared_from_this<SimLoop>
+    {
+     public:
+      SimLoop(Scheduler& scheduler, Network& network, SockAddr host);
+      ~SimLoop() override;
+
+      const SockAddr&
+      Host() const
+      {
+        return m_Host;
+      }
+
+      bool
+      init() override
+      {
+        return true;
+      }
+
+      int
+      run() override
+      {
+        return 0;
+      }
+
+      bool
+      running() const override
+      {
+        return m_Running;
+      }
+
+      llarp_time_t
+      time_now() const override
+      {
+        return m_Scheduler.Now();
+      }
+
+      bool
+      tcp_connect(llarp_tcp_connecter*, const SockAddr&) override
+      {
+        return false;
+      }
+
+      int
+      tick(int) override
+      {
+        return 0;
+      }
+
+      uint32_t
+      call_after_delay(llarp_time_t delay_ms, std::function<void(void)> callback) override;
+
+      void
+      cancel_delayed_call(uint32_t call_id) override;
+
+      bool
+      add_ticker(std::function<void(void)> ticker) override;
+
+      void
+      stop() override;
+
+      bool
+      udp_listen(llarp_udp_io* l, const SockAddr& src) override;
+
+      bool
+      udp_close(llarp_udp_io* l) override;
+
+      bool
+      close_ev(ev_io*) override
+      {
+        return false;
+      }
+
+      ev_io*
+      create_tun(llarp_tun_io*) override
+      {
+        return nullptr;
+      }
+
+      ev_io*
+      bind_tcp(llarp_tcp_acceptor*, const SockAddr&) override
+      {
+        return nullptr;
+      }
+
+      void
+      set_logic(std::shared_ptr<Logic> logic) override
+      {
+        m_Logic = std::move(logic);
+      }
+
+      bool
+      add_ev(ev_io*, bool) override
+      {
+        return false;
+      }
+
+      void
+      call_soon(thread::Job f) override;
+
+      void
+      register_poll_fd_readable(int, std::function<void(void)>) override
+      {}
+
+      void
+      deregister_poll_fd_readable(int) override
+      {}
+
+     private:
+      /// schedule job as something this host does, with the tickers after
+      uint64_t
+      Post(llarp_time_t delay, thread::Job job);
+
+      void
+      AfterEvent();
+
+      static int
+      SendTo(llarp_udp_io* udp, const SockAddr& to, const byte_t* ptr, size_t sz);
+
+      Scheduler& m_Scheduler;
+      Network& m_Network;
+      const SockAddr m_Host;
+      std::shared_ptr<Logic> m_Logic;
+      bool m_Running = true;
+      bool m_TickersPending = false;
+      std::vector<std::function<void(void)>> m_Tickers;
+      uint32_t m_NextTimer = 1;
+      std::unordered_map<uint32_t, uint64_t> m_Timers;
+      std::unordered_map<llarp_udp_io*, SockAddr> m_Sockets;
+      uint16_t m_NextPort = 40000;
+    };
+  }  // namespace simulate
+}  // namespace llarp
+
+#endif
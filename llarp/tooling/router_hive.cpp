@@ -9,6 +9,8 @@
 #include <chrono>
 #include <algorithm>
 
+#include <pthread.h>
+
 using namespace std::chrono_literals;
 
 namespace tooling
@@ -50,7 +52,9 @@ namespace tooling
     for (auto [routerId, ctx] : container)
     {
       routerMainThreads.emplace_back([=]() {
+        NoteMainThread(routerId, true);
         ctx->Run(llarp::RuntimeOptions{false, false, isRelay});
+        NoteMainThread(routerId, false);
       });
       std::this_thread::sleep_for(2ms);
     }
@@ -221,6 +225,47 @@ namespace tooling
     return results;
   }
 
+  void
+  RouterHive::NoteMainThread(const llarp::RouterID& id, bool running)
+  {
+    std::lock_guard<std::mutex> guard{cpuClockMutex};
+    // the clock of a thread that has exited is not ours to read any more
+    mainThreadClocks.erase(id);
+    clockid_t clock;
+    if (running and pthread_getcpuclockid(pthread_self(), &clock) == 0)
+      mainThreadClocks.emplace(id, clock);
+  }
+
+  std::vector<std::pair<llarp::RouterID, double>>
+  RouterHive::CPUTimes(bool isRelay)
+  {
+    std::lock_guard<std::mutex> routers{routerMutex};
+    std::lock_guard<std::mutex> guard{cpuClockMutex};
+    std::vector<std::pair<llarp::RouterID, double>> results;
+    for (const auto& item : (isRelay ? relays : clients))
+    {
+      auto itr = mainThreadClocks.find(item.first);
+      timespec ts;
+      // routers that are not running have nothing to read
+      if (itr == mainThreadClocks.end() or clock_gettime(itr->second, &ts) != 0)
+        continue;
+      results.emplace_back(item.first, ts.tv_sec + ts.tv_nsec / 1e9);
+    }
+    return results;
+  }
+
+  std::vector<std::pair<llarp::RouterID, double>>
+  RouterHive::RelayCPUTimes()
+  {
+    return CPUTimes(true);
+  }
+
+  std::vector<std::pair<llarp::RouterID, double>>
+  RouterHive::ClientCPUTimes()
+  {
+    return CPUTimes(false);
+  }
+
   void
   RouterHive::ForEachRelay(std::function<void(Context_ptr)> visit)
   {
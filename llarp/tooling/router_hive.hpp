@@ -10,6 +10,9 @@
 #include <deque>
 #include <thread>
 #include <mutex>
+#include <utility>
+
+#include <time.h>
 
 struct llarp_config;
 struct llarp_main;
@@ -38,6 +41,14 @@ namespace tooling
     void
     VisitRouter(Context_ptr ctx, std::function<void(Context_ptr)> visit);
 
+    /// called on a router's main thread before and after it runs so we can read that thread's
+    /// cpu time while it is running
+    void
+    NoteMainThread(const llarp::RouterID& id, bool running);
+
+    std::vector<std::pair<llarp::RouterID, double>>
+    CPUTimes(bool isRelay);
+
    public:
     RouterHive() = default;
 
@@ -82,12 +93,24 @@ namespace tooling
     std::vector<llarp::RouterContact>
     GetRelayRCs();
 
+    /// seconds of cpu each relay's main thread has used so far. that thread runs its logic and
+    /// event loop, crypto done on worker threads is not in it
+    std::vector<std::pair<llarp::RouterID, double>>
+    RelayCPUTimes();
+
+    /// as RelayCPUTimes for clients
+    std::vector<std::pair<llarp::RouterID, double>>
+    ClientCPUTimes();
+
     std::mutex routerMutex;
     std::unordered_map<llarp::RouterID, Context_ptr, llarp::RouterID::Hash> relays;
     std::unordered_map<llarp::RouterID, Context_ptr, llarp::RouterID::Hash> clients;
 
     std::vector<std::thread> routerMainThreads;
 
+    std::mutex cpuClockMutex;
+    std::unordered_map<llarp::RouterID, clockid_t, llarp::RouterID::Hash> mainThreadClocks;
+
     std::mutex eventQueueMutex;
     std::deque<RouterEventPtr> eventQueue;
   };
@@ -5,6 +5,7 @@
 #include <util/logging/logger.hpp>
 #include <util/meta/traits.hpp>
 #include <util/printer.hpp>
+#include <util/keyed_hash.hpp>
 
 #include <lokimq/hex.h>
 
@@ -288,14 +289,13 @@ namespace llarp
       return stream;
     }
 
+    /// keyed so that peers choosing ids cannot pile them into one bucket
     struct Hash
     {
       std::size_t
       operator()(const AlignedBuffer& buf) const noexcept
       {
-        std::size_t h = 0;
-        std::memcpy(&h, buf.data(), sizeof(std::size_t));
-        return h;
+        return KeyedHash(buf.data(), sz);
       }
     };
 
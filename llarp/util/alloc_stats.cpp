@@ -0,0 +1,279 @@
+#include <util/alloc_stats.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace llarp
+{
+  namespace alloc
+  {
+    const char*
+    TagName(Tag tag)
+    {
+      switch (tag)
+      {
+        case LinkBuffers:
+          return "link_buffers";
+        case PathQueues:
+          return "path_queues";
+        case DHTMessages:
+          return "dht_messages";
+        case ServiceFrames:
+          return "service_frames";
+        case Logging:
+          return "logging";
+        default:
+          return "other";
+      }
+    }
+
+    util::StatusObject
+    TagStats::ExtractStatus() const
+    {
+      return {{"bytes", bytes},
+              {"highWater", highWater},
+              {"allocations", allocations},
+              {"frees", frees}};
+    }
+
+#ifdef LOKINET_ALLOC_STATS
+    namespace
+    {
+      /// goes through operator new with the tag set, the header says where to count the free
+      struct TaggedResource final : public std::pmr::memory_resource
+      {
+        Tag tag = Other;
+
+       private:
+        void*
+        do_allocate(size_t bytes, size_t alignment) override
+        {
+          Scope scope{tag};
+          // the aligned operator new is not counted, only take it when there is no choice
+          if (alignment <= alignof(std::max_align_t))
+            return ::operator new(bytes);
+          return ::operator new(bytes, std::align_val_t{alignment});
+        }
+
+        void
+        do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+        {
+          if (alignment <= alignof(std::max_align_t))
+            ::operator delete(ptr);
+          else
+            ::operator delete(ptr, bytes, std::align_val_t{alignment});
+        }
+
+        bool
+        do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+          return this == &other;
+        }
+      };
+
+      /// all of it is constant initialized, operator new runs before anything is constructed
+      struct Counters
+      {
+        std::atomic<int64_t> bytes{0};
+        std::atomic<int64_t> highWater{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+
+        void
+        Allocated(size_t sz)
+        {
+          allocations.fetch_add(1, std::memory_order_relaxed);
+          const int64_t now = bytes.fetch_add(sz, std::memory_order_relaxed) + sz;
+          auto high = highWater.load(std::memory_order_relaxed);
+          while (now > high
+                 and not highWater.compare_exchange_weak(high, now, std::memory_order_relaxed))
+          {
+          }
+        }
+
+        void
+        Freed(size_t sz)
+        {
+          frees.fetch_add(1, std::memory_order_relaxed);
+          bytes.fetch_sub(sz, std::memory_order_relaxed);
+        }
+
+        TagStats
+        Load() const
+        {
+          TagStats stats;
+          stats.bytes = bytes.load(std::memory_order_relaxed);
+          stats.highWater = highWater.load(std::memory_order_relaxed);
+          stats.allocations = allocations.load(std::memory_order_relaxed);
+          stats.frees = frees.load(std::memory_order_relaxed);
+          return stats;
+        }
+      };
+
+      /// one per tag and the total after them
+      Counters g_Counters[NumTags + 1];
+
+      thread_local Tag t_Tag = Other;
+
+      /// in front of every allocation, a whole max_align_t so what follows stays aligned
+      struct alignas(std::max_align_t) Header
+      {
+        size_t size;
+        Tag tag;
+      };
+
+      void*
+      Allocate(size_t sz) noexcept
+      {
+        auto* header = static_cast<Header*>(std::malloc(sizeof(Header) + sz));
+        if (header == nullptr)
+          return nullptr;
+        header->size = sz;
+        header->tag = t_Tag;
+        g_Counters[header->tag].Allocated(sz);
+        g_Counters[NumTags].Allocated(sz);
+        return header + 1;
+      }
+
+      void
+      Free(void* ptr) noexcept
+      {
+        if (ptr == nullptr)
+          return;
+        auto* header = static_cast<Header*>(ptr) - 1;
+        g_Counters[header->tag].Freed(header->size);
+        g_Counters[NumTags].Freed(header->size);
+        std::free(header);
+      }
+    }  // namespace
+
+    Scope::Scope(Tag tag) : m_Prev(t_Tag)
+    {
+      t_Tag = tag;
+    }
+
+    Scope::~Scope()
+    {
+      t_Tag = m_Prev;
+    }
+
+    std::pmr::memory_resource*
+    Resource(Tag tag)
+    {
+      static std::array<TaggedResource, NumTags> resources = [] {
+        std::array<TaggedResource, NumTags> all;
+        for (size_t idx = 0; idx < NumTags; ++idx)
+          all[idx].tag = Tag(idx);
+        return all;
+      }();
+      return &resources[tag];
+    }
+
+    std::array<TagStats, NumTags>
+    Snapshot()
+    {
+      std::array<TagStats, NumTags> stats;
+      for (size_t idx = 0; idx < NumTags; ++idx)
+        stats[idx] = g_Counters[idx].Load();
+      return stats;
+    }
+
+    util::StatusObject
+    ExtractStatus()
+    {
+      util::StatusObject obj{{"enabled", true},
+                             {"all", g_Counters[NumTags].Load().ExtractStatus()}};
+      const auto stats = Snapshot();
+      for (size_t idx = 0; idx < NumTags; ++idx)
+        obj[TagName(Tag(idx))] = stats[idx].ExtractStatus();
+      return obj;
+    }
+#else
+    std::pmr::memory_resource*
+    Resource(Tag)
+    {
+      return std::pmr::get_default_resource();
+    }
+
+    std::array<TagStats, NumTags>
+    Snapshot()
+    {
+      return {};
+    }
+
+    util::StatusObject
+    ExtractStatus()
+    {
+      return {{"enabled", false}};
+    }
+#endif
+  }  // namespace alloc
+}  // namespace llarp
+
+#ifdef LOKINET_ALLOC_STATS
+// every form that allocates or frees without an alignment, so nothing is freed that did not
+// come from Allocate. the aligned forms are left as they are and not counted
+void*
+operator new(size_t sz)
+{
+  if (void* ptr = llarp::alloc::Allocate(sz))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void*
+operator new[](size_t sz)
+{
+  return operator new(sz);
+}
+
+void*
+operator new(size_t sz, const std::nothrow_t&) noexcept
+{
+  return llarp::alloc::Allocate(sz);
+}
+
+void*
+operator new[](size_t sz, const std::nothrow_t&) noexcept
+{
+  return llarp::alloc::Allocate(sz);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+
+void
+operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+
+void
+operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  llarp::alloc::Free(ptr);
+}
+#endif
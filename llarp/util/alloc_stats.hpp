@@ -0,0 +1,86 @@
+#ifndef LLARP_UTIL_ALLOC_STATS_HPP
+#define LLARP_UTIL_ALLOC_STATS_HPP
+
+#include <util/status.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+
+namespace llarp
+{
+  namespace alloc
+  {
+    /// what heap use is counted against, set by the innermost Scope on the thread
+    enum Tag : uint8_t
+    {
+      Other = 0,
+      LinkBuffers,
+      PathQueues,
+      DHTMessages,
+      ServiceFrames,
+      Logging,
+      NumTags
+    };
+
+    const char*
+    TagName(Tag tag);
+
+#ifdef LOKINET_ALLOC_STATS
+    /// built with WITH_ALLOC_STATS, operator new is replaced to count every allocation
+    constexpr bool Enabled = true;
+
+    /// allocations on this thread count against tag while the scope lives, whichever
+    /// container makes them. frees count against the tag the memory was allocated under
+    struct Scope
+    {
+      explicit Scope(Tag tag);
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      Scope&
+      operator=(const Scope&) = delete;
+
+     private:
+      const Tag m_Prev;
+    };
+#else
+    constexpr bool Enabled = false;
+
+    struct Scope
+    {
+      explicit constexpr Scope(Tag)
+      {}
+    };
+#endif
+
+    struct TagStats
+    {
+      /// bytes allocated under the tag and not freed yet
+      int64_t bytes = 0;
+      /// the most bytes has ever been
+      int64_t highWater = 0;
+      uint64_t allocations = 0;
+      uint64_t frees = 0;
+
+      util::StatusObject
+      ExtractStatus() const;
+    };
+
+    /// a memory resource that allocates under tag from any thread, for containers that
+    /// should be counted against a subsystem wherever they grow. the plain default
+    /// resource when not Enabled
+    std::pmr::memory_resource*
+    Resource(Tag tag);
+
+    /// what each tag has now, all zero unless Enabled
+    std::array<TagStats, NumTags>
+    Snapshot();
+
+    /// every tag's stats by name, with the total as "all"
+    util::StatusObject
+    ExtractStatus();
+  }  // namespace alloc
+}  // namespace llarp
+
+#endif
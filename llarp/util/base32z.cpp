@@ -0,0 +1,140 @@
+#include <util/base32z.hpp>
+
+#include <array>
+#include <cstring>
+
+namespace llarp
+{
+  namespace base32z
+  {
+    static constexpr char Alphabet[] = "ybndrfg8ejkmcpqxot1uwisza345h769";
+
+    /// value of each character, 0xff for one that is not base32z
+    static constexpr std::array<uint8_t, 256>
+    MakeDecodeTable()
+    {
+      std::array<uint8_t, 256> table{};
+      for (auto& val : table)
+        val = 0xff;
+      for (uint8_t idx = 0; idx < 32; ++idx)
+      {
+        const auto ch = static_cast<uint8_t>(Alphabet[idx]);
+        table[ch] = idx;
+        if (ch >= 'a' and ch <= 'z')
+          table[ch - 'a' + 'A'] = idx;
+      }
+      return table;
+    }
+
+    static constexpr auto DecodeTable = MakeDecodeTable();
+
+    void
+    Encode(const uint8_t* in, size_t sz, char* out)
+    {
+      size_t idx = 0;
+      for (; idx + 5 <= sz; idx += 5, out += 8)
+      {
+        const uint64_t word = (uint64_t{in[idx]} << 32) | (uint64_t{in[idx + 1]} << 24)
+            | (uint64_t{in[idx + 2]} << 16) | (uint64_t{in[idx + 3]} << 8) | in[idx + 4];
+        out[0] = Alphabet[(word >> 35) & 31];
+        out[1] = Alphabet[(word >> 30) & 31];
+        out[2] = Alphabet[(word >> 25) & 31];
+        out[3] = Alphabet[(word >> 20) & 31];
+        out[4] = Alphabet[(word >> 15) & 31];
+        out[5] = Alphabet[(word >> 10) & 31];
+        out[6] = Alphabet[(word >> 5) & 31];
+        out[7] = Alphabet[word & 31];
+      }
+      // the last 1 to 4 bytes a bit at a time
+      uint32_t bits = 0;
+      int held = 0;
+      for (; idx < sz; ++idx)
+      {
+        bits = (bits << 8) | in[idx];
+        held += 8;
+        while (held >= 5)
+        {
+          held -= 5;
+          *out++ = Alphabet[(bits >> held) & 31];
+        }
+      }
+      if (held > 0)
+        *out = Alphabet[(bits << (5 - held)) & 31];
+    }
+
+    std::string
+    Encode(const uint8_t* in, size_t sz)
+    {
+      std::string str(EncodedSize(sz), '\0');
+      Encode(in, sz, str.data());
+      return str;
+    }
+
+    bool
+    Decode(std::string_view str, uint8_t* out, size_t sz)
+    {
+      if (str.size() != EncodedSize(sz))
+        return false;
+      // checked first so out is left as it was if this is not base32z
+      uint8_t bad = 0;
+      for (const char ch : str)
+        bad |= DecodeTable[static_cast<uint8_t>(ch)];
+      if (bad & 0x80)
+        return false;
+
+      const char* in = str.data();
+      const auto value = [&in](size_t pos) -> uint64_t {
+        return DecodeTable[static_cast<uint8_t>(in[pos])];
+      };
+      size_t idx = 0;
+      for (; idx + 5 <= sz; idx += 5, in += 8)
+      {
+        const uint64_t word = (value(0) << 35) | (value(1) << 30) | (value(2) << 25)
+            | (value(3) << 20) | (value(4) << 15) | (value(5) << 10) | (value(6) << 5) | value(7);
+        out[idx] = word >> 32;
+        out[idx + 1] = word >> 24;
+        out[idx + 2] = word >> 16;
+        out[idx + 3] = word >> 8;
+        out[idx + 4] = word;
+      }
+      uint32_t bits = 0;
+      int held = 0;
+      for (; idx < sz; ++in)
+      {
+        bits = (bits << 5) | DecodeTable[static_cast<uint8_t>(*in)];
+        held += 5;
+        if (held >= 8)
+        {
+          held -= 8;
+          out[idx++] = bits >> held;
+        }
+      }
+      return true;
+    }
+
+    /// keys each thread keeps rendered, a key goes in the slot its first byte picks
+    static constexpr size_t CachedKeys = 64;
+    static constexpr size_t KeySize = 32;
+
+    struct CachedKey
+    {
+      std::array<uint8_t, KeySize> key;
+      std::array<char, EncodedSize(KeySize)> text;
+      bool filled = false;
+    };
+
+    void
+    AppendKey(std::string& out, const uint8_t* key)
+    {
+      thread_local std::array<CachedKey, CachedKeys> cache;
+      auto& slot = cache[key[0] % CachedKeys];
+      if (not slot.filled or std::memcmp(slot.key.data(), key, KeySize) != 0)
+      {
+        std::memcpy(slot.key.data(), key, KeySize);
+        Encode(key, KeySize, slot.text.data());
+        slot.filled = true;
+      }
+      out.append(slot.text.data(), slot.text.size());
+    }
+  }  // namespace base32z
+}  // namespace llarp
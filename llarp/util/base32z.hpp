@@ -0,0 +1,42 @@
+#ifndef LLARP_UTIL_BASE32Z_HPP
+#define LLARP_UTIL_BASE32Z_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace llarp
+{
+  namespace base32z
+  {
+    /// characters sz bytes encode to, the last one padded with zero bits
+    constexpr size_t
+    EncodedSize(size_t sz)
+    {
+      return (sz * 8 + 4) / 5;
+    }
+
+    /// the same encoding as lokimq::to_base32z. 5 bytes go out as 8 characters at a time from
+    /// one 40 bit word rather than a bit at a time. out must have EncodedSize(sz) characters
+    void
+    Encode(const uint8_t* in, size_t sz, char* out);
+
+    std::string
+    Encode(const uint8_t* in, size_t sz);
+
+    /// decode str, which must be exactly EncodedSize(sz) characters, into sz bytes at out. the
+    /// padding bits are dropped as lokimq::from_base32z does, upper case is taken as lower.
+    /// returns false without a complete write if any character is not base32z
+    bool
+    Decode(std::string_view str, uint8_t* out, size_t sz);
+
+    /// append the 52 characters of a 32 byte key, out of a small per thread cache of the
+    /// keys rendered last, as the same few addresses go into most log lines, dns replies and
+    /// status we make
+    void
+    AppendKey(std::string& out, const uint8_t* key);
+  }  // namespace base32z
+}  // namespace llarp
+
+#endif
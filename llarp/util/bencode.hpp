@@ -8,7 +8,9 @@
 #include <util/mem.hpp>
 
 #include <fstream>
+#include <limits>
 #include <set>
+#include <string_view>
 #include <vector>
 
 namespace llarp
@@ -120,6 +122,65 @@ namespace llarp
     return true;
   }
 
+  /// a bencoded string decoded as a view into the buffer it was read from instead of a copy,
+  /// so it is only good for as long as that buffer is. at most maxsz bytes long
+  template <size_t maxsz = std::numeric_limits<size_t>::max()>
+  struct BEncodeView
+  {
+    bool
+    BDecode(llarp_buffer_t* buf)
+    {
+      llarp_buffer_t strbuf;
+      if (not bencode_read_string(buf, &strbuf))
+        return false;
+      if (strbuf.sz > maxsz)
+        return false;
+      m_Data = strbuf.base;
+      m_Size = strbuf.sz;
+      return true;
+    }
+
+    bool
+    BEncode(llarp_buffer_t* buf) const
+    {
+      return bencode_write_bytestring(buf, m_Data, m_Size);
+    }
+
+    /// nullptr until something is decoded into it
+    const byte_t*
+    data() const
+    {
+      return m_Data;
+    }
+
+    size_t
+    size() const
+    {
+      return m_Size;
+    }
+
+    std::string_view
+    View() const
+    {
+      return std::string_view(reinterpret_cast<const char*>(m_Data), m_Size);
+    }
+
+    /// view sz bytes at data, which must outlive every use of this view
+    bool
+    Assign(const byte_t* data, size_t sz)
+    {
+      if (sz > maxsz)
+        return false;
+      m_Data = data;
+      m_Size = sz;
+      return true;
+    }
+
+   private:
+    const byte_t* m_Data = nullptr;
+    size_t m_Size = 0;
+  };
+
   template <typename List_t>
   bool
   BEncodeWriteDictBEncodeList(const char* k, const List_t& l, llarp_buffer_t* buf)
@@ -389,6 +450,248 @@ namespace llarp
     return ret;
   }
 
+  /// exact length of i bencoded as an integer
+  constexpr size_t
+  BEncodeSizeInt(uint64_t i)
+  {
+    size_t digits = 1;
+    while (i >= 10)
+    {
+      i /= 10;
+      ++digits;
+    }
+    return digits + 2;
+  }
+
+  /// exact length of a bencoded string of len bytes
+  constexpr size_t
+  BEncodeSizeString(size_t len)
+  {
+    return BEncodeSizeInt(len) - 1 + len;
+  }
+
+  /// exact length of a byte container bencoded as a string
+  template <typename T>
+  auto
+  BEncodeSize(const T& t) -> decltype(t.size(), t.data(), size_t{})
+  {
+    return BEncodeSizeString(t.size());
+  }
+
+  /// true if every key sorts after the one before it
+  template <size_t N>
+  constexpr bool
+  BEncodeKeysInOrder(const char (&keys)[N])
+  {
+    for (size_t idx = 1; idx < N; ++idx)
+      if (keys[idx - 1] >= keys[idx])
+        return false;
+    return true;
+  }
+
+  /// a message's bencoded dict declared once as its fields, in key order, each keyed by one
+  /// byte. Encode, DecodeKey and EncodedSize are made from the list: a key is matched on its
+  /// byte against every field's constant key, which the compiler folds into one switch,
+  /// and the size is exact so the encode buffer can be sized up front. EncodedSize is only
+  /// there when every field knows its size.
+  ///
+  /// using Schema = BEncodeSchema<
+  ///     BEncodeDictMsgType<'a', 'u'>,
+  ///     BEncodeDictEntry<'p', &RelayUpstreamMessage::pathid>,
+  ///     BEncodeDictVersion<'v'>>;
+  template <typename... Fields>
+  struct BEncodeSchema
+  {
+    static_assert(sizeof...(Fields) > 0, "a schema needs fields");
+    static_assert(
+        BEncodeKeysInOrder({Fields::Key...}), "bencoded dict keys must be unique and in order");
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t& msg, llarp_buffer_t* buf)
+    {
+      return bencode_start_dict(buf) and (Fields::Encode(msg, buf) and ...) and bencode_end(buf);
+    }
+
+    /// decode the value for key into msg, false if key is not one of ours or does not decode
+    template <typename Msg_t>
+    static bool
+    DecodeKey(Msg_t& msg, const llarp_buffer_t& key, llarp_buffer_t* buf)
+    {
+      if (key.sz != 1)
+        return false;
+      const char k = *key.base;
+      bool decoded = false;
+      ((k == Fields::Key and (decoded = Fields::Decode(msg, buf), true)) or ...);
+      return decoded;
+    }
+
+    template <typename Msg_t>
+    static size_t
+    EncodedSize(const Msg_t& msg)
+    {
+      return 2 + (Fields::Size(msg) + ...);
+    }
+
+  };
+
+  /// the message type key, checked when it is decoded
+  template <char k, char type>
+  struct BEncodeDictMsgType
+  {
+    static constexpr char Key = k;
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t&, llarp_buffer_t* buf)
+    {
+      const char t[1] = {type};
+      return bencode_write_bytestring(buf, &Key, 1) and bencode_write_bytestring(buf, t, 1);
+    }
+
+    template <typename Msg_t>
+    static bool
+    Decode(Msg_t&, llarp_buffer_t* buf)
+    {
+      llarp_buffer_t strbuf;
+      return bencode_read_string(buf, &strbuf) and strbuf.sz == 1 and *strbuf.base == type;
+    }
+
+    template <typename Msg_t>
+    static constexpr size_t
+    Size(const Msg_t&)
+    {
+      return BEncodeSizeString(1) * 2;
+    }
+  };
+
+  /// a member with its own BEncode and BDecode
+  template <char k, auto member>
+  struct BEncodeDictEntry
+  {
+    static constexpr char Key = k;
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t& msg, llarp_buffer_t* buf)
+    {
+      return bencode_write_bytestring(buf, &Key, 1) and (msg.*member).BEncode(buf);
+    }
+
+    template <typename Msg_t>
+    static bool
+    Decode(Msg_t& msg, llarp_buffer_t* buf)
+    {
+      return (msg.*member).BDecode(buf);
+    }
+
+    template <typename Msg_t>
+    static size_t
+    Size(const Msg_t& msg)
+    {
+      return BEncodeSizeString(1) + BEncodeSize(msg.*member);
+    }
+  };
+
+  /// an integer member
+  template <char k, auto member>
+  struct BEncodeDictInt
+  {
+    static constexpr char Key = k;
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t& msg, llarp_buffer_t* buf)
+    {
+      return bencode_write_bytestring(buf, &Key, 1) and bencode_write_uint64(buf, msg.*member);
+    }
+
+    template <typename Msg_t>
+    static bool
+    Decode(Msg_t& msg, llarp_buffer_t* buf)
+    {
+      uint64_t i;
+      if (not bencode_read_integer(buf, &i))
+        return false;
+      msg.*member = i;
+      return true;
+    }
+
+    template <typename Msg_t>
+    static size_t
+    Size(const Msg_t& msg)
+    {
+      return BEncodeSizeString(1) + BEncodeSizeInt(msg.*member);
+    }
+  };
+
+  /// the protocol version, always encoded as ours. decoded into msg.version, and refused
+  /// unless it is ours when verify is set
+  template <char k, bool verify = true>
+  struct BEncodeDictVersion
+  {
+    static constexpr char Key = k;
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t&, llarp_buffer_t* buf)
+    {
+      return bencode_write_bytestring(buf, &Key, 1)
+          and bencode_write_uint64(buf, LLARP_PROTO_VERSION);
+    }
+
+    template <typename Msg_t>
+    static bool
+    Decode(Msg_t& msg, llarp_buffer_t* buf)
+    {
+      if (not bencode_read_integer(buf, &msg.version))
+        return false;
+      return not verify or msg.version == LLARP_PROTO_VERSION;
+    }
+
+    template <typename Msg_t>
+    static constexpr size_t
+    Size(const Msg_t&)
+    {
+      return BEncodeSizeString(1) + BEncodeSizeInt(LLARP_PROTO_VERSION);
+    }
+  };
+
+  /// a byte string decoded as a view and encoded from the view when there is one, otherwise
+  /// from the owned member built locally
+  template <char k, auto view, auto owned>
+  struct BEncodeDictViewOr
+  {
+    static constexpr char Key = k;
+
+    template <typename Msg_t>
+    static bool
+    Encode(const Msg_t& msg, llarp_buffer_t* buf)
+    {
+      if (not bencode_write_bytestring(buf, &Key, 1))
+        return false;
+      if ((msg.*view).data())
+        return (msg.*view).BEncode(buf);
+      return (msg.*owned).BEncode(buf);
+    }
+
+    template <typename Msg_t>
+    static bool
+    Decode(Msg_t& msg, llarp_buffer_t* buf)
+    {
+      return (msg.*view).BDecode(buf);
+    }
+
+    template <typename Msg_t>
+    static size_t
+    Size(const Msg_t& msg)
+    {
+      if ((msg.*view).data())
+        return BEncodeSizeString(1) + BEncodeSize(msg.*view);
+      return BEncodeSizeString(1) + BEncodeSize(msg.*owned);
+    }
+  };
+
 }  // namespace llarp
 
 #endif
@@ -2,16 +2,16 @@
 #define LLARP_CODEL_QUEUE_HPP
 
 #include <util/logging/logger.hpp>
-#include <util/mem.hpp>
-#include <util/thread/threading.hpp>
+#include <util/thread/spsc_queue.hpp>
 #include <util/time.hpp>
 
 #include <algorithm>
-#include <array>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace llarp
 {
@@ -22,147 +22,164 @@ namespace llarp
       llarp_time_t
       operator()() const
       {
-        return llarp::time_now_ms();
+        return llarp::coarse_now_ms();
       }
     };
 
+    /// the Mark of a queue whose items cannot carry a congestion mark, so are always dropped
+    struct NeverMark
+    {
+      template <typename T>
+      bool
+      operator()(T&) const
+      {
+        return false;
+      }
+    };
+
+    /// codel in front of a ring handing items from one producer thread to one consumer thread
+    /// without a lock between them. the ring holds handles to items rather than the items
+    /// themselves, and handles that were visited go back to the producer to be filled again, so
+    /// a queued packet is copied once on the way in and never moved around after. Process takes
+    /// a whole batch off the ring at once
     template <
         typename T,
         typename GetTime,
         typename PutTime,
         typename Compare,
         typename GetNow = GetNowSyscall,
-        typename Mutex_t = util::Mutex,
-        typename Lock_t = std::lock_guard<Mutex_t>,
-        size_t MaxSize = 1024>
+        size_t MaxSize = 1024,
+        typename Mark = NeverMark>
     struct CoDelQueue
     {
+      using Handle_t = std::unique_ptr<T>;
+
       CoDelQueue(std::string name, PutTime put, GetNow now)
-          : m_QueueIdx(0)
+          : m_Queue(MaxSize)
+          , m_Free(MaxSize)
           , m_name(std::move(name))
           , _putTime(std::move(put))
           , _getNow(std::move(now))
       {}
 
+      /// exact from the producer or the consumer, approximate from anywhere else
       size_t
-      Size() EXCLUDES(m_QueueMutex)
+      Size() const
       {
-        Lock_t lock(m_QueueMutex);
-        return m_QueueIdx;
+        return m_Queue.size();
       }
 
+      /// producer only
       template <typename... Args>
       bool
-      EmplaceIf(std::function<bool(T&)> pred, Args&&... args) EXCLUDES(m_QueueMutex)
+      EmplaceIf(std::function<bool(T&)> pred, Args&&... args)
       {
-        Lock_t lock(m_QueueMutex);
-        if (m_QueueIdx == MaxSize)
+        if (m_Queue.full())
           return false;
-        T* t = &m_Queue[m_QueueIdx];
-        new (t) T(std::forward<Args>(args)...);
-        if (!pred(*t))
+        Handle_t item = Make(std::forward<Args>(args)...);
+        if (not pred(*item))
         {
-          t->~T();
+          m_Spare = std::move(item);
           return false;
         }
-
-        _putTime(m_Queue[m_QueueIdx]);
-        if (firstPut == 0s)
-          firstPut = _getTime(m_Queue[m_QueueIdx]);
-        ++m_QueueIdx;
-
-        return true;
+        _putTime(*item);
+        return m_Queue.tryPushBack(std::move(item));
       }
 
+      /// producer only
       template <typename... Args>
       void
-      Emplace(Args&&... args) EXCLUDES(m_QueueMutex)
+      Emplace(Args&&... args)
       {
-        Lock_t lock(m_QueueMutex);
-        if (m_QueueIdx == MaxSize)
+        if (m_Queue.full())
           return;
-        T* t = &m_Queue[m_QueueIdx];
-        new (t) T(std::forward<Args>(args)...);
-        _putTime(m_Queue[m_QueueIdx]);
-        if (firstPut == 0s)
-          firstPut = _getTime(m_Queue[m_QueueIdx]);
-        ++m_QueueIdx;
+        Handle_t item = Make(std::forward<Args>(args)...);
+        _putTime(*item);
+        m_Queue.tryPushBack(std::move(item));
       }
 
-      template <typename Visit>
-      void
-      Process(Visit v)
+      /// consumer only, items marked rather than dropped
+      uint64_t
+      Marks() const
       {
-        return Process(v, [](T&) -> bool { return false; });
+        return m_Marks;
       }
 
-      template <typename Visit, typename Filter>
+      /// consumer only, visit at most max of the queued items oldest first. if even the
+      /// freshest of them sat longer than dropMs the newest is marked or dropped and we back off
+      template <typename Visit>
       void
-      Process(Visit visitor, Filter f) EXCLUDES(m_QueueMutex)
+      Process(Visit visitor, size_t max = MaxSize)
       {
-        llarp_time_t lowest = std::numeric_limits<llarp_time_t>::max();
-        if (_getNow() < nextTickAt)
+        const llarp_time_t now = _getNow();
+        if (now < nextTickAt)
           return;
-        // llarp::LogInfo("CoDelQueue::Process - start at ", start);
-        Lock_t lock(m_QueueMutex);
-        auto start = firstPut;
-
-        if (m_QueueIdx == 1)
-        {
-          visitor(m_Queue[0]);
-          T* t = &m_Queue[0];
-          t->~T();
-          m_QueueIdx = 0;
-          firstPut = 0s;
+        m_Batch.clear();
+        if (m_Queue.popAll(m_Batch, max) == 0)
           return;
+        llarp::LogDebug(m_name, " - processing ", m_Batch.size());
+        llarp_time_t lowest = llarp_time_t::max();
+        for (const auto& item : m_Batch)
+          lowest = std::min(lowest, now - _getTime(*item));
+        size_t num = m_Batch.size();
+        if (lowest > dropMs)
+        {
+          if (_mark(*m_Batch[num - 1]))
+            ++m_Marks;
+          else
+            --num;
+          nextTickInterval += initialIntervalMs / uint64_t(std::sqrt(++dropNum));
+          nextTickAt = now + nextTickInterval;
         }
-        size_t idx = 0;
-        while (m_QueueIdx)
+        else
         {
-          llarp::LogDebug(m_name, " - queue has ", m_QueueIdx);
-          T* item = &m_Queue[idx++];
-          if (f(*item))
-            break;
-          --m_QueueIdx;
-          const llarp_time_t dlt = start - _getTime(*item);
-          // llarp::LogInfo("CoDelQueue::Process - dlt ", dlt);
-          lowest = std::min(dlt, lowest);
-          if (m_QueueIdx == 0)
-          {
-            // llarp::LogInfo("CoDelQueue::Process - single item: lowest ",
-            // lowest, " dropMs: ", dropMs);
-            if (lowest > dropMs)
-            {
-              item->~T();
-              nextTickInterval += initialIntervalMs / uint64_t(std::sqrt(++dropNum));
-              firstPut = 0s;
-              nextTickAt = start + nextTickInterval;
-              return;
-            }
-
-            nextTickInterval = initialIntervalMs;
-            dropNum = 0;
-          }
-          visitor(*item);
-          item->~T();
+          nextTickInterval = initialIntervalMs;
+          dropNum = 0;
+          nextTickAt = 0s;
         }
-        firstPut = 0s;
-        nextTickAt = start + nextTickInterval;
+        for (size_t idx = 0; idx < num; ++idx)
+          visitor(*m_Batch[idx]);
+        // what does not fit back in the free ring is let go
+        m_Free.tryPushBack(m_Batch.data(), m_Batch.size());
+        m_Batch.clear();
       }
 
       const llarp_time_t initialIntervalMs = 5ms;
       const llarp_time_t dropMs = 100ms;
-      llarp_time_t firstPut = 0s;
       size_t dropNum = 0;
       llarp_time_t nextTickInterval = initialIntervalMs;
       llarp_time_t nextTickAt = 0s;
-      Mutex_t m_QueueMutex;
-      size_t m_QueueIdx GUARDED_BY(m_QueueMutex);
-      std::array<T, MaxSize> m_Queue GUARDED_BY(m_QueueMutex);
+
+     private:
+      /// producer only, an item made from args in a recycled handle if there is one
+      template <typename... Args>
+      Handle_t
+      Make(Args&&... args)
+      {
+        Handle_t item = std::move(m_Spare);
+        if (item or m_Free.tryPopFront(item))
+        {
+          item->~T();
+          new (item.get()) T(std::forward<Args>(args)...);
+          return item;
+        }
+        return std::make_unique<T>(std::forward<Args>(args)...);
+      }
+
+      /// producer to consumer
+      thread::SpscQueue<Handle_t> m_Queue;
+      /// consumer to producer, handles to fill again
+      thread::SpscQueue<Handle_t> m_Free;
+      /// producer only, a handle whose item was turned down
+      Handle_t m_Spare;
+      /// consumer only
+      std::vector<Handle_t> m_Batch;
       std::string m_name;
       GetTime _getTime;
       PutTime _putTime;
       GetNow _getNow;
+      Mark _mark;
+      uint64_t m_Marks = 0;
     };  // namespace util
   }     // namespace util
 }  // namespace llarp
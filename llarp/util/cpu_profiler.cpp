@@ -0,0 +1,206 @@
+#include <util/cpu_profiler.hpp>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#define LOKINET_CPU_PROFILER
+#endif
+
+#ifdef LOKINET_CPU_PROFILER
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/time.h>
+#endif
+
+namespace llarp
+{
+  namespace util
+  {
+#ifdef LOKINET_CPU_PROFILER
+    namespace
+    {
+      constexpr size_t MaxDepth = 48;
+      constexpr size_t MaxSamples = 16384;
+      /// the handler and the signal trampoline
+      constexpr int SkipFrames = 2;
+
+      struct Sample
+      {
+        void* frames[MaxDepth];
+        int depth;
+        char thread[16];
+      };
+
+      std::atomic<bool> g_Running{false};
+      /// only set while sampling, the handler does nothing without it
+      std::atomic<Sample*> g_Samples{nullptr};
+      std::atomic<size_t> g_NextSample{0};
+      std::atomic<uint64_t> g_Dropped{0};
+      /// handlers still running, the buffer is not read until they are done
+      std::atomic<int> g_InHandler{0};
+
+      void
+      OnProf(int, siginfo_t*, void*)
+      {
+        const int saved = errno;
+        g_InHandler.fetch_add(1);
+        if (auto* samples = g_Samples.load())
+        {
+          const auto idx = g_NextSample.fetch_add(1, std::memory_order_relaxed);
+          if (idx < MaxSamples)
+          {
+            auto& sample = samples[idx];
+            sample.depth = backtrace(sample.frames, MaxDepth);
+            if (prctl(PR_GET_NAME, sample.thread) != 0)
+              sample.thread[0] = 0;
+          }
+          else
+            g_Dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        g_InHandler.fetch_sub(1);
+        errno = saved;
+      }
+
+      std::string
+      FrameName(void* addr)
+      {
+        Dl_info info{};
+        if (dladdr(addr, &info) == 0)
+        {
+          std::ostringstream out;
+          out << addr;
+          return out.str();
+        }
+        if (info.dli_sname)
+        {
+          int status = 0;
+          char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+          std::string name = status == 0 ? demangled : info.dli_sname;
+          std::free(demangled);
+          return name;
+        }
+        const char* module = info.dli_fname ? std::strrchr(info.dli_fname, '/') : nullptr;
+        std::ostringstream out;
+        out << (module ? module + 1 : "?") << "+0x" << std::hex
+            << (static_cast<const char*>(addr) - static_cast<const char*>(info.dli_fbase));
+        return out.str();
+      }
+
+      std::string
+      Fold(const std::vector<Sample>& samples, size_t count)
+      {
+        std::unordered_map<void*, std::string> names;
+        std::map<std::string, uint64_t> stacks;
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+          const auto& sample = samples[idx];
+          std::string stack = sample.thread[0] ? sample.thread : "?";
+          for (int frame = sample.depth - 1; frame >= SkipFrames; --frame)
+          {
+            auto* addr = sample.frames[frame];
+            auto itr = names.find(addr);
+            if (itr == names.end())
+              itr = names.emplace(addr, FrameName(addr)).first;
+            stack += ';';
+            stack += itr->second;
+          }
+          stacks[stack]++;
+        }
+        std::string folded;
+        for (const auto& [stack, hits] : stacks)
+        {
+          folded += stack;
+          folded += ' ';
+          folded += std::to_string(hits);
+          folded += '\n';
+        }
+        return folded;
+      }
+    }  // namespace
+
+    bool
+    CpuProfilingSupported()
+    {
+      return true;
+    }
+
+    std::optional<CpuProfile>
+    ProfileCpu(std::chrono::milliseconds duration, int hz)
+    {
+      if (g_Running.exchange(true))
+        return std::nullopt;
+
+      // the first backtrace loads the unwinder, which must not happen in the handler
+      void* warm[1];
+      backtrace(warm, 1);
+
+      std::vector<Sample> samples(MaxSamples);
+      g_NextSample = 0;
+      g_Dropped = 0;
+      g_Samples.store(samples.data());
+
+      struct sigaction action
+      {
+      };
+      struct sigaction previous
+      {
+      };
+      action.sa_sigaction = &OnProf;
+      action.sa_flags = SA_SIGINFO | SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGPROF, &action, &previous);
+
+      const auto usec = 1000000 / std::max(1, hz);
+      itimerval timer{};
+      timer.it_interval.tv_sec = usec / 1000000;
+      timer.it_interval.tv_usec = usec % 1000000;
+      timer.it_value = timer.it_interval;
+      setitimer(ITIMER_PROF, &timer, nullptr);
+
+      std::this_thread::sleep_for(duration);
+
+      timer = itimerval{};
+      setitimer(ITIMER_PROF, &timer, nullptr);
+      g_Samples.store(nullptr);
+      while (g_InHandler.load() > 0)
+        std::this_thread::yield();
+      // a signal raised before the timer stopped can still be pending and the default action
+      // is to exit, so ours stays installed, doing nothing, unless someone else had one
+      if (previous.sa_handler != SIG_DFL)
+        sigaction(SIGPROF, &previous, nullptr);
+
+      const auto count = std::min(g_NextSample.load(), MaxSamples);
+      CpuProfile profile;
+      profile.samples = count;
+      profile.dropped = g_Dropped.load();
+      profile.folded = Fold(samples, count);
+      g_Running = false;
+      return profile;
+    }
+#else
+    bool
+    CpuProfilingSupported()
+    {
+      return false;
+    }
+
+    std::optional<CpuProfile>
+    ProfileCpu(std::chrono::milliseconds, int)
+    {
+      return std::nullopt;
+    }
+#endif
+  }  // namespace util
+}  // namespace llarp
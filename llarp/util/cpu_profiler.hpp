@@ -0,0 +1,35 @@
+#ifndef LLARP_UTIL_CPU_PROFILER_HPP
+#define LLARP_UTIL_CPU_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace llarp
+{
+  namespace util
+  {
+    struct CpuProfile
+    {
+      /// one line per distinct stack, "thread;outer;...;inner count", as flamegraph tools take
+      std::string folded;
+      uint64_t samples = 0;
+      /// samples that did not fit in the buffer
+      uint64_t dropped = 0;
+    };
+
+    /// false where there is no way to take a stack from a signal handler, ProfileCpu then
+    /// always returns nothing
+    bool
+    CpuProfilingSupported();
+
+    /// samples the stack of whichever thread is on the cpu, hz times per second of cpu the
+    /// process uses, and blocks until duration is up. frames that are not exported show as
+    /// module+offset for addr2line. nothing if a profile is already running
+    std::optional<CpuProfile>
+    ProfileCpu(std::chrono::milliseconds duration, int hz);
+  }  // namespace util
+}  // namespace llarp
+
+#endif
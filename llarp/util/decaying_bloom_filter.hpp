@@ -0,0 +1,196 @@
+#ifndef LLARP_UTIL_DECAYING_BLOOM_FILTER_HPP
+#define LLARP_UTIL_DECAYING_BLOOM_FILTER_HPP
+
+#include <util/time.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// fixed size replay filter for values that are already uniformly random, like nonces
+    /// values go into the newer of two generations of bloom bits, and the older generation is
+    /// dropped once the newer one is interval old or has had capacity values put in it. so a
+    /// value is remembered for at least interval or capacity inserts, whichever comes first,
+    /// and a fresh value is taken for a replay at about fpRate. nothing is allocated until the
+    /// first insert and a filter that sat idle until both generations went stale lets go of
+    /// its bits, so idle filters cost nothing
+    template <typename Val_t>
+    struct DecayingBloomFilter
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      DecayingBloomFilter(size_t capacity, double fpRate, Time_t interval = 5s)
+          : m_Capacity{std::max(capacity, size_t{1})}, m_Interval{interval}
+      {
+        static_assert(sizeof(Val_t) >= 16, "values need at least 16 bytes to hash from");
+        fpRate = std::clamp(fpRate, 1e-12, 0.5);
+        const double ln2 = std::log(2.0);
+        const double bits = -double(m_Capacity) * std::log(fpRate) / (ln2 * ln2);
+        size_t numBits = 64;
+        while (numBits < bits)
+          numBits <<= 1;
+        m_Mask = numBits - 1;
+        m_Hashes = std::clamp<size_t>(std::lround(double(numBits) / m_Capacity * ln2), 1, 16);
+        static thread_local std::mt19937_64 rng{std::random_device{}()};
+        m_Seeds[0] = rng();
+        m_Seeds[1] = rng();
+      }
+
+      /// return true if inserted
+      /// return false if v is in the filter, which it may be by chance
+      bool
+      Insert(const Val_t& v, Time_t now = 0s)
+      {
+        Decay(now);
+        if (Contains(v))
+          return false;
+        if (m_Inserted >= m_Capacity)
+          Rotate();
+        if (m_Bits.empty())
+          m_Bits.resize(2 * Words());
+        ForEachBit(v, [this](size_t bit) {
+          m_Bits[m_Current * Words() + bit / 64] |= uint64_t{1} << (bit % 64);
+          return true;
+        });
+        m_Inserted++;
+        return true;
+      }
+
+      bool
+      Contains(const Val_t& v) const
+      {
+        if (m_Bits.empty())
+          return false;
+        for (size_t gen = 0; gen < 2; ++gen)
+        {
+          const uint64_t* bits = m_Bits.data() + gen * Words();
+          bool all = true;
+          ForEachBit(v, [bits, &all](size_t bit) {
+            all = bits[bit / 64] & (uint64_t{1} << (bit % 64));
+            return all;
+          });
+          if (all)
+            return true;
+        }
+        return false;
+      }
+
+      /// drop generations that have been around longer than the interval
+      void
+      Decay(Time_t now = 0s)
+      {
+        if (now == 0s)
+          now = llarp::coarse_now_ms();
+        if (m_Bits.empty())
+        {
+          // nothing to forget yet, the first generation starts with the first insert
+          m_Started = now;
+          return;
+        }
+        if (now < m_Started + m_Interval)
+          return;
+        if (now >= m_Started + 2 * m_Interval)
+        {
+          // idle for long enough that both generations are stale, the next insert allocates
+          // them again
+          m_Bits.clear();
+          m_Bits.shrink_to_fit();
+          m_Inserted = 0;
+          return;
+        }
+        Rotate();
+        m_Started = now;
+      }
+
+      /// bytes of filter we hold
+      size_t
+      MemoryUsage() const
+      {
+        return m_Bits.capacity() * sizeof(uint64_t);
+      }
+
+      size_t
+      NumHashes() const
+      {
+        return m_Hashes;
+      }
+
+      size_t
+      NumBits() const
+      {
+        return m_Mask + 1;
+      }
+
+      Time_t
+      DecayInterval() const
+      {
+        return m_Interval;
+      }
+
+     private:
+      size_t
+      Words() const
+      {
+        return (m_Mask + 1) / 64;
+      }
+
+      /// clear the older generation and make it the current one
+      void
+      Rotate()
+      {
+        m_Current ^= 1;
+        if (not m_Bits.empty())
+          std::fill_n(m_Bits.begin() + m_Current * Words(), Words(), 0);
+        m_Inserted = 0;
+      }
+
+      /// visit the bits for v until visit returns false, double hashing 2 words of v mixed with
+      /// our seeds so nobody can pick values that collide in somebody else's filter
+      template <typename Visit_t>
+      void
+      ForEachBit(const Val_t& v, Visit_t visit) const
+      {
+        uint64_t words[2];
+        std::memcpy(words, &v, sizeof(words));
+        const uint64_t h1 = Mix(words[0] ^ m_Seeds[0]);
+        const uint64_t h2 = Mix(words[1] ^ m_Seeds[1]) | 1;
+        for (size_t idx = 0; idx < m_Hashes; ++idx)
+        {
+          if (not visit((h1 + idx * h2) & m_Mask))
+            return;
+        }
+      }
+
+      static uint64_t
+      Mix(uint64_t x)
+      {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+      }
+
+      size_t m_Capacity;
+      Time_t m_Interval;
+      size_t m_Mask;
+      size_t m_Hashes;
+      uint64_t m_Seeds[2];
+      /// both generations back to back
+      std::vector<uint64_t> m_Bits;
+      size_t m_Current = 0;
+      size_t m_Inserted = 0;
+      Time_t m_Started = 0s;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
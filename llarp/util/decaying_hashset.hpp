@@ -2,18 +2,73 @@
 #define LLARP_UTIL_DECAYING_HASHSET_HPP
 
 #include <util/time.hpp>
+
+#include <algorithm>
+#include <deque>
 #include <unordered_map>
 
 namespace llarp
 {
   namespace util
   {
+    /// keys of a decaying container by when they went in, oldest first, so decaying only
+    /// touches what expires. times are expected to mostly go forwards, one earlier than the
+    /// newest is placed where it belongs
+    template <typename Key_t>
+    struct InsertionOrder
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      void
+      Add(const Key_t& k, Time_t when)
+      {
+        if (m_Order.empty() or m_Order.back().first <= when)
+        {
+          m_Order.emplace_back(when, k);
+          return;
+        }
+        const auto itr = std::upper_bound(
+            m_Order.begin(), m_Order.end(), when, [](Time_t t, const auto& item) {
+              return t < item.first;
+            });
+        m_Order.emplace(itr, when, k);
+      }
+
+      /// pass every key added at or before cutoff to expire and forget them
+      template <typename Expire_t>
+      void
+      ExpireUntil(Time_t cutoff, Expire_t expire)
+      {
+        while (not m_Order.empty() and m_Order.front().first <= cutoff)
+          ExpireOldest(expire);
+      }
+
+      template <typename Expire_t>
+      void
+      ExpireOldest(Expire_t expire)
+      {
+        expire(m_Order.front().second);
+        m_Order.pop_front();
+      }
+
+      size_t
+      Size() const
+      {
+        return m_Order.size();
+      }
+
+     private:
+      std::deque<std::pair<Time_t, Key_t>> m_Order;
+    };
+
     template <typename Val_t, typename Hash_t = typename Val_t::Hash>
     struct DecayingHashSet
     {
       using Time_t = std::chrono::milliseconds;
 
-      DecayingHashSet(Time_t cacheInterval = 5s) : m_CacheInterval(cacheInterval)
+      /// maxSize, if not 0, is how many values are kept at most, the oldest going to make room
+      DecayingHashSet(Time_t cacheInterval = 5s, size_t maxSize = 0)
+          : m_CacheInterval(cacheInterval), m_MaxSize(maxSize)
       {}
       /// determine if we have v contained in our decaying hashset
       bool
@@ -28,17 +83,23 @@ namespace llarp
       Insert(const Val_t& v, Time_t now = 0s)
       {
         if (now == 0s)
-          now = llarp::time_now_ms();
-        return m_Values.try_emplace(v, now).second;
+          now = llarp::coarse_now_ms();
+        if (not m_Values.try_emplace(v, now).second)
+          return false;
+        m_Order.Add(v, now);
+        if (m_MaxSize and m_Values.size() > m_MaxSize)
+          m_Order.ExpireOldest([this](const Val_t& old) { m_Values.erase(old); });
+        return true;
       }
 
-      /// decay hashset entries
+      /// decay hashset entries, only the ones that expire are looked at
       void
       Decay(Time_t now = 0s)
       {
         if (now == 0s)
-          now = llarp::time_now_ms();
-        EraseIf([&](const auto& item) { return (m_CacheInterval + item.second) <= now; });
+          now = llarp::coarse_now_ms();
+        m_Order.ExpireUntil(
+            now - m_CacheInterval, [this](const Val_t& old) { m_Values.erase(old); });
       }
 
       Time_t
@@ -53,32 +114,23 @@ namespace llarp
         return m_Values.empty();
       }
 
-      void
-      DecayInterval(Time_t interval)
+      size_t
+      Size() const
       {
-        m_CacheInterval = interval;
+        return m_Values.size();
       }
 
-     private:
-      template <typename Predicate_t>
       void
-      EraseIf(Predicate_t pred)
+      DecayInterval(Time_t interval)
       {
-        for (auto i = m_Values.begin(), last = m_Values.end(); i != last;)
-        {
-          if (pred(*i))
-          {
-            i = m_Values.erase(i);
-          }
-          else
-          {
-            ++i;
-          }
-        }
+        m_CacheInterval = interval;
       }
 
+     private:
       Time_t m_CacheInterval;
+      size_t m_MaxSize;
       std::unordered_map<Val_t, Time_t, Hash_t> m_Values;
+      InsertionOrder<Val_t> m_Order;
     };
   }  // namespace util
 }  // namespace llarp
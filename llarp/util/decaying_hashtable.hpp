@@ -1,6 +1,8 @@
 #pragma once
 
+#include <util/decaying_hashset.hpp>
 #include <util/time.hpp>
+#include <optional>
 #include <unordered_map>
 
 namespace llarp::util
@@ -8,13 +10,16 @@ namespace llarp::util
   template <typename Key_t, typename Value_t, typename Hash_t = typename Key_t::Hash>
   struct DecayingHashTable
   {
-    DecayingHashTable(std::chrono::milliseconds cacheInterval = 1h) : m_CacheInterval(cacheInterval)
+    /// maxSize, if not 0, is how many entries are kept at most, the oldest going to make room
+    DecayingHashTable(std::chrono::milliseconds cacheInterval = 1h, size_t maxSize = 0)
+        : m_CacheInterval(cacheInterval), m_MaxSize(maxSize)
     {}
 
+    /// only the entries that expire are looked at
     void
     Decay(llarp_time_t now)
     {
-      EraseIf([&](const auto& item) { return item.second.second + m_CacheInterval <= now; });
+      m_Order.ExpireUntil(now - m_CacheInterval, [this](const Key_t& k) { m_Values.erase(k); });
     }
 
     bool
@@ -29,8 +34,15 @@ namespace llarp::util
     Put(Key_t key, Value_t value, llarp_time_t now = 0s)
     {
       if (now == 0s)
-        now = llarp::time_now_ms();
-      return m_Values.try_emplace(std::move(key), std::make_pair(std::move(value), now)).second;
+        now = llarp::coarse_now_ms();
+      const auto [itr, inserted] =
+          m_Values.try_emplace(std::move(key), std::make_pair(std::move(value), now));
+      if (not inserted)
+        return false;
+      m_Order.Add(itr->first, now);
+      if (m_MaxSize and m_Values.size() > m_MaxSize)
+        m_Order.ExpireOldest([this](const Key_t& k) { m_Values.erase(k); });
+      return true;
     }
 
     std::optional<Value_t>
@@ -42,25 +54,16 @@ namespace llarp::util
       return itr->second.first;
     }
 
-   private:
-    template <typename Predicate_t>
-    void
-    EraseIf(Predicate_t pred)
+    size_t
+    Size() const
     {
-      for (auto i = m_Values.begin(), last = m_Values.end(); i != last;)
-      {
-        if (pred(*i))
-        {
-          i = m_Values.erase(i);
-        }
-        else
-        {
-          ++i;
-        }
-      }
+      return m_Values.size();
     }
 
+   private:
     llarp_time_t m_CacheInterval;
+    size_t m_MaxSize;
     std::unordered_map<Key_t, std::pair<Value_t, llarp_time_t>, Hash_t> m_Values;
+    InsertionOrder<Key_t> m_Order;
   };
 }  // namespace llarp::util
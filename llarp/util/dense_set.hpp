@@ -0,0 +1,85 @@
+#ifndef LLARP_UTIL_DENSE_SET_HPP
+#define LLARP_UTIL_DENSE_SET_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// a set kept packed in a vector so a uniform random member is one index away.
+    /// removal swaps the last value into the hole, so order is not kept
+    template <typename Val_t, typename Hash_t = typename Val_t::Hash>
+    struct DenseSet
+    {
+      /// return true if inserted
+      /// return false if it was already in the set
+      bool
+      Insert(const Val_t& v)
+      {
+        if (not m_Slots.try_emplace(v, m_Values.size()).second)
+          return false;
+        m_Values.push_back(v);
+        return true;
+      }
+
+      /// return true if v was in the set
+      bool
+      Remove(const Val_t& v)
+      {
+        auto itr = m_Slots.find(v);
+        if (itr == m_Slots.end())
+          return false;
+        const size_t slot = itr->second;
+        m_Slots.erase(itr);
+        if (slot + 1 != m_Values.size())
+        {
+          m_Values[slot] = std::move(m_Values.back());
+          m_Slots[m_Values[slot]] = slot;
+        }
+        m_Values.pop_back();
+        return true;
+      }
+
+      bool
+      Contains(const Val_t& v) const
+      {
+        return m_Slots.count(v) != 0;
+      }
+
+      void
+      Clear()
+      {
+        m_Slots.clear();
+        m_Values.clear();
+      }
+
+      size_t
+      Size() const
+      {
+        return m_Values.size();
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Values.empty();
+      }
+
+      /// the member at idx, idx < Size()
+      const Val_t&
+      operator[](size_t idx) const
+      {
+        return m_Values[idx];
+      }
+
+     private:
+      std::unordered_map<Val_t, size_t, Hash_t> m_Slots;
+      std::vector<Val_t> m_Values;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
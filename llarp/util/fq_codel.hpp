@@ -0,0 +1,269 @@
+#ifndef LLARP_UTIL_FQ_CODEL_HPP
+#define LLARP_UTIL_FQ_CODEL_HPP
+
+#include <util/codel.hpp>
+#include <util/histogram.hpp>
+#include <util/time.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// fair queueing over flows with codel on each, after rfc 8290. items hash into NumFlows
+    /// queues that are served deficit round robin a Quantum of bytes at a time, new flows
+    /// first, so a bulk flow cannot hold up the others. a flow whose items sat longer than
+    /// Target for an Interval has items dropped at its head until it drains, or marked where
+    /// Mark can, which then go on as rfc 8290 has for ecn. not thread safe.
+    template <typename T, size_t NumFlows = 64, size_t MaxItems = 1024, typename Mark = NeverMark>
+    struct FlowQueues
+    {
+      static constexpr auto Target = 5ms;
+      static constexpr auto Interval = 100ms;
+      /// bytes a flow may send per round
+      static constexpr int64_t Quantum = 1500;
+
+      /// queue item of size bytes for the flow with this hash. when full the head of the flow
+      /// holding the most bytes is dropped to make room
+      void
+      Push(uint32_t hash, T item, size_t size, llarp_time_t now)
+      {
+        const size_t idx = hash % NumFlows;
+        auto& flow = m_Flows[idx];
+        flow.items.push_back(Entry{std::move(item), size, now});
+        flow.bytes += size;
+        ++m_Size;
+        if (not flow.active)
+        {
+          flow.active = true;
+          flow.deficit = Quantum;
+          m_NewFlows.push_back(idx);
+        }
+        if (m_Size <= MaxItems)
+          return;
+        size_t fattest = 0;
+        for (size_t i = 1; i < NumFlows; ++i)
+        {
+          if (m_Flows[i].bytes > m_Flows[fattest].bytes)
+            fattest = i;
+        }
+        DropHead(m_Flows[fattest]);
+      }
+
+      /// hand items to visit in fair order until budget bytes went or nothing is left, return
+      /// the bytes handed over
+      template <typename Visit_t>
+      size_t
+      Pop(llarp_time_t now, size_t budget, Visit_t visit)
+      {
+        size_t sent = 0;
+        while (sent < budget)
+        {
+          const bool fromNew = not m_NewFlows.empty();
+          auto& list = fromNew ? m_NewFlows : m_OldFlows;
+          if (list.empty())
+            break;
+          const size_t idx = list.front();
+          auto& flow = m_Flows[idx];
+          if (flow.deficit <= 0)
+          {
+            flow.deficit += Quantum;
+            list.pop_front();
+            m_OldFlows.push_back(idx);
+            continue;
+          }
+          auto entry = Dequeue(flow, now);
+          if (not entry)
+          {
+            list.pop_front();
+            // a new flow that went empty goes through the old list once so it cannot come
+            // back as new straight away and jump the queue
+            if (fromNew)
+              m_OldFlows.push_back(idx);
+            else
+              flow.active = false;
+            continue;
+          }
+          flow.deficit -= entry->size;
+          m_Delays.Add(now - entry->queued);
+          sent += entry->size;
+          visit(entry->item);
+        }
+        return sent;
+      }
+
+      size_t
+      Size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Size == 0;
+      }
+
+      /// items dropped for sitting too long or for room
+      uint64_t
+      Drops() const
+      {
+        return m_Drops;
+      }
+
+      /// items marked instead of dropped for sitting too long
+      uint64_t
+      Marks() const
+      {
+        return m_Marks;
+      }
+
+      /// how long items that went out sat in the queue
+      const DurationHistogram&
+      Delays() const
+      {
+        return m_Delays;
+      }
+
+     private:
+      struct Entry
+      {
+        T item;
+        size_t size;
+        llarp_time_t queued;
+      };
+
+      struct Flow
+      {
+        std::deque<Entry> items;
+        size_t bytes = 0;
+        int64_t deficit = 0;
+        bool active = false;
+        /// codel state
+        llarp_time_t firstAboveTime = 0s;
+        llarp_time_t dropNext = 0s;
+        uint32_t count = 0;
+        bool dropping = false;
+      };
+
+      static llarp_time_t
+      ControlLaw(llarp_time_t t, uint32_t count)
+      {
+        const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(Interval);
+        return t
+            + std::chrono::duration_cast<llarp_time_t>(
+                   interval / std::sqrt(double(std::max<uint32_t>(count, 1))));
+      }
+
+      void
+      DropHead(Flow& flow)
+      {
+        if (flow.items.empty())
+          return;
+        flow.bytes -= flow.items.front().size;
+        flow.items.pop_front();
+        --m_Size;
+        ++m_Drops;
+      }
+
+      std::optional<Entry>
+      PopHead(Flow& flow)
+      {
+        if (flow.items.empty())
+          return std::nullopt;
+        Entry entry = std::move(flow.items.front());
+        flow.items.pop_front();
+        flow.bytes -= entry.size;
+        --m_Size;
+        return entry;
+      }
+
+      /// true if the head that just left sat too long for long enough
+      bool
+      OkToDrop(Flow& flow, const Entry& entry, llarp_time_t now)
+      {
+        if (now - entry.queued < Target or flow.bytes <= size_t(Quantum))
+        {
+          flow.firstAboveTime = 0s;
+          return false;
+        }
+        if (flow.firstAboveTime == 0s)
+        {
+          flow.firstAboveTime = now + Interval;
+          return false;
+        }
+        return now >= flow.firstAboveTime;
+      }
+
+      std::optional<Entry>
+      Dequeue(Flow& flow, llarp_time_t now)
+      {
+        auto entry = PopHead(flow);
+        if (not entry)
+        {
+          flow.dropping = false;
+          return std::nullopt;
+        }
+        bool drop = OkToDrop(flow, *entry, now);
+        if (flow.dropping)
+        {
+          if (not drop)
+          {
+            flow.dropping = false;
+            return entry;
+          }
+          while (now >= flow.dropNext and flow.dropping)
+          {
+            ++flow.count;
+            if (m_Mark(entry->item))
+            {
+              ++m_Marks;
+              flow.dropNext = ControlLaw(flow.dropNext, flow.count);
+              break;
+            }
+            ++m_Drops;
+            entry = PopHead(flow);
+            if (not entry or not OkToDrop(flow, *entry, now))
+              flow.dropping = false;
+            else
+              flow.dropNext = ControlLaw(flow.dropNext, flow.count);
+          }
+          return entry;
+        }
+        if (drop)
+        {
+          if (m_Mark(entry->item))
+            ++m_Marks;
+          else
+          {
+            ++m_Drops;
+            entry = PopHead(flow);
+          }
+          flow.dropping = true;
+          // pick up where the last drop state left off if it ended lately
+          const bool recent = flow.count > 2 and now - flow.dropNext < Interval * 16;
+          flow.count = recent ? flow.count - 2 : 1;
+          flow.dropNext = ControlLaw(now, flow.count);
+        }
+        return entry;
+      }
+
+      std::array<Flow, NumFlows> m_Flows;
+      std::deque<size_t> m_NewFlows;
+      std::deque<size_t> m_OldFlows;
+      size_t m_Size = 0;
+      uint64_t m_Drops = 0;
+      uint64_t m_Marks = 0;
+      Mark m_Mark;
+      DurationHistogram m_Delays;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef LLARP_UTIL_HISTOGRAM_HPP
+#define LLARP_UTIL_HISTOGRAM_HPP
+
+#include <util/status.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// counts of durations in power of two millisecond buckets: under 1ms, under 2ms, under
+    /// 4ms and so on, the last bucket takes everything longer. for seeing how often something
+    /// that should be quick stalls and how badly, without keeping every sample
+    struct DurationHistogram
+    {
+      static constexpr size_t NumBuckets = 12;
+
+      void
+      Add(std::chrono::microseconds dur)
+      {
+        const uint64_t ms = std::max<int64_t>(dur.count(), 0) / 1000;
+        size_t bucket = 0;
+        while (bucket + 1 < NumBuckets and ms >= (uint64_t{1} << bucket))
+          ++bucket;
+        m_Buckets[bucket]++;
+        m_Count++;
+        m_Total += dur;
+        m_Max = std::max(m_Max, dur);
+        m_Last = dur;
+      }
+
+      uint64_t
+      Count() const
+      {
+        return m_Count;
+      }
+
+      std::chrono::microseconds
+      Max() const
+      {
+        return m_Max;
+      }
+
+      util::StatusObject
+      ExtractStatus() const
+      {
+        util::StatusObject buckets;
+        for (size_t bucket = 0; bucket < NumBuckets; ++bucket)
+        {
+          const std::string name = bucket + 1 < NumBuckets
+              ? "<" + std::to_string(uint64_t{1} << bucket) + "ms"
+              : ">=" + std::to_string(uint64_t{1} << (bucket - 1)) + "ms";
+          buckets[name] = m_Buckets[bucket];
+        }
+        return util::StatusObject{
+            {"count", m_Count},
+            {"buckets", buckets},
+            {"lastUs", m_Last.count()},
+            {"maxUs", m_Max.count()},
+            {"meanUs", m_Count ? m_Total.count() / int64_t(m_Count) : 0}};
+      }
+
+     private:
+      std::array<uint64_t, NumBuckets> m_Buckets{};
+      uint64_t m_Count = 0;
+      std::chrono::microseconds m_Total{0};
+      std::chrono::microseconds m_Max{0};
+      std::chrono::microseconds m_Last{0};
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef LLARP_UTIL_ID_RING_HPP
+#define LLARP_UTIL_ID_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// map from mostly sequential ids to values kept in one flat ring, an id lives in slot
+    /// id % capacity so lookups never chase pointers
+    /// the ring doubles until every live id has its own slot, ids that would need more than
+    /// MaxCapacity slots at once are refused
+    template <typename Val_t, size_t MaxCapacity = 1024, size_t InitialCapacity = 8>
+    struct IdRing
+    {
+      static_assert((MaxCapacity & (MaxCapacity - 1)) == 0, "capacity must be a power of 2");
+      static_assert((InitialCapacity & (InitialCapacity - 1)) == 0, "capacity must be a power of 2");
+
+      Val_t*
+      Find(uint64_t id)
+      {
+        if (m_Slots.empty())
+          return nullptr;
+        auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+        if (slot.value.has_value() and slot.id == id)
+          return &*slot.value;
+        return nullptr;
+      }
+
+      const Val_t*
+      Find(uint64_t id) const
+      {
+        return const_cast<IdRing*>(this)->Find(id);
+      }
+
+      bool
+      Contains(uint64_t id) const
+      {
+        return Find(id) != nullptr;
+      }
+
+      /// returns the value for id and true if we made it, or nullptr if there is no room
+      /// pointers are invalidated when we grow
+      template <typename... Args_t>
+      std::pair<Val_t*, bool>
+      Emplace(uint64_t id, Args_t&&... args)
+      {
+        if (auto* existing = Find(id))
+          return {existing, false};
+        if (m_Slots.empty())
+          m_Slots.resize(InitialCapacity);
+        while (true)
+        {
+          auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+          if (not slot.value.has_value())
+          {
+            slot.id = id;
+            slot.value.emplace(std::forward<Args_t>(args)...);
+            m_Size++;
+            return {&*slot.value, true};
+          }
+          if (m_Slots.size() >= MaxCapacity)
+            return {nullptr, false};
+          Grow();
+        }
+      }
+
+      /// remove and return the value for id
+      std::optional<Val_t>
+      Take(uint64_t id)
+      {
+        std::optional<Val_t> taken;
+        if (m_Slots.empty())
+          return taken;
+        auto& slot = m_Slots[id & (m_Slots.size() - 1)];
+        if (slot.value.has_value() and slot.id == id)
+        {
+          taken = std::move(slot.value);
+          slot.value.reset();
+          m_Size--;
+        }
+        return taken;
+      }
+
+      bool
+      Erase(uint64_t id)
+      {
+        return Take(id).has_value();
+      }
+
+      /// visit every entry as visit(id, value), visit must not add entries
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t visit)
+      {
+        for (auto& slot : m_Slots)
+        {
+          if (slot.value.has_value())
+            visit(slot.id, *slot.value);
+        }
+      }
+
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t visit) const
+      {
+        for (const auto& slot : m_Slots)
+        {
+          if (slot.value.has_value())
+            visit(slot.id, *slot.value);
+        }
+      }
+
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Size == 0;
+      }
+
+      size_t
+      Capacity() const
+      {
+        return m_Slots.size();
+      }
+
+     private:
+      struct Slot
+      {
+        uint64_t id = 0;
+        std::optional<Val_t> value;
+      };
+
+      void
+      Grow()
+      {
+        // ids that differ mod n also differ mod 2n so moving everything over never collides
+        std::vector<Slot> slots(m_Slots.size() * 2);
+        for (auto& slot : m_Slots)
+        {
+          if (not slot.value.has_value())
+            continue;
+          auto& dest = slots[slot.id & (slots.size() - 1)];
+          dest.id = slot.id;
+          dest.value = std::move(slot.value);
+        }
+        m_Slots = std::move(slots);
+      }
+
+      std::vector<Slot> m_Slots;
+      size_t m_Size = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
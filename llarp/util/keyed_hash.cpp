@@ -0,0 +1,25 @@
+#include <util/keyed_hash.hpp>
+
+extern "C"
+{
+  extern void
+  randombytes(unsigned char* const ptr, unsigned long long sz);
+}
+
+namespace llarp
+{
+  static HashKey
+  MakeProcessHashKey()
+  {
+    HashKey key;
+    randombytes(reinterpret_cast<unsigned char*>(key.data()), sizeof(key));
+    return key;
+  }
+
+  const HashKey&
+  ProcessHashKey()
+  {
+    static const HashKey key = MakeProcessHashKey();
+    return key;
+  }
+}  // namespace llarp
@@ -0,0 +1,78 @@
+#ifndef LLARP_UTIL_KEYED_HASH_HPP
+#define LLARP_UTIL_KEYED_HASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace llarp
+{
+  using HashKey = std::array<uint64_t, 2>;
+
+  /// the key every in memory table hashes under, random for each run of the process so
+  /// where keys will land cannot be worked out from outside
+  const HashKey&
+  ProcessHashKey();
+
+  namespace detail
+  {
+    /// both halves of the 128 bit product folded together, as in wyhash
+    inline uint64_t
+    HashMix(uint64_t a, uint64_t b)
+    {
+#ifdef __SIZEOF_INT128__
+      const __uint128_t product = __uint128_t{a} * b;
+      return uint64_t(product) ^ uint64_t(product >> 64);
+#else
+      const uint64_t aLo = uint32_t(a), aHi = a >> 32, bLo = uint32_t(b), bHi = b >> 32;
+      const uint64_t lo = aLo * bLo, mid1 = aHi * bLo, mid2 = aLo * bHi, hi = aHi * bHi;
+      const uint64_t cross = (lo >> 32) + uint32_t(mid1) + uint32_t(mid2);
+      return ((cross << 32) | uint32_t(lo)) ^ (hi + (mid1 >> 32) + (mid2 >> 32) + (cross >> 32));
+#endif
+    }
+
+    /// up to 8 bytes in host order, hashes are not kept past the process so that is fine
+    inline uint64_t
+    HashLoad(const uint8_t* ptr, size_t sz)
+    {
+      uint64_t word = 0;
+      std::memcpy(&word, ptr, sz);
+      return word;
+    }
+  }  // namespace detail
+
+  /// fast keyed hash for hash table keys in the style of wyhash, 16 bytes are taken at a time
+  /// and multiplied together under the key. not a mac, but without the key which keys
+  /// collide cannot be picked
+  inline uint64_t
+  KeyedHash(const void* data, size_t sz, const HashKey& key) noexcept
+  {
+    using namespace detail;
+    constexpr uint64_t Odd0 = 0xa0761d6478bd642fULL;
+    constexpr uint64_t Odd1 = 0xe7037ed1a0b428dbULL;
+    const auto* ptr = static_cast<const uint8_t*>(data);
+    uint64_t state = key[0] ^ Odd0;
+    size_t off = 0;
+    for (; off + 16 <= sz; off += 16)
+      state = HashMix(HashLoad(ptr + off, 8) ^ key[1] ^ Odd1, HashLoad(ptr + off + 8, 8) ^ state);
+    if (off < sz)
+    {
+      const size_t rest = sz - off;
+      const size_t first = rest < 8 ? rest : 8;
+      state = HashMix(
+          HashLoad(ptr + off, first) ^ key[1] ^ Odd1,
+          HashLoad(ptr + off + first, rest - first) ^ state);
+    }
+    return HashMix(state ^ key[1], sz ^ Odd1);
+  }
+
+  /// under ProcessHashKey
+  inline size_t
+  KeyedHash(const void* data, size_t sz) noexcept
+  {
+    return KeyedHash(data, sz, ProcessHashKey());
+  }
+}  // namespace llarp
+
+#endif
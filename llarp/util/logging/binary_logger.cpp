@@ -0,0 +1,170 @@
+#include <util/logging/binary_logger.hpp>
+
+#include <utility>
+
+namespace llarp
+{
+  /// what each entry in the file starts with, the file itself starts with the magic and a
+  /// version, which is written again each time the file is opened for another run
+  enum EntryKind : byte_t
+  {
+    EntrySite = 1,
+    EntryRecord = 2,
+    EntryDropped = 3,
+  };
+
+  static constexpr char Magic[] = "LLBL";
+  static constexpr byte_t Version = 1;
+
+  static std::atomic<uint64_t> s_NextGeneration{1};
+
+  /// the calling thread's ring in the last stream it logged to
+  struct LocalRingCache
+  {
+    uint64_t generation = 0;
+    void* ring = nullptr;
+  };
+
+  static thread_local LocalRingCache t_Ring;
+
+  BinaryLogStream::BinaryLogStream(
+      std::function<void(Work_t)> disk, FILE* f, llarp_time_t flushInterval)
+      : m_Disk(std::move(disk))
+      , m_File(f)
+      , m_FlushInterval(flushInterval)
+      , m_Generation(s_NextGeneration++)
+  {
+    Write(Magic, 4);
+    Write(&Version, 1);
+    fflush(m_File);
+  }
+
+  BinaryLogStream::~BinaryLogStream()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_RingsMutex);
+      for (auto& ring : m_Rings)
+        ring->disable();
+    }
+    ImmediateFlush();
+    fclose(m_File);
+  }
+
+  BinaryLogStream::Ring_t&
+  BinaryLogStream::LocalRing()
+  {
+    if (t_Ring.generation != m_Generation)
+    {
+      std::lock_guard<std::mutex> lock(m_RingsMutex);
+      m_Rings.emplace_back(std::make_unique<Ring_t>(RingSize));
+      t_Ring.generation = m_Generation;
+      t_Ring.ring = m_Rings.back().get();
+    }
+    return *static_cast<Ring_t*>(t_Ring.ring);
+  }
+
+  void
+  BinaryLogStream::Push(Record rec)
+  {
+    const auto now = rec.when;
+    auto& ring = LocalRing();
+    if (not ring.tryPushBack(std::move(rec)))
+      m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    if (ring.full())
+      m_LastFlush = 0s;
+    Tick(now);
+  }
+
+  void
+  BinaryLogStream::AppendLog(
+      LogLevel lvl, const char* fname, int lineno, const std::string&, const std::string msg)
+  {
+    Append(lvl, fname, lineno, msg);
+  }
+
+  void
+  BinaryLogStream::ImmediateFlush()
+  {
+    Drain();
+    m_LastFlush = time_now_ms();
+  }
+
+  void
+  BinaryLogStream::Tick(llarp_time_t now)
+  {
+    auto last = m_LastFlush.load();
+    // only whoever moves m_LastFlush on queues the drain
+    if (last < now and now - last >= m_FlushInterval
+        and m_LastFlush.compare_exchange_strong(last, now))
+      m_Disk([this]() { Drain(); });
+  }
+
+  void
+  BinaryLogStream::Write(const void* ptr, size_t sz)
+  {
+    fwrite(ptr, 1, sz, m_File);
+  }
+
+  void
+  BinaryLogStream::Drain()
+  {
+    std::unique_lock<std::mutex> drain(m_DrainMutex, std::try_to_lock);
+    if (not drain.owns_lock())
+      return;
+    std::vector<Ring_t*> rings;
+    {
+      std::lock_guard<std::mutex> lock(m_RingsMutex);
+      for (const auto& ring : m_Rings)
+        rings.push_back(ring.get());
+    }
+    bool wrote = false;
+    for (size_t idx = 0; idx < rings.size(); ++idx)
+    {
+      m_Batch.clear();
+      rings[idx]->popAll(m_Batch);
+      const uint16_t thread = idx;
+      for (const auto& rec : m_Batch)
+      {
+        auto& sites = m_Sites[rec.file];
+        auto itr = sites.find(rec.line);
+        if (itr == sites.end())
+        {
+          itr = sites.emplace(rec.line, m_NextSite++).first;
+          const byte_t kind = EntrySite;
+          const int32_t line = rec.line;
+          const std::string_view file{rec.file};
+          const uint16_t len = file.size();
+          Write(&kind, 1);
+          Write(&itr->second, sizeof(itr->second));
+          Write(&line, sizeof(line));
+          Write(&len, sizeof(len));
+          Write(file.data(), len);
+        }
+        const byte_t kind = EntryRecord;
+        const int64_t when = rec.when.count();
+        const byte_t level = rec.level;
+        const byte_t truncated = rec.truncated;
+        Write(&kind, 1);
+        Write(&when, sizeof(when));
+        Write(&thread, sizeof(thread));
+        Write(&level, 1);
+        Write(&itr->second, sizeof(itr->second));
+        Write(&truncated, 1);
+        Write(&rec.size, sizeof(rec.size));
+        Write(rec.data.data(), rec.size);
+        wrote = true;
+      }
+    }
+    if (const uint64_t dropped = Dropped(); dropped != m_DroppedWritten)
+    {
+      const byte_t kind = EntryDropped;
+      Write(&kind, 1);
+      Write(&dropped, sizeof(dropped));
+      m_DroppedWritten = dropped;
+      wrote = true;
+    }
+    m_Batch.clear();
+    if (wrote)
+      fflush(m_File);
+  }
+}  // namespace llarp
@@ -0,0 +1,224 @@
+#ifndef LLARP_UTIL_BINARY_LOGGER_HPP
+#define LLARP_UTIL_BINARY_LOGGER_HPP
+
+#include <util/logging/logstream.hpp>
+#include <util/thread/spsc_queue.hpp>
+#include <util/types.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  /// log stream that does not format. each thread puts compact records, the call site and the
+  /// raw arguments, on a ring of its own with no locks, and they are written out in binary
+  /// on the disk thread for contrib/py/logdecode to turn into text later. arguments that are
+  /// neither numbers nor strings are still formatted here, and bools and chars go as the
+  /// strings they would print as. records that find their ring full are counted and dropped
+  struct BinaryLogStream : public ILogStream
+  {
+    using Work_t = std::function<void(void)>;
+
+    /// argument tags in a record
+    enum ArgTag : byte_t
+    {
+      ArgSigned = 'i',
+      ArgUnsigned = 'u',
+      ArgFloat = 'f',
+      ArgString = 's',
+    };
+
+    /// what goes on a ring per log statement
+    struct Record
+    {
+      static constexpr size_t MaxData = 224;
+
+      llarp_time_t when = 0s;
+      const char* file = nullptr;
+      int line = 0;
+      LogLevel level = eLogInfo;
+      /// arguments did not all fit
+      bool truncated = false;
+      uint16_t size = 0;
+      std::array<byte_t, MaxData> data;
+
+      void
+      Put(const void* ptr, size_t sz)
+      {
+        if (truncated or size + sz > MaxData)
+        {
+          truncated = true;
+          return;
+        }
+        std::memcpy(data.data() + size, ptr, sz);
+        size += sz;
+      }
+
+      void
+      PutString(std::string_view str)
+      {
+        const uint16_t len = std::min<size_t>(str.size(), MaxData);
+        if (size + 1 + sizeof(len) + len > MaxData)
+        {
+          truncated = true;
+          return;
+        }
+        const byte_t tag = ArgString;
+        Put(&tag, 1);
+        Put(&len, sizeof(len));
+        Put(str.data(), len);
+      }
+
+      template <typename TArg>
+      void
+      PutArg(const TArg& arg)
+      {
+        using T = std::decay_t<TArg>;
+        if constexpr (std::is_same_v<T, bool>)
+          PutString(arg ? "1" : "0");
+        else if constexpr (
+            std::is_same_v<T, char> or std::is_same_v<T, signed char>
+            or std::is_same_v<T, unsigned char>)
+          PutString(std::string_view{reinterpret_cast<const char*>(&arg), 1});
+        else if constexpr (std::is_integral_v<T>)
+        {
+          if constexpr (std::is_signed_v<T>)
+            PutTagged(ArgSigned, int64_t(arg));
+          else
+            PutTagged(ArgUnsigned, uint64_t(arg));
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+          PutTagged(ArgFloat, double(arg));
+        else if constexpr (std::is_convertible_v<const TArg&, std::string_view>)
+          PutString(std::string_view{arg});
+        else
+        {
+          std::stringstream ss;
+          ss << arg;
+          PutString(ss.str());
+        }
+      }
+
+     private:
+      template <typename Val_t>
+      void
+      PutTagged(byte_t tag, Val_t val)
+      {
+        if (size + 1 + sizeof(val) > MaxData)
+        {
+          truncated = true;
+          return;
+        }
+        Put(&tag, 1);
+        Put(&val, sizeof(val));
+      }
+    };
+
+    static constexpr size_t RingSize = 1024;
+
+    BinaryLogStream(std::function<void(Work_t)> io, FILE* f, llarp_time_t flushInterval);
+
+    ~BinaryLogStream() override;
+
+    /// log without formatting, from any thread
+    template <typename... TArgs>
+    void
+    Append(LogLevel lvl, const char* fname, int lineno, TArgs&&... args)
+    {
+      Record rec;
+      rec.when = time_now_ms();
+      rec.file = fname;
+      rec.line = lineno;
+      rec.level = lvl;
+      (rec.PutArg(args), ...);
+      Push(std::move(rec));
+    }
+
+    BinaryLogStream*
+    AsBinary() override
+    {
+      return this;
+    }
+
+    void
+    PreLog(std::stringstream&, LogLevel, const char*, int, const std::string&) const override
+    {}
+
+    void
+    Print(LogLevel, const char*, const std::string&) override
+    {}
+
+    void
+    PostLog(std::stringstream&) const override
+    {}
+
+    /// for messages that were formatted anyway
+    void
+    AppendLog(
+        LogLevel lvl,
+        const char* fname,
+        int lineno,
+        const std::string& nodename,
+        const std::string msg) override;
+
+    void
+    ImmediateFlush() override;
+
+    void
+    Tick(llarp_time_t now) override;
+
+    /// records dropped because their thread's ring was full
+    uint64_t
+    Dropped() const
+    {
+      return m_Dropped.load(std::memory_order_relaxed);
+    }
+
+   private:
+    using Ring_t = thread::SpscQueue<Record>;
+
+    void
+    Push(Record rec);
+
+    /// the ring for the calling thread, made the first time it logs
+    Ring_t&
+    LocalRing();
+
+    /// move what is on the rings to the file, on the disk thread
+    void
+    Drain();
+
+    void
+    Write(const void* ptr, size_t sz);
+
+    const std::function<void(Work_t)> m_Disk;
+    FILE* const m_File;
+    const llarp_time_t m_FlushInterval;
+    std::atomic<llarp_time_t> m_LastFlush{0s};
+    /// told apart from any stream that was at this address before
+    const uint64_t m_Generation;
+    std::atomic<uint64_t> m_Dropped{0};
+
+    /// guards m_Rings as threads add theirs
+    std::mutex m_RingsMutex;
+    std::vector<std::unique_ptr<Ring_t>> m_Rings;
+
+    /// only one drain at a time as this is the consumer side of every ring
+    std::mutex m_DrainMutex;
+    /// call sites written to the file so far, by file name and line
+    std::unordered_map<const char*, std::unordered_map<int, uint32_t>> m_Sites;
+    uint32_t m_NextSite = 0;
+    std::vector<Record> m_Batch;
+    uint64_t m_DroppedWritten = 0;
+  };
+}  // namespace llarp
+
+#endif
@@ -3,6 +3,7 @@
 #include <util/logging/logger_syslog.hpp>
 #include <util/logging/file_logger.hpp>
 #include <util/logging/json_logger.hpp>
+#include <util/logging/binary_logger.hpp>
 #if defined(_WIN32)
 #include <util/logging/win32_logger.hpp>
 #endif
@@ -40,6 +41,8 @@ namespace llarp
       return LogType::Json;
     else if (str == "syslog")
       return LogType::Syslog;
+    else if (str == "binary")
+      return LogType::Binary;
 
     return LogType::Unknown;
   }
@@ -167,6 +170,13 @@ namespace llarp
         LogContext::Instance().logStream = std::make_unique<SysLogStream>();
 #endif
         break;
+      case LogType::Binary:
+        if (logfile == stdout)
+          throw std::invalid_argument("log type=binary needs a file to log to");
+        LogInfo("Switching logger to binary with file: ", file);
+        std::cout << std::flush;
+        LogContext::Instance().logStream = std::make_unique<BinaryLogStream>(io, logfile, 100ms);
+        break;
     }
   }
 
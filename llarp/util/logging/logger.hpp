@@ -5,6 +5,13 @@
 #include <util/time.hpp>
 #include <util/logging/logstream.hpp>
 #include <util/logging/logger_internal.hpp>
+#include <util/logging/binary_logger.hpp>
+#include <util/alloc_stats.hpp>
+
+/// log statements below this level are compiled out, see LOKINET_MIN_LOG_LEVEL in cmake
+#ifndef LOKINET_MIN_LOG_LEVEL
+#define LOKINET_MIN_LOG_LEVEL 0
+#endif
 
 namespace llarp
 {
@@ -14,6 +21,7 @@ namespace llarp
     File,
     Json,
     Syslog,
+    Binary,
   };
   LogType
   LogTypeFromString(const std::string&);
@@ -49,7 +57,7 @@ namespace llarp
     ///
     /// @param level is the new log level (below which log statements will be ignored)
     /// @param type is the type of logger to set up
-    /// @param file is the file to log to (relevant for types File and Json)
+    /// @param file is the file to log to (relevant for types File, Json and Binary)
     /// @param nickname is a tag to add to each log statement
     /// @param io is a callable that queues work that does io, async
     void
@@ -80,6 +88,19 @@ namespace llarp
   LogLevel
   GetLogLevel();
 
+  /** internal */
+  /// true if a statement logged at lvl would go anywhere. the log macros check this before
+  /// their arguments are evaluated, and for levels under LOKINET_MIN_LOG_LEVEL it folds to
+  /// false so the whole statement drops out
+  inline bool
+  _LogEnabled(LogLevel lvl) noexcept
+  {
+    if (lvl < LOKINET_MIN_LOG_LEVEL)
+      return false;
+    const auto& log = LogContext::Instance();
+    return log.curLevel <= lvl and log.logStream != nullptr;
+  }
+
   /** internal */
   template <typename... TArgs>
   inline static void
@@ -88,29 +109,40 @@ namespace llarp
     auto& log = LogContext::Instance();
     if (log.curLevel > lvl || log.logStream == nullptr)
       return;
+    alloc::Scope allocScope{alloc::Logging};
+    // left to be formatted offline
+    if (auto binary = log.logStream->AsBinary())
+    {
+      binary->Append(lvl, fname, lineno, std::forward<TArgs>(args)...);
+      return;
+    }
     std::stringstream ss;
     LogAppend(ss, std::forward<TArgs>(args)...);
     log.logStream->AppendLog(lvl, fname, lineno, log.nodeName, ss.str());
   }
 }  // namespace llarp
 
-#define LogTrace(...) _Log(llarp::eLogTrace, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogDebug(...) _Log(llarp::eLogDebug, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogInfo(...) _Log(llarp::eLogInfo, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogWarn(...) _Log(llarp::eLogWarn, LOG_TAG, __LINE__, __VA_ARGS__)
-#define LogError(...) _Log(llarp::eLogError, LOG_TAG, __LINE__, __VA_ARGS__)
-
-#define LogTraceTag(tag, ...) _Log(llarp::eLogTrace, tag, __LINE__, __VA_ARGS__)
-#define LogDebugTag(tag, ...) _Log(llarp::eLogDebug, tag, __LINE__, __VA_ARGS__)
-#define LogInfoTag(tag, ...) _Log(llarp::eLogInfo, tag, __LINE__, __VA_ARGS__)
-#define LogWarnTag(tag, ...) _Log(llarp::eLogWarn, tag, __LINE__, __VA_ARGS__)
-#define LogErrorTag(tag, ...) _Log(llarp::eLogError, tag, __LINE__, __VA_ARGS__)
-
-#define LogTraceExplicit(tag, line, ...) _Log(llarp::eLogTrace, tag, line, __VA_ARGS__)
-#define LogDebugExplicit(tag, line, ...) _Log(llarp::eLogDebug, tag, line, __VA_ARGS__)
-#define LogInfoExplicit(tag, line, ...) _Log(llarp::eLogInfo, tag, line __VA_ARGS__)
-#define LogWarnExplicit(tag, line, ...) _Log(llarp::eLogWarn, tag, line, __VA_ARGS__)
-#define LogErrorExplicit(tag, line, ...) _Log(llarp::eLogError, tag, line, __VA_ARGS__)
+/// these expand to a conditional so that a leading llarp:: still works
+#define _LogGated(lvl, tag, line, ...) \
+  _LogEnabled(lvl) ? ::llarp::_Log(lvl, tag, line, __VA_ARGS__) : void()
+
+#define LogTrace(...) _LogGated(llarp::eLogTrace, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogDebug(...) _LogGated(llarp::eLogDebug, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogInfo(...) _LogGated(llarp::eLogInfo, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogWarn(...) _LogGated(llarp::eLogWarn, LOG_TAG, __LINE__, __VA_ARGS__)
+#define LogError(...) _LogGated(llarp::eLogError, LOG_TAG, __LINE__, __VA_ARGS__)
+
+#define LogTraceTag(tag, ...) _LogGated(llarp::eLogTrace, tag, __LINE__, __VA_ARGS__)
+#define LogDebugTag(tag, ...) _LogGated(llarp::eLogDebug, tag, __LINE__, __VA_ARGS__)
+#define LogInfoTag(tag, ...) _LogGated(llarp::eLogInfo, tag, __LINE__, __VA_ARGS__)
+#define LogWarnTag(tag, ...) _LogGated(llarp::eLogWarn, tag, __LINE__, __VA_ARGS__)
+#define LogErrorTag(tag, ...) _LogGated(llarp::eLogError, tag, __LINE__, __VA_ARGS__)
+
+#define LogTraceExplicit(tag, line, ...) _LogGated(llarp::eLogTrace, tag, line, __VA_ARGS__)
+#define LogDebugExplicit(tag, line, ...) _LogGated(llarp::eLogDebug, tag, line, __VA_ARGS__)
+#define LogInfoExplicit(tag, line, ...) _LogGated(llarp::eLogInfo, tag, line, __VA_ARGS__)
+#define LogWarnExplicit(tag, line, ...) _LogGated(llarp::eLogWarn, tag, line, __VA_ARGS__)
+#define LogErrorExplicit(tag, line, ...) _LogGated(llarp::eLogError, tag, line, __VA_ARGS__)
 
 #ifndef LOG_TAG
 #define LOG_TAG "default"
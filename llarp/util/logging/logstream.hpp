@@ -10,6 +10,8 @@
 
 namespace llarp
 {
+  struct BinaryLogStream;
+
   /// logger stream interface
   struct ILogStream
   {
@@ -51,6 +53,13 @@ namespace llarp
     /// called every end of event loop tick
     virtual void
     Tick(llarp_time_t now) = 0;
+
+    /// non null if this stream takes log statements unformatted
+    virtual BinaryLogStream*
+    AsBinary()
+    {
+      return nullptr;
+    }
   };
 
   using ILogStream_ptr = std::unique_ptr<ILogStream>;
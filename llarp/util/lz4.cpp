@@ -0,0 +1,182 @@
+#include <util/lz4.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace llarp
+{
+  namespace lz4
+  {
+    /// shortest match a sequence encodes
+    static constexpr size_t MinMatch = 4;
+    /// the last match starts at least this far from the end of a block
+    static constexpr size_t MatchLimit = 12;
+    /// and the last this many bytes are always literals
+    static constexpr size_t LastLiterals = 5;
+    static constexpr size_t MaxOffset = 65535;
+    static constexpr int HashBits = 12;
+
+    static uint32_t
+    Read32(const uint8_t* ptr)
+    {
+      uint32_t val;
+      std::memcpy(&val, ptr, sizeof(val));
+      return val;
+    }
+
+    static uint32_t
+    Hash(uint32_t val)
+    {
+      return (val * 2654435761U) >> (32 - HashBits);
+    }
+
+    /// writes blocks, keeping track of room left
+    struct Sink
+    {
+      uint8_t* out;
+      size_t cap;
+      size_t pos = 0;
+
+      bool
+      Put(uint8_t byte)
+      {
+        if (pos == cap)
+          return false;
+        out[pos++] = byte;
+        return true;
+      }
+
+      /// the rest of a length over 15 as 255s and what is left
+      bool
+      PutLength(size_t len)
+      {
+        for (; len >= 255; len -= 255)
+          if (not Put(255))
+            return false;
+        return Put(len);
+      }
+
+      bool
+      PutLiterals(const uint8_t* data, size_t sz)
+      {
+        if (sz > cap - pos)
+          return false;
+        if (sz > 0)
+          std::memcpy(out + pos, data, sz);
+        pos += sz;
+        return true;
+      }
+
+      /// the literals before a match then the match, or only literals for the last sequence
+      bool
+      PutSequence(const uint8_t* lits, size_t numLits, size_t offset, size_t matchLen)
+      {
+        const bool last = matchLen == 0;
+        const size_t extra = last ? 0 : matchLen - MinMatch;
+        const uint8_t token = (std::min<size_t>(numLits, 15) << 4) | std::min<size_t>(extra, 15);
+        if (not Put(token))
+          return false;
+        if (numLits >= 15 and not PutLength(numLits - 15))
+          return false;
+        if (not PutLiterals(lits, numLits))
+          return false;
+        if (last)
+          return true;
+        if (not(Put(offset & 0xff) and Put(offset >> 8)))
+          return false;
+        return extra < 15 or PutLength(extra - 15);
+      }
+    };
+
+    size_t
+    Compress(const uint8_t* in, size_t sz, uint8_t* out, size_t cap)
+    {
+      if (sz > MaxInput)
+        return 0;
+      Sink sink{out, cap};
+      size_t anchor = 0;
+      if (sz > MatchLimit)
+      {
+        // positions plus one, 0 for none yet
+        std::array<uint16_t, 1 << HashBits> table{};
+        const size_t matchEnd = sz - LastLiterals;
+        size_t idx = 0;
+        while (idx + MatchLimit <= sz)
+        {
+          const uint32_t word = Read32(in + idx);
+          auto& slot = table[Hash(word)];
+          const size_t cand = slot;
+          slot = idx + 1;
+          if (cand == 0 or idx - (cand - 1) > MaxOffset or Read32(in + cand - 1) != word)
+          {
+            idx++;
+            continue;
+          }
+          const size_t ref = cand - 1;
+          size_t len = MinMatch;
+          while (idx + len < matchEnd and in[ref + len] == in[idx + len])
+            len++;
+          if (not sink.PutSequence(in + anchor, idx - anchor, idx - ref, len))
+            return 0;
+          idx += len;
+          anchor = idx;
+        }
+      }
+      if (not sink.PutSequence(in + anchor, sz - anchor, 0, 0))
+        return 0;
+      return sink.pos;
+    }
+
+    bool
+    Decompress(const uint8_t* in, size_t sz, uint8_t* out, size_t outsz)
+    {
+      size_t ip = 0;
+      size_t op = 0;
+      // a length over 15 carried on in the bytes after, false if it runs off the block
+      const auto readLength = [&](size_t& len) {
+        uint8_t byte;
+        do
+        {
+          if (ip == sz)
+            return false;
+          byte = in[ip++];
+          len += byte;
+        } while (byte == 255);
+        return true;
+      };
+      while (ip < sz)
+      {
+        const uint8_t token = in[ip++];
+        size_t numLits = token >> 4;
+        if (numLits == 15 and not readLength(numLits))
+          return false;
+        if (numLits > sz - ip or numLits > outsz - op)
+          return false;
+        if (numLits > 0)
+          std::memcpy(out + op, in + ip, numLits);
+        ip += numLits;
+        op += numLits;
+        // the last sequence has no match
+        if (ip == sz)
+          return op == outsz;
+        if (sz - ip < 2)
+          return false;
+        const size_t offset = in[ip] | (size_t{in[ip + 1]} << 8);
+        ip += 2;
+        if (offset == 0 or offset > op)
+          return false;
+        size_t len = token & 15;
+        if (len == 15 and not readLength(len))
+          return false;
+        len += MinMatch;
+        if (len > outsz - op)
+          return false;
+        // a byte at a time, the match may overlap what it writes
+        for (const uint8_t* ref = out + op - offset; len > 0; --len)
+          out[op++] = *ref++;
+      }
+      return false;
+    }
+  }  // namespace lz4
+}  // namespace llarp
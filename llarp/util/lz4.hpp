@@ -0,0 +1,36 @@
+#ifndef LLARP_UTIL_LZ4_HPP
+#define LLARP_UTIL_LZ4_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  /// the lz4 block format, what liblz4's LZ4_compress_default makes and LZ4_decompress_safe
+  /// reads, for payloads of up to 64k. a greedy single pass that trades ratio for speed, as
+  /// lz4's fast mode does
+  namespace lz4
+  {
+    /// the most bytes sz bytes compress to when nothing in them repeats
+    constexpr size_t
+    CompressBound(size_t sz)
+    {
+      return sz + sz / 255 + 16;
+    }
+
+    /// most bytes one block may hold
+    constexpr size_t MaxInput = 65535;
+
+    /// compress sz bytes at in to out, which has room for cap bytes. returns how many bytes
+    /// were written, 0 if sz is over MaxInput or the block did not fit in cap
+    size_t
+    Compress(const uint8_t* in, size_t sz, uint8_t* out, size_t cap);
+
+    /// decompress the block of sz bytes at in to exactly outsz bytes at out. false if the block
+    /// is malformed or does not come to outsz bytes, out may be partly written then
+    bool
+    Decompress(const uint8_t* in, size_t sz, uint8_t* out, size_t outsz);
+  }  // namespace lz4
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,157 @@
+#include <util/metrics.hpp>
+
+#include <lokimq/bt_serialize.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace llarp
+{
+  namespace metrics
+  {
+    Histogram::Histogram(std::vector<uint64_t> bounds)
+        : m_Bounds(std::move(bounds))
+        , m_Buckets(std::make_unique<std::atomic<uint64_t>[]>(m_Bounds.size() + 1))
+    {
+      if (not std::is_sorted(m_Bounds.begin(), m_Bounds.end()))
+        throw std::invalid_argument("histogram bounds are not in order");
+    }
+
+    void
+    Histogram::Observe(uint64_t val)
+    {
+      const size_t idx =
+          std::lower_bound(m_Bounds.begin(), m_Bounds.end(), val) - m_Bounds.begin();
+      m_Buckets[idx].fetch_add(1, std::memory_order_relaxed);
+      m_Count.fetch_add(1, std::memory_order_relaxed);
+      m_Sum.fetch_add(val, std::memory_order_relaxed);
+    }
+
+    std::vector<uint64_t>
+    LatencyBounds()
+    {
+      std::vector<uint64_t> bounds{1};
+      for (uint64_t bound = 2; bound <= (uint64_t{1} << 23); bound *= 2)
+      {
+        bounds.push_back(bound);
+        bounds.push_back(bound + bound / 2);
+      }
+      return bounds;
+    }
+
+    bool
+    Registry::HasName(const std::string& name) const
+    {
+      const auto same = [&name](const auto& named) { return named.name == name; };
+      return std::any_of(m_Counters.begin(), m_Counters.end(), same)
+          or std::any_of(m_Gauges.begin(), m_Gauges.end(), same)
+          or std::any_of(m_Histograms.begin(), m_Histograms.end(), same);
+    }
+
+    template <typename Metric_t, typename... Args_t>
+    Metric_t&
+    Registry::Add(
+        std::deque<Named<Metric_t>>& metrics, std::string name, std::string help, Args_t&&... args)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (auto& named : metrics)
+      {
+        if (named.name == name)
+          return named.metric;
+      }
+      if (HasName(name))
+        throw std::invalid_argument("metric " + name + " is already another kind");
+      return metrics
+          .emplace_back(std::move(name), std::move(help), std::forward<Args_t>(args)...)
+          .metric;
+    }
+
+    Counter&
+    Registry::AddCounter(std::string name, std::string help)
+    {
+      return Add(m_Counters, std::move(name), std::move(help));
+    }
+
+    Gauge&
+    Registry::AddGauge(std::string name, std::string help)
+    {
+      return Add(m_Gauges, std::move(name), std::move(help));
+    }
+
+    Histogram&
+    Registry::AddHistogram(std::string name, std::string help, std::vector<uint64_t> bounds)
+    {
+      return Add(m_Histograms, std::move(name), std::move(help), std::move(bounds));
+    }
+
+    static void
+    PutHeader(std::ostream& out, const std::string& name, const std::string& help, const char* type)
+    {
+      out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+    }
+
+    std::string
+    Registry::PrometheusText() const
+    {
+      std::stringstream out;
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (const auto& counter : m_Counters)
+      {
+        PutHeader(out, counter.name, counter.help, "counter");
+        out << counter.name << " " << counter.metric.Value() << "\n";
+      }
+      for (const auto& gauge : m_Gauges)
+      {
+        PutHeader(out, gauge.name, gauge.help, "gauge");
+        out << gauge.name << " " << gauge.metric.Value() << "\n";
+      }
+      for (const auto& hist : m_Histograms)
+      {
+        PutHeader(out, hist.name, hist.help, "histogram");
+        const auto& bounds = hist.metric.Bounds();
+        // prometheus buckets are cumulative
+        uint64_t below = 0;
+        for (size_t idx = 0; idx <= bounds.size(); ++idx)
+        {
+          below += hist.metric.BucketCount(idx);
+          out << hist.name << "_bucket{le=\"";
+          if (idx < bounds.size())
+            out << bounds[idx];
+          else
+            out << "+Inf";
+          out << "\"} " << below << "\n";
+        }
+        out << hist.name << "_sum " << hist.metric.Sum() << "\n";
+        out << hist.name << "_count " << hist.metric.Count() << "\n";
+      }
+      return out.str();
+    }
+
+    std::string
+    Registry::BTEncoded() const
+    {
+      lokimq::bt_dict all;
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (const auto& counter : m_Counters)
+        all[counter.name] = counter.metric.Value();
+      for (const auto& gauge : m_Gauges)
+        all[gauge.name] = gauge.metric.Value();
+      for (const auto& hist : m_Histograms)
+      {
+        lokimq::bt_list bounds;
+        lokimq::bt_list counts;
+        for (const auto bound : hist.metric.Bounds())
+          bounds.emplace_back(bound);
+        for (size_t idx = 0; idx <= hist.metric.Bounds().size(); ++idx)
+          counts.emplace_back(hist.metric.BucketCount(idx));
+        all[hist.name] = lokimq::bt_dict{
+            {"b", std::move(bounds)},
+            {"c", std::move(counts)},
+            {"n", hist.metric.Count()},
+            {"s", hist.metric.Sum()}};
+      }
+      return lokimq::bt_serialize(all);
+    }
+  }  // namespace metrics
+}  // namespace llarp
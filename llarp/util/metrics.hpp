@@ -0,0 +1,175 @@
+#ifndef LLARP_UTIL_METRICS_HPP
+#define LLARP_UTIL_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace metrics
+  {
+    /// only goes up, safe to bump from any thread
+    struct Counter
+    {
+      void
+      Inc(uint64_t n = 1)
+      {
+        m_Value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      uint64_t
+      Value() const
+      {
+        return m_Value.load(std::memory_order_relaxed);
+      }
+
+     private:
+      std::atomic<uint64_t> m_Value{0};
+    };
+
+    /// a current value, set by whoever knows it
+    struct Gauge
+    {
+      void
+      Set(int64_t val)
+      {
+        m_Value.store(val, std::memory_order_relaxed);
+      }
+
+      void
+      Add(int64_t n)
+      {
+        m_Value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      int64_t
+      Value() const
+      {
+        return m_Value.load(std::memory_order_relaxed);
+      }
+
+     private:
+      std::atomic<int64_t> m_Value{0};
+    };
+
+    /// counts of observations at or under each of a fixed set of ascending bounds, in whole
+    /// units the name says, microseconds or bytes. one more bucket takes what is over them all
+    struct Histogram
+    {
+      using Clock_t = std::chrono::steady_clock;
+
+      explicit Histogram(std::vector<uint64_t> bounds);
+
+      void
+      Observe(uint64_t val);
+
+      /// observe the microseconds since start, for timing a step
+      void
+      ObserveSince(Clock_t::time_point start)
+      {
+        Observe(std::chrono::duration_cast<std::chrono::microseconds>(Clock_t::now() - start)
+                    .count());
+      }
+
+      const std::vector<uint64_t>&
+      Bounds() const
+      {
+        return m_Bounds;
+      }
+
+      /// observations in the bucket idx and not in the ones before it, idx of Bounds().size()
+      /// is the one over every bound
+      uint64_t
+      BucketCount(size_t idx) const
+      {
+        return m_Buckets[idx].load(std::memory_order_relaxed);
+      }
+
+      uint64_t
+      Count() const
+      {
+        return m_Count.load(std::memory_order_relaxed);
+      }
+
+      uint64_t
+      Sum() const
+      {
+        return m_Sum.load(std::memory_order_relaxed);
+      }
+
+     private:
+      const std::vector<uint64_t> m_Bounds;
+      std::unique_ptr<std::atomic<uint64_t>[]> m_Buckets;
+      std::atomic<uint64_t> m_Count{0};
+      std::atomic<uint64_t> m_Sum{0};
+    };
+
+    /// bounds for a histogram of latencies in microseconds, 1us to about 8s with two to each
+    /// doubling, so it tells one step from another at any scale without many buckets
+    std::vector<uint64_t>
+    LatencyBounds();
+
+    /// where subsystems put their metrics so they can be scraped without the logic thread.
+    /// metrics live as long as the registry and keep their address, so subsystems hold on to
+    /// what Add gave them and update it lock free. adding a name twice gives back the same
+    /// metric, adding it as another kind throws std::invalid_argument
+    struct Registry
+    {
+      Counter&
+      AddCounter(std::string name, std::string help);
+
+      Gauge&
+      AddGauge(std::string name, std::string help);
+
+      Histogram&
+      AddHistogram(std::string name, std::string help, std::vector<uint64_t> bounds);
+
+      /// every metric in the prometheus text exposition format
+      std::string
+      PrometheusText() const;
+
+      /// every metric as a bt dict by name. counters and gauges are integers, histograms are
+      /// dicts of their bounds "b", per bucket counts "c", the count "n" and the sum "s"
+      std::string
+      BTEncoded() const;
+
+     private:
+      template <typename Metric_t>
+      struct Named
+      {
+        template <typename... Args_t>
+        Named(std::string _name, std::string _help, Args_t&&... args)
+            : name(std::move(_name)), help(std::move(_help)), metric(std::forward<Args_t>(args)...)
+        {}
+
+        const std::string name;
+        const std::string help;
+        Metric_t metric;
+      };
+
+      template <typename Metric_t, typename... Args_t>
+      Metric_t&
+      Add(std::deque<Named<Metric_t>>& metrics,
+          std::string name,
+          std::string help,
+          Args_t&&... args);
+
+      bool
+      HasName(const std::string& name) const;
+
+      mutable std::mutex m_Mutex;
+      std::deque<Named<Counter>> m_Counters;
+      std::deque<Named<Gauge>> m_Gauges;
+      std::deque<Named<Histogram>> m_Histograms;
+    };
+  }  // namespace metrics
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,206 @@
+#include <util/numa.hpp>
+
+#include <util/fs.hpp>
+#include <util/logging/logger.hpp>
+#include <util/str.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace llarp
+{
+  namespace util
+  {
+    namespace
+    {
+      MemoryPolicy g_Policy;
+      std::atomic<bool> g_SlabsEnabled{false};
+      std::atomic<size_t> g_NextCpu{0};
+      std::atomic<size_t> g_PinnedThreads{0};
+      std::atomic<size_t> g_Slabs{0};
+      std::atomic<size_t> g_HugeSlabs{0};
+      std::atomic<size_t> g_LocalSlabs{0};
+
+      /// node of each cpu as sysfs lists it, empty where there is no sysfs
+      struct Topology
+      {
+        size_t nodes = 1;
+        std::vector<size_t> nodeOfCpu;
+
+        Topology()
+        {
+#ifdef __linux__
+          std::error_code ec;
+          const fs::path sysNodes{"/sys/devices/system/node"};
+          size_t found = 0;
+          for (const auto& entry : fs::directory_iterator{sysNodes, ec})
+          {
+            const auto name = entry.path().filename().string();
+            size_t node = 0;
+            if (not starts_with(name, "node") or not parse_int(name.substr(4), node))
+              continue;
+            found = std::max(found, node + 1);
+            for (const auto& cpuEntry : fs::directory_iterator{entry.path(), ec})
+            {
+              const auto cpuName = cpuEntry.path().filename().string();
+              size_t cpu = 0;
+              if (not starts_with(cpuName, "cpu") or not parse_int(cpuName.substr(3), cpu))
+                continue;
+              if (cpu >= nodeOfCpu.size())
+                nodeOfCpu.resize(cpu + 1, 0);
+              nodeOfCpu[cpu] = node;
+            }
+          }
+          nodes = std::max(found, size_t{1});
+#endif
+        }
+      };
+
+      const Topology&
+      GetTopology()
+      {
+        static const Topology topology;
+        return topology;
+      }
+    }  // namespace
+
+    void
+    SetMemoryPolicy(MemoryPolicy policy)
+    {
+      if (g_SlabsEnabled and not policy.Slabs())
+      {
+        LogWarn("pooled memory stays in slabs until restart");
+        policy.nodeLocal = g_Policy.nodeLocal;
+        policy.hugePages = g_Policy.hugePages;
+      }
+      g_Policy = std::move(policy);
+      g_NextCpu = 0;
+      if (g_Policy.Slabs())
+        g_SlabsEnabled = true;
+    }
+
+    const MemoryPolicy&
+    GetMemoryPolicy()
+    {
+      return g_Policy;
+    }
+
+    bool
+    SlabsEnabled()
+    {
+      return g_SlabsEnabled.load(std::memory_order_relaxed);
+    }
+
+    int
+    PinThisThread()
+    {
+      if (g_Policy.cpus.empty())
+        return -1;
+      const int cpu = g_Policy.cpus[g_NextCpu++ % g_Policy.cpus.size()];
+      return PinThisThreadTo(cpu) ? cpu : -1;
+    }
+
+    bool
+    PinThisThreadTo(int cpu)
+    {
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      if (sched_setaffinity(0, sizeof(set), &set) != 0)
+      {
+        LogWarn("cannot pin thread to cpu ", cpu, ": ", strerror(errno));
+        return false;
+      }
+      g_PinnedThreads++;
+      return true;
+#else
+      (void)cpu;
+      return false;
+#endif
+    }
+
+    size_t
+    NumaNodes()
+    {
+      return GetTopology().nodes;
+    }
+
+    size_t
+    NumaNodeOf(int cpu)
+    {
+      const auto& nodeOfCpu = GetTopology().nodeOfCpu;
+      if (cpu < 0 or size_t(cpu) >= nodeOfCpu.size())
+        return 0;
+      return nodeOfCpu[cpu];
+    }
+
+    size_t
+    CurrentNumaNode()
+    {
+#ifdef __linux__
+      return NumaNodeOf(sched_getcpu());
+#else
+      return 0;
+#endif
+    }
+
+    void*
+    AllocSlab()
+    {
+#ifdef __linux__
+      // twice the size so a huge page aligned slab fits in it, the rest goes back
+      const size_t mapped = SlabSize * 2;
+      void* ptr =
+          mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (ptr == MAP_FAILED)
+        return nullptr;
+      const auto base = reinterpret_cast<uintptr_t>(ptr);
+      const auto aligned = (base + SlabSize - 1) & ~(SlabSize - 1);
+      if (aligned > base)
+        munmap(ptr, aligned - base);
+      if (base + mapped > aligned + SlabSize)
+        munmap(reinterpret_cast<void*>(aligned + SlabSize), base + mapped - aligned - SlabSize);
+      auto* slab = reinterpret_cast<void*>(aligned);
+      g_Slabs++;
+      if (g_Policy.hugePages and madvise(slab, SlabSize, MADV_HUGEPAGE) == 0)
+        g_HugeSlabs++;
+      if (g_Policy.nodeLocal and NumaNodes() > 1)
+      {
+        // preferred rather than bound, so a full node spills over instead of failing
+        unsigned long mask = 1UL << CurrentNumaNode();
+        if (syscall(SYS_mbind, slab, SlabSize, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0) == 0)
+          g_LocalSlabs++;
+      }
+      return slab;
+#else
+      g_Slabs++;
+      return ::operator new(SlabSize, std::nothrow);
+#endif
+    }
+
+    util::StatusObject
+    MemoryPolicyStatus()
+    {
+      return util::StatusObject{{"hugePages", g_Policy.hugePages},
+                                {"nodeLocal", g_Policy.nodeLocal},
+                                {"numaNodes", NumaNodes()},
+                                {"cpus", g_Policy.cpus},
+                                {"pinnedThreads", g_PinnedThreads.load()},
+                                {"slabs", g_Slabs.load()},
+                                {"hugePageSlabs", g_HugeSlabs.load()},
+                                {"nodeLocalSlabs", g_LocalSlabs.load()}};
+    }
+  }  // namespace util
+}  // namespace llarp
@@ -0,0 +1,77 @@
+#ifndef LLARP_UTIL_NUMA_HPP
+#define LLARP_UTIL_NUMA_HPP
+
+#include <util/status.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// where pooled memory comes from and which cpus our own threads run on
+    struct MemoryPolicy
+    {
+      /// back pooled blocks with transparent huge pages
+      bool hugePages = false;
+      /// put the pages a thread carves its blocks out of on that thread's numa node
+      bool nodeLocal = false;
+      /// cpus the crypto workers and link socket threads are pinned to in turn, none if empty
+      std::vector<int> cpus;
+
+      /// whether pooled blocks come out of slabs from AllocSlab rather than the heap
+      bool
+      Slabs() const
+      {
+        return hugePages or nodeLocal;
+      }
+    };
+
+    /// set at startup before the threads it pins are started. once slabs are on they stay on,
+    /// as blocks carved out of them can never go back to the heap
+    void
+    SetMemoryPolicy(MemoryPolicy policy);
+
+    const MemoryPolicy&
+    GetMemoryPolicy();
+
+    /// any thread, whether the pool takes new blocks from AllocSlab
+    bool
+    SlabsEnabled();
+
+    /// pin the calling thread to the next cpu of the policy, returns that cpu or -1 when the
+    /// policy has none or pinning failed
+    int
+    PinThisThread();
+
+    /// pin the calling thread to cpu whatever the policy says, false if that failed
+    bool
+    PinThisThreadTo(int cpu);
+
+    /// numa nodes on this machine, 1 where we cannot tell
+    size_t
+    NumaNodes();
+
+    /// numa node of cpu, 0 where we cannot tell
+    size_t
+    NumaNodeOf(int cpu);
+
+    /// numa node the calling thread runs on right now
+    size_t
+    CurrentNumaNode();
+
+    /// size of each slab, one huge page
+    constexpr size_t SlabSize = 2 * 1024 * 1024;
+
+    /// SlabSize bytes of fresh memory laid out as the policy says, on the calling thread's
+    /// node and in huge pages where it asks for them. never given back, nullptr if out of memory
+    void*
+    AllocSlab();
+
+    util::StatusObject
+    MemoryPolicyStatus();
+  }  // namespace util
+}  // namespace llarp
+
+#endif
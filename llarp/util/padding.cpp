@@ -0,0 +1,128 @@
+#include <util/padding.hpp>
+
+#include <constants/path.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace llarp
+{
+  namespace padding
+  {
+    std::optional<Profile>
+    ParseProfile(std::string_view str)
+    {
+      if (str == "none")
+        return Profile::None;
+      if (str == "bucketed")
+        return Profile::Bucketed;
+      if (str == "constant-rate")
+        return Profile::ConstantRate;
+      return std::nullopt;
+    }
+
+    std::string
+    ToString(Profile profile)
+    {
+      switch (profile)
+      {
+        case Profile::None:
+          return "none";
+        case Profile::Bucketed:
+          return "bucketed";
+        case Profile::ConstantRate:
+          return "constant-rate";
+      }
+      return "unknown";
+    }
+
+    size_t
+    CellPadding(Profile profile, size_t sz, size_t maxsz)
+    {
+      size_t bucket = 0;
+      switch (profile)
+      {
+        case Profile::None:
+          return 0;
+        case Profile::Bucketed:
+          bucket = path::pad_size;
+          break;
+        case Profile::ConstantRate:
+          bucket = ConstantCellSize;
+          break;
+      }
+      // an empty cell is still a whole bucket
+      const size_t padded = sz == 0 ? bucket : ((sz + bucket - 1) / bucket) * bucket;
+      return std::min(padded, std::max(maxsz, sz)) - sz;
+    }
+
+    LinkPad
+    LinkPadding(Profile profile)
+    {
+      if (profile == Profile::None)
+        return {0, 0};
+      return {16, 16};
+    }
+
+    static std::atomic<Profile> g_LinkProfile{DefaultProfile};
+
+    void
+    SetLinkProfile(Profile profile)
+    {
+      g_LinkProfile = profile;
+    }
+
+    Profile
+    LinkProfile()
+    {
+      return g_LinkProfile.load(std::memory_order_relaxed);
+    }
+
+    namespace
+    {
+      struct Counters
+      {
+        std::atomic<uint64_t> cellPayload{0};
+        std::atomic<uint64_t> cellPadding{0};
+        std::atomic<uint64_t> coverCells{0};
+        std::atomic<uint64_t> coverBytes{0};
+        std::atomic<uint64_t> linkPayload{0};
+        std::atomic<uint64_t> linkPadding{0};
+      };
+
+      Counters g_Counters;
+    }  // namespace
+
+    void
+    CountCell(size_t payload, size_t pad, bool cover)
+    {
+      if (cover)
+      {
+        g_Counters.coverCells.fetch_add(1, std::memory_order_relaxed);
+        g_Counters.coverBytes.fetch_add(payload + pad, std::memory_order_relaxed);
+        return;
+      }
+      g_Counters.cellPayload.fetch_add(payload, std::memory_order_relaxed);
+      g_Counters.cellPadding.fetch_add(pad, std::memory_order_relaxed);
+    }
+
+    void
+    CountLink(size_t payload, size_t pad)
+    {
+      g_Counters.linkPayload.fetch_add(payload, std::memory_order_relaxed);
+      g_Counters.linkPadding.fetch_add(pad, std::memory_order_relaxed);
+    }
+
+    util::StatusObject
+    ExtractStatus()
+    {
+      return util::StatusObject{{"linkProfile", ToString(LinkProfile())},
+                                {"cellPayload", g_Counters.cellPayload.load()},
+                                {"cellPadding", g_Counters.cellPadding.load()},
+                                {"coverCells", g_Counters.coverCells.load()},
+                                {"coverBytes", g_Counters.coverBytes.load()},
+                                {"linkPayload", g_Counters.linkPayload.load()},
+                                {"linkPadding", g_Counters.linkPadding.load()}};
+    }
+  }  // namespace padding
+}  // namespace llarp
@@ -0,0 +1,82 @@
+#ifndef LLARP_UTIL_PADDING_HPP
+#define LLARP_UTIL_PADDING_HPP
+
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace llarp
+{
+  namespace padding
+  {
+    /// how much random padding traffic gets, trading bandwidth for how much its sizes and
+    /// timing tell someone watching
+    enum class Profile : uint8_t
+    {
+      /// nothing past what a message needs
+      None = 0,
+      /// cells rounded up to a multiple of path::pad_size, link control packets get 16 to 32
+      /// random bytes, what we always did
+      Bucketed = 1,
+      /// cells rounded up to a multiple of ConstantCellSize, and a path that sent nothing for
+      /// CoverInterval sends an empty cell so an idle path looks like a quiet busy one
+      ConstantRate = 2,
+    };
+
+    constexpr Profile DefaultProfile = Profile::Bucketed;
+
+    /// cells of a constant rate path are a multiple of this many bytes
+    constexpr size_t ConstantCellSize = 512;
+
+    /// a constant rate path that sent nothing for this long sends a cover cell
+    constexpr auto CoverInterval = 1s;
+
+    std::optional<Profile>
+    ParseProfile(std::string_view str);
+
+    std::string
+    ToString(Profile profile);
+
+    /// random bytes to append to a cell of sz bytes, never taking it past maxsz
+    size_t
+    CellPadding(Profile profile, size_t sz, size_t maxsz);
+
+    struct LinkPad
+    {
+      size_t min;
+      size_t variance;
+    };
+
+    /// random bytes link control packets get, at least min and up to min + variance
+    LinkPad
+    LinkPadding(Profile profile);
+
+    /// what link control packets are padded to, set once from config. it only changes what
+    /// we send, a peer takes whatever trails a packet's command as padding either way
+    void
+    SetLinkProfile(Profile profile);
+
+    Profile
+    LinkProfile();
+
+    /// count a cell sent along a path with the padding it got, cover if it had nothing in it
+    void
+    CountCell(size_t payload, size_t pad, bool cover = false);
+
+    /// count a link packet with the padding it got
+    void
+    CountLink(size_t payload, size_t pad);
+
+    /// bytes sent as padding and cover against those that carried something, across the
+    /// process
+    util::StatusObject
+    ExtractStatus();
+  }  // namespace padding
+}  // namespace llarp
+
+#endif
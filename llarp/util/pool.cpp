@@ -0,0 +1,213 @@
+#include <util/pool.hpp>
+
+#include <util/numa.hpp>
+
+#include <array>
+#include <mutex>
+#include <new>
+
+namespace llarp
+{
+  namespace util
+  {
+    namespace
+    {
+      constexpr size_t SmallestBlockSize = 256;
+      constexpr size_t NumSizeClasses = 7;
+      static_assert(SmallestBlockSize << (NumSizeClasses - 1) == PooledMaxBlockSize);
+
+      /// how many bytes each thread keeps around per size class
+      constexpr size_t MaxCachedBytes = 1024 * 1024;
+
+      struct FreeBlock
+      {
+        FreeBlock* next;
+      };
+
+      /// index of the smallest size class that fits sz
+      constexpr size_t
+      SizeClass(size_t sz)
+      {
+        size_t idx = 0;
+        while ((SmallestBlockSize << idx) < sz)
+          ++idx;
+        return idx;
+      }
+
+      /// set once this thread's cache is torn down so late frees go back to the heap
+      thread_local bool t_CacheGone = false;
+
+      struct Bucket
+      {
+        FreeBlock* head = nullptr;
+        size_t num = 0;
+
+        void
+        Push(FreeBlock* block)
+        {
+          block->next = head;
+          head = block;
+          num++;
+        }
+
+        FreeBlock*
+        Pop()
+        {
+          auto* block = head;
+          head = block->next;
+          num--;
+          return block;
+        }
+      };
+
+      /// blocks taken from slabs never go back to the heap, what a thread cannot keep waits
+      /// here for any thread on the same numa node
+      struct NodeBlocks
+      {
+        std::mutex mutex;
+        std::array<Bucket, NumSizeClasses> buckets;
+      };
+
+      constexpr size_t MaxNodes = 8;
+      std::array<NodeBlocks, MaxNodes> g_NodeBlocks;
+
+      /// blocks a thread takes from its node at once
+      constexpr size_t NodeBatch = 16;
+
+      void
+      GiveToNode(size_t node, size_t idx, FreeBlock* block)
+      {
+        auto& shared = g_NodeBlocks[node % MaxNodes];
+        std::lock_guard<std::mutex> lock{shared.mutex};
+        shared.buckets[idx].Push(block);
+      }
+
+      struct ThreadCache
+      {
+        std::array<Bucket, NumSizeClasses> buckets;
+        /// node this thread first allocated on and the slab it is carving up, if any
+        size_t node = CurrentNumaNode();
+        char* slab = nullptr;
+        size_t slabLeft = 0;
+
+        /// a block of size class idx from this node's spares or our slab, nullptr when there
+        /// is no memory left
+        void*
+        Refill(size_t idx)
+        {
+          auto& bucket = buckets[idx];
+          {
+            auto& shared = g_NodeBlocks[node % MaxNodes];
+            std::lock_guard<std::mutex> lock{shared.mutex};
+            auto& spare = shared.buckets[idx];
+            while (spare.head and bucket.num < NodeBatch)
+              bucket.Push(spare.Pop());
+          }
+          if (bucket.head)
+            return bucket.Pop();
+          const size_t sz = SmallestBlockSize << idx;
+          if (slabLeft < sz)
+          {
+            // the tail of the old slab is too small for this class, it goes to the smallest
+            while (slabLeft >= SmallestBlockSize)
+            {
+              GiveToNode(node, 0, reinterpret_cast<FreeBlock*>(slab));
+              slab += SmallestBlockSize;
+              slabLeft -= SmallestBlockSize;
+            }
+            slab = static_cast<char*>(AllocSlab());
+            if (slab == nullptr)
+            {
+              slabLeft = 0;
+              return nullptr;
+            }
+            slabLeft = SlabSize;
+          }
+          void* block = slab;
+          slab += sz;
+          slabLeft -= sz;
+          return block;
+        }
+
+        ~ThreadCache()
+        {
+          t_CacheGone = true;
+          const bool slabs = SlabsEnabled();
+          for (size_t idx = 0; idx < NumSizeClasses; ++idx)
+          {
+            auto& bucket = buckets[idx];
+            while (bucket.head)
+            {
+              auto* block = bucket.Pop();
+              if (slabs)
+                GiveToNode(node, idx, block);
+              else
+                ::operator delete(block);
+            }
+          }
+        }
+      };
+
+      ThreadCache&
+      Cache()
+      {
+        static thread_local ThreadCache cache;
+        return cache;
+      }
+    }  // namespace
+
+    void*
+    PoolAlloc(size_t sz)
+    {
+      if (sz > PooledMaxBlockSize)
+        return ::operator new(sz);
+      const auto idx = SizeClass(sz);
+      // a whole size class even now, as another thread may keep it when it is freed
+      if (t_CacheGone)
+        return ::operator new(SmallestBlockSize << idx);
+      auto& cache = Cache();
+      auto& bucket = cache.buckets[idx];
+      if (bucket.head)
+        return bucket.Pop();
+      if (not SlabsEnabled())
+        return ::operator new(SmallestBlockSize << idx);
+      if (auto* block = cache.Refill(idx))
+        return block;
+      throw std::bad_alloc{};
+    }
+
+    void
+    PoolFree(void* ptr, size_t sz)
+    {
+      if (ptr == nullptr)
+        return;
+      if (sz > PooledMaxBlockSize)
+      {
+        ::operator delete(ptr);
+        return;
+      }
+      const auto idx = SizeClass(sz);
+      auto* block = static_cast<FreeBlock*>(ptr);
+      const bool slabs = SlabsEnabled();
+      if (t_CacheGone)
+      {
+        if (slabs)
+          GiveToNode(CurrentNumaNode(), idx, block);
+        else
+          ::operator delete(ptr);
+        return;
+      }
+      auto& cache = Cache();
+      auto& bucket = cache.buckets[idx];
+      if (bucket.num * (SmallestBlockSize << idx) >= MaxCachedBytes)
+      {
+        if (slabs)
+          GiveToNode(cache.node, idx, block);
+        else
+          ::operator delete(ptr);
+        return;
+      }
+      bucket.Push(block);
+    }
+  }  // namespace util
+}  // namespace llarp
@@ -0,0 +1,69 @@
+#ifndef LLARP_UTIL_POOL_HPP
+#define LLARP_UTIL_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// get a block of at least sz bytes, blocks up to PooledMaxBlockSize come from a per thread
+    /// free list of recycled blocks and only hit the heap when that is empty
+    void*
+    PoolAlloc(size_t sz);
+
+    /// give back a block from PoolAlloc, sz must be what was asked for
+    /// the block is kept for reuse by the calling thread, which may not be the one that got it
+    void
+    PoolFree(void* ptr, size_t sz);
+
+    /// largest block we recycle, anything bigger goes straight to the heap
+    constexpr size_t PooledMaxBlockSize = 16 * 1024;
+
+    /// stateless allocator that recycles blocks through PoolAlloc / PoolFree
+    template <typename T>
+    struct PoolAllocator
+    {
+      using value_type = T;
+
+      PoolAllocator() = default;
+
+      template <typename U>
+      PoolAllocator(const PoolAllocator<U>&)
+      {}
+
+      T*
+      allocate(size_t n)
+      {
+        return static_cast<T*>(PoolAlloc(n * sizeof(T)));
+      }
+
+      void
+      deallocate(T* ptr, size_t n)
+      {
+        PoolFree(ptr, n * sizeof(T));
+      }
+
+      template <typename U>
+      bool
+      operator==(const PoolAllocator<U>&) const
+      {
+        return true;
+      }
+
+      template <typename U>
+      bool
+      operator!=(const PoolAllocator<U>&) const
+      {
+        return false;
+      }
+    };
+
+    /// a byte buffer whose storage is recycled instead of freed
+    template <typename T>
+    using PooledVector = std::vector<T, PoolAllocator<T>>;
+  }  // namespace util
+}  // namespace llarp
+
+#endif
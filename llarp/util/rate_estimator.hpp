@@ -0,0 +1,101 @@
+#ifndef LLARP_UTIL_RATE_ESTIMATOR_HPP
+#define LLARP_UTIL_RATE_ESTIMATOR_HPP
+
+#include <util/status.hpp>
+#include <util/time.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// bytes per second of something that moves data, kept as a moving average and as the last
+    /// few per tick samples so the spread can be seen and not just one number per interval.
+    /// bytes are added as they move and folded into a sample on each Tick
+    struct RateEstimator
+    {
+      /// how many samples the percentiles are taken over
+      static constexpr size_t NumSamples = 16;
+      /// weight of a new sample in the moving average
+      static constexpr double Alpha = 0.125;
+
+      void
+      Add(uint64_t bytes)
+      {
+        m_Bytes += bytes;
+      }
+
+      /// closes the current sample, returns the bytes that went into it. the first tick only
+      /// starts the clock
+      uint64_t
+      Tick(llarp_time_t now)
+      {
+        const auto bytes = m_Bytes;
+        m_Bytes = 0;
+        if (m_LastTick > 0s and now > m_LastTick)
+        {
+          const std::chrono::duration<double> dlt = now - m_LastTick;
+          m_Last = bytes / dlt.count();
+          m_Smoothed = m_NumSamples ? m_Smoothed + Alpha * (m_Last - m_Smoothed) : m_Last;
+          m_Samples[m_NextSample] = m_Last;
+          m_NextSample = (m_NextSample + 1) % NumSamples;
+          m_NumSamples = std::min(m_NumSamples + 1, NumSamples);
+        }
+        m_LastTick = now;
+        return bytes;
+      }
+
+      /// bytes per second over the last sample
+      double
+      Last() const
+      {
+        return m_Last;
+      }
+
+      /// moving average in bytes per second
+      double
+      Smoothed() const
+      {
+        return m_Smoothed;
+      }
+
+      /// the sample at fraction p of the ones kept, 0.5 for the median, 0 if there are none
+      double
+      Percentile(double p) const
+      {
+        if (m_NumSamples == 0)
+          return 0;
+        std::array<double, NumSamples> sorted;
+        std::copy_n(m_Samples.begin(), m_NumSamples, sorted.begin());
+        const size_t idx = std::min<size_t>(p * m_NumSamples, m_NumSamples - 1);
+        std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.begin() + m_NumSamples);
+        return sorted[idx];
+      }
+
+      util::StatusObject
+      ExtractStatus() const
+      {
+        return util::StatusObject{{"last", uint64_t(m_Last)},
+                                  {"smoothed", uint64_t(m_Smoothed)},
+                                  {"p50", uint64_t(Percentile(0.5))},
+                                  {"p95", uint64_t(Percentile(0.95))},
+                                  {"max", uint64_t(Percentile(1.0))}};
+      }
+
+     private:
+      std::array<double, NumSamples> m_Samples{};
+      size_t m_NextSample = 0;
+      size_t m_NumSamples = 0;
+      uint64_t m_Bytes = 0;
+      double m_Last = 0;
+      double m_Smoothed = 0;
+      llarp_time_t m_LastTick = 0s;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef LLARP_UTIL_REPLAY_WINDOW_HPP
+#define LLARP_UTIL_REPLAY_WINDOW_HPP
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// tracks which of the last N sequential ids we have seen in a bitmap that slides forward
+    /// with the highest id, anything that fell off the back counts as seen
+    template <size_t N = 1024>
+    struct ReplayWindow
+    {
+      /// return true if id was seen or is too old to tell
+      bool
+      Contains(uint64_t id) const
+      {
+        if (id >= m_Top)
+          return false;
+        if (m_Top - id > N)
+          return true;
+        return m_Seen.test(id % N);
+      }
+
+      /// mark id as seen, return true if it was not seen before
+      bool
+      Insert(uint64_t id)
+      {
+        if (Contains(id))
+          return false;
+        if (id >= m_Top)
+        {
+          // clear the slots we slide over
+          if (id - m_Top >= N)
+          {
+            m_Seen.reset();
+          }
+          else
+          {
+            for (uint64_t n = m_Top; n <= id; ++n)
+              m_Seen.reset(n % N);
+          }
+          m_Top = id + 1;
+        }
+        m_Seen.set(id % N);
+        return true;
+      }
+
+      /// number of ids in the window we have seen
+      size_t
+      size() const
+      {
+        return m_Seen.count();
+      }
+
+     private:
+      std::bitset<N> m_Seen;
+      /// one past the highest id we have seen
+      uint64_t m_Top = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef LLARP_UTIL_THREAD_JOB_HPP
+#define LLARP_UTIL_THREAD_JOB_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// move only void() callable that keeps small closures inline instead of on the heap
+    /// anything that captures up to InlineSize bytes, including a std::function, never allocates
+    class Job
+    {
+     public:
+      static constexpr size_t InlineSize = 48;
+
+      Job() = default;
+
+      Job(std::nullptr_t)
+      {}
+
+      template <
+          typename F,
+          typename Fn = std::decay_t<F>,
+          typename = std::enable_if_t<
+              not std::is_same_v<Fn, Job> and not std::is_same_v<Fn, std::nullptr_t>
+              and std::is_invocable_v<Fn&>>>
+      Job(F&& f)
+      {
+        if constexpr (FitsInline<Fn>())
+        {
+          new (m_Storage) Fn(std::forward<F>(f));
+          m_Ops = &Inline<Fn>::ops;
+        }
+        else
+        {
+          *reinterpret_cast<Fn**>(m_Storage) = new Fn(std::forward<F>(f));
+          m_Ops = &Heap<Fn>::ops;
+        }
+      }
+
+      Job(Job&& other) noexcept
+      {
+        MoveFrom(other);
+      }
+
+      Job&
+      operator=(Job&& other) noexcept
+      {
+        if (this != &other)
+        {
+          Reset();
+          MoveFrom(other);
+        }
+        return *this;
+      }
+
+      Job(const Job&) = delete;
+      Job&
+      operator=(const Job&) = delete;
+
+      ~Job()
+      {
+        Reset();
+      }
+
+      explicit operator bool() const
+      {
+        return m_Ops != nullptr;
+      }
+
+      void
+      operator()()
+      {
+        m_Ops->call(m_Storage);
+      }
+
+      void
+      Reset()
+      {
+        if (m_Ops)
+          m_Ops->destroy(m_Storage);
+        m_Ops = nullptr;
+      }
+
+     private:
+      struct Ops
+      {
+        void (*call)(void*);
+        /// move construct into dst and destroy src
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+      };
+
+      template <typename Fn>
+      static constexpr bool
+      FitsInline()
+      {
+        return sizeof(Fn) <= InlineSize and alignof(Fn) <= alignof(std::max_align_t)
+            and std::is_nothrow_move_constructible_v<Fn>;
+      }
+
+      template <typename Fn>
+      struct Inline
+      {
+        static void
+        Call(void* ptr)
+        {
+          (*static_cast<Fn*>(ptr))();
+        }
+
+        static void
+        Move(void* dst, void* src)
+        {
+          new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+          static_cast<Fn*>(src)->~Fn();
+        }
+
+        static void
+        Destroy(void* ptr)
+        {
+          static_cast<Fn*>(ptr)->~Fn();
+        }
+
+        static constexpr Ops ops{&Call, &Move, &Destroy};
+      };
+
+      template <typename Fn>
+      struct Heap
+      {
+        static void
+        Call(void* ptr)
+        {
+          (**static_cast<Fn**>(ptr))();
+        }
+
+        static void
+        Move(void* dst, void* src)
+        {
+          *static_cast<Fn**>(dst) = *static_cast<Fn**>(src);
+        }
+
+        static void
+        Destroy(void* ptr)
+        {
+          delete *static_cast<Fn**>(ptr);
+        }
+
+        static constexpr Ops ops{&Call, &Move, &Destroy};
+      };
+
+      void
+      MoveFrom(Job& other)
+      {
+        m_Ops = other.m_Ops;
+        if (m_Ops)
+          m_Ops->move(m_Storage, other.m_Storage);
+        other.m_Ops = nullptr;
+      }
+
+      alignas(std::max_align_t) std::byte m_Storage[InlineSize];
+      const Ops* m_Ops = nullptr;
+    };
+  }  // namespace thread
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef LLARP_UTIL_THREAD_JOB_QUEUE_HPP
+#define LLARP_UTIL_THREAD_JOB_QUEUE_HPP
+
+#include <util/thread/job.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// bounded lock free queue of jobs with many producers and one consumer
+    /// every slot carries a sequence number so producers only contend on claiming a position,
+    /// and jobs are stored in the slots so pushing never allocates
+    class JobQueue
+    {
+     public:
+      /// capacity is rounded up to a power of 2
+      explicit JobQueue(size_t capacity)
+      {
+        size_t sz = 2;
+        while (sz < capacity)
+          sz <<= 1;
+        m_Mask = sz - 1;
+        m_Cells = std::make_unique<Cell[]>(sz);
+        for (size_t idx = 0; idx < sz; ++idx)
+          m_Cells[idx].seq.store(idx, std::memory_order_relaxed);
+      }
+
+      size_t
+      Capacity() const
+      {
+        return m_Mask + 1;
+      }
+
+      /// any thread, moves job in and returns true unless the queue is full
+      bool
+      TryPush(Job& job)
+      {
+        size_t pos = m_Enqueue.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+          cell = &m_Cells[pos & m_Mask];
+          const size_t seq = cell->seq.load(std::memory_order_acquire);
+          const auto dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+          if (dif == 0)
+          {
+            if (m_Enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+              break;
+          }
+          else if (dif < 0)
+            return false;
+          else
+            pos = m_Enqueue.load(std::memory_order_relaxed);
+        }
+        cell->job = std::move(job);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+
+      /// consumer only, moves the oldest job out, returns false if there is none
+      bool
+      TryPop(Job& job)
+      {
+        Cell& cell = m_Cells[m_Dequeue & m_Mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (seq != m_Dequeue + 1)
+          return false;
+        job = std::move(cell.job);
+        cell.seq.store(m_Dequeue + m_Mask + 1, std::memory_order_release);
+        m_Dequeue++;
+        return true;
+      }
+
+      /// consumer only, run at most max jobs in order, returns how many ran
+      /// jobs may push more and may drain the queue again themselves
+      size_t
+      Drain(size_t max)
+      {
+        size_t ran = 0;
+        Job job;
+        while (ran < max and TryPop(job))
+        {
+          job();
+          job.Reset();
+          ran++;
+        }
+        return ran;
+      }
+
+      /// consumer only
+      bool
+      Empty() const
+      {
+        return m_Cells[m_Dequeue & m_Mask].seq.load(std::memory_order_acquire) != m_Dequeue + 1;
+      }
+
+     private:
+      struct Cell
+      {
+        std::atomic<size_t> seq;
+        Job job;
+      };
+
+      std::unique_ptr<Cell[]> m_Cells;
+      size_t m_Mask;
+      alignas(64) std::atomic<size_t> m_Enqueue{0};
+      alignas(64) size_t m_Dequeue = 0;
+    };
+  }  // namespace thread
+}  // namespace llarp
+
+#endif
@@ -13,13 +13,13 @@ namespace llarp
   }
 
   void
-  Logic::Call(std::function<void(void)> func)
+  Logic::Call(thread::Job func)
   {
     m_Queue(std::move(func));
   }
 
   void
-  Logic::SetQueuer(std::function<void(std::function<void(void)>)> q)
+  Logic::SetQueuer(std::function<void(thread::Job)> q)
   {
     m_Queue = std::move(q);
   }
@@ -59,7 +59,7 @@ namespace llarp
   Logic::set_event_loop(llarp_ev_loop* loop)
   {
     m_Loop = loop;
-    SetQueuer([loop](std::function<void(void)> work) { loop->call_soon(work); });
+    SetQueuer([loop](thread::Job work) { loop->call_soon(std::move(work)); });
   }
 
   void
@@ -14,7 +14,7 @@ namespace llarp
     stop();
 
     void
-    Call(std::function<void(void)> func);
+    Call(thread::Job func);
 
     uint32_t
     call_later(llarp_time_t later, std::function<void(void)> func);
@@ -26,7 +26,7 @@ namespace llarp
     remove_call(uint32_t id);
 
     void
-    SetQueuer(std::function<void(std::function<void(void)>)> q);
+    SetQueuer(std::function<void(thread::Job)> q);
 
     void
     set_event_loop(llarp_ev_loop* loop);
@@ -36,7 +36,7 @@ namespace llarp
 
    private:
     llarp_ev_loop* m_Loop = nullptr;
-    std::function<void(std::function<void(void)>)> m_Queue;
+    std::function<void(thread::Job)> m_Queue;
   };
 }  // namespace llarp
 
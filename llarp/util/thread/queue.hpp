@@ -79,6 +79,24 @@ namespace llarp
       std::optional<Type>
       tryPopFront();
 
+      // Construct an element in its slot and have `fill` set it up there, so
+      // a large element is not built elsewhere and copied in. `fill` must not
+      // throw. Fails like `tryPushBack`.
+      template <typename Fill>
+      QueueReturn
+      tryEmplaceBackWith(Fill&& fill);
+
+      // Hand the front element to `visit` where it sits and then remove it.
+      // Block until an element is available.
+      template <typename Visit>
+      void
+      popFrontWith(Visit&& visit);
+
+      // As `popFrontWith`, returning false at once if the queue is empty.
+      template <typename Visit>
+      bool
+      tryPopFrontWith(Visit&& visit);
+
       // Remove all elements from the queue. Note this is not atomic, and if
       // other threads `pushBack` onto the queue during this call, the `size` of
       // the queue is not guaranteed to be 0.
@@ -289,6 +307,84 @@ namespace llarp
       return std::optional<Type>(std::move(m_data[index]));
     }
 
+    template <typename Type>
+    template <typename Fill>
+    QueueReturn
+    Queue<Type>::tryEmplaceBackWith(Fill&& fill)
+    {
+      uint32_t generation = 0;
+      uint32_t index = 0;
+
+      // Sync point A, as in tryPushBack.
+
+      QueueReturn retVal = m_manager.reservePushIndex(generation, index);
+
+      if (retVal != QueueReturn::Success)
+      {
+        return retVal;
+      }
+
+      QueuePushGuard<Type> pushGuard(*this, generation, index);
+
+      // Default initialised, fill sets up what it needs.
+      ::new (&m_data[index]) Type;
+      fill(m_data[index]);
+
+      pushGuard.release();
+
+      m_manager.commitPushIndex(generation, index);
+
+      if (m_waitingPoppers > 0)
+      {
+        m_popSemaphore.notify();
+      }
+
+      return QueueReturn::Success;
+    }
+
+    template <typename Type>
+    template <typename Visit>
+    void
+    Queue<Type>::popFrontWith(Visit&& visit)
+    {
+      uint32_t generation = 0;
+      uint32_t index = 0;
+      while (m_manager.reservePopIndex(generation, index) != QueueReturn::Success)
+      {
+        m_waitingPoppers.fetch_add(1, std::memory_order_relaxed);
+
+        if (empty())
+        {
+          m_popSemaphore.wait();
+        }
+
+        m_waitingPoppers.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      QueuePopGuard<Type> popGuard(*this, generation, index);
+      visit(m_data[index]);
+    }
+
+    template <typename Type>
+    template <typename Visit>
+    bool
+    Queue<Type>::tryPopFrontWith(Visit&& visit)
+    {
+      uint32_t generation = 0;
+      uint32_t index = 0;
+
+      // Sync Point C, as in tryPopFront.
+
+      if (m_manager.reservePopIndex(generation, index) != QueueReturn::Success)
+      {
+        return false;
+      }
+
+      QueuePopGuard<Type> popGuard(*this, generation, index);
+      visit(m_data[index]);
+      return true;
+    }
+
     template <typename Type>
     QueueReturn
     Queue<Type>::pushBack(const Type& value)
@@ -0,0 +1,148 @@
+#ifndef LLARP_UTIL_THREAD_SPSC_QUEUE_HPP
+#define LLARP_UTIL_THREAD_SPSC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// bounded ring for handing batches from exactly one producer thread to exactly one consumer
+    /// thread. each side owns its index and only loads the other's, so there are no CAS loops,
+    /// and whole batches go across with one index update. Type must be default constructible
+    /// and move assignable as slots are kept constructed and moved into and out of.
+    template <typename Type>
+    class SpscQueue
+    {
+     public:
+      /// capacity is rounded up to a power of 2
+      explicit SpscQueue(size_t capacity)
+      {
+        size_t sz = 2;
+        while (sz < capacity)
+          sz <<= 1;
+        m_Mask = sz - 1;
+        m_Slots = std::make_unique<Type[]>(sz);
+      }
+
+      SpscQueue(const SpscQueue&) = delete;
+      SpscQueue&
+      operator=(const SpscQueue&) = delete;
+
+      size_t
+      capacity() const
+      {
+        return m_Mask + 1;
+      }
+
+      /// producer only, moves in as many of the n items as fit, returns how many went in
+      /// nothing goes in while the queue is disabled
+      size_t
+      tryPushBack(Type* items, size_t n)
+      {
+        if (not enabled())
+          return 0;
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead + n > capacity())
+          m_CachedHead = m_Head.load(std::memory_order_acquire);
+        const size_t count = std::min(n, capacity() - (tail - m_CachedHead));
+        for (size_t idx = 0; idx < count; ++idx)
+          m_Slots[(tail + idx) & m_Mask] = std::move(items[idx]);
+        m_Tail.store(tail + count, std::memory_order_release);
+        return count;
+      }
+
+      /// producer only
+      bool
+      tryPushBack(Type&& item)
+      {
+        return tryPushBack(&item, 1) == 1;
+      }
+
+      /// consumer only, moves at most max items onto the end of out, returns how many moved
+      size_t
+      popAll(std::vector<Type>& out, size_t max = ~size_t{0})
+      {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_CachedTail - head < max)
+          m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        const size_t count = std::min(max, m_CachedTail - head);
+        out.reserve(out.size() + count);
+        for (size_t idx = 0; idx < count; ++idx)
+          out.emplace_back(std::move(m_Slots[(head + idx) & m_Mask]));
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+      }
+
+      /// consumer only, false if there was nothing to move into out
+      bool
+      tryPopFront(Type& out)
+      {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_CachedTail == head)
+          m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        if (m_CachedTail == head)
+          return false;
+        out = std::move(m_Slots[head & m_Mask]);
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+      }
+
+      /// approximate unless called from the producer or the consumer with the other idle
+      size_t
+      size() const
+      {
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire);
+      }
+
+      bool
+      empty() const
+      {
+        return size() == 0;
+      }
+
+      bool
+      full() const
+      {
+        return size() >= capacity();
+      }
+
+      /// make pushes fail, items already queued can still be popped
+      void
+      disable()
+      {
+        m_Enabled.store(false, std::memory_order_release);
+      }
+
+      void
+      enable()
+      {
+        m_Enabled.store(true, std::memory_order_release);
+      }
+
+      bool
+      enabled() const
+      {
+        return m_Enabled.load(std::memory_order_acquire);
+      }
+
+     private:
+      std::unique_ptr<Type[]> m_Slots;
+      size_t m_Mask;
+      std::atomic<bool> m_Enabled{true};
+      /// written by the producer, with its copy of the consumer's index
+      alignas(64) std::atomic<size_t> m_Tail{0};
+      size_t m_CachedHead = 0;
+      /// written by the consumer, with its copy of the producer's index
+      alignas(64) std::atomic<size_t> m_Head{0};
+      size_t m_CachedTail = 0;
+    };
+  }  // namespace thread
+}  // namespace llarp
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef LLARP_THREADING_HPP
 #define LLARP_THREADING_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <thread>
 #include <shared_mutex>
 #include <mutex>
@@ -21,7 +23,7 @@ using pid_t = int;
 #endif
 
 #ifdef TRACY_ENABLE
-#include "Tracy.hpp"
+#include <util/tracy.hpp>
 #define DECLARE_LOCK(type, var, ...) TracyLockable(type, var)
 #else
 #define DECLARE_LOCK(type, var, ...) type var __VA_ARGS__
@@ -95,6 +97,89 @@ namespace llarp
     /// Basic RAII lock type for the default mutex type.
     using Lock = std::lock_guard<Mutex>;
 
+    /// a Mutex that counts how often it is taken shared and exclusive, and how many of those
+    /// had to wait on another holder first, to see how contended a lock is
+    struct CAPABILITY("mutex") CountingMutex
+    {
+      struct Counts
+      {
+        uint64_t shared = 0;
+        uint64_t sharedWaits = 0;
+        uint64_t exclusive = 0;
+        uint64_t exclusiveWaits = 0;
+      };
+
+      void
+      lock() ACQUIRE()
+      {
+        if (not m_Mutex.try_lock())
+        {
+          m_ExclusiveWaits.fetch_add(1, std::memory_order_relaxed);
+          m_Mutex.lock();
+        }
+        m_Exclusive.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      bool
+      try_lock() TRY_ACQUIRE(true)
+      {
+        if (not m_Mutex.try_lock())
+          return false;
+        m_Exclusive.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+
+      void
+      unlock() RELEASE()
+      {
+        m_Mutex.unlock();
+      }
+
+      void
+      lock_shared() ACQUIRE_SHARED()
+      {
+        if (not m_Mutex.try_lock_shared())
+        {
+          m_SharedWaits.fetch_add(1, std::memory_order_relaxed);
+          m_Mutex.lock_shared();
+        }
+        m_Shared.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      bool
+      try_lock_shared() TRY_ACQUIRE_SHARED(true)
+      {
+        if (not m_Mutex.try_lock_shared())
+          return false;
+        m_Shared.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+
+      void
+      unlock_shared() RELEASE_SHARED()
+      {
+        m_Mutex.unlock_shared();
+      }
+
+      Counts
+      GetCounts() const
+      {
+        Counts counts;
+        counts.shared = m_Shared.load(std::memory_order_relaxed);
+        counts.sharedWaits = m_SharedWaits.load(std::memory_order_relaxed);
+        counts.exclusive = m_Exclusive.load(std::memory_order_relaxed);
+        counts.exclusiveWaits = m_ExclusiveWaits.load(std::memory_order_relaxed);
+        return counts;
+      }
+
+     private:
+      Mutex m_Mutex;
+      std::atomic<uint64_t> m_Shared = 0;
+      std::atomic<uint64_t> m_SharedWaits = 0;
+      std::atomic<uint64_t> m_Exclusive = 0;
+      std::atomic<uint64_t> m_ExclusiveWaits = 0;
+    };
+
     /// Obtains multiple unique locks simultaneously and atomically.  Returns a
     /// tuple of all the held locks.
     template <typename... Mutex>
@@ -0,0 +1,241 @@
+#include <util/thread/worker_pool.hpp>
+#include <util/thread/threading.hpp>
+#include <util/numa.hpp>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// spread sequential keys like pointers and counters over the workers
+    static uint64_t
+    MixKey(uint64_t key)
+    {
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      key *= 0xc4ceb9fe1a85ec53ULL;
+      key ^= key >> 33;
+      return key;
+    }
+
+    WorkerPool::WorkerPool(size_t threads, std::string name) : m_Name{std::move(name)}
+    {
+      if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+      m_Workers.reserve(threads);
+      for (size_t idx = 0; idx < threads; ++idx)
+        m_Workers.emplace_back(std::make_unique<Worker>());
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+      Stop();
+    }
+
+    void
+    WorkerPool::Start()
+    {
+      if (m_Running.exchange(true))
+        return;
+      for (auto& worker : m_Workers)
+      {
+        worker->thread = std::thread{[this, self = worker.get()]() {
+          util::SetThreadName(m_Name);
+          util::PinThisThread();
+          Run(*self);
+        }};
+      }
+    }
+
+    void
+    WorkerPool::Stop()
+    {
+      if (not m_Running.exchange(false))
+        return;
+      for (auto& worker : m_Workers)
+        Poke(*worker);
+      for (auto& worker : m_Workers)
+      {
+        if (worker->thread.joinable())
+          worker->thread.join();
+      }
+    }
+
+    void
+    WorkerPool::Queue(Job job)
+    {
+      auto& worker = *m_Workers[m_NextWorker++ % m_Workers.size()];
+      const bool busy = not worker.idle.load();
+      Push(worker, std::move(job), &Worker::shared);
+      if (not busy)
+        return;
+      // the worker we picked is in the middle of something, get an idle one to steal it
+      for (auto& other : m_Workers)
+      {
+        if (other->idle.load())
+        {
+          Poke(*other);
+          return;
+        }
+      }
+    }
+
+    void
+    WorkerPool::QueueFor(uint64_t key, Job job)
+    {
+      Push(*m_Workers[MixKey(key) % m_Workers.size()], std::move(job), &Worker::pinned);
+    }
+
+    bool
+    WorkerPool::TryQueueBackground(Job job, size_t maxQueued)
+    {
+      if (m_BackgroundQueued.fetch_add(1) >= maxQueued)
+      {
+        m_BackgroundQueued--;
+        m_BackgroundRejected++;
+        return false;
+      }
+      // idle workers pick it up straight away, busy ones only once they run dry
+      for (auto& worker : m_Workers)
+      {
+        if (worker->idle.load())
+        {
+          Push(*worker, std::move(job), &Worker::background);
+          return true;
+        }
+      }
+      Push(*m_Workers[m_NextWorker++ % m_Workers.size()], std::move(job), &Worker::background);
+      return true;
+    }
+
+    void
+    WorkerPool::Push(Worker& worker, Job job, std::deque<Job> Worker::*queue)
+    {
+      {
+        std::lock_guard<std::mutex> lock{worker.mutex};
+        (worker.*queue).emplace_back(std::move(job));
+        worker.maxQueued = std::max(
+            worker.maxQueued,
+            worker.pinned.size() + worker.shared.size() + worker.background.size());
+      }
+      worker.cond.notify_one();
+    }
+
+    void
+    WorkerPool::Poke(Worker& worker)
+    {
+      {
+        std::lock_guard<std::mutex> lock{worker.mutex};
+        worker.poked = true;
+      }
+      worker.cond.notify_one();
+    }
+
+    bool
+    WorkerPool::Steal(const Worker& thief, Job& job, bool background)
+    {
+      for (auto& victim : m_Workers)
+      {
+        if (victim.get() == &thief)
+          continue;
+        std::lock_guard<std::mutex> lock{victim->mutex};
+        auto& queue = background ? victim->background : victim->shared;
+        if (queue.empty())
+          continue;
+        job = std::move(queue.front());
+        queue.pop_front();
+        return true;
+      }
+      return false;
+    }
+
+    void
+    WorkerPool::Run(Worker& self)
+    {
+      Job job;
+      for (;;)
+      {
+        {
+          std::unique_lock<std::mutex> lock{self.mutex};
+          // keyed work first as nobody else can pick it up
+          auto& queue = self.pinned.empty() ? self.shared : self.pinned;
+          if (not queue.empty())
+          {
+            job = std::move(queue.front());
+            queue.pop_front();
+          }
+        }
+        if (not job and Steal(self, job, false))
+          self.stolen++;
+        // background work only once nobody has anything else for us
+        if (not job)
+        {
+          {
+            std::unique_lock<std::mutex> lock{self.mutex};
+            if (not self.background.empty())
+            {
+              job = std::move(self.background.front());
+              self.background.pop_front();
+            }
+          }
+          if (not job and Steal(self, job, true))
+            self.stolen++;
+          if (job)
+            m_BackgroundQueued--;
+        }
+        if (job)
+        {
+          job();
+          job.Reset();
+          self.ran++;
+          continue;
+        }
+        std::unique_lock<std::mutex> lock{self.mutex};
+        if (not m_Running.load() and self.pinned.empty() and self.shared.empty()
+            and self.background.empty())
+          return;
+        self.idle.store(true);
+        self.cond.wait(lock, [&self, this]() {
+          return self.poked or not self.pinned.empty() or not self.shared.empty()
+              or not self.background.empty() or not m_Running.load();
+        });
+        self.poked = false;
+        self.idle.store(false);
+      }
+    }
+
+    size_t
+    WorkerPool::Queued() const
+    {
+      size_t queued = 0;
+      for (const auto& worker : m_Workers)
+      {
+        std::lock_guard<std::mutex> lock{worker->mutex};
+        queued += worker->pinned.size() + worker->shared.size() + worker->background.size();
+      }
+      return queued;
+    }
+
+    util::StatusObject
+    WorkerPool::ExtractStatus() const
+    {
+      std::vector<util::StatusObject> workers;
+      uint64_t stolen = 0;
+      for (const auto& worker : m_Workers)
+      {
+        std::lock_guard<std::mutex> lock{worker->mutex};
+        stolen += worker->stolen.load();
+        workers.emplace_back(util::StatusObject{{"pinned", worker->pinned.size()},
+                                                {"shared", worker->shared.size()},
+                                                {"background", worker->background.size()},
+                                                {"maxQueued", worker->maxQueued},
+                                                {"ran", worker->ran.load()},
+                                                {"stolen", worker->stolen.load()}});
+      }
+      return util::StatusObject{{"workers", workers},
+                                {"stolen", stolen},
+                                {"backgroundQueued", m_BackgroundQueued.load()},
+                                {"backgroundRejected", m_BackgroundRejected.load()}};
+    }
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,123 @@
+#ifndef LLARP_UTIL_THREAD_WORKER_POOL_HPP
+#define LLARP_UTIL_THREAD_WORKER_POOL_HPP
+
+#include <util/status.hpp>
+#include <util/thread/job.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// fixed set of worker threads with a queue each, for crypto work
+    /// jobs queued under a key always land on the same worker so work for one path or session
+    /// runs in the order it was queued and keeps its state in one core's cache
+    /// jobs queued without a key are spread round robin and idle workers steal them
+    /// background jobs wait in a bounded queue of their own and only run when a worker has
+    /// nothing else, so bursts of them never hold up the rest
+    class WorkerPool
+    {
+     public:
+      /// 0 threads means one per cpu
+      explicit WorkerPool(size_t threads, std::string name = "llarp-worker");
+
+      ~WorkerPool();
+
+      WorkerPool(const WorkerPool&) = delete;
+      WorkerPool&
+      operator=(const WorkerPool&) = delete;
+
+      void
+      Start();
+
+      /// run whatever is still queued then join the workers
+      void
+      Stop();
+
+      /// run job on any worker
+      void
+      Queue(Job job);
+
+      /// run job on the worker that owns key, after everything queued before it under key
+      void
+      QueueFor(uint64_t key, Job job);
+
+      /// run job on any worker once none has anything keyed or unkeyed, returns false without
+      /// taking it if maxQueued background jobs are already waiting
+      bool
+      TryQueueBackground(Job job, size_t maxQueued);
+
+      /// background jobs waiting right now
+      size_t
+      BackgroundQueued() const
+      {
+        return m_BackgroundQueued.load();
+      }
+
+      /// jobs of every kind waiting in all the workers' queues, takes each worker's lock
+      size_t
+      Queued() const;
+
+      size_t
+      NumWorkers() const
+      {
+        return m_Workers.size();
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Worker
+      {
+        mutable std::mutex mutex;
+        std::condition_variable cond;
+        /// keyed jobs, only this worker runs them
+        std::deque<Job> pinned;
+        /// unkeyed jobs, anyone may take them
+        std::deque<Job> shared;
+        /// background jobs, anyone may take them when there is nothing else
+        std::deque<Job> background;
+        /// set to make a waiting worker look around for jobs to steal
+        bool poked = false;
+        std::atomic<bool> idle{false};
+        std::atomic<uint64_t> ran{0};
+        std::atomic<uint64_t> stolen{0};
+        size_t maxQueued = 0;
+        std::thread thread;
+      };
+
+      void
+      Run(Worker& self);
+
+      /// take a job off another worker's shared or background queue
+      bool
+      Steal(const Worker& thief, Job& job, bool background);
+
+      /// push job onto one of a worker's queues and wake it
+      void
+      Push(Worker& worker, Job job, std::deque<Job> Worker::*queue);
+
+      static void
+      Poke(Worker& worker);
+
+      std::vector<std::unique_ptr<Worker>> m_Workers;
+      std::atomic<size_t> m_NextWorker{0};
+      std::atomic<size_t> m_BackgroundQueued{0};
+      std::atomic<uint64_t> m_BackgroundRejected{0};
+      std::atomic<bool> m_Running{false};
+      std::string m_Name;
+    };
+  }  // namespace thread
+}  // namespace llarp
+
+#endif
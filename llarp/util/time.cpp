@@ -1,4 +1,5 @@
 #include <util/time.hpp>
+#include <atomic>
 #include <chrono>
 #include <util/logging/logger.hpp>
 
@@ -26,9 +27,23 @@ namespace llarp
         - started_at_steady;
   }
 
+#ifdef LOKINET_SIMULATION
+  static std::atomic<const std::atomic<llarp_time_t>*> virtual_time{nullptr};
+
+  void
+  set_virtual_time_source(const std::atomic<llarp_time_t>* source)
+  {
+    virtual_time.store(source, std::memory_order_release);
+  }
+#endif
+
   llarp_time_t
   time_now_ms()
   {
+#ifdef LOKINET_SIMULATION
+    if (const auto* source = virtual_time.load(std::memory_order_acquire))
+      return source->load(std::memory_order_relaxed);
+#endif
     static llarp_time_t lastTime = 0s;
     auto t = time_since_started();
 #ifdef TESTNET_SPEED
@@ -58,6 +73,35 @@ namespace llarp
     return t;
   }
 
+  /// what coarse_now_ms returns, 0 until a loop publishes
+  static std::atomic<llarp_time_t::rep> coarse_time{0};
+
+  llarp_time_t
+  coarse_now_ms()
+  {
+#ifdef LOKINET_SIMULATION
+    if (virtual_time.load(std::memory_order_acquire))
+      return time_now_ms();
+#endif
+    const auto t = coarse_time.load(std::memory_order_relaxed);
+    if (t == 0)
+      return time_now_ms();
+    return llarp_time_t{t};
+  }
+
+  llarp_time_t
+  publish_coarse_now_ms()
+  {
+    const auto now = time_now_ms();
+    auto prev = coarse_time.load(std::memory_order_relaxed);
+    while (prev < now.count()
+           and not coarse_time.compare_exchange_weak(
+               prev, now.count(), std::memory_order_relaxed))
+    {
+    }
+    return now;
+  }
+
   nlohmann::json
   to_json(const llarp_time_t& t)
   {
@@ -4,20 +4,51 @@
 #include <util/types.hpp>
 #include <nlohmann/json.hpp>
 
+#ifdef LOKINET_SIMULATION
+#include <atomic>
+#endif
+
 using namespace std::chrono_literals;
 
 namespace llarp
 {
   /// get time right now as milliseconds, this is monotonic
+  /// reads the clock each call, per packet code wants coarse_now_ms
   llarp_time_t
   time_now_ms();
 
+  /// time_now_ms as an event loop last published it, one relaxed atomic load from any thread.
+  /// the loops publish each time they wake, so this is behind by at most the work done since.
+  /// reads the clock until some loop has published
+  llarp_time_t
+  coarse_now_ms();
+
+  /// read the clock, publish it for coarse_now_ms and return it. called by event loops each
+  /// time they wake, several may publish and the latest time wins
+  llarp_time_t
+  publish_coarse_now_ms();
+
+#ifdef LOKINET_SIMULATION
+  /// while set time_now_ms returns what source holds instead of reading the clock, for
+  /// simulations on virtual time. nullptr goes back to the clock
+  void
+  set_virtual_time_source(const std::atomic<llarp_time_t>* source);
+#endif
+
   std::ostream&
   operator<<(std::ostream& out, const llarp_time_t& t);
 
   nlohmann::json
   to_json(const llarp_time_t& t);
 
+  /// time from now until the next multiple of window, timers that wait on the same window
+  /// wake together
+  inline llarp_time_t
+  time_until_aligned(llarp_time_t now, llarp_time_t window)
+  {
+    return window - (now % window);
+  }
+
 }  // namespace llarp
 
 #endif
@@ -0,0 +1,198 @@
+#include <util/timer_wheel.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace util
+  {
+    static constexpr uint64_t SlotMask = TimerWheel::NumSlots - 1;
+
+    void
+    TimerWheel::Schedule(uint32_t id, llarp_time_t now, llarp_time_t delay, Callback_t cb)
+    {
+      Cancel(id);
+      const uint64_t when = now.count();
+      if (empty())
+        m_Now = std::max(m_Now, when);
+      uint32_t idx;
+      if (m_Free.empty())
+      {
+        idx = m_Timers.size();
+        m_Timers.emplace_back();
+      }
+      else
+      {
+        idx = m_Free.back();
+        m_Free.pop_back();
+      }
+      auto& timer = m_Timers[idx];
+      // never due on the tick we are at so a callback rescheduling itself can't spin Advance
+      timer.expires = std::max(when + std::max(delay.count(), int64_t{0}), m_Now + 1);
+      timer.id = id;
+      timer.callback = std::move(cb);
+      Place(idx);
+      m_Index.emplace(id, idx);
+    }
+
+    bool
+    TimerWheel::Cancel(uint32_t id)
+    {
+      const auto itr = m_Index.find(id);
+      if (itr == m_Index.end())
+        return false;
+      const auto idx = itr->second;
+      m_Index.erase(itr);
+      Unlink(idx);
+      Release(idx);
+      return true;
+    }
+
+    size_t
+    TimerWheel::Advance(llarp_time_t now)
+    {
+      const uint64_t target = now.count();
+      size_t ran = 0;
+      while (m_Now < target)
+      {
+        if (empty())
+        {
+          m_Now = target;
+          break;
+        }
+        // jump straight to the next tick where something is due or has to be moved down
+        uint64_t next = target;
+        for (size_t level = 0; level < NumLevels; ++level)
+        {
+          if (const auto tick = NextTick(level))
+            next = std::min(next, *tick);
+        }
+        m_Now = next;
+        for (size_t level = NumLevels - 1; level > 0; --level)
+        {
+          const size_t shift = level * SlotBits;
+          if ((m_Now & ((uint64_t{1} << shift) - 1)) == 0)
+            Cascade(level, (m_Now >> shift) & SlotMask);
+        }
+        ran += Fire();
+      }
+      return ran;
+    }
+
+    std::optional<llarp_time_t>
+    TimerWheel::NextWakeup() const
+    {
+      std::optional<uint64_t> next;
+      for (size_t level = 0; level < NumLevels; ++level)
+      {
+        const auto tick = NextTick(level);
+        if (tick and (not next or *tick < *next))
+          next = tick;
+      }
+      if (not next)
+        return std::nullopt;
+      return llarp_time_t{*next};
+    }
+
+    std::optional<uint64_t>
+    TimerWheel::NextTick(size_t level) const
+    {
+      const uint64_t occupied = m_Levels[level].occupied;
+      if (occupied == 0)
+        return std::nullopt;
+      const size_t shift = level * SlotBits;
+      const uint64_t block = m_Now >> shift;
+      // rotate so bit 0 is the slot right after the current one
+      const size_t rot = (block + 1) & SlotMask;
+      const uint64_t ahead = rot ? (occupied >> rot) | (occupied << (NumSlots - rot)) : occupied;
+      const uint64_t blocks = __builtin_ctzll(ahead) + 1;
+      return (block + blocks) << shift;
+    }
+
+    void
+    TimerWheel::Place(uint32_t idx)
+    {
+      auto& timer = m_Timers[idx];
+      const uint64_t delta = timer.expires > m_Now ? timer.expires - m_Now : 0;
+      size_t level = 0;
+      while (level < NumLevels and delta >= (uint64_t{1} << ((level + 1) * SlotBits)))
+        ++level;
+      uint64_t expires = timer.expires;
+      if (level == NumLevels)
+      {
+        // past the top level, park it in the furthest slot and place it again when that comes up
+        level = NumLevels - 1;
+        expires = m_Now + (uint64_t{1} << (NumLevels * SlotBits)) - 1;
+      }
+      const size_t slot = (expires >> (level * SlotBits)) & SlotMask;
+      auto& lvl = m_Levels[level];
+      timer.level = level;
+      timer.slot = slot;
+      timer.prev = npos;
+      timer.next = lvl.heads[slot];
+      if (timer.next != npos)
+        m_Timers[timer.next].prev = idx;
+      lvl.heads[slot] = idx;
+      lvl.occupied |= uint64_t{1} << slot;
+    }
+
+    void
+    TimerWheel::Unlink(uint32_t idx)
+    {
+      auto& timer = m_Timers[idx];
+      auto& lvl = m_Levels[timer.level];
+      if (timer.prev == npos)
+        lvl.heads[timer.slot] = timer.next;
+      else
+        m_Timers[timer.prev].next = timer.next;
+      if (timer.next != npos)
+        m_Timers[timer.next].prev = timer.prev;
+      if (lvl.heads[timer.slot] == npos)
+        lvl.occupied &= ~(uint64_t{1} << timer.slot);
+      timer.prev = npos;
+      timer.next = npos;
+    }
+
+    void
+    TimerWheel::Release(uint32_t idx)
+    {
+      m_Timers[idx].callback = nullptr;
+      m_Free.push_back(idx);
+    }
+
+    void
+    TimerWheel::Cascade(size_t level, size_t slot)
+    {
+      auto& lvl = m_Levels[level];
+      uint32_t idx = lvl.heads[slot];
+      lvl.heads[slot] = npos;
+      lvl.occupied &= ~(uint64_t{1} << slot);
+      while (idx != npos)
+      {
+        const uint32_t next = m_Timers[idx].next;
+        Place(idx);
+        idx = next;
+      }
+    }
+
+    size_t
+    TimerWheel::Fire()
+    {
+      const size_t slot = m_Now & SlotMask;
+      size_t ran = 0;
+      // callbacks can cancel timers in this slot so always take the head again
+      while (m_Levels[0].heads[slot] != npos)
+      {
+        const uint32_t idx = m_Levels[0].heads[slot];
+        Unlink(idx);
+        m_Index.erase(m_Timers[idx].id);
+        auto callback = std::move(m_Timers[idx].callback);
+        Release(idx);
+        if (callback)
+          callback();
+        ran++;
+      }
+      return ran;
+    }
+  }  // namespace util
+}  // namespace llarp
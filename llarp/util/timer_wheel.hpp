@@ -0,0 +1,124 @@
+#ifndef LLARP_UTIL_TIMER_WHEEL_HPP
+#define LLARP_UTIL_TIMER_WHEEL_HPP
+
+#include <util/types.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// hierarchical timer wheel with millisecond resolution
+    /// scheduling and cancelling are O(1), advancing only touches slots that have timers in them
+    /// and timers further out than the top level are parked there and re-placed as it turns
+    /// not thread safe
+    class TimerWheel
+    {
+     public:
+      using Callback_t = std::function<void(void)>;
+
+      static constexpr size_t SlotBits = 6;
+      static constexpr size_t NumSlots = size_t{1} << SlotBits;
+      static constexpr size_t NumLevels = 4;
+
+      /// run cb once the wheel is advanced delay past now, a timer already under id is replaced
+      /// now is only used to start the wheel's clock when it has nothing scheduled
+      void
+      Schedule(uint32_t id, llarp_time_t now, llarp_time_t delay, Callback_t cb);
+
+      /// drop the timer under id without running it, return true if there was one
+      bool
+      Cancel(uint32_t id);
+
+      /// run every timer due at or before now, in order of expiry
+      /// callbacks may schedule and cancel timers
+      /// returns how many timers were run
+      size_t
+      Advance(llarp_time_t now);
+
+      /// when the next timer is due or something needs to be moved down a level, whichever is
+      /// sooner, nullopt if nothing is scheduled
+      std::optional<llarp_time_t>
+      NextWakeup() const;
+
+      llarp_time_t
+      Now() const
+      {
+        return llarp_time_t{m_Now};
+      }
+
+      size_t
+      size() const
+      {
+        return m_Index.size();
+      }
+
+      bool
+      empty() const
+      {
+        return m_Index.empty();
+      }
+
+     private:
+      static constexpr uint32_t npos = ~uint32_t{0};
+
+      struct Timer
+      {
+        uint64_t expires = 0;
+        uint32_t id = 0;
+        uint32_t prev = npos;
+        uint32_t next = npos;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        Callback_t callback;
+      };
+
+      struct Level
+      {
+        std::array<uint32_t, NumSlots> heads;
+        /// bit n is set when slot n has timers
+        uint64_t occupied = 0;
+
+        Level()
+        {
+          heads.fill(npos);
+        }
+      };
+
+      void
+      Place(uint32_t idx);
+
+      void
+      Unlink(uint32_t idx);
+
+      void
+      Release(uint32_t idx);
+
+      /// move everything in a slot of a higher level down to where it belongs now
+      void
+      Cascade(size_t level, size_t slot);
+
+      /// run everything in the level 0 slot of the current tick
+      size_t
+      Fire();
+
+      /// the tick after m_Now at which the nearest occupied slot of a level comes up
+      std::optional<uint64_t>
+      NextTick(size_t level) const;
+
+      std::array<Level, NumLevels> m_Levels;
+      std::vector<Timer> m_Timers;
+      std::vector<uint32_t> m_Free;
+      std::unordered_map<uint32_t, uint32_t> m_Index;
+      uint64_t m_Now = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef LLARP_UTIL_TOKEN_BUCKET_HPP
+#define LLARP_UTIL_TOKEN_BUCKET_HPP
+
+#include <util/time.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// lets through rate things a second on average and up to burst at once. starts full and
+    /// refills as time passes, worked out when it is used so an idle one costs nothing
+    struct TokenBucket
+    {
+      TokenBucket(double rate, double burst) : m_Rate(rate), m_Burst(burst), m_Tokens(burst)
+      {}
+
+      /// the tokens there are at now
+      double
+      Available(llarp_time_t now)
+      {
+        Refill(now);
+        return m_Tokens;
+      }
+
+      /// take cost tokens if there are that many, false and none taken if not
+      bool
+      Take(llarp_time_t now, double cost = 1.0)
+      {
+        Refill(now);
+        if (m_Tokens < cost)
+          return false;
+        m_Tokens -= cost;
+        return true;
+      }
+
+      /// true if it is full at now, so forgetting it changes nothing
+      bool
+      Full(llarp_time_t now)
+      {
+        return Available(now) >= m_Burst;
+      }
+
+     private:
+      void
+      Refill(llarp_time_t now)
+      {
+        if (now > m_LastRefill)
+        {
+          const std::chrono::duration<double> dlt = now - m_LastRefill;
+          m_Tokens = std::min(m_Burst, m_Tokens + dlt.count() * m_Rate);
+        }
+        m_LastRefill = std::max(m_LastRefill, now);
+      }
+
+      double m_Rate;
+      double m_Burst;
+      double m_Tokens;
+      llarp_time_t m_LastRefill = 0s;
+    };
+  }  // namespace util
+}  // namespace llarp
+
+#endif
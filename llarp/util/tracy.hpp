@@ -0,0 +1,33 @@
+#ifndef LLARP_UTIL_TRACY_HPP
+#define LLARP_UTIL_TRACY_HPP
+
+/// tracy profiler instrumentation, built with TRACY_ROOT set in cmake and compiled out otherwise.
+/// names must be string literals, tracy keeps the pointer
+
+#ifdef TRACY_ENABLE
+#include "Tracy.hpp"
+
+#include <cstdint>
+
+/// time the rest of the enclosing scope as a zone, at most one per scope
+#define LLARP_ZONE(name) ZoneScopedN(name)
+/// end a frame of the main loop
+#define LLARP_FRAME() FrameMark
+/// plot a number over time
+#define LLARP_PLOT(name, val) TracyPlot(name, static_cast<int64_t>(val))
+#else
+#define LLARP_ZONE(name) \
+  do                     \
+  {                      \
+  } while (0)
+#define LLARP_FRAME() \
+  do                  \
+  {                   \
+  } while (0)
+#define LLARP_PLOT(name, val) \
+  do                          \
+  {                           \
+  } while (0)
+#endif
+
+#endif
@@ -10,6 +10,10 @@ namespace llarp
           .def(py::init<std::string, Context_ptr>())
           .def("SendTo", &PythonEndpoint::SendPacket)
           .def("OurAddress", &PythonEndpoint::GetOurAddress)
+          .def("IsReady", &PythonEndpoint::IsReady)
+          .def("SendBurst", &PythonEndpoint::SendBurst)
+          .def("CountTraffic", &PythonEndpoint::CountTraffic)
+          .def("TakeTraffic", &PythonEndpoint::TakeTraffic)
           .def_readwrite("GotPacket", &PythonEndpoint::handlePacket);
     }
 
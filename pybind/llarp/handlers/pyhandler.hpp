@@ -5,6 +5,14 @@
 #include "service/endpoint.hpp"
 #include "router/abstractrouter.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
 namespace llarp
 {
   namespace handlers
@@ -28,6 +36,11 @@ namespace llarp
           service::ProtocolType proto,
           uint64_t) override
       {
+        if (m_CountTraffic)
+        {
+          CountPacket(pktbuf);
+          return true;
+        }
         if (handlePacket)
         {
           AlignedBuffer<32> addr;
@@ -89,6 +102,71 @@ namespace llarp
       {
         return m_Identity.pub.Addr().ToString();
       }
+
+      /// for benchmarks, send count packets of size bytes to remote from the logic thread, each
+      /// stamped with when it went so the far end can tell its latency without python in the way
+      void
+      SendBurst(service::Address remote, size_t count, size_t size)
+      {
+        LogicCall(m_router->logic(), [remote, count, size, self = shared_from_this()]() {
+          std::vector<byte_t> pkt(std::max(size, sizeof(uint64_t)));
+          for (size_t idx = 0; idx < count; ++idx)
+          {
+            const uint64_t sent = StampNow();
+            std::memcpy(pkt.data(), &sent, sizeof(sent));
+            self->SendToServiceOrQueue(remote, llarp_buffer_t(pkt), service::eProtocolControl);
+          }
+        });
+      }
+
+      /// count what comes in from SendBurst instead of handing it to GotPacket
+      void
+      CountTraffic(bool enable)
+      {
+        m_CountTraffic = enable;
+      }
+
+      /// packets and bytes counted since the last call, and the latency of each packet in
+      /// microseconds
+      std::tuple<uint64_t, uint64_t, std::vector<uint64_t>>
+      TakeTraffic()
+      {
+        std::lock_guard<std::mutex> lock(m_TrafficMutex);
+        auto taken = std::make_tuple(m_Packets, m_Bytes, std::move(m_Latencies));
+        m_Packets = 0;
+        m_Bytes = 0;
+        m_Latencies.clear();
+        return taken;
+      }
+
+     private:
+      static uint64_t
+      StampNow()
+      {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+      }
+
+      void
+      CountPacket(const llarp_buffer_t& pktbuf)
+      {
+        uint64_t sent = 0;
+        if (pktbuf.sz >= sizeof(sent))
+          std::memcpy(&sent, pktbuf.base, sizeof(sent));
+        const auto now = StampNow();
+        std::lock_guard<std::mutex> lock(m_TrafficMutex);
+        m_Packets++;
+        m_Bytes += pktbuf.sz;
+        if (sent != 0 and sent <= now)
+          m_Latencies.push_back(now - sent);
+      }
+
+      std::atomic<bool> m_CountTraffic{false};
+      std::mutex m_TrafficMutex;
+      uint64_t m_Packets = 0;
+      uint64_t m_Bytes = 0;
+      std::vector<uint64_t> m_Latencies;
     };
 
     using PythonEndpoint_ptr = std::shared_ptr<PythonEndpoint>;
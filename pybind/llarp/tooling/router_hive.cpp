@@ -50,6 +50,8 @@ namespace tooling
         .def("GetAllEvents", &RouterHive::GetAllEvents)
         .def("RelayConnectedRelays", &RouterHive::RelayConnectedRelays)
         .def("GetRelayRCs", &RouterHive::GetRelayRCs)
+        .def("RelayCPUTimes", &RouterHive::RelayCPUTimes)
+        .def("ClientCPUTimes", &RouterHive::ClientCPUTimes)
         .def("GetRelay", &RouterHive::GetRelay);
   }
 }  // namespace tooling
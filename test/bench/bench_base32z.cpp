@@ -0,0 +1,122 @@
+#include <router_id.hpp>
+#include <util/base32z.hpp>
+
+#include <cxxopts.hpp>
+#include <lokimq/base32z.h>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// base32z for the 32 byte keys in every .loki and .snode name, lokimq's codec against ours,
+/// and keys rendered through the per thread cache for a few hot keys and for many cold ones.
+/// results go out as json on stdout
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  std::vector<llarp::RouterID>
+  MakeKeys(size_t count)
+  {
+    std::vector<llarp::RouterID> keys(count);
+    for (auto& key : keys)
+      key.Randomize();
+    return keys;
+  }
+
+  template <typename Op_t>
+  nlohmann::json
+  Run(const std::string& name, size_t count, std::chrono::milliseconds duration, Op_t op)
+  {
+    uint64_t ops = 0;
+    size_t sink = 0;
+    const auto started = Clock_t::now();
+    const auto until = started + duration;
+    do
+    {
+      for (size_t idx = 0; idx < count; ++idx)
+        sink += op(idx);
+      ops += count;
+    } while (Clock_t::now() < until);
+    const double seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+    return {{"name", name},
+            {"keys", count},
+            {"ops", ops},
+            {"sink", sink},
+            {"ns_per_op", 1e9 * seconds / ops}};
+  }
+
+  void
+  RunAll(nlohmann::json& results, size_t count, std::chrono::milliseconds duration)
+  {
+    const auto keys = MakeKeys(count);
+    std::vector<std::string> encoded;
+    for (const auto& key : keys)
+      encoded.emplace_back(llarp::base32z::Encode(key.data(), key.size()));
+
+    results.push_back(Run("encode/lokimq", count, duration, [&](size_t idx) {
+      return lokimq::to_base32z(keys[idx].begin(), keys[idx].end()).size();
+    }));
+    results.push_back(Run("encode/llarp", count, duration, [&](size_t idx) {
+      return llarp::base32z::Encode(keys[idx].data(), keys[idx].size()).size();
+    }));
+    results.push_back(Run("encode/cached", count, duration, [&](size_t idx) {
+      std::string str;
+      llarp::base32z::AppendKey(str, keys[idx].data());
+      return str.size();
+    }));
+    results.push_back(Run("decode/lokimq", count, duration, [&](size_t idx) {
+      llarp::RouterID out;
+      if (not lokimq::is_base32z(encoded[idx]))
+        return size_t{0};
+      lokimq::from_base32z(encoded[idx].begin(), encoded[idx].end(), out.begin());
+      return size_t{out[0]};
+    }));
+    results.push_back(Run("decode/llarp", count, duration, [&](size_t idx) {
+      llarp::RouterID out;
+      llarp::base32z::Decode(encoded[idx], out.data(), out.size());
+      return size_t{out[0]};
+    }));
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchBase32z", "base32z key codec benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("d,duration", "milliseconds each benchmark runs for", cxxopts::value<uint64_t>()->default_value("500"))
+    ;
+  // clang-format on
+
+  std::chrono::milliseconds duration;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    duration = std::chrono::milliseconds(result["duration"].as<uint64_t>());
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  nlohmann::json results = nlohmann::json::array();
+  // a handful of hot names as a resolver busy with a few sites sees, then mostly misses
+  for (const size_t count : {size_t{16}, size_t{10000}})
+    RunAll(results, count, duration);
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
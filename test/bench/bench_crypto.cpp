@@ -0,0 +1,338 @@
+#include <constants/link_layer.hpp>
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/hot_crypto.hpp>
+#include <crypto/types.hpp>
+#include <crypto/xchacha20_lanes.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// micro benchmarks for every llarp::Crypto primitive, run on one thread and then across
+/// --threads threads, results go out as json on stdout. run it again with
+/// AVX2_FORCE_DISABLE=1 to get the portable numbers to compare against
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  /// one primitive, make() sets up the keys and buffers one thread uses and gives back the
+  /// operation to time
+  struct Bench
+  {
+    std::string name;
+    /// bytes one operation covers, 0 for the ones where only ops/s means anything
+    size_t bytes;
+    std::function<std::function<void()>()> make;
+  };
+
+  struct Result
+  {
+    uint64_t ops = 0;
+    double seconds = 0;
+  };
+
+  static constexpr size_t BatchCells = 64;
+  static constexpr size_t CellSize = 512;
+
+  template <typename Buffer_t>
+  Buffer_t
+  Random()
+  {
+    Buffer_t buf;
+    buf.Randomize();
+    return buf;
+  }
+
+  std::vector<Bench>
+  Benches()
+  {
+    std::vector<Bench> benches;
+    auto crypto = CryptoManager::instance();
+
+    for (const size_t sz : {size_t{1024}, size_t{4096}, MAX_LINK_MSG_SIZE})
+    {
+      benches.push_back({"xchacha20/" + std::to_string(sz), sz, [crypto, sz]() {
+                           auto data = std::make_shared<std::vector<byte_t>>(sz);
+                           const auto key = Random<SharedSecret>();
+                           const auto nonce = Random<TunnelNonce>();
+                           return [crypto, data, key, nonce]() {
+                             crypto->xchacha20(llarp_buffer_t(*data), key, nonce);
+                           };
+                         }});
+      // the same call bound at compile time when LOKINET_STATIC_CRYPTO is on
+      benches.push_back({"xchacha20_hot/" + std::to_string(sz), sz, [sz]() {
+                           auto data = std::make_shared<std::vector<byte_t>>(sz);
+                           const auto key = Random<SharedSecret>();
+                           const auto nonce = Random<TunnelNonce>();
+                           return [data, key, nonce]() {
+                             HotCrypto()->xchacha20(llarp_buffer_t(*data), key, nonce);
+                           };
+                         }});
+    }
+
+    // a path hop layer, many relay cells under one key
+    benches.push_back({"xchacha20_batch/64x512", BatchCells * CellSize, [crypto]() {
+                         auto data = std::make_shared<std::vector<byte_t>>(BatchCells * CellSize);
+                         auto spans = std::make_shared<std::vector<CryptoSpan>>();
+                         auto nonces = std::make_shared<std::vector<TunnelNonce>>(BatchCells);
+                         for (size_t idx = 0; idx < BatchCells; ++idx)
+                         {
+                           spans->push_back({data->data() + idx * CellSize, CellSize});
+                           (*nonces)[idx].Randomize();
+                         }
+                         const auto key = Random<SharedSecret>();
+                         return [crypto, data, spans, nonces, key]() {
+                           crypto->xchacha20_batch(
+                               spans->data(), nonces->data(), spans->size(), key);
+                         };
+                       }});
+
+    benches.push_back({"hmac/1024", 1024, [crypto]() {
+                         auto data = std::make_shared<std::vector<byte_t>>(1024);
+                         const auto key = Random<SharedSecret>();
+                         return [crypto, data, key]() {
+                           ShortHash result;
+                           crypto->hmac(result.data(), llarp_buffer_t(*data), key);
+                         };
+                       }});
+
+    benches.push_back({"shorthash/1024", 1024, [crypto]() {
+                         auto data = std::make_shared<std::vector<byte_t>>(1024);
+                         return [crypto, data]() {
+                           ShortHash result;
+                           crypto->shorthash(result, llarp_buffer_t(*data));
+                         };
+                       }});
+
+    const auto signer = [crypto]() {
+      auto key = std::make_shared<SecretKey>();
+      crypto->identity_keygen(*key);
+      return key;
+    };
+
+    benches.push_back({"sign/256", 256, [crypto, signer]() {
+                         auto key = signer();
+                         auto data = std::make_shared<std::vector<byte_t>>(256);
+                         return [crypto, key, data]() {
+                           Signature sig;
+                           crypto->sign(sig, *key, llarp_buffer_t(*data));
+                         };
+                       }});
+
+    benches.push_back({"verify/256", 256, [crypto, signer]() {
+                         auto key = signer();
+                         auto data = std::make_shared<std::vector<byte_t>>(256);
+                         auto sig = std::make_shared<Signature>();
+                         crypto->sign(*sig, *key, llarp_buffer_t(*data));
+                         const PubKey pub = key->toPublic();
+                         return [crypto, pub, data, sig]() {
+                           crypto->verify(pub, llarp_buffer_t(*data), *sig);
+                         };
+                       }});
+
+    const auto dh = [crypto](bool client) {
+      return [crypto, client]() {
+        SecretKey us, them;
+        crypto->encryption_keygen(us);
+        crypto->encryption_keygen(them);
+        const PubKey pub = them.toPublic();
+        const auto nonce = Random<TunnelNonce>();
+        return [crypto, client, us, pub, nonce]() {
+          SharedSecret shared;
+          if (client)
+            crypto->dh_client(shared, pub, us, nonce);
+          else
+            crypto->dh_server(shared, pub, us, nonce);
+        };
+      };
+    };
+    benches.push_back({"dh_client", 0, dh(true)});
+    benches.push_back({"dh_server", 0, dh(false)});
+
+    const auto pqkeys = [crypto]() {
+      auto keys = std::make_shared<PQKeyPair>();
+      crypto->pqe_keygen(*keys);
+      return keys;
+    };
+
+    benches.push_back({"pqe_encrypt", 0, [crypto, pqkeys]() {
+                         auto keys = pqkeys();
+                         const PQPubKey pub(pq_keypair_to_public(*keys));
+                         return [crypto, pub]() {
+                           PQCipherBlock C;
+                           SharedSecret K;
+                           crypto->pqe_encrypt(C, K, pub);
+                         };
+                       }});
+
+    benches.push_back({"pqe_decrypt", 0, [crypto, pqkeys]() {
+                         auto keys = pqkeys();
+                         auto C = std::make_shared<PQCipherBlock>();
+                         SharedSecret K;
+                         crypto->pqe_encrypt(*C, K, PQPubKey(pq_keypair_to_public(*keys)));
+                         return [crypto, keys, C]() {
+                           SharedSecret K;
+                           crypto->pqe_decrypt(*C, K, pq_keypair_to_secret(*keys));
+                         };
+                       }});
+
+    benches.push_back({"derive_subkey", 0, [crypto, signer]() {
+                         const PubKey root = signer()->toPublic();
+                         return [crypto, root]() {
+                           PubKey derived;
+                           crypto->derive_subkey(derived, root, 1);
+                         };
+                       }});
+
+    benches.push_back({"derive_subkey_private", 0, [crypto, signer]() {
+                         auto root = signer();
+                         return [crypto, root]() {
+                           PrivateKey derived;
+                           crypto->derive_subkey_private(derived, *root, 1);
+                         };
+                       }});
+
+    return benches;
+  }
+
+  /// run op on threads threads for about duration, each on its own keys and buffers
+  Result
+  Run(const Bench& bench, size_t threads, Clock_t::duration duration)
+  {
+    std::atomic<uint64_t> total = 0;
+    std::atomic<size_t> ready = 0;
+    std::atomic<bool> go = false;
+    std::vector<std::thread> workers;
+    for (size_t idx = 0; idx < threads; ++idx)
+    {
+      workers.emplace_back([&]() {
+        auto op = bench.make();
+        // warm up the caches and the clocks before anyone is timed
+        for (int warm = 0; warm < 16; ++warm)
+          op();
+        ready++;
+        while (not go)
+          std::this_thread::yield();
+        const auto until = Clock_t::now() + duration;
+        uint64_t ops = 0;
+        do
+        {
+          // check the clock every few ops so it does not show up in the cheap ones
+          for (int step = 0; step < 16; ++step)
+            op();
+          ops += 16;
+        } while (Clock_t::now() < until);
+        total += ops;
+      });
+    }
+    while (ready < threads)
+      std::this_thread::yield();
+    const auto started = Clock_t::now();
+    go = true;
+    for (auto& worker : workers)
+      worker.join();
+    Result result;
+    result.ops = total;
+    result.seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+    return result;
+  }
+
+  nlohmann::json
+  ToJSON(const Bench& bench, size_t threads, const Result& result)
+  {
+    const double opsPerSec = result.ops / result.seconds;
+    nlohmann::json obj{{"name", bench.name},
+                       {"threads", threads},
+                       {"ops", result.ops},
+                       {"seconds", result.seconds},
+                       {"ops_per_sec", opsPerSec},
+                       // per thread, so it lines up with the single threaded run
+                       {"ns_per_op", 1e9 * threads / opsPerSec}};
+    if (bench.bytes)
+      obj["mb_per_sec"] = opsPerSec * bench.bytes / 1e6;
+    return obj;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchCrypto", "llarp::Crypto micro benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("t,threads", "threads for the threaded run, 0 for one per core", cxxopts::value<size_t>()->default_value("0"))
+    ("d,duration", "milliseconds each benchmark runs for", cxxopts::value<uint64_t>()->default_value("500"))
+    ("f,filter", "only run benchmarks whose name contains this", cxxopts::value<std::string>()->default_value(""))
+    ;
+  // clang-format on
+
+  size_t threads = 0;
+  std::chrono::milliseconds duration;
+  std::string filter;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    threads = result["threads"].as<size_t>();
+    duration = std::chrono::milliseconds(result["duration"].as<uint64_t>());
+    filter = result["filter"].as<std::string>();
+  }
+  catch (const cxxopts::option_not_exists_exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    std::cout << opts.help() << std::endl;
+    return 1;
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  llarp::sodium::CryptoLibSodium sodium;
+  llarp::CryptoManager manager(&sodium);
+
+  const char* avx2 = std::getenv("AVX2_FORCE_DISABLE");
+  nlohmann::json results = nlohmann::json::array();
+  for (const auto& bench : Benches())
+  {
+    if (bench.name.find(filter) == std::string::npos)
+      continue;
+    results.push_back(ToJSON(bench, 1, Run(bench, 1, duration)));
+    if (threads > 1)
+      results.push_back(ToJSON(bench, threads, Run(bench, threads, duration)));
+  }
+
+  nlohmann::json out{{"context",
+                      {{"avx2_force_disable", avx2 != nullptr and std::string(avx2) == "1"},
+                       {"xchacha20_kernel", llarp::sodium::xchacha20_kernel().name},
+#ifdef LOKINET_STATIC_CRYPTO
+                       {"static_crypto", true},
+#else
+                       {"static_crypto", false},
+#endif
+                       {"hardware_threads", std::thread::hardware_concurrency()}}},
+                     {"benchmarks", results}};
+  std::cout << out.dump(2) << std::endl;
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <net/endpoint_key.hpp>
+#include <net/ip_address.hpp>
+#include <net/sock_addr.hpp>
+#include <router_id.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// what the link layer pays per datagram to find the session for the address it came from,
+/// with the maps keyed by IpAddress as they were and by EndpointKey. each op is made from the
+/// SockAddr recvfrom hands us, like LinkLayer::SessionFor does. results go out as json on
+/// stdout
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  std::vector<llarp::SockAddr>
+  MakeAddrs(size_t count)
+  {
+    std::mt19937 rng{count};
+    std::vector<llarp::SockAddr> addrs;
+    addrs.reserve(count);
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+      sockaddr_in in{};
+      in.sin_family = AF_INET;
+      in.sin_addr.s_addr = rng();
+      in.sin_port = htons(1024 + rng() % 60000);
+      addrs.emplace_back(in);
+    }
+    return addrs;
+  }
+
+  template <typename Key_t>
+  nlohmann::json
+  Run(const std::string& name, size_t count, std::chrono::milliseconds duration)
+  {
+    const auto addrs = MakeAddrs(count);
+    std::unordered_map<Key_t, llarp::RouterID, typename Key_t::Hash> map;
+    for (const auto& addr : addrs)
+      map.emplace(Key_t{addr}, llarp::RouterID{});
+    // datagrams from peers we have no session with miss, as the first of a handshake does
+    const auto strangers = MakeAddrs(count + 1);
+    uint64_t ops = 0;
+    size_t found = 0;
+    const auto started = Clock_t::now();
+    const auto until = started + duration;
+    do
+    {
+      for (size_t idx = 0; idx < count; ++idx)
+      {
+        found += map.count(Key_t{addrs[idx]});
+        found += map.count(Key_t{strangers[idx]});
+      }
+      ops += 2 * count;
+    } while (Clock_t::now() < until);
+    const double seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+    return {{"name", name},
+            {"peers", count},
+            {"ops", ops},
+            {"found", found},
+            {"ns_per_op", 1e9 * seconds / ops}};
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchDemux", "link layer address lookup benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("d,duration", "milliseconds each benchmark runs for", cxxopts::value<uint64_t>()->default_value("500"))
+    ;
+  // clang-format on
+
+  std::chrono::milliseconds duration;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    duration = std::chrono::milliseconds(result["duration"].as<uint64_t>());
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  nlohmann::json results = nlohmann::json::array();
+  for (const size_t count : {size_t{100}, size_t{5000}})
+  {
+    results.push_back(Run<llarp::IpAddress>("ip_address", count, duration));
+    results.push_back(Run<llarp::EndpointKey>("endpoint_key", count, duration));
+  }
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
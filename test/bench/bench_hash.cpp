@@ -0,0 +1,133 @@
+#include <path/path_types.hpp>
+#include <router_id.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// lookups in the unordered maps the router keeps by id, with AlignedBuffer::Hash against
+/// the first word of the id that it used to be, for random ids and for ids made to share
+/// their first word. results go out as json on stdout
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  /// what AlignedBuffer::Hash was before it was keyed
+  template <typename Key_t>
+  struct FirstWordHash
+  {
+    size_t
+    operator()(const Key_t& key) const noexcept
+    {
+      size_t h = 0;
+      std::memcpy(&h, key.data(), sizeof(h));
+      return h;
+    }
+  };
+
+  template <typename Key_t>
+  std::vector<Key_t>
+  MakeKeys(size_t count, bool clustered)
+  {
+    std::vector<Key_t> keys(count);
+    for (auto& key : keys)
+    {
+      key.Randomize();
+      // what someone picking their own ids can do to the old hash
+      if (clustered)
+        std::memset(key.data(), 0, sizeof(size_t));
+    }
+    return keys;
+  }
+
+  template <typename Key_t, typename Hash_t>
+  nlohmann::json
+  Run(const std::string& name, size_t count, bool clustered, std::chrono::milliseconds duration)
+  {
+    const auto keys = MakeKeys<Key_t>(count, clustered);
+    std::unordered_map<Key_t, size_t, Hash_t> map;
+    for (size_t idx = 0; idx < keys.size(); ++idx)
+      map.emplace(keys[idx], idx);
+    uint64_t ops = 0;
+    size_t found = 0;
+    const auto started = Clock_t::now();
+    const auto until = started + duration;
+    do
+    {
+      for (const auto& key : keys)
+        found += map.count(key);
+      ops += keys.size();
+    } while (Clock_t::now() < until);
+    const double seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+    return {{"name", name},
+            {"keys", count},
+            {"clustered", clustered},
+            {"ops", ops},
+            {"found", found},
+            {"ns_per_op", 1e9 * seconds / ops}};
+  }
+
+  template <typename Key_t>
+  void
+  RunBoth(
+      nlohmann::json& results,
+      const std::string& name,
+      size_t count,
+      bool clustered,
+      std::chrono::milliseconds duration)
+  {
+    results.push_back(
+        Run<Key_t, typename Key_t::Hash>(name + "/keyed", count, clustered, duration));
+    results.push_back(
+        Run<Key_t, FirstWordHash<Key_t>>(name + "/first_word", count, clustered, duration));
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchHash", "id map lookup benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("d,duration", "milliseconds each benchmark runs for", cxxopts::value<uint64_t>()->default_value("500"))
+    ;
+  // clang-format on
+
+  std::chrono::milliseconds duration;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    duration = std::chrono::milliseconds(result["duration"].as<uint64_t>());
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  nlohmann::json results = nlohmann::json::array();
+  for (const size_t count : {size_t{1000}, size_t{100000}})
+  {
+    RunBoth<llarp::PathID_t>(results, "path_id", count, false, duration);
+    RunBoth<llarp::RouterID>(results, "router_id", count, false, duration);
+  }
+  // few enough that the old hash finishes, all in one bucket it is quadratic
+  RunBoth<llarp::PathID_t>(results, "path_id", 2000, true, duration);
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
@@ -0,0 +1,447 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <messages/link_intro.hpp>
+#include <messages/relay.hpp>
+#include <messages/relay_commit.hpp>
+#include <net/ip_packet.hpp>
+#include <router_contact.hpp>
+#include <routing/handler.hpp>
+#include <routing/message_parser.hpp>
+#include <routing/path_transfer_message.hpp>
+#include <routing/transfer_traffic_message.hpp>
+#include <service/intro_set.hpp>
+#include <service/protocol.hpp>
+#include <util/buffer.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// bencode and bdecode of the link and routing messages that carry traffic and of what is
+/// gossiped, in ns per op and heap allocations per op. routing messages are decoded through
+/// routing::InboundMessageParser with a handler that takes everything, link messages with
+/// their BDecode as LinkMessageParser would without handing them to a router, and relay
+/// messages through RelayCell::Read, which is what LinkMessageParser does with them. a hidden
+/// service frame is opened as a worker does on an established convo, from its own copy of the
+/// frame to the ip packet the tun takes. results go out as json on stdout
+
+namespace
+{
+  std::atomic<uint64_t> g_Allocations{0};
+}  // namespace
+
+void*
+operator new(size_t sz)
+{
+  g_Allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(sz ? sz : 1))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+  using Buffer_t = std::vector<byte_t>;
+
+  /// a routing message handler that says yes to everything, like a path would
+  struct AcceptAll : public llarp::routing::IMessageHandler
+  {
+    bool
+    HandleObtainExitMessage(const llarp::routing::ObtainExitMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleGrantExitMessage(const llarp::routing::GrantExitMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleRejectExitMessage(const llarp::routing::RejectExitMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleTransferTrafficMessage(
+        const llarp::routing::TransferTrafficMessage&, llarp::AbstractRouter*) override
+    {
+      return true;
+    }
+
+    bool
+    HandleUpdateExitMessage(const llarp::routing::UpdateExitMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleUpdateExitVerifyMessage(
+        const llarp::routing::UpdateExitVerifyMessage&, llarp::AbstractRouter*) override
+    {
+      return true;
+    }
+
+    bool
+    HandleCloseExitMessage(const llarp::routing::CloseExitMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleDataDiscardMessage(const llarp::routing::DataDiscardMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandlePathTransferMessage(
+        const llarp::routing::PathTransferMessage&, llarp::AbstractRouter*) override
+    {
+      return true;
+    }
+
+    bool
+    HandleHiddenServiceFrame(const llarp::service::ProtocolFrame&) override
+    {
+      return true;
+    }
+
+    bool
+    HandlePathConfirmMessage(const llarp::routing::PathConfirmMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandlePathLatencyMessage(const llarp::routing::PathLatencyMessage&, llarp::AbstractRouter*)
+        override
+    {
+      return true;
+    }
+
+    bool
+    HandleBatchMessage(const llarp::routing::BatchMessage&, llarp::AbstractRouter*) override
+    {
+      return true;
+    }
+
+    bool
+    HandleDHTMessage(const llarp::dht::IMessage&, llarp::AbstractRouter*) override
+    {
+      return true;
+    }
+  };
+
+  /// time func for duration after one untimed call that has to succeed
+  template <typename Func_t>
+  nlohmann::json
+  Run(const std::string& name, size_t bytes, std::chrono::milliseconds duration, Func_t func)
+  {
+    if (not func())
+      throw std::runtime_error(name + " failed");
+    uint64_t ops = 0;
+    const auto allocations = g_Allocations.load();
+    const auto started = Clock_t::now();
+    const auto until = started + duration;
+    do
+    {
+      for (size_t idx = 0; idx < 100; ++idx)
+        func();
+      ops += 100;
+    } while (Clock_t::now() < until);
+    const double seconds = std::chrono::duration<double>(Clock_t::now() - started).count();
+    return {{"name", name},
+            {"bytes", bytes},
+            {"ops", ops},
+            {"ns_per_op", 1e9 * seconds / ops},
+            {"allocations_per_op", double(g_Allocations.load() - allocations) / ops}};
+  }
+
+  template <typename Msg_t>
+  Buffer_t
+  Encode(const Msg_t& msg, size_t max)
+  {
+    Buffer_t out(max);
+    llarp_buffer_t buf(out);
+    if (not msg.BEncode(&buf))
+      throw std::runtime_error("encode failed");
+    out.resize(buf.cur - buf.base);
+    return out;
+  }
+
+  /// encode into a buffer of max bytes, then decode what that gave with decode
+  template <typename Msg_t, typename Decode_t>
+  void
+  RunPair(
+      nlohmann::json& results,
+      const std::string& name,
+      const Msg_t& msg,
+      size_t max,
+      std::chrono::milliseconds duration,
+      Decode_t decode)
+  {
+    Buffer_t scratch(max);
+    const auto encoded = Encode(msg, max);
+    results.push_back(Run(name + "/encode", encoded.size(), duration, [&]() {
+      llarp_buffer_t buf(scratch);
+      return msg.BEncode(&buf);
+    }));
+    results.push_back(Run(name + "/decode", encoded.size(), duration, [&]() {
+      return decode(llarp_buffer_t(encoded.data(), encoded.size()));
+    }));
+  }
+
+  llarp::RouterContact
+  MakeRC()
+  {
+    auto crypto = llarp::CryptoManager::instance();
+    llarp::SecretKey sign;
+    llarp::SecretKey encr;
+    crypto->identity_keygen(sign);
+    crypto->encryption_keygen(encr);
+    llarp::RouterContact rc;
+    rc.enckey = encr.toPublic();
+    rc.pubkey = sign.toPublic();
+    rc.SetNick("bench");
+    llarp::AddressInfo ai;
+    ai.rank = 1;
+    ai.dialect = "iwp";
+    ai.pubkey = rc.enckey;
+    ai.port = 1090;
+    rc.addrs.emplace_back(std::move(ai));
+    rc.routerVersion = llarp::RouterVersion{{0, 8, 1}, LLARP_PROTO_VERSION};
+    if (not rc.Sign(sign))
+      throw std::runtime_error("failed to sign rc");
+    return rc;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchMessages", "message encode and decode benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("d,duration", "milliseconds each benchmark runs for", cxxopts::value<uint64_t>()->default_value("500"))
+    ;
+  // clang-format on
+
+  std::chrono::milliseconds duration;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    duration = std::chrono::milliseconds(result["duration"].as<uint64_t>());
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  llarp::sodium::CryptoLibSodium sodium;
+  llarp::CryptoManager manager(&sodium);
+
+  nlohmann::json results = nlohmann::json::array();
+  try
+  {
+    llarp::RelayUpstreamMessage relay;
+    relay.pathid.Randomize();
+    relay.Y.Randomize();
+    relay.X = llarp::Encrypted<MAX_LINK_MSG_SIZE - 128>(1024);
+    relay.X.Randomize();
+    RunPair(results, "relay_upstream", relay, MAX_LINK_MSG_SIZE, duration, [](auto buf) {
+      return llarp::RelayCell::Read(buf).has_value();
+    });
+    {
+      llarp::ILinkSession::Message_t compact;
+      const llarp_buffer_t X(relay.X.data(), relay.X.size());
+      llarp::RelayCell::WriteCompact('u', relay.pathid, X, relay.Y, compact);
+      results.push_back(Run("relay_upstream/compact_encode", compact.size(), duration, [&]() {
+        return llarp::RelayCell::WriteCompact('u', relay.pathid, X, relay.Y, compact);
+      }));
+      results.push_back(Run("relay_upstream/compact_decode", compact.size(), duration, [&]() {
+        return llarp::RelayCell::Read(llarp_buffer_t(compact.data(), compact.size()))
+            .has_value();
+      }));
+    }
+    {
+      llarp::RelayUpstreamMessage decoded;
+      RunPair(
+          results,
+          "relay_upstream/dict",
+          relay,
+          MAX_LINK_MSG_SIZE,
+          duration,
+          [&decoded](auto buf) {
+            decoded.Clear();
+            return decoded.BDecode(&buf);
+          });
+    }
+
+    {
+      llarp::LR_CommitMessage commit;
+      for (auto& frame : commit.frames)
+        frame.Randomize();
+      llarp::LR_CommitMessage decoded;
+      RunPair(
+          results, "lr_commit", commit, MAX_LINK_MSG_SIZE, duration, [&decoded](auto buf) {
+            decoded.Clear();
+            return decoded.BDecode(&buf);
+          });
+    }
+
+    const auto rc = MakeRC();
+    {
+      llarp::LinkIntroMessage intro;
+      intro.rc = rc;
+      intro.N.Randomize();
+      intro.P = 1;
+      intro.Z.Randomize();
+      llarp::LinkIntroMessage decoded;
+      RunPair(
+          results,
+          "link_intro",
+          intro,
+          llarp::LinkIntroMessage::MaxSize,
+          duration,
+          [&decoded](auto buf) {
+            decoded.Clear();
+            return decoded.BDecode(&buf);
+          });
+    }
+
+    AcceptAll handler;
+    llarp::routing::InboundMessageParser parser;
+    const llarp::PathID_t from;
+    const auto parse = [&](auto buf) {
+      return parser.ParseMessageBuffer(buf, &handler, from, nullptr);
+    };
+    {
+      llarp::routing::TransferTrafficMessage traffic;
+      std::vector<byte_t> pkt(1280);
+      for (uint64_t counter = 0; counter < 4; ++counter)
+        traffic.PutBuffer(llarp_buffer_t(pkt), counter);
+      traffic.S = 1;
+      RunPair(
+          results, "transfer_traffic", traffic, MAX_LINK_MSG_SIZE, duration, parse);
+    }
+    {
+      llarp::routing::PathTransferMessage transfer;
+      transfer.P.Randomize();
+      transfer.Y.Randomize();
+      transfer.S = 1;
+      transfer.T.C.Randomize();
+      transfer.T.D = llarp::service::ProtocolFrame::Encrypted_t(1024);
+      transfer.T.D.Randomize();
+      transfer.T.N.Randomize();
+      transfer.T.Z.Randomize();
+      transfer.T.F.Randomize();
+      transfer.T.T.Randomize();
+      RunPair(
+          results, "path_transfer", transfer, MAX_LINK_MSG_SIZE, duration, parse);
+    }
+
+    {
+      llarp::SharedSecret shared;
+      shared.Randomize();
+      std::vector<byte_t> pkt(1280, 0);
+      pkt[0] = 0x45;
+      llarp::service::ProtocolMessage msg;
+      msg.tag.Randomize();
+      msg.PutBuffer(llarp_buffer_t(pkt));
+      llarp::service::ProtocolFrame sealed;
+      sealed.N.Randomize();
+      sealed.T = msg.tag;
+      if (not sealed.EncryptAndMAC(msg, shared))
+        throw std::runtime_error("failed to seal frame");
+      llarp::net::IPPacket ip;
+      // copies the frame, decrypts D where it is, takes the payload into a pooled message and
+      // that into the packet
+      results.push_back(Run("service_frame/open", pkt.size(), duration, [&]() {
+        llarp::service::ProtocolFrame frame = sealed;
+        auto opened = llarp::service::ProtocolMessage::MakePooled();
+        return frame.VerifyMAC(shared) and frame.DecryptPayloadInPlace(shared, *opened)
+            and ip.Load(llarp_buffer_t(opened->payload));
+      }));
+      // with a second copy of D to decrypt and the message off the heap, as it used to be
+      results.push_back(Run("service_frame/open_copied", pkt.size(), duration, [&]() {
+        llarp::service::ProtocolFrame frame = sealed;
+        auto opened = std::make_shared<llarp::service::ProtocolMessage>();
+        return frame.VerifyMAC(shared) and frame.DecryptPayloadInto(shared, *opened)
+            and ip.Load(llarp_buffer_t(opened->payload));
+      }));
+    }
+    {
+      llarp::RouterContact decoded;
+      RunPair(results, "router_contact", rc, MAX_RC_SIZE, duration, [&decoded](auto buf) {
+        decoded.Clear();
+        return decoded.BDecode(&buf);
+      });
+    }
+    {
+      llarp::service::EncryptedIntroSet introset;
+      introset.derivedSigningKey.Randomize();
+      introset.signedAt = llarp::time_now_ms();
+      introset.introsetPayload.resize(1024);
+      introset.nounce.Randomize();
+      introset.sig.Randomize();
+      llarp::service::EncryptedIntroSet decoded;
+      RunPair(
+          results,
+          "encrypted_introset",
+          introset,
+          MAX_LINK_MSG_SIZE,
+          duration,
+          [&decoded](auto buf) {
+            decoded = llarp::service::EncryptedIntroSet{};
+            return decoded.BDecode(&buf);
+          });
+    }
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
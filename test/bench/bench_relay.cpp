@@ -0,0 +1,140 @@
+#include <ev/ev.h>
+#include <ev/ev.hpp>
+#include <net/sock_addr.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// what one relay hop adds to a datagram's round trip with the event loop blocking as it does
+/// by default and with it busy polling. an event loop on its own thread sends each datagram
+/// it reads on loopback straight back, as a relay passes a cell on, while we ping it at a
+/// steady rate from a blocking socket. results go out as json on stdout
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  void
+  Echo(llarp_udp_io* udp, const llarp::SockAddr& from, ManagedBuffer pkt)
+  {
+    llarp_ev_udp_sendto(udp, from, pkt.underlying);
+  }
+
+  nlohmann::json
+  Run(const std::string& name,
+      std::chrono::microseconds busyPoll,
+      int cpu,
+      size_t pings,
+      std::chrono::microseconds gap)
+  {
+    auto loop = llarp_make_ev_loop();
+    loop->set_busy_poll(busyPoll);
+    loop->set_loop_cpu(cpu);
+    llarp_udp_io relay{};
+    relay.recvfrom = &Echo;
+    if (llarp_ev_add_udp(loop.get(), &relay, llarp::SockAddr{127, 0, 0, 1, 0}) == -1)
+      return {{"name", name}, {"error", "cannot bind relay socket"}};
+    // bound as a v4 mapped v6 address
+    sockaddr_storage relayAddr{};
+    socklen_t len = sizeof(relayAddr);
+    ::getsockname(relay.fd, reinterpret_cast<sockaddr*>(&relayAddr), &len);
+    std::thread thread{[loop]() { loop->run(); }};
+
+    const int fd = ::socket(relayAddr.ss_family, SOCK_DGRAM, 0);
+    const timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::connect(fd, reinterpret_cast<const sockaddr*>(&relayAddr), len);
+
+    std::array<char, 64> cell{};
+    std::vector<double> rtts;
+    rtts.reserve(pings);
+    size_t lost = 0;
+    for (size_t idx = 0; idx < pings; ++idx)
+    {
+      // long enough that the loop has gone back to waiting before the next one comes in
+      std::this_thread::sleep_for(gap);
+      const auto sent = Clock_t::now();
+      if (::send(fd, cell.data(), cell.size(), 0) < 0
+          or ::recv(fd, cell.data(), cell.size(), 0) < 0)
+      {
+        lost++;
+        continue;
+      }
+      rtts.push_back(std::chrono::duration<double, std::micro>(Clock_t::now() - sent).count());
+    }
+    ::close(fd);
+    loop->call_soon([l = loop.get()]() { l->stop(); });
+    thread.join();
+
+    nlohmann::json result{{"name", name},
+                          {"busy_poll_us", busyPoll.count()},
+                          {"pings", pings},
+                          {"lost", lost}};
+    if (rtts.empty())
+      return result;
+    std::sort(rtts.begin(), rtts.end());
+    const auto at = [&rtts](double q) { return rtts[size_t(q * (rtts.size() - 1))]; };
+    result["us_p50"] = at(0.5);
+    result["us_p99"] = at(0.99);
+    result["us_max"] = rtts.back();
+    return result;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchRelay", "per hop relay latency benchmarks, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("n,pings", "datagrams sent through each relay", cxxopts::value<size_t>()->default_value("5000"))
+    ("g,gap", "microseconds between pings", cxxopts::value<uint64_t>()->default_value("200"))
+    ("b,busy-poll", "microseconds the busy polling loop spins for", cxxopts::value<uint64_t>()->default_value("500"))
+    ("c,cpu", "cpu to pin the relay loop to, -1 for none", cxxopts::value<int>()->default_value("-1"))
+    ;
+  // clang-format on
+
+  size_t pings;
+  std::chrono::microseconds gap;
+  std::chrono::microseconds busyPoll;
+  int cpu;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return 0;
+    }
+    pings = result["pings"].as<size_t>();
+    gap = std::chrono::microseconds(result["gap"].as<uint64_t>());
+    busyPoll = std::chrono::microseconds(result["busy-poll"].as<uint64_t>());
+    cpu = result["cpu"].as<int>();
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
+  nlohmann::json results = nlohmann::json::array();
+  results.push_back(Run("relay/blocking", std::chrono::microseconds{0}, cpu, pings, gap));
+  results.push_back(Run("relay/busy_poll", busyPoll, cpu, pings, gap));
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
@@ -0,0 +1,222 @@
+#include <config/key_manager.hpp>
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <ev/ev.h>
+#include <ev/ev.hpp>
+#include <iwp/iwp.hpp>
+#include <link/capture.hpp>
+#include <net/net.hpp>
+#include <util/logging/logger.hpp>
+#include <util/metrics.hpp>
+#include <util/thread/logic.hpp>
+
+#include <cxxopts.hpp>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// feeds a capture a relay took with capture-file set back through an iwp link layer, as fast
+/// as it goes or paced as it came in, to see what the link layer does with real traffic
+/// without a network. sessions the capture logged keys for are restored so their datagrams
+/// open, handshakes of the others do not complete offline and are counted as dropped. link
+/// messages go to a handler that only counts them. results go out as json on stdout
+
+namespace
+{
+  using Clock_t = std::chrono::steady_clock;
+
+  /// datagrams handed to the link layer in one go at full speed, about what a recvmmsg gives
+  constexpr size_t Burst = 32;
+
+  struct Replay
+  {
+    std::vector<llarp::capture::Record> records;
+    size_t datagrams = 0;
+    size_t keys = 0;
+  };
+
+  bool
+  Load(const std::string& file, Replay& replay)
+  {
+    llarp::capture::Reader reader;
+    if (not reader.Open(file))
+      return false;
+    while (auto record = reader.Next())
+    {
+      if (std::holds_alternative<llarp::capture::Datagram>(*record))
+        replay.datagrams++;
+      else
+        replay.keys++;
+      replay.records.emplace_back(std::move(*record));
+    }
+    return true;
+  }
+
+  nlohmann::json
+  Stage(const llarp::metrics::Histogram& hist)
+  {
+    const auto count = hist.Count();
+    return {{"count", count}, {"mean_us", count ? double(hist.Sum()) / count : 0.0}};
+  }
+
+  nlohmann::json
+  Run(const Replay& replay, bool paced, double speed)
+  {
+    auto logic = std::make_shared<llarp::Logic>();
+    auto loop = llarp_make_ev_loop();
+    loop->set_logic(logic);
+
+    auto keys = std::make_shared<llarp::KeyManager>();
+    llarp::CryptoManager::instance()->identity_keygen(keys->identityKey);
+    llarp::CryptoManager::instance()->encryption_keygen(keys->encryptionKey);
+    llarp::CryptoManager::instance()->encryption_keygen(keys->transportKey);
+    llarp::RouterContact rc;
+    rc.pubkey = keys->identityKey.toPublic();
+    rc.enckey = keys->encryptionKey.toPublic();
+
+    size_t handled = 0;
+    Clock_t::time_point lastHandled;
+    auto link = llarp::iwp::NewInboundLink(
+        keys,
+        [&rc]() -> const llarp::RouterContact& { return rc; },
+        [&handled, &lastHandled](llarp::ILinkSession*, const llarp_buffer_t&) {
+          handled++;
+          lastHandled = Clock_t::now();
+          return true;
+        },
+        [](llarp::Signature&, const llarp_buffer_t&) { return false; },
+        nullptr,
+        [](llarp::ILinkSession*, bool) { return true; },
+        [](llarp::RouterContact, llarp::RouterContact) { return false; },
+        [](llarp::ILinkSession*) {},
+        [](llarp::RouterID) {},
+        []() {},
+        [loop](llarp::Work_t work) { loop->call_soon(std::move(work)); });
+    llarp::metrics::Registry registry;
+    link->SetMetrics(registry);
+    if (not link->Configure(loop, llarp::net::LoopbackInterfaceName(), AF_INET, 0)
+        or not link->Start(logic))
+      return {{"error", "cannot start link"}};
+    auto* iwp = static_cast<llarp::iwp::LinkLayer*>(link.get());
+
+    const auto started = Clock_t::now();
+    std::vector<llarp_udp_pkt> burst;
+    const auto flush = [&burst, &link]() {
+      link->RecvBurst(burst.data(), burst.size());
+      burst.clear();
+    };
+    for (const auto& record : replay.records)
+    {
+      if (const auto* key = std::get_if<llarp::capture::SessionKey>(&record))
+      {
+        loop->call_soon([&flush, iwp, key]() {
+          flush();
+          iwp->RestoreSession(key->from, key->remote, key->key);
+        });
+        continue;
+      }
+      const auto& dgram = std::get<llarp::capture::Datagram>(record);
+      if (paced)
+      {
+        const auto at = std::chrono::duration_cast<llarp_time_t>(dgram.at / speed);
+        loop->call_after_delay(at, [&link, &dgram]() {
+          const llarp_udp_pkt pkt{dgram.from, dgram.data.data(), dgram.data.size()};
+          link->RecvBurst(&pkt, 1);
+        });
+        continue;
+      }
+      loop->call_soon([&burst, &flush, &dgram]() {
+        burst.push_back({dgram.from, dgram.data.data(), dgram.data.size()});
+        if (burst.size() == Burst)
+          flush();
+      });
+    }
+    loop->call_soon(flush);
+    // what was handed over still has to be decrypted and handled, give it time to drain
+    const auto last = replay.records.empty()
+        ? llarp_time_t{0}
+        : std::chrono::duration_cast<llarp_time_t>(
+            std::visit([](const auto& r) { return r.at; }, replay.records.back()) / speed);
+    loop->call_after_delay((paced ? last : llarp_time_t{0}) + std::chrono::seconds{1}, [loop]() {
+      llarp_ev_loop_stop(loop);
+    });
+    llarp_ev_loop_run_single_process(loop, logic);
+    link->Stop();
+
+    nlohmann::json result{{"name", paced ? "replay/paced" : "replay/max"},
+                          {"datagrams", replay.datagrams},
+                          {"session_keys", replay.keys},
+                          {"messages_handled", handled}};
+    if (paced)
+      result["speed"] = speed;
+    if (handled > 0)
+    {
+      const auto secs = std::chrono::duration<double>(lastHandled - started).count();
+      result["seconds"] = secs;
+      result["datagrams_per_sec"] = replay.datagrams / secs;
+    }
+    if (const auto* stages = link->StageTimes())
+      result["stages"] = {{"decrypt_wait", Stage(stages->decryptWait)},
+                          {"decrypt", Stage(stages->decrypt)},
+                          {"logic_wait", Stage(stages->logicWait)}};
+    return result;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  cxxopts::Options opts("benchReplay", "replays a link capture offline, json on stdout");
+
+  // clang-format off
+  opts.add_options()
+    ("h,help", "help", cxxopts::value<bool>())
+    ("f,file", "capture file written by a relay with capture-file set", cxxopts::value<std::string>())
+    ("p,pace", "feed datagrams as they came in instead of as fast as we can", cxxopts::value<bool>())
+    ("s,speed", "how many times faster than it came in a paced replay goes", cxxopts::value<double>()->default_value("1"))
+    ;
+  // clang-format on
+
+  std::string file;
+  bool paced;
+  double speed;
+  try
+  {
+    const auto result = opts.parse(argc, argv);
+    if (result.count("help") > 0 or result.count("file") == 0)
+    {
+      std::cout << opts.help() << std::endl;
+      return result.count("help") > 0 ? 0 : 1;
+    }
+    file = result["file"].as<std::string>();
+    paced = result.count("pace") > 0;
+    speed = result["speed"].as<double>();
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+  if (speed <= 0)
+  {
+    std::cerr << "speed must be above 0" << std::endl;
+    return 1;
+  }
+
+  Replay replay;
+  if (not Load(file, replay))
+    return 1;
+
+  llarp::LogSilencer shutup;
+  llarp::sodium::CryptoLibSodium crypto{};
+  llarp::CryptoManager manager{&crypto};
+
+  nlohmann::json results = nlohmann::json::array();
+  results.push_back(Run(replay, paced, speed));
+
+  std::cout << nlohmann::json{{"benchmarks", results}}.dump(2) << std::endl;
+  return 0;
+}
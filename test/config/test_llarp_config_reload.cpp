@@ -0,0 +1,76 @@
+#include <config/config.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+  struct ConfigFile
+  {
+    fs::path dir = fs::temp_directory_path() / "lokinet-test-config-reload";
+    fs::path file = dir / "lokinet.ini";
+
+    ConfigFile()
+    {
+      fs::create_directories(dir);
+    }
+
+    ~ConfigFile()
+    {
+      std::error_code ec;
+      fs::remove_all(dir, ec);
+    }
+
+    void
+    Write(const std::string& contents) const
+    {
+      std::ofstream out{file};
+      out << contents;
+    }
+  };
+
+  bool
+  Has(const std::vector<std::string>& options, const std::string& option)
+  {
+    return std::find(options.begin(), options.end(), option) != options.end();
+  }
+}  // namespace
+
+TEST_CASE("Config reload finds what changed in the file", "[config]")
+{
+  ConfigFile conf;
+  conf.Write("[network]\nhops=3\npaths=4\n[logging]\nlevel=info\n");
+  llarp::Config running{conf.dir};
+  REQUIRE(running.Load(conf.file, false));
+  CHECK(running.ChangedOptions(running).empty());
+
+  conf.Write("[network]\nhops=2\npaths=4\n[logging]\nlevel=debug\n[dns]\nupstream=1.1.1.1\n");
+  const auto reloaded = running.Reload();
+  REQUIRE(reloaded);
+  CHECK(*reloaded->network.m_Hops == 2);
+  CHECK(reloaded->logging.m_logLevel == llarp::eLogDebug);
+
+  const auto changed = running.ChangedOptions(*reloaded);
+  CHECK(changed.size() == 3);
+  CHECK(Has(changed, "network:hops"));
+  CHECK(Has(changed, "logging:level"));
+  CHECK(Has(changed, "dns:upstream"));
+  CHECK(not Has(changed, "network:paths"));
+}
+
+TEST_CASE("Config reload of a file that no longer parses", "[config]")
+{
+  ConfigFile conf;
+  conf.Write("[network]\nhops=3\n");
+  llarp::Config running{conf.dir};
+  REQUIRE(running.Load(conf.file, false));
+
+  conf.Write("[network]\nhops=99\n");
+  CHECK(running.Reload() == nullptr);
+
+  llarp::Config defaults{conf.dir};
+  REQUIRE(defaults.Load(std::nullopt, false));
+  CHECK(defaults.Reload() == nullptr);
+}
@@ -0,0 +1,97 @@
+#include <consensus/table.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+using llarp::consensus::Table;
+
+namespace
+{
+  llarp::RouterID
+  MakeRouter(uint8_t id)
+  {
+    llarp::RouterID router;
+    router[0] = id;
+    return router;
+  }
+}  // namespace
+
+TEST_CASE("Consensus table keeps each router once", "[consensus]")
+{
+  const Table table{{{MakeRouter(2), 3}, {MakeRouter(1), 0}, {MakeRouter(2), 7}}};
+  REQUIRE(table.Size() == 2);
+  CHECK(table.Entries()[0].router == MakeRouter(1));
+  CHECK(table.Contains(MakeRouter(2)));
+  CHECK(not table.Contains(MakeRouter(3)));
+  CHECK(table.Weight(MakeRouter(1)) == 1);
+  CHECK(table.Weight(MakeRouter(2)) == 3);
+  CHECK(table.Weight(MakeRouter(3)) == 0);
+  CHECK(Table{}.Empty());
+}
+
+TEST_CASE("Consensus table draws routers by weight", "[consensus]")
+{
+  const Table table{{{MakeRouter(1), 1}, {MakeRouter(2), 2}, {MakeRouter(3), 5}}};
+  std::mt19937_64 rng{42};
+  std::map<llarp::RouterID, size_t> drawn;
+  constexpr size_t Draws = 80000;
+  for (size_t i = 0; i < Draws; ++i)
+    drawn[table.Pick(rng())]++;
+  REQUIRE(drawn.size() == 3);
+  CHECK(drawn[MakeRouter(1)] == Approx(Draws / 8).epsilon(0.05));
+  CHECK(drawn[MakeRouter(2)] == Approx(Draws / 4).epsilon(0.05));
+  CHECK(drawn[MakeRouter(3)] == Approx(Draws * 5 / 8).epsilon(0.05));
+}
+
+TEST_CASE("Consensus table picks replicas around the ring", "[consensus]")
+{
+  const Table table{
+      {{MakeRouter(40), 1}, {MakeRouter(10), 1}, {MakeRouter(30), 9}, {MakeRouter(20), 1}}};
+  const auto at = [](uint8_t id) {
+    llarp::AlignedBuffer<32> location;
+    location[0] = id;
+    location[31] = 1;
+    return location;
+  };
+  CHECK(
+      table.Replicas(at(15), 3)
+      == std::vector<llarp::RouterID>{MakeRouter(20), MakeRouter(30), MakeRouter(40)});
+  // wraps past the last router to the first
+  CHECK(
+      table.Replicas(at(35), 3)
+      == std::vector<llarp::RouterID>{MakeRouter(40), MakeRouter(10), MakeRouter(20)});
+  CHECK(
+      table.Replicas(at(50), 2) == std::vector<llarp::RouterID>{MakeRouter(10), MakeRouter(20)});
+  // each router once however many are asked for
+  CHECK(table.Replicas(at(0), 9).size() == 4);
+  CHECK(Table{}.Replicas(at(0), 4).empty());
+}
+
+TEST_CASE("Consensus table replicas only move off a router that left", "[consensus]")
+{
+  std::mt19937_64 rng{7};
+  std::vector<Table::Entry> entries(200);
+  for (auto& entry : entries)
+    entry.router.Randomize();
+  const Table before{entries};
+  // the same list in another order picks the same
+  std::shuffle(entries.begin(), entries.end(), rng);
+  const Table shuffled{entries};
+  const auto gone = entries.back().router;
+  entries.pop_back();
+  const Table after{entries};
+
+  for (size_t idx = 0; idx < 500; ++idx)
+  {
+    llarp::AlignedBuffer<32> location;
+    location.Randomize();
+    const auto replicas = before.Replicas(location, 4);
+    REQUIRE(shuffled.Replicas(location, 4) == replicas);
+    if (std::find(replicas.begin(), replicas.end(), gone) == replicas.end())
+      CHECK(after.Replicas(location, 4) == replicas);
+  }
+}
@@ -22,6 +22,22 @@ namespace llarp
                    bool(const llarp_buffer_t &, const llarp_buffer_t &,
                         const SharedSecret &, const byte_t *));
 
+      MOCK_METHOD4(xchacha20_batch,
+                   bool(const CryptoSpan *, const TunnelNonce *, size_t,
+                        const SharedSecret &));
+
+      MOCK_METHOD0(aes256gcm_available, bool());
+
+      MOCK_METHOD6(aes256gcm_seal_batch,
+                   bool(const CryptoSpan *, const CryptoSpan *,
+                        const TunnelNonce *, GCMTag *, size_t,
+                        const SharedSecret &));
+
+      MOCK_METHOD7(aes256gcm_open_batch,
+                   bool(const CryptoSpan *, const CryptoSpan *,
+                        const TunnelNonce *, const GCMTag *, size_t,
+                        const SharedSecret &, bool *));
+
       MOCK_METHOD4(dh_client,
                    bool(SharedSecret &, const PubKey &, const SecretKey &,
                         const TunnelNonce &));
@@ -30,6 +46,12 @@ namespace llarp
                    bool(SharedSecret &, const PubKey &, const SecretKey &,
                         const TunnelNonce &));
 
+      MOCK_METHOD3(dh_client_static,
+                   bool(SharedSecret &, const PubKey &, const SecretKey &));
+
+      MOCK_METHOD3(dh_server_static,
+                   bool(SharedSecret &, const PubKey &, const SecretKey &));
+
       MOCK_METHOD4(transport_dh_client,
                    bool(SharedSecret &, const PubKey &, const SecretKey &,
                         const TunnelNonce &));
@@ -46,6 +68,10 @@ namespace llarp
                    bool(byte_t *, const llarp_buffer_t &,
                         const SharedSecret &));
 
+      MOCK_METHOD4(hmac_batch,
+                   bool(ShortHash *, const CryptoSpan *, size_t,
+                        const SharedSecret &));
+
       MOCK_METHOD4(derive_subkey, bool(PubKey &, const PubKey &, uint64_t, const AlignedBuffer<32> *));
 
       MOCK_METHOD4(derive_subkey_private,
@@ -59,6 +85,9 @@ namespace llarp
                    bool(const PubKey &, const llarp_buffer_t &,
                         const Signature &));
 
+      MOCK_METHOD3(verify_batch,
+                   bool(const SignatureCheck *, size_t, bool *));
+
       MOCK_METHOD2(seed_to_secretkey,
                    bool(llarp::SecretKey &, const llarp::IdentitySecret &));
 
@@ -1,5 +1,6 @@
 #include <crypto/crypto_libsodium.hpp>
 
+#include <array>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -67,4 +68,40 @@ namespace llarp
     ASSERT_TRUE(c->pqe_decrypt(block, otherShared, pq_keypair_to_secret(keys)));
     ASSERT_TRUE(otherShared == shared);
   }
+
+  TEST(AESGCMTest, TestSealOpen)
+  {
+    llarp::sodium::CryptoLibSodium crypto;
+    if (not crypto.aes256gcm_available())
+      GTEST_SKIP() << "no aes instructions on this cpu";
+    SharedSecret key;
+    key.Randomize();
+    std::array<AlignedBuffer<256>, 3> plain, bufs;
+    std::array<AlignedBuffer<32>, 3> ad;
+    std::array<TunnelNonce, 3> nonces;
+    std::array<CryptoSpan, 3> spans, adSpans;
+    std::array<GCMTag, 3> tags;
+    for (size_t idx = 0; idx < bufs.size(); ++idx)
+    {
+      plain[idx].Randomize();
+      bufs[idx] = plain[idx];
+      ad[idx].Randomize();
+      nonces[idx].Randomize();
+      spans[idx] = CryptoSpan{bufs[idx].data(), bufs[idx].size()};
+      adSpans[idx] = CryptoSpan{ad[idx].data(), ad[idx].size()};
+    }
+    ASSERT_TRUE(crypto.aes256gcm_seal_batch(
+        spans.data(), adSpans.data(), nonces.data(), tags.data(), bufs.size(), key));
+    ASSERT_NE(bufs[0], plain[0]);
+    // mangle the second one's associated data
+    ad[1][0] ^= 1;
+    bool valid[3];
+    ASSERT_FALSE(crypto.aes256gcm_open_batch(
+        spans.data(), adSpans.data(), nonces.data(), tags.data(), bufs.size(), key, valid));
+    ASSERT_TRUE(valid[0]);
+    ASSERT_FALSE(valid[1]);
+    ASSERT_TRUE(valid[2]);
+    ASSERT_EQ(bufs[0], plain[0]);
+    ASSERT_EQ(bufs[2], plain[2]);
+  }
 }  // namespace llarp
@@ -0,0 +1,64 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/key_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <vector>
+
+namespace
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager cmanager(&crypto);
+}  // namespace
+
+using llarp::EphemeralKeyCache;
+
+TEST_CASE("EphemeralKeyCache refills in the background", "[crypto][key-cache]")
+{
+  std::vector<EphemeralKeyCache::Work_t> queued;
+  EphemeralKeyCache cache{8, [&queued](auto work) { queued.emplace_back(std::move(work)); }};
+
+  // empty, so the first key is made in line and a refill is asked for once
+  llarp::SecretKey key;
+  cache.Take(key);
+  REQUIRE(not key.IsZero());
+  cache.RequestRefill();
+  REQUIRE(queued.size() == 1);
+
+  queued.front()();
+  queued.clear();
+  REQUIRE(cache.Size() == 8);
+
+  // no refill until we get down to half
+  std::set<llarp::PubKey> seen{key.toPublic()};
+  for (size_t idx = 0; idx < 3; ++idx)
+  {
+    cache.Take(key);
+    REQUIRE(seen.emplace(key.toPublic()).second);
+  }
+  REQUIRE(queued.empty());
+  cache.Take(key);
+  REQUIRE(seen.emplace(key.toPublic()).second);
+  REQUIRE(queued.size() == 1);
+  REQUIRE(cache.Size() == 4);
+
+  const auto status = cache.ExtractStatus();
+  REQUIRE(status["hits"] == 4);
+  REQUIRE(status["misses"] == 1);
+}
+
+TEST_CASE("EphemeralKeyCache works with a worker that runs right away", "[crypto][key-cache]")
+{
+  EphemeralKeyCache cache{4, [](auto work) { work(); }};
+  cache.RequestRefill();
+  REQUIRE(cache.Size() == 4);
+  llarp::SecretKey key;
+  cache.Take(key);
+  REQUIRE(cache.Size() == 3);
+  REQUIRE(not key.IsZero());
+  // down to half refills straight away
+  cache.Take(key);
+  REQUIRE(cache.Size() == 4);
+}
@@ -0,0 +1,49 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <crypto/verified_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager cmanager(&crypto);
+}  // namespace
+
+using llarp::VerifiedCache;
+using namespace std::literals;
+
+TEST_CASE("VerifiedCache remembers digests until they decay", "[crypto][verified-cache]")
+{
+  VerifiedCache cache{10s, 2};
+
+  std::array<byte_t, 64> data{};
+  llarp::ShortHash first, second, third;
+  REQUIRE(VerifiedCache::Digest(first, llarp_buffer_t(data)));
+  data[0] = 1;
+  REQUIRE(VerifiedCache::Digest(second, llarp_buffer_t(data)));
+  data[0] = 2;
+  REQUIRE(VerifiedCache::Digest(third, llarp_buffer_t(data)));
+  REQUIRE(first != second);
+
+  REQUIRE(not cache.Contains(first, 1s));
+  cache.Add(first, 1s);
+  cache.Add(second, 2s);
+  REQUIRE(cache.Contains(first, 3s));
+  REQUIRE(cache.Contains(second, 3s));
+
+  // over capacity the oldest goes
+  cache.Add(third, 4s);
+  REQUIRE(not cache.Contains(first, 5s));
+  REQUIRE(cache.Contains(third, 5s));
+
+  // and past the interval everything does
+  REQUIRE(not cache.Contains(second, 13s));
+  REQUIRE(cache.Contains(third, 13s));
+  REQUIRE(not cache.Contains(third, 15s));
+  REQUIRE(cache.Size() == 0);
+
+  const auto status = cache.ExtractStatus();
+  REQUIRE(status["hits"] == 4);
+  REQUIRE(status["misses"] == 4);
+}
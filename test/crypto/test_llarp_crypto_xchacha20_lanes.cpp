@@ -0,0 +1,91 @@
+#include <crypto/xchacha20_lanes.hpp>
+
+#include <sodium/crypto_stream_xchacha20.h>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+namespace
+{
+  using Buffer_t = std::vector<byte_t>;
+
+  /// deterministic filler, these tests compare streams so the bytes only need to differ
+  void
+  Fill(byte_t* data, size_t sz, uint32_t seed)
+  {
+    for (size_t idx = 0; idx < sz; ++idx)
+    {
+      seed = seed * 1664525 + 1013904223;
+      data[idx] = seed >> 24;
+    }
+  }
+
+  /// run sizes through every kernel this cpu has and compare with libsodium
+  void
+  CheckSizes(const std::vector<size_t>& sizes)
+  {
+    llarp::SharedSecret key;
+    Fill(key.data(), key.size(), 1);
+    std::vector<Buffer_t> plain;
+    std::vector<llarp::TunnelNonce> nonces(sizes.size());
+    for (size_t idx = 0; idx < sizes.size(); ++idx)
+    {
+      plain.emplace_back(sizes[idx]);
+      Fill(plain.back().data(), sizes[idx], 100 + idx);
+      Fill(nonces[idx].data(), nonces[idx].size(), 1000 + idx);
+    }
+
+    std::vector<Buffer_t> expect = plain;
+    for (size_t idx = 0; idx < expect.size(); ++idx)
+    {
+      crypto_stream_xchacha20_xor(
+          expect[idx].data(), expect[idx].data(), expect[idx].size(), nonces[idx].data(),
+          key.data());
+    }
+
+    for (const auto& kernel : llarp::sodium::xchacha20_kernels())
+    {
+      INFO(kernel.name);
+      std::vector<Buffer_t> got = plain;
+      std::vector<llarp::CryptoSpan> spans;
+      for (auto& buf : got)
+        spans.push_back({buf.data(), buf.size()});
+      kernel.run(spans.data(), nonces.data(), spans.size(), key);
+      for (size_t idx = 0; idx < got.size(); ++idx)
+      {
+        INFO("buffer " << idx << " of " << got.size() << " bytes " << got[idx].size());
+        REQUIRE(got[idx] == expect[idx]);
+      }
+    }
+  }
+}  // namespace
+
+TEST_CASE("xchacha20 lanes match libsodium on one buffer", "[crypto]")
+{
+  CheckSizes({1});
+  CheckSizes({64});
+  CheckSizes({8000});
+}
+
+TEST_CASE("xchacha20 lanes match libsodium on block edges", "[crypto]")
+{
+  CheckSizes({0, 1, 63, 64, 65, 127, 128, 129, 191, 192, 255, 256, 257});
+}
+
+TEST_CASE("xchacha20 lanes match libsodium on mixed relay batches", "[crypto]")
+{
+  // more buffers than the widest kernel has lanes, uneven, so lanes are refilled while
+  // others are still busy and the last long one is finished alone
+  std::vector<size_t> sizes;
+  for (size_t idx = 0; idx < 53; ++idx)
+    sizes.push_back((idx * 397) % 1500 + (idx % 7 == 0 ? 6000 : 0));
+  CheckSizes(sizes);
+}
+
+TEST_CASE("xchacha20 picks a kernel", "[crypto]")
+{
+  const auto& kernel = llarp::sodium::xchacha20_kernel();
+  REQUIRE(kernel.lanes >= 4);
+  REQUIRE(llarp::sodium::xchacha20_kernels().back().lanes == 4);
+}
@@ -41,6 +41,8 @@ namespace llarp
 
       MOCK_METHOD3(DHTSendTo, void(const RouterID&, dht::IMessage*, bool));
 
+      MOCK_METHOD2(DHTSendToPath, void(const PathID_t&, dht::IMessage*));
+
       MOCK_METHOD4(
           HandleExploritoryRouterLookup,
           bool(const dht::Key_t& requester, uint64_t txid,
@@ -97,7 +99,9 @@ namespace llarp
 
       MOCK_CONST_METHOD0(pendingExploreLookups, const PendingExploreLookups&());
 
-      MOCK_METHOD0(services, dht::Bucket< dht::ISNode >*());
+      MOCK_METHOD0(services, dht::IntroSetStore*());
+
+      MOCK_METHOD0(exploreScheduler, dht::ExploreScheduler&());
 
       MOCK_CONST_METHOD0(AllowTransit, const bool&());
       MOCK_METHOD0(AllowTransit, bool&());
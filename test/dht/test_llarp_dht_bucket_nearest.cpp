@@ -0,0 +1,80 @@
+#include <dht/bucket.hpp>
+#include <dht/kademlia.hpp>
+#include <dht/node.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::dht::Key_t;
+using Bucket_t = llarp::dht::Bucket<llarp::dht::RCNode>;
+
+namespace
+{
+  Key_t
+  RandomKey(std::mt19937_64& rng)
+  {
+    Key_t key;
+    for (auto& byte : key)
+      byte = rng();
+    return key;
+  }
+
+  std::vector<Key_t>
+  Closest(std::vector<Key_t> keys, const Key_t& target, size_t k, const std::set<Key_t>& exclude)
+  {
+    keys.erase(
+        std::remove_if(
+            keys.begin(), keys.end(), [&exclude](const auto& key) { return exclude.count(key); }),
+        keys.end());
+    std::sort(keys.begin(), keys.end(), llarp::dht::XorMetric{target});
+    keys.resize(std::min(k, keys.size()));
+    return keys;
+  }
+}  // namespace
+
+TEST_CASE("Bucket nearest matches a full sort", "[dht]")
+{
+  std::mt19937_64 rng{4321};
+  Bucket_t bucket{Key_t{}, [&rng]() { return rng(); }};
+  std::vector<Key_t> keys;
+  for (size_t idx = 0; idx < 500; ++idx)
+  {
+    llarp::dht::RCNode node;
+    node.ID = RandomKey(rng);
+    keys.push_back(node.ID);
+    bucket.PutNode(node);
+  }
+  REQUIRE(bucket.size() == keys.size());
+  REQUIRE(std::is_sorted(
+      bucket.nodes.begin(), bucket.nodes.end(), [](const auto& left, const auto& right) {
+        return left.ID < right.ID;
+      }));
+
+  std::set<Key_t> exclude;
+  for (int round = 0; round < 40; ++round)
+  {
+    const Key_t target = round % 2 ? keys[round] : RandomKey(rng);
+    // exclude the closest few some of the time so the walk has to go past them
+    exclude.clear();
+    if (round % 4 == 1)
+    {
+      for (const auto& key : Closest(keys, target, 3, {}))
+        exclude.insert(key);
+    }
+    for (const size_t k : {1, 4, 16})
+    {
+      std::vector<Key_t> out(k);
+      const size_t found = bucket.GetNearest(
+          target, out.data(), k, [&exclude](const Key_t& key) { return exclude.count(key) == 0; });
+      out.resize(found);
+      REQUIRE(out == Closest(keys, target, k, exclude));
+    }
+    Key_t closest;
+    REQUIRE(bucket.FindCloseExcluding(target, closest, exclude));
+    REQUIRE(closest == Closest(keys, target, 1, exclude).front());
+  }
+}
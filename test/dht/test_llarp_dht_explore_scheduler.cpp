@@ -0,0 +1,51 @@
+#include <dht/explore_scheduler.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::dht::ExploreScheduler;
+
+TEST_CASE("Explore scheduler stays at the floor on a cold start", "[dht]")
+{
+  ExploreScheduler sched;
+  llarp_time_t now = 10s;
+  REQUIRE(sched.Due(now, 0, 2s));
+  REQUIRE(sched.Interval() == 2s);
+  REQUIRE_FALSE(sched.Due(now + 1s, 0, 2s));
+
+  // everything known but hardly any routers yet, keep going fast
+  sched.Seen(10, 10);
+  now += 2s;
+  REQUIRE(sched.Due(now, ExploreScheduler::ColdStartRouters - 1, 2s));
+  REQUIRE(sched.Interval() == 2s);
+  REQUIRE(sched.Coverage() == Approx(1.0));
+}
+
+TEST_CASE("Explore scheduler backs off once covered and speeds up on new routers", "[dht]")
+{
+  ExploreScheduler sched;
+  const size_t buckets = ExploreScheduler::ColdStartRouters * 4;
+  llarp_time_t now = 10s;
+  REQUIRE(sched.Due(now, buckets, 2s));
+  REQUIRE(sched.Interval() == 2s);
+
+  for (int i = 0; i < 20; ++i)
+  {
+    sched.Seen(20, 20);
+    now += sched.Interval();
+    REQUIRE(sched.Due(now, buckets, 2s));
+  }
+  REQUIRE(sched.Interval() == ExploreScheduler::MaxInterval);
+  REQUIRE_FALSE(sched.Due(now + ExploreScheduler::MaxInterval - 1s, buckets, 2s));
+
+  // most of what the last explore found was new to us
+  sched.Seen(5, 20);
+  now += sched.Interval();
+  REQUIRE(sched.Due(now, buckets, 2s));
+  REQUIRE(sched.Interval() == ExploreScheduler::MaxInterval / 2);
+  REQUIRE(sched.Coverage() == Approx(0.25));
+
+  // losing the bucket is a cold start again
+  now += sched.Interval();
+  REQUIRE(sched.Due(now, 1, 2s));
+  REQUIRE(sched.Interval() == 2s);
+}
@@ -15,6 +15,7 @@ struct TestDhtExploreNetworkJob : public ::testing::Test
 {
   RouterID peer;
   test::MockContext context;
+  dht::ExploreScheduler scheduler;
   dht::ExploreNetworkJob exploreNetworkJob;
 
   TestDhtExploreNetworkJob()
@@ -61,6 +62,7 @@ TEST_F(TestDhtExploreNetworkJob, send_reply)
     exploreNetworkJob.valuesFound.clear();
     EXPECT_CALL(context, LookupRouter(_, _)).Times(0);
     EXPECT_CALL(context, GetRouter()).WillOnce(Return(nullptr));
+    EXPECT_CALL(context, exploreScheduler()).WillOnce(ReturnRef(scheduler));
 
     ASSERT_NO_THROW(exploreNetworkJob.SendReply());
   }
@@ -72,6 +74,7 @@ TEST_F(TestDhtExploreNetworkJob, send_reply)
     exploreNetworkJob.valuesFound.push_back(makeBuf<RouterID>(0x02));
 
     EXPECT_CALL(context, GetRouter()).WillOnce(Return(nullptr));
+    EXPECT_CALL(context, exploreScheduler()).WillOnce(ReturnRef(scheduler));
     EXPECT_CALL(context, LookupRouter(Ne(makeBuf<RouterID>(0x01)), _)).Times(2).WillRepeatedly(Return(true));
     EXPECT_CALL(context, LookupRouter(Eq(makeBuf<RouterID>(0x01)), _)).WillOnce(Return(false));
 
@@ -85,6 +88,7 @@ TEST_F(TestDhtExploreNetworkJob, send_reply)
     exploreNetworkJob.valuesFound.push_back(makeBuf<RouterID>(0x02));
 
     EXPECT_CALL(context, GetRouter()).WillOnce(Return(nullptr));
+    EXPECT_CALL(context, exploreScheduler()).WillOnce(ReturnRef(scheduler));
     EXPECT_CALL(context, LookupRouter(_, _)).Times(3).WillRepeatedly(Return(true));
 
     ASSERT_NO_THROW(exploreNetworkJob.SendReply());
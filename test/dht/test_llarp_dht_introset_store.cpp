@@ -0,0 +1,101 @@
+#include <constants/path.hpp>
+#include <dht/introset_store.hpp>
+
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::dht::IntroSetStore;
+using llarp::dht::Key_t;
+using llarp::service::EncryptedIntroSet;
+
+namespace
+{
+  EncryptedIntroSet
+  MakeIntroSet(uint16_t id, llarp_time_t signedAt)
+  {
+    EncryptedIntroSet introset;
+    introset.derivedSigningKey.Zero();
+    introset.derivedSigningKey[0] = id;
+    introset.derivedSigningKey[1] = id >> 8;
+    introset.signedAt = signedAt;
+    return introset;
+  }
+
+  Key_t
+  KeyOf(const EncryptedIntroSet& introset)
+  {
+    return Key_t{introset.derivedSigningKey.as_array()};
+  }
+}  // namespace
+
+TEST_CASE("IntroSetStore keeps the newest introset per key", "[dht]")
+{
+  IntroSetStore store;
+  const auto older = MakeIntroSet(1, 1s);
+  const auto newer = MakeIntroSet(1, 2s);
+
+  REQUIRE(store.Put(newer));
+  REQUIRE_FALSE(store.Put(older));
+  auto found = store.Get(KeyOf(older), 3s);
+  REQUIRE(found);
+  REQUIRE(found->signedAt == 2s);
+  REQUIRE(store.Size() == 1);
+  REQUIRE_FALSE(store.Get(KeyOf(MakeIntroSet(2, 1s)), 3s));
+}
+
+TEST_CASE("IntroSetStore expires introsets by when they were signed", "[dht]")
+{
+  IntroSetStore store;
+  for (uint16_t id = 0; id < 100; ++id)
+    store.Put(MakeIntroSet(id, id < 50 ? 1s : 5min));
+  // put again later, the earlier expiry for it must not drop it
+  store.Put(MakeIntroSet(0, 5min));
+
+  const auto now = 1s + llarp::path::default_lifetime;
+  REQUIRE_FALSE(store.Get(KeyOf(MakeIntroSet(1, 0s)), now));
+  store.Expire(now);
+  REQUIRE(store.Size() == 51);
+  REQUIRE(store.Get(KeyOf(MakeIntroSet(0, 0s)), now));
+  REQUIRE(store.Get(KeyOf(MakeIntroSet(70, 0s)), now));
+
+  store.Expire(5min + llarp::path::default_lifetime);
+  REQUIRE(store.Size() == 0);
+
+  const auto status = store.ExtractStatus();
+  REQUIRE(status["shards"].size() == IntroSetStore::NumShards);
+}
+
+TEST_CASE("IntroSetStore answers lookups while it is being published to", "[dht]")
+{
+  IntroSetStore store;
+  for (uint16_t id = 0; id < 64; ++id)
+    store.Put(MakeIntroSet(id, 1s));
+
+  std::vector<std::thread> threads;
+  std::atomic<size_t> found = 0;
+  for (int reader = 0; reader < 4; ++reader)
+  {
+    threads.emplace_back([&store, &found]() {
+      for (int round = 0; round < 100; ++round)
+      {
+        for (uint16_t id = 0; id < 64; ++id)
+        {
+          if (store.Get(KeyOf(MakeIntroSet(id, 0s)), 2s))
+            found++;
+        }
+      }
+    });
+  }
+  threads.emplace_back([&store]() {
+    for (uint16_t id = 64; id < 1064; ++id)
+      store.Put(MakeIntroSet(id, 1s));
+  });
+  for (auto& thread : threads)
+    thread.join();
+
+  REQUIRE(found == 4 * 100 * 64);
+  REQUIRE(store.Size() == 1064);
+}
@@ -0,0 +1,88 @@
+#include <dht/request_limiter.hpp>
+
+#include <dht/messages/findintro.hpp>
+#include <dht/messages/findrouter.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::dht::RequestLimiter;
+using Kind = RequestLimiter::Kind;
+
+namespace
+{
+  llarp::RouterID
+  MakePeer(uint8_t val)
+  {
+    llarp::RouterID peer;
+    peer.Fill(val);
+    return peer;
+  }
+
+  llarp::PathID_t
+  MakePath(uint8_t val)
+  {
+    llarp::PathID_t path;
+    path.Fill(val);
+    return path;
+  }
+}  // namespace
+
+TEST_CASE("dht request limiter holds one path to its burst", "[dht]")
+{
+  RequestLimiter limiter;
+  const auto peer = MakePeer(1);
+  const auto path = MakePath(1);
+  const llarp_time_t now = 10s;
+  for (int i = 0; i < RequestLimiter::PathBurst; ++i)
+    REQUIRE(limiter.Allow(peer, path, Kind::FindIntro, now));
+  CHECK_FALSE(limiter.Allow(peer, path, Kind::FindIntro, now));
+  CHECK(limiter.Rejected(Kind::FindIntro) == 1);
+  CHECK(limiter.Exhausted(peer, path, now));
+  CHECK(limiter.Rejected(Kind::Undecoded) == 1);
+
+  // another path through the same relay has its own tokens
+  CHECK(limiter.Allow(peer, MakePath(2), Kind::FindRouter, now));
+  CHECK_FALSE(limiter.Exhausted(peer, MakePath(2), now));
+
+  // and the first path gets more as time passes
+  CHECK(limiter.Allow(peer, path, Kind::FindIntro, now + 1s));
+}
+
+TEST_CASE("dht request limiter holds all the paths of one relay together", "[dht]")
+{
+  RequestLimiter limiter;
+  const auto peer = MakePeer(1);
+  const llarp_time_t now = 10s;
+  uint8_t next = 0;
+  int allowed = 0;
+  while (limiter.Allow(peer, MakePath(next), Kind::Other, now))
+  {
+    ++allowed;
+    if (allowed % int(RequestLimiter::PathBurst) == 0)
+      ++next;
+  }
+  CHECK(allowed == RequestLimiter::PeerBurst);
+  // a rejection took from neither bucket, a fresh path is still held by its relay
+  CHECK_FALSE(limiter.Allow(peer, MakePath(200), Kind::Other, now));
+  CHECK(limiter.Allow(MakePeer(2), MakePath(200), Kind::Other, now));
+}
+
+TEST_CASE("dht request limiter forgets idle buckets", "[dht]")
+{
+  RequestLimiter limiter;
+  const auto peer = MakePeer(1);
+  const auto path = MakePath(1);
+  for (int i = 0; i < RequestLimiter::PathBurst; ++i)
+    limiter.Allow(peer, path, Kind::FindName, 10s);
+  REQUIRE(limiter.Exhausted(peer, path, 10s));
+  limiter.Expire(10s + RequestLimiter::IdleTimeout + 1s);
+  CHECK_FALSE(limiter.Exhausted(peer, path, 10s + RequestLimiter::IdleTimeout + 1s));
+}
+
+TEST_CASE("dht request limiter sorts messages by kind", "[dht]")
+{
+  llarp::dht::FindIntroMessage intro{llarp::service::Tag{"tag"}, 1};
+  llarp::dht::FindRouterMessage router{1};
+  CHECK(RequestLimiter::KindOf(intro) == Kind::FindIntro);
+  CHECK(RequestLimiter::KindOf(router) == Kind::FindRouter);
+}
@@ -0,0 +1,131 @@
+#include <dht/txholder.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::dht::Key_t;
+using llarp::dht::TXOwner;
+
+namespace
+{
+  struct Record
+  {
+    std::vector<TXOwner> started;
+    size_t replies = 0;
+    size_t found = 0;
+  };
+
+  struct FakeTX : public llarp::dht::TX<Key_t, Key_t>
+  {
+    Record& record;
+
+    FakeTX(const TXOwner& asker, const Key_t& k, Record& r)
+        : llarp::dht::TX<Key_t, Key_t>(asker, k, nullptr), record(r)
+    {}
+
+    bool
+    Validate(const Key_t&) const override
+    {
+      return true;
+    }
+
+    void
+    Start(const TXOwner& peer) override
+    {
+      record.started.push_back(peer);
+    }
+
+    void
+    SendReply() override
+    {
+      record.replies++;
+      record.found = valuesFound.size();
+    }
+  };
+
+  using Holder_t = llarp::dht::TXHolder<Key_t, Key_t, Key_t::Hash>;
+
+  Key_t
+  MakeKey(uint8_t b)
+  {
+    Key_t key;
+    key.Fill(b);
+    return key;
+  }
+}  // namespace
+
+TEST_CASE("Parallel tx asks every peer and the first answer wins", "[dht]")
+{
+  Holder_t holder;
+  Record record;
+  const Key_t target = MakeKey(1);
+  const TXOwner asker(MakeKey(2), 7);
+  const std::vector<TXOwner> peers{{MakeKey(3), 1}, {MakeKey(4), 2}, {MakeKey(5), 3}};
+
+  holder.NewParallelTX(peers, asker, target, new FakeTX(asker, target, record));
+  REQUIRE(record.started == peers);
+  for (const auto& peer : peers)
+    REQUIRE(holder.HasPendingLookupFrom(peer));
+
+  holder.Found(peers[1], target, {MakeKey(9)});
+  REQUIRE(record.replies == 1);
+  REQUIRE(record.found == 1);
+  // the rest are cancelled, their late replies find nothing
+  for (const auto& peer : peers)
+    REQUIRE_FALSE(holder.HasPendingLookupFrom(peer));
+  REQUIRE_FALSE(holder.HasLookupFor(target));
+  REQUIRE(holder.siblings.empty());
+  REQUIRE(holder.asking.empty());
+
+  holder.NotFound(peers[2], nullptr);
+  REQUIRE(record.replies == 1);
+}
+
+TEST_CASE("Parallel tx fails only once every peer has nothing", "[dht]")
+{
+  Holder_t holder;
+  Record record;
+  const Key_t target = MakeKey(1);
+  const TXOwner asker(MakeKey(2), 7);
+  const std::vector<TXOwner> peers{{MakeKey(3), 1}, {MakeKey(4), 2}, {MakeKey(5), 3}};
+
+  holder.NewParallelTX(peers, asker, target, new FakeTX(asker, target, record));
+
+  holder.NotFound(peers[0], nullptr);
+  holder.NotFound(peers[2], nullptr);
+  REQUIRE(record.replies == 0);
+  REQUIRE(holder.HasPendingLookupFrom(peers[1]));
+  REQUIRE_FALSE(holder.HasPendingLookupFrom(peers[2]));
+
+  holder.NotFound(peers[1], nullptr);
+  REQUIRE(record.replies == 1);
+  REQUIRE(record.found == 0);
+  REQUIRE_FALSE(holder.HasLookupFor(target));
+  REQUIRE(holder.siblings.empty());
+  REQUIRE(holder.asking.empty());
+}
+
+TEST_CASE("Parallel tx joins a lookup already out for the same key", "[dht]")
+{
+  Holder_t holder;
+  Record first, second;
+  const Key_t target = MakeKey(1);
+  const TXOwner asker(MakeKey(2), 7);
+  const TXOwner other(MakeKey(6), 8);
+
+  holder.NewTX({MakeKey(3), 1}, asker, target, new FakeTX(asker, target, first));
+  const std::vector<TXOwner> peers{{MakeKey(4), 2}, {MakeKey(5), 3}};
+  holder.NewParallelTX(peers, other, target, new FakeTX(other, target, second));
+  // nothing more is sent, the one out already answers both
+  REQUIRE(first.started.size() == 1);
+  REQUIRE(second.started.empty());
+  REQUIRE(holder.siblings.empty());
+  REQUIRE(holder.started == 1);
+  REQUIRE(holder.coalesced == 1);
+
+  holder.Found({MakeKey(3), 1}, target, {MakeKey(9)});
+  REQUIRE(first.replies == 1);
+  REQUIRE(second.replies == 1);
+  REQUIRE(second.found == 1);
+}
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
+
 namespace
 {
   using llarp::dht::Key_t;
@@ -11,10 +13,8 @@ namespace
   {
     Key_t node;
     uint64_t id;
-    size_t expectedHash;
 
-    TxOwnerData(const Key_t& k, uint64_t i, size_t h)
-        : node(k), id(i), expectedHash(h)
+    TxOwnerData(const Key_t& k, uint64_t i) : node(k), id(i)
     {
     }
   };
@@ -28,16 +28,18 @@ namespace
     TXOwner dc;
     ASSERT_TRUE(dc.node.IsZero());
     ASSERT_EQ(0u, dc.txid);
-    ASSERT_EQ(0u, TXOwner::Hash()(dc));
+    ASSERT_EQ(TXOwner::Hash()(TXOwner()), TXOwner::Hash()(dc));
   }
 
   TEST_P(TxOwner, hash)
   {
     // test single interactions (constructor and hash)
+    // the hash is keyed per process so only equal owners hashing the same can be checked
     auto d = GetParam();
     TXOwner constructor(d.node, d.id);
+    TXOwner copy(constructor);
 
-    ASSERT_EQ(d.expectedHash, TXOwner::Hash()(constructor));
+    ASSERT_EQ(TXOwner::Hash()(copy), TXOwner::Hash()(constructor));
   }
 
   std::vector< TxOwnerData >
@@ -54,19 +56,26 @@ namespace
 
     uint64_t max = std::numeric_limits< uint64_t >::max();
 
-    result.emplace_back(zero, 0, 0ull);
-    result.emplace_back(zero, 1, 1ull);
-    result.emplace_back(one, 0, 144680345676153346ull);
-    result.emplace_back(one, 1, 144680345676153347ull);
-    result.emplace_back(two, 0, 289360691352306692ull);
-    result.emplace_back(two, 2, 289360691352306694ull);
-    result.emplace_back(zero, max, 18446744073709551615ull);
-    result.emplace_back(one, max, 18302063728033398269ull);
-    result.emplace_back(two, max, 18157383382357244923ull);
+    result.emplace_back(zero, 0);
+    result.emplace_back(zero, 1);
+    result.emplace_back(one, 0);
+    result.emplace_back(one, 1);
+    result.emplace_back(two, 0);
+    result.emplace_back(two, 2);
+    result.emplace_back(zero, max);
+    result.emplace_back(one, max);
+    result.emplace_back(two, max);
 
     return result;
   }
 
+  TEST_F(TxOwner, distinct_hashes)
+  {
+    std::set< size_t > hashes;
+    for(const auto& d : makeData())
+      ASSERT_TRUE(hashes.insert(TXOwner::Hash()(TXOwner(d.node, d.id))).second);
+  }
+
   struct TxOwnerCmpData
   {
     TXOwner lhs;
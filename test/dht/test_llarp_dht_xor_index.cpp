@@ -0,0 +1,121 @@
+#include <dht/kademlia.hpp>
+#include <dht/xor_index.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::RouterID;
+using llarp::dht::Key_t;
+using llarp::dht::XorIndex;
+
+namespace
+{
+  RouterID
+  RandomID(std::mt19937_64& rng)
+  {
+    RouterID id;
+    for (auto& byte : id)
+      byte = rng();
+    return id;
+  }
+
+  std::vector<RouterID>
+  Closest(std::vector<RouterID> ids, const Key_t& location, size_t k)
+  {
+    const llarp::dht::XorMetric compare{location};
+    std::sort(ids.begin(), ids.end(), [&compare](const auto& left, const auto& right) {
+      return compare(Key_t{left}, Key_t{right});
+    });
+    ids.resize(std::min(k, ids.size()));
+    return ids;
+  }
+}  // namespace
+
+TEST_CASE("XorIndex matches a full sort", "[dht]")
+{
+  std::mt19937_64 rng{1234};
+  XorIndex index;
+  std::vector<RouterID> ids;
+  for (size_t idx = 0; idx < 1000; ++idx)
+  {
+    ids.push_back(RandomID(rng));
+    index.Insert(ids.back());
+  }
+  // ids that only differ in their last bits, so the walk has to go all the way down
+  for (byte_t low = 1; low < 8; ++low)
+  {
+    RouterID near = ids.front();
+    near[31] ^= low;
+    ids.push_back(near);
+    index.Insert(near);
+  }
+  REQUIRE(index.Size() == ids.size());
+
+  for (int round = 0; round < 50; ++round)
+  {
+    const Key_t location{round % 2 ? ids[round] : RandomID(rng)};
+    for (const size_t k : {1, 4, 8, 20})
+      REQUIRE(index.FindClosest(location, k) == Closest(ids, location, k));
+  }
+}
+
+TEST_CASE("XorIndex follows inserts and removes", "[dht]")
+{
+  std::mt19937_64 rng{99};
+  XorIndex index;
+  REQUIRE(index.FindClosest(Key_t{}, 4).empty());
+
+  std::vector<RouterID> ids;
+  for (size_t idx = 0; idx < 64; ++idx)
+  {
+    ids.push_back(RandomID(rng));
+    index.Insert(ids.back());
+  }
+  // inserting again changes nothing
+  index.Insert(ids.front());
+  REQUIRE(index.Size() == ids.size());
+
+  const Key_t location{ids[10]};
+  REQUIRE(index.FindClosest(location, 1).front() == ids[10]);
+  index.Remove(ids[10]);
+  ids.erase(ids.begin() + 10);
+  REQUIRE(index.FindClosest(location, 8) == Closest(ids, location, 8));
+  REQUIRE(index.FindClosest(location, 100).size() == ids.size());
+  REQUIRE(index.FindClosest(location, 0).empty());
+
+  index.Clear();
+  REQUIRE(index.Size() == 0);
+  REQUIRE(index.FindClosest(location, 4).empty());
+}
+
+TEST_CASE("XorIndex walks in key order in pieces", "[dht]")
+{
+  std::mt19937_64 rng{4321};
+  XorIndex index;
+  std::vector<RouterID> ids;
+  for (size_t idx = 0; idx < 100; ++idx)
+  {
+    ids.push_back(RandomID(rng));
+    index.Insert(ids.back());
+  }
+  std::sort(ids.begin(), ids.end());
+
+  // ten at a time, going on from the last one seen
+  std::vector<RouterID> walked;
+  RouterID after;
+  for (size_t piece = 0; piece < 20; ++piece)
+  {
+    size_t seen = 0;
+    index.ForEachAfter(after, [&](const RouterID& id) {
+      walked.push_back(id);
+      after = id;
+      return ++seen < 10;
+    });
+    if (seen < 10)
+      break;
+  }
+  REQUIRE(walked == ids);
+}
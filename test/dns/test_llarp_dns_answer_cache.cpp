@@ -0,0 +1,124 @@
+#include <dns/answer_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace
+{
+  /// wire format query for name with type a and class in
+  std::vector<byte_t>
+  MakeQuery(uint16_t id, const std::vector<std::string>& labels)
+  {
+    std::vector<byte_t> msg{byte_t(id >> 8), byte_t(id), 0x01, 0, 0, 1, 0, 0, 0, 0, 0, 0};
+    for (const auto& label : labels)
+    {
+      msg.push_back(label.size());
+      msg.insert(msg.end(), label.begin(), label.end());
+    }
+    msg.insert(msg.end(), {0, 0, 1, 0, 1});
+    return msg;
+  }
+
+  /// the reply to query with one a record with ttl and an opt record
+  std::vector<byte_t>
+  MakeReply(std::vector<byte_t> msg, uint32_t ttl, byte_t rcode = 0)
+  {
+    msg[2] |= 0x80;
+    msg[3] = 0x80 | rcode;
+    msg[7] = 1;
+    msg[11] = 1;
+    msg.insert(
+        msg.end(),
+        {0xc0,
+         0x0c,
+         0,
+         1,
+         0,
+         1,
+         byte_t(ttl >> 24),
+         byte_t(ttl >> 16),
+         byte_t(ttl >> 8),
+         byte_t(ttl),
+         0,
+         4,
+         10,
+         0,
+         0,
+         1});
+    // opt with the do bit set where a ttl would be
+    msg.insert(msg.end(), {0, 0, 41, 0x10, 0, 0, 0, 0x80, 0, 0, 0});
+    return msg;
+  }
+
+  uint32_t
+  AnswerTTL(const std::vector<byte_t>& reply, size_t questionEnd)
+  {
+    const byte_t* ttl = reply.data() + questionEnd + 6;
+    return (uint32_t{ttl[0]} << 24) | (uint32_t{ttl[1]} << 16) | (uint32_t{ttl[2]} << 8) | ttl[3];
+  }
+}  // namespace
+
+TEST_CASE("AnswerCache answers repeat questions with ttls aged", "[dns]")
+{
+  llarp::dns::AnswerCache cache;
+  const auto query = MakeQuery(1, {"example", "com"});
+  const size_t questionEnd = query.size();
+  cache.Put(llarp_buffer_t(MakeReply(query, 300)), 1000s);
+  REQUIRE(cache.Size() == 1);
+
+  // names match whatever their case
+  const auto again = MakeQuery(0xbeef, {"EXAMPLE", "Com"});
+  const auto hit = cache.Get(llarp_buffer_t(again), 1100s);
+  REQUIRE(hit);
+  CHECK((*hit)[0] == 0xbe);
+  CHECK((*hit)[1] == 0xef);
+  CHECK(AnswerTTL(*hit, questionEnd) == 200);
+  // the opt record is left alone
+  CHECK(hit->back() == 0);
+  CHECK((*hit)[hit->size() - 4] == 0x80);
+  CHECK(cache.Hits() == 1);
+
+  CHECK_FALSE(cache.Get(llarp_buffer_t(MakeQuery(2, {"example", "net"})), 1100s));
+  CHECK_FALSE(cache.Get(llarp_buffer_t(again), 1300s));
+  CHECK(cache.Size() == 0);
+  CHECK(cache.Misses() == 2);
+}
+
+TEST_CASE("AnswerCache keeps only replies it can age", "[dns]")
+{
+  llarp::dns::AnswerCache cache;
+  const auto query = MakeQuery(1, {"example", "com"});
+  cache.Put(llarp_buffer_t(MakeReply(query, 0)), 0s);
+  // servfail
+  cache.Put(llarp_buffer_t(MakeReply(query, 300, 2)), 0s);
+  // truncated
+  auto truncated = MakeReply(query, 300);
+  truncated[2] |= 0x02;
+  cache.Put(llarp_buffer_t(truncated), 0s);
+  // not a reply at all
+  cache.Put(llarp_buffer_t(query), 0s);
+  // cut short
+  auto cut = MakeReply(query, 300);
+  cut.resize(cut.size() - 14);
+  cache.Put(llarp_buffer_t(cut), 0s);
+  CHECK(cache.Size() == 0);
+
+  cache.Put(llarp_buffer_t(MakeReply(query, 300, 3)), 0s);
+  CHECK(cache.Size() == 1);
+}
+
+TEST_CASE("AnswerCache drops the least recently used when full", "[dns]")
+{
+  llarp::dns::AnswerCache cache;
+  for (size_t idx = 0; idx < llarp::dns::AnswerCache::MaxEntries; ++idx)
+    cache.Put(llarp_buffer_t(MakeReply(MakeQuery(1, {std::to_string(idx)}), 300)), 0s);
+  REQUIRE(cache.Get(llarp_buffer_t(MakeQuery(1, {"0"})), 1s));
+  cache.Put(llarp_buffer_t(MakeReply(MakeQuery(1, {"new"}), 300)), 1s);
+  CHECK(cache.Size() == llarp::dns::AnswerCache::MaxEntries);
+  CHECK(cache.Get(llarp_buffer_t(MakeQuery(1, {"0"})), 1s));
+  CHECK_FALSE(cache.Get(llarp_buffer_t(MakeQuery(1, {"1"})), 1s));
+}
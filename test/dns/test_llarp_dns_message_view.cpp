@@ -0,0 +1,78 @@
+#include <dns/dns.hpp>
+#include <dns/message.hpp>
+#include <dns/message_view.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <vector>
+
+namespace
+{
+  /// the wire format of a query for qname with qtype
+  std::vector<byte_t>
+  EncodeQuery(std::string qname, uint16_t qtype)
+  {
+    llarp::dns::MessageHeader hdr;
+    hdr.id = 0x1234;
+    hdr.fields = llarp::dns::flags_RD;
+    llarp::dns::Message msg(hdr);
+    msg.questions.resize(1);
+    msg.questions[0].qname = std::move(qname);
+    msg.questions[0].qtype = qtype;
+    msg.questions[0].qclass = llarp::dns::qClassIN;
+    std::array<byte_t, 512> tmp{};
+    llarp_buffer_t buf(tmp);
+    REQUIRE(msg.Encode(&buf));
+    return std::vector<byte_t>(tmp.begin(), tmp.begin() + (buf.cur - buf.base));
+  }
+}  // namespace
+
+TEST_CASE("MessageView reads the question where it lies", "[dns]")
+{
+  auto wire = EncodeQuery("foo.bar.loki.", llarp::dns::qTypeAAAA);
+  llarp::dns::MessageView view;
+  REQUIRE(view.Parse(llarp_buffer_t(wire)));
+  CHECK(view.id == 0x1234);
+  CHECK(view.qdCount == 1);
+  CHECK(view.qtype == llarp::dns::qTypeAAAA);
+  CHECK(view.qclass == llarp::dns::qClassIN);
+  CHECK(view.questionEnd == wire.size());
+  CHECK(view.QName() == "foo.bar.loki.");
+
+  // same answers as Question
+  llarp::dns::Question question;
+  question.qname = "foo.bar.loki.";
+  for (const auto tld : {".loki", ".snode", "bar.loki", ".bar.loki", "oki", "foo.bar.loki"})
+    CHECK(view.HasTLD(tld) == question.HasTLD(tld));
+  for (const auto name : {"foo.bar.loki", "foo.bar.loki.", "bar.loki", "foo.bar.lok"})
+    CHECK(view.IsName(name) == question.IsName(name));
+
+  // cut short in the question
+  wire.resize(wire.size() - 3);
+  CHECK_FALSE(view.Parse(llarp_buffer_t(wire)));
+}
+
+TEST_CASE("ReplyWriter makes the reply Message would have", "[dns]")
+{
+  auto wire = EncodeQuery("use-application-dns.net.", llarp::dns::qTypeA);
+  const auto query = wire;
+  // an opt record after the question goes
+  wire.insert(wire.end(), {0, 0, 41, 0x10, 0, 0, 0, 0, 0, 0, 0});
+  wire[11] = 1;
+
+  llarp::dns::MessageView view;
+  REQUIRE(view.Parse(llarp_buffer_t(wire)));
+  llarp::dns::ReplyWriter(wire, view).NX();
+
+  llarp::dns::MessageHeader hdr;
+  llarp_buffer_t buf(query);
+  REQUIRE(hdr.Decode(&buf));
+  llarp::dns::Message msg(hdr);
+  REQUIRE(msg.Decode(&buf));
+  msg.AddNXReply();
+  std::array<byte_t, 512> tmp{};
+  llarp_buffer_t out(tmp);
+  REQUIRE(msg.Encode(&out));
+  CHECK(wire == std::vector<byte_t>(tmp.begin(), tmp.begin() + (out.cur - out.base)));
+}
@@ -0,0 +1,61 @@
+#include <exit/snode_registry.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+namespace
+{
+  /// a udp over ipv4 packet with the given ports
+  std::vector<byte_t>
+  UDP(uint16_t src, uint16_t dst)
+  {
+    std::vector<byte_t> pkt(28, 0);
+    pkt[0] = 0x45;
+    pkt[9] = 17;
+    pkt[20] = src >> 8;
+    pkt[21] = src & 0xff;
+    pkt[22] = dst >> 8;
+    pkt[23] = dst & 0xff;
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("Shared snode session replies go to whoever sent on the flow", "[exit]")
+{
+  llarp::exit::FlowOwners flows;
+  int tun, app;
+  const llarp_time_t now = 1h;
+
+  const auto tunOut = UDP(40000, 53);
+  const auto appOut = UDP(40001, 53);
+  flows.Sent(&tun, tunOut.data(), tunOut.size(), now);
+  flows.Sent(&app, appOut.data(), appOut.size(), now);
+  CHECK(flows.Size() == 2);
+
+  const auto tunReply = UDP(53, 40000);
+  const auto appReply = UDP(53, 40001);
+  CHECK(flows.Received(tunReply.data(), tunReply.size()) == &tun);
+  CHECK(flows.Received(appReply.data(), appReply.size()) == &app);
+
+  // on no flow it goes to the last to send anything
+  const auto stray = UDP(53, 1234);
+  CHECK(flows.Received(stray.data(), stray.size()) == &app);
+
+  flows.Forget(&app);
+  CHECK(flows.Size() == 1);
+  CHECK(flows.Received(appReply.data(), appReply.size()) == nullptr);
+  CHECK(flows.Received(tunReply.data(), tunReply.size()) == &tun);
+}
+
+TEST_CASE("Shared snode session flows expire", "[exit]")
+{
+  llarp::exit::FlowOwners flows;
+  int owner;
+  const auto out = UDP(40000, 53);
+  flows.Sent(&owner, out.data(), out.size(), 1h);
+  flows.Expire(1h + llarp::exit::FlowOwners::FlowLifetime - 1ms);
+  CHECK(flows.Size() == 1);
+  flows.Expire(1h + llarp::exit::FlowOwners::FlowLifetime);
+  CHECK(flows.Size() == 0);
+}
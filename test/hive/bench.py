@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+throughput and latency benchmark on the router hive.
+
+spins up relays and clients in process, puts an endpoint on each client and drives traffic
+between them through real paths, then reports what got through, end to end latency and how
+much cpu each router's main thread used. packets are made and counted in c++ so python is not
+what is being measured.
+
+  bench.py --profile bulk --relay-count 20 --client-count 10 --duration 30 --json out.json
+"""
+import pyllarp
+import hive
+from time import sleep, time
+from argparse import ArgumentParser as ap
+import json
+import resource
+import sys
+
+# name: (bytes per packet, packets per burst, seconds between bursts, remotes per client)
+PROFILES = {
+  # big packets as fast as the paths will take them, one remote each
+  "bulk": (1200, 64, 0.01, 1),
+  # small packets every so often, a chat or ssh session
+  "interactive": (64, 1, 0.02, 1),
+  # a few packets to every other client, so most of the time goes on making sessions
+  "convos": (256, 4, 0.5, None),
+}
+
+class Bench(object):
+
+  def __init__(self, router_hive, profile):
+    self.hive = router_hive
+    self.size, self.burst, self.interval, self.fanout = PROFILES[profile]
+    self.endpoints = []
+
+  def AddEndpoints(self):
+    def add(ctx):
+      ep = pyllarp.Endpoint("bench", ctx)
+      ep.CountTraffic(True)
+      ctx.CallSafe(lambda: ctx.AddEndpoint(ep))
+      self.endpoints.append(ep)
+    self.hive.hive.ForEachClient(add)
+
+  def WaitReady(self, timeout):
+    end = time() + timeout
+    while time() < end:
+      self.hive.hive.GetAllEvents()
+      if all(ep.IsReady() for ep in self.endpoints):
+        return True
+      sleep(0.1)
+    return False
+
+  def Flows(self):
+    addrs = [pyllarp.ServiceAddress(ep.OurAddress()) for ep in self.endpoints]
+    count = len(self.endpoints)
+    fanout = self.fanout or count - 1
+    flows = []
+    for idx, ep in enumerate(self.endpoints):
+      for step in range(1, fanout + 1):
+        flows.append((ep, addrs[(idx + step) % count]))
+    return flows
+
+  def CPUTimes(self):
+    return ({str(k): v for k, v in self.hive.hive.RelayCPUTimes()},
+            {str(k): v for k, v in self.hive.hive.ClientCPUTimes()})
+
+  def Run(self, duration, warmup):
+    flows = self.Flows()
+    # bring the sessions up first unless making them is what we are measuring
+    if self.fanout:
+      for ep, remote in flows:
+        ep.SendBurst(remote, 1, self.size)
+      sleep(warmup)
+    for ep in self.endpoints:
+      ep.TakeTraffic()
+
+    relays_before, clients_before = self.CPUTimes()
+    started = time()
+    sent = 0
+    while time() < started + duration:
+      for ep, remote in flows:
+        ep.SendBurst(remote, self.burst, self.size)
+        sent += self.burst
+      # the hive keeps every router event for us, don't let them pile up
+      self.hive.hive.GetAllEvents()
+      sleep(self.interval)
+    # give what is still in flight a moment to land
+    sleep(1)
+    elapsed = time() - started
+    relays_after, clients_after = self.CPUTimes()
+
+    packets = 0
+    nbytes = 0
+    latencies = []
+    for ep in self.endpoints:
+      got, got_bytes, lat = ep.TakeTraffic()
+      packets += got
+      nbytes += got_bytes
+      latencies.extend(lat)
+    latencies.sort()
+
+    def percentile(p):
+      if not latencies:
+        return None
+      return latencies[min(len(latencies) - 1, int(len(latencies) * p))]
+
+    def cpu(before, after):
+      return {k: after[k] - before[k] for k in after if k in before}
+
+    return {
+      "flows": len(flows),
+      "sent": sent,
+      "received": packets,
+      "elapsed": elapsed,
+      "bytes_per_sec": nbytes / elapsed,
+      "packets_per_sec": packets / elapsed,
+      "latency_us": {"p50": percentile(0.5), "p99": percentile(0.99)},
+      "relay_cpu": cpu(relays_before, relays_after),
+      "client_cpu": cpu(clients_before, clients_after),
+      "process_cpu": resource.getrusage(resource.RUSAGE_SELF).ru_utime,
+    }
+
+def report(result):
+  print("flows: {}, sent: {}, received: {} ({:.1f}%)".format(
+    result["flows"], result["sent"], result["received"],
+    100.0 * result["received"] / max(1, result["sent"])))
+  print("throughput: {:.0f} B/s, {:.0f} pkt/s".format(
+    result["bytes_per_sec"], result["packets_per_sec"]))
+  print("latency: p50 {} us, p99 {} us".format(
+    result["latency_us"]["p50"], result["latency_us"]["p99"]))
+  for kind in ("relay_cpu", "client_cpu"):
+    cpu = result[kind]
+    if cpu:
+      print("{}: mean {:.3f}s, max {:.3f}s over {} routers".format(
+        kind, sum(cpu.values()) / len(cpu), max(cpu.values()), len(cpu)))
+
+def main():
+  parser = ap()
+  parser.add_argument('--profile', choices=sorted(PROFILES), default='bulk')
+  parser.add_argument('--relay-count', dest="relay_count", type=int, default=20)
+  parser.add_argument('--client-count', dest="client_count", type=int, default=10)
+  parser.add_argument('--duration', type=float, default=30)
+  parser.add_argument('--warmup', type=float, default=5)
+  parser.add_argument('--ready-timeout', dest="ready_timeout", type=float, default=60)
+  parser.add_argument('--json', dest="json_out", default=None)
+  parser.add_argument('--verbose', action='store_true', dest='verbose')
+  args = parser.parse_args()
+
+  router_hive = hive.RouterHive(args.relay_count, args.client_count, shutup=not args.verbose)
+  router_hive.Start()
+  try:
+    bench = Bench(router_hive, args.profile)
+    bench.AddEndpoints()
+    if not bench.WaitReady(args.ready_timeout):
+      print("endpoints did not get ready in {} seconds".format(args.ready_timeout))
+      return 1
+    result = bench.Run(args.duration, args.warmup)
+    result["profile"] = args.profile
+    result["relays"] = args.relay_count
+    result["clients"] = args.client_count
+    report(result)
+    if args.json_out:
+      with open(args.json_out, "w") as f:
+        json.dump(result, f, indent=2)
+  finally:
+    router_hive.Stop()
+  return 0
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,81 @@
+#include <iwp/congestion.hpp>
+#include <catch2/catch.hpp>
+
+using llarp::iwp::CongestionControl;
+
+TEST_CASE("CongestionControl slow start grows per ack", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  const auto start = cc.Window();
+  cc.OnRTTSample(50ms);
+  cc.OnAcked(4, 1s);
+  REQUIRE(cc.Window() == start + 4);
+  REQUIRE(cc.SmoothedRTT() == 50ms);
+}
+
+TEST_CASE("CongestionControl backs off once per round trip", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  cc.OnRTTSample(100ms);
+  cc.OnAcked(84, 1s);
+  REQUIRE(cc.Window() == 100);
+  cc.OnLoss(2s);
+  REQUIRE(cc.Window() == 70);
+  REQUIRE(cc.LossEvents() == 1);
+  // same round trip, no second decrease
+  cc.OnLoss(2s + 10ms);
+  REQUIRE(cc.Window() == 70);
+  cc.OnLoss(2s + 200ms);
+  REQUIRE(cc.Window() == 49);
+  REQUIRE(cc.LossEvents() == 2);
+}
+
+TEST_CASE("CongestionControl recovers towards the old window", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  cc.OnRTTSample(100ms);
+  cc.OnAcked(84, 1s);
+  cc.OnLoss(2s);
+  const auto reduced = cc.Window();
+  llarp_time_t now = 2s;
+  for (int i = 0; i < 100; ++i)
+  {
+    now += 100ms;
+    cc.OnAcked(cc.Window(), now);
+  }
+  REQUIRE(cc.Window() > reduced);
+  REQUIRE(cc.Window() >= 100);
+}
+
+TEST_CASE("CongestionControl timeout collapses the window", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  cc.OnAcked(200, 1s);
+  cc.OnTimeout(2s);
+  REQUIRE(cc.Window() <= CongestionControl::InitialWindow);
+  REQUIRE(cc.Window() >= CongestionControl::MinWindow);
+}
+
+TEST_CASE("CongestionControl limits what is in flight", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  const auto window = cc.Window();
+  // nothing in flight always lets one message out
+  REQUIRE(cc.CanSend(window * 2, 0, 1s));
+  REQUIRE(cc.CanSend(1, window - 1, 1s));
+  REQUIRE(not cc.CanSend(2, window - 1, 1s));
+}
+
+TEST_CASE("CongestionControl paces once it has an rtt", "[iwp][congestion]")
+{
+  CongestionControl cc;
+  REQUIRE(cc.PacingRate() == 0);
+  cc.OnRTTSample(100ms);
+  REQUIRE(cc.PacingRate() > 0);
+  REQUIRE(cc.CanSend(1, 1, 1s));
+  // use up the burst
+  cc.OnSent(CongestionControl::MaxBurst);
+  REQUIRE(not cc.CanSend(1, 1, 1s));
+  // tokens come back with time
+  REQUIRE(cc.CanSend(1, 1, 1s + 100ms));
+}
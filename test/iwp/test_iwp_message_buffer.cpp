@@ -0,0 +1,69 @@
+#include <iwp/message_buffer.hpp>
+#include <catch2/catch.hpp>
+
+using namespace llarp::iwp;
+
+TEST_CASE("AckRanges encodes runs of acked fragments", "[iwp][sack]")
+{
+  FragmentBits acks;
+  REQUIRE(AckRanges(acks, MaxFragments).empty());
+
+  acks.set(0);
+  acks.set(1);
+  acks.set(3);
+  acks.set(5);
+  acks.set(6);
+  acks.set(7);
+  const auto ranges = AckRanges(acks, MaxFragments);
+  REQUIRE(ranges.size() == 3);
+  REQUIRE(ranges[0] == std::make_pair<uint16_t, uint16_t>(0, 2));
+  REQUIRE(ranges[1] == std::make_pair<uint16_t, uint16_t>(3, 1));
+  REQUIRE(ranges[2] == std::make_pair<uint16_t, uint16_t>(5, 3));
+
+  // fragments past the end of the message are never encoded
+  REQUIRE(AckRanges(acks, 4).size() == 2);
+}
+
+TEST_CASE("InboundMessage asks for an ack when a fragment skips a hole", "[iwp][sack]")
+{
+  InboundMessage msg{0, 4 * FragmentSize, llarp::ShortHash{}, 0s};
+  std::vector<byte_t> frag(FragmentSize);
+  const llarp_buffer_t buf(frag);
+
+  REQUIRE(not msg.HandleData(0, buf, 1s));
+  REQUIRE(not msg.m_ACKNow);
+  // fragment 1 goes missing
+  REQUIRE(msg.HandleData(2 * FragmentSize, buf, 1s));
+  REQUIRE(msg.m_ACKNow);
+  REQUIRE(msg.ShouldSendACKS(1s));
+  msg.ACKSSent(1s);
+  REQUIRE(not msg.ShouldSendACKS(1s));
+  // a duplicate says nothing new
+  REQUIRE(not msg.HandleData(2 * FragmentSize, buf, 1s));
+  REQUIRE(not msg.m_ACKNow);
+
+  const auto ranges = AckRanges(msg.m_Acks, msg.NumFragments());
+  REQUIRE(ranges.size() == 2);
+  REQUIRE(not msg.IsCompleted());
+}
+
+TEST_CASE("InboundMessage indexes fragments by the remote's fragment size", "[iwp][mtu]")
+{
+  const size_t fragsz = MaxFragmentSize;
+  const uint16_t sz = 3 * fragsz - 100;
+  InboundMessage msg{0, sz, llarp::ShortHash{}, 0s, fragsz};
+  REQUIRE(msg.NumFragments() == 3);
+  // the biggest fragments still need no more ack bits than the smallest
+  REQUIRE(MAX_LINK_MSG_SIZE / FragmentSizes.front() <= MaxFragments);
+
+  std::vector<byte_t> frag(fragsz);
+  const llarp_buffer_t buf(frag);
+  REQUIRE(not msg.HandleData(0, buf, 1s));
+  REQUIRE(not msg.IsCompleted());
+  const llarp_buffer_t last(frag.data(), sz - 2 * fragsz);
+  REQUIRE(msg.HandleData(2 * fragsz, last, 1s));
+  REQUIRE(msg.m_Acks.test(2));
+  REQUIRE(not msg.m_Acks.test(1));
+  REQUIRE(not msg.HandleData(fragsz, buf, 1s));
+  REQUIRE(msg.IsCompleted());
+}
@@ -257,23 +257,26 @@ TEST_CASE("IWP send messages", "[iwp]")
         alice->Call([session, endIfDone, alice, &aliceNumSent]() {
           // generate a discard message that is 512 bytes long
           llarp::DiscardMessage msg;
-          std::vector<byte_t> msgBuff(512);
+          llarp::ILinkSession::Message_t msgBuff(512);
           llarp_buffer_t buf(msgBuff);
           // add random padding
           llarp::CryptoManager::instance()->randomize(buf);
           // encode the discard message
           msg.BEncode(&buf);
           // send the message
-          session->SendMessageBuffer(msgBuff, [endIfDone, alice, &aliceNumSent](auto status) {
-            if (status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess)
-            {
-              // on successful transmit increment the number we sent
-              aliceNumSent++;
-            }
-            // if we sent all the messages sucessfully we end the unit test
-            alice->gucci = aliceNumSent == numSend;
-            endIfDone();
-          });
+          session->SendMessageBuffer(
+              msgBuff,
+              [endIfDone, alice, &aliceNumSent](auto status) {
+                if (status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess)
+                {
+                  // on successful transmit increment the number we sent
+                  aliceNumSent++;
+                }
+                // if we sent all the messages sucessfully we end the unit test
+                alice->gucci = aliceNumSent == numSend;
+                endIfDone();
+              },
+              llarp::TrafficClass::Control);
         });
       }
     });
@@ -283,23 +286,26 @@ TEST_CASE("IWP send messages", "[iwp]")
         bob->Call([session, endIfDone, bob, &bobNumSent]() {
           // generate a discard message that is 512 bytes long
           llarp::DiscardMessage msg;
-          std::vector<byte_t> msgBuff(512);
+          llarp::ILinkSession::Message_t msgBuff(512);
           llarp_buffer_t buf(msgBuff);
           // add random padding
           llarp::CryptoManager::instance()->randomize(buf);
           // encode the discard message
           msg.BEncode(&buf);
           // send the message
-          session->SendMessageBuffer(msgBuff, [endIfDone, bob, &bobNumSent](auto status) {
-            if (status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess)
-            {
-              // on successful transmit increment the number we sent
-              bobNumSent++;
-            }
-            // if we sent all the messages sucessfully we end the unit test
-            bob->gucci = bobNumSent == numSend;
-            endIfDone();
-          });
+          session->SendMessageBuffer(
+              msgBuff,
+              [endIfDone, bob, &bobNumSent](auto status) {
+                if (status == llarp::ILinkSession::DeliveryStatus::eDeliverySuccess)
+                {
+                  // on successful transmit increment the number we sent
+                  bobNumSent++;
+                }
+                // if we sent all the messages sucessfully we end the unit test
+                bob->gucci = bobNumSent == numSend;
+                endIfDone();
+              },
+              llarp::TrafficClass::Control);
         });
       }
     });
@@ -0,0 +1,86 @@
+#include <link/capture.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <fstream>
+
+namespace
+{
+  struct CaptureFile
+  {
+    fs::path file = fs::temp_directory_path() / "lokinet-test-capture";
+
+    ~CaptureFile()
+    {
+      std::error_code ec;
+      fs::remove(file, ec);
+    }
+  };
+}  // namespace
+
+TEST_CASE("Captures read back what was written", "[link][capture]")
+{
+  CaptureFile capture;
+  const llarp::SockAddr from{"1.2.3.4:1090"};
+  const std::vector<byte_t> first{1, 2, 3};
+  const std::vector<byte_t> second(1400, 0xaa);
+  llarp::RouterID remote;
+  remote.Randomize();
+  llarp::SharedSecret key;
+  key.Randomize();
+  {
+    llarp::capture::Writer writer;
+    REQUIRE(writer.Open(capture.file, true));
+    writer.Write(from, first.data(), first.size());
+    writer.WriteKey(from, remote, key);
+    writer.Write(from, second.data(), second.size());
+  }
+
+  llarp::capture::Reader reader;
+  REQUIRE(reader.Open(capture.file));
+  auto record = reader.Next();
+  REQUIRE(record);
+  const auto* dgram = std::get_if<llarp::capture::Datagram>(&*record);
+  REQUIRE(dgram);
+  CHECK(dgram->from == from);
+  CHECK(dgram->data == first);
+
+  record = reader.Next();
+  REQUIRE(record);
+  const auto* logged = std::get_if<llarp::capture::SessionKey>(&*record);
+  REQUIRE(logged);
+  CHECK(logged->from == from);
+  CHECK(logged->remote == remote);
+  CHECK(logged->key == key);
+
+  record = reader.Next();
+  REQUIRE(record);
+  dgram = std::get_if<llarp::capture::Datagram>(&*record);
+  REQUIRE(dgram);
+  CHECK(dgram->data == second);
+  CHECK(dgram->at >= logged->at);
+
+  CHECK(not reader.Next());
+}
+
+TEST_CASE("Captures leave keys out unless asked", "[link][capture]")
+{
+  CaptureFile capture;
+  const llarp::SockAddr from{"1.2.3.4:1090"};
+  {
+    llarp::capture::Writer writer;
+    REQUIRE(writer.Open(capture.file, false));
+    writer.WriteKey(from, llarp::RouterID{}, llarp::SharedSecret{});
+  }
+  llarp::capture::Reader reader;
+  REQUIRE(reader.Open(capture.file));
+  CHECK(not reader.Next());
+}
+
+TEST_CASE("Captures refuse files that are not captures", "[link][capture]")
+{
+  CaptureFile capture;
+  std::ofstream{capture.file} << "not a capture";
+  llarp::capture::Reader reader;
+  CHECK(not reader.Open(capture.file));
+}
@@ -0,0 +1,218 @@
+#include <messages/relay.hpp>
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+  template <typename Msg_t>
+  std::string
+  Encode(Msg_t& msg)
+  {
+    std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+    llarp_buffer_t buf(tmp);
+    REQUIRE(msg.BEncode(&buf));
+    return std::string(reinterpret_cast<const char*>(tmp.data()), buf.cur - buf.base);
+  }
+
+  template <typename Msg_t>
+  Msg_t
+  MakeRelay()
+  {
+    Msg_t msg;
+    msg.pathid.Randomize();
+    msg.Y.Randomize();
+    const std::string payload(700, 'x');
+    msg.X = llarp_buffer_t(payload);
+    return msg;
+  }
+}  // namespace
+
+TEST_CASE("RelayCell reads relay messages as we encode them", "[relay]")
+{
+  auto up = MakeRelay<llarp::RelayUpstreamMessage>();
+  auto down = MakeRelay<llarp::RelayDownstreamMessage>();
+  for (const auto& [type, encoded] :
+       {std::pair{'u', Encode(up)}, std::pair{'d', Encode(down)}})
+  {
+    const auto& msg = type == 'u' ? static_cast<llarp::ILinkMessage&>(up)
+                                  : static_cast<llarp::ILinkMessage&>(down);
+    const auto& Y = type == 'u' ? up.Y : down.Y;
+    llarp_buffer_t buf(encoded);
+    const auto cell = llarp::RelayCell::Read(buf);
+    REQUIRE(cell);
+    CHECK(cell->type == type);
+    CHECK(cell->pathid == msg.pathid);
+    CHECK(cell->Y == Y);
+    REQUIRE(cell->XSize == 700);
+    // a view into the message, not a copy
+    CHECK(cell->X >= buf.base);
+    CHECK(cell->X + cell->XSize <= buf.base + buf.sz);
+    CHECK(
+        std::string(reinterpret_cast<const char*>(cell->X), cell->XSize)
+        == std::string(700, 'x'));
+  }
+}
+
+TEST_CASE("RelayCell leaves anything else to the parser", "[relay]")
+{
+  auto up = MakeRelay<llarp::RelayUpstreamMessage>();
+  const auto encoded = Encode(up);
+
+  // cut short, or with something after it
+  for (const auto& bad : {encoded.substr(0, encoded.size() - 1), encoded + "e"})
+  {
+    llarp_buffer_t buf(bad);
+    CHECK_FALSE(llarp::RelayCell::Read(buf));
+  }
+
+  // another version
+  auto version = encoded;
+  const auto pos = version.find("1:vi");
+  REQUIRE(pos != std::string::npos);
+  version[pos + 4] = '9';
+  llarp_buffer_t versionBuf(std::as_const(version));
+  CHECK_FALSE(llarp::RelayCell::Read(versionBuf));
+
+  // another message type
+  auto other = encoded;
+  other[6] = 'i';
+  llarp_buffer_t otherBuf(std::as_const(other));
+  CHECK_FALSE(llarp::RelayCell::Read(otherBuf));
+}
+
+TEST_CASE("RelayCell reads relay messages in the compact framing", "[relay]")
+{
+  auto up = MakeRelay<llarp::RelayUpstreamMessage>();
+  auto down = MakeRelay<llarp::RelayDownstreamMessage>();
+  using Case_t = std::pair<char, const llarp::ILinkMessage*>;
+  for (const auto& [type, msg] : {Case_t{'u', &up}, Case_t{'d', &down}})
+  {
+    const auto& Y = type == 'u' ? up.Y : down.Y;
+    llarp::ILinkSession::Message_t out;
+    REQUIRE(msg->CompactEncode(out));
+    CHECK(out.size() == llarp::RelayCell::CompactHeaderSize + 700);
+    // smaller than the bencoded message
+    CHECK(out.size() < (type == 'u' ? Encode(up) : Encode(down)).size());
+
+    llarp_buffer_t buf(out);
+    const auto cell = llarp::RelayCell::Read(buf);
+    REQUIRE(cell);
+    CHECK(cell->type == type);
+    CHECK(cell->pathid == msg->pathid);
+    CHECK(cell->Y == Y);
+    REQUIRE(cell->XSize == 700);
+    CHECK(cell->X == buf.base + llarp::RelayCell::CompactHeaderSize);
+    CHECK(
+        std::string(reinterpret_cast<const char*>(cell->X), cell->XSize)
+        == std::string(700, 'x'));
+
+    // the size of X has to match what is there
+    out.pop_back();
+    llarp_buffer_t shortBuf(out);
+    CHECK_FALSE(llarp::RelayCell::Read(shortBuf));
+  }
+}
+
+TEST_CASE("a relay message viewing a held cell encodes as one owning it", "[relay]")
+{
+  const auto owned = MakeRelay<llarp::RelayUpstreamMessage>();
+  const std::vector<byte_t> held(700, 'x');
+  llarp::RelayUpstreamMessage viewing;
+  viewing.pathid = owned.pathid;
+  viewing.Y = owned.Y;
+  REQUIRE(viewing.XView.Assign(held.data(), held.size()));
+  CHECK(viewing.X.size() == 0);
+  CHECK(Encode(viewing) == Encode(owned));
+
+  llarp::ILinkSession::Message_t fromOwned;
+  llarp::ILinkSession::Message_t fromViewing;
+  REQUIRE(owned.CompactEncode(fromOwned));
+  REQUIRE(viewing.CompactEncode(fromViewing));
+  CHECK(fromViewing == fromOwned);
+
+  const std::vector<byte_t> tooBig(MAX_LINK_MSG_SIZE, 'x');
+  CHECK_FALSE(viewing.XView.Assign(tooBig.data(), tooBig.size()));
+}
+
+TEST_CASE("compact framing is left to routers new enough for it", "[relay]")
+{
+  CHECK_FALSE(llarp::RouterVersion({0, 8, 0}, LLARP_PROTO_VERSION)
+                  .IsAtLeast(llarp::CompactFramingVersion));
+  CHECK(llarp::RouterVersion(llarp::CompactFramingVersion, LLARP_PROTO_VERSION)
+            .IsAtLeast(llarp::CompactFramingVersion));
+  CHECK(llarp::RouterVersion({0, 9, 0}, LLARP_PROTO_VERSION)
+            .IsAtLeast(llarp::CompactFramingVersion));
+}
+
+TEST_CASE("relay cells for one next hop share a bundle", "[relay]")
+{
+  auto up = MakeRelay<llarp::RelayUpstreamMessage>();
+  auto down = MakeRelay<llarp::RelayDownstreamMessage>();
+  llarp::ILinkSession::Message_t upCell, downCell;
+  REQUIRE(up.CompactEncode(upCell));
+  REQUIRE(down.CompactEncode(downCell));
+  REQUIRE(llarp::RelayCell::IsCompact(upCell));
+  REQUIRE(llarp::RelayCell::IsCompact(downCell));
+
+  llarp::ILinkSession::Message_t bundle;
+  llarp::RelayCell::AddToBundle(bundle, upCell);
+  // one cell goes as itself
+  CHECK(bundle == upCell);
+  const auto expected = llarp::RelayCell::BundledSize(bundle, downCell.size());
+  llarp::RelayCell::AddToBundle(bundle, downCell);
+  CHECK(bundle.size() == expected);
+  CHECK(bundle[0] == llarp::RelayCell::CompactBundle);
+  CHECK_FALSE(llarp::RelayCell::IsCompact(bundle));
+
+  std::vector<llarp::RelayCell> cells;
+  llarp_buffer_t buf(bundle);
+  REQUIRE(llarp::RelayCell::ReadBundle(
+      buf, [&cells](const llarp::RelayCell& cell) { cells.push_back(cell); }));
+  REQUIRE(cells.size() == 2);
+  CHECK(cells[0].type == 'u');
+  CHECK(cells[0].pathid == up.pathid);
+  CHECK(cells[0].Y == up.Y);
+  CHECK(cells[1].type == 'd');
+  CHECK(cells[1].pathid == down.pathid);
+  CHECK(cells[1].XSize == 700);
+
+  // a bundle cut short is dropped whole
+  bundle.pop_back();
+  llarp_buffer_t shortBuf(bundle);
+  size_t visited = 0;
+  CHECK_FALSE(llarp::RelayCell::ReadBundle(shortBuf, [&](const auto&) { visited++; }));
+  CHECK(visited == 0);
+}
+
+TEST_CASE("a downstream cell carries the congestion bit through a bundle", "[relay]")
+{
+  auto down = MakeRelay<llarp::RelayDownstreamMessage>();
+  down.congested = true;
+  llarp::ILinkSession::Message_t cell;
+  REQUIRE(down.CompactEncode(cell));
+  REQUIRE(llarp::RelayCell::IsCompact(cell));
+  const auto read = llarp::RelayCell::Read(llarp_buffer_t(cell));
+  REQUIRE(read);
+  CHECK(read->type == 'd');
+  CHECK(read->congested);
+
+  llarp::ILinkSession::Message_t bundle;
+  llarp::RelayCell::AddToBundle(bundle, cell);
+  llarp::RelayCell::AddToBundle(bundle, cell);
+  size_t congested = 0;
+  REQUIRE(llarp::RelayCell::ReadBundle(llarp_buffer_t(bundle), [&](const auto& c) {
+    congested += c.congested;
+  }));
+  CHECK(congested == 2);
+
+  // taken off for peers that cannot read it
+  llarp::RelayCell::ClearCongested(cell);
+  CHECK(cell[0] == llarp::RelayCell::CompactDownstream);
+  CHECK_FALSE(llarp::RelayCell::Read(llarp_buffer_t(cell))->congested);
+}
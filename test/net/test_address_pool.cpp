@@ -0,0 +1,52 @@
+#include <net/address_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+
+using namespace std::literals;
+using llarp::huint128_t;
+
+TEST_CASE("AddressPool hands out each address in range once", "[AddressPool]")
+{
+  llarp::net::AddressPool pool;
+  pool.Reset(huint128_t{10}, huint128_t{14});
+  REQUIRE(pool.Capacity() == 4);
+  // taken by hand, so stepped over
+  pool.Take(huint128_t{12});
+
+  std::set<huint128_t> got;
+  while (const auto ip = pool.Allocate())
+    got.insert(*ip);
+  REQUIRE(got == std::set<huint128_t>{huint128_t{11}, huint128_t{13}, huint128_t{14}});
+  REQUIRE(pool.Used() == 4);
+
+  pool.Release(huint128_t{13});
+  REQUIRE_FALSE(pool.IsHeld(huint128_t{13}));
+  REQUIRE(pool.Allocate() == huint128_t{13});
+  REQUIRE_FALSE(pool.Allocate());
+}
+
+TEST_CASE("AddressPool offers the least active address", "[AddressPool]")
+{
+  llarp::net::AddressPool pool;
+  pool.Reset(huint128_t{0}, huint128_t{3});
+  pool.Pin(huint128_t{0});
+  for (int idx = 0; idx < 3; ++idx)
+    pool.MarkActive(*pool.Allocate(), llarp_time_t{idx + 1});
+  REQUIRE(pool.Oldest() == huint128_t{1});
+
+  pool.MarkActive(huint128_t{1}, 10ms);
+  REQUIRE(pool.Oldest() == huint128_t{2});
+  // activity never goes backwards
+  pool.MarkActive(huint128_t{1}, 5ms);
+  REQUIRE(pool.LastActive(huint128_t{1}) == 10ms);
+  REQUIRE(pool.LastActive(huint128_t{0}) == llarp_time_t::max());
+
+  pool.Release(huint128_t{2});
+  pool.Release(huint128_t{3});
+  REQUIRE(pool.Oldest() == huint128_t{1});
+  pool.Release(huint128_t{1});
+  // the pinned one is never offered
+  REQUIRE_FALSE(pool.Oldest());
+}
@@ -0,0 +1,75 @@
+#include <net/ingress_classifier.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+
+using llarp::IPRange;
+using llarp::net::IngressVerdict;
+
+namespace
+{
+  /// ipv4 udp packet between the two addresses
+  llarp::net::IPPacket
+  MakeUDPv4(std::array<byte_t, 4> src, std::array<byte_t, 4> dst)
+  {
+    std::array<byte_t, 28> raw{};
+    raw[0] = 0x45;
+    raw[9] = 17;
+    std::copy(src.begin(), src.end(), raw.begin() + 12);
+    std::copy(dst.begin(), dst.end(), raw.begin() + 16);
+    llarp::net::IPPacket pkt;
+    REQUIRE(pkt.Load(llarp_buffer_t(raw)));
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("IngressClassifier forwards local and routed traffic", "[IngressClassifier]")
+{
+  const auto ours = IPRange::FromIPv4(10, 0, 0, 1, 16);
+  llarp::net::IngressClassifier classifier;
+  classifier.Reset(
+      ours,
+      {ours, IPRange::FromIPv4(172, 16, 0, 1, 32)},
+      {IPRange::FromIPv4(0, 0, 0, 0, 0), IPRange::FromIPv4(8, 8, 0, 0, 16)});
+
+  CHECK(classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {10, 0, 3, 4})) == IngressVerdict::Forward);
+  // a mapped address in a bogon range is still ours
+  CHECK(classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {172, 16, 0, 1})) == IngressVerdict::Forward);
+  CHECK(classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {8, 8, 8, 8})) == IngressVerdict::Forward);
+  CHECK(classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {1, 1, 1, 1})) == IngressVerdict::Forward);
+  CHECK(
+      classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {192, 168, 1, 1}))
+      == IngressVerdict::Unreachable);
+
+  const auto status = classifier.ExtractStatus();
+  // the narrower routed range takes the match
+  CHECK(status["routed"]["8.8.0.0/16"] == 1);
+  CHECK(status["routed"]["0.0.0.0/0"] == 1);
+  CHECK(status["local"]["10.0.0.1/16"] == 1);
+  CHECK(status["bogon"] == 1);
+}
+
+TEST_CASE("IngressClassifier turns away what it cannot send", "[IngressClassifier]")
+{
+  const auto ours = IPRange::FromIPv4(10, 0, 0, 1, 16);
+  llarp::net::IngressClassifier classifier;
+  classifier.Reset(ours, {ours}, {});
+
+  CHECK(classifier.Classify(MakeUDPv4({10, 1, 0, 1}, {10, 0, 0, 2})) == IngressVerdict::Drop);
+  CHECK(classifier.Classify(MakeUDPv4({10, 0, 0, 1}, {1, 1, 1, 1})) == IngressVerdict::Unreachable);
+
+  llarp::net::IPPacket junk;
+  const std::array<byte_t, 4> raw{0x45, 0, 0, 4};
+  REQUIRE(junk.Load(llarp_buffer_t(raw)));
+  CHECK(classifier.Classify(junk) == IngressVerdict::Drop);
+
+  const auto status = classifier.ExtractStatus();
+  CHECK(status["spoofed"] == 1);
+  CHECK(status["unrouted"] == 1);
+  CHECK(status["malformed"] == 1);
+
+  // without a source range anything may come from the tun
+  classifier.Reset(std::nullopt, {ours}, {});
+  CHECK(classifier.Classify(MakeUDPv4({1, 1, 1, 1}, {10, 0, 0, 2})) == IngressVerdict::Forward);
+}
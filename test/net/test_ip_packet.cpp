@@ -0,0 +1,268 @@
+#include <net/ip_packet.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  /// minimal ipv4 udp packet from 10.0.0.1:1000 to 10.0.0.2:53
+  std::array<byte_t, 28>
+  MakeUDPv4()
+  {
+    std::array<byte_t, 28> pkt{};
+    pkt[0] = 0x45;
+    pkt[9] = 17;
+    pkt[12] = 10;
+    pkt[15] = 1;
+    pkt[16] = 10;
+    pkt[19] = 2;
+    pkt[20] = 1000 >> 8;
+    pkt[21] = 1000 & 0xff;
+    pkt[23] = 53;
+    return pkt;
+  }
+
+  /// the internet checksum the slow way, 16 bits at a time in network order
+  uint16_t
+  ReferenceChecksum(const byte_t* buf, size_t sz)
+  {
+    uint32_t sum = 0;
+    for (size_t idx = 0; idx + 1 < sz; idx += 2)
+      sum += (uint32_t{buf[idx]} << 8) | buf[idx + 1];
+    if (sz % 2)
+      sum += uint32_t{buf[sz - 1]} << 8;
+    while (sum >> 16)
+      sum = (sum & 0xFFff) + (sum >> 16);
+    return ~sum & 0xFFff;
+  }
+}  // namespace
+
+TEST_CASE("FlowHash is the same for every packet of a flow", "[IPPacket]")
+{
+  auto pkt = MakeUDPv4();
+  const auto hash = llarp::net::FlowHash(pkt.data(), pkt.size());
+  CHECK(hash != 0);
+  // payload and ttl don't matter
+  pkt[8] = 3;
+  CHECK(llarp::net::FlowHash(pkt.data(), pkt.size()) == hash);
+}
+
+TEST_CASE("FlowHash tells flows apart", "[IPPacket]")
+{
+  const auto base = MakeUDPv4();
+  const auto hash = llarp::net::FlowHash(base.data(), base.size());
+
+  auto otherPort = base;
+  otherPort[21]++;
+  CHECK(llarp::net::FlowHash(otherPort.data(), otherPort.size()) != hash);
+
+  auto otherDst = base;
+  otherDst[19]++;
+  CHECK(llarp::net::FlowHash(otherDst.data(), otherDst.size()) != hash);
+
+  auto otherProto = base;
+  otherProto[9] = 6;
+  CHECK(llarp::net::FlowHash(otherProto.data(), otherProto.size()) != hash);
+}
+
+TEST_CASE("FlowHash ignores ports on later fragments", "[IPPacket]")
+{
+  auto frag = MakeUDPv4();
+  frag[7] = 1;
+  const auto hash = llarp::net::FlowHash(frag.data(), frag.size());
+  frag[21]++;
+  CHECK(llarp::net::FlowHash(frag.data(), frag.size()) == hash);
+}
+
+TEST_CASE("FlowHash rejects runts", "[IPPacket]")
+{
+  const auto pkt = MakeUDPv4();
+  CHECK(llarp::net::FlowHash(pkt.data(), 0) == 0);
+  CHECK(llarp::net::FlowHash(pkt.data(), 19) == 0);
+  const byte_t v6[20] = {0x60};
+  CHECK(llarp::net::FlowHash(v6, sizeof(v6)) == 0);
+}
+
+TEST_CASE("IPChecksum matches the checksum done 16 bits at a time", "[IPPacket]")
+{
+  std::array<byte_t, 1501> data;
+  for (size_t idx = 0; idx < data.size(); ++idx)
+    data[idx] = (idx * 131 + 7) ^ (idx >> 3);
+  // every length through the word and tail paths, from even and odd offsets, and the mtu
+  for (const size_t offset : {0, 1, 3})
+  {
+    for (size_t sz = 0; sz <= 70; ++sz)
+    {
+      const uint16_t sum = llarp::net::IPChecksum(data.data() + offset, sz);
+      byte_t be[2];
+      std::memcpy(be, &sum, 2);
+      CHECK(((uint16_t{be[0]} << 8) | be[1]) == ReferenceChecksum(data.data() + offset, sz));
+    }
+  }
+  const uint16_t sum = llarp::net::IPChecksum(data.data(), 1500);
+  byte_t be[2];
+  std::memcpy(be, &sum, 2);
+  CHECK(((uint16_t{be[0]} << 8) | be[1]) == ReferenceChecksum(data.data(), 1500));
+}
+
+TEST_CASE("IPChecksum of a header with its checksum in is zero", "[IPPacket]")
+{
+  auto pkt = MakeUDPv4();
+  const uint16_t check = llarp::net::IPChecksum(pkt.data(), 20);
+  std::memcpy(pkt.data() + 10, &check, 2);
+  CHECK(llarp::net::IPChecksum(pkt.data(), 20) == 0);
+}
+
+namespace
+{
+  /// ipv4 tcp syn from 10.0.0.1 to 10.0.0.2 with an mss option of mss, after pad nops
+  std::vector<byte_t>
+  MakeSYNv4(uint16_t mss, size_t pad)
+  {
+    const size_t optSize = (pad + 4 + 3) / 4 * 4;
+    std::vector<byte_t> pkt(40 + optSize, 0);
+    pkt[0] = 0x45;
+    pkt[3] = pkt.size();
+    pkt[9] = 6;
+    pkt[12] = 10;
+    pkt[15] = 1;
+    pkt[16] = 10;
+    pkt[19] = 2;
+    byte_t* tcp = pkt.data() + 20;
+    tcp[12] = (20 + optSize) / 4 << 4;
+    tcp[13] = 0x02;
+    std::fill(tcp + 20, tcp + 20 + optSize, 1);
+    tcp[20 + pad] = 2;
+    tcp[21 + pad] = 4;
+    tcp[22 + pad] = mss >> 8;
+    tcp[23 + pad] = mss & 0xff;
+    return pkt;
+  }
+
+  /// tcp checksum of the segment in an ipv4 packet with its pseudo header
+  uint16_t
+  TCPChecksumV4(const byte_t* pkt, size_t sz)
+  {
+    std::vector<byte_t> data(pkt + 12, pkt + 20);
+    data.push_back(0);
+    data.push_back(6);
+    data.push_back((sz - 20) >> 8);
+    data.push_back((sz - 20) & 0xff);
+    data.insert(data.end(), pkt + 20, pkt + sz);
+    return llarp::net::IPChecksum(data.data(), data.size());
+  }
+}  // namespace
+
+TEST_CASE("ClampTCPMSS lowers a syn's mss to what fits", "[IPPacket]")
+{
+  // even and odd offsets for the option
+  for (const size_t pad : {0, 1, 3})
+  {
+    auto raw = MakeSYNv4(8960, pad);
+    const uint16_t check = TCPChecksumV4(raw.data(), raw.size());
+    std::memcpy(raw.data() + 36, &check, 2);
+    REQUIRE(TCPChecksumV4(raw.data(), raw.size()) == 0);
+
+    llarp::net::IPPacket pkt;
+    REQUIRE(pkt.Load(llarp_buffer_t(raw)));
+    REQUIRE(pkt.ClampTCPMSS());
+    const byte_t* opt = pkt.buf + 40 + pad;
+    CHECK(((uint16_t{opt[2]} << 8) | opt[3]) == llarp::net::IPPacket::MaxSize - 40);
+    CHECK(TCPChecksumV4(pkt.buf, pkt.sz) == 0);
+  }
+}
+
+TEST_CASE("ClampTCPMSS leaves small mss and non syns alone", "[IPPacket]")
+{
+  auto raw = MakeSYNv4(1200, 0);
+  llarp::net::IPPacket pkt;
+  REQUIRE(pkt.Load(llarp_buffer_t(raw)));
+  CHECK_FALSE(pkt.ClampTCPMSS());
+
+  raw = MakeSYNv4(8960, 0);
+  raw[20 + 13] = 0x10;
+  REQUIRE(pkt.Load(llarp_buffer_t(raw)));
+  CHECK_FALSE(pkt.ClampTCPMSS());
+}
+
+TEST_CASE("MarkCE marks ect packets and fixes the header checksum", "[IPPacket]")
+{
+  for (const byte_t ect : {1, 2})
+  {
+    auto pkt = MakeUDPv4();
+    pkt[1] = 0xb8 | ect;
+    const uint16_t check = llarp::net::IPChecksum(pkt.data(), 20);
+    std::memcpy(pkt.data() + 10, &check, 2);
+    REQUIRE(llarp::net::MarkCE(pkt.data(), pkt.size()));
+    CHECK(pkt[1] == 0xbb);
+    CHECK(llarp::net::IPChecksum(pkt.data(), 20) == 0);
+  }
+
+  std::array<byte_t, 40> v6{};
+  v6[0] = 0x60;
+  v6[1] = 0x10;
+  REQUIRE(llarp::net::MarkCE(v6.data(), v6.size()));
+  CHECK(v6[0] == 0x60);
+  CHECK(v6[1] == 0x30);
+}
+
+TEST_CASE("MarkCE leaves packets that are not ect alone", "[IPPacket]")
+{
+  auto pkt = MakeUDPv4();
+  pkt[1] = 0xb8;
+  const auto before = pkt;
+  CHECK_FALSE(llarp::net::MarkCE(pkt.data(), pkt.size()));
+  CHECK(pkt == before);
+
+  std::array<byte_t, 40> v6{};
+  v6[0] = 0x6b;
+  v6[1] = 0x80;
+  CHECK_FALSE(llarp::net::MarkCE(v6.data(), v6.size()));
+  CHECK(v6[1] == 0x80);
+  CHECK_FALSE(llarp::net::MarkCE(pkt.data(), 10));
+}
+
+TEST_CASE("IsInteractive picks out acks, dns and small packets", "[IPPacket]")
+{
+  // a full size tcp segment carrying data is bulk
+  std::vector<byte_t> data(1280, 0);
+  data[0] = 0x45;
+  data[9] = 6;
+  data[20 + 12] = 5 << 4;
+  CHECK_FALSE(llarp::net::IsInteractive(data.data(), data.size()));
+
+  // the same headers with no payload is an ack, however many options pad it out
+  auto ack = data;
+  ack[20 + 12] = 15 << 4;
+  CHECK(llarp::net::IsInteractive(ack.data(), 20 + 60));
+  CHECK(llarp::net::IsInteractive(data.data(), 40));
+
+  // udp is bulk unless it is to or from port 53
+  auto udp = data;
+  udp[9] = 17;
+  CHECK_FALSE(llarp::net::IsInteractive(udp.data(), udp.size()));
+  udp[23] = 53;
+  CHECK(llarp::net::IsInteractive(udp.data(), udp.size()));
+
+  // later fragments have no header to go by
+  udp[7] = 1;
+  CHECK_FALSE(llarp::net::IsInteractive(udp.data(), udp.size()));
+  CHECK(llarp::net::IsInteractive(udp.data(), llarp::net::InteractiveSize));
+}
+
+TEST_CASE("IsInteractive reads ipv6 headers", "[IPPacket]")
+{
+  std::vector<byte_t> pkt(1280, 0);
+  pkt[0] = 0x60;
+  pkt[6] = 6;
+  pkt[40 + 12] = 8 << 4;
+  CHECK_FALSE(llarp::net::IsInteractive(pkt.data(), pkt.size()));
+  CHECK(llarp::net::IsInteractive(pkt.data(), 40 + 32));
+  pkt[6] = 17;
+  pkt[41] = 53;
+  CHECK(llarp::net::IsInteractive(pkt.data(), pkt.size()));
+}
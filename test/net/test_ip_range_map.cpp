@@ -0,0 +1,58 @@
+#include <net/ip_range_map.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::IPRange;
+
+namespace
+{
+  IPRange
+  Range(std::string str)
+  {
+    IPRange range;
+    REQUIRE(range.FromString(std::move(str)));
+    return range;
+  }
+
+  llarp::huint128_t
+  IPv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    return llarp::net::ExpandV4(llarp::ipaddr_ipv4_bits(a, b, c, d));
+  }
+}  // namespace
+
+TEST_CASE("IPRangeMap finds every range holding an address", "[IPRangeMap]")
+{
+  llarp::net::IPRangeMap<std::string> map;
+  map.Insert(Range("10.0.0.0/8"), "wide");
+  map.Insert(Range("10.1.0.0/16"), "narrow");
+  map.Insert(Range("10.1.2.0/24"), "narrower");
+  map.Insert(Range("192.168.0.0/16"), "other");
+  map.Insert(Range("0.0.0.0/0"), "default");
+
+  const std::set<std::string> all{"default", "wide", "narrow", "narrower"};
+  REQUIRE(map.FindAll(IPv4(10, 1, 2, 3)) == all);
+  REQUIRE(map.FindAll(IPv4(10, 2, 0, 1)) == std::set<std::string>({"default", "wide"}));
+  REQUIRE(map.FindAll(IPv4(192, 168, 7, 7)) == std::set<std::string>({"default", "other"}));
+  REQUIRE(map.FindAll(IPv4(8, 8, 8, 8)) == std::set<std::string>{"default"});
+
+  REQUIRE(map.GetExact(Range("10.1.0.0/16")) == "narrow");
+  REQUIRE_FALSE(map.GetExact(Range("10.1.0.0/17")));
+  REQUIRE(map.ContainsValue("other"));
+}
+
+TEST_CASE("IPRangeMap forgets removed ranges", "[IPRangeMap]")
+{
+  llarp::net::IPRangeMap<std::string> map;
+  map.Insert(Range("10.0.0.0/8"), "wide");
+  map.Insert(Range("10.1.0.0/16"), "narrow");
+  map.RemoveIf([](const auto& entry) { return entry.second == "narrow"; });
+
+  REQUIRE(map.FindAll(IPv4(10, 1, 0, 1)) == std::set<std::string>{"wide"});
+  REQUIRE_FALSE(map.ContainsValue("narrow"));
+  REQUIRE_FALSE(map.GetExact(Range("10.1.0.0/16")));
+
+  map.RemoveIf([](const auto&) { return true; });
+  REQUIRE(map.Empty());
+  REQUIRE(map.FindAll(IPv4(10, 1, 0, 1)).empty());
+}
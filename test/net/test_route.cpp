@@ -0,0 +1,34 @@
+#include <net/route.hpp>
+
+#include <algorithm>
+
+#include <catch2/catch.hpp>
+
+using llarp::net::DiffRoutes;
+using llarp::net::RouteChange;
+using llarp::net::RouteMap_t;
+
+TEST_CASE("DiffRoutes moves routes that changed gateway only", "[net]")
+{
+  const RouteMap_t before{{"10.0.0.1", "192.168.1.1"}, {"10.0.0.2", "192.168.1.1"}};
+  const RouteMap_t after{{"10.0.0.1", "192.168.2.1"}, {"10.0.0.2", "192.168.1.1"}};
+
+  const auto changes = DiffRoutes(before, after);
+  REQUIRE(
+      changes
+      == std::vector<RouteChange>{
+          {"10.0.0.1", "192.168.1.1", false}, {"10.0.0.1", "192.168.2.1", true}});
+}
+
+TEST_CASE("DiffRoutes deletes before it adds", "[net]")
+{
+  const RouteMap_t before{{"10.0.0.1", "192.168.1.1"}, {"10.0.0.3", "192.168.1.1"}};
+  const RouteMap_t after{{"10.0.0.2", "192.168.1.1"}};
+
+  const auto changes = DiffRoutes(before, after);
+  REQUIRE(changes.size() == 3);
+  REQUIRE(std::is_partitioned(
+      changes.begin(), changes.end(), [](const auto& change) { return not change.add; }));
+  REQUIRE(changes.back() == RouteChange{"10.0.0.2", "192.168.1.1", true});
+  REQUIRE(DiffRoutes(after, after).empty());
+}
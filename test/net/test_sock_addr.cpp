@@ -1,4 +1,5 @@
 #include <util/mem.hpp>
+#include <net/endpoint_key.hpp>
 #include <net/sock_addr.hpp>
 #include <net/net_if.hpp>
 #include <util/logging/logger.hpp>
@@ -92,3 +93,20 @@ TEST_CASE("SockAddr from sockaddr_in6", "[SockAddr]")
 
   CHECK(addr.toString() == "127.0.0.1:53");
 }
+
+TEST_CASE("EndpointKey matches however the address was made", "[SockAddr]")
+{
+  sockaddr_in in{};
+  in.sin_family = AF_INET;
+  in.sin_addr.s_addr = htonl(0x01020304);
+  in.sin_port = htons(1090);
+  const llarp::EndpointKey fromRecv{llarp::SockAddr{in}};
+  // what sessions hand the link layer
+  const llarp::EndpointKey fromSession{llarp::IpAddress{"1.2.3.4:1090"}};
+  CHECK(fromRecv == fromSession);
+  CHECK(llarp::EndpointKey::Hash{}(fromRecv) == llarp::EndpointKey::Hash{}(fromSession));
+  CHECK(fromRecv.ToSockAddr().toString() == "1.2.3.4:1090");
+
+  CHECK(fromRecv != llarp::EndpointKey{llarp::SockAddr{1, 2, 3, 4, 1091}});
+  CHECK(fromRecv != llarp::EndpointKey{llarp::SockAddr{1, 2, 3, 5, 1090}});
+}
@@ -0,0 +1,230 @@
+#include <net/tun_offload.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  uint32_t
+  Sum(const byte_t* buf, size_t sz, uint32_t sum = 0)
+  {
+    for (size_t idx = 0; idx + 1 < sz; idx += 2)
+      sum += (uint32_t{buf[idx]} << 8) | buf[idx + 1];
+    if (sz % 2)
+      sum += uint32_t{buf[sz - 1]} << 8;
+    return sum;
+  }
+
+  bool
+  ChecksumOK(uint32_t sum)
+  {
+    while (sum >> 16)
+      sum = (sum & 0xffff) + (sum >> 16);
+    return sum == 0xffff;
+  }
+
+  bool
+  TCPChecksumOK(const byte_t* pkt, size_t sz)
+  {
+    const size_t tcplen = sz - 20;
+    const byte_t trailer[4] = {0, 6, byte_t(tcplen >> 8), byte_t(tcplen & 0xff)};
+    return ChecksumOK(Sum(pkt + 20, tcplen, Sum(trailer, 4, Sum(pkt + 12, 8))));
+  }
+
+  /// virtio header then an ipv4 tcp packet from 10.0.0.1:1000 to 10.0.0.2:80 with payloadsz
+  /// bytes of payload
+  std::vector<byte_t>
+  MakeTSOPacket(size_t payloadsz, uint16_t mss, byte_t tcpflags)
+  {
+    llarp::net::VirtioNetHdr hdr{};
+    hdr.flags = llarp::net::VirtioNetHdr::NeedsCsum;
+    hdr.gso_type = llarp::net::VirtioNetHdr::GSOTCPv4;
+    hdr.hdr_len = 40;
+    hdr.gso_size = mss;
+    hdr.csum_start = 20;
+    hdr.csum_offset = 16;
+    std::vector<byte_t> buf(sizeof(hdr) + 40 + payloadsz);
+    std::memcpy(buf.data(), &hdr, sizeof(hdr));
+    byte_t* ip = buf.data() + sizeof(hdr);
+    ip[0] = 0x45;
+    ip[4] = 0x12;
+    ip[5] = 0x34;
+    ip[8] = 64;
+    ip[9] = 6;
+    ip[12] = 10;
+    ip[15] = 1;
+    ip[16] = 10;
+    ip[19] = 2;
+    byte_t* tcp = ip + 20;
+    tcp[0] = 1000 >> 8;
+    tcp[1] = 1000 & 0xff;
+    tcp[3] = 80;
+    tcp[7] = 100;
+    tcp[12] = 5 << 4;
+    tcp[13] = tcpflags;
+    for (size_t idx = 0; idx < payloadsz; ++idx)
+      ip[40 + idx] = byte_t(idx);
+    return buf;
+  }
+}  // namespace
+
+TEST_CASE("Plain packets pass through with their checksum filled in", "[tun_offload]")
+{
+  auto buf = MakeTSOPacket(11, 0, 0x18);
+  llarp::net::VirtioNetHdr hdr;
+  std::memcpy(&hdr, buf.data(), sizeof(hdr));
+  hdr.gso_type = llarp::net::VirtioNetHdr::GSONone;
+  std::memcpy(buf.data(), &hdr, sizeof(hdr));
+  // what the kernel would leave behind, the folded pseudo header sum
+  byte_t* ip = buf.data() + sizeof(hdr);
+  const byte_t trailer[4] = {0, 6, 0, 31};
+  uint32_t pseudo = Sum(trailer, 4, Sum(ip + 12, 8));
+  while (pseudo >> 16)
+    pseudo = (pseudo & 0xffff) + (pseudo >> 16);
+  ip[36] = pseudo >> 8;
+  ip[37] = pseudo & 0xff;
+
+  std::vector<std::vector<byte_t>> pkts;
+  const auto visit = [&](const byte_t* ptr, size_t sz) { pkts.emplace_back(ptr, ptr + sz); };
+  REQUIRE(llarp::net::SplitOffloadedPacket(buf.data(), buf.size(), visit));
+  REQUIRE(pkts.size() == 1);
+  CHECK(pkts[0].size() == 51);
+  CHECK(TCPChecksumOK(pkts[0].data(), pkts[0].size()));
+}
+
+TEST_CASE("TSO super packets are cut into mss segments", "[tun_offload]")
+{
+  auto buf = MakeTSOPacket(2500, 1000, 0x80 | 0x18 | 0x01);
+  std::vector<std::vector<byte_t>> pkts;
+  const auto visit = [&](const byte_t* ptr, size_t sz) { pkts.emplace_back(ptr, ptr + sz); };
+  REQUIRE(llarp::net::SplitOffloadedPacket(buf.data(), buf.size(), visit));
+  REQUIRE(pkts.size() == 3);
+  CHECK(pkts[0].size() == 1040);
+  CHECK(pkts[1].size() == 1040);
+  CHECK(pkts[2].size() == 540);
+
+  for (size_t idx = 0; idx < pkts.size(); ++idx)
+  {
+    const auto& pkt = pkts[idx];
+    CHECK(((pkt[2] << 8) | pkt[3]) == int(pkt.size()));
+    CHECK(((pkt[4] << 8) | pkt[5]) == int(0x1234 + idx));
+    CHECK(ChecksumOK(Sum(pkt.data(), 20)));
+    CHECK(TCPChecksumOK(pkt.data(), pkt.size()));
+    const uint32_t seq = (pkt[24] << 24) | (pkt[25] << 16) | (pkt[26] << 8) | pkt[27];
+    CHECK(seq == 100 + idx * 1000);
+    // payload is carried over in order
+    CHECK(pkt[40] == byte_t(idx * 1000));
+  }
+  CHECK(pkts[0][33] == (0x80 | 0x10));
+  CHECK(pkts[1][33] == 0x10);
+  CHECK(pkts[2][33] == (0x10 | 0x08 | 0x01));
+}
+
+TEST_CASE("Offloaded packets we can't handle are refused", "[tun_offload]")
+{
+  std::vector<std::vector<byte_t>> pkts;
+  const auto visit = [&](const byte_t* ptr, size_t sz) { pkts.emplace_back(ptr, ptr + sz); };
+
+  auto udp = MakeTSOPacket(100, 50, 0);
+  udp[1] = 3;
+  CHECK_FALSE(llarp::net::SplitOffloadedPacket(udp.data(), udp.size(), visit));
+
+  auto huge = MakeTSOPacket(4000, 2000, 0);
+  CHECK_FALSE(llarp::net::SplitOffloadedPacket(huge.data(), huge.size(), visit));
+
+  auto runt = MakeTSOPacket(0, 1000, 0);
+  CHECK_FALSE(llarp::net::SplitOffloadedPacket(runt.data(), 20, visit));
+
+  CHECK(pkts.empty());
+}
+
+namespace
+{
+  /// cut a tso packet into segments the way the kernel would hand them to us without tso
+  std::vector<std::vector<byte_t>>
+  Segments(size_t payloadsz, uint16_t mss, byte_t tcpflags)
+  {
+    auto buf = MakeTSOPacket(payloadsz, mss, tcpflags);
+    std::vector<std::vector<byte_t>> pkts;
+    const auto visit = [&](const byte_t* ptr, size_t sz) { pkts.emplace_back(ptr, ptr + sz); };
+    REQUIRE(llarp::net::SplitOffloadedPacket(buf.data(), buf.size(), visit));
+    return pkts;
+  }
+
+  std::vector<llarp_tun_pkt>
+  Views(const std::vector<std::vector<byte_t>>& pkts)
+  {
+    std::vector<llarp_tun_pkt> views;
+    for (const auto& pkt : pkts)
+      views.emplace_back(llarp_tun_pkt{pkt.data(), pkt.size()});
+    return views;
+  }
+}  // namespace
+
+TEST_CASE("A stretch of one tcp stream coalesces and splits back the same", "[tun_offload]")
+{
+  const auto pkts = Segments(3500, 1000, 0x10 | 0x08);
+  REQUIRE(pkts.size() == 4);
+  const auto views = Views(pkts);
+  REQUIRE(llarp::net::CoalescableRun(views.data(), views.size()) == 4);
+
+  llarp::net::VirtioNetHdr vhdr;
+  byte_t header[llarp::net::MaxCoalescedHeaderSize];
+  const size_t hdrlen = llarp::net::MakeCoalescedHeader(views.data(), 4, vhdr, header);
+  REQUIRE(hdrlen == 40);
+  CHECK(vhdr.gso_type == llarp::net::VirtioNetHdr::GSOTCPv4);
+  CHECK(vhdr.gso_size == 1000);
+  CHECK(ChecksumOK(Sum(header, 20)));
+
+  // what the kernel would see, which it cuts up again just as we do on reads
+  std::vector<byte_t> super(sizeof(vhdr));
+  std::memcpy(super.data(), &vhdr, sizeof(vhdr));
+  super.insert(super.end(), header, header + hdrlen);
+  for (const auto& pkt : pkts)
+    super.insert(super.end(), pkt.begin() + hdrlen, pkt.end());
+  std::vector<std::vector<byte_t>> split;
+  const auto visit = [&](const byte_t* ptr, size_t sz) { split.emplace_back(ptr, ptr + sz); };
+  REQUIRE(llarp::net::SplitOffloadedPacket(super.data(), super.size(), visit));
+  CHECK(split == pkts);
+}
+
+TEST_CASE("Runs stop where the stream does", "[tun_offload]")
+{
+  SECTION("a push ends the run")
+  {
+    auto pkts = Segments(3000, 1000, 0x10);
+    pkts[1][33] |= 0x08;
+    const auto views = Views(pkts);
+    CHECK(llarp::net::CoalescableRun(views.data(), views.size()) == 2);
+  }
+  SECTION("a gap in sequence numbers")
+  {
+    auto pkts = Segments(3000, 1000, 0x10);
+    pkts.erase(pkts.begin() + 1);
+    const auto views = Views(pkts);
+    CHECK(llarp::net::CoalescableRun(views.data(), views.size()) == 1);
+  }
+  SECTION("another flow")
+  {
+    auto pkts = Segments(3000, 1000, 0x10);
+    pkts[2][19]++;
+    const auto views = Views(pkts);
+    CHECK(llarp::net::CoalescableRun(views.data(), views.size()) == 2);
+  }
+  SECTION("a different ack")
+  {
+    auto pkts = Segments(3000, 1000, 0x10);
+    pkts[1][31]++;
+    const auto views = Views(pkts);
+    CHECK(llarp::net::CoalescableRun(views.data(), views.size()) == 1);
+  }
+  SECTION("a syn never coalesces")
+  {
+    auto pkts = Segments(3000, 1000, 0x10);
+    pkts[0][33] = 0x02;
+    const auto views = Views(pkts);
+    CHECK(llarp::net::CoalescableRun(views.data(), views.size()) == 1);
+  }
+}
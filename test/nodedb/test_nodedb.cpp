@@ -4,6 +4,8 @@
 #include <router_contact.hpp>
 #include <nodedb.hpp>
 
+#include <test_util.hpp>
+
 TEST_CASE("FindClosestTo returns correct number of elements", "[nodedb][dht]")
 {
   llarp_nodedb nodeDB("", nullptr);
@@ -63,3 +65,60 @@ TEST_CASE("FindClosestTo returns properly ordered set", "[nodedb][dht]")
   REQUIRE(c.pubkey == results[0].pubkey);
   REQUIRE(b.pubkey == results[1].pubkey);
 }
+
+TEST_CASE("nodedb saves only what changed since the last save", "[nodedb]")
+{
+  const fs::path dir = llarp::test::randFilename();
+  fs::create_directory(dir);
+  llarp::test::FileGuard guard(dir);
+
+  llarp_nodedb nodeDB(dir.string(), nullptr);
+  REQUIRE(nodeDB.Load(dir) == 0);
+  REQUIRE_FALSE(nodeDB.HasUnsaved());
+
+  llarp::RouterContact a, b;
+  a.pubkey[0] = 1;
+  b.pubkey[0] = 2;
+  nodeDB.Insert(a);
+  nodeDB.Insert(b);
+  REQUIRE(nodeDB.HasUnsaved());
+  nodeDB.SaveAll();
+  REQUIRE_FALSE(nodeDB.HasUnsaved());
+  REQUIRE(nodeDB.store.Live() == 2);
+
+  // a save with nothing new in it appends nothing
+  const auto size = fs::file_size(dir / llarp::NodeDBStore::FileName);
+  nodeDB.SaveAll();
+  REQUIRE(fs::file_size(dir / llarp::NodeDBStore::FileName) == size);
+
+  nodeDB.Remove(a.pubkey);
+  REQUIRE(nodeDB.HasUnsaved());
+  nodeDB.SaveAll();
+  REQUIRE_FALSE(nodeDB.HasUnsaved());
+  REQUIRE(nodeDB.store.Live() == 1);
+}
+
+TEST_CASE("nodedb shares its rcs instead of copying them", "[nodedb]")
+{
+  llarp_nodedb nodeDB("", nullptr);
+  llarp::RouterContact rc;
+  rc.pubkey[0] = 1;
+  rc.last_updated = 1s;
+  nodeDB.Insert(rc);
+
+  const auto shared = nodeDB.GetShared(rc.pubkey);
+  REQUIRE(shared != nullptr);
+  REQUIRE(shared->pubkey == rc.pubkey);
+  REQUIRE(nodeDB.GetShared(rc.pubkey) == shared);
+  const auto closest = nodeDB.FindClosestShared(llarp::dht::Key_t{rc.pubkey}, 4);
+  REQUIRE(closest.size() == 1);
+  REQUIRE(closest.front() == shared);
+
+  // an update replaces the entry and leaves the one handed out as it was
+  rc.last_updated = 2s;
+  nodeDB.Insert(rc);
+  REQUIRE(nodeDB.GetShared(rc.pubkey) != shared);
+  REQUIRE(nodeDB.GetShared(rc.pubkey)->last_updated == 2s);
+  REQUIRE(shared->last_updated == 1s);
+  REQUIRE(nodeDB.GetShared(llarp::RouterID{}) == nullptr);
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch.hpp>
+
+#include <nodedb_store.hpp>
+#include <router_contact.hpp>
+
+#include <test_util.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+using llarp::NodeDBStore;
+using llarp::RouterContact;
+
+namespace
+{
+  RouterContact
+  MakeRC(byte_t id, llarp_time_t updated = 1s)
+  {
+    RouterContact rc;
+    rc.pubkey[0] = id;
+    rc.last_updated = updated;
+    return rc;
+  }
+
+  std::vector<RouterContact>
+  Reopen(const fs::path& file)
+  {
+    NodeDBStore store;
+    std::vector<RouterContact> rcs;
+    REQUIRE(store.Open(file, rcs));
+    std::sort(rcs.begin(), rcs.end(), [](const auto& left, const auto& right) {
+      return left.pubkey < right.pubkey;
+    });
+    return rcs;
+  }
+}  // namespace
+
+TEST_CASE("NodeDBStore keeps what was appended", "[nodedb]")
+{
+  const fs::path dir = llarp::test::randFilename();
+  fs::create_directory(dir);
+  llarp::test::FileGuard guard(dir);
+  const fs::path file = dir / NodeDBStore::FileName;
+
+  NodeDBStore store;
+  std::vector<RouterContact> rcs;
+  REQUIRE_FALSE(store.Open(file, rcs));
+  REQUIRE(store.Append({MakeRC(1), MakeRC(2), MakeRC(3)}, {}));
+
+  auto loaded = Reopen(file);
+  REQUIRE(loaded.size() == 3);
+  REQUIRE(loaded[0].pubkey == MakeRC(1).pubkey);
+  REQUIRE(loaded[2].pubkey == MakeRC(3).pubkey);
+
+  SECTION("newer records win and tombstones remove")
+  {
+    REQUIRE(store.Append({MakeRC(2, 5s)}, {MakeRC(3).pubkey}));
+    REQUIRE(store.Live() == 2);
+    REQUIRE(store.DeadBytes() > 0);
+    loaded = Reopen(file);
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded[1].pubkey == MakeRC(2).pubkey);
+    REQUIRE(loaded[1].last_updated == 5s);
+  }
+
+  SECTION("decoding in batches reads the same rcs")
+  {
+    size_t split = 0;
+    const auto batches = [&split](size_t num, const auto& batch) {
+      // one index a thread, the most split up it can be
+      std::vector<std::thread> threads;
+      for (size_t idx = 0; idx < num; ++idx)
+        threads.emplace_back([&batch, idx]() { batch(idx, idx + 1); });
+      for (auto& thread : threads)
+        thread.join();
+      split = num;
+    };
+    NodeDBStore batched;
+    rcs.clear();
+    REQUIRE(batched.Open(file, rcs, batches));
+    REQUIRE(split == 3);
+    REQUIRE(rcs.size() == 3);
+    REQUIRE(batched.Live() == 3);
+  }
+
+  SECTION("a record cut short is dropped and written over")
+  {
+    {
+      std::ofstream out(file.string(), std::ios::binary | std::ios::app);
+      out.write("\x00\x00\x01\x00partial", 11);
+    }
+    REQUIRE(store.Open(file, rcs));
+    REQUIRE(store.Live() == 3);
+    REQUIRE(store.Append({MakeRC(4)}, {}));
+    REQUIRE(Reopen(file).size() == 4);
+  }
+
+  SECTION("compaction leaves only live records")
+  {
+    // replace one rc until the dead records outweigh the live ones enough to compact
+    int round = 0;
+    size_t dead = 0;
+    do
+    {
+      REQUIRE(++round < 10000);
+      dead = store.DeadBytes();
+      REQUIRE(store.Append({MakeRC(1, llarp_time_t{round})}, {}));
+    } while (store.DeadBytes() > dead);
+    REQUIRE(store.DeadBytes() == 0);
+    REQUIRE(fs::file_size(file) < NodeDBStore::MinCompactBytes);
+    loaded = Reopen(file);
+    REQUIRE(loaded.size() == 3);
+    REQUIRE(loaded[0].last_updated == llarp_time_t{round});
+  }
+}
+
+TEST_CASE("NodeDBStore rewrite replaces everything", "[nodedb]")
+{
+  const fs::path dir = llarp::test::randFilename();
+  fs::create_directory(dir);
+  llarp::test::FileGuard guard(dir);
+  const fs::path file = dir / NodeDBStore::FileName;
+  {
+    std::ofstream out(file.string(), std::ios::binary);
+    out << "not a nodedb";
+  }
+
+  NodeDBStore store;
+  std::vector<RouterContact> rcs;
+  REQUIRE_FALSE(store.Open(file, rcs));
+  REQUIRE(store.Rewrite({MakeRC(7), MakeRC(8)}));
+  REQUIRE(Reopen(file).size() == 2);
+}
@@ -0,0 +1,47 @@
+#include <path/build_time.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::path::BuildTimeEstimator;
+
+TEST_CASE("BuildTimeEstimator falls back to the fixed timeout", "[path]")
+{
+  BuildTimeEstimator times;
+  REQUIRE(not times.HasHistory());
+  CHECK(times.Timeout(4, std::nullopt, 0) == llarp::path::build_timeout);
+  CHECK(times.LateAfter(llarp::path::build_timeout) == llarp::path::build_timeout / 2);
+}
+
+TEST_CASE("BuildTimeEstimator scales the first hop's rtt over every hop", "[path]")
+{
+  BuildTimeEstimator times;
+  // 4 hops of 2 * 400ms + 500ms
+  CHECK(times.Timeout(4, 400ms, 0) == 5200ms);
+  // never under the floor, however close the first hop is
+  CHECK(times.Timeout(4, 10ms, 0) == BuildTimeEstimator::MinTimeout);
+  // hops we know nothing of get more time
+  CHECK(times.Timeout(4, 400ms, 2) == 7200ms);
+  // and never over the fixed timeout
+  CHECK(times.Timeout(4, 10s, 0) == llarp::path::build_timeout);
+}
+
+TEST_CASE("BuildTimeEstimator follows the builds it saw", "[path]")
+{
+  BuildTimeEstimator times;
+  for (int idx = 0; idx < 50; ++idx)
+    times.Observe(2s);
+  REQUIRE(times.HasHistory());
+  // steady builds leave little variance, so the timeout closes in on them
+  const auto steady = times.Timeout(4, std::nullopt, 0);
+  CHECK(steady >= 2s);
+  CHECK(steady < 3500ms);
+  CHECK(times.LateAfter(steady) <= steady / 2);
+
+  // a slow first hop still stretches it
+  CHECK(times.Timeout(4, 1s, 0) == 10s);
+
+  // jittery builds widen it
+  for (int idx = 0; idx < 10; ++idx)
+    times.Observe(idx % 2 ? 1s : 5s);
+  CHECK(times.Timeout(4, std::nullopt, 0) > steady);
+}
@@ -0,0 +1,29 @@
+#include <path/latency_probe.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace std::chrono_literals;
+using llarp::path::ProbeTimedOut;
+using llarp::path::ShouldProbeLatency;
+
+TEST_CASE("Busy paths are probed once their rtt is stale", "[path][latency]")
+{
+  const llarp_time_t now = 1000s;
+  CHECK(not ShouldProbeLatency(now, now - 1s, now - 10s));
+  CHECK(ShouldProbeLatency(now, now - 1s, now - 21s));
+}
+
+TEST_CASE("Idle paths are probed rarely", "[path][latency]")
+{
+  const llarp_time_t now = 1000s;
+  CHECK(not ShouldProbeLatency(now, now - 30s, now - 30s));
+  CHECK(not ShouldProbeLatency(now, now - 59s, now - 59s));
+  CHECK(ShouldProbeLatency(now, now - 61s, now - 61s));
+}
+
+TEST_CASE("Probes time out", "[path][latency]")
+{
+  const llarp_time_t now = 1000s;
+  CHECK(not ProbeTimedOut(now, now - 5s));
+  CHECK(ProbeTimedOut(now, now - 10s));
+}
@@ -0,0 +1,51 @@
+#include <path/relay_load.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::path::MaxRelayLoad;
+using llarp::path::RelayLoads;
+using llarp::path::ToRelayLoad;
+
+TEST_CASE("Relay load levels from queue fill", "[path]")
+{
+  CHECK(ToRelayLoad(0.0) == 0);
+  CHECK(ToRelayLoad(-1.0) == 0);
+  CHECK(ToRelayLoad(0.1) == 0);
+  CHECK(ToRelayLoad(0.5) == 4);
+  CHECK(ToRelayLoad(0.99) == MaxRelayLoad);
+  CHECK(ToRelayLoad(1.0) == MaxRelayLoad);
+  CHECK(ToRelayLoad(5.0) == MaxRelayLoad);
+}
+
+TEST_CASE("Relay load reports weight hop choice and expire", "[path]")
+{
+  RelayLoads loads;
+  llarp::RouterID idle, busy, unknown;
+  idle.Randomize();
+  busy.Randomize();
+  unknown.Randomize();
+  const llarp_time_t now = 1h;
+  loads.Put(idle, 0, now);
+  loads.Put(busy, MaxRelayLoad, now);
+
+  CHECK(loads.Get(busy, now) == MaxRelayLoad);
+  CHECK(not loads.Get(unknown, now));
+
+  size_t idleKept = 0, busyKept = 0, unknownKept = 0;
+  for (uint64_t random = 0; random < 800; ++random)
+  {
+    idleKept += loads.Accept(idle, now, random);
+    busyKept += loads.Accept(busy, now, random);
+    unknownKept += loads.Accept(unknown, now, random);
+  }
+  CHECK(idleKept == 800);
+  CHECK(unknownKept == 800);
+  // passed over most of the time but never left out
+  CHECK(busyKept == 100);
+
+  const auto later = now + RelayLoads::ReportLifetime;
+  CHECK(not loads.Get(busy, later));
+  CHECK(loads.Accept(busy, later, 0));
+  loads.Expire(later);
+  CHECK(loads.ExtractStatus()["reports"] == 0);
+}
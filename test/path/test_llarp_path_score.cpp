@@ -0,0 +1,71 @@
+#include <path/path_score.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::path::PathScore;
+
+TEST_CASE("PathScore smooths latency", "[path][score]")
+{
+  PathScore score;
+  REQUIRE(not score.HasLatency());
+  REQUIRE(score.Cost() == Approx(PathScore::UnknownLatency));
+  score.AddLatencySample(100ms);
+  REQUIRE(score.Latency() == Approx(100));
+  score.AddLatencySample(900ms);
+  REQUIRE(score.Latency() == Approx(200));
+  REQUIRE(score.Cost() == Approx(200));
+}
+
+TEST_CASE("PathScore penalizes loss", "[path][score]")
+{
+  PathScore lossy, clean;
+  lossy.AddLatencySample(100ms);
+  clean.AddLatencySample(100ms);
+  for (int tick = 1; tick <= 50; ++tick)
+  {
+    for (int idx = 0; idx < 10; ++idx)
+    {
+      lossy.AddSent();
+      clean.AddSent();
+    }
+    for (int idx = 0; idx < 8; ++idx)
+      lossy.AddDrop();
+    lossy.Tick(tick * 1s, 0);
+    clean.Tick(tick * 1s, 0);
+  }
+  REQUIRE(clean.Loss() == Approx(0));
+  REQUIRE(lossy.Loss() > 0.7);
+  REQUIRE(lossy.Cost() > clean.Cost() * 5);
+  REQUIRE(lossy.ShouldRetire());
+  REQUIRE(not clean.ShouldRetire());
+}
+
+TEST_CASE("PathScore does not retire on a few early drops", "[path][score]")
+{
+  PathScore score;
+  score.AddLatencySample(100ms);
+  for (int tick = 1; tick <= 20; ++tick)
+  {
+    score.AddSent();
+    score.AddDrop();
+    score.Tick(tick * 1s, 0);
+  }
+  REQUIRE(score.Loss() > PathScore::RetireLoss);
+  REQUIRE(not score.ShouldRetire());
+}
+
+TEST_CASE("PathScore favours proven throughput", "[path][score]")
+{
+  PathScore bulk, idle;
+  bulk.AddLatencySample(100ms);
+  idle.AddLatencySample(100ms);
+  for (int tick = 1; tick <= 100; ++tick)
+  {
+    bulk.Tick(tick * 1s, 1024 * 1024);
+    idle.Tick(tick * 1s, 0);
+  }
+  REQUIRE(bulk.Throughput() > PathScore::GoodThroughput);
+  REQUIRE(bulk.Cost() < idle.Cost());
+  // never more than half off
+  REQUIRE(bulk.Cost() >= idle.Cost() / 2);
+}
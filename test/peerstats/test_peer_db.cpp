@@ -215,3 +215,40 @@ TEST_CASE("Test PeerDb handleGossipedRC expiry calcs", "[PeerDb]")
   CHECK(stats3->numDistinctRCsReceived == 3);
   CHECK(stats3->lastRCUpdated == s3);
 }
+
+TEST_CASE("Test PeerDb flushes every shard in one batch", "[PeerDb]")
+{
+  const std::string filename = "/tmp/peerdb_test_tmp3.db.sqlite";
+  constexpr size_t numPeers = llarp::PeerDb::NumShards * 4;
+
+  {
+    llarp::PeerDb db;
+    db.loadDatabase(filename);
+
+    for (size_t i = 0; i < numPeers; ++i)
+    {
+      const llarp::RouterID id = llarp::test::makeBuf<llarp::RouterID>(0x10 + i);
+      db.modifyPeerStats(id, [i](llarp::PeerStats& stats) { stats.numPathBuilds = i + 1; });
+    }
+    CHECK(db.listAllPeerStats().size() == numPeers);
+
+    db.flushDatabase();
+  }
+
+  {
+    llarp::PeerDb db;
+    db.loadDatabase(filename);
+
+    auto all = db.listAllPeerStats();
+    CHECK(all.size() == numPeers);
+    for (const auto& stats : all)
+      CHECK(not stats.stale);
+
+    const llarp::RouterID id = llarp::test::makeBuf<llarp::RouterID>(0x10 + 7);
+    auto stats = db.getCurrentPeerStats(id);
+    CHECK(stats.has_value());
+    CHECK(stats->numPathBuilds == 8);
+  }
+
+  fs::remove(filename);
+}
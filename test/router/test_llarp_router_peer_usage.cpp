@@ -0,0 +1,58 @@
+#include <router/peer_usage.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace std::chrono_literals;
+
+static llarp::RouterID
+MakeID(byte_t b)
+{
+  llarp::RouterID id;
+  id.Fill(b);
+  return id;
+}
+
+TEST_CASE("PeerUsage ranks peers by recent use", "[router][peerusage]")
+{
+  llarp::PeerUsage usage;
+  const auto a = MakeID(1);
+  const auto b = MakeID(2);
+  const auto c = MakeID(3);
+  usage.Use(a, 0s);
+  usage.Use(b, 0s);
+  usage.Use(b, 1s);
+  usage.Use(c, 0s);
+  usage.Use(c, 1s);
+  usage.Use(c, 2s);
+
+  auto busiest = usage.Busiest(2, 2s);
+  REQUIRE(busiest.size() == 2);
+  REQUIRE(busiest[0] == c);
+  REQUIRE(busiest[1] == b);
+  REQUIRE(usage.Busiest(10, 2s).size() == 3);
+
+  // much later use of a outweighs old use of the others
+  const auto later = llarp::PeerUsage::HalfLife * 3;
+  usage.Use(a, later);
+  busiest = usage.Busiest(1, later);
+  REQUIRE(busiest.size() == 1);
+  REQUIRE(busiest[0] == a);
+}
+
+TEST_CASE("PeerUsage forgets idle peers", "[router][peerusage]")
+{
+  llarp::PeerUsage usage;
+  const auto a = MakeID(1);
+  const auto b = MakeID(2);
+  usage.Use(a, 0s);
+  usage.Use(b, llarp::PeerUsage::HalfLife);
+
+  // a single use stays busy for one half life
+  REQUIRE(usage.Busiest(10, llarp::PeerUsage::HalfLife).size() == 2);
+  const auto idleA = llarp::PeerUsage::HalfLife + 1s;
+  REQUIRE(usage.Busiest(10, idleA) == std::vector<llarp::RouterID>{b});
+  usage.Decay(idleA);
+  REQUIRE(usage.Size() == 1);
+  usage.Decay(llarp::PeerUsage::HalfLife * 3);
+  REQUIRE(usage.Size() == 0);
+}
@@ -0,0 +1,52 @@
+#include <profiling.hpp>
+#include <test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::Profiling;
+using llarp::RouterID;
+
+TEST_CASE("Profiling marks routers bad for paths after enough hop fails", "[router]")
+{
+  Profiling profiling;
+  const RouterID bad = llarp::test::makeBuf<RouterID>(0x01);
+  const RouterID good = llarp::test::makeBuf<RouterID>(0x02);
+
+  CHECK(not profiling.IsBadForPath(bad));
+  for (int i = 0; i < 8; ++i)
+    profiling.MarkHopFail(bad);
+  CHECK(profiling.IsBadForPath(bad));
+  CHECK(not profiling.IsBadForPath(good));
+
+  profiling.Disable();
+  CHECK(not profiling.IsBadForPath(bad));
+  profiling.Enable();
+
+  profiling.ClearProfile(bad);
+  CHECK(not profiling.IsBadForPath(bad));
+}
+
+TEST_CASE("Profiling saves only what changed and loads it all back", "[router]")
+{
+  const std::string filename = "/tmp/profiling_test_tmp.dat";
+  llarp::test::FileGuard guard(filename);
+  constexpr size_t numRouters = Profiling::NumShards * 3;
+
+  {
+    Profiling profiling;
+    for (size_t i = 0; i < numRouters; ++i)
+      profiling.MarkConnectSuccess(llarp::test::makeBuf<RouterID>(0x10 + i));
+    REQUIRE(profiling.Save(filename.c_str()));
+
+    // one shard changes, the rest are written from what was encoded before
+    for (int i = 0; i < 8; ++i)
+      profiling.MarkHopFail(llarp::test::makeBuf<RouterID>(0x10));
+    REQUIRE(profiling.Save(filename.c_str()));
+  }
+
+  Profiling loaded;
+  REQUIRE(loaded.Load(filename.c_str()));
+  CHECK(loaded.IsBadForPath(llarp::test::makeBuf<RouterID>(0x10)));
+  for (size_t i = 1; i < numRouters; ++i)
+    CHECK(not loaded.IsBadForPath(llarp::test::makeBuf<RouterID>(0x10 + i)));
+}
@@ -0,0 +1,70 @@
+#include <router/rc_digest.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::RCDigest;
+using llarp::RouterContact;
+
+namespace
+{
+  RouterContact
+  MakeRC(uint32_t id, llarp_time_t updated)
+  {
+    RouterContact rc;
+    rc.Clear();
+    rc.pubkey.Zero();
+    for (size_t idx = 0; idx < 4; ++idx)
+      rc.pubkey[idx * 5] = (id >> (idx * 8)) & 0xff;
+    rc.last_updated = updated;
+    return rc;
+  }
+}  // namespace
+
+TEST_CASE("RC digest has what was added and not newer copies", "[router]")
+{
+  RCDigest digest(100, 42);
+  REQUIRE(digest.IsValid());
+  for (uint32_t id = 0; id < 100; ++id)
+    digest.Add(MakeRC(id, 1000ms));
+
+  for (uint32_t id = 0; id < 100; ++id)
+    REQUIRE(digest.Contains(MakeRC(id, 1000ms)));
+
+  size_t newer = 0;
+  size_t missing = 0;
+  for (uint32_t id = 0; id < 1000; ++id)
+  {
+    newer += digest.Contains(MakeRC(id, 2000ms));
+    missing += digest.Contains(MakeRC(id + 1000, 1000ms));
+  }
+  // about 1% of each by chance
+  REQUIRE(newer < 40);
+  REQUIRE(missing < 40);
+}
+
+TEST_CASE("RC digest hashes the same for the same seed", "[router]")
+{
+  RCDigest ours(50, 7);
+  RCDigest theirs(50, 7);
+  for (uint32_t id = 0; id < 50; ++id)
+    ours.Add(MakeRC(id, 5000ms));
+  theirs.bits = ours.bits;
+  for (uint32_t id = 0; id < 50; ++id)
+    REQUIRE(theirs.Contains(MakeRC(id, 5000ms)));
+}
+
+TEST_CASE("RC digest size is capped", "[router]")
+{
+  RCDigest small(0, 1);
+  REQUIRE(small.IsValid());
+  RCDigest huge(10'000'000, 1);
+  REQUIRE(huge.bits.size() == RCDigest::MaxBytes);
+  REQUIRE(huge.IsValid());
+
+  RCDigest bad;
+  REQUIRE_FALSE(bad.IsValid());
+  REQUIRE_FALSE(bad.Contains(MakeRC(1, 1ms)));
+  bad.bits.resize(RCDigest::MaxBytes + 1);
+  bad.hashes = 3;
+  REQUIRE_FALSE(bad.IsValid());
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <routing/transfer_traffic_message.hpp>
 
+#include <array>
+
 using TransferTrafficMessage = llarp::routing::TransferTrafficMessage;
 
 class TransferTrafficTest : public ::testing::Test
@@ -22,3 +24,41 @@ TEST_F(TransferTrafficTest, TestPutBuffer)
   llarp_buffer_t buf(tmp);
   ASSERT_TRUE(msg.PutBuffer(buf, 1));
 }
+
+TEST_F(TransferTrafficTest, TestDecodeKeepsViews)
+{
+  TransferTrafficMessage msg;
+  std::array< byte_t, 64 > pkt;
+  pkt.fill(0x42);
+  ASSERT_TRUE(msg.PutBuffer(llarp_buffer_t(pkt), 7));
+
+  std::array< byte_t, 256 > tmp;
+  llarp_buffer_t buf(tmp);
+  ASSERT_TRUE(msg.BEncode(&buf));
+  buf.sz  = buf.cur - buf.base;
+  buf.cur = buf.base;
+
+  // the message type key is taken by the routing message parser
+  TransferTrafficMessage decoded;
+  ASSERT_TRUE(llarp::bencode_read_dict(
+      [&](llarp_buffer_t* val, llarp_buffer_t* key) {
+        if(key == nullptr)
+          return true;
+        if(*key == "A")
+          return bencode_discard(val);
+        return decoded.DecodeKey(*key, val);
+      },
+      &buf));
+  ASSERT_TRUE(decoded.X.empty());
+  ASSERT_EQ(decoded.XView.size(), 1u);
+  // the packet was not copied out of the buffer it came in
+  ASSERT_GE(decoded.XView[0].data(), tmp.data());
+  ASSERT_LT(decoded.XView[0].data(), tmp.data() + tmp.size());
+
+  size_t packets = 0;
+  decoded.ForEachPacket([&](const llarp_buffer_t& b) {
+    ++packets;
+    return b.sz == pkt.size() + 8;
+  });
+  ASSERT_EQ(packets, 1u);
+}
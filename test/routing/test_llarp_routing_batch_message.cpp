@@ -0,0 +1,117 @@
+#include <routing/batch_message.hpp>
+
+#include <util/bencode.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::routing::BatchMessage;
+using llarp::routing::MessageBatcher;
+
+namespace
+{
+  std::string
+  View(const llarp_buffer_t& buf)
+  {
+    return std::string(reinterpret_cast<const char*>(buf.base), buf.sz);
+  }
+}  // namespace
+
+TEST_CASE("MessageBatcher only batches once enabled", "[routing]")
+{
+  MessageBatcher batcher;
+  const std::string msg = "d1:A1:Le";
+  llarp_buffer_t buf(msg);
+  REQUIRE_FALSE(batcher.Batchable(buf));
+  REQUIRE_FALSE(batcher.Add(buf, 1s));
+  REQUIRE(batcher.Empty());
+
+  batcher.enabled = true;
+  REQUIRE(batcher.Batchable(buf));
+  REQUIRE(batcher.Add(buf, 1s));
+  REQUIRE_FALSE(batcher.Empty());
+  REQUIRE(batcher.Started() == 1s);
+}
+
+TEST_CASE("MessageBatcher keeps big messages out", "[routing]")
+{
+  MessageBatcher batcher;
+  batcher.enabled = true;
+  const std::string big(MessageBatcher::MaxItemSize + 1, 'x');
+  llarp_buffer_t buf(big);
+  REQUIRE_FALSE(batcher.Batchable(buf));
+  REQUIRE_FALSE(batcher.Add(buf, 1s));
+}
+
+TEST_CASE("MessageBatcher refuses to overflow a batch", "[routing]")
+{
+  MessageBatcher batcher;
+  batcher.enabled = true;
+  const std::string item(MessageBatcher::MaxItemSize, 'x');
+  llarp_buffer_t buf(item);
+  size_t added = 0;
+  while (batcher.Add(buf, 1s))
+    added++;
+  REQUIRE(added == MessageBatcher::MaxBatchSize / MessageBatcher::MaxItemSize);
+
+  BatchMessage batch;
+  batcher.Take(batch);
+  REQUIRE(batch.M.size() == added);
+  REQUIRE(batcher.Empty());
+  REQUIRE(batcher.Batched() == added);
+  REQUIRE(batcher.Batches() == 1);
+
+  // room again once taken, and the new batch starts from when it is added to
+  REQUIRE(batcher.Add(buf, 2s));
+  REQUIRE(batcher.Started() == 2s);
+}
+
+TEST_CASE("BatchMessage round trips its messages in order", "[routing]")
+{
+  MessageBatcher batcher;
+  batcher.enabled = true;
+  const std::vector<std::string> msgs{"d1:A1:Le", "d1:A1:Se", "d1:A1:Ze"};
+  for (const auto& msg : msgs)
+  {
+    llarp_buffer_t buf(msg);
+    REQUIRE(batcher.Add(buf, 1s));
+  }
+  BatchMessage out;
+  batcher.Take(out);
+  out.S = 7;
+
+  std::array<byte_t, 256> tmp;
+  llarp_buffer_t buf(tmp);
+  REQUIRE(out.BEncode(&buf));
+  buf.sz = buf.cur - buf.base;
+  buf.cur = buf.base;
+
+  // the message type is read by the parser, the message itself decodes the rest
+  BatchMessage in;
+  std::string type;
+  const bool decoded = llarp::bencode_read_dict(
+      [&](llarp_buffer_t* buffer, llarp_buffer_t* key) {
+        if (key == nullptr)
+          return true;
+        if (*key == "A")
+        {
+          llarp_buffer_t strbuf;
+          if (not bencode_read_string(buffer, &strbuf))
+            return false;
+          type = View(strbuf);
+          return true;
+        }
+        return in.DecodeKey(*key, buffer);
+      },
+      &buf);
+  REQUIRE(decoded);
+  REQUIRE(type == "B");
+  REQUIRE(in.S == 7);
+  REQUIRE(in.version == LLARP_PROTO_VERSION);
+  REQUIRE(in.M.size() == msgs.size());
+  for (size_t idx = 0; idx < msgs.size(); ++idx)
+    REQUIRE(in.M[idx] == msgs[idx]);
+}
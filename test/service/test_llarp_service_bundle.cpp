@@ -0,0 +1,57 @@
+#include <service/bundle.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using llarp::service::Bundle;
+
+TEST_CASE("bundle packs packets and gives them back in order", "[service]")
+{
+  const std::vector<byte_t> first{0x45, 1, 2, 3};
+  const std::vector<byte_t> second(200, 0x60);
+  std::vector<byte_t> bundle;
+  Bundle::Append(bundle, llarp::service::eProtocolTrafficV4, first.data(), first.size());
+  Bundle::Append(bundle, llarp::service::eProtocolTrafficV6, second.data(), second.size());
+  CHECK(bundle.size() == 2 * Bundle::ItemHeaderSize + first.size() + second.size());
+
+  std::vector<std::pair<llarp::service::ProtocolType, std::vector<byte_t>>> got;
+  CHECK(Bundle::ForEach(bundle, [&](auto proto, const byte_t* data, size_t sz) {
+    got.emplace_back(proto, std::vector<byte_t>(data, data + sz));
+  }));
+  REQUIRE(got.size() == 2);
+  CHECK(got[0].first == llarp::service::eProtocolTrafficV4);
+  CHECK(got[0].second == first);
+  CHECK(got[1].first == llarp::service::eProtocolTrafficV6);
+  CHECK(got[1].second == second);
+}
+
+TEST_CASE("bundle turns away cut short and foreign contents", "[service]")
+{
+  const std::vector<byte_t> pkt(10, 0x45);
+  std::vector<byte_t> bundle;
+  Bundle::Append(bundle, llarp::service::eProtocolExit, pkt.data(), pkt.size());
+  Bundle::Append(bundle, llarp::service::eProtocolTrafficV4, pkt.data(), pkt.size());
+
+  auto cut = bundle;
+  cut.pop_back();
+  size_t visited = 0;
+  const auto count = [&](auto, const byte_t*, size_t) { ++visited; };
+  CHECK_FALSE(Bundle::ForEach(cut, count));
+  CHECK(visited == 1);
+
+  // a control message has no place in a bundle
+  auto control = bundle;
+  control[0] = llarp::service::eProtocolControl;
+  visited = 0;
+  CHECK_FALSE(Bundle::ForEach(control, count));
+  CHECK(visited == 0);
+}
+
+TEST_CASE("bundle fits no more than its size", "[service]")
+{
+  CHECK(Bundle::Fits(0, Bundle::MaxSize - Bundle::ItemHeaderSize));
+  CHECK_FALSE(Bundle::Fits(0, Bundle::MaxSize));
+  CHECK(Bundle::Fits(1000, 400));
+  CHECK_FALSE(Bundle::Fits(1000, 500));
+}
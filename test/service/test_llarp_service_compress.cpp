@@ -0,0 +1,132 @@
+#include <service/compress.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+
+using llarp::service::Compression;
+using llarp::service::CompressionGate;
+
+namespace
+{
+  llarp::util::PooledVector<byte_t>
+  Page()
+  {
+    std::string text;
+    for (int idx = 0; text.size() < 1200; ++idx)
+      text += "{\"id\":" + std::to_string(idx) + ",\"name\":\"item\",\"tags\":[\"a\",\"b\"]},";
+    return {text.begin(), text.end()};
+  }
+}  // namespace
+
+TEST_CASE("compressed payloads give back the proto and payload", "[service]")
+{
+  const auto page = Page();
+  llarp::util::PooledVector<byte_t> compressed;
+  REQUIRE(Compression::Compress(
+      llarp::service::eProtocolTrafficV4, page.data(), page.size(), compressed));
+  CHECK(compressed.size() < page.size());
+  CHECK(compressed.size() % Compression::SizeClass == 0);
+
+  llarp::service::ProtocolType proto = 0;
+  llarp::util::PooledVector<byte_t> out;
+  REQUIRE(Compression::Decompress(compressed.data(), compressed.size(), proto, out));
+  CHECK(proto == llarp::service::eProtocolTrafficV4);
+  CHECK(out == page);
+
+  // in place, as a message's payload is
+  REQUIRE(Compression::Decompress(compressed.data(), compressed.size(), proto, compressed));
+  CHECK(compressed == page);
+}
+
+TEST_CASE("compression leaves what it should not touch", "[service]")
+{
+  const auto page = Page();
+  llarp::util::PooledVector<byte_t> out;
+  CHECK_FALSE(
+      Compression::Compress(llarp::service::eProtocolControl, page.data(), page.size(), out));
+  CHECK_FALSE(Compression::Compress(
+      llarp::service::eProtocolTrafficV4, page.data(), Compression::MinSize - 1, out));
+  std::mt19937 rng{7};
+  llarp::util::PooledVector<byte_t> noise(1000);
+  for (auto& byte : noise)
+    byte = rng();
+  CHECK_FALSE(
+      Compression::Compress(llarp::service::eProtocolTrafficV4, noise.data(), noise.size(), out));
+  CHECK(out.empty());
+}
+
+TEST_CASE("compressed payloads that lie are turned away", "[service]")
+{
+  const auto page = Page();
+  llarp::util::PooledVector<byte_t> compressed;
+  REQUIRE(Compression::Compress(
+      llarp::service::eProtocolTrafficV6, page.data(), page.size(), compressed));
+  llarp::service::ProtocolType proto;
+  llarp::util::PooledVector<byte_t> out;
+
+  auto nested = compressed;
+  nested[0] = llarp::service::eProtocolCompressed;
+  CHECK_FALSE(Compression::Decompress(nested.data(), nested.size(), proto, out));
+
+  auto huge = compressed;
+  huge[1] = 0xff;
+  CHECK_FALSE(Compression::Decompress(huge.data(), huge.size(), proto, out));
+
+  auto cut = compressed;
+  cut.resize(Compression::HeaderSize + 10);
+  CHECK_FALSE(Compression::Decompress(cut.data(), cut.size(), proto, out));
+}
+
+TEST_CASE("compression gate backs off from payloads that do not shrink", "[service]")
+{
+  CompressionGate gate;
+  for (uint64_t idx = 0; idx < CompressionGate::Misses; ++idx)
+  {
+    REQUIRE(gate.ShouldTry());
+    gate.Tried(false);
+  }
+  for (uint64_t idx = 0; idx < CompressionGate::MinBackoff; ++idx)
+    CHECK_FALSE(gate.ShouldTry());
+  CHECK(gate.Bypassed() == CompressionGate::MinBackoff);
+
+  // twice as long the next time
+  for (uint64_t idx = 0; idx < CompressionGate::Misses; ++idx)
+  {
+    REQUIRE(gate.ShouldTry());
+    gate.Tried(false);
+  }
+  for (uint64_t idx = 0; idx < 2 * CompressionGate::MinBackoff; ++idx)
+    CHECK_FALSE(gate.ShouldTry());
+  CHECK(gate.ShouldTry());
+
+  // a saving starts over
+  gate.Tried(true);
+  CHECK(gate.Compressed() == 1);
+  for (uint64_t idx = 0; idx < CompressionGate::Misses; ++idx)
+  {
+    REQUIRE(gate.ShouldTry());
+    gate.Tried(false);
+  }
+  for (uint64_t idx = 0; idx < CompressionGate::MinBackoff; ++idx)
+    CHECK_FALSE(gate.ShouldTry());
+  CHECK(gate.ShouldTry());
+}
+
+TEST_CASE("compression gate only compresses what shrinks", "[service]")
+{
+  CompressionGate gate;
+  auto payload = Page();
+  const auto page = payload;
+  llarp::service::ProtocolType proto = llarp::service::eProtocolBundle;
+  gate.Apply(proto, payload);
+  CHECK(proto == llarp::service::eProtocolCompressed);
+  CHECK(payload.size() < page.size());
+
+  llarp::util::PooledVector<byte_t> small(100, 1);
+  proto = llarp::service::eProtocolTrafficV4;
+  gate.Apply(proto, small);
+  CHECK(proto == llarp::service::eProtocolTrafficV4);
+  CHECK(small.size() == 100);
+}
@@ -0,0 +1,141 @@
+#include <service/exit_selector.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::service::Address;
+using llarp::service::ExitSelector;
+
+namespace
+{
+  Address
+  MakeExit(byte_t fill)
+  {
+    Address addr;
+    addr.Fill(fill);
+    return addr;
+  }
+}  // namespace
+
+TEST_CASE("new flows go to the fastest exit and stay on theirs", "[service]")
+{
+  const auto near = MakeExit(1);
+  const auto far = MakeExit(2);
+  const std::set<Address> exits{near, far};
+  ExitSelector selector;
+  llarp_time_t now = 10s;
+
+  // nothing measured yet, flows still go somewhere
+  const auto first = selector.Pick(1, exits, now);
+  CHECK(exits.count(first) == 1);
+
+  selector.Latency(near, 100ms);
+  selector.Latency(far, 150ms);
+  selector.Received(first, 1000, now);
+  CHECK(selector.Pick(2, exits, now) == near);
+  // the first flow keeps its exit whichever it was
+  CHECK(selector.Pick(1, exits, now) == first);
+  CHECK(selector.Flows() == 2);
+}
+
+TEST_CASE("advertised capacity outweighs a slightly longer round trip", "[service]")
+{
+  const auto thin = MakeExit(1);
+  const auto fat = MakeExit(2);
+  ExitSelector selector;
+  selector.Latency(thin, 100ms);
+  selector.Latency(fat, 130ms);
+
+  llarp::service::IntroSet introset;
+  introset.SRVs.emplace_back(std::string{ExitSelector::CapacitySRV}, 0, 1000, 0, "");
+  selector.Advertised(fat, introset);
+
+  REQUIRE(selector.Cost(fat).has_value());
+  REQUIRE(selector.Cost(thin).has_value());
+  CHECK(*selector.Cost(fat) < *selector.Cost(thin));
+  CHECK(selector.Pick(1, {thin, fat}, 1s) == fat);
+}
+
+TEST_CASE("a slow exit takes no new flows but keeps its old ones", "[service]")
+{
+  const auto fast = MakeExit(1);
+  const auto slow = MakeExit(2);
+  const std::set<Address> exits{fast, slow};
+  ExitSelector selector;
+  llarp_time_t now = 10s;
+
+  selector.Latency(slow, 50ms);
+  selector.Latency(fast, 60ms);
+  REQUIRE(selector.Pick(1, exits, now) == slow);
+  selector.Received(slow, 100, now);
+
+  // slow gets much slower, its rtt is smoothed so it takes a few samples
+  for (int idx = 0; idx < 20; ++idx)
+    selector.Latency(slow, 500ms);
+  CHECK(selector.IsDegraded(slow, now));
+  CHECK_FALSE(selector.IsDead(slow, now));
+  CHECK(selector.Pick(2, exits, now) == fast);
+  // draining, not cut off
+  CHECK(selector.Pick(1, exits, now) == slow);
+}
+
+TEST_CASE("flows move off an exit that stopped answering", "[service]")
+{
+  const auto good = MakeExit(1);
+  const auto gone = MakeExit(2);
+  const std::set<Address> exits{good, gone};
+  ExitSelector selector;
+  llarp_time_t now = 10s;
+
+  selector.Latency(gone, 50ms);
+  selector.Latency(good, 60ms);
+  REQUIRE(selector.Pick(1, exits, now) == gone);
+  selector.Received(good, 100, now);
+
+  now += ExitSelector::ReplyTimeout;
+  CHECK(selector.IsDead(gone, now));
+  CHECK(selector.Pick(1, exits, now) == good);
+
+  // nothing sent to it any more, so after a while it gets another go
+  now += ExitSelector::FlowIdle;
+  selector.Tick(now, exits);
+  CHECK_FALSE(selector.IsDead(gone, now));
+}
+
+TEST_CASE("idle flows and unmapped exits are forgotten", "[service]")
+{
+  const auto one = MakeExit(1);
+  const auto two = MakeExit(2);
+  ExitSelector selector;
+  llarp_time_t now = 10s;
+  selector.Latency(one, 50ms);
+  selector.Latency(two, 60ms);
+  selector.Pick(1, {one, two}, now);
+  selector.Received(one, 100, now);
+
+  selector.Tick(now + ExitSelector::FlowIdle, {one, two});
+  CHECK(selector.Flows() == 0);
+
+  selector.Tick(now, {two});
+  CHECK_FALSE(selector.Cost(one).has_value());
+  CHECK(selector.Cost(two).has_value());
+}
+
+TEST_CASE("exits rank by what they carried back", "[service]")
+{
+  const auto busy = MakeExit(1);
+  const auto idle = MakeExit(2);
+  ExitSelector selector;
+  llarp_time_t now = 10s;
+  selector.Latency(busy, 100ms);
+  selector.Latency(idle, 100ms);
+
+  selector.Received(busy, 0, now);
+  // 10 Mbit/s for a second
+  for (int idx = 0; idx < 100; ++idx)
+  {
+    now += 10ms;
+    selector.Received(busy, 12500, now);
+  }
+  selector.Tick(now + 1ms, {busy, idle});
+  CHECK(*selector.Cost(busy) < *selector.Cost(idle));
+}
@@ -0,0 +1,104 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <service/handshake_cache.hpp>
+#include <service/identity.hpp>
+#include <util/meta/memfn.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using llarp::service::HandshakeCache;
+
+TEST_CASE("HandshakeCache dh matches the uncached exchange", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity alice, bob;
+  alice.RegenerateKeys();
+  bob.RegenerateKeys();
+
+  HandshakeCache aliceCache, bobCache;
+  for (int round = 0; round < 3; ++round)
+  {
+    KeyExchangeNonce N;
+    N.Randomize();
+    SharedSecret expect;
+    path_dh_func dh_client = util::memFn(&Crypto::dh_client, CryptoManager::instance());
+    REQUIRE(alice.KeyExchange(dh_client, expect, bob.pub, N));
+
+    SharedSecret client, server;
+    REQUIRE(aliceCache.ClientDH(client, alice, bob.pub, N, 1s));
+    REQUIRE(bobCache.ServerDH(server, bob, alice.pub, N, 1s));
+    REQUIRE(client == expect);
+    REQUIRE(server == expect);
+  }
+  REQUIRE(aliceCache.Size() == 1);
+  REQUIRE(aliceCache.Hits() == 2);
+  REQUIRE(bobCache.Hits() == 2);
+}
+
+TEST_CASE("HandshakeCache reuses an encapsulation the remote can open", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity bob;
+  bob.RegenerateKeys();
+  const PQPubKey bobPQ(pq_keypair_to_public(bob.pq));
+
+  HandshakeCache sender, receiver;
+  PQCipherBlock C1, C2;
+  SharedSecret K1, K2, opened;
+  REQUIRE(sender.Encapsulate(C1, K1, bobPQ, 1s));
+  REQUIRE(sender.Encapsulate(C2, K2, bobPQ, 2s));
+  REQUIRE(C1 == C2);
+  REQUIRE(K1 == K2);
+
+  REQUIRE(receiver.Decapsulate(C1, opened, bob.pq, 1s));
+  REQUIRE(opened == K1);
+  opened.Zero();
+  REQUIRE(receiver.Decapsulate(C2, opened, bob.pq, 2s));
+  REQUIRE(opened == K1);
+  REQUIRE(receiver.Hits() == 1);
+}
+
+TEST_CASE("HandshakeCache bounds how long and how often an entry is used", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity bob;
+  bob.RegenerateKeys();
+  const PQPubKey bobPQ(pq_keypair_to_public(bob.pq));
+
+  HandshakeCache cache;
+  PQCipherBlock first, C;
+  SharedSecret K;
+  REQUIRE(cache.Encapsulate(first, K, bobPQ, 0s));
+
+  SECTION("age")
+  {
+    REQUIRE(cache.Encapsulate(C, K, bobPQ, HandshakeCache::MaxAge - 1ms));
+    REQUIRE(C == first);
+    REQUIRE(cache.Encapsulate(C, K, bobPQ, HandshakeCache::MaxAge));
+    REQUIRE(C != first);
+
+    cache.Expire(HandshakeCache::MaxAge * 2);
+    REQUIRE(cache.Size() == 0);
+  }
+
+  SECTION("uses")
+  {
+    for (uint64_t use = 1; use < HandshakeCache::MaxUses; ++use)
+    {
+      REQUIRE(cache.Encapsulate(C, K, bobPQ, 1s));
+      REQUIRE(C == first);
+    }
+    REQUIRE(cache.Size() == 0);
+    REQUIRE(cache.Encapsulate(C, K, bobPQ, 1s));
+    REQUIRE(C != first);
+  }
+
+  SECTION("clear")
+  {
+    cache.Clear();
+    REQUIRE(cache.Size() == 0);
+    REQUIRE(cache.Encapsulate(C, K, bobPQ, 1s));
+    REQUIRE(C != first);
+  }
+}
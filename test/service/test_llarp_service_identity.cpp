@@ -230,3 +230,24 @@ TEST_CASE("Test sign and encrypt introset", "[crypto]")
   CHECK(crypto->derive_subkey(blind_key, root_key, 1));
   CHECK(blind_key == maybe->derivedSigningKey);
 }
+
+TEST_CASE("Introset content ignores when it was signed", "[service]")
+{
+  service::IntroSet I;
+  service::Introduction intro;
+  intro.router.Randomize();
+  intro.pathID.Randomize();
+  I.I.emplace_back(intro);
+
+  service::IntroSet resigned = I;
+  resigned.T = 5s;
+  resigned.Z.Randomize();
+  CHECK(I.SameContentAs(resigned));
+
+  service::IntroSet changed = I;
+  changed.SRVs.emplace_back("_http._tcp", 1, 1, 80, "");
+  CHECK(not I.SameContentAs(changed));
+  changed = I;
+  changed.I.front().pathID.Randomize();
+  CHECK(not I.SameContentAs(changed));
+}
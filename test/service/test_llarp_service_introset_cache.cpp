@@ -0,0 +1,94 @@
+#include <service/introset_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::dht::Key_t;
+using llarp::service::IntroSet;
+using llarp::service::IntroSetCache;
+
+namespace
+{
+  IntroSet
+  MakeIntroSet(llarp_time_t signedAt, llarp_time_t expiresAt)
+  {
+    IntroSet introset;
+    introset.T = signedAt;
+    introset.I.emplace_back();
+    introset.I.back().expiresAt = expiresAt;
+    return introset;
+  }
+
+  Key_t
+  MakeKey(uint8_t b)
+  {
+    Key_t key;
+    key.Fill(b);
+    return key;
+  }
+}  // namespace
+
+TEST_CASE("IntroSetCache serves an introset until just before it expires", "[service]")
+{
+  IntroSetCache cache;
+  const auto location = MakeKey(1);
+  cache.Put(location, MakeIntroSet(1s, 10min), 1s);
+
+  const auto found = cache.Get(location, 5min);
+  REQUIRE(found);
+  REQUIRE(found->T == 1s);
+  REQUIRE_FALSE(cache.IsMissing(location, 5min));
+  REQUIRE_FALSE(cache.Get(MakeKey(2), 5min));
+
+  REQUIRE_FALSE(cache.Get(location, 10min - IntroSetCache::ExpiryMargin));
+  REQUIRE(cache.Size() == 0);
+  REQUIRE(cache.Hits() == 1);
+
+  // one already too close to expiring is not kept at all
+  cache.Put(location, MakeIntroSet(1s, 10min), 10min - 1s);
+  REQUIRE(cache.Size() == 0);
+}
+
+TEST_CASE("IntroSetCache keeps the newer introset", "[service]")
+{
+  IntroSetCache cache;
+  const auto location = MakeKey(1);
+  cache.Put(location, MakeIntroSet(2s, 10min), 3s);
+  cache.Put(location, MakeIntroSet(1s, 11min), 3s);
+  REQUIRE(cache.Get(location, 4s)->T == 2s);
+  cache.Put(location, MakeIntroSet(3s, 11min), 4s);
+  REQUIRE(cache.Get(location, 5s)->T == 3s);
+}
+
+TEST_CASE("IntroSetCache remembers a miss for a little while", "[service]")
+{
+  IntroSetCache cache;
+  const auto location = MakeKey(1);
+  cache.PutMissing(location, 1s);
+  REQUIRE(cache.IsMissing(location, 2s));
+  REQUIRE_FALSE(cache.Get(location, 2s));
+  REQUIRE_FALSE(cache.IsMissing(location, 1s + IntroSetCache::MissTTL));
+
+  // an introset found later replaces the miss
+  cache.PutMissing(location, 10s);
+  cache.Put(location, MakeIntroSet(10s, 10min), 11s);
+  REQUIRE_FALSE(cache.IsMissing(location, 12s));
+  REQUIRE(cache.Get(location, 12s));
+}
+
+TEST_CASE("IntroSetCache drops what expires first when full", "[service]")
+{
+  IntroSetCache cache;
+  for (size_t idx = 0; idx < IntroSetCache::MaxEntries; ++idx)
+  {
+    Key_t key;
+    key.Zero();
+    key[0] = idx;
+    key[1] = idx >> 8;
+    cache.Put(key, MakeIntroSet(1s, 10min + std::chrono::seconds(idx)), 1s);
+  }
+  const auto location = MakeKey(1);
+  cache.PutMissing(location, 2s);
+  REQUIRE(cache.Size() == IntroSetCache::MaxEntries);
+  REQUIRE(cache.IsMissing(location, 3s));
+}
@@ -0,0 +1,62 @@
+#include <service/name_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::service::Address;
+using llarp::service::NameCache;
+
+namespace
+{
+  Address
+  MakeAddr(uint8_t b)
+  {
+    Address addr;
+    addr.Fill(b);
+    return addr;
+  }
+}  // namespace
+
+TEST_CASE("NameCache serves a name fresh then stale then not at all", "[service]")
+{
+  NameCache cache;
+  cache.Put("jason.loki", MakeAddr(1), 1s);
+
+  REQUIRE(cache.Get("jason.loki", 2s) == MakeAddr(1));
+  REQUIRE_FALSE(cache.ShouldRefresh("jason.loki", 2s));
+  REQUIRE_FALSE(cache.Get("other.loki", 2s));
+
+  const auto stale = 1s + NameCache::FreshTTL;
+  REQUIRE(cache.Get("jason.loki", stale) == MakeAddr(1));
+  REQUIRE(cache.ShouldRefresh("jason.loki", stale));
+
+  REQUIRE_FALSE(cache.Get("jason.loki", 1s + NameCache::StaleTTL));
+  REQUIRE(cache.Size() == 0);
+}
+
+TEST_CASE("NameCache has one refresh out at a time", "[service]")
+{
+  NameCache cache;
+  cache.Put("jason.loki", MakeAddr(1), 0s);
+  const auto stale = NameCache::FreshTTL;
+  REQUIRE(cache.ShouldRefresh("jason.loki", stale));
+  REQUIRE_FALSE(cache.ShouldRefresh("jason.loki", stale + 1s));
+
+  // a refresh that found a new address makes it fresh again
+  cache.Put("jason.loki", MakeAddr(2), stale + 2s);
+  REQUIRE(cache.Get("jason.loki", stale + 3s) == MakeAddr(2));
+  REQUIRE_FALSE(cache.ShouldRefresh("jason.loki", stale + 3s));
+}
+
+TEST_CASE("NameCache retries a failed refresh later", "[service]")
+{
+  NameCache cache;
+  cache.Put("jason.loki", MakeAddr(1), 0s);
+  const auto stale = NameCache::FreshTTL;
+  REQUIRE(cache.ShouldRefresh("jason.loki", stale));
+  cache.RefreshFailed("jason.loki", stale);
+
+  REQUIRE(cache.Get("jason.loki", stale + 1s) == MakeAddr(1));
+  REQUIRE_FALSE(cache.ShouldRefresh("jason.loki", stale + 1s));
+  REQUIRE(cache.ShouldRefresh("jason.loki", stale + NameCache::RetryInterval));
+}
@@ -0,0 +1,59 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <service/protocol.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("ProtocolFrame keyed hash takes the place of the signature", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+
+  SharedSecret key;
+  key.Randomize();
+  service::ProtocolMessage msg;
+  msg.tag.Randomize();
+  msg.seqno = 7;
+  const std::string payload = "hello";
+  msg.PutBuffer(llarp_buffer_t(payload));
+
+  service::ProtocolFrame frame;
+  frame.T = msg.tag;
+  frame.N.Randomize();
+  REQUIRE(frame.EncryptAndMAC(msg, key));
+  REQUIRE(frame.Z.IsZero());
+  REQUIRE_FALSE(frame.H.IsZero());
+  REQUIRE(frame.VerifyMAC(key));
+
+  SECTION("it survives the wire")
+  {
+    std::array<byte_t, service::MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+    llarp_buffer_t buf(tmp);
+    REQUIRE(frame.BEncode(&buf));
+    buf.sz = buf.cur - buf.base;
+    buf.cur = buf.base;
+    service::ProtocolFrame other;
+    REQUIRE(other.BDecode(&buf));
+    REQUIRE(other.VerifyMAC(key));
+    service::ProtocolMessage got;
+    REQUIRE(other.DecryptPayloadInto(key, got));
+    REQUIRE(got.seqno == 7);
+    REQUIRE(got.payload == msg.payload);
+  }
+
+  SECTION("another key or a changed frame fails")
+  {
+    SharedSecret other;
+    other.Randomize();
+    REQUIRE_FALSE(frame.VerifyMAC(other));
+    frame.F.Randomize();
+    REQUIRE_FALSE(frame.VerifyMAC(key));
+  }
+
+  SECTION("a frame carrying intro key material is never trusted on a keyed hash")
+  {
+    frame.C.Randomize();
+    REQUIRE_FALSE(frame.VerifyMAC(key));
+  }
+}
@@ -0,0 +1,130 @@
+#include <service/reliable_stream.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace llarp::service;
+
+namespace
+{
+  std::vector<byte_t>
+  Segment(byte_t fill)
+  {
+    return std::vector<byte_t>(100, fill);
+  }
+
+  struct Sent
+  {
+    std::vector<uint32_t> seqnos;
+
+    void
+    operator()(uint32_t seqno, const std::vector<byte_t>&)
+    {
+      seqnos.push_back(seqno);
+    }
+  };
+}  // namespace
+
+TEST_CASE("StreamAck round trips", "[service][stream]")
+{
+  StreamAck ack;
+  ack.next = 1234;
+  ack.sacks = 0x8000000000000005;
+  std::array<byte_t, StreamAck::Size> buf;
+  ack.Encode(buf.data());
+  const auto decoded = StreamAck::Decode(llarp_buffer_t(buf));
+  REQUIRE(decoded);
+  CHECK(decoded->next == ack.next);
+  CHECK(decoded->sacks == ack.sacks);
+  CHECK_FALSE(StreamAck::Decode(llarp_buffer_t(buf.data(), 4)));
+}
+
+TEST_CASE("ReliableReceiver delivers in order and acks what it holds", "[service][stream]")
+{
+  ReliableReceiver receiver;
+  std::vector<byte_t> out;
+  const auto deliver = [&out](const std::vector<byte_t>& data) { out.push_back(data[0]); };
+
+  CHECK_FALSE(receiver.Push(0, Segment(0), deliver));
+  CHECK(receiver.Push(2, Segment(2), deliver));
+  CHECK(receiver.Push(4, Segment(4), deliver));
+  CHECK(out == std::vector<byte_t>{0});
+  auto ack = receiver.TakeAck();
+  CHECK(ack.next == 1);
+  CHECK(ack.sacks == 0b101);
+  CHECK_FALSE(receiver.AckPending());
+
+  // filling the gap is acked at once
+  CHECK(receiver.Push(1, Segment(1), deliver));
+  CHECK(out == std::vector<byte_t>{0, 1, 2});
+  ack = receiver.TakeAck();
+  CHECK(ack.next == 3);
+  CHECK(ack.sacks == 0b1);
+
+  // a duplicate gets acked again and goes no further
+  CHECK(receiver.Push(0, Segment(0), deliver));
+  CHECK(out.size() == 3);
+}
+
+TEST_CASE("ReliableSender keeps to its window and resends only what was lost", "[service][stream]")
+{
+  ReliableSender sender;
+  for (byte_t idx = 0; idx < 20; ++idx)
+    REQUIRE(sender.Queue(Segment(idx)));
+
+  llarp_time_t now = 1s;
+  Sent first;
+  sender.Flush(now, first);
+  REQUIRE(first.seqnos.size() == size_t(ReliableSender::InitialWindow));
+  CHECK(sender.InFlight() == first.seqnos.size());
+
+  // 0 is lost, 1 through 4 arrive
+  now += 100ms;
+  StreamAck ack;
+  ack.next = 0;
+  ack.sacks = 0b1111;
+  sender.HandleAck(ack, now);
+  // 0 goes again first, then new ones up to the window, which lost a quarter
+  Sent second;
+  sender.Flush(now, second);
+  CHECK(sender.Window() == size_t(ReliableSender::InitialWindow * ReliableSender::LossBackoff));
+  CHECK(second.seqnos == std::vector<uint32_t>{0, 8, 9});
+  CHECK(sender.InFlight() == sender.Window());
+
+  // everything acked opens the window up again
+  now += 100ms;
+  ack.next = 10;
+  ack.sacks = 0;
+  sender.HandleAck(ack, now);
+  CHECK(sender.InFlight() == 0);
+  Sent third;
+  sender.Flush(now, third);
+  CHECK(third.seqnos.front() == 10);
+  CHECK(third.seqnos.size() == sender.Window());
+}
+
+TEST_CASE("ReliableSender resends on timeout and gives up in the end", "[service][stream]")
+{
+  ReliableSender sender;
+  REQUIRE(sender.Queue(Segment(0)));
+  llarp_time_t now = 1s;
+  Sent sent;
+  sender.Flush(now, sent);
+  REQUIRE(sent.seqnos.size() == 1);
+
+  for (uint32_t tries = 1; tries < ReliableSender::MaxTries; ++tries)
+  {
+    now += sender.Timeout();
+    Sent again;
+    sender.Flush(now, again);
+    CHECK(again.seqnos == std::vector<uint32_t>{0});
+  }
+  now += sender.Timeout();
+  Sent last;
+  sender.Flush(now, last);
+  CHECK(last.seqnos.empty());
+  CHECK(sender.Failed());
+  CHECK_FALSE(sender.Queue(Segment(1)));
+}
@@ -0,0 +1,89 @@
+#include <service/reorder_buffer.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+  struct Msg
+  {
+    uint64_t seqno;
+  };
+
+  using Msg_ptr = std::shared_ptr<Msg>;
+  using Buffer_t = llarp::service::ReorderBuffer<Msg_ptr>;
+
+  struct Collect
+  {
+    std::vector<uint64_t>& out;
+
+    void
+    operator()(const Msg_ptr& msg)
+    {
+      out.push_back(msg->seqno);
+    }
+  };
+
+  Msg_ptr
+  MakeMsg(uint64_t seqno)
+  {
+    return std::make_shared<Msg>(Msg{seqno});
+  }
+}  // namespace
+
+TEST_CASE("ReorderBuffer passes in order traffic straight on", "[service][reorder]")
+{
+  Buffer_t buffer;
+  std::vector<uint64_t> out;
+  for (uint64_t seqno = 1; seqno <= 5; ++seqno)
+    buffer.Push(MakeMsg(seqno), 1s, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1, 2, 3, 4, 5});
+  REQUIRE(buffer.Empty());
+}
+
+TEST_CASE("ReorderBuffer puts striped traffic back in order", "[service][reorder]")
+{
+  Buffer_t buffer;
+  std::vector<uint64_t> out;
+  for (uint64_t seqno : {1, 3, 5, 2, 4, 6})
+    buffer.Push(MakeMsg(seqno), 1s, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1, 2, 3, 4, 5, 6});
+  REQUIRE(buffer.Empty());
+  REQUIRE(buffer.Skipped() == 0);
+}
+
+TEST_CASE("ReorderBuffer gives up on a gap after the hold time", "[service][reorder]")
+{
+  Buffer_t buffer;
+  std::vector<uint64_t> out;
+  buffer.Push(MakeMsg(1), 1s, Collect{out});
+  buffer.Push(MakeMsg(3), 1s, Collect{out});
+  buffer.Push(MakeMsg(4), 1s, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1});
+  buffer.Expire(1s + Buffer_t::MaxHold - 1ms, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1});
+  buffer.Expire(1s + Buffer_t::MaxHold, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1, 3, 4});
+  REQUIRE(buffer.Skipped() == 1);
+  // the lost one turning up late still goes through
+  buffer.Push(MakeMsg(2), 2s, Collect{out});
+  REQUIRE(out == std::vector<uint64_t>{1, 3, 4, 2});
+  REQUIRE(buffer.Late() == 1);
+}
+
+TEST_CASE("ReorderBuffer holds a bounded amount", "[service][reorder]")
+{
+  Buffer_t buffer;
+  std::vector<uint64_t> out;
+  buffer.Push(MakeMsg(1), 1s, Collect{out});
+  for (uint64_t seqno = 3; seqno < 3 + Buffer_t::MaxHeld; ++seqno)
+    buffer.Push(MakeMsg(seqno), 1s, Collect{out});
+  REQUIRE(buffer.Held() == Buffer_t::MaxHeld);
+  buffer.Push(MakeMsg(3 + Buffer_t::MaxHeld), 1s, Collect{out});
+  REQUIRE(buffer.Empty());
+  REQUIRE(out.size() == Buffer_t::MaxHeld + 2);
+  REQUIRE(std::is_sorted(out.begin(), out.end()));
+}
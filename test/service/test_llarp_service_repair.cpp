@@ -0,0 +1,84 @@
+#include <service/repair.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp::service;
+
+namespace
+{
+  std::vector<byte_t>
+  MakePayload(size_t sz, byte_t fill)
+  {
+    std::vector<byte_t> payload(sz);
+    for (size_t idx = 0; idx < sz; ++idx)
+      payload[idx] = fill + idx;
+    return payload;
+  }
+}  // namespace
+
+TEST_CASE("Repair group size follows path loss", "[service][repair]")
+{
+  CHECK(RepairEncoder::GroupSizeFor(0.0) == 0);
+  CHECK(RepairEncoder::GroupSizeFor(0.005) == 0);
+  CHECK(RepairEncoder::GroupSizeFor(0.01) == RepairEncoder::MaxGroup);
+  CHECK(RepairEncoder::GroupSizeFor(0.05) == 5);
+  CHECK(RepairEncoder::GroupSizeFor(0.5) == RepairEncoder::MinGroup);
+}
+
+TEST_CASE("One lost message of a group is rebuilt from its repair", "[service][repair]")
+{
+  RepairEncoder encoder;
+  RepairDecoder decoder;
+  std::vector<std::vector<byte_t>> sent;
+  std::optional<std::vector<byte_t>> repair;
+  // seqnos need not be contiguous, other messages may go between them
+  const std::vector<uint64_t> seqnos{10, 11, 13, 14};
+  for (size_t idx = 0; idx < seqnos.size(); ++idx)
+  {
+    sent.push_back(MakePayload(100 + idx * 37, idx));
+    repair = encoder.Add(seqnos[idx], eProtocolTrafficV4, llarp_buffer_t(sent.back()), 4);
+    CHECK(repair.has_value() == (idx == 3));
+  }
+  REQUIRE(repair);
+  CHECK(encoder.Repairs() == 1);
+
+  // 13 is lost
+  for (const size_t idx : {0, 1, 3})
+    CHECK(decoder.Keep(seqnos[idx], eProtocolTrafficV4, sent[idx]));
+  const auto rebuilt = decoder.Repair(*repair);
+  REQUIRE(rebuilt);
+  CHECK(rebuilt->seqno == 13);
+  CHECK(rebuilt->proto == eProtocolTrafficV4);
+  CHECK(rebuilt->payload == sent[2]);
+  CHECK(decoder.Repaired() == 1);
+
+  // the original turning up late goes no further
+  CHECK_FALSE(decoder.Keep(13, eProtocolTrafficV4, sent[2]));
+}
+
+TEST_CASE("A repair does nothing with none or two of its group lost", "[service][repair]")
+{
+  RepairEncoder encoder;
+  std::vector<std::vector<byte_t>> sent;
+  std::optional<std::vector<byte_t>> repair;
+  for (uint64_t seqno = 1; seqno <= 4; ++seqno)
+  {
+    sent.push_back(MakePayload(64, seqno));
+    repair = encoder.Add(seqno, eProtocolTrafficV6, llarp_buffer_t(sent.back()), 4);
+  }
+  REQUIRE(repair);
+
+  RepairDecoder all;
+  for (uint64_t seqno = 1; seqno <= 4; ++seqno)
+    all.Keep(seqno, eProtocolTrafficV6, sent[seqno - 1]);
+  CHECK_FALSE(all.Repair(*repair));
+
+  RepairDecoder two;
+  two.Keep(1, eProtocolTrafficV6, sent[0]);
+  two.Keep(4, eProtocolTrafficV6, sent[3]);
+  CHECK_FALSE(two.Repair(*repair));
+
+  CHECK_FALSE(two.Repair(std::vector<byte_t>(4)));
+}
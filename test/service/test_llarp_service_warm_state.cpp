@@ -0,0 +1,69 @@
+#include <crypto/crypto.hpp>
+#include <crypto/crypto_libsodium.hpp>
+#include <service/identity.hpp>
+#include <service/warm_state.hpp>
+
+#include <fstream>
+
+#include <test_util.hpp>
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  RouterID
+  MakeRouter(byte_t b)
+  {
+    RouterID id;
+    id.Fill(b);
+    return id;
+  }
+}  // namespace
+
+TEST_CASE("WarmState reads back what it saved", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity ident;
+  ident.RegenerateKeys();
+  const fs::path p = test::randFilename();
+  test::FileGuard guard(p);
+
+  service::WarmState saved;
+  saved.firstHops = {MakeRouter(1), MakeRouter(2)};
+  REQUIRE(saved.Save(p, ident));
+
+  service::WarmState loaded;
+  REQUIRE(loaded.Load(p, ident));
+  REQUIRE(loaded.firstHops == saved.firstHops);
+  REQUIRE(loaded.introsets.empty());
+}
+
+TEST_CASE("WarmState only opens for the identity that sealed it", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity ident, other;
+  ident.RegenerateKeys();
+  other.RegenerateKeys();
+  const fs::path p = test::randFilename();
+  test::FileGuard guard(p);
+
+  service::WarmState saved;
+  saved.firstHops = {MakeRouter(3)};
+  REQUIRE(saved.Save(p, ident));
+
+  service::WarmState loaded;
+  REQUIRE_FALSE(loaded.Load(p, other));
+
+  // flip the last byte, the mac no longer matches
+  {
+    std::fstream f(p.string(), std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(-1, std::ios::end);
+    char last = 0;
+    f.read(&last, 1);
+    f.seekp(-1, std::ios::end);
+    last ^= 1;
+    f.write(&last, 1);
+  }
+  REQUIRE_FALSE(loaded.Load(p, ident));
+}
@@ -0,0 +1,165 @@
+#include <simulation/network.hpp>
+#include <simulation/scheduler.hpp>
+#include <simulation/sim_loop.hpp>
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using simulate::LinkConditions;
+using simulate::Network;
+using simulate::Scheduler;
+using simulate::SimLoop;
+
+TEST_CASE("Scheduler runs events in time then schedule order", "[simulation]")
+{
+  Scheduler sched;
+  const auto start = sched.Now();
+  std::string order;
+  sched.Schedule(20ms, [&]() { order += 'c'; });
+  sched.Schedule(10ms, [&]() { order += 'a'; });
+  sched.Schedule(10ms, [&]() { order += 'b'; });
+  const auto dropped = sched.Schedule(15ms, [&]() { order += 'x'; });
+  CHECK(sched.Cancel(dropped));
+  CHECK_FALSE(sched.Cancel(dropped));
+
+  CHECK(sched.RunFor(15ms) == 2);
+  CHECK(order == "ab");
+  CHECK(sched.Now() == start + 15ms);
+  CHECK(sched.RunFor(1s) == 1);
+  CHECK(order == "abc");
+  CHECK(sched.Pending() == 0);
+}
+
+TEST_CASE("Scheduler time only moves when events are taken", "[simulation]")
+{
+  Scheduler sched;
+  const auto start = sched.Now();
+  llarp_time_t seen = 0s;
+  sched.Schedule(5s, [&]() {
+    seen = sched.Now();
+    sched.Schedule(0ms, [&]() { seen += 1ms; });
+  });
+  CHECK(sched.Step());
+  CHECK(seen == start + 5s);
+  CHECK(sched.Step());
+  CHECK(seen == start + 5s + 1ms);
+  CHECK_FALSE(sched.Step());
+}
+
+TEST_CASE("Network delivers after latency and drops what it loses", "[simulation]")
+{
+  Scheduler sched;
+  Network net{sched, 1};
+  const SockAddr a{10, 0, 0, 1, 1000};
+  const SockAddr b{10, 0, 0, 2, 1000};
+  net.SetConditions(a, b, LinkConditions{50ms, 0ms, 0});
+
+  std::vector<llarp_time_t> arrived;
+  REQUIRE(net.Bind(b, [&](const SockAddr& from, std::vector<byte_t> data) {
+    CHECK(from == a);
+    CHECK(data.size() == 3);
+    arrived.push_back(sched.Now());
+  }));
+  CHECK_FALSE(net.Bind(b, [](const SockAddr&, std::vector<byte_t>) {}));
+
+  const byte_t data[3] = {1, 2, 3};
+  const auto sent = sched.Now();
+  net.Send(a, b, data, sizeof(data));
+  sched.RunFor(49ms);
+  CHECK(arrived.empty());
+  sched.RunFor(1ms);
+  REQUIRE(arrived.size() == 1);
+  CHECK(arrived[0] == sent + 50ms);
+
+  // nothing bound at the other end
+  net.Send(b, a, data, sizeof(data));
+  sched.RunFor(1s);
+  CHECK(net.Dropped() == 1);
+
+  net.SetConditions(a, b, LinkConditions{10ms, 0ms, 1.0});
+  net.Send(a, b, data, sizeof(data));
+  sched.RunFor(1s);
+  CHECK(arrived.size() == 1);
+  CHECK(net.Dropped() == 2);
+  CHECK(net.Delivered() == 1);
+}
+
+TEST_CASE("Network losses repeat with the seed", "[simulation]")
+{
+  auto run = [](uint64_t seed) {
+    Scheduler sched;
+    Network net{sched, seed};
+    net.SetDefaultConditions(LinkConditions{10ms, 5ms, 0.3});
+    const SockAddr a{10, 0, 0, 1, 1};
+    const SockAddr b{10, 0, 0, 2, 1};
+    std::vector<byte_t> got;
+    net.Bind(b, [&](const SockAddr&, std::vector<byte_t> data) { got.push_back(data[0]); });
+    for (byte_t idx = 0; idx < 100; ++idx)
+      net.Send(a, b, &idx, 1);
+    sched.RunFor(1s);
+    return got;
+  };
+  const auto first = run(7);
+  CHECK(first.size() < 100);
+  CHECK(first.size() > 0);
+  CHECK(run(7) == first);
+}
+
+TEST_CASE("SimLoop carries udp between hosts and runs tickers once per instant", "[simulation]")
+{
+  Scheduler sched;
+  Network net{sched};
+  auto loopA = std::make_shared<SimLoop>(sched, net, net.NextHost());
+  auto loopB = std::make_shared<SimLoop>(sched, net, net.NextHost());
+
+  struct Received
+  {
+    std::vector<std::string> pkts;
+    SockAddr from;
+  };
+  Received got;
+  llarp_udp_io udpA{};
+  llarp_udp_io udpB{};
+  udpB.user = &got;
+  udpB.recvfrom = [](llarp_udp_io* udp, const SockAddr& from, ManagedBuffer buf) {
+    auto* received = static_cast<Received*>(udp->user);
+    received->pkts.emplace_back(
+        reinterpret_cast<const char*>(buf.underlying.base), buf.underlying.sz);
+    received->from = from;
+  };
+  REQUIRE(llarp_ev_add_udp(loopA.get(), &udpA, SockAddr{0, 0, 0, 0, 0}) == 0);
+  REQUIRE(llarp_ev_add_udp(loopB.get(), &udpB, SockAddr{0, 0, 0, 0, 1090}) == 0);
+
+  int ticks = 0;
+  loopB->add_ticker([&ticks]() { ticks++; });
+
+  SockAddr to = loopB->Host();
+  to.setPort(1090);
+  const std::string hello = "hello";
+  const llarp_buffer_t buf(hello);
+  CHECK(llarp_ev_udp_sendto(&udpA, to, buf) == int(hello.size()));
+  CHECK(llarp_ev_udp_sendto(&udpA, to, buf) == int(hello.size()));
+  sched.RunFor(1s);
+  CHECK(got.pkts == std::vector<std::string>{hello, hello});
+  SockAddr hostA = got.from;
+  hostA.setPort(0);
+  CHECK(hostA == loopA->Host());
+  // both arrived in the same instant
+  CHECK(ticks == 1);
+
+  bool fired = false;
+  const auto id = loopB->call_after_delay(100ms, [&fired]() { fired = true; });
+  loopB->call_after_delay(200ms, [&fired]() { fired = true; });
+  loopB->cancel_delayed_call(id);
+  sched.RunFor(150ms);
+  CHECK_FALSE(fired);
+  sched.RunFor(100ms);
+  CHECK(fired);
+  CHECK(loopB->time_now() == sched.Now());
+
+  llarp_ev_close_udp(&udpA);
+  llarp_ev_close_udp(&udpB);
+}
@@ -122,4 +122,64 @@ TEST_CASE("RouterContact Decode Mixed Versions", "[RC][RouterContact]")
     REQUIRE(rc_vec[i] == rc_vec_out[i]);
 }
 
+
+TEST_CASE("RouterContact VerifyMany checks mixed versions", "[RC][RouterContact][verify]")
+{
+  std::vector<RouterContact> rcs(6);
+  for (size_t i = 0; i < rcs.size(); i++)
+  {
+    SecretKey sign, encr;
+    cmanager.instance()->identity_keygen(sign);
+    cmanager.instance()->encryption_keygen(encr);
+    rcs[i].version = i % 2;
+    rcs[i].enckey = encr.toPublic();
+    rcs[i].pubkey = sign.toPublic();
+    REQUIRE(rcs[i].Sign(sign));
+  }
+  // one bad signature of each version
+  rcs[2].signature.data()[0] ^= 1;
+  rcs[5].signature.data()[0] ^= 1;
+
+  bool valid[6];
+  REQUIRE(RouterContact::VerifyMany(rcs.data(), rcs.size(), time_now_ms(), valid) == 4);
+  for (size_t i = 0; i < rcs.size(); i++)
+  {
+    REQUIRE(valid[i] == rcs[i].Verify(time_now_ms()));
+    REQUIRE(valid[i] == (i != 2 and i != 5));
+  }
+}
+
+TEST_CASE("RouterContact Verify remembers only what it verified", "[RC][RouterContact][verify]")
+{
+  RouterContact rc;
+  SecretKey sign, encr;
+  cmanager.instance()->identity_keygen(sign);
+  cmanager.instance()->encryption_keygen(encr);
+  rc.version = 1;
+  rc.enckey = encr.toPublic();
+  rc.pubkey = sign.toPublic();
+  REQUIRE(rc.Sign(sign));
+
+  const auto now = time_now_ms();
+  const auto hits = [] { return VerifiedRCStatus()["hits"].get<uint64_t>(); };
+  REQUIRE(rc.Verify(now));
+  const auto before = hits();
+  REQUIRE(rc.Verify(now));
+  REQUIRE(hits() == before + 1);
+
+  bool valid[1];
+  REQUIRE(RouterContact::VerifyMany(&rc, 1, now, valid) == 1);
+  REQUIRE(hits() == before + 2);
+
+  // a copy with its signature or key changed is not the one we verified
+  RouterContact forged = rc;
+  forged.signature.data()[0] ^= 1;
+  REQUIRE(not forged.Verify(now));
+  forged = rc;
+  cmanager.instance()->identity_keygen(sign);
+  forged.pubkey = sign.toPublic();
+  REQUIRE(not forged.Verify(now));
+  REQUIRE(RouterContact::VerifyMany(&forged, 1, now, valid) == 0);
+}
+
 } // namespace llarp
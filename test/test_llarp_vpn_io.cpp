@@ -0,0 +1,49 @@
+#include <ev/vpnio.hpp>
+#include <llarp.h>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("vpn io batches packets through the slots", "[vpn]")
+{
+  constexpr size_t slot = LLARP_VPN_PACKET_SLOT_SIZE;
+  std::vector<unsigned char> slots(4 * slot);
+  std::vector<uint32_t> lens{20, 0, 1500, 40};
+  for (size_t idx = 0; idx < lens.size(); ++idx)
+    std::fill_n(slots.begin() + idx * slot, lens[idx], 0x10 + idx);
+
+  llarp_vpn_pkt_writer writer;
+  // the empty packet is dropped but counts as taken
+  CHECK(llarp_vpn_io_writepkts(&writer, slots.data(), lens.data(), lens.size()) == 4);
+  REQUIRE(writer.queue.size() == 3);
+
+  // what lokinet read from the writer comes back out of a reader the same way
+  llarp_vpn_pkt_reader reader;
+  while (auto pkt = writer.queue.tryPopFront())
+    reader.queue.pushBack(std::move(*pkt));
+
+  std::vector<unsigned char> out(2 * slot);
+  std::vector<uint32_t> outLens(2);
+  CHECK(llarp_vpn_io_readpkts(&reader, out.data(), outLens.data(), 2) == 2);
+  CHECK(outLens[0] == 20);
+  CHECK(outLens[1] == 1500);
+  CHECK(out[0] == 0x10);
+  CHECK(out[slot + 1499] == 0x12);
+
+  CHECK(llarp_vpn_io_readpkts(&reader, out.data(), outLens.data(), 2) == 1);
+  CHECK(outLens[0] == 40);
+  CHECK(out[39] == 0x13);
+}
+
+TEST_CASE("vpn io batch write stops when the queue is full", "[vpn]")
+{
+  llarp_vpn_pkt_writer writer;
+  const size_t capacity = writer.queue.capacity();
+  std::vector<unsigned char> slots((capacity + 2) * LLARP_VPN_PACKET_SLOT_SIZE, 0x45);
+  std::vector<uint32_t> lens(capacity + 2, 60);
+  CHECK(
+      llarp_vpn_io_writepkts(&writer, slots.data(), lens.data(), lens.size())
+      == ssize_t(capacity));
+  CHECK(llarp_vpn_io_writepkts(nullptr, slots.data(), lens.data(), lens.size()) == -1);
+}
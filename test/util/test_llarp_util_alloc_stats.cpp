@@ -0,0 +1,65 @@
+#include <util/alloc_stats.hpp>
+
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace alloc = llarp::alloc;
+
+TEST_CASE("allocation tags have their own names", "[util]")
+{
+  std::set<std::string> names;
+  for (uint8_t tag = 0; tag < alloc::NumTags; ++tag)
+    names.emplace(alloc::TagName(alloc::Tag(tag)));
+  CHECK(names.size() == alloc::NumTags);
+}
+
+TEST_CASE("allocations count against the tag of their scope", "[util]")
+{
+  if (not alloc::Enabled)
+  {
+    for (const auto& stats : alloc::Snapshot())
+      CHECK(stats.allocations == 0);
+    CHECK(alloc::ExtractStatus()["enabled"] == false);
+    return;
+  }
+  const auto before = alloc::Snapshot()[alloc::PathQueues];
+  std::unique_ptr<char[]> mem;
+  {
+    alloc::Scope scope{alloc::PathQueues};
+    {
+      // the inner scope wins while it lives
+      alloc::Scope inner{alloc::Logging};
+      std::make_unique<char[]>(16);
+    }
+    mem = std::make_unique<char[]>(4096);
+  }
+  const auto during = alloc::Snapshot()[alloc::PathQueues];
+  CHECK(during.allocations == before.allocations + 1);
+  CHECK(during.bytes == before.bytes + 4096);
+  CHECK(during.highWater >= during.bytes);
+
+  // frees go against the tag it was allocated under from wherever they happen
+  mem.reset();
+  const auto after = alloc::Snapshot()[alloc::PathQueues];
+  CHECK(after.frees == before.frees + 1);
+  CHECK(after.bytes == before.bytes);
+  CHECK(after.highWater == during.highWater);
+}
+
+TEST_CASE("containers on a tagged resource count against it anywhere", "[util]")
+{
+  const auto before = alloc::Snapshot()[alloc::DHTMessages];
+  {
+    std::pmr::vector<uint64_t> vec{alloc::Resource(alloc::DHTMessages)};
+    alloc::Scope scope{alloc::Logging};
+    vec.resize(128);
+    if (alloc::Enabled)
+      CHECK(alloc::Snapshot()[alloc::DHTMessages].bytes >= before.bytes + 1024);
+  }
+  CHECK(alloc::Snapshot()[alloc::DHTMessages].bytes == before.bytes);
+}
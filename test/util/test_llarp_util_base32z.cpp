@@ -0,0 +1,89 @@
+#include <util/base32z.hpp>
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+  /// a bit at a time, as lokimq does it
+  std::string
+  ReferenceEncode(const std::vector<uint8_t>& in)
+  {
+    static constexpr char alphabet[] = "ybndrfg8ejkmcpqxot1uwisza345h769";
+    std::string out;
+    uint32_t bits = 0;
+    int held = 0;
+    for (const auto byte : in)
+    {
+      bits = (bits << 8) | byte;
+      held += 8;
+      while (held >= 5)
+      {
+        held -= 5;
+        out += alphabet[(bits >> held) & 31];
+      }
+    }
+    if (held > 0)
+      out += alphabet[(bits << (5 - held)) & 31];
+    return out;
+  }
+}  // namespace
+
+TEST_CASE("base32z matches the bit at a time encoding", "[base32z]")
+{
+  std::mt19937 rng{7};
+  for (size_t sz = 0; sz <= 40; ++sz)
+  {
+    std::vector<uint8_t> in(sz);
+    for (auto& byte : in)
+      byte = rng();
+    const auto encoded = llarp::base32z::Encode(in.data(), in.size());
+    REQUIRE(encoded.size() == llarp::base32z::EncodedSize(sz));
+    REQUIRE(encoded == ReferenceEncode(in));
+
+    std::vector<uint8_t> out(sz);
+    REQUIRE(llarp::base32z::Decode(encoded, out.data(), out.size()));
+    REQUIRE(out == in);
+  }
+}
+
+TEST_CASE("base32z decode rejects what is not base32z", "[base32z]")
+{
+  std::vector<uint8_t> key(32, 0xab);
+  const auto encoded = llarp::base32z::Encode(key.data(), key.size());
+  std::vector<uint8_t> out(32, 0);
+
+  SECTION("a character outside the alphabet leaves out alone")
+  {
+    auto bad = encoded;
+    bad[10] = 'v';
+    REQUIRE_FALSE(llarp::base32z::Decode(bad, out.data(), out.size()));
+    REQUIRE(out == std::vector<uint8_t>(32, 0));
+  }
+  SECTION("the wrong length")
+  {
+    REQUIRE_FALSE(llarp::base32z::Decode(encoded.substr(1), out.data(), out.size()));
+  }
+  SECTION("upper case is taken as lower")
+  {
+    auto upper = encoded;
+    for (auto& ch : upper)
+      ch = std::toupper(ch);
+    REQUIRE(llarp::base32z::Decode(upper, out.data(), out.size()));
+    REQUIRE(out == key);
+  }
+}
+
+TEST_CASE("base32z keys come from the cache as encoded", "[base32z]")
+{
+  std::vector<uint8_t> first(32, 1), second(32, 1);
+  // the same cache slot, so the second pushes the first out
+  second[31] = 2;
+  for (const auto* key : {&first, &second, &first, &first})
+  {
+    std::string out = "prefix.";
+    llarp::base32z::AppendKey(out, key->data());
+    REQUIRE(out == "prefix." + llarp::base32z::Encode(key->data(), key->size()));
+  }
+}
@@ -1,7 +1,11 @@
+#include <util/aligned.hpp>
 #include <util/bencode.h>
 #include <util/bencode.hpp>
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -448,3 +452,112 @@ TEST(TestBencode, ReadDictEmptyBuffer)
   ASSERT_FALSE(llarp::bencode_read_dict(
       [](llarp_buffer_t*, llarp_buffer_t*) { return true; }, &buf));
 }
+
+TEST(TestBencode, ReadViewPointsIntoBuffer)
+{
+  std::string input = "5:hello3:abc";
+  llarp_buffer_t buf(input.data(), input.size());
+
+  llarp::BEncodeView<> view;
+  ASSERT_EQ(view.data(), nullptr);
+  ASSERT_TRUE(view.BDecode(&buf));
+  ASSERT_EQ(view.View(), "hello");
+  ASSERT_EQ(view.data(), reinterpret_cast< const byte_t* >(input.data()) + 2);
+
+  // over the limit is refused
+  llarp::BEncodeView< 2 > small;
+  ASSERT_FALSE(small.BDecode(&buf));
+
+  std::array< byte_t, 16 > tmp;
+  llarp_buffer_t out(tmp);
+  ASSERT_TRUE(view.BEncode(&out));
+  ASSERT_EQ(std::string(reinterpret_cast< char* >(tmp.data()), out.cur - out.base),
+            "5:hello");
+}
+
+namespace
+{
+  struct SchemaMessage
+  {
+    uint64_t version = 0;
+    uint64_t S       = 0;
+    llarp::AlignedBuffer< 16 > P;
+    llarp::BEncodeView<> XView;
+    llarp::AlignedBuffer< 8 > X;
+  };
+
+  using TestSchema = llarp::BEncodeSchema<
+      llarp::BEncodeDictMsgType< 'A', 't' >,
+      llarp::BEncodeDictEntry< 'P', &SchemaMessage::P >,
+      llarp::BEncodeDictInt< 'S', &SchemaMessage::S >,
+      llarp::BEncodeDictVersion< 'V' >,
+      llarp::BEncodeDictViewOr< 'X', &SchemaMessage::XView, &SchemaMessage::X > >;
+}  // namespace
+
+TEST(TestBencode, SchemaRoundTrip)
+{
+  SchemaMessage msg;
+  msg.S = 123456;
+  msg.P.Fill(0x11);
+  msg.X.Fill(0x22);
+
+  std::array< byte_t, 256 > tmp;
+  llarp_buffer_t buf(tmp);
+  ASSERT_TRUE(TestSchema::Encode(msg, &buf));
+  const size_t written = buf.cur - buf.base;
+  ASSERT_EQ(TestSchema::EncodedSize(msg), written);
+
+  buf.sz  = written;
+  buf.cur = buf.base;
+  SchemaMessage decoded;
+  ASSERT_TRUE(llarp::bencode_read_dict(
+      [&](llarp_buffer_t* val, llarp_buffer_t* key) {
+        return key == nullptr or TestSchema::DecodeKey(decoded, *key, val);
+      },
+      &buf));
+  ASSERT_EQ(decoded.S, msg.S);
+  ASSERT_EQ(decoded.P, msg.P);
+  ASSERT_EQ(decoded.version, LLARP_PROTO_VERSION);
+  // the owned value encodes, and comes back as a view
+  ASSERT_EQ(decoded.XView.View(), std::string(8, 0x22));
+
+  // once decoded it encodes from the view to the same bytes
+  std::array< byte_t, 256 > again;
+  llarp_buffer_t againBuf(again);
+  ASSERT_TRUE(TestSchema::Encode(decoded, &againBuf));
+  ASSERT_EQ(TestSchema::EncodedSize(decoded), written);
+  ASSERT_TRUE(std::equal(tmp.begin(), tmp.begin() + written, again.begin()));
+}
+
+TEST(TestBencode, SchemaRefusesUnknownKeysAndBadValues)
+{
+  SchemaMessage msg;
+  std::string unknown = "i1e";
+  llarp_buffer_t val(unknown.data(), unknown.size());
+  std::string key = "Q";
+  ASSERT_FALSE(TestSchema::DecodeKey(msg, llarp_buffer_t(key.data(), key.size()), &val));
+  key = "SS";
+  ASSERT_FALSE(TestSchema::DecodeKey(msg, llarp_buffer_t(key.data(), key.size()), &val));
+
+  std::string version = "i9999e";
+  llarp_buffer_t versionVal(version.data(), version.size());
+  key = "V";
+  ASSERT_FALSE(
+      TestSchema::DecodeKey(msg, llarp_buffer_t(key.data(), key.size()), &versionVal));
+
+  std::string type = "1:u";
+  llarp_buffer_t typeVal(type.data(), type.size());
+  key = "A";
+  ASSERT_FALSE(TestSchema::DecodeKey(msg, llarp_buffer_t(key.data(), key.size()), &typeVal));
+}
+
+TEST(TestBencode, SizeHelpersAreExact)
+{
+  ASSERT_EQ(llarp::BEncodeSizeInt(0), 3u);
+  ASSERT_EQ(llarp::BEncodeSizeInt(9), 3u);
+  ASSERT_EQ(llarp::BEncodeSizeInt(10), 4u);
+  ASSERT_EQ(llarp::BEncodeSizeInt(std::numeric_limits< uint64_t >::max()), 22u);
+  ASSERT_EQ(llarp::BEncodeSizeString(0), 2u);
+  ASSERT_EQ(llarp::BEncodeSizeString(5), 7u);
+  ASSERT_EQ(llarp::BEncodeSizeString(10), 13u);
+}
@@ -0,0 +1,157 @@
+#include <util/codel.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace std::literals;
+
+namespace
+{
+  struct Item
+  {
+    int value = 0;
+    llarp_time_t queued = 0s;
+
+    Item() = default;
+
+    explicit Item(int v) : value(v)
+    {}
+  };
+
+  llarp_time_t clockNow = 0s;
+
+  struct GetTime
+  {
+    llarp_time_t
+    operator()(const Item& item) const
+    {
+      return item.queued;
+    }
+  };
+
+  struct PutTime
+  {
+    void
+    operator()(Item& item) const
+    {
+      item.queued = clockNow;
+    }
+  };
+
+  struct GetNow
+  {
+    llarp_time_t
+    operator()() const
+    {
+      return clockNow;
+    }
+  };
+
+  struct Compare
+  {
+    bool
+    operator()(const Item& left, const Item& right) const
+    {
+      return left.queued < right.queued;
+    }
+  };
+
+  /// odd items take a mark
+  struct MarkOdd
+  {
+    bool
+    operator()(Item& item) const
+    {
+      if (item.value % 2 == 0)
+        return false;
+      item.value = -item.value;
+      return true;
+    }
+  };
+
+  using Queue_t = llarp::util::CoDelQueue<Item, GetTime, PutTime, Compare, GetNow, 8>;
+  using MarkingQueue_t =
+      llarp::util::CoDelQueue<Item, GetTime, PutTime, Compare, GetNow, 8, MarkOdd>;
+}  // namespace
+
+TEST_CASE("CoDelQueue hands items over in order and in batches", "[util]")
+{
+  clockNow = 1s;
+  Queue_t queue("test", PutTime{}, GetNow{});
+  for (int idx = 0; idx < 5; ++idx)
+    queue.Emplace(idx);
+  REQUIRE(queue.Size() == 5);
+
+  std::vector<int> seen;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); }, 3);
+  REQUIRE(seen == std::vector<int>{0, 1, 2});
+  REQUIRE(queue.Size() == 2);
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen == std::vector<int>{0, 1, 2, 3, 4});
+  REQUIRE(queue.Size() == 0);
+}
+
+TEST_CASE("CoDelQueue turns items away when full or refused", "[util]")
+{
+  clockNow = 1s;
+  Queue_t queue("test", PutTime{}, GetNow{});
+  for (int idx = 0; idx < 10; ++idx)
+    queue.Emplace(idx);
+  REQUIRE(queue.Size() == 8);
+  REQUIRE_FALSE(queue.EmplaceIf([](Item&) { return true; }, 10));
+
+  std::vector<int> seen;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen.size() == 8);
+  REQUIRE_FALSE(queue.EmplaceIf([](Item&) { return false; }, 11));
+  // recycled handles come back filled with the new item
+  REQUIRE(queue.EmplaceIf([](Item& item) { return item.value == 12; }, 12));
+  seen.clear();
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen == std::vector<int>{12});
+}
+
+TEST_CASE("CoDelQueue drops when everything sat too long", "[util]")
+{
+  clockNow = 1s;
+  Queue_t queue("test", PutTime{}, GetNow{});
+  for (int idx = 0; idx < 4; ++idx)
+    queue.Emplace(idx);
+  clockNow += 200ms;
+
+  std::vector<int> seen;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  // the newest goes and the queue backs off before the next batch
+  REQUIRE(seen == std::vector<int>{0, 1, 2});
+  queue.Emplace(4);
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen.size() == 3);
+  clockNow += 20ms;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen == std::vector<int>{0, 1, 2, 4});
+}
+
+TEST_CASE("CoDelQueue marks instead of dropping what can take a mark", "[util]")
+{
+  clockNow = 1s;
+  MarkingQueue_t queue("test", PutTime{}, GetNow{});
+  for (int idx = 0; idx < 4; ++idx)
+    queue.Emplace(idx);
+  clockNow += 200ms;
+
+  std::vector<int> seen;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  // the newest is marked and goes on, the queue still backs off
+  REQUIRE(seen == std::vector<int>{0, 1, 2, -3});
+  REQUIRE(queue.Marks() == 1);
+  queue.Emplace(4);
+  queue.Emplace(6);
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  REQUIRE(seen.size() == 4);
+  clockNow += 200ms;
+  queue.Process([&seen](Item& item) { seen.push_back(item.value); });
+  // one that cannot be marked is dropped as before
+  REQUIRE(seen == std::vector<int>{0, 1, 2, -3, 4});
+  REQUIRE(queue.Marks() == 1);
+}
@@ -0,0 +1,38 @@
+#include <util/cpu_profiler.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("cpu profile samples a busy thread", "[util]")
+{
+  if (not llarp::util::CpuProfilingSupported())
+  {
+    CHECK(not llarp::util::ProfileCpu(std::chrono::milliseconds{10}, 100));
+    return;
+  }
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> spins{0};
+  std::thread busy{[&]() {
+    while (not stop)
+      spins++;
+  }};
+
+  std::optional<llarp::util::CpuProfile> second;
+  std::thread other{[&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    second = llarp::util::ProfileCpu(std::chrono::milliseconds{10}, 100);
+  }};
+  const auto profile = llarp::util::ProfileCpu(std::chrono::milliseconds{300}, 200);
+  stop = true;
+  busy.join();
+  other.join();
+
+  // only one runs at a time
+  CHECK(not second);
+  REQUIRE(profile);
+  CHECK(profile->samples > 0);
+  CHECK(profile->dropped == 0);
+  CHECK(not profile->folded.empty());
+}
@@ -0,0 +1,87 @@
+#include <util/decaying_bloom_filter.hpp>
+
+#include <array>
+#include <random>
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+  using Nonce_t = std::array<uint64_t, 4>;
+  using Filter_t = llarp::util::DecayingBloomFilter<Nonce_t>;
+
+  Nonce_t
+  RandomNonce(std::mt19937_64& rng)
+  {
+    return Nonce_t{rng(), rng(), rng(), rng()};
+  }
+}  // namespace
+
+TEST_CASE("DecayingBloomFilter rejects replays", "[decaying-bloom-filter]")
+{
+  std::mt19937_64 rng{1};
+  Filter_t filter{1024, 1e-6};
+  REQUIRE(filter.MemoryUsage() == 0);
+  const auto nonce = RandomNonce(rng);
+  REQUIRE(not filter.Contains(nonce));
+  REQUIRE(filter.Insert(nonce, 1s));
+  REQUIRE(filter.Contains(nonce));
+  REQUIRE(not filter.Insert(nonce, 1s));
+  REQUIRE(filter.MemoryUsage() == 2 * filter.NumBits() / 8);
+}
+
+TEST_CASE("DecayingBloomFilter decays after the interval", "[decaying-bloom-filter]")
+{
+  static constexpr auto interval = 5s;
+  static constexpr auto now = 1s;
+  std::mt19937_64 rng{2};
+  Filter_t filter{1024, 1e-6, interval};
+  const auto nonce = RandomNonce(rng);
+  REQUIRE(filter.Insert(nonce, now));
+  // kept for at least one interval, and at most two
+  filter.Decay(now + interval - 1s);
+  REQUIRE(filter.Contains(nonce));
+  filter.Decay(now + interval);
+  REQUIRE(filter.Contains(nonce));
+  filter.Decay(now + 2 * interval);
+  REQUIRE(not filter.Contains(nonce));
+}
+
+TEST_CASE("DecayingBloomFilter forgets everything when idle", "[decaying-bloom-filter]")
+{
+  static constexpr auto interval = 5s;
+  std::mt19937_64 rng{3};
+  Filter_t filter{1024, 1e-6, interval};
+  const auto nonce = RandomNonce(rng);
+  REQUIRE(filter.Insert(nonce, 1s));
+  filter.Decay(1s + 3 * interval);
+  REQUIRE(not filter.Contains(nonce));
+  // and holds no memory until it is used again
+  REQUIRE(filter.MemoryUsage() == 0);
+  REQUIRE(filter.Insert(nonce, 1s + 3 * interval));
+  REQUIRE(filter.MemoryUsage() == 2 * filter.NumBits() / 8);
+}
+
+TEST_CASE("DecayingBloomFilter remembers a full capacity", "[decaying-bloom-filter]")
+{
+  static constexpr size_t capacity = 1024;
+  std::mt19937_64 rng{4};
+  Filter_t filter{capacity, 1e-6};
+  std::vector<Nonce_t> nonces;
+  size_t dropped = 0;
+  for (size_t idx = 0; idx < capacity * 10; ++idx)
+  {
+    nonces.emplace_back(RandomNonce(rng));
+    if (not filter.Insert(nonces.back(), 1s))
+      dropped++;
+  }
+  // early rotation keeps the generations from filling past what the false positive rate allows
+  REQUIRE(dropped <= 1);
+  // the last capacity inserts are always remembered
+  for (size_t idx = nonces.size() - capacity; idx < nonces.size(); ++idx)
+    REQUIRE(filter.Contains(nonces[idx]));
+  const size_t memory = filter.MemoryUsage();
+  for (size_t idx = 0; idx < capacity; ++idx)
+    filter.Insert(RandomNonce(rng), 1s);
+  REQUIRE(filter.MemoryUsage() == memory);
+}
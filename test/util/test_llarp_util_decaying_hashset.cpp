@@ -1,4 +1,5 @@
 #include <util/decaying_hashset.hpp>
+#include <util/decaying_hashtable.hpp>
 #include <router_id.hpp>
 #include <catch2/catch.hpp>
 
@@ -37,3 +38,71 @@ TEST_CASE("DecayingHashSet tset decay dynamic time", "[decaying-hashset]")
   hashset.Decay(now + timeout + 1s);
   REQUIRE(not hashset.Contains(zero));
 }
+
+TEST_CASE("DecayingHashSet decays in insertion time order", "[decaying-hashset]")
+{
+  static constexpr auto timeout = 5s;
+  llarp::util::DecayingHashSet<llarp::RouterID> hashset(timeout);
+  llarp::RouterID a, b, c;
+  a.Fill(1);
+  b.Fill(2);
+  c.Fill(3);
+  REQUIRE(hashset.Insert(a, 10s));
+  REQUIRE(hashset.Insert(b, 12s));
+  // earlier than the newest, goes in before it
+  REQUIRE(hashset.Insert(c, 11s));
+  REQUIRE(not hashset.Insert(a, 13s));
+
+  hashset.Decay(15s);
+  CHECK(not hashset.Contains(a));
+  CHECK(hashset.Contains(b));
+  CHECK(hashset.Contains(c));
+  hashset.Decay(16s);
+  CHECK(not hashset.Contains(c));
+  CHECK(hashset.Contains(b));
+  hashset.Decay(17s);
+  CHECK(hashset.Empty());
+}
+
+TEST_CASE("DecayingHashSet with a max size drops the oldest", "[decaying-hashset]")
+{
+  llarp::util::DecayingHashSet<llarp::RouterID> hashset(5s, 2);
+  llarp::RouterID a, b, c;
+  a.Fill(1);
+  b.Fill(2);
+  c.Fill(3);
+  REQUIRE(hashset.Insert(a, 1s));
+  REQUIRE(hashset.Insert(b, 2s));
+  REQUIRE(hashset.Insert(c, 3s));
+  CHECK(hashset.Size() == 2);
+  CHECK(not hashset.Contains(a));
+  CHECK(hashset.Contains(b));
+  CHECK(hashset.Contains(c));
+  // a went, so it can come back
+  REQUIRE(hashset.Insert(a, 4s));
+  CHECK(not hashset.Contains(b));
+  hashset.Decay(8s);
+  CHECK(hashset.Size() == 1);
+  CHECK(hashset.Contains(a));
+}
+
+TEST_CASE("DecayingHashTable decays and keeps to its max size", "[decaying-hashset]")
+{
+  llarp::util::DecayingHashTable<llarp::RouterID, int> table(5s, 2);
+  llarp::RouterID a, b, c;
+  a.Fill(1);
+  b.Fill(2);
+  c.Fill(3);
+  REQUIRE(table.Put(a, 1, 1s));
+  REQUIRE(not table.Put(a, 2, 1s));
+  CHECK(table.Get(a) == 1);
+  REQUIRE(table.Put(b, 2, 2s));
+  REQUIRE(table.Put(c, 3, 3s));
+  CHECK(not table.Has(a));
+  CHECK(table.Size() == 2);
+  table.Decay(7s);
+  CHECK(not table.Has(b));
+  CHECK(table.Get(c) == 3);
+  table.Decay(8s);
+  CHECK(table.Size() == 0);
+}
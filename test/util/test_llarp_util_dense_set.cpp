@@ -0,0 +1,49 @@
+#include <util/dense_set.hpp>
+#include <router_id.hpp>
+#include <catch2/catch.hpp>
+
+#include <set>
+
+TEST_CASE("DenseSet keeps its members packed", "[dense-set]")
+{
+  llarp::util::DenseSet<llarp::RouterID> set;
+  std::vector<llarp::RouterID> ids(5);
+  for (size_t idx = 0; idx < ids.size(); ++idx)
+  {
+    ids[idx][0] = idx + 1;
+    REQUIRE(set.Insert(ids[idx]));
+  }
+  REQUIRE_FALSE(set.Insert(ids[0]));
+  REQUIRE(set.Size() == 5);
+
+  SECTION("removing swaps the last one in")
+  {
+    REQUIRE(set.Remove(ids[1]));
+    REQUIRE_FALSE(set.Remove(ids[1]));
+    REQUIRE_FALSE(set.Contains(ids[1]));
+    REQUIRE(set.Size() == 4);
+    REQUIRE(set[1] == ids[4]);
+
+    // the moved one can still be removed by value
+    REQUIRE(set.Remove(ids[4]));
+    std::set<llarp::RouterID> members;
+    for (size_t idx = 0; idx < set.Size(); ++idx)
+      members.insert(set[idx]);
+    REQUIRE(members == std::set<llarp::RouterID>{ids[0], ids[2], ids[3]});
+  }
+
+  SECTION("removing the last one")
+  {
+    REQUIRE(set.Remove(ids[4]));
+    REQUIRE(set.Size() == 4);
+    REQUIRE(set[3] == ids[3]);
+  }
+
+  SECTION("clear")
+  {
+    set.Clear();
+    REQUIRE(set.Empty());
+    REQUIRE_FALSE(set.Contains(ids[0]));
+    REQUIRE(set.Insert(ids[0]));
+  }
+}
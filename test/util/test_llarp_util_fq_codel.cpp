@@ -0,0 +1,107 @@
+#include <util/fq_codel.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std::literals;
+using Queues = llarp::util::FlowQueues<int, 8, 64>;
+
+namespace
+{
+  /// every item takes a mark, which flips its sign
+  struct MarkAll
+  {
+    bool
+    operator()(int& item) const
+    {
+      item = -item;
+      return true;
+    }
+  };
+}  // namespace
+
+TEST_CASE("FlowQueues serves flows in turn", "[util]")
+{
+  Queues queues;
+  // a bulk flow queued first, then one small packet on another flow
+  for (int idx = 0; idx < 10; ++idx)
+    queues.Push(1, idx, 1000, 0s);
+  queues.Push(2, 100, 100, 0s);
+  REQUIRE(queues.Size() == 11);
+
+  std::vector<int> order;
+  const auto sent = queues.Pop(1ms, 3000, [&order](int item) { order.push_back(item); });
+  REQUIRE(sent == 3100);
+  // the bulk flow gets its quantum, then the small flow goes before the rest of it
+  REQUIRE(order == std::vector<int>{0, 1, 100, 2});
+  REQUIRE(queues.Size() == 7);
+  REQUIRE(queues.Delays().Count() == 4);
+}
+
+TEST_CASE("FlowQueues keeps order within a flow", "[util]")
+{
+  Queues queues;
+  for (int idx = 0; idx < 5; ++idx)
+    queues.Push(3, idx, 100, 0s);
+  std::vector<int> order;
+  queues.Pop(1ms, 100000, [&order](int item) { order.push_back(item); });
+  REQUIRE(order == std::vector<int>{0, 1, 2, 3, 4});
+  REQUIRE(queues.Empty());
+  REQUIRE(queues.Drops() == 0);
+}
+
+TEST_CASE("FlowQueues drops from the fattest flow when full", "[util]")
+{
+  Queues queues;
+  for (int idx = 0; idx < 64; ++idx)
+    queues.Push(1, idx, 1000, 0s);
+  queues.Push(2, 100, 100, 0s);
+  REQUIRE(queues.Size() == 64);
+  REQUIRE(queues.Drops() == 1);
+
+  std::vector<int> order;
+  queues.Pop(1ms, 100000, [&order](int item) { order.push_back(item); });
+  REQUIRE(order.size() == 64);
+  // the bulk flow lost its oldest, the small flow lost nothing
+  REQUIRE(order.front() == 1);
+  REQUIRE(std::count(order.begin(), order.end(), 100) == 1);
+}
+
+TEST_CASE("FlowQueues drops what sat too long under a standing queue", "[util]")
+{
+  Queues queues;
+  for (int idx = 0; idx < 20; ++idx)
+    queues.Push(1, idx, 1000, 0s);
+  std::vector<int> order;
+  const auto visit = [&order](int item) { order.push_back(item); };
+  // long past target, the first dequeue only starts the interval
+  queues.Pop(1s, 1000, visit);
+  REQUIRE(queues.Drops() == 0);
+  // still above target a whole interval later, codel starts dropping
+  queues.Pop(1s + Queues::Interval, 1000, visit);
+  REQUIRE(queues.Drops() > 0);
+  REQUIRE(order.size() == 2);
+  REQUIRE(order[1] > 1);
+}
+
+TEST_CASE("FlowQueues marks instead of dropping what can take a mark", "[util]")
+{
+  llarp::util::FlowQueues<int, 8, 64, MarkAll> queues;
+  for (int idx = 1; idx <= 20; ++idx)
+    queues.Push(1, idx, 1000, 0s);
+  std::vector<int> order;
+  const auto visit = [&order](int item) { order.push_back(item); };
+  queues.Pop(1s, 1000, visit);
+  queues.Pop(1s + Queues::Interval, 1000, visit);
+  // codel would have dropped here, the head went on marked instead
+  REQUIRE(queues.Drops() == 0);
+  REQUIRE(queues.Marks() == 1);
+  REQUIRE(order == std::vector<int>{1, -2});
+  // more marks come at the control law's pace while the queue stands
+  queues.Pop(1s + Queues::Interval * 3, 100000, visit);
+  REQUIRE(queues.Drops() == 0);
+  REQUIRE(queues.Marks() > 1);
+  REQUIRE(order.size() == 20);
+}
@@ -0,0 +1,28 @@
+#include <util/histogram.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+using llarp::util::DurationHistogram;
+
+TEST_CASE("DurationHistogram buckets by power of two milliseconds", "[util]")
+{
+  DurationHistogram hist;
+  hist.Add(500us);
+  hist.Add(1ms);
+  hist.Add(3ms);
+  hist.Add(3900us);
+  hist.Add(1h);
+
+  REQUIRE(hist.Count() == 5);
+  REQUIRE(hist.Max() == 1h);
+  const auto status = hist.ExtractStatus();
+  const auto& buckets = status["buckets"];
+  REQUIRE(buckets["<1ms"] == 1);
+  REQUIRE(buckets["<2ms"] == 1);
+  REQUIRE(buckets["<4ms"] == 2);
+  REQUIRE(buckets["<8ms"] == 0);
+  // anything past the top bucket lands in it
+  REQUIRE(buckets[">=1024ms"] == 1);
+  REQUIRE(status["lastUs"] == std::chrono::microseconds{1h}.count());
+}
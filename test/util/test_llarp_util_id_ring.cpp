@@ -0,0 +1,79 @@
+#include <util/id_ring.hpp>
+#include <util/replay_window.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+
+TEST_CASE("IdRing stores and takes values by id", "[id-ring]")
+{
+  llarp::util::IdRing<std::string, 64, 4> ring;
+  REQUIRE(ring.empty());
+  REQUIRE(ring.Find(0) == nullptr);
+  for (uint64_t id = 0; id < 4; ++id)
+    REQUIRE(ring.Emplace(id, std::to_string(id)).second);
+  REQUIRE(ring.size() == 4);
+  REQUIRE(ring.Capacity() == 4);
+  REQUIRE(not ring.Emplace(2, "dupe").second);
+  REQUIRE(*ring.Find(2) == "2");
+
+  auto taken = ring.Take(1);
+  REQUIRE(taken.has_value());
+  REQUIRE(*taken == "1");
+  REQUIRE(not ring.Contains(1));
+  REQUIRE(ring.size() == 3);
+  REQUIRE(not ring.Take(1).has_value());
+}
+
+TEST_CASE("IdRing grows when live ids collide", "[id-ring]")
+{
+  llarp::util::IdRing<int, 16, 4> ring;
+  REQUIRE(ring.Emplace(0, 0).second);
+  // 4 lands on the same slot as 0
+  REQUIRE(ring.Emplace(4, 4).second);
+  REQUIRE(ring.Capacity() == 8);
+  REQUIRE(*ring.Find(0) == 0);
+  REQUIRE(*ring.Find(4) == 4);
+  // a free slot is reused without growing
+  ring.Erase(0);
+  REQUIRE(ring.Emplace(8, 8).second);
+  REQUIRE(ring.Capacity() == 8);
+
+  int sum = 0;
+  ring.ForEach([&sum](uint64_t, int val) { sum += val; });
+  REQUIRE(sum == 12);
+}
+
+TEST_CASE("IdRing refuses ids too far apart", "[id-ring]")
+{
+  llarp::util::IdRing<int, 8, 4> ring;
+  REQUIRE(ring.Emplace(0, 0).second);
+  const auto [ptr, inserted] = ring.Emplace(8, 8);
+  REQUIRE(ptr == nullptr);
+  REQUIRE(not inserted);
+  REQUIRE(ring.Capacity() == 8);
+}
+
+TEST_CASE("ReplayWindow tracks sequential ids", "[replay-window]")
+{
+  llarp::util::ReplayWindow<8> window;
+  REQUIRE(not window.Contains(0));
+  REQUIRE(window.Insert(0));
+  REQUIRE(not window.Insert(0));
+  REQUIRE(window.Contains(0));
+  // out of order inside the window is fine
+  REQUIRE(window.Insert(5));
+  REQUIRE(not window.Contains(3));
+  REQUIRE(window.Insert(3));
+  REQUIRE(window.size() == 3);
+  // sliding forward forgets the slots we pass over
+  REQUIRE(window.Insert(9));
+  REQUIRE(not window.Contains(8));
+  REQUIRE(not window.Contains(4));
+  // fell off the back, treated as seen
+  REQUIRE(window.Contains(1));
+  REQUIRE(not window.Insert(1));
+  // jumping a whole window clears everything
+  REQUIRE(window.Insert(100));
+  REQUIRE(window.size() == 1);
+  REQUIRE(window.Contains(50));
+}
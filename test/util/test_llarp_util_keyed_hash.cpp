@@ -0,0 +1,46 @@
+#include <util/aligned.hpp>
+#include <util/keyed_hash.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <vector>
+
+TEST_CASE("KeyedHash depends on the key, every byte and the length", "[keyed_hash]")
+{
+  const llarp::HashKey key{0x0706050403020100ULL, 0x0f0e0d0c0b0a0908ULL};
+  const llarp::HashKey other{0x0706050403020100ULL, 0x0f0e0d0c0b0a0909ULL};
+  std::vector<uint8_t> data(40);
+  for (size_t idx = 0; idx < data.size(); ++idx)
+    data[idx] = idx * 7;
+
+  const auto base = llarp::KeyedHash(data.data(), data.size(), key);
+  CHECK(llarp::KeyedHash(data.data(), data.size(), key) == base);
+  CHECK(llarp::KeyedHash(data.data(), data.size(), other) != base);
+
+  std::set<uint64_t> seen{base};
+  for (size_t idx = 0; idx < data.size(); ++idx)
+  {
+    auto flipped = data;
+    flipped[idx] ^= 1;
+    CHECK(seen.insert(llarp::KeyedHash(flipped.data(), flipped.size(), key)).second);
+  }
+
+  // all zero inputs only differ in how long they are
+  const std::vector<uint8_t> zeros(40);
+  std::set<uint64_t> byLength;
+  for (size_t sz = 0; sz <= zeros.size(); ++sz)
+    CHECK(byLength.insert(llarp::KeyedHash(zeros.data(), sz, key)).second);
+}
+
+TEST_CASE("AlignedBuffer::Hash covers every byte", "[keyed_hash]")
+{
+  using Buf = llarp::AlignedBuffer<16>;
+  Buf a, b;
+  a.Randomize();
+  b = a;
+  CHECK(Buf::Hash()(a) == Buf::Hash()(b));
+  // it used to only look at the first word
+  b[15] ^= 1;
+  CHECK(Buf::Hash()(a) != Buf::Hash()(b));
+}
@@ -0,0 +1,124 @@
+#include <util/logging/logger.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  /// keeps what was logged
+  struct CaptureStream : public llarp::ILogStream
+  {
+    std::vector<std::string>& lines;
+
+    explicit CaptureStream(std::vector<std::string>& out) : lines(out)
+    {}
+
+    void
+    PreLog(std::stringstream&, llarp::LogLevel, const char*, int, const std::string&)
+        const override
+    {}
+
+    void
+    Print(llarp::LogLevel, const char*, const std::string& msg) override
+    {
+      lines.emplace_back(msg);
+    }
+
+    void
+    PostLog(std::stringstream&) const override
+    {}
+
+    void
+    ImmediateFlush() override
+    {}
+
+    void
+    Tick(llarp_time_t) override
+    {}
+  };
+}  // namespace
+
+TEST_CASE("Log statements below the level skip their arguments", "[logging]")
+{
+  auto& ctx = llarp::LogContext::Instance();
+  std::vector<std::string> lines;
+  auto oldStream = std::move(ctx.logStream);
+  const auto oldLevel = ctx.curLevel;
+  ctx.logStream = std::make_unique<CaptureStream>(lines);
+  ctx.curLevel = llarp::eLogInfo;
+
+  int evaluated = 0;
+  const auto arg = [&evaluated]() { return ++evaluated; };
+  llarp::LogDebug("debug ", arg());
+  llarp::LogTrace("trace ", arg());
+  CHECK(evaluated == 0);
+  llarp::LogInfo("info ", arg());
+  CHECK(evaluated == 1);
+  CHECK(lines == std::vector<std::string>{"info 1"});
+
+  // nowhere to log to
+  ctx.logStream.reset();
+  llarp::LogError("error ", arg());
+  CHECK(evaluated == 1);
+
+  ctx.logStream = std::move(oldStream);
+  ctx.curLevel = oldLevel;
+}
+
+TEST_CASE("Binary log stream writes call sites and raw arguments", "[logging]")
+{
+  auto& ctx = llarp::LogContext::Instance();
+  auto oldStream = std::move(ctx.logStream);
+  const auto oldLevel = ctx.curLevel;
+  ctx.curLevel = llarp::eLogInfo;
+
+  FILE* f = std::tmpfile();
+  REQUIRE(f != nullptr);
+  ctx.logStream =
+      std::make_unique<llarp::BinaryLogStream>([](auto work) { work(); }, f, 1h);
+  llarp::LogInfoExplicit("here.cpp", 7, "n=", 42, " x");
+  llarp::LogWarnExplicit("here.cpp", 7, "n=", 43u, " x");
+  ctx.logStream->ImmediateFlush();
+
+  std::vector<uint8_t> data(4096);
+  std::rewind(f);
+  data.resize(std::fread(data.data(), 1, data.size(), f));
+  ctx.logStream = std::move(oldStream);
+  ctx.curLevel = oldLevel;
+
+  const std::string_view site{"here.cpp"};
+  // magic, then the site once and the two records that use it
+  const size_t siteSize = 1 + 4 + 4 + 2 + site.size();
+  const size_t payloadSize = (1 + 2 + 2) + (1 + 8) + (1 + 2 + 2);
+  const size_t recordSize = 1 + 8 + 2 + 1 + 4 + 1 + 2 + payloadSize;
+  REQUIRE(data.size() == 5 + siteSize + 2 * recordSize);
+  CHECK(std::memcmp(data.data(), "LLBL\x01", 5) == 0);
+
+  const uint8_t* ptr = data.data() + 5;
+  CHECK(ptr[0] == 1);
+  int32_t line;
+  std::memcpy(&line, ptr + 5, 4);
+  CHECK(line == 7);
+  CHECK(std::string_view{reinterpret_cast<const char*>(ptr + 11), site.size()} == site);
+
+  ptr += siteSize;
+  for (const auto& [level, tag] : {std::pair{llarp::eLogInfo, 'i'}, {llarp::eLogWarn, 'u'}})
+  {
+    CHECK(ptr[0] == 2);
+    CHECK(ptr[11] == level);
+    // not truncated
+    CHECK(ptr[16] == 0);
+    const uint8_t* arg = ptr + 19;
+    CHECK(arg[0] == 's');
+    CHECK(std::memcmp(arg + 3, "n=", 2) == 0);
+    CHECK(arg[5] == tag);
+    int64_t val;
+    std::memcpy(&val, arg + 6, 8);
+    CHECK(val == (level == llarp::eLogInfo ? 42 : 43));
+    CHECK(std::memcmp(arg + 17, " x", 2) == 0);
+    ptr += recordSize;
+  }
+}
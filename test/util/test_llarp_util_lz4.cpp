@@ -0,0 +1,80 @@
+#include <util/lz4.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  std::vector<uint8_t>
+  RoundTrip(const std::vector<uint8_t>& in)
+  {
+    std::vector<uint8_t> block(llarp::lz4::CompressBound(in.size()));
+    const size_t sz = llarp::lz4::Compress(in.data(), in.size(), block.data(), block.size());
+    REQUIRE(sz > 0);
+    block.resize(sz);
+    std::vector<uint8_t> out(in.size());
+    REQUIRE(llarp::lz4::Decompress(block.data(), block.size(), out.data(), out.size()));
+    return block;
+  }
+}  // namespace
+
+TEST_CASE("lz4 reads blocks as the lz4 format lays them out", "[util][lz4]")
+{
+  // "abc", a match 3 back of 10 more, then the last 5 as literals
+  const std::vector<uint8_t> block{0x36, 'a', 'b', 'c', 3, 0, 0x50, 'b', 'c', 'a', 'b', 'c'};
+  std::string out(18, '\0');
+  REQUIRE(llarp::lz4::Decompress(
+      block.data(), block.size(), reinterpret_cast<uint8_t*>(out.data()), out.size()));
+  CHECK(out == "abcabcabcabcabcabc");
+}
+
+TEST_CASE("lz4 gives back what it compressed", "[util][lz4]")
+{
+  std::mt19937 rng{42};
+  SECTION("text shrinks")
+  {
+    std::string text;
+    while (text.size() < 1400)
+      text += "<li class=\"item\"><a href=\"/posts/" + std::to_string(rng() % 100)
+          + "\">post</a></li>";
+    const std::vector<uint8_t> in(text.begin(), text.end());
+    CHECK(RoundTrip(in).size() < in.size() / 2);
+  }
+  SECTION("long runs need long lengths")
+  {
+    std::vector<uint8_t> in(5000, 7);
+    in.insert(in.end(), 300, 9);
+    CHECK(RoundTrip(in).size() < 64);
+  }
+  SECTION("random bytes barely grow")
+  {
+    std::vector<uint8_t> in(1400);
+    for (auto& byte : in)
+      byte = rng();
+    CHECK(RoundTrip(in).size() <= llarp::lz4::CompressBound(in.size()));
+  }
+  SECTION("short inputs are all literals")
+  {
+    for (size_t sz = 0; sz < 20; ++sz)
+      RoundTrip(std::vector<uint8_t>(sz, 1));
+  }
+}
+
+TEST_CASE("lz4 turns away blocks that do not fit", "[util][lz4]")
+{
+  const std::vector<uint8_t> in(500, 'x');
+  std::vector<uint8_t> block(16);
+  CHECK(llarp::lz4::Compress(in.data(), in.size(), block.data(), 2) == 0);
+  const size_t sz = llarp::lz4::Compress(in.data(), in.size(), block.data(), block.size());
+  REQUIRE(sz > 0);
+  std::vector<uint8_t> out(in.size());
+  CHECK_FALSE(llarp::lz4::Decompress(block.data(), sz, out.data(), out.size() - 1));
+  CHECK_FALSE(llarp::lz4::Decompress(block.data(), sz - 1, out.data(), out.size()));
+
+  // a match reaching back before the start
+  const std::vector<uint8_t> bad{0x10, 'a', 5, 0, 0x00};
+  CHECK_FALSE(llarp::lz4::Decompress(bad.data(), bad.size(), out.data(), 10));
+}
@@ -0,0 +1,93 @@
+#include <util/metrics.hpp>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::metrics::Histogram;
+using llarp::metrics::Registry;
+
+TEST_CASE("metrics registry gives back the same metric for a name", "[util]")
+{
+  Registry registry;
+  auto& counter = registry.AddCounter("llarp_test_total", "things");
+  counter.Inc();
+  auto& again = registry.AddCounter("llarp_test_total", "things");
+  REQUIRE(&again == &counter);
+  REQUIRE(again.Value() == 1);
+  REQUIRE_THROWS_AS(registry.AddGauge("llarp_test_total", "things"), std::invalid_argument);
+}
+
+TEST_CASE("metrics counters add up across threads", "[util]")
+{
+  Registry registry;
+  auto& counter = registry.AddCounter("llarp_test_total", "things");
+  std::vector<std::thread> threads;
+  for (int idx = 0; idx < 4; ++idx)
+    threads.emplace_back([&counter]() {
+      for (int n = 0; n < 1000; ++n)
+        counter.Inc();
+    });
+  for (auto& thread : threads)
+    thread.join();
+  REQUIRE(counter.Value() == 4000);
+}
+
+TEST_CASE("metrics histogram buckets by upper bound", "[util]")
+{
+  REQUIRE_THROWS_AS(Histogram({10, 1}), std::invalid_argument);
+
+  Histogram hist{{10, 100}};
+  for (const uint64_t val : {1, 10, 11, 100, 5000})
+    hist.Observe(val);
+  REQUIRE(hist.BucketCount(0) == 2);
+  REQUIRE(hist.BucketCount(1) == 2);
+  REQUIRE(hist.BucketCount(2) == 1);
+  REQUIRE(hist.Count() == 5);
+  REQUIRE(hist.Sum() == 5122);
+}
+
+TEST_CASE("metrics registry writes the prometheus text format", "[util]")
+{
+  Registry registry;
+  registry.AddCounter("llarp_test_total", "things").Inc(3);
+  registry.AddGauge("llarp_test_level", "a level").Set(-2);
+  auto& hist = registry.AddHistogram("llarp_test_us", "durations", {10, 100});
+  hist.Observe(5);
+  hist.Observe(50);
+  hist.Observe(500);
+
+  const auto text = registry.PrometheusText();
+  CHECK(
+      text
+      == "# HELP llarp_test_total things\n"
+         "# TYPE llarp_test_total counter\n"
+         "llarp_test_total 3\n"
+         "# HELP llarp_test_level a level\n"
+         "# TYPE llarp_test_level gauge\n"
+         "llarp_test_level -2\n"
+         "# HELP llarp_test_us durations\n"
+         "# TYPE llarp_test_us histogram\n"
+         "llarp_test_us_bucket{le=\"10\"} 1\n"
+         "llarp_test_us_bucket{le=\"100\"} 2\n"
+         "llarp_test_us_bucket{le=\"+Inf\"} 3\n"
+         "llarp_test_us_sum 555\n"
+         "llarp_test_us_count 3\n");
+}
+
+TEST_CASE("latency bounds split each doubling in two", "[util]")
+{
+  const auto bounds = llarp::metrics::LatencyBounds();
+  REQUIRE(bounds.front() == 1);
+  CHECK(
+      std::vector<uint64_t>(bounds.begin(), bounds.begin() + 5)
+      == std::vector<uint64_t>{1, 2, 3, 4, 6});
+  CHECK(bounds.back() == (uint64_t{1} << 23) + (uint64_t{1} << 22));
+
+  Histogram hist{bounds};
+  hist.ObserveSince(Histogram::Clock_t::now() - std::chrono::milliseconds{5});
+  REQUIRE(hist.Count() == 1);
+  CHECK(hist.Sum() >= 5000);
+}
@@ -0,0 +1,76 @@
+#include <util/padding.hpp>
+
+#include <constants/path.hpp>
+#include <messages/relay_commit.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+
+using namespace llarp;
+
+TEST_CASE("Padding profiles parse from their names", "[padding]")
+{
+  for (const auto profile :
+       {padding::Profile::None, padding::Profile::Bucketed, padding::Profile::ConstantRate})
+  {
+    const auto parsed = padding::ParseProfile(padding::ToString(profile));
+    REQUIRE(parsed);
+    CHECK(*parsed == profile);
+  }
+  CHECK_FALSE(padding::ParseProfile("bucket"));
+  CHECK_FALSE(padding::ParseProfile(""));
+}
+
+TEST_CASE("Cells are padded to the profile's bucket", "[padding]")
+{
+  constexpr size_t maxsz = 4096;
+  CHECK(padding::CellPadding(padding::Profile::None, 1, maxsz) == 0);
+  CHECK(padding::CellPadding(padding::Profile::None, 300, maxsz) == 0);
+
+  CHECK(padding::CellPadding(padding::Profile::Bucketed, 0, maxsz) == path::pad_size);
+  CHECK(padding::CellPadding(padding::Profile::Bucketed, 1, maxsz) == path::pad_size - 1);
+  CHECK(padding::CellPadding(padding::Profile::Bucketed, path::pad_size, maxsz) == 0);
+  CHECK(padding::CellPadding(padding::Profile::Bucketed, 300, maxsz) == 3 * path::pad_size - 300);
+
+  CHECK(padding::CellPadding(padding::Profile::ConstantRate, 1, maxsz) == 511);
+  CHECK(padding::CellPadding(padding::Profile::ConstantRate, 600, maxsz) == 1024 - 600);
+
+  // never past what the buffer holds
+  CHECK(padding::CellPadding(padding::Profile::ConstantRate, 4000, maxsz) == 96);
+  CHECK(padding::CellPadding(padding::Profile::Bucketed, maxsz, maxsz) == 0);
+}
+
+TEST_CASE("Link control packets are padded unless the profile is none", "[padding]")
+{
+  CHECK(padding::LinkPadding(padding::Profile::None).min == 0);
+  CHECK(padding::LinkPadding(padding::Profile::None).variance == 0);
+  CHECK(padding::LinkPadding(padding::Profile::Bucketed).min == 16);
+  CHECK(padding::LinkPadding(padding::Profile::Bucketed).variance == 16);
+}
+
+TEST_CASE("Padding profile goes in the commit record only when it is not the default", "[padding]")
+{
+  LR_CommitRecord record;
+  record.nextHop.Fill(1);
+  record.tunnelNonce.Fill(2);
+  record.rxid.Fill(3);
+  record.txid.Fill(4);
+  record.version = LLARP_PROTO_VERSION;
+
+  std::array<byte_t, 1024> tmp;
+  llarp_buffer_t buf(tmp);
+  REQUIRE(record.BEncode(&buf));
+  const std::string plain(reinterpret_cast<const char*>(tmp.data()), buf.cur - buf.base);
+  CHECK(plain.find("1:pi") == std::string::npos);
+
+  record.padding = padding::Profile::ConstantRate;
+  buf.cur = buf.base;
+  REQUIRE(record.BEncode(&buf));
+  buf.sz = buf.cur - buf.base;
+  buf.cur = buf.base;
+  LR_CommitRecord decoded;
+  REQUIRE(decoded.BDecode(&buf));
+  CHECK(decoded == record);
+  CHECK(decoded.padding == padding::Profile::ConstantRate);
+}
@@ -0,0 +1,72 @@
+#include <util/numa.hpp>
+#include <util/pool.hpp>
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("PoolAlloc recycles freed blocks", "[pool]")
+{
+  void* first = llarp::util::PoolAlloc(1500);
+  REQUIRE(first != nullptr);
+  llarp::util::PoolFree(first, 1500);
+  // same size class on the same thread gets the same block back
+  void* second = llarp::util::PoolAlloc(1200);
+  REQUIRE(second == first);
+  llarp::util::PoolFree(second, 1200);
+}
+
+TEST_CASE("PoolAlloc handles blocks bigger than the pool", "[pool]")
+{
+  const size_t sz = llarp::util::PooledMaxBlockSize * 2;
+  auto* ptr = static_cast<unsigned char*>(llarp::util::PoolAlloc(sz));
+  REQUIRE(ptr != nullptr);
+  std::fill_n(ptr, sz, 0xff);
+  llarp::util::PoolFree(ptr, sz);
+}
+
+TEST_CASE("PooledVector behaves like a vector", "[pool]")
+{
+  llarp::util::PooledVector<unsigned char> vec(1024, 0x2a);
+  REQUIRE(vec.size() == 1024);
+  vec.resize(4096);
+  REQUIRE(vec[1023] == 0x2a);
+  REQUIRE(vec[4095] == 0);
+  auto copy = vec;
+  REQUIRE(copy == vec);
+}
+
+TEST_CASE("PoolAlloc carves blocks out of slabs once a policy asks for them", "[pool]")
+{
+  llarp::util::MemoryPolicy policy;
+  policy.nodeLocal = true;
+  llarp::util::SetMemoryPolicy(policy);
+  REQUIRE(llarp::util::SlabsEnabled());
+  REQUIRE(llarp::util::NumaNodeOf(-1) == 0);
+  REQUIRE(llarp::util::CurrentNumaNode() < llarp::util::NumaNodes());
+
+  // more than a thread keeps, so some go to the node and come back from it
+  std::vector<unsigned char*> blocks;
+  for (size_t idx = 0; idx < 1024; ++idx)
+  {
+    auto* ptr = static_cast<unsigned char*>(llarp::util::PoolAlloc(1500));
+    REQUIRE(ptr != nullptr);
+    std::fill_n(ptr, 1500, idx & 0xff);
+    blocks.push_back(ptr);
+  }
+  for (size_t idx = 0; idx < blocks.size(); ++idx)
+    REQUIRE(blocks[idx][1499] == (idx & 0xff));
+  REQUIRE(llarp::util::MemoryPolicyStatus()["slabs"].get<size_t>() > 0);
+  for (auto* ptr : blocks)
+    llarp::util::PoolFree(ptr, 1500);
+  for (auto& ptr : blocks)
+    ptr = static_cast<unsigned char*>(llarp::util::PoolAlloc(1500));
+  std::sort(blocks.begin(), blocks.end());
+  REQUIRE(std::adjacent_find(blocks.begin(), blocks.end()) == blocks.end());
+  for (auto* ptr : blocks)
+    llarp::util::PoolFree(ptr, 1500);
+
+  // once on the pool stays on slabs
+  llarp::util::SetMemoryPolicy({});
+  REQUIRE(llarp::util::SlabsEnabled());
+}
@@ -0,0 +1,44 @@
+#include <util/rate_estimator.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::util::RateEstimator;
+
+TEST_CASE("rate estimator turns bytes between ticks into a rate", "[util]")
+{
+  RateEstimator rate;
+  rate.Add(1000);
+  // the first tick only starts the clock
+  CHECK(rate.Tick(1s) == 1000);
+  CHECK(rate.Last() == 0);
+
+  rate.Add(2000);
+  CHECK(rate.Tick(3s) == 2000);
+  CHECK(rate.Last() == Approx(1000));
+  CHECK(rate.Smoothed() == Approx(1000));
+}
+
+TEST_CASE("rate estimator percentiles come from the recent samples", "[util]")
+{
+  RateEstimator rate;
+  rate.Tick(1s);
+  // one burst among steady seconds moves the max but not the median
+  for (int sec = 2; sec < 12; ++sec)
+  {
+    rate.Add(sec == 5 ? 100000 : 1000);
+    rate.Tick(llarp_time_t{sec * 1000});
+  }
+  CHECK(rate.Percentile(0.5) == Approx(1000));
+  CHECK(rate.Percentile(1.0) == Approx(100000));
+  CHECK(rate.Smoothed() > 1000);
+  CHECK(rate.Smoothed() < 100000);
+
+  // old samples fall out of the window
+  for (int sec = 12; sec < 12 + int(RateEstimator::NumSamples); ++sec)
+  {
+    rate.Add(500);
+    rate.Tick(llarp_time_t{sec * 1000});
+  }
+  CHECK(rate.Percentile(1.0) == Approx(500));
+  CHECK(rate.ExtractStatus()["p95"] == 500);
+}
@@ -0,0 +1,20 @@
+#include <util/time.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+TEST_CASE("coarse time only moves when a loop publishes", "[time]")
+{
+  const auto published = llarp::publish_coarse_now_ms();
+  CHECK(llarp::coarse_now_ms() >= published);
+  std::this_thread::sleep_for(20ms);
+  const auto coarse = llarp::coarse_now_ms();
+  CHECK(coarse < published + 20ms);
+  CHECK(llarp::time_now_ms() >= published + 20ms);
+
+  // publishing again moves it on
+  const auto later = llarp::publish_coarse_now_ms();
+  CHECK(later >= published + 20ms);
+  CHECK(llarp::coarse_now_ms() >= later);
+}
@@ -0,0 +1,85 @@
+#include <util/timer_wheel.hpp>
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("TimerWheel runs timers in order of expiry", "[timer-wheel]")
+{
+  llarp::util::TimerWheel wheel;
+  std::vector<int> ran;
+  const auto start = 1000s;
+  // spread over every level
+  wheel.Schedule(3, start, 300000ms, [&]() { ran.push_back(3); });
+  wheel.Schedule(1, start, 70ms, [&]() { ran.push_back(1); });
+  wheel.Schedule(0, start, 5ms, [&]() { ran.push_back(0); });
+  wheel.Schedule(2, start, 5000ms, [&]() { ran.push_back(2); });
+  REQUIRE(wheel.size() == 4);
+
+  REQUIRE(wheel.Advance(start + 4ms) == 0);
+  REQUIRE(wheel.Advance(start + 5ms) == 1);
+  REQUIRE(wheel.Advance(start + 69ms) == 0);
+  REQUIRE(wheel.Advance(start + 4999ms) == 1);
+  REQUIRE(wheel.Advance(start + 5000ms) == 1);
+  REQUIRE(wheel.Advance(start + 299999ms) == 0);
+  REQUIRE(wheel.Advance(start + 300000ms) == 1);
+  REQUIRE(ran == std::vector<int>{0, 1, 2, 3});
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimerWheel cancels and replaces by id", "[timer-wheel]")
+{
+  llarp::util::TimerWheel wheel;
+  int ran = 0;
+  wheel.Schedule(7, 0s, 10ms, [&]() { ran += 1; });
+  REQUIRE(wheel.Cancel(7));
+  REQUIRE(not wheel.Cancel(7));
+  wheel.Schedule(8, 0s, 10ms, [&]() { ran += 10; });
+  wheel.Schedule(8, 0s, 20ms, [&]() { ran += 100; });
+  REQUIRE(wheel.size() == 1);
+  wheel.Advance(1s);
+  REQUIRE(ran == 100);
+}
+
+TEST_CASE("TimerWheel callbacks can schedule and cancel", "[timer-wheel]")
+{
+  llarp::util::TimerWheel wheel;
+  int ticks = 0;
+  bool other = false;
+  std::function<void(void)> tick = [&]() {
+    if (++ticks < 5)
+      wheel.Schedule(1, wheel.Now(), 0ms, tick);
+  };
+  wheel.Schedule(1, 0s, 1ms, tick);
+  wheel.Schedule(2, 0s, 3ms, [&]() { other = true; });
+  wheel.Schedule(3, 0s, 2ms, [&]() { wheel.Cancel(2); });
+  wheel.Advance(100ms);
+  REQUIRE(ticks == 5);
+  REQUIRE(not other);
+}
+
+TEST_CASE("TimerWheel parks timers past its horizon", "[timer-wheel]")
+{
+  llarp::util::TimerWheel wheel;
+  bool ran = false;
+  const auto far = std::chrono::duration_cast<llarp_time_t>(48h);
+  wheel.Schedule(1, 0s, far, [&]() { ran = true; });
+  REQUIRE(wheel.NextWakeup().has_value());
+  wheel.Advance(far - 1ms);
+  REQUIRE(not ran);
+  wheel.Advance(far);
+  REQUIRE(ran);
+}
+
+TEST_CASE("TimerWheel wakes up for the nearest timer", "[timer-wheel]")
+{
+  llarp::util::TimerWheel wheel;
+  REQUIRE(not wheel.NextWakeup().has_value());
+  wheel.Schedule(1, 500ms, 10ms, []() {});
+  REQUIRE(*wheel.NextWakeup() == 510ms);
+  // asleep with nothing due only jumps the clock
+  wheel.Cancel(1);
+  wheel.Advance(10s);
+  REQUIRE(wheel.Now() == 10s);
+}
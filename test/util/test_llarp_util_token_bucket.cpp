@@ -0,0 +1,40 @@
+#include <util/token_bucket.hpp>
+
+#include <catch2/catch.hpp>
+
+using llarp::util::TokenBucket;
+
+TEST_CASE("token bucket lets a burst through then the rate", "[util]")
+{
+  TokenBucket bucket{2, 4};
+  const llarp_time_t start = 10s;
+  CHECK(bucket.Full(start));
+  for (int i = 0; i < 4; ++i)
+    CHECK(bucket.Take(start));
+  CHECK_FALSE(bucket.Take(start));
+  CHECK_FALSE(bucket.Full(start));
+
+  // half a second buys one token at 2 a second
+  CHECK(bucket.Take(start + 500ms));
+  CHECK_FALSE(bucket.Take(start + 500ms));
+  CHECK(bucket.Available(start + 1500ms) == Approx(2));
+}
+
+TEST_CASE("token bucket refills no further than its burst", "[util]")
+{
+  TokenBucket bucket{1, 3};
+  CHECK(bucket.Take(1s, 3));
+  CHECK(bucket.Available(1h) == Approx(3));
+  CHECK(bucket.Full(1h));
+  // too large a cost takes nothing
+  CHECK_FALSE(bucket.Take(1h, 4));
+  CHECK(bucket.Available(1h) == Approx(3));
+}
+
+TEST_CASE("token bucket ignores time going backwards", "[util]")
+{
+  TokenBucket bucket{1, 2};
+  CHECK(bucket.Take(10s, 2));
+  CHECK_FALSE(bucket.Take(5s));
+  CHECK(bucket.Available(11s) == Approx(1));
+}
@@ -0,0 +1,36 @@
+#include <util/thread/threading.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+using llarp::util::CountingMutex;
+
+TEST_CASE("CountingMutex counts locks and the waits for them", "[threading]")
+{
+  CountingMutex mutex;
+  {
+    std::shared_lock first{mutex};
+    std::shared_lock second{mutex};
+  }
+  auto counts = mutex.GetCounts();
+  REQUIRE(counts.shared == 2);
+  REQUIRE(counts.sharedWaits == 0);
+
+  {
+    std::unique_lock held{mutex};
+    REQUIRE_FALSE(mutex.try_lock_shared());
+    REQUIRE_FALSE(mutex.try_lock());
+    // a reader that has to wait for the writer to let go
+    std::thread reader([&mutex]() { std::shared_lock lock{mutex}; });
+    while (mutex.GetCounts().sharedWaits == 0)
+      std::this_thread::yield();
+    held.unlock();
+    reader.join();
+  }
+  counts = mutex.GetCounts();
+  REQUIRE(counts.shared == 3);
+  REQUIRE(counts.sharedWaits == 1);
+  REQUIRE(counts.exclusive == 1);
+  REQUIRE(counts.exclusiveWaits == 0);
+}
@@ -0,0 +1,90 @@
+#include <util/thread/job_queue.hpp>
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using llarp::thread::Job;
+using llarp::thread::JobQueue;
+
+TEST_CASE("Job holds small and large closures", "[job-queue]")
+{
+  int ran = 0;
+  Job small{[&ran]() { ran += 1; }};
+  std::array<char, 128> big{};
+  big[0] = 10;
+  Job large{[&ran, big]() { ran += big[0]; }};
+  small();
+  large();
+  REQUIRE(ran == 11);
+
+  // moving carries the closure and its captured state along
+  auto shared = std::make_shared<int>(100);
+  Job owner{[&ran, shared]() { ran += *shared; }};
+  REQUIRE(shared.use_count() == 2);
+  Job moved{std::move(owner)};
+  REQUIRE(not owner);
+  moved();
+  REQUIRE(ran == 111);
+  moved.Reset();
+  REQUIRE(shared.use_count() == 1);
+}
+
+TEST_CASE("JobQueue runs jobs in order and refuses when full", "[job-queue]")
+{
+  JobQueue queue{3};
+  REQUIRE(queue.Capacity() == 4);
+  REQUIRE(queue.Empty());
+  std::vector<int> ran;
+  for (int idx = 0; idx < 4; ++idx)
+  {
+    Job job{[&ran, idx]() { ran.push_back(idx); }};
+    REQUIRE(queue.TryPush(job));
+    REQUIRE(not job);
+  }
+  Job extra{[&ran]() { ran.push_back(-1); }};
+  REQUIRE(not queue.TryPush(extra));
+  REQUIRE(extra);
+
+  REQUIRE(queue.Drain(2) == 2);
+  REQUIRE(queue.TryPush(extra));
+  REQUIRE(queue.Drain(10) == 3);
+  REQUIRE(ran == std::vector<int>{0, 1, 2, 3, -1});
+  REQUIRE(queue.Empty());
+}
+
+TEST_CASE("JobQueue takes jobs from many threads", "[job-queue]")
+{
+  constexpr size_t NumThreads = 4;
+  constexpr size_t PerThread = 10000;
+  JobQueue queue{64};
+  std::array<size_t, NumThreads> last{};
+  size_t total = 0;
+  bool ordered = true;
+
+  std::vector<std::thread> producers;
+  for (size_t thread = 0; thread < NumThreads; ++thread)
+  {
+    producers.emplace_back([&, thread]() {
+      for (size_t idx = 1; idx <= PerThread; ++idx)
+      {
+        Job job{[&, thread, idx]() {
+          // each thread's jobs come out in the order it pushed them
+          ordered = ordered and last[thread] + 1 == idx;
+          last[thread] = idx;
+          total++;
+        }};
+        while (not queue.TryPush(job))
+          std::this_thread::yield();
+      }
+    });
+  }
+  while (total < NumThreads * PerThread)
+    queue.Drain(queue.Capacity());
+  for (auto& producer : producers)
+    producer.join();
+  REQUIRE(ordered);
+  REQUIRE(queue.Empty());
+}
@@ -0,0 +1,71 @@
+#include <util/thread/spsc_queue.hpp>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using llarp::thread::SpscQueue;
+
+TEST_CASE("SpscQueue pushes and pops batches in order", "[spsc-queue]")
+{
+  SpscQueue<std::string> queue{3};
+  REQUIRE(queue.capacity() == 4);
+  REQUIRE(queue.empty());
+
+  std::vector<std::string> batch{"a", "b", "c", "d", "e"};
+  REQUIRE(queue.tryPushBack(batch.data(), batch.size()) == 4);
+  REQUIRE(queue.full());
+  REQUIRE(not queue.tryPushBack(std::string{"f"}));
+
+  std::vector<std::string> out;
+  REQUIRE(queue.popAll(out, 2) == 2);
+  REQUIRE(queue.tryPushBack(batch.data() + 4, 1) == 1);
+  REQUIRE(queue.popAll(out) == 3);
+  REQUIRE(out == std::vector<std::string>{"a", "b", "c", "d", "e"});
+  REQUIRE(queue.empty());
+  REQUIRE(queue.popAll(out) == 0);
+}
+
+TEST_CASE("SpscQueue refuses pushes while disabled", "[spsc-queue]")
+{
+  SpscQueue<int> queue{4};
+  REQUIRE(queue.tryPushBack(1));
+  queue.disable();
+  REQUIRE(not queue.tryPushBack(2));
+  std::vector<int> out;
+  REQUIRE(queue.popAll(out) == 1);
+  queue.enable();
+  REQUIRE(queue.tryPushBack(3));
+}
+
+TEST_CASE("SpscQueue hands everything across threads", "[spsc-queue]")
+{
+  constexpr size_t Total = 100000;
+  SpscQueue<size_t> queue{64};
+  std::thread producer{[&queue]() {
+    std::vector<size_t> batch;
+    size_t next = 0;
+    while (next < Total)
+    {
+      batch.clear();
+      for (size_t idx = 0; idx < 16 and next < Total; ++idx)
+        batch.push_back(next++);
+      size_t pushed = 0;
+      while (pushed < batch.size())
+      {
+        pushed += queue.tryPushBack(batch.data() + pushed, batch.size() - pushed);
+        std::this_thread::yield();
+      }
+    }
+  }};
+  std::vector<size_t> out;
+  while (out.size() < Total)
+    queue.popAll(out);
+  producer.join();
+  bool ordered = true;
+  for (size_t idx = 0; idx < Total; ++idx)
+    ordered = ordered and out[idx] == idx;
+  REQUIRE(ordered);
+  REQUIRE(queue.empty());
+}
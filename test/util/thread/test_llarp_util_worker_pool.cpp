@@ -0,0 +1,93 @@
+#include <util/thread/worker_pool.hpp>
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using llarp::thread::WorkerPool;
+
+TEST_CASE("WorkerPool runs keyed jobs in order on one thread", "[worker-pool]")
+{
+  constexpr size_t NumKeys = 8;
+  constexpr size_t PerKey = 1000;
+  WorkerPool pool{4, "test-worker"};
+  REQUIRE(pool.NumWorkers() == 4);
+  std::array<size_t, NumKeys> last{};
+  std::array<std::thread::id, NumKeys> owner{};
+  std::atomic<bool> ordered{true};
+  std::atomic<bool> pinned{true};
+  pool.Start();
+  for (size_t idx = 1; idx <= PerKey; ++idx)
+  {
+    for (uint64_t key = 0; key < NumKeys; ++key)
+    {
+      pool.QueueFor(key, [&, key, idx]() {
+        if (idx == 1)
+          owner[key] = std::this_thread::get_id();
+        else if (owner[key] != std::this_thread::get_id())
+          pinned = false;
+        if (last[key] + 1 != idx)
+          ordered = false;
+        last[key] = idx;
+      });
+    }
+  }
+  pool.Stop();
+  REQUIRE(ordered);
+  REQUIRE(pinned);
+  for (const auto n : last)
+    REQUIRE(n == PerKey);
+}
+
+TEST_CASE("WorkerPool idle workers steal unkeyed jobs", "[worker-pool]")
+{
+  WorkerPool pool{2};
+  std::atomic<bool> release{false};
+  std::atomic<size_t> ran{0};
+  pool.Start();
+  // tie up one worker so the next job queued behind it has to be stolen
+  pool.QueueFor(0, [&]() {
+    while (not release)
+      std::this_thread::yield();
+  });
+  for (size_t idx = 0; idx < 10; ++idx)
+    pool.Queue([&]() { ran++; });
+  while (ran < 10)
+    std::this_thread::yield();
+  release = true;
+  pool.Stop();
+  const auto status = pool.ExtractStatus();
+  REQUIRE(status["stolen"].get<uint64_t>() > 0);
+  REQUIRE(status["workers"].size() == 2);
+}
+
+TEST_CASE("WorkerPool runs background jobs last and bounds them", "[worker-pool]")
+{
+  WorkerPool pool{1};
+  std::atomic<bool> release{false};
+  std::mutex mutex;
+  std::vector<std::string> order;
+  const auto record = [&](std::string name) {
+    std::lock_guard<std::mutex> lock{mutex};
+    order.emplace_back(std::move(name));
+  };
+  pool.Start();
+  pool.QueueFor(0, [&]() {
+    while (not release)
+      std::this_thread::yield();
+  });
+  REQUIRE(pool.TryQueueBackground([&]() { record("background"); }, 2));
+  REQUIRE(pool.TryQueueBackground([&]() { record("background"); }, 2));
+  REQUIRE(not pool.TryQueueBackground([&]() { record("rejected"); }, 2));
+  REQUIRE(pool.BackgroundQueued() == 2);
+  pool.Queue([&]() { record("shared"); });
+  release = true;
+  pool.Stop();
+  REQUIRE(order == std::vector<std::string>{"shared", "background", "background"});
+  REQUIRE(pool.BackgroundQueued() == 0);
+  REQUIRE(pool.ExtractStatus()["backgroundRejected"] == 1);
+}